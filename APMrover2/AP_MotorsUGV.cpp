@@ -14,6 +14,7 @@
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 #include "SRV_Channel/SRV_Channel.h"
+#include <AP_OutputLatency/AP_OutputLatency.h>
 #include "AP_MotorsUGV.h"
 #include "Rover.h"
 
@@ -263,11 +264,20 @@ void AP_MotorsUGV::output(bool armed, float ground_speed, float dt)
     // output to mainsail
     output_mainsail();
 
+    AP_OutputLatency *latency = AP::output_latency();
+    if (latency != nullptr) {
+        latency->stage(AP_OutputLatency::Stage::MIXER);
+    }
+
     // send values to the PWM timers for output
     SRV_Channels::calc_pwm();
     SRV_Channels::cork();
     SRV_Channels::output_ch_all();
     SRV_Channels::push();
+
+    if (latency != nullptr) {
+        latency->stage(AP_OutputLatency::Stage::OUTPUT);
+    }
 }
 
 // test steering or throttle output as a percentage of the total (range -100 to +100)
@@ -532,9 +542,9 @@ void AP_MotorsUGV::add_omni_motor(int8_t motor_num, float throttle_factor, float
     if (motor_num >= 0 && motor_num < AP_MOTORS_NUM_MOTORS_MAX) {
 
         // set throttle, steering and lateral factors
-        _throttle_factor[motor_num] = throttle_factor;
-        _steering_factor[motor_num] = steering_factor;
-        _lateral_factor[motor_num] = lateral_factor;
+        _omni_mix[motor_num][OMNI_THROTTLE] = throttle_factor;
+        _omni_mix[motor_num][OMNI_STEERING] = steering_factor;
+        _omni_mix[motor_num][OMNI_LATERAL] = lateral_factor;
 
         add_omni_motor_num(motor_num);
     }
@@ -560,9 +570,9 @@ void AP_MotorsUGV::clear_omni_motors(int8_t motor_num)
     // ensure valid motor number is provided
     if (motor_num >= 0 && motor_num < AP_MOTORS_NUM_MOTORS_MAX) {
         // disable the motor and set factors to zero
-        _throttle_factor[motor_num] = 0;
-        _steering_factor[motor_num] = 0;
-        _lateral_factor[motor_num] = 0;
+        _omni_mix[motor_num][OMNI_THROTTLE] = 0;
+        _omni_mix[motor_num][OMNI_STEERING] = 0;
+        _omni_mix[motor_num][OMNI_LATERAL] = 0;
     }
 }
 
@@ -686,24 +696,26 @@ void AP_MotorsUGV::output_omni(bool armed, float steering, float throttle, float
         steering = constrain_float(steering, -4500.0f, 4500.0f);
 
         // scale throttle, steering and lateral inputs to -1 to 1
-        const float scaled_throttle = throttle / 100.0f;
-        const float scaled_steering = steering / 4500.0f;
-        const float scaled_lateral = lateral / 100.0f;
-
-        float thr_str_ltr_out;
+        float input[3];
+        input[OMNI_THROTTLE] = throttle / 100.0f;
+        input[OMNI_STEERING] = steering / 4500.0f;
+        input[OMNI_LATERAL] = lateral / 100.0f;
+
+        // mix all the motors first, so every motor is scaled down by
+        // the same amount when any of them is over the limit
+        float thr_str_ltr_out[AP_MOTORS_NUM_MOTORS_MAX];
         float thr_str_ltr_max = 1;
-        for (uint8_t i=0; i<AP_MOTORS_NUM_MOTORS_MAX; i++) {
-            thr_str_ltr_out = (scaled_throttle * _throttle_factor[i]) +
-                              (scaled_steering * _steering_factor[i]) +
-                              (scaled_lateral * _lateral_factor[i]);
-            if (fabsf(thr_str_ltr_out) > thr_str_ltr_max) {
-                thr_str_ltr_max = fabsf(thr_str_ltr_out);
-            }
-
-            float output_vectored = (thr_str_ltr_out / thr_str_ltr_max);
+        for (uint8_t i=0; i<_motors_num; i++) {
+            thr_str_ltr_out[i] = _omni_mix[i][OMNI_THROTTLE] * input[OMNI_THROTTLE] +
+                                 _omni_mix[i][OMNI_STEERING] * input[OMNI_STEERING] +
+                                 _omni_mix[i][OMNI_LATERAL] * input[OMNI_LATERAL];
+            thr_str_ltr_max = MAX(thr_str_ltr_max, fabsf(thr_str_ltr_out[i]));
+        }
 
-            // send output for each motor
-            output_throttle(SRV_Channels::get_motor_function(i), 100.0f * output_vectored);
+        // send output for each motor
+        const float scale = 100.0f / thr_str_ltr_max;
+        for (uint8_t i=0; i<_motors_num; i++) {
+            output_throttle(SRV_Channels::get_motor_function(i), thr_str_ltr_out[i] * scale);
         }
     } else {
         // handle disarmed case
@@ -181,8 +181,9 @@ protected:
     float   _mainsail;  // requested mainsail input as a value from 0 to 100
 
     // omni variables
-    float   _throttle_factor[AP_MOTORS_NUM_MOTORS_MAX];
-    float   _steering_factor[AP_MOTORS_NUM_MOTORS_MAX];
-    float   _lateral_factor[AP_MOTORS_NUM_MOTORS_MAX];
+    // mixing matrix with a row of throttle, steering and lateral
+    // factors for each motor, applied to the scaled inputs in that order
+    enum { OMNI_THROTTLE = 0, OMNI_STEERING = 1, OMNI_LATERAL = 2 };
+    float   _omni_mix[AP_MOTORS_NUM_MOTORS_MAX][3];
     uint8_t   _motors_num;
 };
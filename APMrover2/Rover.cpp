@@ -203,6 +203,11 @@ void Rover::ahrs_update()
     if (should_log(MASK_LOG_IMU)) {
         logger.Write_IMU();
     }
+
+#if MOUNT == ENABLED
+    // camera mount's fast update
+    camera_mount.update_fast();
+#endif
 }
 
 /*
@@ -296,6 +301,8 @@ void Rover::one_second_loop(void)
 
     // send latest param values to wp_nav
     g2.wp_nav.set_turn_params(g.turn_max_g, g2.turn_radius, g2.motors.have_skid_steering());
+
+    output_latency.report();
 }
 
 void Rover::update_GPS(void)
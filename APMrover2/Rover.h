@@ -69,6 +69,7 @@
 #include <AP_Follow/AP_Follow.h>
 #include <AP_OSD/AP_OSD.h>
 #include <AP_WindVane/AP_WindVane.h>
+#include <AP_OutputLatency/AP_OutputLatency.h>
 
 #ifdef ENABLE_SCRIPTING
 #include <AP_Scripting/AP_Scripting.h>
@@ -175,6 +176,9 @@ private:
 
     AP_L1_Control L1_controller{ahrs, nullptr};
 
+    // latency from gyro sample to motor output
+    AP_OutputLatency output_latency;
+
 #if AP_AHRS_NAVEKF_AVAILABLE
     OpticalFlow optflow;
 #endif
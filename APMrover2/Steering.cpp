@@ -15,6 +15,7 @@ void Rover::set_servos(void)
             speed = 0.0f;
         }
 
+        output_latency.start(ins.get_gyro_sample_us());
         g2.motors.output(arming.is_armed(), speed, G_Dt);
     }
 }
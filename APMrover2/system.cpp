@@ -7,6 +7,7 @@ The init_ardupilot function processes everything we need for an in - air restart
 
 #include "Rover.h"
 #include <AP_Common/AP_FWVersion.h>
+#include <AP_Common/AP_BootTrace.h>
 
 static void mavlink_delay_cb_static()
 {
@@ -20,6 +21,7 @@ static void failsafe_check_static()
 
 void Rover::init_ardupilot()
 {
+    AP_BootTrace::stage("console");
     // initialise console serial port
     serial_manager.init_console();
 
@@ -32,6 +34,7 @@ void Rover::init_ardupilot()
     // Check the EEPROM format version before loading any parameters from EEPROM.
     //
 
+    AP_BootTrace::stage("params");
     load_parameters();
 #if STATS_ENABLED == ENABLED
     // initialise stats module
@@ -40,6 +43,7 @@ void Rover::init_ardupilot()
 
     mavlink_system.sysid = g.sysid_this_mav;
 
+    AP_BootTrace::stage("serial");
     // initialise serial ports
     serial_manager.init();
 
@@ -50,11 +54,13 @@ void Rover::init_ardupilot()
     // more than 5ms remaining in your call to hal.scheduler->delay
     hal.scheduler->register_delay_callback(mavlink_delay_cb_static, 5);
 
+    AP_BootTrace::stage("board");
     BoardConfig.init();
 #if HAL_WITH_UAVCAN
     BoardConfig_CAN.init();
 #endif
 
+    AP_BootTrace::stage("peripherals");
     // init gripper
 #if GRIPPER_ENABLED == ENABLED
     g2.gripper.init();
@@ -77,9 +83,11 @@ void Rover::init_ardupilot()
 
     g2.windvane.init(serial_manager);
 
+    AP_BootTrace::stage("baro");
     // init baro before we start the GCS, so that the CLI baro test works
     barometer.init();
 
+    AP_BootTrace::stage("gcs");
     // setup telem slots with serial ports
     gcs().setup_uarts();
 
@@ -87,36 +95,44 @@ void Rover::init_ardupilot()
     osd.init();
 #endif
 
+    AP_BootTrace::stage("logger");
 #if LOGGING_ENABLED == ENABLED
     log_init();
 #endif
 
+    AP_BootTrace::stage("compass");
     // initialise compass
     AP::compass().set_log_bit(MASK_LOG_COMPASS);
     AP::compass().init();
 
+    AP_BootTrace::stage("rangefinder");
     // initialise rangefinder
     rangefinder.init(ROTATION_NONE);
 
+    AP_BootTrace::stage("proximity");
     // init proximity sensor
     init_proximity();
 
+    AP_BootTrace::stage("beacon_visodom");
     // init beacons used for non-gps position estimation
     init_beacon();
 
     // init visual odometry
     init_visual_odom();
 
+    AP_BootTrace::stage("baro_cal");
     // and baro for EKF
     barometer.set_log_baro_bit(MASK_LOG_IMU);
     barometer.calibrate();
 
+    AP_BootTrace::stage("gps");
     // Do GPS init
     gps.set_log_gps_bit(MASK_LOG_GPS);
     gps.init(serial_manager);
 
     ins.set_log_raw_bit(MASK_LOG_IMU_RAW);
 
+    AP_BootTrace::stage("rc_motors");
     set_control_channels();  // setup radio channels and outputs ranges
     init_rc_in();            // sets up rc channels deadzone
     g2.motors.init();        // init motors including setting servo out channels ranges
@@ -138,14 +154,17 @@ void Rover::init_ardupilot()
      */
     hal.scheduler->register_timer_failsafe(failsafe_check_static, 1000);
 
+    AP_BootTrace::stage("srtl_oa");
     // initialize SmartRTL
     g2.smart_rtl.init();
 
     // initialise object avoidance
     g2.oa.init();
 
+    AP_BootTrace::stage("ground_start");
     startup_ground();
 
+    AP_BootTrace::stage("finalise");
     Mode *initial_mode = mode_from_mode_num((enum Mode::Number)g.initial_mode.get());
     if (initial_mode == nullptr) {
         initial_mode = &mode_initializing;
@@ -162,6 +181,7 @@ void Rover::init_ardupilot()
 
     // flag that initialisation has completed
     initialised = true;
+    AP_BootTrace::finish();
 
 #if AP_PARAM_KEY_DUMP
     AP_Param::show_all(hal.console, true);
@@ -38,6 +38,8 @@
 #include <AP_AccelCal/AP_AccelCal.h>                // interface and maths for accelerometer calibration
 #include <AP_AHRS/AP_AHRS.h>         // ArduPilot Mega DCM Library
 #include <Filter/Filter.h>                     // Filter library
+#include <Filter/TargetEstimator.h>
+#include <AP_RTC/JitterCorrection.h>
 
 #include <AP_SerialManager/AP_SerialManager.h>   // Serial manager library
 #include <AP_Declination/AP_Declination.h> // ArduPilot Mega Declination Helper Library
@@ -150,6 +152,10 @@ private:
         uint32_t last_update_ms;    // last position update in milliseconds
         Vector3f vel;           // the vehicle's velocity in m/s
         int32_t relative_alt;	// the vehicle's relative altitude in meters * 100
+        Location origin;        // origin of the estimator positions
+        Vector3f report_pos;    // last reported position in meters NED from origin
+        TargetEstimator estimator;  // estimate of the vehicle's motion between reports
+        JitterCorrection jitter{TRACKING_TIMEOUT_MS};  // time reports were sent, in local time
     } vehicle;
 
     // Navigation controller state
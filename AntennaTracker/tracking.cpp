@@ -11,12 +11,14 @@ void Tracker::update_vehicle_pos_estimate()
 
     // if less than 5 seconds since last position update estimate the position
     if (dt < TRACKING_TIMEOUT_SEC) {
-        // project the vehicle position to take account of lost radio packets
+        // predict where the vehicle is now, to take account of the
+        // time since the last report and lost radio packets. The
+        // prediction is applied as an offset from the reported
+        // location, so it stays small
+        const Vector3f ofs = vehicle.estimator.predict(AP_HAL::micros()) - vehicle.report_pos;
         vehicle.location_estimate = vehicle.location;
-        float north_offset = vehicle.vel.x * dt;
-        float east_offset = vehicle.vel.y * dt;
-        vehicle.location_estimate.offset(north_offset, east_offset);
-    	vehicle.location_estimate.alt += vehicle.vel.z * 100.0f * dt;
+        vehicle.location_estimate.offset(ofs.x, ofs.y);
+        vehicle.location_estimate.alt -= ofs.z * 100.0f;
         // set valid_location flag
         vehicle.location_valid = true;
     } else {
@@ -157,7 +159,22 @@ void Tracker::tracking_update_position(const mavlink_global_position_int_t &msg)
     vehicle.location.alt = msg.alt/10;
     vehicle.relative_alt = msg.relative_alt/10;
     vehicle.vel = Vector3f(msg.vx/100.0f, msg.vy/100.0f, msg.vz/100.0f);
-    vehicle.last_update_us = AP_HAL::micros();
+
+    // the estimator works relative to the first report since the
+    // vehicle was last lost, when it is also reset
+    const uint32_t now_us = AP_HAL::micros();
+    const uint32_t timeout_us = TRACKING_TIMEOUT_MS * 1000UL;
+    if (vehicle.last_update_us == 0 || now_us - vehicle.last_update_us > timeout_us) {
+        vehicle.origin = vehicle.location;
+    }
+    vehicle.report_pos = vehicle.origin.get_distance_NED(vehicle.location);
+
+    // timestamp the report with when it was sent, so the prediction
+    // covers the link latency and isn't upset by jitter on the link
+    const uint32_t sent_us = vehicle.jitter.correct_offboard_timestamp_usec(msg.time_boot_ms * 1000ULL, AP_HAL::micros64());
+    vehicle.estimator.update(vehicle.report_pos, vehicle.vel, sent_us, timeout_us);
+
+    vehicle.last_update_us = now_us;
     vehicle.last_update_ms = AP_HAL::millis();
     // log vehicle as GPS2
     if (should_log(MASK_LOG_GPS)) {
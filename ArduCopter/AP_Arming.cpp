@@ -690,6 +690,8 @@ void AP_Arming_Copter::set_pre_arm_check(bool b)
 
 bool AP_Arming_Copter::arm(const AP_Arming::Method method, const bool do_arming_checks)
 {
+    WITH_SEMAPHORE(copter.rate_loop_sem);
+
     static bool in_arm_motors = false;
 
     // exit immediately if already in this function
@@ -803,6 +805,8 @@ bool AP_Arming_Copter::arm(const AP_Arming::Method method, const bool do_arming_
 // arming.disarm - disarm motors
 bool AP_Arming_Copter::disarm()
 {
+    WITH_SEMAPHORE(copter.rate_loop_sem);
+
     // return immediately if we are already disarmed
     if (!copter.motors->armed()) {
         return true;
@@ -60,6 +60,7 @@ void Copter::update_throttle_hover()
     if (throttle > 0.0f && fabsf(inertial_nav.get_velocity_z()) < 60 &&
         labs(ahrs.roll_sensor-attitude_control->get_roll_trim_cd()) < 500 && labs(ahrs.pitch_sensor) < 500) {
         // Can we set the time constant automatically
+        WITH_SEMAPHORE(rate_loop_sem);
         motors->update_throttle_hover(0.01f);
     }
 }
@@ -118,6 +118,9 @@ const AP_Scheduler::Task Copter::scheduler_tasks[] = {
 #endif
 #if VISUAL_ODOMETRY_ENABLED == ENABLED
     SCHED_TASK_CLASS(AP_VisualOdom,       &copter.g2.visual_odom,        update,         400,  50),
+#endif
+#if MODE_FOLLOW_ENABLED == ENABLED
+    SCHED_TASK_CLASS(AP_Follow,            &copter.g2.follow,           update,          50,  75),
 #endif
     SCHED_TASK(update_altitude,       10,    100),
     SCHED_TASK(run_nav_updates,       50,    100),
@@ -165,6 +168,7 @@ const AP_Scheduler::Task Copter::scheduler_tasks[] = {
     SCHED_TASK_CLASS(AP_Logger,      &copter.logger,           periodic_tasks, 400, 300),
 #endif
     SCHED_TASK_CLASS(AP_InertialSensor,    &copter.ins,                 periodic,       400,  50),
+    SCHED_TASK_CLASS(AP_GyroFFT,           &copter.g2.fft,              update,          10,  50),
     SCHED_TASK_CLASS(AP_Scheduler,         &copter.scheduler,           update_logging, 0.1,  75),
 #if RPM_ENABLED == ENABLED
     SCHED_TASK(rpm_update,            40,    200),
@@ -206,7 +210,7 @@ const AP_Scheduler::Task Copter::scheduler_tasks[] = {
     SCHED_TASK_CLASS(AP_Button,            &copter.g2.button,           update,           5, 100),
 #endif
 #if STATS_ENABLED == ENABLED
-    SCHED_TASK_CLASS(AP_Stats,             &copter.g2.stats,            update,           1, 100),
+    SCHED_TASK_CLASS_GROUP(AP_Stats,       &copter.g2.stats,            update,           1, 100, AP_Scheduler::THREAD_GROUP_BACKGROUND),
 #endif
 #if OSD_ENABLED == ENABLED
     SCHED_TASK(publish_osd_info, 1, 10),
@@ -239,11 +243,24 @@ void Copter::fast_loop()
     // update INS immediately to get current gyro data populated
     ins.update();
 
-    // run low level rate controllers that only require IMU data
-    attitude_control->rate_controller_run();
+#if FRAME_CONFIG != HELI_FRAME
+    if (!using_rate_thread)
+#endif
+    {
+        output_latency.start(ins.get_gyro_sample_us());
 
-    // send outputs to the motors library immediately
-    motors_output();
+        // run low level rate controllers that only require IMU data
+        attitude_control->rate_controller_run();
+
+        // send outputs to the motors library immediately
+        motors_output();
+    }
+
+    // motor rpm from ESCs is updated every few frames, so track it at
+    // the loop rate
+    if (ins.get_gyro_harmonic_notch_tracking_mode() == HarmonicNotch_UpdateBLHeli) {
+        update_dynamic_notch();
+    }
 
     // run EKF state estimator (expensive)
     // --------------------
@@ -264,13 +281,20 @@ void Copter::fast_loop()
     check_ekf_reset();
 
     // run the attitude controllers
-    update_flight_mode();
+    {
+        // the rate loop thread must not see the targets half set
+        WITH_SEMAPHORE(rate_loop_sem);
+        update_flight_mode();
+    }
 
     // update home from EKF if necessary
     update_home_from_EKF();
 
     // check if we've landed or crashed
-    update_land_and_crash_detectors();
+    {
+        WITH_SEMAPHORE(rate_loop_sem);
+        update_land_and_crash_detectors();
+    }
 
 #if MOUNT == ENABLED
     // camera mount's fast update
@@ -283,6 +307,53 @@ void Copter::fast_loop()
     }
 }
 
+#if FRAME_CONFIG != HELI_FRAME
+/*
+  rate loop thread, used with FSTRATE_ENABLE. It wakes on each filtered
+  sample of the gyro the AHRS uses and runs the rate controller and motor
+  output straight away, so the EKF no longer sits between a gyro
+  sample and the motor output it produces
+ */
+void Copter::rate_controller_thread()
+{
+    while (true) {
+        Vector3f gyro;
+        float dt;
+        uint64_t sample_us;
+        // the timeout only stops us waiting forever on a failed IMU
+        if (!ins.wait_rate_loop_sample(gyro, dt, sample_us, 100000)) {
+            continue;
+        }
+        WITH_SEMAPHORE(rate_loop_sem);
+        output_latency.start(sample_us);
+        attitude_control->rate_controller_run_gyro(ahrs_view->rotate_gyro_to_view(gyro), dt);
+        motors_output();
+    }
+}
+
+void Copter::rate_controller_thread_start()
+{
+    if (!g2.fast_rate_enable) {
+        return;
+    }
+    if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&Copter::rate_controller_thread, void),
+                                      "RateLoop", 4096, AP_HAL::Scheduler::PRIORITY_BOOST, 1)) {
+        gcs().send_text(MAV_SEVERITY_ERROR, "Failed to start rate loop thread");
+        return;
+    }
+    uint16_t div = constrain_int16(g2.fast_rate_div, 0, 10);
+    if (div == 0) {
+        // run at the main loop rate, which the outputs are set up
+        // for, rather than at the raw gyro rate
+        const uint16_t gyro_rate_hz = ins.get_raw_gyro_rate_hz(ins.get_primary_gyro());
+        div = gyro_rate_hz / scheduler.get_loop_rate_hz();
+    }
+    // a fast IMU at a slow loop rate can need more than 8 bits
+    ins.enable_rate_loop_samples(constrain_int32(div, 1, UINT8_MAX));
+    using_rate_thread = true;
+}
+#endif
+
 // rc_loops - reads user input from transmitter/receiver
 // called at 100hz
 void Copter::rc_loop()
@@ -298,7 +369,10 @@ void Copter::rc_loop()
 void Copter::throttle_loop()
 {
     // update throttle_low_comp value (controls priority of throttle vs attitude control)
-    update_throttle_mix();
+    {
+        WITH_SEMAPHORE(rate_loop_sem);
+        update_throttle_mix();
+    }
 
     // check auto_armed status
     update_auto_armed();
@@ -314,7 +388,9 @@ void Copter::throttle_loop()
     // compensate for ground effect (if enabled)
     update_ground_effect_detector();
 
-    update_dynamic_notch();
+    if (ins.get_gyro_harmonic_notch_tracking_mode() != HarmonicNotch_UpdateBLHeli) {
+        update_dynamic_notch();
+    }
 }
 
 // update_batt_compass - read battery and compass
@@ -445,6 +521,8 @@ void Copter::one_hz_loop()
     arming.update();
 
     if (!motors->armed()) {
+        WITH_SEMAPHORE(rate_loop_sem);
+
         // make it possible to change ahrs orientation at runtime during initial config
         ahrs.update_orientation();
 
@@ -470,6 +548,8 @@ void Copter::one_hz_loop()
 #endif
 
     AP_Notify::flags.flying = !ap.land_complete;
+
+    output_latency.report();
 }
 
 
@@ -669,6 +749,13 @@ void Copter::read_AHRS(void)
 
     // we tell AHRS to skip INS update as we have already done it in fast_loop()
     ahrs.update(true);
+
+#if FRAME_CONFIG != HELI_FRAME
+    if (using_rate_thread) {
+        // correct the rate loop samples the way get_gyro_latest() does
+        ins.set_rate_loop_gyro(ahrs.get_primary_gyro_index(), ahrs.get_gyro_drift());
+    }
+#endif
 }
 
 // read baro and log control tuning
@@ -65,6 +65,8 @@
 #include <AP_Arming/AP_Arming.h>
 #include <AP_SmartRTL/AP_SmartRTL.h>
 #include <AP_TempCalibration/AP_TempCalibration.h>
+#include <AP_GyroFFT/AP_GyroFFT.h>
+#include <AP_OutputLatency/AP_OutputLatency.h>
 #include <AC_AutoTune/AC_AutoTune.h>
 #include <AP_Common/AP_FWVersion.h>
 
@@ -483,6 +485,17 @@ private:
     // Attitude, Position and Waypoint navigation objects
     // To-Do: move inertial nav up or other navigation variables down here
     AC_AttitudeControl_t *attitude_control;
+
+    // latency from gyro sample to motor output
+    AP_OutputLatency output_latency;
+    // with FSTRATE_ENABLE the rate controller runs on its own thread,
+    // which holds this while it uses the controller and motors. The
+    // main loop holds it while changing the attitude targets or the
+    // motors state
+    HAL_Semaphore rate_loop_sem;
+#if FRAME_CONFIG != HELI_FRAME
+    bool using_rate_thread;
+#endif
     AC_PosControl *pos_control;
     AC_WPNav *wp_nav;
     AC_Loiter *loiter_nav;
@@ -659,6 +672,10 @@ private:
 
     // ArduCopter.cpp
     void fast_loop();
+#if FRAME_CONFIG != HELI_FRAME
+    void rate_controller_thread();
+    void rate_controller_thread_start();
+#endif
     void rc_loop();
     void throttle_loop();
     void update_batt_compass(void);
@@ -961,6 +961,28 @@ const AP_Param::GroupInfo ParametersG2::var_info[] = {
     AP_SUBGROUPINFO(arot, "AROT_", 37, ParametersG2, AC_Autorotation),
 #endif
 
+    // @Group: FFT_
+    // @Path: ../libraries/AP_GyroFFT/AP_GyroFFT.cpp
+    AP_SUBGROUPINFO(fft, "FFT_", 38, ParametersG2, AP_GyroFFT),
+
+#if FRAME_CONFIG != HELI_FRAME
+    // @Param: FSTRATE_ENABLE
+    // @DisplayName: Fast rate loop enable
+    // @Description: Runs the rate controller and motor output on their own thread each time the primary gyro has a new filtered sample, rather than once per main loop. This cuts the latency from gyro sample to motor output and raises the rate loop to the gyro rate. The EKF and everything else stay in the main loop
+    // @Values: 0:Disabled, 1:Enabled
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("FSTRATE_ENABLE", 39, ParametersG2, fast_rate_enable, 0),
+
+    // @Param: FSTRATE_DIV
+    // @DisplayName: Fast rate loop divisor
+    // @Description: With FSTRATE_ENABLE the rate loop runs on every Nth raw gyro sample, to bring fast sampling IMUs down to a rate the rate loop and ESCs can keep up with. 0 picks the divisor which runs the rate loop at the main loop rate
+    // @Range: 0 10
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("FSTRATE_DIV", 40, ParametersG2, fast_rate_div, 0),
+#endif
+
 
 
     AP_GROUPEND
@@ -620,6 +620,15 @@ public:
     // Autonmous autorotation
     AC_Autorotation arot;
 #endif
+
+    // on board gyro spectral analysis
+    AP_GyroFFT fft;
+
+#if FRAME_CONFIG != HELI_FRAME
+    // rate loop thread
+    AP_Int8 fast_rate_enable;
+    AP_Int8 fast_rate_div;
+#endif
 };
 
 extern const AP_Param::Info        var_info[];
@@ -75,6 +75,9 @@ MAV_RESULT Copter::mavlink_compassmot(const GCS_MAVLINK &gcs_chan)
     // disable cpu failsafe
     failsafe_disable();
 
+    // keep the rate loop thread off the motors while we drive them
+    WITH_SEMAPHORE(rate_loop_sem);
+
     float current;
 
     // default compensation type to use current if possible
@@ -178,6 +178,7 @@ enum HarmonicNotchDynamicMode {
     HarmonicNotch_UpdateThrottle,
     HarmonicNotch_UpdateRPM,
     HarmonicNotch_UpdateBLHeli,
+    HarmonicNotch_UpdateGyroFFT,
 };
 
 #define MASK_LOG_ATTITUDE_FAST          (1<<0)
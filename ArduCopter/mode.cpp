@@ -185,6 +185,7 @@ Mode *Copter::mode_from_mode_num(const Mode::Number mode)
 // ACRO, STABILIZE, ALTHOLD, LAND, DRIFT and SPORT can always be set successfully but the return state of other flight modes should be checked and the caller should deal with failures appropriately
 bool Copter::set_mode(Mode::Number mode, ModeReason reason)
 {
+    WITH_SEMAPHORE(rate_loop_sem);
 
     // return immediately if we are already in the desired mode
     if (mode == control_mode) {
@@ -293,6 +294,10 @@ bool Copter::set_mode(Mode::Number mode, ModeReason reason)
     // update notify object
     notify_flight_mode();
 
+#ifdef ENABLE_SCRIPTING
+    AP_Scripting::post_event(AP_Scripting::Event::MODE_CHANGE, (uint8_t)control_mode);
+#endif
+
     // return success
     return true;
 }
@@ -130,6 +130,8 @@ bool Copter::mavlink_motor_test_check(const GCS_MAVLINK &gcs_chan, bool check_rc
 MAV_RESULT Copter::mavlink_motor_test_start(const GCS_MAVLINK &gcs_chan, uint8_t motor_seq, uint8_t throttle_type, uint16_t throttle_value,
                                          float timeout_sec, uint8_t motor_count)
 {
+    WITH_SEMAPHORE(rate_loop_sem);
+
     if (motor_count == 0) {
         motor_count = 1;
     }
@@ -187,6 +189,8 @@ MAV_RESULT Copter::mavlink_motor_test_start(const GCS_MAVLINK &gcs_chan, uint8_t
 // motor_test_stop - stops the motor test
 void Copter::motor_test_stop()
 {
+    WITH_SEMAPHORE(rate_loop_sem);
+
     // exit immediately if the test is not running
     if (!ap.motor_test) {
         return;
@@ -178,6 +178,8 @@ void Copter::motors_output()
 
     // push all channels
     SRV_Channels::push();
+
+    output_latency.stage(AP_OutputLatency::Stage::OUTPUT);
 }
 
 // check for pilot stick input to trigger lost vehicle alarm
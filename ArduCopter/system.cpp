@@ -1,5 +1,6 @@
 #include "Copter.h"
 #include <AP_BLHeli/AP_BLHeli.h>
+#include <AP_Common/AP_BootTrace.h>
 
 /*****************************************************************************
 *   The init_ardupilot function processes everything we need for an in - air restart
@@ -21,6 +22,7 @@ static void failsafe_check_static()
 
 void Copter::init_ardupilot()
 {
+    AP_BootTrace::stage("console");
     // initialise serial port
     serial_manager.init_console();
 
@@ -34,6 +36,7 @@ void Copter::init_ardupilot()
     //
     report_version();
 
+    AP_BootTrace::stage("params");
     // load parameters from EEPROM
     load_parameters();
 
@@ -49,6 +52,7 @@ void Copter::init_ardupilot()
     // identify ourselves correctly with the ground station
     mavlink_system.sysid = g.sysid_this_mav;
     
+    AP_BootTrace::stage("serial");
     // initialise serial ports
     serial_manager.init();
 
@@ -59,11 +63,13 @@ void Copter::init_ardupilot()
     // more than 5ms remaining in your call to hal.scheduler->delay
     hal.scheduler->register_delay_callback(mavlink_delay_cb_static, 5);
     
+    AP_BootTrace::stage("board");
     BoardConfig.init();
 #if HAL_WITH_UAVCAN
     BoardConfig_CAN.init();
 #endif
 
+    AP_BootTrace::stage("peripherals");
     // init cargo gripper
 #if GRIPPER_ENABLED == ENABLED
     g2.gripper.init();
@@ -86,8 +92,10 @@ void Copter::init_ardupilot()
     // Init RSSI
     rssi.init();
     
+    AP_BootTrace::stage("baro");
     barometer.init();
 
+    AP_BootTrace::stage("gcs");
     // setup telem slots with serial ports
     gcs().setup_uarts();
 
@@ -95,6 +103,7 @@ void Copter::init_ardupilot()
     osd.init();
 #endif
 
+    AP_BootTrace::stage("logger");
 #if LOGGING_ENABLED == ENABLED
     log_init();
 #endif
@@ -110,6 +119,7 @@ void Copter::init_ardupilot()
     input_manager.set_loop_rate(scheduler.get_loop_rate_hz());
 #endif
 
+    AP_BootTrace::stage("rc_motors");
     init_rc_in();               // sets up rc channels from radio
 
     // allocate the motors class
@@ -127,6 +137,7 @@ void Copter::init_ardupilot()
     // motors initialised so parameters can be sent
     ap.initialised_params = true;
 
+    AP_BootTrace::stage("relay");
     relay.init();
 
     /*
@@ -135,13 +146,16 @@ void Copter::init_ardupilot()
      */
     hal.scheduler->register_timer_failsafe(failsafe_check_static, 1000);
 
+    AP_BootTrace::stage("gps");
     // Do GPS init
     gps.set_log_gps_bit(MASK_LOG_GPS);
     gps.init(serial_manager);
 
+    AP_BootTrace::stage("compass");
     AP::compass().set_log_bit(MASK_LOG_COMPASS);
     AP::compass().init();
 
+    AP_BootTrace::stage("nav");
 #if OPTFLOW == ENABLED
     // make optflow available to AHRS
     ahrs.set_optflow(&optflow);
@@ -160,9 +174,11 @@ void Copter::init_ardupilot()
     attitude_control->parameter_sanity_check();
     pos_control->set_dt(scheduler.get_loop_period_s());
 
+    AP_BootTrace::stage("optflow");
     // init the optical flow sensor
     init_optflow();
 
+    AP_BootTrace::stage("mount_precland");
 #if MOUNT == ENABLED
     // initialise camera mount
     camera_mount.init();
@@ -192,17 +208,21 @@ void Copter::init_ardupilot()
     ins.set_hil_mode();
 #endif
 
+    AP_BootTrace::stage("baro_cal");
     // read Baro pressure at ground
     //-----------------------------
     barometer.set_log_baro_bit(MASK_LOG_IMU);
     barometer.calibrate();
 
+    AP_BootTrace::stage("rangefinder");
     // initialise rangefinder
     init_rangefinder();
 
+    AP_BootTrace::stage("proximity");
     // init proximity sensor
     init_proximity();
 
+    AP_BootTrace::stage("beacon_visodom");
 #if BEACON_ENABLED == ENABLED
     // init beacons used for non-gps position estimation
     g2.beacon.init();
@@ -216,6 +236,7 @@ void Copter::init_ardupilot()
     rpm_sensor.init();
 #endif
 
+    AP_BootTrace::stage("mission");
 #if MODE_AUTO_ENABLED == ENABLED
     // initialise mission library
     mode_auto.mission.init();
@@ -229,12 +250,19 @@ void Copter::init_ardupilot()
     // initialise AP_Logger library
     logger.setVehicle_Startup_Writer(FUNCTOR_BIND(&copter, &Copter::Log_Write_Vehicle_Startup_Messages, void));
 
+    AP_BootTrace::stage("ins");
     startup_INS_ground();
 
+    AP_BootTrace::stage("fft");
+    // start the gyro spectral analysis now the gyro rate is known
+    g2.fft.init();
+
+    AP_BootTrace::stage("scripting");
 #ifdef ENABLE_SCRIPTING
     g2.scripting.init();
 #endif // ENABLE_SCRIPTING
 
+    AP_BootTrace::stage("finalise");
     // set landed flags
     set_land_complete(true);
     set_land_complete_maybe(true);
@@ -259,10 +287,15 @@ void Copter::init_ardupilot()
 
     vehicle_setup();
 
+#if FRAME_CONFIG != HELI_FRAME
+    rate_controller_thread_start();
+#endif
+
     hal.console->printf("\nReady to FLY ");
 
     // flag that initialisation has completed
     ap.initialised = true;
+    AP_BootTrace::finish();
 
 #if AP_PARAM_KEY_DUMP
     AP_Param::show_all(hal.console, true);
@@ -315,9 +348,32 @@ void Copter::update_dynamic_notch()
 #endif
 #ifdef HAVE_AP_BLHELI_SUPPORT
         case HarmonicNotch_UpdateBLHeli: // BLHeli based tracking
-            ins.update_harmonic_notch_freq_hz(MAX(ref_freq, AP_BLHeli::get_singleton()->get_average_motor_frequency_hz() * ref));
+            if (ins.has_harmonic_notch_option(HarmonicNotchFilterParams::Options::DynamicHarmonic)) {
+                // set a harmonic notch filter frequency for each motor
+                float notches[HNF_MAX_COMPOSITE_NOTCHES];
+                const uint8_t num_notches = AP_BLHeli::get_singleton()->get_motor_frequencies_hz(HNF_MAX_COMPOSITE_NOTCHES, notches);
+                for (uint8_t i = 0; i < num_notches; i++) {
+                    notches[i] = MAX(ref_freq, notches[i] * ref);
+                }
+                if (num_notches > 0) {
+                    ins.update_harmonic_notch_freqs_hz(num_notches, notches);
+                } else {
+                    ins.update_harmonic_notch_freq_hz(ref_freq);
+                }
+            } else {
+                ins.update_harmonic_notch_freq_hz(MAX(ref_freq, AP_BLHeli::get_singleton()->get_average_motor_frequency_hz() * ref));
+            }
             break;
 #endif
+        case HarmonicNotch_UpdateGyroFFT: // gyro FFT based tracking
+            if (g2.fft.healthy()) {
+                // set the harmonic notch filter frequency from the tracked vibration peak
+                ins.update_harmonic_notch_freq_hz(MAX(ref_freq, g2.fft.get_peak_freq_hz() * ref));
+            } else {
+                ins.update_harmonic_notch_freq_hz(ref_freq);
+            }
+            break;
+
         case HarmonicNotch_Fixed: // static
         default:
             ins.update_harmonic_notch_freq_hz(ref_freq);
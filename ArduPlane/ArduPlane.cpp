@@ -167,6 +167,11 @@ void Plane::ahrs_update()
 
     // update inertial_nav for quadplane
     quadplane.inertial_nav.update();
+
+#if MOUNT == ENABLED
+    // camera mount's fast update
+    camera_mount.update_fast();
+#endif
 }
 
 /*
@@ -261,6 +266,11 @@ void Plane::one_second_loop()
     // make it possible to change orientation at runtime
     ahrs.update_orientation();
 
+    // TECS and L1 are updated at 10Hz, by update_alt() and navigate()
+    const float nav_interp_hz = g2.nav_out_interp ? 10 : 0;
+    TECS_controller.set_output_interpolation(nav_interp_hz);
+    L1_controller.set_output_interpolation(nav_interp_hz);
+
     adsb.set_stall_speed_cm(aparm.airspeed_min);
     adsb.set_max_speed(aparm.airspeed_max);
 
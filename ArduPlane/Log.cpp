@@ -127,6 +127,7 @@ struct PACKED log_Nav_Tuning {
     int32_t target_lng;
     int32_t target_alt;
     int32_t target_airspeed;
+    uint32_t nav_update_us;
 };
 
 // Write a navigation tuning packet
@@ -146,6 +147,7 @@ void Plane::Log_Write_Nav_Tuning()
         target_lng          : next_WP_loc.lng,
         target_alt          : next_WP_loc.alt,
         target_airspeed     : target_airspeed_cm,
+        nav_update_us       : L1_controller.get_update_time_us(),
     };
     logger.WriteBlock(&pkt, sizeof(pkt));
 }
@@ -255,7 +257,7 @@ const struct LogStructure Plane::log_structure[] = {
     { LOG_CTUN_MSG, sizeof(log_Control_Tuning),     
       "CTUN", "Qcccchhhf",    "TimeUS,NavRoll,Roll,NavPitch,Pitch,ThrOut,RdrOut,ThrDem,Aspd", "sdddd---n", "FBBBB---0" },
     { LOG_NTUN_MSG, sizeof(log_Nav_Tuning),         
-      "NTUN", "QfcccfffLLii",  "TimeUS,Dist,TBrg,NavBrg,AltErr,XT,XTi,AspdE,TLat,TLng,TAlt,TAspd", "smddmmmnDUmn", "F0BBB0B0GGBB" },
+      "NTUN", "QfcccfffLLiiI",  "TimeUS,Dist,TBrg,NavBrg,AltErr,XT,XTi,AspdE,TLat,TLng,TAlt,TAspd,Nus", "smddmmmnDUmn-", "F0BBB0B0GGBB-" },
     { LOG_SONAR_MSG, sizeof(log_Sonar),             
       "SONR", "QffBf",   "TimeUS,Dist,Volt,Cnt,Corr", "smv--", "FB0--" },
     { LOG_ATRP_MSG, sizeof(AP_AutoTune::log_ATRP),
@@ -1271,6 +1271,13 @@ const AP_Param::GroupInfo ParametersG2::var_info[] = {
     // @User: Standard
     AP_GROUPINFO("RTL_CLIMB_MIN", 27, ParametersG2, rtl_climb_min, 0),
 
+    // @Param: NAV_OUT_INTERP
+    // @DisplayName: Navigation output interpolation
+    // @Description: When enabled the pitch and throttle demands from TECS and the roll demand from the L1 controller are linearly interpolated over the 0.1s between their updates, so the attitude controllers see smoothly changing demands rather than steps at 10Hz. This is most useful with a high SCHED_LOOP_RATE, as on quadplanes. It delays changes in the demands by up to 0.1s.
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    AP_GROUPINFO("NAV_OUT_INTERP", 28, ParametersG2, nav_out_interp, 0),
+
     AP_GROUPEND
 };
 
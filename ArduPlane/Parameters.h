@@ -572,6 +572,9 @@ public:
 
     // min initial climb in RTL
     AP_Int16        rtl_climb_min;
+
+    // interpolate TECS and L1 demands between their updates
+    AP_Int8         nav_out_interp;
 };
 
 extern const AP_Param::Info var_info[];
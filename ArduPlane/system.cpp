@@ -1,5 +1,6 @@
 #include "Plane.h"
 #include <AP_Common/AP_FWVersion.h>
+#include <AP_Common/AP_BootTrace.h>
 
 /*****************************************************************************
 *   The init_ardupilot function processes everything we need for an in - air restart
@@ -20,6 +21,7 @@ static void failsafe_check_static()
 
 void Plane::init_ardupilot()
 {
+    AP_BootTrace::stage("console");
     // initialise serial port
     serial_manager.init_console();
 
@@ -29,6 +31,7 @@ void Plane::init_ardupilot()
                         (unsigned)hal.util->available_memory());
 
     //
+    AP_BootTrace::stage("params");
     // Check the EEPROM format version before loading any parameters from EEPROM
     //
     load_parameters();
@@ -53,6 +56,7 @@ void Plane::init_ardupilot()
 
     mavlink_system.sysid = g.sysid_this_mav;
 
+    AP_BootTrace::stage("serial");
     // initialise serial ports
     serial_manager.init();
     gcs().setup_console();
@@ -61,12 +65,14 @@ void Plane::init_ardupilot()
     // more than 5ms remaining in your call to hal.scheduler->delay
     hal.scheduler->register_delay_callback(mavlink_delay_cb_static, 5);
 
+    AP_BootTrace::stage("board");
     // setup any board specific drivers
     BoardConfig.init();
 #if HAL_WITH_UAVCAN
     BoardConfig_CAN.init();
 #endif
 
+    AP_BootTrace::stage("rc_notify");
     // initialise rc channels including setting mode
     rc().init();
 
@@ -82,18 +88,22 @@ void Plane::init_ardupilot()
     // used to detect in-flight resets
     g.num_resets.set_and_save(g.num_resets+1);
 
+    AP_BootTrace::stage("baro");
     // init baro
     barometer.init();
 
+    AP_BootTrace::stage("rangefinder");
     // initialise rangefinder
     rangefinder.set_log_rfnd_bit(MASK_LOG_SONAR);
     rangefinder.init(ROTATION_PITCH_270);
 
+    AP_BootTrace::stage("battery_rpm");
     // initialise battery monitoring
     battery.init();
 
     rpm_sensor.init();
 
+    AP_BootTrace::stage("gcs");
     // setup telem slots with serial ports
     gcs().setup_uarts();
 
@@ -101,13 +111,16 @@ void Plane::init_ardupilot()
     osd.init();
 #endif
 
+    AP_BootTrace::stage("logger");
 #if LOGGING_ENABLED == ENABLED
     log_init();
 #endif
 
+    AP_BootTrace::stage("airspeed");
     // initialise airspeed sensor
     airspeed.init();
 
+    AP_BootTrace::stage("compass");
     AP::compass().set_log_bit(MASK_LOG_COMPASS);
     AP::compass().init();
 
@@ -121,10 +134,12 @@ void Plane::init_ardupilot()
     // give AHRS the airspeed sensor
     ahrs.set_airspeed(&airspeed);
 
+    AP_BootTrace::stage("gps");
     // GPS Initialization
     gps.set_log_gps_bit(MASK_LOG_GPS);
     gps.init(serial_manager);
 
+    AP_BootTrace::stage("rc_mount");
     init_rc_in();               // sets up rc channels from radio
 
 #if MOUNT == ENABLED
@@ -148,12 +163,15 @@ void Plane::init_ardupilot()
      */
     hal.scheduler->register_timer_failsafe(failsafe_check_static, 1000);
 
+    AP_BootTrace::stage("quadplane");
     quadplane.setup();
 
     AP_Param::reload_defaults_file(true);
     
+    AP_BootTrace::stage("ground_start");
     startup_ground();
 
+    AP_BootTrace::stage("finalise");
     // don't initialise aux rc output until after quadplane is setup as
     // that can change initial values of channels
     init_rc_out_aux();
@@ -184,6 +202,7 @@ void Plane::init_ardupilot()
 
     // disable safety if requested
     BoardConfig.init_safety();
+    AP_BootTrace::finish();
 
 #if AP_PARAM_KEY_DUMP
     AP_Param::show_all(hal.console, true);
@@ -305,6 +324,10 @@ bool Plane::set_mode(Mode &new_mode, const ModeReason reason)
     notify_mode(*control_mode);
     gcs().send_message(MSG_HEARTBEAT);
 
+#ifdef ENABLE_SCRIPTING
+    AP_Scripting::post_event(AP_Scripting::Event::MODE_CHANGE, control_mode->mode_number());
+#endif
+
     return true;
 }
 
@@ -114,6 +114,7 @@ void Sub::fast_loop()
 
     // send outputs to the motors library
     motors_output();
+    record_joystick_latency();
 
     // run EKF state estimator (expensive)
     // --------------------
@@ -126,6 +127,9 @@ void Sub::fast_loop()
     // check if ekf has reset target heading
     check_ekf_yaw_reset();
 
+    // use any new joystick input in this loop
+    read_joystick_input();
+
     // run the attitude controllers
     update_flight_mode();
 
@@ -288,6 +292,8 @@ void Sub::one_hz_loop()
     // log terrain data
     terrain_logging();
 
+    log_joystick_latency();
+
     // need to set "likely flying" when armed to allow for compass
     // learning to run
     ahrs.set_likely_flying(hal.util->get_soft_armed());
@@ -312,6 +312,15 @@ const AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
     // @Increment: 1
     // @User: Advanced
     AP_GROUPINFO("PARAMS",   8, GCS_MAVLINK_Parameters, streamRates[GCS_MAVLINK::STREAM_PARAMS],  0),
+
+    // @Param: ADAPT
+    // @DisplayName: Adaptive stream rate target utilisation
+    // @Description: When non-zero, stream rates on this link are reduced so the data sent uses about this percentage of the throughput the link is estimated to carry. Low value streams are slowed first and attitude and position last. Zero sends streams at their set rates
+    // @Units: %
+    // @Range: 0 95
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("ADAPT",   10, GCS_MAVLINK_Parameters, adaptive_util,  0),
     AP_GROUPEND
 };
 
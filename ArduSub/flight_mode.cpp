@@ -80,6 +80,10 @@ bool Sub::set_mode(control_mode_t mode, ModeReason reason)
         // update notify object
         notify_flight_mode(control_mode);
 
+#ifdef ENABLE_SCRIPTING
+        AP_Scripting::post_event(AP_Scripting::Event::MODE_CHANGE, control_mode);
+#endif
+
 #if CAMERA == ENABLED
         camera.set_is_auto_mode(control_mode == AUTO);
 #endif
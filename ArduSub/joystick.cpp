@@ -26,6 +26,16 @@ const uint8_t SERVO_CHAN_3 = 11; // Pixhawk Aux3
 
 uint8_t roll_pitch_flag = false; // Flag to adjust roll/pitch instead of forward/lateral
 bool controls_reset_since_input_hold = true;
+
+// joystick input handed from MAVLink handling to the fast loop, and
+// the latency from its arrival to the thruster outputs calculated from it
+struct {
+    uint64_t arrival_us;    // arrival of input not yet read, zero if none
+    uint64_t read_us;       // arrival of input read this loop, zero if none
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t sum_us;
+} js_input;
 }
 
 void Sub::init_joystick()
@@ -53,6 +63,8 @@ void Sub::init_joystick()
 
 void Sub::transform_manual_control_to_rc_override(int16_t x, int16_t y, int16_t z, int16_t r, uint16_t buttons)
 {
+    // the fast loop reads the overrides as soon as it next runs
+    js_input.arrival_us = AP_HAL::micros64();
 
     float rpyScale = 0.4*gain; // Scale -1000-1000 to -400-400 with gain
     float throttleScale = 0.8*gain*g.throttle_gain; // Scale 0-1000 to 0-800 times gain
@@ -139,6 +151,58 @@ void Sub::transform_manual_control_to_rc_override(int16_t x, int16_t y, int16_t
     z_last = z;
 }
 
+/*
+  read the RC overrides from joystick input that has arrived since the
+  last loop, so the flight mode uses them straight away rather than
+  waiting for the 50Hz RC input read. Called by the fast loop before
+  the flight mode is updated
+ */
+void Sub::read_joystick_input()
+{
+    if (js_input.arrival_us == 0) {
+        return;
+    }
+    rc().read_input();
+    js_input.read_us = js_input.arrival_us;
+    js_input.arrival_us = 0;
+}
+
+/*
+  the thruster outputs from the flight mode update of the last loop
+  have been sent. If that used new joystick input, record the latency
+  from its arrival
+ */
+void Sub::record_joystick_latency()
+{
+    if (js_input.read_us == 0) {
+        return;
+    }
+    const uint32_t latency_us = AP_HAL::micros64() - js_input.read_us;
+    js_input.read_us = 0;
+    js_input.count++;
+    js_input.sum_us += latency_us;
+    js_input.max_us = MAX(js_input.max_us, latency_us);
+}
+
+// log the joystick input latency since the last call, then reset it
+void Sub::log_joystick_latency()
+{
+    if (js_input.count == 0) {
+        return;
+    }
+    // count of inputs used, and mean and max latency in microseconds
+    if (should_log(MASK_LOG_ANY)) {
+        logger.Write("JLAT", "TimeUS,Cnt,Mean,Max", "QIfI",
+                     AP_HAL::micros64(),
+                     js_input.count,
+                     (double)(float(js_input.sum_us) / js_input.count),
+                     js_input.max_us);
+    }
+    js_input.count = 0;
+    js_input.sum_us = 0;
+    js_input.max_us = 0;
+}
+
 void Sub::handle_jsbutton_press(uint8_t _button, bool shift, bool held)
 {
     // Act based on the function assigned to this button
@@ -1,4 +1,5 @@
 #include "Sub.h"
+#include <AP_Common/AP_BootTrace.h>
 
 /*****************************************************************************
 *   The init_ardupilot function processes everything we need for an in - air restart
@@ -19,6 +20,7 @@ static void failsafe_check_static()
 
 void Sub::init_ardupilot()
 {
+    AP_BootTrace::stage("console");
     // initialise serial port
     serial_manager.init_console();
 
@@ -27,9 +29,11 @@ void Sub::init_ardupilot()
                         AP::fwversion().fw_string,
                         (unsigned)hal.util->available_memory());
 
+    AP_BootTrace::stage("params");
     // load parameters from EEPROM
     load_parameters();
 
+    AP_BootTrace::stage("board");
     BoardConfig.init();
 #if HAL_WITH_UAVCAN
     BoardConfig_CAN.init();
@@ -55,12 +59,14 @@ void Sub::init_ardupilot()
     // identify ourselves correctly with the ground station
     mavlink_system.sysid = g.sysid_this_mav;
     
+    AP_BootTrace::stage("serial");
     // initialise serial port
     serial_manager.init();
 
     // setup first port early to allow BoardConfig to report errors
     gcs().setup_console();
 
+    AP_BootTrace::stage("peripherals");
     // init cargo gripper
 #if GRIPPER_ENABLED == ENABLED
     g2.gripper.init();
@@ -74,6 +80,7 @@ void Sub::init_ardupilot()
     // initialise battery monitor
     battery.init();
 
+    AP_BootTrace::stage("baro");
     barometer.init();
 
     // Register the mavlink service callback. This will run
@@ -81,13 +88,16 @@ void Sub::init_ardupilot()
     // hal.scheduler->delay.
     hal.scheduler->register_delay_callback(mavlink_delay_cb_static, 5);
 
+    AP_BootTrace::stage("gcs");
     // setup telem slots with serial ports
     gcs().setup_uarts();
 
+    AP_BootTrace::stage("logger");
 #if LOGGING_ENABLED == ENABLED
     log_init();
 #endif
 
+    AP_BootTrace::stage("rc_motors");
     // initialise rc channels including setting mode
     rc().init();
 
@@ -103,13 +113,16 @@ void Sub::init_ardupilot()
      */
     hal.scheduler->register_timer_failsafe(failsafe_check_static, 1000);
 
+    AP_BootTrace::stage("gps");
     // Do GPS init
     gps.set_log_gps_bit(MASK_LOG_GPS);
     gps.init(serial_manager);
 
+    AP_BootTrace::stage("compass");
     AP::compass().set_log_bit(MASK_LOG_COMPASS);
     AP::compass().init();
 
+    AP_BootTrace::stage("nav");
 #if OPTFLOW == ENABLED
     // make optflow available to AHRS
     ahrs.set_optflow(&optflow);
@@ -137,6 +150,7 @@ void Sub::init_ardupilot()
     USERHOOK_INIT
 #endif
 
+    AP_BootTrace::stage("baro_cal");
     // Init baro and determine if we have external (depth) pressure sensor
     barometer.set_log_baro_bit(MASK_LOG_IMU);
     barometer.calibrate(false);
@@ -167,6 +181,7 @@ void Sub::init_ardupilot()
 
     last_pilot_heading = ahrs.yaw_sensor;
 
+    AP_BootTrace::stage("rangefinder");
     // initialise rangefinder
 #if RANGEFINDER_ENABLED == ENABLED
     init_rangefinder();
@@ -177,6 +192,7 @@ void Sub::init_ardupilot()
     rpm_sensor.init();
 #endif
 
+    AP_BootTrace::stage("mission");
     // initialise mission library
     mission.init();
 
@@ -185,12 +201,15 @@ void Sub::init_ardupilot()
     logger.setVehicle_Startup_Writer(FUNCTOR_BIND(&sub, &Sub::Log_Write_Vehicle_Startup_Messages, void));
 #endif
 
+    AP_BootTrace::stage("ins");
     startup_INS_ground();
 
+    AP_BootTrace::stage("scripting");
 #ifdef ENABLE_SCRIPTING
     g2.scripting.init();
 #endif // ENABLE_SCRIPTING
 
+    AP_BootTrace::stage("finalise");
     // we don't want writes to the serial port to cause us to pause
     // mid-flight, so set the serial ports non-blocking once we are
     // ready to fly
@@ -208,6 +227,7 @@ void Sub::init_ardupilot()
 
     // flag that initialisation has completed
     ap.initialised = true;
+    AP_BootTrace::finish();
 
 #if AP_PARAM_KEY_DUMP
     AP_Param::show_all(hal.console, true);
@@ -76,6 +76,18 @@
 // GET_CRC		verify CRC of entire flashable area
 // RESET		finalise flash programming, reset chip and starts application
 //
+// Bootloaders which answer GET_DEVICE/BULK_MAX also support a faster
+// upload, where sectors are only erased as the upload reaches them,
+// with the next sector erased while the host sends the next block:
+//
+// GET_SYNC		verify that the board is present
+// GET_DEVICE		determine which board and the largest block size
+// START_BULK		reset address counter, nothing is erased yet
+// loop:
+//      PROG_BULK       erase up to the end of the block, program bytes
+// GET_CRC		erase sectors after the upload, verify CRC of entire flashable area
+// RESET		finalise flash programming, reset chip and starts application
+//
 
 #define BL_PROTOCOL_VERSION 		5		// The revision of the bootloader protocol
 // protocol bytes
@@ -103,9 +115,12 @@
 #define PROTO_BOOT					0x30    // boot the application
 #define PROTO_DEBUG					0x31    // emit debug information - format not defined
 #define PROTO_SET_BAUD				0x33    // baud rate on uart
+#define PROTO_START_BULK			0x34    // start a bulk upload
+#define PROTO_PROG_BULK				0x35    // erase as needed, write bytes at program address and increment
 
 #define PROTO_PROG_MULTI_MAX    64	// maximum PROG_MULTI size
 #define PROTO_READ_MULTI_MAX    255	// size of the size field
+#define PROTO_PROG_BULK_MAX     1024	// maximum PROG_BULK size
 
 /* argument values for PROTO_GET_DEVICE */
 #define PROTO_DEVICE_BL_REV	1	// bootloader revision
@@ -113,6 +128,7 @@
 #define PROTO_DEVICE_BOARD_REV	3	// board revision
 #define PROTO_DEVICE_FW_SIZE	4	// size of flashable area
 #define PROTO_DEVICE_VEC_AREA	5	// contents of reserved vectors 7-10
+#define PROTO_DEVICE_BULK_MAX	6	// maximum PROG_BULK size, if bulk upload is supported
 
 // interrupt vector table for STM32
 #define SCB_VTOR 0xE000ED08
@@ -370,7 +386,7 @@ static bool flash_write_flush(void)
 /*
   write to flash with buffering to 32 bytes alignment
  */
-static bool flash_write_buffer(uint32_t address, const uint32_t *v, uint8_t nwords)
+static bool flash_write_buffer(uint32_t address, const uint32_t *v, uint16_t nwords)
 {
     if (fbuf.n > 0 && address != fbuf.address + fbuf.n*4) {
         if (!flash_write_flush()) {
@@ -397,6 +413,41 @@ static bool flash_write_buffer(uint32_t address, const uint32_t *v, uint8_t nwor
     return true;
 }
 
+/*
+  state of a bulk upload. Sectors before next_sector are erased,
+  covering the flash up to erased_end
+ */
+static struct {
+    bool active;
+    bool erase_ahead;       // erase the next sector once the reply is sent
+    uint8_t next_sector;
+    uint32_t erased_end;
+} bulk;
+
+/*
+  erase the next sector of a bulk upload, unless it is already blank
+ */
+static bool bulk_erase_next(void)
+{
+    const uint32_t size = flash_func_sector_size(bulk.next_sector);
+    if (size == 0) {
+        return false;
+    }
+    bool blank = true;
+    for (uint32_t ofs = 0; ofs < size; ofs += 4) {
+        if (flash_func_read_word(bulk.erased_end + ofs) != 0xffffffff) {
+            blank = false;
+            break;
+        }
+    }
+    if (!blank && !flash_func_erase_sector(bulk.next_sector)) {
+        return false;
+    }
+    bulk.erased_end += size;
+    bulk.next_sector++;
+    return true;
+}
+
 #define TEST_FLASH 0
 
 #if TEST_FLASH
@@ -489,6 +540,10 @@ bootloader(unsigned timeout)
             uint8_t		c[256];
             uint32_t	w[64];
         } flash_buffer;
+        static union {
+            uint8_t		c[PROTO_PROG_BULK_MAX];
+            uint32_t	w[PROTO_PROG_BULK_MAX/4];
+        } bulk_buffer;
 
         // Wait for a command byte
         led_off(LED_ACTIVITY);
@@ -580,6 +635,12 @@ bootloader(unsigned timeout)
 
                 break;
 
+            case PROTO_DEVICE_BULK_MAX: {
+                uint32_t bulk_max = PROTO_PROG_BULK_MAX;
+                cout((uint8_t *)&bulk_max, sizeof(bulk_max));
+                break;
+            }
+
             default:
                 goto cmd_bad;
             }
@@ -608,6 +669,7 @@ bootloader(unsigned timeout)
             // to zero
             done_erase = true;
             timeout = 0;
+            bulk.active = false;
             
             flash_set_keep_unlocked(true);
 
@@ -703,6 +765,104 @@ bootloader(unsigned timeout)
             address += arg * 4;
             break;
 
+        // start a bulk upload. Unlike CHIP_ERASE nothing is erased
+        // until PROG_BULK reaches it
+        //
+        // command:		START_BULK/EOC
+        // success reply:	INSYNC/OK
+        //
+        case PROTO_START_BULK:
+            if (!done_sync || !done_get_device) {
+                // lower chance of random data on a uart triggering erase
+                goto cmd_bad;
+            }
+
+            if (!wait_for_eoc(2)) {
+                goto cmd_bad;
+            }
+
+            // as with erase there is no going back
+            done_erase = true;
+            timeout = 0;
+
+            flash_set_keep_unlocked(true);
+
+            bulk.active = true;
+            bulk.next_sector = 0;
+            bulk.erased_end = 0;
+            address = 0;
+
+            // erase the first sector while the host sends the first block
+            bulk.erase_ahead = true;
+            break;
+
+        // erase the sectors up to the end of the block if needed, then
+        // program bytes at current address
+        //
+        // command:		PROG_BULK/<len:2>/<data:len>/EOC
+        // success reply:	INSYNC/OK
+        // invalid reply:	INSYNC/INVALID
+        // erase or write failure:	INSYNC/FAILURE
+        //
+        case PROTO_PROG_BULK: {
+            if (!bulk.active) {
+                goto cmd_bad;
+            }
+
+            led_set(LED_OFF);
+
+            // expect little-endian count
+            const int len_lo = cin(50);
+            const int len_hi = cin(50);
+            if (len_lo < 0 || len_hi < 0) {
+                goto cmd_bad;
+            }
+            const uint32_t len = uint32_t(len_lo) | (uint32_t(len_hi) << 8);
+
+            // sanity-check arguments
+            if ((len % 4) != 0 || len > sizeof(bulk_buffer.c) || (address + len) > board_info.fw_size) {
+                goto cmd_bad;
+            }
+
+            for (uint32_t i = 0; i < len; i++) {
+                c = cin(1000);
+
+                if (c < 0) {
+                    goto cmd_bad;
+                }
+
+                bulk_buffer.c[i] = c;
+            }
+
+            if (!wait_for_eoc(200)) {
+                goto cmd_bad;
+            }
+
+            while (bulk.erased_end < address + len) {
+                if (!bulk_erase_next()) {
+                    goto cmd_fail;
+                }
+            }
+
+            // save the first words and don't program it until everything else is done
+            if (address < sizeof(first_words)) {
+                uint8_t n = MIN(sizeof(first_words)-address, len);
+                memcpy(&first_words[address/4], &bulk_buffer.w[0], n);
+                // replace first words with 1 bits we can overwrite later
+                memset(&bulk_buffer.w[0], 0xFF, n);
+            }
+
+            if (!flash_write_buffer(address, bulk_buffer.w, len/4)) {
+                goto cmd_fail;
+            }
+            address += len;
+
+            // if the next block would need another sector, erase it
+            // while the host is sending the block
+            bulk.erase_ahead = address + PROTO_PROG_BULK_MAX > bulk.erased_end;
+            break;
+        }
+
         // fetch CRC of the entire flash area
         //
         // command:			GET_CRC/EOC
@@ -718,6 +878,12 @@ bootloader(unsigned timeout)
                 goto cmd_bad;
             }
 
+            if (bulk.active) {
+                // erase anything left after the end of a bulk upload
+                while (bulk.erased_end < board_info.fw_size && bulk_erase_next()) {
+                }
+            }
+
             // compute CRC of the programmed area
             uint32_t sum = 0;
 
@@ -966,6 +1132,15 @@ bootloader(unsigned timeout)
 
         // send the sync response for this command
         sync_response();
+
+        if (bulk.erase_ahead) {
+            // the host can send the next block while we erase. If
+            // it fails the sector is tried again when it is needed
+            bulk.erase_ahead = false;
+            if (bulk.erased_end < board_info.fw_size) {
+                bulk_erase_next();
+            }
+        }
         continue;
 cmd_bad:
         // if we get a bad command it could be line noise on a
@@ -191,7 +191,7 @@ void AP_Periph_FW::update()
 #endif
     }
     can_update();
-    hal.scheduler->delay(1);
+    can_wait(1000);
 #if defined(HAL_PERIPH_NEOPIXEL_COUNT) && HAL_PERIPH_NEOPIXEL_COUNT == 8
     update_rainbow();
 #endif
@@ -38,6 +38,7 @@ public:
 
     void can_start();
     void can_update();
+    void can_wait(uint32_t wait_us);
     void can_mag_update();
     void can_gps_update();
     void can_baro_update();
@@ -414,6 +414,104 @@ static void fix_float16(float &f)
     *(uint16_t *)&f = canardConvertNativeFloatToFloat16(f);
 }
 
+/*
+  a sensor message published by this node. The message is encoded
+  into the publisher's buffer as soon as a new sample is ready, and
+  all publishers are queued for transmit together once per loop. If
+  the bus has not sent the last batch by then a newer sample replaces
+  the one waiting rather than queueing behind it, so a busy bus
+  delays data instead of sending stale samples. Each message type
+  has its own transfer ID
+ */
+class PeriphPublisher {
+public:
+    PeriphPublisher(uint64_t signature, uint16_t id, uint8_t *buffer) :
+        _signature(signature),
+        _id(id),
+        _buffer(buffer),
+        _next(_list)
+    {
+        _list = this;
+    }
+
+    // buffer to encode the next sample into
+    uint8_t *buffer() { return _buffer; }
+
+    // mark the encoded sample of len bytes to be sent at the next flush
+    void publish(uint16_t len) {
+        _len = len;
+        _pending = true;
+    }
+
+    // queue the pending samples of all publishers for transmit
+    static void flush_all();
+
+private:
+    const uint64_t _signature;
+    const uint16_t _id;
+    uint8_t *_buffer;
+    uint16_t _len;
+    uint8_t _transfer_id;
+    bool _pending;
+
+    PeriphPublisher *_next;
+    static PeriphPublisher *_list;
+};
+
+PeriphPublisher *PeriphPublisher::_list;
+
+void PeriphPublisher::flush_all()
+{
+    if (canardPeekTxQueue(&canard) != NULL) {
+        // the last batch is still going out
+        return;
+    }
+    for (PeriphPublisher *p = _list; p != nullptr; p = p->_next) {
+        if (!p->_pending) {
+            continue;
+        }
+        p->_pending = false;
+        canardBroadcast(&canard,
+                        p->_signature,
+                        p->_id,
+                        &p->_transfer_id,
+                        CANARD_TRANSFER_PRIORITY_LOW,
+                        p->_buffer,
+                        p->_len);
+    }
+}
+
+// publisher with its own buffer of SIZE bytes
+template <uint16_t SIZE>
+class PeriphPublisherBuffer : public PeriphPublisher {
+public:
+    PeriphPublisherBuffer(uint64_t signature, uint16_t id) :
+        PeriphPublisher(signature, id, _data) {}
+
+private:
+    uint8_t _data[SIZE];
+};
+
+#define PERIPH_PUBLISHER(name, msg) static PeriphPublisherBuffer<msg ## _MAX_SIZE> name{msg ## _SIGNATURE, msg ## _ID}
+
+#ifdef HAL_PERIPH_ENABLE_MAG
+PERIPH_PUBLISHER(mag_pub, UAVCAN_EQUIPMENT_AHRS_MAGNETICFIELDSTRENGTH);
+#endif
+#ifdef HAL_PERIPH_ENABLE_GPS
+PERIPH_PUBLISHER(gps_fix_pub, UAVCAN_EQUIPMENT_GNSS_FIX);
+PERIPH_PUBLISHER(gps_aux_pub, UAVCAN_EQUIPMENT_GNSS_AUXILIARY);
+#endif
+#ifdef HAL_PERIPH_ENABLE_BARO
+PERIPH_PUBLISHER(baro_press_pub, UAVCAN_EQUIPMENT_AIR_DATA_STATICPRESSURE);
+PERIPH_PUBLISHER(baro_temp_pub, UAVCAN_EQUIPMENT_AIR_DATA_STATICTEMPERATURE);
+#endif
+#ifdef HAL_PERIPH_ENABLE_AIRSPEED
+PERIPH_PUBLISHER(airspeed_pub, UAVCAN_EQUIPMENT_AIR_DATA_RAWAIRDATA);
+#endif
+#ifdef HAL_PERIPH_ENABLE_RANGEFINDER
+PERIPH_PUBLISHER(rangefinder_pub, UAVCAN_EQUIPMENT_RANGE_SENSOR_MEASUREMENT);
+#endif
+
 
 #ifdef HAL_PERIPH_ENABLE_BUZZER
 static uint32_t buzzer_start_ms;
@@ -733,7 +831,7 @@ static bool shouldAcceptTransfer(const CanardInstance* ins,
 
 static void processTx(void)
 {
-    static uint8_t fail_count;
+    static uint32_t last_tx_ms;
     for (const CanardCANFrame* txf = NULL; (txf = canardPeekTxQueue(&canard)) != NULL;) {
         CANTxFrame txmsg {};
         txmsg.DLC = txf->data_len;
@@ -743,13 +841,12 @@ static void processTx(void)
         txmsg.RTR = 0;
         if (canTransmit(&CAND1, CAN_ANY_MAILBOX, &txmsg, TIME_IMMEDIATE) == MSG_OK) {
             canardPopTxQueue(&canard);
-            fail_count = 0;
+            last_tx_ms = AP_HAL::millis();
         } else {
-            // just exit and try again later. If we fail 8 times in a row
-            // then start discarding to prevent the pool filling up
-            if (fail_count < 8) {
-                fail_count++;
-            } else {
+            // just exit and try again when a mailbox empties. If
+            // nothing has gone out for 8ms then start discarding to
+            // prevent the pool filling up
+            if (AP_HAL::millis() - last_tx_ms > 8) {
                 canardPopTxQueue(&canard);
             }
             return;
@@ -777,6 +874,41 @@ static void processRx(void)
     }
 }
 
+/*
+  wake the main thread from the CAN interrupt when a TX mailbox empties
+  or frames arrive, so mailboxes are refilled between loops
+ */
+#define EVT_CAN EVENT_MASK(0)
+static thread_t *can_wait_thread;
+
+static void can_event_isr(CANDriver *canp, uint32_t flags)
+{
+    chSysLockFromISR();
+    if (can_wait_thread != nullptr) {
+        chEvtSignalI(can_wait_thread, EVT_CAN);
+    }
+    chSysUnlockFromISR();
+}
+
+/*
+  wait for wait_us between loops, refilling the TX mailboxes and
+  emptying the RX FIFO whenever the interrupt says they need it
+ */
+void AP_Periph_FW::can_wait(uint32_t wait_us)
+{
+    const uint32_t start_us = AP_HAL::micros();
+    can_wait_thread = chThdGetSelfX();
+    while (true) {
+        const uint32_t waited_us = AP_HAL::micros() - start_us;
+        if (waited_us >= wait_us) {
+            break;
+        }
+        chEvtWaitAnyTimeout(EVT_CAN, chTimeUS2I(wait_us - waited_us));
+        processTx();
+        processRx();
+    }
+}
+
 static uint16_t pool_peak_percent(void)
 {
     const CanardPoolAllocatorStatistics stats = canardGetPoolAllocatorStatistics(&canard);
@@ -945,6 +1077,8 @@ void AP_Periph_FW::can_start()
         PreferredNodeID = g.can_node;
     }
 
+    CAND1.txempty_cb = can_event_isr;
+    CAND1.rxfull_cb = can_event_isr;
     canStart(&CAND1, &cancfg);
 
     canardInit(&canard, (uint8_t *)canard_memory_pool, sizeof(canard_memory_pool),
@@ -981,6 +1115,7 @@ void AP_Periph_FW::can_update()
 #ifdef HAL_GPIO_PIN_SAFE_BUTTON
     can_safety_button_update();
 #endif
+    PeriphPublisher::flush_all();
     processTx();
     processRx();
 }
@@ -1017,16 +1152,7 @@ void AP_Periph_FW::can_mag_update(void)
         fix_float16(pkt.magnetic_field_ga[i]);
     }
 
-    uint8_t buffer[UAVCAN_EQUIPMENT_AHRS_MAGNETICFIELDSTRENGTH_MAX_SIZE];
-    uint16_t total_size = uavcan_equipment_ahrs_MagneticFieldStrength_encode(&pkt, buffer);
-
-    canardBroadcast(&canard,
-                    UAVCAN_EQUIPMENT_AHRS_MAGNETICFIELDSTRENGTH_SIGNATURE,
-                    UAVCAN_EQUIPMENT_AHRS_MAGNETICFIELDSTRENGTH_ID,
-                    &transfer_id,
-                    CANARD_TRANSFER_PRIORITY_LOW,
-                    &buffer[0],
-                    total_size);
+    mag_pub.publish(uavcan_equipment_ahrs_MagneticFieldStrength_encode(&pkt, mag_pub.buffer()));
 #endif // HAL_PERIPH_ENABLE_MAG
 }
 
@@ -1108,18 +1234,7 @@ void AP_Periph_FW::can_gps_update(void)
         fix_float16(vel_cov[8]);
     }
 
-    {
-        uint8_t buffer[UAVCAN_EQUIPMENT_GNSS_FIX_MAX_SIZE];
-        uint16_t total_size = uavcan_equipment_gnss_Fix_encode(&pkt, buffer);
-
-        canardBroadcast(&canard,
-                        UAVCAN_EQUIPMENT_GNSS_FIX_SIGNATURE,
-                        UAVCAN_EQUIPMENT_GNSS_FIX_ID,
-                        &transfer_id,
-                        CANARD_TRANSFER_PRIORITY_LOW,
-                        &buffer[0],
-                        total_size);
-    }
+    gps_fix_pub.publish(uavcan_equipment_gnss_Fix_encode(&pkt, gps_fix_pub.buffer()));
 
     /*
       send aux packet
@@ -1131,15 +1246,7 @@ void AP_Periph_FW::can_gps_update(void)
         fix_float16(aux.hdop);
         fix_float16(aux.vdop);
 
-        uint8_t buffer[UAVCAN_EQUIPMENT_GNSS_AUXILIARY_MAX_SIZE];
-        uint16_t total_size = uavcan_equipment_gnss_Auxiliary_encode(&aux, buffer);
-        canardBroadcast(&canard,
-                        UAVCAN_EQUIPMENT_GNSS_AUXILIARY_SIGNATURE,
-                        UAVCAN_EQUIPMENT_GNSS_AUXILIARY_ID,
-                        &transfer_id,
-                        CANARD_TRANSFER_PRIORITY_LOW,
-                        &buffer[0],
-                        total_size);
+        gps_aux_pub.publish(uavcan_equipment_gnss_Auxiliary_encode(&aux, gps_aux_pub.buffer()));
     }
 #endif // HAL_PERIPH_ENABLE_GPS
 }
@@ -1169,16 +1276,7 @@ void AP_Periph_FW::can_baro_update(void)
         pkt.static_pressure_variance = 0; // should we make this a parameter?
         fix_float16(pkt.static_pressure_variance);
 
-        uint8_t buffer[UAVCAN_EQUIPMENT_AIR_DATA_STATICPRESSURE_MAX_SIZE];
-        uint16_t total_size = uavcan_equipment_air_data_StaticPressure_encode(&pkt, buffer);
-
-        canardBroadcast(&canard,
-                        UAVCAN_EQUIPMENT_AIR_DATA_STATICPRESSURE_SIGNATURE,
-                        UAVCAN_EQUIPMENT_AIR_DATA_STATICPRESSURE_ID,
-                        &transfer_id,
-                        CANARD_TRANSFER_PRIORITY_LOW,
-                        &buffer[0],
-                        total_size);
+        baro_press_pub.publish(uavcan_equipment_air_data_StaticPressure_encode(&pkt, baro_press_pub.buffer()));
     }
 
     {
@@ -1189,16 +1287,7 @@ void AP_Periph_FW::can_baro_update(void)
         fix_float16(pkt.static_temperature);
         fix_float16(pkt.static_temperature_variance);
 
-        uint8_t buffer[UAVCAN_EQUIPMENT_AIR_DATA_STATICTEMPERATURE_MAX_SIZE];
-        uint16_t total_size = uavcan_equipment_air_data_StaticTemperature_encode(&pkt, buffer);
-
-        canardBroadcast(&canard,
-                        UAVCAN_EQUIPMENT_AIR_DATA_STATICTEMPERATURE_SIGNATURE,
-                        UAVCAN_EQUIPMENT_AIR_DATA_STATICTEMPERATURE_ID,
-                        &transfer_id,
-                        CANARD_TRANSFER_PRIORITY_LOW,
-                        &buffer[0],
-                        total_size);
+        baro_temp_pub.publish(uavcan_equipment_air_data_StaticTemperature_encode(&pkt, baro_temp_pub.buffer()));
     }
 #endif // HAL_PERIPH_ENABLE_BARO
 }
@@ -1249,16 +1338,7 @@ void AP_Periph_FW::can_airspeed_update(void)
     pkt.differential_pressure_sensor_temperature = nanf("");
     pkt.pitot_temperature = nanf("");
 
-    uint8_t buffer[UAVCAN_EQUIPMENT_AIR_DATA_RAWAIRDATA_MAX_SIZE];
-    uint16_t total_size = uavcan_equipment_air_data_RawAirData_encode(&pkt, buffer);
-
-    canardBroadcast(&canard,
-                    UAVCAN_EQUIPMENT_AIR_DATA_RAWAIRDATA_SIGNATURE,
-                    UAVCAN_EQUIPMENT_AIR_DATA_RAWAIRDATA_ID,
-                    &transfer_id,
-                    CANARD_TRANSFER_PRIORITY_LOW,
-                    &buffer[0],
-                    total_size);
+    airspeed_pub.publish(uavcan_equipment_air_data_RawAirData_encode(&pkt, airspeed_pub.buffer()));
 #endif // HAL_PERIPH_ENABLE_AIRSPEED
 }
 
@@ -1324,16 +1404,7 @@ void AP_Periph_FW::can_rangefinder_update(void)
     pkt.range = dist_cm * 0.01;
     fix_float16(pkt.range);
 
-    uint8_t buffer[UAVCAN_EQUIPMENT_RANGE_SENSOR_MEASUREMENT_MAX_SIZE];
-    uint16_t total_size = uavcan_equipment_range_sensor_Measurement_encode(&pkt, buffer);
-
-    canardBroadcast(&canard,
-                    UAVCAN_EQUIPMENT_RANGE_SENSOR_MEASUREMENT_SIGNATURE,
-                    UAVCAN_EQUIPMENT_RANGE_SENSOR_MEASUREMENT_ID,
-                    &transfer_id,
-                    CANARD_TRANSFER_PRIORITY_LOW,
-                    &buffer[0],
-                    total_size);
+    rangefinder_pub.publish(uavcan_equipment_range_sensor_Measurement_encode(&pkt, rangefinder_pub.buffer()));
 #endif // HAL_PERIPH_ENABLE_RANGEFINDER
 }
 
@@ -0,0 +1,294 @@
+/*
+  on-target microbenchmarks
+
+  Runs a table of small benchmarks of library code that matters on
+  flight controllers and prints the cost of each in CPU cycles, so
+  boards can be compared directly. On ChibiOS the DWT cycle counter is
+  used, elsewhere cycles are worked out from the microsecond clock
+  and SYSCLK, or reported in nanoseconds if SYSCLK isn't known.
+
+  Each benchmark is run in batches. The fastest batch is the cost with
+  the least interference from interrupts and other threads, and the
+  mean shows what they add. Results are printed on the console, which
+  is USB on most boards, and repeat every few seconds.
+
+  To add a benchmark write a function doing the operation n times and
+  add it to the benchmarks[] table
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/matrixN_sym.h>
+#include <AP_HAL/utility/RingBuffer.h>
+#include <Filter/LowPassFilter2p.h>
+#include <Filter/NotchFilter.h>
+
+void setup();
+void loop();
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#ifdef STM32_SYS_CK
+static const uint32_t sysclk = STM32_SYS_CK;
+#elif defined(STM32_SYSCLK)
+static const uint32_t sysclk = STM32_SYSCLK;
+#else
+static const uint32_t sysclk = 0;
+#endif
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_CHIBIOS && defined(DWT_CTRL_CYCCNTENA_Msk)
+#define HAVE_CYCLE_COUNTER 1
+#else
+#define HAVE_CYCLE_COUNTER 0
+#endif
+
+static void cycle_counter_init(void)
+{
+#if HAVE_CYCLE_COUNTER
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+#if defined(__CORTEX_M) && __CORTEX_M == 7
+    // the DWT is locked after reset on the M7
+    DWT->LAR = 0xC5ACCE55;
+#endif
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+// cycles, or nanoseconds where SYSCLK isn't known. Only differences
+// are used, so wrapping doesn't matter
+static inline uint32_t get_cycles(void)
+{
+#if HAVE_CYCLE_COUNTER
+    return DWT->CYCCNT;
+#else
+    if (sysclk == 0) {
+        return uint32_t(AP_HAL::micros64() * 1000ULL);
+    }
+    return uint32_t(AP_HAL::micros64() * (sysclk / 1000000U));
+#endif
+}
+
+// results are written here so the compiler can't drop the work
+static volatile float sink_f;
+static volatile uint32_t sink_u32;
+
+// inputs are read from here so they aren't constant folded
+static volatile float input_f = 0.37f;
+
+/*
+  the benchmarks
+ */
+static void bm_empty(uint32_t n)
+{
+    for (uint32_t i=0; i<n; i++) {
+        sink_u32 = i;
+    }
+}
+
+static void bm_sqrtf(uint32_t n)
+{
+    float v = input_f;
+    for (uint32_t i=0; i<n; i++) {
+        sink_f = sqrtf(v + i);
+    }
+}
+
+static void bm_atan2f(uint32_t n)
+{
+    float v = input_f;
+    for (uint32_t i=0; i<n; i++) {
+        sink_f = atan2f(v, i + 1.0f);
+    }
+}
+
+static void bm_vector3_normalize(uint32_t n)
+{
+    Vector3f v{input_f, 2.0f, 3.0f};
+    for (uint32_t i=0; i<n; i++) {
+        v.x += 0.001f;
+        sink_f = v.normalized().x;
+    }
+}
+
+static void bm_matrix3_mul(uint32_t n)
+{
+    Matrix3f m;
+    m.from_euler(input_f, 0.2f, 0.3f);
+    Matrix3f r = m;
+    for (uint32_t i=0; i<n; i++) {
+        r = r * m;
+    }
+    sink_f = r.a.x;
+}
+
+static void bm_euler_from_dcm(uint32_t n)
+{
+    Matrix3f m;
+    m.from_euler(input_f, 0.2f, 0.3f);
+    float roll, pitch, yaw;
+    for (uint32_t i=0; i<n; i++) {
+        m.a.x += 1.0e-7f;
+        m.to_euler(&roll, &pitch, &yaw);
+        sink_f = roll;
+    }
+}
+
+static void bm_lpf2p_vector3f(uint32_t n)
+{
+    static LowPassFilter2pVector3f filter;
+    filter.set_cutoff_frequency(1000, 80);
+    Vector3f v{input_f, 0.2f, 0.3f};
+    for (uint32_t i=0; i<n; i++) {
+        v.x = -v.x;
+        sink_f = filter.apply(v).x;
+    }
+}
+
+static void bm_notch_vector3f(uint32_t n)
+{
+    static NotchFilterVector3f filter;
+    filter.init(1000, 80, 20, 15);
+    Vector3f v{input_f, 0.2f, 0.3f};
+    for (uint32_t i=0; i<n; i++) {
+        v.x = -v.x;
+        sink_f = filter.apply(v).x;
+    }
+}
+
+/*
+  one scalar fusion of the EKF3 covariance update, P -= K*(H*P), with
+  the magnetometer Jacobian sparsity over 24 states
+ */
+static void bm_ekf_covariance_fusion(uint32_t n)
+{
+    static SymMatrixN<float,24> P;
+    static const uint8_t idx[] = { 0, 1, 2, 3, 16, 17, 18, 19, 20, 21 };
+    float H[24] {};
+    float K[24];
+    float HP[24];
+    P.zero();
+    for (uint8_t i=0; i<24; i++) {
+        P[i][i] = 1.0f;
+        K[i] = input_f * 1.0e-3f;
+    }
+    for (uint8_t i=0; i<ARRAY_SIZE(idx); i++) {
+        H[idx[i]] = 0.1f * i;
+    }
+    for (uint32_t i=0; i<n; i++) {
+        P.sparse_vec_mul(HP, H, idx, ARRAY_SIZE(idx), 24);
+        P.sub_outer(K, HP, 24);
+    }
+    sink_f = P[0][0];
+}
+
+static uint8_t data_buf[256];
+
+static void bm_crc32_256(uint32_t n)
+{
+    for (uint32_t i=0; i<n; i++) {
+        sink_u32 = crc_crc32(i, data_buf, sizeof(data_buf));
+    }
+}
+
+static void bm_crc16_ccitt_256(uint32_t n)
+{
+    for (uint32_t i=0; i<n; i++) {
+        sink_u32 = crc16_ccitt(data_buf, sizeof(data_buf), i);
+    }
+}
+
+static void bm_bytebuffer_64(uint32_t n)
+{
+    static ByteBuffer buf(1024);
+    uint8_t tmp[64];
+    for (uint32_t i=0; i<n; i++) {
+        buf.write(data_buf, sizeof(tmp));
+        sink_u32 = buf.read(tmp, sizeof(tmp));
+    }
+}
+
+static void bm_snprintf_nmea(uint32_t n)
+{
+    char buf[100];
+    for (uint32_t i=0; i<n; i++) {
+        sink_u32 = hal.util->snprintf(buf, sizeof(buf), "$GPGGA,%02u%02u%05.2f,%09.4f,N,%010.4f,E,1,%02u,%.1f,%.1f,M,0,M,,",
+                                      12U, 34U, 56.78f, input_f + 3512.0f, 14907.0625f, 8U, 1.2f, 123.4f);
+    }
+}
+
+static const struct {
+    const char *name;
+    void (*fn)(uint32_t n);
+    uint16_t calls;   // calls per batch
+} benchmarks[] = {
+    { "empty",          bm_empty,                   1000 },
+    { "sqrtf",          bm_sqrtf,                   1000 },
+    { "atan2f",         bm_atan2f,                  200 },
+    { "v3f normalize",  bm_vector3_normalize,       500 },
+    { "m3f multiply",   bm_matrix3_mul,             500 },
+    { "m3f to_euler",   bm_euler_from_dcm,          200 },
+    { "lpf2p v3f",      bm_lpf2p_vector3f,          500 },
+    { "notch v3f",      bm_notch_vector3f,          500 },
+    { "ekf cov fusion", bm_ekf_covariance_fusion,   10 },
+    { "crc32 256",      bm_crc32_256,               20 },
+    { "crc16 256",      bm_crc16_ccitt_256,         20 },
+    { "bytebuf 64",     bm_bytebuffer_64,           100 },
+    { "snprintf nmea",  bm_snprintf_nmea,           20 },
+};
+
+// number of batches each benchmark is timed over
+#define NUM_BATCHES 20
+
+static void run_benchmarks(void)
+{
+#if HAVE_CYCLE_COUNTER || defined(STM32_SYS_CK) || defined(STM32_SYSCLK)
+    const char *unit = "cycles";
+#else
+    const char *unit = "ns";
+#endif
+    hal.console->printf("SYSCLK %uMHz, times in %s per call\n", unsigned(sysclk / 1000000U), unit);
+    hal.console->printf("%-16s %10s %10s %9s\n", "Benchmark", "Min", "Mean", "MinUS");
+    for (uint8_t b=0; b<ARRAY_SIZE(benchmarks); b++) {
+        const uint16_t calls = benchmarks[b].calls;
+        uint32_t min_cycles = UINT32_MAX;
+        uint64_t total_cycles = 0;
+        // the first batch warms up caches and static state
+        benchmarks[b].fn(calls);
+        for (uint8_t i=0; i<NUM_BATCHES; i++) {
+            const uint32_t start = get_cycles();
+            benchmarks[b].fn(calls);
+            const uint32_t cycles = get_cycles() - start;
+            min_cycles = MIN(min_cycles, cycles);
+            total_cycles += cycles;
+        }
+        const float min_per_call = float(min_cycles) / calls;
+        const float mean_per_call = float(total_cycles) / (NUM_BATCHES * calls);
+        const float min_us = sysclk ? min_per_call * 1.0e6f / sysclk : min_per_call * 1.0e-3f;
+        hal.console->printf("%-16s %10.1f %10.1f %9.3f\n",
+                            benchmarks[b].name,
+                            (double)min_per_call,
+                            (double)mean_per_call,
+                            (double)min_us);
+        // let the console drain
+        hal.scheduler->delay(5);
+    }
+}
+
+void setup()
+{
+    cycle_counter_init();
+    for (uint16_t i=0; i<sizeof(data_buf); i++) {
+        data_buf[i] = i * 37 + 11;
+    }
+}
+
+void loop()
+{
+    run_benchmarks();
+    hal.console->printf("\n");
+    hal.scheduler->delay(3000);
+}
+
+AP_HAL_MAIN();
@@ -2,6 +2,8 @@
 
 #include <fcntl.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <stdio.h>
 #include <unistd.h>
@@ -12,6 +14,9 @@
 #define PRIu64 "llu"
 #endif
 
+// size of the window read ahead of the current message in a mapped log
+#define LOGREADER_PREFETCH_SIZE (4U*1024U*1024U)
+
 // flogged from AP_Hal_Linux/system.cpp; we don't want to use stopped clock here
 uint64_t now() {
     struct timespec ts;
@@ -25,6 +30,11 @@ AP_LoggerFileReader::AP_LoggerFileReader() :
 
 AP_LoggerFileReader::~AP_LoggerFileReader()
 {
+    delete compress;
+    if (map != nullptr) {
+        munmap(map, map_len);
+    }
+
     const uint64_t micros = now();
     const uint64_t delta = micros - start_micros;
     ::printf("Replay counts: %" PRIu64 " bytes  %u entries\n", bytes_read, message_count);
@@ -37,16 +47,143 @@ bool AP_LoggerFileReader::open_log(const char *logfile)
     if (fd == -1) {
         return false;
     }
+
+    map_log();
+
+    // compressed logs start with their own header instead of a message
+    uint8_t hdr[LOG_COMPRESS_FILE_HEADER_LEN];
+    if (read_file(hdr, sizeof(hdr)) == sizeof(hdr) && LogCompress::is_compressed(hdr)) {
+        compress = new LogCompress();
+        compress->reset();
+        block_len = block_ofs = 0;
+        return true;
+    }
+    bytes_read = 0;
+    if (map != nullptr) {
+        map_ofs = 0;
+    } else if (::lseek(fd, 0, SEEK_SET) != 0) {
+        return false;
+    }
     return true;
 }
 
-ssize_t AP_LoggerFileReader::read_input(void *buffer, const size_t count)
+/*
+  map the whole log so uncompressed messages can be handed to the
+  handlers without copying them. Logs that can't be mapped (pipes,
+  empty files) are read with read()
+ */
+void AP_LoggerFileReader::map_log()
 {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        return;
+    }
+    void *p = mmap(nullptr, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+        return;
+    }
+    map = (uint8_t *)p;
+    map_len = st.st_size;
+    map_ofs = 0;
+    map_prefetch_ofs = 0;
+    madvise(map, map_len, MADV_SEQUENTIAL);
+}
+
+/*
+  ask for the next window of the log to be read in, and drop the
+  pages we have finished with so a multi-GB log doesn't fill memory
+ */
+void AP_LoggerFileReader::prefetch()
+{
+    if (map_ofs < map_prefetch_ofs) {
+        return;
+    }
+    const size_t window_ofs = map_ofs - map_ofs % LOGREADER_PREFETCH_SIZE;
+    if (window_ofs >= LOGREADER_PREFETCH_SIZE) {
+        // keep the previous window, which holds the current message
+        madvise(map, window_ofs - LOGREADER_PREFETCH_SIZE, MADV_DONTNEED);
+    }
+    const size_t len = MIN(size_t(2*LOGREADER_PREFETCH_SIZE), map_len - window_ofs);
+    madvise(map + window_ofs, len, MADV_WILLNEED);
+    map_prefetch_ofs = window_ofs + LOGREADER_PREFETCH_SIZE;
+}
+
+ssize_t AP_LoggerFileReader::read_file(void *buffer, const size_t count)
+{
+    if (map != nullptr) {
+        const size_t n = MIN(count, map_len - map_ofs);
+        memcpy(buffer, &map[map_ofs], n);
+        map_ofs += n;
+        bytes_read += n;
+        prefetch();
+        return n;
+    }
     uint64_t ret = ::read(fd, buffer, count);
     bytes_read += ret;
     return ret;
 }
 
+bool AP_LoggerFileReader::read_frame()
+{
+    uint8_t hdr[LOG_COMPRESS_FRAME_HEADER_LEN];
+    if (read_file(hdr, sizeof(hdr)) != sizeof(hdr)) {
+        return false;
+    }
+    uint16_t raw_len, comp_len;
+    LogCompress::frame_lengths(hdr, raw_len, comp_len);
+    if (raw_len > sizeof(block) || comp_len > raw_len) {
+        ::printf("bad compressed frame\n");
+        return false;
+    }
+    uint8_t data[comp_len];
+    if (read_file(data, comp_len) != comp_len) {
+        return false;
+    }
+    if (!compress->decompress(data, comp_len, block, raw_len)) {
+        ::printf("bad compressed frame\n");
+        return false;
+    }
+    block_len = raw_len;
+    block_ofs = 0;
+    return true;
+}
+
+ssize_t AP_LoggerFileReader::read_input(void *buffer, const size_t count)
+{
+    if (compress == nullptr) {
+        return read_file(buffer, count);
+    }
+    size_t done = 0;
+    while (done < count) {
+        if (block_ofs == block_len && !read_frame()) {
+            break;
+        }
+        const size_t n = MIN(count - done, size_t(block_len - block_ofs));
+        memcpy((uint8_t *)buffer + done, &block[block_ofs], n);
+        block_ofs += n;
+        done += n;
+    }
+    return done;
+}
+
+uint8_t *AP_LoggerFileReader::input_msg(uint8_t *buf, const size_t count)
+{
+    if (map != nullptr && compress == nullptr) {
+        if (count > map_len - map_ofs) {
+            return nullptr;
+        }
+        uint8_t *ret = &map[map_ofs];
+        map_ofs += count;
+        bytes_read += count;
+        prefetch();
+        return ret;
+    }
+    if (read_input(buf, count) != ssize_t(count)) {
+        return nullptr;
+    }
+    return buf;
+}
+
 void AP_LoggerFileReader::format_type(uint16_t type, char dest[5])
 {
     const struct log_Format &f = formats[type];
@@ -63,23 +200,26 @@ void AP_LoggerFileReader::get_packet_counts(uint64_t dest[])
 
 bool AP_LoggerFileReader::update(char type[5])
 {
-    uint8_t hdr[3];
-    if (read_input(hdr, 3) != 3) {
+    // the header and body of a message are contiguous both in the
+    // mapped log and in buf
+    uint8_t buf[UINT8_MAX];
+    uint8_t *msg = input_msg(buf, 3);
+    if (msg == nullptr) {
         return false;
     }
-    if (hdr[0] != HEAD_BYTE1 || hdr[1] != HEAD_BYTE2) {
+    if (msg[0] != HEAD_BYTE1 || msg[1] != HEAD_BYTE2) {
         printf("bad log header\n");
         return false;
     }
 
-    packet_counts[hdr[2]]++;
+    packet_counts[msg[2]]++;
 
-    if (hdr[2] == LOG_FORMAT_MSG) {
+    if (msg[2] == LOG_FORMAT_MSG) {
         struct log_Format f;
-        memcpy(&f, hdr, 3);
-        if (read_input(&f.type, sizeof(f)-3) != sizeof(f)-3) {
+        if (input_msg(&buf[3], sizeof(f)-3) == nullptr) {
             return false;
         }
+        memcpy(&f, msg, sizeof(f));
         memcpy(&formats[f.type], &f, sizeof(formats[f.type]));
         strncpy(type, "FMT", 3);
         type[3] = 0;
@@ -88,18 +228,15 @@ bool AP_LoggerFileReader::update(char type[5])
         return handle_log_format_msg(f);
     }
 
-    const struct log_Format &f = formats[hdr[2]];
+    const struct log_Format &f = formats[msg[2]];
     if (f.length == 0) {
         // can't just throw these away as the format specifies the
         // number of bytes in the message
-        ::printf("No format defined for type (%d)\n", hdr[2]);
+        ::printf("No format defined for type (%d)\n", msg[2]);
         exit(1);
     }
 
-    uint8_t msg[f.length];
-
-    memcpy(msg, hdr, 3);
-    if (read_input(&msg[3], f.length-3) != f.length-3) {
+    if (f.length < 3 || input_msg(&buf[3], f.length-3) == nullptr) {
         return false;
     }
 
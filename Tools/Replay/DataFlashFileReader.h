@@ -1,6 +1,7 @@
 #pragma once
 
 #include <AP_Logger/AP_Logger.h>
+#include <AP_Logger/LogCompress.h>
 
 #define LOGREADER_MAX_FORMATS 255 // must be >= highest MESSAGE
 
@@ -27,6 +28,30 @@ protected:
 
 private:
     ssize_t read_input(void *buf, size_t count);
+    ssize_t read_file(void *buf, size_t count);
+    // returns count bytes of the next message, in place in the
+    // mapped log if possible, else read into buf
+    uint8_t *input_msg(uint8_t *buf, size_t count);
+    // map the log into memory if it is a regular file
+    void map_log();
+    // hint the kernel to read ahead of map_ofs
+    void prefetch();
+    // refill block from the next frame of a compressed log
+    bool read_frame();
+
+    // set if the log was written compressed
+    LogCompress *compress = nullptr;
+    uint8_t block[LOG_COMPRESS_MAX_BLOCK];
+    uint16_t block_len = 0;
+    uint16_t block_ofs = 0;
+
+    // the log mapped into memory, or nullptr to use read(). Mapped
+    // private and writable as handlers may modify messages
+    uint8_t *map = nullptr;
+    size_t map_len = 0;
+    size_t map_ofs = 0;
+    // offset at which to next call prefetch()
+    size_t map_prefetch_ofs = 0;
 
     uint64_t bytes_read = 0;
     uint32_t message_count = 0;
@@ -153,6 +153,14 @@ void Replay::usage(void)
     ::printf("\t--no-params        don't use parameters from the log\n");
     ::printf("\t--no-fpe           do not generate floating point exceptions\n");
     ::printf("\t--packet-counts    print packet counts at end of processing\n");
+    ::printf("\t--stats-file FILE  write EKF innovation and timing statistics to FILE\n");
+    ::printf("\t--batch            replay all the logs given on the command line\n");
+    ::printf("\t--batch-list FILE  replay all the logs listed in FILE, one per line\n");
+    ::printf("\t--batch-dir DIR    directory for batch output (default replay_batch)\n");
+    ::printf("\t--jobs N           number of logs to replay at once (default number of CPUs)\n");
+    ::printf("\t--sweep FILE       also run EKF3 with each set of parameters in FILE\n");
+    ::printf("\t--sweep-threads N  number of threads for the sweep (default number of CPUs)\n");
+    ::printf("\t--sweep-out FILE   file for the sweep summary (default sweep_summary.txt)\n");
 }
 
 
@@ -169,6 +177,14 @@ enum {
     OPT_PARAM_FILE,
     OPT_NO_FPE,
     OPT_PACKET_COUNTS,
+    OPT_STATS_FILE,
+    OPT_BATCH,
+    OPT_BATCH_LIST,
+    OPT_BATCH_DIR,
+    OPT_JOBS,
+    OPT_SWEEP,
+    OPT_SWEEP_THREADS,
+    OPT_SWEEP_OUT,
 };
 
 void Replay::flush_logger(void) {
@@ -226,6 +242,14 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
         {"no-params",       false,  0, OPT_NOPARAMS},
         {"no-fpe",          false,  0, OPT_NO_FPE},
         {"packet-counts",   false,  0, OPT_PACKET_COUNTS},
+        {"stats-file",      true,   0, OPT_STATS_FILE},
+        {"batch",           false,  0, OPT_BATCH},
+        {"batch-list",      true,   0, OPT_BATCH_LIST},
+        {"batch-dir",       true,   0, OPT_BATCH_DIR},
+        {"jobs",            true,   0, OPT_JOBS},
+        {"sweep",           true,   0, OPT_SWEEP},
+        {"sweep-threads",   true,   0, OPT_SWEEP_THREADS},
+        {"sweep-out",       true,   0, OPT_SWEEP_OUT},
         {0, false, 0, 0}
     };
 
@@ -313,6 +337,39 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
             packet_counts = true;
             break;
 
+        case OPT_STATS_FILE:
+            stats_filename = gopt.optarg;
+            break;
+
+        case OPT_BATCH:
+            batch = true;
+            break;
+
+        case OPT_BATCH_LIST:
+            batch = true;
+            batch_list = gopt.optarg;
+            break;
+
+        case OPT_BATCH_DIR:
+            batch_dir = gopt.optarg;
+            break;
+
+        case OPT_JOBS:
+            batch_jobs = strtoul(gopt.optarg, NULL, 0);
+            break;
+
+        case OPT_SWEEP:
+            sweep_filename = gopt.optarg;
+            break;
+
+        case OPT_SWEEP_THREADS:
+            sweep_threads = strtoul(gopt.optarg, NULL, 0);
+            break;
+
+        case OPT_SWEEP_OUT:
+            sweep_out = gopt.optarg;
+            break;
+
         case 'h':
         default:
             usage();
@@ -320,6 +377,21 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
         }
     }
 
+    if (batch) {
+        // each log is replayed by a copy of Replay given the same
+        // options, so this process never replays a log itself
+        ReplayBatch replay_batch(batch_dir, batch_jobs);
+        if (batch_list != nullptr && !replay_batch.add_list(batch_list)) {
+            exit(1);
+        }
+        for (int i=gopt.optind; i<argc; i++) {
+            if (!replay_batch.add_log(argv[i])) {
+                exit(1);
+            }
+        }
+        exit(replay_batch.run(argc, argv, gopt.optind));
+    }
+
 	argv += gopt.optind;
 	argc -= gopt.optind;
 
@@ -534,6 +606,14 @@ void Replay::setup()
 
     _vehicle.setup();
 
+    if (sweep_filename != nullptr) {
+        sweep = new ReplaySweep(&_vehicle.ahrs, _vehicle.rng);
+        if (sweep == nullptr || !sweep->load(sweep_filename)) {
+            exit(1);
+        }
+        sweep->set_threads(sweep_threads);
+    }
+
     inhibit_gyro_cal();
     force_log_disarmed();
 
@@ -695,7 +775,14 @@ void Replay::read_sensors(const char *type)
     }
     
     if (run_ahrs) {
+        struct timespec ts0, ts1;
+        clock_gettime(CLOCK_MONOTONIC, &ts0);
         _vehicle.ahrs.update();
+        clock_gettime(CLOCK_MONOTONIC, &ts1);
+        update_stats((ts1.tv_sec - ts0.tv_sec) * 1000000U + (ts1.tv_nsec - ts0.tv_nsec) / 1000);
+        if (sweep != nullptr) {
+            sweep->update(_vehicle.EKF3);
+        }
         if ((downsample == 0 || ++output_counter % downsample == 0) && !logmatch) {
             write_ekf_logs();
         }
@@ -778,10 +865,42 @@ void Replay::log_check_solution(void)
     check_result.max_pos_error   = MAX(check_result.max_pos_error,   pos_error);
 }
 
+/*
+  record the time taken by an AHRS update and the EKF innovations
+ */
+void Replay::update_stats(uint32_t update_us)
+{
+    if (stats_filename == nullptr) {
+        return;
+    }
+    stats.update_time(update_us);
+
+    float ratios[ReplayStats::INNOV_NUM];
+    Vector3f mag_var;
+    Vector2f offset;
+    if (_vehicle.ahrs.get_variances(ratios[ReplayStats::INNOV_VEL],
+                                    ratios[ReplayStats::INNOV_POS],
+                                    ratios[ReplayStats::INNOV_HGT],
+                                    mag_var,
+                                    ratios[ReplayStats::INNOV_TAS],
+                                    offset)) {
+        ratios[ReplayStats::INNOV_MAG] = mag_var.length();
+        stats.update_innovations(ratios);
+    }
+}
+
 void Replay::flush_and_exit()
 {
     flush_logger();
 
+    if (stats_filename != nullptr && !stats.save(stats_filename)) {
+        ::fprintf(stderr, "Failed to write %s: %m\n", stats_filename);
+    }
+
+    if (sweep != nullptr) {
+        write_sweep_summary();
+    }
+
     if (check_solution) {
         report_checks();
     }
@@ -793,6 +912,18 @@ void Replay::flush_and_exit()
     exit(0);
 }
 
+void Replay::write_sweep_summary(void)
+{
+    FILE *f = fopen(sweep_out, "w");
+    if (f == nullptr) {
+        ::fprintf(stderr, "Failed to write %s: %m\n", sweep_out);
+    } else {
+        sweep->write_summary(f);
+        fclose(f);
+    }
+    sweep->write_summary(stdout);
+}
+
 void Replay::show_packet_counts()
 {
     uint64_t counts[LOGREADER_MAX_FORMATS];
@@ -48,6 +48,8 @@
 #include <signal.h>
 #include <unistd.h>
 #include <AP_HAL/utility/getopt_cpp.h>
+#include "ReplayBatch.h"
+#include "ReplaySweep.h"
 
 class ReplayVehicle {
 public:
@@ -150,6 +152,24 @@ private:
     uint64_t last_timestamp = 0;
     bool packet_counts = false;
 
+    // batch mode options
+    bool batch = false;
+    const char *batch_list = nullptr;
+    const char *batch_dir = "replay_batch";
+    uint16_t batch_jobs = 0;
+
+    // statistics written to stats_filename at the end of the log
+    const char *stats_filename = nullptr;
+    ReplayStats stats {};
+    void update_stats(uint32_t update_us);
+
+    // EKF3 parameter sweep, run alongside the replayed EKF
+    const char *sweep_filename = nullptr;
+    const char *sweep_out = "sweep_summary.txt";
+    uint16_t sweep_threads = 0;
+    ReplaySweep *sweep = nullptr;
+    void write_sweep_summary(void);
+
     struct {
         float max_roll_error;
         float max_pitch_error;
@@ -0,0 +1,467 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ReplayBatch.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define streq(x, y) (!strcmp(x, y))
+
+// name of the stats file each worker writes in its directory
+#define REPLAY_BATCH_STATS_FILE "replay_stats.txt"
+
+const char *ReplayStats::innov_name(uint8_t i)
+{
+    static const char *names[INNOV_NUM] = { "Vel", "Pos", "Hgt", "Mag", "Tas" };
+    return i < INNOV_NUM ? names[i] : "";
+}
+
+void ReplayStats::update_time(uint32_t dt_us)
+{
+    updates++;
+    update_time_us += dt_us;
+    if (dt_us > update_time_max_us) {
+        update_time_max_us = dt_us;
+    }
+}
+
+void ReplayStats::update_innovations(const float ratios[INNOV_NUM])
+{
+    innov_count++;
+    for (uint8_t i=0; i<INNOV_NUM; i++) {
+        innov_sum[i] += ratios[i];
+        if (ratios[i] > innov_max[i]) {
+            innov_max[i] = ratios[i];
+        }
+        if (ratios[i] > 1) {
+            innov_over[i]++;
+        }
+    }
+}
+
+void ReplayStats::add(const ReplayStats &other)
+{
+    updates += other.updates;
+    update_time_us += other.update_time_us;
+    if (other.update_time_max_us > update_time_max_us) {
+        update_time_max_us = other.update_time_max_us;
+    }
+    innov_count += other.innov_count;
+    for (uint8_t i=0; i<INNOV_NUM; i++) {
+        innov_sum[i] += other.innov_sum[i];
+        if (other.innov_max[i] > innov_max[i]) {
+            innov_max[i] = other.innov_max[i];
+        }
+        innov_over[i] += other.innov_over[i];
+    }
+}
+
+float ReplayStats::mean_update_us() const
+{
+    return updates ? float(update_time_us) / updates : 0;
+}
+
+float ReplayStats::mean_innovation(uint8_t i) const
+{
+    return innov_count ? innov_sum[i] / innov_count : 0;
+}
+
+float ReplayStats::fraction_over(uint8_t i) const
+{
+    return innov_count ? float(innov_over[i]) / innov_count : 0;
+}
+
+/*
+  stats files hold one "name value" pair per line
+ */
+bool ReplayStats::save(const char *filename) const
+{
+    FILE *f = fopen(filename, "w");
+    if (f == nullptr) {
+        return false;
+    }
+    fprintf(f, "updates %u\n", (unsigned)updates);
+    fprintf(f, "update_time_us %llu\n", (unsigned long long)update_time_us);
+    fprintf(f, "update_time_max_us %u\n", (unsigned)update_time_max_us);
+    fprintf(f, "innov_count %u\n", (unsigned)innov_count);
+    for (uint8_t i=0; i<INNOV_NUM; i++) {
+        fprintf(f, "innov_sum_%s %f\n", innov_name(i), innov_sum[i]);
+        fprintf(f, "innov_max_%s %f\n", innov_name(i), (double)innov_max[i]);
+        fprintf(f, "innov_over_%s %u\n", innov_name(i), (unsigned)innov_over[i]);
+    }
+    return fclose(f) == 0;
+}
+
+bool ReplayStats::load(const char *filename)
+{
+    FILE *f = fopen(filename, "r");
+    if (f == nullptr) {
+        return false;
+    }
+    *this = {};
+    char name[32];
+    double value;
+    while (fscanf(f, "%31s %lf", name, &value) == 2) {
+        if (streq(name, "updates")) {
+            updates = value;
+        } else if (streq(name, "update_time_us")) {
+            update_time_us = value;
+        } else if (streq(name, "update_time_max_us")) {
+            update_time_max_us = value;
+        } else if (streq(name, "innov_count")) {
+            innov_count = value;
+        }
+        for (uint8_t i=0; i<INNOV_NUM; i++) {
+            if (strncmp(name, "innov_sum_", 10) == 0 && streq(&name[10], innov_name(i))) {
+                innov_sum[i] = value;
+            } else if (strncmp(name, "innov_max_", 10) == 0 && streq(&name[10], innov_name(i))) {
+                innov_max[i] = value;
+            } else if (strncmp(name, "innov_over_", 11) == 0 && streq(&name[11], innov_name(i))) {
+                innov_over[i] = value;
+            }
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+ReplayBatch::ReplayBatch(const char *dir, uint16_t jobs) :
+    _dir(dir),
+    _max_running(jobs)
+{
+    if (_max_running == 0) {
+        const long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        _max_running = ncpu > 0 ? ncpu : 1;
+    }
+}
+
+ReplayBatch::~ReplayBatch()
+{
+    for (uint32_t i=0; i<_num_jobs; i++) {
+        free(_jobs[i].filename);
+    }
+    free(_jobs);
+    free(_worker_argv);
+}
+
+bool ReplayBatch::add_log(const char *filename)
+{
+    if (_num_jobs == _jobs_alloc) {
+        const uint32_t new_alloc = _jobs_alloc ? _jobs_alloc * 2 : 64;
+        struct job *jobs = (struct job *)realloc(_jobs, new_alloc * sizeof(struct job));
+        if (jobs == nullptr) {
+            return false;
+        }
+        _jobs = jobs;
+        _jobs_alloc = new_alloc;
+    }
+    struct job &j = _jobs[_num_jobs];
+    j = {};
+    j.pid = -1;
+    // workers run in their own directory
+    char path[PATH_MAX];
+    if (realpath(filename, path) != nullptr) {
+        j.filename = strdup(path);
+    } else {
+        ::fprintf(stderr, "%s: %s\n", filename, strerror(errno));
+        j.filename = strdup(filename);
+        j.status = -1;
+    }
+    if (j.filename == nullptr) {
+        return false;
+    }
+    _num_jobs++;
+    return true;
+}
+
+bool ReplayBatch::add_list(const char *filename)
+{
+    FILE *f = fopen(filename, "r");
+    if (f == nullptr) {
+        ::fprintf(stderr, "Failed to open log list %s: %s\n", filename, strerror(errno));
+        return false;
+    }
+    char line[PATH_MAX];
+    bool ret = true;
+    while (ret && fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = 0;
+        if (line[0] == 0 || line[0] == '#') {
+            continue;
+        }
+        ret = add_log(line);
+    }
+    fclose(f);
+    return ret;
+}
+
+bool ReplayBatch::is_batch_option(const char *arg, bool &takes_value)
+{
+    static const struct {
+        const char *name;
+        bool takes_value;
+    } options[] = {
+        { "--batch", false },
+        { "--batch-list", true },
+        { "--batch-dir", true },
+        { "--jobs", true },
+        { "--stats-file", true },
+    };
+    for (const auto &opt : options) {
+        const size_t len = strlen(opt.name);
+        if (strncmp(arg, opt.name, len) != 0) {
+            continue;
+        }
+        if (arg[len] == 0) {
+            takes_value = opt.takes_value;
+            return true;
+        }
+        if (arg[len] == '=') {
+            takes_value = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t ReplayBatch::now_us()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000U;
+}
+
+/*
+  start the worker for a log in its own directory, with its output
+  going to replay.out there
+ */
+bool ReplayBatch::start_job(uint32_t idx)
+{
+    struct job &j = _jobs[idx];
+    char dir[PATH_MAX];
+    snprintf(dir, sizeof(dir), "%s/%04u", _dir, (unsigned)idx+1);
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        ::fprintf(stderr, "Failed to create %s: %s\n", dir, strerror(errno));
+        return false;
+    }
+    // don't pick up the results of an earlier run
+    char stats_file[PATH_MAX+20];
+    snprintf(stats_file, sizeof(stats_file), "%s/" REPLAY_BATCH_STATS_FILE, dir);
+    unlink(stats_file);
+
+    // the last two arguments are left for the log
+    uint32_t argc = 0;
+    while (_worker_argv[argc] != nullptr) {
+        argc++;
+    }
+    _worker_argv[argc-1] = j.filename;
+
+    j.start_us = now_us();
+    j.pid = fork();
+    if (j.pid == -1) {
+        ::fprintf(stderr, "fork failed: %s\n", strerror(errno));
+        return false;
+    }
+    if (j.pid == 0) {
+        // only async-signal-safe calls until the exec
+        if (chdir(dir) != 0) {
+            _exit(126);
+        }
+        const int fd = open("replay.out", O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, 0644);
+        if (fd != -1) {
+            dup2(fd, 1);
+            dup2(fd, 2);
+        }
+        execv("/proc/self/exe", _worker_argv);
+        _exit(127);
+    }
+    return true;
+}
+
+void ReplayBatch::finish_job(pid_t pid, int status)
+{
+    for (uint32_t i=0; i<_num_jobs; i++) {
+        struct job &j = _jobs[i];
+        if (j.pid != pid) {
+            continue;
+        }
+        j.pid = -1;
+        j.status = status;
+        j.wall_us = now_us() - j.start_us;
+        char stats_file[PATH_MAX+20];
+        snprintf(stats_file, sizeof(stats_file), "%s/%04u/" REPLAY_BATCH_STATS_FILE, _dir, (unsigned)i+1);
+        j.have_stats = j.stats.load(stats_file);
+        char result[20];
+        result_string(j, result, sizeof(result));
+        ::printf("[%u/%u] %s %s %.1fs\n", (unsigned)i+1, (unsigned)_num_jobs,
+                 j.filename, result, j.wall_us*1.0e-6);
+        return;
+    }
+}
+
+void ReplayBatch::result_string(const struct job &j, char *buf, uint8_t len)
+{
+    if (j.status == -1) {
+        snprintf(buf, len, "missing");
+    } else if (WIFSIGNALED(j.status)) {
+        snprintf(buf, len, "signal-%d", WTERMSIG(j.status));
+    } else if (WEXITSTATUS(j.status) == 0) {
+        snprintf(buf, len, "ok");
+    } else if (WEXITSTATUS(j.status) == 1 && j.have_stats) {
+        // --check reports failure with an exit code of 1
+        snprintf(buf, len, "check-failed");
+    } else {
+        snprintf(buf, len, "exit-%d", WEXITSTATUS(j.status));
+    }
+}
+
+int ReplayBatch::run(int argc, char * const argv[], int first_log)
+{
+    if (_num_jobs == 0) {
+        ::fprintf(stderr, "No logs to replay\n");
+        return 1;
+    }
+    if (mkdir(_dir, 0755) != 0 && errno != EEXIST) {
+        ::fprintf(stderr, "Failed to create %s: %s\n", _dir, strerror(errno));
+        return 1;
+    }
+
+    // worker arguments are ours without the batch options or logs
+    _worker_argv = (char **)calloc(first_log + 5, sizeof(char *));
+    if (_worker_argv == nullptr) {
+        return 1;
+    }
+    uint32_t n = 0;
+    // our argv[0] is the "--" separating the HAL options
+    _worker_argv[n++] = (char *)"Replay";
+    _worker_argv[n++] = (char *)"--";
+    for (int i=1; i<first_log; i++) {
+        bool takes_value;
+        if (is_batch_option(argv[i], takes_value)) {
+            if (takes_value) {
+                i++;
+            }
+            continue;
+        }
+        _worker_argv[n++] = argv[i];
+    }
+    _worker_argv[n++] = (char *)"--stats-file=" REPLAY_BATCH_STATS_FILE;
+    // filled in with each log by start_job()
+    _worker_argv[n++] = (char *)"";
+
+    ::printf("Replaying %u logs with %u workers in %s\n",
+             (unsigned)_num_jobs, (unsigned)_max_running, _dir);
+
+    const uint64_t start_us = now_us();
+    uint32_t next = 0;
+    uint16_t running = 0;
+    while (next < _num_jobs || running > 0) {
+        while (running < _max_running && next < _num_jobs) {
+            const uint32_t idx = next++;
+            if (_jobs[idx].status == -1) {
+                continue;
+            }
+            if (!start_job(idx)) {
+                _jobs[idx].status = -1;
+                continue;
+            }
+            running++;
+        }
+        if (running == 0) {
+            break;
+        }
+        int status;
+        const pid_t pid = waitpid(-1, &status, 0);
+        if (pid == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ::fprintf(stderr, "waitpid failed: %s\n", strerror(errno));
+            return 1;
+        }
+        finish_job(pid, status);
+        running--;
+    }
+    const uint64_t elapsed_us = now_us() - start_us;
+
+    char summary_file[PATH_MAX];
+    snprintf(summary_file, sizeof(summary_file), "%s/summary.txt", _dir);
+    FILE *f = fopen(summary_file, "w");
+    if (f != nullptr) {
+        write_summary(f, elapsed_us);
+        fclose(f);
+    }
+    write_summary(stdout, elapsed_us);
+
+    for (uint32_t i=0; i<_num_jobs; i++) {
+        if (_jobs[i].status != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+  write a line for each log and one for all of them together. The
+  innovation columns are the mean and max EKF test ratios
+ */
+void ReplayBatch::write_summary(FILE *f, uint64_t elapsed_us) const
+{
+    fprintf(f, "%-4s %-12s %8s %8s %7s %7s", "Num", "Result", "Wall(s)", "Updates", "Upd(us)", "Max(us)");
+    for (uint8_t i=0; i<ReplayStats::INNOV_NUM; i++) {
+        fprintf(f, " %5s %6s", ReplayStats::innov_name(i), "Max");
+    }
+    fprintf(f, " Log\n");
+
+    ReplayStats total {};
+    uint64_t total_wall_us = 0;
+    uint32_t num_ok = 0;
+    for (uint32_t n=0; n<_num_jobs; n++) {
+        const struct job &j = _jobs[n];
+        char result[20];
+        result_string(j, result, sizeof(result));
+        fprintf(f, "%04u %-12s %8.1f %8u %7.1f %7u", (unsigned)n+1, result,
+                j.wall_us*1.0e-6, (unsigned)j.stats.updates,
+                (double)j.stats.mean_update_us(), (unsigned)j.stats.update_time_max_us);
+        for (uint8_t i=0; i<ReplayStats::INNOV_NUM; i++) {
+            fprintf(f, " %5.2f %6.2f", (double)j.stats.mean_innovation(i), (double)j.stats.innov_max[i]);
+        }
+        fprintf(f, " %s\n", j.filename);
+        if (j.have_stats) {
+            total.add(j.stats);
+        }
+        if (j.status == 0) {
+            num_ok++;
+        }
+        total_wall_us += j.wall_us;
+    }
+
+    char result[20];
+    snprintf(result, sizeof(result), "%u/%u-ok", (unsigned)num_ok, (unsigned)_num_jobs);
+    fprintf(f, "%-4s %-12s %8.1f %8u %7.1f %7u", "ALL", result,
+            total_wall_us*1.0e-6, (unsigned)total.updates,
+            (double)total.mean_update_us(), (unsigned)total.update_time_max_us);
+    for (uint8_t i=0; i<ReplayStats::INNOV_NUM; i++) {
+        fprintf(f, " %5.2f %6.2f", (double)total.mean_innovation(i), (double)total.innov_max[i]);
+    }
+    fprintf(f, "\nElapsed %.1fs with %u workers\n", elapsed_us*1.0e-6, (unsigned)_max_running);
+}
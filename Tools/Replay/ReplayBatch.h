@@ -0,0 +1,108 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+/*
+  statistics gathered while replaying one log, written by Replay with
+  --stats-file and combined by ReplayBatch
+ */
+class ReplayStats {
+public:
+    // EKF innovation test ratios
+    enum {
+        INNOV_VEL,
+        INNOV_POS,
+        INNOV_HGT,
+        INNOV_MAG,
+        INNOV_TAS,
+        INNOV_NUM
+    };
+    static const char *innov_name(uint8_t i);
+
+    void update_time(uint32_t dt_us);
+    void update_innovations(const float ratios[INNOV_NUM]);
+
+    // combine stats from another log
+    void add(const ReplayStats &other);
+
+    bool save(const char *filename) const;
+    bool load(const char *filename);
+
+    float mean_update_us() const;
+    float mean_innovation(uint8_t i) const;
+    // fraction of test ratios over 1, which the EKF rejects
+    float fraction_over(uint8_t i) const;
+
+    uint32_t updates;
+    uint64_t update_time_us;
+    uint32_t update_time_max_us;
+    uint32_t innov_count;
+    double innov_sum[INNOV_NUM];
+    float innov_max[INNOV_NUM];
+    uint32_t innov_over[INNOV_NUM];
+};
+
+/*
+  replay a list of logs, each in its own Replay process so they share
+  no vehicle state, running up to jobs of them at once
+ */
+class ReplayBatch {
+public:
+    ReplayBatch(const char *dir, uint16_t jobs);
+    ~ReplayBatch();
+
+    bool add_log(const char *filename);
+    // add logs listed one per line in filename
+    bool add_list(const char *filename);
+
+    /*
+      run the logs, passing each worker the options in argv[1] to
+      argv[first_log-1] other than the batch options. Returns the exit
+      code for Replay
+     */
+    int run(int argc, char * const argv[], int first_log);
+
+    // true if arg is a batch option, setting takes_value if it is
+    // followed by its value
+    static bool is_batch_option(const char *arg, bool &takes_value);
+
+private:
+    struct job {
+        char *filename;
+        pid_t pid;
+        uint64_t start_us;
+        uint64_t wall_us;
+        int status;
+        bool have_stats;
+        ReplayStats stats;
+    } *_jobs = nullptr;
+    uint32_t _num_jobs = 0;
+    uint32_t _jobs_alloc = 0;
+
+    const char *_dir;
+    uint16_t _max_running;
+
+    char **_worker_argv = nullptr;
+
+    bool start_job(uint32_t idx);
+    void finish_job(pid_t pid, int status);
+    void write_summary(FILE *f, uint64_t elapsed_us) const;
+    static void result_string(const struct job &j, char *buf, uint8_t len);
+    static uint64_t now_us();
+};
@@ -0,0 +1,329 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ReplaySweep.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+extern const AP_HAL::HAL& hal;
+
+bool ReplaySweep::load(const char *filename)
+{
+    FILE *f = fopen(filename, "r");
+    if (f == nullptr) {
+        ::fprintf(stderr, "Failed to open sweep file %s: %s\n", filename, strerror(errno));
+        return false;
+    }
+    char line[1024];
+    uint32_t line_num = 0;
+    bool ret = true;
+    while (ret && fgets(line, sizeof(line), f)) {
+        line_num++;
+        line[strcspn(line, "\r\n")] = 0;
+        const char *p = &line[strspn(line, " \t")];
+        if (*p == 0 || *p == '#') {
+            continue;
+        }
+        ret = parse_line(line, line_num);
+    }
+    fclose(f);
+    if (ret && _num_configs == 0) {
+        ::fprintf(stderr, "No configurations in %s\n", filename);
+        ret = false;
+    }
+    return ret;
+}
+
+/*
+  parse a line of the sweep file, adding a configuration for each
+  combination of the values on it
+ */
+bool ReplaySweep::parse_line(char *line, uint32_t line_num)
+{
+    struct {
+        char name[AP_MAX_NAME_SIZE+1];
+        float values[max_values];
+        uint8_t num_values;
+    } axes[max_overrides];
+    uint8_t num_axes = 0;
+    char name[32];
+    snprintf(name, sizeof(name), "cfg%u", (unsigned)_num_configs+1);
+
+    char *saveptr = nullptr;
+    for (char *tok = strtok_r(line, " \t", &saveptr); tok; tok = strtok_r(nullptr, " \t", &saveptr)) {
+        char *eq = strchr(tok, '=');
+        if (eq == nullptr) {
+            // the name of the configuration
+            snprintf(name, sizeof(name), "%s", tok);
+            continue;
+        }
+        *eq = 0;
+        const char *pname = tok;
+        if (strncmp(pname, "EK3_", 4) == 0) {
+            pname += 4;
+        }
+        if (find_param(pname) == nullptr) {
+            ::fprintf(stderr, "line %u: unknown EKF3 parameter %s\n", (unsigned)line_num, tok);
+            return false;
+        }
+        if (num_axes == max_overrides) {
+            ::fprintf(stderr, "line %u: too many parameters, the most is %u\n", (unsigned)line_num, max_overrides);
+            return false;
+        }
+        auto &axis = axes[num_axes++];
+        snprintf(axis.name, sizeof(axis.name), "%s", pname);
+        axis.num_values = 0;
+        char *vsaveptr = nullptr;
+        for (char *v = strtok_r(eq+1, ",", &vsaveptr); v; v = strtok_r(nullptr, ",", &vsaveptr)) {
+            char *end;
+            const float value = strtof(v, &end);
+            if (end == v || *end != 0) {
+                ::fprintf(stderr, "line %u: bad value %s for %s\n", (unsigned)line_num, v, tok);
+                return false;
+            }
+            if (axis.num_values == max_values) {
+                ::fprintf(stderr, "line %u: too many values for %s, the most is %u\n", (unsigned)line_num, tok, max_values);
+                return false;
+            }
+            axis.values[axis.num_values++] = value;
+        }
+        if (axis.num_values == 0) {
+            ::fprintf(stderr, "line %u: no value for %s\n", (unsigned)line_num, tok);
+            return false;
+        }
+    }
+
+    uint32_t combinations = 1;
+    for (uint8_t a=0; a<num_axes; a++) {
+        combinations *= axes[a].num_values;
+        if (combinations > max_configs) {
+            break;
+        }
+    }
+    if (_num_configs + combinations > max_configs) {
+        ::fprintf(stderr, "line %u: too many configurations, the most is %u\n", (unsigned)line_num, max_configs);
+        return false;
+    }
+
+    for (uint32_t n=0; n<combinations; n++) {
+        struct param_override overrides[max_overrides];
+        // the first parameter on the line changes fastest
+        uint32_t k = n;
+        for (uint8_t a=0; a<num_axes; a++) {
+            memcpy(overrides[a].name, axes[a].name, sizeof(overrides[a].name));
+            overrides[a].value = axes[a].values[k % axes[a].num_values];
+            k /= axes[a].num_values;
+        }
+        char config_name[32];
+        if (combinations > 1) {
+            snprintf(config_name, sizeof(config_name), "%.24s/%u", name, (unsigned)n+1);
+        } else {
+            snprintf(config_name, sizeof(config_name), "%s", name);
+        }
+        if (!add_config(config_name, overrides, num_axes)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ReplaySweep::add_config(const char *name, const struct param_override *overrides, uint8_t num_overrides)
+{
+    struct config *c = new config();
+    if (c == nullptr) {
+        return false;
+    }
+    c->ekf = new NavEKF3(_ahrs, _rng);
+    if (c->ekf == nullptr) {
+        delete c;
+        return false;
+    }
+    snprintf(c->name, sizeof(c->name), "%s", name);
+    memcpy(c->overrides, overrides, num_overrides * sizeof(overrides[0]));
+    c->num_overrides = num_overrides;
+    _configs[_num_configs++] = c;
+    return true;
+}
+
+/*
+  find a scalar EKF3 parameter by its name without the EK3_ prefix
+ */
+const struct AP_Param::GroupInfo *ReplaySweep::find_param(const char *name)
+{
+    const struct AP_Param::GroupInfo *info = NavEKF3::var_info;
+    for (uint8_t i=0; info[i].type != AP_PARAM_NONE; i++) {
+        if (info[i].type <= AP_PARAM_FLOAT && strcmp(info[i].name, name) == 0) {
+            return &info[i];
+        }
+    }
+    return nullptr;
+}
+
+/*
+  copy the scalar parameters of one EKF3 to another
+ */
+void ReplaySweep::copy_params(const NavEKF3 &from, NavEKF3 &to)
+{
+    const struct AP_Param::GroupInfo *info = NavEKF3::var_info;
+    for (uint8_t i=0; info[i].type != AP_PARAM_NONE; i++) {
+        const enum ap_var_type type = (enum ap_var_type)info[i].type;
+        if (type > AP_PARAM_FLOAT) {
+            continue;
+        }
+        const AP_Param *src = (const AP_Param *)((const uint8_t *)&from + info[i].offset);
+        AP_Param::set_value(type, (uint8_t *)&to + info[i].offset, src->cast_to_float(type));
+    }
+}
+
+/*
+  start a worker thread for each slice of the configurations after
+  the first
+ */
+bool ReplaySweep::start_workers(void)
+{
+    uint16_t threads = _max_threads;
+    if (threads == 0) {
+        threads = hal.scheduler->get_num_cores();
+    }
+    threads = constrain_int16(threads, 1, _num_configs);
+
+    _workers = new Worker[threads];
+    if (_workers == nullptr) {
+        return false;
+    }
+    // split the configurations as evenly as we can
+    uint16_t first = 0;
+    for (uint16_t i=0; i<threads; i++) {
+        Worker &w = _workers[i];
+        w.sweep = this;
+        w.first = first;
+        w.count = (_num_configs - first) / (threads - i);
+        first += w.count;
+        if (i > 0 &&
+            !hal.scheduler->thread_create(FUNCTOR_BIND(&w, &Worker::thread_main, void),
+                                          "sweep", 16384, AP_HAL::Scheduler::PRIORITY_MAIN, 0)) {
+            return false;
+        }
+    }
+    _num_workers = threads;
+    ::printf("Sweeping %u EKF3 configurations on %u threads\n",
+             (unsigned)_num_configs, (unsigned)_num_workers);
+    return true;
+}
+
+void ReplaySweep::Worker::thread_main(void)
+{
+    while (true) {
+        start.wait_blocking();
+        sweep->run_configs(first, count);
+        done.signal();
+    }
+}
+
+void ReplaySweep::update(const NavEKF3 &replay_ekf)
+{
+    // the configurations start when the replayed EKF does, by which
+    // time the parameters in the log have been loaded
+    if (replay_ekf.activeCores() == 0) {
+        return;
+    }
+    if (_workers == nullptr && !start_workers()) {
+        ::fprintf(stderr, "Failed to start sweep threads\n");
+        exit(1);
+    }
+    _replay_ekf = &replay_ekf;
+
+    for (uint16_t i=1; i<_num_workers; i++) {
+        _workers[i].start.signal();
+    }
+    run_configs(_workers[0].first, _workers[0].count);
+    for (uint16_t i=1; i<_num_workers; i++) {
+        _workers[i].done.wait_blocking();
+    }
+}
+
+void ReplaySweep::run_configs(uint16_t first, uint16_t count)
+{
+    for (uint16_t i=first; i<first+count; i++) {
+        run_config(*_configs[i]);
+    }
+}
+
+void ReplaySweep::run_config(struct config &c)
+{
+    if (!c.started) {
+        // start from the replayed EKF's parameters, which include
+        // those from the log and from --parm
+        copy_params(*_replay_ekf, *c.ekf);
+        for (uint8_t i=0; i<c.num_overrides; i++) {
+            AP_Param::set_object_value(c.ekf, NavEKF3::var_info, c.overrides[i].name, c.overrides[i].value);
+        }
+        // only the replayed EKF logs
+        AP_Param::set_object_value(c.ekf, NavEKF3::var_info, "LOG_MASK", 0);
+        c.started = c.ekf->InitialiseFilter();
+        return;
+    }
+
+    struct timespec ts0, ts1;
+    clock_gettime(CLOCK_MONOTONIC, &ts0);
+    c.ekf->UpdateFilter();
+    clock_gettime(CLOCK_MONOTONIC, &ts1);
+    c.stats.update_time((ts1.tv_sec - ts0.tv_sec) * 1000000U + (ts1.tv_nsec - ts0.tv_nsec) / 1000);
+
+    float ratios[ReplayStats::INNOV_NUM];
+    Vector3f mag_var;
+    Vector2f offset;
+    c.ekf->getVariances(-1,
+                        ratios[ReplayStats::INNOV_VEL],
+                        ratios[ReplayStats::INNOV_POS],
+                        ratios[ReplayStats::INNOV_HGT],
+                        mag_var,
+                        ratios[ReplayStats::INNOV_TAS],
+                        offset);
+    ratios[ReplayStats::INNOV_MAG] = mag_var.length();
+    c.stats.update_innovations(ratios);
+}
+
+/*
+  write a line for each configuration. The innovation columns are the
+  mean and max EKF test ratios and the percentage over 1, which the
+  EKF rejects. A well tuned configuration has mean test ratios well
+  below 1 and few rejections
+ */
+void ReplaySweep::write_summary(FILE *f) const
+{
+    fprintf(f, "%-4s %-28s %8s %7s", "Num", "Name", "Updates", "Upd(us)");
+    for (uint8_t i=0; i<ReplayStats::INNOV_NUM; i++) {
+        fprintf(f, " %5s %6s %5s", ReplayStats::innov_name(i), "Max", "Rej%");
+    }
+    fprintf(f, " Overrides\n");
+
+    for (uint16_t n=0; n<_num_configs; n++) {
+        const struct config &c = *_configs[n];
+        fprintf(f, "%04u %-28s %8u %7.1f", (unsigned)n+1, c.name,
+                (unsigned)c.stats.updates, (double)c.stats.mean_update_us());
+        for (uint8_t i=0; i<ReplayStats::INNOV_NUM; i++) {
+            fprintf(f, " %5.2f %6.2f %5.1f", (double)c.stats.mean_innovation(i),
+                    (double)c.stats.innov_max[i], (double)(100 * c.stats.fraction_over(i)));
+        }
+        for (uint8_t i=0; i<c.num_overrides; i++) {
+            fprintf(f, " EK3_%s=%g", c.overrides[i].name, (double)c.overrides[i].value);
+        }
+        fprintf(f, "\n");
+    }
+}
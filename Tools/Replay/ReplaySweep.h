@@ -0,0 +1,104 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Param/AP_Param.h>
+#include <AP_NavEKF3/AP_NavEKF3.h>
+#include "ReplayBatch.h"
+
+/*
+  run EKF3 with many sets of parameters over one replay of a log.
+
+  The log is read and its sensor data decoded once, by the normal
+  replay. After each AHRS update every configuration gets its own
+  NavEKF3 update from the same sensor state, so the configurations run
+  in lockstep with the replayed EKF. The configurations are spread
+  over worker threads, which only read the sensor state, and the
+  replay waits for all of them before reading on
+ */
+class ReplaySweep {
+public:
+    ReplaySweep(const AP_AHRS *ahrs, const RangeFinder &rng) :
+        _ahrs(ahrs),
+        _rng(rng) {}
+
+    /*
+      add the configurations in filename. Each line is a name then
+      NAME=VALUE EK3 parameter overrides. A VALUE may be a comma
+      separated list, in which case a configuration is added for each
+      combination of values on the line
+     */
+    bool load(const char *filename);
+
+    // set the number of threads to use, 0 for one per CPU
+    void set_threads(uint16_t threads) { _max_threads = threads; }
+
+    // run one step of every configuration, after replay_ekf has run
+    void update(const NavEKF3 &replay_ekf);
+
+    // write the innovation and timing metrics of each configuration
+    void write_summary(FILE *f) const;
+
+    uint16_t num_configs() const { return _num_configs; }
+
+    static const uint16_t max_configs = 256;
+    static const uint8_t max_overrides = 16;
+    static const uint8_t max_values = 32;
+
+private:
+    const AP_AHRS *_ahrs;
+    const RangeFinder &_rng;
+    const NavEKF3 *_replay_ekf = nullptr;
+
+    struct param_override {
+        char name[AP_MAX_NAME_SIZE+1];  // without the EK3_ prefix
+        float value;
+    };
+
+    struct config {
+        char name[32];
+        struct param_override overrides[max_overrides];
+        uint8_t num_overrides;
+        NavEKF3 *ekf;
+        bool started;
+        ReplayStats stats;
+    } *_configs[max_configs];
+    uint16_t _num_configs = 0;
+
+    // worker running a slice of the configurations. The first slice
+    // is run by the replay thread
+    class Worker {
+    public:
+        void thread_main(void);
+
+        ReplaySweep *sweep;
+        uint16_t first;
+        uint16_t count;
+        HAL_BinarySemaphore start;  // signalled to run a step
+        HAL_BinarySemaphore done;   // signalled when the step is complete
+    } *_workers = nullptr;
+    uint16_t _num_workers = 0;
+    uint16_t _max_threads = 0;
+
+    bool parse_line(char *line, uint32_t line_num);
+    bool add_config(const char *name, const struct param_override *overrides, uint8_t num_overrides);
+    bool start_workers(void);
+    void run_configs(uint16_t first, uint16_t count);
+    void run_config(struct config &c);
+
+    static const struct AP_Param::GroupInfo *find_param(const char *name);
+    static void copy_params(const NavEKF3 &from, NavEKF3 &to);
+};
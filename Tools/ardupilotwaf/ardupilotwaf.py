@@ -90,6 +90,9 @@ COMMON_VEHICLE_DEPENDENT_LIBRARIES = [
     'AC_PID',
     'AP_SerialLED',
     'AP_Hott_Telem',
+    'AP_GyroFFT',
+    'AP_SampleJitter',
+    'AP_OutputLatency',
 ]
 
 def get_legacy_defines(sketch_name):
@@ -368,7 +371,7 @@ def write_version_header(ctx, tgt):
             print('#define {} {}'.format(k, v), file=f)
 
 @conf
-def ap_find_benchmarks(bld, use=[]):
+def ap_find_benchmarks(bld, use=[], defines=[]):
     if not bld.env.HAS_GBENCHMARK:
         return
 
@@ -381,9 +384,12 @@ def ap_find_benchmarks(bld, use=[]):
             includes=includes,
             source=[f],
             use=use,
+            defines=list(defines),
             program_name=f.change_ext('').name,
             program_groups='benchmarks',
             use_legacy_defines=False,
+            # the gbenchmark headers don't mark their overrides
+            cxxflags=['-Wno-suggest-override'],
         )
 
 def test_summary(bld):
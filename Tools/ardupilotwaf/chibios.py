@@ -187,6 +187,16 @@ class build_intel_hex(Task.Task):
     def __str__(self):
         return self.outputs[0].path_from(self.generator.bld.bldnode)
 
+class memory_report(Task.Task):
+    '''report the static RAM used by each library from the link map'''
+    color='CYAN'
+    run_str='${PYTHON} ${TOOLS_SCRIPTS}/memory_report.py --output ${TGT} ${SRC}'
+    always_run = True
+    def keyword(self):
+        return "Generating"
+    def __str__(self):
+        return self.outputs[0].path_from(self.generator.bld.bldnode)
+
 @feature('ch_ap_program')
 @after_method('process_source')
 def chibios_firmware(self):
@@ -195,6 +205,13 @@ def chibios_firmware(self):
     link_output = self.link_task.outputs[0]
     hex_task = None
 
+    # keep the link map so static RAM use can be reported per library
+    map_target = self.bld.bldnode.find_or_declare('bin/' + link_output.change_ext('.map').name)
+    self.link_task.env.append_value('LINKFLAGS', ['-Wl,-Map=%s' % map_target.abspath()])
+    memory_target = self.bld.bldnode.find_or_declare('bin/' + link_output.change_ext('.memory.txt').name)
+    memory_task = self.create_task('memory_report', src=map_target, tgt=memory_target)
+    memory_task.set_run_after(self.link_task)
+
     bin_target = self.bld.bldnode.find_or_declare('bin/' + link_output.change_ext('.bin').name)
     apj_target = self.bld.bldnode.find_or_declare('bin/' + link_output.change_ext('.apj').name)
 
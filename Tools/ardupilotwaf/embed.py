@@ -7,11 +7,32 @@ Andrew Tridgell
 May 2017
 '''
 
-import os, sys, tempfile, gzip
+import os, sys, tempfile, struct, zlib
+
+# uncompressed size of each independently compressed block of a
+# chunked file, which is the buffer size needed to stream it
+CHUNK_BLOCK_SIZE = 2048
+CHUNK_MAGIC = 0x315A4652
 
 def write_encode(out, s):
     out.write(s.encode())
 
+def compress_chunked(contents, block_size=CHUNK_BLOCK_SIZE):
+    '''compress contents in the AP_ROMFS chunked format, a header and
+    index of blocks followed by each block as raw deflate data'''
+    blocks = []
+    for ofs in range(0, len(contents), block_size):
+        c = zlib.compressobj(9, zlib.DEFLATED, -15)
+        blocks.append(c.compress(bytes(contents[ofs:ofs+block_size])) + c.flush())
+    header = struct.pack('<IIHH', CHUNK_MAGIC, len(contents), block_size, len(blocks))
+    ofs = len(header) + 4 * (len(blocks) + 1)
+    index = b''
+    for b in blocks:
+        index += struct.pack('<I', ofs)
+        ofs += len(b)
+    index += struct.pack('<I', ofs)
+    return header + index + b''.join(blocks)
+
 def embed_file(out, f, idx, embedded_name, uncompressed):
     '''embed one file'''
     try:
@@ -47,11 +68,8 @@ def embed_file(out, f, idx, embedded_name, uncompressed):
             contents += nul
         compressed.write(contents)
     else:
-        # compress it
-        f = open(compressed.name, "wb")
-        with gzip.GzipFile(fileobj=f, mode='wb', filename='', compresslevel=9, mtime=0) as g:
-            g.write(contents)
-        f.close()
+        # compress it in blocks so it can be streamed
+        compressed.write(compress_chunked(contents))
 
     compressed.seek(0)
     b = bytearray(compressed.read())
@@ -384,6 +384,7 @@ def run_step(step):
         "disable_breakpoints": opts.disable_breakpoints,
         "frame": opts.frame,
         "_show_test_timings": opts.show_test_timings,
+        "profile": opts.profile,
     }
     if opts.speedup is not None:
         fly_opts["speedup"] = opts.speedup
@@ -737,6 +738,10 @@ if __name__ == "__main__":
                          default=False,
                          action='store_true',
                          help="disable all breakpoints before starting")
+    group_sim.add_option("--profile",
+                         default=False,
+                         action='store_true',
+                         help="record a SITL wall clock profile for each test")
     parser.add_option_group(group_sim)
 
     opts, args = parser.parse_args()
@@ -1,10 +1,12 @@
 from __future__ import print_function
 
 import abc
+import json
 import math
 import os
 import re
 import shutil
+import signal
 import sys
 import time
 import traceback
@@ -177,7 +179,8 @@ class AutoTest(ABC):
                  disable_breakpoints=False,
                  viewerip=None,
                  use_map=False,
-                 _show_test_timings=False):
+                 _show_test_timings=False,
+                 profile=False):
 
         self.binary = binary
         self.valgrind = valgrind
@@ -206,6 +209,8 @@ class AutoTest(ABC):
         self.run_tests_called = False
         self._show_test_timings = _show_test_timings
         self.test_timings = dict()
+        self.profile = profile
+        self.profile_results = dict()
 
     @staticmethod
     def progress(text):
@@ -456,6 +461,12 @@ class AutoTest(ABC):
         util.pexpect_close(self.mavproxy)
         util.pexpect_close(self.sitl)
 
+        if self.profile:
+            path = self.buildlogs_path("%s-profile.json" % self.log_name())
+            with open(path, "w") as f:
+                json.dump(self.profile_results, f, indent=2, sort_keys=True)
+            self.progress("Wrote profile to %s" % path)
+
         valgrind_log = util.valgrind_log_filepath(binary=self.binary,
                                                   model=self.frame)
         if os.path.exists(valgrind_log):
@@ -2213,6 +2224,9 @@ class AutoTest(ABC):
         self.test_timings[desc] = time.time() - start_time
         self.context_pop()
 
+        if self.profile:
+            self.profile_results[name] = self.collect_profile()
+
         passed = True
         if ex is not None:
             passed = False
@@ -2241,6 +2255,25 @@ class AutoTest(ABC):
 
         tee.close()
 
+    def sitl_profile_filepath(self):
+        return self.buildlogs_path("%s-sitl-profile.json" % self.log_name())
+
+    def collect_profile(self, timeout=10):
+        '''ask SITL for the profile since the last one and return it'''
+        path = self.sitl_profile_filepath()
+        if os.path.exists(path):
+            os.unlink(path)
+        os.kill(self.sitl.pid, signal.SIGUSR2)
+        tstart = time.time()
+        while not os.path.exists(path):
+            if time.time() - tstart > timeout:
+                self.progress("No profile from SITL")
+                return None
+            self.drain_mav()
+            time.sleep(0.1)
+        with open(path) as f:
+            return json.load(f)
+
     def check_test_syntax(self, test_file):
         """Check mistake on autotest function syntax."""
         self.start_test("Check for syntax mistake in autotest lambda")
@@ -2304,6 +2337,7 @@ class AutoTest(ABC):
                                     valgrind=self.valgrind,
                                     vicon=self.uses_vicon(),
                                     wipe=True,
+                                    profile=self.sitl_profile_filepath() if self.profile else None,
                                     )
 
         self.start_mavproxy()
@@ -3450,6 +3484,10 @@ switch value'''
             if not self.is_tracker(): # FIXME - more to the point, fix Tracker's mission handling
                 self.clear_mission(mavutil.mavlink.MAV_MISSION_TYPE_ALL)
 
+            if self.profile:
+                # start the first test's profile from here
+                self.collect_profile()
+
             for test in tests:
                 (name, desc, func) = test
                 self.run_one_test(name, desc, func)
@@ -11,6 +11,7 @@ import subprocess
 import sys
 import tempfile
 import time
+import zlib
 from math import acos, atan2, cos, pi, sqrt
 
 import pexpect
@@ -241,7 +242,11 @@ def start_SITL(binary,
                breakpoints=[],
                disable_breakpoints=False,
                vicon=False,
-               lldb=False):
+               lldb=False,
+               profile=None,
+               instance=None,
+               seed=None,
+               reset_file=None):
     """Launch a SITL instance."""
     cmd = []
     if valgrind and os.path.exists('/usr/bin/valgrind'):
@@ -320,6 +325,14 @@ def start_SITL(binary,
         cmd.extend(['--unhide-groups'])
     if vicon:
         cmd.extend(["--uartF=sim:vicon:"])
+    if profile is not None:
+        cmd.extend(['--profile', profile])
+    if instance is not None:
+        cmd.extend(['--instance', str(instance)])
+    if seed is not None:
+        cmd.extend(['--seed', str(seed)])
+    if reset_file is not None:
+        cmd.extend(['--reset-file', reset_file])
 
     if gdb and not os.getenv('DISPLAY'):
         subprocess.Popen(cmd)
@@ -339,6 +352,10 @@ def start_SITL(binary,
     rest = cmd[1:]
     child = pexpect.spawn(first, rest, logfile=sys.stdout, encoding=ENCODING, timeout=5)
     pexpect_autoclose(child)
+    if instance == 'auto':
+        # SITL picks the instance, and so the ports, from the pool
+        child.expect(r'SITL instance (\d+)', timeout=30)
+        child.sitl_instance = int(child.match.group(1))
     # give time for parameters to properly setup
     time.sleep(3)
     if gdb or lldb:
@@ -353,6 +370,24 @@ def start_SITL(binary,
     return child
 
 
+def reset_SITL(sitl, reset_file, snapshot=None, seed=None):
+    """Reset a SITL started with reset_file in place for the next test,
+    optionally from a snapshot and with a new random seed."""
+    with open(reset_file, "w") as f:
+        if snapshot is not None:
+            f.write("snapshot %s\n" % snapshot)
+        if seed is not None:
+            f.write("seed %u\n" % seed)
+    os.kill(sitl.pid, signal.SIGHUP)
+    sitl.expect('Waiting for connection', timeout=300)
+
+
+def test_seed(name):
+    """Return a stable random seed for a test case name, so a test gets
+    the same seed whichever instance runs it."""
+    return zlib.crc32(name.encode('utf-8')) & 0xffffffff
+
+
 def mavproxy_cmd():
     '''return path to which mavproxy to use'''
     return os.getenv('MAVPROXY_CMD', 'mavproxy.py')
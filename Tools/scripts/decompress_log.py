@@ -0,0 +1,137 @@
+#!/usr/bin/env python
+'''
+decompress a dataflash log written with LOG_FILE_COMPR=1 into a
+normal .BIN log
+
+See libraries/AP_Logger/LogCompress.h for a description of the format
+'''
+
+from __future__ import print_function
+
+import os
+import struct
+import sys
+import optparse
+
+MAGIC = b'APLZ'
+VERSION = 1
+FILE_HEADER_LEN = 8
+FRAME_HEADER_LEN = 4
+HEAD_BYTE1 = 0xA3
+HEAD_BYTE2 = 0x95
+LOG_FORMAT_MSG = 128
+LOG_FORMAT_LEN = 89
+
+
+def lz4_decompress(src, raw_len):
+    '''decompress one LZ4 block'''
+    dst = bytearray()
+    ip = 0
+    while ip < len(src):
+        token = src[ip]
+        ip += 1
+        lit_len = token >> 4
+        if lit_len == 15:
+            while True:
+                b = src[ip]
+                ip += 1
+                lit_len += b
+                if b != 255:
+                    break
+        dst += src[ip:ip+lit_len]
+        ip += lit_len
+        if ip >= len(src):
+            break
+        offset = src[ip] | (src[ip+1] << 8)
+        ip += 2
+        match_len = token & 0x0F
+        if match_len == 15:
+            while True:
+                b = src[ip]
+                ip += 1
+                match_len += b
+                if b != 255:
+                    break
+        match_len += 4
+        if offset == 0 or offset > len(dst):
+            raise ValueError("bad match offset")
+        start = len(dst) - offset
+        for i in range(match_len):
+            dst.append(dst[start + i])
+    if len(dst) != raw_len:
+        raise ValueError("bad block length")
+    return dst
+
+
+class Undelta(object):
+    '''undo the per-message timestamp differencing'''
+    def __init__(self):
+        self.msg_len = {LOG_FORMAT_MSG: LOG_FORMAT_LEN}
+
+    def block(self, block):
+        last = {}
+        ofs = 0
+        while ofs + 3 <= len(block):
+            if block[ofs] != HEAD_BYTE1 or block[ofs+1] != HEAD_BYTE2:
+                break
+            mtype = block[ofs+2]
+            mlen = self.msg_len.get(mtype, 0)
+            if mlen == 0 or ofs + mlen > len(block):
+                break
+            if mlen >= 11:
+                (v,) = struct.unpack_from('<Q', block, ofs+3)
+                if mtype in last:
+                    v = (v + last[mtype]) & 0xFFFFFFFFFFFFFFFF
+                    struct.pack_into('<Q', block, ofs+3, v)
+                last[mtype] = v
+            if mtype == LOG_FORMAT_MSG and block[ofs+3] != LOG_FORMAT_MSG:
+                self.msg_len[block[ofs+3]] = block[ofs+4]
+            ofs += mlen
+
+
+def decompress(infile, outfile):
+    data = open(infile, 'rb').read()
+    if data[:4] != MAGIC or bytearray(data[4:5])[0] != VERSION:
+        print("%s is not a compressed log" % infile)
+        return False
+    undelta = Undelta()
+    out = open(outfile, 'wb')
+    ofs = FILE_HEADER_LEN
+    nframes = 0
+    while ofs + FRAME_HEADER_LEN <= len(data):
+        (raw_len, comp_len) = struct.unpack_from('<HH', data, ofs)
+        ofs += FRAME_HEADER_LEN
+        frame = bytearray(data[ofs:ofs+comp_len])
+        if len(frame) < comp_len:
+            print("truncated frame at end of log")
+            break
+        ofs += comp_len
+        if comp_len == raw_len:
+            block = frame
+        else:
+            block = lz4_decompress(frame, raw_len)
+        undelta.block(block)
+        out.write(block)
+        nframes += 1
+    out.close()
+    print("%s: %u frames, %u bytes -> %u bytes" % (infile, nframes, len(data), os.path.getsize(outfile)))
+    return True
+
+
+parser = optparse.OptionParser("decompress_log.py [options] INFILE [OUTFILE]")
+opts, args = parser.parse_args()
+
+if len(args) < 1:
+    parser.print_help()
+    sys.exit(1)
+
+infile = args[0]
+if len(args) > 1:
+    outfile = args[1]
+elif infile.upper().endswith('.BIN'):
+    outfile = infile[:-4] + '-decompressed.BIN'
+else:
+    outfile = infile + '.BIN'
+
+if not decompress(infile, outfile):
+    sys.exit(1)
@@ -0,0 +1,130 @@
+#!/usr/bin/env python
+'''
+report the static RAM (.data and .bss) used by each library of a
+firmware, from the map file written by the linker
+
+  memory_report.py build/fmuv3/bin/arducopter.map
+'''
+
+from __future__ import print_function
+
+import os
+import re
+import sys
+from argparse import ArgumentParser
+
+# input section with its address, size and object on the same line
+section_line = re.compile(r'^ (\S+)\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)\s+(\S.*)$')
+# input section whose name was too long, the rest is on the next line
+section_name_line = re.compile(r'^ (\S+)$')
+section_rest_line = re.compile(r'^\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)\s+(\S.*)$')
+# archive member, such as lib/libArduCopter_libs.a(AP_AHRS.cpp.0.o)
+archive_member = re.compile(r'^(.*)\((.*)\)$')
+# object file built by waf, such as AP_AHRS.cpp.0.o
+waf_object = re.compile(r'^(.*)\.\d+\.o$')
+
+
+def source_index(topdir):
+    '''map source file names under libraries/ to their library'''
+    index = {}
+    libdir = os.path.join(topdir, 'libraries')
+    for lib in os.listdir(libdir):
+        for root, dirs, files in os.walk(os.path.join(libdir, lib)):
+            for f in files:
+                index.setdefault(f, lib)
+    return index
+
+
+def owner(obj, index):
+    '''library or module an object in the map file came from'''
+    m = archive_member.match(obj)
+    if m is not None:
+        archive, member = m.group(1), m.group(2)
+        m = waf_object.match(member)
+        if m is not None and m.group(1) in index:
+            return index[m.group(1)]
+        name = os.path.basename(archive)
+        if name == 'libch.a':
+            return 'ChibiOS'
+        return os.path.splitext(name)[0]
+    parts = obj.replace('\\', '/').split('/')
+    if 'libraries' in parts[:-1]:
+        return parts[parts.index('libraries') + 1]
+    m = waf_object.match(parts[-1])
+    if m is not None and m.group(1) in index:
+        return index[m.group(1)]
+    if len(parts) > 1:
+        return parts[-2]
+    return parts[-1]
+
+
+def section_kind(name):
+    '''data or bss for sections placed in RAM, otherwise None'''
+    if name.startswith('.data'):
+        return 'data'
+    if name.startswith('.bss') or name == 'COMMON':
+        return 'bss'
+    return None
+
+
+def parse_map(filename, index):
+    '''sum the .data and .bss of each library in a map file'''
+    usage = {}
+    in_memory_map = False
+    pending = None
+    for line in open(filename, 'r'):
+        line = line.rstrip('\n')
+        if not in_memory_map:
+            # the discarded sections come before the memory map
+            in_memory_map = line.startswith('Linker script and memory map')
+            continue
+        m = section_line.match(line)
+        if m is not None:
+            name, size, obj = m.group(1), int(m.group(3), 16), m.group(4)
+        elif pending is not None and section_rest_line.match(line):
+            m = section_rest_line.match(line)
+            name, size, obj = pending, int(m.group(2), 16), m.group(3)
+        else:
+            m = section_name_line.match(line)
+            pending = m.group(1) if m is not None else None
+            continue
+        pending = None
+        kind = section_kind(name)
+        if kind is None or size == 0:
+            continue
+        lib = owner(obj.strip(), index)
+        if lib not in usage:
+            usage[lib] = {'data': 0, 'bss': 0}
+        usage[lib][kind] += size
+    return usage
+
+
+def report(usage, limit=None):
+    '''table of libraries by total static RAM, largest first'''
+    libs = sorted(usage.keys(), key=lambda k: usage[k]['data'] + usage[k]['bss'], reverse=True)
+    total_data = sum([u['data'] for u in usage.values()])
+    total_bss = sum([u['bss'] for u in usage.values()])
+    lines = ['%-32s %8s %8s %8s' % ('Library', 'Data', 'BSS', 'Total')]
+    if limit is not None:
+        libs = libs[:limit]
+    for lib in libs:
+        u = usage[lib]
+        lines.append('%-32s %8u %8u %8u' % (lib, u['data'], u['bss'], u['data'] + u['bss']))
+    lines.append('%-32s %8u %8u %8u' % ('TOTAL', total_data, total_bss, total_data + total_bss))
+    return '\n'.join(lines) + '\n'
+
+
+if __name__ == '__main__':
+    parser = ArgumentParser(description='static RAM use by library from a linker map file')
+    parser.add_argument('mapfile', help='map file written by the linker')
+    parser.add_argument('--output', default=None, help='write the report to this file')
+    parser.add_argument('--limit', type=int, default=None, help='only list the largest LIMIT libraries')
+    parser.add_argument('--topdir', default=os.path.join(os.path.dirname(os.path.realpath(__file__)), '../..'),
+                        help='top of the source tree')
+    args = parser.parse_args()
+
+    text = report(parse_map(args.mapfile, source_index(args.topdir)), args.limit)
+    if args.output is not None:
+        open(args.output, 'w').write(text)
+    else:
+        sys.stdout.write(text)
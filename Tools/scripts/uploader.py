@@ -199,6 +199,8 @@ class uploader(object):
 
     REBOOT          = b'\x30'
     SET_BAUD        = b'\x33'     # set baud
+    START_BULK      = b'\x34'     # start a bulk upload, if INFO_BULK_MAX is supported
+    PROG_BULK       = b'\x35'     # erase as needed and program a block
 
     INFO_BL_REV     = b'\x01'        # bootloader protocol revision
     BL_REV_MIN      = 2              # minimum supported bootloader protocol
@@ -206,6 +208,7 @@ class uploader(object):
     INFO_BOARD_ID   = b'\x02'        # board type
     INFO_BOARD_REV  = b'\x03'        # board revision
     INFO_FLASH_SIZE = b'\x04'        # max firmware size in bytes
+    INFO_BULK_MAX   = b'\x06'        # max PROG_BULK size, if supported
 
     PROG_MULTI_MAX  = 252            # protocol max is 255, must be multiple of 4
     READ_MULTI_MAX  = 252            # protocol max is 255
@@ -297,6 +300,16 @@ class uploader(object):
         val = struct.unpack("<I", raw)
         return val[0]
 
+    # receive an int, waiting up to timeout seconds for it
+    def __recv_int_wait(self, timeout):
+        deadline = time.time() + timeout
+        raw = b''
+        while len(raw) < 4:
+            raw += self.port.read(4 - len(raw))
+            if len(raw) < 4 and time.time() > deadline:
+                raise RuntimeError("timeout waiting for data (4 bytes)")
+        return struct.unpack("<I", raw)[0]
+
     def __getSync(self):
         self.port.flush()
         c = bytes(self.__recv())
@@ -416,6 +429,29 @@ class uploader(object):
 
         raise RuntimeError("timed out waiting for erase")
 
+    # send the START_BULK command, sectors are erased as the upload reaches them
+    def __start_bulk(self):
+        self.__send(uploader.START_BULK +
+                    uploader.EOC)
+        self.__getSync()
+
+    # send a PROG_BULK command to write a block, waiting for any sector
+    # erase it needs
+    def __program_bulk(self, data):
+        self.__send(uploader.PROG_BULK)
+        self.__send(struct.pack("<H", len(data)))
+        self.__send(data)
+        self.__send(uploader.EOC)
+        # erasing a large sector can take a few seconds
+        deadline = time.time() + 10.0
+        while True:
+            try:
+                self.__getSync()
+                return
+            except RuntimeError as e:
+                if "timeout" not in str(e) or time.time() > deadline:
+                    raise
+
     # send a PROG_MULTI command to write a collection of bytes
     def __program_multi(self, data):
 
@@ -496,6 +532,21 @@ class uploader(object):
                 self.__drawProgressBar(label, uploadProgress, len(groups))
         self.__drawProgressBar(label, 100, 100)
 
+    # upload code in bulk blocks
+    def __program_bulk_all(self, label, fw):
+        print("\n", end='')
+        code = fw.image
+        groups = self.__split_len(code, self.bulk_max)
+
+        uploadProgress = 0
+        for bytes in groups:
+            self.__program_bulk(bytes)
+
+            uploadProgress += 1
+            if uploadProgress % 64 == 0:
+                self.__drawProgressBar(label, uploadProgress, len(groups))
+        self.__drawProgressBar(label, 100, 100)
+
     # download code
     def __download(self, label, fw):
         print("\n", end='')
@@ -543,7 +594,11 @@ class uploader(object):
         expect_crc = fw.crc(self.fw_maxsize)
         self.__send(uploader.GET_CRC +
                     uploader.EOC)
-        report_crc = self.__recv_int()
+        if self.bulk_max > 0:
+            # the bootloader erases what is left of the old firmware first
+            report_crc = self.__recv_int_wait(30.0)
+        else:
+            report_crc = self.__recv_int()
         self.__getSync()
         if report_crc != expect_crc:
             print("Expected 0x%x" % expect_crc)
@@ -578,6 +633,15 @@ class uploader(object):
         self.board_rev = self.__getInfo(uploader.INFO_BOARD_REV)
         self.fw_maxsize = self.__getInfo(uploader.INFO_FLASH_SIZE)
 
+        # newer bootloaders support bulk upload, older ones reply
+        # INVALID without a value
+        self.bulk_max = 0
+        if self.bl_rev >= 5:
+            try:
+                self.bulk_max = self.__getInfo(uploader.INFO_BULK_MAX) & ~3
+            except RuntimeError:
+                self.__sync()
+
     def dump_board_info(self):
         # OTP added in v4:
         print("Bootloader Protocol: %u" % self.bl_rev)
@@ -712,8 +776,13 @@ class uploader(object):
             self.port.baudrate = self.baudrate_bootloader_flash
             self.__sync()
 
-        self.__erase("Erase  ")
-        self.__program("Program", fw)
+        if self.bulk_max > 0:
+            # sectors are erased as the upload goes
+            self.__start_bulk()
+            self.__program_bulk_all("Program", fw)
+        else:
+            self.__erase("Erase  ")
+            self.__program("Program", fw)
 
         if self.bl_rev == 2:
             self.__verify_v2("Verify ", fw)
@@ -1,6 +1,7 @@
 #include "AC_AttitudeControl_Multi.h"
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
+#include <AP_OutputLatency/AP_OutputLatency.h>
 
 // table of user settable parameters
 const AP_Param::GroupInfo AC_AttitudeControl_Multi::var_info[] = {
@@ -315,28 +316,47 @@ float AC_AttitudeControl_Multi::get_throttle_avg_max(float throttle_in)
 }
 
 // update_throttle_rpy_mix - slew set_throttle_rpy_mix to requested value
-void AC_AttitudeControl_Multi::update_throttle_rpy_mix()
+void AC_AttitudeControl_Multi::update_throttle_rpy_mix(float dt)
 {
     // slew _throttle_rpy_mix to _throttle_rpy_mix_desired
     if (_throttle_rpy_mix < _throttle_rpy_mix_desired) {
         // increase quickly (i.e. from 0.1 to 0.9 in 0.4 seconds)
-        _throttle_rpy_mix += MIN(2.0f * _dt, _throttle_rpy_mix_desired - _throttle_rpy_mix);
+        _throttle_rpy_mix += MIN(2.0f * dt, _throttle_rpy_mix_desired - _throttle_rpy_mix);
     } else if (_throttle_rpy_mix > _throttle_rpy_mix_desired) {
         // reduce more slowly (from 0.9 to 0.1 in 1.6 seconds)
-        _throttle_rpy_mix -= MIN(0.5f * _dt, _throttle_rpy_mix - _throttle_rpy_mix_desired);
+        _throttle_rpy_mix -= MIN(0.5f * dt, _throttle_rpy_mix - _throttle_rpy_mix_desired);
     }
     _throttle_rpy_mix = constrain_float(_throttle_rpy_mix, 0.1f, AC_ATTITUDE_CONTROL_MAX);
 }
 
 void AC_AttitudeControl_Multi::rate_controller_run()
 {
+    rate_controller_update(_ahrs.get_gyro_latest(), _dt);
+}
+
+/*
+  run the rate controller on a gyro sample taken dt seconds after the
+  previous one. This is for a rate loop running at the gyro rate on
+  its own thread, so it does not wait for the AHRS to see the sample
+ */
+void AC_AttitudeControl_Multi::rate_controller_run_gyro(const Vector3f &gyro, float dt)
+{
+    rate_controller_update(gyro, dt);
+}
+
+void AC_AttitudeControl_Multi::rate_controller_update(const Vector3f &gyro_latest, float dt)
+{
+    if (!is_equal(dt, _pid_rate_roll.get_dt())) {
+        _pid_rate_roll.set_dt(dt);
+        _pid_rate_pitch.set_dt(dt);
+        _pid_rate_yaw.set_dt(dt);
+    }
+
     // move throttle vs attitude mixing towards desired (called from here because this is conveniently called on every iteration)
-    update_throttle_rpy_mix();
+    update_throttle_rpy_mix(dt);
 
     _rate_target_ang_vel += _rate_sysid_ang_vel;
 
-    Vector3f gyro_latest = _ahrs.get_gyro_latest();
-
     _motors.set_roll(get_rate_roll_pid().update_all(_rate_target_ang_vel.x, gyro_latest.x, _motors.limit.roll) + _actuator_sysid.x);
     _motors.set_roll_ff(get_rate_roll_pid().get_ff());
 
@@ -350,6 +370,11 @@ void AC_AttitudeControl_Multi::rate_controller_run()
     _actuator_sysid.zero();
 
     control_monitor_update();
+
+    AP_OutputLatency *latency = AP::output_latency();
+    if (latency != nullptr) {
+        latency->stage(AP_OutputLatency::Stage::RATE_PID);
+    }
 }
 
 // sanity check parameters.  should be called once before takeoff
@@ -75,6 +75,9 @@ public:
     // run lowest level body-frame rate controller and send outputs to the motors
     void rate_controller_run() override;
 
+    // run the rate controller with a gyro sample taken dt seconds after the previous one
+    void rate_controller_run_gyro(const Vector3f &gyro, float dt);
+
     // sanity check parameters.  should be called once before take-off
     void parameter_sanity_check() override;
 
@@ -84,7 +87,10 @@ public:
 protected:
 
     // update_throttle_rpy_mix - updates thr_low_comp value towards the target
-    void update_throttle_rpy_mix();
+    void update_throttle_rpy_mix(float dt);
+
+    // run the rate PIDs on a gyro sample
+    void rate_controller_update(const Vector3f &gyro_latest, float dt);
 
     // get maximum value throttle can be raised to based on throttle vs attitude prioritisation
     float get_throttle_avg_max(float throttle_in);
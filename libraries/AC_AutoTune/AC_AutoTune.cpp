@@ -35,6 +35,13 @@
  *      i) increases stab P until the maximum angle becomes greater than 110% of the requested angle (20deg)
  *      j) decreases stab P by 25%
  *
+ * With AUTOTUNE_METHOD set to frequency response there are no twitches. Instead:
+ *      a) all the axes being tuned are excited together for about 10 seconds, each with a sum of sines on its own frequencies
+ *      b) the response of each rate loop is measured at its frequencies
+ *      c) the rate P and D giving the highest crossover frequency without the loop's peak sensitivity going over 1 + 10 x AUTOTUNE_AGGR are fitted to the response
+ *      d) stab P is set from the bandwidth of the fitted rate loop
+ *      e) this is repeated with the fitted gains, then the tune is complete
+ *
  */
 
 #define AUTOTUNE_AXIS_BITMASK_ROLL            1
@@ -84,6 +91,17 @@
 #define AUTOTUNE_TARGET_MIN_ANGLE_YAW_CD     500    // minimum target angle during TESTING_RATE step that will cause us to move to next step
 #define AUTOTUNE_TARGET_MIN_RATE_YAW_CDS    1500    // minimum target yaw rate during AUTOTUNE_STEP_TWITCHING step
 
+// frequency response method
+#define AUTOTUNE_FREQ_MIN_HZ                1.0f    // lowest excitation frequency
+#define AUTOTUNE_FREQ_MAX_HZ               40.0f    // highest excitation frequency
+#define AUTOTUNE_FREQ_FADE_S                1.0f    // time the excitation fades in over before the response is recorded
+#define AUTOTUNE_FREQ_RECORD_S             10.0f    // time the response is recorded for
+#define AUTOTUNE_FREQ_RATE_RLLPIT_CDS       3000    // peak roll and pitch rate excitation
+#define AUTOTUNE_FREQ_RATE_YAW_CDS          1500    // peak yaw rate excitation
+#define AUTOTUNE_FREQ_ITERATIONS               2    // number of times the response is measured and the gains fitted
+#define AUTOTUNE_FREQ_MAX_FAILURES             3    // number of fits in a row that can fail before the tune fails
+#define AUTOTUNE_FREQ_SP_BANDWIDTH_RATIO   0.25f    // stab P as a ratio of the rate loop bandwidth in rad/s
+
 // Auto Tune message ids for ground station
 #define AUTOTUNE_MESSAGE_STARTED 0
 #define AUTOTUNE_MESSAGE_STOPPED 1
@@ -106,7 +124,7 @@ const AP_Param::GroupInfo AC_AutoTune::var_info[] = {
 
     // @Param: AGGR
     // @DisplayName: Autotune aggressiveness
-    // @Description: Autotune aggressiveness. Defines the bounce back used to detect size of the D term.
+    // @Description: Autotune aggressiveness. Defines the bounce back used to detect size of the D term. With the frequency response method it sets the highest peak sensitivity of the rate loops, which is 1 + 10 x AGGR
     // @Range: 0.05 0.10
     // @User: Standard
     AP_GROUPINFO("AGGR", 2, AC_AutoTune, aggressiveness, 0.1f),
@@ -118,6 +136,13 @@ const AP_Param::GroupInfo AC_AutoTune::var_info[] = {
     // @User: Standard
     AP_GROUPINFO("MIN_D", 3, AC_AutoTune, min_d,  0.001f),
 
+    // @Param: METHOD
+    // @DisplayName: AutoTune method
+    // @Description: How the gains are tuned. Twitch steps each axis in turn and adjusts the gains from how it responds. Frequency response excites all the axes being tuned at once and fits the gains to their measured frequency responses, which takes less flight time
+    // @Values: 0:Twitch,1:Frequency response
+    // @User: Advanced
+    AP_GROUPINFO("METHOD", 4, AC_AutoTune, method, 0),
+
     AP_GROUPEND
 };
 
@@ -258,6 +283,9 @@ void AC_AutoTune::send_step_string()
     case TWITCHING:
         gcs().send_text(MAV_SEVERITY_INFO, "AutoTune: TWITCHING");
         return;
+    case EXCITING:
+        gcs().send_text(MAV_SEVERITY_INFO, "AutoTune: EXCITING");
+        return;
     }
     gcs().send_text(MAV_SEVERITY_INFO, "AutoTune: unknown step");
 }
@@ -285,6 +313,12 @@ void AC_AutoTune::do_gcs_announcements()
     if (now - announce_time < AUTOTUNE_ANNOUNCE_INTERVAL_MS) {
         return;
     }
+    if (Method(method.get()) == Method::FREQ_RESPONSE) {
+        send_step_string();
+        gcs().send_text(MAV_SEVERITY_INFO, "AutoTune: iteration %u/%u", freq_resp_iteration, AUTOTUNE_FREQ_ITERATIONS);
+        announce_time = now;
+        return;
+    }
     float tune_rp = 0.0f;
     float tune_rd = 0.0f;
     float tune_sp = 0.0f;
@@ -475,6 +509,11 @@ bool AC_AutoTune::currently_level()
 // attitude_controller - sets attitude control targets during tuning
 void AC_AutoTune::control_attitude()
 {
+    if (Method(method.get()) == Method::FREQ_RESPONSE) {
+        control_attitude_freq_resp();
+        return;
+    }
+
     rotation_rate = 0.0f;        // rotation rate in radians/second
     lean_angle = 0.0f;
     const float direction_sign = positive_direction ? 1.0f : -1.0f;
@@ -669,6 +708,10 @@ void AC_AutoTune::control_attitude()
         break;
     }
 
+    case EXCITING:
+        // only used by the frequency response method
+        break;
+
     case UPDATE_GAINS:
 
         // re-enable rate limits
@@ -892,6 +935,169 @@ void AC_AutoTune::control_attitude()
     }
 }
 
+// control_attitude_freq_resp - sets attitude control targets during tuning by frequency response
+void AC_AutoTune::control_attitude_freq_resp()
+{
+    const uint32_t now = AP_HAL::millis();
+
+    switch (step) {
+
+    case WAITING_FOR_LEVEL:
+    case TWITCHING:
+        // Note: we should be using intra-test gains (which are very close to the original gains but have lower I)
+        attitude_control->use_sqrt_controller(true);
+
+        get_poshold_attitude(roll_cd, pitch_cd, desired_yaw_cd);
+
+        // hold level attitude
+        attitude_control->input_euler_angle_roll_pitch_yaw(roll_cd, pitch_cd, desired_yaw_cd, true);
+
+        // reset counter if we are no longer level
+        if (!currently_level()) {
+            step_start_time_ms = now;
+        }
+
+        if (now - step_start_time_ms > AUTOTUNE_REQUIRED_LEVEL_TIME_MS) {
+            gcs().send_text(MAV_SEVERITY_INFO, "AutoTune: Exciting");
+            step = EXCITING;
+            step_start_time_ms = now;
+            freq_resp.init(AP::scheduler().get_loop_period_s(), AUTOTUNE_FREQ_MIN_HZ, AUTOTUNE_FREQ_MAX_HZ, AUTOTUNE_FREQ_FADE_S, AUTOTUNE_FREQ_RECORD_S);
+            // the response is measured with the gains being tuned
+            load_gains(GAIN_TUNED);
+        } else {
+            // when waiting for level we use the intra-test gains
+            load_gains(GAIN_INTRA_TEST);
+        }
+        break;
+
+    case EXCITING: {
+        attitude_control->use_sqrt_controller(true);
+
+        // the rate controllers have just run on these targets,
+        // excitation included, giving these rates
+        freq_resp.update(attitude_control->rate_bf_targets(), ahrs_view->get_gyro());
+        if (freq_resp.complete()) {
+            step = UPDATE_GAINS;
+        }
+
+        // hold level, with the excitation on top of the rate targets
+        get_poshold_attitude(roll_cd, pitch_cd, desired_yaw_cd);
+        attitude_control->input_euler_angle_roll_pitch_yaw(roll_cd, pitch_cd, desired_yaw_cd, true);
+
+        const Vector3f excitation = freq_resp.excitation();
+        if (roll_enabled()) {
+            attitude_control->rate_bf_roll_sysid(radians(excitation.x * AUTOTUNE_FREQ_RATE_RLLPIT_CDS * 0.01f));
+        }
+        if (pitch_enabled()) {
+            attitude_control->rate_bf_pitch_sysid(radians(excitation.y * AUTOTUNE_FREQ_RATE_RLLPIT_CDS * 0.01f));
+        }
+        if (yaw_enabled()) {
+            attitude_control->rate_bf_yaw_sysid(radians(excitation.z * AUTOTUNE_FREQ_RATE_YAW_CDS * 0.01f));
+        }
+
+        // start again if we have been pushed too far from level
+        lean_angle = MAX(fabsf(ahrs_view->roll_sensor - roll_cd), fabsf(ahrs_view->pitch_sensor - pitch_cd));
+        if (lean_angle > AUTOTUNE_TARGET_ANGLE_RLLPIT_CD) {
+            gcs().send_text(MAV_SEVERITY_WARNING, "AutoTune: lean angle limit, restarting excitation");
+            load_gains(GAIN_INTRA_TEST);
+            step = WAITING_FOR_LEVEL;
+            step_start_time_ms = now;
+            level_start_time_ms = now;
+        }
+
+        AP::logger().Write_Rate(ahrs_view, *motors, *attitude_control, *pos_control);
+        log_pids();
+        break;
+    }
+
+    case UPDATE_GAINS:
+        if (update_gains_freq_resp()) {
+            freq_resp_iteration++;
+            freq_resp_failures = 0;
+        } else if (++freq_resp_failures >= AUTOTUNE_FREQ_MAX_FAILURES) {
+            mode = FAILED;
+            load_gains(GAIN_ORIGINAL);
+            update_gcs(AUTOTUNE_MESSAGE_FAILED);
+            Log_Write_Event(EVENT_AUTOTUNE_FAILED);
+            break;
+        } else {
+            gcs().send_text(MAV_SEVERITY_WARNING, "AutoTune: poor response, repeating excitation");
+        }
+
+        if (freq_resp_iteration >= AUTOTUNE_FREQ_ITERATIONS) {
+            if (roll_enabled()) {
+                axes_completed |= AUTOTUNE_AXIS_BITMASK_ROLL;
+            }
+            if (pitch_enabled()) {
+                axes_completed |= AUTOTUNE_AXIS_BITMASK_PITCH;
+            }
+            if (yaw_enabled()) {
+                axes_completed |= AUTOTUNE_AXIS_BITMASK_YAW;
+            }
+            mode = SUCCESS;
+            update_gcs(AUTOTUNE_MESSAGE_SUCCESS);
+            Log_Write_Event(EVENT_AUTOTUNE_SUCCESS);
+            AP_Notify::events.autotune_complete = true;
+        }
+
+        // set gains to their intra-test values (which are very close to the original gains)
+        load_gains(GAIN_INTRA_TEST);
+
+        step = WAITING_FOR_LEVEL;
+        step_start_time_ms = now;
+        level_start_time_ms = step_start_time_ms;
+        break;
+    }
+}
+
+// update_gains_freq_resp - fit the gains of all the axes being tuned to their
+// measured frequency responses. Returns false if any of them could not be fitted
+bool AC_AutoTune::update_gains_freq_resp()
+{
+    bool success = true;
+    if (roll_enabled()) {
+        success &= fit_freq_resp_gains(ROLL, attitude_control->get_rate_roll_pid(), AUTOTUNE_PI_RATIO_FINAL, tune_roll_rp, tune_roll_rd, tune_roll_sp);
+    }
+    if (pitch_enabled()) {
+        success &= fit_freq_resp_gains(PITCH, attitude_control->get_rate_pitch_pid(), AUTOTUNE_PI_RATIO_FINAL, tune_pitch_rp, tune_pitch_rd, tune_pitch_sp);
+    }
+    if (yaw_enabled()) {
+        // yaw runs without D
+        float tune_yaw_rd = 0.0f;
+        success &= fit_freq_resp_gains(YAW, attitude_control->get_rate_yaw_pid(), AUTOTUNE_YAW_PI_RATIO_FINAL, tune_yaw_rp, tune_yaw_rd, tune_yaw_sp);
+    }
+    return success;
+}
+
+// fit_freq_resp_gains - fit the rate gains of an axis to its frequency
+// response, measured while flying on them, and set stab P to suit
+bool AC_AutoTune::fit_freq_resp_gains(AxisType tune_axis, AC_PID &pid, float i_ratio, float &tune_rp, float &tune_rd, float &tune_sp)
+{
+    const AC_AutoTune_FreqResp::Gains flown {
+        tune_rp,
+        tune_rp * i_ratio,
+        tune_rd,
+        pid.filt_T_hz(),
+        pid.filt_E_hz(),
+        pid.filt_D_hz()
+    };
+
+    AC_AutoTune_FreqResp::Fit fit;
+    if (!freq_resp.fit_gains(tune_axis, flown, 1.0f + 10.0f * aggressiveness, i_ratio, tune_axis != YAW, fit)) {
+        gcs().send_text(MAV_SEVERITY_WARNING, "AutoTune: no response on axis %u", (unsigned)tune_axis);
+        return false;
+    }
+
+    tune_rp = constrain_float(fit.gains.p, AUTOTUNE_RP_MIN, AUTOTUNE_RP_MAX);
+    if (tune_axis != YAW) {
+        tune_rd = constrain_float(fit.gains.d, min_d, AUTOTUNE_RD_MAX);
+    }
+    tune_sp = constrain_float(fit.bandwidth_hz * M_2PI * AUTOTUNE_FREQ_SP_BANDWIDTH_RATIO, AUTOTUNE_SP_MIN, AUTOTUNE_SP_MAX);
+
+    Log_Write_AutoTuneFreqResp(tune_axis, fit, tune_rp, tune_rd, tune_sp);
+    return true;
+}
+
 // backup_gains_and_initialise - store current gains as originals
 //  called before tuning starts to backup original gains
 void AC_AutoTune::backup_gains_and_initialise()
@@ -913,6 +1119,8 @@ void AC_AutoTune::backup_gains_and_initialise()
     level_start_time_ms = step_start_time_ms;
     tune_type = RD_UP;
     step_scaler = 1.0f;
+    freq_resp_iteration = 0;
+    freq_resp_failures = 0;
 
     desired_yaw_cd = ahrs_view->yaw_sensor;
 
@@ -1724,3 +1932,43 @@ void AC_AutoTune::Log_Write_AutoTuneDetails(float angle_cd, float rate_cds)
         angle_cd*0.01f,
         rate_cds*0.01f);
 }
+
+// Write the frequency response of an axis and the gains fitted to it
+void AC_AutoTune::Log_Write_AutoTuneFreqResp(uint8_t tune_axis, const AC_AutoTune_FreqResp::Fit &fit, float new_gain_rp, float new_gain_rd, float new_gain_sp)
+{
+    const uint64_t now_us = AP_HAL::micros64();
+    for (uint8_t bin = 0; bin < AUTOTUNE_FREQ_BINS; bin++) {
+        float freq_hz;
+        AC_AutoTune_FreqResp::Complex response;
+        if (!freq_resp.response(tune_axis, bin, freq_hz, response)) {
+            continue;
+        }
+        AP::logger().Write(
+            "ATFR",
+            "TimeUS,Axis,Freq,Gain,Phase",
+            "s-z-d",
+            "F-0-0",
+            "QBfff",
+            now_us,
+            tune_axis,
+            freq_hz,
+            norm(response.re, response.im),
+            degrees(atan2f(response.im, response.re)));
+    }
+
+    AP::logger().Write(
+        "ATFS",
+        "TimeUS,Axis,Iter,Xover,BW,Ms,RP,RD,SP",
+        "s--zz----",
+        "F--00----",
+        "QBBffffff",
+        now_us,
+        tune_axis,
+        freq_resp_iteration,
+        fit.crossover_hz,
+        fit.bandwidth_hz,
+        fit.sensitivity,
+        new_gain_rp,
+        new_gain_rd,
+        new_gain_sp);
+}
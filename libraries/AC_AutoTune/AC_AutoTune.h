@@ -22,6 +22,7 @@
 #include <AP_HAL/AP_HAL.h>
 #include <AC_AttitudeControl/AC_AttitudeControl_Multi.h>
 #include <AC_AttitudeControl/AC_PosControl.h>
+#include "AC_AutoTune_FreqResp.h"
 
 class AC_AutoTune {
 public:
@@ -113,6 +114,7 @@ private:
 
     void Log_Write_AutoTune(uint8_t axis, uint8_t tune_step, float meas_target, float meas_min, float meas_max, float new_gain_rp, float new_gain_rd, float new_gain_sp, float new_ddt);
     void Log_Write_AutoTuneDetails(float angle_cd, float rate_cds);
+    void Log_Write_AutoTuneFreqResp(uint8_t tune_axis, const AC_AutoTune_FreqResp::Fit &fit, float new_gain_rp, float new_gain_rd, float new_gain_sp);
 
     void send_step_string();
     const char *level_issue_string() const;
@@ -144,7 +146,14 @@ private:
     enum StepType {
         WAITING_FOR_LEVEL = 0,    // autotune is waiting for vehicle to return to level before beginning the next twitch
         TWITCHING = 1,            // autotune has begun a twitch and is watching the resulting vehicle movement
-        UPDATE_GAINS = 2          // autotune has completed a twitch and is updating the gains based on the results
+        UPDATE_GAINS = 2,         // autotune has completed a twitch and is updating the gains based on the results
+        EXCITING = 3              // autotune is exciting all the axes being tuned and measuring their frequency response
+    };
+
+    // ways of tuning the gains
+    enum class Method : uint8_t {
+        TWITCH = 0,               // twitch each axis in turn, stepping the gains from the responses
+        FREQ_RESPONSE = 1,        // excite the axes together and fit the gains to their frequency responses
     };
 
     // things that can be tuned
@@ -172,6 +181,11 @@ private:
     };
     void load_gains(enum GainType gain_type);
 
+    // frequency response method
+    void control_attitude_freq_resp();
+    bool update_gains_freq_resp();
+    bool fit_freq_resp_gains(AxisType tune_axis, AC_PID &pid, float i_ratio, float &tune_rp, float &tune_rd, float &tune_sp);
+
     TuneMode mode                : 2;    // see TuneMode for what modes are allowed
     bool     pilot_override      : 1;    // true = pilot is overriding controls so we suspend tuning temporarily
     AxisType axis                : 2;    // see AxisType for which things can be tuned
@@ -204,6 +218,10 @@ private:
 
     LowPassFilterFloat  rotation_rate_filt;         // filtered rotation rate in radians/second
 
+    AC_AutoTune_FreqResp freq_resp;                 // frequency response of the axes being tuned
+    uint8_t  freq_resp_iteration;                   // frequency responses measured and fitted so far
+    uint8_t  freq_resp_failures;                    // fits that have failed in a row
+
     // backup of currently being tuned parameter values
     float    orig_roll_rp, orig_roll_ri, orig_roll_rd, orig_roll_rff, orig_roll_sp, orig_roll_accel;
     float    orig_pitch_rp, orig_pitch_ri, orig_pitch_rd, orig_pitch_rff, orig_pitch_sp, orig_pitch_accel;
@@ -231,6 +249,7 @@ private:
     AP_Int8  axis_bitmask;
     AP_Float aggressiveness;
     AP_Float min_d;
+    AP_Int8  method;
 
     // copies of object pointers to make code a bit clearer
     AC_AttitudeControl_Multi *attitude_control;
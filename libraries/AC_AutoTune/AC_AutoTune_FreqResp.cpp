@@ -0,0 +1,290 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AC_AutoTune_FreqResp.h"
+
+// highest loop gain allowed at the top of the measured band
+#define AUTOTUNE_FREQ_MAX_END_LOOP_GAIN   0.5f
+
+typedef AC_AutoTune_FreqResp::Complex Complex;
+
+static Complex complex_mul(const Complex &a, const Complex &b)
+{
+    return Complex{a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re};
+}
+
+static Complex complex_div(const Complex &a, const Complex &b)
+{
+    const float norm = b.re * b.re + b.im * b.im;
+    if (!is_positive(norm)) {
+        return Complex{0.0f, 0.0f};
+    }
+    return Complex{(a.re * b.re + a.im * b.im) / norm, (a.im * b.re - a.re * b.im) / norm};
+}
+
+static float complex_abs(const Complex &a)
+{
+    return norm(a.re, a.im);
+}
+
+// frequency at which a magnitude falling through limit crosses it, interpolated on log scales
+static float interpolate_crossing(float freq0, float mag0, float freq1, float mag1, float limit)
+{
+    const float log_mag0 = logf(MAX(mag0, FLT_EPSILON));
+    const float log_mag1 = logf(MAX(mag1, FLT_EPSILON));
+    if (is_equal(log_mag0, log_mag1)) {
+        return freq0;
+    }
+    const float ratio = constrain_float((log_mag0 - logf(limit)) / (log_mag0 - log_mag1), 0.0f, 1.0f);
+    return freq0 * powf(freq1 / freq0, ratio);
+}
+
+void AC_AutoTune_FreqResp::init(float dt, float min_hz, float max_hz, float fade_s, float record_s)
+{
+    _fade_samples = constrain_float(fade_s / dt, 0.0f, UINT16_MAX / 2);
+    _record_samples = constrain_float(record_s / dt, 1.0f, UINT16_MAX / 2);
+    _count = 0;
+
+    // keep well below the Nyquist frequency so the sines are not lost in the filtering
+    max_hz = MIN(max_hz, 0.25f / dt);
+    min_hz = MIN(min_hz, max_hz);
+
+    // log spaced frequencies, dealt out to the axes in turn so each
+    // covers the whole band. Each is rounded to a whole number of
+    // cycles over the recording so they are orthogonal
+    const float record_time = _record_samples * dt;
+    const uint8_t num_freqs = AUTOTUNE_FREQ_AXES * AUTOTUNE_FREQ_BINS;
+    uint16_t last_cycles = 0;
+    for (uint8_t i = 0; i < num_freqs; i++) {
+        const float freq_hz = min_hz * powf(max_hz / min_hz, float(i) / (num_freqs - 1));
+        const uint16_t cycles = MAX(uint16_t(roundf(freq_hz * record_time)), uint16_t(last_cycles + 1));
+        last_cycles = cycles;
+
+        const uint8_t bin = i / AUTOTUNE_FREQ_AXES;
+        auto &b = _bins[i % AUTOTUNE_FREQ_AXES][bin];
+        b.freq_hz = cycles / record_time;
+        const float angle_step = M_2PI * b.freq_hz * dt;
+        b.step = Complex{cosf(angle_step), sinf(angle_step)};
+        // Schroeder phases keep the peak of the sum of sines low
+        const float phase = -M_PI * (bin + 1) * bin / AUTOTUNE_FREQ_BINS;
+        b.phasor = Complex{cosf(phase), sinf(phase)};
+        b.target = Complex{0.0f, 0.0f};
+        b.measured = Complex{0.0f, 0.0f};
+    }
+
+    // Schroeder phased multisines peak at about 1.6 times their rms
+    _amplitude = 1.0f / (1.6f * sqrtf(AUTOTUNE_FREQ_BINS * 0.5f));
+}
+
+Vector3f AC_AutoTune_FreqResp::excitation() const
+{
+    Vector3f ret;
+    if (complete()) {
+        return ret;
+    }
+    float scale = _amplitude;
+    if (_count < _fade_samples) {
+        scale *= float(_count) / _fade_samples;
+    }
+    for (uint8_t axis = 0; axis < AUTOTUNE_FREQ_AXES; axis++) {
+        float sum = 0.0f;
+        for (uint8_t bin = 0; bin < AUTOTUNE_FREQ_BINS; bin++) {
+            sum += _bins[axis][bin].phasor.im;
+        }
+        ret[axis] = sum * scale;
+    }
+    return ret;
+}
+
+void AC_AutoTune_FreqResp::update(const Vector3f &target, const Vector3f &measured)
+{
+    if (complete()) {
+        return;
+    }
+    const bool recording = _count >= _fade_samples;
+    for (uint8_t axis = 0; axis < AUTOTUNE_FREQ_AXES; axis++) {
+        for (uint8_t bin = 0; bin < AUTOTUNE_FREQ_BINS; bin++) {
+            auto &b = _bins[axis][bin];
+            if (recording) {
+                b.target.re += target[axis] * b.phasor.re;
+                b.target.im -= target[axis] * b.phasor.im;
+                b.measured.re += measured[axis] * b.phasor.re;
+                b.measured.im -= measured[axis] * b.phasor.im;
+            }
+            // step the phase on, correcting the magnitude for rounding errors
+            const Complex next = complex_mul(b.phasor, b.step);
+            const float correction = 1.5f - 0.5f * (next.re * next.re + next.im * next.im);
+            b.phasor = Complex{next.re * correction, next.im * correction};
+        }
+    }
+    _count++;
+}
+
+bool AC_AutoTune_FreqResp::response(uint8_t axis, uint8_t bin, float &freq_hz, Complex &resp) const
+{
+    if (!complete() || axis >= AUTOTUNE_FREQ_AXES || bin >= AUTOTUNE_FREQ_BINS) {
+        return false;
+    }
+    const auto &b = _bins[axis][bin];
+    if (is_zero(complex_abs(b.target))) {
+        return false;
+    }
+    freq_hz = b.freq_hz;
+    resp = complex_div(b.measured, b.target);
+    return true;
+}
+
+Complex AC_AutoTune_FreqResp::controller_response(const Gains &gains, float freq_hz)
+{
+    const float omega = M_2PI * freq_hz;
+
+    // P and I
+    Complex ret{gains.p, -gains.i / omega};
+
+    // D, through its low pass filter
+    if (is_positive(gains.filt_d_hz)) {
+        const float ratio = omega / (M_2PI * gains.filt_d_hz);
+        const float scale = gains.d / (1.0f + ratio * ratio);
+        ret.re += scale * omega * ratio;
+        ret.im += scale * omega;
+    } else {
+        ret.im += gains.d * omega;
+    }
+
+    // all the terms act on the error after its low pass filter
+    if (is_positive(gains.filt_e_hz)) {
+        ret = complex_div(ret, Complex{1.0f, omega / (M_2PI * gains.filt_e_hz)});
+    }
+    return ret;
+}
+
+uint8_t AC_AutoTune_FreqResp::plant_response(uint8_t axis, const Gains &flown, float freq_hz[], Complex plant[]) const
+{
+    uint8_t count = 0;
+    for (uint8_t bin = 0; bin < AUTOTUNE_FREQ_BINS; bin++) {
+        Complex closed;
+        if (!response(axis, bin, freq_hz[count], closed)) {
+            continue;
+        }
+        // the target filter is outside the loop
+        if (is_positive(flown.filt_t_hz)) {
+            closed = complex_mul(closed, Complex{1.0f, freq_hz[count] / flown.filt_t_hz});
+        }
+        // open loop response from the closed loop, then take out the controller
+        const Complex loop = complex_div(closed, Complex{1.0f - closed.re, -closed.im});
+        const Complex controller = controller_response(flown, freq_hz[count]);
+        if (is_zero(complex_abs(controller))) {
+            continue;
+        }
+        plant[count++] = complex_div(loop, controller);
+    }
+    return count;
+}
+
+bool AC_AutoTune_FreqResp::evaluate(const float freq_hz[], const Complex plant[], uint8_t count, const Gains &gains,
+                                    float &sensitivity, float &crossover_hz, float &bandwidth_hz)
+{
+    sensitivity = 0.0f;
+    crossover_hz = freq_hz[count - 1];
+    bandwidth_hz = freq_hz[count - 1];
+    bool found_crossover = false;
+    bool found_bandwidth = false;
+    float last_loop_mag = 0.0f;
+    float last_closed_mag = 0.0f;
+    for (uint8_t i = 0; i < count; i++) {
+        const Complex loop = complex_mul(plant[i], controller_response(gains, freq_hz[i]));
+        const Complex one_plus_loop{1.0f + loop.re, loop.im};
+        const float loop_mag = complex_abs(loop);
+        const float closed_mag = complex_abs(complex_div(loop, one_plus_loop));
+        sensitivity = MAX(sensitivity, 1.0f / MAX(complex_abs(one_plus_loop), FLT_EPSILON));
+
+        if (!found_crossover && loop_mag < 1.0f) {
+            found_crossover = true;
+            crossover_hz = (i == 0) ? freq_hz[0] : interpolate_crossing(freq_hz[i-1], last_loop_mag, freq_hz[i], loop_mag, 1.0f);
+        }
+        if (!found_bandwidth && closed_mag < M_SQRT1_2) {
+            found_bandwidth = true;
+            bandwidth_hz = (i == 0) ? freq_hz[0] : interpolate_crossing(freq_hz[i-1], last_closed_mag, freq_hz[i], closed_mag, M_SQRT1_2);
+        }
+        last_loop_mag = loop_mag;
+        last_closed_mag = closed_mag;
+    }
+    return last_loop_mag < AUTOTUNE_FREQ_MAX_END_LOOP_GAIN;
+}
+
+bool AC_AutoTune_FreqResp::fit_gains(uint8_t axis, const Gains &flown, float max_sensitivity, float i_ratio, bool tune_d, Fit &fit) const
+{
+    float freq_hz[AUTOTUNE_FREQ_BINS];
+    Complex plant[AUTOTUNE_FREQ_BINS];
+    const uint8_t count = plant_response(axis, flown, freq_hz, plant);
+    if (count < AUTOTUNE_FREQ_BINS / 2) {
+        return false;
+    }
+
+    // D to P ratios tried, relative to the flown ratio
+    static const float d_ratios[] = { 0.5f, 0.7f, 1.0f, 1.4f, 2.0f };
+    const float min_scale = 0.25f;
+    const float max_scale = 4.0f;
+
+    bool found = false;
+    float best_crossover_hz = 0.0f;
+    float lowest_sensitivity = FLT_MAX;
+    for (uint8_t r = 0; r < ARRAY_SIZE(d_ratios); r++) {
+        const float d_ratio = tune_d ? d_ratios[r] : 1.0f;
+        if (!tune_d && r != 2) {
+            continue;
+        }
+
+        // the sensitivity peak grows with the gains, so bisect on a log
+        // scale for the highest gains that keep it below the limit and
+        // the crossover inside the measured band
+        Gains gains = flown;
+        float sensitivity, crossover_hz, bandwidth_hz;
+        float low = logf(min_scale);
+        float high = logf(max_scale);
+        for (uint8_t i = 0; i < 12; i++) {
+            const float scale = expf(0.5f * (low + high));
+            gains.p = flown.p * scale;
+            gains.d = flown.d * scale * d_ratio;
+            gains.i = gains.p * i_ratio;
+            if (!evaluate(freq_hz, plant, count, gains, sensitivity, crossover_hz, bandwidth_hz) ||
+                sensitivity > max_sensitivity) {
+                high = 0.5f * (low + high);
+            } else {
+                low = 0.5f * (low + high);
+            }
+        }
+        const float scale = expf(low);
+        gains.p = flown.p * scale;
+        gains.d = flown.d * scale * d_ratio;
+        gains.i = gains.p * i_ratio;
+        const bool measured = evaluate(freq_hz, plant, count, gains, sensitivity, crossover_hz, bandwidth_hz);
+
+        // prefer the highest crossover within the limit, otherwise the
+        // lowest sensitivity found
+        const bool within_limit = measured && sensitivity <= max_sensitivity;
+        if ((within_limit && (!found || crossover_hz > best_crossover_hz)) ||
+            (!found && sensitivity < lowest_sensitivity)) {
+            found = within_limit;
+            best_crossover_hz = crossover_hz;
+            lowest_sensitivity = sensitivity;
+            fit.gains = gains;
+            fit.crossover_hz = crossover_hz;
+            fit.bandwidth_hz = bandwidth_hz;
+            fit.sensitivity = sensitivity;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,105 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  frequency response measurement of the rate loops for autotune.
+
+  All the axes are excited at once, each with a multisine on its own
+  set of frequencies. The frequencies are a whole number of cycles over
+  the recording, so the response of each axis can be separated from
+  the others with a DFT at just those frequencies.
+ */
+
+#pragma once
+
+#include <AP_Math/AP_Math.h>
+
+#define AUTOTUNE_FREQ_AXES                    3
+#define AUTOTUNE_FREQ_BINS                   10     // frequencies each axis is excited at
+
+class AC_AutoTune_FreqResp {
+public:
+    struct Complex {
+        float re;
+        float im;
+    };
+
+    // gains of a rate PID and the filters it runs with
+    struct Gains {
+        float p;
+        float i;
+        float d;
+        float filt_t_hz;
+        float filt_e_hz;
+        float filt_d_hz;
+    };
+
+    // result of fitting the gains of an axis
+    struct Fit {
+        Gains gains;            // fitted gains
+        float crossover_hz;     // crossover frequency of the loop with the fitted gains
+        float bandwidth_hz;     // -3dB bandwidth of the rate loop with the fitted gains
+        float sensitivity;      // peak sensitivity with the fitted gains
+    };
+
+    // set up an excitation between min_hz and max_hz, for a loop period
+    // of dt. The response is recorded for record_s after fade_s
+    void init(float dt, float min_hz, float max_hz, float fade_s, float record_s);
+
+    // excitation of each axis for the next sample, with a peak of about one
+    Vector3f excitation() const;
+
+    // record the rate targets the rate controllers ran on for the last
+    // sample and the rates measured since, and move on to the next sample
+    void update(const Vector3f &target, const Vector3f &measured);
+
+    // true once the response has been recorded
+    bool complete() const { return _count >= _fade_samples + _record_samples; }
+
+    // closed loop response from rate target to measured rate at a frequency of an axis
+    bool response(uint8_t axis, uint8_t bin, float &freq_hz, Complex &response) const;
+
+    // fit the gains of an axis with the highest crossover frequency for
+    // which the peak sensitivity stays below max_sensitivity. flown are
+    // the gains the response was measured with. The I gain is kept at
+    // i_ratio times P, and D is only changed relative to P if tune_d is true
+    bool fit_gains(uint8_t axis, const Gains &flown, float max_sensitivity, float i_ratio, bool tune_d, Fit &fit) const;
+
+private:
+    // response of the PID controller at a frequency
+    static Complex controller_response(const Gains &gains, float freq_hz);
+
+    // response of everything in the loop but the controller, for each
+    // frequency of an axis that has a usable measurement
+    uint8_t plant_response(uint8_t axis, const Gains &flown, float freq_hz[], Complex plant[]) const;
+
+    // peak sensitivity, crossover and bandwidth of the loop closed around
+    // the plant with gains. Returns false if the loop gain has not fallen
+    // far enough by the highest frequency to see its sensitivity peak
+    static bool evaluate(const float freq_hz[], const Complex plant[], uint8_t count, const Gains &gains,
+                         float &sensitivity, float &crossover_hz, float &bandwidth_hz);
+
+    float _amplitude;               // amplitude of each sine for a peak of about one
+    uint16_t _fade_samples;
+    uint16_t _record_samples;
+    uint16_t _count;                // samples since the excitation started
+
+    struct {
+        float freq_hz;
+        Complex phasor;             // phase of this frequency at the current sample
+        Complex step;               // change in phase each sample
+        Complex target;             // DFT of the rate target
+        Complex measured;           // DFT of the measured rate
+    } _bins[AUTOTUNE_FREQ_AXES][AUTOTUNE_FREQ_BINS];
+};
@@ -406,7 +406,7 @@ void AC_Avoid::adjust_velocity_inclusion_and_exclusion_polygons(float kP, float
             continue;
         }
         // adjust velocity
-        adjust_velocity_polygon(kP, accel_cmss, desired_vel_cms, boundary, num_points, true, fence->get_margin(), dt, true);
+        adjust_velocity_polygon(kP, accel_cmss, desired_vel_cms, boundary, num_points, true, fence->get_margin(), dt, true, fence->polyfence().get_inclusion_polygon_index(i));
     }
 
     // iterate through exclusion polygons
@@ -419,7 +419,7 @@ void AC_Avoid::adjust_velocity_inclusion_and_exclusion_polygons(float kP, float
             continue;
         }
         // adjust velocity
-        adjust_velocity_polygon(kP, accel_cmss, desired_vel_cms, boundary, num_points, true, fence->get_margin(), dt, false);
+        adjust_velocity_polygon(kP, accel_cmss, desired_vel_cms, boundary, num_points, true, fence->get_margin(), dt, false, fence->polyfence().get_exclusion_polygon_index(i));
     }
 }
 
@@ -703,7 +703,7 @@ void AC_Avoid::adjust_velocity_proximity(float kP, float accel_cmss, Vector2f &d
 /*
  * Adjusts the desired velocity for the polygon fence.
  */
-void AC_Avoid::adjust_velocity_polygon(float kP, float accel_cmss, Vector2f &desired_vel_cms, const Vector2f* boundary, uint16_t num_points, bool earth_frame, float margin, float dt, bool stay_inside)
+void AC_Avoid::adjust_velocity_polygon(float kP, float accel_cmss, Vector2f &desired_vel_cms, const Vector2f* boundary, uint16_t num_points, bool earth_frame, float margin, float dt, bool stay_inside, const Polygon_index *index)
 {
     // exit if there are no points
     if (boundary == nullptr || num_points == 0) {
@@ -729,7 +729,7 @@ void AC_Avoid::adjust_velocity_polygon(float kP, float accel_cmss, Vector2f &des
     }
 
     // return if we have already breached polygon
-    const bool inside_polygon = !Polygon_outside(position_xy, boundary, num_points);
+    const bool inside_polygon = (index != nullptr) ? !index->outside(position_xy) : !Polygon_outside(position_xy, boundary, num_points);
     if (inside_polygon != stay_inside) {
         return;
     }
@@ -752,7 +752,32 @@ void AC_Avoid::adjust_velocity_polygon(float kP, float accel_cmss, Vector2f &des
     const float speed = safe_vel.length();
     const Vector2f stopping_point_plus_margin = position_xy + safe_vel*((2.0f + margin_cm + get_stopping_distance(kP, accel_cmss, speed))/speed);
 
-    for (uint16_t i=0; i<num_points; i++) {
+    // body-frame boundaries are fixed relative to the vehicle so sliding uses the cached edge geometry
+    if (!earth_frame && ((AC_Avoid::BehaviourType)_behavior.get() == BEHAVIOR_SLIDE)) {
+        bool on_edge;
+        if (adjust_velocity_body_frame_slide(kP, accel_cmss, safe_vel, boundary, num_points, margin_cm, dt, on_edge)) {
+            if (on_edge) {
+                // We are exactly on an edge - treat this as a fence breach.
+                // i.e. do not adjust velocity.
+                return;
+            }
+            // rotate resulting vector back to earth-frame
+            desired_vel_cms.x = safe_vel.x * _ahrs.cos_yaw() - safe_vel.y * _ahrs.sin_yaw();
+            desired_vel_cms.y = safe_vel.x * _ahrs.sin_yaw() + safe_vel.y * _ahrs.cos_yaw();
+            return;
+        }
+    }
+
+    // when stopping only edges near the path to the stopping point can be intersected
+    // sliding limits velocity against every edge so can't use the index
+    const bool use_index = (index != nullptr) && ((AC_Avoid::BehaviourType)_behavior.get() != BEHAVIOR_SLIDE);
+    Polygon_index::EdgeIterator edge_it;
+    if (use_index) {
+        index->edges_start(edge_it, position_xy, stopping_point_plus_margin);
+    }
+
+    // with the index, i is set to the next nearby edge each time around the loop
+    for (uint16_t i=0; use_index ? index->edges_next(edge_it, i) : (i<num_points); i++) {
         uint16_t j = i+1;
         if (j >= num_points) {
             j = 0;
@@ -810,6 +835,102 @@ void AC_Avoid::adjust_velocity_polygon(float kP, float accel_cmss, Vector2f &des
     }
 }
 
+/*
+ * Slides the body-frame velocity along every edge of a body-frame boundary
+ *   returns false if the edge geometry could not be cached, in which case the velocity is unchanged
+ */
+bool AC_Avoid::adjust_velocity_body_frame_slide(float kP, float accel_cmss, Vector2f &safe_vel, const Vector2f* boundary, uint16_t num_points, float margin_cm, float dt, bool &on_edge)
+{
+    if (!update_edge_cache(boundary, num_points)) {
+        return false;
+    }
+    on_edge = _edge_cache.on_edge;
+    if (on_edge) {
+        return true;
+    }
+
+    // the maximum speed towards each edge does not depend on the velocity so calculate them all in one pass
+    const float *dir_x = _edge_cache.dir_x;
+    const float *dir_y = _edge_cache.dir_y;
+    const float *dist_cm = _edge_cache.dist_cm;
+    float *max_speed = _edge_cache.max_speed;
+    for (uint16_t i=0; i<num_points; i++) {
+        max_speed[i] = get_max_speed(kP, accel_cmss, MAX(dist_cm[i] - margin_cm, 0.0f), dt);
+    }
+
+    // each edge limits the velocity already limited by the edges before it, as in limit_velocity
+    for (uint16_t i=0; i<num_points; i++) {
+        const float speed = safe_vel.x * dir_x[i] + safe_vel.y * dir_y[i];
+        if (speed > max_speed[i]) {
+            const float diff = max_speed[i] - speed;
+            safe_vel.x += dir_x[i] * diff;
+            safe_vel.y += dir_y[i] * diff;
+        }
+    }
+    return true;
+}
+
+/*
+ * Updates _edge_cache for a body-frame boundary, recalculating the geometry only if the boundary has changed
+ *   returns false on allocation failure
+ */
+bool AC_Avoid::update_edge_cache(const Vector2f* boundary, uint16_t num_points)
+{
+    if ((num_points == _edge_cache.num_points) &&
+        (memcmp(boundary, _edge_cache.points, num_points * sizeof(Vector2f)) == 0)) {
+        return true;
+    }
+
+    if (num_points > _edge_cache.size) {
+        delete[] _edge_cache.points;
+        delete[] _edge_cache.dir_x;
+        delete[] _edge_cache.dir_y;
+        delete[] _edge_cache.dist_cm;
+        delete[] _edge_cache.max_speed;
+        _edge_cache.points = new Vector2f[num_points];
+        _edge_cache.dir_x = new float[num_points];
+        _edge_cache.dir_y = new float[num_points];
+        _edge_cache.dist_cm = new float[num_points];
+        _edge_cache.max_speed = new float[num_points];
+        if ((_edge_cache.points == nullptr) || (_edge_cache.dir_x == nullptr) || (_edge_cache.dir_y == nullptr) ||
+            (_edge_cache.dist_cm == nullptr) || (_edge_cache.max_speed == nullptr)) {
+            delete[] _edge_cache.points;
+            delete[] _edge_cache.dir_x;
+            delete[] _edge_cache.dir_y;
+            delete[] _edge_cache.dist_cm;
+            delete[] _edge_cache.max_speed;
+            _edge_cache = {};
+            return false;
+        }
+        _edge_cache.size = num_points;
+    }
+
+    memcpy(_edge_cache.points, boundary, num_points * sizeof(Vector2f));
+    _edge_cache.num_points = num_points;
+    _edge_cache.on_edge = false;
+
+    // the vehicle is at the origin so the direction to each edge is just its closest point to the origin
+    const Vector2f origin;
+    for (uint16_t i=0; i<num_points; i++) {
+        uint16_t j = i+1;
+        if (j >= num_points) {
+            j = 0;
+        }
+        Vector2f limit_direction = Vector2f::closest_point(origin, boundary[j], boundary[i]);
+        const float limit_distance_cm = limit_direction.length();
+        if (is_zero(limit_distance_cm)) {
+            _edge_cache.on_edge = true;
+            limit_direction.zero();
+        } else {
+            limit_direction /= limit_distance_cm;
+        }
+        _edge_cache.dir_x[i] = limit_direction.x;
+        _edge_cache.dir_y[i] = limit_direction.y;
+        _edge_cache.dist_cm[i] = limit_distance_cm;
+    }
+    return true;
+}
+
 /*
  * Computes distance required to stop, given current speed.
  *
@@ -123,7 +123,19 @@ private:
      *   margin is the distance (in meters) that the vehicle should stop short of the polygon
      *   stay_inside should be true for fences, false for exclusion polygons
      */
-    void adjust_velocity_polygon(float kP, float accel_cmss, Vector2f &desired_vel_cms, const Vector2f* boundary, uint16_t num_points, bool earth_frame, float margin, float dt, bool stay_inside);
+    void adjust_velocity_polygon(float kP, float accel_cmss, Vector2f &desired_vel_cms, const Vector2f* boundary, uint16_t num_points, bool earth_frame, float margin, float dt, bool stay_inside, const Polygon_index *index = nullptr);
+
+    /*
+     * Slides the body-frame velocity along every edge of a body-frame boundary
+     *   returns false if the edge geometry could not be cached, in which case the velocity is unchanged
+     */
+    bool adjust_velocity_body_frame_slide(float kP, float accel_cmss, Vector2f &safe_vel, const Vector2f* boundary, uint16_t num_points, float margin_cm, float dt, bool &on_edge);
+
+    /*
+     * Updates _edge_cache for a body-frame boundary, recalculating the geometry only if the boundary has changed
+     *   returns false on allocation failure
+     */
+    bool update_edge_cache(const Vector2f* boundary, uint16_t num_points);
 
     /*
      * Computes distance required to stop, given current speed.
@@ -149,6 +161,19 @@ private:
 
     bool _proximity_enabled = true; // true if proximity sensor based avoidance is enabled (used to allow pilot to enable/disable)
 
+    // geometry of each edge of the last body-frame boundary. The vehicle is always at the origin
+    // so this only changes when the boundary does, not as the vehicle moves or yaws
+    struct {
+        Vector2f *points;           // copy of the boundary the geometry was calculated for
+        float *dir_x;               // unit vector from vehicle towards the closest point on each edge
+        float *dir_y;
+        float *dist_cm;             // distance from vehicle to the closest point on each edge
+        float *max_speed;           // scratch space for the maximum speed towards each edge
+        uint16_t num_points;        // number of valid points
+        uint16_t size;              // number of points allocated
+        bool on_edge;               // true if the vehicle lies exactly on one of the edges
+    } _edge_cache {};
+
     static AC_Avoid *_singleton;
 };
 
@@ -19,7 +19,7 @@
 #include <AP_AHRS/AP_AHRS.h>
 #include <AP_Logger/AP_Logger.h>
 
-const int16_t OA_BENDYRULER_BEARING_INC = 5;            // check every 5 degrees around vehicle
+const int16_t OA_BENDYRULER_BEARING_MAX = 170;          // check up to 170 degrees either side of the destination
 const float OA_BENDYRULER_LOOKAHEAD_STEP2_RATIO = 1.0f; // step2's lookahead length as a ratio of step1's lookahead length
 const float OA_BENDYRULER_LOOKAHEAD_STEP2_MIN = 2.0f;   // step2 checks at least this many meters past step1's location
 const float OA_BENDYRULER_LOOKAHEAD_PAST_DEST = 2.0f;   // lookahead length will be at least this many meters past the destination
@@ -55,72 +55,72 @@ bool AP_OABendyRuler::update(const Location& current_loc, const Location& destin
         ground_course_deg = degrees(ground_speed_vec.angle());
     }
 
-    // check OA_BEARING_INC definition allows checking in all directions
-    static_assert(360 % OA_BENDYRULER_BEARING_INC == 0, "check 360 is a multiple of OA_BEARING_INC");
-
-    // search in OA_BENDYRULER_BEARING_INC degree increments around the vehicle alternating left
+    // search in _bearing_inc degree increments around the vehicle alternating left
     // and right. For each direction check if vehicle would avoid all obstacles
     float best_bearing = bearing_to_dest;
     bool have_best_bearing = false;
     float best_margin = -FLT_MAX;
     float best_margin_bearing = best_bearing;
 
-    for (uint8_t i = 0; i <= (170 / OA_BENDYRULER_BEARING_INC); i++) {
-        for (uint8_t bdir = 0; bdir <= 1; bdir++) {
-            // skip duplicate check of bearing straight towards destination
-            if ((i==0) && (bdir > 0)) {
-                continue;
-            }
-            // bearing that we are probing
-            const float bearing_delta = i * OA_BENDYRULER_BEARING_INC * (bdir == 0 ? -1.0f : 1.0f);
-            const float bearing_test = wrap_180(bearing_to_dest + bearing_delta);
-
-            // ToDo: add effective groundspeed calculations using airspeed
-            // ToDo: add prediction of vehicle's position change as part of turn to desired heading
-
-            // test location is projected from current location at test bearing
-            Location test_loc = current_loc;
-            test_loc.offset_bearing(bearing_test, lookahead_step1_dist);
-
-            // calculate margin from fence for this scenario
-            float margin = calc_avoidance_margin(current_loc, test_loc);
-            if (margin > best_margin) {
-                best_margin_bearing = bearing_test;
-                best_margin = margin;
+    if (!init_candidates()) {
+        return false;
+    }
+    for (uint16_t c = 0; c < _num_candidates; c++) {
+        _candidate_end_x[c] = cosf(radians(bearing_to_dest + _candidate_bearing_delta[c]));
+        _candidate_end_y[c] = sinf(radians(bearing_to_dest + _candidate_bearing_delta[c]));
+    }
+
+    // calculate margin from fences and obstacles for all first step paths
+    calc_candidate_margins(current_loc, lookahead_step1_dist);
+
+    for (uint16_t c = 0; c < _num_candidates; c++) {
+        // bearing that we are probing
+        const float bearing_test = wrap_180(bearing_to_dest + _candidate_bearing_delta[c]);
+
+        // ToDo: add effective groundspeed calculations using airspeed
+        // ToDo: add prediction of vehicle's position change as part of turn to desired heading
+
+        // test location is projected from current location at test bearing
+        Location test_loc = current_loc;
+        test_loc.offset_bearing(bearing_test, lookahead_step1_dist);
+
+        const float margin = _candidate_margin[c];
+        if (margin > best_margin) {
+            best_margin_bearing = bearing_test;
+            best_margin = margin;
+        }
+        if (margin > _margin_max) {
+            // this bearing avoids obstacles out to the lookahead_step1_dist
+            // now check in there is a clear path in three directions towards the destination
+            if (!have_best_bearing) {
+                best_bearing = bearing_test;
+                have_best_bearing = true;
+            } else if (fabsf(wrap_180(ground_course_deg - bearing_test)) <
+                       fabsf(wrap_180(ground_course_deg - best_bearing))) {
+                // replace bearing with one that is closer to our current ground course
+                best_bearing = bearing_test;
             }
-            if (margin > _margin_max) {
-                // this bearing avoids obstacles out to the lookahead_step1_dist
-                // now check in there is a clear path in three directions towards the destination
-                if (!have_best_bearing) {
-                    best_bearing = bearing_test;
-                    have_best_bearing = true;
-                } else if (fabsf(wrap_180(ground_course_deg - bearing_test)) <
-                           fabsf(wrap_180(ground_course_deg - best_bearing))) {
-                    // replace bearing with one that is closer to our current ground course
-                    best_bearing = bearing_test;
-                }
 
-                // perform second stage test in three directions looking for obstacles
-                const float test_bearings[] { 0.0f, 45.0f, -45.0f };
-                const float bearing_to_dest2 = test_loc.get_bearing_to(destination) * 0.01f;
-                float distance2 = constrain_float(lookahead_step2_dist, OA_BENDYRULER_LOOKAHEAD_STEP2_MIN, test_loc.get_distance(destination));
-                for (uint8_t j = 0; j < ARRAY_SIZE(test_bearings); j++) {
-                    float bearing_test2 = wrap_180(bearing_to_dest2 + test_bearings[j]);
-                    Location test_loc2 = test_loc;
-                    test_loc2.offset_bearing(bearing_test2, distance2);
-
-                    // calculate minimum margin to fence and obstacles for this scenario
-                    float margin2 = calc_avoidance_margin(test_loc, test_loc2);
-                    if (margin2 > _margin_max) {
-                        // all good, now project in the chosen direction by the full distance
-                        destination_new = current_loc;
-                        destination_new.offset_bearing(bearing_test, distance_to_dest);
-                        _current_lookahead = MIN(_lookahead, _current_lookahead * 1.1f);
-                        // if the chosen direction is directly towards the destination turn off avoidance
-                        const bool active = (i != 0 || j != 0);
-                        AP::logger().Write_OABendyRuler(active, bearing_to_dest, margin, destination, destination_new);
-                        return active;
-                    }
+            // perform second stage test in three directions looking for obstacles
+            const float test_bearings[] { 0.0f, 45.0f, -45.0f };
+            const float bearing_to_dest2 = test_loc.get_bearing_to(destination) * 0.01f;
+            float distance2 = constrain_float(lookahead_step2_dist, OA_BENDYRULER_LOOKAHEAD_STEP2_MIN, test_loc.get_distance(destination));
+            for (uint8_t j = 0; j < ARRAY_SIZE(test_bearings); j++) {
+                float bearing_test2 = wrap_180(bearing_to_dest2 + test_bearings[j]);
+                Location test_loc2 = test_loc;
+                test_loc2.offset_bearing(bearing_test2, distance2);
+
+                // calculate minimum margin to fence and obstacles for this scenario
+                float margin2 = calc_avoidance_margin(test_loc, test_loc2);
+                if (margin2 > _margin_max) {
+                    // all good, now project in the chosen direction by the full distance
+                    destination_new = current_loc;
+                    destination_new.offset_bearing(bearing_test, distance_to_dest);
+                    _current_lookahead = MIN(_lookahead, _current_lookahead * 1.1f);
+                    // if the chosen direction is directly towards the destination turn off avoidance
+                    const bool active = (c != 0 || j != 0);
+                    AP::logger().Write_OABendyRuler(active, bearing_to_dest, margin, destination, destination_new);
+                    return active;
                 }
             }
         }
@@ -175,6 +175,244 @@ float AP_OABendyRuler::calc_avoidance_margin(const Location &start, const Locati
     return margin_min;
 }
 
+// allocate step1 candidate arrays for the current bearing increment
+// returns false if out of memory
+bool AP_OABendyRuler::init_candidates()
+{
+    if ((_candidate_margin != nullptr) && (_candidates_bearing_inc == _bearing_inc)) {
+        return true;
+    }
+
+    delete[] _candidate_bearing_delta;
+    delete[] _candidate_end_x;
+    delete[] _candidate_end_y;
+    delete[] _candidate_margin;
+
+    // straight towards destination then alternating left and right
+    const uint16_t num_candidates = 1 + 2 * (OA_BENDYRULER_BEARING_MAX / _bearing_inc);
+    _candidate_bearing_delta = new float[num_candidates];
+    _candidate_end_x = new float[num_candidates];
+    _candidate_end_y = new float[num_candidates];
+    _candidate_margin = new float[num_candidates];
+    if ((_candidate_bearing_delta == nullptr) || (_candidate_end_x == nullptr) ||
+        (_candidate_end_y == nullptr) || (_candidate_margin == nullptr)) {
+        delete[] _candidate_bearing_delta;
+        delete[] _candidate_end_x;
+        delete[] _candidate_end_y;
+        delete[] _candidate_margin;
+        _candidate_bearing_delta = nullptr;
+        _candidate_end_x = nullptr;
+        _candidate_end_y = nullptr;
+        _candidate_margin = nullptr;
+        _num_candidates = 0;
+        return false;
+    }
+
+    _num_candidates = num_candidates;
+    _candidates_bearing_inc = _bearing_inc;
+    _candidate_bearing_delta[0] = 0;
+    for (uint16_t i = 1; i <= OA_BENDYRULER_BEARING_MAX / _bearing_inc; i++) {
+        _candidate_bearing_delta[i*2-1] = -i * _bearing_inc;
+        _candidate_bearing_delta[i*2] = i * _bearing_inc;
+    }
+    return true;
+}
+
+// calculate margins of all step1 candidate paths from start, lookahead meters long, in _candidate_margin
+// on entry _candidate_end_x and _candidate_end_y hold the unit vector of each candidate's bearing
+// each obstacle source is visited once and checked against all candidates
+void AP_OABendyRuler::calc_candidate_margins(const Location &start, float lookahead)
+{
+    for (uint16_t c = 0; c < _num_candidates; c++) {
+        _candidate_margin[c] = FLT_MAX;
+    }
+
+    Vector2f start_NE;
+    if (!start.get_vector_xy_from_origin_NE(start_NE)) {
+        // without an EKF origin only the circular fence can be checked, one candidate at a time
+        for (uint16_t c = 0; c < _num_candidates; c++) {
+            Location end = start;
+            end.offset(_candidate_end_x[c] * lookahead, _candidate_end_y[c] * lookahead);
+            float margin;
+            if (calc_margin_from_circular_fence(start, end, margin)) {
+                _candidate_margin[c] = margin;
+            }
+        }
+        return;
+    }
+
+    // convert unit vectors to candidate end points
+    const float lookahead_cm = lookahead * 100.0f;
+    for (uint16_t c = 0; c < _num_candidates; c++) {
+        _candidate_end_x[c] = start_NE.x + _candidate_end_x[c] * lookahead_cm;
+        _candidate_end_y[c] = start_NE.y + _candidate_end_y[c] * lookahead_cm;
+    }
+
+    calc_candidate_margins_from_circular_fence(start_NE);
+    calc_candidate_margins_from_object_database(start_NE, lookahead);
+    calc_candidate_margins_from_inclusion_and_exclusion_polygons(start_NE);
+    calc_candidate_margins_from_inclusion_and_exclusion_circles(start_NE);
+}
+
+// calculate distance (in cm) from a point to each candidate path starting at start_NE and
+// lower each candidate's margin to the distance in meters minus radius if it is smaller
+void AP_OABendyRuler::lower_candidate_margins_to_point(const Vector2f &start_NE, const Vector2f &point_cm, float radius)
+{
+    const float px = point_cm.x - start_NE.x;
+    const float py = point_cm.y - start_NE.y;
+    for (uint16_t c = 0; c < _num_candidates; c++) {
+        // closest point on the candidate path, as a fraction of its length
+        const float dx = _candidate_end_x[c] - start_NE.x;
+        const float dy = _candidate_end_y[c] - start_NE.y;
+        const float len_sq = dx * dx + dy * dy;
+        float t = (len_sq > 0.0f) ? ((px * dx + py * dy) / len_sq) : 0.0f;
+        t = constrain_float(t, 0.0f, 1.0f);
+        const float ex = px - t * dx;
+        const float ey = py - t * dy;
+        const float m = sqrtf(ex * ex + ey * ey) * 0.01f - radius;
+        _candidate_margin[c] = MIN(_candidate_margin[c], m);
+    }
+}
+
+// calculate margin between all step1 candidate paths and the circular fence (centered on home)
+void AP_OABendyRuler::calc_candidate_margins_from_circular_fence(const Vector2f &start_NE)
+{
+    // exit immediately if polygon fence is not enabled
+    const AC_Fence *fence = AC_Fence::get_singleton();
+    if (fence == nullptr) {
+        return;
+    }
+    if ((fence->get_enabled_fences() & AC_FENCE_TYPE_CIRCLE) == 0) {
+        return;
+    }
+
+    Vector2f home_NE;
+    if (!AP::ahrs().get_home().get_vector_xy_from_origin_NE(home_NE)) {
+        return;
+    }
+
+    // get circular fence radius + margin
+    const float fence_radius_plus_margin = fence->get_radius() - fence->get_margin();
+
+    // margin is fence radius minus the longer of start or end distance
+    const float start_dist_sq = (start_NE - home_NE).length_squared();
+    for (uint16_t c = 0; c < _num_candidates; c++) {
+        const float ex = _candidate_end_x[c] - home_NE.x;
+        const float ey = _candidate_end_y[c] - home_NE.y;
+        const float m = fence_radius_plus_margin - sqrtf(MAX(start_dist_sq, ex * ex + ey * ey)) * 0.01f;
+        _candidate_margin[c] = MIN(_candidate_margin[c], m);
+    }
+}
+
+// calculate margin between all step1 candidate paths and all inclusion and exclusion polygons
+void AP_OABendyRuler::calc_candidate_margins_from_inclusion_and_exclusion_polygons(const Vector2f &start_NE)
+{
+    const AC_Fence *fence = AC_Fence::get_singleton();
+    if (fence == nullptr) {
+        return;
+    }
+
+    // exclusion polygons enabled along with polygon fences
+    if ((fence->get_enabled_fences() & AC_FENCE_TYPE_POLYGON) == 0) {
+        return;
+    }
+
+    // get fence margin
+    const float fence_margin = fence->get_margin();
+
+    // iterate through inclusion then exclusion polygons
+    const uint8_t num_inclusion_polygons = fence->polyfence().get_inclusion_polygon_count();
+    const uint8_t num_exclusion_polygons = fence->polyfence().get_exclusion_polygon_count();
+    for (uint16_t i = 0; i < num_inclusion_polygons + num_exclusion_polygons; i++) {
+        const bool inclusion = (i < num_inclusion_polygons);
+        uint16_t num_points;
+        const Vector2f* boundary = inclusion ? fence->polyfence().get_inclusion_polygon(i, num_points) :
+                                               fence->polyfence().get_exclusion_polygon(i - num_inclusion_polygons, num_points);
+        if (num_points < 3) {
+            // ignore polygons with less than 3 points
+            continue;
+        }
+
+        // all candidates share the same start so the side of the boundary they start from is the same
+        // margin is negative if outside an inclusion polygon or inside an exclusion polygon
+        const bool outside = Polygon_outside(start_NE, boundary, num_points);
+        const float sign = (outside != inclusion) ? 1.0f : -1.0f;
+
+        // calculate min distance (in meters) from each candidate to polygon
+        for (uint16_t c = 0; c < _num_candidates; c++) {
+            const Vector2f end_NE(_candidate_end_x[c], _candidate_end_y[c]);
+            const float m = (sign * Polygon_closest_distance_line(boundary, num_points, start_NE, end_NE) * 0.01f) - fence_margin;
+            _candidate_margin[c] = MIN(_candidate_margin[c], m);
+        }
+    }
+}
+
+// calculate margin between all step1 candidate paths and all inclusion and exclusion circles
+void AP_OABendyRuler::calc_candidate_margins_from_inclusion_and_exclusion_circles(const Vector2f &start_NE)
+{
+    // exit immediately if fence is not enabled
+    const AC_Fence *fence = AC_Fence::get_singleton();
+    if (fence == nullptr) {
+        return;
+    }
+
+    // inclusion/exclusion circles enabled along with polygon fences
+    if ((fence->get_enabled_fences() & AC_FENCE_TYPE_POLYGON) == 0) {
+        return;
+    }
+
+    // get fence margin
+    const float fence_margin = fence->get_margin();
+
+    // iterate through inclusion circles
+    const uint8_t num_inclusion_circles = fence->polyfence().get_inclusion_circle_count();
+    for (uint8_t i = 0; i < num_inclusion_circles; i++) {
+        Vector2f center_pos_cm;
+        float radius;
+        if (fence->polyfence().get_inclusion_circle(i, center_pos_cm, radius)) {
+            // margin is fence radius minus the longer of start or end distance
+            const float start_dist_sq = (start_NE - center_pos_cm).length_squared();
+            for (uint16_t c = 0; c < _num_candidates; c++) {
+                const float ex = _candidate_end_x[c] - center_pos_cm.x;
+                const float ey = _candidate_end_y[c] - center_pos_cm.y;
+                const float m = (radius + fence_margin) - (sqrtf(MAX(start_dist_sq, ex * ex + ey * ey)) * 0.01f);
+                _candidate_margin[c] = MIN(_candidate_margin[c], m);
+            }
+        }
+    }
+
+    // iterate through exclusion circles, margin is distance to the center minus the radius
+    const uint8_t num_exclusion_circles = fence->polyfence().get_exclusion_circle_count();
+    for (uint8_t i = 0; i < num_exclusion_circles; i++) {
+        Vector2f center_pos_cm;
+        float radius;
+        if (fence->polyfence().get_exclusion_circle(i, center_pos_cm, radius)) {
+            lower_candidate_margins_to_point(start_NE, center_pos_cm, radius + fence_margin);
+        }
+    }
+}
+
+// calculate margin between all step1 candidate paths and proximity sensor obstacles
+void AP_OABendyRuler::calc_candidate_margins_from_object_database(const Vector2f &start_NE, float lookahead)
+{
+    // exit immediately if db is empty
+    AP_OADatabase *oaDb = AP::oadatabase();
+    if (oaDb == nullptr || !oaDb->healthy()) {
+        return;
+    }
+
+    // check obstacles near enough to any candidate to lower its margin below _margin_max
+    const float search_dist = lookahead + _margin_max + oaDb->get_radius_max();
+    const Vector2f search_offset(search_dist, search_dist);
+    AP_OADatabase::GridIterator it;
+    oaDb->grid_iterate_start(it, start_NE * 0.01f - search_offset, start_NE * 0.01f + search_offset);
+    uint16_t i;
+    while (oaDb->grid_iterate_next(it, i)) {
+        const AP_OADatabase::OA_DbItem& item = oaDb->get_item(i);
+        lower_candidate_margins_to_point(start_NE, item.pos * 100.0f, item.radius);
+    }
+}
+
 // calculate minimum distance between a path and the circular fence (centered on home)
 // on success returns true and updates margin
 bool AP_OABendyRuler::calc_margin_from_circular_fence(const Location &start, const Location &end, float &margin)
@@ -367,9 +605,17 @@ bool AP_OABendyRuler::calc_margin_from_object_database(const Location &start, co
         return false;
     }
 
-    // check each obstacle's distance from segment
+    // check distance from segment of each obstacle near enough to lower the margin below _margin_max
+    // obstacles further away can only affect which of the paths with enough margin is chosen
+    const float search_dist_cm = (_margin_max + oaDb->get_radius_max()) * 100.0f;
+    const Vector2f search_offset_cm(search_dist_cm, search_dist_cm);
+    AP_OADatabase::GridIterator it;
+    oaDb->grid_iterate_start(it,
+                             (Vector2f(MIN(start_NE.x, end_NE.x), MIN(start_NE.y, end_NE.y)) - search_offset_cm) * 0.01f,
+                             (Vector2f(MAX(start_NE.x, end_NE.x), MAX(start_NE.y, end_NE.y)) + search_offset_cm) * 0.01f);
     float smallest_margin = FLT_MAX;
-    for (uint16_t i=0; i<oaDb->database_count(); i++) {
+    uint16_t i;
+    while (oaDb->grid_iterate_next(it, i)) {
         const AP_OADatabase::OA_DbItem& item = oaDb->get_item(i);
         const Vector2f point_cm = item.pos * 100.0f;
         // margin is distance between line segment and obstacle minus obstacle's radius
@@ -18,7 +18,11 @@ public:
     AP_OABendyRuler &operator=(const AP_OABendyRuler&) = delete;
 
     // send configuration info stored in front end parameters
-    void set_config(float lookahead, float margin_max) { _lookahead = MAX(lookahead, 1.0f); _margin_max = MAX(margin_max, 0.0f); }
+    void set_config(float lookahead, float margin_max, int16_t bearing_inc) {
+        _lookahead = MAX(lookahead, 1.0f);
+        _margin_max = MAX(margin_max, 0.0f);
+        _bearing_inc = constrain_int16(bearing_inc, 1, 30);
+    }
 
     // run background task to find best path and update avoidance_results
     // returns true and populates origin_new and destination_new if OA is required.  returns false if OA is not required
@@ -29,6 +33,25 @@ private:
     // calculate minimum distance between a path and any obstacle
     float calc_avoidance_margin(const Location &start, const Location &end);
 
+    // allocate step1 candidate arrays for the current bearing increment
+    // returns false if out of memory
+    bool init_candidates();
+
+    // calculate margins of all step1 candidate paths from start, lookahead meters long, in _candidate_margin
+    // each obstacle source is visited once and checked against all candidates
+    void calc_candidate_margins(const Location &start, float lookahead);
+
+    // batched versions of the calc_margin_from_ methods below for all step1 candidates
+    // start_NE and candidate end points are offsets in cm from the EKF origin
+    void calc_candidate_margins_from_circular_fence(const Vector2f &start_NE);
+    void calc_candidate_margins_from_inclusion_and_exclusion_polygons(const Vector2f &start_NE);
+    void calc_candidate_margins_from_inclusion_and_exclusion_circles(const Vector2f &start_NE);
+    void calc_candidate_margins_from_object_database(const Vector2f &start_NE, float lookahead);
+
+    // calculate distance (in cm) from a point to each candidate path starting at start_NE and
+    // lower each candidate's margin to the distance in meters minus radius if it is smaller
+    void lower_candidate_margins_to_point(const Vector2f &start_NE, const Vector2f &point_cm, float radius);
+
     // calculate minimum distance between a path and the circular fence (centered on home)
     // on success returns true and updates margin
     bool calc_margin_from_circular_fence(const Location &start, const Location &end, float &margin);
@@ -48,6 +71,16 @@ private:
     // configuration parameters
     float _lookahead;               // object avoidance will look this many meters ahead of vehicle
     float _margin_max;              // object avoidance will ignore objects more than this many meters from vehicle
+    int16_t _bearing_inc = 5;       // check every this many degrees around vehicle
+
+    // step1 candidate paths from the vehicle in the order they are tested, as separate arrays so
+    // the inner loops over candidates are simple and can be vectorised
+    uint16_t _num_candidates;       // number of candidates for _candidates_bearing_inc
+    int16_t _candidates_bearing_inc;// bearing increment the candidate arrays were allocated for
+    float *_candidate_bearing_delta;// bearing relative to destination in degrees
+    float *_candidate_end_x;        // end point north offset in cm from EKF origin
+    float *_candidate_end_y;        // end point east offset in cm from EKF origin
+    float *_candidate_margin;       // minimum margin to any obstacle in meters
 
     // internal variables used by background thread
     float _current_lookahead;       // distance (in meters) ahead of the vehicle we are looking for obstacles
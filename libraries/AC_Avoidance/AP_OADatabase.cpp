@@ -31,6 +31,10 @@ extern const AP_HAL::HAL& hal;
     #define AP_OADATABASE_QUEUE_SIZE_DEFAULT 80
 #endif
 
+#define AP_OADATABASE_GRID_CELL_SIZE    2.0f    // width of spatial grid index cells in meters
+#define AP_OADATABASE_GRID_BUCKETS_MAX  4096    // maximum number of spatial grid index buckets
+#define AP_OADATABASE_GRID_NONE         UINT16_MAX  // end of a grid bucket's list
+
 
 const AP_Param::GroupInfo AP_OADatabase::var_info[] = {
 
@@ -108,6 +112,7 @@ void AP_OADatabase::init()
 {
     init_database();
     init_queue();
+    init_grid();
 
     // initialise scalar using beam width of at least 1deg
     dist_to_radius_scalar = tanf(radians(MAX(_beam_width, 1.0f)));
@@ -116,6 +121,12 @@ void AP_OADatabase::init()
         gcs().send_text(MAV_SEVERITY_INFO, "DB init failed . Sizes queue:%u, db:%u", (unsigned int)_queue.size, (unsigned int)_database.size);
         delete _queue.items;
         delete[] _database.items;
+        delete[] _grid.head;
+        delete[] _grid.next;
+        _queue.items = nullptr;
+        _database.items = nullptr;
+        _grid.head = nullptr;
+        _grid.next = nullptr;
         return;
     }
 }
@@ -169,6 +180,127 @@ void AP_OADatabase::init_database()
     _database.items = new OA_DbItem[_database.size];
 }
 
+void AP_OADatabase::init_grid()
+{
+    if (_database.size == 0) {
+        return;
+    }
+
+    // about one bucket per item
+    _grid.num_buckets = 1;
+    while ((_grid.num_buckets < _database.size) && (_grid.num_buckets < AP_OADATABASE_GRID_BUCKETS_MAX)) {
+        _grid.num_buckets *= 2;
+    }
+
+    _grid.head = new uint16_t[_grid.num_buckets];
+    _grid.next = new uint16_t[_database.size];
+    if ((_grid.head == nullptr) || (_grid.next == nullptr)) {
+        delete[] _grid.head;
+        delete[] _grid.next;
+        _grid.head = nullptr;
+        _grid.next = nullptr;
+        return;
+    }
+    for (uint16_t i=0; i<_grid.num_buckets; i++) {
+        _grid.head[i] = AP_OADATABASE_GRID_NONE;
+    }
+}
+
+// get grid cell holding a position (offset in meters from EKF origin)
+void AP_OADatabase::grid_cell(const Vector2f &pos, int32_t &x, int32_t &y) const
+{
+    x = (int32_t)floorf(pos.x * (1.0f / AP_OADATABASE_GRID_CELL_SIZE));
+    y = (int32_t)floorf(pos.y * (1.0f / AP_OADATABASE_GRID_CELL_SIZE));
+}
+
+// get bucket holding a grid cell's items. Many cells share each bucket
+uint16_t AP_OADatabase::grid_bucket(int32_t x, int32_t y) const
+{
+    const uint32_t hash = ((uint32_t)x * 73856093U) ^ ((uint32_t)y * 19349663U);
+    return hash & (_grid.num_buckets - 1);
+}
+
+// add database item to the grid index
+void AP_OADatabase::grid_item_link(const uint16_t index)
+{
+    int32_t x, y;
+    grid_cell(_database.items[index].pos, x, y);
+    const uint16_t bucket = grid_bucket(x, y);
+    _grid.next[index] = _grid.head[bucket];
+    _grid.head[bucket] = index;
+}
+
+// remove database item from the grid index
+void AP_OADatabase::grid_item_unlink(const uint16_t index)
+{
+    int32_t x, y;
+    grid_cell(_database.items[index].pos, x, y);
+    uint16_t *link = &_grid.head[grid_bucket(x, y)];
+    while (*link != AP_OADATABASE_GRID_NONE) {
+        if (*link == index) {
+            *link = _grid.next[index];
+            return;
+        }
+        link = &_grid.next[*link];
+    }
+}
+
+// start iterating over items which may lie within the box between corner1 and corner2 (offsets in meters from the EKF origin)
+void AP_OADatabase::grid_iterate_start(GridIterator &it, const Vector2f &corner1, const Vector2f &corner2) const
+{
+    grid_cell(Vector2f(MIN(corner1.x, corner2.x), MIN(corner1.y, corner2.y)), it.x_min, it.y_min);
+    grid_cell(Vector2f(MAX(corner1.x, corner2.x), MAX(corner1.y, corner2.y)), it.x_max, it.y_max);
+
+    // if the box covers more cells than there are items it is quicker to check every item
+    const float num_cells = (float)(it.x_max - it.x_min + 1) * (float)(it.y_max - it.y_min + 1);
+    it.all_items = !healthy() || (num_cells > _database.count);
+
+    it.x = it.x_min;
+    it.y = it.y_min;
+    if (it.all_items) {
+        it.index = 0;
+    } else {
+        it.index = _grid.head[grid_bucket(it.x, it.y)];
+    }
+}
+
+// get next item from iterator, returns false when there are no more items
+bool AP_OADatabase::grid_iterate_next(GridIterator &it, uint16_t &index) const
+{
+    if (it.all_items) {
+        if (it.index >= _database.count) {
+            return false;
+        }
+        index = it.index++;
+        return true;
+    }
+
+    while (true) {
+        // return items in current cell's bucket that are in the current cell
+        while (it.index != AP_OADATABASE_GRID_NONE) {
+            const uint16_t i = it.index;
+            it.index = _grid.next[i];
+            int32_t x, y;
+            grid_cell(_database.items[i].pos, x, y);
+            if ((x == it.x) && (y == it.y)) {
+                index = i;
+                return true;
+            }
+        }
+
+        // move to next cell
+        if (it.y < it.y_max) {
+            it.y++;
+        } else if (it.x < it.x_max) {
+            it.x++;
+            it.y = it.y_min;
+        } else {
+            return false;
+        }
+        it.index = _grid.head[grid_bucket(it.x, it.y)];
+    }
+}
+
 // get bitmask of gcs channels item should be sent to based on its importance
 // returns 0xFF (send to all channels) if should be sent, 0 if it should not be sent
 uint8_t AP_OADatabase::get_send_to_gcs_flags(const OA_DbItemImportance importance)
@@ -226,9 +358,14 @@ bool AP_OADatabase::process_queue()
 
         item.send_to_gcs = get_send_to_gcs_flags(item.importance);
 
-        // compare item to all items in database. If found a similar item, update the existing, else add it as a new one
+        // compare item to nearby items in database. If found a similar item, update the existing, else add it as a new one
         bool found = false;
-        for (uint16_t i=0; i<_database.count; i++) {
+        const float search_radius = MAX(item.radius, _database.radius_max);
+        const Vector2f search_offset(search_radius, search_radius);
+        GridIterator it;
+        grid_iterate_start(it, item.pos - search_offset, item.pos + search_offset);
+        uint16_t i;
+        while (grid_iterate_next(it, i)) {
             if (is_close_to_item_in_database(i, item)) {
                 database_item_refresh(i, item.timestamp_ms, item.radius);
                 found = true;
@@ -250,6 +387,8 @@ void AP_OADatabase::database_item_add(const OA_DbItem &item)
     }
     _database.items[_database.count] = item;
     _database.items[_database.count].send_to_gcs = get_send_to_gcs_flags(_database.items[_database.count].importance);
+    grid_item_link(_database.count);
+    _database.radius_max = MAX(_database.radius_max, item.radius);
     _database.count++;
 }
 
@@ -263,6 +402,7 @@ void AP_OADatabase::database_item_remove(const uint16_t index)
     // radius of 0 tells the GCS we don't care about it any more (aka it expired)
     _database.items[index].radius = 0;
     _database.items[index].send_to_gcs = get_send_to_gcs_flags(_database.items[index].importance);
+    grid_item_unlink(index);
 
     _database.count--;
     if (_database.count == 0) {
@@ -271,8 +411,10 @@ void AP_OADatabase::database_item_remove(const uint16_t index)
 
     if (index != _database.count) {
         // copy last object in array over expired object
+        grid_item_unlink(_database.count);
         _database.items[index] = _database.items[_database.count];
         _database.items[index].send_to_gcs = get_send_to_gcs_flags(_database.items[index].importance);
+        grid_item_link(index);
     }
 }
 
@@ -292,6 +434,7 @@ void AP_OADatabase::database_item_refresh(const uint16_t index, const uint32_t t
         // and trigger resending to GCS
         _database.items[index].timestamp_ms = timestamp_ms;
         _database.items[index].radius = radius;
+        _database.radius_max = MAX(_database.radius_max, radius);
         _database.items[index].send_to_gcs = get_send_to_gcs_flags(_database.items[index].importance);
     }
 }
@@ -309,13 +452,18 @@ void AP_OADatabase::database_items_remove_all_expired()
     const uint32_t now_ms = AP_HAL::millis();
     const uint32_t expiry_ms = (uint32_t)_database_expiry_seconds * 1000;
     uint16_t index = 0;
+    float radius_max = 0;
     while (index < _database.count) {
         if (now_ms - _database.items[index].timestamp_ms > expiry_ms) {
             database_item_remove(index);
         } else {
+            radius_max = MAX(radius_max, _database.items[index].radius);
             index++;
         }
     }
+
+    // largest radius may have expired
+    _database.radius_max = radius_max;
 }
 
 // returns true if a similar object already exists in database. When true, the object timer is also reset
@@ -38,7 +38,7 @@ public:
     void queue_push(const Vector2f &pos, uint32_t timestamp_ms, float distance);
 
     // returns true if database is healthy
-    bool healthy() const { return (_queue.items != nullptr) && (_database.items != nullptr); }
+    bool healthy() const { return (_queue.items != nullptr) && (_database.items != nullptr) && (_grid.head != nullptr); }
 
     // fetch an item in database. Undefined result when i >= _database.count.
     const OA_DbItem& get_item(uint32_t i) const { return _database.items[i]; }
@@ -46,6 +46,25 @@ public:
     // get number of items in the database
     uint16_t database_count() const { return _database.count; }
 
+    // get largest radius of any object in the database, in meters
+    float get_radius_max() const { return _database.radius_max; }
+
+    // iterator over the items which may lie within a box, using the spatial grid index
+    // items outside the box may also be returned so callers must still check each item's position
+    struct GridIterator {
+        int32_t x_min, x_max;   // range of grid cells covering the box
+        int32_t y_min, y_max;
+        int32_t x, y;           // current grid cell
+        uint16_t index;         // next item to return
+        bool all_items;         // true if box covers more cells than there are items, so all items are returned
+    };
+
+    // start iterating over items which may lie within the box between corner1 and corner2 (offsets in meters from the EKF origin)
+    void grid_iterate_start(GridIterator &it, const Vector2f &corner1, const Vector2f &corner2) const;
+
+    // get next item from iterator, returns false when there are no more items
+    bool grid_iterate_next(GridIterator &it, uint16_t &index) const;
+
     // empty queue and try and put into database. Return true if there's more work to do
     bool process_queue();
 
@@ -73,6 +92,13 @@ private:
     // returns true if database item "index" is close to "item"
     bool is_close_to_item_in_database(const uint16_t index, const OA_DbItem &item) const;
 
+    // spatial grid index management
+    void init_grid();
+    void grid_cell(const Vector2f &pos, int32_t &x, int32_t &y) const;
+    uint16_t grid_bucket(int32_t x, int32_t y) const;
+    void grid_item_link(const uint16_t index);
+    void grid_item_unlink(const uint16_t index);
+
     // enum for use with _OUTPUT parameter
     enum class OA_DbOutputLevel {
         OUTPUT_LEVEL_DISABLED = 0,
@@ -101,8 +127,17 @@ private:
         OA_DbItem       *items;                             // array of objects in the database
         uint16_t        count;                              // number of objects in the items array
         uint16_t        size;                               // cached value of _database_size_param that sticks after initialized
+        float           radius_max;                         // largest radius of any object in the database (may be larger after objects expire)
     } _database;
 
+    // spatial grid index of the database. Items are linked into lists by the hash of the grid cell holding their position,
+    // so finding items near a position only checks the items in nearby cells
+    struct {
+        uint16_t        *head;                              // first item in each bucket's list (or UINT16_MAX if empty)
+        uint16_t        *next;                              // next item in the same bucket's list, indexed like _database.items
+        uint16_t        num_buckets;                        // number of buckets, always a power of two
+    } _grid;
+
     uint16_t _next_index_to_send[MAVLINK_COMM_NUM_BUFFERS]; // index of next object in _database to send to GCS
     uint16_t _highest_index_sent[MAVLINK_COMM_NUM_BUFFERS]; // highest index in _database sent to GCS
     uint32_t _last_send_to_gcs_ms[MAVLINK_COMM_NUM_BUFFERS];// system time that send_adsb_vehicle was last called
@@ -18,10 +18,12 @@
 #include <AC_Fence/AC_Fence.h>
 #include <AP_AHRS/AP_AHRS.h>
 #include <AP_Logger/AP_Logger.h>
+#include <AP_Math/crc.h>
 
 #define OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK  32      // expanding arrays for fence points and paths to destination will grow in increments of 20 elements
 #define OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX        255     // index use to indicate we do not have a tentative short path for a node
 #define OA_DIJKSTRA_ERROR_REPORTING_INTERVAL_MS         5000    // failure messages sent to GCS every 5 seconds
+#define OA_DIJKSTRA_SEARCH_TIME_US                      5000    // path search gives up the thread after 5ms and continues on the next iteration
 
 /// Constructor
 AP_OADijkstra::AP_OADijkstra() :
@@ -29,6 +31,7 @@ AP_OADijkstra::AP_OADijkstra() :
         _exclusion_polygon_pts(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _exclusion_circle_pts(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _short_path_data(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
+        _heap(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _path(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK)
 {
 }
@@ -66,6 +69,7 @@ AP_OADijkstra::AP_OADijkstra_State AP_OADijkstra::update(const Location &current
         _inclusion_polygon_with_margin_ok = false;
         _polyfence_visgraph_ok = false;
         _shortest_path_ok = false;
+        _path_search_active = false;
     }
 
     // check for exclusion polygon updates
@@ -73,6 +77,7 @@ AP_OADijkstra::AP_OADijkstra_State AP_OADijkstra::update(const Location &current
         _exclusion_polygon_with_margin_ok = false;
         _polyfence_visgraph_ok = false;
         _shortest_path_ok = false;
+        _path_search_active = false;
     }
 
     // check for exclusion circle updates
@@ -80,10 +85,12 @@ AP_OADijkstra::AP_OADijkstra_State AP_OADijkstra::update(const Location &current
         _exclusion_circle_with_margin_ok = false;
         _polyfence_visgraph_ok = false;
         _shortest_path_ok = false;
+        _path_search_active = false;
     }
 
     // create inner polygon fence
     AP_OADijkstra_Error error_id;
+    const uint32_t fence_start_us = AP_HAL::micros();
     if (!_inclusion_polygon_with_margin_ok) {
         _inclusion_polygon_with_margin_ok = create_inclusion_polygon_with_margin(_polyfence_margin * 100.0f, error_id);
         if (!_inclusion_polygon_with_margin_ok) {
@@ -115,9 +122,13 @@ AP_OADijkstra::AP_OADijkstra_State AP_OADijkstra::update(const Location &current
 
     // create visgraph for all fence (with margin) points
     if (!_polyfence_visgraph_ok) {
+        const uint32_t visgraph_start_us = AP_HAL::micros();
+        _timing.fence_us = visgraph_start_us - fence_start_us;
         _polyfence_visgraph_ok = create_fence_visgraph(error_id);
+        _timing.visgraph_us = AP_HAL::micros() - visgraph_start_us;
         if (!_polyfence_visgraph_ok) {
             _shortest_path_ok = false;
+            _path_search_active = false;
             report_error(error_id);
             AP::logger().Write_OADijkstra(DIJKSTRA_STATE_ERROR, (uint8_t)error_id, 0, 0, destination, destination);
             return DIJKSTRA_STATE_ERROR;
@@ -128,11 +139,26 @@ AP_OADijkstra::AP_OADijkstra_State AP_OADijkstra::update(const Location &current
     if (!destination.same_latlon_as(_destination_prev)) {
         _destination_prev = destination;
         _shortest_path_ok = false;
+        _path_search_active = false;
     }
 
     // calculate shortest path from current_loc to destination
     if (!_shortest_path_ok) {
-        _shortest_path_ok = calc_shortest_path(current_loc, destination, error_id);
+        const uint32_t path_start_us = AP_HAL::micros();
+        const PathSearchState search_state = calc_shortest_path(current_loc, destination, error_id);
+        _timing.path_us += AP_HAL::micros() - path_start_us;
+        if (search_state == PathSearchState::IN_PROGRESS) {
+            // continue search on next iteration
+            AP::logger().Write_OADijkstra(DIJKSTRA_STATE_PROCESSING, 0, 0, 0, destination, destination);
+            return DIJKSTRA_STATE_PROCESSING;
+        }
+        _shortest_path_ok = (search_state == PathSearchState::COMPLETE);
+        log_timing();
+        // timings are only logged once, for the replan that used them
+        _timing.fence_us = 0;
+        _timing.visgraph_us = 0;
+        _timing.path_us = 0;
+        _timing.checks = 0;
         if (!_shortest_path_ok) {
             report_error(error_id);
             AP::logger().Write_OADijkstra(DIJKSTRA_STATE_ERROR, (uint8_t)error_id, 0, 0, destination, destination);
@@ -329,6 +355,21 @@ bool AP_OADijkstra::create_inclusion_polygon_with_margin(float margin_cm, AP_OAD
         _inclusion_polygon_numpoints += num_points;
     }
 
+    // inclusion circles block paths too, so changes to them count as a change to this fence type
+    uint32_t crc = 0;
+    for (uint16_t i = 0; i < _inclusion_polygon_numpoints; i++) {
+        crc = crc_crc32(crc, (const uint8_t *)&_inclusion_polygon_pts[i], sizeof(Vector2f));
+    }
+    for (uint8_t i = 0; i < fence->polyfence().get_inclusion_circle_count(); i++) {
+        Vector2f center_pos_cm;
+        float radius;
+        if (fence->polyfence().get_inclusion_circle(i, center_pos_cm, radius)) {
+            crc = crc_crc32(crc, (const uint8_t *)&center_pos_cm, sizeof(center_pos_cm));
+            crc = crc_crc32(crc, (const uint8_t *)&radius, sizeof(radius));
+        }
+    }
+    update_fence_crc(0, crc);
+
     // record fence update time so we don't process these inclusion polygons again
     _inclusion_polygon_update_ms = fence->polyfence().get_inclusion_polygon_update_ms();
 
@@ -420,6 +461,12 @@ bool AP_OADijkstra::create_exclusion_polygon_with_margin(float margin_cm, AP_OAD
         _exclusion_polygon_numpoints += num_points;
     }
 
+    uint32_t crc = 0;
+    for (uint16_t i = 0; i < _exclusion_polygon_numpoints; i++) {
+        crc = crc_crc32(crc, (const uint8_t *)&_exclusion_polygon_pts[i], sizeof(Vector2f));
+    }
+    update_fence_crc(1, crc);
+
     // record fence update time so we don't process these exclusion polygons again
     _exclusion_polygon_update_ms = fence->polyfence().get_exclusion_polygon_update_ms();
 
@@ -486,12 +533,27 @@ bool AP_OADijkstra::create_exclusion_circle_with_margin(float margin_cm, AP_OADi
         }
     }
 
+    uint32_t crc = 0;
+    for (uint16_t i = 0; i < _exclusion_circle_numpoints; i++) {
+        crc = crc_crc32(crc, (const uint8_t *)&_exclusion_circle_pts[i], sizeof(Vector2f));
+    }
+    update_fence_crc(2, crc);
+
     // record fence update time so we don't process these exclusion circles again
     _exclusion_circle_update_ms = fence->polyfence().get_exclusion_circle_update_ms();
 
     return true;
 }
 
+// record that a fence type has changed if crc differs from the one it was last built with
+void AP_OADijkstra::update_fence_crc(uint8_t type_idx, uint32_t crc)
+{
+    if (crc != _fence_crc[type_idx]) {
+        _fence_crc[type_idx] = crc;
+        _fence_changed |= (1U << type_idx);
+    }
+}
+
 // returns total number of points across all fence types
 uint16_t AP_OADijkstra::total_numpoints() const
 {
@@ -530,8 +592,21 @@ bool AP_OADijkstra::get_point(uint16_t index, Vector2f &point) const
     return false;
 }
 
+// returns the type (0 for inclusion, 1 for exclusion polygon, 2 for exclusion circle) of the fence point at index
+uint8_t AP_OADijkstra::get_point_type(uint16_t index) const
+{
+    if (index < _inclusion_polygon_numpoints) {
+        return 0;
+    }
+    if (index < _inclusion_polygon_numpoints + _exclusion_polygon_numpoints) {
+        return 1;
+    }
+    return 2;
+}
+
 // returns true if line segment intersects polygon or circular fence
-bool AP_OADijkstra::intersects_fence(const Vector2f &seg_start, const Vector2f &seg_end) const
+// fence_types is a bitmask of FenceType, limiting which fences are checked
+bool AP_OADijkstra::intersects_fence(const Vector2f &seg_start, const Vector2f &seg_end, uint8_t fence_types) const
 {
     // return immediately if fence is not enabled
     const AC_Fence *fence = AC_Fence::get_singleton();
@@ -541,7 +616,8 @@ bool AP_OADijkstra::intersects_fence(const Vector2f &seg_start, const Vector2f &
 
     // determine if segment crosses any of the inclusion polygons
     uint16_t num_points = 0;
-    for (uint8_t i = 0; i < fence->polyfence().get_inclusion_polygon_count(); i++) {
+    const uint8_t num_inclusion_polygons = (fence_types & FENCE_TYPE_INCLUSION) ? fence->polyfence().get_inclusion_polygon_count() : 0;
+    for (uint8_t i = 0; i < num_inclusion_polygons; i++) {
         const Vector2f* boundary = fence->polyfence().get_inclusion_polygon(i, num_points);
         if ((boundary != nullptr) && (num_points >= 3)) {
             Vector2f intersection;
@@ -552,7 +628,8 @@ bool AP_OADijkstra::intersects_fence(const Vector2f &seg_start, const Vector2f &
     }
 
     // determine if segment crosses any of the exclusion polygons
-    for (uint8_t i = 0; i < fence->polyfence().get_exclusion_polygon_count(); i++) {
+    const uint8_t num_exclusion_polygons = (fence_types & FENCE_TYPE_EXCLUSION_POLYGON) ? fence->polyfence().get_exclusion_polygon_count() : 0;
+    for (uint8_t i = 0; i < num_exclusion_polygons; i++) {
         const Vector2f* boundary = fence->polyfence().get_exclusion_polygon(i, num_points);
         if ((boundary != nullptr) && (num_points >= 3)) {
             Vector2f intersection;
@@ -563,7 +640,8 @@ bool AP_OADijkstra::intersects_fence(const Vector2f &seg_start, const Vector2f &
     }
 
     // determine if segment crosses any of the inclusion circles
-    for (uint8_t i = 0; i < fence->polyfence().get_inclusion_circle_count(); i++) {
+    const uint8_t num_inclusion_circles = (fence_types & FENCE_TYPE_INCLUSION) ? fence->polyfence().get_inclusion_circle_count() : 0;
+    for (uint8_t i = 0; i < num_inclusion_circles; i++) {
         Vector2f center_pos_cm;
         float radius;
         if (fence->polyfence().get_inclusion_circle(i, center_pos_cm, radius)) {
@@ -579,7 +657,8 @@ bool AP_OADijkstra::intersects_fence(const Vector2f &seg_start, const Vector2f &
     }
 
     // determine if segment crosses any of the exclusion circles
-    for (uint8_t i = 0; i < fence->polyfence().get_exclusion_circle_count(); i++) {
+    const uint8_t num_exclusion_circles = (fence_types & FENCE_TYPE_EXCLUSION_CIRCLE) ? fence->polyfence().get_exclusion_circle_count() : 0;
+    for (uint8_t i = 0; i < num_exclusion_circles; i++) {
         Vector2f center_pos_cm;
         float radius;
         if (fence->polyfence().get_exclusion_circle(i, center_pos_cm, radius)) {
@@ -597,7 +676,34 @@ bool AP_OADijkstra::intersects_fence(const Vector2f &seg_start, const Vector2f &
     return false;
 }
 
+// returns the first fence type in fence_types blocking a line segment as 1 + its bit number, or 0 if none block it
+uint8_t AP_OADijkstra::fence_blocking_segment(const Vector2f &seg_start, const Vector2f &seg_end, uint8_t fence_types) const
+{
+    for (uint8_t t = 0; t < FENCE_TYPE_COUNT; t++) {
+        if ((fence_types & (1U << t)) && intersects_fence(seg_start, seg_end, 1U << t)) {
+            return t + 1;
+        }
+    }
+    return 0;
+}
+
+// get the visibility state of fence points i and j (i < j) in a fence visibility table
+uint8_t AP_OADijkstra::get_fence_vis(const uint8_t *vis, uint16_t i, uint16_t j)
+{
+    const uint32_t pair = ((uint32_t)j * (j - 1)) / 2 + i;
+    return (vis[pair / 4] >> ((pair % 4) * 2)) & 0x03;
+}
+
+// set the visibility state of fence points i and j (i < j) in a fence visibility table
+void AP_OADijkstra::set_fence_vis(uint8_t *vis, uint16_t i, uint16_t j, uint8_t state)
+{
+    const uint32_t pair = ((uint32_t)j * (j - 1)) / 2 + i;
+    const uint8_t shift = (pair % 4) * 2;
+    vis[pair / 4] = (vis[pair / 4] & ~(0x03 << shift)) | ((state & 0x03) << shift);
+}
+
 // create visibility graph for all fence (with margin) points
+// only pairs of points affected by fence types in _fence_changed are checked again
 // returns true on success.  returns false on failure and err_id is updated
 // requires these functions to have been run create_inclusion_polygon_with_margin, create_exclusion_polygon_with_margin, create_exclusion_circle_with_margin
 bool AP_OADijkstra::create_fence_visgraph(AP_OADijkstra_Error &err_id)
@@ -610,36 +716,93 @@ bool AP_OADijkstra::create_fence_visgraph(AP_OADijkstra_Error &err_id)
     }
 
     // fail if more fence points than algorithm can handle
-    if (total_numpoints() >= OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) {
+    const uint16_t numpoints = total_numpoints();
+    if (numpoints >= OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) {
         err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_TOO_MANY_FENCE_POINTS;
+        delete[] _fence_vis;
+        _fence_vis = nullptr;
+        _fence_changed = FENCE_TYPE_ALL;
         return false;
     }
 
-    // clear fence points visibility graph
-    _fence_visgraph.clear();
-
-    // calculate distance from each point to all other points
-    for (uint8_t i = 0; i < total_numpoints() - 1; i++) {
-        Vector2f start_seg;
-        if (get_point(i, start_seg)) {
-            for (uint8_t j = i + 1; j < total_numpoints(); j++) {
-                Vector2f end_seg;
-                if (get_point(j, end_seg)) {
-                    // if line segment does not intersect with any inclusion or exclusion zones add to visgraph
-                    if (!intersects_fence(start_seg, end_seg)) {
-                        if (!_fence_visgraph.add_item({AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i},
-                                                      {AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, j},
-                                                      (start_seg - end_seg).length())) {
-                            // failure to add a point can only be caused by out-of-memory
-                            err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
-                            return false;
-                        }
-                    }
+    // allocate new visibility table, two bits per pair of points
+    const uint32_t num_pairs = ((uint32_t)numpoints * (numpoints - 1)) / 2;
+    uint8_t *vis = new uint8_t[(num_pairs + 3) / 4];
+    if (vis == nullptr) {
+        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
+        delete[] _fence_vis;
+        _fence_vis = nullptr;
+        _fence_changed = FENCE_TYPE_ALL;
+        return false;
+    }
+
+    // index of first point of each fence type in the old and new tables
+    // points of unchanged fence types are the same, only their index may have moved
+    const uint8_t type_numpoints[FENCE_TYPE_COUNT] = {_inclusion_polygon_numpoints, _exclusion_polygon_numpoints, _exclusion_circle_numpoints};
+    uint16_t old_start[FENCE_TYPE_COUNT] {};
+    uint16_t new_start[FENCE_TYPE_COUNT] {};
+    for (uint8_t t = 1; t < FENCE_TYPE_COUNT; t++) {
+        old_start[t] = old_start[t-1] + _fence_vis_numpoints[t-1];
+        new_start[t] = new_start[t-1] + type_numpoints[t-1];
+    }
+    const uint8_t changed = (_fence_vis == nullptr) ? uint8_t(FENCE_TYPE_ALL) : _fence_changed;
+
+    for (uint16_t j = 1; j < numpoints; j++) {
+        Vector2f end_seg;
+        if (!get_point(j, end_seg)) {
+            continue;
+        }
+        const uint8_t type_j = get_point_type(j);
+        for (uint16_t i = 0; i < j; i++) {
+            Vector2f start_seg;
+            if (!get_point(i, start_seg)) {
+                continue;
+            }
+            const uint8_t type_i = get_point_type(i);
+            uint8_t state;
+            if ((changed & (1U << type_i)) || (changed & (1U << type_j))) {
+                // at least one point has moved, check against all fences
+                state = fence_blocking_segment(start_seg, end_seg, FENCE_TYPE_ALL);
+                _timing.checks++;
+            } else {
+                const uint8_t old_state = get_fence_vis(_fence_vis, i - new_start[type_i] + old_start[type_i], j - new_start[type_j] + old_start[type_j]);
+                if (old_state == 0) {
+                    // was visible, so only the changed fences can now block it
+                    state = fence_blocking_segment(start_seg, end_seg, changed);
+                    _timing.checks++;
+                } else if (changed & (1U << (old_state - 1))) {
+                    // the fence that blocked it has changed
+                    state = fence_blocking_segment(start_seg, end_seg, FENCE_TYPE_ALL);
+                    _timing.checks++;
+                } else {
+                    // still blocked by the same unchanged fence
+                    state = old_state;
                 }
             }
+            set_fence_vis(vis, i, j, state);
         }
     }
 
+    // replace old table
+    delete[] _fence_vis;
+    _fence_vis = vis;
+    memcpy(_fence_vis_numpoints, type_numpoints, sizeof(_fence_vis_numpoints));
+    _fence_changed = FENCE_TYPE_NONE;
+
+    // allocate what the path search needs for these fence points now,
+    // so it does not allocate while searching. The source and
+    // destination graphs hold at most one item per fence point plus
+    // one, and the search at most one entry per node
+    const uint16_t numnodes = numpoints + 2;
+    if (!_source_visgraph.reserve(numpoints + 1) ||
+        !_destination_visgraph.reserve(numpoints + 1) ||
+        !_short_path_data.reserve(numnodes) ||
+        !_heap.reserve(numnodes) ||
+        !_path.reserve(numnodes)) {
+        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
+        return false;
+    }
+
     return true;
 }
 
@@ -684,46 +847,70 @@ bool AP_OADijkstra::update_visgraph(AP_OAVisGraph& visgraph, const AP_OAVisGraph
 
 // update total distance for all nodes visible from current node
 // curr_node_idx is an index into the _short_path_data array
-void AP_OADijkstra::update_visible_node_distances(node_index curr_node_idx)
+// returns false if out of memory
+bool AP_OADijkstra::update_visible_node_distances(node_index curr_node_idx)
 {
     // sanity check
     if (curr_node_idx >= _short_path_data_numpoints) {
-        return;
+        return true;
     }
 
     // get current node for convenience
     const ShortPathNode &curr_node = _short_path_data[curr_node_idx];
 
-    // for each visibility graph
-    const AP_OAVisGraph* visgraphs[] = {&_fence_visgraph, &_destination_visgraph};
-    for (uint8_t v=0; v<ARRAY_SIZE(visgraphs); v++) {
-
-        // skip if empty
-        const AP_OAVisGraph &curr_visgraph = *visgraphs[v];
-        if (curr_visgraph.num_items() == 0) {
-            continue;
-        }
-
-        // search visibility graph for items visible from current_node
-        for (uint16_t i = 0; i < curr_visgraph.num_items(); i++) {
-            const AP_OAVisGraph::VisGraphItem &item = curr_visgraph[i];
-            // match if current node's id matches either of the id's in the graph (i.e. either end of the vector)
-            if ((curr_node.id == item.id1) || (curr_node.id == item.id2)) {
-                AP_OAVisGraph::OAItemID matching_id = (curr_node.id == item.id1) ? item.id2 : item.id1;
-                // find item's id in node array
+    // fence points visible from a fence point are found directly from the fence visibility table
+    if ((curr_node.id.id_type == AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT) && (_fence_vis != nullptr)) {
+        const uint16_t curr_id = curr_node.id.id_num;
+        Vector2f curr_pos;
+        if (get_point(curr_id, curr_pos)) {
+            for (uint16_t i = 0; i < total_numpoints(); i++) {
+                if ((i == curr_id) ||
+                    (get_fence_vis(_fence_vis, MIN(i, curr_id), MAX(i, curr_id)) != 0)) {
+                    continue;
+                }
                 node_index item_node_idx;
-                if (find_node_from_id(matching_id, item_node_idx)) {
-                    // if current node's distance + distance to item is less than item's current distance, update item's distance
-                    const float dist_to_item_via_current_node = _short_path_data[curr_node_idx].distance_cm + item.distance_cm;
-                    if (dist_to_item_via_current_node < _short_path_data[item_node_idx].distance_cm) {
-                        // update item's distance and set "distance_from_idx" to current node's index
-                        _short_path_data[item_node_idx].distance_cm = dist_to_item_via_current_node;
-                        _short_path_data[item_node_idx].distance_from_idx = curr_node_idx;
+                Vector2f item_pos;
+                if (find_node_from_id({AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, (AP_OAVisGraph::oaid_num)i}, item_node_idx) &&
+                    !_short_path_data[item_node_idx].visited && get_point(i, item_pos)) {
+                    if (!update_node_distance(curr_node_idx, item_node_idx, (curr_pos - item_pos).length())) {
+                        return false;
                     }
                 }
             }
         }
     }
+
+    // search destination visibility graph for items visible from current_node
+    for (uint16_t i = 0; i < _destination_visgraph.num_items(); i++) {
+        const AP_OAVisGraph::VisGraphItem &item = _destination_visgraph[i];
+        // match if current node's id matches either of the id's in the graph (i.e. either end of the vector)
+        if ((curr_node.id == item.id1) || (curr_node.id == item.id2)) {
+            AP_OAVisGraph::OAItemID matching_id = (curr_node.id == item.id1) ? item.id2 : item.id1;
+            // find item's id in node array
+            node_index item_node_idx;
+            if (find_node_from_id(matching_id, item_node_idx) && !_short_path_data[item_node_idx].visited) {
+                if (!update_node_distance(curr_node_idx, item_node_idx, item.distance_cm)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// update a node's distance if it is shorter to reach it via the current node
+// returns false if out of memory
+bool AP_OADijkstra::update_node_distance(node_index curr_node_idx, node_index item_node_idx, float distance_cm)
+{
+    // if current node's distance + distance to item is less than item's current distance, update item's distance
+    const float dist_to_item_via_current_node = _short_path_data[curr_node_idx].distance_cm + distance_cm;
+    if (dist_to_item_via_current_node < _short_path_data[item_node_idx].distance_cm) {
+        // update item's distance and set "distance_from_idx" to current node's index
+        _short_path_data[item_node_idx].distance_cm = dist_to_item_via_current_node;
+        _short_path_data[item_node_idx].distance_from_idx = curr_node_idx;
+        return heap_push_or_update(item_node_idx);
+    }
+    return true;
 }
 
 // find a node's index into _short_path_data array from it's id (i.e. id type and id number)
@@ -758,34 +945,140 @@ bool AP_OADijkstra::find_node_from_id(const AP_OAVisGraph::OAItemID &id, node_in
     return false;
 }
 
-// find index of node with lowest tentative distance (ignore visited nodes)
-// returns true if successful and node_idx argument is updated
-bool AP_OADijkstra::find_closest_node_idx(node_index &node_idx) const
+// returns true if node a should be searched before node b
+bool AP_OADijkstra::heap_less(node_index a, node_index b) const
 {
-    node_index lowest_idx = 0;
-    float lowest_dist = FLT_MAX;
+    const ShortPathNode &node_a = _short_path_data[a];
+    const ShortPathNode &node_b = _short_path_data[b];
+    return (node_a.distance_cm + node_a.heuristic_cm) < (node_b.distance_cm + node_b.heuristic_cm);
+}
+
+// set element at pos in heap and update the node's heap position
+void AP_OADijkstra::heap_set(uint16_t pos, node_index node_idx)
+{
+    _heap[pos] = node_idx;
+    _short_path_data[node_idx].heap_pos = pos;
+}
+
+// restore heap order by moving the element at pos up towards the root
+void AP_OADijkstra::heap_sift_up(uint16_t pos)
+{
+    const node_index node_idx = _heap[pos];
+    while (pos > 0) {
+        const uint16_t parent = (pos - 1) / 2;
+        if (!heap_less(node_idx, _heap[parent])) {
+            break;
+        }
+        heap_set(pos, _heap[parent]);
+        pos = parent;
+    }
+    heap_set(pos, node_idx);
+}
 
-    // scan through all nodes looking for closest
-    for (node_index i=0; i<_short_path_data_numpoints; i++) {
-        const ShortPathNode &node = _short_path_data[i];
-        if (!node.visited && (node.distance_cm < lowest_dist)) {
-            lowest_idx = i;
-            lowest_dist = node.distance_cm;
+// restore heap order by moving the element at pos down towards the leaves
+void AP_OADijkstra::heap_sift_down(uint16_t pos)
+{
+    const node_index node_idx = _heap[pos];
+    while (true) {
+        uint16_t child = pos * 2 + 1;
+        if (child >= _heap_numpoints) {
+            break;
         }
+        if ((child + 1 < _heap_numpoints) && heap_less(_heap[child + 1], _heap[child])) {
+            child++;
+        }
+        if (!heap_less(_heap[child], node_idx)) {
+            break;
+        }
+        heap_set(pos, _heap[child]);
+        pos = child;
     }
+    heap_set(pos, node_idx);
+}
 
-    if (lowest_dist < FLT_MAX) {
-        node_idx = lowest_idx;
+// add node to the heap, or move it up the heap if already there and its distance has reduced
+// returns false if out of memory
+bool AP_OADijkstra::heap_push_or_update(node_index node_idx)
+{
+    const node_index heap_pos = _short_path_data[node_idx].heap_pos;
+    if (heap_pos != OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) {
+        // distance can only have reduced
+        heap_sift_up(heap_pos);
         return true;
     }
-    return false;
+    if (!_heap.expand_to_hold(_heap_numpoints + 1)) {
+        return false;
+    }
+    _heap_numpoints++;
+    heap_set(_heap_numpoints - 1, node_idx);
+    heap_sift_up(_heap_numpoints - 1);
+    return true;
 }
 
-// calculate shortest path from origin to destination
-// returns true on success.  returns false on failure and err_id is updated
+// remove node with lowest distance plus heuristic from the heap
+// returns true if successful and node_idx argument is updated
+bool AP_OADijkstra::heap_pop(node_index &node_idx)
+{
+    if (_heap_numpoints == 0) {
+        return false;
+    }
+    node_idx = _heap[0];
+    _short_path_data[node_idx].heap_pos = OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX;
+    _heap_numpoints--;
+    if (_heap_numpoints > 0) {
+        heap_set(0, _heap[_heap_numpoints]);
+        heap_sift_down(0);
+    }
+    return true;
+}
+
+// calculate shortest path from origin to destination using A* search
+// the search runs for at most OA_DIJKSTRA_SEARCH_TIME_US per call, returning IN_PROGRESS until done
+// returns COMPLETE on success.  returns FAILED on failure and err_id is updated
 // requires these functions to have been run: create_inclusion_polygon_with_margin, create_exclusion_polygon_with_margin, create_exclusion_circle_with_margin, create_polygon_fence_visgraph
 // resulting path is stored in _shortest_path array as vector offsets from EKF origin
-bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &destination, AP_OADijkstra_Error &err_id)
+AP_OADijkstra::PathSearchState AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &destination, AP_OADijkstra_Error &err_id)
+{
+    const uint32_t start_us = AP_HAL::micros();
+
+    if (!_path_search_active) {
+        if (!start_shortest_path(origin, destination, err_id)) {
+            return PathSearchState::FAILED;
+        }
+        _path_search_active = true;
+    }
+
+    // move current_node_idx to unvisited node with lowest distance plus heuristic
+    node_index current_node_idx;
+    while (heap_pop(current_node_idx)) {
+        // mark current node as visited
+        _short_path_data[current_node_idx].visited = true;
+
+        // with a straight line heuristic the destination's distance is final once it is reached
+        if (_short_path_data[current_node_idx].id.id_type == AP_OAVisGraph::OATYPE_DESTINATION) {
+            break;
+        }
+
+        // update distances to all neighbours of current node
+        if (!update_visible_node_distances(current_node_idx)) {
+            _path_search_active = false;
+            err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
+            return PathSearchState::FAILED;
+        }
+
+        // give up the thread if we have run for too long, continuing from here next time
+        if (AP_HAL::micros() - start_us > OA_DIJKSTRA_SEARCH_TIME_US) {
+            return PathSearchState::IN_PROGRESS;
+        }
+    }
+
+    _path_search_active = false;
+    return extract_shortest_path(err_id) ? PathSearchState::COMPLETE : PathSearchState::FAILED;
+}
+
+// start a new search from origin to destination
+// returns true on success.  returns false on failure and err_id is updated
+bool AP_OADijkstra::start_shortest_path(const Location &origin, const Location &destination, AP_OADijkstra_Error &err_id)
 {
     // convert origin and destination to offsets from EKF origin
     Vector2f origin_NE, destination_NE;
@@ -810,42 +1103,51 @@ bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &d
         return false;
     }
 
-    // add origin and destination (node_type, id, visited, distance_from_idx, distance_cm) to short_path_data array
-    _short_path_data[0] = {{AP_OAVisGraph::OATYPE_SOURCE, 0}, false, 0, 0};
-    _short_path_data[1] = {{AP_OAVisGraph::OATYPE_DESTINATION, 0}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX};
+    // add origin and destination (node_type, id, visited, distance_from_idx, distance_cm, heuristic_cm, heap_pos) to short_path_data array
+    _short_path_data[0] = {{AP_OAVisGraph::OATYPE_SOURCE, 0}, false, 0, 0, (destination_NE - origin_NE).length(), OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX};
+    _short_path_data[1] = {{AP_OAVisGraph::OATYPE_DESTINATION, 0}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX, 0, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX};
     _short_path_data_numpoints = 2;
 
-    // add all inclusion and exclusion fence points to short_path_data array (node_type, id, visited, distance_from_idx, distance_cm)
+    // add all inclusion and exclusion fence points to short_path_data array (node_type, id, visited, distance_from_idx, distance_cm, heuristic_cm, heap_pos)
     for (uint8_t i=0; i<total_numpoints(); i++) {
-        _short_path_data[_short_path_data_numpoints++] = {{AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX};
+        Vector2f point;
+        const float heuristic_cm = get_point(i, point) ? (destination_NE - point).length() : 0;
+        _short_path_data[_short_path_data_numpoints++] = {{AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX, heuristic_cm, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX};
     }
+    _heap_numpoints = 0;
 
     // start algorithm from source point
-    node_index current_node_idx = 0;
+    const node_index source_node_idx = 0;
 
     // update nodes visible from source point
     for (uint16_t i = 0; i < _source_visgraph.num_items(); i++) {
         node_index node_idx;
         if (find_node_from_id(_source_visgraph[i].id2, node_idx)) {
             _short_path_data[node_idx].distance_cm = _source_visgraph[i].distance_cm;
-            _short_path_data[node_idx].distance_from_idx = current_node_idx;
+            _short_path_data[node_idx].distance_from_idx = source_node_idx;
+            if (!heap_push_or_update(node_idx)) {
+                err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
+                return false;
+            }
         } else {
             err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
             return false;
         }
     }
     // mark source node as visited
-    _short_path_data[current_node_idx].visited = true;
+    _short_path_data[source_node_idx].visited = true;
 
-    // move current_node_idx to node with lowest distance
-    while (find_closest_node_idx(current_node_idx)) {
-        // update distances to all neighbours of current node
-        update_visible_node_distances(current_node_idx);
+    // record source and destination for get_shortest_path_point
+    _path_source = origin_NE;
+    _path_destination = destination_NE;
 
-        // mark current node as visited
-        _short_path_data[current_node_idx].visited = true;
-    }
+    return true;
+}
 
+// extract the path found by the search into the _path array
+// returns true on success.  returns false on failure and err_id is updated
+bool AP_OADijkstra::extract_shortest_path(AP_OADijkstra_Error &err_id)
+{
     // extract path starting from destination
     bool success = false;
     node_index nidx;
@@ -878,17 +1180,54 @@ bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &d
             }
         }
     }
-    // update source and destination for by get_shortest_path_point
-    if (success) {
-        _path_source = origin_NE;
-        _path_destination = destination_NE;
-    } else {
+    if (!success) {
         err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
     }
 
     return success;
 }
 
+// log timing of last replan
+void AP_OADijkstra::log_timing() const
+{
+// @LoggerMessage: OADT
+// @Description: Object avoidance (Dijkstra) replan timing
+// @Field: TimeUS: Time since system startup
+// @Field: FenceUS: time spent creating fence points with margin
+// @Field: VisUS: time spent updating the fence visibility graph
+// @Field: PathUS: time spent finding the shortest path
+// @Field: Chk: number of fence point pairs checked against the fence
+// @Field: Pts: number of fence points
+// @Field: Mem: bytes allocated for fence points and path search
+    AP::logger().Write("OADT", "TimeUS,FenceUS,VisUS,PathUS,Chk,Pts,Mem", "QIIIHHI",
+                       AP_HAL::micros64(),
+                       _timing.fence_us,
+                       _timing.visgraph_us,
+                       _timing.path_us,
+                       _timing.checks,
+                       total_numpoints(),
+                       mem_used());
+}
+
+// bytes allocated for fence points and path search
+uint32_t AP_OADijkstra::mem_used() const
+{
+    uint32_t vis_bytes = 0;
+    if (_fence_vis != nullptr) {
+        const uint32_t n = _fence_vis_numpoints[0] + _fence_vis_numpoints[1] + _fence_vis_numpoints[2];
+        vis_bytes = ((n * (n - 1)) / 2 + 3) / 4;
+    }
+    return vis_bytes +
+           _inclusion_polygon_pts.mem_used() +
+           _exclusion_polygon_pts.mem_used() +
+           _exclusion_circle_pts.mem_used() +
+           _source_visgraph.mem_used() +
+           _destination_visgraph.mem_used() +
+           _short_path_data.mem_used() +
+           _heap.mem_used() +
+           _path.mem_used();
+}
+
 // return point from final path as an offset (in cm) from the ekf origin
 bool AP_OADijkstra::get_shortest_path_point(uint8_t point_num, Vector2f& pos)
 {
@@ -26,7 +26,8 @@ public:
     enum AP_OADijkstra_State : uint8_t {
         DIJKSTRA_STATE_NOT_REQUIRED = 0,
         DIJKSTRA_STATE_ERROR,
-        DIJKSTRA_STATE_SUCCESS
+        DIJKSTRA_STATE_SUCCESS,
+        DIJKSTRA_STATE_PROCESSING       // still searching for path, call again to continue
     };
 
     // calculate a destination to avoid the polygon fence
@@ -50,6 +51,16 @@ private:
         DIJKSTRA_ERROR_COULD_NOT_FIND_PATH
     };
 
+    // fence types as bits, so a set of changed fence types fits in a mask
+    enum FenceType : uint8_t {
+        FENCE_TYPE_NONE                 = 0,
+        FENCE_TYPE_INCLUSION            = (1U<<0),  // inclusion polygons and circles
+        FENCE_TYPE_EXCLUSION_POLYGON    = (1U<<1),
+        FENCE_TYPE_EXCLUSION_CIRCLE     = (1U<<2),
+        FENCE_TYPE_ALL                  = 0x07
+    };
+    static const uint8_t FENCE_TYPE_COUNT = 3;
+
     // return error message for a given error id
     const char* get_error_msg(AP_OADijkstra_Error error_id) const;
 
@@ -103,18 +114,49 @@ private:
     // also returns the type of point
     bool get_point(uint16_t index, Vector2f& point) const;
 
+    // returns the type (0 for inclusion, 1 for exclusion polygon, 2 for exclusion circle) of the fence point at index
+    uint8_t get_point_type(uint16_t index) const;
+
     // returns true if line segment intersects polygon or circular fence
-    bool intersects_fence(const Vector2f &seg_start, const Vector2f &seg_end) const;
+    // fence_types is a bitmask of FenceType, limiting which fences are checked
+    bool intersects_fence(const Vector2f &seg_start, const Vector2f &seg_end, uint8_t fence_types = FENCE_TYPE_ALL) const;
+
+    // returns the first fence type in fence_types blocking a line segment as 1 + its bit number, or 0 if none block it
+    uint8_t fence_blocking_segment(const Vector2f &seg_start, const Vector2f &seg_end, uint8_t fence_types) const;
 
     // create visibility graph for all fence (with margin) points
+    // only pairs of points affected by fence types in _fence_changed are checked again
     // returns true on success.  returns false on failure and err_id is updated
     bool create_fence_visgraph(AP_OADijkstra_Error &err_id);
 
-    // calculate shortest path from origin to destination
-    // returns true on success.  returns false on failure and err_id is updated
+    // get or set the visibility state of fence points i and j (i < j) in a fence visibility table
+    static uint8_t get_fence_vis(const uint8_t *vis, uint16_t i, uint16_t j);
+    static void set_fence_vis(uint8_t *vis, uint16_t i, uint16_t j, uint8_t state);
+
+    // record that a fence type has changed if crc differs from the one it was last built with
+    void update_fence_crc(uint8_t type_idx, uint32_t crc);
+
+    // result of one call to calc_shortest_path
+    enum class PathSearchState : uint8_t {
+        FAILED = 0,
+        IN_PROGRESS,
+        COMPLETE
+    };
+
+    // calculate shortest path from origin to destination using A* search
+    // the search runs for at most OA_DIJKSTRA_SEARCH_TIME_US per call, returning IN_PROGRESS until done
+    // returns COMPLETE on success.  returns FAILED on failure and err_id is updated
     // requires create_polygon_fence_with_margin and create_polygon_fence_visgraph to have been run
     // resulting path is stored in _shortest_path array as vector offsets from EKF origin
-    bool calc_shortest_path(const Location &origin, const Location &destination, AP_OADijkstra_Error &err_id);
+    PathSearchState calc_shortest_path(const Location &origin, const Location &destination, AP_OADijkstra_Error &err_id);
+
+    // start a new search from origin to destination
+    // returns true on success.  returns false on failure and err_id is updated
+    bool start_shortest_path(const Location &origin, const Location &destination, AP_OADijkstra_Error &err_id);
+
+    // extract the path found by the search into the _path array
+    // returns true on success.  returns false on failure and err_id is updated
+    bool extract_shortest_path(AP_OADijkstra_Error &err_id);
 
     // shortest path state variables
     bool _inclusion_polygon_with_margin_ok;
@@ -122,6 +164,7 @@ private:
     bool _exclusion_circle_with_margin_ok;
     bool _polyfence_visgraph_ok;
     bool _shortest_path_ok;
+    bool _path_search_active;       // true while a search started by start_shortest_path has not finished
 
     Location _destination_prev;     // destination of previous iterations (used to determine if path should be re-calculated)
     uint8_t _path_idx_returned;     // index into _path array which gives location vehicle should be currently moving towards
@@ -142,8 +185,15 @@ private:
     uint8_t _exclusion_circle_numpoints;    // number of points held in above array
     uint32_t _exclusion_circle_update_ms;   // system time exclusion circles were updated (used to detect changes)
 
+    // fence-to-fence visibility graph, kept between fence updates. Two bits per pair of
+    // fence (with margin) points, 0 if the points are visible to each other, otherwise
+    // 1 + the bit number of the first fence type found blocking them
+    uint8_t *_fence_vis;
+    uint8_t _fence_vis_numpoints[FENCE_TYPE_COUNT]; // number of points of each fence type when _fence_vis was built
+    uint32_t _fence_crc[FENCE_TYPE_COUNT];  // crc of each fence type's points when _fence_vis was built
+    uint8_t _fence_changed = FENCE_TYPE_ALL;    // bitmask of fence types changed since _fence_vis was built
+
     // visibility graphs
-    AP_OAVisGraph _fence_visgraph;          // holds distances between all inclusion/exclusion fence points (with margin)
     AP_OAVisGraph _source_visgraph;         // holds distances from source point to all other nodes
     AP_OAVisGraph _destination_visgraph;    // holds distances from the destination to all other nodes
 
@@ -159,21 +209,46 @@ private:
         bool visited;                   // true if all this node's neighbour's distances have been updated
         node_index distance_from_idx;   // index into _short_path_data from where distance was updated (or 255 if not set)
         float distance_cm;              // distance from source (number is tentative until this node is the current node and/or visited = true)
+        float heuristic_cm;             // straight line distance to destination, never more than the path distance
+        node_index heap_pos;            // position in _heap (or 255 if not in heap)
     };
     AP_ExpandingArray<ShortPathNode> _short_path_data;
     node_index _short_path_data_numpoints;  // number of elements in _short_path_data array
 
     // update total distance for all nodes visible from current node
     // curr_node_idx is an index into the _short_path_data array
-    void update_visible_node_distances(node_index curr_node_idx);
+    // returns false if out of memory
+    bool update_visible_node_distances(node_index curr_node_idx);
+
+    // update a node's distance if it is shorter to reach it via the current node
+    // returns false if out of memory
+    bool update_node_distance(node_index curr_node_idx, node_index item_node_idx, float distance_cm);
 
     // find a node's index into _short_path_data array from it's id (i.e. id type and id number)
     // returns true if successful and node_idx is updated
     bool find_node_from_id(const AP_OAVisGraph::OAItemID &id, node_index &node_idx) const;
 
-    // find index of node with lowest tentative distance (ignore visited nodes)
+    // binary min-heap of unvisited nodes with a tentative distance, ordered by distance plus heuristic
+    AP_ExpandingArray<node_index> _heap;
+    uint16_t _heap_numpoints;           // number of elements in _heap
+
+    // add node to the heap, or move it up the heap if already there and its distance has reduced
+    // returns false if out of memory
+    bool heap_push_or_update(node_index node_idx);
+
+    // remove node with lowest distance plus heuristic from the heap
     // returns true if successful and node_idx argument is updated
-    bool find_closest_node_idx(node_index &node_idx) const;
+    bool heap_pop(node_index &node_idx);
+
+    // restore heap order by moving the element at pos up or down
+    void heap_sift_up(uint16_t pos);
+    void heap_sift_down(uint16_t pos);
+
+    // returns true if node a should be searched before node b
+    bool heap_less(node_index a, node_index b) const;
+
+    // set element at pos in heap and update the node's heap position
+    void heap_set(uint16_t pos, node_index node_idx);
 
     // final path variables and functions
     AP_ExpandingArray<AP_OAVisGraph::OAItemID> _path;   // ids of points on return path in reverse order (i.e. destination is first element)
@@ -184,6 +259,20 @@ private:
     // return point from final path as an offset (in cm) from the ekf origin
     bool get_shortest_path_point(uint8_t point_num, Vector2f& pos);
 
+    // time taken by each phase of the last replan
+    struct {
+        uint32_t fence_us;          // creating fence points with margin
+        uint32_t visgraph_us;       // updating fence visibility graph
+        uint32_t path_us;           // source and destination visibility graphs and shortest path
+        uint16_t checks;            // number of fence visibility graph pairs checked against the fence
+    } _timing;
+
+    // log timing of last replan
+    void log_timing() const;
+
+    // bytes allocated for fence points and path search
+    uint32_t mem_used() const;
+
     AP_OADijkstra_Error _error_last_id;                 // last error id sent to GCS
     uint32_t _error_last_report_ms;                     // last time an error message was sent to GCS
 };
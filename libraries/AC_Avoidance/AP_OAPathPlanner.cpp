@@ -26,6 +26,7 @@ extern const AP_HAL::HAL &hal;
 // parameter defaults
 const float OA_LOOKAHEAD_DEFAULT = 15;
 const float OA_MARGIN_MAX_DEFAULT = 5;
+const int16_t OA_BENDYRULER_BEARING_INC_DEFAULT = 5;
 
 const int16_t OA_UPDATE_MS = 1000;      // path planning updates run at 1hz
 const int16_t OA_TIMEOUT_MS = 3000;     // results over 3 seconds old are ignored
@@ -61,6 +62,15 @@ const AP_Param::GroupInfo AP_OAPathPlanner::var_info[] = {
     // @Path: AP_OADatabase.cpp
     AP_SUBGROUPINFO(_oadatabase, "DB_", 4, AP_OAPathPlanner, AP_OADatabase),
 
+    // @Param: BR_BEAR_INC
+    // @DisplayName: BendyRuler bearing increment
+    // @Description: BendyRuler checks paths this many degrees apart around the vehicle. Smaller values allow finer steering around obstacles but use more CPU
+    // @Units: deg
+    // @Range: 1 30
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("BR_BEAR_INC", 5, AP_OAPathPlanner, _bendy_bearing_inc, OA_BENDYRULER_BEARING_INC_DEFAULT),
+
     AP_GROUPEND
 };
 
@@ -192,6 +202,9 @@ AP_OAPathPlanner::OA_RetState AP_OAPathPlanner::mission_avoidance(const Location
 // avoidance thread that continually updates the avoidance_result structure based on avoidance_request
 void AP_OAPathPlanner::avoidance_thread()
 {
+    // true if the last update has more work to do, so should be run again without waiting
+    bool processing = false;
+
     while (true) {
 
         // if database queue needs attention, service it faster
@@ -202,7 +215,7 @@ void AP_OAPathPlanner::avoidance_thread()
         }
 
         const uint32_t now = AP_HAL::millis();
-        if (now - avoidance_latest_ms < OA_UPDATE_MS) {
+        if (!processing && (now - avoidance_latest_ms < OA_UPDATE_MS)) {
             continue;
         }
         avoidance_latest_ms = now;
@@ -235,7 +248,7 @@ void AP_OAPathPlanner::avoidance_thread()
             if (_oabendyruler == nullptr) {
                 continue;
             }
-            _oabendyruler->set_config(_lookahead, _margin_max);
+            _oabendyruler->set_config(_lookahead, _margin_max, _bendy_bearing_inc);
             if (_oabendyruler->update(avoidance_request2.current_loc, avoidance_request2.destination, avoidance_request2.ground_speed_vec, origin_new, destination_new)) {
                 res = OA_SUCCESS;
             }
@@ -257,9 +270,13 @@ void AP_OAPathPlanner::avoidance_thread()
             case AP_OADijkstra::DIJKSTRA_STATE_SUCCESS:
                 res = OA_SUCCESS;
                 break;
+            case AP_OADijkstra::DIJKSTRA_STATE_PROCESSING:
+                res = OA_PROCESSING;
+                break;
             }
             break;
         }
+        processing = (res == OA_PROCESSING);
 
         {
             // give the main thread the avoidance result
@@ -84,6 +84,7 @@ private:
     AP_Int8 _type;                  // avoidance algorith to be used
     AP_Float _lookahead;            // object avoidance will look this many meters ahead of vehicle
     AP_Float _margin_max;           // object avoidance will ignore objects more than this many meters from vehicle
+    AP_Int8 _bendy_bearing_inc;     // BendyRuler checks paths this many degrees apart
 
     // internal variables used by front end
     HAL_Semaphore_Recursive _rsem;  // semaphore for multi-thread use of avoidance_request and avoidance_result
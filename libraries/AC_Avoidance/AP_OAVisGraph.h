@@ -48,6 +48,12 @@ public:
     // add item to visiblity graph, returns true on success, false if graph is full
     bool add_item(const OAItemID &id1, const OAItemID &id2, float distance_cm);
 
+    // allocate space for num_items up front, returns true on success
+    bool reserve(uint16_t num_items) { return _items.reserve(num_items); }
+
+    // bytes allocated for the graph
+    uint32_t mem_used() const { return _items.mem_used(); }
+
     // allow accessing graph as an array, 0 indexed
     // Note: no protection against out-of-bounds accesses so use with num_items()
     const VisGraphItem& operator[](uint16_t i) const { return _items[i]; }
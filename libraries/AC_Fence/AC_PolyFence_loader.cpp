@@ -213,7 +213,7 @@ bool AC_PolyFence_loader::breached(const Vector2f& pos_cm) const
     // check we are inside each inclusion zone:
     for (uint8_t i=0; i<_num_loaded_inclusion_boundaries; i++) {
         const InclusionBoundary &boundary = _loaded_inclusion_boundary[i];
-        if (Polygon_outside(pos_cm, boundary.points, boundary.count)) {
+        if (boundary.index.outside(pos_cm)) {
             return true;
         }
     }
@@ -221,7 +221,7 @@ bool AC_PolyFence_loader::breached(const Vector2f& pos_cm) const
     // check we are outside each exclusion zone:
     for (uint8_t i=0; i<_num_loaded_exclusion_boundaries; i++) {
         const ExclusionBoundary &boundary = _loaded_exclusion_boundary[i];
-        if (!Polygon_outside(pos_cm, boundary.points, boundary.count)) {
+        if (!boundary.index.outside(pos_cm)) {
             return true;
         }
     }
@@ -340,7 +340,7 @@ out:
     return ret;
 }
 
-bool AC_PolyFence_loader::read_scaled_latlon_from_storage(const Location &origin, uint16_t &read_offset, Vector2f &pos_cm)
+bool AC_PolyFence_loader::read_scaled_latlon_from_storage(const LocationFrame &origin, uint16_t &read_offset, Vector2f &pos_cm)
 {
     Location tmp_loc;
     tmp_loc.lat = fence_storage.read_uint32(read_offset);
@@ -351,7 +351,7 @@ bool AC_PolyFence_loader::read_scaled_latlon_from_storage(const Location &origin
     return true;
 }
 
-bool AC_PolyFence_loader::read_polygon_from_storage(const Location &origin, uint16_t &read_offset, const uint8_t vertex_count, Vector2f *&next_storage_point)
+bool AC_PolyFence_loader::read_polygon_from_storage(const LocationFrame &origin, uint16_t &read_offset, const uint8_t vertex_count, Vector2f *&next_storage_point)
 {
     for (uint8_t i=0; i<vertex_count; i++) {
         // read and convert to lat/lon
@@ -617,6 +617,9 @@ bool AC_PolyFence_loader::load_from_eeprom()
 //        Debug("fence load requires origin");
         return false;
     }
+    // every point is converted relative to the origin, so only
+    // calculate its longitude scaling once
+    const LocationFrame origin_frame(ekf_origin);
 
     _load_attempted = true;
 
@@ -724,11 +727,12 @@ bool AC_PolyFence_loader::load_from_eeprom()
                 break;
             }
             storage_offset += 1; // skip vertex count
-            if (!read_polygon_from_storage(ekf_origin, storage_offset, index.count, next_storage_point)) {
+            if (!read_polygon_from_storage(origin_frame, storage_offset, index.count, next_storage_point)) {
                 gcs().send_text(MAV_SEVERITY_WARNING, "AC_Fence: polygon read failed");
                 storage_valid = false;
                 break;
             }
+            boundary.index.init(boundary.points, boundary.count);
             _num_loaded_inclusion_boundaries++;
             break;
         }
@@ -742,17 +746,18 @@ bool AC_PolyFence_loader::load_from_eeprom()
                 break;
             }
             storage_offset += 1; // skip vertex count
-            if (!read_polygon_from_storage(ekf_origin, storage_offset, index.count, next_storage_point)) {
+            if (!read_polygon_from_storage(origin_frame, storage_offset, index.count, next_storage_point)) {
                 gcs().send_text(MAV_SEVERITY_WARNING, "AC_Fence: polygon read failed");
                 storage_valid = false;
                 break;
             }
+            boundary.index.init(boundary.points, boundary.count);
             _num_loaded_exclusion_boundaries++;
             break;
         }
         case AC_PolyFenceType::CIRCLE_EXCLUSION: {
             ExclusionCircle &circle = _loaded_circle_exclusion_boundary[_num_loaded_circle_exclusion_boundaries];
-            if (!read_scaled_latlon_from_storage(ekf_origin, storage_offset, circle.pos_cm)) {
+            if (!read_scaled_latlon_from_storage(origin_frame, storage_offset, circle.pos_cm)) {
                 gcs().send_text(MAV_SEVERITY_WARNING, "AC_Fence: latlon read failed");
                 storage_valid = false;
                 break;
@@ -769,7 +774,7 @@ bool AC_PolyFence_loader::load_from_eeprom()
         }
         case AC_PolyFenceType::CIRCLE_INCLUSION: {
             InclusionCircle &circle = _loaded_circle_inclusion_boundary[_num_loaded_circle_inclusion_boundaries];
-            if (!read_scaled_latlon_from_storage(ekf_origin, storage_offset, circle.pos_cm)) {
+            if (!read_scaled_latlon_from_storage(origin_frame, storage_offset, circle.pos_cm)) {
                 gcs().send_text(MAV_SEVERITY_WARNING, "AC_Fence: latlon read failed");
                 storage_valid = false;
                 break;
@@ -791,7 +796,7 @@ bool AC_PolyFence_loader::load_from_eeprom()
                 break;
             }
             _loaded_return_point = next_storage_point;
-            if (!read_scaled_latlon_from_storage(ekf_origin, storage_offset, *next_storage_point)) {
+            if (!read_scaled_latlon_from_storage(origin_frame, storage_offset, *next_storage_point)) {
                 storage_valid = false;
                 gcs().send_text(MAV_SEVERITY_WARNING, "PolyFence: latlon read failed");
                 break;
@@ -827,6 +832,15 @@ Vector2f* AC_PolyFence_loader::get_exclusion_polygon(uint16_t index, uint16_t &n
     return boundary.points;
 }
 
+/// returns spatial index of the exclusion polygon's edges, nullptr if index is out of range
+const Polygon_index *AC_PolyFence_loader::get_exclusion_polygon_index(uint16_t index) const
+{
+    if (index >= _num_loaded_exclusion_boundaries) {
+        return nullptr;
+    }
+    return &_loaded_exclusion_boundary[index].index;
+}
+
 /// returns pointer to array of inclusion polygon points and num_points is filled in with the number of points in the polygon
 /// points are offsets in cm from EKF origin in NE frame
 Vector2f* AC_PolyFence_loader::get_inclusion_polygon(uint16_t index, uint16_t &num_points) const
@@ -841,6 +855,15 @@ Vector2f* AC_PolyFence_loader::get_inclusion_polygon(uint16_t index, uint16_t &n
     return boundary.points;
 }
 
+/// returns spatial index of the inclusion polygon's edges, nullptr if index is out of range
+const Polygon_index *AC_PolyFence_loader::get_inclusion_polygon_index(uint16_t index) const
+{
+    if (index >= _num_loaded_inclusion_boundaries) {
+        return nullptr;
+    }
+    return &_loaded_inclusion_boundary[index].index;
+}
+
 /// returns the specified exclusion circle
 /// circle center offsets in cm from EKF origin in NE frame, radius is in meters
 bool AC_PolyFence_loader::get_exclusion_circle(uint8_t index, Vector2f &center_pos_cm, float &radius) const
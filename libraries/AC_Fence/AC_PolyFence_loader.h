@@ -59,6 +59,9 @@ public:
     /// points are offsets in cm from EKF origin in NE frame
     Vector2f* get_exclusion_polygon(uint16_t index, uint16_t &num_points) const;
 
+    /// returns spatial index of the exclusion polygon's edges, nullptr if index is out of range
+    const Polygon_index *get_exclusion_polygon_index(uint16_t index) const;
+
     /// return system time of last update to the exclusion polygon points
     uint32_t get_exclusion_polygon_update_ms() const {
         return _load_time_ms;
@@ -76,6 +79,9 @@ public:
     /// points are offsets in cm from EKF origin in NE frame
     Vector2f* get_inclusion_polygon(uint16_t index, uint16_t &num_points) const;
 
+    /// returns spatial index of the inclusion polygon's edges, nullptr if index is out of range
+    const Polygon_index *get_inclusion_polygon_index(uint16_t index) const;
+
     /// return system time of last update to the inclusion polygon points
     uint32_t get_inclusion_polygon_update_ms() const {
         return _load_time_ms;
@@ -252,6 +258,7 @@ private:
     public:
         Vector2f *points; // pointer into the _loaded_offsets_from_origin array
         uint8_t count; // count of points in the boundary
+        Polygon_index index; // edges bucketed for containment checks
     };
     InclusionBoundary *_loaded_inclusion_boundary;
     uint8_t _num_loaded_inclusion_boundaries;
@@ -260,6 +267,7 @@ private:
     public:
         Vector2f *points; // pointer into the _loaded_offsets_from_origin array
         uint8_t count; // count of points in the boundary
+        Polygon_index index; // edges bucketed for containment checks
     };
     ExclusionBoundary *_loaded_exclusion_boundary;
     uint8_t _num_loaded_exclusion_boundaries;
@@ -300,14 +308,14 @@ private:
     // offset-from-origin and deposits the result into pos_cm.
     // read_offset is increased by the storage space used by the
     // latitude/longitude
-    bool read_scaled_latlon_from_storage(const Location &origin,
+    bool read_scaled_latlon_from_storage(const LocationFrame &origin,
                                          uint16_t &read_offset,
                                          Vector2f &pos_cm) WARN_IF_UNUSED;
     // read_polygon_from_storage - reads vertex_count
     // latitude/longitude points from offset in permanent storage,
     // transforms them into an offset-from-origin and deposits the
     // results into next_storage_point.
-    bool read_polygon_from_storage(const Location &origin,
+    bool read_polygon_from_storage(const LocationFrame &origin,
                                    uint16_t &read_offset,
                                    const uint8_t vertex_count,
                                    Vector2f *&next_storage_point) WARN_IF_UNUSED;
@@ -81,6 +81,9 @@ AC_PID::AC_PID(float initial_p, float initial_i, float initial_d, float initial_
     // reset input filter to first value received
     _flags._reset_filter = true;
 
+    // force the filter alphas to be calculated on the first update
+    _filt_alpha.dt = -1.0f;
+
     memset(&_pid_info, 0, sizeof(_pid_info));
 }
 
@@ -120,6 +123,8 @@ float AC_PID::update_all(float target, float measurement, bool limit)
         return 0.0f;
     }
 
+    update_filt_alphas();
+
     // reset input filter to value received
     if (_flags._reset_filter) {
         _flags._reset_filter = false;
@@ -128,13 +133,13 @@ float AC_PID::update_all(float target, float measurement, bool limit)
         _derivative = 0.0f;
     } else {
         float error_last = _error;
-        _target += get_filt_T_alpha() * (target - _target);
-        _error += get_filt_E_alpha() * ((_target - measurement) - _error);
+        _target += _filt_alpha.T * (target - _target);
+        _error += _filt_alpha.E * ((_target - measurement) - _error);
 
         // calculate and filter derivative
         if (_dt > 0.0f) {
             float derivative = (_error - error_last) / _dt;
-            _derivative += get_filt_D_alpha() * (derivative - _derivative);
+            _derivative += _filt_alpha.D * (derivative - _derivative);
         }
     }
 
@@ -168,6 +173,8 @@ float AC_PID::update_error(float error, bool limit)
 
     _target = 0.0f;
 
+    update_filt_alphas();
+
     // reset input filter to value received
     if (_flags._reset_filter) {
         _flags._reset_filter = false;
@@ -175,12 +182,12 @@ float AC_PID::update_error(float error, bool limit)
         _derivative = 0.0f;
     } else {
         float error_last = _error;
-        _error += get_filt_E_alpha() * (error - _error);
+        _error += _filt_alpha.E * (error - _error);
 
         // calculate and filter derivative
         if (_dt > 0.0f) {
             float derivative = (_error - error_last) / _dt;
-            _derivative += get_filt_D_alpha() * (derivative - _derivative);
+            _derivative += _filt_alpha.D * (derivative - _derivative);
         }
     }
 
@@ -336,6 +343,29 @@ float AC_PID::get_filt_alpha(float filt_hz) const
     return _dt / (_dt + rc);
 }
 
+/*
+  the alphas only change with dt and the filter parameters, so they are
+  only recalculated when one of those changes rather than on every
+  update. The parameters may be set from outside the class, so they are
+  compared here rather than in the setters
+ */
+void AC_PID::update_filt_alphas()
+{
+    if (is_equal(_dt, _filt_alpha.dt) &&
+        is_equal(_filt_T_hz.get(), _filt_alpha.T_hz) &&
+        is_equal(_filt_E_hz.get(), _filt_alpha.E_hz) &&
+        is_equal(_filt_D_hz.get(), _filt_alpha.D_hz)) {
+        return;
+    }
+    _filt_alpha.dt = _dt;
+    _filt_alpha.T_hz = _filt_T_hz;
+    _filt_alpha.E_hz = _filt_E_hz;
+    _filt_alpha.D_hz = _filt_D_hz;
+    _filt_alpha.T = get_filt_T_alpha();
+    _filt_alpha.E = get_filt_E_alpha();
+    _filt_alpha.D = get_filt_D_alpha();
+}
+
 void AC_PID::set_integrator(float target, float measurement, float i)
 {
     set_integrator(target - measurement, i);
@@ -24,6 +24,7 @@ public:
 
     // set_dt - set time step in seconds
     void set_dt(float dt);
+    float get_dt() const { return _dt; }
 
     //  update_all - set target and measured inputs to PID controller and calculate outputs
     //  target and error are filtered
@@ -114,6 +115,9 @@ public:
 
 protected:
 
+    // recalculate the filter alphas if dt or a filter frequency has changed
+    void update_filt_alphas();
+
     // parameters
     AP_Float _kp;
     AP_Float _ki;
@@ -138,5 +142,16 @@ protected:
     uint16_t _reset_counter;  // loop counter for reset decay
     uint64_t _reset_last_update; //time in microseconds of last update to reset_I
 
+    // filter alphas, and the dt and filter frequencies they are for
+    struct {
+        float dt;
+        float T_hz;
+        float E_hz;
+        float D_hz;
+        float T;
+        float E;
+        float D;
+    } _filt_alpha;
+
     AP_Logger::PID_Info _pid_info;
 };
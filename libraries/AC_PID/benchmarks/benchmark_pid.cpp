@@ -0,0 +1,41 @@
+#include <AP_gbenchmark.h>
+
+#include <AC_PID/AC_PID.h>
+
+/*
+  a rate PID as the multicopter roll rate controller sets it up, run at
+  400Hz
+ */
+static AC_PID pid(0.135f, 0.135f, 0.0036f, 0.0f, 0.5f, 20.0f, 0.0f, 20.0f, 0.0025f);
+
+static void BM_PIDUpdateAll(benchmark::State& state)
+{
+    float measurement = 0.0f;
+    while (state.KeepRunning()) {
+        float out = pid.update_all(1.0f, measurement, false);
+        gbenchmark_escape(&out);
+        measurement += 0.001f;
+    }
+}
+
+/*
+  dt changing on every update, as it does with a rate loop driven by
+  the gyro, so the filter alphas are recalculated each time
+ */
+static void BM_PIDUpdateAllChangingDt(benchmark::State& state)
+{
+    float measurement = 0.0f;
+    uint32_t n = 0;
+    while (state.KeepRunning()) {
+        pid.set_dt((n++ & 1) ? 0.0025f : 0.0026f);
+        float out = pid.update_all(1.0f, measurement, false);
+        gbenchmark_escape(&out);
+        measurement += 0.001f;
+    }
+    pid.set_dt(0.0025f);
+}
+
+BENCHMARK(BM_PIDUpdateAll);
+BENCHMARK(BM_PIDUpdateAllChangingDt);
+
+BENCHMARK_MAIN()
@@ -745,6 +745,7 @@ bool AC_WPNav::set_spline_origin_and_destination(const Vector3f& origin, const V
         // update spline calculator
         update_spline_solution(origin, destination, _spline_origin_vel, _spline_destination_vel);
     }
+    _spline_distance = spline_distance_at_time(_spline_time);
 
     // store origin and destination locations
     _origin = origin;
@@ -819,7 +820,59 @@ void AC_WPNav::update_spline_solution(const Vector3f& origin, const Vector3f& de
     _hermite_spline_solution[1] = origin_vel;
     _hermite_spline_solution[2] = -origin*3.0f -origin_vel*2.0f + dest*3.0f - dest_vel;
     _hermite_spline_solution[3] = origin*2.0f + origin_vel -dest*2.0f + dest_vel;
- }
+
+    // tabulate the distance along the spline, integrating the speed
+    // over each piece with Simpson's rule, so the target can be moved
+    // along it by distance
+    const float piece_time = 1.0f / WPNAV_SPLINE_ARC_SEGMENTS;
+    float speed_start = spline_speed(0.0f);
+    _spline_arc_length[0] = 0.0f;
+    for (uint8_t i = 1; i <= WPNAV_SPLINE_ARC_SEGMENTS; i++) {
+        const float speed_mid = spline_speed((i - 0.5f) * piece_time);
+        const float speed_end = spline_speed(i * piece_time);
+        _spline_arc_length[i] = _spline_arc_length[i-1] + (speed_start + 4.0f * speed_mid + speed_end) * piece_time / 6.0f;
+        speed_start = speed_end;
+    }
+}
+
+/// spline_speed - rate of change of distance along the spline with spline time
+float AC_WPNav::spline_speed(float spline_time) const
+{
+    const Vector3f velocity = _hermite_spline_solution[1] + \
+                              _hermite_spline_solution[2] * 2.0f * spline_time + \
+                              _hermite_spline_solution[3] * 3.0f * spline_time * spline_time;
+    return velocity.length();
+}
+
+/// spline_time_at_distance - spline time at a distance in cm along the spline segment
+///     interpolates the arc length table, and extrapolates from its last piece past the destination
+float AC_WPNav::spline_time_at_distance(float distance) const
+{
+    if (distance <= 0.0f) {
+        return 0.0f;
+    }
+    // find the piece of the table the distance falls in
+    uint8_t i = 0;
+    while (i < WPNAV_SPLINE_ARC_SEGMENTS-1 && distance >= _spline_arc_length[i+1]) {
+        i++;
+    }
+    const float piece_length = _spline_arc_length[i+1] - _spline_arc_length[i];
+    if (!is_positive(piece_length)) {
+        return (float)(i+1) / WPNAV_SPLINE_ARC_SEGMENTS;
+    }
+    return (i + (distance - _spline_arc_length[i]) / piece_length) / WPNAV_SPLINE_ARC_SEGMENTS;
+}
+
+/// spline_distance_at_time - distance in cm along the spline segment at a spline time
+float AC_WPNav::spline_distance_at_time(float spline_time) const
+{
+    if (spline_time <= 0.0f) {
+        return 0.0f;
+    }
+    const float piece = spline_time * WPNAV_SPLINE_ARC_SEGMENTS;
+    const uint8_t i = MIN((uint8_t)piece, WPNAV_SPLINE_ARC_SEGMENTS-1);
+    return _spline_arc_length[i] + (piece - i) * (_spline_arc_length[i+1] - _spline_arc_length[i]);
+}
 
 /// advance_spline_target_along_track - move target location along track from origin to destination
 bool AC_WPNav::advance_spline_target_along_track(float dt)
@@ -876,7 +929,7 @@ bool AC_WPNav::advance_spline_target_along_track(float dt)
         }
 
         // update velocity
-        float spline_dist_to_wp = (_destination - target_pos).length();
+        float spline_dist_to_wp = MAX(_spline_arc_length[WPNAV_SPLINE_ARC_SEGMENTS] - _spline_distance, 0.0f);
         float vel_limit = _pos_control.get_max_speed_xy();
         if (!is_zero(dt)) {
             vel_limit = MIN(vel_limit, track_leash_slack/dt);
@@ -893,9 +946,6 @@ bool AC_WPNav::advance_spline_target_along_track(float dt)
         // constrain target velocity
         _spline_vel_scaler = constrain_float(_spline_vel_scaler, 0.0f, vel_limit);
 
-        // scale the spline_time by the velocity we've calculated vs the velocity that came out of the spline calculator
-        _spline_time_scale = _spline_vel_scaler / target_vel_length;
-
         // update target position
         target_pos.z += terr_offset;
         _pos_control.set_pos_target(target_pos);
@@ -917,8 +967,9 @@ bool AC_WPNav::advance_spline_target_along_track(float dt)
             }
         }
 
-        // advance spline time to next step
-        _spline_time += _spline_time_scale*dt;
+        // advance the target along the spline by distance, and look up the spline time for it
+        _spline_distance += _spline_vel_scaler*dt;
+        _spline_time = spline_time_at_distance(_spline_distance);
 
         // we will reach the next waypoint in the next step so set reached_destination flag
         // To-Do: is this one step too early?
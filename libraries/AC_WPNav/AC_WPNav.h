@@ -34,6 +34,8 @@
 
 #define WPNAV_RANGEFINDER_FILT_Z         0.25f      // range finder distance filtered at 0.25hz
 
+#define WPNAV_SPLINE_ARC_SEGMENTS           16      // number of pieces of a spline segment in its arc length table
+
 class AC_WPNav
 {
 public:
@@ -264,6 +266,15 @@ protected:
     /// 	relies on update_spline_solution being called since the previous
     void calc_spline_pos_vel(float spline_time, Vector3f& position, Vector3f& velocity);
 
+    /// spline_speed - rate of change of distance along the spline with spline time
+    float spline_speed(float spline_time) const;
+
+    /// spline_time_at_distance - spline time at a distance in cm along the spline segment, from the arc length table
+    float spline_time_at_distance(float distance) const;
+
+    /// spline_distance_at_time - distance in cm along the spline segment at a spline time, from the arc length table
+    float spline_distance_at_time(float spline_time) const;
+
     // get terrain's altitude (in cm above the ekf origin) at the current position (+ve means terrain below vehicle is above ekf origin's altitude)
     bool get_terrain_offset(float& offset_cm);
 
@@ -307,7 +318,8 @@ protected:
 
     // spline variables
     float       _spline_time;           // current spline time between origin and destination
-    float       _spline_time_scale;     // current spline time between origin and destination
+    float       _spline_distance;       // current distance in cm along the spline from origin to destination
+    float       _spline_arc_length[WPNAV_SPLINE_ARC_SEGMENTS+1]; // distance in cm along the spline at evenly spaced spline times, calculated when the segment is set up
     Vector3f    _spline_origin_vel;     // the target velocity vector at the origin of the spline segment
     Vector3f    _spline_destination_vel;// the target velocity vector at the destination point of the spline segment
     Vector3f    _hermite_spline_solution[4]; // array describing spline path between origin and destination
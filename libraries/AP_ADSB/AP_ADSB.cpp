@@ -186,12 +186,15 @@ void AP_ADSB::init(void)
         in_state.list_size = in_state.list_size_param;
         in_state.vehicle_list = new adsb_vehicle_t[in_state.list_size];
 
-        if (in_state.vehicle_list == nullptr) {
+        if (in_state.vehicle_list == nullptr || !in_state.vehicle_index.init(in_state.list_size)) {
             // dynamic RAM allocation of _vehicle_list[] failed, disable gracefully
             hal.console->printf("Unable to initialize ADS-B vehicle list\n");
+            delete [] in_state.vehicle_list;
+            in_state.vehicle_list = nullptr;
             _enabled.set_and_notify(0);
         }
     }
+    in_state.vehicle_index.clear();
 
     furthest_vehicle_distance = 0;
     furthest_vehicle_index = 0;
@@ -210,6 +213,7 @@ void AP_ADSB::deinit(void)
         delete [] in_state.vehicle_list;
         in_state.vehicle_list = nullptr;
     }
+    in_state.vehicle_index.deinit();
 }
 
 bool AP_ADSB::is_valid_callsign(uint16_t octal)
@@ -385,8 +389,10 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
         furthest_vehicle_distance = 0;
         furthest_vehicle_index = 0;
     }
+    in_state.vehicle_index.remove(in_state.vehicle_list[index].info.ICAO_address);
     if (index != (in_state.vehicle_count-1)) {
         in_state.vehicle_list[index] = in_state.vehicle_list[in_state.vehicle_count-1];
+        in_state.vehicle_index.set(in_state.vehicle_list[index].info.ICAO_address, index);
     }
     // TODO: is memset needed? When we decrement the index we essentially forget about it
     memset(&in_state.vehicle_list[in_state.vehicle_count-1], 0, sizeof(adsb_vehicle_t));
@@ -400,13 +406,7 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
  */
 bool AP_ADSB::find_index(const adsb_vehicle_t &vehicle, uint16_t *index) const
 {
-    for (uint16_t i = 0; i < in_state.vehicle_count; i++) {
-        if (in_state.vehicle_list[i].info.ICAO_address == vehicle.info.ICAO_address) {
-            *index = i;
-            return true;
-        }
-    }
-    return false;
+    return in_state.vehicle_index.find(vehicle.info.ICAO_address, *index);
 }
 
 /*
@@ -517,7 +517,13 @@ void AP_ADSB::set_vehicle(const uint16_t index, const adsb_vehicle_t &vehicle)
         // out of range
         return;
     }
+    // keep the index in step when a vehicle in the list is replaced by another
+    if (index < in_state.vehicle_count &&
+        in_state.vehicle_list[index].info.ICAO_address != vehicle.info.ICAO_address) {
+        in_state.vehicle_index.remove(in_state.vehicle_list[index].info.ICAO_address);
+    }
     in_state.vehicle_list[index] = vehicle;
+    in_state.vehicle_index.set(vehicle.info.ICAO_address, index);
 
     write_log(vehicle);
 }
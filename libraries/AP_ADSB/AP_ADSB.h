@@ -26,6 +26,7 @@
 #include <AP_Param/AP_Param.h>
 #include <AP_Common/Location.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
+#include "AP_ADSB_Index.h"
 
 class AP_ADSB {
 public:
@@ -106,7 +107,7 @@ private:
     // compares current vector against vehicle_list to detect threats
     void determine_furthest_aircraft(void);
 
-    // return index of given vehicle if ICAO_ADDRESS matches. return -1 if no match
+    // return index of given vehicle if ICAO_ADDRESS matches. return false if no match
     bool find_index(const adsb_vehicle_t &vehicle, uint16_t *index) const;
 
     // remove a vehicle from the list
@@ -148,6 +149,7 @@ private:
         uint16_t    list_size = 1; // start with tiny list, then change to param-defined size. This ensures it doesn't fail on start
         adsb_vehicle_t *vehicle_list = nullptr;
         uint16_t    vehicle_count;
+        AP_ADSB_Index<uint32_t> vehicle_index;  // position in vehicle_list by ICAO address
         AP_Int32    list_radius;
         AP_Int16    list_altitude;
 
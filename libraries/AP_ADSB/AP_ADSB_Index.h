@@ -0,0 +1,139 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  hash index from the id of a vehicle or obstacle to its position in a
+  list, so it can be found without searching the whole list. Uses
+  linear probing in a table of at least twice the size of the list
+ */
+
+#include <stdint.h>
+
+template <typename K>
+class AP_ADSB_Index {
+public:
+    ~AP_ADSB_Index() {
+        delete[] _slots;
+    }
+
+    // allocate the table for a list of list_size entries.  returns false on failure
+    bool init(uint16_t list_size) {
+        delete[] _slots;
+        _slots = nullptr;
+        uint32_t size = 4;
+        while (size < 2U * list_size) {
+            size <<= 1;
+        }
+        _slots = new Slot[size];
+        if (_slots == nullptr) {
+            return false;
+        }
+        _mask = size - 1;
+        clear();
+        return true;
+    }
+
+    // free the table
+    void deinit() {
+        delete[] _slots;
+        _slots = nullptr;
+    }
+
+    // remove all entries
+    void clear() {
+        if (_slots == nullptr) {
+            return;
+        }
+        for (uint32_t i = 0; i <= _mask; i++) {
+            _slots[i].index = EMPTY;
+        }
+    }
+
+    // find the position in the list of key
+    bool find(const K key, uint16_t &index) const {
+        if (_slots == nullptr) {
+            return false;
+        }
+        for (uint32_t i = hash(key); _slots[i].index != EMPTY; i = (i + 1) & _mask) {
+            if (_slots[i].key == key) {
+                index = _slots[i].index;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // set the position in the list of key, adding it if it is not already present
+    void set(const K key, uint16_t index) {
+        if (_slots == nullptr) {
+            return;
+        }
+        uint32_t i = hash(key);
+        while (_slots[i].index != EMPTY && _slots[i].key != key) {
+            i = (i + 1) & _mask;
+        }
+        _slots[i].key = key;
+        _slots[i].index = index;
+    }
+
+    // remove key
+    void remove(const K key) {
+        if (_slots == nullptr) {
+            return;
+        }
+        uint32_t i = hash(key);
+        while (_slots[i].index != EMPTY && _slots[i].key != key) {
+            i = (i + 1) & _mask;
+        }
+        if (_slots[i].index == EMPTY) {
+            return;
+        }
+        // shift back the entries after the removed one which would
+        // otherwise no longer be found from their hash
+        uint32_t j = i;
+        while (true) {
+            j = (j + 1) & _mask;
+            if (_slots[j].index == EMPTY) {
+                break;
+            }
+            const uint32_t home = hash(_slots[j].key);
+            // move the entry at j to i unless its home lies cyclically in (i, j]
+            const bool stays = (i <= j) ? ((i < home) && (home <= j)) : ((i < home) || (home <= j));
+            if (!stays) {
+                _slots[i] = _slots[j];
+                i = j;
+            }
+        }
+        _slots[i].index = EMPTY;
+    }
+
+private:
+    static const uint16_t EMPTY = UINT16_MAX;
+
+    struct Slot {
+        K key;
+        uint16_t index;
+    };
+
+    uint32_t hash(const K key) const {
+        // fibonacci hashing of the key, folded to 32 bits
+        const uint64_t h = uint64_t(key) * 0x9E3779B97F4A7C15ULL;
+        return uint32_t(h >> 32) & _mask;
+    }
+
+    Slot *_slots = nullptr;
+    uint32_t _mask;
+};
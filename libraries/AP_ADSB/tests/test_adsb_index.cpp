@@ -0,0 +1,78 @@
+#include <AP_gtest.h>
+
+#include <AP_ADSB/AP_ADSB_Index.h>
+#include <AP_HAL/AP_HAL.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+TEST(ADSBIndex, AddFindRemove)
+{
+    AP_ADSB_Index<uint32_t> index;
+    EXPECT_TRUE(index.init(10));
+
+    for (uint16_t i = 0; i < 10; i++) {
+        index.set(0xABC000 + i * 7, i);
+    }
+    for (uint16_t i = 0; i < 10; i++) {
+        uint16_t found = 0;
+        EXPECT_TRUE(index.find(0xABC000 + i * 7, found));
+        EXPECT_EQ(i, found);
+    }
+
+    // removing entries leaves the others findable
+    for (uint16_t i = 0; i < 10; i += 2) {
+        index.remove(0xABC000 + i * 7);
+    }
+    for (uint16_t i = 0; i < 10; i++) {
+        uint16_t found = 0;
+        EXPECT_EQ(i % 2 == 1, index.find(0xABC000 + i * 7, found));
+    }
+
+    // moving an entry updates its position
+    index.set(0xABC000 + 7, 3);
+    uint16_t found = 0;
+    EXPECT_TRUE(index.find(0xABC000 + 7, found));
+    EXPECT_EQ(3, found);
+
+    index.clear();
+    EXPECT_FALSE(index.find(0xABC000 + 7, found));
+}
+
+TEST(ADSBIndex, Churn)
+{
+    // keys which collide in a small table are still found after many adds and removes
+    const uint16_t list_size = 100;
+    AP_ADSB_Index<uint64_t> index;
+    EXPECT_TRUE(index.init(list_size));
+
+    uint64_t keys[list_size] {};
+    bool present[list_size] {};
+    uint32_t seed = 1;
+    for (uint32_t n = 0; n < 20000; n++) {
+        seed = seed * 1103515245 + 12345;
+        const uint16_t slot = (seed >> 16) % list_size;
+        if (present[slot]) {
+            index.remove(keys[slot]);
+            present[slot] = false;
+        } else {
+            keys[slot] = (uint64_t(seed & 1) << 32) | (seed >> 8);
+            bool duplicate = false;
+            for (uint16_t i = 0; i < list_size; i++) {
+                duplicate |= present[i] && keys[i] == keys[slot];
+            }
+            if (!duplicate) {
+                index.set(keys[slot], slot);
+                present[slot] = true;
+            }
+        }
+        for (uint16_t i = 0; i < list_size; i++) {
+            if (present[i]) {
+                uint16_t found = 0;
+                ASSERT_TRUE(index.find(keys[i], found));
+                ASSERT_EQ(i, found);
+            }
+        }
+    }
+}
+
+AP_GTEST_MAIN()
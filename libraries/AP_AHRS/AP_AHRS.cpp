@@ -159,6 +159,16 @@ const AP_Param::GroupInfo AP_AHRS::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("CUSTOM_YAW", 17, AP_AHRS, _custom_yaw, 0),
 
+#if AP_AHRS_NAVEKF_AVAILABLE
+    // @Param: DCM_RATE
+    // @DisplayName: DCM rate while the EKF is in use
+    // @Description: While an EKF is healthy and in use DCM is only a fallback, so it can be run at a reduced rate to save CPU. This is the lowest rate DCM will then run at, the IMU data in between is accumulated. DCM returns to the full loop rate as soon as the EKF is not in use. A value of zero always runs DCM at the full loop rate.
+    // @Units: Hz
+    // @Range: 0 400
+    // @User: Advanced
+    AP_GROUPINFO("DCM_RATE", 18, AP_AHRS, _dcm_rate, 50),
+#endif
+
     AP_GROUPEND
 };
 
@@ -167,6 +177,8 @@ void AP_AHRS::init()
 {
     update_orientation();
 
+    AP_HAL::SemaphoreStats::set_name(_rsem, "AHRS");
+
 #if !HAL_MINIMIZE_FEATURES && AP_AHRS_NAVEKF_AVAILABLE
     _nmea_out = AP_NMEA_Output::probe();
 #endif
@@ -518,6 +530,125 @@ void AP_AHRS::update_nmea_out()
 #endif
 }
 
+/*
+  fill in and publish a new snapshot. This is only called from the
+  thread running the AHRS update
+ */
+void AP_AHRS::publish_snapshot(uint8_t ekf_type)
+{
+    const uint32_t count = _snapshot_count.load(std::memory_order_relaxed) + 1;
+    Snapshot &snap = _snapshot[count & 1];
+
+    // this buffer was last published two updates ago. Make sure a
+    // reader that sees any of the writes below also sees that the
+    // previous snapshot was published, so it knows to retry
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    snap.time_us = AP_HAL::micros();
+    snap.ekf_type = ekf_type;
+    get_quat_body_to_ned(snap.quat);
+    snap.roll = roll;
+    snap.pitch = pitch;
+    snap.yaw = yaw;
+    snap.gyro = get_gyro();
+    snap.accel_ef = get_accel_ef_blended();
+    snap.flags.healthy = healthy();
+    snap.flags.velocity_valid = get_velocity_NED(snap.velocity_NED);
+    snap.flags.position_valid = get_relative_position_NED_home(snap.position_NED_home);
+    snap.flags.location_valid = get_position(snap.location);
+    snap.flags.home_is_set = _home_is_set;
+    snap.home = _home;
+
+    _snapshot_count.store(count, std::memory_order_release);
+
+    if (_history != nullptr) {
+        StateSample &sample = _history[_history_next];
+        sample.time_us = AP::ins().get_last_update_usec();
+        sample.lat = snap.location.lat;
+        sample.lng = snap.location.lng;
+        sample.alt_cm = snap.location.alt;
+        sample.velocity_NED = snap.velocity_NED;
+        sample.roll = snap.roll;
+        sample.pitch = snap.pitch;
+        sample.yaw = snap.yaw;
+        sample.location_valid = snap.flags.location_valid;
+        _history_next = (_history_next + 1) % AHRS_HISTORY_LEN;
+        _history_count = MIN(_history_count + 1, AHRS_HISTORY_LEN);
+    }
+}
+
+/*
+  start keeping a history of states
+ */
+bool AP_AHRS::enable_history(void)
+{
+    if (_history == nullptr) {
+        _history = new StateSample[AHRS_HISTORY_LEN];
+    }
+    return _history != nullptr;
+}
+
+/*
+  find the state at time_us, interpolating between the two states
+  either side of it
+ */
+bool AP_AHRS::get_state_at(uint32_t time_us, StateSample &sample) const
+{
+    if (_history == nullptr) {
+        return false;
+    }
+    // search back from the newest sample for the first one at or
+    // before time_us
+    for (uint8_t i=0; i+1<_history_count; i++) {
+        const uint8_t idx_after = (_history_next + AHRS_HISTORY_LEN - 1 - i) % AHRS_HISTORY_LEN;
+        const uint8_t idx_before = (idx_after + AHRS_HISTORY_LEN - 1) % AHRS_HISTORY_LEN;
+        const StateSample &after = _history[idx_after];
+        const StateSample &before = _history[idx_before];
+        if (int32_t(time_us - before.time_us) < 0) {
+            continue;
+        }
+        if (int32_t(after.time_us - time_us) < 0 || after.time_us == before.time_us) {
+            // time_us is newer than the newest sample
+            return false;
+        }
+        const float f = float(time_us - before.time_us) / float(after.time_us - before.time_us);
+        sample.time_us = time_us;
+        sample.lat = before.lat + int32_t((after.lat - before.lat) * f);
+        sample.lng = before.lng + int32_t((after.lng - before.lng) * f);
+        sample.alt_cm = before.alt_cm + int32_t((after.alt_cm - before.alt_cm) * f);
+        sample.velocity_NED = before.velocity_NED + (after.velocity_NED - before.velocity_NED) * f;
+        sample.roll = wrap_PI(before.roll + wrap_PI(after.roll - before.roll) * f);
+        sample.pitch = before.pitch + (after.pitch - before.pitch) * f;
+        sample.yaw = wrap_PI(before.yaw + wrap_PI(after.yaw - before.yaw) * f);
+        sample.location_valid = before.location_valid && after.location_valid;
+        return true;
+    }
+    return false;
+}
+
+/*
+  copy the latest snapshot. This is lock free and may be called from
+  any thread
+ */
+bool AP_AHRS::get_snapshot(Snapshot &snap) const
+{
+    // if a new snapshot is published while we copy then the buffer we
+    // are reading from may have been overwritten, so try again. As
+    // publishing only happens at the AHRS loop rate this is rare
+    for (uint8_t tries=0; tries<4; tries++) {
+        const uint32_t count = _snapshot_count.load(std::memory_order_acquire);
+        if (count == 0) {
+            return false;
+        }
+        snap = _snapshot[count & 1];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_snapshot_count.load(std::memory_order_relaxed) == count) {
+            return true;
+        }
+    }
+    return false;
+}
+
 // singleton instance
 AP_AHRS *AP_AHRS::_singleton;
 
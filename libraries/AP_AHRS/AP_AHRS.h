@@ -28,6 +28,7 @@
 #include <AP_InertialSensor/AP_InertialSensor.h>
 #include <AP_Param/AP_Param.h>
 #include <AP_Common/Location.h>
+#include <atomic>
 
 class AP_NMEA_Output;
 class OpticalFlow;
@@ -45,6 +46,9 @@ enum AHRS_VehicleClass : uint8_t {
 
 
 // forward declare view class
+// number of states kept by enable_history(). Enough for 80ms at 400Hz
+#define AHRS_HISTORY_LEN 32
+
 class AP_AHRS_View;
 
 class AP_AHRS
@@ -587,9 +591,73 @@ public:
         return _rsem;
     }
 
+    /*
+      state published once at the end of each AHRS update. Consumers
+      can take a copy with get_snapshot() from any thread without
+      taking the AHRS semaphore, and see all fields from the same
+      update
+     */
+    struct Snapshot {
+        uint32_t time_us;           // time of the update that published this
+        uint8_t ekf_type;           // active EKF type (0 for DCM)
+        Quaternion quat;            // body to NED attitude
+        float roll, pitch, yaw;     // attitude in radians
+        Vector3f gyro;              // drift corrected gyro in rad/s
+        Vector3f accel_ef;          // earth frame acceleration in m/s/s
+        Vector3f velocity_NED;      // velocity in m/s
+        Vector3f position_NED_home; // position relative to home in m
+        Location location;          // current position
+        Location home;              // home position
+        struct {
+            bool healthy           : 1;
+            bool velocity_valid    : 1;
+            bool position_valid    : 1; // position_NED_home is valid
+            bool location_valid    : 1;
+            bool home_is_set       : 1;
+        } flags;
+    };
+
+    // copy the most recently published snapshot, returning false if
+    // none has been published yet
+    bool get_snapshot(Snapshot &snap) const WARN_IF_UNUSED;
+
+    // number of snapshots published so far, so consumers can tell if
+    // there is new data
+    uint32_t get_snapshot_count(void) const {
+        return _snapshot_count.load(std::memory_order_acquire);
+    }
+
+    /*
+      state at an IMU sample time, kept in a short history so that the
+      state at the time of an event, such as a camera capture, can be
+      found after the event
+     */
+    struct StateSample {
+        uint32_t time_us;           // time of the IMU sample the state was calculated from
+        int32_t lat, lng;           // position in 1e-7 degrees
+        int32_t alt_cm;             // altitude above mean sea level
+        Vector3f velocity_NED;      // velocity in m/s
+        float roll, pitch, yaw;     // attitude in radians
+        bool location_valid;
+    };
+
+    // start keeping a history of the last AHRS_HISTORY_LEN states.
+    // returns false if there is not enough memory
+    bool enable_history(void);
+
+    // state at time_us, interpolated between the states published
+    // before and after it. Returns false if time_us is not covered by
+    // the history. Must be called from the thread running the AHRS
+    // update
+    bool get_state_at(uint32_t time_us, StateSample &sample) const WARN_IF_UNUSED;
+
 protected:
     void update_nmea_out();
 
+    // fill and publish a new snapshot, called by the AHRS backend at
+    // the end of update()
+    void publish_snapshot(uint8_t ekf_type);
+
     // multi-thread access support
     HAL_Semaphore_Recursive _rsem;
 
@@ -608,6 +676,7 @@ protected:
     AP_Int8 _gps_minsats;
     AP_Int8 _gps_delay;
     AP_Int8 _ekf_type;
+    AP_Int16 _dcm_rate;
     AP_Float _custom_roll;
     AP_Float _custom_pitch;
     AP_Float _custom_yaw;
@@ -695,6 +764,17 @@ private:
     static AP_AHRS *_singleton;
 
     AP_NMEA_Output* _nmea_out;
+
+    // double buffered snapshot. Snapshot n is written to
+    // _snapshot[n&1], so the last published snapshot is never
+    // overwritten until the next one has been published
+    Snapshot _snapshot[2];
+    std::atomic<uint32_t> _snapshot_count{0};
+
+    // history of states, allocated by enable_history()
+    StateSample *_history = nullptr;
+    uint8_t _history_next;
+    uint8_t _history_count;
 };
 
 #include "AP_AHRS_DCM.h"
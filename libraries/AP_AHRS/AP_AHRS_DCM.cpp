@@ -93,9 +93,23 @@ AP_AHRS_DCM::update(bool skip_ins_update)
     if (delta_t > 0.2f) {
         memset((void *)&_ra_sum[0], 0, sizeof(_ra_sum));
         _ra_deltat = 0;
+        memset((void *)&_imu_accum, 0, sizeof(_imu_accum));
         return;
     }
 
+    accumulate_imu(delta_t);
+
+    // while an EKF is in use DCM is only a fallback, so only update
+    // it at _dcm_rate. As the IMU data is accumulated nothing is lost
+    // when it goes back to the full rate
+    if (_reduced_rate && _dcm_rate > 0) {
+        const uint16_t divider = constrain_int16(_ins.get_sample_rate() / _dcm_rate, 1, 8);
+        if (_imu_accum.count < divider) {
+            return;
+        }
+    }
+    delta_t = _imu_accum.dt;
+
     // Integrate the DCM matrix using gyro inputs
     matrix_update(delta_t);
 
@@ -118,29 +132,17 @@ AP_AHRS_DCM::update(bool skip_ins_update)
     update_AOA_SSA();
 
     backup_attitude();
+
+    memset((void *)&_imu_accum, 0, sizeof(_imu_accum));
 }
 
 /*
-  backup attitude to persistent_data for use in watchdog reset
+  add the IMU data from this loop to the data accumulated since the
+  last DCM update
  */
-void AP_AHRS_DCM::backup_attitude(void)
+void AP_AHRS_DCM::accumulate_imu(float delta_t)
 {
-    AP_HAL::Util::PersistentData &pd = hal.util->persistent_data;
-    pd.roll_rad = roll;
-    pd.pitch_rad = pitch;
-    pd.yaw_rad = yaw;
-}
-
-// update the DCM matrix using only the gyros
-void
-AP_AHRS_DCM::matrix_update(float _G_Dt)
-{
-    // note that we do not include the P terms in _omega. This is
-    // because the spin_rate is calculated from _omega.length(),
-    // and including the P terms would give positive feedback into
-    // the _P_gain() calculation, which can lead to a very large P
-    // value
-    _omega.zero();
+    const AP_InertialSensor &_ins = AP::ins();
 
     // average across first two healthy gyros. This reduces noise on
     // systems with more than one gyro. We don't use the 3rd gyro
@@ -148,7 +150,6 @@ AP_AHRS_DCM::matrix_update(float _G_Dt)
     // noise
     uint8_t healthy_count = 0;
     Vector3f delta_angle;
-    const AP_InertialSensor &_ins = AP::ins();
     for (uint8_t i=0; i<_ins.get_gyro_count(); i++) {
         if (_ins.use_gyro(i) && healthy_count < 2) {
             Vector3f dangle;
@@ -161,8 +162,44 @@ AP_AHRS_DCM::matrix_update(float _G_Dt)
     if (healthy_count > 1) {
         delta_angle /= healthy_count;
     }
+    _imu_accum.delta_angle += delta_angle;
+
+    for (uint8_t i=0; i<_ins.get_accel_count(); i++) {
+        Vector3f delta_velocity;
+        _ins.get_delta_velocity(i, delta_velocity);
+        _imu_accum.delta_velocity[i] += delta_velocity;
+        _imu_accum.delta_velocity_dt[i] += _ins.get_delta_velocity_dt(i);
+    }
+
+    _imu_accum.dt += delta_t;
+    _imu_accum.count++;
+}
+
+/*
+  backup attitude to persistent_data for use in watchdog reset
+ */
+void AP_AHRS_DCM::backup_attitude(void)
+{
+    AP_HAL::Util::PersistentData &pd = hal.util->persistent_data;
+    pd.roll_rad = roll;
+    pd.pitch_rad = pitch;
+    pd.yaw_rad = yaw;
+}
+
+// update the DCM matrix using only the gyros
+void
+AP_AHRS_DCM::matrix_update(float _G_Dt)
+{
+    // note that we do not include the P terms in _omega. This is
+    // because the spin_rate is calculated from _omega.length(),
+    // and including the P terms would give positive feedback into
+    // the _P_gain() calculation, which can lead to a very large P
+    // value
+    _omega.zero();
+
+    // the gyros are averaged as the data is accumulated
     if (_G_Dt > 0) {
-        _omega = delta_angle / _G_Dt;
+        _omega = _imu_accum.delta_angle / _G_Dt;
         _omega += _omega_I;
         _dcm_matrix.rotate((_omega + _omega_P + _omega_yaw_P) * _G_Dt);
     }
@@ -646,9 +683,8 @@ AP_AHRS_DCM::drift_correction(float deltat)
               accel value is sampled over the right time delta for
               each sensor, which prevents an aliasing effect
              */
-            Vector3f delta_velocity;
-            _ins.get_delta_velocity(i, delta_velocity);
-            const float delta_velocity_dt = _ins.get_delta_velocity_dt(i);
+            const Vector3f &delta_velocity = _imu_accum.delta_velocity[i];
+            const float delta_velocity_dt = _imu_accum.delta_velocity_dt[i];
             if (delta_velocity_dt > 0) {
                 _accel_ef[i] = _dcm_matrix * (delta_velocity / delta_velocity_dt);
                 // integrate the accel vector in the earth frame between GPS readings
@@ -75,6 +75,10 @@ public:
     // dead-reckoning support
     virtual bool get_position(struct Location &loc) const override;
 
+    // run at a reduced rate on accumulated IMU data, for when DCM is
+    // only a fallback to a healthy EKF
+    void set_reduced_rate(bool reduced) { _reduced_rate = reduced; }
+
     // status reporting
     float           get_error_rp() const override {
         return _error_rp;
@@ -121,6 +125,17 @@ private:
     bool            use_fast_gains(void) const;
     void            load_watchdog_home();
     void            backup_attitude(void);
+    void            accumulate_imu(float delta_t);
+
+    // IMU data accumulated since the last DCM update
+    struct {
+        Vector3f delta_angle;   // averaged over the first two healthy gyros
+        Vector3f delta_velocity[INS_MAX_INSTANCES];
+        float delta_velocity_dt[INS_MAX_INSTANCES];
+        float dt;
+        uint8_t count;
+    } _imu_accum;
+    bool _reduced_rate;
 
     // primary representation of attitude of board used for all inertial calculations
     Matrix3f _dcm_matrix;
@@ -139,6 +139,15 @@ void AP_AHRS_NavEKF::update(bool skip_ins_update)
     // update NMEA output
     update_nmea_out();
 #endif
+
+    const EKF_TYPE active = active_EKF_type();
+
+    // DCM is only a fallback while an EKF is in use. If the EKF stops
+    // being used DCM is back at the full rate on the next update
+    set_reduced_rate(active != EKF_TYPE_NONE);
+
+    // publish the new state for lock free readers
+    publish_snapshot(active);
 }
 
 void AP_AHRS_NavEKF::update_DCM(bool skip_ins_update)
@@ -23,7 +23,8 @@
 
 AP_AHRS_View::AP_AHRS_View(AP_AHRS &_ahrs, enum Rotation _rotation, float pitch_trim_deg) :
     rotation(_rotation),
-    ahrs(_ahrs)
+    ahrs(_ahrs),
+    cache_valid(false)
 {
     switch (rotation) {
     case ROTATION_NONE:
@@ -55,20 +56,57 @@ void AP_AHRS_View::set_pitch_trim(float trim_deg) {
     rot_view.from_euler(0, radians(wrap_360(y_angle + _pitch_trim_deg)), 0);
     rot_view_T = rot_view;
     rot_view_T.transpose();
+    cache_valid = false;
 };
 
 // update state
 void AP_AHRS_View::update(bool skip_ins_update)
 {
-    rot_body_to_ned = ahrs.get_rotation_body_to_ned();
-    gyro = ahrs.get_gyro();
-
-    if (!is_zero(y_angle + _pitch_trim_deg)) {
-        rot_body_to_ned = rot_body_to_ned * rot_view_T;
-        gyro = rot_view * gyro;
+    const Matrix3f &ahrs_rot = ahrs.get_rotation_body_to_ned();
+    const Vector3f &ahrs_gyro = ahrs.get_gyro();
+
+    // the view may be updated more than once per AHRS update, eg. by
+    // both the AHRS and the vehicle code. Everything below depends
+    // only on the AHRS attitude and gyro, so skip it if neither has
+    // changed
+    if (cache_valid &&
+        ahrs_gyro == last_ahrs_gyro &&
+        ahrs_rot.a == last_ahrs_rot.a &&
+        ahrs_rot.b == last_ahrs_rot.b &&
+        ahrs_rot.c == last_ahrs_rot.c) {
+        return;
+    }
+    last_ahrs_rot = ahrs_rot;
+    last_ahrs_gyro = ahrs_gyro;
+    cache_valid = true;
+
+    rot_body_to_ned = ahrs_rot;
+    gyro = ahrs_gyro;
+
+    if (is_zero(y_angle + _pitch_trim_deg)) {
+        // an unrotated view, so the AHRS has already calculated the
+        // angles and trig values from this matrix
+        roll = ahrs.roll;
+        pitch = ahrs.pitch;
+        yaw = ahrs.yaw;
+        roll_sensor = ahrs.roll_sensor;
+        pitch_sensor = ahrs.pitch_sensor;
+        yaw_sensor = ahrs.yaw_sensor;
+        trig.cos_roll = ahrs.cos_roll();
+        trig.cos_pitch = ahrs.cos_pitch();
+        trig.cos_yaw = ahrs.cos_yaw();
+        trig.sin_roll = ahrs.sin_roll();
+        trig.sin_pitch = ahrs.sin_pitch();
+        trig.sin_yaw = ahrs.sin_yaw();
+        quat_body_to_ned.from_rotation_matrix(rot_body_to_ned);
+        return;
     }
 
+    rot_body_to_ned = rot_body_to_ned * rot_view_T;
+    gyro = rot_view * gyro;
+
     rot_body_to_ned.to_euler(&roll, &pitch, &yaw);
+    quat_body_to_ned.from_rotation_matrix(rot_body_to_ned);
 
     roll_sensor  = degrees(roll) * 100;
     pitch_sensor = degrees(pitch) * 100;
@@ -42,6 +42,12 @@ public:
     // return a smoothed and corrected gyro vector using the latest ins data (which may not have been consumed by the EKF yet)
     Vector3f get_gyro_latest(void) const;
 
+    // rotate a corrected gyro sample of the underlying AHRS into this view
+    Vector3f rotate_gyro_to_view(Vector3f gyro_sample) const {
+        gyro_sample.rotate(rotation);
+        return gyro_sample;
+    }
+
     // return a DCM rotation matrix representing our current attitude in this view
     const Matrix3f &get_rotation_body_to_ned(void) const {
         return rot_body_to_ned;
@@ -49,7 +55,7 @@ public:
 
     // return a Quaternion representing our current attitude in this view
     void get_quat_body_to_ned(Quaternion &quat) const {
-        quat.from_rotation_matrix(rot_body_to_ned);
+        quat = quat_body_to_ned;
     }
 
     // apply pitch trim
@@ -188,6 +194,8 @@ private:
     // transpose of rot_view
     Matrix3f rot_view_T;
     Matrix3f rot_body_to_ned;
+    // rot_body_to_ned as a quaternion, as the controllers use it several times a loop
+    Quaternion quat_body_to_ned;
     Vector3f gyro;
 
     struct {
@@ -201,4 +209,10 @@ private:
 
     float y_angle;
     float _pitch_trim_deg;
+
+    // the AHRS attitude and gyro the view was last calculated from,
+    // so update() only recalculates when they have changed
+    Matrix3f last_ahrs_rot;
+    Vector3f last_ahrs_gyro;
+    bool cache_valid;
 };
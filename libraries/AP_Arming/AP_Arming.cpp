@@ -877,6 +877,9 @@ bool AP_Arming::arm(AP_Arming::Method method, const bool do_arming_checks)
 
     if ((!do_arming_checks && mandatory_checks(true)) || (pre_arm_checks(true) && arm_checks(method))) {
         armed = true;
+#ifdef ENABLE_SCRIPTING
+        AP_Scripting::post_event(AP_Scripting::Event::ARMING, 1);
+#endif
 
         //TODO: Log motor arming
         //Can't do this from this class until there is a unified logging library
@@ -896,6 +899,9 @@ bool AP_Arming::disarm()
         return false;
     }
     armed = false;
+#ifdef ENABLE_SCRIPTING
+    AP_Scripting::post_event(AP_Scripting::Event::ARMING, 0);
+#endif
 
 #if HAL_HAVE_SAFETY_SWITCH
     AP_BoardConfig *board_cfg = AP_BoardConfig::get_singleton();
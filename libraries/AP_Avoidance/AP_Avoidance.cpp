@@ -141,9 +141,11 @@ void AP_Avoidance::init(void)
     if (_obstacles == nullptr) {
         _obstacles = new AP_Avoidance::Obstacle[_obstacles_max];
 
-        if (_obstacles == nullptr) {
+        if (_obstacles == nullptr || !_obstacle_index.init(_obstacles_max)) {
             // dynamic RAM allocation of _obstacles[] failed, disable gracefully
             hal.console->printf("Unable to initialize Avoidance obstacle list\n");
+            delete [] _obstacles;
+            _obstacles = nullptr;
             // disable ourselves to avoid repeated allocation attempts
             _enabled.set(0);
             return;
@@ -151,6 +153,7 @@ void AP_Avoidance::init(void)
         _obstacles_allocated = _obstacles_max;
     }
     _obstacle_count = 0;
+    _obstacle_index.clear();
     _last_state_change_ms = 0;
     _threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
     _gcs_cleared_messages_first_sent = std::numeric_limits<uint32_t>::max();
@@ -168,6 +171,7 @@ void AP_Avoidance::deinit(void)
         _obstacles_allocated = 0;
         handle_recovery(AP_AVOIDANCE_RECOVERY_RTL);
     }
+    _obstacle_index.deinit();
     _obstacle_count = 0;
 }
 
@@ -196,44 +200,42 @@ void AP_Avoidance::add_obstacle(const uint32_t obstacle_timestamp_ms,
     if (! check_startup()) {
         return;
     }
-    uint32_t oldest_timestamp = std::numeric_limits<uint32_t>::max();
-    uint8_t oldest_index = 255; // avoid compiler warning with initialisation
-    int16_t index = -1;
-    uint8_t i;
-    for (i=0; i<_obstacle_count; i++) {
-        if (_obstacles[i].src_id == src_id &&
-            _obstacles[i].src == src) {
-            // pre-existing obstacle found; we will update its information
-            index = i;
-            break;
-        }
-        if (_obstacles[i].timestamp_ms < oldest_timestamp) {
-            oldest_timestamp = _obstacles[i].timestamp_ms;
-            oldest_index = i;
-        }
-    }
+    const uint64_t key = (uint64_t(src) << 32) | src_id;
+    uint16_t index = 0; // avoid compiler warning with initialisation
     WITH_SEMAPHORE(_rsem);
-    
-    if (index == -1) {
+
+    if (!_obstacle_index.find(key, index)) {
         // existing obstacle not found.  See if we can store it anyway:
-        if (i <_obstacles_allocated) {
+        if (_obstacle_count < _obstacles_allocated) {
             // have room to store more vehicles...
             index = _obstacle_count++;
-        } else if (oldest_timestamp < obstacle_timestamp_ms) {
-            // replace this very old entry with this new data
-            index = oldest_index;
         } else {
-            // no room for this (old?!) data
-            return;
+            // find the oldest entry
+            uint32_t oldest_timestamp = std::numeric_limits<uint32_t>::max();
+            for (uint8_t i=0; i<_obstacle_count; i++) {
+                if (_obstacles[i].timestamp_ms < oldest_timestamp) {
+                    oldest_timestamp = _obstacles[i].timestamp_ms;
+                    index = i;
+                }
+            }
+            if (oldest_timestamp >= obstacle_timestamp_ms) {
+                // no room for this (old?!) data
+                return;
+            }
+            // replace this very old entry with this new data
+            _obstacle_index.remove((uint64_t(_obstacles[index].src) << 32) | _obstacles[index].src_id);
         }
 
         _obstacles[index].src = src;
         _obstacles[index].src_id = src_id;
+        _obstacle_index.set(key, index);
     }
 
     _obstacles[index]._location = loc;
     _obstacles[index]._velocity = vel_ned;
     _obstacles[index].timestamp_ms = obstacle_timestamp_ms;
+    // recalculate the threat level with the new data
+    _obstacles[index].next_check_ms = AP_HAL::millis();
 }
 
 void AP_Avoidance::add_obstacle(const uint32_t obstacle_timestamp_ms,
@@ -430,6 +432,25 @@ void AP_Avoidance::handle_threat_gcs_notify(AP_Avoidance::Obstacle *threat)
 
 }
 
+// time until an obstacle with no threat could become one, assuming both
+// vehicles fly straight at each other at their current speeds plus a
+// margin.  The closest approach is projected over the time horizon plus
+// the age of the obstacle's data, which also grows as time passes, so
+// the distance is closed at up to twice the closing speed
+uint32_t AP_Avoidance::time_until_possible_threat_ms(const Location &my_loc,
+                                                     const Vector3f &my_vel,
+                                                     const AP_Avoidance::Obstacle &obstacle) const
+{
+    const float closing_speed = my_vel.length() + obstacle._velocity.length() + AP_AVOIDANCE_RECHECK_SPEED_MARGIN;
+    const float threat_distance = MAX(_warn_distance_xy, _fail_distance_xy);
+    const float horizon = MAX(_warn_time_horizon, _fail_time_horizon) + (AP_HAL::millis() - obstacle.timestamp_ms) * 0.001f;
+    const float time_to_threat = ((my_loc.get_distance(obstacle._location) - threat_distance) / closing_speed - horizon) * 0.5f;
+    if (time_to_threat <= 0) {
+        return 0;
+    }
+    return MIN(time_to_threat * 1000.0f, AP_AVOIDANCE_RECHECK_MAX_MS);
+}
+
 bool AP_Avoidance::obstacle_is_more_serious_threat(const AP_Avoidance::Obstacle &obstacle) const
 {
     if (_current_most_serious_threat == -1) {
@@ -466,28 +487,41 @@ void AP_Avoidance::check_for_threats()
         return;
     }
 
-    // we always check all obstacles to see if they are threats since it
-    // is most likely our own position and/or velocity have changed
+    // we check all obstacles to see if they are threats since it is
+    // most likely our own position and/or velocity have changed.
+    // Obstacles which cannot become a threat for a while, even flying
+    // straight at us, are only recalculated when they send new data or
+    // their time to become a possible threat is up
     // determine the current most-serious-threat
+    const uint32_t now = AP_HAL::millis();
     _current_most_serious_threat = -1;
     for (uint8_t i=0; i<_obstacle_count; i++) {
 
         AP_Avoidance::Obstacle &obstacle = _obstacles[i];
-        const uint32_t obstacle_age = AP_HAL::millis() - obstacle.timestamp_ms;
+        const uint32_t obstacle_age = now - obstacle.timestamp_ms;
         debug("i=%d src_id=%d timestamp=%u age=%d", i, obstacle.src_id, obstacle.timestamp_ms, obstacle_age);
 
-        update_threat_level(my_loc, my_vel, obstacle);
-        debug("   threat-level=%d", obstacle.threat_level);
-
         // ignore any really old data:
         if (obstacle_age > MAX_OBSTACLE_AGE_MS) {
+            obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
             // shrink list if this is the last entry:
             if (i == _obstacle_count-1) {
+                _obstacle_index.remove((uint64_t(obstacle.src) << 32) | obstacle.src_id);
                 _obstacle_count -= 1;
             }
             continue;
         }
 
+        if (obstacle.threat_level != MAV_COLLISION_THREAT_LEVEL_NONE ||
+            (int32_t)(now - obstacle.next_check_ms) >= 0) {
+            update_threat_level(my_loc, my_vel, obstacle);
+            obstacle.next_check_ms = now;
+            if (obstacle.threat_level == MAV_COLLISION_THREAT_LEVEL_NONE) {
+                obstacle.next_check_ms += time_until_possible_threat_ms(my_loc, my_vel, obstacle);
+            }
+        }
+        debug("   threat-level=%d", obstacle.threat_level);
+
         if (obstacle_is_more_serious_threat(obstacle)) {
             _current_most_serious_threat = i;
         }
@@ -36,6 +36,8 @@
 #define AP_AVOIDANCE_STATE_RECOVERY_TIME_MS                 2000    // we will not downgrade state any faster than this (2 seconds)
 
 #define AP_AVOIDANCE_ESCAPE_TIME_SEC                        2       // vehicle runs from thread for 2 seconds
+#define AP_AVOIDANCE_RECHECK_MAX_MS                         1000    // obstacles that cannot be a threat soon have their threat level recalculated at least this often
+#define AP_AVOIDANCE_RECHECK_SPEED_MARGIN                   10.0f   // speed in m/s added to the closing speed of an obstacle when deciding how long it cannot be a threat
 
 class AP_Avoidance {
 public:
@@ -60,6 +62,7 @@ public:
         float time_to_closest_approach; // seconds, 3D approach
         float distance_to_closest_approach; // metres, 3D
         uint32_t last_gcs_report_time; // millis
+        uint32_t next_check_ms; // millis, time the threat level must next be recalculated
     };
 
 
@@ -166,12 +169,19 @@ private:
     // calls into the AP_ADSB library to retrieve vehicle data
     void get_adsb_samples();
 
+    // time until an obstacle with no threat could become one, assuming
+    // both vehicles fly straight at each other
+    uint32_t time_until_possible_threat_ms(const Location &my_loc,
+                                           const Vector3f &my_vel,
+                                           const AP_Avoidance::Obstacle &obstacle) const;
+
     // returns true if the obstacle should be considered more of a
     // threat than the current most serious threat
     bool obstacle_is_more_serious_threat(const AP_Avoidance::Obstacle &obstacle) const;
 
     // internal variables
     AP_Avoidance::Obstacle *_obstacles;
+    AP_ADSB_Index<uint64_t> _obstacle_index;    // position in _obstacles by source and id
     uint8_t _obstacles_allocated;
     uint8_t _obstacle_count;
     int8_t _current_most_serious_threat;
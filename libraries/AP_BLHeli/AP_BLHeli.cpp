@@ -115,6 +115,14 @@ const AP_Param::GroupInfo AP_BLHeli::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("REMASK",  10, AP_BLHeli, channel_reversible_mask, 0),
 
+    // @Param: BDMASK
+    // @DisplayName: BLHeli bitmask of bidirectional DShot channels
+    // @Description: Mask of channels which support bidirectional DShot. The ESCs on these channels report their RPM back on the signal wire after every frame, which is used for RPM based notch filtering without ESC telemetry wiring. This needs ESC firmware with bidirectional DShot support
+    // @Bitmask: 0:Channel1,1:Channel2,2:Channel3,3:Channel4,4:Channel5,5:Channel6,6:Channel7,7:Channel8,8:Channel9,9:Channel10,10:Channel11,11:Channel12,12:Channel13,13:Channel14,14:Channel15,15:Channel16
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("BDMASK",  11, AP_BLHeli, channel_bidir_dshot_mask, 0),
+
     AP_GROUPEND
 };
 
@@ -1268,6 +1276,7 @@ void AP_BLHeli::update(void)
     SRV_Channels::set_digital_mask(mask);
     SRV_Channels::set_reversible_mask(uint16_t(channel_reversible_mask.get()) & mask);
     hal.rcout->set_reversible_mask(channel_reversible_mask.get() & mask);
+    hal.rcout->set_bidir_dshot_mask(uint16_t(channel_bidir_dshot_mask.get()) & mask);
 
     // add motors from channel mask
     for (uint8_t i=0; i<16 && num_motors < max_motors; i++) {
@@ -1284,6 +1293,12 @@ void AP_BLHeli::update(void)
         if (serial_manager) {
             telem_uart = serial_manager->find_serial(AP_SerialManager::SerialProtocol_ESCTelemetry,0);
         }
+        if (telem_uart != nullptr &&
+            !hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_BLHeli::telem_thread, void),
+                                          "esctelem", 2048, AP_HAL::Scheduler::PRIORITY_UART, 0)) {
+            hal.console->printf("Failed to create ESC telemetry thread\n");
+            telem_uart = nullptr;
+        }
     }
 
 }
@@ -1294,11 +1309,26 @@ bool AP_BLHeli::get_telem_data(uint8_t esc_index, struct telem_data &td)
     if (esc_index >= max_motors) {
         return false;
     }
-    if (last_telem[esc_index].timestamp_ms == 0) {
-        return false;
+    td = last_telem[esc_index].read();
+    return td.timestamp_ms != 0;
+}
+
+/*
+  get the latest rpm for a motor, preferring bidirectional DShot over
+  serial telemetry as it is updated every few frames
+ */
+bool AP_BLHeli::get_motor_rpm(uint8_t i, uint32_t now_ms, float &rpm) const
+{
+    if (bdshot[i].timestamp_ms && (now_ms - bdshot[i].timestamp_ms < 1000)) {
+        rpm = bdshot[i].rpm;
+        return true;
     }
-    td = last_telem[esc_index];
-    return true;
+    const struct telem_data td = last_telem[i].read();
+    if (td.timestamp_ms && (now_ms - td.timestamp_ms < 1000)) {
+        rpm = td.rpm;
+        return true;
+    }
+    return false;
 }
 
 // return the average motor frequency in Hz for dynamic filtering
@@ -1309,9 +1339,10 @@ float AP_BLHeli::get_average_motor_frequency_hz() const
     uint8_t valid_escs = 0;
     // average the rpm of each motor as reported by BLHeli and convert to Hz
     for (uint8_t i = 0; i < num_motors; i++) {
-        if (last_telem[i].timestamp_ms && (now - last_telem[i].timestamp_ms < 1000)) {
+        float rpm;
+        if (get_motor_rpm(i, now, rpm)) {
             valid_escs++;
-            motor_freq += last_telem[i].rpm / 60.0f;
+            motor_freq += rpm / 60.0f;
         }
     }
     if (valid_escs > 0) {
@@ -1321,6 +1352,21 @@ float AP_BLHeli::get_average_motor_frequency_hz() const
     return motor_freq;
 }
 
+// get the frequency in Hz of each motor with recent rpm data for
+// dynamic filtering, returning the number of frequencies filled in
+uint8_t AP_BLHeli::get_motor_frequencies_hz(uint8_t nfreqs, float *freqs) const
+{
+    const uint32_t now = AP_HAL::millis();
+    uint8_t valid_escs = 0;
+    for (uint8_t i = 0; i < num_motors && valid_escs < nfreqs; i++) {
+        float rpm;
+        if (get_motor_rpm(i, now, rpm)) {
+            freqs[valid_escs++] = rpm / 60.0f;
+        }
+    }
+    return valid_escs;
+}
+
 /*
   implement the 8 bit CRC used by the BLHeli ESC telemetry protocol
  */
@@ -1337,45 +1383,124 @@ uint8_t AP_BLHeli::telem_crc8(uint8_t crc, uint8_t crc_seed) const
 }
 
 /*
-  read an ESC telemetry packet
+  ESC telemetry thread. The ESCs are asked for telemetry in turn, and
+  each replies with a frame on the telemetry UART which is read and
+  checked here, so the main loop only ever sees the decoded values
  */
-void AP_BLHeli::read_telemetry_packet(void)
+void AP_BLHeli::telem_thread(void)
 {
-    uint8_t buf[telem_packet_size];
-    uint8_t crc = 0;
-    for (uint8_t i=0; i<telem_packet_size; i++) {
-        int16_t v = telem_uart->read();
-        if (v < 0) {
-            // short read, we should have 10 bytes ready when this function is called
-            return;
+    // we need to use begin() here to ensure this thread owns the uart
+    telem_uart->begin(115200);
+
+    while (true) {
+        hal.scheduler->delay_microseconds(500);
+        telem_update();
+    }
+}
+
+/*
+  read ESC telemetry bytes and request telemetry from the next ESC
+ */
+void AP_BLHeli::telem_update(void)
+{
+    const uint32_t now = AP_HAL::micros();
+
+    if (telem.frame_len > 0 && now - telem.last_byte_us > telem_frame_gap_us) {
+        // the rest of the frame didn't arrive
+        telem_stats[telem.frame_esc].bad_frames++;
+        telem.frame_len = 0;
+    }
+
+    uint32_t nbytes = telem_uart->available();
+    while (nbytes--) {
+        const int16_t c = telem_uart->read();
+        if (c < 0) {
+            break;
+        }
+        if (telem.frame_len == 0) {
+            // frames are from the last ESC asked
+            telem.frame_esc = telem.requested_esc;
+        }
+        telem.frame[telem.frame_len++] = uint8_t(c);
+        telem.last_byte_us = now;
+        if (telem.frame_len == telem_packet_size) {
+            telem_process_frame();
+            telem.frame_len = 0;
         }
-        buf[i] = uint8_t(v);
     }
 
+    uint32_t telem_rate_us = 1000000U / uint32_t(MAX(telem_rate.get(), 1) * num_motors);
+    if (telem_rate_us < 2000) {
+        // make sure we have a gap between frames
+        telem_rate_us = 2000;
+    }
+    if (now - telem.last_request_us >= telem_rate_us) {
+        if (telem.awaiting_reply) {
+            telem_stats[telem.requested_esc].no_reply++;
+        }
+        // ask the next ESC for telemetry
+        telem.requested_esc = (telem.requested_esc + 1) % num_motors;
+        uint16_t mask = 1U << motor_map[telem.requested_esc];
+        hal.rcout->set_telem_request_mask(mask);
+        telem.last_request_us = now;
+        telem.awaiting_reply = true;
+    }
+
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - telem.last_stats_ms >= 1000) {
+        telem_log_stats();
+        telem.last_stats_ms = now_ms;
+    }
+}
+
+/*
+  check and publish a complete ESC telemetry frame
+ */
+void AP_BLHeli::telem_process_frame(void)
+{
+    const uint8_t *buf = telem.frame;
+    const uint8_t esc = telem.frame_esc;
+
     // calculate crc
+    uint8_t crc = 0;
     for (uint8_t i=0; i<telem_packet_size-1; i++) {    
         crc = telem_crc8(buf[i], crc);
     }
 
     if (buf[telem_packet_size-1] != crc) {
         // bad crc
-        debug("Bad CRC on %u\n", last_telem_esc);
+        telem_stats[esc].bad_frames++;
         return;
     }
+    if (esc == telem.requested_esc) {
+        telem.awaiting_reply = false;
+    }
+
+    const uint32_t now_ms = AP_HAL::millis();
+    auto &stats = telem_stats[esc];
+    if (stats.last_frame_ms != 0) {
+        const uint32_t age_ms = now_ms - stats.last_frame_ms;
+        stats.age_max_ms = MAX(stats.age_max_ms, age_ms);
+        stats.age_sum_ms += age_ms;
+    }
+    stats.last_frame_ms = now_ms;
+    stats.frames++;
+    stats.count++;
+
     struct telem_data td;
     td.temperature = buf[0];
     td.voltage = (buf[1]<<8) | buf[2];
     td.current = (buf[3]<<8) | buf[4];
     td.consumption = (buf[5]<<8) | buf[6];
     td.rpm = ((buf[7]<<8) | buf[8]) * 200 / motor_poles;
-    td.timestamp_ms = AP_HAL::millis();
+    td.count = stats.count;
+    td.timestamp_ms = now_ms;
 
-    last_telem[last_telem_esc] = td;
-    last_telem[last_telem_esc].count++;
+    last_telem[esc].write(td);
 
     AP_Logger *logger = AP_Logger::get_singleton();
     if (logger && logger->logging_enabled()) {
-        logger->Write_ESC(uint8_t(last_telem_esc),
+        logger->Write_ESC(esc,
                       AP_HAL::micros64(),
                       td.rpm*100U,
                       td.voltage,
@@ -1385,74 +1510,90 @@ void AP_BLHeli::read_telemetry_packet(void)
     }
     if (debug_level >= 2) {
         hal.console->printf("ESC[%u] T=%u V=%u C=%u con=%u RPM=%u t=%u\n",
-                            last_telem_esc,
+                            esc,
                             td.temperature,
                             td.voltage,
                             td.current,
                             td.consumption,
-                            td.rpm, (unsigned)AP_HAL::millis());
+                            td.rpm, (unsigned)now_ms);
     }
 }
 
 /*
-  update BLHeli telemetry handling
-  This is called on push() in SRV_Channels
+  log the telemetry reception stats of each ESC and start again
  */
-void AP_BLHeli::update_telemetry(void)
+void AP_BLHeli::telem_log_stats(void)
 {
-    if (!telem_uart) {
-        return;
-    }
-    uint32_t now = AP_HAL::micros();
-    uint32_t telem_rate_us = 1000000U / uint32_t(telem_rate.get() * num_motors);
-    if (telem_rate_us < 2000) {
-        // make sure we have a gap between frames
-        telem_rate_us = 2000;
-    }
-    if (!telem_uart_started) {
-        // we need to use begin() here to ensure the correct thread owns the uart
-        telem_uart->begin(115200);
-        telem_uart_started = true;
+    AP_Logger *logger = AP_Logger::get_singleton();
+    const bool log = logger && logger->logging_enabled();
+    for (uint8_t i=0; i<num_motors; i++) {
+        auto &stats = telem_stats[i];
+        if (log) {
+            const struct log_ESCTelemStats pkt {
+                LOG_PACKET_HEADER_INIT(LOG_ESC_TELEM_STATS_MSG),
+                time_us    : AP_HAL::micros64(),
+                instance   : i,
+                frames     : stats.frames,
+                bad_frames : stats.bad_frames,
+                no_reply   : stats.no_reply,
+                age_max    : uint16_t(MIN(stats.age_max_ms, uint32_t(UINT16_MAX))),
+                age_avg    : uint16_t(stats.frames > 0 ? MIN(stats.age_sum_ms / stats.frames, uint32_t(UINT16_MAX)) : 0)
+            };
+            logger->WriteBlock(&pkt, sizeof(pkt));
+        }
+        stats.frames = 0;
+        stats.bad_frames = 0;
+        stats.no_reply = 0;
+        stats.age_max_ms = 0;
+        stats.age_sum_ms = 0;
     }
+}
 
-    uint32_t nbytes = telem_uart->available();
+/*
+  update BLHeli telemetry handling. Serial telemetry is handled in its
+  own thread, so this only has bidirectional DShot to read
+ */
+void AP_BLHeli::update_telemetry(void)
+{
+    update_bidir_dshot();
+}
 
-    if (nbytes > telem_packet_size) {
-        // if we have more than 10 bytes then we don't know which ESC
-        // they are from. Throw them all away
-        while (nbytes--) {
-            telem_uart->read();
-        }
+/*
+  read the rpm from motors using bidirectional DShot
+ */
+void AP_BLHeli::update_bidir_dshot(void)
+{
+    const uint16_t bidir_mask = uint16_t(channel_bidir_dshot_mask.get()) & motor_mask;
+    if (bidir_mask == 0) {
         return;
     }
-    if (nbytes > 0 &&
-        nbytes < telem_packet_size &&
-        (last_telem_byte_read_us == 0 ||
-         now - last_telem_byte_read_us < 1000)) {
-        // wait a bit longer, we don't have enough bytes yet
-        if (last_telem_byte_read_us == 0) {
-            last_telem_byte_read_us = now;
+    const uint32_t now = AP_HAL::millis();
+    const bool log_rates = now - last_bdshot_log_ms >= 100;
+    AP_Logger *logger = AP_Logger::get_singleton();
+    for (uint8_t i = 0; i < num_motors; i++) {
+        const uint8_t chan = motor_map[i];
+        if (!(bidir_mask & (1U<<chan))) {
+            continue;
         }
-        return;
-    }
-    if (nbytes > 0 && nbytes < telem_packet_size) {
-        // we've waited long enough, discard bytes if we don't have 10 yet
-        while (nbytes--) {
-            telem_uart->read();
+        bdshot[i].error_rate = hal.rcout->get_erpm_error_rate(chan);
+        if (bdshot[i].error_rate < 100) {
+            // the ESC reports electrical rpm
+            bdshot[i].rpm = hal.rcout->get_erpm(chan) * 2 / motor_poles;
+            bdshot[i].timestamp_ms = now;
+        }
+        if (log_rates && logger && logger->logging_enabled()) {
+            const struct log_BidirDShot pkt {
+                LOG_PACKET_HEADER_INIT(LOG_BIDIR_DSHOT_MSG),
+                time_us     : AP_HAL::micros64(),
+                instance    : i,
+                rpm         : float(bdshot[i].rpm),
+                error_rate  : bdshot[i].error_rate
+            };
+            logger->WriteBlock(&pkt, sizeof(pkt));
         }
-        return;
     }
-    if (nbytes == telem_packet_size) {
-        // we have a full packet ready to parse
-        read_telemetry_packet();
-        last_telem_byte_read_us = 0;
-    }
-    if (now - last_telem_request_us >= telem_rate_us) {
-        // ask the next ESC for telemetry
-        last_telem_esc = (last_telem_esc + 1) % num_motors;
-        uint16_t mask = 1U << motor_map[last_telem_esc];
-        hal.rcout->set_telem_request_mask(mask);
-        last_telem_request_us = now;
+    if (log_rates) {
+        last_bdshot_log_ms = now;
     }
 }
 
@@ -1473,13 +1614,14 @@ void AP_BLHeli::send_esc_telemetry_mavlink(uint8_t mav_chan)
     uint32_t now = AP_HAL::millis();
     for (uint8_t i=0; i<num_motors; i++) {
         uint8_t idx = i % 4;
-        if (last_telem[i].timestamp_ms && (now - last_telem[i].timestamp_ms < 1000)) {
-            temperature[idx]  = last_telem[i].temperature;
-            voltage[idx]      = last_telem[i].voltage;
-            current[idx]      = last_telem[i].current;
-            totalcurrent[idx] = last_telem[i].consumption;
-            rpm[idx]          = last_telem[i].rpm;
-            count[idx]        = last_telem[i].count;
+        const struct telem_data td = last_telem[i].read();
+        if (td.timestamp_ms && (now - td.timestamp_ms < 1000)) {
+            temperature[idx]  = td.temperature;
+            voltage[idx]      = td.voltage;
+            current[idx]      = td.current;
+            totalcurrent[idx] = td.consumption;
+            rpm[idx]          = td.rpm;
+            count[idx]        = td.count;
         } else {
             temperature[idx] = 0;
             voltage[idx] = 0;
@@ -1488,6 +1630,10 @@ void AP_BLHeli::send_esc_telemetry_mavlink(uint8_t mav_chan)
             rpm[idx] = 0;
             count[idx] = 0;
         }
+        float motor_rpm;
+        if (get_motor_rpm(i, now, motor_rpm)) {
+            rpm[idx] = uint16_t(motor_rpm);
+        }
         if (i % 4 == 3 || i == num_motors - 1) {
             if (!HAVE_PAYLOAD_SPACE((mavlink_channel_t)mav_chan, ESC_TELEMETRY_1_TO_4)) {
                 return;
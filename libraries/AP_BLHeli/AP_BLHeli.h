@@ -29,6 +29,7 @@
 #define HAVE_AP_BLHELI_SUPPORT
 
 #include <AP_Param/AP_Param.h>
+#include <AP_HAL/utility/SeqLock.h>
 #include "msp_protocol.h"
 #include "blheli_4way_protocol.h"
 
@@ -40,6 +41,7 @@ public:
     AP_BLHeli();
     
     void update(void);
+    // called on push() in SRV_Channels
     void update_telemetry(void);
     bool process_input(uint8_t b);
 
@@ -59,6 +61,9 @@ public:
     bool get_telem_data(uint8_t esc_index, struct telem_data &td);
     // return the average motor frequency in Hz for dynamic filtering
     float get_average_motor_frequency_hz() const;
+    // get the frequency in Hz of each motor for dynamic filtering,
+    // returning the number of frequencies filled in
+    uint8_t get_motor_frequencies_hz(uint8_t nfreqs, float *freqs) const;
 
     static AP_BLHeli *get_singleton(void) {
         return _singleton;
@@ -73,6 +78,7 @@ private:
     // mask of channels to use for BLHeli protocol
     AP_Int32 channel_mask;
     AP_Int32 channel_reversible_mask;
+    AP_Int16 channel_bidir_dshot_mask;
     AP_Int8 channel_auto;
     AP_Int8 run_test;
     AP_Int16 timeout_sec;
@@ -222,7 +228,16 @@ private:
     static const uint8_t max_motors = AP_BLHELI_MAX_ESCS;
     uint8_t num_motors;
 
-    struct telem_data last_telem[max_motors];
+    // latest telemetry from each ESC, written by the telemetry thread
+    SeqLock<struct telem_data> last_telem[max_motors];
+
+    // rpm from bidirectional DShot
+    struct {
+        uint32_t rpm;
+        float error_rate;
+        uint32_t timestamp_ms;
+    } bdshot[max_motors];
+    uint32_t last_bdshot_log_ms;
 
     // have we initialised the interface?
     bool initialised;
@@ -243,14 +258,42 @@ private:
     uint8_t motor_map[max_motors];
     uint16_t motor_mask;
 
-    // when did we last request telemetry?
-    uint32_t last_telem_request_us;
-    uint8_t last_telem_esc;
     static const uint8_t telem_packet_size = 10;
-    bool telem_uart_started;
-    uint32_t last_telem_byte_read_us;
+
+    // a gap between bytes this long ends a telemetry frame
+    static const uint32_t telem_frame_gap_us = 1000;
+
+    /*
+      state of the telemetry thread. Only the telemetry thread uses
+      this
+     */
+    struct {
+        uint8_t frame[telem_packet_size];
+        uint8_t frame_len;
+        uint8_t frame_esc;          // ESC which the frame being read is from
+        uint32_t last_byte_us;
+        uint32_t last_request_us;   // when did we last request telemetry?
+        uint8_t requested_esc;
+        bool awaiting_reply;
+        uint32_t last_stats_ms;
+    } telem;
+
+    // telemetry reception stats for each ESC, logged once a second
+    struct {
+        uint16_t count;             // good frames since boot
+        uint16_t frames;            // good frames since the stats were logged
+        uint16_t bad_frames;        // frames with a bad CRC or which were cut short
+        uint16_t no_reply;          // requests with no reply
+        uint32_t last_frame_ms;
+        uint32_t age_max_ms;        // longest time between good frames
+        uint32_t age_sum_ms;
+    } telem_stats[max_motors];
+
     int8_t last_control_port;
 
+    bool get_motor_rpm(uint8_t i, uint32_t now_ms, float &rpm) const;
+    void update_bidir_dshot(void);
+
     bool msp_process_byte(uint8_t c);
     void blheli_crc_update(uint8_t c);
     bool blheli_4way_process_byte(uint8_t c);
@@ -280,7 +323,10 @@ private:
     void blheli_process_command(void);
     void run_connection_test(uint8_t chan);
     uint8_t telem_crc8(uint8_t crc, uint8_t crc_seed) const;
-    void read_telemetry_packet(void);
+    void telem_thread(void);
+    void telem_update(void);
+    void telem_process_frame(void);
+    void telem_log_stats(void);
     
     // protocol handler hook
     bool protocol_handler(uint8_t , AP_HAL::UARTDriver *);
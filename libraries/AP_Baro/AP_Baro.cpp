@@ -167,6 +167,15 @@ const AP_Param::GroupInfo AP_Baro::var_info[] = {
     AP_GROUPINFO("PROBE_EXT", 14, AP_Baro, _baro_probe_ext, HAL_BARO_PROBE_EXT_DEFAULT),
 #endif
 
+#if BARO_MAX_INSTANCES > 1
+    // @Param: BLEND
+    // @DisplayName: Blend barometers
+    // @Description: When enabled the altitude given to the EKF and used for the climb rate is an average of all healthy barometers, each weighted by the inverse of its measured noise. When disabled the primary barometer is used.
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    AP_GROUPINFO("BLEND", 15, AP_Baro, _blend_enable, 0),
+#endif
+
     AP_GROUPEND
 };
 
@@ -434,7 +443,10 @@ bool AP_Baro::_add_backend(AP_Baro_Backend *backend)
     if (_num_drivers >= BARO_MAX_DRIVERS) {
         AP_HAL::panic("Too many barometer drivers");
     }
-    drivers[_num_drivers++] = backend;
+    // fill in the slot before counting it, as bus threads look up
+    // their backends with get_bus_slot() while we probe
+    drivers[_num_drivers] = backend;
+    _num_drivers++;
     return true;
 }
 
@@ -775,6 +787,8 @@ void AP_Baro::update(void)
         }
     }
 
+    update_blend();
+
     // ensure the climb rate filter is updated
     if (healthy()) {
         _climb_rate_filter.update(get_altitude(), get_last_update());
@@ -793,6 +807,16 @@ void AP_Baro::update(void)
         }
     }
 
+    // sample interval statistics for each driver, at 1Hz
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - _last_jitter_report_ms >= 1000) {
+        _last_jitter_report_ms = now_ms;
+        for (uint8_t i=0; i<_num_drivers; i++) {
+            drivers[i]->report_sample_jitter(i);
+        }
+        log_sensor_stats();
+    }
+
     // logging
 #ifndef HAL_NO_LOGGING
     if (should_log() && !AP::ahrs().have_ekf_logging()) {
@@ -801,6 +825,150 @@ void AP_Baro::update(void)
 #endif
 }
 
+// time constant of the blend noise estimate, in sensor updates
+#define BARO_BLEND_FILTER_ALPHA 0.02f
+// lowest noise variance, 5cm standard deviation, so no sensor
+// takes all the weight
+#define BARO_BLEND_MIN_NOISE_VAR 0.0025f
+
+/*
+  blend the altitudes of the healthy sensors, weighting each by the
+  inverse of its noise variance. The noise of a sensor is measured as
+  the variation of the difference between its altitude and the blend
+  of the others, so vehicle motion, which all sensors see, cancels
+  out. Differences in offset between sensors are taken out of the
+  noise estimate, but not out of the blend, as the sensors are all
+  calibrated to the same ground altitude
+ */
+void AP_Baro::update_blend(void)
+{
+    _blend.active = false;
+    if (_blend_enable <= 0 || _num_sensors < 2 || _hil_mode) {
+        for (uint8_t i=0; i<_num_sensors; i++) {
+            sensors[i].blend_weight = 0;
+        }
+        return;
+    }
+
+    // blend of all sensors, using the current weights
+    float sum_w = 0;
+    float sum_walt = 0;
+    uint8_t count = 0;
+    uint32_t last_update_ms = 0;
+    for (uint8_t i=0; i<_num_sensors; i++) {
+        const sensor &s = sensors[i];
+        if (!healthy(i) || s.type != sensors[_primary].type) {
+            continue;
+        }
+        const float w = 1.0f / MAX(s.blend_noise_var, BARO_BLEND_MIN_NOISE_VAR);
+        sum_w += w;
+        sum_walt += w * s.altitude;
+        if (count == 0 || int32_t(s.last_update_ms - last_update_ms) > 0) {
+            last_update_ms = s.last_update_ms;
+        }
+        count++;
+    }
+
+    for (uint8_t i=0; i<_num_sensors; i++) {
+        sensor &s = sensors[i];
+        s.blend_weight = 0;
+        if (!healthy(i) || s.type != sensors[_primary].type) {
+            continue;
+        }
+        const float w = 1.0f / MAX(s.blend_noise_var, BARO_BLEND_MIN_NOISE_VAR);
+        s.blend_weight = w / sum_w;
+        if (count < 2 || s.last_update_ms == s.blend_update_ms) {
+            continue;
+        }
+        s.blend_update_ms = s.last_update_ms;
+
+        // compare with the blend of the other sensors
+        const float others = (sum_walt - w * s.altitude) / (sum_w - w);
+        const float diff = s.altitude - others;
+        s.blend_offset += BARO_BLEND_FILTER_ALPHA * (diff - s.blend_offset);
+        const float err = diff - s.blend_offset;
+        s.blend_noise_var += BARO_BLEND_FILTER_ALPHA * (sq(err) - s.blend_noise_var);
+    }
+
+    if (count < 2) {
+        // nothing to blend, use the primary
+        return;
+    }
+    _blend.altitude = sum_walt / sum_w;
+    _blend.last_update_ms = last_update_ms;
+    _blend.active = true;
+}
+
+/*
+  log per sensor statistics at 1Hz
+ */
+void AP_Baro::log_sensor_stats(void)
+{
+#ifndef HAL_NO_LOGGING
+    if (!should_log()) {
+        return;
+    }
+    for (uint8_t i=0; i<_num_drivers; i++) {
+// @LoggerMessage: BARD
+// @Description: Barometer driver statistics
+// @Field: TimeUS: Time since system startup
+// @Field: I: driver instance
+// @Field: Err: samples rejected as out of range since startup
+// @Field: Stag: offset of the driver's conversions from the other barometers on its bus
+        AP::logger().Write("BARD", "TimeUS,I,Err,Stag", "QBII",
+                           AP_HAL::micros64(),
+                           i,
+                           drivers[i]->get_error_count(),
+                           drivers[i]->get_stagger_offset_us());
+    }
+    if (!_blend.active) {
+        return;
+    }
+    for (uint8_t i=0; i<_num_sensors; i++) {
+// @LoggerMessage: BARB
+// @Description: Barometer blending
+// @Field: TimeUS: Time since system startup
+// @Field: I: barometer instance
+// @Field: Off: filtered altitude difference from the other barometers
+// @Field: NSD: standard deviation of that difference, taken as the barometer's noise
+// @Field: W: weight of the barometer in the blended altitude
+// @Field: BAlt: blended altitude
+        AP::logger().Write("BARB", "TimeUS,I,Off,NSD,W,BAlt", "QBffff",
+                           AP_HAL::micros64(),
+                           i,
+                           sensors[i].blend_offset,
+                           safe_sqrt(sensors[i].blend_noise_var),
+                           sensors[i].blend_weight,
+                           _blend.altitude);
+    }
+#endif
+}
+
+/*
+  find the position of a backend among those on the same bus
+ */
+bool AP_Baro::get_bus_slot(const AP_Baro_Backend *backend, uint8_t &slot, uint8_t &count) const
+{
+    const uint16_t key = backend->get_bus_key();
+    bool found = false;
+    slot = 0;
+    count = 0;
+    for (uint8_t i=0; i<_num_drivers; i++) {
+        if (drivers[i] == backend) {
+            found = true;
+            slot = count;
+        }
+        if (key != 0 && drivers[i] != nullptr && drivers[i]->get_bus_key() == key) {
+            count++;
+        }
+    }
+    if (count == 0) {
+        // not on a shared bus
+        count = 1;
+    }
+    return found;
+}
+
 /*
   call accumulate on all drivers
  */
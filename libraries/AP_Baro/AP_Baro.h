@@ -81,7 +81,7 @@ public:
 
     // get current altitude in meters relative to altitude at the time
     // of the last calibrate() call
-    float get_altitude(void) const { return get_altitude(_primary); }
+    float get_altitude(void) const { return _blend.active ? _blend.altitude : get_altitude(_primary); }
     float get_altitude(uint8_t instance) const { return sensors[instance].altitude; }
 
     // get altitude difference in meters relative given a base
@@ -113,7 +113,7 @@ public:
     void set_external_temperature(float temperature);
 
     // get last time sample was taken (in ms)
-    uint32_t get_last_update(void) const { return get_last_update(_primary); }
+    uint32_t get_last_update(void) const { return _blend.active ? _blend.last_update_ms : get_last_update(_primary); }
     uint32_t get_last_update(uint8_t instance) const { return sensors[instance].last_update_ms; }
 
     // settable parameters
@@ -181,6 +181,11 @@ public:
     void set_log_baro_bit(uint32_t bit) { _log_baro_bit = bit; }
     bool should_log() const;
 
+    // position of a backend among the backends reading sensors on the
+    // same bus, and the number of them. Returns false if the backend
+    // has not been added yet
+    bool get_bus_slot(const AP_Baro_Backend *backend, uint8_t &slot, uint8_t &count) const;
+
     // allow threads to lock against baro update
     HAL_Semaphore &get_semaphore(void) {
         return _rsem;
@@ -230,8 +235,22 @@ private:
         bool healthy;                   // true if sensor is healthy
         bool alt_ok;                    // true if calculated altitude is ok
         bool calibrated;                // true if calculated calibrated successfully
+        uint32_t blend_update_ms;       // last_update_ms of the reading last used for the noise estimate
+        float blend_offset;             // filtered altitude difference from the other sensors
+        float blend_noise_var;          // variance of that difference about its mean
+        float blend_weight;             // share of the blended altitude, zero if not used
     } sensors[BARO_MAX_INSTANCES];
 
+    // altitude from all healthy sensors, weighted by their noise
+    struct {
+        bool active;
+        float altitude;
+        uint32_t last_update_ms;
+    } _blend;
+    AP_Int8                             _blend_enable;
+    void update_blend(void);
+    void log_sensor_stats(void);
+
     AP_Float                            _alt_offset;
     float                               _alt_offset_active;
     AP_Int8                             _primary_baro; // primary chosen by user
@@ -248,6 +267,7 @@ private:
 
     // when did we last notify the GCS of new pressure reference?
     uint32_t                            _last_notify_ms;
+    uint32_t                            _last_jitter_report_ms;
 
     bool _add_backend(AP_Baro_Backend *backend);
     void _probe_i2c_barometers(void);
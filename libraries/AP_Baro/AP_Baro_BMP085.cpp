@@ -137,7 +137,7 @@ bool AP_Baro_BMP085::_init()
 
     _instance = _frontend.register_sensor();
 
-    _dev->register_periodic_callback(20000, FUNCTOR_BIND_MEMBER(&AP_Baro_BMP085::_timer, void));
+    _register_staggered_callback(*_dev, 20000, FUNCTOR_BIND_MEMBER(&AP_Baro_BMP085::_timer, void));
     return true;
 }
 
@@ -116,7 +116,7 @@ bool AP_Baro_BMP280::_init()
     _instance = _frontend.register_sensor();
 
     // request 50Hz update
-    _dev->register_periodic_callback(20 * AP_USEC_PER_MSEC, FUNCTOR_BIND_MEMBER(&AP_Baro_BMP280::_timer, void));
+    _register_staggered_callback(*_dev, 20 * AP_USEC_PER_MSEC, FUNCTOR_BIND_MEMBER(&AP_Baro_BMP280::_timer, void));
 
     return true;
 }
@@ -109,7 +109,7 @@ bool AP_Baro_BMP388::init()
     instance = _frontend.register_sensor();
 
     // request 50Hz update
-    dev->register_periodic_callback(20 * AP_USEC_PER_MSEC, FUNCTOR_BIND_MEMBER(&AP_Baro_BMP388::timer, void));
+    _register_staggered_callback(*dev, 20 * AP_USEC_PER_MSEC, FUNCTOR_BIND_MEMBER(&AP_Baro_BMP388::timer, void));
 
     return true;
 }
@@ -191,26 +191,21 @@ void AP_Baro_BMP388::update_temperature(uint32_t data)
  */
 void AP_Baro_BMP388::update_pressure(uint32_t data)
 {
-    float partial1 = calib.par_p6 * temperature;
-    float partial2 = calib.par_p7 * powf(temperature, 2);
-    float partial3 = calib.par_p8 * powf(temperature, 3);
-    float partial_out1 = calib.par_p5 + partial1 + partial2 + partial3;
-
-    partial1 = calib.par_p2 * temperature;
-    partial2 = calib.par_p3 * powf(temperature, 2);
-    partial3 = calib.par_p4 * powf(temperature, 3);
-    float partial_out2 = data * (calib.par_p1 + partial1 + partial2 + partial3);
-
-    partial1 = powf(data, 2);
-    partial2 = calib.par_p9 + calib.par_p10 * temperature;
-    partial3 = partial1 * partial2;
-    float partial4 = partial3 + powf(data, 3) * calib.par_p11;
+    // the cubics in temperature are evaluated in Horner form, which
+    // avoids four powf() calls per sample
+    const float t = temperature;
+    const float partial_out1 = calib.par_p5 + t * (calib.par_p6 + t * (calib.par_p7 + t * calib.par_p8));
+    const float partial_out2 = data * (calib.par_p1 + t * (calib.par_p2 + t * (calib.par_p3 + t * calib.par_p4)));
+
+    const float data_sq = sq(float(data));
+    const float partial4 = data_sq * (calib.par_p9 + calib.par_p10 * t) + data_sq * data * calib.par_p11;
     float press = partial_out1 + partial_out2 + partial4;
 
     WITH_SEMAPHORE(_sem);
     
     pressure = press;
     has_sample = true;
+    _notify_new_sample();
 }
 
 /*
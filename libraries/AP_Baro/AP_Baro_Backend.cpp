@@ -62,6 +62,57 @@ void AP_Baro_Backend::_copy_to_frontend(uint8_t instance, float pressure, float
     _frontend.sensors[instance].last_update_ms = now;
 }
 
+/*
+  register the sensor read callback, staggered against the other
+  baros on the same bus
+ */
+void AP_Baro_Backend::_register_staggered_callback(AP_HAL::Device &dev, uint32_t period_usec, AP_HAL::Device::PeriodicCb cb)
+{
+    _timer_dev = &dev;
+    _timer_cb = cb;
+    _timer_period_us = period_usec;
+    if (dev.bus_type() != AP_HAL::Device::BUS_TYPE_UNKNOWN) {
+        _bus_key = (uint16_t(dev.bus_type()) << 8) | dev.bus_num();
+    }
+    _stagger_state = StaggerState::WAITING;
+    _timer_handle = dev.register_periodic_callback(period_usec, FUNCTOR_BIND_MEMBER(&AP_Baro_Backend::_staggered_timer, void));
+}
+
+/*
+  run the sensor read callback, shifting it to its place on the bus
+  on the first calls. The shift is done by making one interval longer,
+  never shorter, so a conversion started on the last call is always
+  complete
+ */
+void AP_Baro_Backend::_staggered_timer(void)
+{
+    switch (_stagger_state) {
+    case StaggerState::WAITING: {
+        uint8_t slot, count;
+        if (!_frontend.get_bus_slot(this, slot, count)) {
+            // still probing, try again next time
+            break;
+        }
+        _stagger_offset_us = _timer_period_us * slot / count;
+        if (_stagger_offset_us != 0 &&
+            _timer_dev->adjust_periodic_callback(_timer_handle, _timer_period_us + _stagger_offset_us)) {
+            _stagger_state = StaggerState::SHIFTED;
+        } else {
+            _stagger_offset_us = 0;
+            _stagger_state = StaggerState::DONE;
+        }
+        break;
+    }
+    case StaggerState::SHIFTED:
+        _timer_dev->adjust_periodic_callback(_timer_handle, _timer_period_us);
+        _stagger_state = StaggerState::DONE;
+        break;
+    default:
+        break;
+    }
+    _timer_cb();
+}
+
 static constexpr float FILTER_KOEF = 0.1f;
 
 /* Check that the baro value is valid by using a mean filter. If the
@@ -70,7 +121,8 @@ static constexpr float FILTER_KOEF = 0.1f;
 */
 bool AP_Baro_Backend::pressure_ok(float press)
 {
-    
+    _notify_new_sample();
+
     if (isinf(press) || isnan(press)) {
         return false;
     }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "AP_Baro.h"
+#include <AP_SampleJitter/AP_SampleJitter.h>
 
 class AP_Baro_Backend
 {
@@ -23,12 +24,33 @@ public:
     // If the value further that filtrer_range from mean value, it is rejected.
     bool pressure_ok(float press);
     uint32_t get_error_count() const { return _error_count; }
+
+    // bus the backend reads its sensor on, or zero if it has no
+    // periodic callback on a bus
+    uint16_t get_bus_key() const { return _bus_key; }
+
+    // offset of this backend's conversions from the others on its bus
+    uint32_t get_stagger_offset_us() const { return _stagger_offset_us; }
+
+    // log and send the sample interval statistics for this backend
+    void report_sample_jitter(uint8_t index) { _sample_jitter.report(AP_SampleJitter::SensorType::BARO, index); }
+
 protected:
     // reference to frontend object
     AP_Baro &_frontend;
 
     void _copy_to_frontend(uint8_t instance, float pressure, float temperature);
 
+    // record the arrival of a raw pressure sample. pressure_ok() calls
+    // this, so only backends which don't range check need to
+    void _notify_new_sample(void) { _sample_jitter.sample(AP_HAL::micros()); }
+
+    // register the periodic callback which reads the sensor. Baros on
+    // the same bus start in phase, so once all have registered each
+    // callback is shifted by its share of the period, spreading the
+    // conversions over the period instead of reading them together
+    void _register_staggered_callback(AP_HAL::Device &dev, uint32_t period_usec, AP_HAL::Device::PeriodicCb cb);
+
     // semaphore for access to shared frontend data
     HAL_Semaphore_Recursive _sem;
 
@@ -38,4 +60,22 @@ protected:
     float _mean_pressure; 
     // number of dropped samples. Not used for now, but can be usable to choose more reliable sensor
     uint32_t _error_count;
+
+    AP_SampleJitter _sample_jitter;
+
+private:
+    void _staggered_timer(void);
+
+    AP_HAL::Device *_timer_dev;
+    AP_HAL::Device::PeriodicHandle _timer_handle;
+    AP_HAL::Device::PeriodicCb _timer_cb;
+    uint32_t _timer_period_us;
+    uint32_t _stagger_offset_us;
+    uint16_t _bus_key;
+    enum class StaggerState : uint8_t {
+        NONE,
+        WAITING,    // waiting to be registered with the frontend
+        SHIFTED,    // next call is late by the offset
+        DONE,
+    } _stagger_state;
 };
@@ -166,7 +166,7 @@ bool AP_Baro_DPS280::init()
     dev->get_semaphore()->give();
 
     // request 64Hz update. New data will be available at 32Hz
-    dev->register_periodic_callback((1000 / 64) * AP_USEC_PER_MSEC, FUNCTOR_BIND_MEMBER(&AP_Baro_DPS280::timer, void));
+    _register_staggered_callback(*dev, (1000 / 64) * AP_USEC_PER_MSEC, FUNCTOR_BIND_MEMBER(&AP_Baro_DPS280::timer, void));
 
     return true;
 }
@@ -127,7 +127,7 @@ bool AP_Baro_FBM320::init()
     dev->get_semaphore()->give();
 
     // request 50Hz update
-    dev->register_periodic_callback(20 * AP_USEC_PER_MSEC, FUNCTOR_BIND_MEMBER(&AP_Baro_FBM320::timer, void));
+    _register_staggered_callback(*dev, 20 * AP_USEC_PER_MSEC, FUNCTOR_BIND_MEMBER(&AP_Baro_FBM320::timer, void));
 
     return true;
 }
@@ -215,7 +215,7 @@ bool AP_Baro_ICM20789::init()
     debug("ICM20789: startup OK\n");
 
     // use 10ms to ensure we don't lose samples, with max lag of 10ms
-    dev->register_periodic_callback(CONVERSION_INTERVAL/2, FUNCTOR_BIND_MEMBER(&AP_Baro_ICM20789::timer, void));
+    _register_staggered_callback(*dev, CONVERSION_INTERVAL/2, FUNCTOR_BIND_MEMBER(&AP_Baro_ICM20789::timer, void));
 
     return true;
 
@@ -156,8 +156,8 @@ bool AP_Baro_KellerLD::_init()
 
     // Request 50Hz update
     // The sensor really struggles with any jitter in timing at 100Hz, and will sometimes start reading out all zeros
-    _dev->register_periodic_callback(20 * AP_USEC_PER_MSEC,
-                                     FUNCTOR_BIND_MEMBER(&AP_Baro_KellerLD::_timer, void));
+    _register_staggered_callback(*_dev, 20 * AP_USEC_PER_MSEC,
+                                 FUNCTOR_BIND_MEMBER(&AP_Baro_KellerLD::_timer, void));
     return true;
 }
 
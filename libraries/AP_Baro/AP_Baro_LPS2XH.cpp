@@ -182,7 +182,7 @@ bool AP_Baro_LPS2XH::_init()
 
     _dev->get_semaphore()->give();
 
-    _dev->register_periodic_callback(CallTime, FUNCTOR_BIND_MEMBER(&AP_Baro_LPS2XH::_timer, void));
+    _register_staggered_callback(*_dev, CallTime, FUNCTOR_BIND_MEMBER(&AP_Baro_LPS2XH::_timer, void));
 
     return true;
 }
@@ -223,6 +223,7 @@ void AP_Baro_LPS2XH::_timer(void)
 
     if (status & 0x01) {
         _update_pressure();
+        _notify_new_sample();
     }
 
     _has_sample = true;
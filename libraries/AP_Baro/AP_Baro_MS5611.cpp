@@ -146,8 +146,8 @@ bool AP_Baro_MS56XX::_init()
     _dev->get_semaphore()->give();
 
     /* Request 100Hz update */
-    _dev->register_periodic_callback(10 * AP_USEC_PER_MSEC,
-                                     FUNCTOR_BIND_MEMBER(&AP_Baro_MS56XX::_timer, void));
+    _register_staggered_callback(*_dev, 10 * AP_USEC_PER_MSEC,
+                                 FUNCTOR_BIND_MEMBER(&AP_Baro_MS56XX::_timer, void));
     return true;
 }
 
@@ -161,15 +161,6 @@ uint16_t AP_Baro_MS56XX::_read_prom_word(uint8_t word)
     return (val[0] << 8) | val[1];
 }
 
-uint32_t AP_Baro_MS56XX::_read_adc()
-{
-    uint8_t val[3];
-    if (!_dev->transfer(&CMD_MS56XX_READ_ADC, 1, val, sizeof(val))) {
-        return 0;
-    }
-    return (val[0] << 16) | (val[1] << 8) | val[2];
-}
-
 bool AP_Baro_MS56XX::_read_prom_5611(uint16_t prom[8])
 {
     /*
@@ -243,28 +234,26 @@ bool AP_Baro_MS56XX::_read_prom_5637(uint16_t prom[8])
 */
 void AP_Baro_MS56XX::_timer(void)
 {
-    uint8_t next_cmd;
-    uint8_t next_state;
-    uint32_t adc_val = _read_adc();
-
     /*
-     * If read fails, re-initiate a read command for current state or we are
-     * stuck
+     * Read the finished conversion and start the next one in a single
+     * batch, which is one syscall on Linux spidev. The next conversion is
+     * picked before the result is known: a failed read skips a state
+     * rather than repeating it, and the discard below drops its successor
      */
-    if (adc_val == 0) {
-        next_state = _state;
-    } else {
-        next_state = (_state + 1) % 5;
-    }
-
-    next_cmd = next_state == 0 ? ADDR_CMD_CONVERT_TEMPERATURE
-                               : ADDR_CMD_CONVERT_PRESSURE;
-    if (!_dev->transfer(&next_cmd, 1, nullptr, 0)) {
-        return;
-    }
+    const uint8_t next_state = (_state + 1) % 5;
+    const uint8_t next_cmd = next_state == 0 ? ADDR_CMD_CONVERT_TEMPERATURE
+                                             : ADDR_CMD_CONVERT_PRESSURE;
+    uint8_t val[3] {};
+    const AP_HAL::Device::Transfer transfers[] = {
+        { &CMD_MS56XX_READ_ADC, 1, val, sizeof(val) },
+        { &next_cmd, 1, nullptr, 0 },
+    };
+    const bool ok = _dev->transfer_batch(transfers, ARRAY_SIZE(transfers));
+    const uint32_t adc_val = ok ? (val[0] << 16) | (val[1] << 8) | val[2] : 0;
 
     /* if we had a failed read we are all done */
     if (adc_val == 0 || adc_val == 0xFFFFFF) {
+        _state = next_state;
         // a failed read can mean the next returned value will be
         // corrupt, we must discard it. This copes with MISO being
         // pulled either high or low
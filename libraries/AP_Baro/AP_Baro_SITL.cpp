@@ -116,6 +116,7 @@ void AP_Baro_SITL::_timer()
     _recent_press = p;
     _recent_temp = T;
     _has_sample = true;
+    _notify_new_sample();
 }
 
 // Read the sensor
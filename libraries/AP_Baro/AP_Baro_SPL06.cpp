@@ -142,7 +142,7 @@ bool AP_Baro_SPL06::_init()
 
     // request 50Hz update
     _timer_counter = -1;
-    _dev->register_periodic_callback(20 * AP_USEC_PER_MSEC, FUNCTOR_BIND_MEMBER(&AP_Baro_SPL06::_timer, void));
+    _register_staggered_callback(*_dev, 20 * AP_USEC_PER_MSEC, FUNCTOR_BIND_MEMBER(&AP_Baro_SPL06::_timer, void));
 
     return true;
 }
@@ -135,6 +135,7 @@ void AP_Baro_UAVCAN::handle_pressure(AP_UAVCAN* ap_uavcan, uint8_t node_id, cons
         WITH_SEMAPHORE(driver->_sem_baro);
         driver->_pressure = cb.msg->static_pressure;
         driver->new_pressure = true;
+        driver->_notify_new_sample();
     }
 }
 
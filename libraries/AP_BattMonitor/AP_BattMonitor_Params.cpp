@@ -169,6 +169,15 @@ const AP_Param::GroupInfo AP_BattMonitor_Params::var_info[] = {
     // @User: Standard
     AP_GROUPINFO("BUS", 20, AP_BattMonitor_Params, _i2c_bus, 0),
 
+    // @Param: SMB_BUDGET
+    // @DisplayName: SMBus battery bus time budget
+    // @Description: Time an SMBus battery may spend on the I2C bus in each read cycle. Voltage and current are read every cycle. Registers which change slowly, such as temperature, remaining capacity, serial number and cycle count, are read in turn in the remaining time, at least one each cycle. Lower values leave more of the bus to other sensors.
+    // @Units: us
+    // @Range: 0 20000
+    // @Increment: 100
+    // @User: Advanced
+    AP_GROUPINFO("SMB_BUDGET", 21, AP_BattMonitor_Params, _smbus_budget_us, 2000),
+
     AP_GROUPEND
 
 };
@@ -16,7 +16,7 @@ AP_BattMonitor_SMBus::AP_BattMonitor_SMBus(AP_BattMonitor &mon,
 void AP_BattMonitor_SMBus::init(void)
 {
     if (_dev) {
-        timer_handle = _dev->register_periodic_callback(100000, FUNCTOR_BIND_MEMBER(&AP_BattMonitor_SMBus::timer, void));
+        timer_handle = _dev->register_periodic_callback(AP_BATTMONITOR_SMBUS_PERIOD_MICROS, FUNCTOR_BIND_MEMBER(&AP_BattMonitor_SMBus::timer, void));
     }
 }
 
@@ -119,6 +119,102 @@ void AP_BattMonitor_SMBus::read_cycle_count()
     _has_cycle_count = read_word(BATTMONITOR_SMBUS_CYCLE_COUNT, _cycle_count);
 }
 
+// true if a slow register still needs a bus transfer
+bool AP_BattMonitor_SMBus::slow_register_wanted(SlowRegister r) const
+{
+    if ((_slow_mask & (1U<<uint8_t(r))) == 0) {
+        return false;
+    }
+    switch (r) {
+    case SlowRegister::TEMP:
+        return true;
+    case SlowRegister::REMAINING_CAPACITY:
+        return _params._pack_capacity > 0;
+    case SlowRegister::FULL_CHARGE_CAPACITY:
+        return _full_charge_capacity == 0;
+    case SlowRegister::SERIAL_NUMBER:
+        return _serial_number == -1;
+    case SlowRegister::CYCLE_COUNT:
+        return !_has_cycle_count;
+    case SlowRegister::NUM:
+        break;
+    }
+    return false;
+}
+
+/*
+  read the slow registers in turn within the bus time budget. Reading
+  them all each cycle would take several milliseconds of bus time per
+  battery, so the voltage and current could not be read as often
+ */
+void AP_BattMonitor_SMBus::read_slow_registers(uint32_t cycle_start_us)
+{
+    const uint32_t budget_us = MAX(_params._smbus_budget_us.get(), 0);
+    for (uint8_t n = 0; n < uint8_t(SlowRegister::NUM); n++) {
+        const SlowRegister r = SlowRegister(_slow_next);
+        _slow_next = (_slow_next + 1) % uint8_t(SlowRegister::NUM);
+        if (!slow_register_wanted(r)) {
+            continue;
+        }
+        switch (r) {
+        case SlowRegister::TEMP:
+            read_temp();
+            break;
+        case SlowRegister::REMAINING_CAPACITY:
+            read_remaining_capacity();
+            break;
+        case SlowRegister::FULL_CHARGE_CAPACITY:
+            read_full_charge_capacity();
+            break;
+        case SlowRegister::SERIAL_NUMBER:
+            read_serial_number();
+            break;
+        case SlowRegister::CYCLE_COUNT:
+            read_cycle_count();
+            break;
+        case SlowRegister::NUM:
+            break;
+        }
+        if (AP_HAL::micros() - cycle_start_us >= budget_us) {
+            break;
+        }
+    }
+}
+
+// read_block - returns number of characters read if successful, zero if unsuccessful
+uint8_t AP_BattMonitor_SMBus::read_block(uint8_t reg, uint8_t* data, uint8_t max_len) const
+{
+    // buffer to hold results (extra bytes returned holding length and PEC)
+    uint8_t buff[max_len + 1 + (_pec_supported ? 1 : 0)];
+
+    // read the length, data and PEC in one transfer. Bytes past the
+    // end of a shorter block are ignored
+    if (!_dev->read_registers(reg, buff, sizeof(buff))) {
+        return 0;
+    }
+
+    // get length
+    const uint8_t bufflen = buff[0];
+
+    // sanity check length returned by smbus
+    if (bufflen == 0 || bufflen > max_len) {
+        return 0;
+    }
+
+    // check PEC
+    if (_pec_supported) {
+        const uint8_t pec = get_PEC(AP_BATTMONITOR_SMBUS_I2C_ADDR, reg, true, buff, bufflen+1);
+        if (pec != buff[bufflen+1]) {
+            return 0;
+        }
+    }
+
+    // copy data (excluding PEC)
+    memcpy(data, &buff[1], bufflen);
+
+    return bufflen;
+}
+
 // read word from register
 // returns true if read was successful, false if failed
 bool AP_BattMonitor_SMBus::read_word(uint8_t reg, uint16_t& data) const
@@ -10,6 +10,7 @@
 #define AP_BATTMONITOR_SMBUS_BUS_EXTERNAL           1
 #define AP_BATTMONITOR_SMBUS_I2C_ADDR               0x0B
 #define AP_BATTMONITOR_SMBUS_TIMEOUT_MICROS         5000000 // sensor becomes unhealthy if no successful readings for 5 seconds
+#define AP_BATTMONITOR_SMBUS_PERIOD_MICROS          50000   // read cycle, voltage and current are read every cycle
 
 class AP_BattMonitor_SMBus : public AP_BattMonitor_Backend
 {
@@ -75,6 +76,30 @@ protected:
     // reads the battery's cycle count
     void read_cycle_count();
 
+    // registers which change slowly or are only read once. These are
+    // read in turn by read_slow_registers()
+    enum class SlowRegister : uint8_t {
+        TEMP = 0,
+        REMAINING_CAPACITY,
+        FULL_CHARGE_CAPACITY,
+        SERIAL_NUMBER,
+        CYCLE_COUNT,
+        NUM
+    };
+
+    // read slow registers in turn until the bus time used since
+    // cycle_start_us reaches the budget, reading at least one if any
+    // are still wanted
+    void read_slow_registers(uint32_t cycle_start_us);
+
+    // mask of SlowRegister values the battery supports
+    uint8_t _slow_mask = (1U<<uint8_t(SlowRegister::NUM)) - 1;
+
+    // read a block with its length byte, and PEC if supported, in a
+    // single transaction. Returns the number of bytes read, or zero on
+    // failure
+    uint8_t read_block(uint8_t reg, uint8_t* data, uint8_t max_len) const;
+
      // read word from register
      // returns true if read was successful, false if failed
     bool read_word(uint8_t reg, uint16_t& data) const;
@@ -95,6 +120,12 @@ protected:
     virtual void timer(void) = 0;   // timer function to read from the battery
 
     AP_HAL::Device::PeriodicHandle timer_handle;
+
+private:
+    // true if a slow register still needs a bus transfer
+    bool slow_register_wanted(SlowRegister r) const;
+
+    uint8_t _slow_next;             // next slow register to read
 };
 
 // include specific implementations
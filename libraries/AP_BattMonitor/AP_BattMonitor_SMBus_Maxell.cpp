@@ -77,16 +77,8 @@ void AP_BattMonitor_SMBus_Maxell::timer()
         _state.last_time_micros = tnow;
     }
 
-    read_full_charge_capacity();
-
     // FIXME: Perform current integration if the remaining capacity can't be requested
-    read_remaining_capacity();
-
-    read_temp();
-
-    read_serial_number();
-
-    read_cycle_count();
+    read_slow_registers(tnow);
 }
 
 // read_block - returns number of characters read if successful, zero if unsuccessful
@@ -14,6 +14,9 @@ AP_BattMonitor_SMBus_NeoDesign::AP_BattMonitor_SMBus_NeoDesign(AP_BattMonitor &m
     : AP_BattMonitor_SMBus(mon, mon_state, params, std::move(dev))
 {
     _pec_supported = true;
+    _slow_mask = (1U<<uint8_t(SlowRegister::TEMP)) |
+                 (1U<<uint8_t(SlowRegister::REMAINING_CAPACITY)) |
+                 (1U<<uint8_t(SlowRegister::FULL_CHARGE_CAPACITY));
 }
 
 void AP_BattMonitor_SMBus_NeoDesign::timer()
@@ -68,8 +71,6 @@ void AP_BattMonitor_SMBus_NeoDesign::timer()
         _state.last_time_micros = tnow;
     }
 
-    read_full_charge_capacity();
-    read_remaining_capacity();
-    read_temp();
+    read_slow_registers(tnow);
 }
 
@@ -24,13 +24,14 @@ AP_BattMonitor_SMBus_SUI::AP_BattMonitor_SMBus_SUI(AP_BattMonitor &mon,
 {
     _pec_supported = false;
     _dev->set_retries(2);
+    _slow_mask &= ~(1U<<uint8_t(SlowRegister::CYCLE_COUNT));
 }
 
 void AP_BattMonitor_SMBus_SUI::init(void)
 {
     AP_BattMonitor_SMBus::init();
     if (_dev && timer_handle) {
-        // run twice as fast for two phases
+        // each of the two phases needs 50ms, whatever the default period
         _dev->adjust_periodic_callback(timer_handle, 50000);
     }
 }
@@ -56,11 +57,7 @@ void AP_BattMonitor_SMBus_SUI::timer()
         _state.last_time_micros = tnow;
     }
 
-    read_full_charge_capacity();
-
-    read_temp();
-    read_serial_number();
-    read_remaining_capacity();
+    read_slow_registers(tnow);
     update_health();
 }
 
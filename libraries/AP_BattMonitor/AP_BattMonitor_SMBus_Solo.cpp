@@ -7,7 +7,7 @@
 
 #define BATTMONITOR_SMBUS_SOLO_CELL_VOLTAGE         0x28    // cell voltage register
 #define BATTMONITOR_SMBUS_SOLO_CURRENT              0x2a    // current register
-#define BATTMONITOR_SMBUS_SOLO_BUTTON_DEBOUNCE      6       // button held down for 5 intervals will cause a power off event
+#define BATTMONITOR_SMBUS_SOLO_BUTTON_DEBOUNCE_MS   600     // button held down for this long will cause a power off event
 #define BATTMONITOR_SMBUS_SOLO_NUM_CELLS            4       // solo's battery pack is 4S
 
 /*
@@ -40,7 +40,7 @@ void AP_BattMonitor_SMBus_Solo::timer()
 
 
     // read cell voltages
-    if (read_block(BATTMONITOR_SMBUS_SOLO_CELL_VOLTAGE, buff, 8, false)) {
+    if (read_block(BATTMONITOR_SMBUS_SOLO_CELL_VOLTAGE, buff, 8)) {
         float pack_voltage_mv = 0.0f;
         for (uint8_t i = 0; i < BATTMONITOR_SMBUS_SOLO_NUM_CELLS; i++) {
             uint16_t cell = buff[(i * 2) + 1] << 8 | buff[i * 2];
@@ -66,19 +66,16 @@ void AP_BattMonitor_SMBus_Solo::timer()
     }
 
     // read current
-    if (read_block(BATTMONITOR_SMBUS_SOLO_CURRENT, buff, 4, false) == 4) {
+    if (read_block(BATTMONITOR_SMBUS_SOLO_CURRENT, buff, 4) == 4) {
         _state.current_amps = -(float)((int32_t)((uint32_t)buff[3]<<24 | (uint32_t)buff[2]<<16 | (uint32_t)buff[1]<<8 | (uint32_t)buff[0])) / 1000.0f;
         _state.last_time_micros = tnow;
     }
 
-    read_full_charge_capacity();
-    read_remaining_capacity();
-
     // read the button press indicator
-    if (read_block(BATTMONITOR_SMBUS_MANUFACTURE_DATA, buff, 6, false) == 6) {
+    if (read_block(BATTMONITOR_SMBUS_MANUFACTURE_DATA, buff, 6) == 6) {
         bool pressed = (buff[1] >> 3) & 0x01;
 
-        if (_button_press_count >= BATTMONITOR_SMBUS_SOLO_BUTTON_DEBOUNCE) {
+        if (_button_press_count >= BATTMONITOR_SMBUS_SOLO_BUTTON_DEBOUNCE_MS / (AP_BATTMONITOR_SMBUS_PERIOD_MICROS / 1000)) {
             // vehicle will power off, set state flag
             _state.is_powering_off = true;
         } else if (pressed) {
@@ -90,45 +87,5 @@ void AP_BattMonitor_SMBus_Solo::timer()
         }
     }
 
-    read_temp();
-
-    read_serial_number();
-
-    read_cycle_count();
-}
-
-// read_block - returns number of characters read if successful, zero if unsuccessful
-uint8_t AP_BattMonitor_SMBus_Solo::read_block(uint8_t reg, uint8_t* data, uint8_t max_len, bool append_zero) const
-{
-    uint8_t buff[max_len+2];    // buffer to hold results (2 extra byte returned holding length and PEC)
-
-    // read bytes
-    if (!_dev->read_registers(reg, buff, sizeof(buff))) {
-        return 0;
-    }
-
-    // get length
-    uint8_t bufflen = buff[0];
-
-    // sanity check length returned by smbus
-    if (bufflen == 0 || bufflen > max_len) {
-        return 0;
-    }
-
-    // check PEC
-    uint8_t pec = get_PEC(AP_BATTMONITOR_SMBUS_I2C_ADDR, reg, true, buff, bufflen+1);
-    if (pec != buff[bufflen+1]) {
-        return 0;
-    }
-
-    // copy data (excluding PEC)
-    memcpy(data, &buff[1], bufflen);
-
-    // optionally add zero to end
-    if (append_zero) {
-        data[bufflen] = '\0';
-    }
-
-    // return success
-    return bufflen;
+    read_slow_registers(tnow);
 }
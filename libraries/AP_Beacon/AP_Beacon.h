@@ -23,7 +23,10 @@
 
 class AP_Beacon_Backend;
 
-#define AP_BEACON_MAX_BEACONS 4
+// the EKF keeps per-beacon state for at most 10 beacons
+#ifndef AP_BEACON_MAX_BEACONS
+#define AP_BEACON_MAX_BEACONS 10
+#endif
 #define AP_BEACON_TIMEOUT_MS 300
 #define AP_BEACON_MINIMUM_FENCE_BEACONS 3
 
@@ -80,7 +80,7 @@ const AP_Param::GroupInfo AP_Camera::var_info[] = {
 
     // @Param: FEEDBACK_PIN
     // @DisplayName: Camera feedback pin
-    // @Description: pin number to use for save accurate camera feedback messages. If set to -1 then don't use a pin flag for this, otherwise this is a pin number which if held high after a picture trigger order, will save camera messages when camera really takes a picture. A universal camera hot shoe is needed. The pin should be held high for at least 2 milliseconds for reliable trigger detection. See also the CAM_FEEDBACK_POL option.
+    // @Description: pin number to use for save accurate camera feedback messages. If set to -1 then don't use a pin flag for this, otherwise this is a pin number which if held high after a picture trigger order, will save camera messages when camera really takes a picture. A universal camera hot shoe is needed. The pin should be held high for at least 2 milliseconds for reliable trigger detection. Each capture is also logged in a CAMP message with the position, velocity and attitude interpolated to the capture time. See also the CAM_FEEDBACK_POL option.
     // @Values: -1:Disabled,50:AUX1,51:AUX2,52:AUX3,53:AUX4,54:AUX5,55:AUX6
     // @User: Standard
     // @RebootRequired: True
@@ -385,6 +385,73 @@ void AP_Camera::feedback_pin_isr(uint8_t pin, bool high, uint32_t timestamp_us)
 {
     _feedback_timestamp_us = timestamp_us;
     _camera_trigger_count++;
+    queue_capture(timestamp_us);
+}
+
+/*
+  queue a capture time to be logged with the AHRS state at that time.
+  If the queue is full the capture is only logged in the CAM message
+ */
+void AP_Camera::queue_capture(uint32_t timestamp_us)
+{
+    const uint8_t head = _captures.head;
+    const uint8_t next = (head + 1) & (AP_CAMERA_CAPTURE_QUEUE_LEN - 1);
+    if (next == _captures.tail) {
+        return;
+    }
+    _captures.time_us[head] = timestamp_us;
+    _captures.head = next;
+}
+
+/*
+  log the AHRS state at each queued capture time, interpolated between
+  the AHRS updates either side of it. Captures newer than the last
+  AHRS update wait for the next one
+ */
+void AP_Camera::log_captures()
+{
+    AP_Logger *logger = AP_Logger::get_singleton();
+    const AP_AHRS &ahrs = AP::ahrs();
+    while (_captures.tail != _captures.head) {
+        const uint8_t tail = _captures.tail;
+        const uint32_t capture_us = _captures.time_us[tail];
+        const uint32_t age_us = AP_HAL::micros() - capture_us;
+        AP_AHRS::StateSample state;
+        const bool interpolated = ahrs.get_state_at(capture_us, state);
+        if (!interpolated && age_us < 100000) {
+            // no AHRS update after the capture yet
+            break;
+        }
+        _captures.tail = (tail + 1) & (AP_CAMERA_CAPTURE_QUEUE_LEN - 1);
+        _captures.count++;
+        if (logger == nullptr || !logger->should_log(log_camera_bit)) {
+            continue;
+        }
+        if (!interpolated) {
+            // the capture is older than the history, use the current state
+            state.lat = current_loc.lat;
+            state.lng = current_loc.lng;
+            state.alt_cm = current_loc.alt;
+            state.velocity_NED.zero();
+            IGNORE_RETURN(ahrs.get_velocity_NED(state.velocity_NED));
+            state.roll = ahrs.roll;
+            state.pitch = ahrs.pitch;
+            state.yaw = ahrs.yaw;
+        }
+        logger->Write("CAMP", "TimeUS,N,Lat,Lng,Alt,VN,VE,VD,Roll,Pitch,Yaw,I", "QHLLiffffffB",
+                      AP_HAL::micros64() - age_us,
+                      _captures.count,
+                      state.lat,
+                      state.lng,
+                      state.alt_cm,
+                      (double)state.velocity_NED.x,
+                      (double)state.velocity_NED.y,
+                      (double)state.velocity_NED.z,
+                      (double)degrees(state.roll),
+                      (double)degrees(state.pitch),
+                      (double)wrap_360(degrees(state.yaw)),
+                      uint8_t(interpolated));
+    }
 }
 
 /*
@@ -399,6 +466,7 @@ void AP_Camera::feedback_pin_timer(void)
         _last_pin_state != trigger_polarity) {
         _feedback_timestamp_us = AP_HAL::micros();
         _camera_trigger_count++;
+        queue_capture(_feedback_timestamp_us);
     }
     _last_pin_state = pin_state;
 }
@@ -414,6 +482,9 @@ void AP_Camera::setup_feedback_callback(void)
         return;
     }
 
+    // keep the AHRS states needed to find the state at each capture
+    _history_enabled = AP::ahrs().enable_history();
+
     // ensure we are in input mode
     hal.gpio->pinMode(_feedback_pin, HAL_GPIO_INPUT);
 
@@ -472,7 +543,11 @@ void AP_Camera::take_picture()
 void AP_Camera::update_trigger()
 {
     trigger_pic_cleanup();
-    
+
+    if (_history_enabled) {
+        log_captures();
+    }
+
     if (_camera_trigger_logged != _camera_trigger_count) {
         uint32_t timestamp32 = _feedback_timestamp_us;
         _camera_trigger_logged = _camera_trigger_count;
@@ -11,6 +11,7 @@
 #define AP_CAMERA_SERVO_OFF_PWM             1100    // default PWM value to move servo to when shutter is deactivated
 
 #define AP_CAMERA_FEEDBACK_DEFAULT_FEEDBACK_PIN -1  // default is to not use camera feedback pin
+#define AP_CAMERA_CAPTURE_QUEUE_LEN 8               // captures waiting to be logged, must be a power of 2
 
 /// @class	Camera
 /// @brief	Object managing a Photo or video camera
@@ -124,6 +125,20 @@ private:
     bool            _isr_installed;
     uint8_t         _last_pin_state;
 
+    // capture times from the feedback pin waiting for the AHRS state
+    // after them. Filled by the interrupt or timer, emptied by
+    // update_trigger()
+    struct {
+        uint32_t time_us[AP_CAMERA_CAPTURE_QUEUE_LEN];
+        volatile uint8_t head;
+        volatile uint8_t tail;
+        uint16_t count;         // captures taken off the queue since boot
+    } _captures;
+    bool            _history_enabled;
+
+    void queue_capture(uint32_t timestamp_us);
+    void log_captures();
+
     void log_picture();
 
     uint32_t log_camera_bit;
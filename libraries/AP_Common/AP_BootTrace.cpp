@@ -0,0 +1,56 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_BootTrace.h"
+
+#include <AP_HAL/AP_HAL.h>
+
+const char *AP_BootTrace::_name[AP_BOOTTRACE_MAX_STAGES];
+// the start of each stage, followed by the end of the last one
+uint32_t AP_BootTrace::_start_us[AP_BOOTTRACE_MAX_STAGES+1];
+uint8_t AP_BootTrace::_num_stages;
+bool AP_BootTrace::_finished;
+
+void AP_BootTrace::stage(const char *name)
+{
+    if (_finished || _num_stages >= AP_BOOTTRACE_MAX_STAGES) {
+        return;
+    }
+    _name[_num_stages] = name;
+    _start_us[_num_stages] = AP_HAL::micros();
+    _num_stages++;
+}
+
+void AP_BootTrace::finish()
+{
+    if (_finished) {
+        return;
+    }
+    _start_us[_num_stages] = AP_HAL::micros();
+    _finished = true;
+}
+
+bool AP_BootTrace::get_stage(uint8_t i, Stage &s)
+{
+    if (i >= _num_stages) {
+        return false;
+    }
+    s.name = _name[i];
+    s.start_us = _start_us[i];
+    // the last stage is still running until finish() is called
+    const uint32_t end_us = (i+1 < _num_stages || _finished) ? _start_us[i+1] : AP_HAL::micros();
+    s.duration_us = end_us - s.start_us;
+    return true;
+}
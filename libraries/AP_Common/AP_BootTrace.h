@@ -0,0 +1,59 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  record of how long each stage of the vehicle's init took. The
+  vehicle marks the start of each stage with stage(), which also ends
+  the previous one, and calls finish() once it is ready. Stages are
+  only recorded from the main thread while booting
+ */
+
+#include <stdint.h>
+
+#ifndef AP_BOOTTRACE_MAX_STAGES
+#define AP_BOOTTRACE_MAX_STAGES 32
+#endif
+
+class AP_BootTrace {
+public:
+    struct Stage {
+        const char *name;
+        uint32_t start_us;
+        uint32_t duration_us;
+    };
+
+    // start a new stage, ending the previous one. name must be a
+    // string constant
+    static void stage(const char *name);
+
+    // end the last stage. No more stages are recorded after this
+    static void finish();
+
+    // true once finish() has been called
+    static bool finished() { return _finished; }
+
+    // number of stages recorded
+    static uint8_t num_stages() { return _num_stages; }
+
+    // get a recorded stage, returns false if there is no such stage
+    static bool get_stage(uint8_t i, Stage &s);
+
+private:
+    static const char *_name[AP_BOOTTRACE_MAX_STAGES];
+    static uint32_t _start_us[AP_BOOTTRACE_MAX_STAGES+1];
+    static uint8_t _num_stages;
+    static bool _finished;
+};
@@ -70,3 +70,17 @@ bool hex_to_uint8(uint8_t a, uint8_t &res)
     }
     return true;
 }
+
+/*
+  strncpy without the warning for not leaving room for nul
+  termination, for fixed width fields which don't need one
+ */
+void strncpy_noterm(char *dest, const char *src, size_t n)
+{
+    size_t len = strnlen(src, n);
+    if (len < n) {
+        // include the nul terminator
+        len++;
+    }
+    memcpy(dest, src, len);
+}
@@ -20,32 +20,87 @@ extern const AP_HAL::HAL& hal;
 
 AP_ExpandingArrayGeneric::~AP_ExpandingArrayGeneric(void)
 {
-    // free chunks
+    // free chunks, slabs are freed through their first chunk
     for (uint16_t i=0; i<chunk_count; i++) {
-        free(chunk_ptrs[i]);
+        if (!in_slab_tail(i)) {
+            free(chunk_ptrs[i]);
+        }
     }
     // free chunks_ptrs array
     free(chunk_ptrs);
 }
 
+// true if chunk is part of a slab but not the start of it
+bool AP_ExpandingArrayGeneric::in_slab_tail(uint16_t chunk) const
+{
+    for (uint8_t i=0; i<slab_count; i++) {
+        if (chunk > slabs[i].start && chunk < slabs[i].start + slabs[i].count) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// true if adding num_chunks would exceed items_limit
+bool AP_ExpandingArrayGeneric::over_limit(uint16_t num_chunks) const
+{
+    if (items_limit == 0) {
+        return false;
+    }
+    // the last chunk may be partly beyond the limit
+    const uint32_t chunks_max = (uint32_t(items_limit) + chunk_size - 1) / chunk_size;
+    return uint32_t(chunk_count) + num_chunks > chunks_max;
+}
+
+// make room for num_chunks more pointers in chunk_ptrs, returns true on success
+bool AP_ExpandingArrayGeneric::expand_chunk_ptrs(uint16_t num_chunks)
+{
+    const uint32_t chunks_needed = uint32_t(chunk_count) + num_chunks;
+    if (chunks_needed <= chunk_count_max) {
+        return true;
+    }
+    if (chunks_needed > UINT16_MAX) {
+        return false;
+    }
+
+    // at least double the array each time so the number of
+    // re-allocations grows with the log of the array size
+    uint32_t chunk_ptr_size = uint32_t(chunk_count_max) * 2;
+    if (chunk_ptr_size < chunks_needed) {
+        chunk_ptr_size = chunks_needed;
+    }
+    if (chunk_ptr_size < chunk_ptr_increment) {
+        chunk_ptr_size = chunk_ptr_increment;
+    }
+    if (chunk_ptr_size > UINT16_MAX) {
+        chunk_ptr_size = UINT16_MAX;
+    }
+    if (hal.util->available_memory() < 100U + (chunk_ptr_size * sizeof(chunk_ptr_t))) {
+        // fail if reallocating would leave less than 100 bytes of memory free
+        return false;
+    }
+    chunk_ptr_t *chunk_ptrs_new = (chunk_ptr_t*)hal.util->std_realloc((void*)chunk_ptrs, chunk_ptr_size * sizeof(chunk_ptr_t));
+    if (chunk_ptrs_new == nullptr) {
+        return false;
+    }
+    allocs++;
+
+    // use new pointers array
+    chunk_ptrs = chunk_ptrs_new;
+    chunk_count_max = chunk_ptr_size;
+    return true;
+}
+
 // expand the array by specified number of chunks, returns true on success
 bool AP_ExpandingArrayGeneric::expand(uint16_t num_chunks)
 {
-    // expand chunk_ptrs array if necessary
-    if (chunk_count + num_chunks >= chunk_count_max) {
-        uint16_t chunk_ptr_size = chunk_count + num_chunks + chunk_ptr_increment;
-        if (hal.util->available_memory() < 100U + (chunk_ptr_size * sizeof(chunk_ptr_t))) {
-            // fail if reallocating would leave less than 100 bytes of memory free
-            return false;
-        }
-        chunk_ptr_t *chunk_ptrs_new = (chunk_ptr_t*)hal.util->std_realloc((void*)chunk_ptrs, chunk_ptr_size * sizeof(chunk_ptr_t));
-        if (chunk_ptrs_new == nullptr) {
-            return false;
-        }
+    if (over_limit(num_chunks)) {
+        return false;
+    }
 
-        // use new pointers array
-        chunk_ptrs = chunk_ptrs_new;
-        chunk_count_max = chunk_ptr_size;
+    // expand chunk_ptrs array if necessary
+    if (!expand_chunk_ptrs(num_chunks)) {
+        return false;
     }
 
     // allocate new chunks
@@ -59,6 +114,7 @@ bool AP_ExpandingArrayGeneric::expand(uint16_t num_chunks)
             // failed to allocate new chunk
             return false;
         }
+        allocs++;
         chunk_ptrs[chunk_count] = new_chunk;
         chunk_count++;
     }
@@ -75,3 +131,44 @@ bool AP_ExpandingArrayGeneric::expand_to_hold(uint16_t num_items)
     uint16_t chunks_required = ((num_items - max_items()) / chunk_size) + 1;
     return expand(chunks_required);
 }
+
+// allocate space for at least num_items as a single slab, returns true on success
+bool AP_ExpandingArrayGeneric::reserve(uint16_t num_items)
+{
+    // check if already big enough
+    if (num_items <= max_items()) {
+        return true;
+    }
+    const uint16_t chunks_required = (num_items - max_items() + chunk_size - 1) / chunk_size;
+    if (slab_count >= slabs_max || chunks_required == 1) {
+        // no slab needed, or no room to record another
+        return expand(chunks_required);
+    }
+    if (over_limit(chunks_required)) {
+        return false;
+    }
+    if (!expand_chunk_ptrs(chunks_required)) {
+        return false;
+    }
+
+    const uint32_t chunk_bytes = uint32_t(chunk_size) * elem_size;
+    const uint32_t slab_bytes = chunk_bytes * chunks_required;
+    if (hal.util->available_memory() < 100U + slab_bytes) {
+        // fail if allocating would leave less than 100 bytes of memory free
+        return false;
+    }
+    uint8_t *slab = (uint8_t *)calloc(chunks_required, chunk_bytes);
+    if (slab == nullptr) {
+        return false;
+    }
+    allocs++;
+
+    slabs[slab_count].start = chunk_count;
+    slabs[slab_count].count = chunks_required;
+    slab_count++;
+    for (uint16_t i = 0; i < chunks_required; i++) {
+        chunk_ptrs[chunk_count] = &slab[i * chunk_bytes];
+        chunk_count++;
+    }
+    return true;
+}
@@ -27,10 +27,15 @@
  *
  * When the array is expanded up to two memory allocations are required:
  *    1. if the chunk_ptrs array (which holds points to all allocated chunks) is full, this array will be re-allocated.
- *       During this operation a new copy of the chunk_ptr array will be created with "chunk_ptr_increment" more rows,
+ *       During this operation a new copy of the chunk_ptr array will be created with at least twice as many rows,
  *       the old array's data will be copied to the new array and finally the old array will be freed.
  *    2. a new chunk will be allocated and a pointer to this new chunk will be added to the chunk_ptrs array
  *
+ * The "reserve" function allocates all the chunks needed to hold a given number of elements as a single "slab"
+ * (plus at most one re-allocation of chunk_ptrs), so users which know their worst case can allocate it up front
+ * rather than while running. "set_max_items" limits how far the array may grow, so a bad input fails cleanly
+ * rather than using all free memory.
+ *
  * Warnings:
  *    1. memset, memcpy, memcmp cannot be used because the individual elements are not guaranteed to be next to each other in memory
  *    2. operator[] functions do not perform any range checking so max_items() should be used when necessary to avoid out-of-bound memory access
@@ -65,17 +70,55 @@ public:
     // expand to hold at least num_items
     bool expand_to_hold(uint16_t num_items);
 
+    // allocate space for at least num_items in a single allocation,
+    // so expand_to_hold(num_items) will not need to allocate. Returns
+    // true on success
+    bool reserve(uint16_t num_items);
+
+    // limit the number of items the array may hold, 0 for no limit.
+    // Expansion beyond the limit fails
+    void set_max_items(uint16_t num_items) { items_limit = num_items; }
+
+    // bytes allocated for elements and chunk pointers
+    uint32_t mem_used() const {
+        return uint32_t(chunk_count) * chunk_size * elem_size + uint32_t(chunk_count_max) * sizeof(chunk_ptr_t);
+    }
+
+    // number of memory allocations made by the array
+    uint16_t alloc_count() const { return allocs; }
+
 protected:
 
     const uint16_t elem_size;   // number of bytes for each element
     const uint16_t chunk_size;  // the number of T elements in each chunk
-    const uint16_t chunk_ptr_increment = 32;    // chunk_ptrs array is grown by this many elements each time it fills
+    const uint16_t chunk_ptr_increment = 32;    // minimum number of elements in chunk_ptrs array
 
     typedef uint8_t* chunk_ptr_t;   // pointer to a chunk
 
-    chunk_ptr_t *chunk_ptrs;    // array of pointers to allocated chunks
-    uint16_t chunk_count_max;   // number of elements in chunk_ptrs array
-    uint16_t chunk_count;       // number of allocated chunks
+    chunk_ptr_t *chunk_ptrs = nullptr;  // array of pointers to allocated chunks
+    uint16_t chunk_count_max = 0;   // number of elements in chunk_ptrs array
+    uint16_t chunk_count = 0;       // number of allocated chunks
+
+private:
+
+    // true if adding num_chunks would exceed items_limit
+    bool over_limit(uint16_t num_chunks) const;
+
+    // make room for num_chunks more pointers in chunk_ptrs
+    bool expand_chunk_ptrs(uint16_t num_chunks);
+
+    // true if chunk is part of a slab but not the start of it, so is
+    // not freed on its own
+    bool in_slab_tail(uint16_t chunk) const;
+
+    static const uint8_t slabs_max = 4;
+    struct {
+        uint16_t start;         // first chunk of slab
+        uint16_t count;         // number of chunks in slab
+    } slabs[slabs_max] {};
+    uint8_t slab_count = 0;     // number of slabs allocated by reserve
+    uint16_t items_limit = 0;   // maximum number of items, zero for no limit
+    uint16_t allocs = 0;        // number of allocations made
 };
 
 template <typename T>
@@ -0,0 +1,159 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  weighted fair queue for a telemetry link that sends one item in each
+  slot it is given, such as FrSky passthrough which gets a slot each
+  time the receiver polls it. Each slot goes to the ready item that
+  has waited longest relative to its weight, so an item with half the
+  weight of another gets twice its share of the slots. An item can
+  have a minimum period to keep fast links from resending it too
+  often, but when every ready item is within its minimum period the
+  slot goes to the most overdue of them rather than being wasted.
+
+  The rate slots are given at is measured, and for each item the
+  number of times it was sent and the longest time it went unsent are
+  recorded, which is the worst age of that data at the other end
+ */
+
+#include <stdint.h>
+
+template <uint8_t N>
+class AP_WFQ_Scheduler {
+public:
+    static_assert(N <= 32, "ready mask is 32 bits");
+
+    // set the weight of an item, smaller weights are sent more often
+    void set_weight(uint8_t idx, uint16_t weight) {
+        if (idx < N) {
+            _item[idx].weight = weight > 0 ? weight : 1;
+        }
+    }
+
+    // set the shortest time between sends of an item
+    void set_min_period(uint8_t idx, uint16_t min_period_ms) {
+        if (idx < N) {
+            _item[idx].min_period_ms = min_period_ms;
+        }
+    }
+
+    // make an item the most overdue, so it is sent in the next slot
+    // it is ready for
+    void expedite(uint8_t idx) {
+        if (idx < N) {
+            _item[idx].timer_ms -= 10000;
+        }
+    }
+
+    /*
+      choose the item to send in a slot starting at now_ms, from the
+      items with their bit set in ready_mask. Returns the index of the
+      item, which is then treated as sent, or -1 if none is ready
+     */
+    int8_t select(uint32_t now_ms, uint32_t ready_mask) {
+        update_slot_rate(now_ms);
+
+        int8_t best = -1;
+        float best_delay = 0;
+        int8_t best_limited = -1;
+        float best_limited_delay = 0;
+        for (uint8_t i = 0; i < N; i++) {
+            if ((ready_mask & (1U << i)) == 0) {
+                continue;
+            }
+            const uint32_t waited_ms = now_ms - _item[i].timer_ms;
+            // normalise the time waited by the weight. Use >= so that
+            // with equal delays the later, less frequent, item wins
+            const float delay = waited_ms / float(_item[i].weight);
+            if (waited_ms >= _item[i].min_period_ms) {
+                if (delay >= best_delay) {
+                    best_delay = delay;
+                    best = i;
+                }
+            } else if (delay >= best_limited_delay) {
+                best_limited_delay = delay;
+                best_limited = i;
+            }
+        }
+        if (best < 0) {
+            best = best_limited;
+        }
+        if (best >= 0) {
+            sent(best, now_ms);
+        }
+        return best;
+    }
+
+    // slots given to us per second, averaged over a few seconds
+    float get_slot_rate() const { return _slot_rate; }
+
+    struct ItemStats {
+        uint32_t sent;          // number of times the item was sent
+        uint32_t age_ms;        // time since it was last sent
+        uint32_t max_age_ms;    // longest time between sends
+    };
+
+    // statistics for an item, returns false if there is no such item
+    bool get_stats(uint8_t idx, uint32_t now_ms, ItemStats &stats) const {
+        if (idx >= N) {
+            return false;
+        }
+        const Item &item = _item[idx];
+        stats.sent = item.sent;
+        stats.age_ms = item.sent ? now_ms - item.last_sent_ms : 0;
+        stats.max_age_ms = item.max_age_ms;
+        return true;
+    }
+
+private:
+    struct Item {
+        uint16_t weight = 1;
+        uint16_t min_period_ms;
+        uint32_t timer_ms;          // when the item was last scheduled, moved back by expedite()
+        uint32_t last_sent_ms;
+        uint32_t max_age_ms;
+        uint32_t sent;
+    } _item[N] {};
+
+    void sent(uint8_t idx, uint32_t now_ms) {
+        Item &item = _item[idx];
+        if (item.sent > 0 && now_ms - item.last_sent_ms > item.max_age_ms) {
+            item.max_age_ms = now_ms - item.last_sent_ms;
+        }
+        item.timer_ms = now_ms;
+        item.last_sent_ms = now_ms;
+        item.sent++;
+    }
+
+    void update_slot_rate(uint32_t now_ms) {
+        _slot_count++;
+        if (now_ms - _slot_count_start_ms < 1000) {
+            return;
+        }
+        const float rate = _slot_count * 1000.0f / (now_ms - _slot_count_start_ms);
+        if (_slot_rate <= 0) {
+            _slot_rate = rate;
+        } else {
+            _slot_rate = _slot_rate * 0.75f + rate * 0.25f;
+        }
+        _slot_count_start_ms = now_ms;
+        _slot_count = 0;
+    }
+
+    float _slot_rate = 0;
+    uint32_t _slot_count_start_ms = 0;
+    uint32_t _slot_count = 0;
+};
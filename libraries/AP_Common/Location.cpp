@@ -274,6 +274,42 @@ float Location::longitude_scale() const
     return MAX(scale, 0.01f);
 }
 
+void LocationFrame::set_origin(const Location &origin)
+{
+    _origin = origin;
+    const float scale = origin.longitude_scale();
+    _lng_to_m = Location::LOCATION_SCALING_FACTOR * scale;
+    _m_to_lng = Location::LOCATION_SCALING_FACTOR_INV / scale;
+}
+
+Vector3f LocationFrame::get_distance_NED(const Location &loc) const
+{
+    const Vector2f ne = get_distance_NE(loc);
+    return Vector3f(ne.x, ne.y, (_origin.alt - loc.alt) * 0.01f);
+}
+
+void LocationFrame::get_distance_NE(const Location *locs, Vector2f *ne, uint16_t count) const
+{
+    for (uint16_t i = 0; i < count; i++) {
+        ne[i] = get_distance_NE(locs[i]);
+    }
+}
+
+void LocationFrame::offset(Location &loc, float ofs_north, float ofs_east) const
+{
+    if (!is_equal(ofs_north, 0.0f) || !is_equal(ofs_east, 0.0f)) {
+        loc.lat += (int32_t)(ofs_north * Location::LOCATION_SCALING_FACTOR_INV);
+        loc.lng += (int32_t)(ofs_east * _m_to_lng);
+    }
+}
+
+Location LocationFrame::get_location_NE(const Vector2f &ne) const
+{
+    Location loc = _origin;
+    offset(loc, ne.x, ne.y);
+    return loc;
+}
+
 /*
  * convert invalid waypoint with useful data. return true if location changed
  */
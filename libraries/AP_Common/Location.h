@@ -117,6 +117,8 @@ public:
     bool initialised() const { return (lat !=0 || lng != 0 || alt != 0); }
 
 private:
+    friend class LocationFrame;
+
     static AP_Terrain *_terrain;
 
     // scaling factor from 1e-7 degrees to meters at equator
@@ -125,3 +127,51 @@ private:
     // inverse of LOCATION_SCALING_FACTOR
     static constexpr float LOCATION_SCALING_FACTOR_INV = 89.83204953368922f;
 };
+
+/*
+  a local north/east frame around an origin location. The origin's
+  longitude scaling is calculated once, so converting many locations
+  near the origin to offsets (or back) costs no trig calls.
+
+  All results use the origin's longitude scale, so they match the
+  Location methods called on the origin, e.g. get_distance_NE(loc)
+  matches origin.get_distance_NE(loc).
+ */
+class LocationFrame
+{
+public:
+    LocationFrame() {}
+    explicit LocationFrame(const Location &origin) { set_origin(origin); }
+
+    // set the origin, recalculating the cached scale factors
+    void set_origin(const Location &origin);
+    const Location &get_origin() const { return _origin; }
+
+    // return the distance in meters in North/East plane as a N/E vector from the origin to loc
+    Vector2f get_distance_NE(const Location &loc) const {
+        return Vector2f((loc.lat - _origin.lat) * Location::LOCATION_SCALING_FACTOR,
+                        (loc.lng - _origin.lng) * _lng_to_m);
+    }
+
+    // return the distance in meters in North/East/Down plane as a N/E/D vector from the origin to loc
+    Vector3f get_distance_NED(const Location &loc) const;
+
+    // return horizontal distance in meters from the origin to loc
+    float get_distance(const Location &loc) const { return get_distance_NE(loc).length(); }
+
+    // convert count locations to N/E offsets in meters from the origin
+    void get_distance_NE(const Location *locs, Vector2f *ne, uint16_t count) const;
+
+    // extrapolate the latitude/longitude of loc, which should be
+    // near the origin, given distances (in meters) north and east
+    void offset(Location &loc, float ofs_north, float ofs_east) const;
+
+    // return the origin offset by a N/E vector in meters
+    Location get_location_NE(const Vector2f &ne) const;
+
+private:
+    Location _origin;
+    // 1e-7 degrees of longitude to meters at the origin's latitude, and back
+    float _lng_to_m = Location::LOCATION_SCALING_FACTOR;
+    float _m_to_lng = Location::LOCATION_SCALING_FACTOR_INV;
+};
@@ -0,0 +1,66 @@
+#include <AP_gtest.h>
+
+#include <AP_Common/AP_ExpandingArray.h>
+#include <AP_HAL/AP_HAL.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+TEST(ExpandingArrayTest, ExpandToHold)
+{
+    AP_ExpandingArray<uint32_t> arr(16);
+    EXPECT_EQ(arr.max_items(), 0U);
+    EXPECT_TRUE(arr.expand_to_hold(1));
+    EXPECT_EQ(arr.max_items(), 16U);
+    EXPECT_TRUE(arr.expand_to_hold(40));
+    EXPECT_EQ(arr.max_items(), 48U);
+    for (uint16_t i = 0; i < 40; i++) {
+        arr[i] = i * 3;
+    }
+    for (uint16_t i = 0; i < 40; i++) {
+        EXPECT_EQ(arr[i], i * 3U);
+    }
+}
+
+TEST(ExpandingArrayTest, Reserve)
+{
+    AP_ExpandingArray<uint16_t> arr(8);
+
+    // one allocation for the chunk pointers and one for the slab
+    EXPECT_TRUE(arr.reserve(100));
+    EXPECT_EQ(arr.max_items(), 104U);
+    EXPECT_EQ(arr.alloc_count(), 2U);
+
+    // nothing more to allocate up to the reserved size
+    EXPECT_TRUE(arr.expand_to_hold(104));
+    EXPECT_EQ(arr.alloc_count(), 2U);
+
+    // growing past it still works, and the slab and the new chunks
+    // are all usable
+    EXPECT_TRUE(arr.expand_to_hold(200));
+    for (uint16_t i = 0; i < 200; i++) {
+        arr[i] = i;
+    }
+    for (uint16_t i = 0; i < 200; i++) {
+        EXPECT_EQ(arr[i], i);
+    }
+    EXPECT_GE(arr.mem_used(), 200U * sizeof(uint16_t));
+}
+
+TEST(ExpandingArrayTest, MaxItems)
+{
+    AP_ExpandingArray<uint8_t> arr(10);
+    arr.set_max_items(25);
+
+    EXPECT_TRUE(arr.expand_to_hold(25));
+    EXPECT_EQ(arr.max_items(), 30U);
+    EXPECT_FALSE(arr.expand_to_hold(31));
+    EXPECT_FALSE(arr.reserve(100));
+    EXPECT_EQ(arr.max_items(), 30U);
+
+    // no limit
+    arr.set_max_items(0);
+    EXPECT_TRUE(arr.reserve(100));
+    EXPECT_EQ(arr.max_items(), 100U);
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,69 @@
+#include <AP_gtest.h>
+
+#include <AP_Common/Location.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const Location origins[] = {
+    Location(-353632621, 1491652374, 58400, Location::AltFrame::ABSOLUTE),
+    Location(0, 0, 0, Location::AltFrame::ABSOLUTE),
+    Location(784300000, 159000000, 1000, Location::AltFrame::ABSOLUTE),
+};
+
+TEST(LocationFrame, MatchesLocation)
+{
+    for (const Location &origin : origins) {
+        const LocationFrame frame(origin);
+        for (int32_t i = -5; i <= 5; i++) {
+            Location loc = origin;
+            loc.lat += i * 12345;
+            loc.lng -= i * 23456;
+            loc.alt += i * 100;
+
+            const Vector2f ne = frame.get_distance_NE(loc);
+            const Vector2f ne_ref = origin.get_distance_NE(loc);
+            EXPECT_NEAR(ne_ref.x, ne.x, 1.0e-3f);
+            EXPECT_NEAR(ne_ref.y, ne.y, 1.0e-3f);
+
+            const Vector3f ned = frame.get_distance_NED(loc);
+            const Vector3f ned_ref = origin.get_distance_NED(loc);
+            EXPECT_NEAR(ned_ref.x, ned.x, 1.0e-3f);
+            EXPECT_NEAR(ned_ref.y, ned.y, 1.0e-3f);
+            EXPECT_FLOAT_EQ(ned_ref.z, ned.z);
+
+            EXPECT_NEAR(ne_ref.length(), frame.get_distance(loc), 1.0e-3f);
+
+            // offsets round to the nearest 1e-7 degrees
+            Location moved = origin;
+            moved.offset(ne.x, ne.y);
+            const Location moved_frame = frame.get_location_NE(ne);
+            EXPECT_NEAR(moved.lat, moved_frame.lat, 1);
+            EXPECT_NEAR(moved.lng, moved_frame.lng, 1);
+            EXPECT_NEAR(loc.lat, moved_frame.lat, 1);
+            EXPECT_NEAR(loc.lng, moved_frame.lng, 1);
+        }
+    }
+}
+
+TEST(LocationFrame, Batch)
+{
+    const Location &origin = origins[0];
+    LocationFrame frame;
+    frame.set_origin(origin);
+    EXPECT_TRUE(frame.get_origin().same_latlon_as(origin));
+
+    Location locs[7];
+    Vector2f ne[7];
+    for (uint8_t i = 0; i < ARRAY_SIZE(locs); i++) {
+        locs[i] = origin;
+        frame.offset(locs[i], 10.0f * i, -25.0f * i);
+    }
+    frame.get_distance_NE(locs, ne, ARRAY_SIZE(locs));
+    for (uint8_t i = 0; i < ARRAY_SIZE(locs); i++) {
+        EXPECT_EQ(frame.get_distance_NE(locs[i]), ne[i]);
+        EXPECT_NEAR(10.0f * i, ne[i].x, 0.02f);
+        EXPECT_NEAR(-25.0f * i, ne[i].y, 0.02f);
+    }
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,90 @@
+#include <AP_gtest.h>
+
+#include <AP_Common/AP_WFQ_Scheduler.h>
+
+TEST(WFQScheduler, Weights)
+{
+    AP_WFQ_Scheduler<4> s;
+    s.set_weight(0, 1);
+    s.set_weight(1, 1);
+    s.set_weight(2, 4);
+    s.set_weight(3, 4);
+
+    // the items with a quarter of the weight get more of the slots
+    uint32_t sent[4] {};
+    for (uint32_t t = 1; t <= 1000; t++) {
+        const int8_t idx = s.select(t, 0xF);
+        ASSERT_GE(idx, 0);
+        sent[idx]++;
+    }
+    EXPECT_NEAR(sent[0], sent[1], 1);
+    EXPECT_NEAR(sent[2], sent[3], 1);
+    EXPECT_GT(sent[0], 2 * sent[2]);
+    EXPECT_EQ(1000U, sent[0] + sent[1] + sent[2] + sent[3]);
+}
+
+TEST(WFQScheduler, Ready)
+{
+    AP_WFQ_Scheduler<3> s;
+
+    EXPECT_EQ(-1, s.select(10, 0));
+    for (uint32_t t = 20; t < 100; t += 10) {
+        EXPECT_EQ(1, s.select(t, 1U << 1));
+    }
+}
+
+TEST(WFQScheduler, MinPeriod)
+{
+    AP_WFQ_Scheduler<2> s;
+    s.set_min_period(0, 1000);
+    s.set_min_period(1, 1000);
+
+    EXPECT_EQ(1, s.select(1000, 0x3));
+    EXPECT_EQ(0, s.select(1010, 0x3));
+    // both within their minimum period, the slot goes to the most
+    // overdue rather than being wasted
+    EXPECT_EQ(1, s.select(1020, 0x3));
+    EXPECT_EQ(0, s.select(1030, 0x3));
+}
+
+TEST(WFQScheduler, Expedite)
+{
+    AP_WFQ_Scheduler<3> s;
+    s.set_weight(0, 1);
+    s.set_weight(1, 1000);
+    s.set_weight(2, 1000);
+
+    EXPECT_EQ(0, s.select(100, 0x7));
+    s.expedite(2);
+    EXPECT_EQ(2, s.select(101, 0x7));
+}
+
+TEST(WFQScheduler, Stats)
+{
+    AP_WFQ_Scheduler<1> s;
+    AP_WFQ_Scheduler<1>::ItemStats stats;
+
+    EXPECT_FALSE(s.get_stats(1, 0, stats));
+    for (uint32_t t = 0; t <= 2000; t += 50) {
+        s.select(t, 0x1);
+    }
+    s.select(2500, 0x1);
+    EXPECT_TRUE(s.get_stats(0, 2600, stats));
+    EXPECT_EQ(42U, stats.sent);
+    EXPECT_EQ(100U, stats.age_ms);
+    EXPECT_EQ(500U, stats.max_age_ms);
+}
+
+TEST(WFQScheduler, SlotRate)
+{
+    AP_WFQ_Scheduler<1> s;
+
+    for (uint32_t t = 0; t <= 5000; t += 50) {
+        s.select(t, 0x1);
+    }
+    EXPECT_NEAR(20.0f, s.get_slot_rate(), 1.0f);
+}
+
+AP_GTEST_MAIN()
+
+int hal = 0; // bizarrely, this fixes an undefined-symbol error but doesn't raise a type exception.  Yay.
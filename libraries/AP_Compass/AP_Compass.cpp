@@ -645,6 +645,25 @@ const AP_Param::GroupInfo Compass::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("CUS_YAW", 51, Compass, _custom_yaw, 0),
 #endif
+
+#if COMPASS_CAL_ENABLED
+    // @Param: CAL_TIME
+    // @DisplayName: Compass calibration fitting time
+    // @Description: Maximum time spent fitting compass calibrations each time the calibration is updated, shared between the compasses being calibrated. Fits that take longer are carried on in the next update. Zero runs one complete fit step per compass per update, however long that takes.
+    // @Range: 0 5000
+    // @Units: us
+    // @Increment: 10
+    // @User: Advanced
+    AP_GROUPINFO("CAL_TIME", 52, Compass, _cal_time_us, 200),
+#endif
+
+    // @Param: POLL_DIV
+    // @DisplayName: Compass polling divider when still
+    // @Description: While the vehicle is rotating at less than 10 degrees per second the AK09916, IST8310, LIS3MDL, QMC5883L and RM3100 compasses are only read on one in this many of their polls, to free up the bus they share with other sensors. Polling is at the full rate while rotating or calibrating. 1 always polls at the full rate.
+    // @Range: 1 8
+    // @User: Advanced
+    AP_GROUPINFO("POLL_DIV", 53, Compass, _poll_div, 1),
+
     AP_GROUPEND
 };
 
@@ -1463,6 +1482,27 @@ Compass::_detect_runtime(void)
 #endif
 }
 
+/*
+  while the vehicle is not rotating the field in body frame barely
+  changes, so backends which support it can poll their sensor less
+  often. Polling is kept at the full rate while calibrating as the
+  calibrator needs every sample
+ */
+void Compass::update_poll_divider(void)
+{
+    uint8_t div = 1;
+#ifndef HAL_BUILD_AP_PERIPH
+    if (_poll_div > 1 &&
+#if COMPASS_CAL_ENABLED
+        !is_calibrating() &&
+#endif
+        AP::ahrs().get_gyro().length() < AP_COMPASS_POLL_STILL_RATE) {
+        div = MIN(_poll_div.get(), AP_COMPASS_POLL_DIV_MAX);
+    }
+#endif
+    _poll_divider = div;
+}
+
 bool
 Compass::read(void)
 {
@@ -1473,6 +1513,7 @@ Compass::read(void)
 #endif
 
     _detect_runtime();
+    update_poll_divider();
 
     for (uint8_t i=0; i< _backend_count; i++) {
         // call read on each of the backend. This call updates field[i]
@@ -1482,6 +1523,15 @@ Compass::read(void)
     for (StateIndex i(0); i < COMPASS_MAX_INSTANCES; i++) {
         _state[i].healthy = (time - _state[i].last_update_ms < 500);
     }
+    // sample interval statistics for each compass, at 1Hz
+    if (time - _last_jitter_report_ms >= 1000) {
+        _last_jitter_report_ms = time;
+        for (StateIndex i(0); i < COMPASS_MAX_INSTANCES; i++) {
+            if (_state[i].registered) {
+                _state[i].sample_jitter.report(AP_SampleJitter::SensorType::COMPASS, _get_priority(i).get_int());
+            }
+        }
+    }
 #if COMPASS_LEARN_ENABLED
     if (_learn == LEARN_INFLIGHT && !learn_allocated) {
         learn_allocated = true;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <inttypes.h>
+#include <atomic>
 
 #include <AP_Common/AP_Common.h>
 #include <AP_Declination/AP_Declination.h>
@@ -8,6 +9,7 @@
 #include <AP_Math/AP_Math.h>
 #include <AP_Param/AP_Param.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
+#include <AP_SampleJitter/AP_SampleJitter.h>
 
 #include "CompassCalibrator.h"
 #include "AP_Compass_Backend.h"
@@ -42,6 +44,10 @@
 #define AP_COMPASS_MAX_XY_ANG_DIFF radians(60.0f)
 #define AP_COMPASS_MAX_XY_LENGTH_DIFF 200.0f
 
+// rotation rate below which COMPASS_POLL_DIV slows the sensor polling
+#define AP_COMPASS_POLL_STILL_RATE radians(10.0f)
+#define AP_COMPASS_POLL_DIV_MAX 8
+
 /**
    maximum number of compass instances available on this platform. If more
    than 1 then redundant sensors may be available
@@ -170,6 +176,10 @@ public:
     bool compass_cal_requires_reboot() const { return _cal_complete_requires_reboot; }
     bool is_calibrating() const;
 
+    // number of sensor polls per sample taken by backends which
+    // support slower polling while the vehicle is still
+    uint8_t get_poll_divider() const { return _poll_divider; }
+
     // indicate which bit in LOG_BITMASK indicates we should log compass readings
     void set_log_bit(uint32_t log_bit) { _log_bit = log_bit; }
 
@@ -502,9 +512,26 @@ private:
         // board specific orientation
         enum Rotation rotation;
 
-        // accumulated samples, protected by _sem, used by AP_Compass_Backend
+        // accumulated samples, only touched by the thread sampling the
+        // sensor, used by AP_Compass_Backend
         Vector3f accum;
         uint32_t accum_count;
+
+        // the sum so far is republished after each sample into
+        // accum_snap[accum_seq&1] so the thread draining it can copy
+        // it without a lock. accum_taken is the last sequence number
+        // drained. When it differs from accum_reset the sampling
+        // thread starts a new sum
+        struct {
+            Vector3f sum;
+            uint32_t count;
+        } accum_snap[2];
+        std::atomic<uint32_t> accum_seq{0};
+        std::atomic<uint32_t> accum_taken{0};
+        uint32_t accum_reset;
+
+        // arrival of raw samples, recorded by AP_Compass_Backend
+        AP_SampleJitter sample_jitter;
         // We only copy persistent params
         void copy_from(const mag_state& state);
     };
@@ -554,6 +581,9 @@ private:
 
 #if COMPASS_CAL_ENABLED
     RestrictIDTypeArray<CompassCalibrator, COMPASS_MAX_INSTANCES, Priority> _calibrator;
+
+    // fitting time per cal_update() call, in microseconds
+    AP_Int16 _cal_time_us;
 #endif
 
 #if COMPASS_MOT_ENABLED
@@ -587,6 +617,13 @@ private:
     ///
     void try_set_initial_location();
     bool _initial_location_set;
+
+    uint32_t _last_jitter_report_ms;
+
+    // slow backend polling while the vehicle is not rotating
+    void update_poll_divider(void);
+    AP_Int8 _poll_div;
+    volatile uint8_t _poll_divider = 1;
 };
 
 namespace AP {
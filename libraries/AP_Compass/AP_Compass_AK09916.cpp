@@ -266,6 +266,10 @@ void AP_Compass_AK09916::_update()
     struct sample_regs regs = {0};
     Vector3f raw_field;
 
+    if (!poll_due()) {
+        return;
+    }
+
     if (!_bus->block_read(REG_ST1, (uint8_t *) &regs, sizeof(regs))) {
         return;
     }
@@ -47,6 +47,8 @@ void AP_Compass_Backend::publish_raw_field(const Vector3f &mag, uint8_t instance
 {
     Compass::mag_state &state = _compass._state[Compass::StateIndex(instance)];
 
+    state.sample_jitter.sample(AP_HAL::micros());
+
     // note that we do not set last_update_usec here as otherwise the
     // EKF and DCM would end up consuming compass data at the full
     // sensor rate. We want them to consume only the filtered fields
@@ -133,37 +135,88 @@ void AP_Compass_Backend::accumulate_sample(Vector3f &field, uint8_t instance,
         return;
     }
 
-    WITH_SEMAPHORE(_sem);
-
     Compass::mag_state &state = _compass._state[Compass::StateIndex(instance)];
+
+    // the sum is only ever changed by this thread. Start a new sum
+    // once a snapshot of it has been drained
+    const uint32_t taken = state.accum_taken.load(std::memory_order_acquire);
+    if (taken != state.accum_reset) {
+        state.accum_reset = taken;
+        state.accum.zero();
+        state.accum_count = 0;
+    }
     state.accum += field;
     state.accum_count++;
     if (max_samples && state.accum_count >= max_samples) {
         state.accum_count /= 2;
         state.accum /= 2;
     }
+
+    // publish the sum into the buffer not holding the last
+    // snapshot. A drain that sees any of these writes must also see
+    // the last snapshot was published, so it knows to try again
+    const uint32_t seq = state.accum_seq.load(std::memory_order_relaxed) + 1;
+    auto &snap = state.accum_snap[seq & 1];
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    snap.sum = state.accum;
+    snap.count = state.accum_count;
+    state.accum_seq.store(seq, std::memory_order_release);
 }
 
 void AP_Compass_Backend::drain_accumulated_samples(uint8_t instance,
                                                    const Vector3f *scaling)
 {
-    WITH_SEMAPHORE(_sem);
-
     Compass::mag_state &state = _compass._state[Compass::StateIndex(instance)];
 
-    if (state.accum_count == 0) {
+    // copy the latest snapshot, trying again if the sampling thread
+    // reuses its buffer while we copy. If it keeps doing so the
+    // samples are drained on the next call instead
+    Vector3f sum;
+    uint32_t count = 0;
+    uint32_t seq = 0;
+    for (uint8_t tries=0; tries<4; tries++) {
+        seq = state.accum_seq.load(std::memory_order_acquire);
+        if (seq == state.accum_taken.load(std::memory_order_relaxed)) {
+            // no samples since the last drain
+            return;
+        }
+        const auto &snap = state.accum_snap[seq & 1];
+        sum = snap.sum;
+        count = snap.count;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (state.accum_seq.load(std::memory_order_relaxed) == seq) {
+            break;
+        }
+        count = 0;
+    }
+    if (count == 0) {
         return;
     }
 
+    // the sampling thread starts a new sum when it sees this. In the
+    // rare case it published another sample since our copy, the next
+    // drain averages that sample together with the ones drained now
+    state.accum_taken.store(seq, std::memory_order_release);
+
     if (scaling) {
-        state.accum *= *scaling;
+        sum *= *scaling;
     }
-    state.accum /= state.accum_count;
+    sum /= count;
 
-    publish_filtered_field(state.accum, instance);
+    publish_filtered_field(sum, instance);
+}
 
-    state.accum.zero();
-    state.accum_count = 0;
+/*
+  called at the start of each periodic poll of the sensor by backends
+  which support slower polling while the vehicle is still
+ */
+bool AP_Compass_Backend::poll_due()
+{
+    if (++_poll_count < _compass.get_poll_divider()) {
+        return false;
+    }
+    _poll_count = 0;
+    return true;
 }
 
 /*
@@ -87,6 +87,10 @@ protected:
                            uint32_t max_samples = 10);
     void drain_accumulated_samples(uint8_t instance, const Vector3f *scale = NULL);
 
+    // false on the sensor polls to skip while the frontend has
+    // slowed polling because the vehicle is still
+    bool poll_due();
+
     // register a new compass instance with the frontend
     bool register_compass(int32_t dev_id, uint8_t& instance) const;
 
@@ -111,9 +115,6 @@ protected:
     // access to frontend
     Compass &_compass;
 
-    // semaphore for access to shared frontend data
-    HAL_Semaphore _sem;
-
     // Check that the compass field is valid by using a mean filter on the vector length
     bool field_ok(const Vector3f &field);
     
@@ -125,4 +126,6 @@ private:
     float _mean_field_length;
     // number of dropped samples. Not used for now, but can be usable to choose more reliable sensor
     uint32_t _error_count;
+    // polls since the sensor was last read
+    uint8_t _poll_count;
 };
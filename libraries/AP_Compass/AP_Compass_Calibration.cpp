@@ -19,8 +19,21 @@ void Compass::cal_update()
 
     bool running = false;
 
+    // share the fitting time between the calibrators that are running
+    uint8_t num_running = 0;
+    for (Priority i(0); i<COMPASS_MAX_INSTANCES; i++) {
+        if (_calibrator[i].running()) {
+            num_running++;
+        }
+    }
+    uint16_t time_budget_us = 0;
+    if (_cal_time_us > 0 && num_running > 0) {
+        time_budget_us = MAX(_cal_time_us / num_running, 1);
+    }
+
     for (Priority i(0); i<COMPASS_MAX_INSTANCES; i++) {
         bool failure;
+        _calibrator[i].set_time_budget_us(time_budget_us);
         _calibrator[i].update(failure);
         if (failure) {
             AP_Notify::events.compass_cal_failed = 1;
@@ -446,19 +459,14 @@ MAV_RESULT Compass::mag_cal_fixed_yaw(float yaw_deg, uint8_t compass_mask,
     }
 
     // get the magnetic field intensity and orientation
-    float intensity;
-    float declination;
-    float inclination;
-    if (!AP_Declination::get_mag_field_ef(lat_deg, lon_deg, intensity, declination, inclination)) {
+    AP_Declination::MagField mag_field;
+    if (!AP_Declination::Lookup().get_mag_field(lat_deg, lon_deg, mag_field)) {
         gcs().send_text(MAV_SEVERITY_ERROR, "Mag: WMM table error");
         return MAV_RESULT_FAILED;
     }
 
-    // create a field vector and rotate to the required orientation
-    Vector3f field(1e3f * intensity, 0.0f, 0.0f);
-    Matrix3f R;
-    R.from_euler(0.0f, -ToRad(inclination), ToRad(declination));
-    field = R * field;
+    // create a field vector in mGauss
+    Vector3f field = mag_field.earth_field_ga() * 1e3f;
 
     Matrix3f dcm;
     dcm.from_euler(AP::ahrs().roll, AP::ahrs().pitch, radians(yaw_deg));
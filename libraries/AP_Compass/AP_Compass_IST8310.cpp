@@ -190,6 +190,10 @@ void AP_Compass_IST8310::start_conversion()
 
 void AP_Compass_IST8310::timer()
 {
+    if (!poll_due()) {
+        return;
+    }
+
     if (_ignore_next_sample) {
         _ignore_next_sample = false;
         start_conversion();
@@ -132,7 +132,10 @@ fail:
 
 void AP_Compass_LIS3MDL::timer()
 {
+    // the status register is just before the output registers, so
+    // read them all in one transfer
     struct PACKED {
+        uint8_t status;
         int16_t magx;
         int16_t magy;
         int16_t magz;
@@ -140,17 +143,15 @@ void AP_Compass_LIS3MDL::timer()
     const float range_scale = 1000.0f / 6842.0f;
     Vector3f field;
 
-    // check data ready
-    uint8_t status;
-    if (!dev->read_registers(ADDR_STATUS_REG, (uint8_t *)&status, 1)) {
-        goto check_registers;
+    if (!poll_due()) {
+        return;
     }
-    if (!(status & 0x08)) {
-        // data not available yet
+
+    if (!dev->read_registers(ADDR_STATUS_REG, (uint8_t *)&data, sizeof(data))) {
         goto check_registers;
     }
-
-    if (!dev->read_registers(ADDR_OUT_X_L, (uint8_t *)&data, sizeof(data))) {
+    if (!(data.status & 0x08)) {
+        // data not available yet
         goto check_registers;
     }
 
@@ -165,6 +165,12 @@ void AP_Compass_QMC5883L::timer()
 
     const float range_scale = 1000.0f / 3000.0f;
 
+    if (!poll_due()) {
+        return;
+    }
+
+    // the status register follows the output registers and reading
+    // the outputs clears its data ready bit, so it is read first
     uint8_t status;
     if(!_dev->read_registers(QMC5883L_REG_STATUS,&status,1)){
     	return;
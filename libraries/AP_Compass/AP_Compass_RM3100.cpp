@@ -103,22 +103,20 @@ bool AP_Compass_RM3100::init()
     // high retries for init
     dev->set_retries(10);
 
-    // use default cycle count values as a whoami test
-    uint8_t ccx0;
-    uint8_t ccx1;
-    uint8_t ccy0;
-    uint8_t ccy1;
-    uint8_t ccz0;
-    uint8_t ccz1;
-    if (!dev->read_registers(RM3100_CCX1_REG, &ccx1, 1) ||
-        !dev->read_registers(RM3100_CCX0_REG, &ccx0, 1) ||
-        !dev->read_registers(RM3100_CCY1_REG, &ccy1, 1) ||
-        !dev->read_registers(RM3100_CCY0_REG, &ccy0, 1) ||
-        !dev->read_registers(RM3100_CCZ1_REG, &ccz1, 1) ||
-        !dev->read_registers(RM3100_CCZ0_REG, &ccz0, 1) ||
-        ccx1 != CCP1_DEFAULT || ccx0 != CCP0_DEFAULT ||
-        ccy1 != CCP1_DEFAULT || ccy0 != CCP0_DEFAULT ||
-        ccz1 != CCP1_DEFAULT || ccz0 != CCP0_DEFAULT) {
+    // use default cycle count values as a whoami test. The six cycle
+    // count registers are contiguous so are read in one transfer
+    struct PACKED {
+        uint8_t ccx1;
+        uint8_t ccx0;
+        uint8_t ccy1;
+        uint8_t ccy0;
+        uint8_t ccz1;
+        uint8_t ccz0;
+    } cc;
+    if (!dev->read_registers(RM3100_CCX1_REG, (uint8_t *)&cc, sizeof(cc)) ||
+        cc.ccx1 != CCP1_DEFAULT || cc.ccx0 != CCP0_DEFAULT ||
+        cc.ccy1 != CCP1_DEFAULT || cc.ccy0 != CCP0_DEFAULT ||
+        cc.ccz1 != CCP1_DEFAULT || cc.ccz0 != CCP0_DEFAULT) {
         // couldn't read one of the cycle count registers or didn't recognize the default cycle count values
         dev->get_semaphore()->give();
         return false;
@@ -183,7 +181,13 @@ void AP_Compass_RM3100::timer()
     int32_t magy = 0;
     int32_t magz = 0;
 
-    // check data ready on 3 axis
+    if (!poll_due()) {
+        return;
+    }
+
+    // check data ready on 3 axis. The status register comes after the
+    // measurement registers and reading them clears it, so it is read
+    // on its own first
     uint8_t status;
     if (!dev->read_registers(RM3100_STATUS_REG, (uint8_t *)&status, 1)) {
         goto check_registers;
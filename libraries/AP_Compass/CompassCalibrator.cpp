@@ -55,6 +55,14 @@
  *
  * The fitting algorithm used is Levenberg-Marquardt. See also:
  * http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm
+ *
+ * Each Levenberg-Marquardt iteration makes one pass over the samples to
+ * accumulate the normal equations and a second pass to measure the
+ * residuals of the two candidate solutions. Both passes can be paused
+ * and resumed, so when a time budget is set with set_time_budget_us() a
+ * call to update() does as much fitting as fits in the budget and then
+ * returns, and several compasses can be calibrated at once without any
+ * one call overrunning the main loop.
  */
 
 #include "CompassCalibrator.h"
@@ -66,6 +74,7 @@
 
 #define FIELD_RADIUS_MIN 150
 #define FIELD_RADIUS_MAX 950
+#define LMA_DAMPING 10.0f
 
 extern const AP_HAL::HAL& hal;
 
@@ -190,6 +199,7 @@ void CompassCalibrator::new_sample(const Vector3f& sample)
         update_completion_mask(sample);
         _sample_buffer[_samples_collected].set(sample);
         _sample_buffer[_samples_collected].att.set_from_ahrs();
+        _sample_sum += _sample_buffer[_samples_collected].get();
         _samples_collected++;
     }
 }
@@ -198,11 +208,38 @@ void CompassCalibrator::update(bool &failure)
 {
     failure = false;
 
-    // collect the minimum number of samples
-    if (!fitting()) {
-        return;
-    }
+    const uint32_t start_us = AP_HAL::micros();
+    do {
+        // collect the minimum number of samples
+        if (!fitting()) {
+            return;
+        }
+        if (!run_fit_step(start_us, failure)) {
+            return;
+        }
+    } while (_time_budget_us != 0 && !out_of_time(start_us));
+}
+
+/////////////////////////////////////////////////////////////
+////////////////////// PRIVATE METHODS //////////////////////
+/////////////////////////////////////////////////////////////
+bool CompassCalibrator::running() const
+{
+    return _status == Status::RUNNING_STEP_ONE || _status == Status::RUNNING_STEP_TWO;
+}
 
+bool CompassCalibrator::fitting() const
+{
+    return running() && (_samples_collected == COMPASS_CAL_NUM_SAMPLES);
+}
+
+bool CompassCalibrator::out_of_time(uint32_t start_us) const
+{
+    return _time_budget_us != 0 && AP_HAL::micros() - start_us >= _time_budget_us;
+}
+
+bool CompassCalibrator::run_fit_step(uint32_t start_us, bool &failure)
+{
     if (_status == Status::RUNNING_STEP_ONE) {
         if (_fit_step >= 10) {
             if (is_equal(_fitness, _initial_fitness) || isnan(_fitness)) {  // if true, means that fitness is diverging instead of converging
@@ -212,10 +249,12 @@ void CompassCalibrator::update(bool &failure)
                 set_status(Status::RUNNING_STEP_TWO);
             }
         } else {
-            if (_fit_step == 0) {
+            if (_fit_step == 0 && _fit->phase == FitState::Phase::IDLE) {
                 calc_initial_offset();
             }
-            run_sphere_fit();
+            if (!run_fit(false, start_us)) {
+                return false;
+            }
             _fit_step++;
         }
     } else if (_status == Status::RUNNING_STEP_TWO) {
@@ -226,27 +265,14 @@ void CompassCalibrator::update(bool &failure)
                 set_status(Status::FAILED);
                 failure = true;
             }
-        } else if (_fit_step < 15) {
-            run_sphere_fit();
-            _fit_step++;
         } else {
-            run_ellipsoid_fit();
+            if (!run_fit(_fit_step >= 15, start_us)) {
+                return false;
+            }
             _fit_step++;
         }
     }
-}
-
-/////////////////////////////////////////////////////////////
-////////////////////// PRIVATE METHODS //////////////////////
-/////////////////////////////////////////////////////////////
-bool CompassCalibrator::running() const
-{
-    return _status == Status::RUNNING_STEP_ONE || _status == Status::RUNNING_STEP_TWO;
-}
-
-bool CompassCalibrator::fitting() const
-{
-    return running() && (_samples_collected == COMPASS_CAL_NUM_SAMPLES);
+    return true;
 }
 
 // initialize fitness before starting a fit
@@ -261,12 +287,16 @@ void CompassCalibrator::initialize_fit()
     _sphere_lambda = 1.0f;
     _ellipsoid_lambda = 1.0f;
     _fit_step = 0;
+    if (_fit != nullptr) {
+        _fit->phase = FitState::Phase::IDLE;
+    }
 }
 
 void CompassCalibrator::reset_state()
 {
     _samples_collected = 0;
     _samples_thinned = 0;
+    _sample_sum.zero();
     _params.radius = 200;
     _params.offset.zero();
     _params.diag = Vector3f(1.0f,1.0f,1.0f);
@@ -287,10 +317,7 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
         case Status::NOT_STARTED:
             reset_state();
             _status = Status::NOT_STARTED;
-            if (_sample_buffer != nullptr) {
-                free(_sample_buffer);
-                _sample_buffer = nullptr;
-            }
+            free_buffers();
             return true;
 
         case Status::WAITING_TO_START:
@@ -312,7 +339,10 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
             if (_sample_buffer == nullptr) {
                 _sample_buffer = (CompassSample*)calloc(COMPASS_CAL_NUM_SAMPLES, sizeof(CompassSample));
             }
-            if (_sample_buffer != nullptr) {
+            if (_fit == nullptr) {
+                _fit = (FitState*)calloc(1, sizeof(FitState));
+            }
+            if (_sample_buffer != nullptr && _fit != nullptr) {
                 initialize_fit();
                 _status = Status::RUNNING_STEP_ONE;
                 return true;
@@ -333,10 +363,7 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
                 return false;
             }
 
-            if (_sample_buffer != nullptr) {
-                free(_sample_buffer);
-                _sample_buffer = nullptr;
-            }
+            free_buffers();
 
             _status = Status::SUCCESS;
             return true;
@@ -360,10 +387,7 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
                 return true;
             }
 
-            if (_sample_buffer != nullptr) {
-                free(_sample_buffer);
-                _sample_buffer = nullptr;
-            }
+            free_buffers();
 
             _status = status;
             return true;
@@ -373,6 +397,18 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
     };
 }
 
+void CompassCalibrator::free_buffers()
+{
+    if (_sample_buffer != nullptr) {
+        free(_sample_buffer);
+        _sample_buffer = nullptr;
+    }
+    if (_fit != nullptr) {
+        free(_fit);
+        _fit = nullptr;
+    }
+}
+
 bool CompassCalibrator::fit_acceptable()
 {
     if (!isnan(_fitness) &&
@@ -410,6 +446,7 @@ void CompassCalibrator::thin_samples()
     // remove any samples that are close together
     for (uint16_t i=0; i < _samples_collected; i++) {
         if (!accept_sample(_sample_buffer[i], i)) {
+            _sample_sum -= _sample_buffer[i].get();
             _sample_buffer[i] = _sample_buffer[_samples_collected-1];
             _samples_collected--;
             _samples_thinned++;
@@ -492,11 +529,9 @@ float CompassCalibrator::calc_mean_squared_residuals(const param_t& params) cons
 // calculate initial offsets by simply taking the average values of the samples
 void CompassCalibrator::calc_initial_offset()
 {
-    // Set initial offset to the average value of the samples
-    _params.offset.zero();
-    for (uint16_t k = 0; k < _samples_collected; k++) {
-        _params.offset -= _sample_buffer[k].get();
-    }
+    // Set initial offset to the average value of the samples, which
+    // new_sample() keeps a running sum of
+    _params.offset = -_sample_sum;
     _params.offset /= _samples_collected;
 }
 
@@ -524,93 +559,6 @@ void CompassCalibrator::calc_sphere_jacob(const Vector3f& sample, const param_t&
     ret[3] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
 }
 
-// run sphere fit to calculate diagonals and offdiagonals
-void CompassCalibrator::run_sphere_fit()
-{
-    if (_sample_buffer == nullptr) {
-        return;
-    }
-
-    const float lma_damping = 10.0f;
-
-    // take backup of fitness and parameters so we can determine later if this fit has improved the calibration
-    float fitness = _fitness;
-    float fit1, fit2;
-    param_t fit1_params, fit2_params;
-    fit1_params = fit2_params = _params;
-
-    float JTJ[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
-    float JTJ2[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
-    float JTFI[COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
-
-    // Gauss Newton Part common for all kind of extensions including LM
-    for (uint16_t k = 0; k<_samples_collected; k++) {
-        Vector3f sample = _sample_buffer[k].get();
-
-        float sphere_jacob[COMPASS_CAL_NUM_SPHERE_PARAMS];
-
-        calc_sphere_jacob(sample, fit1_params, sphere_jacob);
-
-        for (uint8_t i = 0;i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
-            // compute JTJ
-            for (uint8_t j = 0; j < COMPASS_CAL_NUM_SPHERE_PARAMS; j++) {
-                JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];   //a backup JTJ for LM
-            }
-            // compute JTFI
-            JTFI[i] += sphere_jacob[i] * calc_residual(sample, fit1_params);
-        }
-    }
-
-    //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
-    // refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
-    for (uint8_t i = 0; i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
-        JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+i] += _sphere_lambda;
-        JTJ2[i*COMPASS_CAL_NUM_SPHERE_PARAMS+i] += _sphere_lambda/lma_damping;
-    }
-
-    if (!inverse(JTJ, JTJ, 4)) {
-        return;
-    }
-
-    if (!inverse(JTJ2, JTJ2, 4)) {
-        return;
-    }
-
-    // extract radius, offset, diagonals and offdiagonal parameters
-    for (uint8_t row=0; row < COMPASS_CAL_NUM_SPHERE_PARAMS; row++) {
-        for (uint8_t col=0; col < COMPASS_CAL_NUM_SPHERE_PARAMS; col++) {
-            fit1_params.get_sphere_params()[row] -= JTFI[col] * JTJ[row*COMPASS_CAL_NUM_SPHERE_PARAMS+col];
-            fit2_params.get_sphere_params()[row] -= JTFI[col] * JTJ2[row*COMPASS_CAL_NUM_SPHERE_PARAMS+col];
-        }
-    }
-
-    // calculate fitness of two possible sets of parameters
-    fit1 = calc_mean_squared_residuals(fit1_params);
-    fit2 = calc_mean_squared_residuals(fit2_params);
-
-    // decide which of the two sets of parameters is best and store in fit1_params
-    if (fit1 > _fitness && fit2 > _fitness) {
-        // if neither set of parameters provided better results, increase lambda
-        _sphere_lambda *= lma_damping;
-    } else if (fit2 < _fitness && fit2 < fit1) {
-        // if fit2 was better we will use it. decrease lambda
-        _sphere_lambda /= lma_damping;
-        fit1_params = fit2_params;
-        fitness = fit2;
-    } else if (fit1 < _fitness) {
-        fitness = fit1;
-    }
-    //--------------------Levenberg-Marquardt-part-ends-here--------------------------------//
-
-    // store new parameters and update fitness
-    if (!isnan(fitness) && fitness < _fitness) {
-        _fitness = fitness;
-        _params = fit1_params;
-        update_completion_mask();
-    }
-}
-
 void CompassCalibrator::calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const
 {
     const Vector3f &offset = params.offset;
@@ -641,93 +589,153 @@ void CompassCalibrator::calc_ellipsoid_jacob(const Vector3f& sample, const param
     ret[8] = -1.0f * (((sample.z + offset.z) * B) + ((sample.y + offset.y) * C))/length;
 }
 
-void CompassCalibrator::run_ellipsoid_fit()
+bool CompassCalibrator::run_fit(bool ellipsoid, uint32_t start_us)
 {
-    if (_sample_buffer == nullptr) {
-        return;
+    if (_sample_buffer == nullptr || _fit == nullptr) {
+        return true;
     }
 
-    const float lma_damping = 10.0f;
+    FitState &fit = *_fit;
+    if (fit.phase == FitState::Phase::IDLE) {
+        // take copies of the parameters to fit, so we can determine later if this fit has improved the calibration
+        fit.ellipsoid = ellipsoid;
+        fit.fit1_params = fit.fit2_params = _params;
+        memset(fit.JTJ, 0, sizeof(fit.JTJ));
+        memset(fit.JTFI, 0, sizeof(fit.JTFI));
+        fit.next_sample = 0;
+        fit.phase = FitState::Phase::ACCUMULATE;
+    }
+    const uint8_t num_params = fit.ellipsoid ? COMPASS_CAL_NUM_ELLIPSOID_PARAMS : COMPASS_CAL_NUM_SPHERE_PARAMS;
 
-    // take backup of fitness and parameters so we can determine later if this fit has improved the calibration
-    float fitness = _fitness;
-    float fit1, fit2;
-    param_t fit1_params, fit2_params;
-    fit1_params = fit2_params = _params;
+    if (fit.phase == FitState::Phase::ACCUMULATE) {
+        // Gauss Newton Part common for all kind of extensions including LM.
+        // JTJ is symmetric so only its upper triangle is summed here
+        while (fit.next_sample < _samples_collected) {
+            const Vector3f sample = _sample_buffer[fit.next_sample].get();
 
-    float JTJ[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
-    float JTJ2[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
-    float JTFI[COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
+            float jacob[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+            if (fit.ellipsoid) {
+                calc_ellipsoid_jacob(sample, fit.fit1_params, jacob);
+            } else {
+                calc_sphere_jacob(sample, fit.fit1_params, jacob);
+            }
+            const float residual = calc_residual(sample, fit.fit1_params);
+
+            for (uint8_t i = 0; i < num_params; i++) {
+                float *JTJ_row = &fit.JTJ[i*num_params];
+                for (uint8_t j = i; j < num_params; j++) {
+                    JTJ_row[j] += jacob[i] * jacob[j];
+                }
+                fit.JTFI[i] += jacob[i] * residual;
+            }
 
-    // Gauss Newton Part common for all kind of extensions including LM
-    for (uint16_t k = 0; k<_samples_collected; k++) {
-        Vector3f sample = _sample_buffer[k].get();
+            fit.next_sample++;
+            if ((fit.next_sample & 7) == 0 && out_of_time(start_us)) {
+                return false;
+            }
+        }
 
-        float ellipsoid_jacob[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+        if (!solve_fit()) {
+            fit.phase = FitState::Phase::IDLE;
+            return true;
+        }
+        fit.fit1_sum = 0.0f;
+        fit.fit2_sum = 0.0f;
+        fit.next_sample = 0;
+        fit.phase = FitState::Phase::EVALUATE;
+    }
 
-        calc_ellipsoid_jacob(sample, fit1_params, ellipsoid_jacob);
+    // calculate fitness of the two possible sets of parameters in a single pass
+    while (fit.next_sample < _samples_collected) {
+        const Vector3f sample = _sample_buffer[fit.next_sample].get();
+        fit.fit1_sum += sq(calc_residual(sample, fit.fit1_params));
+        fit.fit2_sum += sq(calc_residual(sample, fit.fit2_params));
 
-        for (uint8_t i = 0;i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
-            // compute JTJ
-            for (uint8_t j = 0; j < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; j++) {
-                JTJ [i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
-            }
-            // compute JTFI
-            JTFI[i] += ellipsoid_jacob[i] * calc_residual(sample, fit1_params);
+        fit.next_sample++;
+        if ((fit.next_sample & 7) == 0 && out_of_time(start_us)) {
+            return false;
         }
     }
 
+    finish_fit();
+    fit.phase = FitState::Phase::IDLE;
+    return true;
+}
+
+bool CompassCalibrator::solve_fit()
+{
+    FitState &fit = *_fit;
+    const uint8_t num_params = fit.ellipsoid ? COMPASS_CAL_NUM_ELLIPSOID_PARAMS : COMPASS_CAL_NUM_SPHERE_PARAMS;
+    const float lambda = fit.ellipsoid ? _ellipsoid_lambda : _sphere_lambda;
+
+    // fill in the lower triangle, and take a backup JTJ for LM
+    float JTJ[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+    float JTJ2[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+    for (uint8_t i = 0; i < num_params; i++) {
+        for (uint8_t j = 0; j < num_params; j++) {
+            JTJ[i*num_params+j] = j >= i ? fit.JTJ[i*num_params+j] : fit.JTJ[j*num_params+i];
+        }
+    }
+    memcpy(JTJ2, JTJ, sizeof(float)*num_params*num_params);
+
     //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
-    //refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
-    for (uint8_t i = 0; i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
-        JTJ[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+i] += _ellipsoid_lambda;
-        JTJ2[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+i] += _ellipsoid_lambda/lma_damping;
+    // refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
+    for (uint8_t i = 0; i < num_params; i++) {
+        JTJ[i*num_params+i] += lambda;
+        JTJ2[i*num_params+i] += lambda/LMA_DAMPING;
     }
 
-    if (!inverse(JTJ, JTJ, 9)) {
-        return;
+    if (!inverse(JTJ, JTJ, num_params)) {
+        return false;
     }
 
-    if (!inverse(JTJ2, JTJ2, 9)) {
-        return;
+    if (!inverse(JTJ2, JTJ2, num_params)) {
+        return false;
     }
 
     // extract radius, offset, diagonals and offdiagonal parameters
-    for (uint8_t row=0; row < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; row++) {
-        for (uint8_t col=0; col < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; col++) {
-            fit1_params.get_ellipsoid_params()[row] -= JTFI[col] * JTJ[row*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+col];
-            fit2_params.get_ellipsoid_params()[row] -= JTFI[col] * JTJ2[row*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+col];
+    float *fit1 = fit.ellipsoid ? fit.fit1_params.get_ellipsoid_params() : fit.fit1_params.get_sphere_params();
+    float *fit2 = fit.ellipsoid ? fit.fit2_params.get_ellipsoid_params() : fit.fit2_params.get_sphere_params();
+    for (uint8_t row=0; row < num_params; row++) {
+        for (uint8_t col=0; col < num_params; col++) {
+            fit1[row] -= fit.JTFI[col] * JTJ[row*num_params+col];
+            fit2[row] -= fit.JTFI[col] * JTJ2[row*num_params+col];
         }
     }
+    return true;
+}
+
+void CompassCalibrator::finish_fit()
+{
+    FitState &fit = *_fit;
+    float &lambda = fit.ellipsoid ? _ellipsoid_lambda : _sphere_lambda;
 
-    // calculate fitness of two possible sets of parameters
-    fit1 = calc_mean_squared_residuals(fit1_params);
-    fit2 = calc_mean_squared_residuals(fit2_params);
+    float fitness = _fitness;
+    const float fit1 = fit.fit1_sum / _samples_collected;
+    const float fit2 = fit.fit2_sum / _samples_collected;
 
     // decide which of the two sets of parameters is best and store in fit1_params
     if (fit1 > _fitness && fit2 > _fitness) {
         // if neither set of parameters provided better results, increase lambda
-        _ellipsoid_lambda *= lma_damping;
+        lambda *= LMA_DAMPING;
     } else if (fit2 < _fitness && fit2 < fit1) {
         // if fit2 was better we will use it. decrease lambda
-        _ellipsoid_lambda /= lma_damping;
-        fit1_params = fit2_params;
+        lambda /= LMA_DAMPING;
+        fit.fit1_params = fit.fit2_params;
         fitness = fit2;
     } else if (fit1 < _fitness) {
         fitness = fit1;
     }
-    //--------------------Levenberg-part-ends-here--------------------------------//
+    //--------------------Levenberg-Marquardt-part-ends-here--------------------------------//
 
     // store new parameters and update fitness
-    if (fitness < _fitness) {
+    if (!isnan(fitness) && fitness < _fitness) {
         _fitness = fitness;
-        _params = fit1_params;
+        _params = fit.fit1_params;
         update_completion_mask();
     }
 }
 
-
 //////////////////////////////////////////////////////////
 //////////// CompassSample public interface //////////////
 //////////////////////////////////////////////////////////
@@ -925,10 +933,10 @@ bool CompassCalibrator::calculate_orientation(void)
     _orientation = besti;
 
     // re-run the fit to get the diagonals and off-diagonals for the
-    // new orientation
+    // new orientation. These run to completion however long they take
     initialize_fit();
-    run_sphere_fit();
-    run_ellipsoid_fit();
+    while (!run_fit(false, AP_HAL::micros())) {}
+    while (!run_fit(true, AP_HAL::micros())) {}
 
     return fit_acceptable();
 }
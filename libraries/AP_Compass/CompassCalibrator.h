@@ -16,6 +16,10 @@ public:
     // set tolerance of calibration (aka fitness)
     void set_tolerance(float tolerance) { _tolerance = tolerance; }
 
+    // set the maximum time in microseconds each call to update() may
+    // spend fitting. Zero runs one complete fit step per call
+    void set_time_budget_us(uint16_t budget_us) { _time_budget_us = budget_us; }
+
     // set compass's initial orientation and whether it should be automatically fixed (if required)
     void set_orientation(enum Rotation orientation, bool is_external, bool fix_orientation);
 
@@ -109,9 +113,40 @@ private:
         int16_t z;
     };
 
+    // state of a sphere or ellipsoid fit that is in progress, kept so
+    // that a single fit can be spread over several calls to update()
+    class FitState {
+    public:
+        enum class Phase : uint8_t {
+            IDLE,           // no fit in progress
+            ACCUMULATE,     // summing JTJ and JTFI over the samples
+            EVALUATE,       // summing the residuals of both candidate fits
+        };
+        Phase phase;
+        bool ellipsoid;                                     // true for an ellipsoid fit, false for a sphere fit
+        uint16_t next_sample;                               // next sample to process in the current phase
+        float JTJ[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS];  // upper triangle only while accumulating
+        float JTFI[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+        param_t fit1_params;                                // candidate with lambda damping
+        param_t fit2_params;                                // candidate with lambda/lma_damping damping
+        float fit1_sum;                                     // sum of squared residuals of fit1_params
+        float fit2_sum;                                     // sum of squared residuals of fit2_params
+    };
+
     // set status including any required initialisation
     bool set_status(Status status);
 
+    // free the sample buffer and fit state
+    void free_buffers();
+
+    // run the next step of the state machine, either a status
+    // transition or (part of) a fit. Returns false if it ran out of
+    // time part way through a fit
+    bool run_fit_step(uint32_t start_us, bool &failure);
+
+    // true if the time budget for this call to update() has been used
+    bool out_of_time(uint32_t start_us) const;
+
     // returns true if sample should be added to buffer
     bool accept_sample(const Vector3f &sample, uint16_t skip_index = UINT16_MAX);
     bool accept_sample(const CompassSample &sample, uint16_t skip_index = UINT16_MAX);
@@ -141,13 +176,22 @@ private:
     // calculate initial offsets by simply taking the average values of the samples
     void calc_initial_offset();
 
-    // run sphere fit to calculate diagonals and offdiagonals
+    // sphere fit jacobian, used to calculate radius and offsets
     void calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
-    void run_sphere_fit();
 
-    // run ellipsoid fit to calculate diagonals and offdiagonals
+    // ellipsoid fit jacobian, used to calculate offsets, diagonals and offdiagonals
     void calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
-    void run_ellipsoid_fit();
+
+    // run or continue one Levenberg-Marquardt iteration of a sphere or
+    // ellipsoid fit. Returns true once the iteration is complete
+    bool run_fit(bool ellipsoid, uint32_t start_us);
+
+    // invert the accumulated normal equations and calculate the two
+    // candidate parameter sets. Returns false if a matrix is singular
+    bool solve_fit();
+
+    // pick the better candidate and update lambda and the parameters
+    void finish_fit();
 
     // update the completion mask based on a single sample
     void update_completion_mask(const Vector3f& sample);
@@ -179,6 +223,7 @@ private:
     CompassSample *_sample_buffer;          // buffer of sensor values
     uint16_t _samples_collected;            // number of samples in buffer
     uint16_t _samples_thinned;              // number of samples removed by the thin_samples() call (called before step 2 begins)
+    Vector3f _sample_sum;                   // sum of the samples in the buffer, used for the initial offsets
 
     // fit state
     class param_t _params;                  // latest calibration outputs
@@ -187,6 +232,8 @@ private:
     float _initial_fitness;                 // fitness before latest "fit" was attempted (used to determine if fit was an improvement)
     float _sphere_lambda;                   // sphere fit's lambda
     float _ellipsoid_lambda;                // ellipsoid fit's lambda
+    FitState *_fit;                         // fit in progress, allocated along with the sample buffer
+    uint16_t _time_budget_us;               // maximum time spent fitting per call to update(), zero for one fit step per call
 
     // variables for orientation checking
     enum Rotation _orientation;             // latest detected orientation
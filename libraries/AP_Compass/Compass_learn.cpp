@@ -27,6 +27,11 @@ CompassLearn::CompassLearn(Compass &_compass) :
             compass.set_and_save_scale_factor(uint8_t(i), 0.0);
         }
     }
+    for (uint16_t i=0; i<num_sectors; i++) {
+        const float yaw_err = radians(i*(360/num_sectors));
+        worker.sector_sin[i] = sinf(yaw_err);
+        worker.sector_cos[i] = cosf(yaw_err);
+    }
 }
 
 /*
@@ -35,7 +40,7 @@ CompassLearn::CompassLearn(Compass &_compass) :
 void CompassLearn::update(void)
 {
     const AP_AHRS &ahrs = AP::ahrs();
-    if (converged || compass.get_learn_type() != Compass::LEARN_INFLIGHT ||
+    if (compass.get_learn_type() != Compass::LEARN_INFLIGHT ||
         !hal.util->get_soft_armed() || ahrs.get_time_flying_ms() < 3000) {
         // only learn when flying and with enough time to be clear of
         // the ground
@@ -68,41 +73,51 @@ void CompassLearn::update(void)
             mat.identity();
         }
 
-        // set initial error to field intensity
-        float intensity = mag_ef.length();
-        for (uint16_t i=0; i<num_sectors; i++) {
-            errors[i] = intensity;
-        }
-        
+        // samples from here on start a new run in the IO thread
+        run++;
+
         gcs().send_text(MAV_SEVERITY_INFO, "CompassLearn: have earth field");
-        hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&CompassLearn::io_timer, void));
+        if (!io_registered) {
+            io_registered = true;
+            hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&CompassLearn::io_timer, void));
+        }
     }
 
     AP_Notify::flags.compass_cal_running = true;
 
-    if (sample_available) {
-        // last sample still being processed by IO thread
-        return;
-    }
-
+    // queue a sample for the IO thread if the field has moved enough
+    // to tell us something new
     Vector3f field = compass.get_field(0);
     Vector3f field_change = field - last_field;
-    if (field_change.length() < min_field_change) {
-        return;
+    if (field_change.length() >= min_field_change) {
+        struct sample s;
+        s.field = field;
+        s.offsets = compass.get_offsets(0);
+        s.attitude = Vector3f(ahrs.roll, ahrs.pitch, ahrs.yaw);
+        s.mag_ef = mag_ef;
+        s.mat = mat;
+        s.run = run;
+        if (sample_queue.push(s)) {
+            last_field = field;
+            num_samples++;
+        } else {
+            // the IO thread is behind, try again on the next read
+            dropped_samples++;
+        }
     }
 
-    {
-        WITH_SEMAPHORE(sem);
-        // give a sample to the backend to process
-        new_sample.field = field;
-        new_sample.offsets = compass.get_offsets(0);
-        new_sample.attitude = Vector3f(ahrs.roll, ahrs.pitch, ahrs.yaw);
-        sample_available = true;
-        last_field = field;
-        num_samples++;
+    // apply a new estimate from the IO thread
+    const uint32_t count = estimate.count();
+    if (count == last_estimate_count) {
+        return;
+    }
+    last_estimate_count = count;
+    const struct estimate e = estimate.read();
+    if (e.run != run) {
+        // left over from an earlier run
+        return;
     }
 
-    if (sample_available) {
 // @LoggerMessage: COFS
 // @Description: Current compass learn offsets
 // @Field: TimeUS: Time since system startup
@@ -113,138 +128,205 @@ void CompassLearn::update(void)
 // @Field: Yaw: best learnt yaw
 // @Field: WVar: error of best learn yaw
 // @Field: N: number of samples used
-        AP::logger().Write("COFS", "TimeUS,OfsX,OfsY,OfsZ,Var,Yaw,WVar,N", "QffffffI",
-                                               AP_HAL::micros64(),
-                                               (double)best_offsets.x,
-                                               (double)best_offsets.y,
-                                               (double)best_offsets.z,
-                                               (double)best_error,
-                                               (double)best_yaw_deg,
-                                               (double)worst_error,
-                                               num_samples);
-    }
-
-    if (!converged) {
-        WITH_SEMAPHORE(sem);
-
-        // set offsets to current best guess
-        compass.set_offsets(0, best_offsets);
-
-        // set non-primary offsets to match primary
-        Vector3f field_primary = compass.get_field(0);
-        for (uint8_t i=1; i<compass.get_count(); i++) {
-            if (!compass._use_for_yaw[Compass::Priority(i)]) {
-                continue;
-            }
-            Vector3f field2 = compass.get_field(i);
-            Vector3f new_offsets = compass.get_offsets(i) + (field_primary - field2);
-            compass.set_offsets(i, new_offsets);
+// @Field: CPU: IO thread time taken by the last sample
+// @Field: Drop: number of samples not queued as the IO thread was behind
+    AP::logger().Write("COFS", "TimeUS,OfsX,OfsY,OfsZ,Var,Yaw,WVar,N,CPU,Drop", "QffffffIHI",
+                       AP_HAL::micros64(),
+                       (double)e.offsets.x,
+                       (double)e.offsets.y,
+                       (double)e.offsets.z,
+                       (double)e.best_error,
+                       (double)e.yaw_deg,
+                       (double)e.worst_error,
+                       e.num_samples,
+                       e.cpu_us,
+                       dropped_samples);
+
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - last_report_ms >= 10000) {
+        last_report_ms = now_ms;
+        gcs().send_text(MAV_SEVERITY_INFO, "CompassLearn: %u samples err %.0f yaw %.0f cpu %uus",
+                        (unsigned)e.num_samples, (double)e.best_error, (double)e.yaw_deg, (unsigned)e.cpu_us);
+    }
+
+    // set offsets to current best guess
+    compass.set_offsets(0, e.offsets);
+
+    // set non-primary offsets to match primary
+    Vector3f field_primary = compass.get_field(0);
+    for (uint8_t i=1; i<compass.get_count(); i++) {
+        if (!compass._use_for_yaw[Compass::Priority(i)]) {
+            continue;
         }
+        Vector3f field2 = compass.get_field(i);
+        Vector3f new_offsets = compass.get_offsets(i) + (field_primary - field2);
+        compass.set_offsets(i, new_offsets);
+    }
 
-        // stop updating the offsets once converged
-        if (num_samples > 30 && best_error < 50 && worst_error > 65) {
-            // set the offsets and enable compass for EKF use. Let the
-            // EKF learn the remaining compass offset error
-            for (uint8_t i=0; i<compass.get_count(); i++) {
-                if (compass._use_for_yaw[Compass::Priority(i)]) {
-                    compass.save_offsets(i);
-                    compass.set_and_save_scale_factor(i, 0.0);
-                }
+    // stop updating the offsets once converged
+    if (e.num_samples > 30 && e.best_error < 50 && e.worst_error > 65) {
+        // set the offsets and enable compass for EKF use. Let the
+        // EKF learn the remaining compass offset error
+        for (uint8_t i=0; i<compass.get_count(); i++) {
+            if (compass._use_for_yaw[Compass::Priority(i)]) {
+                compass.save_offsets(i);
+                compass.set_and_save_scale_factor(i, 0.0);
             }
-            compass.set_learn_type(Compass::LEARN_NONE, true);
-            // setup so use can trigger it again
-            converged = false;
-            sample_available = false;
-            num_samples = 0;
-            have_earth_field = false;
-            memset(predicted_offsets, 0, sizeof(predicted_offsets));
-            worst_error = 0;
-            best_error = 0;
-            best_yaw_deg = 0;
-            best_offsets.zero();
-            gcs().send_text(MAV_SEVERITY_INFO, "CompassLearn: finished");
-            AP_Notify::flags.compass_cal_running = false;
-            AP_Notify::events.compass_cal_saved = true;
         }
+        compass.set_learn_type(Compass::LEARN_NONE, true);
+        // setup so use can trigger it again
+        num_samples = 0;
+        dropped_samples = 0;
+        have_earth_field = false;
+        gcs().send_text(MAV_SEVERITY_INFO, "CompassLearn: finished");
+        AP_Notify::flags.compass_cal_running = false;
+        AP_Notify::events.compass_cal_saved = true;
     }
 }
 
 /*
-  we run the math intensive calculations in the IO thread
+  we run the math intensive calculations in the IO thread, a slice of
+  the sectors per call
  */
 void CompassLearn::io_timer(void)
 {
-    if (!sample_available) {
-        return;
+    const uint32_t start_us = AP_HAL::micros();
+
+    if (!worker.busy) {
+        if (!sample_queue.pop(worker.s)) {
+            return;
+        }
+        start_sample();
     }
 
-    struct sample s;
+    const uint16_t count = MIN(sectors_per_slice, uint16_t(num_sectors - worker.next_sector));
+    process_sectors(worker.next_sector, count);
+    worker.next_sector += count;
 
-    {
-        WITH_SEMAPHORE(sem);
-        s = new_sample;
-        sample_available = false;
-    }
+    worker.cpu_us += AP_HAL::micros() - start_us;
 
-    process_sample(s);
+    if (worker.next_sector >= num_sectors) {
+        finish_sample();
+    }
 }
 
 /*
-  process a new compass sample
+  setup to process a new compass sample
  */
-void CompassLearn::process_sample(const struct sample &s)
+void CompassLearn::start_sample(void)
 {
-    uint16_t besti = 0;
-    float bestv = 0, worstv=0;
+    const struct sample &s = worker.s;
+
+    if (s.run != worker.run) {
+        // a new run, so forget what we learnt last time. Set initial
+        // error to field intensity
+        worker.run = s.run;
+        worker.processed = 0;
+        const float intensity = s.mag_ef.length();
+        for (uint16_t i=0; i<num_sectors; i++) {
+            worker.ofs_x[i] = worker.ofs_y[i] = worker.ofs_z[i] = 0;
+            worker.errors[i] = intensity;
+        }
+    }
 
     /*
-      we run through the 72 possible yaw error values, and for each
-      one we calculate a value for the compass offsets if that yaw
-      error is correct. 
-     */
-    for (uint16_t i=0; i<num_sectors; i++) {
-        float yaw_err_deg = i*(360/num_sectors);
-
-        // form rotation matrix for the euler attitude
-        Matrix3f dcm;
-        dcm.from_euler(s.attitude.x, s.attitude.y, wrap_2PI(s.attitude.z + radians(yaw_err_deg)));
+      for each of the 72 possible yaw errors we calculate the field we
+      would expect if that yaw error is correct, and from that a value
+      for the compass offsets:
 
-        // calculate the field we would expect to get if this yaw error is correct
-        Vector3f expected_field = dcm.transposed() * mag_ef;
+        offsets = mat * (dcm(yaw + yaw_err)^T * mag_ef - field) + s.offsets
 
-        // calculate a value for the compass offsets for this yaw error
-        Vector3f v1 = mat * s.field;
-        Vector3f v2 = mat * expected_field;
-        Vector3f offsets = (v2 - v1) + s.offsets;
-        float delta = (offsets - predicted_offsets[i]).length();
+      Only the yaw rotation depends on the sector, so this is
+      ofs_cos * cos(yaw_err) + ofs_sin * sin(yaw_err) + ofs_const,
+      with the three vectors worked out once per sample here
+     */
+    Matrix3f dcm_rp;
+    dcm_rp.from_euler(s.attitude.x, s.attitude.y, 0);
+    const Matrix3f m = s.mat * dcm_rp.transposed();
+    const Vector3f cx = m.colx();
+    const Vector3f cy = m.coly();
+    const Vector3f p = cx * s.mag_ef.x + cy * s.mag_ef.y;
+    const Vector3f q = cx * s.mag_ef.y - cy * s.mag_ef.x;
+    const float sin_yaw = sinf(s.attitude.z);
+    const float cos_yaw = cosf(s.attitude.z);
+    worker.ofs_cos = p * cos_yaw + q * sin_yaw;
+    worker.ofs_sin = q * cos_yaw - p * sin_yaw;
+    worker.ofs_const = m.colz() * s.mag_ef.z - s.mat * s.field + s.offsets;
+
+    worker.processed++;
+    worker.next_sector = 0;
+    worker.cpu_us = 0;
+    worker.busy = true;
+}
 
-        if (num_samples == 1) {
-            predicted_offsets[i] = offsets;
-        } else {
-            // lowpass the predicted offsets and the error
-            const float learn_rate = 0.92f;
-            predicted_offsets[i] = predicted_offsets[i] * learn_rate + offsets * (1-learn_rate);
-            errors[i] = errors[i] * learn_rate + delta * (1-learn_rate);
+/*
+  update the predicted offsets and errors of a range of sectors for
+  the current sample. The loop has no branches on the data so it can
+  be vectorised
+ */
+void CompassLearn::process_sectors(uint16_t first, uint16_t count)
+{
+    const Vector3f &a = worker.ofs_cos;
+    const Vector3f &b = worker.ofs_sin;
+    const Vector3f &c = worker.ofs_const;
+    const uint16_t end = first + count;
+
+    if (worker.processed == 1) {
+        for (uint16_t i=first; i<end; i++) {
+            worker.ofs_x[i] = a.x * worker.sector_cos[i] + b.x * worker.sector_sin[i] + c.x;
+            worker.ofs_y[i] = a.y * worker.sector_cos[i] + b.y * worker.sector_sin[i] + c.y;
+            worker.ofs_z[i] = a.z * worker.sector_cos[i] + b.z * worker.sector_sin[i] + c.z;
         }
+        return;
+    }
+
+    // lowpass the predicted offsets and the error
+    const float learn_rate = 0.92f;
+    for (uint16_t i=first; i<end; i++) {
+        const float ox = a.x * worker.sector_cos[i] + b.x * worker.sector_sin[i] + c.x;
+        const float oy = a.y * worker.sector_cos[i] + b.y * worker.sector_sin[i] + c.y;
+        const float oz = a.z * worker.sector_cos[i] + b.z * worker.sector_sin[i] + c.z;
+        const float dx = ox - worker.ofs_x[i];
+        const float dy = oy - worker.ofs_y[i];
+        const float dz = oz - worker.ofs_z[i];
+        const float delta = sqrtf(dx*dx + dy*dy + dz*dz);
+        worker.ofs_x[i] = worker.ofs_x[i] * learn_rate + ox * (1-learn_rate);
+        worker.ofs_y[i] = worker.ofs_y[i] * learn_rate + oy * (1-learn_rate);
+        worker.ofs_z[i] = worker.ofs_z[i] * learn_rate + oz * (1-learn_rate);
+        worker.errors[i] = worker.errors[i] * learn_rate + delta * (1-learn_rate);
+    }
+}
 
-        // keep track of the current best prediction
-        if (i == 0 || errors[i] < bestv) {
+/*
+  pass the estimate for a fully processed sample to the front-end
+ */
+void CompassLearn::finish_sample(void)
+{
+    // keep track of the current best prediction, and also the worst
+    // error. This is used as part of the convergence test
+    uint16_t besti = 0;
+    float bestv = worker.errors[0], worstv = worker.errors[0];
+    for (uint16_t i=1; i<num_sectors; i++) {
+        if (worker.errors[i] < bestv) {
             besti = i;
-            bestv = errors[i];
+            bestv = worker.errors[i];
         }
-        // also keep the worst error. This is used as part of the convergence test
-        if (i == 0 || errors[i] > worstv) {
-            worstv = errors[i];
+        if (worker.errors[i] > worstv) {
+            worstv = worker.errors[i];
         }
     }
 
-    WITH_SEMAPHORE(sem);
-
-    // pass the current estimate to the front-end
-    best_offsets = predicted_offsets[besti];
-    best_error = bestv;
-    worst_error = worstv;
-    best_yaw_deg = wrap_360(degrees(s.attitude.z) + besti * (360/num_sectors));
+    struct estimate e;
+    e.offsets = Vector3f(worker.ofs_x[besti], worker.ofs_y[besti], worker.ofs_z[besti]);
+    e.best_error = bestv;
+    e.worst_error = worstv;
+    e.yaw_deg = wrap_360(degrees(worker.s.attitude.z) + besti * (360/num_sectors));
+    e.num_samples = worker.processed;
+    e.cpu_us = MIN(worker.cpu_us, uint32_t(UINT16_MAX));
+    e.run = worker.run;
+    estimate.write(e);
+
+    worker.busy = false;
 }
 
 #endif // COMPASS_LEARN_ENABLED
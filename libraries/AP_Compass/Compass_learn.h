@@ -1,9 +1,16 @@
 #pragma once
 
 #include <AP_AHRS/AP_AHRS.h>
+#include <AP_HAL/utility/RingBuffer.h>
+#include <AP_HAL/utility/SeqLock.h>
 
 /*
   compass learning using magnetic field tables from AP_Declination
+
+  The vehicle thread only queues samples and applies the latest
+  estimate. The yaw hypotheses are evaluated in the IO thread, a slice
+  of sectors per call, so the cost to any one thread is bounded however
+  long learning runs for
  */
 
 class CompassLearn {
@@ -16,20 +23,27 @@ public:
 private:
     Compass &compass;
     bool have_earth_field;
+    bool io_registered;
 
     // 5 degree resolution
-    static const uint16_t num_sectors = 72; 
-    
-    Vector3f predicted_offsets[num_sectors];
-    float errors[num_sectors];
-    uint32_t num_samples;
+    static const uint16_t num_sectors = 72;
+
+    // sectors evaluated per IO thread call
+    static const uint16_t sectors_per_slice = 24;
+
+    // number of samples which can be waiting for the IO thread
+    static const uint8_t sample_queue_size = 4;
+
+    // learning run, bumped each time learning starts so the IO thread
+    // knows to start again and stale estimates can be ignored
+    uint8_t run;
 
     // earth field
     Vector3f mag_ef;
 
-    // semaphore for access to shared data with IO thread
-    HAL_Semaphore sem;
-    
+    // inverse of the eliptical correction matrix
+    Matrix3f mat;
+
     struct sample {
         // milliGauss body field and offsets
         Vector3f field;
@@ -37,21 +51,67 @@ private:
 
         // euler radians attitude
         Vector3f attitude;
+
+        // earth field and correction matrix for this run
+        Vector3f mag_ef;
+        Matrix3f mat;
+
+        uint8_t run;
     };
 
-    Matrix3f mat;
-    
-    struct sample new_sample;
-    bool sample_available;
+    // samples from the vehicle thread to the IO thread
+    ObjectBuffer<struct sample> sample_queue{sample_queue_size};
+    uint32_t num_samples;
+    uint32_t dropped_samples;
     Vector3f last_field;
     static const uint32_t min_field_change = 60;
 
-    Vector3f best_offsets;
-    float best_error;
-    float best_yaw_deg;
-    float worst_error;
-    bool converged;
+    // estimate from the IO thread to the vehicle thread
+    struct estimate {
+        Vector3f offsets;
+        float best_error;
+        float worst_error;
+        float yaw_deg;
+        uint32_t num_samples;
+        // IO thread time taken by the last sample
+        uint16_t cpu_us;
+        uint8_t run;
+    };
+    SeqLock<struct estimate> estimate;
+    uint32_t last_estimate_count;
+    uint32_t last_report_ms;
+
+    /*
+      state of the IO thread. The hypothesis bank is kept as separate
+      arrays per axis so the sector loop works on contiguous floats
+     */
+    struct {
+        float ofs_x[num_sectors];
+        float ofs_y[num_sectors];
+        float ofs_z[num_sectors];
+        float errors[num_sectors];
+
+        // sine and cosine of each sector's yaw error
+        float sector_sin[num_sectors];
+        float sector_cos[num_sectors];
+
+        // sample being processed, and the terms of the offsets
+        // common to all sectors for it
+        struct sample s;
+        Vector3f ofs_cos, ofs_sin, ofs_const;
+        bool busy;
+        uint16_t next_sector;
+
+        uint16_t besti;
+        float bestv;
+        float worstv;
+        uint32_t processed;
+        uint32_t cpu_us;
+        uint8_t run;
+    } worker;
 
     void io_timer(void);
-    void process_sample(const struct sample &s);
+    void start_sample(void);
+    void process_sectors(uint16_t first, uint16_t count);
+    void finish_sample(void);
 };
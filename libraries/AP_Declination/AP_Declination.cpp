@@ -30,15 +30,15 @@
 #include <AP_Math/AP_Math.h>
 
 /*
-  calculate magnetic field intensity and orientation
+  find the cell for a location
 */
-bool AP_Declination::get_mag_field_ef(float latitude_deg, float longitude_deg, float &intensity_gauss, float &declination_deg, float &inclination_deg)
+bool AP_Declination::find_cell(float latitude_deg, float longitude_deg, int32_t &min_lat, int32_t &min_lon)
 {
     bool valid_input_data = true;
 
     /* round down to nearest sampling resolution */
-    int32_t min_lat = static_cast<int32_t>(static_cast<int32_t>(latitude_deg / SAMPLING_RES) * SAMPLING_RES);
-    int32_t min_lon = static_cast<int32_t>(static_cast<int32_t>(longitude_deg / SAMPLING_RES) * SAMPLING_RES);
+    min_lat = static_cast<int32_t>(static_cast<int32_t>(latitude_deg / SAMPLING_RES) * SAMPLING_RES);
+    min_lon = static_cast<int32_t>(static_cast<int32_t>(longitude_deg / SAMPLING_RES) * SAMPLING_RES);
 
     /* for the rare case of hitting the bounds exactly
      * the rounding logic wouldn't fit, so enforce it.
@@ -65,55 +65,81 @@ bool AP_Declination::get_mag_field_ef(float latitude_deg, float longitude_deg, f
         valid_input_data = false;
     }
 
-    /* find index of nearest low sampling point */
-    uint32_t min_lat_index = static_cast<uint32_t>((-(SAMPLING_MIN_LAT) + min_lat)  / SAMPLING_RES);
-    uint32_t min_lon_index = static_cast<uint32_t>((-(SAMPLING_MIN_LON) + min_lon) / SAMPLING_RES);
-
-    /* calculate intensity */
-
-    float data_sw = intensity_table[min_lat_index][min_lon_index];
-    float data_se = intensity_table[min_lat_index][min_lon_index + 1];;
-    float data_ne = intensity_table[min_lat_index + 1][min_lon_index + 1];
-    float data_nw = intensity_table[min_lat_index + 1][min_lon_index];
-
-    /* perform bilinear interpolation on the four grid corners */
-
-    float data_min = ((longitude_deg - min_lon) / SAMPLING_RES) * (data_se - data_sw) + data_sw;
-    float data_max = ((longitude_deg - min_lon) / SAMPLING_RES) * (data_ne - data_nw) + data_nw;
-
-    intensity_gauss = ((latitude_deg - min_lat) / SAMPLING_RES) * (data_max - data_min) + data_min;
-
-    /* calculate declination */
-
-    data_sw = declination_table[min_lat_index][min_lon_index];
-    data_se = declination_table[min_lat_index][min_lon_index + 1];;
-    data_ne = declination_table[min_lat_index + 1][min_lon_index + 1];
-    data_nw = declination_table[min_lat_index + 1][min_lon_index];
-
-    /* perform bilinear interpolation on the four grid corners */
-
-    data_min = ((longitude_deg - min_lon) / SAMPLING_RES) * (data_se - data_sw) + data_sw;
-    data_max = ((longitude_deg - min_lon) / SAMPLING_RES) * (data_ne - data_nw) + data_nw;
+    return valid_input_data;
+}
 
-    declination_deg = ((latitude_deg - min_lat) / SAMPLING_RES) * (data_max - data_min) + data_min;
+/*
+  load the bilinear coefficients for the cell at min_lat, min_lon
+*/
+void AP_Declination::Lookup::load_cell(void)
+{
+    /* find index of nearest low sampling point */
+    const uint32_t min_lat_index = static_cast<uint32_t>((-(SAMPLING_MIN_LAT) + min_lat)  / SAMPLING_RES);
+    const uint32_t min_lon_index = static_cast<uint32_t>((-(SAMPLING_MIN_LON) + min_lon) / SAMPLING_RES);
+
+    const float (*tables[3])[37] = { intensity_table, declination_table, inclination_table };
+
+    for (uint8_t i=0; i<3; i++) {
+        const float data_sw = tables[i][min_lat_index][min_lon_index];
+        const float data_se = tables[i][min_lat_index][min_lon_index + 1];
+        const float data_ne = tables[i][min_lat_index + 1][min_lon_index + 1];
+        const float data_nw = tables[i][min_lat_index + 1][min_lon_index];
+
+        /* bilinear interpolation on the four grid corners, as
+           sw + x*(se-sw) + y*((nw-sw) + x*(ne-nw-se+sw)) */
+        coeff[i][0] = data_sw;
+        coeff[i][1] = data_se - data_sw;
+        coeff[i][2] = data_nw - data_sw;
+        coeff[i][3] = data_ne - data_nw - data_se + data_sw;
+    }
+}
 
-    /* calculate inclination */
+/*
+  calculate magnetic field intensity and orientation, reusing the cell
+  of the last call if the location is still in it
+*/
+bool AP_Declination::Lookup::get_mag_field(float latitude_deg, float longitude_deg, MagField &field)
+{
+    int32_t lat, lon;
+    const bool valid_input_data = find_cell(latitude_deg, longitude_deg, lat, lon);
+    if (lat != min_lat || lon != min_lon) {
+        min_lat = lat;
+        min_lon = lon;
+        load_cell();
+    }
 
-    data_sw = inclination_table[min_lat_index][min_lon_index];
-    data_se = inclination_table[min_lat_index][min_lon_index + 1];;
-    data_ne = inclination_table[min_lat_index + 1][min_lon_index + 1];
-    data_nw = inclination_table[min_lat_index + 1][min_lon_index];
+    const float x = (longitude_deg - min_lon) / SAMPLING_RES;
+    const float y = (latitude_deg - min_lat) / SAMPLING_RES;
 
-    /* perform bilinear interpolation on the four grid corners */
+    field.intensity_gauss = interpolate(0, x, y);
+    field.declination_deg = interpolate(1, x, y);
+    field.inclination_deg = interpolate(2, x, y);
 
-    data_min = ((longitude_deg - min_lon) / SAMPLING_RES) * (data_se - data_sw) + data_sw;
-    data_max = ((longitude_deg - min_lon) / SAMPLING_RES) * (data_ne - data_nw) + data_nw;
+    return valid_input_data;
+}
 
-    inclination_deg = ((latitude_deg - min_lat) / SAMPLING_RES) * (data_max - data_min) + data_min;
+bool AP_Declination::Lookup::get_mag_field(const Location &loc, MagField &field)
+{
+    return get_mag_field(loc.lat*1.0e-7f, loc.lng*1.0e-7f, field);
+}
 
-    return valid_input_data;
+/*
+  calculate magnetic field intensity and orientation
+*/
+bool AP_Declination::get_mag_field_ef(float latitude_deg, float longitude_deg, float &intensity_gauss, float &declination_deg, float &inclination_deg)
+{
+    MagField field;
+    const bool ret = Lookup().get_mag_field(latitude_deg, longitude_deg, field);
+    intensity_gauss = field.intensity_gauss;
+    declination_deg = field.declination_deg;
+    inclination_deg = field.inclination_deg;
+    return ret;
 }
 
+bool AP_Declination::get_mag_field(const Location &loc, MagField &field)
+{
+    return Lookup().get_mag_field(loc, field);
+}
 
 /*
  calculate magnetic field intensity and orientation
@@ -128,13 +154,10 @@ float AP_Declination::get_declination(float latitude_deg, float longitude_deg)
 }
 
 /*
-  get earth field as a Vector3f in Gauss given a Location
+  get earth field as a Vector3f in Gauss
 */
-Vector3f AP_Declination::get_earth_field_ga(const Location &loc)
+Vector3f AP_Declination::MagField::earth_field_ga() const
 {
-    float declination_deg=0, inclination_deg=0, intensity_gauss=0;
-    get_mag_field_ef(loc.lat*1.0e-7f, loc.lng*1.0e-7f, intensity_gauss, declination_deg, inclination_deg);
-
     // create earth field
     Vector3f mag_ef = Vector3f(intensity_gauss, 0.0, 0.0);
     Matrix3f R;
@@ -143,3 +166,13 @@ Vector3f AP_Declination::get_earth_field_ga(const Location &loc)
     mag_ef = R * mag_ef;
     return mag_ef;
 }
+
+/*
+  get earth field as a Vector3f in Gauss given a Location
+*/
+Vector3f AP_Declination::get_earth_field_ga(const Location &loc)
+{
+    MagField field;
+    get_mag_field(loc, field);
+    return field.earth_field_ga();
+}
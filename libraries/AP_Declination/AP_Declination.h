@@ -27,8 +27,60 @@ public:
       get declination in degrees for a given latitude_deg and longitude_deg
      */
     static float get_declination(float latitude_deg, float longitude_deg);
-    
+
+    /*
+      magnetic field at a location, from one walk of the tables
+     */
+    struct MagField {
+        float intensity_gauss;
+        float declination_deg;
+        float inclination_deg;
+
+        // earth field as a Vector3f in Gauss
+        Vector3f earth_field_ga() const;
+    };
+
+    /*
+      get intensity, declination and inclination together for a
+      Location. Returns false if outside the valid input range, as
+      get_mag_field_ef()
+     */
+    static bool get_mag_field(const Location &loc, MagField &field);
+
+    /*
+      a lookup which keeps the interpolation cell of the last location,
+      so lookups while the vehicle stays in the same cell only do the
+      interpolation. Each user keeps its own, so no locking is needed
+     */
+    class Lookup {
+    public:
+        bool get_mag_field(float latitude_deg, float longitude_deg, MagField &field);
+        bool get_mag_field(const Location &loc, MagField &field);
+
+    private:
+        // south west corner of the cell in degrees, min_lat is
+        // INT32_MAX when no cell has been loaded
+        int32_t min_lat = INT32_MAX;
+        int32_t min_lon;
+
+        // bilinear coefficients of the cell for intensity,
+        // declination and inclination
+        float coeff[3][4];
+
+        void load_cell(void);
+        float interpolate(uint8_t table, float x, float y) const {
+            const float *c = coeff[table];
+            return c[0] + x * c[1] + y * (c[2] + x * c[3]);
+        }
+    };
+
 private:
+    /*
+      find the cell for a location, returning false if it is outside
+      the valid input range
+     */
+    static bool find_cell(float latitude_deg, float longitude_deg, int32_t &min_lat, int32_t &min_lon);
+
     static const float SAMPLING_RES;
     static const float SAMPLING_MIN_LAT;
     static const float SAMPLING_MAX_LAT;
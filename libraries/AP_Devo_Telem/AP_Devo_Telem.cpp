@@ -29,6 +29,7 @@
 #include <AP_AHRS/AP_AHRS.h>
 #include <AP_GPS/AP_GPS.h>
 #include <AP_BattMonitor/AP_BattMonitor.h>
+#include <AP_SerialManager/AP_SerialFrame.h>
 #include <GCS_MAVLink/GCS.h>
 
 extern const AP_HAL::HAL& hal;
@@ -113,15 +114,12 @@ void AP_DEVO_Telem::send_frames()
     devoPacket.volt = roundf(AP::battery().voltage() * 10.0f);
     devoPacket.temp = gcs().custom_mode(); // Send mode as temperature
 
-    // emit the packet to the port byte-by-byte, calculating checksum
-    // as we go.  Note we are stepping backwards through the structure
-    // - presumably to get endianness correct on the entries!
-    uint8_t *b = (uint8_t *)&devoPacket;
-    for (uint8_t i = sizeof(devoPacket)-1; i !=0; i--) {
-        _port->write(b, 1);
-        devoPacket.checksum8 += *b++; // Add Checksum
-    }
-    _port->write(&devoPacket.checksum8, 1);
+    // emit the packet to the port in one frame, ending with the sum
+    // of the bytes before the checksum
+    const uint8_t *b = (const uint8_t *)&devoPacket;
+    devoPacket.checksum8 = AP_SerialFrame::sum8(b, sizeof(devoPacket)-1);
+    AP_SerialFrame out(_port, AP_SerialFrame::Protocol::DEVO, sizeof(devoPacket));
+    out.put(b, sizeof(devoPacket));
 }
 
 void AP_DEVO_Telem::tick(void)
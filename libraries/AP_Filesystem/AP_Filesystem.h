@@ -31,6 +31,9 @@
 #if CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL
 #include "AP_Filesystem_posix.h"
 #endif
+#include "AP_Filesystem_Sys.h"
+#include "AP_Filesystem_ROMFS.h"
+#include "AP_Filesystem_Async.h"
 
 class AP_Filesystem {
 
@@ -59,6 +62,20 @@ public:
 
     // set modification time on a file
     bool set_mtime(const char *filename, const time_t mtime_sec);
+
+    // allocate size bytes of contiguous space for an empty file
+    // opened for writing, so writing it doesn't allocate as it
+    // goes. The file may then read as size bytes long until it is
+    // truncated to the length written with ftruncate(). Returns
+    // false if the space can't be allocated
+    bool fpreallocate(int fd, uint32_t size);
+
+    // set the length of a file open for writing
+    int ftruncate(int fd, off_t length);
+
+    // return the allocation unit of the filesystem a file is on in
+    // bytes, 0 on error
+    uint32_t cluster_size(int fd);
 };
 
 namespace AP {
@@ -0,0 +1,291 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  asynchronous file IO on the IO thread
+ */
+
+#include "AP_Filesystem.h"
+
+#if HAVE_FILESYSTEM_SUPPORT
+
+#include <AP_Math/AP_Math.h>
+#include <fcntl.h>
+
+extern const AP_HAL::HAL& hal;
+
+static AP_Filesystem_Async fs_async;
+
+enum class ChunkState : uint8_t {
+    EMPTY,
+    PENDING,    // waiting for the IO thread
+    BUSY,       // being read by the IO thread
+    READY,
+    FAILED,
+};
+
+struct AP_Filesystem_Async::ReadAhead {
+    int fd;
+    uint32_t chunk_size;
+    uint8_t *buf;               // two chunks of chunk_size
+    struct {
+        uint32_t ofs;           // file offset of the chunk
+        uint32_t len;           // bytes read, less than chunk_size at end of file
+        ChunkState state;
+    } chunk[2];
+    ReadAhead *next;
+};
+
+void AP_Filesystem_Async::init()
+{
+    if (initialised) {
+        return;
+    }
+    initialised = true;
+    hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&AP_Filesystem_Async::io_timer, void));
+}
+
+bool AP_Filesystem_Async::read(int fd, uint32_t offset, void *buf, uint32_t count, completion_fn_t cb)
+{
+    WITH_SEMAPHORE(sem);
+    init();
+    if (num_requests == ARRAY_SIZE(requests)) {
+        return false;
+    }
+    struct request &r = requests[(request_head + num_requests) % ARRAY_SIZE(requests)];
+    r.op = Op::READ;
+    r.fd = fd;
+    r.offset = offset;
+    r.buf = (uint8_t *)buf;
+    r.count = count;
+    r.cb = cb;
+    num_requests++;
+    return true;
+}
+
+bool AP_Filesystem_Async::write(int fd, uint32_t offset, const void *buf, uint32_t count, completion_fn_t cb)
+{
+    WITH_SEMAPHORE(sem);
+    init();
+    if (num_requests == ARRAY_SIZE(requests)) {
+        return false;
+    }
+    struct request &r = requests[(request_head + num_requests) % ARRAY_SIZE(requests)];
+    r.op = Op::WRITE;
+    r.fd = fd;
+    r.offset = offset;
+    r.buf = (uint8_t *)const_cast<void *>(buf);
+    r.count = count;
+    r.cb = cb;
+    num_requests++;
+    return true;
+}
+
+AP_Filesystem_Async::ReadAhead *AP_Filesystem_Async::open_readahead(const char *pathname, uint32_t chunk_size)
+{
+    ReadAhead *r = new ReadAhead;
+    if (r == nullptr) {
+        return nullptr;
+    }
+    r->buf = (uint8_t *)malloc(2 * chunk_size);
+    if (r->buf == nullptr) {
+        delete r;
+        return nullptr;
+    }
+    r->fd = AP::FS().open(pathname, O_RDONLY);
+    if (r->fd == -1) {
+        free(r->buf);
+        delete r;
+        return nullptr;
+    }
+    r->chunk_size = chunk_size;
+    // start reading from the beginning of the file straight away
+    r->chunk[0].ofs = 0;
+    r->chunk[0].len = 0;
+    r->chunk[0].state = ChunkState::PENDING;
+    r->chunk[1].ofs = chunk_size;
+    r->chunk[1].len = 0;
+    r->chunk[1].state = ChunkState::PENDING;
+
+    WITH_SEMAPHORE(io_sem);
+    WITH_SEMAPHORE(sem);
+    init();
+    r->next = readaheads;
+    readaheads = r;
+    return r;
+}
+
+int32_t AP_Filesystem_Async::read_ahead(ReadAhead *r, uint32_t ofs, void *buf, uint32_t count)
+{
+    WITH_SEMAPHORE(sem);
+
+    uint8_t *b = (uint8_t *)buf;
+    uint32_t total = 0;
+    int8_t last = -1;
+    while (total < count) {
+        const uint32_t pos = ofs + total;
+        int8_t idx = -1;
+        for (uint8_t i=0; i<2; i++) {
+            if (pos >= r->chunk[i].ofs && pos < r->chunk[i].ofs + r->chunk_size) {
+                idx = i;
+            }
+        }
+        if (idx == -1) {
+            // not buffered, restart the read-ahead at pos, keeping
+            // the chunk we have just read from
+            for (uint8_t i=0; i<2; i++) {
+                auto &c = r->chunk[i];
+                if (i != last && c.state != ChunkState::BUSY) {
+                    c.ofs = pos;
+                    c.state = ChunkState::PENDING;
+                    if (last == -1 && r->chunk[1-i].state != ChunkState::BUSY) {
+                        r->chunk[1-i].ofs = pos + r->chunk_size;
+                        r->chunk[1-i].state = ChunkState::PENDING;
+                    }
+                    break;
+                }
+            }
+            return AP_FILESYSTEM_ASYNC_PENDING;
+        }
+        auto &c = r->chunk[idx];
+        if (c.state == ChunkState::FAILED) {
+            return -1;
+        }
+        if (c.state != ChunkState::READY) {
+            // nothing has been consumed, so a retry will find the
+            // data read so far still in the buffer
+            return AP_FILESYSTEM_ASYNC_PENDING;
+        }
+        if (pos >= c.ofs + c.len) {
+            // end of file
+            break;
+        }
+        const uint32_t n = MIN(count - total, c.ofs + c.len - pos);
+        memcpy(&b[total], &r->buf[idx * r->chunk_size + (pos - c.ofs)], n);
+        total += n;
+        last = idx;
+    }
+
+    if (last != -1) {
+        // once the reader has moved on from a chunk refill it with
+        // the data after the chunk it is now reading
+        const auto &c = r->chunk[last];
+        auto &other = r->chunk[1-last];
+        if (other.ofs < c.ofs && c.len == r->chunk_size && other.state != ChunkState::BUSY) {
+            other.ofs = c.ofs + r->chunk_size;
+            other.state = ChunkState::PENDING;
+        }
+    }
+    return total;
+}
+
+void AP_Filesystem_Async::close_readahead(ReadAhead *r)
+{
+    if (r == nullptr) {
+        return;
+    }
+    WITH_SEMAPHORE(io_sem);
+    {
+        WITH_SEMAPHORE(sem);
+        for (ReadAhead **p = &readaheads; *p != nullptr; p = &(*p)->next) {
+            if (*p == r) {
+                *p = r->next;
+                break;
+            }
+        }
+    }
+    AP::FS().close(r->fd);
+    free(r->buf);
+    delete r;
+}
+
+bool AP_Filesystem_Async::fill_readahead(ReadAhead *r)
+{
+    uint8_t idx;
+    uint32_t ofs;
+    {
+        WITH_SEMAPHORE(sem);
+        // read the pending chunk nearest the start of the file first,
+        // as the reader will want it first
+        idx = 2;
+        for (uint8_t i=0; i<2; i++) {
+            if (r->chunk[i].state == ChunkState::PENDING &&
+                (idx == 2 || r->chunk[i].ofs < r->chunk[idx].ofs)) {
+                idx = i;
+            }
+        }
+        if (idx == 2) {
+            return false;
+        }
+        r->chunk[idx].state = ChunkState::BUSY;
+        ofs = r->chunk[idx].ofs;
+    }
+
+    int32_t ret = -1;
+    if (AP::FS().lseek(r->fd, ofs, SEEK_SET) == (off_t)ofs) {
+        ret = AP::FS().read(r->fd, &r->buf[idx * r->chunk_size], r->chunk_size);
+    }
+
+    WITH_SEMAPHORE(sem);
+    // a busy chunk is never moved by the reader, so it is still at ofs
+    auto &c = r->chunk[idx];
+    if (ret < 0) {
+        c.state = ChunkState::FAILED;
+    } else {
+        c.len = ret;
+        c.state = ChunkState::READY;
+    }
+    return true;
+}
+
+void AP_Filesystem_Async::io_timer()
+{
+    while (true) {
+        struct request req;
+        {
+            WITH_SEMAPHORE(sem);
+            if (num_requests == 0) {
+                break;
+            }
+            req = requests[request_head];
+            request_head = (request_head + 1) % ARRAY_SIZE(requests);
+            num_requests--;
+        }
+        int32_t ret = -1;
+        if (AP::FS().lseek(req.fd, req.offset, SEEK_SET) == (off_t)req.offset) {
+            if (req.op == Op::READ) {
+                ret = AP::FS().read(req.fd, req.buf, req.count);
+            } else {
+                ret = AP::FS().write(req.fd, req.buf, req.count);
+            }
+        }
+        req.cb(ret);
+    }
+
+    WITH_SEMAPHORE(io_sem);
+    for (ReadAhead *r = readaheads; r != nullptr; r = r->next) {
+        while (fill_readahead(r)) {
+        }
+    }
+}
+
+namespace AP
+{
+AP_Filesystem_Async &FS_Async()
+{
+    return fs_async;
+}
+}
+
+#endif // HAVE_FILESYSTEM_SUPPORT
@@ -0,0 +1,105 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  asynchronous file IO, carried out on the IO thread so that callers
+  on the main or scripting threads don't block on the filesystem
+ */
+#pragma once
+
+#include "AP_Filesystem_Available.h"
+
+#if HAVE_FILESYSTEM_SUPPORT
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/Semaphores.h>
+
+#define AP_FILESYSTEM_ASYNC_MAX_REQUESTS 8
+
+// returned by read_ahead() when the data has not been read yet
+#define AP_FILESYSTEM_ASYNC_PENDING -2
+
+class AP_Filesystem_Async {
+public:
+    // called on the IO thread when a request completes, with the
+    // number of bytes read or written, or -1 on error
+    FUNCTOR_TYPEDEF(completion_fn_t, void, int32_t);
+
+    /*
+      queue a read or write of count bytes at offset of an open
+      file. The fd and buffer must not be used by anyone else until
+      the callback has been called. Returns false if the queue is full
+     */
+    bool read(int fd, uint32_t offset, void *buf, uint32_t count, completion_fn_t cb);
+    bool write(int fd, uint32_t offset, const void *buf, uint32_t count, completion_fn_t cb);
+
+    /*
+      a file read through two buffers of chunk_size bytes, which the IO
+      thread keeps filled with the data after the position being read
+     */
+    struct ReadAhead;
+
+    // open a file for read-ahead, returns nullptr on failure
+    ReadAhead *open_readahead(const char *pathname, uint32_t chunk_size);
+
+    // read up to count bytes from offset ofs without blocking. Returns
+    // the number of bytes read, 0 at the end of the file,
+    // AP_FILESYSTEM_ASYNC_PENDING if the data is still being read
+    // or -1 on error. Reading away from the buffered data restarts
+    // the read-ahead at the new offset
+    int32_t read_ahead(ReadAhead *r, uint32_t ofs, void *buf, uint32_t count);
+
+    // close a read-ahead file. Waits for any read of it in progress
+    void close_readahead(ReadAhead *r);
+
+private:
+    // start the IO thread callback on first use
+    void init();
+
+    // carry out queued requests and fill read-ahead buffers
+    void io_timer();
+
+    // fill one pending read-ahead buffer of r, returns true if one was read
+    bool fill_readahead(ReadAhead *r);
+
+    enum class Op : uint8_t {
+        READ,
+        WRITE,
+    };
+
+    struct request {
+        Op op;
+        int fd;
+        uint32_t offset;
+        uint8_t *buf;
+        uint32_t count;
+        completion_fn_t cb;
+    } requests[AP_FILESYSTEM_ASYNC_MAX_REQUESTS];
+    uint8_t request_head;
+    uint8_t num_requests;
+
+    ReadAhead *readaheads;
+    bool initialised;
+
+    // protects the request queue and the state of read-ahead buffers
+    HAL_Semaphore sem;
+    // held by the IO thread while it reads for read-ahead files
+    HAL_Semaphore io_sem;
+};
+
+namespace AP {
+    AP_Filesystem_Async &FS_Async();
+};
+
+#endif // HAVE_FILESYSTEM_SUPPORT
@@ -278,6 +278,13 @@ static bool remount_file_system(void)
 
 int AP_Filesystem::open(const char *pathname, int flags)
 {
+    if (AP_Filesystem_Sys::is_sys_path(pathname)) {
+        return AP::FS_Sys().open(pathname, flags);
+    }
+    if (AP_Filesystem_ROMFS::is_romfs_path(pathname)) {
+        return AP::FS_ROMFS().open(pathname, flags);
+    }
+
     int fileno;
     int fatfs_modes;
     FAT_FILE *stream;
@@ -354,6 +361,13 @@ int AP_Filesystem::open(const char *pathname, int flags)
 
 int AP_Filesystem::close(int fileno)
 {
+    if (AP_Filesystem_Sys::is_sys_fd(fileno)) {
+        return AP::FS_Sys().close(fileno);
+    }
+    if (AP_Filesystem_ROMFS::is_romfs_fd(fileno)) {
+        return AP::FS_ROMFS().close(fileno);
+    }
+
     FAT_FILE *stream;
     FIL *fh;
     int res;
@@ -384,6 +398,13 @@ int AP_Filesystem::close(int fileno)
 
 ssize_t AP_Filesystem::read(int fd, void *buf, size_t count)
 {
+    if (AP_Filesystem_Sys::is_sys_fd(fd)) {
+        return AP::FS_Sys().read(fd, buf, count);
+    }
+    if (AP_Filesystem_ROMFS::is_romfs_fd(fd)) {
+        return AP::FS_ROMFS().read(fd, buf, count);
+    }
+
     UINT bytes = count;
     int res;
     FIL *fh;
@@ -505,8 +526,96 @@ int AP_Filesystem::fsync(int fileno)
     return 0;
 }
 
+/*
+  preallocate a contiguous area for an empty file. Writes within it
+  need no FAT chain updates. The file size is set to the allocated
+  size, so the file must be truncated when it is closed
+ */
+bool AP_Filesystem::fpreallocate(int fileno, uint32_t size)
+{
+    FAT_FILE *stream;
+    FIL *fh;
+    int res;
+
+    WITH_SEMAPHORE(sem);
+
+    errno = 0;
+
+    // checks if fileno out of bounds
+    stream = fileno_to_stream(fileno);
+    if (stream == NULL) {
+        return false;
+    }
+
+    // fileno_to_fatfs checks for fileno out of bounds
+    fh = fileno_to_fatfs(fileno);
+    if (fh == NULL) {
+        return false;
+    }
+    res = f_expand(fh, size, 1);
+    if (res != FR_OK) {
+        errno = fatfs_to_errno((FRESULT)res);
+        return false;
+    }
+    return true;
+}
+
+int AP_Filesystem::ftruncate(int fileno, off_t length)
+{
+    FAT_FILE *stream;
+    FIL *fh;
+    int res;
+
+    WITH_SEMAPHORE(sem);
+
+    errno = 0;
+
+    // checks if fileno out of bounds
+    stream = fileno_to_stream(fileno);
+    if (stream == NULL) {
+        return -1;
+    }
+
+    // fileno_to_fatfs checks for fileno out of bounds
+    fh = fileno_to_fatfs(fileno);
+    if (fh == NULL) {
+        return -1;
+    }
+    const FSIZE_t pos = f_tell(fh);
+    res = f_lseek(fh, length);
+    if (res == FR_OK) {
+        res = f_truncate(fh);
+    }
+    if (res == FR_OK && pos < FSIZE_t(length)) {
+        res = f_lseek(fh, pos);
+    }
+    if (res != FR_OK) {
+        errno = fatfs_to_errno((FRESULT)res);
+        return -1;
+    }
+    return 0;
+}
+
+uint32_t AP_Filesystem::cluster_size(int fileno)
+{
+    WITH_SEMAPHORE(sem);
+
+    FIL *fh = fileno_to_fatfs(fileno);
+    if (fh == NULL || fh->obj.fs == NULL) {
+        return 0;
+    }
+    return uint32_t(fh->obj.fs->csize) * FF_MAX_SS;
+}
+
 off_t AP_Filesystem::lseek(int fileno, off_t position, int whence)
 {
+    if (AP_Filesystem_Sys::is_sys_fd(fileno)) {
+        return AP::FS_Sys().lseek(fileno, position, whence);
+    }
+    if (AP_Filesystem_ROMFS::is_romfs_fd(fileno)) {
+        return AP::FS_ROMFS().lseek(fileno, position, whence);
+    }
+
     FRESULT res;
     FIL *fh;
     errno = 0;
@@ -598,6 +707,13 @@ static time_t fat_time_to_unix(uint16_t date, uint16_t time)
 
 int AP_Filesystem::stat(const char *name, struct stat *buf)
 {
+    if (AP_Filesystem_Sys::is_sys_path(name)) {
+        return AP::FS_Sys().stat(name, buf);
+    }
+    if (AP_Filesystem_ROMFS::is_romfs_path(name)) {
+        return AP::FS_ROMFS().stat(name, buf);
+    }
+
     FILINFO info;
     int res;
     time_t epoch;
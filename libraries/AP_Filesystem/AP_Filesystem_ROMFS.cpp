@@ -0,0 +1,144 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  read-only embedded files under @ROMFS/
+ */
+
+#include "AP_Filesystem.h"
+
+#if HAVE_FILESYSTEM_SUPPORT
+
+#include <AP_Math/AP_Math.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+
+static AP_Filesystem_ROMFS fs_romfs;
+
+bool AP_Filesystem_ROMFS::is_romfs_path(const char *pathname)
+{
+    return strncmp(pathname, AP_FILESYSTEM_ROMFS_PREFIX, strlen(AP_FILESYSTEM_ROMFS_PREFIX)) == 0;
+}
+
+AP_ROMFS::Stream *AP_Filesystem_ROMFS::get_stream(int fd) const
+{
+    if (!is_romfs_fd(fd)) {
+        return nullptr;
+    }
+    return streams[fd - AP_FILESYSTEM_ROMFS_FD_BASE];
+}
+
+int AP_Filesystem_ROMFS::open(const char *pathname, int flags)
+{
+    if ((flags & O_ACCMODE) != O_RDONLY) {
+        errno = EROFS;
+        return -1;
+    }
+    uint8_t idx;
+    for (idx=0; idx<ARRAY_SIZE(streams); idx++) {
+        if (streams[idx] == nullptr) {
+            break;
+        }
+    }
+    if (idx == ARRAY_SIZE(streams)) {
+        errno = ENFILE;
+        return -1;
+    }
+    streams[idx] = AP_ROMFS::open(pathname + strlen(AP_FILESYSTEM_ROMFS_PREFIX));
+    if (streams[idx] == nullptr) {
+        errno = ENOENT;
+        return -1;
+    }
+    return AP_FILESYSTEM_ROMFS_FD_BASE + idx;
+}
+
+int AP_Filesystem_ROMFS::close(int fd)
+{
+    AP_ROMFS::Stream *s = get_stream(fd);
+    if (s == nullptr) {
+        errno = EBADF;
+        return -1;
+    }
+    AP_ROMFS::close(s);
+    streams[fd - AP_FILESYSTEM_ROMFS_FD_BASE] = nullptr;
+    return 0;
+}
+
+ssize_t AP_Filesystem_ROMFS::read(int fd, void *buf, size_t count)
+{
+    AP_ROMFS::Stream *s = get_stream(fd);
+    if (s == nullptr) {
+        errno = EBADF;
+        return -1;
+    }
+    const int32_t ret = s->read(buf, MIN(count, size_t(INT32_MAX)));
+    if (ret < 0) {
+        errno = EIO;
+        return -1;
+    }
+    return ret;
+}
+
+off_t AP_Filesystem_ROMFS::lseek(int fd, off_t offset, int whence)
+{
+    AP_ROMFS::Stream *s = get_stream(fd);
+    if (s == nullptr) {
+        errno = EBADF;
+        return -1;
+    }
+    switch (whence) {
+    case SEEK_SET:
+        break;
+    case SEEK_CUR:
+        offset += s->tell();
+        break;
+    case SEEK_END:
+        offset += s->size();
+        break;
+    default:
+        errno = EINVAL;
+        return -1;
+    }
+    if (offset < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    s->seek(MIN(uint32_t(offset), s->size()));
+    return s->tell();
+}
+
+int AP_Filesystem_ROMFS::stat(const char *pathname, struct stat *stbuf)
+{
+    AP_ROMFS::Stream *s = AP_ROMFS::open(pathname + strlen(AP_FILESYSTEM_ROMFS_PREFIX));
+    if (s == nullptr) {
+        errno = ENOENT;
+        return -1;
+    }
+    memset(stbuf, 0, sizeof(*stbuf));
+    stbuf->st_mode = S_IFREG | 0444;
+    stbuf->st_size = s->size();
+    AP_ROMFS::close(s);
+    return 0;
+}
+
+namespace AP
+{
+AP_Filesystem_ROMFS &FS_ROMFS()
+{
+    return fs_romfs;
+}
+}
+
+#endif // HAVE_FILESYSTEM_SUPPORT
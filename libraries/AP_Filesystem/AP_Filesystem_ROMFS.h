@@ -0,0 +1,63 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  read-only access to the files embedded in the firmware under
+  @ROMFS/, decompressed as they are read
+ */
+#pragma once
+
+#include "AP_Filesystem_Available.h"
+
+#if HAVE_FILESYSTEM_SUPPORT
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <AP_ROMFS/AP_ROMFS.h>
+
+#define AP_FILESYSTEM_ROMFS_PREFIX "@ROMFS/"
+
+// file descriptors for @ROMFS files start here, above those of @SYS files
+#define AP_FILESYSTEM_ROMFS_FD_BASE 1010
+#define AP_FILESYSTEM_ROMFS_MAX_OPEN 4
+
+class AP_Filesystem_ROMFS {
+public:
+    // return true if pathname is an @ROMFS file
+    static bool is_romfs_path(const char *pathname);
+
+    // return true if fd is an open @ROMFS file
+    static bool is_romfs_fd(int fd) {
+        return fd >= AP_FILESYSTEM_ROMFS_FD_BASE && fd < AP_FILESYSTEM_ROMFS_FD_BASE + AP_FILESYSTEM_ROMFS_MAX_OPEN;
+    }
+
+    int open(const char *pathname, int flags);
+    int close(int fd);
+    ssize_t read(int fd, void *buf, size_t count);
+    off_t lseek(int fd, off_t offset, int whence);
+    int stat(const char *pathname, struct stat *stbuf);
+
+private:
+    // open stream of an fd, or nullptr
+    AP_ROMFS::Stream *get_stream(int fd) const;
+
+    AP_ROMFS::Stream *streams[AP_FILESYSTEM_ROMFS_MAX_OPEN];
+};
+
+namespace AP {
+    AP_Filesystem_ROMFS &FS_ROMFS();
+};
+
+#endif // HAVE_FILESYSTEM_SUPPORT
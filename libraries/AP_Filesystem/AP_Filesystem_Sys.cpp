@@ -0,0 +1,556 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  read-only system information files under @SYS/
+ */
+
+#include "AP_Filesystem.h"
+
+#if HAVE_FILESYSTEM_SUPPORT
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Scripting/AP_Scripting.h>
+#include <AP_Common/AP_BootTrace.h>
+#if HAL_WITH_UAVCAN
+#include <AP_UAVCAN/AP_UAVCAN.h>
+#endif
+#include <AP_Frsky_Telem/AP_Frsky_Telem.h>
+#include <AP_SerialManager/AP_SerialFrame.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+
+extern const AP_HAL::HAL& hal;
+
+static AP_Filesystem_Sys fs_sys;
+
+bool AP_Filesystem_Sys::is_sys_path(const char *pathname)
+{
+    return strncmp(pathname, AP_FILESYSTEM_SYS_PREFIX, strlen(AP_FILESYSTEM_SYS_PREFIX)) == 0;
+}
+
+/*
+  one line per thread with its share of the CPU over the last second,
+  the lowest free stack it has had and, for periodic threads, how late
+  it has been woken
+ */
+char *AP_Filesystem_Sys::threads_txt(uint32_t &size) const
+{
+    const uint8_t line_len = 56;
+    AP_HAL::Util::ThreadStats stats;
+    uint8_t n = 0;
+    while (hal.util->get_thread_stats(n, stats)) {
+        n++;
+    }
+    const uint32_t buf_size = (n + 1U) * line_len;
+    char *buf = (char *)malloc(buf_size);
+    if (buf == nullptr) {
+        return nullptr;
+    }
+    int len = hal.util->snprintf(buf, buf_size, "%-16s %6s %8s %7s %7s\n",
+                                 "Thread", "Load%", "StackFree", "JitAvg", "JitMax");
+    for (uint8_t i=0; i<n && hal.util->get_thread_stats(i, stats); i++) {
+        len += hal.util->snprintf(&buf[len], buf_size - len, "%-16s %4u.%u %8u %7u %7u\n",
+                                  stats.name,
+                                  unsigned(stats.load / 10),
+                                  unsigned(stats.load % 10),
+                                  unsigned(stats.stack_free),
+                                  unsigned(stats.jitter_avg_us),
+                                  unsigned(stats.jitter_max_us));
+    }
+    size = MIN(uint32_t(len), buf_size - 1);
+    return buf;
+}
+
+/*
+  pool and heap statistics for each memory type, then the bytes of
+  each type allocated by each owner. Static RAM by library is in the
+  .memory.txt file written next to the firmware by the build
+ */
+char *AP_Filesystem_Sys::memory_txt(uint32_t &size) const
+{
+    uint8_t num_owners = 0;
+    AP_HAL::Util::MemoryOwnerStats owner;
+    while (hal.util->get_memory_owner_stats(num_owners, owner)) {
+        num_owners++;
+    }
+    const uint16_t line_len = 64;
+    const uint16_t buf_size = (num_owners + 6U) * line_len;
+    char *buf = (char *)malloc(buf_size);
+    if (buf == nullptr) {
+        return nullptr;
+    }
+    static const struct {
+        AP_HAL::Util::Memory_Type type;
+        const char *name;
+    } types[] = {
+        { AP_HAL::Util::MEM_DMA_SAFE, "DMA" },
+        { AP_HAL::Util::MEM_FAST, "FAST" },
+    };
+    int len = hal.util->snprintf(buf, buf_size, "%-5s %7s %7s %7s %7s %7s %5s %7s %7s\n",
+                                 "Type", "Alloc", "Peak", "ArenaF", "PoolN", "HeapN", "Fail", "HeapF", "Largest");
+    for (uint8_t i=0; i<ARRAY_SIZE(types); i++) {
+        AP_HAL::Util::MemoryStats stats;
+        if (!hal.util->get_memory_stats(types[i].type, stats)) {
+            continue;
+        }
+        len += hal.util->snprintf(&buf[len], buf_size - len, "%-5s %7u %7u %7u %7u %7u %5u %7u %7u\n",
+                                  types[i].name,
+                                  unsigned(stats.allocated),
+                                  unsigned(stats.peak),
+                                  unsigned(stats.arena_free),
+                                  unsigned(stats.pool_allocs),
+                                  unsigned(stats.heap_allocs),
+                                  unsigned(stats.failures),
+                                  unsigned(stats.heap_free),
+                                  unsigned(stats.heap_largest));
+    }
+    len += hal.util->snprintf(&buf[len], buf_size - len, "\n%-12s %7s %7s %7s %6s %5s\n",
+                              "Owner", "DMA", "FAST", "Peak", "Allocs", "Fail");
+    for (uint8_t i=0; i<num_owners && hal.util->get_memory_owner_stats(i, owner); i++) {
+        len += hal.util->snprintf(&buf[len], buf_size - len, "%-12.12s %7u %7u %7u %6u %5u\n",
+                                  owner.owner,
+                                  unsigned(owner.allocated[AP_HAL::Util::MEM_DMA_SAFE]),
+                                  unsigned(owner.allocated[AP_HAL::Util::MEM_FAST]),
+                                  unsigned(owner.peak),
+                                  unsigned(owner.allocs),
+                                  unsigned(owner.failures));
+    }
+    size = MIN(uint32_t(len), buf_size - 1U);
+    return buf;
+}
+
+/*
+  storage write statistics. WAmp is the write amplification, the bytes
+  written to the backend for each byte changed
+ */
+char *AP_Filesystem_Sys::storage_txt(uint32_t &size) const
+{
+    AP_HAL::Storage::Stats stats;
+    if (!hal.storage->get_stats(stats)) {
+        return nullptr;
+    }
+    const uint8_t buf_size = 128;
+    char *buf = (char *)malloc(buf_size);
+    if (buf == nullptr) {
+        return nullptr;
+    }
+    const uint32_t wamp = stats.bytes_dirtied ? uint64_t(stats.bytes_written) * 100U / stats.bytes_dirtied : 0;
+    int len = hal.util->snprintf(buf, buf_size, "%8s %8s %6s %6s %6s %7s %8s\n",
+                                 "Dirtied", "Written", "WAmp", "Writes", "Erases", "Compact", "StallMax");
+    len += hal.util->snprintf(&buf[len], buf_size - len, "%8u %8u %3u.%02u %6u %6u %7u %8u\n",
+                              unsigned(stats.bytes_dirtied),
+                              unsigned(stats.bytes_written),
+                              unsigned(wamp / 100),
+                              unsigned(wamp % 100),
+                              unsigned(stats.writes),
+                              unsigned(stats.erases),
+                              unsigned(stats.compactions),
+                              unsigned(stats.stall_max_us));
+    size = MIN(uint32_t(len), buf_size - 1U);
+    return buf;
+}
+
+/*
+  script heap statistics. Frag is the share of the free space that is
+  not in the largest free block
+ */
+char *AP_Filesystem_Sys::scripting_txt(uint32_t &size) const
+{
+#ifdef ENABLE_SCRIPTING
+    AP_HAL::Util::HeapStats stats;
+    const AP_Scripting *scripting = AP::scripting();
+    if (scripting == nullptr || !scripting->heap_stats(stats)) {
+        return nullptr;
+    }
+    const uint8_t buf_size = 128;
+    char *buf = (char *)malloc(buf_size);
+    if (buf == nullptr) {
+        return nullptr;
+    }
+    const uint32_t frag = stats.free ? 100U - uint64_t(stats.largest_free) * 100U / stats.free : 0;
+    int len = hal.util->snprintf(buf, buf_size, "%7s %7s %7s %7s %7s %4s %8s %5s\n",
+                                 "Size", "Used", "Peak", "Free", "Largest", "Frag", "Allocs", "Fail");
+    len += hal.util->snprintf(&buf[len], buf_size - len, "%7u %7u %7u %7u %7u %3u%% %8u %5u\n",
+                              unsigned(stats.size),
+                              unsigned(stats.used),
+                              unsigned(stats.peak),
+                              unsigned(stats.free),
+                              unsigned(stats.largest_free),
+                              unsigned(frag),
+                              unsigned(stats.allocs),
+                              unsigned(stats.failures));
+    size = MIN(uint32_t(len), buf_size - 1U);
+    return buf;
+#else
+    return nullptr;
+#endif
+}
+
+/*
+  one line per loaded script, the running one marked with a *. Times
+  are in microseconds, and Inst and Alloc are for the last run
+ */
+char *AP_Filesystem_Sys::scripts_txt(uint32_t &size) const
+{
+#ifdef ENABLE_SCRIPTING
+    const AP_Scripting *scripting = AP::scripting();
+    if (scripting == nullptr) {
+        return nullptr;
+    }
+    const uint8_t line_len = 96;
+    AP_Scripting::ScriptStats stats;
+    uint8_t n = 0;
+    while (scripting->script_stats(n, stats)) {
+        n++;
+    }
+    const uint32_t buf_size = (n + 1U) * line_len;
+    char *buf = (char *)malloc(buf_size);
+    if (buf == nullptr) {
+        return nullptr;
+    }
+    int len = hal.util->snprintf(buf, buf_size, "%-24s %7s %7s %7s %7s %7s %7s %7s\n",
+                                 "Script", "Runs", "Last", "Avg", "Max", "Inst", "Alloc", "Mem");
+    for (uint8_t i=0; i<n && scripting->script_stats(i, stats); i++) {
+        len += hal.util->snprintf(&buf[len], buf_size - len, "%-23.23s%c %7u %7u %7u %7u %7u %7u %7d\n",
+                                  stats.name,
+                                  stats.running ? '*' : ' ',
+                                  unsigned(stats.run_count),
+                                  unsigned(stats.run_time_us),
+                                  unsigned(stats.run_count ? stats.run_time_total_us / stats.run_count : 0),
+                                  unsigned(stats.run_time_max_us),
+                                  unsigned(stats.instructions),
+                                  unsigned(stats.alloc_bytes),
+                                  int(stats.mem_resident));
+    }
+    size = MIN(uint32_t(len), buf_size - 1);
+    return buf;
+#else
+    return nullptr;
+#endif
+}
+
+/*
+  one line per stage of the vehicle init with its start time since
+  boot and how long it took, in microseconds
+ */
+char *AP_Filesystem_Sys::boot_txt(uint32_t &size) const
+{
+    const uint8_t line_len = 40;
+    const uint8_t n = AP_BootTrace::num_stages();
+    const uint32_t buf_size = (n + 1U) * line_len;
+    char *buf = (char *)malloc(buf_size);
+    if (buf == nullptr) {
+        return nullptr;
+    }
+    int len = hal.util->snprintf(buf, buf_size, "%-16s %10s %10s\n",
+                                 "Stage", "Start", "Dur");
+    AP_BootTrace::Stage stage;
+    for (uint8_t i=0; AP_BootTrace::get_stage(i, stage); i++) {
+        len += hal.util->snprintf(&buf[len], buf_size - len, "%-16.16s %10u %10u\n",
+                                  stage.name,
+                                  unsigned(stage.start_us),
+                                  unsigned(stage.duration_us));
+    }
+    size = MIN(uint32_t(len), buf_size - 1);
+    return buf;
+}
+
+/*
+  node memory pool and error counts for each UAVCAN driver. Pool
+  figures are in blocks of UAVCAN_NODE_POOL_BLOCK_SIZE bytes, and Fail
+  counts the allocations refused, each of which dropped a transfer
+ */
+char *AP_Filesystem_Sys::uavcan_txt(uint32_t &size) const
+{
+#if HAL_WITH_UAVCAN
+    const uint8_t line_len = 64;
+    const uint32_t buf_size = (MAX_NUMBER_OF_CAN_DRIVERS + 1U) * line_len;
+    char *buf = (char *)malloc(buf_size);
+    if (buf == nullptr) {
+        return nullptr;
+    }
+    int len = hal.util->snprintf(buf, buf_size, "%3s %6s %6s %6s %8s %8s %8s\n",
+                                 "Drv", "Cap", "Used", "Peak", "Fail", "TErr", "CErr");
+    for (uint8_t i=0; i<MAX_NUMBER_OF_CAN_DRIVERS; i++) {
+        AP_UAVCAN *uavcan = AP_UAVCAN::get_uavcan(i);
+        AP_UAVCAN::Stats stats;
+        if (uavcan == nullptr || !uavcan->get_stats(stats)) {
+            continue;
+        }
+        len += hal.util->snprintf(&buf[len], buf_size - len, "%3u %6u %6u %6u %8u %8u %8u\n",
+                                  unsigned(i + 1),
+                                  unsigned(stats.pool.capacity),
+                                  unsigned(stats.pool.used),
+                                  unsigned(stats.pool.peak),
+                                  unsigned(stats.pool.failures),
+                                  unsigned(stats.transfer_errors),
+                                  unsigned(stats.can_errors));
+    }
+    size = MIN(uint32_t(len), buf_size - 1);
+    return buf;
+#else
+    return nullptr;
+#endif
+}
+
+/*
+  FrSky passthrough polls per second and, for each packet, how often it
+  has been sent and how old the copy the receiver holds is now and has
+  been at worst, in milliseconds
+ */
+char *AP_Filesystem_Sys::frsky_txt(uint32_t &size) const
+{
+    const AP_Frsky_Telem *frsky = AP::frsky_telem();
+    if (frsky == nullptr) {
+        return nullptr;
+    }
+    const uint8_t line_len = 48;
+    const uint32_t buf_size = (TIME_SLOT_MAX + 2U) * line_len;
+    char *buf = (char *)malloc(buf_size);
+    if (buf == nullptr) {
+        return nullptr;
+    }
+    int len = hal.util->snprintf(buf, buf_size, "Rate %.1f\n%-10s %8s %8s %8s\n",
+                                 (double)frsky->get_passthrough_slot_rate(),
+                                 "Packet", "Sent", "Age", "MaxAge");
+    const char *name;
+    AP_WFQ_Scheduler<TIME_SLOT_MAX>::ItemStats stats;
+    for (uint8_t i=0; frsky->get_passthrough_stats(i, name, stats); i++) {
+        len += hal.util->snprintf(&buf[len], buf_size - len, "%-10s %8u %8u %8u\n",
+                                  name,
+                                  unsigned(stats.sent),
+                                  unsigned(stats.age_ms),
+                                  unsigned(stats.max_age_ms));
+    }
+    size = MIN(uint32_t(len), buf_size - 1);
+    return buf;
+}
+
+/*
+  frames and bytes sent by each serial telemetry protocol, how many of
+  the frames were written in place in the UART buffer and the time
+  spent building and queueing them in microseconds
+ */
+char *AP_Filesystem_Sys::telem_txt(uint32_t &size) const
+{
+    const uint8_t line_len = 72;
+    const uint32_t buf_size = (uint8_t(AP_SerialFrame::Protocol::NUM_PROTOCOLS) + 1U) * line_len;
+    char *buf = (char *)malloc(buf_size);
+    if (buf == nullptr) {
+        return nullptr;
+    }
+    int len = hal.util->snprintf(buf, buf_size, "%-10s %8s %9s %8s %7s %9s %6s\n",
+                                 "Protocol", "Frames", "Bytes", "Direct", "Drop", "TimeUS", "MaxUS");
+    const char *name;
+    AP_SerialFrame::Stats stats;
+    for (uint8_t i=0; AP_SerialFrame::get_stats(i, name, stats); i++) {
+        len += hal.util->snprintf(&buf[len], buf_size - len, "%-10s %8u %9u %8u %7u %9u %6u\n",
+                                  name,
+                                  unsigned(stats.frames),
+                                  unsigned(stats.bytes),
+                                  unsigned(stats.direct),
+                                  unsigned(stats.dropped),
+                                  unsigned(stats.time_us),
+                                  unsigned(stats.max_us));
+    }
+    size = MIN(uint32_t(len), buf_size - 1);
+    return buf;
+}
+
+/*
+  semaphores which WITH_SEMAPHORE() has had to wait for, with the
+  number of waits, the longest wait in microseconds and how many waits
+  fell in each decade of wait time. Unnamed semaphores are shown by
+  the line of their first wait
+ */
+char *AP_Filesystem_Sys::locks_txt(uint32_t &size) const
+{
+    const uint8_t line_len = 80;
+    AP_HAL::SemaphoreStats::Entry entry;
+    uint8_t n = 0;
+    while (AP_HAL::SemaphoreStats::get(n, entry)) {
+        n++;
+    }
+    const uint32_t buf_size = (n + 1U) * line_len;
+    char *buf = (char *)malloc(buf_size);
+    if (buf == nullptr) {
+        return nullptr;
+    }
+    int len = hal.util->snprintf(buf, buf_size, "%-16s %8s %8s %7s %7s %7s %7s %7s\n",
+                                 "Lock", "Waits", "MaxUS", "<10us", "<100us", "<1ms", "<10ms", ">=10ms");
+    for (uint8_t i=0; i<n && AP_HAL::SemaphoreStats::get(i, entry); i++) {
+        char name[17];
+        if (entry.name != nullptr) {
+            strncpy(name, entry.name, sizeof(name)-1);
+            name[sizeof(name)-1] = 0;
+        } else {
+            hal.util->snprintf(name, sizeof(name), "line %u", unsigned(entry.line));
+        }
+        len += hal.util->snprintf(&buf[len], buf_size - len, "%-16s %8u %8u %7u %7u %7u %7u %7u\n",
+                                  name,
+                                  unsigned(entry.count),
+                                  unsigned(entry.max_us),
+                                  unsigned(entry.buckets[0]),
+                                  unsigned(entry.buckets[1]),
+                                  unsigned(entry.buckets[2]),
+                                  unsigned(entry.buckets[3]),
+                                  unsigned(entry.buckets[4]));
+    }
+    size = MIN(uint32_t(len), buf_size - 1);
+    return buf;
+}
+
+char *AP_Filesystem_Sys::generate(const char *name, uint32_t &size) const
+{
+    if (strcmp(name, "threads.txt") == 0) {
+        return threads_txt(size);
+    }
+    if (strcmp(name, "memory.txt") == 0) {
+        return memory_txt(size);
+    }
+    if (strcmp(name, "storage.txt") == 0) {
+        return storage_txt(size);
+    }
+    if (strcmp(name, "scripting.txt") == 0) {
+        return scripting_txt(size);
+    }
+    if (strcmp(name, "scripts.txt") == 0) {
+        return scripts_txt(size);
+    }
+    if (strcmp(name, "boot.txt") == 0) {
+        return boot_txt(size);
+    }
+    if (strcmp(name, "uavcan.txt") == 0) {
+        return uavcan_txt(size);
+    }
+    if (strcmp(name, "frsky.txt") == 0) {
+        return frsky_txt(size);
+    }
+    if (strcmp(name, "telem.txt") == 0) {
+        return telem_txt(size);
+    }
+    if (strcmp(name, "locks.txt") == 0) {
+        return locks_txt(size);
+    }
+    return nullptr;
+}
+
+int AP_Filesystem_Sys::open(const char *pathname, int flags)
+{
+    if ((flags & O_ACCMODE) != O_RDONLY) {
+        errno = EROFS;
+        return -1;
+    }
+    uint8_t idx;
+    for (idx=0; idx<ARRAY_SIZE(files); idx++) {
+        if (files[idx].data == nullptr) {
+            break;
+        }
+    }
+    if (idx == ARRAY_SIZE(files)) {
+        errno = ENFILE;
+        return -1;
+    }
+    uint32_t size = 0;
+    char *data = generate(pathname + strlen(AP_FILESYSTEM_SYS_PREFIX), size);
+    if (data == nullptr) {
+        errno = ENOENT;
+        return -1;
+    }
+    files[idx].data = data;
+    files[idx].size = size;
+    files[idx].ofs = 0;
+    return AP_FILESYSTEM_SYS_FD_BASE + idx;
+}
+
+int AP_Filesystem_Sys::close(int fd)
+{
+    if (!is_sys_fd(fd) || files[fd - AP_FILESYSTEM_SYS_FD_BASE].data == nullptr) {
+        errno = EBADF;
+        return -1;
+    }
+    struct open_file &f = files[fd - AP_FILESYSTEM_SYS_FD_BASE];
+    free(f.data);
+    f.data = nullptr;
+    return 0;
+}
+
+ssize_t AP_Filesystem_Sys::read(int fd, void *buf, size_t count)
+{
+    if (!is_sys_fd(fd) || files[fd - AP_FILESYSTEM_SYS_FD_BASE].data == nullptr) {
+        errno = EBADF;
+        return -1;
+    }
+    struct open_file &f = files[fd - AP_FILESYSTEM_SYS_FD_BASE];
+    count = MIN(count, size_t(f.size - f.ofs));
+    memcpy(buf, &f.data[f.ofs], count);
+    f.ofs += count;
+    return count;
+}
+
+off_t AP_Filesystem_Sys::lseek(int fd, off_t offset, int whence)
+{
+    if (!is_sys_fd(fd) || files[fd - AP_FILESYSTEM_SYS_FD_BASE].data == nullptr) {
+        errno = EBADF;
+        return -1;
+    }
+    struct open_file &f = files[fd - AP_FILESYSTEM_SYS_FD_BASE];
+    switch (whence) {
+    case SEEK_SET:
+        break;
+    case SEEK_CUR:
+        offset += f.ofs;
+        break;
+    case SEEK_END:
+        offset += f.size;
+        break;
+    default:
+        errno = EINVAL;
+        return -1;
+    }
+    if (offset < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    f.ofs = MIN(uint32_t(offset), f.size);
+    return f.ofs;
+}
+
+int AP_Filesystem_Sys::stat(const char *pathname, struct stat *stbuf)
+{
+    uint32_t size = 0;
+    char *data = generate(pathname + strlen(AP_FILESYSTEM_SYS_PREFIX), size);
+    if (data == nullptr) {
+        errno = ENOENT;
+        return -1;
+    }
+    free(data);
+    memset(stbuf, 0, sizeof(*stbuf));
+    stbuf->st_mode = S_IFREG | 0444;
+    stbuf->st_size = size;
+    return 0;
+}
+
+namespace AP
+{
+AP_Filesystem_Sys &FS_Sys()
+{
+    return fs_sys;
+}
+}
+
+#endif // HAVE_FILESYSTEM_SUPPORT
@@ -0,0 +1,96 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  read-only files under @SYS/ giving system information, generated
+  when they are opened
+ */
+#pragma once
+
+#include "AP_Filesystem_Available.h"
+
+#if HAVE_FILESYSTEM_SUPPORT
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#define AP_FILESYSTEM_SYS_PREFIX "@SYS/"
+
+// file descriptors for @SYS files start here, above those of the backends
+#define AP_FILESYSTEM_SYS_FD_BASE 1000
+#define AP_FILESYSTEM_SYS_MAX_OPEN 2
+
+class AP_Filesystem_Sys {
+public:
+    // return true if pathname is an @SYS file
+    static bool is_sys_path(const char *pathname);
+
+    // return true if fd is an open @SYS file
+    static bool is_sys_fd(int fd) {
+        return fd >= AP_FILESYSTEM_SYS_FD_BASE && fd < AP_FILESYSTEM_SYS_FD_BASE + AP_FILESYSTEM_SYS_MAX_OPEN;
+    }
+
+    int open(const char *pathname, int flags);
+    int close(int fd);
+    ssize_t read(int fd, void *buf, size_t count);
+    off_t lseek(int fd, off_t offset, int whence);
+    int stat(const char *pathname, struct stat *stbuf);
+
+private:
+    // generate the contents of a file, returns nullptr if there is no such file
+    char *generate(const char *name, uint32_t &size) const;
+
+    // contents of @SYS/threads.txt
+    char *threads_txt(uint32_t &size) const;
+
+    // contents of @SYS/memory.txt
+    char *memory_txt(uint32_t &size) const;
+
+    // contents of @SYS/storage.txt
+    char *storage_txt(uint32_t &size) const;
+
+    // contents of @SYS/scripting.txt
+    char *scripting_txt(uint32_t &size) const;
+
+    // contents of @SYS/scripts.txt
+    char *scripts_txt(uint32_t &size) const;
+
+    // contents of @SYS/boot.txt
+    char *boot_txt(uint32_t &size) const;
+
+    // contents of @SYS/uavcan.txt
+    char *uavcan_txt(uint32_t &size) const;
+
+    // contents of @SYS/frsky.txt
+    char *frsky_txt(uint32_t &size) const;
+
+    // contents of @SYS/telem.txt
+    char *telem_txt(uint32_t &size) const;
+
+    // contents of @SYS/locks.txt
+    char *locks_txt(uint32_t &size) const;
+
+    struct open_file {
+        char *data;
+        uint32_t size;
+        uint32_t ofs;
+    } files[AP_FILESYSTEM_SYS_MAX_OPEN];
+};
+
+namespace AP {
+    AP_Filesystem_Sys &FS_Sys();
+};
+
+#endif // HAVE_FILESYSTEM_SUPPORT
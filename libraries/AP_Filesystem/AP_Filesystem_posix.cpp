@@ -26,22 +26,46 @@
 #include <sys/vfs.h>
 #endif
 #include <utime.h>
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#include <linux/falloc.h>
+#endif
 
 extern const AP_HAL::HAL& hal;
 
 int AP_Filesystem::open(const char *fname, int flags)
 {
+    if (AP_Filesystem_Sys::is_sys_path(fname)) {
+        return AP::FS_Sys().open(fname, flags);
+    }
+    if (AP_Filesystem_ROMFS::is_romfs_path(fname)) {
+        return AP::FS_ROMFS().open(fname, flags);
+    }
+
     // we automatically add O_CLOEXEC as we always want it for ArduPilot FS usage
     return ::open(fname, flags | O_CLOEXEC, 0644);
 }
 
 int AP_Filesystem::close(int fd)
 {
+    if (AP_Filesystem_Sys::is_sys_fd(fd)) {
+        return AP::FS_Sys().close(fd);
+    }
+    if (AP_Filesystem_ROMFS::is_romfs_fd(fd)) {
+        return AP::FS_ROMFS().close(fd);
+    }
+
     return ::close(fd);
 }
 
 ssize_t AP_Filesystem::read(int fd, void *buf, size_t count)
 {
+    if (AP_Filesystem_Sys::is_sys_fd(fd)) {
+        return AP::FS_Sys().read(fd, buf, count);
+    }
+    if (AP_Filesystem_ROMFS::is_romfs_fd(fd)) {
+        return AP::FS_ROMFS().read(fd, buf, count);
+    }
+
     return ::read(fd, buf, count);
 }
 
@@ -57,11 +81,25 @@ int AP_Filesystem::fsync(int fd)
 
 off_t AP_Filesystem::lseek(int fd, off_t offset, int seek_from)
 {
+    if (AP_Filesystem_Sys::is_sys_fd(fd)) {
+        return AP::FS_Sys().lseek(fd, offset, seek_from);
+    }
+    if (AP_Filesystem_ROMFS::is_romfs_fd(fd)) {
+        return AP::FS_ROMFS().lseek(fd, offset, seek_from);
+    }
+
     return ::lseek(fd, offset, seek_from);
 }
 
 int AP_Filesystem::stat(const char *pathname, struct stat *stbuf)
 {
+    if (AP_Filesystem_Sys::is_sys_path(pathname)) {
+        return AP::FS_Sys().stat(pathname, stbuf);
+    }
+    if (AP_Filesystem_ROMFS::is_romfs_path(pathname)) {
+        return AP::FS_ROMFS().stat(pathname, stbuf);
+    }
+
     return ::stat(pathname, stbuf);
 }
 
@@ -116,6 +154,31 @@ int64_t AP_Filesystem::disk_space(const char *path)
     return (((int64_t)stats.f_blocks) * stats.f_bsize);
 }
 
+bool AP_Filesystem::fpreallocate(int fd, uint32_t size)
+{
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+    // allocate without changing the file size, so there is nothing
+    // to tidy up if the file isn't closed
+    return ::fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, size) == 0;
+#else
+    return false;
+#endif
+}
+
+int AP_Filesystem::ftruncate(int fd, off_t length)
+{
+    return ::ftruncate(fd, length);
+}
+
+uint32_t AP_Filesystem::cluster_size(int fd)
+{
+    struct statfs stats;
+    if (::fstatfs(fd, &stats) < 0) {
+        return 0;
+    }
+    return stats.f_bsize;
+}
+
 
 /*
   set mtime on a file
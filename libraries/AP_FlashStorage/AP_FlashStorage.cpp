@@ -258,6 +258,16 @@ bool AP_FlashStorage::write(uint16_t offset, uint16_t length)
     return true;
 }
 
+// check if a compaction would be worthwhile
+bool AP_FlashStorage::compaction_advised(void) const
+{
+    if (reserved_space == 0 || write_error) {
+        // the other sector is still available, no erase needed yet
+        return false;
+    }
+    return write_offset + reserved_space > flash_sector_size / 2;
+}
+
 /*
   load all data from a flash sector into mem_buffer
  */
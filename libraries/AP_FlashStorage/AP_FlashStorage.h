@@ -120,6 +120,13 @@ public:
     // write some data to storage from mem_buffer
     bool write(uint16_t offset, uint16_t length) WARN_IF_UNUSED;
 
+    // return true if the current sector is more than half used and
+    // the next sector switch will need an erase. Callers can use this
+    // to call switch_full_sector() at a time of their choosing rather
+    // than have write() fail once the sector fills while erase is not
+    // allowed
+    bool compaction_advised(void) const;
+
     // fixed storage size
     static const uint16_t storage_size = HAL_STORAGE_SIZE;
     
@@ -156,18 +156,15 @@ bool AP_Follow::get_target_location_and_velocity(Location &loc, Vector3f &vel_ne
         return false;
     }
 
-    // calculate time since last actual position update
-    const float dt = (AP_HAL::millis() - _last_location_update_ms) * 0.001f;
+    // predict where the target is now. The prediction is applied as
+    // an offset from the reported location, so it stays small
+    const uint32_t now_us = AP_HAL::micros();
+    const Vector3f ofs = _estimator.predict(now_us) - _target_report_pos;
+    vel_ned = _estimator.predict_velocity(now_us);
 
-    // get velocity estimate
-    if (!get_velocity_ned(vel_ned, dt)) {
-        return false;
-    }
-
-    // project the vehicle position
     Location last_loc = _target_location;
-    last_loc.offset(vel_ned.x * dt, vel_ned.y * dt);
-    last_loc.alt -= vel_ned.z * 100.0f * dt; // convert m/s to cm/s, multiply by dt.  minus because NED
+    last_loc.offset(ofs.x, ofs.y);
+    last_loc.alt -= ofs.z * 100.0f; // convert m to cm.  minus because NED
 
     // return latest position estimate
     loc = last_loc;
@@ -277,11 +274,6 @@ void AP_Follow::handle_msg(const mavlink_message_t &msg)
     // decode global-position-int message
     if (msg.msgid == MAVLINK_MSG_ID_GLOBAL_POSITION_INT) {
 
-        // get estimated location and velocity (for logging)
-        Location loc_estimate{};
-        Vector3f vel_estimate;
-        UNUSED_RESULT(get_target_location_and_velocity(loc_estimate, vel_estimate));
-
         // decode message
         mavlink_global_position_int_t packet;
         mavlink_msg_global_position_int_decode(&msg, &packet);
@@ -291,61 +283,108 @@ void AP_Follow::handle_msg(const mavlink_message_t &msg)
             return;
         }
 
-        _target_location.lat = packet.lat;
-        _target_location.lng = packet.lon;
+        target_report report {};
+        report.loc.lat = packet.lat;
+        report.loc.lng = packet.lon;
 
         // select altitude source based on FOLL_ALT_TYPE param 
         if (_alt_type == AP_FOLLOW_ALTITUDE_TYPE_RELATIVE) {
             // relative altitude
-            _target_location.alt = packet.relative_alt / 10;        // convert millimeters to cm
-            _target_location.relative_alt = 1;                // set relative_alt flag
+            report.loc.alt = packet.relative_alt / 10;        // convert millimeters to cm
+            report.loc.relative_alt = 1;                // set relative_alt flag
         } else {
             // absolute altitude
-            _target_location.alt = packet.alt / 10;                 // convert millimeters to cm
-            _target_location.relative_alt = 0;                // reset relative_alt flag
+            report.loc.alt = packet.alt / 10;                 // convert millimeters to cm
+            report.loc.relative_alt = 0;                // reset relative_alt flag
         }
 
-        _target_velocity_ned.x = packet.vx * 0.01f; // velocity north
-        _target_velocity_ned.y = packet.vy * 0.01f; // velocity east
-        _target_velocity_ned.z = packet.vz * 0.01f; // velocity down
+        report.vel_ned.x = packet.vx * 0.01f; // velocity north
+        report.vel_ned.y = packet.vy * 0.01f; // velocity east
+        report.vel_ned.z = packet.vz * 0.01f; // velocity down
+
+        // get a local timestamp of when the message was sent, with
+        // correction for transport jitter
+        report.time_us = _jitter.correct_offboard_timestamp_usec(packet.time_boot_ms * 1000ULL, AP_HAL::micros64());
+
+        // heading (UINT16_MAX if unknown)
+        report.heading = (packet.hdg <= 36000) ? packet.hdg * 0.01f : -1.0f;
 
-        // get a local timestamp with correction for transport jitter
-        _last_location_update_ms = _jitter.correct_offboard_timestamp_msec(packet.time_boot_ms, AP_HAL::millis());
-        if (packet.hdg <= 36000) {                  // heading (UINT16_MAX if unknown)
-            _target_heading = packet.hdg * 0.01f;   // convert centi-degrees to degrees
-            _last_heading_update_ms = _last_location_update_ms;
-        }
         // initialise _sysid if zero to sender's id
         if (_sysid == 0) {
             _sysid.set(msg.sysid);
             _automatic_sysid = true;
         }
 
-        // log lead's estimated vs reported position
-        AP::logger().Write("FOLL",
-                                               "TimeUS,Lat,Lon,Alt,VelN,VelE,VelD,LatE,LonE,AltE",  // labels
-                                               "sDUmnnnDUm",    // units
-                                               "F--B000--B",    // mults
-                                               "QLLifffLLi",    // fmt
-                                               AP_HAL::micros64(),
-                                               _target_location.lat,
-                                               _target_location.lng,
-                                               _target_location.alt,
-                                               (double)_target_velocity_ned.x,
-                                               (double)_target_velocity_ned.y,
-                                               (double)_target_velocity_ned.z,
-                                               loc_estimate.lat,
-                                               loc_estimate.lng,
-                                               loc_estimate.alt
-                                               );
+        // leave the fusion and logging to update(), so GCS processing
+        // isn't held up. If reports aren't being taken the oldest is
+        // dropped, as the newest is worth the most
+        _reports.push_force(report);
     }
 }
 
-// get velocity estimate in m/s in NED frame using dt since last update
-bool AP_Follow::get_velocity_ned(Vector3f &vel_ned, float dt) const
+// fuse target reports queued by handle_msg
+void AP_Follow::update()
 {
-    vel_ned = _target_velocity_ned + (_target_accel_ned * dt);
-    return true;
+    target_report report;
+    while (_reports.pop(report)) {
+        fuse_report(report);
+    }
+}
+
+// fuse a target position report into the estimate
+void AP_Follow::fuse_report(const target_report &report)
+{
+    // get estimated location and velocity (for logging)
+    Location loc_estimate{};
+    Vector3f vel_estimate;
+    UNUSED_RESULT(get_target_location_and_velocity(loc_estimate, vel_estimate));
+
+    // the estimator works relative to the first report since the
+    // target was last lost, when it is also reset
+    const uint32_t time_ms = report.time_us / 1000U;
+    const uint32_t timeout_us = AP_FOLLOW_TIMEOUT_MS * 1000UL;
+    if ((_last_location_update_ms == 0) || (AP_HAL::millis() - _last_location_update_ms > AP_FOLLOW_TIMEOUT_MS) ||
+        (_target_origin.relative_alt != report.loc.relative_alt)) {
+        _target_origin = report.loc;
+    }
+    _target_location = report.loc;
+    _target_report_pos = _target_origin.get_distance_NED(report.loc);
+    _estimator.update(_target_report_pos, report.vel_ned, report.time_us, timeout_us);
+    _last_location_update_ms = time_ms;
+
+    if (!is_negative(report.heading)) {
+        set_target_heading(report.heading, time_ms);
+    }
+
+    // log lead's estimated vs reported position
+    AP::logger().Write("FOLL",
+                                           "TimeUS,Lat,Lon,Alt,VelN,VelE,VelD,LatE,LonE,AltE,Lag",  // labels
+                                           "sDUmnnnDUms",    // units
+                                           "F--B000--BC",    // mults
+                                           "QLLifffLLif",    // fmt
+                                           AP_HAL::micros64(),
+                                           _target_location.lat,
+                                           _target_location.lng,
+                                           _target_location.alt,
+                                           (double)report.vel_ned.x,
+                                           (double)report.vel_ned.y,
+                                           (double)report.vel_ned.z,
+                                           loc_estimate.lat,
+                                           loc_estimate.lng,
+                                           loc_estimate.alt,
+                                           (double)_jitter.get_link_lag_ms()
+                                           );
+}
+
+// set the heading of the target and the rotation of relative offsets
+void AP_Follow::set_target_heading(float heading_deg, uint32_t time_ms)
+{
+    if (!is_equal(heading_deg, _target_heading) || (_last_heading_update_ms == 0)) {
+        _heading_cos = cosf(radians(heading_deg));
+        _heading_sin = sinf(radians(heading_deg));
+    }
+    _target_heading = heading_deg;
+    _last_heading_update_ms = time_ms;
 }
 
 // initialise offsets to provided distance vector to other vehicle (in meters in NED frame) if required
@@ -388,8 +427,9 @@ bool AP_Follow::get_offsets_ned(Vector3f &offset) const
         return false;
     }
 
-    // rotate offsets from vehicle's perspective to NED
-    offset = rotate_vector(off, target_heading_deg);
+    // rotate offsets from vehicle's perspective to NED, using the
+    // rotation worked out when the heading was reported
+    offset = Vector3f((off.x * _heading_cos) - (off.y * _heading_sin), (off.y * _heading_cos) + (off.x * _heading_sin), off.z);
     return true;
 }
 
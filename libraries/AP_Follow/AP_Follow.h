@@ -21,6 +21,8 @@
 #include <GCS_MAVLink/GCS.h>
 #include <AC_PID/AC_P.h>
 #include <AP_RTC/JitterCorrection.h>
+#include <AP_HAL/utility/RingBuffer.h>
+#include <Filter/TargetEstimator.h>
 
 class AP_Follow
 {
@@ -76,6 +78,9 @@ public:
     // parse mavlink messages which may hold target's position, velocity and attitude
     void handle_msg(const mavlink_message_t &msg);
 
+    // fuse target reports queued by handle_msg, should be called at 50hz
+    void update();
+
     //
     // GCS reporting functions
     //
@@ -91,8 +96,20 @@ public:
 
 private:
 
-    // get velocity estimate in m/s in NED frame using dt since last update
-    bool get_velocity_ned(Vector3f &vel_ned, float dt) const;
+    // a target position report, timestamped with when it was sent in
+    // the local time domain
+    struct target_report {
+        Location loc;
+        Vector3f vel_ned;
+        uint32_t time_us;
+        float heading;          // heading in degrees, negative if unknown
+    };
+
+    // fuse a target position report into the estimate
+    void fuse_report(const target_report &report);
+
+    // set the heading of the target and the rotation of relative offsets
+    void set_target_heading(float heading_deg, uint32_t time_ms);
 
     // initialise offsets to provided distance vector to other vehicle (in meters in NED frame) if required
     void init_offsets_if_required(const Vector3f &dist_vec_ned);
@@ -120,10 +137,13 @@ private:
     bool _healthy;                  // true if we are receiving mavlink messages (regardless of whether they have target position info within them)
     uint32_t _last_location_update_ms;  // system time of last position update
     Location _target_location;      // last known location of target
-    Vector3f _target_velocity_ned;  // last known velocity of target in NED frame in m/s
-    Vector3f _target_accel_ned;     // last known acceleration of target in NED frame in m/s/s
+    Location _target_origin;        // origin of the estimator positions
+    Vector3f _target_report_pos;    // last reported position in meters NED from origin
+    TargetEstimator _estimator;     // estimate of the target's motion between reports
     uint32_t _last_heading_update_ms;   // system time of last heading update
     float _target_heading;          // heading in degrees
+    float _heading_cos;             // cosine of the target's heading, to rotate relative offsets
+    float _heading_sin;             // sine of the target's heading, to rotate relative offsets
     bool _automatic_sysid;          // did we lock onto a sysid automatically?
     float _dist_to_target;          // latest distance to target in meters (for reporting purposes)
     float _bearing_to_target;       // latest bearing to target in degrees (for reporting purposes)
@@ -131,4 +151,7 @@ private:
 
     // setup jitter correction with max transport lag of 3s
     JitterCorrection _jitter{3000};
+
+    // reports from handle_msg waiting to be fused
+    ObjectBuffer<target_report> _reports{4};
 };
@@ -69,19 +69,23 @@ void AP_Frsky_Telem::setup_passthrough(void)
 #endif
 
     // initialize packet weights for the WFQ scheduler
-    // priority[i] = 1/_passthrough.packet_weight[i]
+    // priority[i] = 1/weight[i]
     // rate[i] = LinkRate * ( priority[i] / (sum(priority[1-n])) )
-    _passthrough.packet_weight[0] = 35;    // 0x5000 status text (dynamic)
-    _passthrough.packet_weight[1] = 50;    // 0x5006 Attitude and range (dynamic)
-    _passthrough.packet_weight[2] = 550;   // 0x800 GPS lat (600 with 1 sensor)
-    _passthrough.packet_weight[3] = 550;   // 0x800 GPS lon (600 with 1 sensor)
-    _passthrough.packet_weight[4] = 400;   // 0x5005 Vel and Yaw
-    _passthrough.packet_weight[5] = 700;   // 0x5001 AP status
-    _passthrough.packet_weight[6] = 700;   // 0x5002 GPS Status
-    _passthrough.packet_weight[7] = 400;   // 0x5004 Home
-    _passthrough.packet_weight[8] = 1300;  // 0x5008 Battery 2 status
-    _passthrough.packet_weight[9] = 1300;  // 0x5003 Battery 1 status
-    _passthrough.packet_weight[10] = 1700; // 0x5007 parameters
+    _scheduler.set_weight(0, 35);    // 0x5000 status text (dynamic)
+    _scheduler.set_weight(1, 50);    // 0x5006 Attitude and range (dynamic)
+    _scheduler.set_weight(2, 550);   // 0x800 GPS lat (600 with 1 sensor)
+    _scheduler.set_weight(3, 550);   // 0x800 GPS lon (600 with 1 sensor)
+    _scheduler.set_weight(4, 400);   // 0x5005 Vel and Yaw
+    _scheduler.set_weight(5, 700);   // 0x5001 AP status
+    _scheduler.set_weight(6, 700);   // 0x5002 GPS Status
+    _scheduler.set_weight(7, 400);   // 0x5004 Home
+    _scheduler.set_weight(8, 1300);  // 0x5008 Battery 2 status
+    _scheduler.set_weight(9, 1300);  // 0x5003 Battery 1 status
+    _scheduler.set_weight(10, 1700); // 0x5007 parameters
+
+    for (uint8_t i=0; i<TIME_SLOT_MAX; i++) {
+        _scheduler.set_min_period(i, _sport_config.packet_min_period[i]);
+    }
 }
 
 /*
@@ -115,37 +119,13 @@ bool AP_Frsky_Telem::init()
     return false;
 }
 
-void AP_Frsky_Telem::update_avg_packet_rate()
-{
-    uint32_t poll_now = AP_HAL::millis();
-
-    _passthrough.avg_packet_counter++;
-    
-    if (poll_now - _passthrough.last_poll_timer > 1000) { //average in last 1000ms
-        // initialize
-        if (_passthrough.avg_packet_rate == 0) _passthrough.avg_packet_rate = _passthrough.avg_packet_counter;
-        // moving average
-        _passthrough.avg_packet_rate = (uint8_t)_passthrough.avg_packet_rate * 0.75 + _passthrough.avg_packet_counter * 0.25;
-        // reset
-        _passthrough.last_poll_timer = poll_now;
-        _passthrough.avg_packet_counter = 0;
-    }
-}
-
 /*
  * WFQ scheduler
  * for FrSky SPort Passthrough (OpenTX) protocol (X-receivers)
  */
 void AP_Frsky_Telem::passthrough_wfq_adaptive_scheduler(void)
 {
-    update_avg_packet_rate();
-
-    uint32_t now = AP_HAL::millis();
-    uint8_t max_delay_idx = 0;
-    
-    float max_delay = 0;
-    float delay = 0;
-    bool packet_ready = false;
+    const uint32_t now = AP_HAL::millis();
 
     // build message queue for sensor_status_flags
     check_sensor_status_flags();
@@ -159,45 +139,36 @@ void AP_Frsky_Telem::passthrough_wfq_adaptive_scheduler(void)
         queue_empty = !_statustext.available && _statustext.queue.empty();
     }
     if (!queue_empty) {
-        _passthrough.packet_weight[0] = 45;     // messages
-        _passthrough.packet_weight[1] = 80;     // attitude
+        _scheduler.set_weight(0, 45);     // messages
+        _scheduler.set_weight(1, 80);     // attitude
     } else {
-        _passthrough.packet_weight[0] = 5000;   // messages
-        _passthrough.packet_weight[1] = 45;     // attitude
+        _scheduler.set_weight(0, 5000);   // messages
+        _scheduler.set_weight(1, 45);     // attitude
     }
-    
-    // search the packet with the longest delay after the scheduled time
-    for (int i=0;i<TIME_SLOT_MAX;i++) {
-        //normalize packet delay relative to packet weight
-        delay = (now - _passthrough.packet_timer[i])/static_cast<float>(_passthrough.packet_weight[i]);
-        // use >= so with equal delays we choose the packet with lowest priority
-        // this is ensured by the packets being sorted by desc frequency
-        // apply the rate limiter
-        if (delay >= max_delay && ((now - _passthrough.packet_timer[i]) >= _sport_config.packet_min_period[i])) {
-            switch (i) {
-                case 0:
-                    packet_ready = !queue_empty;
-                    break;
-                case 5:
-                    packet_ready = gcs().vehicle_initialised();
-                    break;
-                case 8:
-                    packet_ready = AP::battery().num_instances() > 1;
-                    break;
-                default:
-                    packet_ready = true;
-                    break;
-            }
 
-            if (packet_ready) {
-                max_delay = delay;
-                max_delay_idx = i;
-            }
-        }
+    // packets which have something to send. The packets are sorted by
+    // desc frequency so with equal delays the scheduler chooses the
+    // packet with lowest priority
+    uint32_t ready_mask = (1U << TIME_SLOT_MAX) - 1;
+    if (queue_empty) {
+        ready_mask &= ~(1U << 0);
+    }
+    if (!gcs().vehicle_initialised()) {
+        ready_mask &= ~(1U << 5);
+    }
+    if (AP::battery().num_instances() < 2) {
+        ready_mask &= ~(1U << 8);
+    }
+
+    // choose the packet with the longest delay after the scheduled
+    // time. If every packet is rate limited the most overdue one is
+    // sent rather than leaving the slot empty
+    const int8_t idx = _scheduler.select(now, ready_mask);
+    if (idx < 0) {
+        return;
     }
-    _passthrough.packet_timer[max_delay_idx] = AP_HAL::millis();
     // send packet
-    switch (max_delay_idx) {
+    switch (idx) {
         case 0: // 0x5000 status text
             if (get_next_msg_chunk()) {
                 send_uint32(SPORT_DATA_FRAME, DIY_FIRST_ID, _msg_chunk.chunk);
@@ -213,7 +184,7 @@ void AP_Frsky_Telem::passthrough_wfq_adaptive_scheduler(void)
             // force the scheduler to select GPS lon as packet that's been waiting the most
             // this guarantees that gps coords are sent at max 
             // _passthrough.avg_polling_period*number_of_downlink_sensors time separation
-            _passthrough.packet_timer[3] = _passthrough.packet_timer[2] - 10000;
+            _scheduler.expedite(3);
             break;
         case 3: // 0x800 GPS lon
             send_uint32(SPORT_DATA_FRAME, GPS_LONG_LATI_FIRST_ID, _passthrough.gps_lng_sample); // gps longitude
@@ -474,57 +445,6 @@ void AP_Frsky_Telem::loop(void)
     }
 }
 
-/* 
- * build up the frame's crc
- * for FrSky SPort protocol (X-receivers)
- */
-void AP_Frsky_Telem::calc_crc(uint8_t byte)
-{
-    _crc += byte; //0-1FF
-    _crc += _crc >> 8; //0-100
-    _crc &= 0xFF;
-}
-
-/*
- * send the frame's crc at the end of the frame
- * for FrSky SPort protocol (X-receivers)
- */
-void AP_Frsky_Telem::send_crc(void) 
-{
-    send_byte(0xFF - _crc);
-    _crc = 0;
-}
-
-
-/*
-  send 1 byte and do byte stuffing
-*/
-void AP_Frsky_Telem::send_byte(uint8_t byte)
-{
-    if (_protocol == AP_SerialManager::SerialProtocol_FrSky_D) { // FrSky D protocol (D-receivers)
-        if (byte == START_STOP_D) {
-            _port->write(0x5D);
-            _port->write(0x3E);
-        } else if (byte == BYTESTUFF_D) {
-            _port->write(0x5D);
-            _port->write(0x3D);
-        } else {
-            _port->write(byte);
-        }
-    } else { // FrSky SPort protocol (X-receivers)
-        if (byte == START_STOP_SPORT) {
-            _port->write(0x7D);
-            _port->write(0x5E);
-        } else if (byte == BYTESTUFF_SPORT) {
-            _port->write(0x7D);
-            _port->write(0x5D);
-        } else {
-            _port->write(byte);
-        }
-        calc_crc(byte);
-    }
-}
-
 /*
  * send one uint32 frame of FrSky data - for FrSky SPort protocol (X-receivers)
  */
@@ -537,16 +457,19 @@ void  AP_Frsky_Telem::send_uint32(uint8_t frame, uint16_t id, uint32_t data)
         external_data.pending = true;
         return;
     }
-    send_byte(frame); // frame type
-    uint8_t *bytes = (uint8_t*)&id;
-    send_byte(bytes[0]); // LSB
-    send_byte(bytes[1]); // MSB
-    bytes = (uint8_t*)&data;
-    send_byte(bytes[0]); // LSB
-    send_byte(bytes[1]);
-    send_byte(bytes[2]);
-    send_byte(bytes[3]); // MSB
-    send_crc();
+    // frame type, then id and data LSB first, then the crc, all byte stuffed
+    const uint8_t bytes[] = {
+        frame,
+        uint8_t(id), uint8_t(id >> 8),
+        uint8_t(data), uint8_t(data >> 8), uint8_t(data >> 16), uint8_t(data >> 24)
+    };
+    AP_SerialFrame out(_port, AP_SerialFrame::Protocol::FRSKY_SPORT, 2 * (sizeof(bytes) + 1));
+    uint8_t crc = 0;
+    for (uint8_t i=0; i<sizeof(bytes); i++) {
+        out.put_escaped(bytes[i], START_STOP_SPORT, BYTESTUFF_SPORT, 0x20);
+        crc = AP_SerialFrame::crc_sport(crc, bytes[i]);
+    }
+    out.put_escaped(0xFF - crc, START_STOP_SPORT, BYTESTUFF_SPORT, 0x20);
 }
 
 /*
@@ -554,12 +477,11 @@ void  AP_Frsky_Telem::send_uint32(uint8_t frame, uint16_t id, uint32_t data)
  */
 void  AP_Frsky_Telem::send_uint16(uint16_t id, uint16_t data)
 {
-    _port->write(START_STOP_D);    // send a 0x5E start byte
-    uint8_t *bytes = (uint8_t*)&id;
-    send_byte(bytes[0]);
-    bytes = (uint8_t*)&data;
-    send_byte(bytes[0]); // LSB
-    send_byte(bytes[1]); // MSB
+    AP_SerialFrame out(_port, AP_SerialFrame::Protocol::FRSKY_D, 7);
+    out.put(START_STOP_D);    // send a 0x5E start byte
+    out.put_escaped(uint8_t(id), START_STOP_D, BYTESTUFF_D, 0x60);
+    out.put_escaped(uint8_t(data), START_STOP_D, BYTESTUFF_D, 0x60); // LSB
+    out.put_escaped(uint8_t(data >> 8), START_STOP_D, BYTESTUFF_D, 0x60); // MSB
 }
 
 /*
@@ -602,12 +524,13 @@ bool AP_Frsky_Telem::get_next_msg_chunk(void)
     // repeat each message chunk 3 times to ensure transmission
     // on slow links reduce the number of duplicate chunks
     uint8_t extra_chunks = 2;
+    const float slot_rate = _scheduler.get_slot_rate();
 
-    if (_passthrough.avg_packet_rate < 20) {
+    if (slot_rate < 20) {
         // with 3 or more extra frsky sensors on the bus
         // send messages only once
         extra_chunks = 0;
-    } else if (_passthrough.avg_packet_rate < 30) {
+    } else if (slot_rate < 30) {
         // with 1 or 2 extra frsky sensors on the bus
         // send messages twice
         extra_chunks = 1;
@@ -1140,6 +1063,22 @@ uint32_t AP_Frsky_Telem::sensor_status_flags() const
     return ~health & enabled & present;
 }
 
+/*
+  name and scheduler statistics of a passthrough packet
+ */
+bool AP_Frsky_Telem::get_passthrough_stats(uint8_t idx, const char *&name, AP_WFQ_Scheduler<TIME_SLOT_MAX>::ItemStats &stats) const
+{
+    static const char *names[TIME_SLOT_MAX] = {
+        "Text", "Attitude", "GPSLat", "GPSLon", "VelYaw", "APStatus",
+        "GPSStatus", "Home", "Batt2", "Batt1", "Param"
+    };
+    if (!_scheduler.get_stats(idx, AP_HAL::millis(), stats)) {
+        return false;
+    }
+    name = names[idx];
+    return true;
+}
+
 /*
   fetch Sport data for an external transport, such as FPort
  */
@@ -17,7 +17,9 @@
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Notify/AP_Notify.h>
 #include <AP_SerialManager/AP_SerialManager.h>
+#include <AP_SerialManager/AP_SerialFrame.h>
 #include <AP_HAL/utility/RingBuffer.h>
+#include <AP_Common/AP_WFQ_Scheduler.h>
 
 #define FRSKY_TELEM_PAYLOAD_STATUS_CAPACITY          5 // size of the message buffer queue (max number of messages waiting to be sent)
 
@@ -140,10 +142,16 @@ public:
     // get next telemetry data for external consumers of SPort data
     static bool get_telem_data(uint8_t &frame, uint16_t &appid, uint32_t &data);
 
+    // passthrough polls per second
+    float get_passthrough_slot_rate() const { return _scheduler.get_slot_rate(); }
+
+    // name and scheduler statistics of a passthrough packet, returns
+    // false if there is no such packet
+    bool get_passthrough_stats(uint8_t idx, const char *&name, AP_WFQ_Scheduler<TIME_SLOT_MAX>::ItemStats &stats) const;
+
 private:
     AP_HAL::UARTDriver *_port;                  // UART used to send data to FrSky receiver
     AP_SerialManager::SerialProtocol _protocol; // protocol used - detected using SerialManager's SERIAL#_PROTOCOL parameter
-    uint16_t _crc;
 
     uint32_t check_sensor_status_timer;
     uint32_t check_ekf_status_timer;
@@ -177,18 +185,15 @@ private:
     {
         bool send_latitude; // sizeof(bool) = 4 ?
         uint32_t gps_lng_sample;
-        uint32_t last_poll_timer;
-        uint32_t avg_packet_counter;
-        uint32_t packet_timer[TIME_SLOT_MAX];
-        uint32_t packet_weight[TIME_SLOT_MAX];
-        uint8_t avg_packet_rate;
         uint8_t new_byte;
     } _passthrough;
-    
+
+    // chooses the passthrough packet to send in each poll
+    AP_WFQ_Scheduler<TIME_SLOT_MAX> _scheduler;
 
     struct
     {
-        const uint32_t packet_min_period[TIME_SLOT_MAX] = {
+        const uint16_t packet_min_period[TIME_SLOT_MAX] = {
             28,     //0x5000 text,      25Hz
             38,     //0x5006 attitude   20Hz
             280,    //0x800  GPS        3Hz
@@ -229,7 +234,6 @@ private:
     
     float get_vspeed_ms(void);
     // passthrough WFQ scheduler
-    void update_avg_packet_rate();
     void passthrough_wfq_adaptive_scheduler();
     // main transmission function when protocol is FrSky SPort Passthrough (OpenTX)
     void send_SPort_Passthrough(void);
@@ -240,9 +244,6 @@ private:
     // tick - main call to send updates to transmitter (called by scheduler at 1kHz)
     void loop(void);
     // methods related to the nuts-and-bolts of sending data
-    void calc_crc(uint8_t byte);
-    void send_crc(void);
-    void send_byte(uint8_t value);
     void send_uint16(uint16_t id, uint16_t data);
     void send_uint32(uint8_t frame, uint16_t id, uint32_t data);
 
@@ -705,6 +705,9 @@ void AP_GPS::update_instance(uint8_t instance)
         send_blob_update(instance);
     }
 
+    // write RTCM data waiting for space in the transmit buffer
+    drivers[instance]->send_injected_data();
+
     // we have an active driver for this instance
     bool result = drivers[instance]->read();
     uint32_t tnow = AP_HAL::millis();
@@ -827,6 +830,8 @@ void AP_GPS::update(void)
 
     update_primary();
 
+    Write_RTCM_stats();
+
 #ifndef HAL_BUILD_AP_PERIPH
     // update notify with gps status. We always base this on the primary_instance
     AP_Notify::flags.gps_status = state[primary_instance].status;
@@ -1250,44 +1255,112 @@ void AP_GPS::handle_gps_rtcm_fragment(uint8_t flags, const uint8_t *data, uint8_
 
     uint8_t fragment = (flags >> 1U) & 0x03;
     uint8_t sequence = (flags >> 3U) & 0x1F;
+    const uint32_t now_ms = AP_HAL::millis();
+    rtcm_stats.fragments++;
+
+    // find the slot re-assembling this sequence, discarding any which have timed out
+    uint8_t free_slot = GPS_RTCM_REASSEMBLY_SLOTS;
+    uint8_t oldest_slot = 0;
+    uint8_t s;
+    for (s=0; s<GPS_RTCM_REASSEMBLY_SLOTS; s++) {
+        auto &slot = rtcm_buffer->slot[s];
+        if (slot.fragments_received && now_ms - slot.first_ms > GPS_RTCM_FRAGMENT_TIMEOUT_MS) {
+            memset(&slot, 0, sizeof(slot));
+            rtcm_stats.blocks_lost++;
+        }
+        if (slot.fragments_received == 0) {
+            if (free_slot == GPS_RTCM_REASSEMBLY_SLOTS) {
+                free_slot = s;
+            }
+            continue;
+        }
+        if (slot.sequence == sequence) {
+            break;
+        }
+        if (now_ms - slot.first_ms > now_ms - rtcm_buffer->slot[oldest_slot].first_ms) {
+            oldest_slot = s;
+        }
+    }
 
-    // see if this fragment is consistent with existing fragments
-    if (rtcm_buffer->fragments_received &&
-        (rtcm_buffer->sequence != sequence ||
-        (rtcm_buffer->fragments_received & (1U<<fragment)))) {
-        // we have one or more partial fragments already received
-        // which conflict with the new fragment, discard previous fragments
-        memset(rtcm_buffer, 0, sizeof(*rtcm_buffer));
+    if (s < GPS_RTCM_REASSEMBLY_SLOTS && (rtcm_buffer->slot[s].fragments_received & (1U<<fragment))) {
+        // we already have this fragment of the sequence, so this is a
+        // new block reusing the sequence number. Discard the old one
+        memset(&rtcm_buffer->slot[s], 0, sizeof(rtcm_buffer->slot[s]));
+        rtcm_stats.blocks_lost++;
+    } else if (s == GPS_RTCM_REASSEMBLY_SLOTS) {
+        // start a new block, replacing the oldest if all slots are in use
+        if (free_slot < GPS_RTCM_REASSEMBLY_SLOTS) {
+            s = free_slot;
+        } else {
+            s = oldest_slot;
+            memset(&rtcm_buffer->slot[s], 0, sizeof(rtcm_buffer->slot[s]));
+            rtcm_stats.blocks_lost++;
+        }
     }
+    auto &slot = rtcm_buffer->slot[s];
 
     // add this fragment
-    rtcm_buffer->sequence = sequence;
-    rtcm_buffer->fragments_received |= (1U << fragment);
+    if (slot.fragments_received == 0) {
+        slot.first_ms = now_ms;
+    }
+    slot.sequence = sequence;
+    slot.fragments_received |= (1U << fragment);
 
     // copy the data
-    memcpy(&rtcm_buffer->buffer[MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*(uint16_t)fragment], data, len);
+    memcpy(&slot.buffer[MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*(uint16_t)fragment], data, len);
 
     // when we get a fragment of less than max size then we know the
     // number of fragments. Note that this means if you want to send a
     // block of RTCM data of an exact multiple of the buffer size you
     // need to send a final packet of zero length
     if (len < MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN) {
-        rtcm_buffer->fragment_count = fragment+1;
-        rtcm_buffer->total_length = (MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*fragment) + len;
-    } else if (rtcm_buffer->fragments_received == 0x0F) {
+        slot.fragment_count = fragment+1;
+        slot.total_length = (MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*fragment) + len;
+    } else if (slot.fragments_received == 0x0F) {
         // special case of 4 full fragments
-        rtcm_buffer->fragment_count = 4;
-        rtcm_buffer->total_length = MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*4;
+        slot.fragment_count = 4;
+        slot.total_length = MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*4;
     }
 
 
     // see if we have all fragments
-    if (rtcm_buffer->fragment_count != 0 &&
-        rtcm_buffer->fragments_received == (1U << rtcm_buffer->fragment_count) - 1) {
+    if (slot.fragment_count != 0 &&
+        slot.fragments_received == (1U << slot.fragment_count) - 1) {
         // we have them all, inject
-        inject_data(rtcm_buffer->buffer, rtcm_buffer->total_length);
-        memset(rtcm_buffer, 0, sizeof(*rtcm_buffer));
+        inject_data(slot.buffer, slot.total_length);
+        memset(&slot, 0, sizeof(slot));
+    }
+}
+
+/*
+  log the counters of RTCM data handled once a second while data is flowing
+ */
+void AP_GPS::Write_RTCM_stats()
+{
+#ifndef HAL_BUILD_AP_PERIPH
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - rtcm_stats.last_log_ms < 1000 ||
+        rtcm_stats.fragments == rtcm_stats.last_log_fragments ||
+        !should_log()) {
+        return;
     }
+    rtcm_stats.last_log_ms = now_ms;
+    rtcm_stats.last_log_fragments = rtcm_stats.fragments;
+
+// @LoggerMessage: GRTC
+// @Description: counters of RTCM data injected into the GPS receivers
+// @Field: TimeUS: Time since system startup
+// @Field: Frag: fragments of blocks received
+// @Field: Lost: partly received blocks discarded
+// @Field: Inj: blocks written to a GPS
+// @Field: Drop: blocks that could not be written to a GPS
+    AP::logger().Write("GRTC", "TimeUS,Frag,Lost,Inj,Drop", "QIIII",
+                       AP_HAL::micros64(),
+                       rtcm_stats.fragments,
+                       rtcm_stats.blocks_lost,
+                       rtcm_stats.blocks_injected,
+                       rtcm_stats.blocks_dropped);
+#endif
 }
 
 /*
@@ -32,6 +32,10 @@
 #ifndef GPS_MAX_INSTANCES
 #define GPS_MAX_INSTANCES  (GPS_MAX_RECEIVERS + 1) // maximum number of GPS instances including the 'virtual' GPS created by blending receiver data
 #endif
+#define GPS_RTCM_REASSEMBLY_SLOTS 4         // RTCM blocks that can be re-assembled at once
+#define GPS_RTCM_FRAGMENT_TIMEOUT_MS 500    // partly received RTCM blocks are discarded after this long
+#define GPS_INJECT_QUEUE_SIZE 2048          // bytes of RTCM data each GPS can queue waiting for space to write them
+#define GPS_READ_BLOCK_SIZE 64              // bytes drivers read from the port in one call
 #if GPS_MAX_INSTANCES > GPS_MAX_RECEIVERS
 #define GPS_BLENDED_INSTANCE GPS_MAX_RECEIVERS  // the virtual blended GPS is always the highest instance (2)
 #endif
@@ -570,25 +574,43 @@ public:
     void update_instance(uint8_t instance);
 
     /*
-      buffer for re-assembling RTCM data for GPS injection.
+      buffers for re-assembling RTCM data for GPS injection.
       The 8 bit flags field in GPS_RTCM_DATA is interpreted as:
               1 bit for "is fragmented"
               2 bits for fragment number
               5 bits for sequence number
 
-      The rtcm_buffer is allocated on first use. Once a block of data
+      The rtcm_buffer is allocated on first use. Fragments of several
+      sequences can be re-assembled at once, so blocks arriving
+      interleaved or out of order are not lost. Once a block of data
       is successfully reassembled it is injected into all active GPS
       backends. This assumes we don't want more than 4*180=720 bytes
       in a RTCM data block
      */
     struct rtcm_buffer {
-        uint8_t fragments_received;
-        uint8_t sequence;
-        uint8_t fragment_count;
-        uint16_t total_length;
-        uint8_t buffer[MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*4];
+        struct {
+            uint8_t fragments_received;
+            uint8_t sequence;
+            uint8_t fragment_count;
+            uint16_t total_length;
+            uint32_t first_ms;      // time the first fragment was received
+            uint8_t buffer[MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*4];
+        } slot[GPS_RTCM_REASSEMBLY_SLOTS];
     } *rtcm_buffer;
 
+    // counters of RTCM data handled, logged once a second while data is flowing
+    struct {
+        uint32_t fragments;         // fragments of blocks received
+        uint32_t blocks_lost;       // partly received blocks discarded
+        uint32_t blocks_injected;   // blocks written to a GPS
+        uint32_t blocks_dropped;    // blocks that could not be written to a GPS
+        uint32_t last_log_ms;
+        uint32_t last_log_fragments;
+    } rtcm_stats;
+
+    // log the RTCM counters
+    void Write_RTCM_stats();
+
     // re-assemble GPS_RTCM_DATA message
     void handle_gps_rtcm_data(const mavlink_message_t &msg);
     void handle_gps_inject(const mavlink_message_t &msg);
@@ -78,14 +78,39 @@ AP_GPS_NOVA::read(void)
     }
 
     bool ret = false;
+    uint8_t buf[GPS_READ_BLOCK_SIZE];
     while (port->available() > 0) {
-        uint8_t temp = port->read();
-        ret |= parse(temp);
+        const ssize_t n = port->read(buf, MIN(port->available(), sizeof(buf)));
+        if (n <= 0) {
+            break;
+        }
+        for (uint16_t i = parse_data(buf, n); i < n; i += 1 + parse_data(&buf[i+1], n - (i+1))) {
+            ret |= parse(buf[i]);
+        }
     }
-    
+
     return ret;
 }
 
+// copy the body of a message straight from the input, leaving the
+// last byte for parse() to finish the body. Returns the number of bytes used
+uint16_t
+AP_GPS_NOVA::parse_data(const uint8_t *buf, uint16_t len)
+{
+    if (nova_msg.nova_state != nova_msg_parser::DATA) {
+        return 0;
+    }
+    const uint32_t end = MIN(uint32_t(nova_msg.header.nova_headeru.messagelength + nova_msg.header.nova_headeru.headerlength),
+                             sizeof(nova_msg.data));
+    if (nova_msg.read + 1U >= end) {
+        return 0;
+    }
+    const uint16_t n = MIN(uint32_t(len), end - 1 - nova_msg.read);
+    memcpy(&nova_msg.data.bytes[nova_msg.read - nova_msg.header.nova_headeru.headerlength], buf, n);
+    nova_msg.read += n;
+    return n;
+}
+
 bool
 AP_GPS_NOVA::parse(uint8_t temp)
 {
@@ -293,12 +318,8 @@ AP_GPS_NOVA::process_message(void)
 void
 AP_GPS_NOVA::inject_data(const uint8_t *data, uint16_t len)
 {
-    if (port->txspace() > len) {
-        last_injected_data_ms = AP_HAL::millis();
-        port->write(data, len);
-    } else {
-        Debug("NOVA: Not enough TXSPACE");
-    }
+    last_injected_data_ms = AP_HAL::millis();
+    AP_GPS_Backend::inject_data(data, len);
 }
 
 #define CRC32_POLYNOMIAL 0xEDB88320L
@@ -39,6 +39,7 @@ public:
 private:
 
     bool parse(uint8_t temp);
+    uint16_t parse_data(const uint8_t *buf, uint16_t len);
     bool process_message();
     uint32_t CRC32Value(uint32_t icrc);
     uint32_t CalculateBlockCRC32(uint32_t length, uint8_t *buffer, uint32_t crc);
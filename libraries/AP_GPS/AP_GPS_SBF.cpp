@@ -66,9 +66,16 @@ AP_GPS_SBF::read(void)
 {
     bool ret = false;
     uint32_t available_bytes = port->available();
-    for (uint32_t i = 0; i < available_bytes; i++) {
-        uint8_t temp = port->read();
-        ret |= parse(temp);
+    uint8_t buf[GPS_READ_BLOCK_SIZE];
+    while (available_bytes > 0) {
+        const ssize_t n = port->read(buf, MIN(available_bytes, sizeof(buf)));
+        if (n <= 0) {
+            break;
+        }
+        available_bytes -= n;
+        for (uint16_t i = parse_data(buf, n); i < n; i += 1 + parse_data(&buf[i+1], n - (i+1))) {
+            ret |= parse(buf[i]);
+        }
     }
 
     if (gps._auto_config != AP_GPS::GPS_AUTO_CONFIG_DISABLE) {
@@ -117,6 +124,26 @@ bool AP_GPS_SBF::logging_healthy(void) const
     }
 }
 
+// copy the body of a block straight from the input, leaving the last
+// byte for parse() to finish the block. Returns the number of bytes used
+uint16_t
+AP_GPS_SBF::parse_data(const uint8_t *buf, uint16_t len)
+{
+    if (sbf_msg.sbf_state != sbf_msg_parser_t::DATA) {
+        return 0;
+    }
+    const uint16_t body_length = sbf_msg.length - 8;
+    if (sbf_msg.read + 1U >= body_length) {
+        return 0;
+    }
+    const uint16_t n = MIN(len, uint16_t(body_length - 1 - sbf_msg.read));
+    if (sbf_msg.read < sizeof(sbf_msg.data)) {
+        memcpy(&sbf_msg.data.bytes[sbf_msg.read], buf, MIN(n, sizeof(sbf_msg.data) - sbf_msg.read));
+    }
+    sbf_msg.read += n;
+    return n;
+}
+
 bool
 AP_GPS_SBF::parse(uint8_t temp)
 {
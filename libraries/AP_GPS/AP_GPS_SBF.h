@@ -55,6 +55,7 @@ public:
 private:
 
     bool parse(uint8_t temp);
+    uint16_t parse_data(const uint8_t *buf, uint16_t len);
     bool process_message();
 
     static const uint8_t SBF_PREAMBLE1 = '$';
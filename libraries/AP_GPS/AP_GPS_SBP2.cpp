@@ -83,12 +83,8 @@ AP_GPS_SBP2::read(void)
 void
 AP_GPS_SBP2::inject_data(const uint8_t *data, uint16_t len)
 {
-    if (port->txspace() > len) {
-        last_injected_data_ms = AP_HAL::millis();
-        port->write(data, len);
-    } else {
-        Debug("PIKSI: Not enough TXSPACE");
-    }
+    last_injected_data_ms = AP_HAL::millis();
+    AP_GPS_Backend::inject_data(data, len);
 }
 
 //This attempts to reads all SBP messages from the incoming port.
@@ -539,7 +539,6 @@ bool
 AP_GPS_UBLOX::read(void)
 {
     uint8_t data;
-    int16_t numc;
     bool parsed = false;
     uint32_t millis_now = AP_HAL::millis();
 
@@ -568,11 +567,46 @@ AP_GPS_UBLOX::read(void)
         }
     }
 
-    numc = port->available();
-    for (int16_t i = 0; i < numc; i++) {        // Process bytes received
+    uint32_t available_bytes = port->available();
+    while (true) {
+        // read the input in blocks. Bytes left in the block when we
+        // stop early for an RTCMv3 packet are parsed on the next call
+        if (_rx_block_ofs >= _rx_block_len) {
+            if (available_bytes == 0) {
+                break;
+            }
+            const ssize_t n = port->read(_rx_block, MIN(available_bytes, sizeof(_rx_block)));
+            if (n <= 0) {
+                break;
+            }
+            available_bytes -= n;
+            _rx_block_len = n;
+            _rx_block_ofs = 0;
+        }
+
+#if GPS_UBLOX_MOVING_BASELINE
+        const bool bulk_payload = (rtcm3_parser == nullptr);
+#else
+        const bool bulk_payload = true;
+#endif
+        if (_step == 6 && bulk_payload) {
+            // copy as much of the payload as we have in one go
+            const uint16_t n = MIN(uint16_t(_rx_block_len - _rx_block_ofs), uint16_t(_payload_length - _payload_counter));
+            const uint8_t *p = &_rx_block[_rx_block_ofs];
+            for (uint16_t j = 0; j < n; j++) {
+                _ck_b += (_ck_a += p[j]);               // checksum byte
+            }
+            memcpy(&_buffer[_payload_counter], p, n);
+            _payload_counter += n;
+            _rx_block_ofs += n;
+            if (_payload_counter == _payload_length) {
+                _step++;
+            }
+            continue;
+        }
 
         // read the next byte
-        data = port->read();
+        data = _rx_block[_rx_block_ofs++];
 
 #if GPS_UBLOX_MOVING_BASELINE
         if (rtcm3_parser) {
@@ -672,6 +672,11 @@ private:
     uint16_t        _payload_length;
     uint16_t        _payload_counter;
 
+    // block of input read from the port and how far we have parsed it
+    uint8_t         _rx_block[GPS_READ_BLOCK_SIZE];
+    uint8_t         _rx_block_len;
+    uint8_t         _rx_block_ofs;
+
     uint8_t         _class;
     bool            _cfg_saved;
 
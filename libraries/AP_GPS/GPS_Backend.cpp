@@ -128,12 +128,47 @@ void
 AP_GPS_Backend::inject_data(const uint8_t *data, uint16_t len)
 {
     // not all backends have valid ports
-    if (port != nullptr) {
-        if (port->txspace() > len) {
-            port->write(data, len);
-        } else {
-            Debug("GPS %d: Not enough TXSPACE", state.instance + 1);
+    if (port == nullptr) {
+        return;
+    }
+
+    // keep the blocks in order behind any already waiting
+    send_injected_data();
+    if ((_inject_queue == nullptr || _inject_queue->empty()) && port->txspace() > len) {
+        port->write(data, len);
+        gps.rtcm_stats.blocks_injected++;
+        return;
+    }
+
+    if (_inject_queue == nullptr) {
+        _inject_queue = new ByteBuffer(GPS_INJECT_QUEUE_SIZE);
+    }
+    if (_inject_queue == nullptr || _inject_queue->space() < len + sizeof(len)) {
+        Debug("GPS %d: Not enough TXSPACE", state.instance + 1);
+        gps.rtcm_stats.blocks_dropped++;
+        return;
+    }
+    _inject_queue->write((const uint8_t *)&len, sizeof(len));
+    _inject_queue->write(data, len);
+}
+
+void AP_GPS_Backend::send_injected_data()
+{
+    if (port == nullptr || _inject_queue == nullptr) {
+        return;
+    }
+    uint16_t len;
+    while (_inject_queue->peekbytes((uint8_t *)&len, sizeof(len)) == sizeof(len) &&
+           port->txspace() > len) {
+        _inject_queue->advance(sizeof(len));
+        // write the block straight out of the queue, which may be in two parts
+        ByteBuffer::IoVec vec[2];
+        const uint8_t n_vec = _inject_queue->peekiovec(vec, len);
+        for (uint8_t i = 0; i < n_vec; i++) {
+            port->write(vec[i].data, vec[i].len);
         }
+        _inject_queue->advance(len);
+        gps.rtcm_stats.blocks_injected++;
     }
 }
 
@@ -20,6 +20,7 @@
 
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_RTC/JitterCorrection.h>
+#include <AP_HAL/utility/RingBuffer.h>
 #include "AP_GPS.h"
 
 class AP_GPS_Backend
@@ -29,7 +30,7 @@ public:
 
     // we declare a virtual destructor so that GPS drivers can
     // override with a custom destructor if need be.
-    virtual ~AP_GPS_Backend(void) {}
+    virtual ~AP_GPS_Backend(void) { delete _inject_queue; }
 
     // The read() method is the only one needed in each driver. It
     // should return true when the backend has successfully received a
@@ -42,8 +43,14 @@ public:
 
     virtual bool is_configured(void) { return true; }
 
+    // send a block of RTCM data to the GPS. Blocks are written whole
+    // so they are not split by the driver's own messages, and wait in a
+    // queue if there is not enough space to write them yet
     virtual void inject_data(const uint8_t *data, uint16_t len);
 
+    // write queued RTCM blocks that now fit in the port's transmit buffer
+    void send_injected_data();
+
     //MAVLink methods
     virtual bool supports_mavlink_gps_rtk_message() { return false; }
     virtual void send_mavlink_gps_rtk(mavlink_channel_t chan);
@@ -120,4 +127,8 @@ private:
     uint16_t _rate_counter;
 
     JitterCorrection jitter_correction;
+
+    // RTCM blocks waiting for space in the transmit buffer, each
+    // stored after its length. Allocated on first use
+    ByteBuffer *_inject_queue = nullptr;
 };
@@ -0,0 +1,376 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_GyroFFT.h"
+#include <AP_InertialSensor/AP_InertialSensor.h>
+#include <AP_Logger/AP_Logger.h>
+#include <GCS_MAVLink/GCS.h>
+
+extern const AP_HAL::HAL& hal;
+
+#define GYROFFT_MIN_WINDOW      32
+#define GYROFFT_MAX_WINDOW      512
+// the windows are sampled at no less than this multiple of the maximum frequency
+#define GYROFFT_OVERSAMPLE      2.5f
+// minimum ratio of the peak power to the mean power in the band
+#define GYROFFT_MIN_SNR         4.0f
+// a peak older than this is no longer used
+#define GYROFFT_TIMEOUT_MS      1000
+// smoothing applied to successive peak frequencies
+#define GYROFFT_FREQ_ALPHA      0.3f
+
+// table of user settable parameters
+const AP_Param::GroupInfo AP_GyroFFT::var_info[] = {
+
+    // @Param: ENABLE
+    // @DisplayName: Gyro FFT enable
+    // @Description: Enable on board spectral analysis of the gyro to track the dominant vibration frequency
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO_FLAGS("ENABLE", 1, AP_GyroFFT, _enable, 0, AP_PARAM_FLAG_ENABLE),
+
+    // @Param: MINHZ
+    // @DisplayName: Gyro FFT minimum frequency
+    // @Description: Lowest frequency in Hz that a vibration peak will be tracked at
+    // @Range: 10 400
+    // @Units: Hz
+    // @User: Advanced
+    AP_GROUPINFO("MINHZ", 2, AP_GyroFFT, _min_hz, 80),
+
+    // @Param: MAXHZ
+    // @DisplayName: Gyro FFT maximum frequency
+    // @Description: Highest frequency in Hz that a vibration peak will be tracked at. The gyro is decimated to a little over twice this rate before analysis.
+    // @Range: 20 495
+    // @Units: Hz
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("MAXHZ", 3, AP_GyroFFT, _max_hz, 400),
+
+    // @Param: WINDOW
+    // @DisplayName: Gyro FFT window size
+    // @Description: Number of samples in each analysis window. Larger windows give finer frequency resolution but respond more slowly and use more memory.
+    // @Values: 32:32,64:64,128:128,256:256,512:512
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("WINDOW", 4, AP_GyroFFT, _window_size, 128),
+
+    AP_GROUPEND
+};
+
+AP_GyroFFT::AP_GyroFFT(void)
+{
+    AP_Param::setup_object_defaults(this, var_info);
+
+    if (_singleton != nullptr) {
+        AP_HAL::panic("AP_GyroFFT must be singleton");
+    }
+    _singleton = this;
+}
+
+/*
+  allocate the buffers and start the analysis thread. Must be called
+  after the IMU has been initialised so the raw gyro rate is known
+ */
+void AP_GyroFFT::init(void)
+{
+    if (_initialised || !enabled()) {
+        return;
+    }
+
+    const float raw_rate_hz = AP::ins().get_raw_gyro_rate_hz(0);
+    const float max_hz = constrain_float(_max_hz, 20, 495);
+    if (raw_rate_hz < GYROFFT_OVERSAMPLE * max_hz) {
+        gcs().send_text(MAV_SEVERITY_WARNING, "GyroFFT: gyro rate too low");
+        return;
+    }
+    _decimation = constrain_int16(raw_rate_hz / (GYROFFT_OVERSAMPLE * max_hz), 1, 255);
+    _sample_rate_hz = raw_rate_hz / _decimation;
+
+    // round the window down to a power of two
+    const uint16_t window_size = constrain_int16(_window_size, GYROFFT_MIN_WINDOW, GYROFFT_MAX_WINDOW);
+    _n = GYROFFT_MIN_WINDOW;
+    while (_n * 2 <= window_size) {
+        _n *= 2;
+    }
+
+    for (uint8_t i = 0; i < 2; i++) {
+        _samples_x[i] = new float[_n];
+        _samples_y[i] = new float[_n];
+    }
+    _hann = new float[_n];
+    _cos = new float[_n/2];
+    _sin = new float[_n/2];
+    _work = new float[_n];
+    _power = new float[_n/2+1];
+    if (_samples_x[0] == nullptr || _samples_x[1] == nullptr ||
+        _samples_y[0] == nullptr || _samples_y[1] == nullptr ||
+        _hann == nullptr || _cos == nullptr || _sin == nullptr ||
+        _work == nullptr || _power == nullptr) {
+        gcs().send_text(MAV_SEVERITY_WARNING, "GyroFFT: failed to allocate %u bytes", (unsigned)(_n * 9 * sizeof(float)));
+        return;
+    }
+
+    for (uint16_t i = 0; i < _n; i++) {
+        _hann[i] = 0.5f - 0.5f * cosf(M_2PI * i / _n);
+    }
+    for (uint16_t k = 0; k < _n/2; k++) {
+        _cos[k] = cosf(M_2PI * k / _n);
+        _sin[k] = sinf(M_2PI * k / _n);
+    }
+
+    // run below the main loop so the analysis only uses spare time
+    if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_GyroFFT::fft_thread, void),
+                                      "gyrofft",
+                                      2048, AP_HAL::Scheduler::PRIORITY_IO, -1)) {
+        gcs().send_text(MAV_SEVERITY_WARNING, "GyroFFT: failed to start thread");
+        return;
+    }
+
+    _initialised = true;
+}
+
+/*
+  decimate a raw gyro sample into the window being filled. When the
+  window is full it is handed to the thread if the thread has finished
+  with the previous one, otherwise the window is dropped and refilled
+ */
+void AP_GyroFFT::sample(const Vector3f &gyro)
+{
+    if (!_initialised) {
+        return;
+    }
+
+    _accum += gyro;
+    if (++_accum_count < _decimation) {
+        return;
+    }
+    _accum /= _accum_count;
+    _samples_x[_fill][_fill_count] = _accum.x;
+    _samples_y[_fill][_fill_count] = _accum.y;
+    _accum.zero();
+    _accum_count = 0;
+
+    if (++_fill_count < _n) {
+        return;
+    }
+    _fill_count = 0;
+    if (_ready.load() < 0) {
+        _ready.store(_fill);
+        _fill ^= 1;
+    } else {
+        _overruns++;
+    }
+}
+
+// the analysis thread, which waits for full windows
+void AP_GyroFFT::fft_thread(void)
+{
+    while (true) {
+        const int8_t ready = _ready.load();
+        if (ready < 0) {
+            hal.scheduler->delay(1);
+            continue;
+        }
+        analyse(_samples_x[ready], _samples_y[ready]);
+        _ready.store(-1);
+    }
+}
+
+/*
+  find the strongest peak in the summed roll and pitch spectrum
+ */
+void AP_GyroFFT::analyse(const float *window_x, const float *window_y)
+{
+    const uint16_t nbins = _n/2 + 1;
+    memset(_power, 0, nbins * sizeof(float));
+    power_spectrum(window_x, _power);
+    power_spectrum(window_y, _power);
+
+    const float bin_hz = _sample_rate_hz / _n;
+    const uint16_t min_bin = MAX(1, uint16_t(ceilf(_min_hz / bin_hz)));
+    const uint16_t max_bin = MIN(uint16_t(nbins - 2), uint16_t(_max_hz / bin_hz));
+    if (max_bin <= min_bin) {
+        return;
+    }
+
+    uint16_t peak_bin = min_bin;
+    float total = 0;
+    for (uint16_t k = min_bin; k <= max_bin; k++) {
+        total += _power[k];
+        if (_power[k] > _power[peak_bin]) {
+            peak_bin = k;
+        }
+    }
+    const float mean = total / (max_bin - min_bin + 1);
+    if (!is_positive(mean)) {
+        return;
+    }
+    const float snr = _power[peak_bin] / mean;
+    if (snr < GYROFFT_MIN_SNR) {
+        return;
+    }
+
+    // quadratic interpolation of the magnitudes either side of the peak
+    const float m0 = sqrtf(_power[peak_bin-1]);
+    const float m1 = sqrtf(_power[peak_bin]);
+    const float m2 = sqrtf(_power[peak_bin+1]);
+    const float denom = m0 - 2 * m1 + m2;
+    float delta = 0;
+    if (!is_zero(denom)) {
+        delta = constrain_float(0.5f * (m0 - m2) / denom, -0.5f, 0.5f);
+    }
+    const float freq_hz = (peak_bin + delta) * bin_hz;
+
+    // amplitude of a sine wave giving this peak, the Hann window sums to n/2
+    const float amplitude = 4 * m1 / _n;
+
+    WITH_SEMAPHORE(_sem);
+    const uint32_t now_ms = AP_HAL::millis();
+    if (_peak.count == 0 || now_ms - _peak.last_update_ms > GYROFFT_TIMEOUT_MS) {
+        _peak.freq_hz = freq_hz;
+    } else {
+        _peak.freq_hz += GYROFFT_FREQ_ALPHA * (freq_hz - _peak.freq_hz);
+    }
+    _peak.energy = amplitude;
+    _peak.snr = snr;
+    _peak.last_update_ms = now_ms;
+    _peak.count++;
+}
+
+/*
+  window one axis, take its real FFT as an FFT of n/2 complex values
+  and add the power in bins 0 to n/2 to power
+ */
+void AP_GyroFFT::power_spectrum(const float *samples, float *power)
+{
+    // pack even samples into the real parts and odd into the imaginary
+    for (uint16_t i = 0; i < _n; i++) {
+        _work[i] = samples[i] * _hann[i];
+    }
+    const uint16_t m = _n/2;
+    complex_fft(_work, m);
+
+    // separate the spectra of the even and odd samples and combine them
+    for (uint16_t k = 0; k <= m; k++) {
+        const uint16_t k0 = k % m;
+        const uint16_t k1 = (m - k) % m;
+        const float zr = _work[2*k0];
+        const float zi = _work[2*k0+1];
+        const float cr = _work[2*k1];
+        const float ci = -_work[2*k1+1];
+        const float er = 0.5f * (zr + cr);
+        const float ei = 0.5f * (zi + ci);
+        const float odd_r = 0.5f * (zi - ci);
+        const float odd_i = -0.5f * (zr - cr);
+        const float wr = (k < m) ? _cos[k] : -1.0f;
+        const float wi = (k < m) ? -_sin[k] : 0.0f;
+        const float xr = er + wr * odd_r - wi * odd_i;
+        const float xi = ei + wr * odd_i + wi * odd_r;
+        power[k] += sq(xr) + sq(xi);
+    }
+}
+
+/*
+  iterative radix 2 FFT of n complex values stored as interleaved real
+  and imaginary parts. The twiddle tables are for _n points, n is at
+  most _n/2
+ */
+void AP_GyroFFT::complex_fft(float *data, uint16_t n) const
+{
+    // bit reversal permutation
+    for (uint16_t i = 0, j = 0; i < n - 1; i++) {
+        if (i < j) {
+            float t = data[2*i];
+            data[2*i] = data[2*j];
+            data[2*j] = t;
+            t = data[2*i+1];
+            data[2*i+1] = data[2*j+1];
+            data[2*j+1] = t;
+        }
+        uint16_t bit = n >> 1;
+        while (j & bit) {
+            j ^= bit;
+            bit >>= 1;
+        }
+        j |= bit;
+    }
+
+    for (uint16_t len = 2; len <= n; len <<= 1) {
+        const uint16_t half = len / 2;
+        const uint16_t step = _n / len;
+        for (uint16_t i = 0; i < n; i += len) {
+            for (uint16_t j = 0; j < half; j++) {
+                const float wr = _cos[j * step];
+                const float wi = -_sin[j * step];
+                float *a = &data[2*(i+j)];
+                float *b = &data[2*(i+j+half)];
+                const float tr = wr * b[0] - wi * b[1];
+                const float ti = wr * b[1] + wi * b[0];
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+}
+
+// log the tracked peak
+void AP_GyroFFT::update(void)
+{
+    if (!_initialised) {
+        return;
+    }
+
+    WITH_SEMAPHORE(_sem);
+    const struct log_GyroFFT pkt = {
+        LOG_PACKET_HEADER_INIT(LOG_GYRO_FFT_MSG),
+        time_us     : AP_HAL::micros64(),
+        freq_hz     : _peak.freq_hz,
+        amplitude   : _peak.energy,
+        snr         : _peak.snr,
+        overruns    : _overruns,
+        healthy     : healthy(),
+    };
+    AP::logger().WriteBlock(&pkt, sizeof(pkt));
+}
+
+bool AP_GyroFFT::healthy(void) const
+{
+    return _initialised && _peak.count > 0 &&
+        AP_HAL::millis() - _peak.last_update_ms < GYROFFT_TIMEOUT_MS;
+}
+
+float AP_GyroFFT::get_peak_freq_hz(void) const
+{
+    WITH_SEMAPHORE(_sem);
+    if (!healthy()) {
+        return 0;
+    }
+    return _peak.freq_hz;
+}
+
+// singleton instance
+AP_GyroFFT *AP_GyroFFT::_singleton;
+
+namespace AP {
+
+AP_GyroFFT *fft()
+{
+    return AP_GyroFFT::get_singleton();
+}
+
+}
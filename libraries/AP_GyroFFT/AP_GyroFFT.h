@@ -0,0 +1,128 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  on board spectral analysis of the gyro, used to track the frequency
+  of the dominant vibration for the harmonic notch filter.
+
+  Raw gyro samples from the first IMU are decimated into one of two
+  sample windows by the IMU backend. When a window is full it is handed
+  to a low priority thread which applies a Hann window and a real FFT
+  to the roll and pitch axes, and finds the strongest peak in the
+  configured frequency range.
+ */
+
+#include <AP_Common/AP_Common.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Param/AP_Param.h>
+#include <AP_Math/AP_Math.h>
+#include <atomic>
+
+class AP_GyroFFT
+{
+public:
+    AP_GyroFFT();
+
+    /* Do not allow copies */
+    AP_GyroFFT(const AP_GyroFFT &other) = delete;
+    AP_GyroFFT &operator=(const AP_GyroFFT&) = delete;
+
+    // allocate the sample windows and start the analysis thread
+    void init(void);
+
+    // add a raw gyro sample. Called from the IMU backend at the raw
+    // gyro rate, so it never blocks
+    void sample(const Vector3f &gyro);
+
+    // log the tracked peak. Should be called from the main loop
+    void update(void);
+
+    // true if a peak has been found recently
+    bool healthy(void) const;
+
+    // frequency of the tracked peak in Hz, or zero if not healthy
+    float get_peak_freq_hz(void) const;
+
+    bool enabled(void) const { return _enable != 0; }
+
+    static const struct AP_Param::GroupInfo var_info[];
+
+    static AP_GyroFFT *get_singleton() { return _singleton; }
+
+private:
+    static AP_GyroFFT *_singleton;
+
+    // the analysis thread
+    void fft_thread(void);
+    // analyse one sample window
+    void analyse(const float *window_x, const float *window_y);
+    // add the power spectrum of one axis to power, which has n/2+1 bins
+    void power_spectrum(const float *samples, float *power);
+    // in place complex FFT of n interleaved complex values
+    void complex_fft(float *data, uint16_t n) const;
+
+    // parameters
+    AP_Int8 _enable;
+    AP_Int16 _min_hz;
+    AP_Int16 _max_hz;
+    AP_Int16 _window_size;
+
+    // number of samples in each window
+    uint16_t _n;
+    // raw gyro samples averaged into each window sample
+    uint8_t _decimation;
+    // sample rate of the windows in Hz
+    float _sample_rate_hz;
+
+    // two sample windows per axis. The backend fills window _fill
+    // while the thread analyses window _ready
+    float *_samples_x[2];
+    float *_samples_y[2];
+    uint16_t _fill_count;
+    uint8_t _fill;
+    std::atomic<int8_t> _ready{-1};
+    // decimation accumulator
+    Vector3f _accum;
+    uint8_t _accum_count;
+    // windows dropped because the thread was still busy
+    uint32_t _overruns;
+
+    // Hann window coefficients
+    float *_hann;
+    // twiddle factors, cos and sin of 2*pi*k/n for k < n/2
+    float *_cos;
+    float *_sin;
+    // FFT work buffer of n floats and the summed power spectrum of
+    // n/2+1 bins
+    float *_work;
+    float *_power;
+
+    // the result, published by the thread
+    struct {
+        float freq_hz;
+        float energy;
+        float snr;
+        uint32_t last_update_ms;
+        uint32_t count;
+    } _peak;
+    mutable HAL_Semaphore _sem;
+
+    bool _initialised;
+};
+
+namespace AP {
+    AP_GyroFFT *fft();
+};
@@ -184,6 +184,15 @@
 #define HAL_MINIMIZE_FEATURES       0
 #endif
 
+// record how long WITH_SEMAPHORE() waits on contended semaphores
+#ifndef HAL_SEMAPHORE_STATS_ENABLED
+#if HAL_MINIMIZE_FEATURES || defined(HAL_BOOTLOADER_BUILD) || defined(IOMCU_FW)
+#define HAL_SEMAPHORE_STATS_ENABLED 0
+#else
+#define HAL_SEMAPHORE_STATS_ENABLED 1
+#endif
+#endif
+
 #ifndef HAL_OS_FATFS_IO
 #define HAL_OS_FATFS_IO 0
 #endif
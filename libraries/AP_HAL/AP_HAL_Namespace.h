@@ -27,6 +27,8 @@ namespace AP_HAL {
     class RCOutput;
     class Scheduler;
     class Semaphore;
+    class BinarySemaphore;
+    class SemaphoreStats;
     class OpticalFlow;
 
     class CANProtocol;
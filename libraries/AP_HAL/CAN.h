@@ -126,6 +126,12 @@ public:
     virtual bool is_initialized() = 0;
     virtual void initialized(bool val) = 0;
 
+    /*
+     Wake a thread blocked in select() on the driver, so it can act on
+     something other than bus activity without waiting for its timeout
+     */
+    virtual void wake_driver() {}
+
     uavcan::ICanDriver* get_driver() { return _driver; }
 private:
     uavcan::ICanDriver* _driver;
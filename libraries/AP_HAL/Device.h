@@ -103,6 +103,34 @@ public:
     virtual bool transfer(const uint8_t *send, uint32_t send_len,
                           uint8_t *recv, uint32_t recv_len) = 0;
 
+    /*
+     * One transaction of a batch passed to #transfer_batch(), with the
+     * same meaning as the arguments of #transfer()
+     */
+    struct Transfer {
+        const uint8_t *send;
+        uint32_t send_len;
+        uint8_t *recv;
+        uint32_t recv_len;
+    };
+
+    /*
+     * Run several independent transactions back to back. Buses that can
+     * queue them, like Linux spidev, submit the whole batch to the kernel
+     * at once. Others run them one by one with #transfer().
+     *
+     * Return: true if all transfers succeeded, false on the first failure.
+     */
+    virtual bool transfer_batch(const Transfer *transfers, uint8_t count) {
+        for (uint8_t i = 0; i < count; i++) {
+            const Transfer &t = transfers[i];
+            if (!transfer(t.send, t.send_len, t.recv, t.recv_len)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     /**
      * Wrapper function over #transfer() to read recv_len registers, starting
      * by first_reg, into the array pointed by recv. The read flag passed to
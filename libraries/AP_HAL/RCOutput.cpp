@@ -52,3 +52,13 @@ void AP_HAL::RCOutput::append_to_banner(char banner_msg[], uint8_t banner_msg_le
         hal.util->snprintf(banner_msg, banner_msg_len, "%s %s:%u-%u", banner_msg_temp, mode_str, (unsigned)low_ch, (unsigned)high_ch);
     }
 }
+
+// write a set of channels, one at a time unless the backend can do better
+void AP_HAL::RCOutput::write_channels(uint32_t chmask, const uint16_t *period_us)
+{
+    for (uint8_t i = 0; chmask != 0; i++, chmask >>= 1) {
+        if (chmask & 1U) {
+            write(i, period_us[i]);
+        }
+    }
+}
@@ -50,6 +50,14 @@ public:
      */
     virtual void     write(uint8_t chan, uint16_t period_us) = 0;
 
+    /*
+     * Output a set of channels in one call, writing period_us[i] to
+     * each channel i in chmask. As with write() the values go to the
+     * hardware straight away unless cork() has been called, but all
+     * of them together.
+     */
+    virtual void     write_channels(uint32_t chmask, const uint16_t *period_us);
+
     /*
      * mark the channels in chanmask as reversible. This is needed for some ESC types (such as DShot)
      * so that output scaling can be performed correctly. The chanmask passed is added (ORed) into
@@ -133,6 +141,30 @@ public:
      */
     virtual void timer_tick(void) { }
 
+    /*
+      time in microseconds that the values from the last push() started
+      going out by DMA, for latency measurement. Zero if not known
+     */
+    virtual uint32_t get_push_dma_start_us(void) const { return 0; }
+
+    /*
+      enable bidirectional DShot on a mask of channels. The ESCs on
+      these channels answer each frame with their eRPM, which is
+      decoded by the HAL
+     */
+    virtual void set_bidir_dshot_mask(uint16_t mask) {}
+
+    /*
+      latest eRPM from bidirectional DShot on a channel, zero if none
+     */
+    virtual uint32_t get_erpm(uint8_t chan) const { return 0; }
+
+    /*
+      percentage of bidirectional DShot frames on a channel that did
+      not decode over the last second
+     */
+    virtual float get_erpm_error_rate(uint8_t chan) const { return 100.0f; }
+
     /*
       setup for serial output to an ESC using the given
       baudrate. Assumes 1 start bit, 1 stop bit, LSB first and 8
@@ -121,6 +121,15 @@ public:
         return false;
     }
 
+    /*
+      pin the calling thread to one CPU core. Returns false if the HAL
+      does not support thread affinity
+     */
+    virtual bool set_thread_affinity(uint8_t core) { return false; }
+
+    // return the number of CPU cores threads can be run on
+    virtual uint8_t get_num_cores() const { return 1; }
+
 private:
 
     AP_HAL::Proc _delay_cb;
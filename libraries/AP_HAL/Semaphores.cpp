@@ -16,7 +16,15 @@ WithSemaphore::WithSemaphore(AP_HAL::Semaphore &mtx, uint32_t line) :
     if (in_main) {
         hal.util->persistent_data.semaphore_line = line;
     }
+#if HAL_SEMAPHORE_STATS_ENABLED
+    if (!_mtx.take_nonblocking()) {
+        const uint32_t start_us = AP_HAL::micros();
+        _mtx.take_blocking();
+        AP_HAL::SemaphoreStats::record(_mtx, line, AP_HAL::micros() - start_us);
+    }
+#else
     _mtx.take_blocking();
+#endif
     if (in_main) {
         hal.util->persistent_data.semaphore_line = 0;
     }
@@ -26,3 +34,84 @@ WithSemaphore::~WithSemaphore()
 {
     _mtx.give();
 }
+
+#if HAL_SEMAPHORE_STATS_ENABLED
+
+#ifndef HAL_SEMAPHORE_STATS_MAX
+#define HAL_SEMAPHORE_STATS_MAX 16
+#endif
+
+static AP_HAL::SemaphoreStats::Entry stats_entries[HAL_SEMAPHORE_STATS_MAX];
+static uint8_t stats_num_entries;
+// taken directly rather than with WITH_SEMAPHORE() so we don't record
+// ourselves
+static HAL_Semaphore stats_sem;
+
+/*
+  find the entry for a semaphore, adding one if there is room. Called
+  with stats_sem held
+ */
+AP_HAL::SemaphoreStats::Entry *AP_HAL::SemaphoreStats::find(const AP_HAL::Semaphore &sem)
+{
+    for (uint8_t i=0; i<stats_num_entries; i++) {
+        if (stats_entries[i].sem == &sem) {
+            return &stats_entries[i];
+        }
+    }
+    if (stats_num_entries == HAL_SEMAPHORE_STATS_MAX) {
+        return nullptr;
+    }
+    Entry *e = &stats_entries[stats_num_entries++];
+    e->sem = &sem;
+    return e;
+}
+
+void AP_HAL::SemaphoreStats::set_name(const AP_HAL::Semaphore &sem, const char *name)
+{
+    stats_sem.take_blocking();
+    Entry *e = find(sem);
+    if (e != nullptr) {
+        e->name = name;
+    }
+    stats_sem.give();
+}
+
+void AP_HAL::SemaphoreStats::record(const AP_HAL::Semaphore &sem, uint16_t line, uint32_t wait_us)
+{
+    uint8_t b = 0;
+    for (uint32_t limit_us = 10; b < num_buckets-1 && wait_us >= limit_us; limit_us *= 10) {
+        b++;
+    }
+    stats_sem.take_blocking();
+    Entry *e = find(sem);
+    if (e != nullptr) {
+        if (e->line == 0) {
+            e->line = line;
+        }
+        e->count++;
+        e->buckets[b]++;
+        if (wait_us > e->max_us) {
+            e->max_us = wait_us;
+        }
+    }
+    stats_sem.give();
+}
+
+bool AP_HAL::SemaphoreStats::get(uint8_t i, Entry &entry)
+{
+    stats_sem.take_blocking();
+    const bool ret = i < stats_num_entries;
+    if (ret) {
+        entry = stats_entries[i];
+    }
+    stats_sem.give();
+    return ret;
+}
+
+#else
+
+void AP_HAL::SemaphoreStats::set_name(const AP_HAL::Semaphore &sem, const char *name) {}
+void AP_HAL::SemaphoreStats::record(const AP_HAL::Semaphore &sem, uint16_t line, uint32_t wait_us) {}
+bool AP_HAL::SemaphoreStats::get(uint8_t i, Entry &entry) { return false; }
+
+#endif // HAL_SEMAPHORE_STATS_ENABLED
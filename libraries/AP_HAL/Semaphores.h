@@ -21,6 +21,63 @@ public:
     virtual ~Semaphore(void) {}
 };
 
+/*
+  a binary semaphore used to signal between threads. Unlike a
+  Semaphore it is not owned, so one thread can wait() on it while
+  another thread calls signal(). A signal sent while nobody is waiting
+  is remembered until the next wait()
+ */
+class AP_HAL::BinarySemaphore {
+public:
+    BinarySemaphore() {}
+    virtual ~BinarySemaphore(void) {}
+
+    // do not allow copying
+    BinarySemaphore(const BinarySemaphore &other) = delete;
+    BinarySemaphore &operator=(const BinarySemaphore&) = delete;
+
+    // wait up to timeout_us for a signal, returning true if one arrived
+    virtual bool wait(uint32_t timeout_us) WARN_IF_UNUSED = 0;
+    virtual bool wait_blocking() = 0;
+    virtual void signal() = 0;
+};
+
+/*
+  contention statistics for semaphores taken with WITH_SEMAPHORE(),
+  for finding the locks that threads spend time waiting on. Only takes
+  that had to wait are recorded, so an uncontended take costs one
+  extra non-blocking attempt. Semaphores are listed by the name given
+  with set_name(), or otherwise by the line of their first contended
+  take
+ */
+class AP_HAL::SemaphoreStats {
+public:
+    // wait times are counted in decades from 10us: <10us, <100us,
+    // <1ms, <10ms and longer
+    static const uint8_t num_buckets = 5;
+
+    struct Entry {
+        const AP_HAL::Semaphore *sem;
+        const char *name;
+        uint16_t line;
+        uint32_t count;
+        uint32_t max_us;
+        uint32_t buckets[num_buckets];
+    };
+
+    // name a semaphore in the statistics. The name must be a constant
+    static void set_name(const AP_HAL::Semaphore &sem, const char *name);
+
+    // record a take at line which waited wait_us
+    static void record(const AP_HAL::Semaphore &sem, uint16_t line, uint32_t wait_us);
+
+    // copy of statistics entry i, returning false past the last entry
+    static bool get(uint8_t i, Entry &entry);
+
+private:
+    static Entry *find(const AP_HAL::Semaphore &sem);
+};
+
 /*
   a method to make semaphores less error prone. The WITH_SEMAPHORE()
   macro will block forever for a semaphore, and will automatically
@@ -11,4 +11,16 @@ public:
     virtual void write_block(uint16_t dst, const void* src, size_t n) = 0;
     virtual void _timer_tick(void) {};
     virtual bool healthy(void) { return true; }
+
+    // write statistics, comparing what callers changed with what the
+    // backend actually had to write
+    struct Stats {
+        uint32_t bytes_dirtied;     // bytes changed by write_block()
+        uint32_t bytes_written;     // bytes written to the backend, including any headers
+        uint32_t writes;            // backend write operations
+        uint32_t erases;            // flash sector erases
+        uint32_t compactions;       // flash log compactions done while idle
+        uint32_t stall_max_us;      // longest single flush from _timer_tick()
+    };
+    virtual bool get_stats(Stats &stats) { return false; }
 };
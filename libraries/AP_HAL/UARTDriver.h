@@ -4,6 +4,7 @@
 
 #include "AP_HAL_Namespace.h"
 #include "utility/BetterStream.h"
+#include "utility/RingBuffer.h"
 
 /* Pure virtual UARTDriver class */
 class AP_HAL::UARTDriver : public AP_HAL::BetterStream {
@@ -45,6 +46,16 @@ public:
     // and write is discarded
     virtual size_t write_locked(const uint8_t *buffer, size_t size, uint32_t key) { return 0; }
 
+    /*
+      reserve len bytes of the transmit buffer so the caller can fill
+      them in place, in one or two pieces if the buffer wraps. The
+      port is held for writing until write_commit() queues the bytes
+      for transmit. Returns false if the port can't do this or has
+      less than len bytes free, in which case write() should be used
+     */
+    virtual bool write_reserve(ByteBuffer::IoVec vec[2], uint32_t len) { return false; }
+    virtual void write_commit(uint32_t len) {}
+
     // read from a locked port. If port is locked and key is not correct then 0 is returned
     virtual int16_t read_locked(uint32_t key) { return -1; }
     
@@ -111,6 +122,9 @@ public:
         return 57;
     }
 
+    // number of received bytes lost because the read buffer was full
+    virtual uint32_t get_rx_overruns(void) const { return 0; }
+
     uint8_t read_stale(void) {
         uint8_t c = 1;
         return c;
@@ -1,6 +1,7 @@
 #include "AP_HAL.h"
 #include "Util.h"
 #include "utility/print_vprintf.h"
+#include <string.h>
 #if defined(__APPLE__) && defined(__MACH__)
 #include <sys/time.h>
 #elif CONFIG_HAL_BOARD == HAL_BOARD_CHIBIOS
@@ -24,11 +25,11 @@ public:
         return 1;
     }
     size_t write(const uint8_t *buffer, size_t size) override {
-        size_t n = 0;
-        while (size--) {
-            n += write(*buffer++);
+        if (_offs < _size) {
+            memcpy(&_str[_offs], buffer, size < _size - _offs ? size : _size - _offs);
         }
-        return n;
+        _offs += size;
+        return size;
     }
 
     size_t _offs;
@@ -67,6 +68,91 @@ int AP_HAL::Util::vsnprintf(char* str, size_t size, const char *format, va_list
     return int(ret);
 }
 
+/*
+  allocations from malloc_type() are added up by owner. Owners are
+  expected to be string constants, and once the table is full the
+  rest are counted together in the last entry
+ */
+#ifndef HAL_MEMORY_OWNERS_MAX
+#define HAL_MEMORY_OWNERS_MAX 16
+#endif
+
+static AP_HAL::Util::MemoryOwnerStats memory_owners[HAL_MEMORY_OWNERS_MAX];
+static uint8_t num_memory_owners;
+static HAL_Semaphore memory_owners_sem;
+
+void *AP_HAL::Util::malloc_type(size_t size, Memory_Type mem_type, const char *owner)
+{
+    void *ret = _malloc_type(size, mem_type);
+    update_memory_owner(owner, mem_type, ret != nullptr ? int32_t(size) : 0, ret == nullptr);
+    return ret;
+}
+
+void AP_HAL::Util::free_type(void *ptr, size_t size, Memory_Type mem_type, const char *owner)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    _free_type(ptr, size, mem_type);
+    update_memory_owner(owner, mem_type, -int32_t(size), false);
+}
+
+void AP_HAL::Util::update_memory_owner(const char *owner, Memory_Type mem_type, int32_t delta, bool failed)
+{
+    if (mem_type >= MEM_NUM_TYPES) {
+        return;
+    }
+    if (owner == nullptr) {
+        owner = "Other";
+    }
+    WITH_SEMAPHORE(memory_owners_sem);
+    uint8_t i;
+    for (i=0; i<num_memory_owners; i++) {
+        if (memory_owners[i].owner == owner || strcmp(memory_owners[i].owner, owner) == 0) {
+            break;
+        }
+    }
+    if (i == num_memory_owners) {
+        if (num_memory_owners < HAL_MEMORY_OWNERS_MAX) {
+            memory_owners[num_memory_owners++].owner = owner;
+        } else {
+            i = HAL_MEMORY_OWNERS_MAX - 1;
+            memory_owners[i].owner = "Other";
+        }
+    }
+    MemoryOwnerStats &s = memory_owners[i];
+    if (failed) {
+        s.failures++;
+        return;
+    }
+    if (delta > 0) {
+        s.allocs++;
+    }
+    if (delta < 0 && uint32_t(-delta) > s.allocated[mem_type]) {
+        // freed with a different owner or size than allocated
+        s.allocated[mem_type] = 0;
+    } else {
+        s.allocated[mem_type] += delta;
+    }
+    uint32_t total = 0;
+    for (uint8_t t=0; t<MEM_NUM_TYPES; t++) {
+        total += s.allocated[t];
+    }
+    if (total > s.peak) {
+        s.peak = total;
+    }
+}
+
+bool AP_HAL::Util::get_memory_owner_stats(uint8_t idx, MemoryOwnerStats &stats) const
+{
+    WITH_SEMAPHORE(memory_owners_sem);
+    if (idx >= num_memory_owners) {
+        return false;
+    }
+    stats = memory_owners[idx];
+    return true;
+}
+
 uint64_t AP_HAL::Util::get_hw_rtc() const
 {
 #if defined(__APPLE__) && defined(__MACH__)
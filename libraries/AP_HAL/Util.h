@@ -151,18 +151,86 @@ public:
     virtual void perf_end(perf_counter_t h) {}
     virtual void perf_count(perf_counter_t h) {}
 
-    // allocate and free DMA-capable memory if possible. Otherwise return normal memory
+    /*
+      trace points recorded with a timestamp by an external tracer,
+      such as LTTng on Linux. They cost a virtual call when the HAL
+      has no tracer
+     */
+    enum trace_event {
+        TRACE_TASK_BEGIN,       // scheduler task about to run, arg is the task index
+        TRACE_TASK_END,         // scheduler task finished, arg is the task index
+        TRACE_GYRO_SAMPLE,      // raw gyro sample arrived, arg is the instance
+        TRACE_ACCEL_SAMPLE,     // raw accel sample arrived, arg is the instance
+        TRACE_RCOUT_PUSH,       // outputs pushed to the RCOutput driver, arg counts pushes
+    };
+    virtual void trace(trace_event event, const char *name, uint32_t arg) {}
+
+    // allocate and free DMA-capable memory if possible. Otherwise
+    // return normal memory. The owner names the subsystem making the
+    // allocation, so the memory report can show where memory has gone
     enum Memory_Type {
         MEM_DMA_SAFE,
-        MEM_FAST
+        MEM_FAST,
+        MEM_NUM_TYPES
+    };
+    void *malloc_type(size_t size, Memory_Type mem_type, const char *owner = nullptr);
+    void free_type(void *ptr, size_t size, Memory_Type mem_type, const char *owner = nullptr);
+
+    /*
+      bytes currently allocated with malloc_type() by an owner
+     */
+    struct MemoryOwnerStats {
+        const char *owner;
+        uint32_t allocated[MEM_NUM_TYPES];  // bytes in use of each memory type
+        uint32_t peak;                      // highest total of allocated
+        uint16_t allocs;                    // allocations made
+        uint16_t failures;                  // allocations that failed
     };
-    virtual void *malloc_type(size_t size, Memory_Type mem_type) { return calloc(1, size); }
-    virtual void free_type(void *ptr, size_t size, Memory_Type mem_type) { return free(ptr); }
+
+    /*
+      get the statistics of the idx'th owner to use malloc_type().
+      Returns false when idx is past the last owner
+     */
+    bool get_memory_owner_stats(uint8_t idx, MemoryOwnerStats &stats) const;
+
+    /*
+      allocation statistics of a memory type
+     */
+    struct MemoryStats {
+        uint32_t allocated;             // bytes in use from the size class pools
+        uint32_t peak;                  // highest value of allocated
+        uint32_t arena_free;            // bytes of the pool arena not in use
+        uint32_t pool_allocs;           // allocations served by the pools
+        uint32_t heap_allocs;           // allocations that fell back to the heap
+        uint32_t failures;              // allocations that failed
+        uint32_t heap_free;             // free bytes in heaps able to hold this type
+        uint32_t heap_largest;          // largest free block in those heaps
+    };
+
+    /*
+      get the allocation statistics of a memory type. Returns false if
+      not supported
+     */
+    virtual bool get_memory_stats(Memory_Type mem_type, MemoryStats &stats) { return false; }
 
 #ifdef ENABLE_HEAP
     // heap functions, note that a heap once alloc'd cannot be dealloc'd
     virtual void *allocate_heap_memory(size_t size) = 0;
     virtual void *heap_realloc(void *heap, void *ptr, size_t new_size) = 0;
+
+    /*
+      statistics of a heap from allocate_heap_memory()
+     */
+    struct HeapStats {
+        uint32_t size;                  // bytes available to allocations
+        uint32_t used;                  // bytes allocated
+        uint32_t peak;                  // highest value of used
+        uint32_t free;                  // bytes free
+        uint32_t largest_free;          // largest allocation sure to succeed
+        uint32_t allocs;                // allocations made
+        uint32_t failures;              // allocations that failed
+    };
+    virtual bool get_heap_stats(void *heap, HeapStats &stats) { return false; }
 #if USE_LIBC_REALLOC
     virtual void *std_realloc(void *ptr, size_t new_size) { return realloc(ptr, new_size); }
 #else
@@ -171,6 +239,42 @@ public:
 #endif // ENABLE_HEAP
 
 
+    /*
+      lock statistics of a DMA stream shared between peripherals
+     */
+    struct DMAStats {
+        // number of log2 buckets in wait_hist, matching AP::PerfInfo
+        static const uint8_t WAIT_BINS = 16;
+        uint32_t lock_count;            // times the stream was locked
+        uint32_t contended_count;       // locks that had to wait for another user
+        uint32_t nonblock_fail_count;   // non-blocking lock attempts that failed
+        uint32_t max_wait_us;           // longest wait for the stream
+        uint16_t wait_hist[WAIT_BINS];  // lock waits in microseconds, log2 buckets
+    };
+
+    /*
+      get the statistics of shared DMA stream stream_id. Returns false
+      if stream_id is beyond the last stream
+     */
+    virtual bool get_dma_stats(uint8_t stream_id, DMAStats &stats) { return false; }
+
+    /*
+      CPU load and stack usage of a thread
+     */
+    struct ThreadStats {
+        char name[16];
+        uint16_t load;                  // share of CPU time over the last second, in units of 0.1%
+        uint32_t stack_free;            // lowest free stack seen, in bytes
+        uint32_t jitter_avg_us;         // mean wakeup lateness of a periodic thread, 0 if not periodic
+        uint32_t jitter_max_us;         // worst wakeup lateness since the last call
+    };
+
+    /*
+      get the statistics of thread idx. Returns false if idx is beyond
+      the last thread
+     */
+    virtual bool get_thread_stats(uint8_t idx, ThreadStats &stats) { return false; }
+
     /**
        how much free memory do we have in bytes. If unknown return 4096
      */
@@ -186,4 +290,12 @@ protected:
     // values until the vehicle code has fully started
     bool soft_armed = false;
     uint32_t last_armed_change_ms;
+
+    // memory allocation for malloc_type() and free_type()
+    virtual void *_malloc_type(size_t size, Memory_Type mem_type) { return calloc(1, size); }
+    virtual void _free_type(void *ptr, size_t size, Memory_Type mem_type) { return free(ptr); }
+
+private:
+    // add delta bytes to the allocations of owner
+    void update_memory_owner(const char *owner, Memory_Type mem_type, int32_t delta, bool failed);
 };
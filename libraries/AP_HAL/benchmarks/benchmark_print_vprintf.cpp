@@ -0,0 +1,69 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static char buf[128];
+
+// an NMEA GGA sentence body, as sent by AP_NMEA_Output
+static void BM_PrintNMEA(benchmark::State& state)
+{
+    float lat = 3512.345678f;
+    while (state.KeepRunning()) {
+        int n = hal.util->snprintf(buf, sizeof(buf), "$GPGGA,%02u%02u%05.2f,%09.4f,N,%010.4f,E,1,%02u,%.1f,%.1f,M,0,M,,",
+                                   12U, 34U, 56.78f, lat, 14907.0625f, 8U, 1.2f, 123.4f);
+        lat += 0.001f;
+        gbenchmark_escape(&n);
+    }
+}
+
+// short OSD style values
+static void BM_PrintFixedFloat(benchmark::State& state)
+{
+    float v = 12.34f;
+    while (state.KeepRunning()) {
+        int n = hal.util->snprintf(buf, sizeof(buf), "%.1f %.2f %5.2f", v, v * 0.3f, -v);
+        v += 0.01f;
+        gbenchmark_escape(&n);
+    }
+}
+
+static void BM_PrintInts(benchmark::State& state)
+{
+    uint32_t v = 123;
+    while (state.KeepRunning()) {
+        int n = hal.util->snprintf(buf, sizeof(buf), "PreArm: %s %u %d %lx", "Compass", unsigned(v), -int(v), (unsigned long)v);
+        v += 7;
+        gbenchmark_escape(&n);
+    }
+}
+
+static void BM_PrintText(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        int n = hal.util->snprintf(buf, sizeof(buf), "EKF3 IMU0 is using GPS");
+        gbenchmark_escape(&n);
+    }
+}
+
+BENCHMARK(BM_PrintNMEA);
+BENCHMARK(BM_PrintFixedFloat);
+BENCHMARK(BM_PrintInts);
+BENCHMARK(BM_PrintText);
+
+BENCHMARK_MAIN()
@@ -336,4 +336,5 @@
 #include <AP_HAL_Linux/Semaphores.h>
 #define HAL_Semaphore Linux::Semaphore
 #define HAL_Semaphore_Recursive Linux::Semaphore
+#define HAL_BinarySemaphore Linux::BinarySemaphore
 
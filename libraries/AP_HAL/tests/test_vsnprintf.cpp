@@ -52,6 +52,24 @@ TEST(vsnprintf_Test, Basic)
         EXPECT_TRUE(streq(output, "                   0.3333333"));
     }
 
+    { // fixed precision floats, rounding exact ties to even as C does
+        const int bytes_required = hal.util->snprintf(output, ARRAY_SIZE(output), "%.2f %.2f %.0f %.0f %.1f",
+                                                      0.125f, 0.375f, 2.5f, 3.5f, 0.96f);
+        EXPECT_EQ(bytes_required, 17);
+        EXPECT_TRUE(streq(output, "0.12 0.38 2 4 1.0"));
+    }
+    { // sign, padding and negative zero
+        const int bytes_required = hal.util->snprintf(output, ARRAY_SIZE(output), "%08.3f|%-7.1f|%+.2f|% .1f|%.2f",
+                                                      -3.5f, 2.25f, 1.0f, 4.0f, -0.001f);
+        EXPECT_TRUE(streq(output, "-003.500|2.2    |+1.00| 4.0|-0.00"));
+        EXPECT_EQ(bytes_required, 33);
+    }
+    { // NMEA style coordinate
+        const int bytes_required = hal.util->snprintf(output, ARRAY_SIZE(output), "%.3f,%c", 4512.346f, 'N');
+        EXPECT_TRUE(streq(output, "4512.346,N"));
+        EXPECT_EQ(bytes_required, 10);
+    }
+
     { // simple string
         const int bytes_required = hal.util->snprintf(output, ARRAY_SIZE(output), "%s %s %c", "ABC", "DEF", 'x');
         EXPECT_EQ(bytes_required, 9);
@@ -19,3 +19,16 @@ size_t AP_HAL::BetterStream::write(const char *str)
 {
     return write((const uint8_t *)str, strlen(str));
 }
+
+ssize_t AP_HAL::BetterStream::read(uint8_t *buffer, uint16_t count)
+{
+    uint16_t nread = 0;
+    while (nread < count) {
+        const int16_t c = read();
+        if (c < 0) {
+            break;
+        }
+        buffer[nread++] = c;
+    }
+    return nread;
+}
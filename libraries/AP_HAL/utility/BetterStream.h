@@ -43,6 +43,10 @@ public:
      * -1 if nothing available, uint8_t value otherwise. */
     virtual int16_t read() = 0;
 
+    /* read up to count bytes into buffer. returns the number of bytes
+     * read, which is zero if nothing is available */
+    virtual ssize_t read(uint8_t *buffer, uint16_t count);
+
     // virtual int16_t read_stale() = 0;
 
     /* NB txspace was traditionally a member of BetterStream in the
@@ -3,6 +3,18 @@
 
 #include "RingBuffer.h"
 
+/*
+  The buffer is lock free for one writer and one reader. Each side
+  only stores to its own index: the writer to tail and the reader to
+  head. An index is stored with release ordering after the data it
+  covers has been written (or finished with), and the other side loads
+  it with acquire ordering before touching that data. A side's own
+  index can be loaded relaxed as nobody else changes it.
+
+  Callers with several writers (or several readers) must serialise
+  them among themselves, but never need to lock against the other side
+ */
+
 ByteBuffer::ByteBuffer(uint32_t _size)
 {
     buf = (uint8_t*)calloc(1, _size);
@@ -34,16 +46,31 @@ bool ByteBuffer::set_size(uint32_t _size)
     return true;
 }
 
+/*
+ * Caller is responsible for locking in set_buffer()
+ */
+bool ByteBuffer::set_buffer(uint8_t *mem, uint32_t _size)
+{
+    head = tail = 0;
+    if (mem != buf) {
+        free(buf);
+        buf = mem;
+    }
+    size = buf ? _size : 0;
+    return buf != nullptr;
+}
+
 uint32_t ByteBuffer::available(void) const
 {
     /* use a copy on stack to avoid race conditions of @tail being updated by
      * the writer thread */
-    uint32_t _tail = tail;
+    const uint32_t _tail = tail.load(std::memory_order_acquire);
+    const uint32_t _head = head.load(std::memory_order_relaxed);
 
-    if (head > _tail) {
-        return size - head + _tail;
+    if (_head > _tail) {
+        return size - _head + _tail;
     }
-    return _tail - head;
+    return _tail - _head;
 }
 
 void ByteBuffer::clear(void)
@@ -59,21 +86,22 @@ uint32_t ByteBuffer::space(void) const
 
     /* use a copy on stack to avoid race conditions of @head being updated by
      * the reader thread */
-    uint32_t _head = head;
+    const uint32_t _head = head.load(std::memory_order_acquire);
+    const uint32_t _tail = tail.load(std::memory_order_relaxed);
     uint32_t ret = 0;
 
-    if (_head <= tail) {
+    if (_head <= _tail) {
         ret = size;
     }
 
-    ret += _head - tail - 1;
+    ret += _head - _tail - 1;
 
     return ret;
 }
 
 bool ByteBuffer::empty(void) const
 {
-    return head == tail;
+    return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire);
 }
 
 uint32_t ByteBuffer::write(const uint8_t *data, uint32_t len)
@@ -101,11 +129,12 @@ bool ByteBuffer::update(const uint8_t *data, uint32_t len)
         return false;
     }
     // perform as two memcpy calls
-    uint32_t n = size - head;
+    const uint32_t _head = head.load(std::memory_order_relaxed);
+    uint32_t n = size - _head;
     if (n > len) {
         n = len;
     }
-    memcpy(&buf[head], data, n);
+    memcpy(&buf[_head], data, n);
     data += n;
     if (len > n) {
         memcpy(&buf[0], data, len-n);
@@ -118,7 +147,8 @@ bool ByteBuffer::advance(uint32_t n)
     if (n > available()) {
         return false;
     }
-    head = (head + n) % size;
+    // we have finished with the bytes, so the writer may now reuse them
+    head.store((head.load(std::memory_order_relaxed) + n) % size, std::memory_order_release);
     return true;
 }
 
@@ -187,9 +217,10 @@ uint8_t ByteBuffer::reserve(ByteBuffer::IoVec iovec[2], uint32_t len)
         return 0;
     }
 
-    iovec[0].data = &buf[tail];
+    const uint32_t _tail = tail.load(std::memory_order_relaxed);
+    iovec[0].data = &buf[_tail];
 
-    n = size - tail;
+    n = size - _tail;
     if (len <= n) {
         iovec[0].len = len;
         return 1;
@@ -212,7 +243,8 @@ bool ByteBuffer::commit(uint32_t len)
         return false; //Someone broke the agreement
     }
 
-    tail = (tail + len) % size;
+    // publish the bytes written since reserve() to the reader
+    tail.store((tail.load(std::memory_order_relaxed) + len) % size, std::memory_order_release);
     return true;
 }
 
@@ -244,10 +276,11 @@ bool ByteBuffer::read_byte(uint8_t *data)
  */
 const uint8_t *ByteBuffer::readptr(uint32_t &available_bytes)
 {
-    uint32_t _tail = tail;
-    available_bytes = (head > _tail) ? size - head : _tail - head;
+    const uint32_t _tail = tail.load(std::memory_order_acquire);
+    const uint32_t _head = head.load(std::memory_order_relaxed);
+    available_bytes = (_head > _tail) ? size - _head : _tail - _head;
 
-    return available_bytes ? &buf[head] : nullptr;
+    return available_bytes ? &buf[_head] : nullptr;
 }
 
 int16_t ByteBuffer::peek(uint32_t ofs) const
@@ -255,5 +288,5 @@ int16_t ByteBuffer::peek(uint32_t ofs) const
     if (ofs >= available()) {
         return -1;
     }
-    return buf[(head+ofs)%size];
+    return buf[(head.load(std::memory_order_relaxed)+ofs)%size];
 }
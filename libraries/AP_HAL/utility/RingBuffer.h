@@ -44,6 +44,10 @@ public:
     // set size of ringbuffer, caller responsible for locking
     bool set_size(uint32_t size);
 
+    // use memory from malloc() or a HAL allocator as the buffer, taking
+    // ownership of it. Caller responsible for locking
+    bool set_buffer(uint8_t *mem, uint32_t size);
+
     // advance the read pointer (discarding bytes)
     bool advance(uint32_t n);
 
@@ -0,0 +1,88 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <type_traits>
+#include <AP_HAL/AP_HAL_Boards.h>
+
+/*
+  a value which is written by one thread at a time and read by many,
+  for read-mostly state such as a set of outputs published each loop.
+
+  Readers don't take a lock and don't hold up each other or the
+  writer: they copy the value and check a sequence number the writer
+  bumps before and after each write, retrying if a write overlapped.
+  Writers are serialised with a semaphore. A reader which still
+  overlaps a write after a retry waits on that semaphore instead of
+  spinning, as on a single core a spinning reader can keep a lower
+  priority writer from finishing; the semaphore gives the writer the
+  reader's priority until it is done.
+
+  T must be trivially copyable, as it may be copied while being written
+ */
+template <typename T>
+class SeqLock {
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock needs a trivially copyable type");
+
+    SeqLock() {}
+
+    // do not allow copying
+    SeqLock(const SeqLock &other) = delete;
+    SeqLock &operator=(const SeqLock&) = delete;
+
+    // replace the value
+    void write(const T &value) {
+        _sem.take_blocking();
+        const uint32_t seq = _seq.load(std::memory_order_relaxed);
+        // an odd sequence marks a write in progress
+        _seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        _value = value;
+        _seq.store(seq + 2, std::memory_order_release);
+        _sem.give();
+    }
+
+    // copy of the latest value
+    T read(void) const {
+        for (uint8_t i=0; i<2; i++) {
+            const uint32_t seq = _seq.load(std::memory_order_acquire);
+            if (seq & 1) {
+                break;
+            }
+            const T ret = _value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_seq.load(std::memory_order_relaxed) == seq) {
+                return ret;
+            }
+        }
+        _sem.take_blocking();
+        const T ret = _value;
+        _sem.give();
+        return ret;
+    }
+
+    // number of writes so far, for readers to tell if the value has
+    // changed since they last read it
+    uint32_t count(void) const {
+        return _seq.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    mutable HAL_Semaphore _sem;
+    std::atomic<uint32_t> _seq{0};
+    T _value {};
+};
@@ -0,0 +1,378 @@
+#include "TLSF.h"
+
+#ifdef ENABLE_HEAP
+
+#include <stdlib.h>
+#include <string.h>
+
+// index of the highest set bit
+static inline uint8_t fls_size(size_t x)
+{
+    return (sizeof(unsigned long long) * 8 - 1) - __builtin_clzll(x);
+}
+
+// index of the lowest set bit
+static inline uint8_t ffs_u32(uint32_t x)
+{
+    return __builtin_ctz(x);
+}
+
+TLSFHeap *TLSFHeap::create(size_t size)
+{
+    // room for the heap itself, block alignment and the end sentinel
+    const size_t total = sizeof(TLSFHeap) + size + ALIGN + DATA_OFFSET + sizeof(Block);
+    void *mem = malloc(total);
+    if (mem == nullptr) {
+        return nullptr;
+    }
+    TLSFHeap *heap = (TLSFHeap *)mem;
+    if (!heap->init((uint8_t *)mem + sizeof(TLSFHeap), total - sizeof(TLSFHeap))) {
+        free(mem);
+        return nullptr;
+    }
+    return heap;
+}
+
+bool TLSFHeap::init(void *mem, size_t size)
+{
+    memset(this, 0, sizeof(*this));
+
+    // the first block's data must be aligned
+    const uintptr_t start = uintptr_t(mem);
+    const uintptr_t first_data = (start + DATA_OFFSET + ALIGN - 1) & ~uintptr_t(ALIGN - 1);
+    const uintptr_t end = start + size;
+    Block *first = (Block *)(first_data - DATA_OFFSET);
+
+    // the first block runs up to a zero sized used block at the end,
+    // so every block has a next block
+    if (end < first_data + MIN_SIZE + DATA_OFFSET) {
+        return false;
+    }
+    size_t first_size = (end - first_data - DATA_OFFSET) & ~(ALIGN - 1);
+    if (first_size > MAX_SIZE - ALIGN) {
+        first_size = MAX_SIZE - ALIGN;
+    }
+    if (first_size < MIN_SIZE) {
+        return false;
+    }
+    first->size = first_size;
+    mark_free(first);
+    Block *sentinel = block_next(first);
+    sentinel->size = FLAG_PREV_FREE;
+    insert_free(first);
+
+    _size = first_size;
+    return true;
+}
+
+TLSFHeap::Block *TLSFHeap::link_next(Block *b)
+{
+    Block *next = block_next(b);
+    next->prev_phys = b;
+    return next;
+}
+
+void TLSFHeap::mark_free(Block *b)
+{
+    Block *next = link_next(b);
+    next->size |= FLAG_PREV_FREE;
+    b->size |= FLAG_FREE;
+}
+
+void TLSFHeap::mark_used(Block *b)
+{
+    Block *next = block_next(b);
+    next->size &= ~FLAG_PREV_FREE;
+    b->size &= ~FLAG_FREE;
+}
+
+/*
+  round a request up to the alignment and minimum block size. Returns
+  zero if it can never be satisfied
+ */
+size_t TLSFHeap::adjust_size(size_t size)
+{
+    if (size == 0 || size >= MAX_SIZE - ALIGN) {
+        return 0;
+    }
+    size = (size + ALIGN - 1) & ~(ALIGN - 1);
+    if (size < MIN_SIZE) {
+        size = MIN_SIZE;
+    }
+    return size;
+}
+
+/*
+  the list a free block of this size belongs in
+ */
+void TLSFHeap::mapping_insert(size_t size, uint8_t &fl, uint8_t &sl)
+{
+    if (size < SMALL_BLOCK) {
+        fl = 0;
+        sl = size / (SMALL_BLOCK / SL_COUNT);
+    } else {
+        const uint8_t bit = fls_size(size);
+        sl = (size >> (bit - SL_LOG2)) ^ SL_COUNT;
+        fl = bit - (FL_SHIFT - 1);
+    }
+}
+
+/*
+  the first list whose blocks are all at least this size, so a search
+  never needs to walk a list
+ */
+void TLSFHeap::mapping_search(size_t size, uint8_t &fl, uint8_t &sl)
+{
+    if (size >= SMALL_BLOCK) {
+        size += (size_t(1) << (fls_size(size) - SL_LOG2)) - 1;
+    }
+    mapping_insert(size, fl, sl);
+}
+
+TLSFHeap::Block *TLSFHeap::search_suitable(uint8_t &fl, uint8_t &sl) const
+{
+    if (fl >= FL_COUNT) {
+        return nullptr;
+    }
+    uint32_t sl_map = sl_bitmap[fl] & (~0U << sl);
+    if (sl_map == 0) {
+        // nothing big enough at this first level, go up
+        const uint32_t fl_map = fl + 1 < 32 ? fl_bitmap & (~0U << (fl + 1)) : 0;
+        if (fl_map == 0) {
+            return nullptr;
+        }
+        fl = ffs_u32(fl_map);
+        sl_map = sl_bitmap[fl];
+    }
+    sl = ffs_u32(sl_map);
+    return free_lists[fl][sl];
+}
+
+void TLSFHeap::insert_free(Block *b)
+{
+    uint8_t fl, sl;
+    mapping_insert(block_size(b), fl, sl);
+    Block *head = free_lists[fl][sl];
+    b->next_free = head;
+    b->prev_free = nullptr;
+    if (head != nullptr) {
+        head->prev_free = b;
+    }
+    free_lists[fl][sl] = b;
+    _free += block_size(b);
+    fl_bitmap |= 1U << fl;
+    sl_bitmap[fl] |= 1U << sl;
+}
+
+void TLSFHeap::remove_free(Block *b, uint8_t fl, uint8_t sl)
+{
+    _free -= block_size(b);
+    if (b->prev_free != nullptr) {
+        b->prev_free->next_free = b->next_free;
+    }
+    if (b->next_free != nullptr) {
+        b->next_free->prev_free = b->prev_free;
+    }
+    if (free_lists[fl][sl] == b) {
+        free_lists[fl][sl] = b->next_free;
+        if (b->next_free == nullptr) {
+            sl_bitmap[fl] &= ~(1U << sl);
+            if (sl_bitmap[fl] == 0) {
+                fl_bitmap &= ~(1U << fl);
+            }
+        }
+    }
+}
+
+void TLSFHeap::remove_free(Block *b)
+{
+    uint8_t fl, sl;
+    mapping_insert(block_size(b), fl, sl);
+    remove_free(b, fl, sl);
+}
+
+/*
+  split the tail off b, leaving b with size bytes. The tail is marked
+  free but not put in a list
+ */
+TLSFHeap::Block *TLSFHeap::split(Block *b, size_t size)
+{
+    Block *rest = (Block *)(block_data(b) + size - OVERHEAD);
+    rest->size = block_size(b) - (size + OVERHEAD);
+    b->size = size | (b->size & FLAGS);
+    mark_free(rest);
+    return rest;
+}
+
+/*
+  join b onto the end of prev
+ */
+TLSFHeap::Block *TLSFHeap::absorb(Block *prev, Block *b)
+{
+    prev->size += block_size(b) + OVERHEAD;
+    link_next(prev);
+    return prev;
+}
+
+TLSFHeap::Block *TLSFHeap::merge_prev(Block *b)
+{
+    if (b->size & FLAG_PREV_FREE) {
+        Block *prev = b->prev_phys;
+        remove_free(prev);
+        b = absorb(prev, b);
+    }
+    return b;
+}
+
+TLSFHeap::Block *TLSFHeap::merge_next(Block *b)
+{
+    Block *next = block_next(b);
+    if (next->size & FLAG_FREE) {
+        remove_free(next);
+        b = absorb(b, next);
+    }
+    return b;
+}
+
+/*
+  give back the unneeded end of a free block about to be used
+ */
+void TLSFHeap::trim_free(Block *b, size_t size)
+{
+    if (block_size(b) >= sizeof(Block) + size) {
+        insert_free(split(b, size));
+    }
+}
+
+/*
+  give back the unneeded end of a used block
+ */
+void TLSFHeap::trim_used(Block *b, size_t size)
+{
+    if (block_size(b) >= sizeof(Block) + size) {
+        Block *rest = split(b, size);
+        // b stays in use
+        rest->size &= ~FLAG_PREV_FREE;
+        insert_free(merge_next(rest));
+    }
+}
+
+void TLSFHeap::add_used(size_t bytes)
+{
+    _used += bytes;
+    if (_used > _peak) {
+        _peak = _used;
+    }
+}
+
+void *TLSFHeap::allocate(size_t size)
+{
+    const size_t adjusted = adjust_size(size);
+    uint8_t fl, sl;
+    mapping_search(adjusted, fl, sl);
+    Block *b = adjusted != 0 ? search_suitable(fl, sl) : nullptr;
+    if (b == nullptr) {
+        _failures++;
+        return nullptr;
+    }
+    remove_free(b, fl, sl);
+    trim_free(b, adjusted);
+    mark_used(b);
+    add_used(block_size(b));
+    _allocs++;
+    return block_data(b);
+}
+
+void TLSFHeap::release(void *ptr)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    Block *b = data_block(ptr);
+    _used -= block_size(b);
+    mark_free(b);
+    b = merge_prev(b);
+    b = merge_next(b);
+    insert_free(b);
+}
+
+void *TLSFHeap::reallocate(void *ptr, size_t size)
+{
+    if (ptr == nullptr) {
+        return allocate(size);
+    }
+    if (size == 0) {
+        release(ptr);
+        return nullptr;
+    }
+    Block *b = data_block(ptr);
+    const size_t current = block_size(b);
+    const size_t adjusted = adjust_size(size);
+    if (adjusted == 0) {
+        _failures++;
+        return nullptr;
+    }
+    if (adjusted > current) {
+        Block *next = block_next(b);
+        const bool next_free = (next->size & FLAG_FREE) != 0;
+        if (!next_free || adjusted > current + block_size(next) + OVERHEAD) {
+            // can't grow in place, move it
+            void *p = allocate(size);
+            if (p != nullptr) {
+                memcpy(p, ptr, current);
+                release(ptr);
+            }
+            return p;
+        }
+        merge_next(b);
+        mark_used(b);
+    }
+    trim_used(b, adjusted);
+    _used += block_size(b);
+    _used -= current;
+    if (_used > _peak) {
+        _peak = _used;
+    }
+    return ptr;
+}
+
+size_t TLSFHeap::allocation_size(const void *ptr)
+{
+    return block_size(data_block(ptr));
+}
+
+/*
+  the statistics only read counters and bitmaps, so they are safe to
+  take from another thread while the heap is in use
+ */
+void TLSFHeap::get_stats(AP_HAL::Util::HeapStats &stats) const
+{
+    stats.size = _size;
+    stats.used = _used;
+    stats.peak = _peak;
+    stats.free = _free;
+    stats.allocs = _allocs;
+    stats.failures = _failures;
+
+    // every block in the highest non-empty list is at least the
+    // bottom of that list's size range, and a request of that size
+    // searches no higher, so it is the largest allocation that is
+    // sure to succeed
+    stats.largest_free = 0;
+    const uint32_t fl_map = fl_bitmap;
+    if (fl_map != 0) {
+        const uint8_t fl = 31 - __builtin_clz(fl_map);
+        const uint32_t sl_map = sl_bitmap[fl];
+        if (sl_map != 0) {
+            const uint8_t sl = 31 - __builtin_clz(sl_map);
+            if (fl == 0) {
+                stats.largest_free = sl * (SMALL_BLOCK / SL_COUNT);
+            } else {
+                const uint8_t bit = fl + FL_SHIFT - 1;
+                stats.largest_free = (size_t(1) << bit) + sl * (size_t(1) << (bit - SL_LOG2));
+            }
+        }
+    }
+}
+
+#endif // ENABLE_HEAP
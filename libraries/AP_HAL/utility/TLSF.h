@@ -0,0 +1,117 @@
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+
+#ifdef ENABLE_HEAP
+
+/*
+  two level segregated fit allocator, used for the heaps handed out by
+  Util::allocate_heap_memory().
+
+  Free blocks are kept in lists by size class, with a bitmap over the
+  classes, so allocate and release take constant time whatever the
+  state of the heap. Blocks are split to fit and merged with their free
+  neighbours on release, which keeps fragmentation down under the many
+  small short-lived allocations that Lua makes.
+
+  The heap is not thread safe; each heap is expected to be used by one
+  thread. Statistics may be read from any thread
+ */
+class TLSFHeap {
+public:
+    // create a heap with room for size bytes of allocations plus
+    // their overhead, using memory from malloc()
+    static TLSFHeap *create(size_t size);
+
+    // set up a heap in the memory given. Returns false if it is too small
+    bool init(void *mem, size_t size);
+
+    // allocate size bytes, returns nullptr on failure
+    void *allocate(size_t size);
+
+    // release an allocation. ptr may be nullptr
+    void release(void *ptr);
+
+    // change the size of an allocation, in place where possible. With
+    // size zero the allocation is released and nullptr returned
+    void *reallocate(void *ptr, size_t size);
+
+    // usable size of an allocation
+    static size_t allocation_size(const void *ptr);
+
+    void get_stats(AP_HAL::Util::HeapStats &stats) const;
+
+private:
+    struct Block {
+        // stored at the end of the previous block, only valid while
+        // that block is free
+        Block *prev_phys;
+        // size of the block's data, with the flags below in the low bits
+        size_t size;
+        // free list links, only valid while this block is free
+        Block *next_free;
+        Block *prev_free;
+    };
+
+    static const size_t FLAG_FREE = 1;
+    static const size_t FLAG_PREV_FREE = 2;
+    static const size_t FLAGS = FLAG_FREE | FLAG_PREV_FREE;
+
+    // allocations are aligned to the word size, which keeps every
+    // block header aligned too
+    static const uint8_t ALIGN_LOG2 = sizeof(size_t) == 8 ? 3 : 2;
+    static const size_t ALIGN = 1U << ALIGN_LOG2;
+    // second level lists per power of two
+    static const uint8_t SL_LOG2 = 4;
+    static const uint8_t SL_COUNT = 1U << SL_LOG2;
+    // sizes below this are all in the first first level list
+    static const uint8_t FL_SHIFT = SL_LOG2 + ALIGN_LOG2;
+    static const size_t SMALL_BLOCK = 1U << FL_SHIFT;
+    // largest size class is below 2^FL_MAX
+    static const uint8_t FL_MAX = 30;
+    static const uint8_t FL_COUNT = FL_MAX - FL_SHIFT + 1;
+
+    static const size_t OVERHEAD = sizeof(size_t);
+    static const size_t DATA_OFFSET = offsetof(Block, size) + sizeof(size_t);
+    static const size_t MIN_SIZE = sizeof(Block) - sizeof(Block *);
+    static const size_t MAX_SIZE = size_t(1) << FL_MAX;
+
+    uint32_t fl_bitmap;
+    uint32_t sl_bitmap[FL_COUNT];
+    Block *free_lists[FL_COUNT][SL_COUNT];
+
+    uint32_t _size;
+    uint32_t _used;
+    uint32_t _free;
+    uint32_t _peak;
+    uint32_t _allocs;
+    uint32_t _failures;
+
+    static size_t block_size(const Block *b) { return b->size & ~FLAGS; }
+    static uint8_t *block_data(const Block *b) { return (uint8_t *)b + DATA_OFFSET; }
+    static Block *data_block(const void *ptr) { return (Block *)((uint8_t *)ptr - DATA_OFFSET); }
+    static Block *block_next(const Block *b) { return (Block *)(block_data(b) + block_size(b) - OVERHEAD); }
+    static Block *link_next(Block *b);
+    static void mark_free(Block *b);
+    static void mark_used(Block *b);
+
+    static size_t adjust_size(size_t size);
+    static void mapping_insert(size_t size, uint8_t &fl, uint8_t &sl);
+    static void mapping_search(size_t size, uint8_t &fl, uint8_t &sl);
+
+    Block *search_suitable(uint8_t &fl, uint8_t &sl) const;
+    void insert_free(Block *b);
+    void remove_free(Block *b);
+    void remove_free(Block *b, uint8_t fl, uint8_t sl);
+
+    Block *split(Block *b, size_t size);
+    Block *absorb(Block *prev, Block *b);
+    Block *merge_prev(Block *b);
+    Block *merge_next(Block *b);
+    void trim_free(Block *b, size_t size);
+    void trim_used(Block *b, size_t size);
+
+    void add_used(size_t bytes);
+};
+
+#endif // ENABLE_HEAP
@@ -66,6 +66,82 @@
 #define FL_FLTEXP   FL_PREC
 #define FL_FLTFIX   FL_LONG
 
+#if CONFIG_HAL_BOARD != HAL_BOARD_CHIBIOS || __FPU_PRESENT
+static const uint32_t pow10u[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+
+/*
+  fast path for '%f' of a non-negative value with up to 6 decimal
+  places and no more than 7 significant digits, which covers most of
+  what we print, such as NMEA, OSD and STATUSTEXT values. The float is
+  split into its integer mantissa and binary exponent, so the scaling
+  and rounding are done exactly in integers rather than a digit at a
+  time, giving the same digits as C printf. Fills buf with the digits in reverse order, least significant
+  first, and returns the number of characters, or 0 if the value needs
+  the general formatter
+ */
+static uint8_t ftoa_fixed_fast(float value, uint8_t prec, unsigned char *buf)
+{
+    if (prec > 6 || !(value < 1.0e7f / pow10u[prec])) {
+        // too many digits, or NaN or infinite
+        return 0;
+    }
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const int16_t exp = int16_t((bits >> 23) & 0xFF) - 150;
+    const uint32_t mant = (bits & 0x7FFFFF) | 0x800000;
+    uint32_t ipart = 0;
+    uint32_t fpart = 0;
+    if ((bits >> 23) == 0) {
+        // zero or denormal, which rounds to zero
+    } else if (exp >= 0) {
+        // value is below 1e7 so this can't overflow
+        ipart = mant << exp;
+    } else if (exp > -64) {
+        // value = mant / 2^shift
+        const uint8_t shift = -exp;
+        const uint64_t frac = shift < 32 ? mant & ((1UL << shift) - 1) : mant;
+        ipart = shift < 32 ? mant >> shift : 0;
+        // round to nearest, with exact ties to even as in C printf
+        const uint64_t scaled = frac * pow10u[prec];
+        const uint64_t rem = scaled & ((1ULL << shift) - 1);
+        const uint64_t half = 1ULL << (shift - 1);
+        fpart = scaled >> shift;
+        if (rem > half || (rem == half && ((prec ? fpart : ipart) & 1))) {
+            fpart++;
+        }
+    }
+    if (fpart >= pow10u[prec]) {
+        // rounded up into the integer part
+        fpart = 0;
+        ipart++;
+    }
+    uint8_t n = 0;
+    for (uint8_t i=0; i<prec; i++) {
+        buf[n++] = '0' + fpart % 10;
+        fpart /= 10;
+    }
+    if (prec) {
+        buf[n++] = '.';
+    }
+    do {
+        buf[n++] = '0' + ipart % 10;
+        ipart /= 10;
+    } while (ipart);
+    return n;
+}
+#endif
+
+// write len bytes of buf in reverse order in one call
+static void write_reversed(AP_HAL::BetterStream *s, unsigned char *buf, uint8_t len)
+{
+    for (uint8_t i=0, j=len-1; i<j; i++, j--) {
+        const unsigned char t = buf[i];
+        buf[i] = buf[j];
+        buf[j] = t;
+    }
+    s->write(buf, len);
+}
+
 void print_vprintf(AP_HAL::BetterStream *s, const char *fmt, va_list ap)
 {
         unsigned char c;        /* holds a char from the format string */
@@ -76,18 +152,24 @@ void print_vprintf(AP_HAL::BetterStream *s, const char *fmt, va_list ap)
 
         for (;;) {
             /*
-             * Process non-format characters
+             * Process non-format characters, writing each run of them
+             * in one call
              */
             for (;;) {
-                c = *fmt++;
-                if (!c) {
+                const char *run = fmt;
+                while (*fmt != 0 && *fmt != '%') {
+                    fmt++;
+                }
+                if (fmt != run) {
+                    s->write((const uint8_t *)run, fmt - run);
+                }
+                if (*fmt == 0) {
                     return;
                 }
-                if (c == '%') {
-                    c = *fmt++;
-                    if (c != '%') {
-                        break;
-                    }
+                fmt++;
+                c = *fmt++;
+                if (c != '%') {
+                    break;
                 }
                 s->write(c);
             }
@@ -189,6 +271,39 @@ flt_oper:
                     flags = (flags & ~FL_FLTFIX) | FL_FLTEXP;
                 }
 
+                if (flags & FL_FLTFIX) {
+                    n = ftoa_fixed_fast(fabsf(value), prec, buf);
+                    if (n > 0) {
+                        sign = 0;
+                        if (signbit(value)) {
+                            sign = '-';
+                        } else if (flags & FL_PLUS) {
+                            sign = '+';
+                        } else if (flags & FL_SPACE) {
+                            sign = ' ';
+                        }
+                        ndigs = n + (sign ? 1 : 0);
+                        width = width > ndigs ? width - ndigs : 0;
+                        if (!(flags & (FL_LPAD | FL_ZFILL))) {
+                            while (width) {
+                                s->write(' ');
+                                width--;
+                            }
+                        }
+                        if (sign) {
+                            s->write(sign);
+                        }
+                        if (!(flags & FL_LPAD)) {
+                            while (width) {
+                                s->write('0');
+                                width--;
+                            }
+                        }
+                        write_reversed(s, buf, n);
+                        goto tail;
+                    }
+                }
+
                 if (flags & FL_FLTFIX) {
                     vtype = 7;              /* 'prec' arg for 'ftoa_engine' */
                     ndigs = prec < 60 ? prec + 1 : 60;
@@ -520,9 +635,7 @@ ultoa:
                     prec--;
                 }
 
-                do {
-                    s->write(buf[--c]);
-                } while (c);
+                write_reversed(s, buf, c);
             }
 
 tail:
@@ -0,0 +1,143 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/utility/RingBuffer.h>
+#include <AP_Math/AP_Math.h>
+
+#include <thread>
+
+TEST(ByteBufferTest, ReserveCommitWrap)
+{
+    ByteBuffer buf(16);
+
+    // one byte is always kept free to tell full from empty
+    EXPECT_EQ(buf.space(), 15U);
+    EXPECT_TRUE(buf.empty());
+
+    uint8_t data[10];
+    for (uint8_t i = 0; i < sizeof(data); i++) {
+        data[i] = i;
+    }
+    EXPECT_EQ(buf.write(data, sizeof(data)), 10U);
+    EXPECT_TRUE(buf.advance(8));
+
+    // a reservation over the end of the buffer comes back in two parts
+    ByteBuffer::IoVec vec[2];
+    ASSERT_EQ(buf.reserve(vec, 12), 2);
+    EXPECT_EQ(vec[0].len, 6U);
+    EXPECT_EQ(vec[1].len, 6U);
+    EXPECT_EQ(vec[1].data, buf.buf);
+    for (uint8_t i = 0; i < 12; i++) {
+        ByteBuffer::IoVec &v = i < 6 ? vec[0] : vec[1];
+        v.data[i < 6 ? i : i - 6] = 100 + i;
+    }
+    // nothing is visible to the reader until it is committed
+    EXPECT_EQ(buf.available(), 2U);
+    EXPECT_TRUE(buf.commit(12));
+    EXPECT_EQ(buf.available(), 14U);
+    EXPECT_EQ(buf.space(), 1U);
+    EXPECT_FALSE(buf.commit(2));
+
+    // the contiguous part runs to the end of the buffer
+    uint32_t n;
+    const uint8_t *p = buf.readptr(n);
+    ASSERT_NE(p, nullptr);
+    EXPECT_EQ(n, 8U);
+    EXPECT_EQ(p[0], 8);
+    EXPECT_EQ(p[2], 100);
+
+    uint8_t out[14];
+    EXPECT_EQ(buf.read(out, sizeof(out)), 14U);
+    for (uint8_t i = 0; i < 12; i++) {
+        EXPECT_EQ(out[2+i], 100 + i);
+    }
+    EXPECT_TRUE(buf.empty());
+}
+
+/*
+  one thread writes a counting sequence in uneven chunks while another
+  reads it, with no locking between them
+ */
+TEST(ByteBufferTest, SingleProducerSingleConsumer)
+{
+    const uint32_t total = 100000;
+    ByteBuffer buf(257);
+
+    std::thread producer([&buf, total]() {
+        uint32_t sent = 0;
+        uint8_t chunk = 1;
+        while (sent < total) {
+            ByteBuffer::IoVec vec[2];
+            const uint8_t n_vec = buf.reserve(vec, MIN(uint32_t(chunk), total - sent));
+            uint32_t len = 0;
+            for (uint8_t i = 0; i < n_vec; i++) {
+                for (uint32_t j = 0; j < vec[i].len; j++) {
+                    vec[i].data[j] = uint8_t(sent + len++);
+                }
+            }
+            if (len == 0) {
+                std::this_thread::yield();
+            }
+            buf.commit(len);
+            sent += len;
+            chunk = chunk % 61 + 1;
+        }
+    });
+
+    uint32_t received = 0;
+    uint32_t errors = 0;
+    while (received < total) {
+        uint32_t n;
+        const uint8_t *p = buf.readptr(n);
+        for (uint32_t i = 0; i < n; i++) {
+            if (p[i] != uint8_t(received + i)) {
+                errors++;
+            }
+        }
+        if (n == 0) {
+            std::this_thread::yield();
+        }
+        buf.advance(n);
+        received += n;
+    }
+    producer.join();
+
+    EXPECT_EQ(errors, 0U);
+    EXPECT_EQ(received, total);
+    EXPECT_TRUE(buf.empty());
+}
+
+TEST(ObjectBufferTest, SingleProducerSingleConsumer)
+{
+    const uint32_t total = 20000;
+    ObjectBuffer<uint32_t> buf(31);
+
+    std::thread producer([&buf, total]() {
+        for (uint32_t i = 0; i < total;) {
+            if (buf.push(i)) {
+                i++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    uint32_t errors = 0;
+    while (expected < total) {
+        uint32_t v;
+        if (buf.pop(v)) {
+            if (v != expected) {
+                errors++;
+            }
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    EXPECT_EQ(errors, 0U);
+    EXPECT_TRUE(buf.empty());
+}
+
+AP_GTEST_MAIN()
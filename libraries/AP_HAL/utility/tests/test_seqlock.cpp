@@ -0,0 +1,76 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/SeqLock.h>
+
+#include <thread>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+struct Sample {
+    uint32_t a;
+    uint32_t b[7];
+};
+
+TEST(SeqLockTest, ReadWrite)
+{
+    SeqLock<Sample> lock;
+    EXPECT_EQ(lock.count(), 0U);
+    EXPECT_EQ(lock.read().a, 0U);
+
+    Sample s {};
+    s.a = 42;
+    s.b[6] = 7;
+    lock.write(s);
+    EXPECT_EQ(lock.count(), 1U);
+    const Sample r = lock.read();
+    EXPECT_EQ(r.a, 42U);
+    EXPECT_EQ(r.b[6], 7U);
+}
+
+/*
+  readers must never see a value part way through being written, which
+  here would show as a sample with differing elements
+ */
+TEST(SeqLockTest, NoTornReads)
+{
+    SeqLock<Sample> lock;
+    const uint32_t writes = 20000;
+
+    std::thread writer([&lock, writes]() {
+        Sample s;
+        for (uint32_t i = 1; i <= writes; i++) {
+            s.a = i;
+            for (uint8_t j = 0; j < 7; j++) {
+                s.b[j] = i;
+            }
+            lock.write(s);
+            if (i % 64 == 0) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t torn = 0;
+    uint32_t last = 0;
+    uint32_t backwards = 0;
+    while (last < writes) {
+        const Sample s = lock.read();
+        for (uint8_t j = 0; j < 7; j++) {
+            if (s.b[j] != s.a) {
+                torn++;
+            }
+        }
+        if (s.a < last) {
+            backwards++;
+        }
+        last = s.a;
+    }
+    writer.join();
+
+    EXPECT_EQ(torn, 0U);
+    EXPECT_EQ(backwards, 0U);
+    EXPECT_EQ(lock.count(), writes);
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,147 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/utility/TLSF.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+TEST(TLSFTest, AllocateRelease)
+{
+    TLSFHeap *heap = TLSFHeap::create(4096);
+    ASSERT_NE(heap, nullptr);
+
+    AP_HAL::Util::HeapStats stats;
+    heap->get_stats(stats);
+    EXPECT_GE(stats.size, 4096U);
+    EXPECT_EQ(stats.used, 0U);
+    EXPECT_EQ(stats.free, stats.size);
+
+    void *a = heap->allocate(10);
+    void *b = heap->allocate(100);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    EXPECT_EQ(uintptr_t(a) % sizeof(size_t), 0U);
+    EXPECT_EQ(uintptr_t(b) % sizeof(size_t), 0U);
+    EXPECT_GE(TLSFHeap::allocation_size(a), 10U);
+    EXPECT_GE(TLSFHeap::allocation_size(b), 100U);
+
+    heap->get_stats(stats);
+    EXPECT_EQ(stats.allocs, 2U);
+    EXPECT_GE(stats.used, 110U);
+
+    heap->release(a);
+    heap->release(b);
+    heap->get_stats(stats);
+    EXPECT_EQ(stats.used, 0U);
+    // everything merged back into one block
+    EXPECT_EQ(stats.free, stats.size);
+    free(heap);
+}
+
+TEST(TLSFTest, Exhaustion)
+{
+    TLSFHeap *heap = TLSFHeap::create(1024);
+    ASSERT_NE(heap, nullptr);
+
+    EXPECT_EQ(heap->allocate(0), nullptr);
+    EXPECT_EQ(heap->allocate(4096), nullptr);
+
+    AP_HAL::Util::HeapStats stats;
+    heap->get_stats(stats);
+    EXPECT_EQ(stats.failures, 2U);
+
+    // the reported largest free block can always be allocated
+    void *p = heap->allocate(stats.largest_free);
+    EXPECT_NE(p, nullptr);
+    heap->release(p);
+    free(heap);
+}
+
+TEST(TLSFTest, ReallocateInPlace)
+{
+    TLSFHeap *heap = TLSFHeap::create(4096);
+    ASSERT_NE(heap, nullptr);
+
+    uint8_t *p = (uint8_t *)heap->allocate(64);
+    ASSERT_NE(p, nullptr);
+    memset(p, 0x5A, 64);
+
+    // the rest of the heap follows p, so growing does not move it
+    uint8_t *q = (uint8_t *)heap->reallocate(p, 1024);
+    EXPECT_EQ(q, p);
+    for (uint8_t i=0; i<64; i++) {
+        EXPECT_EQ(q[i], 0x5A);
+    }
+
+    // shrinking does not move it either
+    q = (uint8_t *)heap->reallocate(q, 16);
+    EXPECT_EQ(q, p);
+
+    EXPECT_EQ(heap->reallocate(q, 0), nullptr);
+    AP_HAL::Util::HeapStats stats;
+    heap->get_stats(stats);
+    EXPECT_EQ(stats.used, 0U);
+    EXPECT_EQ(stats.free, stats.size);
+    free(heap);
+}
+
+TEST(TLSFTest, ReallocateMoves)
+{
+    TLSFHeap *heap = TLSFHeap::create(4096);
+    ASSERT_NE(heap, nullptr);
+
+    uint8_t *p = (uint8_t *)heap->allocate(32);
+    void *blocker = heap->allocate(32);
+    ASSERT_NE(p, nullptr);
+    ASSERT_NE(blocker, nullptr);
+    for (uint8_t i=0; i<32; i++) {
+        p[i] = i;
+    }
+
+    uint8_t *q = (uint8_t *)heap->reallocate(p, 256);
+    ASSERT_NE(q, nullptr);
+    EXPECT_NE(q, p);
+    for (uint8_t i=0; i<32; i++) {
+        EXPECT_EQ(q[i], i);
+    }
+    heap->release(q);
+    heap->release(blocker);
+    free(heap);
+}
+
+TEST(TLSFTest, Churn)
+{
+    TLSFHeap *heap = TLSFHeap::create(16384);
+    ASSERT_NE(heap, nullptr);
+
+    const uint16_t n = 200;
+    uint8_t *ptrs[n] {};
+    uint16_t sizes[n] {};
+    srand(1);
+    for (uint32_t i=0; i<100000; i++) {
+        const uint16_t idx = rand() % n;
+        if (ptrs[idx] != nullptr) {
+            for (uint16_t j=0; j<sizes[idx]; j++) {
+                ASSERT_EQ(ptrs[idx][j], uint8_t(idx));
+            }
+            heap->release(ptrs[idx]);
+            ptrs[idx] = nullptr;
+        } else {
+            sizes[idx] = 1 + rand() % 200;
+            ptrs[idx] = (uint8_t *)heap->allocate(sizes[idx]);
+            if (ptrs[idx] != nullptr) {
+                memset(ptrs[idx], idx, sizes[idx]);
+            }
+        }
+    }
+    for (uint16_t i=0; i<n; i++) {
+        heap->release(ptrs[i]);
+    }
+    AP_HAL::Util::HeapStats stats;
+    heap->get_stats(stats);
+    EXPECT_EQ(stats.used, 0U);
+    EXPECT_EQ(stats.free, stats.size);
+    free(heap);
+}
+
+AP_GTEST_MAIN()
@@ -13,6 +13,7 @@ namespace ChibiOS {
     class RCOutput;
     class Scheduler;
     class Semaphore;
+    class BinarySemaphore;
     class SPIBus;
     class SPIDesc;
     class SPIDevice;
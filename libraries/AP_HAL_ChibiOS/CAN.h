@@ -67,6 +67,7 @@ public:
      */
     bool is_initialized() override;
     void initialized(bool val) override;
+    void wake_driver() override;
 
 private:
     bool initialized_;
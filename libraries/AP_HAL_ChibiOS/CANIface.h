@@ -52,6 +52,14 @@
 
 class SLCANRouter;
 
+/*
+  depth of the per-interface software TX queue. Frames wait here in
+  priority order until a hardware mailbox is free
+ */
+#ifndef HAL_CAN_TX_QUEUE_LEN
+#define HAL_CAN_TX_QUEUE_LEN 16
+#endif
+
 namespace ChibiOS_CAN {
 /**
  * Driver error codes.
@@ -144,22 +152,36 @@ class CanIface : public uavcan::ICanIface, uavcan::Noncopyable {
 
     struct TxItem {
         uavcan::MonotonicTime deadline;
+        uavcan::uint64_t enqueue_usec;
         uavcan::CanFrame frame;
         bool pending;
         bool loopback;
         bool abort_on_error;
 
         TxItem()
-            : pending(false)
+            : enqueue_usec(0)
+            , pending(false)
             , loopback(false)
             , abort_on_error(false)
         { }
     };
 
+    /*
+     * Frame waiting in the software TX queue for a free mailbox.
+     */
+    struct TxQueueItem {
+        uavcan::MonotonicTime deadline;
+        uavcan::uint64_t enqueue_usec;
+        uavcan::CanFrame frame;
+        uavcan::CanIOFlags flags;
+    };
+
     enum { NumTxMailboxes = 3 };
     enum { NumFilters = 14 };
+    enum { TxQueueCapacity = HAL_CAN_TX_QUEUE_LEN };
 
     static const uavcan::uint32_t TSR_ABRQx[NumTxMailboxes];
+    static const uavcan::uint32_t TSR_TMEx[NumTxMailboxes];
 
     RxQueue rx_queue_;
     bxcan::CanType* const can_;
@@ -171,6 +193,25 @@ class CanIface : public uavcan::ICanIface, uavcan::Noncopyable {
     const uavcan::uint8_t self_index_;
     bool had_activity_;
 
+    // sorted highest priority first, equal priorities in arrival order
+    TxQueueItem tx_queue_[TxQueueCapacity];
+    uavcan::uint8_t tx_queue_len_;
+
+public:
+    struct TxStats {
+        uavcan::uint32_t requests;          // frames accepted by send()
+        uavcan::uint32_t completed;         // frames transmitted successfully
+        uavcan::uint32_t timedout;          // frames dropped at their deadline
+        uavcan::uint32_t overflow;          // frames evicted from a full queue
+        uavcan::uint32_t aborted;           // frames aborted on bus error
+        uavcan::uint32_t latency_max_us;    // worst send() to TX complete time
+        uavcan::uint32_t latency_avg_us;    // filtered send() to TX complete time
+        uavcan::uint8_t queue_peak;         // peak software queue depth
+    };
+
+private:
+    TxStats tx_stats_;
+
     int computeTimings(uavcan::uint32_t target_bitrate, Timings& out_timings);
 
     virtual uavcan::int16_t send(const uavcan::CanFrame& frame, uavcan::MonotonicTime tx_deadline,
@@ -187,7 +228,15 @@ class CanIface : public uavcan::ICanIface, uavcan::Noncopyable {
         return NumFilters;
     }
 
-    void handleTxMailboxInterrupt(uavcan::uint8_t mailbox_index, bool txok, uavcan::uint64_t utc_usec);
+    void handleTxMailboxInterrupt(uavcan::uint8_t mailbox_index, bool txok, uavcan::uint64_t utc_usec,
+                                  uavcan::uint64_t mono_usec);
+
+    /*
+     * Drop expired queued frames and load every free mailbox from the head
+     * of the TX queue. Must be called from a critical section.
+     */
+    void refillTxMailboxes(uavcan::MonotonicTime current_time);
+    void loadTxMailbox(uavcan::uint8_t mailbox_index, const TxQueueItem& item);
 
     bool waitMsrINakBitStateChange(bool target_state);
 
@@ -209,6 +258,8 @@ public:
         , peak_tx_mailbox_index_(0)
         , self_index_(self_index)
         , had_activity_(false)
+        , tx_queue_len_(0)
+        , tx_stats_()
     {
         UAVCAN_ASSERT(self_index_ < UAVCAN_STM32_NUM_IFACES);
     }
@@ -285,6 +336,11 @@ public:
     {
         return uavcan::uint8_t(peak_tx_mailbox_index_ + 1);
     }
+
+    /**
+     * Snapshot of the TX queue statistics since initialization.
+     */
+    void getTxStats(TxStats& stats) const;
 #if AP_UAVCAN_SLCAN_ENABLED
     static SLCANRouter &slcan_router() { return _slcan_router; }
 #endif
@@ -55,4 +55,9 @@ void CANManager::initialized(bool val)
     initialized_ = val;
 }
 
+void CANManager::wake_driver()
+{
+    can_helper.driver.getUpdateEvent()->signal();
+}
+
 #endif //HAL_WITH_UAVCAN
@@ -210,6 +210,13 @@ const uavcan::uint32_t CanIface::TSR_ABRQx[CanIface::NumTxMailboxes] =
     bxcan::TSR_ABRQ2
 };
 
+const uavcan::uint32_t CanIface::TSR_TMEx[CanIface::NumTxMailboxes] =
+{
+    bxcan::TSR_TME0,
+    bxcan::TSR_TME1,
+    bxcan::TSR_TME2
+};
+
 int CanIface::computeTimings(const uavcan::uint32_t target_bitrate, Timings& out_timings)
 {
     if (target_bitrate < 1)
@@ -358,49 +365,107 @@ uavcan::int16_t CanIface::send(const uavcan::CanFrame& frame, uavcan::MonotonicT
     }
 
     /*
-     * Normally we should perform the same check as in @ref canAcceptNewTxFrame(), because
-     * it is possible that the highest-priority frame between select() and send() could have been
-     * replaced with a lower priority one due to TX timeout. But we don't do this check because:
-     *
-     *  - It is a highly unlikely scenario.
-     *
-     *  - Frames do not timeout on a properly functioning bus. Since frames do not timeout, the new
-     *    frame can only have higher priority, which doesn't break the logic.
-     *
-     *  - If high-priority frames are timing out in the TX queue, there's probably a lot of other
-     *    issues to take care of before this one becomes relevant.
-     *
-     *  - It takes CPU time. Not just CPU time, but critical section time, which is expensive.
+     * Frames go into a priority-sorted software queue rather than straight into a mailbox.
+     * With only three mailboxes a handful of bulk frames would otherwise hold back a
+     * high-priority frame until one of them had been sent.
      */
     CriticalSectionLocker lock;
 
-    /*
-     * Seeking for an empty slot
-     */
-    uavcan::uint8_t txmailbox = 0xFF;
-    if ((can_->TSR & bxcan::TSR_TME0) == bxcan::TSR_TME0)
-    {
-        txmailbox = 0;
-    }
-    else if ((can_->TSR & bxcan::TSR_TME1) == bxcan::TSR_TME1)
+    const uavcan::MonotonicTime now = clock::getMonotonic();
+
+    if (tx_queue_len_ >= TxQueueCapacity)
     {
-        txmailbox = 1;
+        // Queue is full, only make room if the new frame outranks the lowest-priority one
+        if (!frame.priorityHigherThan(tx_queue_[tx_queue_len_ - 1].frame))
+        {
+            return 0;
+        }
+        tx_queue_len_--;
+        tx_stats_.overflow++;
     }
-    else if ((can_->TSR & bxcan::TSR_TME2) == bxcan::TSR_TME2)
+
+    /*
+     * Insert behind every frame of equal or higher priority, so the frames of a
+     * multi-frame transfer, which share one CAN ID, keep their order.
+     */
+    uavcan::uint8_t pos = tx_queue_len_;
+    while (pos > 0 && frame.priorityHigherThan(tx_queue_[pos - 1].frame))
     {
-        txmailbox = 2;
+        tx_queue_[pos] = tx_queue_[pos - 1];
+        pos--;
     }
-    else
+
+    TxQueueItem& item = tx_queue_[pos];
+    item.deadline     = tx_deadline;
+    item.enqueue_usec = now.toUSec();
+    item.frame        = frame;
+    item.flags        = flags;
+    tx_queue_len_++;
+
+    tx_stats_.requests++;
+    tx_stats_.queue_peak = uavcan::max(tx_stats_.queue_peak, tx_queue_len_);
+
+    refillTxMailboxes(now);
+    return 1;
+}
+
+void CanIface::refillTxMailboxes(uavcan::MonotonicTime current_time)
+{
+    /*
+     * Single pass over the queue: expired frames are dropped, and each remaining
+     * frame is loaded into a free mailbox unless a frame with the same ID is
+     * already in one. The hardware picks among mailboxes by ID and falls back to
+     * the mailbox number for equal IDs, which would reorder a multi-frame transfer.
+     */
+    uavcan::uint8_t out = 0;
+    for (uavcan::uint8_t i = 0; i < tx_queue_len_; i++)
     {
-        return 0;       // No transmission for you.
+        const TxQueueItem& item = tx_queue_[i];
+        if (item.deadline < current_time)
+        {
+            tx_stats_.timedout++;
+            continue;
+        }
+
+        uavcan::uint8_t free_mbx = NumTxMailboxes;
+        bool id_pending = false;
+        for (uavcan::uint8_t mbx = 0; mbx < NumTxMailboxes; mbx++)
+        {
+            if (pending_tx_[mbx].pending)
+            {
+                id_pending = id_pending || (pending_tx_[mbx].frame.id == item.frame.id);
+            }
+            else if (free_mbx == NumTxMailboxes && (can_->TSR & TSR_TMEx[mbx]))
+            {
+                free_mbx = mbx;
+            }
+        }
+
+        if (free_mbx < NumTxMailboxes && !id_pending)
+        {
+            loadTxMailbox(free_mbx, item);
+            continue;
+        }
+
+        if (out != i)
+        {
+            tx_queue_[out] = item;
+        }
+        out++;
     }
+    tx_queue_len_ = out;
+}
+
+void CanIface::loadTxMailbox(uavcan::uint8_t mailbox_index, const TxQueueItem& item)
+{
+    const uavcan::CanFrame& frame = item.frame;
 
-    peak_tx_mailbox_index_ = uavcan::max(peak_tx_mailbox_index_, txmailbox);    // Statistics
+    peak_tx_mailbox_index_ = uavcan::max(peak_tx_mailbox_index_, mailbox_index);    // Statistics
 
     /*
      * Setting up the mailbox
      */
-    bxcan::TxMailboxType& mb = can_->TxMailbox[txmailbox];
+    bxcan::TxMailboxType& mb = can_->TxMailbox[mailbox_index];
     if (frame.isExtended())
     {
         mb.TIR = ((frame.id & uavcan::CanFrame::MaskExtID) << 3) | bxcan::TIR_IDE;
@@ -431,13 +496,13 @@ uavcan::int16_t CanIface::send(const uavcan::CanFrame& frame, uavcan::MonotonicT
     /*
      * Registering the pending transmission so we can track its deadline and loopback it as needed
      */
-    TxItem& txi = pending_tx_[txmailbox];
-    txi.deadline       = tx_deadline;
+    TxItem& txi = pending_tx_[mailbox_index];
+    txi.deadline       = item.deadline;
+    txi.enqueue_usec   = item.enqueue_usec;
     txi.frame          = frame;
-    txi.loopback       = (flags & uavcan::CanIOFlagLoopback) != 0;
-    txi.abort_on_error = (flags & uavcan::CanIOFlagAbortOnError) != 0;
+    txi.loopback       = (item.flags & uavcan::CanIOFlagLoopback) != 0;
+    txi.abort_on_error = (item.flags & uavcan::CanIOFlagAbortOnError) != 0;
     txi.pending        = true;
-    return 1;
 }
 
 uavcan::int16_t CanIface::receive(uavcan::CanFrame& out_frame, uavcan::MonotonicTime& out_ts_monotonic,
@@ -588,6 +653,8 @@ int CanIface::init(const uavcan::uint32_t bitrate, const OperatingMode mode)
     served_aborts_cnt_ = 0;
     uavcan::fill_n(pending_tx_, NumTxMailboxes, TxItem());
     peak_tx_mailbox_index_ = 0;
+    tx_queue_len_ = 0;
+    tx_stats_ = TxStats();
     had_activity_ = false;
 
     /*
@@ -660,7 +727,8 @@ int CanIface::init(const uavcan::uint32_t bitrate, const OperatingMode mode)
     return 0;
 }
 
-void CanIface::handleTxMailboxInterrupt(uavcan::uint8_t mailbox_index, bool txok, const uavcan::uint64_t utc_usec)
+void CanIface::handleTxMailboxInterrupt(uavcan::uint8_t mailbox_index, bool txok, const uavcan::uint64_t utc_usec,
+                                        const uavcan::uint64_t mono_usec)
 {
     UAVCAN_ASSERT(mailbox_index < NumTxMailboxes);
 
@@ -668,9 +736,19 @@ void CanIface::handleTxMailboxInterrupt(uavcan::uint8_t mailbox_index, bool txok
 
     TxItem& txi = pending_tx_[mailbox_index];
 
-    if (txi.loopback && txok && txi.pending)
+    if (txok && txi.pending)
     {
-        rx_queue_.push(txi.frame, utc_usec, uavcan::CanIOFlagLoopback);
+        if (txi.loopback)
+        {
+            rx_queue_.push(txi.frame, utc_usec, uavcan::CanIOFlagLoopback);
+        }
+
+        const uavcan::uint32_t latency_us = uavcan::uint32_t(mono_usec - txi.enqueue_usec);
+        tx_stats_.completed++;
+        tx_stats_.latency_max_us = uavcan::max(tx_stats_.latency_max_us, latency_us);
+        // 1/16 low pass keeps the average cheap enough for the ISR
+        tx_stats_.latency_avg_us = uavcan::uint32_t(int32_t(tx_stats_.latency_avg_us) +
+                                                    (int32_t(latency_us) - int32_t(tx_stats_.latency_avg_us)) / 16);
     }
 
     txi.pending = false;
@@ -678,25 +756,32 @@ void CanIface::handleTxMailboxInterrupt(uavcan::uint8_t mailbox_index, bool txok
 
 void CanIface::handleTxInterrupt(const uavcan::uint64_t utc_usec)
 {
+    const uavcan::MonotonicTime now = clock::getMonotonic();
+    const uavcan::uint64_t mono_usec = now.toUSec();
+
     // TXOK == false means that there was a hardware failure
     if (can_->TSR & bxcan::TSR_RQCP0)
     {
         const bool txok = can_->TSR & bxcan::TSR_TXOK0;
         can_->TSR = bxcan::TSR_RQCP0;
-        handleTxMailboxInterrupt(0, txok, utc_usec);
+        handleTxMailboxInterrupt(0, txok, utc_usec, mono_usec);
     }
     if (can_->TSR & bxcan::TSR_RQCP1)
     {
         const bool txok = can_->TSR & bxcan::TSR_TXOK1;
         can_->TSR = bxcan::TSR_RQCP1;
-        handleTxMailboxInterrupt(1, txok, utc_usec);
+        handleTxMailboxInterrupt(1, txok, utc_usec, mono_usec);
     }
     if (can_->TSR & bxcan::TSR_RQCP2)
     {
         const bool txok = can_->TSR & bxcan::TSR_TXOK2;
         can_->TSR = bxcan::TSR_RQCP2;
-        handleTxMailboxInterrupt(2, txok, utc_usec);
+        handleTxMailboxInterrupt(2, txok, utc_usec, mono_usec);
     }
+
+    // Batch refill of every mailbox freed above
+    refillTxMailboxes(now);
+
     update_event_.signalFromInterrupt();
 
     pollErrorFlagsFromISR();
@@ -802,46 +887,29 @@ void CanIface::discardTimedOutTxMailboxes(uavcan::MonotonicTime current_time)
             can_->TSR = TSR_ABRQx[i];  // Goodnight sweet transmission
             txi.pending = false;
             error_cnt_++;
+            tx_stats_.timedout++;
         }
     }
+
+    // Expire queued frames too; aborted mailboxes are refilled from the TX interrupt
+    refillTxMailboxes(current_time);
 }
 
 bool CanIface::canAcceptNewTxFrame(const uavcan::CanFrame& frame) const
 {
     /*
-     * We can accept more frames only if the following conditions are satisfied:
-     *  - There is at least one TX mailbox free (obvious enough);
-     *  - The priority of the new frame is higher than priority of all TX mailboxes.
-     */
-    {
-        static const uavcan::uint32_t TME = bxcan::TSR_TME0 | bxcan::TSR_TME1 | bxcan::TSR_TME2;
-        const uavcan::uint32_t tme = can_->TSR & TME;
-
-        if (tme == TME)     // All TX mailboxes are free (as in freedom).
-        {
-            return true;
-        }
-
-        if (tme == 0)       // All TX mailboxes are busy transmitting.
-        {
-            return false;
-        }
-    }
-
-    /*
-     * The second condition requires a critical section.
+     * The software queue sorts frames by priority itself, so a new frame can be
+     * accepted while there is space, or when it would displace the lowest-priority
+     * queued frame in the next @ref send().
      */
     CriticalSectionLocker lock;
 
-    for (int mbx = 0; mbx < NumTxMailboxes; mbx++)
+    if (tx_queue_len_ < TxQueueCapacity)
     {
-        if (pending_tx_[mbx].pending && !frame.priorityHigherThan(pending_tx_[mbx].frame))
-        {
-            return false;       // There's a mailbox whose priority is higher or equal the priority of the new frame.
-        }
+        return true;
     }
 
-    return true;                // This new frame will be added to a free TX mailbox in the next @ref send().
+    return frame.priorityHigherThan(tx_queue_[tx_queue_len_ - 1].frame);
 }
 
 bool CanIface::isRxBufferEmpty() const
@@ -862,6 +930,13 @@ unsigned CanIface::getRxQueueLength() const
     return rx_queue_.getLength();
 }
 
+void CanIface::getTxStats(TxStats& stats) const
+{
+    CriticalSectionLocker lock;
+    stats = tx_stats_;
+    stats.aborted = served_aborts_cnt_;
+}
+
 bool CanIface::hadActivity()
 {
     CriticalSectionLocker lock;
@@ -15,6 +15,7 @@
 #include "Device.h"
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
 #include <AP_HAL/utility/OwnPtr.h>
 #include <stdio.h>
 
@@ -29,6 +30,20 @@
 #define HAL_DEVICE_THREAD_STACK 1024
 #endif
 
+// callbacks due within this many microseconds of a wakeup are run in
+// that wakeup. The bus thread never sleeps for less than this, so they
+// would otherwise be run late by a separate wakeup
+#ifndef HAL_DEVICE_COALESCE_USEC
+#define HAL_DEVICE_COALESCE_USEC 100
+#endif
+
+// period over which bus utilization is measured
+#define DEVICE_BUS_STATS_MS 5000
+
+#ifndef HAL_DEVICE_BUS_DEBUG
+#define HAL_DEVICE_BUS_DEBUG 0
+#endif
+
 using namespace ChibiOS;
 
 extern const AP_HAL::HAL& hal;
@@ -51,22 +66,49 @@ void DeviceBus::bus_thread(void *arg)
         uint64_t now = AP_HAL::micros64();
         DeviceBus::callback_info *callback;
 
-        // find a callback to run
+        // run all the callbacks that are due, or will be before we
+        // could wake up again, as one group under a single semaphore
+        // take
+        const uint64_t due = now + HAL_DEVICE_COALESCE_USEC;
         for (callback = binfo->callbacks; callback; callback = callback->next) {
-            if (now >= callback->next_usec) {
-                while (now >= callback->next_usec) {
-                    callback->next_usec += callback->period_usec;
+            if (due >= callback->next_usec) {
+                break;
+            }
+        }
+        if (callback != nullptr) {
+            WITH_SEMAPHORE(binfo->semaphore);
+            for (; callback; callback = callback->next) {
+                if (due >= callback->next_usec) {
+                    while (due >= callback->next_usec) {
+                        callback->next_usec += callback->period_usec;
+                    }
+                    callback->cb();
                 }
-                // call it with semaphore held
-                WITH_SEMAPHORE(binfo->semaphore);
-                callback->cb();
             }
         }
 
         // work out when next loop is needed
         uint64_t next_needed = 0;
+        const uint64_t busy_start = now;
         now = AP_HAL::micros64();
 
+        binfo->stats.busy_us += now - busy_start;
+        binfo->stats.wakeups++;
+        const uint32_t now_ms = AP_HAL::millis();
+        const uint32_t stats_dt_ms = now_ms - binfo->stats.start_ms;
+        if (stats_dt_ms >= DEVICE_BUS_STATS_MS) {
+            binfo->busy_pct = binfo->stats.busy_us * 0.1f / stats_dt_ms;
+            binfo->wakeup_rate_hz = binfo->stats.wakeups * 1000.0f / stats_dt_ms;
+#if HAL_DEVICE_BUS_DEBUG
+            hal.console->printf("%s: %.1f%% busy %.0f wakeups/s\n",
+                                binfo->thread_ctx->name,
+                                (double)binfo->busy_pct, (double)binfo->wakeup_rate_hz);
+#endif
+            binfo->stats.busy_us = 0;
+            binfo->stats.wakeups = 0;
+            binfo->stats.start_ms = now_ms;
+        }
+
         for (callback = binfo->callbacks; callback; callback = callback->next) {
             if (next_needed == 0 ||
                 callback->next_usec < next_needed) {
@@ -131,7 +173,7 @@ AP_HAL::Device::PeriodicHandle DeviceBus::register_periodic_callback(uint32_t pe
     }
     callback->cb = cb;
     callback->period_usec = period_usec;
-    callback->next_usec = AP_HAL::micros64() + period_usec;
+    callback->next_usec = coalesced_start_usec(period_usec);
 
     // add to linked list of callbacks on thread
     callback->next = callbacks;
@@ -141,6 +183,43 @@ AP_HAL::Device::PeriodicHandle DeviceBus::register_periodic_callback(uint32_t pe
 }
 #endif // CH_CFG_USE_HEAP
 
+/*
+  choose the first call time for a new callback, at least one period
+  from now. If another callback on the bus has a period that is a
+  multiple or a divisor of this one then start in phase with it, so
+  the two are run in the same wakeups from then on
+ */
+uint64_t DeviceBus::coalesced_start_usec(uint32_t period_usec) const
+{
+    const uint64_t start_usec = AP_HAL::micros64() + period_usec;
+    if (period_usec == 0) {
+        return start_usec;
+    }
+    for (const callback_info *callback = callbacks; callback; callback = callback->next) {
+        const uint32_t other_usec = callback->period_usec;
+        if (other_usec == 0 ||
+            (other_usec % period_usec != 0 && period_usec % other_usec != 0)) {
+            continue;
+        }
+        const uint32_t common_usec = MIN(period_usec, other_usec);
+        int64_t phase_usec = ((int64_t)callback->next_usec - (int64_t)start_usec) % common_usec;
+        if (phase_usec < 0) {
+            phase_usec += common_usec;
+        }
+        return start_usec + phase_usec;
+    }
+    return start_usec;
+}
+
+/*
+  return the bus utilization measured over the last DEVICE_BUS_STATS_MS
+ */
+void DeviceBus::get_utilization(float &_busy_pct, float &_wakeup_rate_hz) const
+{
+    _busy_pct = busy_pct;
+    _wakeup_rate_hz = wakeup_rate_hz;
+}
+
 /*
  * Adjust the timer for the next call: it needs to be called from the bus
  * thread, otherwise it will race with it
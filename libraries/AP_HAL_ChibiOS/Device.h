@@ -43,6 +43,10 @@ public:
                             uint8_t *&buf_rx, uint16_t rx_len) WARN_IF_UNUSED;
     void bouncebuffer_finish(const uint8_t *buf_tx, uint8_t *buf_rx, uint16_t rx_len);
 
+    // get the percentage of time the bus thread spent in callbacks and
+    // its wakeup rate, measured over the last few seconds
+    void get_utilization(float &busy_pct, float &wakeup_rate_hz) const;
+
 private:
     struct callback_info {
         struct callback_info *next;
@@ -52,6 +56,19 @@ private:
     } *callbacks;
     uint8_t thread_priority;
     thread_t* thread_ctx;
+
+    // choose the first call time of a new callback
+    uint64_t coalesced_start_usec(uint32_t period_usec) const;
+
+    // utilization accounting, see get_utilization()
+    struct {
+        uint32_t busy_us;
+        uint32_t wakeups;
+        uint32_t start_ms;
+    } stats;
+    float busy_pct;
+    float wakeup_rate_hz;
+
     bool thread_started;
     AP_HAL::Device *hal_device;
 
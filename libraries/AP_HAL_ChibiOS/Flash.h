@@ -18,6 +18,23 @@ public:
     void keep_unlocked(bool set) override { stm32_flash_keep_unlocked(set); }
     bool ispageerased(uint32_t page) override { return stm32_flash_ispageerased(page); }
 
+    // return true if a page is in a different flash bank from the
+    // firmware, so erasing it doesn't stall the CPU
+    bool background_erase_ok(uint32_t page) { return stm32_flash_background_erase_ok(page); }
+
+    // erase a page, sleeping instead of spinning while the erase
+    // runs. Should only be used when background_erase_ok() is true
+    bool erasepage_background(uint32_t page) {
+        WITH_SEMAPHORE(sem);
+        if (!stm32_flash_erasepage_start(page)) {
+            return false;
+        }
+        while (stm32_flash_erase_busy()) {
+            chThdSleepMilliseconds(1);
+        }
+        return stm32_flash_erasepage_finish(page);
+    }
+
 private:
     HAL_Semaphore sem;
 };
@@ -341,6 +341,25 @@ void RCOutput::write(uint8_t chan, uint16_t period_us)
     }
 }
 
+/*
+  write a set of channels, pushing them out together
+ */
+void RCOutput::write_channels(uint32_t chmask, const uint16_t *period_us)
+{
+    const bool was_corked = corked;
+    if (!was_corked) {
+        cork();
+    }
+    for (uint8_t i = 0; chmask != 0; i++, chmask >>= 1) {
+        if (chmask & 1U) {
+            write(i, period_us[i]);
+        }
+    }
+    if (!was_corked) {
+        push();
+    }
+}
+
 /*
   push values to local channels from period[] array
  */
@@ -504,10 +523,10 @@ bool RCOutput::setup_group_DMA(pwm_group &group, uint32_t bitrate, uint32_t bit_
 #ifndef DISABLE_DSHOT
     if (!group.dma_buffer || buffer_length != group.dma_buffer_len) {
         if (group.dma_buffer) {
-            hal.util->free_type(group.dma_buffer, group.dma_buffer_len, AP_HAL::Util::MEM_DMA_SAFE);
+            hal.util->free_type(group.dma_buffer, group.dma_buffer_len, AP_HAL::Util::MEM_DMA_SAFE, "RCOut");
             group.dma_buffer_len = 0;
         }
-        group.dma_buffer = (uint32_t *)hal.util->malloc_type(buffer_length, AP_HAL::Util::MEM_DMA_SAFE);
+        group.dma_buffer = (uint32_t *)hal.util->malloc_type(buffer_length, AP_HAL::Util::MEM_DMA_SAFE, "RCOut");
         if (!group.dma_buffer) {
             return false;
         }
@@ -632,6 +651,9 @@ void RCOutput::set_group_mode(pwm_group &group)
         const uint32_t rate = protocol_bitrate(group.current_mode);
         const uint32_t bit_period = 20;
 
+        // the buffer may be new, so encode all the LEDs on the next send
+        group.prepared_send = false;
+
         // configure timer driver for DMAR at requested rate
         const uint8_t pad_end_bits = 8;
         const uint8_t pad_start_bits = 1;
@@ -652,8 +674,10 @@ void RCOutput::set_group_mode(pwm_group &group)
         const uint32_t rate = protocol_bitrate(group.current_mode);
         const uint32_t bit_period = 20;
 
-        // configure timer driver for DMAR at requested rate
-        if (!setup_group_DMA(group, rate, bit_period, true, dshot_buffer_length, false)) {
+        // configure timer driver for DMAR at requested rate. The line
+        // idles high for bidirectional DShot
+        const bool bidir = bdshot_setup_group(group);
+        if (!setup_group_DMA(group, rate, bit_period, !bidir, dshot_buffer_length, false)) {
             group.current_mode = MODE_PWM_NORMAL;
             break;
         }
@@ -819,6 +843,7 @@ void RCOutput::cork(void)
 void RCOutput::push(void)
 {
     corked = false;
+    push_dma_pending = true;
     push_local();
 #if HAL_WITH_IO_MCU
     if (AP_BoardConfig::io_enabled()) {
@@ -872,10 +897,21 @@ void RCOutput::trigger_groups(void)
     osalSysUnlock();
 
     if (!serial_group) {
+        /*
+          fill in the DMA buffers of all the DShot groups first, then
+          start their bursts back to back, so the outputs on
+          different timers go out with as little skew as possible
+         */
+        uint8_t prepared_mask = 0;
         for (uint8_t i = 0; i < NUM_GROUPS; i++) {
             pwm_group &group = pwm_group_list[i];
-            if (is_dshot_protocol(group.current_mode)) {
-                dshot_send(group, false);
+            if (is_dshot_protocol(group.current_mode) && dshot_prepare(group, false)) {
+                prepared_mask |= (1U<<i);
+            }
+        }
+        for (uint8_t i = 0; i < NUM_GROUPS; i++) {
+            if (prepared_mask & (1U<<i)) {
+                dshot_start(pwm_group_list[i]);
             }
         }
     }
@@ -910,18 +946,6 @@ void RCOutput::timer_tick(void)
             dshot_send(group, true);
         }
     }
-    if (serial_led_pending && chMtxTryLock(&trigger_mutex)) {
-        serial_led_pending = false;
-        for (uint8_t j = 0; j < NUM_GROUPS; j++) {
-            pwm_group &group = pwm_group_list[j];
-            if (group.serial_led_pending && (group.current_mode == MODE_NEOPIXEL || group.current_mode == MODE_PROFILED)) {
-                group.serial_led_pending = !serial_led_send(group);
-                group.prepared_send = group.serial_led_pending;
-                serial_led_pending |=  group.serial_led_pending;
-            }
-        }
-        chMtxUnlock(&trigger_mutex);
-    }
     if (min_pulse_trigger_us == 0 ||
         serial_group != nullptr) {
         return;
@@ -972,7 +996,7 @@ void RCOutput::dma_deallocate(Shared_DMA *ctx)
 /*
   create a DSHOT 16 bit packet. Based on prepareDshotPacket from betaflight
  */
-uint16_t RCOutput::create_dshot_packet(const uint16_t value, bool telem_request)
+uint16_t RCOutput::create_dshot_packet(const uint16_t value, bool telem_request, bool bidir)
 {
     uint16_t packet = (value << 1);
 
@@ -987,6 +1011,10 @@ uint16_t RCOutput::create_dshot_packet(const uint16_t value, bool telem_request)
         csum ^= csum_data;
         csum_data >>= 4;
     }
+    if (bidir) {
+        // bidirectional DShot ESCs expect an inverted checksum
+        csum = ~csum;
+    }
     csum &= 0xf;
     // append checksum
     packet = (packet << 4) | csum;
@@ -1020,23 +1048,40 @@ void RCOutput::fill_DMA_buffer_dshot(uint32_t *buffer, uint8_t stride, uint16_t
   In normal operation it doesn't wait for the DMA lock.
  */
 void RCOutput::dshot_send(pwm_group &group, bool blocking)
+{
+    if (dshot_prepare(group, blocking)) {
+        dshot_start(group);
+    }
+}
+
+/*
+  take the DMA lock for a DShot group and fill in its DMA buffer,
+  returning true if the group is ready for dshot_start()
+ */
+bool RCOutput::dshot_prepare(pwm_group &group, bool blocking)
 {
 #ifndef DISABLE_DSHOT
     if (irq.waiter) {
         // doing serial output, don't send DShot pulses
-        return;
+        return false;
     }
 
     if (blocking) {
         group.dma_handle->lock();
     } else {
         if (!group.dma_handle->lock_nonblock()) {
-            return;
+            return false;
         }
     }
 
     bool safety_on = hal.util->safety_switch_state() == AP_HAL::Util::SAFETY_DISARMED;
 
+    if (group.bdshot.mask != 0) {
+        // the last frame's reply has been captured, as we hold the lock
+        bdshot_decode(group);
+        bdshot_prepare(group);
+    }
+
     memset((uint8_t *)group.dma_buffer, 0, dshot_buffer_length);
 
     for (uint8_t i=0; i<4; i++) {
@@ -1075,17 +1120,33 @@ void RCOutput::dshot_send(pwm_group &group, bool blocking)
             }
 
             bool request_telemetry = (telem_request_mask & chan_mask)?true:false;
-            uint16_t packet = create_dshot_packet(value, request_telemetry);
+            uint16_t packet = create_dshot_packet(value, request_telemetry, (group.bdshot.mask & (1U<<i)) != 0);
             if (request_telemetry) {
                 telem_request_mask &= ~chan_mask;
             }
             fill_DMA_buffer_dshot(group.dma_buffer + i, 4, packet, group.bit_width_mul);
         }
     }
+    return true;
+#else
+    return false;
+#endif //#ifndef DISABLE_DSHOT
+}
 
+/*
+  start the DMA burst for a group prepared by dshot_prepare()
+ */
+void RCOutput::dshot_start(pwm_group &group)
+{
+#ifndef DISABLE_DSHOT
     // start sending the pulses out
     send_pulses_DMAR(group, dshot_buffer_length);
 
+    if (push_dma_pending) {
+        push_dma_pending = false;
+        push_dma_start_us = AP_HAL::micros();
+    }
+
     group.last_dmar_send_us = AP_HAL::micros64();
 #endif //#ifndef DISABLE_DSHOT
 }
@@ -1099,7 +1160,16 @@ bool RCOutput::serial_led_send(pwm_group &group)
 {
 #ifndef DISABLE_DSHOT
     if (irq.waiter || !group.dma_handle->lock_nonblock()) {
-        // doing serial output, don't send Serial LED pulses
+        // doing serial output or the last frame is still going
+        // out, don't send Serial LED pulses
+        return false;
+    }
+
+    // the buffer can't be going out while we hold the lock
+    serial_led_encode(group);
+
+    if (!chMtxTryLock(&trigger_mutex)) {
+        group.dma_handle->unlock();
         return false;
     }
 
@@ -1107,10 +1177,36 @@ bool RCOutput::serial_led_send(pwm_group &group)
     send_pulses_DMAR(group, group.dma_buffer_len);
 
     group.last_dmar_send_us = AP_HAL::micros64();
+    chMtxUnlock(&trigger_mutex);
 #endif //#ifndef DISABLE_DSHOT
     return true;
 }
 
+/*
+  send serial LED data for the groups that have a send pending. This
+  runs in the IO thread, so the callers setting colours never wait for
+  the bits to be encoded or for the last frame to finish going out
+ */
+void RCOutput::serial_led_update(void)
+{
+    if (!serial_led_pending) {
+        return;
+    }
+    serial_led_pending = false;
+    for (uint8_t i = 0; i < NUM_GROUPS; i++) {
+        pwm_group &group = pwm_group_list[i];
+        if (!group.serial_led_pending ||
+            (group.current_mode != MODE_NEOPIXEL && group.current_mode != MODE_PROFILED)) {
+            continue;
+        }
+        group.serial_led_pending = false;
+        if (!serial_led_send(group)) {
+            group.serial_led_pending = true;
+            serial_led_pending = true;
+        }
+    }
+}
+
 
 /*
   send a series of pulses for a group using DMAR. Pulses must have
@@ -1175,6 +1271,9 @@ void RCOutput::dma_irq_callback(void *p, uint32_t flags)
     if (group->in_serial_dma && irq.waiter) {
         // tell the waiting process we've done the DMA
         chEvtSignalI(irq.waiter, serial_event_mask);
+    } else if (group->bdshot.ic_locked) {
+        // listen for the eRPM reply before the next frame
+        bdshot_start_capture_I(*group);
     } else {
         // this prevents us ever having two dshot pulses too close together
         chVTSetI(&group->dma_timeout, chTimeUS2I(dshot_min_gap_us), dma_unlock, p);
@@ -1718,11 +1817,124 @@ bool RCOutput::set_serial_led_num_LEDs(const uint16_t chan, uint8_t num_leds, ou
         }
     }
 
+    if (!serial_led_alloc(*grp, grp->serial_nleds)) {
+        return false;
+    }
+    grp->serial_led_mask |= 1U<<i;
+
+    if (!serial_led_registered) {
+        serial_led_registered = true;
+        hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&RCOutput::serial_led_update, void));
+    }
+
     set_output_mode(1U<<chan, mode);
 
     return grp->current_mode == mode;
 }
 
+/*
+  make room for the colours of num_leds LEDs on each channel of a group
+*/
+bool RCOutput::serial_led_alloc(pwm_group &group, uint8_t num_leds)
+{
+    if (group.serial_led_rgb != nullptr && num_leds <= group.serial_led_rgb_nleds) {
+        return true;
+    }
+    const uint16_t bytes_per_led = 4 * 3;
+    uint8_t *rgb = (uint8_t *)hal.util->malloc_type(num_leds * bytes_per_led, AP_HAL::Util::MEM_FAST, "RCOut");
+    if (rgb == nullptr) {
+        return false;
+    }
+    if (group.serial_led_rgb != nullptr) {
+        memcpy(rgb, group.serial_led_rgb, group.serial_led_rgb_nleds * bytes_per_led);
+        hal.util->free_type(group.serial_led_rgb, group.serial_led_rgb_nleds * bytes_per_led, AP_HAL::Util::MEM_FAST, "RCOut");
+    } else {
+        group.serial_led_dirty_start = UINT8_MAX;
+        group.serial_led_dirty_end = 0;
+    }
+    group.serial_led_rgb = rgb;
+    group.serial_led_rgb_nleds = num_leds;
+    return true;
+}
+
+/*
+  set the colour of LEDs first to last on a channel of a group,
+  marking the LEDs that change to be encoded on the next send
+*/
+void RCOutput::serial_led_set_colours(pwm_group &group, uint8_t idx, uint8_t first, uint8_t last, uint8_t red, uint8_t green, uint8_t blue)
+{
+    uint8_t dirty_start = UINT8_MAX;
+    uint8_t dirty_end = 0;
+    for (uint16_t led = first; led <= last; led++) {
+        uint8_t *rgb = &group.serial_led_rgb[(led * 4 + idx) * 3];
+        if (rgb[0] == red && rgb[1] == green && rgb[2] == blue) {
+            continue;
+        }
+        rgb[0] = red;
+        rgb[1] = green;
+        rgb[2] = blue;
+        dirty_start = MIN(dirty_start, uint8_t(led));
+        dirty_end = uint8_t(led + 1);
+    }
+    if (dirty_end == 0) {
+        return;
+    }
+    chSysLock();
+    group.serial_led_dirty_start = MIN(group.serial_led_dirty_start, dirty_start);
+    group.serial_led_dirty_end = MAX(group.serial_led_dirty_end, dirty_end);
+    chSysUnlock();
+}
+
+/*
+  encode the LEDs changed since the last send into the DMA buffer of a
+  group, or all of them if the buffer has not been filled. The DMA lock
+  must be held so the buffer is not going out
+*/
+void RCOutput::serial_led_encode(pwm_group &group)
+{
+    chSysLock();
+    uint8_t start = group.serial_led_dirty_start;
+    uint8_t end = group.serial_led_dirty_end;
+    group.serial_led_dirty_start = UINT8_MAX;
+    group.serial_led_dirty_end = 0;
+    chSysUnlock();
+
+    if (!group.prepared_send) {
+        group.prepared_send = true;
+        start = 0;
+        end = group.serial_nleds;
+    }
+    end = MIN(end, group.serial_led_rgb_nleds);
+
+    for (uint16_t led = start; led < end; led++) {
+        for (uint8_t idx = 0; idx < 4; idx++) {
+            const uint8_t *rgb = &group.serial_led_rgb[(led * 4 + idx) * 3];
+            switch (group.current_mode) {
+            case MODE_NEOPIXEL:
+                if ((group.serial_led_mask & (1U<<idx)) != 0) {
+                    _set_neopixel_rgb_data(&group, idx, uint8_t(led), rgb[0], rgb[1], rgb[2]);
+                }
+                break;
+
+            case MODE_PROFILED:
+                if ((group.clock_mask & (1U<<idx)) != 0) {
+                    _set_profiled_clock(&group, idx, uint8_t(led));
+                } else if ((group.serial_led_mask & (1U<<idx)) == 0) {
+                    // no LEDs on this channel
+                } else if (led < group.serial_nleds - 2) {
+                    _set_profiled_rgb_data(&group, idx, uint8_t(led), rgb[0], rgb[1], rgb[2]);
+                } else {
+                    _set_profiled_blank_frame(&group, idx, uint8_t(led));
+                }
+                break;
+
+            default:
+                return;
+            }
+        }
+    }
+}
+
 /*
   setup neopixel (WS2812B) output data for a given output channel
   and a LED number. LED -1 is all LEDs
@@ -1804,46 +2016,17 @@ void RCOutput::set_serial_led_rgb_data(const uint16_t chan, int8_t led, uint8_t
         return;
     }
 
-    if (led >= grp->serial_nleds || (grp->current_mode != MODE_NEOPIXEL && grp->current_mode != MODE_PROFILED)) {
+    if (led >= grp->serial_nleds || grp->serial_nleds == 0 || grp->serial_led_rgb == nullptr ||
+        (grp->current_mode != MODE_NEOPIXEL && grp->current_mode != MODE_PROFILED)) {
         return;
     }
 
+    // only the colours are stored here, the bits are encoded by the IO
+    // thread when they are sent
     if (led == -1) {
-        grp->prepared_send = true;
-        for (uint8_t n=0; n<grp->serial_nleds; n++) {
-            set_serial_led_rgb_data(chan, n, red, green, blue);
-        }
-        return;
-    } else if (!grp->prepared_send) {
-        // if not ouput clock and trailing frames, run through all LED's to do it now
-        set_serial_led_rgb_data(chan, -1, 0, 0, 0);
-    }
-
-    switch (grp->current_mode) {
-        case MODE_NEOPIXEL: {
-            _set_neopixel_rgb_data(grp, i, uint8_t(led), red, green, blue);
-            break;
-        }
-
-        case MODE_PROFILED: {
-            if (led < grp->serial_nleds - 2) {
-                _set_profiled_rgb_data(grp, i, uint8_t(led), red, green, blue);
-            } else {
-                _set_profiled_blank_frame(grp, i, uint8_t(led));
-            }
-
-            for (uint8_t j = 0; j < 4; j++) {
-                if ((grp->clock_mask & 1U<<j) != 0) {
-                   _set_profiled_clock(grp, j, uint8_t(led));
-                }
-            }
-
-            break;
-        }
-
-        default: {
-            return;
-        }
+        serial_led_set_colours(*grp, i, 0, grp->serial_nleds - 1, red, green, blue);
+    } else {
+        serial_led_set_colours(*grp, i, uint8_t(led), uint8_t(led), red, green, blue);
     }
 }
 
@@ -1860,8 +2043,11 @@ void RCOutput::serial_led_send(const uint16_t chan)
     if (grp->current_mode != MODE_NEOPIXEL && grp->current_mode != MODE_PROFILED) {
         return;
     }
-    if (grp->prepared_send) {
-        serial_led_pending = true; 
+    // strings that have not changed are only sent now and then, in
+    // case LEDs have been reconnected
+    const bool changed = grp->serial_led_dirty_end > grp->serial_led_dirty_start;
+    if (changed || (grp->prepared_send && AP_HAL::micros64() - grp->last_dmar_send_us > 1000000U)) {
+        serial_led_pending = true;
         grp->serial_led_pending = true;
     }
 }
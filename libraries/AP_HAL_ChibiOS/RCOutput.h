@@ -35,6 +35,7 @@ public:
     void     enable_ch(uint8_t ch) override;
     void     disable_ch(uint8_t ch) override;
     void     write(uint8_t ch, uint16_t period_us) override;
+    void     write_channels(uint32_t chmask, const uint16_t *period_us) override;
     uint16_t read(uint8_t ch) override;
     void     read(uint16_t* period_us, uint8_t len) override;
     uint16_t read_last_sent(uint8_t ch) override;
@@ -58,6 +59,13 @@ public:
     void     cork(void) override;
     void     push(void) override;
 
+    /*
+      bidirectional DShot eRPM
+     */
+    void set_bidir_dshot_mask(uint16_t mask) override;
+    uint32_t get_erpm(uint8_t chan) const override;
+    float get_erpm_error_rate(uint8_t chan) const override;
+
     /*
       force the safety switch on, disabling PWM output from the IO board
      */
@@ -86,6 +94,8 @@ public:
      */
     void timer_tick(void) override;
 
+    uint32_t get_push_dma_start_us(void) const override { return push_dma_start_us; }
+
     /*
       setup for serial output to a set of ESCs, using the given
       baudrate. Assumes 1 start bit, 1 stop bit, LSB first and 8
@@ -185,6 +195,12 @@ private:
         uint8_t dma_up_channel;
         uint8_t alt_functions[4];
         ioline_t pal_lines[4];
+        // input capture DMA per channel, for bidirectional DShot
+        struct {
+            bool have_dma;
+            uint8_t stream_id;
+            uint8_t channel;
+        } ic_dma[4];
 
         // below this line is not initialised by hwdef.h
         enum output_mode current_mode;
@@ -205,6 +221,13 @@ private:
         uint8_t clock_mask;
         bool serial_led_pending;
         bool prepared_send;
+        // colours of the LEDs on each channel in the group, by LED
+        // then channel, and the LEDs changed since they were encoded
+        uint8_t *serial_led_rgb;
+        uint8_t serial_led_rgb_nleds;
+        uint8_t serial_led_mask;
+        uint8_t serial_led_dirty_start;
+        uint8_t serial_led_dirty_end;
 
         // serial output
         struct {
@@ -217,6 +240,36 @@ private:
             // thread waiting for byte to be written
             thread_t *waiter;
         } serial;
+
+        // bidirectional DShot
+        struct {
+            // channels within the group (0 to 3) with eRPM capture
+            uint8_t mask;
+            // channel being captured this frame, one per frame in turn
+            uint8_t curr_chan;
+            Shared_DMA *ic_dma_handle[4];
+            const stm32_dma_stream_t *ic_dma_stream[4];
+            bool ic_locked;
+            bool have_capture;
+            uint16_t *ic_buffer;
+            uint16_t ic_edges;
+            uint32_t ticks_per_bit;
+            uint16_t ic_psc;
+            // time from the end of a frame to the end of the reply
+            uint16_t capture_us;
+            // timer registers while sending DShot
+            uint32_t ccmr;
+            uint32_t ccer;
+            uint32_t psc;
+            uint32_t arr;
+            uint32_t dier;
+            // latest eRPM and frame statistics
+            uint32_t erpm[4];
+            uint16_t frames[4];
+            uint16_t errors[4];
+            float error_rate[4];
+            uint32_t stats_start_ms;
+        } bdshot;
     };
 
     /*
@@ -295,6 +348,10 @@ private:
     // which output groups need triggering
     uint8_t trigger_groupmask;
 
+    // DMA start time of the first DShot send after a push()
+    volatile bool push_dma_pending;
+    volatile uint32_t push_dma_start_us;
+
     // widest pulse for oneshot triggering
     uint16_t trigger_widest_pulse;
 
@@ -337,6 +394,7 @@ private:
     static const uint16_t dshot_min_gap_us = 100;
     uint32_t dshot_pulse_time_us;
     uint16_t telem_request_mask;
+    uint16_t bidir_dshot_mask;
 
     /*
       Serial lED handling. Max of 32 LEDs uses max 12k of memory per group
@@ -344,12 +402,19 @@ private:
     */
     bool serial_led_send(pwm_group &group);
     bool serial_led_pending;
+    bool serial_led_registered;
+    bool serial_led_alloc(pwm_group &group, uint8_t num_leds);
+    void serial_led_set_colours(pwm_group &group, uint8_t idx, uint8_t first, uint8_t last, uint8_t red, uint8_t green, uint8_t blue);
+    void serial_led_encode(pwm_group &group);
+    void serial_led_update(void);
 
     void dma_allocate(Shared_DMA *ctx);
     void dma_deallocate(Shared_DMA *ctx);
-    uint16_t create_dshot_packet(const uint16_t value, bool telem_request);
+    uint16_t create_dshot_packet(const uint16_t value, bool telem_request, bool bidir);
     void fill_DMA_buffer_dshot(uint32_t *buffer, uint8_t stride, uint16_t packet, uint16_t clockmul);
     void dshot_send(pwm_group &group, bool blocking);
+    bool dshot_prepare(pwm_group &group, bool blocking);
+    void dshot_start(pwm_group &group);
     static void dma_irq_callback(void *p, uint32_t flags);
     static void dma_unlock(void *p);
     bool mode_requires_dma(enum output_mode mode) const;
@@ -359,6 +424,20 @@ private:
     bool is_dshot_protocol(const enum output_mode mode) const;
     uint32_t protocol_bitrate(const enum output_mode mode) const;
 
+    /*
+      bidirectional DShot eRPM capture, in RCOutput_bdshot.cpp
+     */
+    static const uint8_t bdshot_ic_buffer_length = 32;
+    bool bdshot_setup_group(pwm_group &group);
+    bool bdshot_setup_group_locked(pwm_group &group);
+    void bdshot_ic_dma_allocate(Shared_DMA *ctx);
+    void bdshot_ic_dma_deallocate(Shared_DMA *ctx);
+    void bdshot_prepare(pwm_group &group);
+    void bdshot_decode(pwm_group &group);
+    static uint32_t bdshot_decode_erpm(const uint16_t *edges, uint16_t count, uint32_t ticks_per_bit, bool &valid);
+    static void bdshot_start_capture_I(pwm_group &group);
+    static void bdshot_finish_capture(void *p);
+
     /*
       setup neopixel (WS2812B) output data for a given output channel
      */
@@ -0,0 +1,460 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  bidirectional DShot
+
+  With bidirectional DShot the line idles high and the ESC answers
+  each frame about 30us after it ends with a 21 bit GCR encoded eRPM
+  frame, at 5/4 of the DShot bitrate. Once the output DMA for a frame
+  completes one channel of the group is switched to input capture on
+  both edges, and the edge times are read by DMA from its CCR
+  register. After the reply the channel is switched back to output and
+  the capture is decoded when the next frame is sent.
+
+  The channels of a group share the timer, so only one channel is
+  captured per frame, taking each channel in turn.
+ */
+#include "RCOutput.h"
+#include <AP_Math/AP_Math.h>
+#include "hwdef/common/stm32_util.h"
+
+#if HAL_USE_PWM == TRUE
+
+using namespace ChibiOS;
+
+extern const AP_HAL::HAL& hal;
+
+#define NUM_GROUPS ARRAY_SIZE(pwm_group_list)
+
+// marker for a disabled channel
+#define CHAN_DISABLED 255
+
+// timer ticks per telemetry bit we aim for when capturing
+#define BDSHOT_TICKS_PER_BIT 16
+
+// the ESC starts its reply this long after the end of a frame
+#define BDSHOT_REPLY_DELAY_US 30
+
+// margin after the expected end of a reply
+#define BDSHOT_REPLY_MARGIN_US 20
+
+// bits in a reply frame
+#define BDSHOT_REPLY_BITS 21
+
+/*
+  enable bidirectional DShot on a mask of channels. Only channels
+  with input capture DMA in the hwdef can be captured
+ */
+void RCOutput::set_bidir_dshot_mask(uint16_t mask)
+{
+#ifndef DISABLE_DSHOT
+    if (mask == bidir_dshot_mask) {
+        return;
+    }
+    bidir_dshot_mask = mask;
+    for (uint8_t i = 0; i < NUM_GROUPS; i++ ) {
+        pwm_group &group = pwm_group_list[i];
+        if (is_dshot_protocol(group.current_mode)) {
+            // the group changes polarity, so needs setting up again
+            set_group_mode(group);
+        }
+    }
+#endif
+}
+
+/*
+  setup a group for bidirectional DShot from bidir_dshot_mask, called
+  when the group mode is set. Returns true if any channel in the group
+  is bidirectional
+ */
+bool RCOutput::bdshot_setup_group(pwm_group &group)
+{
+#ifndef DISABLE_DSHOT
+    // wait for any capture in progress
+    if (group.dma_handle != nullptr) {
+        group.dma_handle->lock();
+    }
+    const bool ret = bdshot_setup_group_locked(group);
+    if (group.dma_handle != nullptr) {
+        group.dma_handle->unlock();
+    }
+    return ret;
+#else
+    return false;
+#endif
+}
+
+#ifndef DISABLE_DSHOT
+bool RCOutput::bdshot_setup_group_locked(pwm_group &group)
+{
+    group.bdshot.mask = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        const uint8_t chan = group.chan[i];
+        if (chan == CHAN_DISABLED ||
+            !(bidir_dshot_mask & (1U<<(chan+chan_offset))) ||
+            !group.ic_dma[i].have_dma ||
+            (group.have_up_dma && group.ic_dma[i].stream_id == group.dma_up_stream_id)) {
+            continue;
+        }
+        if (group.bdshot.ic_dma_handle[i] == nullptr) {
+            group.bdshot.ic_dma_handle[i] = new Shared_DMA(group.ic_dma[i].stream_id, SHARED_DMA_NONE,
+                                                           FUNCTOR_BIND_MEMBER(&RCOutput::bdshot_ic_dma_allocate, void, Shared_DMA *),
+                                                           FUNCTOR_BIND_MEMBER(&RCOutput::bdshot_ic_dma_deallocate, void, Shared_DMA *));
+            if (group.bdshot.ic_dma_handle[i] == nullptr) {
+                continue;
+            }
+        }
+        group.bdshot.mask |= 1U<<i;
+    }
+    if (group.bdshot.mask == 0) {
+        return false;
+    }
+    if (group.bdshot.ic_buffer == nullptr) {
+        group.bdshot.ic_buffer = (uint16_t *)hal.util->malloc_type(bdshot_ic_buffer_length * sizeof(uint16_t),
+                                                                    AP_HAL::Util::MEM_DMA_SAFE, "RCOut");
+        if (group.bdshot.ic_buffer == nullptr) {
+            group.bdshot.mask = 0;
+            return false;
+        }
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        if (group.bdshot.mask & (1U<<i)) {
+            // the ESC drives the line low while answering, keep it
+            // high between frames
+            palSetLineMode(group.pal_lines[i], PAL_MODE_ALTERNATE(group.alt_functions[i]) |
+                           PAL_STM32_OSPEED_MID2 | PAL_STM32_OTYPE_PUSHPULL | PAL_STM32_PUPDR_PULLUP);
+        }
+    }
+    group.bdshot.curr_chan = __builtin_ctz(group.bdshot.mask);
+    group.bdshot.have_capture = false;
+    return true;
+}
+#endif // DISABLE_DSHOT
+
+/*
+  allocate the input capture DMA stream for a channel
+ */
+void RCOutput::bdshot_ic_dma_allocate(Shared_DMA *ctx)
+{
+#ifndef DISABLE_DSHOT
+    for (uint8_t i = 0; i < NUM_GROUPS; i++ ) {
+        pwm_group &group = pwm_group_list[i];
+        for (uint8_t c = 0; c < 4; c++) {
+            if (group.bdshot.ic_dma_handle[c] != ctx || group.bdshot.ic_dma_stream[c] != nullptr) {
+                continue;
+            }
+            chSysLock();
+            group.bdshot.ic_dma_stream[c] = dmaStreamAllocI(group.ic_dma[c].stream_id, 10, nullptr, nullptr);
+            chSysUnlock();
+#if STM32_DMA_SUPPORTS_DMAMUX
+            if (group.bdshot.ic_dma_stream[c]) {
+                dmaSetRequestSource(group.bdshot.ic_dma_stream[c], group.ic_dma[c].channel);
+            }
+#endif
+        }
+    }
+#endif
+}
+
+/*
+  deallocate the input capture DMA stream for a channel
+ */
+void RCOutput::bdshot_ic_dma_deallocate(Shared_DMA *ctx)
+{
+#ifndef DISABLE_DSHOT
+    for (uint8_t i = 0; i < NUM_GROUPS; i++ ) {
+        pwm_group &group = pwm_group_list[i];
+        for (uint8_t c = 0; c < 4; c++) {
+            if (group.bdshot.ic_dma_handle[c] == ctx && group.bdshot.ic_dma_stream[c] != nullptr) {
+                chSysLock();
+                dmaStreamFreeI(group.bdshot.ic_dma_stream[c]);
+                group.bdshot.ic_dma_stream[c] = nullptr;
+                chSysUnlock();
+            }
+        }
+    }
+#endif
+}
+
+/*
+  take the input capture DMA for the channel to be captured after the
+  next frame. Called with the group DMA locked. If the stream is busy
+  this frame goes without a capture
+ */
+void RCOutput::bdshot_prepare(pwm_group &group)
+{
+#ifndef DISABLE_DSHOT
+    const uint8_t c = group.bdshot.curr_chan;
+    group.bdshot.ic_locked = false;
+    if (!group.bdshot.ic_dma_handle[c]->lock_nonblock()) {
+        return;
+    }
+    if (group.bdshot.ic_dma_stream[c] == nullptr) {
+        group.bdshot.ic_dma_handle[c]->unlock();
+        return;
+    }
+    const uint32_t telem_bitrate = protocol_bitrate(group.current_mode) * 5 / 4;
+    const uint32_t prescaler = MAX(group.pwm_drv->clock / (telem_bitrate * BDSHOT_TICKS_PER_BIT), 1U);
+    group.bdshot.ticks_per_bit = group.pwm_drv->clock / (prescaler * telem_bitrate);
+    group.bdshot.ic_psc = prescaler - 1;
+    group.bdshot.capture_us = BDSHOT_REPLY_DELAY_US + BDSHOT_REPLY_MARGIN_US +
+        1000000UL * BDSHOT_REPLY_BITS / telem_bitrate;
+    group.bdshot.ic_locked = true;
+#endif
+}
+
+/*
+  switch the current channel to input capture on both edges and start
+  reading the edge times. Called from the output DMA completion IRQ in
+  a lock zone
+ */
+void RCOutput::bdshot_start_capture_I(pwm_group &group)
+{
+#ifndef DISABLE_DSHOT
+    stm32_tim_t *tim = group.pwm_drv->tim;
+    const uint8_t c = group.bdshot.curr_chan;
+    volatile uint32_t &ccmr = c < 2 ? tim->CCMR1 : tim->CCMR2;
+    const uint8_t ccmr_shift = (c & 1) * 8;
+    const uint8_t ccer_shift = c * 4;
+
+    // save the output setup
+    group.bdshot.ccmr = ccmr;
+    group.bdshot.ccer = tim->CCER;
+    group.bdshot.psc = tim->PSC;
+    group.bdshot.arr = tim->ARR;
+    group.bdshot.dier = tim->DIER;
+
+    // CCxS can only be changed with the channel disabled
+    tim->DIER = 0;
+    tim->CCER &= ~(0xFU << ccer_shift);
+    ccmr = (ccmr & ~(0xFFU << ccmr_shift)) | (STM32_TIM_CCMR1_CC1S(1) << ccmr_shift);
+    tim->PSC = group.bdshot.ic_psc;
+    tim->ARR = 0xFFFF;
+    tim->EGR = STM32_TIM_EGR_UG;
+    tim->CCER |= (STM32_TIM_CCER_CC1E | STM32_TIM_CCER_CC1P | STM32_TIM_CCER_CC1NP) << ccer_shift;
+
+    const stm32_dma_stream_t *dma = group.bdshot.ic_dma_stream[c];
+    dmaStreamSetPeripheral(dma, &tim->CCR[c]);
+    dmaStreamSetMemory0(dma, group.bdshot.ic_buffer);
+    dmaStreamSetTransactionSize(dma, bdshot_ic_buffer_length);
+    dmaStreamSetFIFO(dma, STM32_DMA_FCR_DMDIS | STM32_DMA_FCR_FTH_FULL);
+    dmaStreamSetMode(dma,
+                     STM32_DMA_CR_CHSEL(group.ic_dma[c].channel) |
+                     STM32_DMA_CR_DIR_P2M | STM32_DMA_CR_PSIZE_HWORD | STM32_DMA_CR_MSIZE_HWORD |
+                     STM32_DMA_CR_MINC | STM32_DMA_CR_PL(3));
+    dmaStreamEnable(dma);
+    tim->DIER = STM32_TIM_DIER_CC1DE << c;
+
+    chVTSetI(&group.dma_timeout, chTimeUS2I(group.bdshot.capture_us), bdshot_finish_capture, &group);
+#endif
+}
+
+/*
+  the reply is over, stop the capture and switch the channel back to
+  output. Called from a virtual timer
+ */
+void RCOutput::bdshot_finish_capture(void *p)
+{
+#ifndef DISABLE_DSHOT
+    pwm_group &group = *(pwm_group *)p;
+    stm32_tim_t *tim = group.pwm_drv->tim;
+    const uint8_t c = group.bdshot.curr_chan;
+    volatile uint32_t &ccmr = c < 2 ? tim->CCMR1 : tim->CCMR2;
+
+    chSysLockFromISR();
+    const stm32_dma_stream_t *dma = group.bdshot.ic_dma_stream[c];
+    dmaStreamDisable(dma);
+    group.bdshot.ic_edges = bdshot_ic_buffer_length - dmaStreamGetTransactionSize(dma);
+    group.bdshot.have_capture = true;
+
+    tim->DIER = 0;
+    tim->CCER &= ~(0xFU << (c * 4));
+    ccmr = group.bdshot.ccmr;
+    tim->PSC = group.bdshot.psc;
+    tim->ARR = group.bdshot.arr;
+    tim->CCR[c] = 0;
+    tim->EGR = STM32_TIM_EGR_UG;
+    tim->CCER = group.bdshot.ccer;
+    tim->DIER = group.bdshot.dier;
+
+    group.bdshot.ic_locked = false;
+    group.bdshot.ic_dma_handle[c]->unlock_from_IRQ();
+    // the reply took longer than the minimum gap between frames
+    group.dma_handle->unlock_from_IRQ();
+    chSysUnlockFromISR();
+#endif
+}
+
+/*
+  decode the reply captured after the last frame and move on to the
+  next channel. Called with the group DMA locked
+ */
+void RCOutput::bdshot_decode(pwm_group &group)
+{
+#ifndef DISABLE_DSHOT
+    const uint8_t c = group.bdshot.curr_chan;
+    if (group.bdshot.have_capture) {
+        group.bdshot.have_capture = false;
+        stm32_cacheBufferInvalidate(group.bdshot.ic_buffer, bdshot_ic_buffer_length * sizeof(uint16_t));
+        bool valid;
+        const uint32_t erpm = bdshot_decode_erpm(group.bdshot.ic_buffer, group.bdshot.ic_edges,
+                                                 group.bdshot.ticks_per_bit, valid);
+        group.bdshot.frames[c]++;
+        if (valid) {
+            group.bdshot.erpm[c] = erpm;
+        } else {
+            group.bdshot.errors[c]++;
+        }
+    }
+
+    // error rates over the last second
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - group.bdshot.stats_start_ms >= 1000) {
+        for (uint8_t i = 0; i < 4; i++) {
+            if (group.bdshot.frames[i] > 0) {
+                group.bdshot.error_rate[i] = 100.0f * group.bdshot.errors[i] / group.bdshot.frames[i];
+            } else {
+                group.bdshot.error_rate[i] = 100.0f;
+                group.bdshot.erpm[i] = 0;
+            }
+            group.bdshot.frames[i] = 0;
+            group.bdshot.errors[i] = 0;
+        }
+        group.bdshot.stats_start_ms = now_ms;
+    }
+
+    // next channel in the group
+    uint8_t next = c;
+    do {
+        next = (next + 1) % 4;
+    } while (!(group.bdshot.mask & (1U<<next)));
+    group.bdshot.curr_chan = next;
+#endif
+}
+
+/*
+  decode the eRPM from the times of the edges of a reply. Based on
+  decodeTelemetryPacket from betaflight.
+
+  Each edge marks a one in the GCR code, with zeroes for the bit times
+  between edges. The last run of the frame has no closing edge
+ */
+uint32_t RCOutput::bdshot_decode_erpm(const uint16_t *edges, uint16_t count, uint32_t ticks_per_bit, bool &valid)
+{
+    valid = false;
+    if (count < 2 || ticks_per_bit == 0) {
+        return 0;
+    }
+    uint32_t value = 0;
+    uint8_t bits = 0;
+    for (uint16_t i = 1; i <= count; i++) {
+        uint32_t len;
+        if (i < count) {
+            const uint16_t diff = edges[i] - edges[i-1];
+            len = (diff + ticks_per_bit/2) / ticks_per_bit;
+        } else {
+            len = BDSHOT_REPLY_BITS - bits;
+        }
+        if (len == 0 || bits + len > BDSHOT_REPLY_BITS) {
+            return 0;
+        }
+        value <<= len;
+        value |= 1U << (len - 1);
+        bits += len;
+        if (bits == BDSHOT_REPLY_BITS) {
+            break;
+        }
+    }
+    if (bits != BDSHOT_REPLY_BITS) {
+        return 0;
+    }
+
+    // GCR 5 bit codes to nibbles
+    static const uint8_t gcr_decode[32] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 9, 10, 11, 0, 13, 14, 15,
+        0, 0, 2, 3, 0, 5, 6, 7, 0, 0, 8, 1, 0, 4, 12, 0 };
+
+    uint32_t decoded = gcr_decode[value & 0x1f];
+    decoded |= gcr_decode[(value >> 5) & 0x1f] << 4;
+    decoded |= gcr_decode[(value >> 10) & 0x1f] << 8;
+    decoded |= gcr_decode[(value >> 15) & 0x1f] << 12;
+
+    // inverted checksum over the nibbles
+    uint32_t csum = decoded;
+    csum = csum ^ (csum >> 8);
+    csum = csum ^ (csum >> 4);
+    if ((csum & 0xf) != 0xf) {
+        return 0;
+    }
+    decoded >>= 4;
+
+    valid = true;
+    if (decoded == 0x0fff) {
+        // motor stopped
+        return 0;
+    }
+    // eRPM period in microseconds, as a 9 bit mantissa and 3 bit exponent
+    const uint32_t period_us = (decoded & 0x1ff) << (decoded >> 9);
+    if (period_us == 0) {
+        valid = false;
+        return 0;
+    }
+    return (60000000UL + period_us/2) / period_us;
+}
+
+/*
+  latest eRPM for a channel
+ */
+uint32_t RCOutput::get_erpm(uint8_t chan) const
+{
+#ifndef DISABLE_DSHOT
+    if (chan < chan_offset) {
+        return 0;
+    }
+    for (uint8_t i = 0; i < NUM_GROUPS; i++ ) {
+        const pwm_group &group = pwm_group_list[i];
+        for (uint8_t c = 0; c < 4; c++) {
+            if (group.chan[c] == chan - chan_offset && (group.bdshot.mask & (1U<<c))) {
+                return group.bdshot.erpm[c];
+            }
+        }
+    }
+#endif
+    return 0;
+}
+
+/*
+  percentage of replies for a channel that failed to decode over the
+  last second
+ */
+float RCOutput::get_erpm_error_rate(uint8_t chan) const
+{
+#ifndef DISABLE_DSHOT
+    if (chan < chan_offset) {
+        return 100.0f;
+    }
+    for (uint8_t i = 0; i < NUM_GROUPS; i++ ) {
+        const pwm_group &group = pwm_group_list[i];
+        for (uint8_t c = 0; c < 4; c++) {
+            if (group.chan[c] == chan - chan_offset && (group.bdshot.mask & (1U<<c))) {
+                return group.bdshot.error_rate[c];
+            }
+        }
+    }
+#endif
+    return 100.0f;
+}
+
+#endif // HAL_USE_PWM
@@ -85,7 +85,8 @@ SPIBus::SPIBus(uint8_t _bus) :
                                 spi_devices[bus].dma_channel_tx,
                                 FUNCTOR_BIND_MEMBER(&SPIBus::dma_allocate, void, Shared_DMA *),
                                 FUNCTOR_BIND_MEMBER(&SPIBus::dma_deallocate, void, Shared_DMA *));
-
+    // sensors on SPI buses take shared streams ahead of telemetry
+    dma_handle->set_priority(Shared_DMA::Priority::HIGH);
 }
 
 /*
@@ -442,8 +443,8 @@ void SPIDevice::test_clock_freq(void)
     // we will send 1024 bytes without any CS asserted and measure the
     // time it takes to do the transfer
     uint16_t len = 1024;
-    uint8_t *buf1 = (uint8_t *)hal.util->malloc_type(len, AP_HAL::Util::MEM_DMA_SAFE);
-    uint8_t *buf2 = (uint8_t *)hal.util->malloc_type(len, AP_HAL::Util::MEM_DMA_SAFE);
+    uint8_t *buf1 = (uint8_t *)hal.util->malloc_type(len, AP_HAL::Util::MEM_DMA_SAFE, "SPI");
+    uint8_t *buf2 = (uint8_t *)hal.util->malloc_type(len, AP_HAL::Util::MEM_DMA_SAFE, "SPI");
     for (uint8_t i=0; i<ARRAY_SIZE(spi_devices); i++) {
         SPIConfig spicfg {};
         const uint32_t target_freq = 2000000UL;
@@ -472,8 +473,8 @@ void SPIDevice::test_clock_freq(void)
         spiReleaseBus(spi_devices[i].driver);
         hal.console->printf("SPI[%u] clock=%u\n", unsigned(spi_devices[i].busid), unsigned(1000000ULL * len * 8ULL / uint64_t(t1 - t0)));
     }
-    hal.util->free_type(buf1, len, AP_HAL::Util::MEM_DMA_SAFE);
-    hal.util->free_type(buf2, len, AP_HAL::Util::MEM_DMA_SAFE);
+    hal.util->free_type(buf1, len, AP_HAL::Util::MEM_DMA_SAFE, "SPI");
+    hal.util->free_type(buf2, len, AP_HAL::Util::MEM_DMA_SAFE, "SPI");
 }
 #endif // HAL_SPI_CHECK_CLOCK_FREQ
 
@@ -360,6 +360,9 @@ void Scheduler::_monitor_thread(void *arg)
 #ifndef HAL_NO_LOGGING
     uint8_t log_wd_counter = 0;
 #endif
+#if HAL_THREAD_STATS_ENABLED
+    uint8_t thread_stats_counter = 0;
+#endif
 
     while (true) {
         sched->delay(100);
@@ -416,6 +419,14 @@ void Scheduler::_monitor_thread(void *arg)
     }
 #endif // HAL_NO_LOGGING
 
+#if HAL_THREAD_STATS_ENABLED
+    if (++thread_stats_counter == 10) {
+        thread_stats_counter = 0;
+        // sample thread loads once a second
+        Util::from(hal.util)->update_thread_stats();
+    }
+#endif
+
 #ifndef IOMCU_FW
     // setup GPIO interrupt quotas
     hal.gpio->timer_tick();
@@ -77,3 +77,35 @@ void Semaphore::assert_owner(void)
 }
 
 #endif // CH_CFG_USE_MUTEXES
+
+#if CH_CFG_USE_SEMAPHORES == TRUE
+
+using namespace ChibiOS;
+
+// constructor, starting in the taken state so the first wait() blocks
+BinarySemaphore::BinarySemaphore()
+{
+    static_assert(sizeof(_sem) >= sizeof(binary_semaphore_t), "invalid binary semaphore size");
+    binary_semaphore_t *sem = (binary_semaphore_t *)_sem;
+    chBSemObjectInit(sem, true);
+}
+
+bool BinarySemaphore::wait(uint32_t timeout_us)
+{
+    binary_semaphore_t *sem = (binary_semaphore_t *)_sem;
+    return chBSemWaitTimeout(sem, TIME_US2I(timeout_us)) == MSG_OK;
+}
+
+bool BinarySemaphore::wait_blocking()
+{
+    binary_semaphore_t *sem = (binary_semaphore_t *)_sem;
+    return chBSemWait(sem) == MSG_OK;
+}
+
+void BinarySemaphore::signal()
+{
+    binary_semaphore_t *sem = (binary_semaphore_t *)_sem;
+    chBSemSignal(sem);
+}
+
+#endif // CH_CFG_USE_SEMAPHORES
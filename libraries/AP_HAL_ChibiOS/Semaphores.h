@@ -37,3 +37,14 @@ protected:
     // we declare the lock as a uint32_t array, and cast inside the cpp file
     uint32_t _lock[5];
 };
+
+class ChibiOS::BinarySemaphore : public AP_HAL::BinarySemaphore {
+public:
+    BinarySemaphore();
+    bool wait(uint32_t timeout_us) override;
+    bool wait_blocking() override;
+    void signal() override;
+protected:
+    // opaque storage for a binary_semaphore_t, as for Semaphore::_lock
+    uint32_t _sem[4];
+};
@@ -16,10 +16,12 @@
  */
 #include <AP_HAL/AP_HAL.h>
 #include <AP_BoardConfig/AP_BoardConfig.h>
+#include <AP_Math/AP_Math.h>
 
 #include "Storage.h"
 #include "HAL_ChibiOS_Class.h"
 #include "Scheduler.h"
+#include "Flash.h"
 #include "hwdef/common/flash.h"
 #include <AP_Filesystem/AP_Filesystem.h>
 #include "sdcard.h"
@@ -242,6 +244,9 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
         WITH_SEMAPHORE(sem);
         memcpy(&_buffer[loc], src, n);
         _mark_dirty(loc, n);
+        _stats.bytes_dirtied += n;
+        _last_write_ms = AP_HAL::millis();
+        _compact_pending = true;
     }
 }
 
@@ -250,13 +255,22 @@ void Storage::_timer_tick(void)
     if (_initialisedType == StorageBackend::None) {
         return;
     }
+    const uint32_t now_ms = AP_HAL::millis();
     if (_dirty_mask.empty()) {
-        _last_empty_ms = AP_HAL::millis();
+        _last_empty_ms = now_ms;
+        _flash_compact();
         return;
     }
 
-    // write out the first dirty line. We don't write more
-    // than one to keep the latency of this call to a minimum
+    if (now_ms - _last_write_ms < HAL_STORAGE_COALESCE_MS &&
+        now_ms - _last_empty_ms < HAL_STORAGE_COALESCE_MAX_MS) {
+        // writes are still arriving, let them build up so that
+        // neighbouring lines go out together
+        return;
+    }
+
+    // write out the first run of dirty lines. We don't write more
+    // than one run to keep the latency of this call to a minimum
     uint16_t i;
     for (i=0; i<CH_STORAGE_NUM_LINES; i++) {
         if (_dirty_mask.get(i)) {
@@ -267,18 +281,29 @@ void Storage::_timer_tick(void)
         // this shouldn't be possible
         return;
     }
+    uint8_t nlines = 1;
+    while (nlines < CH_STORAGE_MAX_WRITE_LINES &&
+           i + nlines < CH_STORAGE_NUM_LINES &&
+           _dirty_mask.get(i + nlines)) {
+        nlines++;
+    }
+    const uint32_t offset = CH_STORAGE_LINE_SIZE*i;
+    const uint16_t length = CH_STORAGE_LINE_SIZE*nlines;
 
     {
-        // take a copy of the line we are writing with a semaphore held
+        // take a copy of the lines we are writing with a semaphore held
         WITH_SEMAPHORE(sem);
-        memcpy(tmpline, &_buffer[CH_STORAGE_LINE_SIZE*i], CH_STORAGE_LINE_SIZE);
+        memcpy(tmpline, &_buffer[offset], length);
     }
 
     bool write_ok = false;
+    const uint32_t start_us = AP_HAL::micros();
 
 #if HAL_WITH_RAMTRON
     if (_initialisedType == StorageBackend::FRAM) {
-        if (fram.write(CH_STORAGE_LINE_SIZE*i, tmpline, CH_STORAGE_LINE_SIZE)) {
+        if (fram.write(offset, tmpline, length)) {
+            _stats.bytes_written += length;
+            _stats.writes++;
             write_ok = true;
         }
     }
@@ -286,16 +311,17 @@ void Storage::_timer_tick(void)
 
 #ifdef USE_POSIX
     if ((_initialisedType == StorageBackend::SDCard) && log_fd != -1) {
-        uint32_t offset = CH_STORAGE_LINE_SIZE*i;
         if (AP::FS().lseek(log_fd, offset, SEEK_SET) != offset) {
             return;
         }
-        if (AP::FS().write(log_fd, &_buffer[offset], CH_STORAGE_LINE_SIZE) != CH_STORAGE_LINE_SIZE) {
+        if (AP::FS().write(log_fd, tmpline, length) != length) {
             return;
         }
         if (AP::FS().fsync(log_fd) != 0) {
             return;
         }
+        _stats.bytes_written += length;
+        _stats.writes++;
         write_ok = true;
     }
 #endif
@@ -303,22 +329,27 @@ void Storage::_timer_tick(void)
 #ifdef STORAGE_FLASH_PAGE
     if (_initialisedType == StorageBackend::Flash) {
         // save to storage backend
-        if (_flash_write(i)) {
+        if (_flash_write(i, nlines)) {
             write_ok = true;
         }
     }
 #endif
 
+    _stats.stall_max_us = MAX(_stats.stall_max_us, AP_HAL::micros() - start_us);
+
     if (write_ok) {
         WITH_SEMAPHORE(sem);
-        // while holding the semaphore we check if the copy of the
+        // while holding the semaphore we check if the copy of each
         // line is different from the original line. If it is
         // different then someone has re-dirtied the line while we
         // were writing it, in which case we should not mark it
         // clean. If it matches then we know we can mark the line as
         // clean
-        if (memcmp(tmpline, &_buffer[CH_STORAGE_LINE_SIZE*i], CH_STORAGE_LINE_SIZE) == 0) {
-            _dirty_mask.clear(i);
+        for (uint8_t n=0; n<nlines; n++) {
+            const uint16_t ofs = CH_STORAGE_LINE_SIZE*n;
+            if (memcmp(&tmpline[ofs], &_buffer[offset+ofs], CH_STORAGE_LINE_SIZE) == 0) {
+                _dirty_mask.clear(i+n);
+            }
         }
     }
 }
@@ -331,7 +362,14 @@ void Storage::_flash_load(void)
 #ifdef STORAGE_FLASH_PAGE
     _flash_page = STORAGE_FLASH_PAGE;
 
-    ::printf("Storage: Using flash pages %u and %u\n", _flash_page, _flash_page+1);
+#if HAL_STORAGE_BACKGROUND_ERASE
+    ChibiOS::Flash *flash = (ChibiOS::Flash *)hal.flash;
+    _flash_background_erase = flash->background_erase_ok(_flash_page) &&
+                              flash->background_erase_ok(_flash_page+1);
+#endif
+
+    ::printf("Storage: Using flash pages %u and %u%s\n", _flash_page, _flash_page+1,
+             _flash_background_erase ? " with background erase" : "");
 
     if (!_flash.init()) {
         AP_HAL::panic("Unable to init flash storage");
@@ -342,17 +380,43 @@ void Storage::_flash_load(void)
 }
 
 /*
-  write one storage line. This also updates _dirty_mask.
+  write a run of storage lines
 */
-bool Storage::_flash_write(uint16_t line)
+bool Storage::_flash_write(uint16_t line, uint8_t nlines)
 {
 #ifdef STORAGE_FLASH_PAGE
-    return _flash.write(line*CH_STORAGE_LINE_SIZE, CH_STORAGE_LINE_SIZE);
+    return _flash.write(line*CH_STORAGE_LINE_SIZE, nlines*CH_STORAGE_LINE_SIZE);
 #else
     return false;
 #endif
 }
 
+/*
+  compact the flash log while we are disarmed and idle, so the sector
+  erase it needs is not forced by a write at a worse time
+*/
+void Storage::_flash_compact(void)
+{
+#ifdef STORAGE_FLASH_PAGE
+    if (_initialisedType != StorageBackend::Flash ||
+        !_compact_pending ||
+        AP_HAL::millis() - _last_write_ms < HAL_STORAGE_COMPACT_IDLE_MS ||
+        !_flash_erase_ok()) {
+        return;
+    }
+    // only look again once there have been more writes
+    _compact_pending = false;
+    if (!_flash.compaction_advised()) {
+        return;
+    }
+    const uint32_t start_us = AP_HAL::micros();
+    if (_flash.switch_full_sector()) {
+        _stats.compactions++;
+    }
+    _stats.stall_max_us = MAX(_stats.stall_max_us, AP_HAL::micros() - start_us);
+#endif
+}
+
 /*
   callback to write data to flash
  */
@@ -362,6 +426,8 @@ bool Storage::_flash_write_data(uint8_t sector, uint32_t offset, const uint8_t *
     size_t base_address = hal.flash->getpageaddr(_flash_page+sector);
     for (uint8_t i=0; i<STORAGE_FLASH_RETRIES; i++) {
         if (hal.flash->write(base_address+offset, data, length)) {
+            _stats.bytes_written += length;
+            _stats.writes++;
             return true;
         }
         hal.scheduler->delay(1);
@@ -404,6 +470,20 @@ bool Storage::_flash_read_data(uint8_t sector, uint32_t offset, uint8_t *data, u
 bool Storage::_flash_erase_sector(uint8_t sector)
 {
 #ifdef STORAGE_FLASH_PAGE
+    if (_flash_background_erase) {
+        // the CPU keeps running from the other bank, so there is no
+        // long delay to expect
+        ChibiOS::Flash *flash = (ChibiOS::Flash *)hal.flash;
+        for (uint8_t i=0; i<STORAGE_FLASH_RETRIES; i++) {
+            if (flash->erasepage_background(_flash_page+sector)) {
+                _stats.erases++;
+                return true;
+            }
+            hal.scheduler->delay(1);
+        }
+        return false;
+    }
+
     // erasing a page can take long enough that USB may not initialise properly if it happens
     // while the host is connecting. Only do a flash erase if we have been up for more than 4s
     for (uint8_t i=0; i<STORAGE_FLASH_RETRIES; i++) {
@@ -417,6 +497,7 @@ bool Storage::_flash_erase_sector(uint8_t sector)
         sched->_expect_delay_ms(1000);
         if (hal.flash->erasepage(_flash_page+sector)) {
             sched->_expect_delay_ms(0);
+            _stats.erases++;
             return true;
         }
         sched->_expect_delay_ms(0);
@@ -433,8 +514,8 @@ bool Storage::_flash_erase_sector(uint8_t sector)
  */
 bool Storage::_flash_erase_ok(void)
 {
-    // only allow erase while disarmed
-    return !hal.util->get_soft_armed();
+    // only allow erase while disarmed, unless it won't stall the CPU
+    return _flash_background_erase || !hal.util->get_soft_armed();
 }
 
 /*
@@ -447,6 +528,15 @@ bool Storage::healthy(void)
             (AP_HAL::millis() - _last_empty_ms < 2000u));
 }
 
+/*
+  get write statistics
+ */
+bool Storage::get_stats(Stats &stats)
+{
+    stats = _stats;
+    return true;
+}
+
 /*
   erase all storage
  */
@@ -37,6 +37,33 @@
 static_assert(CH_STORAGE_SIZE % CH_STORAGE_LINE_SIZE == 0,
               "Storage is not multiple of line size");
 
+// up to this many contiguous dirty lines are written in one go, which
+// for flash storage is one log block with a single header
+#define CH_STORAGE_MAX_WRITE_LINES 8
+
+// dirty lines are held back until writes have paused for this long so
+// that bursts of small writes, such as a parameter save, coalesce
+#ifndef HAL_STORAGE_COALESCE_MS
+#define HAL_STORAGE_COALESCE_MS 50
+#endif
+
+// but are never held back for longer than this
+#ifndef HAL_STORAGE_COALESCE_MAX_MS
+#define HAL_STORAGE_COALESCE_MAX_MS 500
+#endif
+
+// flash compaction is only done when disarmed and there have been no
+// writes for this long
+#ifndef HAL_STORAGE_COMPACT_IDLE_MS
+#define HAL_STORAGE_COMPACT_IDLE_MS 5000
+#endif
+
+// erase storage flash pages in the background, allowing erases while
+// armed, on dual bank MCUs where the pages are not in the firmware bank
+#ifndef HAL_STORAGE_BACKGROUND_ERASE
+#define HAL_STORAGE_BACKGROUND_ERASE 1
+#endif
+
 class ChibiOS::Storage : public AP_HAL::Storage {
 public:
     void init() override {}
@@ -46,6 +73,7 @@ public:
 
     void _timer_tick(void) override;
     bool healthy(void) override;
+    bool get_stats(Stats &stats) override;
 
 private:
     enum class StorageBackend: uint8_t {
@@ -62,7 +90,10 @@ private:
     uint8_t _buffer[CH_STORAGE_SIZE] __attribute__((aligned(4)));
     Bitmask<CH_STORAGE_NUM_LINES> _dirty_mask;
     HAL_Semaphore sem;
-    uint8_t tmpline[CH_STORAGE_LINE_SIZE];
+    uint8_t tmpline[CH_STORAGE_LINE_SIZE*CH_STORAGE_MAX_WRITE_LINES];
+    uint32_t _last_write_ms;
+    bool _compact_pending;
+    Stats _stats;
 
     bool _flash_write_data(uint8_t sector, uint32_t offset, const uint8_t *data, uint16_t length);
     bool _flash_read_data(uint8_t sector, uint32_t offset, uint8_t *data, uint16_t length);
@@ -70,6 +101,7 @@ private:
     bool _flash_erase_ok(void);
     uint8_t _flash_page;
     bool _flash_failed;
+    bool _flash_background_erase;
     uint32_t _last_re_init_ms;
     uint32_t _last_empty_ms;
 
@@ -83,7 +115,8 @@ private:
 #endif
 
     void _flash_load(void);
-    bool _flash_write(uint16_t line);
+    bool _flash_write(uint16_t line, uint8_t nlines);
+    void _flash_compact(void);
 
 #if HAL_WITH_RAMTRON
     AP_RAMTRON fram;
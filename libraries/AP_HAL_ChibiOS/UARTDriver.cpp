@@ -196,6 +196,12 @@ void UARTDriver::begin(uint32_t b, uint16_t rxS, uint16_t txS)
     }
     if (rxS != _readbuf.get_size()) {
         _initialised = false;
+#if HAL_UART_RX_DMA_CIRCULAR
+        // the rx DMA writes straight into the read buffer so must be
+        // stopped while it is replaced
+        dma_rx_circular_stop();
+        rx_dma_buf_ok = false;
+#endif
         _readbuf.set_size(rxS);
     }
 
@@ -209,27 +215,45 @@ void UARTDriver::begin(uint32_t b, uint16_t rxS, uint16_t txS)
     }
 
     if (clear_buffers) {
+#if HAL_UART_RX_DMA_CIRCULAR
+        dma_rx_circular_stop();
+#endif
         _readbuf.clear();
     }
 
 #ifndef HAL_UART_NODMA
     if (!half_duplex && !(_last_options & OPTION_NODMA_RX)) {
+#if HAL_UART_RX_DMA_CIRCULAR
+        // the DMA receives straight into the read buffer, so it
+        // needs to be in DMA safe memory
+        if (!rx_dma_buf_ok && sdef.dma_rx) {
+            uint8_t *mem = (uint8_t *)hal.util->malloc_type(rxS, AP_HAL::Util::MEM_DMA_SAFE, "UART");
+            if (mem != nullptr) {
+                rx_dma_buf_ok = _readbuf.set_buffer(mem, rxS);
+            }
+        }
+#else
         if (rx_bounce_buf[0] == nullptr && sdef.dma_rx) {
-            rx_bounce_buf[0] = (uint8_t *)hal.util->malloc_type(RX_BOUNCE_BUFSIZE, AP_HAL::Util::MEM_DMA_SAFE);
+            rx_bounce_buf[0] = (uint8_t *)hal.util->malloc_type(RX_BOUNCE_BUFSIZE, AP_HAL::Util::MEM_DMA_SAFE, "UART");
         }
         if (rx_bounce_buf[1] == nullptr && sdef.dma_rx) {
-            rx_bounce_buf[1] = (uint8_t *)hal.util->malloc_type(RX_BOUNCE_BUFSIZE, AP_HAL::Util::MEM_DMA_SAFE);
+            rx_bounce_buf[1] = (uint8_t *)hal.util->malloc_type(RX_BOUNCE_BUFSIZE, AP_HAL::Util::MEM_DMA_SAFE, "UART");
         }
+#endif
     }
     if (tx_bounce_buf == nullptr && sdef.dma_tx && !(_last_options & OPTION_NODMA_TX)) {
-        tx_bounce_buf = (uint8_t *)hal.util->malloc_type(TX_BOUNCE_BUFSIZE, AP_HAL::Util::MEM_DMA_SAFE);
+        tx_bounce_buf = (uint8_t *)hal.util->malloc_type(TX_BOUNCE_BUFSIZE, AP_HAL::Util::MEM_DMA_SAFE, "UART");
         chVTObjectInit(&tx_timeout);
         tx_bounce_buf_ready = true;
     }
     if (half_duplex) {
         rx_dma_enabled = tx_dma_enabled = false;
     } else {
+#if HAL_UART_RX_DMA_CIRCULAR
+        rx_dma_enabled = rx_dma_buf_ok;
+#else
         rx_dma_enabled = rx_bounce_buf[0] != nullptr && rx_bounce_buf[1] != nullptr;
+#endif
         tx_dma_enabled = tx_bounce_buf != nullptr;
     }
 #endif
@@ -294,6 +318,8 @@ void UARTDriver::begin(uint32_t b, uint16_t rxS, uint16_t txS)
                                                 SHARED_DMA_NONE,
                                                 FUNCTOR_BIND_MEMBER(&UARTDriver::dma_tx_allocate, void, Shared_DMA *),
                                                 FUNCTOR_BIND_MEMBER(&UARTDriver::dma_tx_deallocate, void, Shared_DMA *));
+                    // TX can always wait for the next write, so give way to sensors
+                    dma_handle->set_priority(Shared_DMA::Priority::LOW);
                 }
                 _device_initialised = true;
             }
@@ -326,7 +352,12 @@ void UARTDriver::begin(uint32_t b, uint16_t rxS, uint16_t txS)
                 //because we will handle them via DMA
                 ((SerialDriver*)sdef.serial)->usart->CR1 &= ~USART_CR1_RXNEIE;
                 // Start DMA
-                if (!was_initialised) {
+                bool start_rx_dma = !was_initialised;
+#if HAL_UART_RX_DMA_CIRCULAR
+                // the circular DMA is stopped whenever the read buffer is replaced or cleared
+                start_rx_dma = !rx_dma_circular;
+#endif
+                if (start_rx_dma) {
                     dmaStreamDisable(rxdma);
                     dma_rx_enable();
                 }
@@ -383,13 +414,80 @@ void UARTDriver::dma_rx_enable(void)
     uint32_t dmamode = STM32_DMA_CR_DMEIE | STM32_DMA_CR_TEIE;
     dmamode |= STM32_DMA_CR_CHSEL(sdef.dma_rx_channel_id);
     dmamode |= STM32_DMA_CR_PL(0);
+#if HAL_UART_RX_DMA_CIRCULAR
+    // receive continuously into the read buffer. The half and full
+    // transfer interrupts make sure bytes are handed over at least
+    // twice per lap of the buffer, the idle interrupt does it as
+    // soon as the line goes quiet
+    _readbuf.clear();
+    rx_dma_pos = 0;
+    dmaStreamSetMemory0(rxdma, _readbuf.buf);
+    dmaStreamSetTransactionSize(rxdma, _readbuf.get_size());
+    dmaStreamSetMode(rxdma, dmamode | STM32_DMA_CR_DIR_P2M |
+                     STM32_DMA_CR_MINC | STM32_DMA_CR_CIRC |
+                     STM32_DMA_CR_HTIE | STM32_DMA_CR_TCIE);
+    rx_dma_circular = true;
+#else
     rx_bounce_idx ^= 1;
     dmaStreamSetMemory0(rxdma, rx_bounce_buf[rx_bounce_idx]);
     dmaStreamSetTransactionSize(rxdma, RX_BOUNCE_BUFSIZE);
     dmaStreamSetMode(rxdma, dmamode | STM32_DMA_CR_DIR_P2M |
                      STM32_DMA_CR_MINC | STM32_DMA_CR_TCIE);
+#endif
     dmaStreamEnable(rxdma);
 }
+
+#if HAL_UART_RX_DMA_CIRCULAR
+/*
+  stop the circular rx DMA so that the read buffer can be changed
+ */
+void UARTDriver::dma_rx_circular_stop(void)
+{
+    if (rxdma == nullptr) {
+        return;
+    }
+    chSysLock();
+    if (rx_dma_circular) {
+        rx_dma_circular = false;
+        dmaStreamDisable(rxdma);
+    }
+    chSysUnlock();
+}
+
+/*
+  hand the bytes written by the circular rx DMA over to readers by
+  moving the write pointer of the read buffer up to the DMA
+  position. Must be called with the system locked
+ */
+void UARTDriver::dma_rx_circular_update(void)
+{
+    const uint32_t size = _readbuf.get_size();
+    const uint32_t pos = (size - dmaStreamGetTransactionSize(rxdma)) % size;
+    const uint32_t len = (pos + size - rx_dma_pos) % size;
+    if (len == 0) {
+        return;
+    }
+    if (pos > rx_dma_pos) {
+        stm32_cacheBufferInvalidate(&_readbuf.buf[rx_dma_pos], len);
+    } else {
+        stm32_cacheBufferInvalidate(&_readbuf.buf[rx_dma_pos], size - rx_dma_pos);
+        stm32_cacheBufferInvalidate(_readbuf.buf, pos);
+    }
+    rx_dma_pos = pos;
+
+    const uint32_t space = _readbuf.space();
+    if (len > space) {
+        // the DMA has overwritten bytes that had not been read
+        // yet. Keep the newest bytes and count the rest as lost
+        _rx_overruns += len - space;
+        _readbuf.tail = pos;
+        _readbuf.head = (pos + 1) % size;
+    } else {
+        _readbuf.commit(len);
+    }
+    receive_timestamp_update();
+}
+#endif // HAL_UART_RX_DMA_CIRCULAR
 #endif
 
 void UARTDriver::dma_tx_deallocate(Shared_DMA *ctx)
@@ -431,7 +529,18 @@ void UARTDriver::rx_irq_cb(void* self)
     if (!uart_drv->rx_dma_enabled) {
         return;
     }
-#if defined(STM32F7) || defined(STM32H7)
+#if HAL_UART_RX_DMA_CIRCULAR
+#if !defined(STM32F7) && !defined(STM32H7) && !defined(STM32F3)
+    volatile uint16_t sr = ((SerialDriver*)(uart_drv->sdef.serial))->usart->SR;
+    if (!(sr & USART_SR_IDLE)) {
+        return;
+    }
+    volatile uint16_t dr = ((SerialDriver*)(uart_drv->sdef.serial))->usart->DR;
+    (void)dr;
+#endif
+    // hand over the bytes received so far, leaving the DMA running
+    rxbuff_full_irq(self, 0);
+#elif defined(STM32F7) || defined(STM32H7)
     //disable dma, triggering DMA transfer complete interrupt
     uart_drv->rxdma->stream->CR &= ~STM32_DMA_CR_EN;
 #elif defined(STM32F3)
@@ -452,7 +561,8 @@ void UARTDriver::rx_irq_cb(void* self)
 #endif
 
 /*
-  handle a RX DMA full interrupt
+  handle a RX DMA full interrupt, or a half or full transfer
+  interrupt of the circular rx DMA
  */
 void UARTDriver::rxbuff_full_irq(void* self, uint32_t flags)
 {
@@ -461,6 +571,13 @@ void UARTDriver::rxbuff_full_irq(void* self, uint32_t flags)
     if (!uart_drv->rx_dma_enabled) {
         return;
     }
+#if HAL_UART_RX_DMA_CIRCULAR
+    chSysLockFromISR();
+    if (uart_drv->rx_dma_circular) {
+        uart_drv->dma_rx_circular_update();
+    }
+    chSysUnlockFromISR();
+#else
     uint16_t len = RX_BOUNCE_BUFSIZE - dmaStreamGetTransactionSize(uart_drv->rxdma);
     const uint8_t bounce_idx = uart_drv->rx_bounce_idx;
 
@@ -476,9 +593,10 @@ void UARTDriver::rxbuff_full_irq(void* self, uint32_t flags)
           we have data to copy out
          */
         stm32_cacheBufferInvalidate(uart_drv->rx_bounce_buf[bounce_idx], len);
-        uart_drv->_readbuf.write(uart_drv->rx_bounce_buf[bounce_idx], len);
+        uart_drv->_rx_overruns += len - uart_drv->_readbuf.write(uart_drv->rx_bounce_buf[bounce_idx], len);
         uart_drv->receive_timestamp_update();
     }
+#endif // HAL_UART_RX_DMA_CIRCULAR
 
     if (uart_drv->_wait.thread_ctx && uart_drv->_readbuf.available() >= uart_drv->_wait.n) {
         chSysLockFromISR();
@@ -512,6 +630,10 @@ void UARTDriver::end()
         sdStop((SerialDriver*)sdef.serial);
 #endif
     }
+#if HAL_UART_RX_DMA_CIRCULAR
+    dma_rx_circular_stop();
+    rx_dma_buf_ok = false;
+#endif
     _readbuf.set_size(0);
     _writebuf.set_size(0);
 }
@@ -584,6 +706,23 @@ int16_t UARTDriver::read()
     return byte;
 }
 
+ssize_t UARTDriver::read(uint8_t *buffer, uint16_t count)
+{
+    if (lock_read_key != 0 || _uart_owner_thd != chThdGetSelfX()){
+        return 0;
+    }
+    if (!_initialised) {
+        return 0;
+    }
+
+    const uint32_t nread = _readbuf.read(buffer, count);
+    if (nread > 0 && !_rts_is_active) {
+        update_rts_line();
+    }
+
+    return nread;
+}
+
 int16_t UARTDriver::read_locked(uint32_t key)
 {
     if (lock_read_key != 0 && key != lock_read_key) {
@@ -692,6 +831,34 @@ size_t UARTDriver::write_locked(const uint8_t *buffer, size_t size, uint32_t key
     return _writebuf.write(buffer, size);
 }
 
+/*
+  reserve space in the write buffer to be filled in place. Only
+  non-blocking buffered writes are supported, so the caller never
+  needs to wait for space
+ */
+bool UARTDriver::write_reserve(ByteBuffer::IoVec vec[2], uint32_t len)
+{
+    if (!_initialised || lock_write_key != 0 ||
+        _blocking_writes || unbuffered_writes) {
+        return false;
+    }
+    _write_mutex.take_blocking();
+    if (_writebuf.space() < len || _writebuf.reserve(vec, len) == 0) {
+        _write_mutex.give();
+        return false;
+    }
+    return true;
+}
+
+/*
+  queue the bytes filled in after write_reserve() for transmit
+ */
+void UARTDriver::write_commit(uint32_t len)
+{
+    _writebuf.commit(len);
+    _write_mutex.give();
+}
+
 /*
   wait for data to arrive, or a timeout. Return true if data has
   arrived, false on timeout
@@ -964,7 +1131,30 @@ void UARTDriver::_timer_tick(void)
     }
 #endif
 
-#ifndef HAL_UART_NODMA
+#if HAL_UART_RX_DMA_CIRCULAR
+    if (rx_dma_enabled && rxdma) {
+        chSysLock();
+        if (rx_dma_circular) {
+#if defined(STM32F3)
+            bool enabled = (rxdma->channel->CCR & STM32_DMA_CR_EN);
+#else
+            bool enabled = (rxdma->stream->CR & STM32_DMA_CR_EN);
+#endif
+            if (enabled) {
+                // pick up any bytes the idle interrupt missed
+                dma_rx_circular_update();
+            } else {
+                // DMA was stopped by a transfer error, start it again
+                dmaStreamDisable(rxdma);
+                dma_rx_enable();
+            }
+            if (_rts_is_active) {
+                update_rts_line();
+            }
+        }
+        chSysUnlock();
+    }
+#elif !defined(HAL_UART_NODMA)
     if (rx_dma_enabled && rxdma) {
         chSysLock();
         //Check if DMA is enabled
@@ -979,7 +1169,7 @@ void UARTDriver::_timer_tick(void)
             uint8_t len = RX_BOUNCE_BUFSIZE - dmaStreamGetTransactionSize(rxdma);
             if (len != 0) {
                 stm32_cacheBufferInvalidate(rx_bounce_buf[rx_bounce_idx], len);
-                _readbuf.write(rx_bounce_buf[rx_bounce_idx], len);
+                _rx_overruns += len - _readbuf.write(rx_bounce_buf[rx_bounce_idx], len);
 
                 receive_timestamp_update();
                 if (_rts_is_active) {
@@ -1395,6 +1585,9 @@ bool UARTDriver::set_options(uint16_t options)
         if (rx_dma_enabled && rxdma) {
             dmaStreamDisable(rxdma);
         }
+#if HAL_UART_RX_DMA_CIRCULAR
+        rx_dma_circular = false;
+#endif
 #endif
         // force DMA off when using half-duplex as the timing may affect other devices
         // sharing the DMA channel
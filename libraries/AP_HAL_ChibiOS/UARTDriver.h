@@ -25,6 +25,16 @@
 #define RX_BOUNCE_BUFSIZE 64U
 #define TX_BOUNCE_BUFSIZE 64U
 
+// receive with a circular DMA transfer straight into the read buffer
+// instead of copying out of the bounce buffers
+#ifndef HAL_UART_RX_DMA_CIRCULAR
+#ifdef HAL_UART_NODMA
+#define HAL_UART_RX_DMA_CIRCULAR 0
+#else
+#define HAL_UART_RX_DMA_CIRCULAR 1
+#endif
+#endif
+
 // enough for uartA to uartH, plus IOMCU
 #define UART_MAX_DRIVERS 9
 
@@ -44,6 +54,7 @@ public:
     uint32_t available() override;
     uint32_t txspace() override;
     int16_t read() override;
+    ssize_t read(uint8_t *buffer, uint16_t count) override;
     int16_t read_locked(uint32_t key) override;
     void _timer_tick(void) override;
 
@@ -61,6 +72,10 @@ public:
     // and write is discarded
     size_t write_locked(const uint8_t *buffer, size_t size, uint32_t key) override;
 
+    // fill the transmit buffer in place
+    bool write_reserve(ByteBuffer::IoVec vec[2], uint32_t len) override;
+    void write_commit(uint32_t len) override;
+
     struct SerialDef {
         BaseSequentialStream* serial;
         bool is_usb;
@@ -117,6 +132,8 @@ public:
         return _baudrate/(9*1024);
     }
 
+    uint32_t get_rx_overruns(void) const override { return _rx_overruns; }
+
 private:
     const SerialDef &sdef;
     bool rx_dma_enabled;
@@ -156,7 +173,17 @@ private:
     volatile uint8_t rx_bounce_idx;
     uint8_t *rx_bounce_buf[2];
     uint8_t *tx_bounce_buf;
+#if HAL_UART_RX_DMA_CIRCULAR
+    // true if the memory of _readbuf is DMA safe
+    bool rx_dma_buf_ok;
+    // true while the rx DMA runs continuously into _readbuf
+    volatile bool rx_dma_circular;
+    // offset in _readbuf that the DMA had written up to when last checked
+    uint32_t rx_dma_pos;
+#endif
 #endif
+    // number of received bytes discarded because _readbuf was full
+    uint32_t _rx_overruns;
     ByteBuffer _readbuf{0};
     ByteBuffer _writebuf{0};
     HAL_Semaphore _write_mutex;
@@ -220,6 +247,10 @@ private:
     void dma_tx_allocate(Shared_DMA *ctx);
     void dma_tx_deallocate(Shared_DMA *ctx);
     void dma_rx_enable(void);
+#if HAL_UART_RX_DMA_CIRCULAR
+    void dma_rx_circular_stop(void);
+    void dma_rx_circular_update(void);
+#endif
 #endif
     void update_rts_line(void);
 
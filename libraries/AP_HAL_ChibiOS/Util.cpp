@@ -24,7 +24,9 @@
 #include "hwdef/common/watchdog.h"
 #include "hwdef/common/flash.h"
 #include <AP_ROMFS/AP_ROMFS.h>
+#include <AP_HAL/utility/TLSF.h>
 #include "sdcard.h"
+#include "shared_dma.h"
 
 #if HAL_WITH_IO_MCU
 #include <AP_BoardConfig/AP_BoardConfig.h>
@@ -46,26 +48,127 @@ uint32_t Util::available_memory(void)
     return mem_available();
 }
 
+/*
+  lock statistics of a shared DMA stream
+*/
+bool Util::get_dma_stats(uint8_t stream_id, DMAStats &stats)
+{
+#if CH_CFG_USE_SEMAPHORES == TRUE
+    return Shared_DMA::get_stats(stream_id, stats);
+#else
+    return false;
+#endif
+}
+
+#if HAL_THREAD_STATS_ENABLED
+/*
+  CPU load and stack usage of a thread, as of the last update
+*/
+bool Util::get_thread_stats(uint8_t idx, ThreadStats &stats)
+{
+    WITH_SEMAPHORE(_thread_stats_sem);
+    if (idx >= _num_thread_samples) {
+        return false;
+    }
+    stats = _thread_samples[idx].stats;
+    return true;
+}
+
+/*
+  sample the run time of each thread. The kernel accumulates the
+  cycle counter into each thread's statistics on every context switch,
+  so the load is the share of the cycles since the last update
+*/
+void Util::update_thread_stats(void)
+{
+    thread_sample samples[HAL_THREAD_STATS_MAX];
+    rttime_t delta[HAL_THREAD_STATS_MAX];
+    rttime_t total = 0;
+    uint8_t n = 0;
+
+    WITH_SEMAPHORE(_thread_stats_sem);
+
+    for (thread_t *tp = chRegFirstThread(); tp != nullptr; tp = chRegNextThread(tp)) {
+        if (n >= ARRAY_SIZE(samples)) {
+            // keep walking the registry so the references are released
+            continue;
+        }
+        thread_sample &s = samples[n];
+        s.tp = tp;
+        chSysLock();
+        s.run_time = tp->stats.cumulative;
+        chSysUnlock();
+
+        // threads seen at the last update only count the time since then
+        delta[n] = s.run_time;
+        for (uint8_t i=0; i<_num_thread_samples; i++) {
+            if (_thread_samples[i].tp == tp) {
+                delta[n] = s.run_time - _thread_samples[i].run_time;
+                break;
+            }
+        }
+        total += delta[n];
+
+        strncpy(s.stats.name, tp->name ? tp->name : "", sizeof(s.stats.name)-1);
+        s.stats.name[sizeof(s.stats.name)-1] = 0;
+
+        // the stack is filled at creation, so the untouched fill
+        // bytes above the stack base are the lowest free stack
+        const uint8_t *p = (const uint8_t *)tp->wabase;
+        while (*p == CH_DBG_STACK_FILL_VALUE) {
+            p++;
+        }
+        s.stats.stack_free = p - (const uint8_t *)tp->wabase;
+        s.stats.jitter_avg_us = 0;
+        s.stats.jitter_max_us = 0;
+        n++;
+    }
+
+    for (uint8_t i=0; i<n; i++) {
+        samples[i].stats.load = total ? (delta[i] * 1000U) / total : 0;
+    }
+    memcpy(_thread_samples, samples, n * sizeof(samples[0]));
+    _num_thread_samples = n;
+}
+#endif // HAL_THREAD_STATS_ENABLED
+
 /*
     Special Allocation Routines
 */
 
-void* Util::malloc_type(size_t size, AP_HAL::Util::Memory_Type mem_type)
+void* Util::_malloc_type(size_t size, AP_HAL::Util::Memory_Type mem_type)
 {
     if (mem_type == AP_HAL::Util::MEM_DMA_SAFE) {
-        return malloc_dma(size);
+        return malloc_pooled(size, MALLOC_POOL_DMA);
     } else if (mem_type == AP_HAL::Util::MEM_FAST) {
-        return malloc_fastmem(size);
+        return malloc_pooled(size, MALLOC_POOL_FAST);
     } else {
         return calloc(1, size);
     }
 }
 
-void Util::free_type(void *ptr, size_t size, AP_HAL::Util::Memory_Type mem_type)
+void Util::_free_type(void *ptr, size_t size, AP_HAL::Util::Memory_Type mem_type)
 {
-    if (ptr != NULL) {
-        chHeapFree(ptr);
-    }
+    // free() returns pooled objects to their pool
+    free(ptr);
+}
+
+/*
+  allocation statistics of the pools and heaps for a memory type
+ */
+bool Util::get_memory_stats(AP_HAL::Util::Memory_Type mem_type, MemoryStats &stats)
+{
+    struct malloc_pool_stats s;
+    malloc_pool_stats(mem_type == AP_HAL::Util::MEM_DMA_SAFE ? MALLOC_POOL_DMA : MALLOC_POOL_FAST, &s);
+    stats.allocated = s.allocated;
+    stats.peak = s.peak;
+    stats.arena_free = s.arena_free;
+    stats.pool_allocs = s.pool_allocs;
+    stats.heap_allocs = s.heap_allocs;
+    stats.failures = s.failures;
+    stats.heap_free = s.heap_free;
+    stats.heap_largest = s.heap_largest;
+    return true;
 }
 
 
@@ -73,17 +176,7 @@ void Util::free_type(void *ptr, size_t size, AP_HAL::Util::Memory_Type mem_type)
 
 void *Util::allocate_heap_memory(size_t size)
 {
-    void *buf = malloc(size);
-    if (buf == nullptr) {
-        return nullptr;
-    }
-
-    memory_heap_t *heap = (memory_heap_t *)malloc(sizeof(memory_heap_t));
-    if (heap != nullptr) {
-        chHeapObjectInit(heap, buf, size);
-    }
-
-    return heap;
+    return TLSFHeap::create(size);
 }
 
 /*
@@ -111,21 +204,16 @@ void *Util::heap_realloc(void *heap, void *ptr, size_t new_size)
     if (heap == nullptr) {
         return nullptr;
     }
-    if (new_size == 0) {
-        if (ptr != nullptr) {
-            chHeapFree(ptr);
-        }
-        return nullptr;
-    }
-    if (ptr == nullptr) {
-        return chHeapAlloc((memory_heap_t *)heap, new_size);
-    }
-    void *new_mem = chHeapAlloc((memory_heap_t *)heap, new_size);
-    if (new_mem != nullptr) {
-        memcpy(new_mem, ptr, chHeapGetSize(ptr) > new_size ? new_size : chHeapGetSize(ptr));
-        chHeapFree(ptr);
+    return ((TLSFHeap *)heap)->reallocate(ptr, new_size);
+}
+
+bool Util::get_heap_stats(void *heap, HeapStats &stats)
+{
+    if (heap == nullptr) {
+        return false;
     }
-    return new_mem;
+    ((TLSFHeap *)heap)->get_stats(stats);
+    return true;
 }
 #endif // ENABLE_HEAP
 
@@ -19,8 +19,19 @@
 #include <AP_HAL/AP_HAL.h>
 #include "AP_HAL_ChibiOS_Namespace.h"
 #include "AP_HAL_ChibiOS.h"
+#include "Semaphores.h"
 #include <ch.h>
 
+// per-thread CPU load uses the kernel's context switch statistics
+#ifndef HAL_THREAD_STATS_ENABLED
+#define HAL_THREAD_STATS_ENABLED (CH_DBG_STATISTICS == TRUE && CH_CFG_USE_REGISTRY == TRUE && CH_DBG_FILL_THREADS == TRUE)
+#endif
+
+// maximum number of threads tracked
+#ifndef HAL_THREAD_STATS_MAX
+#define HAL_THREAD_STATS_MAX 24
+#endif
+
 class ChibiOS::Util : public AP_HAL::Util {
 public:
     static Util *from(AP_HAL::Util *util) {
@@ -30,14 +41,23 @@ public:
     bool run_debug_shell(AP_HAL::BetterStream *stream) override { return false; }
     uint32_t available_memory() override;
 
+    bool get_dma_stats(uint8_t stream_id, DMAStats &stats) override;
+
+#if HAL_THREAD_STATS_ENABLED
+    bool get_thread_stats(uint8_t idx, ThreadStats &stats) override;
+
+    // sample the run time of each thread, called once a second by the monitor thread
+    void update_thread_stats(void);
+#endif
+
     // Special Allocation Routines
-    void *malloc_type(size_t size, AP_HAL::Util::Memory_Type mem_type) override;
-    void free_type(void *ptr, size_t size, AP_HAL::Util::Memory_Type mem_type) override;
+    bool get_memory_stats(AP_HAL::Util::Memory_Type mem_type, MemoryStats &stats) override;
 
 #ifdef ENABLE_HEAP
     // heap functions, note that a heap once alloc'd cannot be dealloc'd
     virtual void *allocate_heap_memory(size_t size) override;
     virtual void *heap_realloc(void *heap, void *ptr, size_t new_size) override;
+    bool get_heap_stats(void *heap, HeapStats &stats) override;
     virtual void *std_realloc(void *ptr, size_t new_size) override;
 #endif // ENABLE_HEAP
 
@@ -65,6 +85,10 @@ public:
     // return true if the reason for the reboot was a watchdog reset
     bool was_watchdog_reset() const override;
 
+protected:
+    void *_malloc_type(size_t size, AP_HAL::Util::Memory_Type mem_type) override;
+    void _free_type(void *ptr, size_t size, AP_HAL::Util::Memory_Type mem_type) override;
+
 private:
 #ifdef HAL_PWM_ALARM
     struct ToneAlarmPwmGroup {
@@ -93,6 +117,19 @@ private:
     static memory_heap_t scripting_heap;
 #endif // ENABLE_HEAP
 
+#if HAL_THREAD_STATS_ENABLED
+    // run time of each thread at the last update, with the load and
+    // stack usage worked out from it
+    struct thread_sample {
+        const thread_t *tp;
+        rttime_t run_time;
+        ThreadStats stats;
+    };
+    thread_sample _thread_samples[HAL_THREAD_STATS_MAX];
+    uint8_t _num_thread_samples;
+    HAL_Semaphore _thread_stats_sem;
+#endif
+
     // stm32F4 and F7 have 20 total RTC backup registers. We use the first one for boot type
     // flags, so 19 available for persistent data
     static_assert(sizeof(persistent_data) <= 19*4, "watchdog persistent data too large");
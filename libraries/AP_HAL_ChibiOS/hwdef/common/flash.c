@@ -127,6 +127,17 @@ static const uint32_t flash_memmap[STM32_FLASH_NPAGES] = { KB(32), KB(32), KB(32
 #error "Unsupported processor for flash.c"
 #endif
 
+/*
+  first page of the second bank on parts which can read from one bank
+  while erasing the other. The 2MB F42x/F43x are always dual bank, the
+  F76x only when nDBANK is programmed so it is not included here
+ */
+#if defined(STM32H7) && BOARD_FLASH_SIZE > 1024
+#define STM32_FLASH_BANK2_FIRST_PAGE 8
+#elif defined(STM32F4) && BOARD_FLASH_SIZE == 2048
+#define STM32_FLASH_BANK2_FIRST_PAGE 12
+#endif
+
 #if defined(__GNUC__) && __GNUC__ >= 6
 #ifdef STORAGE_FLASH_PAGE
 static_assert(STORAGE_FLASH_PAGE < STM32_FLASH_NPAGES,
@@ -335,17 +346,16 @@ bool stm32_flash_ispageerased(uint32_t page)
 }
 
 /*
-  erase a page
+  start erasing a page without waiting for the erase to complete. The
+  caller must wait for stm32_flash_erase_busy() to return false then
+  call stm32_flash_erasepage_finish()
  */
-bool stm32_flash_erasepage(uint32_t page)
+bool stm32_flash_erasepage_start(uint32_t page)
 {
     if (page >= STM32_FLASH_NPAGES) {
         return false;
     }
 
-#if STM32_FLASH_DISABLE_ISR
-    syssts_t sts = chSysGetStatusAndLockX();
-#endif
     stm32_flash_wait_idle();
     stm32_flash_unlock();
 
@@ -364,7 +374,6 @@ bool stm32_flash_erasepage(uint32_t page)
         // use 32 bit operations
         FLASH->CR1 = FLASH_CR_PSIZE_1 | snb | FLASH_CR_SER;
         FLASH->CR1 |= FLASH_CR_START;
-        while (FLASH->SR1 & FLASH_SR_QW) ;
     } else {
         // second bank
         FLASH->SR2 = ~0;
@@ -376,7 +385,6 @@ bool stm32_flash_erasepage(uint32_t page)
         // use 32 bit operations
         FLASH->CR2 = FLASH_CR_PSIZE_1 | snb | FLASH_CR_SER;
         FLASH->CR2 |= FLASH_CR_START;
-        while (FLASH->SR2 & FLASH_SR_QW) ;
     }
 #elif defined(STM32F1) || defined(STM32F3)
     FLASH->CR = FLASH_CR_PER;
@@ -392,16 +400,75 @@ bool stm32_flash_erasepage(uint32_t page)
 #else
 #error "Unsupported MCU"
 #endif
+    return true;
+}
+
+/*
+  return true if a flash operation is still in progress
+ */
+bool stm32_flash_erase_busy(void)
+{
+    __DSB();
+#if defined(STM32H7)
+    return (FLASH->SR1 & (FLASH_SR_BSY|FLASH_SR_QW|FLASH_SR_WBNE)) ||
+           (FLASH->SR2 & (FLASH_SR_BSY|FLASH_SR_QW|FLASH_SR_WBNE));
+#else
+    return (FLASH->SR & FLASH_SR_BSY) != 0;
+#endif
+}
 
+/*
+  complete an erase started with stm32_flash_erasepage_start()
+ */
+bool stm32_flash_erasepage_finish(uint32_t page)
+{
     stm32_flash_wait_idle();
 
     stm32_cacheBufferInvalidate((void*)stm32_flash_getpageaddr(page), stm32_flash_getpagesize(page));
 
     stm32_flash_lock();
+    return stm32_flash_ispageerased(page);
+}
+
+/*
+  erase a page
+ */
+bool stm32_flash_erasepage(uint32_t page)
+{
+    if (page >= STM32_FLASH_NPAGES) {
+        return false;
+    }
+
+#if STM32_FLASH_DISABLE_ISR
+    syssts_t sts = chSysGetStatusAndLockX();
+#endif
+    bool ret = stm32_flash_erasepage_start(page) &&
+               stm32_flash_erasepage_finish(page);
 #if STM32_FLASH_DISABLE_ISR
     chSysRestoreStatusX(sts);
 #endif
-    return stm32_flash_ispageerased(page);
+    return ret;
+}
+
+/*
+  return true if a page can be erased or written without stalling the
+  CPU. On single bank parts any access to flash stalls until an erase
+  completes, which includes fetching code and interrupt vectors, so
+  this is only possible when the page is in a different bank from all
+  of the firmware
+ */
+bool stm32_flash_background_erase_ok(uint32_t page)
+{
+#ifdef STM32_FLASH_BANK2_FIRST_PAGE
+    // end of the code and read-only data, from the linker script
+    extern const uint8_t _etext;
+    return page >= STM32_FLASH_BANK2_FIRST_PAGE &&
+           page < STM32_FLASH_NPAGES &&
+           (uint32_t)&_etext <= stm32_flash_getpageaddr(STM32_FLASH_BANK2_FIRST_PAGE);
+#else
+    (void)page;
+    return false;
+#endif
 }
 
 
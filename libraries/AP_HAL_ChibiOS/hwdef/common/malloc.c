@@ -66,6 +66,48 @@ static memory_heap_t heaps[NUM_MEMORY_REGIONS];
 static memory_heap_t dma_reserve_heap;
 #endif
 
+/*
+  size of the arena for each pooled memory type. Small allocations
+  of DMA safe and fast memory come from power of two size classes
+  carved out of these arenas and are recycled on free, so repeated
+  allocation and freeing does not fragment the heaps
+ */
+#ifndef MALLOC_POOL_ARENA_SIZE
+#if HAL_MEMORY_TOTAL_KB >= 500
+#define MALLOC_POOL_ARENA_SIZE 8192
+#else
+#define MALLOC_POOL_ARENA_SIZE 0
+#endif
+#endif
+
+#if MALLOC_POOL_ARENA_SIZE != 0
+// the arena is split into pages, each holding objects of one size class
+#define MALLOC_POOL_PAGE_SIZE 512
+#define MALLOC_POOL_NUM_PAGES (MALLOC_POOL_ARENA_SIZE/MALLOC_POOL_PAGE_SIZE)
+#define MALLOC_POOL_MIN_SIZE 32
+#define MALLOC_POOL_NUM_CLASSES 5
+
+struct pool_object {
+    struct pool_object *next;
+};
+
+static struct malloc_pool {
+    uint8_t *arena;
+    uint8_t page_class[MALLOC_POOL_NUM_PAGES];
+    uint8_t pages_used;
+    struct pool_object *free_list[MALLOC_POOL_NUM_CLASSES];
+    struct malloc_pool_stats stats;
+} pools[MALLOC_POOL_NUM];
+#endif // MALLOC_POOL_ARENA_SIZE
+
+// region flags needed by each pooled memory type
+static const uint32_t pool_flags[MALLOC_POOL_NUM] = {
+    MEM_REGION_FLAG_DMA_OK,
+    MEM_REGION_FLAG_FAST,
+};
+
+static void *malloc_flags(size_t size, uint32_t flags);
+
 /*
   initialise memory handling
  */
@@ -91,6 +133,16 @@ void malloc_init(void)
         reserve_size = (reserve_size * 7) / 8;
     }
 #endif
+
+#if MALLOC_POOL_ARENA_SIZE != 0
+    // arenas are allocated at boot so pooled allocations can't fail late
+    for (i=0; i<MALLOC_POOL_NUM; i++) {
+        pools[i].arena = malloc_flags(MALLOC_POOL_ARENA_SIZE, pool_flags[i]);
+        if (pools[i].arena != NULL) {
+            pools[i].stats.arena_free = MALLOC_POOL_ARENA_SIZE;
+        }
+    }
+#endif
 }
 
 static void *malloc_flags(size_t size, uint32_t flags)
@@ -211,9 +263,144 @@ void *calloc(size_t nmemb, size_t size)
     return malloc(nmemb * size);
 }
 
+#if MALLOC_POOL_ARENA_SIZE != 0
+/*
+  allocate from the size class pool of the given memory type, carving
+  a new page for the class out of the arena if its free list is empty
+ */
+static void *pool_alloc(struct malloc_pool *pool, size_t size)
+{
+    uint8_t c = 0;
+    uint32_t obj_size = MALLOC_POOL_MIN_SIZE;
+    while (obj_size < size) {
+        if (++c == MALLOC_POOL_NUM_CLASSES) {
+            return NULL;
+        }
+        obj_size <<= 1;
+    }
+    chSysLock();
+    struct pool_object *obj = pool->free_list[c];
+    if (obj == NULL && pool->pages_used < MALLOC_POOL_NUM_PAGES) {
+        // carve a new page into objects of this class
+        const uint8_t page = pool->pages_used++;
+        pool->page_class[page] = c;
+        uint8_t *base = &pool->arena[page * MALLOC_POOL_PAGE_SIZE];
+        for (uint32_t ofs = MALLOC_POOL_PAGE_SIZE; ofs >= obj_size; ofs -= obj_size) {
+            struct pool_object *o = (struct pool_object *)&base[ofs - obj_size];
+            o->next = pool->free_list[c];
+            pool->free_list[c] = o;
+        }
+        obj = pool->free_list[c];
+    }
+    if (obj != NULL) {
+        pool->free_list[c] = obj->next;
+        pool->stats.allocated += obj_size;
+        pool->stats.arena_free -= obj_size;
+        if (pool->stats.allocated > pool->stats.peak) {
+            pool->stats.peak = pool->stats.allocated;
+        }
+    }
+    chSysUnlock();
+    if (obj != NULL) {
+        memset(obj, 0, obj_size);
+    }
+    return obj;
+}
+
+/*
+  return an object to its pool. Returns false if ptr is not in any arena
+ */
+static bool pool_free(void *ptr)
+{
+    for (uint8_t i=0; i<MALLOC_POOL_NUM; i++) {
+        struct malloc_pool *pool = &pools[i];
+        if (pool->arena == NULL ||
+            (uint8_t *)ptr < pool->arena ||
+            (uint8_t *)ptr >= pool->arena + MALLOC_POOL_ARENA_SIZE) {
+            continue;
+        }
+        const uint8_t c = pool->page_class[((uint8_t *)ptr - pool->arena) / MALLOC_POOL_PAGE_SIZE];
+        const uint32_t obj_size = MALLOC_POOL_MIN_SIZE << c;
+        struct pool_object *obj = (struct pool_object *)ptr;
+        chSysLock();
+        obj->next = pool->free_list[c];
+        pool->free_list[c] = obj;
+        pool->stats.allocated -= obj_size;
+        pool->stats.arena_free += obj_size;
+        chSysUnlock();
+        return true;
+    }
+    return false;
+}
+#endif // MALLOC_POOL_ARENA_SIZE
+
+/*
+  allocate memory of the given type, using the size class pools for
+  small allocations and the heaps for everything else
+ */
+void *malloc_pooled(size_t size, enum malloc_pool_type type)
+{
+    if (size == 0 || type >= MALLOC_POOL_NUM) {
+        return NULL;
+    }
+#if MALLOC_POOL_ARENA_SIZE != 0
+    struct malloc_pool *pool = &pools[type];
+    if (pool->arena != NULL) {
+        void *p = pool_alloc(pool, size);
+        if (p != NULL) {
+            pool->stats.pool_allocs++;
+            return p;
+        }
+    }
+#endif
+    void *p = malloc_flags(size, pool_flags[type]);
+#if MALLOC_POOL_ARENA_SIZE != 0
+    if (p != NULL) {
+        pool->stats.heap_allocs++;
+    } else {
+        pool->stats.failures++;
+    }
+#endif
+    return p;
+}
+
+/*
+  get allocation statistics for a memory type, including the free
+  space and largest free block of the heaps that can hold it
+ */
+void malloc_pool_stats(enum malloc_pool_type type, struct malloc_pool_stats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if (type >= MALLOC_POOL_NUM) {
+        return;
+    }
+#if MALLOC_POOL_ARENA_SIZE != 0
+    chSysLock();
+    *stats = pools[type].stats;
+    chSysUnlock();
+#endif
+    uint8_t i;
+    for (i=0; i<NUM_MEMORY_REGIONS; i++) {
+        if (!(memory_regions[i].flags & pool_flags[type])) {
+            continue;
+        }
+        size_t total = 0, largest = 0;
+        chHeapStatus(i == 0 ? NULL : &heaps[i], &total, &largest);
+        stats->heap_free += total;
+        if (largest > stats->heap_largest) {
+            stats->heap_largest = largest;
+        }
+    }
+}
+
 void free(void *ptr)
 {
     if(ptr != NULL) {
+#if MALLOC_POOL_ARENA_SIZE != 0
+        if (pool_free(ptr)) {
+            return;
+        }
+#endif
         chHeapFree(ptr);
     }
 }
@@ -35,6 +35,27 @@ void *malloc_sdcard_dma(size_t size);
 void *malloc_fastmem(size_t size);
 thread_t *thread_create_alloc(size_t size, const char *name, tprio_t prio, tfunc_t pf, void *arg);
 
+// memory types with size class pools, matching AP_HAL::Util::Memory_Type
+enum malloc_pool_type {
+    MALLOC_POOL_DMA = 0,
+    MALLOC_POOL_FAST = 1,
+    MALLOC_POOL_NUM
+};
+
+struct malloc_pool_stats {
+    uint32_t allocated;         // bytes of pool objects in use
+    uint32_t peak;              // highest value of allocated
+    uint32_t arena_free;        // bytes of the arena not in use
+    uint32_t pool_allocs;       // allocations served by the pools
+    uint32_t heap_allocs;       // allocations that fell back to the heaps
+    uint32_t failures;          // allocations that failed
+    uint32_t heap_free;         // free bytes in heaps able to hold this type
+    uint32_t heap_largest;      // largest free block in those heaps
+};
+
+void *malloc_pooled(size_t size, enum malloc_pool_type type);
+void malloc_pool_stats(enum malloc_pool_type type, struct malloc_pool_stats *stats);
+
 // flush all dcache
 void memory_flush_all(void);
     
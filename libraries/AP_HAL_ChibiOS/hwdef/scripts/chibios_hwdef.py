@@ -1410,6 +1410,7 @@ def write_PWM_config(f):
         f.write('#define STM32_TIM%u_SUPPRESS_ISR\n' % n)
     f.write('\n')
     f.write('// PWM output config\n')
+    f.write('#define HAL_PWM_IC_DMA_NONE { false, 0, 0 }\n')
     groups = []
     have_complementary = False
     for t in sorted(pwm_timers):
@@ -1422,6 +1423,7 @@ def write_PWM_config(f):
         ]
         alt_functions = [0, 0, 0, 0]
         pal_lines = ['0', '0', '0', '0']
+        ic_dma = ['HAL_PWM_IC_DMA_NONE'] * 4
         for p in pwm_out:
             if p.type != t:
                 continue
@@ -1435,6 +1437,13 @@ def write_PWM_config(f):
                 chan_mode[chan - 1] = 'PWM_OUTPUT_ACTIVE_HIGH'
             alt_functions[chan - 1] = p.af
             pal_lines[chan - 1] = 'PAL_LINE(GPIO%s, %uU)' % (p.port, p.pin)
+            if p.has_extra('BIDIR') and not compl:
+                ic_dma[chan - 1] = 'HAL_PWM%u_CH%u_IC_DMA_CONFIG' % (n, chan)
+                f.write('''#if defined(STM32_TIM_TIM%u_CH%u_DMA_STREAM) && defined(STM32_TIM_TIM%u_CH%u_DMA_CHAN)
+# define HAL_PWM%u_CH%u_IC_DMA_CONFIG { true, STM32_TIM_TIM%u_CH%u_DMA_STREAM, STM32_TIM_TIM%u_CH%u_DMA_CHAN }
+#else
+# define HAL_PWM%u_CH%u_IC_DMA_CONFIG HAL_PWM_IC_DMA_NONE
+#endif\n''' % (n, chan, n, chan, n, chan, n, chan, n, chan, n, chan))
         groups.append('HAL_PWM_GROUP%u' % group)
         if n in [1, 8]:
             # only the advanced timers do 8MHz clocks
@@ -1464,6 +1473,7 @@ def write_PWM_config(f):
           }, 0, 0}, &PWMD%u, \\
           HAL_PWM%u_DMA_CONFIG, \\
           { %u, %u, %u, %u }, \\
+          { %s, %s, %s, %s }, \\
           { %s, %s, %s, %s }}\n''' %
                 (group, advanced_timer,
                  chan_list[0], chan_list[1], chan_list[2], chan_list[3],
@@ -1471,7 +1481,8 @@ def write_PWM_config(f):
                  chan_mode[0], chan_mode[1], chan_mode[2], chan_mode[3],
                  n, n,
                  alt_functions[0], alt_functions[1], alt_functions[2], alt_functions[3],
-                 pal_lines[0], pal_lines[1], pal_lines[2], pal_lines[3]))
+                 pal_lines[0], pal_lines[1], pal_lines[2], pal_lines[3],
+                 ic_dma[0], ic_dma[1], ic_dma[2], ic_dma[3]))
     f.write('#define HAL_PWM_GROUPS %s\n\n' % ','.join(groups))
     if have_complementary:
         f.write('#define STM32_PWM_USE_ADVANCED TRUE\n')
@@ -1836,6 +1847,14 @@ def build_peripheral_list():
                 label = type + '_UP'
                 if label not in peripherals and not p.has_extra('NODMA'):
                     peripherals.append(label)
+                # bidirectional DShot reads the eRPM back by input
+                # capture DMA on the channel itself
+                if p.has_extra('BIDIR') and not p.has_extra('NODMA'):
+                    label = p.label
+                    if label[-1] == 'N':
+                        label = label[:-1]
+                    if label not in peripherals:
+                        peripherals.append(label)
         done.add(type)
     return peripherals
 
@@ -15,6 +15,7 @@
  * Code by Andrew Tridgell and Siddharth Bharat Purohit
  */
 #include "shared_dma.h"
+#include <AP_Math/AP_Math.h>
 
 /*
   code to handle sharing of DMA channels between peripherals
@@ -43,6 +44,7 @@ Shared_DMA::Shared_DMA(uint8_t _stream_id1,
     stream_id2 = _stream_id2;
     allocate = _allocate;
     deallocate = _deallocate;
+    priority = Priority::NORMAL;
 }
 
 //remove any assigned deallocator or allocator
@@ -62,11 +64,72 @@ void Shared_DMA::unregister()
 }
 
 // lock one stream
-void Shared_DMA::lock_stream(uint8_t stream_id)
+void Shared_DMA::lock_stream(uint8_t stream_id, Priority priority)
 {
-    if (stream_id < SHARED_DMA_MAX_STREAM_ID) {
-        chBSemWait(&locks[stream_id].semaphore);
+    if (stream_id >= SHARED_DMA_MAX_STREAM_ID) {
+        return;
+    }
+    dma_lock &l = locks[stream_id];
+    if (chBSemWaitTimeout(&l.semaphore, TIME_IMMEDIATE) == MSG_OK) {
+        record_wait(stream_id, 0);
+        return;
+    }
+
+    // someone else has the stream, time how long we wait for it
+    const uint32_t start_us = AP_HAL::micros();
+#if HAL_SHARED_DMA_PRIORITY
+    const bool high = (priority == Priority::HIGH);
+    if (high) {
+        chSysLock();
+        l.high_waiting++;
+        chSysUnlock();
+    }
+#endif
+    chBSemWait(&l.semaphore);
+#if HAL_SHARED_DMA_PRIORITY
+    if (high) {
+        chSysLock();
+        l.high_waiting--;
+        chSysUnlock();
+    }
+#endif
+    record_wait(stream_id, AP_HAL::micros() - start_us);
+}
+
+/*
+  record the time taken to get a stream. Called with the stream locked,
+  so the statistics are only ever updated by one thread at a time. The
+  histogram uses the same log2 buckets as the scheduler task histograms
+ */
+void Shared_DMA::record_wait(uint8_t stream_id, uint32_t wait_us)
+{
+    AP_HAL::Util::DMAStats &stats = locks[stream_id].stats;
+    stats.lock_count++;
+    if (wait_us != 0) {
+        stats.contended_count++;
+    }
+    if (wait_us > stats.max_wait_us) {
+        stats.max_wait_us = wait_us;
     }
+    const uint8_t bin = wait_us == 0 ? 0 : MIN(32 - __builtin_clz(wait_us), AP_HAL::Util::DMAStats::WAIT_BINS-1);
+    if (stats.wait_hist[bin] == UINT16_MAX) {
+        for (uint8_t i=0; i<AP_HAL::Util::DMAStats::WAIT_BINS; i++) {
+            stats.wait_hist[i] /= 2;
+        }
+    }
+    stats.wait_hist[bin]++;
+}
+
+// get a copy of the statistics of one stream
+bool Shared_DMA::get_stats(uint8_t stream_id, AP_HAL::Util::DMAStats &stats)
+{
+    if (stream_id >= SHARED_DMA_MAX_STREAM_ID) {
+        return false;
+    }
+    chSysLock();
+    stats = locks[stream_id].stats;
+    chSysUnlock();
+    return true;
 }
 
 // unlock one stream
@@ -88,9 +151,26 @@ void Shared_DMA::unlock_stream_from_IRQ(uint8_t stream_id)
 // lock one stream, non-blocking
 bool Shared_DMA::lock_stream_nonblocking(uint8_t stream_id)
 {
-    if (stream_id < SHARED_DMA_MAX_STREAM_ID) {
-        return chBSemWaitTimeout(&locks[stream_id].semaphore, 1) == MSG_OK;
+    if (stream_id >= SHARED_DMA_MAX_STREAM_ID) {
+        return true;
+    }
+#if HAL_SHARED_DMA_PRIORITY
+    if (priority == Priority::LOW) {
+        // give way to any high priority user waiting for the stream,
+        // and don't queue behind the current holder
+        if (locks[stream_id].high_waiting != 0 ||
+            chBSemWaitTimeout(&locks[stream_id].semaphore, TIME_IMMEDIATE) != MSG_OK) {
+            return false;
+        }
+        record_wait(stream_id, 0);
+        return true;
+    }
+#endif
+    const uint32_t start_us = AP_HAL::micros();
+    if (chBSemWaitTimeout(&locks[stream_id].semaphore, 1) != MSG_OK) {
+        return false;
     }
+    record_wait(stream_id, AP_HAL::micros() - start_us);
     return true;
 }
 
@@ -136,8 +216,8 @@ void Shared_DMA::lock_core(void)
 // lock the DMA channels, blocking method
 void Shared_DMA::lock(void)
 {
-    lock_stream(stream_id1);
-    lock_stream(stream_id2);
+    lock_stream(stream_id1, priority);
+    lock_stream(stream_id2, priority);
     lock_core();
 }
 
@@ -146,6 +226,7 @@ bool Shared_DMA::lock_nonblock(void)
 {
     if (!lock_stream_nonblocking(stream_id1)) {
         chSysDisable();
+        locks[stream_id1].stats.nonblock_fail_count++;
         if (locks[stream_id1].obj != nullptr && locks[stream_id1].obj != this) {
             locks[stream_id1].obj->contention = true;
         }
@@ -156,6 +237,7 @@ bool Shared_DMA::lock_nonblock(void)
     if (!lock_stream_nonblocking(stream_id2)) {
         unlock_stream(stream_id1);
         chSysDisable();
+        locks[stream_id2].stats.nonblock_fail_count++;
         if (locks[stream_id2].obj != nullptr && locks[stream_id2].obj != this) {
             locks[stream_id2].obj->contention = true;
         }
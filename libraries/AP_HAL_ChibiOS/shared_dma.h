@@ -23,12 +23,27 @@
 // DMA stream ID for stream_id2 when only one is needed
 #define SHARED_DMA_NONE 255
 
+// when enabled, LOW priority users give way to HIGH priority users that
+// are waiting for a stream, see Shared_DMA::set_priority()
+#ifndef HAL_SHARED_DMA_PRIORITY
+#define HAL_SHARED_DMA_PRIORITY 0
+#endif
+
 class ChibiOS::Shared_DMA
 {
 public:
     FUNCTOR_TYPEDEF(dma_allocate_fn_t, void, Shared_DMA *);
     FUNCTOR_TYPEDEF(dma_deallocate_fn_t, void, Shared_DMA *);
 
+    // arbitration priority. With HAL_SHARED_DMA_PRIORITY a LOW
+    // priority user fails lock_nonblock() while a HIGH priority user
+    // is waiting for the stream, and never queues on it
+    enum class Priority : uint8_t {
+        NORMAL,
+        HIGH,
+        LOW,
+    };
+
     // the use of two stream IDs is for support of peripherals that
     // need both a RX and TX DMA channel
     Shared_DMA(uint8_t stream_id1, uint8_t stream_id2,
@@ -65,12 +80,19 @@ public:
     // lock all shared DMA channels. Used on reboot
     static void lock_all(void);
 
+    void set_priority(Priority _priority) { priority = _priority; }
+
+    // get the lock statistics of a stream. Returns false if stream_id
+    // is out of range
+    static bool get_stats(uint8_t stream_id, AP_HAL::Util::DMAStats &stats);
+
 private:
     dma_allocate_fn_t allocate;
     dma_allocate_fn_t deallocate;
     uint8_t stream_id1;
     uint8_t stream_id2;
     bool have_lock;
+    Priority priority;
 
     // we set the contention flag if two drivers are fighting over a DMA channel.
     // the UART driver uses this to change its max transmit size to reduce latency
@@ -80,7 +102,10 @@ private:
     void lock_core(void);
 
     // lock one stream
-    static void lock_stream(uint8_t stream_id);
+    static void lock_stream(uint8_t stream_id, Priority priority = Priority::NORMAL);
+
+    // record the time taken to lock a stream
+    static void record_wait(uint8_t stream_id, uint32_t wait_us);
 
     // unlock one stream
     void unlock_stream(uint8_t stream_id);
@@ -102,5 +127,11 @@ private:
 
         // point to object that holds the allocation, if allocated
         Shared_DMA *obj;
+
+        // number of HIGH priority users blocked waiting for the stream
+        uint8_t high_waiting;
+
+        // lock statistics, see get_stats()
+        AP_HAL::Util::DMAStats stats;
     } locks[SHARED_DMA_MAX_STREAM_ID+1];
 };
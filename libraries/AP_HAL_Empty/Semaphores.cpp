@@ -25,3 +25,17 @@ bool Semaphore::take_nonblocking() {
         return false;
     }
 }
+
+bool BinarySemaphore::wait(uint32_t timeout_us) {
+    const bool ret = _pending;
+    _pending = false;
+    return ret;
+}
+
+bool BinarySemaphore::wait_blocking() {
+    return wait(0);
+}
+
+void BinarySemaphore::signal() {
+    _pending = true;
+}
@@ -44,6 +44,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FLOW_PX4_NEON 1
+#else
+#define FLOW_PX4_NEON 0
+#endif
+
 extern const AP_HAL::HAL& hal;
 
 using namespace Linux;
@@ -114,6 +121,73 @@ static inline uint32_t compute_diff(uint8_t *image, uint16_t offx, uint16_t offy
     return acc;
 }
 
+#if FLOW_PX4_NEON
+/* sum of the 8 lanes of a vector */
+static inline uint32_t sum_u16x8(uint16x8_t v)
+{
+    const uint64x2_t sum = vpaddlq_u32(vpaddlq_u16(v));
+    return (uint32_t)(vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1));
+}
+
+/* SAD of two 8x8 windows, one row of 8 pixels at a time */
+static inline uint32_t compute_sad_8x8_neon(const uint8_t *p1, const uint8_t *p2,
+                                            uint16_t row_size)
+{
+    uint16x8_t acc = vdupq_n_u16(0);
+
+    for (uint8_t j = 0; j < 8; j++) {
+        acc = vabal_u8(acc, vld1_u8(p1 + j*row_size), vld1_u8(p2 + j*row_size));
+    }
+    return sum_u16x8(acc);
+}
+
+/* mean of four rows of 8 pixels, rounded down as in the scalar code */
+static inline uint8x8_t mean4_u8(uint8x8_t a, uint8x8_t b, uint8x8_t c, uint8x8_t d)
+{
+    return vshrn_n_u16(vaddq_u16(vaddl_u8(a, b), vaddl_u8(c, d)), 2);
+}
+
+/* subpixel SADs of two 8x8 windows. p2 points at the window in
+ * image2 and may be read one pixel beyond it on every side */
+static inline void compute_subpixel_8x8_neon(const uint8_t *p1, const uint8_t *p2,
+                                             uint32_t *acc, uint16_t row_size)
+{
+    uint16x8_t sum[8];
+
+    for (uint8_t k = 0; k < 8; k++) {
+        sum[k] = vdupq_n_u16(0);
+    }
+
+    for (uint8_t j = 0; j < 8; j++) {
+        const uint8_t *row = p2 + j*row_size;
+        const uint8x8_t base = vld1_u8(p1 + j*row_size);
+        const uint8x8_t x = vld1_u8(row);
+        const uint8x8_t right = vld1_u8(row + 1);
+        const uint8x8_t left = vld1_u8(row - 1);
+        const uint8x8_t up = vld1_u8(row - row_size);
+        const uint8x8_t up_right = vld1_u8(row - row_size + 1);
+        const uint8x8_t up_left = vld1_u8(row - row_size - 1);
+        const uint8x8_t down = vld1_u8(row + row_size);
+        const uint8x8_t down_right = vld1_u8(row + row_size + 1);
+        const uint8x8_t down_left = vld1_u8(row + row_size - 1);
+
+        /* same positions as the scalar compute_subpixel() */
+        sum[0] = vabal_u8(sum[0], base, vhadd_u8(x, right));
+        sum[1] = vabal_u8(sum[1], base, mean4_u8(x, right, down, down_right));
+        sum[2] = vabal_u8(sum[2], base, vhadd_u8(x, down_right));
+        sum[3] = vabal_u8(sum[3], base, mean4_u8(x, left, down_left, down));
+        sum[4] = vabal_u8(sum[4], base, vhadd_u8(x, down_left));
+        sum[5] = vabal_u8(sum[5], base, mean4_u8(x, left, up_left, up));
+        sum[6] = vabal_u8(sum[6], base, vhadd_u8(x, up));
+        sum[7] = vabal_u8(sum[7], base, mean4_u8(x, right, up, up_right));
+    }
+
+    for (uint8_t k = 0; k < 8; k++) {
+        acc[k] = sum_u16x8(sum[k]);
+    }
+}
+#endif
+
 /**
  * @brief Compute SAD of two pixel windows.
  *
@@ -137,6 +211,12 @@ static inline uint32_t compute_sad(uint8_t *image1, uint8_t *image2,
     unsigned int i,j;
     uint32_t acc = 0;
 
+#if FLOW_PX4_NEON
+    if (window_size == 8) {
+        return compute_sad_8x8_neon(&image1[off1], &image2[off2], row_size);
+    }
+#endif
+
     for (i = 0; i < window_size; i++) {
         for (j = 0; j < window_size; j++) {
             acc += abs(image1[off1 + i + j*row_size] -
@@ -169,6 +249,13 @@ static inline uint32_t compute_subpixel(uint8_t *image1, uint8_t *image2,
     uint8_t sub[8];
     uint16_t i, j, k;
 
+#if FLOW_PX4_NEON
+    if (window_size == 8) {
+        compute_subpixel_8x8_neon(&image1[off1], &image2[off2], acc, row_size);
+        return 0;
+    }
+#endif
+
     memset(acc, 0, window_size * sizeof(uint32_t));
 
     for (i = 0; i < window_size; i++) {
@@ -257,6 +257,9 @@ void _usage(void)
     printf("\tcustom terrain path:\n");
     printf("\t                   --terrain-directory /var/APM/terrain\n");
     printf("\t                   -t /var/APM/terrain\n");
+    printf("\tthread priority and CPU affinity (main, timer, uart, rcin, io, other):\n");
+    printf("\t                   --thread timer=18@2\n");
+    printf("\t                   -T main=@3 -T io=@0-1\n");
 #if AP_MODULE_SUPPORTED
     printf("\tmodule support:\n");
     printf("\t                   --module-directory %s\n", AP_MODULE_DEFAULT_DIRECTORY);
@@ -286,11 +289,12 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         {"terrain-directory",   true,  0, 't'},
         {"storage-directory",   true,  0, 's'},
         {"module-directory",    true,  0, 'M'},
+        {"thread",              true,  0, 'T'},
         {"help",                false,  0, 'h'},
         {0, false, 0, 0}
     };
 
-    GetOptLong gopt(argc, argv, "A:B:C:D:E:F:l:t:s:he:SM:",
+    GetOptLong gopt(argc, argv, "A:B:C:D:E:F:l:t:s:he:SM:T:",
                     options);
 
     /*
@@ -336,6 +340,12 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
             module_path = gopt.optarg;
             break;
 #endif
+        case 'T':
+            if (!schedulerInstance.set_thread_config(gopt.optarg)) {
+                printf("Invalid thread configuration '%s'\n", gopt.optarg);
+                exit(1);
+            }
+            break;
         case 'h':
             _usage();
             exit(0);
@@ -357,7 +367,7 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
     uartG->begin(115200);
     uartH->begin(115200);
     analogin->init();
-    utilInstance.init(argc+gopt.optind-1, &argv[gopt.optind-1]);
+    utilInstance.init(argc-gopt.optind+1, &argv[gopt.optind-1]);
 
     // NOTE: See commit 9f5b4ffca ("AP_HAL_Linux_Class: Correct
     // deadlock, and infinite loop in setup()") for details about the
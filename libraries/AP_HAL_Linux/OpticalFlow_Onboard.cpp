@@ -132,13 +132,19 @@ void OpticalFlow_Onboard::init()
             _camera_output_height = _height;
 
             /* we set these values here in order to the calculations be correct
-             * (such as PX4 init) even though we crop each frame later on. */
+             * (such as PX4 init) even though we crop each frame later on.
+             * The flow reads the cropped area in place, so the line length
+             * stays the camera's. */
             _width = HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH;
             _height = HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT;
-            _bytesperline = HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH;
         }
     }
 
+    if (_format == V4L2_PIX_FMT_YUYV && !_shrink_by_software) {
+        /* the flow reads the grey image converted from each frame */
+        _bytesperline = _crop_by_software ? _camera_output_width : _width;
+    }
+
     if (!_videoin->allocate_buffers(nbufs)) {
         AP_HAL::panic("OpticalFlow_Onboard: couldn't allocate video buffers");
     }
@@ -255,7 +261,12 @@ void OpticalFlow_Onboard::_run_optflow()
     uint32_t crop_left = 0, crop_top = 0;
     uint32_t shrink_scale = 0, shrink_width = 0, shrink_height = 0;
     uint32_t shrink_width_offset = 0, shrink_height_offset = 0;
-    uint8_t *convert_buffer = nullptr, *output_buffer = nullptr;
+    /* the flow works on the frame in the driver's buffer where it can.
+     * Frames which have to be converted or shrunk go into our own
+     * buffers instead, two of each as the flow needs the last image too */
+    uint8_t *convert_buffer[2] = {}, *output_buffer[2] = {};
+    uint8_t buffer_index = 0;
+    uint8_t *last_image = nullptr;
     uint8_t qual;
 
     if (_format == V4L2_PIX_FMT_YUYV) {
@@ -265,23 +276,23 @@ void OpticalFlow_Onboard::_run_optflow()
             convert_buffer_size = _width * _height;
         }
 
-        convert_buffer = (uint8_t *)calloc(1, convert_buffer_size);
-        if (!convert_buffer) {
-            AP_HAL::panic("OpticalFlow_Onboard: couldn't allocate conversion buffer\n");
+        for (uint8_t i = 0; i < 2; i++) {
+            convert_buffer[i] = (uint8_t *)calloc(1, convert_buffer_size);
+            if (!convert_buffer[i]) {
+                AP_HAL::panic("OpticalFlow_Onboard: couldn't allocate conversion buffer\n");
+            }
         }
     }
 
-    if (_shrink_by_software || _crop_by_software) {
+    if (_shrink_by_software) {
         output_buffer_size = HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH *
             HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT;
 
-        output_buffer = (uint8_t *)calloc(1, output_buffer_size);
-        if (!output_buffer) {
-            if (convert_buffer) {
-                free(convert_buffer);
+        for (uint8_t i = 0; i < 2; i++) {
+            output_buffer[i] = (uint8_t *)calloc(1, output_buffer_size);
+            if (!output_buffer[i]) {
+                AP_HAL::panic("OpticalFlow_Onboard: couldn't allocate shrink buffer\n");
             }
-
-            AP_HAL::panic("OpticalFlow_Onboard: couldn't allocate crop buffer\n");
         }
     }
 
@@ -309,49 +320,37 @@ void OpticalFlow_Onboard::_run_optflow()
     while(true) {
         /* wait for next frame to come */
         if (!_videoin->get_frame(video_frame)) {
-            if (convert_buffer) {
-               free(convert_buffer);
-            }
-
-            if (output_buffer) {
-               free(output_buffer);
-            }
-
             AP_HAL::panic("OpticalFlow_Onboard: couldn't get frame\n");
         }
 
-        if (_format == V4L2_PIX_FMT_YUYV) {
-            VideoIn::yuyv_to_grey((uint8_t *)video_frame.data,
-                convert_buffer_size * 2, convert_buffer);
+        uint8_t *image = (uint8_t *)video_frame.data;
 
-            memset(video_frame.data, 0, convert_buffer_size * 2);
-            memcpy(video_frame.data, convert_buffer, convert_buffer_size);
+        if (_format == V4L2_PIX_FMT_YUYV) {
+            VideoIn::yuyv_to_grey(image, convert_buffer_size * 2,
+                                  convert_buffer[buffer_index]);
+            image = convert_buffer[buffer_index];
         }
 
         if (_shrink_by_software) {
             /* shrink_8bpp() will shrink a selected area using the offsets,
              * therefore, we don't need the crop. */
-            VideoIn::shrink_8bpp((uint8_t *)video_frame.data, output_buffer,
+            VideoIn::shrink_8bpp(image, output_buffer[buffer_index],
                                  _camera_output_width, _camera_output_height,
                                  shrink_width_offset, shrink_width,
                                  shrink_height_offset, shrink_height,
                                  shrink_scale, shrink_scale);
-            memset(video_frame.data, 0, _camera_output_width * _camera_output_height);
-            memcpy(video_frame.data, output_buffer, output_buffer_size);
+            image = output_buffer[buffer_index];
         } else if (_crop_by_software) {
-            VideoIn::crop_8bpp((uint8_t *)video_frame.data, output_buffer,
-                               _camera_output_width,
-                               crop_left, HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH,
-                               crop_top, HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT);
-
-            memset(video_frame.data, 0, _camera_output_width * _camera_output_height);
-            memcpy(video_frame.data, output_buffer, output_buffer_size);
+            /* the flow reads the cropped area in place */
+            image += crop_top * _bytesperline + crop_left;
         }
+        buffer_index ^= 1;
 
         /* if it is at least the second frame we receive
          * since we have to compare 2 frames */
-        if (_last_video_frame.data == nullptr) {
+        if (last_image == nullptr) {
             _last_video_frame = video_frame;
+            last_image = image;
             continue;
         }
 
@@ -380,8 +379,7 @@ void OpticalFlow_Onboard::_run_optflow()
         /* compute gyro data and video frames
          * get flow rate to send it to the opticalflow driver
          */
-        qual = _flow->compute_flow((uint8_t*)_last_video_frame.data,
-                                   (uint8_t *)video_frame.data,
+        qual = _flow->compute_flow(last_image, image,
                                    video_frame.timestamp -
                                    _last_video_frame.timestamp,
                                    &flow_rate.x, &flow_rate.y);
@@ -408,15 +406,8 @@ void OpticalFlow_Onboard::_run_optflow()
         _videoin->put_frame(_last_video_frame);
         _last_integration_time = gyro_sample.time_us;
         _last_video_frame = video_frame;
+        last_image = image;
         _last_gyro_rate = gyro_sample.gyro;
     }
-
-    if (convert_buffer) {
-        free(convert_buffer);
-    }
-
-    if (output_buffer) {
-        free(output_buffer);
-    }
 }
 #endif
@@ -40,6 +40,27 @@ void Perf_Lttng::count(const char *name, uint64_t val)
     tracepoint(ardupilot, count, name, val);
 }
 
+void Perf_Lttng::trace(AP_HAL::Util::trace_event event, const char *name, uint32_t arg)
+{
+    switch (event) {
+    case AP_HAL::Util::TRACE_TASK_BEGIN:
+        tracepoint(ardupilot, task_begin, name, arg);
+        break;
+    case AP_HAL::Util::TRACE_TASK_END:
+        tracepoint(ardupilot, task_end, name, arg);
+        break;
+    case AP_HAL::Util::TRACE_GYRO_SAMPLE:
+        tracepoint(ardupilot, gyro_sample, arg);
+        break;
+    case AP_HAL::Util::TRACE_ACCEL_SAMPLE:
+        tracepoint(ardupilot, accel_sample, arg);
+        break;
+    case AP_HAL::Util::TRACE_RCOUT_PUSH:
+        tracepoint(ardupilot, rcout_push, arg);
+        break;
+    }
+}
+
 #else
 
 #include "Perf_Lttng.h"
@@ -49,5 +70,6 @@ using namespace Linux;
 void Perf_Lttng::begin(const char *name) { }
 void Perf_Lttng::end(const char *name) { }
 void Perf_Lttng::count(const char *name, uint64_t val) { }
+void Perf_Lttng::trace(AP_HAL::Util::trace_event event, const char *name, uint32_t arg) { }
 
 #endif
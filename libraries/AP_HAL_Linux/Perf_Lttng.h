@@ -16,6 +16,8 @@
 
 #include <inttypes.h>
 
+#include <AP_HAL/AP_HAL.h>
+
 #include "AP_HAL_Linux.h"
 
 namespace Linux {
@@ -25,6 +27,9 @@ public:
     void begin(const char *name);
     void end(const char *name);
     void count(const char *name, uint64_t val);
+
+    /* See AP_HAL::Util::trace() */
+    static void trace(AP_HAL::Util::trace_event event, const char *name, uint32_t arg);
 };
 
 }
@@ -59,6 +59,65 @@ TRACEPOINT_EVENT(
     )
 )
 
+TRACEPOINT_EVENT(
+    ardupilot,
+    task_begin,
+    TP_ARGS(
+        const char*, name_arg,
+        uint32_t, task_arg
+    ),
+    TP_FIELDS(
+        ctf_string(name_field, name_arg)
+        ctf_integer(uint32_t, task_field, task_arg)
+    )
+)
+
+TRACEPOINT_EVENT(
+    ardupilot,
+    task_end,
+    TP_ARGS(
+        const char*, name_arg,
+        uint32_t, task_arg
+    ),
+    TP_FIELDS(
+        ctf_string(name_field, name_arg)
+        ctf_integer(uint32_t, task_field, task_arg)
+    )
+)
+
+TRACEPOINT_EVENT(
+    ardupilot,
+    gyro_sample,
+    TP_ARGS(
+        uint32_t, instance_arg
+    ),
+    TP_FIELDS(
+        ctf_integer(uint32_t, instance_field, instance_arg)
+    )
+)
+
+TRACEPOINT_EVENT(
+    ardupilot,
+    accel_sample,
+    TP_ARGS(
+        uint32_t, instance_arg
+    ),
+    TP_FIELDS(
+        ctf_integer(uint32_t, instance_field, instance_arg)
+    )
+)
+
+TRACEPOINT_EVENT(
+    ardupilot,
+    rcout_push,
+    TP_ARGS(
+        uint32_t, seq_arg
+    ),
+    TP_FIELDS(
+        ctf_integer(uint32_t, seq_field, seq_arg)
+    )
+)
+
 #endif
 
 #include <lttng/tracepoint-event.h>
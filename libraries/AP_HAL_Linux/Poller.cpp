@@ -97,14 +97,14 @@ void Poller::unregister_pollable(const Pollable *p)
     }
 }
 
-int Poller::poll() const
+int Poller::poll(int timeout_ms) const
 {
     const int max_events = 16;
     epoll_event events[max_events];
     int r;
 
     do {
-        r = epoll_wait(_epfd, events, max_events, -1);
+        r = epoll_wait(_epfd, events, max_events, timeout_ms);
     } while (r < 0 && errno == EINTR);
 
     if (r < 0) {
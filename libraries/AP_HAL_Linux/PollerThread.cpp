@@ -23,8 +23,24 @@
 
 #include <AP_Math/AP_Math.h>
 
+/* period over which utilization is measured */
+#define POLLER_STATS_NSEC (5 * AP_NSEC_PER_SEC)
+
 namespace Linux {
 
+static uint64_t monotonic_nsec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * AP_NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static void nsec_to_timespec(uint64_t nsec, struct timespec &ts)
+{
+    ts.tv_sec = nsec / AP_NSEC_PER_SEC;
+    ts.tv_nsec = nsec % AP_NSEC_PER_SEC;
+}
+
 void TimerPollable::on_can_read()
 {
     if (_removeme) {
@@ -37,6 +53,8 @@ void TimerPollable::on_can_read()
         return;
     }
 
+    const uint64_t start_nsec = monotonic_nsec();
+
     if (_wrapper) {
         _wrapper->start_cb();
     }
@@ -46,9 +64,11 @@ void TimerPollable::on_can_read()
     if (_wrapper) {
         _wrapper->end_cb();
     }
+
+    _thread._stats.busy_nsec += monotonic_nsec() - start_nsec;
 }
 
-bool TimerPollable::setup_timer(uint32_t timeout_usec)
+bool TimerPollable::setup_timer(uint32_t timeout_usec, uint64_t start_nsec)
 {
     if (_fd >= 0) {
         return false;
@@ -59,7 +79,7 @@ bool TimerPollable::setup_timer(uint32_t timeout_usec)
         return false;
     }
 
-    if (!adjust_timer(timeout_usec)) {
+    if (!_set_timer(timeout_usec, start_nsec)) {
         ::close(_fd);
         _fd = -1;
         return false;
@@ -69,6 +89,11 @@ bool TimerPollable::setup_timer(uint32_t timeout_usec)
 }
 
 bool TimerPollable::adjust_timer(uint32_t timeout_usec)
+{
+    return _set_timer(timeout_usec, monotonic_nsec() + timeout_usec * AP_NSEC_PER_USEC);
+}
+
+bool TimerPollable::_set_timer(uint32_t timeout_usec, uint64_t start_nsec)
 {
     if (_fd < 0) {
         return false;
@@ -76,13 +101,16 @@ bool TimerPollable::adjust_timer(uint32_t timeout_usec)
 
     struct itimerspec spec = { };
 
-    spec.it_interval.tv_nsec = timeout_usec * AP_NSEC_PER_USEC;
-    spec.it_value.tv_nsec = timeout_usec * AP_NSEC_PER_USEC;
+    nsec_to_timespec(timeout_usec * AP_NSEC_PER_USEC, spec.it_interval);
+    nsec_to_timespec(start_nsec, spec.it_value);
 
-    if (timerfd_settime(_fd, 0, &spec, nullptr) < 0) {
+    if (timerfd_settime(_fd, TFD_TIMER_ABSTIME, &spec, nullptr) < 0) {
         return false;
     }
 
+    _period_usec = timeout_usec;
+    _start_nsec = start_nsec;
+
     return true;
 }
 
@@ -93,8 +121,8 @@ TimerPollable *PollerThread::add_timer(TimerPollable::PeriodicCb cb,
     if (!_poller) {
         return nullptr;
     }
-    TimerPollable *p = new TimerPollable(cb, wrapper);
-    if (!p || !p->setup_timer(timeout_usec) ||
+    TimerPollable *p = new TimerPollable(cb, wrapper, *this);
+    if (!p || !p->setup_timer(timeout_usec, _coalesced_start_nsec(timeout_usec)) ||
         !_poller.register_pollable(p, POLLIN)) {
         delete p;
         return nullptr;
@@ -116,6 +144,63 @@ bool PollerThread::adjust_timer(TimerPollable *p, uint32_t timeout_usec)
     return (*it)->adjust_timer(timeout_usec);
 }
 
+uint64_t PollerThread::_coalesced_start_nsec(uint32_t period_usec) const
+{
+    const uint64_t start_nsec = monotonic_nsec() + period_usec * AP_NSEC_PER_USEC;
+    if (period_usec == 0) {
+        return start_nsec;
+    }
+
+    for (const TimerPollable *p : _timers) {
+        const uint32_t other_usec = p->_period_usec;
+        if (p->_removeme || other_usec == 0 ||
+            (other_usec % period_usec != 0 && period_usec % other_usec != 0)) {
+            continue;
+        }
+        /*
+         * p expires at _start_nsec plus multiples of its period, so
+         * starting a whole number of the shorter period away from it
+         * keeps the two in step
+         */
+        const int64_t common_nsec = MIN(period_usec, other_usec) * AP_NSEC_PER_USEC;
+        int64_t phase_nsec = ((int64_t)p->_start_nsec - (int64_t)start_nsec) % common_nsec;
+        if (phase_nsec < 0) {
+            phase_nsec += common_nsec;
+        }
+        return start_nsec + phase_nsec;
+    }
+
+    return start_nsec;
+}
+
+void PollerThread::get_utilization(float &busy_pct, float &wakeup_rate_hz) const
+{
+    busy_pct = _busy_pct;
+    wakeup_rate_hz = _wakeup_rate_hz;
+}
+
+void PollerThread::_update_stats()
+{
+    const uint64_t now_nsec = monotonic_nsec();
+
+    _stats.wakeups++;
+    if (_stats.start_nsec == 0) {
+        _stats.start_nsec = now_nsec;
+        return;
+    }
+
+    const uint64_t dt_nsec = now_nsec - _stats.start_nsec;
+    if (dt_nsec < POLLER_STATS_NSEC) {
+        return;
+    }
+
+    _busy_pct = _stats.busy_nsec * 100.0f / dt_nsec;
+    _wakeup_rate_hz = _stats.wakeups * (float)AP_NSEC_PER_SEC / dt_nsec;
+    _stats.busy_nsec = 0;
+    _stats.wakeups = 0;
+    _stats.start_nsec = now_nsec;
+}
+
 void PollerThread::_cleanup_timers()
 {
     if (!_poller) {
@@ -141,6 +226,7 @@ void PollerThread::mainloop()
     while (!_should_exit) {
         _poller.poll();
         _cleanup_timers();
+        _update_stats();
     }
 
     _started = false;
@@ -26,6 +26,8 @@
 
 namespace Linux {
 
+class PollerThread;
+
 class TimerPollable : public Pollable {
     friend class PollerThread;
 
@@ -44,19 +46,29 @@ public:
 
     void on_can_read() override;
 
-    bool setup_timer(uint32_t timeout_usec);
+    bool setup_timer(uint32_t timeout_usec, uint64_t start_nsec);
     bool adjust_timer(uint32_t timeout_usec);
 
 protected:
-    TimerPollable(PeriodicCb cb, WrapperCb *wrapper)
+    TimerPollable(PeriodicCb cb, WrapperCb *wrapper, PollerThread &thread)
         : _cb(cb)
         , _wrapper(wrapper)
+        , _thread(thread)
     {
     }
 
+    /*
+     * Arm the timer with a period of @timeout_usec, first expiring at
+     * the absolute CLOCK_MONOTONIC time @start_nsec
+     */
+    bool _set_timer(uint32_t timeout_usec, uint64_t start_nsec);
+
     PeriodicCb _cb;
     WrapperCb *_wrapper;
+    PollerThread &_thread;
     bool _removeme = false;
+    uint32_t _period_usec = 0;
+    uint64_t _start_nsec = 0;
 };
 
 
@@ -74,11 +86,36 @@ public:
 
     bool stop() override;
 
+    /*
+     * Get the percentage of time spent in timer callbacks and the rate
+     * of wakeups, measured over the last few seconds
+     */
+    void get_utilization(float &busy_pct, float &wakeup_rate_hz) const;
+
 protected:
+    friend class TimerPollable;
+
     void _cleanup_timers();
 
+    /*
+     * First expiry time of a new timer, in phase with any existing timer
+     * whose period is a multiple or divisor of @period_usec so that
+     * they expire together
+     */
+    uint64_t _coalesced_start_nsec(uint32_t period_usec) const;
+
+    void _update_stats();
+
     Poller _poller{};
     std::vector<TimerPollable*> _timers{};
+
+    struct {
+        uint64_t busy_nsec;
+        uint32_t wakeups;
+        uint64_t start_nsec;
+    } _stats{};
+    float _busy_pct = 0;
+    float _wakeup_rate_hz = 0;
 };
 
 }
@@ -262,41 +262,20 @@ bool SPIDevice::set_speed(AP_HAL::Device::Speed speed)
     return true;
 }
 
-bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
-                         uint8_t *recv, uint32_t recv_len)
+void SPIDevice::_setup_msg(struct spi_ioc_transfer &msg, const uint8_t *tx,
+                           uint8_t *rx, uint32_t len)
 {
-    struct spi_ioc_transfer msgs[2] = { };
-    unsigned nmsgs = 0;
-    int fd = _bus.fd[_desc.subdev];
-
-    assert(fd >= 0);
-
-    if (send && send_len != 0) {
-        msgs[nmsgs].tx_buf = (uint64_t) send;
-        msgs[nmsgs].rx_buf = 0;
-        msgs[nmsgs].len = send_len;
-        msgs[nmsgs].speed_hz = _speed;
-        msgs[nmsgs].delay_usecs = 0;
-        msgs[nmsgs].bits_per_word = _desc.bits_per_word;
-        msgs[nmsgs].cs_change = 0;
-        nmsgs++;
-    }
-
-    if (recv && recv_len != 0) {
-        msgs[nmsgs].tx_buf = 0;
-        msgs[nmsgs].rx_buf = (uint64_t) recv;
-        msgs[nmsgs].len = recv_len;
-        msgs[nmsgs].speed_hz = _speed;
-        msgs[nmsgs].delay_usecs = 0;
-        msgs[nmsgs].bits_per_word = _desc.bits_per_word;
-        msgs[nmsgs].cs_change = 0;
-        nmsgs++;
-    }
-
-    if (!nmsgs) {
-        return false;
-    }
+    msg.tx_buf = (uint64_t) tx;
+    msg.rx_buf = (uint64_t) rx;
+    msg.len = len;
+    msg.speed_hz = _speed;
+    msg.delay_usecs = 0;
+    msg.bits_per_word = _desc.bits_per_word;
+    msg.cs_change = 0;
+}
 
+bool SPIDevice::_set_bus_mode(int fd)
+{
 #if DEBUG
     if (_desc.mode == _bus.last_mode) {
         /*
@@ -320,9 +299,8 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
     }
 #endif
 
-    int r;
     if (_desc.mode != _bus.last_mode) {
-        r = ioctl(fd, SPI_IOC_WR_MODE, &_desc.mode);
+        int r = ioctl(fd, SPI_IOC_WR_MODE, &_desc.mode);
         if (r < 0) {
             hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
                                 fd, strerror(errno));
@@ -331,8 +309,36 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
         _bus.last_mode = _desc.mode;
     }
 
+    return true;
+}
+
+bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
+                         uint8_t *recv, uint32_t recv_len)
+{
+    struct spi_ioc_transfer msgs[2] = { };
+    unsigned nmsgs = 0;
+    int fd = _bus.fd[_desc.subdev];
+
+    assert(fd >= 0);
+
+    if (send && send_len != 0) {
+        _setup_msg(msgs[nmsgs++], send, nullptr, send_len);
+    }
+
+    if (recv && recv_len != 0) {
+        _setup_msg(msgs[nmsgs++], nullptr, recv, recv_len);
+    }
+
+    if (!nmsgs) {
+        return false;
+    }
+
+    if (!_set_bus_mode(fd)) {
+        return false;
+    }
+
     _cs_assert();
-    r = ioctl(fd, SPI_IOC_MESSAGE(nmsgs), &msgs);
+    int r = ioctl(fd, SPI_IOC_MESSAGE(nmsgs), &msgs);
     _cs_release();
 
     if (r == -1) {
@@ -344,6 +350,63 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
     return true;
 }
 
+bool SPIDevice::transfer_batch(const Transfer *transfers, uint8_t count)
+{
+    static const uint8_t max_batch = 8;
+
+    /*
+      a userspace chip select can't be toggled between the messages of
+      one ioctl, so those devices take one syscall per transfer
+     */
+    if (_desc.cs_pin != SPI_CS_KERNEL || count > max_batch) {
+        return AP_HAL::SPIDevice::transfer_batch(transfers, count);
+    }
+
+    struct spi_ioc_transfer msgs[2 * max_batch] = { };
+    unsigned nmsgs = 0;
+    int fd = _bus.fd[_desc.subdev];
+
+    assert(fd >= 0);
+
+    for (uint8_t i = 0; i < count; i++) {
+        const Transfer &t = transfers[i];
+        const unsigned first = nmsgs;
+
+        if (t.send && t.send_len != 0) {
+            _setup_msg(msgs[nmsgs++], t.send, nullptr, t.send_len);
+        }
+        if (t.recv && t.recv_len != 0) {
+            _setup_msg(msgs[nmsgs++], nullptr, t.recv, t.recv_len);
+        }
+        if (nmsgs == first) {
+            return false;
+        }
+
+        // release chip select between transfers, as separate calls would
+        if (i != count - 1) {
+            msgs[nmsgs - 1].cs_change = 1;
+        }
+    }
+
+    if (!nmsgs) {
+        return false;
+    }
+
+    if (!_set_bus_mode(fd)) {
+        return false;
+    }
+
+    int r = ioctl(fd, SPI_IOC_MESSAGE(nmsgs), &msgs);
+
+    if (r == -1) {
+        hal.console->printf("SPIDevice: error transferring data fd=%d (%s)\n",
+                            fd, strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
 bool SPIDevice::transfer_fullduplex(const uint8_t *send, uint8_t *recv,
                                     uint32_t len)
 {
@@ -22,6 +22,8 @@
 #include <AP_HAL/HAL.h>
 #include <AP_HAL/SPIDevice.h>
 
+struct spi_ioc_transfer;
+
 namespace Linux {
 
 class SPIBus;
@@ -42,6 +44,12 @@ public:
     bool transfer(const uint8_t *send, uint32_t send_len,
                   uint8_t *recv, uint32_t recv_len) override;
 
+    /*
+     * See AP_HAL::Device::transfer_batch(). With kernel chip select the
+     * batch goes to spidev in a single SPI_IOC_MESSAGE ioctl
+     */
+    bool transfer_batch(const Transfer *transfers, uint8_t count) override;
+
     /* See AP_HAL::SPIDevice::transfer_fullduplex() */
     bool transfer_fullduplex(const uint8_t *send, uint8_t *recv,
                              uint32_t len) override;
@@ -63,6 +71,17 @@ protected:
     AP_HAL::DigitalSource *_cs;
     uint32_t _speed;
 
+    /*
+     * Fill @msg for half of a transfer, send or receive
+     */
+    void _setup_msg(struct spi_ioc_transfer &msg, const uint8_t *tx,
+                    uint8_t *rx, uint32_t len);
+
+    /*
+     * Put the bus in this device's SPI mode if another device changed it
+     */
+    bool _set_bus_mode(int fd);
+
     /*
      * Select device if using userspace CS
      */
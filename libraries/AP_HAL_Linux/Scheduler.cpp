@@ -49,13 +49,119 @@ extern const AP_HAL::HAL& hal;
     {                                                           \
         .name = "ap-" #name_,                                   \
         .thread = &_##name_##_thread,                           \
+        .id = THREAD_##UPPER_NAME_,                             \
         .policy = SCHED_FIFO,                                   \
         .prio = APM_LINUX_##UPPER_NAME_##_PRIORITY,             \
         .rate = APM_LINUX_##UPPER_NAME_##_RATE,                 \
     }
 
+const char *const Scheduler::_thread_names[THREAD_NUM] = {
+    "main",
+    "timer",
+    "uart",
+    "rcin",
+    "io",
+    "other",
+};
+
 Scheduler::Scheduler()
-{ }
+{
+    memset(_thread_config, 0, sizeof(_thread_config));
+    memset(_thread_samples, 0, sizeof(_thread_samples));
+}
+
+/*
+  parse a CPU list such as "2" or "0-1,3"
+ */
+bool Scheduler::_parse_cpu_list(const char *list, cpu_set_t &cpus)
+{
+    CPU_ZERO(&cpus);
+    const char *p = list;
+    while (*p) {
+        char *end;
+        const long first = strtol(p, &end, 10);
+        long last = first;
+        if (end == p) {
+            return false;
+        }
+        if (*end == '-') {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+            if (end == p) {
+                return false;
+            }
+        }
+        if (first < 0 || last < first || last >= CPU_SETSIZE) {
+            return false;
+        }
+        for (long cpu = first; cpu <= last; cpu++) {
+            CPU_SET(cpu, &cpus);
+        }
+        if (*end == ',') {
+            end++;
+        } else if (*end != 0) {
+            return false;
+        }
+        p = end;
+    }
+    return CPU_COUNT(&cpus) > 0;
+}
+
+bool Scheduler::set_thread_config(const char *spec)
+{
+    const char *eq = strchr(spec, '=');
+    if (eq == nullptr) {
+        return false;
+    }
+
+    uint8_t id;
+    for (id = 0; id < THREAD_NUM; id++) {
+        if (strlen(_thread_names[id]) == size_t(eq - spec) &&
+            strncmp(spec, _thread_names[id], eq - spec) == 0) {
+            break;
+        }
+    }
+    if (id == THREAD_NUM) {
+        return false;
+    }
+
+    struct thread_config cfg {};
+    const char *p = eq + 1;
+    if (*p != '@' && *p != 0) {
+        char *end;
+        cfg.prio = strtol(p, &end, 10);
+        if (end == p || cfg.prio < 1 || cfg.prio > APM_LINUX_MAX_PRIORITY ||
+            id == THREAD_OTHER) {
+            return false;
+        }
+        p = end;
+    }
+    if (*p == '@') {
+        if (!_parse_cpu_list(p + 1, cfg.cpus)) {
+            return false;
+        }
+        cfg.pinned = true;
+    } else if (*p != 0) {
+        return false;
+    }
+
+    _thread_config[id] = cfg;
+    return true;
+}
+
+/*
+  threads without a CPU set of their own get the startup affinity
+  rather than inheriting a pinned main thread's
+ */
+const cpu_set_t &Scheduler::_thread_cpus(thread_id id) const
+{
+    return _thread_config[id].pinned ? _thread_config[id].cpus : _default_cpus;
+}
+
+int Scheduler::_thread_prio(thread_id id, int default_prio) const
+{
+    return _thread_config[id].prio ? _thread_config[id].prio : default_prio;
+}
 
 
 void Scheduler::init_realtime()
@@ -74,7 +180,7 @@ void Scheduler::init_realtime()
 
     mlockall(MCL_CURRENT|MCL_FUTURE);
 
-    struct sched_param param = { .sched_priority = APM_LINUX_MAIN_PRIORITY };
+    struct sched_param param = { .sched_priority = _thread_prio(THREAD_MAIN, APM_LINUX_MAIN_PRIORITY) };
     if (sched_setscheduler(0, SCHED_FIFO, &param) == -1) {
         AP_HAL::panic("Scheduler: failed to set scheduling parameters: %s",
                       strerror(errno));
@@ -87,6 +193,7 @@ void Scheduler::init()
     const struct sched_table {
         const char *name;
         SchedulerThread *thread;
+        thread_id id;
         int policy;
         int prio;
         uint32_t rate;
@@ -99,8 +206,18 @@ void Scheduler::init()
 
     _main_ctx = pthread_self();
 
+    if (sched_getaffinity(0, sizeof(_default_cpus), &_default_cpus) != 0) {
+        AP_HAL::panic("Scheduler: failed to get CPU affinity: %s",
+                      strerror(errno));
+    }
+
     init_realtime();
 
+    if (_thread_config[THREAD_MAIN].pinned &&
+        pthread_setaffinity_np(_main_ctx, sizeof(cpu_set_t), &_thread_config[THREAD_MAIN].cpus) != 0) {
+        AP_HAL::panic("Scheduler: failed to set main thread CPU affinity");
+    }
+
     /* set barrier to N + 1 threads: worker threads + main */
     unsigned n_threads = ARRAY_SIZE(sched_table) + 1;
     ret = pthread_barrier_init(&_initialized_barrier, nullptr, n_threads);
@@ -114,7 +231,8 @@ void Scheduler::init()
 
         t->thread->set_rate(t->rate);
         t->thread->set_stack_size(1024 * 1024);
-        t->thread->start(t->name, t->policy, t->prio);
+        t->thread->set_cpu_affinity(_thread_cpus(t->id));
+        t->thread->start(t->name, t->policy, _thread_prio(t->id, t->prio));
     }
 
 #if defined(DEBUG_STACK) && DEBUG_STACK
@@ -249,30 +367,60 @@ void Scheduler::_run_io(void)
     _io_semaphore.give();
 }
 
-/*
-  run timers for all UARTs
- */
-void Scheduler::_run_uarts()
-{
-    // process any pending serial bytes
-    hal.uartA->_timer_tick();
-    hal.uartB->_timer_tick();
-    hal.uartC->_timer_tick();
-    hal.uartD->_timer_tick();
-    hal.uartE->_timer_tick();
-    hal.uartF->_timer_tick();
-    hal.uartG->_timer_tick();
-    hal.uartH->_timer_tick();
-}
 
 void Scheduler::_rcin_task()
 {
     RCInput::from(hal.rcin)->_timer_tick();
 }
 
+/*
+  one pass of the uart thread: tick the ports that need it, then sleep
+  until a device is readable, a write arrives on an idle port or the
+  next tick is due
+ */
 void Scheduler::_uart_task()
 {
-    _run_uarts();
+    UARTDriver *const uarts[] = {
+        UARTDriver::from(hal.uartA),
+        UARTDriver::from(hal.uartB),
+        UARTDriver::from(hal.uartC),
+        UARTDriver::from(hal.uartD),
+        UARTDriver::from(hal.uartE),
+        UARTDriver::from(hal.uartF),
+        UARTDriver::from(hal.uartG),
+        UARTDriver::from(hal.uartH),
+    };
+    const uint64_t period_usec = hz_to_usec(APM_LINUX_UART_RATE);
+
+    uint64_t now = AP_HAL::micros64();
+    const bool tick_due = now - _last_uart_tick_usec >= period_usec;
+    if (tick_due) {
+        _last_uart_tick_usec = now;
+    }
+
+    bool periodic = false;
+    for (UARTDriver *uart : uarts) {
+        if (!uart->_reactor_update(_uart_poller)) {
+            periodic = true;
+            if (tick_due) {
+                uart->_timer_tick();
+            }
+        }
+    }
+
+    int timeout_ms = -1;
+    if (periodic || !_uart_poller) {
+        now = AP_HAL::micros64();
+        const uint64_t elapsed = MIN(now - _last_uart_tick_usec, period_usec);
+        timeout_ms = (period_usec - elapsed + 999) / 1000;
+    }
+
+    if (!_uart_poller) {
+        // no epoll, tick every port at the fixed rate as before
+        microsleep(timeout_ms * 1000U);
+        return;
+    }
+    _uart_poller.poll(timeout_ms);
 }
 
 void Scheduler::_io_task()
@@ -282,6 +430,75 @@ void Scheduler::_io_task()
 
     // run registered IO processes
     _run_io();
+
+    if (++_thread_stats_counter >= APM_LINUX_IO_RATE) {
+        _thread_stats_counter = 0;
+        _update_thread_stats();
+    }
+}
+
+static bool thread_cpu_usec(pthread_t ctx, uint64_t &usec)
+{
+    clockid_t clock;
+    struct timespec ts;
+
+    if (pthread_getcpuclockid(ctx, &clock) != 0 ||
+        clock_gettime(clock, &ts) != 0) {
+        return false;
+    }
+    usec = uint64_t(ts.tv_sec) * 1000000ULL + ts.tv_nsec / 1000;
+    return true;
+}
+
+/*
+  sample the CPU time of the main loop and each HAL thread. The load
+  is the CPU time used since the previous sample over the wall time,
+  so a thread busy on one core reads 100%
+ */
+void Scheduler::_update_thread_stats()
+{
+    PeriodicThread *const threads[THREAD_OTHER] = {
+        nullptr,
+        &_timer_thread,
+        &_uart_thread,
+        &_rcin_thread,
+        &_io_thread,
+    };
+
+    const uint64_t now = AP_HAL::micros64();
+
+    WITH_SEMAPHORE(_thread_stats_sem);
+
+    const uint64_t dt = now - _thread_sample_usec;
+    for (uint8_t i = 0; i < THREAD_OTHER; i++) {
+        thread_sample &s = _thread_samples[i];
+        PeriodicThread *t = threads[i];
+        uint64_t cpu_usec = 0;
+
+        const bool have_cpu = thread_cpu_usec(t ? t->get_ctx() : _main_ctx, cpu_usec);
+        if (have_cpu && _thread_sample_usec != 0 && dt > 0) {
+            s.stats.load = MIN((cpu_usec - s.cpu_usec) * 1000U / dt, 1000U);
+        }
+        s.cpu_usec = cpu_usec;
+
+        strncpy(s.stats.name, _thread_names[i], sizeof(s.stats.name) - 1);
+        if (t != nullptr) {
+            const size_t used = t->get_stack_usage() * sizeof(uint32_t);
+            s.stats.stack_free = used < t->get_stack_size() ? t->get_stack_size() - used : 0;
+            t->get_jitter(s.stats.jitter_avg_us, s.stats.jitter_max_us);
+        }
+    }
+    _thread_sample_usec = now;
+}
+
+bool Scheduler::get_thread_stats(uint8_t idx, AP_HAL::Util::ThreadStats &stats)
+{
+    WITH_SEMAPHORE(_thread_stats_sem);
+    if (idx >= THREAD_OTHER || _thread_sample_usec == 0) {
+        return false;
+    }
+    stats = _thread_samples[idx].stats;
+    return true;
 }
 
 bool Scheduler::in_main_thread() const
@@ -328,6 +545,31 @@ bool Scheduler::SchedulerThread::_run()
     return PeriodicThread::_run();
 }
 
+bool Scheduler::UARTReactorThread::_run()
+{
+    _sched._wait_all_threads();
+
+    while (!_should_exit) {
+        _task();
+    }
+
+    _started = false;
+    _should_exit = false;
+
+    return true;
+}
+
+bool Scheduler::UARTReactorThread::stop()
+{
+    if (!PeriodicThread::stop()) {
+        return false;
+    }
+
+    _sched._uart_poller.wakeup();
+
+    return true;
+}
+
 void Scheduler::teardown()
 {
     _timer_thread.stop();
@@ -384,6 +626,8 @@ bool Scheduler::thread_create(AP_HAL::MemberProc proc, const char *name, uint32_
      */
     thread->set_auto_free(true);
 
+    thread->set_cpu_affinity(_thread_cpus(THREAD_OTHER));
+
     if (!thread->start(name, SCHED_FIFO, thread_priority)) {
         delete thread;
         return false;
@@ -391,3 +635,23 @@ bool Scheduler::thread_create(AP_HAL::MemberProc proc, const char *name, uint32_
 
     return true;
 }
+
+/*
+  pin the calling thread to one CPU core
+ */
+bool Scheduler::set_thread_affinity(uint8_t core)
+{
+    if (core >= get_num_cores()) {
+        return false;
+    }
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(core, &cpuset);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) == 0;
+}
+
+uint8_t Scheduler::get_num_cores() const
+{
+    const long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return constrain_int32(n, 1, UINT8_MAX);
+}
@@ -3,6 +3,7 @@
 #include <pthread.h>
 
 #include "AP_HAL_Linux.h"
+#include "Poller.h"
 #include "Semaphores.h"
 #include "Thread.h"
 
@@ -51,8 +52,61 @@ public:
       create a new thread
      */
     bool thread_create(AP_HAL::MemberProc, const char *name, uint32_t stack_size, priority_base base, int8_t priority) override;
-    
+
+    bool set_thread_affinity(uint8_t core) override;
+    uint8_t get_num_cores() const override;
+
+    /*
+      override the priority and CPU set of a HAL thread, given as
+      name=prio@cpus, e.g. "timer=18@2" or "io=@0-1". Names are main,
+      timer, uart, rcin, io and other. "other" covers threads created
+      with thread_create() and only takes a CPU set, as those keep
+      their relative priorities. Must be called before init()
+     */
+    bool set_thread_config(const char *spec);
+
+    /*
+      load, stack and jitter statistics of the main loop and HAL threads
+     */
+    bool get_thread_stats(uint8_t idx, AP_HAL::Util::ThreadStats &stats);
+
 private:
+    enum thread_id {
+        THREAD_MAIN,
+        THREAD_TIMER,
+        THREAD_UART,
+        THREAD_RCIN,
+        THREAD_IO,
+        THREAD_OTHER,
+        THREAD_NUM
+    };
+
+    static const char *const _thread_names[THREAD_NUM];
+
+    struct thread_config {
+        int prio;                   // 0 keeps the default priority
+        bool pinned;
+        cpu_set_t cpus;
+    } _thread_config[THREAD_NUM];
+
+    // CPUs the process was allowed to run on at startup
+    cpu_set_t _default_cpus;
+
+    const cpu_set_t &_thread_cpus(thread_id id) const;
+    int _thread_prio(thread_id id, int default_prio) const;
+    static bool _parse_cpu_list(const char *list, cpu_set_t &cpus);
+
+    // thread statistics, sampled once a second from the IO thread
+    void _update_thread_stats();
+
+    struct thread_sample {
+        uint64_t cpu_usec;
+        AP_HAL::Util::ThreadStats stats;
+    } _thread_samples[THREAD_OTHER];
+    uint64_t _thread_sample_usec;
+    uint8_t _thread_stats_counter;
+    Semaphore _thread_stats_sem;
+
     class SchedulerThread : public PeriodicThread {
     public:
         SchedulerThread(Thread::task_t t, Scheduler &sched)
@@ -66,6 +120,23 @@ private:
         Scheduler &_sched;
     };
 
+    /*
+      the uart thread sleeps on a poller until a port's device is
+      readable or a write wakes it, and only ticks ports periodically
+      while they have bytes pending or cannot be polled
+     */
+    class UARTReactorThread : public SchedulerThread {
+    public:
+        UARTReactorThread(Thread::task_t t, Scheduler &sched)
+            : SchedulerThread(t, sched)
+        { }
+
+        bool stop() override;
+
+    protected:
+        bool _run() override;
+    };
+
     void     init_realtime();
 
     void _wait_all_threads();
@@ -87,7 +158,7 @@ private:
     SchedulerThread _timer_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_timer_task, void), *this};
     SchedulerThread _io_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_io_task, void), *this};
     SchedulerThread _rcin_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_rcin_task, void), *this};
-    SchedulerThread _uart_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_uart_task, void), *this};
+    UARTReactorThread _uart_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_uart_task, void), *this};
 
     void _timer_task();
     void _io_task();
@@ -95,7 +166,9 @@ private:
     void _uart_task();
 
     void _run_io();
-    void _run_uarts();
+
+    Poller _uart_poller;
+    uint64_t _last_uart_tick_usec;
 
     uint64_t _stopped_clock_usec;
     uint64_t _last_stack_debug_msec;
@@ -6,12 +6,19 @@ extern const AP_HAL::HAL& hal;
 
 using namespace Linux;
 
-// construct a semaphore
+/*
+  construct a semaphore. Our threads run SCHED_FIFO at fixed
+  priorities, so a holder is raised to the priority of the highest
+  thread waiting on it, as ChibiOS mutexes do. Otherwise a middle
+  priority thread could keep a low priority holder from running while
+  a high priority thread waits
+ */
 Semaphore::Semaphore()
 {
     pthread_mutexattr_t attr;
     pthread_mutexattr_init(&attr);
     pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
     pthread_mutex_init(&_lock, &attr);
 }
 
@@ -43,3 +50,53 @@ bool Semaphore::take_nonblocking()
     return pthread_mutex_trylock(&_lock) == 0;
 }
 
+
+// construct a binary semaphore, waits are timed on the monotonic clock
+BinarySemaphore::BinarySemaphore() :
+    _pending(false)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&_cond, &attr);
+    pthread_mutex_init(&_lock, nullptr);
+}
+
+bool BinarySemaphore::wait(uint32_t timeout_us)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    const uint64_t nsec = ts.tv_nsec + uint64_t(timeout_us) * 1000ULL;
+    ts.tv_sec += nsec / 1000000000ULL;
+    ts.tv_nsec = nsec % 1000000000ULL;
+
+    pthread_mutex_lock(&_lock);
+    while (!_pending) {
+        if (pthread_cond_timedwait(&_cond, &_lock, &ts) != 0) {
+            break;
+        }
+    }
+    const bool ret = _pending;
+    _pending = false;
+    pthread_mutex_unlock(&_lock);
+    return ret;
+}
+
+bool BinarySemaphore::wait_blocking()
+{
+    pthread_mutex_lock(&_lock);
+    while (!_pending) {
+        pthread_cond_wait(&_cond, &_lock);
+    }
+    _pending = false;
+    pthread_mutex_unlock(&_lock);
+    return true;
+}
+
+void BinarySemaphore::signal()
+{
+    pthread_mutex_lock(&_lock);
+    _pending = true;
+    pthread_cond_signal(&_cond);
+    pthread_mutex_unlock(&_lock);
+}
@@ -18,4 +18,16 @@ protected:
     pthread_mutex_t _lock;
 };
 
+class BinarySemaphore : public AP_HAL::BinarySemaphore {
+public:
+    BinarySemaphore();
+    bool wait(uint32_t timeout_us) override;
+    bool wait_blocking() override;
+    void signal() override;
+protected:
+    pthread_mutex_t _lock;
+    pthread_cond_t _cond;
+    bool _pending;
+};
+
 }
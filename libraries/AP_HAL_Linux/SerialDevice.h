@@ -23,4 +23,10 @@ public:
 
     /* Depends on lower level to implement, most devices are fine with defaults */
     virtual void set_parity(int v) { }
+
+    /*
+     * File descriptor that becomes readable when read() has something to
+     * return, or -1 if the device has to be polled periodically
+     */
+    virtual int get_poll_fd() const { return -1; }
 };
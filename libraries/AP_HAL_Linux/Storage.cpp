@@ -4,6 +4,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -15,7 +16,8 @@ using namespace Linux;
 
 /*
   This stores 'eeprom' data on the SD card, with a 4k size, and a
-  in-memory buffer. This keeps the latency down.
+  in-memory buffer. This keeps the latency down. With
+  HAL_STORAGE_USE_MMAP the buffer is a shared mapping of the file
  */
 
 // name the storage file after the sketch so you can use the same board
@@ -114,9 +116,9 @@ int Storage::_storage_create(const char *dpath)
     }
 
     // take up all needed space
-    if (ftruncate(fd, sizeof(_buffer)) == -1) {
+    if (ftruncate(fd, LINUX_STORAGE_SIZE) == -1) {
         fprintf(stderr, "Failed to set file size to %lu kB (%m)\n",
-                sizeof(_buffer) / 1024);
+                (unsigned long)(LINUX_STORAGE_SIZE / 1024));
         goto fail;
     }
 
@@ -156,16 +158,24 @@ void Storage::init()
         }
     }
 
-    ssize_t ret = read(fd, _buffer, sizeof(_buffer));
+#if HAL_STORAGE_USE_MMAP
+    if (_storage_map(fd)) {
+        _fd = fd;
+        _initialised = true;
+        return;
+    }
+#endif
+
+    ssize_t ret = read(fd, _buffer, LINUX_STORAGE_SIZE);
 
-    if (ret != sizeof(_buffer)) {
+    if (ret != LINUX_STORAGE_SIZE) {
         close(fd);
         _storage_create(dpath);
         fd = open(dpath, O_RDONLY|O_CLOEXEC);
         if (fd == -1) {
             AP_HAL::panic("Failed to open %s (%m)", dpath);
         }
-        if (read(fd, _buffer, sizeof(_buffer)) != sizeof(_buffer)) {
+        if (read(fd, _buffer, LINUX_STORAGE_SIZE) != LINUX_STORAGE_SIZE) {
             AP_HAL::panic("Failed to read %s (%m)", dpath);
         }
     }
@@ -174,6 +184,26 @@ void Storage::init()
     _initialised = true;
 }
 
+#if HAL_STORAGE_USE_MMAP
+/*
+  map a full size storage file. A short file is left to the read path
+  in init(), which recreates it
+ */
+bool Storage::_storage_map(int fd)
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < LINUX_STORAGE_SIZE) {
+        return false;
+    }
+    void *map = mmap(nullptr, LINUX_STORAGE_SIZE, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    _buffer = (uint8_t *)map;
+    return true;
+}
+#endif
+
 /*
   mark some lines as dirty. Note that there is no attempt to avoid
   the race condition between this code and the _timer_tick() code
@@ -196,7 +226,7 @@ void Storage::_mark_dirty(uint16_t loc, uint16_t length)
 
 void Storage::read_block(void *dst, uint16_t loc, size_t n)
 {
-    if (loc >= sizeof(_buffer)-(n-1)) {
+    if (loc >= LINUX_STORAGE_SIZE-(n-1)) {
         return;
     }
     init();
@@ -205,7 +235,7 @@ void Storage::read_block(void *dst, uint16_t loc, size_t n)
 
 void Storage::write_block(uint16_t loc, const void *src, size_t n)
 {
-    if (loc >= sizeof(_buffer)-(n-1)) {
+    if (loc >= LINUX_STORAGE_SIZE-(n-1)) {
         return;
     }
     if (memcmp(src, &_buffer[loc], n) != 0) {
@@ -221,6 +251,20 @@ void Storage::_timer_tick(void)
         return;
     }
 
+#if HAL_STORAGE_USE_MMAP
+    if (_buffer != _ram_buffer) {
+        // the data is already in the mapping, so sync every dirty page
+        // in one call. The mask is cleared first so a write racing
+        // with us is synced on the next tick
+        _dirty_mask = 0;
+        if (msync(_buffer, LINUX_STORAGE_SIZE, MS_SYNC) != 0) {
+            close(_fd);
+            _fd = -1;
+        }
+        return;
+    }
+#endif
+
     // write out the first dirty set of lines. We don't write more
     // than one to keep the latency of this call to a minimum
     uint8_t i, n;
@@ -8,6 +8,12 @@
 #define LINUX_STORAGE_LINE_SIZE (1<<LINUX_STORAGE_LINE_SHIFT)
 #define LINUX_STORAGE_NUM_LINES (LINUX_STORAGE_SIZE/LINUX_STORAGE_LINE_SIZE)
 
+// map the storage file into memory instead of keeping a RAM copy
+// written back line by line. The file layout is the same either way
+#ifndef HAL_STORAGE_USE_MMAP
+#define HAL_STORAGE_USE_MMAP 1
+#endif
+
 namespace Linux {
 
 class Storage : public AP_HAL::Storage
@@ -37,11 +43,16 @@ public:
 protected:
     void _mark_dirty(uint16_t loc, uint16_t length);
     int _storage_create(const char *dpath);
+#if HAL_STORAGE_USE_MMAP
+    bool _storage_map(int fd);
+#endif
 
     int _fd;
     volatile bool _initialised;
     volatile uint32_t _dirty_mask;
-    uint8_t _buffer[LINUX_STORAGE_SIZE];
+    uint8_t _ram_buffer[LINUX_STORAGE_SIZE];
+    // points at _ram_buffer, or at the file mapping once it is open
+    uint8_t *_buffer = _ram_buffer;
 };
 
 }
@@ -84,6 +84,7 @@ bool TCPServerDevice::open()
     }
 
     listener.set_blocking(false);
+    _listening = true;
 
     if (_wait) {
         ::printf("Waiting for connection on %s:%u ....\n",
@@ -109,6 +110,15 @@ bool TCPServerDevice::close()
     return true;
 }
 
+int TCPServerDevice::get_poll_fd() const
+{
+    if (sock != nullptr) {
+        return sock->get_read_fd();
+    }
+    // an unbound stream socket reports a hang up, so wait for listen()
+    return _listening ? listener.get_read_fd() : -1;
+}
+
 void TCPServerDevice::set_blocking(bool blocking)
 {
     _blocking = blocking;
@@ -15,6 +15,12 @@ public:
     virtual ssize_t write(const uint8_t *buf, uint16_t n) override;
     virtual ssize_t read(uint8_t *buf, uint16_t n) override;
 
+    /*
+     * the connection once there is one, otherwise the listening socket,
+     * which becomes readable when a client is waiting to be accepted
+     */
+    virtual int get_poll_fd() const override;
+
 private:
     SocketAPM listener{false};
     SocketAPM *sock = nullptr;
@@ -22,5 +28,6 @@ private:
     uint16_t _port;
     bool _wait;
     bool _blocking = false;
+    bool _listening = false;
     uint32_t _last_bind_warning = 0;
 };
@@ -189,6 +189,13 @@ bool Thread::start(const char *name, int policy, int prio)
         }
     }
 
+    if (_has_cpus) {
+        if ((r = pthread_attr_setaffinity_np(&attr, sizeof(_cpus), &_cpus)) != 0) {
+            AP_HAL::panic("Failed to set CPU affinity for thread '%s': %s",
+                          name, strerror(r));
+        }
+    }
+
     r = pthread_create(&_ctx, &attr, &Thread::_run_trampoline, this);
     if (r != 0) {
         AP_HAL::panic("Failed to create thread '%s': %s",
@@ -227,6 +234,18 @@ bool Thread::join()
 }
 
 
+bool Thread::set_cpu_affinity(const cpu_set_t &cpus)
+{
+    if (_started) {
+        return false;
+    }
+
+    _cpus = cpus;
+    _has_cpus = true;
+
+    return true;
+}
+
 bool PeriodicThread::set_rate(uint32_t rate_hz)
 {
     if (_started || rate_hz == 0) {
@@ -264,6 +283,12 @@ bool PeriodicThread::_run()
             next_run_usec = AP_HAL::micros64();
         } else {
             Scheduler::from(hal.scheduler)->microsleep(dt);
+
+            const uint64_t now = AP_HAL::micros64();
+            const uint32_t late = now > next_run_usec ? uint32_t(now - next_run_usec) : 0;
+            _jitter_sum_usec += late;
+            _jitter_count++;
+            _jitter_max_usec = MAX(_jitter_max_usec, late);
         }
         next_run_usec += _period_usec;
 
@@ -276,6 +301,21 @@ bool PeriodicThread::_run()
     return true;
 }
 
+void PeriodicThread::get_jitter(uint32_t &avg_usec, uint32_t &max_usec)
+{
+    /*
+     * Unlocked: a wakeup landing between the reads and the reset is
+     * at worst left out of one report
+     */
+    const uint32_t count = _jitter_count;
+    avg_usec = count ? _jitter_sum_usec / count : 0;
+    max_usec = _jitter_max_usec;
+
+    _jitter_sum_usec = 0;
+    _jitter_count = 0;
+    _jitter_max_usec = 0;
+}
+
 bool PeriodicThread::stop()
 {
     if (!is_started()) {
@@ -45,6 +45,15 @@ public:
 
     bool set_stack_size(size_t stack_size);
 
+    size_t get_stack_size() const { return _stack_size; }
+
+    /*
+     * Restrict the thread to the given CPUs. Must be called before start().
+     */
+    bool set_cpu_affinity(const cpu_set_t &cpus);
+
+    pthread_t get_ctx() const { return _ctx; }
+
     void set_auto_free(bool auto_free) { _auto_free = auto_free; }
 
     virtual bool stop() { return false; }
@@ -75,6 +84,9 @@ protected:
     } _stack_debug;
 
     size_t _stack_size = 0;
+
+    cpu_set_t _cpus;
+    bool _has_cpus = false;
 };
 
 class PeriodicThread : public Thread {
@@ -87,10 +99,20 @@ public:
 
     bool stop() override;
 
+    /*
+     * Mean and worst wakeup lateness since the previous call
+     */
+    void get_jitter(uint32_t &avg_usec, uint32_t &max_usec);
+
 protected:
     bool _run() override;
 
     uint64_t _period_usec = 0;
+
+    // written by the thread, read and reset by get_jitter()
+    uint64_t _jitter_sum_usec = 0;
+    uint32_t _jitter_count = 0;
+    uint32_t _jitter_max_usec = 0;
 };
 
 }
@@ -10,6 +10,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
@@ -101,6 +102,9 @@ void UARTDriver::begin(uint32_t b, uint16_t rxS, uint16_t txS)
         _readbuf.clear();
         _writebuf.clear();
     }
+
+    // let the uart thread pick up the (re)opened device
+    _reactor_wakeup();
 }
 
 void UARTDriver::_allocate_buffers(uint16_t rxS, uint16_t txS)
@@ -291,6 +295,15 @@ int16_t UARTDriver::read()
     return byte;
 }
 
+ssize_t UARTDriver::read(uint8_t *buffer, uint16_t count)
+{
+    if (!_initialised) {
+        return 0;
+    }
+
+    return _readbuf.read(buffer, count);
+}
+
 /* Linux implementations of Print virtual methods */
 size_t UARTDriver::write(uint8_t c)
 {
@@ -310,6 +323,7 @@ size_t UARTDriver::write(uint8_t c)
     }
     size_t ret = _writebuf.write(&c, 1);
     _write_mutex.give();
+    _reactor_wakeup();
     return ret;
 }
 
@@ -339,9 +353,36 @@ size_t UARTDriver::write(const uint8_t *buffer, size_t size)
 
     size_t ret = _writebuf.write(buffer, size);
     _write_mutex.give();
+    _reactor_wakeup();
     return ret;
 }
 
+/*
+  reserve space in the write buffer to be filled in place. Blocking
+  writes fall back to write()
+ */
+bool UARTDriver::write_reserve(ByteBuffer::IoVec vec[2], uint32_t len)
+{
+    if (!_initialised || !_nonblocking_writes) {
+        return false;
+    }
+    if (!_write_mutex.take_nonblocking()) {
+        return false;
+    }
+    if (_writebuf.space() < len || _writebuf.reserve(vec, len) == 0) {
+        _write_mutex.give();
+        return false;
+    }
+    return true;
+}
+
+void UARTDriver::write_commit(uint32_t len)
+{
+    _writebuf.commit(len);
+    _write_mutex.give();
+    _reactor_wakeup();
+}
+
 /*
   try writing n bytes, handling an unresponsive port
  */
@@ -417,9 +458,10 @@ bool UARTDriver::_write_pending_bytes(void)
 }
 
 /*
-  push any pending bytes to/from the serial port. This is called at
-  1kHz in the timer thread. Doing it this way reduces the system call
-  overhead in the main task enormously.
+  push any pending bytes to/from the serial port. This is called from
+  the uart thread when the device is readable, and periodically while
+  bytes are pending transmission. Doing it this way reduces the system
+  call overhead in the main task enormously.
  */
 void UARTDriver::_timer_tick(void)
 {
@@ -457,6 +499,68 @@ void UARTDriver::_timer_tick(void)
     _in_timer = false;
 }
 
+bool UARTDriver::_reactor_update(Poller &poller)
+{
+    _reactor_poller = &poller;
+
+    // a full read buffer would leave the descriptor readable forever
+    int fd = -1;
+    if (_initialised && _readbuf.space() > 0) {
+        fd = _poll_fd();
+    }
+    if (fd != -1 && fd == _reactor_failed_fd) {
+        fd = -1;
+    } else if (fd != -1) {
+        _reactor_failed_fd = -1;
+    }
+
+    if (fd != _reactor_pollable.get_fd()) {
+        poller.unregister_pollable(&_reactor_pollable);
+        _reactor_pollable.set_fd(fd);
+        if (fd != -1 && !poller.register_pollable(&_reactor_pollable, EPOLLIN)) {
+            _reactor_pollable.set_fd(-1);
+        }
+    }
+
+    if (_initialised && _reactor_pollable.get_fd() == -1) {
+        _reactor_idle = false;
+        return false;
+    }
+
+    /*
+      publish idle before looking at the write buffer: a writer either
+      sees the flag and wakes us, or its bytes are seen here
+     */
+    _reactor_idle = true;
+    if (_initialised && _writebuf.available() > 0) {
+        _reactor_idle = false;
+        return false;
+    }
+    return true;
+}
+
+/*
+  the descriptor reported an error or hang up. Give the device a chance
+  to notice (a TCP client disconnecting) and fall back to periodic
+  polling if it keeps the same descriptor
+ */
+void UARTDriver::_reactor_hang_up()
+{
+    _timer_tick();
+
+    const int fd = _reactor_pollable.get_fd();
+    if (fd != -1 && _poll_fd() == fd) {
+        _reactor_failed_fd = fd;
+    }
+}
+
+void UARTDriver::_reactor_wakeup()
+{
+    if (_reactor_idle.exchange(false) && _reactor_poller != nullptr) {
+        _reactor_poller->wakeup();
+    }
+}
+
 void UARTDriver::configure_parity(uint8_t v) {
     _device->set_parity(v);
 }
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <atomic>
+
 #include <AP_HAL/utility/OwnPtr.h>
 #include <AP_HAL/utility/RingBuffer.h>
 
 #include "AP_HAL_Linux.h"
+#include "Poller.h"
 #include "SerialDevice.h"
 #include "Semaphores.h"
 
@@ -30,16 +33,29 @@ public:
     uint32_t available() override;
     uint32_t txspace() override;
     int16_t read() override;
+    ssize_t read(uint8_t *buffer, uint16_t count) override;
 
     /* Linux implementations of Print virtual methods */
     size_t write(uint8_t c) override;
     size_t write(const uint8_t *buffer, size_t size) override;
 
+    // fill the transmit buffer in place
+    bool write_reserve(ByteBuffer::IoVec vec[2], uint32_t len) override;
+    void write_commit(uint32_t len) override;
+
     void set_device_path(const char *path);
 
     bool _write_pending_bytes(void);
     virtual void _timer_tick(void) override;
 
+    /*
+      keep the device registered with the uart thread's poller. Returns
+      true if the port can sleep until its device is readable or a
+      write wakes it, false if it needs periodic _timer_tick() calls.
+      Only called from the uart thread
+     */
+    bool _reactor_update(Poller &poller);
+
     virtual enum flow_control get_flow_control(void) override
     {
         return _device->get_flow_control();
@@ -84,6 +100,36 @@ private:
 
     AP_HAL::OwnPtr<SerialDevice> _parseDevicePath(const char *arg);
 
+    /*
+      registration of the device's descriptor with the uart thread's
+      poller. Input is read as soon as it arrives
+     */
+    class ReactorPollable : public Pollable {
+    public:
+        ReactorPollable(UARTDriver &uart) : _uart(uart) { }
+        // the descriptor belongs to the SerialDevice
+        ~ReactorPollable() { _fd = -1; }
+
+        void set_fd(int fd) { _fd = fd; }
+
+        void on_can_read() override { _uart._timer_tick(); }
+        void on_error() override { _uart._reactor_hang_up(); }
+        void on_hang_up() override { _uart._reactor_hang_up(); }
+
+    private:
+        UARTDriver &_uart;
+    };
+
+    ReactorPollable _reactor_pollable{*this};
+    const Poller *_reactor_poller = nullptr;
+    // descriptor that reported a hang up, polled until the device replaces it
+    int _reactor_failed_fd = -1;
+    // set while the uart thread sleeps without a timeout for this port
+    std::atomic<bool> _reactor_idle{false};
+
+    void _reactor_hang_up();
+    void _reactor_wakeup();
+
     // timestamp for receiving data on the UART, avoiding a lock
     uint64_t _receive_timestamp[2];
     uint8_t _receive_timestamp_idx;
@@ -100,6 +146,9 @@ protected:
     virtual int _write_fd(const uint8_t *buf, uint16_t n);
     virtual int _read_fd(uint8_t *buf, uint16_t n);
 
+    // descriptor that becomes readable with input, -1 to be polled periodically
+    virtual int _poll_fd() const { return _device->get_poll_fd(); }
+
     Linux::Semaphore _write_mutex;
 };
 
@@ -8,8 +8,10 @@
 #include <unistd.h>
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/TLSF.h>
 
 #include "Heat_Pwm.h"
+#include "Scheduler.h"
 #include "ToneAlarm_Disco.h"
 #include "Util.h"
 
@@ -93,6 +95,11 @@ uint32_t Util::available_memory(void)
     return 256*1024;
 }
 
+bool Util::get_thread_stats(uint8_t idx, ThreadStats &stats)
+{
+    return Scheduler::from(hal.scheduler)->get_thread_stats(idx, stats);
+}
+
 #ifndef HAL_LINUX_DEFAULT_SYSTEM_ID
 #define HAL_LINUX_DEFAULT_SYSTEM_ID "linux-unknown"
 #endif
@@ -233,56 +240,24 @@ int Util::get_hw_arm32()
 #ifdef ENABLE_HEAP
 void *Util::allocate_heap_memory(size_t size)
 {
-    struct heap *new_heap = (struct heap*)malloc(sizeof(struct heap));
-    if (new_heap != nullptr) {
-        new_heap->max_heap_size = size;
-        new_heap->current_heap_usage = 0;
-    }
-    return (void *)new_heap;
+    return TLSFHeap::create(size);
 }
 
-void *Util::heap_realloc(void *h, void *ptr, size_t new_size)
+void *Util::heap_realloc(void *heap, void *ptr, size_t new_size)
 {
-    if (h == nullptr) {
-        return nullptr;
-    }
-
-    struct heap *heapp = (struct heap*)h;
-
-    // extract appropriate headers
-    size_t old_size = 0;
-    heap_allocation_header *old_header = nullptr;
-    if (ptr != nullptr) {
-        old_header = ((heap_allocation_header *)ptr) - 1;
-        old_size = old_header->allocation_size;
-    }
-
-    if ((heapp->current_heap_usage + new_size - old_size) > heapp->max_heap_size) {
-        // fail the allocation as we don't have the memory. Note that we don't simulate fragmentation
+    if (heap == nullptr) {
         return nullptr;
     }
+    return ((TLSFHeap *)heap)->reallocate(ptr, new_size);
+}
 
-    heapp->current_heap_usage -= old_size;
-    if (new_size == 0) {
-       free(old_header);
-       return nullptr;
-    }
-
-    heap_allocation_header *new_header = (heap_allocation_header *)malloc(new_size + sizeof(heap_allocation_header));
-    if (new_header == nullptr) {
-        // total failure to allocate, this is very surprising in SITL
-        return nullptr;
-    }
-    heapp->current_heap_usage += new_size;
-    new_header->allocation_size = new_size;
-    void *new_mem = new_header + 1;
-
-    if (ptr == nullptr) {
-        return new_mem;
+bool Util::get_heap_stats(void *heap, HeapStats &stats)
+{
+    if (heap == nullptr) {
+        return false;
     }
-    memcpy(new_mem, ptr, old_size > new_size ? new_size : old_size);
-    free(old_header);
-    return new_mem;
+    ((TLSFHeap *)heap)->get_stats(stats);
+    return true;
 }
 
 #endif // ENABLE_HEAP
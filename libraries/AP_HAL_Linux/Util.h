@@ -56,6 +56,8 @@ public:
 
     uint32_t available_memory(void) override;
 
+    bool get_thread_stats(uint8_t idx, ThreadStats &stats) override;
+
     bool get_system_id(char buf[40]) override;
     bool get_system_id_unformatted(uint8_t buf[], uint8_t &len) override;
 
@@ -63,6 +65,7 @@ public:
     // heap functions, note that a heap once alloc'd cannot be dealloc'd
     virtual void *allocate_heap_memory(size_t size) override;
     virtual void *heap_realloc(void *h, void *ptr, size_t new_size) override;
+    bool get_heap_stats(void *heap, HeapStats &stats) override;
 #endif // ENABLE_HEAP
     
     /*
@@ -94,6 +97,11 @@ public:
         return Perf::get_singleton()->end(perf);
     }
 
+    void trace(trace_event event, const char *name, uint32_t arg) override
+    {
+        Perf_Lttng::trace(event, name, arg);
+    }
+
     void perf_count(perf_counter_t perf) override
     {
         return Perf::get_singleton()->count(perf);
@@ -119,18 +127,6 @@ private:
     const char *custom_terrain_directory = nullptr;
     const char *custom_storage_directory = nullptr;
     static const char *_hw_names[UTIL_NUM_HARDWARES];
-
-#ifdef ENABLE_HEAP
-    struct heap_allocation_header {
-        size_t allocation_size; // size of allocated block, not including this header
-    };
-
-    struct heap {
-      size_t max_heap_size;
-      size_t current_heap_usage;
-    };
-#endif // ENABLE_HEAP
-
 };
 
 }
@@ -0,0 +1,53 @@
+#include <AP_gbenchmark.h>
+#include <AP_HAL/AP_HAL.h>
+
+#if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_BEBOP
+
+#include <AP_HAL_Linux/Flow_PX4.h>
+
+/* flow between a random image and the same image moved by one pixel in
+ * x and y, at the size the onboard optical flow uses */
+static void BM_FlowPX4(benchmark::State& state)
+{
+    const uint32_t size = state.range_x();
+    uint8_t *image1, *image2;
+
+    image1 = (uint8_t *)malloc(size * size);
+    if (!image1) {
+        fprintf(stderr, "error: couldn't malloc image1\n");
+        return;
+    }
+
+    image2 = (uint8_t *)malloc(size * size);
+    if (!image2) {
+        fprintf(stderr, "error: couldn't malloc image2\n");
+        free(image1);
+        return;
+    }
+
+    for (uint32_t i = 0; i < size * size; i++) {
+        image1[i] = rand();
+    }
+    for (uint32_t i = 0; i < size * size; i++) {
+        image2[i] = image1[(i + size + 1) % (size * size)];
+    }
+
+    Linux::Flow_PX4 flow(size, size,
+                         HAL_FLOW_PX4_MAX_FLOW_PIXEL,
+                         HAL_FLOW_PX4_BOTTOM_FLOW_FEATURE_THRESHOLD,
+                         HAL_FLOW_PX4_BOTTOM_FLOW_VALUE_THRESHOLD);
+    float flow_x, flow_y;
+
+    while (state.KeepRunning()) {
+        uint8_t quality = flow.compute_flow(image1, image2, 0, &flow_x, &flow_y);
+        gbenchmark_escape(&quality);
+    }
+
+    free(image1);
+    free(image2);
+}
+
+BENCHMARK(BM_FlowPX4)->Arg(HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH)->Arg(128);
+#endif
+
+BENCHMARK_MAIN()
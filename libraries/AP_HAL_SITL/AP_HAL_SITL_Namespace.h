@@ -12,8 +12,10 @@ class ADCSource;
 class RCInput;
 class Util;
 class Semaphore;
+class BinarySemaphore;
 class GPIO;
 class DigitalSource;
 class HALSITLCAN;
 class HALSITLCANDriver;
+class Profiler;
 }  // namespace HALSITL
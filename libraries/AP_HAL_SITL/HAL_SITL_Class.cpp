@@ -233,6 +233,11 @@ void HAL_SITL::run(int argc, char * const argv[], Callbacks* callbacks) const
 
 void HAL_SITL::actually_reboot()
 {
+    HALSITL::Profiler *profiler = HALSITL::Profiler::get_singleton();
+    if (profiler != nullptr && profiler->enabled()) {
+        // exec skips atexit handlers
+        profiler->write();
+    }
     execv(new_argv[0], new_argv);
     AP_HAL::panic("PANIC: REBOOT FAILED: %s", strerror(errno));
 }
@@ -0,0 +1,159 @@
+#include <AP_HAL/AP_HAL.h>
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+
+#include "Profiler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+using namespace HALSITL;
+
+Profiler *Profiler::_singleton;
+volatile sig_atomic_t Profiler::_report_requested;
+
+static const char *section_names[] = {
+    "model",
+    "model_wait",
+    "sensors",
+    "timer_procs",
+    "io_procs",
+    "uart_io",
+};
+
+Profiler::Profiler()
+{
+    _singleton = this;
+}
+
+void Profiler::init(const char *path)
+{
+    static_assert(ARRAY_SIZE(section_names) == SECTION_COUNT, "section names must match");
+    _path = path;
+    reset();
+
+    struct sigaction sa_report = {};
+    sigemptyset(&sa_report.sa_mask);
+    sa_report.sa_handler = _sig_report;
+    sigaction(SIGUSR2, &sa_report, nullptr);
+
+    atexit(_atexit_report);
+    ::printf("Profiling to %s\n", _path);
+}
+
+uint64_t Profiler::wall_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec)*1000000ULL + ts.tv_nsec/1000U;
+}
+
+void Profiler::reset(void)
+{
+    memset(_sections, 0, sizeof(_sections));
+    for (uint16_t i=0; i<max_tasks; i++) {
+        _tasks[i].us = 0;
+        _tasks[i].count = 0;
+        _tasks[i].max_us = 0;
+    }
+    _start_us = wall_us();
+    _sim_start_us = _sim_time_us;
+}
+
+void Profiler::task_begin(const char *name, uint32_t index)
+{
+    if (index >= max_tasks) {
+        return;
+    }
+    _tasks[index].name = name;
+    _tasks[index].start_us = wall_us();
+}
+
+void Profiler::task_end(uint32_t index)
+{
+    if (index >= max_tasks || _tasks[index].start_us == 0) {
+        return;
+    }
+    task &t = _tasks[index];
+    const uint64_t dt = wall_us() - t.start_us;
+    t.us += dt;
+    t.count++;
+    if (dt > t.max_us) {
+        t.max_us = dt;
+    }
+}
+
+void Profiler::_sig_report(int signum)
+{
+    _report_requested = 1;
+}
+
+void Profiler::_atexit_report(void)
+{
+    if (_singleton != nullptr && _singleton->enabled()) {
+        _singleton->write();
+    }
+}
+
+void Profiler::update(uint64_t sim_time_us)
+{
+    _sim_time_us = sim_time_us;
+    if (_report_requested) {
+        _report_requested = 0;
+        write();
+        reset();
+    }
+}
+
+/*
+  write the report, replacing the file atomically so a reader never
+  sees a partial report
+ */
+void Profiler::write(void)
+{
+    char *tmp_path = nullptr;
+    if (asprintf(&tmp_path, "%s.tmp", _path) <= 0) {
+        return;
+    }
+    FILE *f = fopen(tmp_path, "w");
+    if (f == nullptr) {
+        free(tmp_path);
+        return;
+    }
+    _report_count++;
+    fprintf(f, "{\n  \"report\": %u,\n  \"wall_us\": %llu,\n  \"sim_us\": %llu,\n  \"sections\": {\n",
+            (unsigned)_report_count,
+            (unsigned long long)(wall_us() - _start_us),
+            (unsigned long long)(_sim_time_us - _sim_start_us));
+    for (uint8_t i=0; i<SECTION_COUNT; i++) {
+        fprintf(f, "    \"%s\": {\"us\": %llu, \"count\": %u}%s\n",
+                section_names[i],
+                (unsigned long long)_sections[i].us,
+                (unsigned)_sections[i].count,
+                i+1 < SECTION_COUNT ? "," : "");
+    }
+    fprintf(f, "  },\n  \"tasks\": [\n");
+    bool first = true;
+    for (uint16_t i=0; i<max_tasks; i++) {
+        const task &t = _tasks[i];
+        if (t.name == nullptr || t.count == 0) {
+            continue;
+        }
+        fprintf(f, "%s    {\"name\": \"%s\", \"us\": %llu, \"count\": %u, \"max_us\": %u}",
+                first ? "" : ",\n",
+                t.name,
+                (unsigned long long)t.us,
+                (unsigned)t.count,
+                (unsigned)t.max_us);
+        first = false;
+    }
+    fprintf(f, "\n  ]\n}\n");
+    const bool ok = fclose(f) == 0;
+    if (ok) {
+        rename(tmp_path, _path);
+    }
+    free(tmp_path);
+}
+
+#endif // CONFIG_HAL_BOARD == HAL_BOARD_SITL
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+
+#include "AP_HAL_SITL_Namespace.h"
+#include <signal.h>
+
+/*
+  wall clock profiler for SITL runs, enabled with --profile FILE.
+
+  Time is attributed to each scheduler task, to the physics model,
+  to the pacing and lockstep waits inside the model, to the sensor
+  simulators, to the HAL timer and IO processes and to moving bytes
+  through the UART sockets. The report is written as JSON at exit and
+  whenever SIGUSR2 is received, after which the counters restart, so
+  a test harness can take one report per test
+ */
+class HALSITL::Profiler {
+public:
+    Profiler();
+
+    enum Section : uint8_t {
+        SECTION_MODEL,          // Aircraft::update_model(), less waits
+        SECTION_MODEL_WAIT,     // pacing sleep and lockstep waits
+        SECTION_SENSORS,        // GPS, airspeed, rangefinder and device simulators
+        SECTION_TIMER_PROCS,    // HAL timer processes (sensor backends)
+        SECTION_IO_PROCS,       // HAL IO processes
+        SECTION_UART_IO,        // UART and storage timer ticks
+        SECTION_COUNT
+    };
+
+    static Profiler *get_singleton(void) { return _singleton; }
+
+    // start profiling, writing reports to path
+    void init(const char *path);
+
+    bool enabled(void) const { return _path != nullptr; }
+
+    // monotonic wall clock, independent of the simulation clock
+    static uint64_t wall_us(void);
+
+    // add time to a section
+    void add(Section section, uint64_t us) {
+        _sections[section].us += us;
+        _sections[section].count++;
+    }
+
+    // add the wall clock time spent in a scope to a section
+    class Scope {
+    public:
+        Scope(Section _section) :
+            profiler(get_singleton()),
+            section(_section) {
+            if (profiler != nullptr && profiler->enabled()) {
+                start_us = wall_us();
+            } else {
+                profiler = nullptr;
+            }
+        }
+        ~Scope() {
+            if (profiler != nullptr) {
+                profiler->add(section, wall_us() - start_us);
+            }
+        }
+    private:
+        Profiler *profiler;
+        Section section;
+        uint64_t start_us;
+    };
+
+    // scheduler task hooks, fed from Util::trace()
+    void task_begin(const char *name, uint32_t index);
+    void task_end(uint32_t index);
+
+    // write a report if one was asked for with SIGUSR2
+    void update(uint64_t sim_time_us);
+
+    // write a report now
+    void write(void);
+
+private:
+    static Profiler *_singleton;
+
+    const char *_path;
+    uint32_t _report_count;
+    uint64_t _start_us;
+    uint64_t _sim_start_us;
+    uint64_t _sim_time_us;
+
+    struct counter {
+        uint64_t us;
+        uint32_t count;
+    } _sections[SECTION_COUNT];
+
+    static const uint16_t max_tasks = 256;
+    struct task {
+        const char *name;
+        uint64_t us;
+        uint64_t start_us;
+        uint32_t count;
+        uint32_t max_us;
+    } _tasks[max_tasks];
+
+    void reset(void);
+
+    static void _sig_report(int signum);
+    static volatile sig_atomic_t _report_requested;
+    static void _atexit_report(void);
+};
+
+#endif // CONFIG_HAL_BOARD == HAL_BOARD_SITL
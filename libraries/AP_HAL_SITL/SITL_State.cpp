@@ -87,6 +87,7 @@ void SITL_State::_sitl_setup(const char *home_str)
         _update_airspeed(0);
         _update_gps(0, 0, 0, 0, 0, 0, 0, false);
         _update_rangefinder(0);
+        _sensor_publish();
 #endif
         if (enable_gimbal) {
             gimbal = new SITL::Gimbal(_sitl->state);
@@ -151,10 +152,14 @@ void SITL_State::_fdm_input_step(void)
 {
     static uint32_t last_pwm_input = 0;
 
+    // the sensor worker reads the state the model is about to update
+    _sensor_join();
+
     _fdm_input_local();
 
-    /* make sure we die if our parent dies */
-    if (kill(_parent_pid, 0) != 0) {
+    /* make sure we die if our parent dies. This is checked every
+       few hundred steps to keep syscalls out of the physics loop */
+    if (_update_count % 256 == 0 && kill(_parent_pid, 0) != 0) {
         exit(1);
     }
 
@@ -172,19 +177,30 @@ void SITL_State::_fdm_input_step(void)
 
     if (_update_count == 0 && _sitl != nullptr) {
         _update_gps(0, 0, 0, 0, 0, 0, 0, false);
+        _sensor_publish();
         _scheduler->timer_event();
         _scheduler->sitl_end_atomic();
         return;
     }
 
     if (_sitl != nullptr) {
-        _update_gps(_sitl->state.latitude, _sitl->state.longitude,
-                    _sitl->state.altitude,
-                    _sitl->state.speedN, _sitl->state.speedE, _sitl->state.speedD,
-                    _sitl->state.yawDeg,
-                    !_sitl->gps_disable);
-        _update_airspeed(_sitl->state.airspeed);
-        _update_rangefinder(_sitl->state.range);
+        Profiler::Scope scope(Profiler::SECTION_SENSORS);
+        _emulated.baro_pressure = _barometer ? _barometer->get_pressure() : 0;
+        if (_sensor_thread_enabled) {
+            if (!_sensor_thread_started) {
+                _sensor_thread_started = true;
+                if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&SITL_State::_sensor_thread, void),
+                                                  "sensors", 8192, AP_HAL::Scheduler::PRIORITY_TIMER, 0)) {
+                    AP_HAL::panic("Failed to create sensor thread");
+                }
+            }
+            // emulate this step's sensors while the vehicle code runs
+            _sensor_job_pending = true;
+            _sensor_job_start.signal();
+        } else {
+            _update_sensors();
+            _sensor_publish();
+        }
 
         if (_sitl->adsb_plane_count >= 0 &&
             adsb == nullptr) {
@@ -199,6 +215,236 @@ void SITL_State::_fdm_input_step(void)
     // trigger all APM timers.
     _scheduler->timer_event();
     _scheduler->sitl_end_atomic();
+
+    if (_snapshot_requested) {
+        _snapshot_requested = 0;
+        _snapshot_save();
+    }
+
+    if (_reset_requested) {
+        _reset_requested = 0;
+        _reset();
+    }
+
+    if (_profiler.enabled()) {
+        _profiler.update(AP_HAL::micros64());
+    }
+}
+
+/*
+  a snapshot file holds the physical state of the simulated vehicle
+  and the contents of HAL storage, so parameters, missions and
+  calibration come back with it. Estimator state is not saved; the
+  EKF initialises again from the restored sensors
+ */
+struct snapshot_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t storage_size;
+    uint32_t state_size;
+};
+static const uint32_t SNAPSHOT_MAGIC = 0x534E4150; // "SNAP"
+static const uint16_t SNAPSHOT_VERSION = 1;
+
+/*
+  emulate the sensors from the current simulator state
+ */
+void SITL_State::_update_sensors(void)
+{
+    _update_gps(_sitl->state.latitude, _sitl->state.longitude,
+                _sitl->state.altitude,
+                _sitl->state.speedN, _sitl->state.speedE, _sitl->state.speedD,
+                _sitl->state.yawDeg,
+                !_sitl->gps_disable);
+    _update_airspeed(_sitl->state.airspeed);
+    _update_rangefinder(_sitl->state.range);
+}
+
+/*
+  make the outputs of the last sensor emulation step visible to the
+  vehicle
+ */
+void SITL_State::_sensor_publish(void)
+{
+    sonar_pin_value = _emulated.sonar_pin_value;
+    airspeed_pin_value = _emulated.airspeed_pin_value;
+    airspeed_2_pin_value = _emulated.airspeed_2_pin_value;
+    _gps_publish();
+}
+
+/*
+  sensor emulation worker, enabled with --sensor-thread. It runs one
+  step at a time as handed over by _fdm_input_step()
+ */
+void SITL_State::_sensor_thread(void)
+{
+    while (true) {
+        _sensor_job_start.wait_blocking();
+        _update_sensors();
+        _sensor_job_done.signal();
+    }
+}
+
+/*
+  wait for the worker to finish the previous step and publish it
+ */
+void SITL_State::_sensor_join(void)
+{
+    if (!_sensor_job_pending) {
+        return;
+    }
+    _sensor_job_done.wait_blocking();
+    _sensor_job_pending = false;
+    _sensor_publish();
+}
+
+/*
+  random float between -1 and 1 for sensor noise. This has its own
+  generator (xorshift32) so the noise does not depend on which thread
+  runs the emulation or on other users of random()
+ */
+float SITL_State::_sensor_rand_float(void)
+{
+    uint32_t x = _sensor_rand_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    _sensor_rand_state = x;
+    return ((x % 2000000) - 1.0e6f) / 1.0e6f;
+}
+
+volatile sig_atomic_t SITL_State::_snapshot_requested;
+
+void SITL_State::_sig_snapshot(int signum)
+{
+    _snapshot_requested = 1;
+}
+
+/*
+  write a snapshot to the --snapshot-save path
+ */
+void SITL_State::_snapshot_save(void)
+{
+    if (_snapshot_save_path == nullptr) {
+        ::printf("Snapshot: no --snapshot-save path\n");
+        return;
+    }
+    const snapshot_header hdr {
+        SNAPSHOT_MAGIC,
+        SNAPSHOT_VERSION,
+        HAL_STORAGE_SIZE,
+        sizeof(SITL::Aircraft::snapshot_state)
+    };
+    SITL::Aircraft::snapshot_state state;
+    sitl_model->get_snapshot(state);
+    uint8_t *storage = new uint8_t[HAL_STORAGE_SIZE];
+    hal.storage->read_block(storage, 0, HAL_STORAGE_SIZE);
+
+    // write to a temporary file then rename, so a reader never sees
+    // a partial snapshot
+    char *tmp_path = nullptr;
+    if (asprintf(&tmp_path, "%s.tmp", _snapshot_save_path) <= 0) {
+        delete[] storage;
+        return;
+    }
+    FILE *f = fopen(tmp_path, "wb");
+    bool ok = f != nullptr &&
+              fwrite(&hdr, sizeof(hdr), 1, f) == 1 &&
+              fwrite(&state, sizeof(state), 1, f) == 1 &&
+              fwrite(storage, HAL_STORAGE_SIZE, 1, f) == 1;
+    if (f != nullptr && fclose(f) != 0) {
+        ok = false;
+    }
+    if (ok) {
+        ok = rename(tmp_path, _snapshot_save_path) == 0;
+    }
+    ::printf("Snapshot: save to %s at %.3fs %s\n",
+             _snapshot_save_path, state.time_now_us*1.0e-6, ok ? "OK" : "failed");
+    free(tmp_path);
+    delete[] storage;
+}
+
+volatile sig_atomic_t SITL_State::_reset_requested;
+
+void SITL_State::_sig_reset(int signum)
+{
+    _reset_requested = 1;
+}
+
+/*
+  reset the vehicle for the next test case, as asked for with SIGHUP.
+  The --reset-file holds lines of "snapshot PATH" and "seed N", both
+  optional. The vehicle libraries have no reset of their own, so we
+  start again in this process the way a reboot does, keeping the pid,
+  instance and ports, and load the snapshot and seed on the way up
+ */
+void SITL_State::_reset(void)
+{
+    if (_reset_path == nullptr) {
+        ::printf("Reset: no --reset-file path\n");
+        return;
+    }
+    FILE *f = fopen(_reset_path, "r");
+    if (f == nullptr) {
+        ::printf("Reset: failed to open %s\n", _reset_path);
+        return;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        char *saveptr = nullptr;
+        const char *key = strtok_r(line, " \t\r\n", &saveptr);
+        const char *value = strtok_r(nullptr, " \t\r\n", &saveptr);
+        if (key == nullptr || key[0] == '#') {
+            continue;
+        }
+        if (value != nullptr && strcmp(key, "snapshot") == 0) {
+            setenv("SITL_RESET_SNAPSHOT", value, 1);
+        } else if (value != nullptr && strcmp(key, "seed") == 0) {
+            setenv("SITL_RESET_SEED", value, 1);
+        } else {
+            ::printf("Reset: bad line in %s: %s\n", _reset_path, key);
+            fclose(f);
+            unsetenv("SITL_RESET_SNAPSHOT");
+            return;
+        }
+    }
+    fclose(f);
+    ::printf("Reset: restarting\n");
+    HAL_SITL::actually_reboot();
+}
+
+/*
+  start from a snapshot. Called after the model is created and before
+  the vehicle loads its parameters
+ */
+bool SITL_State::_snapshot_load(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == nullptr) {
+        ::printf("Snapshot: failed to open %s\n", path);
+        return false;
+    }
+    snapshot_header hdr;
+    SITL::Aircraft::snapshot_state state;
+    uint8_t *storage = new uint8_t[HAL_STORAGE_SIZE];
+    bool ok = fread(&hdr, sizeof(hdr), 1, f) == 1 &&
+              hdr.magic == SNAPSHOT_MAGIC &&
+              hdr.version == SNAPSHOT_VERSION &&
+              hdr.storage_size == HAL_STORAGE_SIZE &&
+              hdr.state_size == sizeof(state) &&
+              fread(&state, sizeof(state), 1, f) == 1 &&
+              fread(storage, HAL_STORAGE_SIZE, 1, f) == 1;
+    fclose(f);
+    if (!ok) {
+        ::printf("Snapshot: %s is not a snapshot from this build\n", path);
+        delete[] storage;
+        return false;
+    }
+    sitl_model->set_snapshot(state);
+    hal.storage->write_block(0, storage, HAL_STORAGE_SIZE);
+    delete[] storage;
+    ::printf("Snapshot: loaded %s at %.3fs\n", path, state.time_now_us*1.0e-6);
+    return true;
 }
 
 
@@ -215,14 +461,14 @@ void SITL_State::wait_clock(uint64_t wait_time_usec)
 }
 
 #define streq(a, b) (!strcmp(a, b))
-int SITL_State::sim_fd(const char *name, const char *arg)
+SITL::SerialPipe *SITL_State::sim_pipe(const char *name, const char *arg)
 {
     if (streq(name, "vicon")) {
         if (vicon != nullptr) {
             AP_HAL::panic("Only one vicon system at a time");
         }
         vicon = new SITL::Vicon();
-        return vicon->fd();
+        return vicon->pipe();
     }
     AP_HAL::panic("unknown simulated device: %s", name);
 }
@@ -333,7 +579,16 @@ void SITL_State::_fdm_input_local(void)
     _simulator_servos(input);
 
     // update the model
-    sitl_model->update_model(input);
+    if (_profiler.enabled()) {
+        const uint64_t start_us = Profiler::wall_us();
+        const uint64_t wait_us = sitl_model->get_wait_time_us();
+        sitl_model->update_model(input);
+        const uint64_t waited_us = sitl_model->get_wait_time_us() - wait_us;
+        _profiler.add(Profiler::SECTION_MODEL, Profiler::wall_us() - start_us - waited_us);
+        _profiler.add(Profiler::SECTION_MODEL_WAIT, waited_us);
+    } else {
+        sitl_model->update_model(input);
+    }
 
     // get FDM output from the model
     if (_sitl) {
@@ -347,18 +602,21 @@ void SITL_State::_fdm_input_local(void)
         }
     }
 
-    if (gimbal != nullptr) {
-        gimbal->update();
-    }
-    if (adsb != nullptr) {
-        adsb->update();
-    }
-    if (vicon != nullptr) {
-        Quaternion attitude;
-        sitl_model->get_attitude(attitude);
-        vicon->update(sitl_model->get_location(),
-                      sitl_model->get_position(),
-                      attitude);
+    {
+        Profiler::Scope scope(Profiler::SECTION_SENSORS);
+        if (gimbal != nullptr) {
+            gimbal->update();
+        }
+        if (adsb != nullptr) {
+            adsb->update();
+        }
+        if (vicon != nullptr) {
+            Quaternion attitude;
+            sitl_model->get_attitude(attitude);
+            vicon->update(sitl_model->get_location(),
+                          sitl_model->get_position(),
+                          attitude);
+        }
     }
 
     if (_sitl && _use_fg_view) {
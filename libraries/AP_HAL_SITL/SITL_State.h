@@ -8,8 +8,11 @@
 #include "AP_HAL_SITL_Namespace.h"
 #include "HAL_SITL_Class.h"
 #include "RCInput.h"
+#include "Profiler.h"
+#include "Semaphores.h"
 
 #include <sys/types.h>
+#include <signal.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <netinet/udp.h>
@@ -24,6 +27,8 @@
 #include <SITL/SIM_Gimbal.h>
 #include <SITL/SIM_ADSB.h>
 #include <SITL/SIM_Vicon.h>
+#include <SITL/SIM_SerialPipe.h>
+#include <SITL/SIM_Lockstep.h>
 #include <AP_HAL/utility/Socket.h>
 
 class HAL_SITL;
@@ -42,9 +47,8 @@ public:
         ArduSub
     };
 
-    int gps_pipe(void);
-    int gps2_pipe(void);
-    ssize_t gps_read(int fd, void *buf, size_t count);
+    // in-process serial pipe for simulated GPS instance 0 or 1
+    SITL::SerialPipe *gps_pipe(uint8_t instance);
     uint16_t pwm_output[SITL_NUM_CHANNELS];
     uint16_t pwm_input[SITL_RC_INPUT_CHANNELS];
     bool output_ready = false;
@@ -54,9 +58,9 @@ public:
         return _base_port;
     }
 
-    // create a file desciptor attached to a virtual device; type of
-    // device is given by name parameter
-    int sim_fd(const char *name, const char *arg);
+    // create an in-process serial pipe attached to a virtual device;
+    // type of device is given by name parameter
+    SITL::SerialPipe *sim_pipe(const char *name, const char *arg);
 
     bool use_rtscts(void) const {
         return _use_rtscts;
@@ -91,6 +95,22 @@ private:
     void _parse_command_line(int argc, char * const argv[]);
     void _set_param_default(const char *parm);
     void _usage(void);
+    void _setup_lockstep(const char *lockstep_str);
+
+    // snapshots of the vehicle state to fast-forward test scenarios
+    void _snapshot_save(void);
+    bool _snapshot_load(const char *path);
+    const char *_snapshot_save_path;
+    static void _sig_snapshot(int signum);
+    static volatile sig_atomic_t _snapshot_requested;
+
+    // test runner support: instance pool, seeding and in-place reset
+    uint8_t _claim_instance(void);
+    void _seed_random(uint32_t seed);
+    void _reset(void);
+    const char *_reset_path;
+    static void _sig_reset(int signum);
+    static volatile sig_atomic_t _reset_requested;
     void _sitl_setup(const char *home_str);
     void _setup_fdm(void);
     void _setup_timer(void);
@@ -138,6 +158,32 @@ private:
                      double speedN, double speedE, double speedD,
                      double yaw, bool have_lock);
     void _update_airspeed(float airspeed);
+
+    /*
+      sensor emulation for GPS, airspeed and rangefinder. Outputs go
+      to _emulated and the GPS staging buffers, and only reach the
+      vehicle through _sensor_publish(), so the emulation can run on
+      a worker thread one step behind the physics while staying
+      deterministic
+     */
+    void _update_sensors(void);
+    void _sensor_publish(void);
+    void _sensor_thread(void);
+    void _sensor_join(void);
+    void _gps_publish(void);
+    float _sensor_rand_float(void);
+    struct {
+        uint16_t sonar_pin_value;
+        uint16_t airspeed_pin_value;
+        uint16_t airspeed_2_pin_value;
+        float baro_pressure;    // input, captured on the main thread
+    } _emulated;
+    uint32_t _sensor_rand_state = 0x2545F491;
+    bool _sensor_thread_enabled;
+    bool _sensor_thread_started;
+    bool _sensor_job_pending;
+    BinarySemaphore _sensor_job_start;
+    BinarySemaphore _sensor_job_done;
     void _update_gps_instance(SITL::SITL::GPSType gps_type, const struct gps_data *d, uint8_t instance);
     void _check_rc_input(void);
     bool _read_rc_sitl_input();
@@ -222,6 +268,12 @@ private:
     // simulated vicon system:
     SITL::Vicon *vicon;
 
+    // physics lockstep with other instances
+    SITL::Lockstep *lockstep;
+
+    // wall clock profiler, enabled with --profile
+    Profiler _profiler;
+
     // output socket for flightgear viewing
     SocketAPM fg_socket{true};
     
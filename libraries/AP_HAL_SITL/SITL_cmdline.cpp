@@ -34,8 +34,10 @@
 #include <SITL/SIM_Scrimmage.h>
 #include <SITL/SIM_Webots.h>
 
+#include <fcntl.h>
 #include <signal.h>
 #include <stdio.h>
+#include <sys/file.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -68,6 +70,7 @@ void SITL_State::_usage(void)
            "\t--rate|-r RATE           set SITL framerate\n"
            "\t--console|-C             use console instead of TCP ports\n"
            "\t--instance|-I N          set instance of SITL (adds 10*instance to all port numbers)\n"
+           "\t                         N may be 'auto' to take the lowest instance not used by another SITL\n"
            // "\t--param|-P NAME=VALUE    set some param\n"  CURRENTLY BROKEN!
            "\t--synthetic-clock|-S     set synthetic clock mode\n"
            "\t--home|-O HOME           set start location (lat,lng,alt,yaw)\n"
@@ -93,6 +96,14 @@ void SITL_State::_usage(void)
            "\t--sim-port-in PORT       set port num for simulator in\n"
            "\t--sim-port-out PORT      set port num for simulator out\n"
            "\t--irlock-port PORT       set port num for irlock\n"
+           "\t--time-warp              run unpaced while disarmed and at rest on the ground\n"
+           "\t--snapshot-save FILE     save a snapshot of the vehicle state to FILE on SIGUSR1\n"
+           "\t--snapshot-load FILE     start from a snapshot saved with --snapshot-save\n"
+           "\t--seed N                 seed the simulation random number generators\n"
+           "\t--reset-file FILE        on SIGHUP, reset in place using the snapshot and seed given in FILE\n"
+           "\t--lockstep GROUP[:MS]    step physics in lockstep with other instances in GROUP, at most MS ahead (default 5)\n"
+           "\t--sensor-thread          run GPS, airspeed and rangefinder emulation on a worker thread, one step behind\n"
+           "\t--profile FILE           write a JSON wall clock profile to FILE at exit and on SIGUSR2\n"
         );
 }
 
@@ -160,6 +171,16 @@ void SITL_State::_set_signal_handlers(void) const
     sa_segv.sa_handler = _sig_segv;
     sigaction(SIGSEGV, &sa_segv, nullptr);
 
+    struct sigaction sa_snapshot = {};
+    sigemptyset(&sa_snapshot.sa_mask);
+    sa_snapshot.sa_handler = _sig_snapshot;
+    sigaction(SIGUSR1, &sa_snapshot, nullptr);
+
+    struct sigaction sa_reset = {};
+    sigemptyset(&sa_reset.sa_mask);
+    sa_reset.sa_handler = _sig_reset;
+    sigaction(SIGHUP, &sa_reset, nullptr);
+
 }
 
 void SITL_State::_parse_command_line(int argc, char * const argv[])
@@ -171,6 +192,10 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
     // default to CMAC
     const char *home_str = nullptr;
     const char *model_str = nullptr;
+    const char *lockstep_str = nullptr;
+    const char *snapshot_load_path = nullptr;
+    uint32_t seed = 0;
+    bool time_warp = false;
     _use_fg_view = true;
     char *autotest_dir = nullptr;
     _fg_address = "127.0.0.1";
@@ -211,6 +236,14 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         CMDLINE_SIM_PORT_IN,
         CMDLINE_SIM_PORT_OUT,
         CMDLINE_IRLOCK_PORT,
+        CMDLINE_LOCKSTEP,
+        CMDLINE_SNAPSHOT_SAVE,
+        CMDLINE_SNAPSHOT_LOAD,
+        CMDLINE_TIME_WARP,
+        CMDLINE_PROFILE,
+        CMDLINE_SENSOR_THREAD,
+        CMDLINE_SEED,
+        CMDLINE_RESET_FILE,
     };
 
     const struct GetOptLong::option options[] = {
@@ -246,6 +279,14 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         {"sim-port-in",     true,   0, CMDLINE_SIM_PORT_IN},
         {"sim-port-out",    true,   0, CMDLINE_SIM_PORT_OUT},
         {"irlock-port",     true,   0, CMDLINE_IRLOCK_PORT},
+        {"lockstep",        true,   0, CMDLINE_LOCKSTEP},
+        {"snapshot-save",   true,   0, CMDLINE_SNAPSHOT_SAVE},
+        {"snapshot-load",   true,   0, CMDLINE_SNAPSHOT_LOAD},
+        {"time-warp",       false,  0, CMDLINE_TIME_WARP},
+        {"profile",         true,   0, CMDLINE_PROFILE},
+        {"sensor-thread",   false,  0, CMDLINE_SENSOR_THREAD},
+        {"seed",            true,   0, CMDLINE_SEED},
+        {"reset-file",      true,   0, CMDLINE_RESET_FILE},
         {0, false, 0, 0}
     };
 
@@ -282,7 +323,11 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
             HALSITL::UARTDriver::_console = true;
             break;
         case 'I': {
-            _instance = atoi(gopt.optarg);
+            if (strcmp(gopt.optarg, "auto") == 0) {
+                _instance = _claim_instance();
+            } else {
+                _instance = atoi(gopt.optarg);
+            }
             if (_base_port == BASE_PORT) {
                 _base_port += _instance * 10;
             }
@@ -364,6 +409,30 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         case CMDLINE_IRLOCK_PORT:
             _irlock_port = atoi(gopt.optarg);
             break;
+        case CMDLINE_LOCKSTEP:
+            lockstep_str = gopt.optarg;
+            break;
+        case CMDLINE_SNAPSHOT_SAVE:
+            _snapshot_save_path = gopt.optarg;
+            break;
+        case CMDLINE_SNAPSHOT_LOAD:
+            snapshot_load_path = gopt.optarg;
+            break;
+        case CMDLINE_TIME_WARP:
+            time_warp = true;
+            break;
+        case CMDLINE_PROFILE:
+            _profiler.init(gopt.optarg);
+            break;
+        case CMDLINE_SENSOR_THREAD:
+            _sensor_thread_enabled = true;
+            break;
+        case CMDLINE_SEED:
+            seed = strtoul(gopt.optarg, nullptr, 0);
+            break;
+        case CMDLINE_RESET_FILE:
+            _reset_path = gopt.optarg;
+            break;
         default:
             _usage();
             exit(1);
@@ -375,6 +444,22 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         exit(1);
     }
 
+    // a reset from the --reset-file replaces the snapshot and seed
+    // given on the command line
+    const char *reset_seed = getenv("SITL_RESET_SEED");
+    if (reset_seed != nullptr) {
+        seed = strtoul(reset_seed, nullptr, 0);
+    }
+    char *reset_snapshot = getenv("SITL_RESET_SNAPSHOT");
+    if (reset_snapshot != nullptr) {
+        snapshot_load_path = strdup(reset_snapshot);
+        // a later reboot keeps the storage it has
+        unsetenv("SITL_RESET_SNAPSHOT");
+    }
+    if (seed != 0) {
+        _seed_random(seed);
+    }
+
     for (uint8_t i=0; i < ARRAY_SIZE(model_constructors); i++) {
         if (strncasecmp(model_constructors[i].name, model_str, strlen(model_constructors[i].name)) == 0) {
             // printf("Creating model %f,%f,%f,%f at speed %.1f\n", opos.lat, opos.lng, opos.alt, opos.hdg, speedup);
@@ -393,6 +478,14 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
             sitl_model->set_instance(_instance);
             sitl_model->set_autotest_dir(autotest_dir);
             sitl_model->set_config(config);
+            sitl_model->set_time_warp(time_warp);
+            if (lockstep_str != nullptr) {
+                _setup_lockstep(lockstep_str);
+            }
+            if (snapshot_load_path != nullptr &&
+                !_snapshot_load(snapshot_load_path)) {
+                exit(1);
+            }
             _synthetic_clock_mode = true;
             break;
         }
@@ -431,6 +524,82 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
     _sitl_setup(home_str);
 }
 
+/*
+  take the lowest free instance number, so a harness running many
+  vehicles at once does not have to share out ports itself. An
+  instance is held with a lock on a file per instance for the life of
+  the process. The lock is kept over exec and the instance passed on
+  in the environment, so a reboot keeps its ports
+ */
+uint8_t SITL_State::_claim_instance(void)
+{
+    const char *claimed = getenv("SITL_INSTANCE_CLAIMED");
+    if (claimed != nullptr) {
+        return atoi(claimed);
+    }
+    const char *dir = getenv("TMPDIR");
+    if (dir == nullptr) {
+        dir = "/tmp";
+    }
+    for (uint8_t i=0; i<SITL::Lockstep::max_members; i++) {
+        char *path = nullptr;
+        if (asprintf(&path, "%s/ardupilot-sitl-%u.lock", dir, (unsigned)i) <= 0) {
+            break;
+        }
+        int fd = open(path, O_RDWR|O_CREAT, 0644);
+        free(path);
+        if (fd == -1) {
+            continue;
+        }
+        if (flock(fd, LOCK_EX|LOCK_NB) == 0) {
+            char instance_str[4];
+            snprintf(instance_str, sizeof(instance_str), "%u", (unsigned)i);
+            setenv("SITL_INSTANCE_CLAIMED", instance_str, 1);
+            ::printf("SITL instance %u\n", (unsigned)i);
+            return i;
+        }
+        close(fd);
+    }
+    ::printf("No free SITL instance\n");
+    exit(1);
+}
+
+/*
+  seed every random number generator the simulation uses, so a run
+  with a given seed reproduces exactly
+ */
+void SITL_State::_seed_random(uint32_t seed)
+{
+    srandom(seed);
+    srand(seed);
+    // xorshift must not start at zero
+    _sensor_rand_state = seed ^ 0x2545F491;
+    if (_sensor_rand_state == 0) {
+        _sensor_rand_state = 0x2545F491;
+    }
+    ::printf("Random seed %u\n", (unsigned)seed);
+}
+
+/*
+  join the lockstep group given as GROUP[:WINDOW_MS]
+ */
+void SITL_State::_setup_lockstep(const char *lockstep_str)
+{
+    char *group = strdup(lockstep_str);
+    uint32_t window_ms = 5;
+    char *colon = strchr(group, ':');
+    if (colon != nullptr) {
+        *colon = 0;
+        window_ms = strtoul(colon+1, nullptr, 10);
+    }
+    lockstep = new SITL::Lockstep();
+    if (!lockstep->init(group, _instance, window_ms*1000U)) {
+        exit(1);
+    }
+    sitl_model->set_lockstep(lockstep);
+    free(group);
+}
+
 /*
   parse a home string into a location and yaw
  */
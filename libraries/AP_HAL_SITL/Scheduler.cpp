@@ -3,6 +3,7 @@
 #include "AP_HAL_SITL.h"
 #include "Scheduler.h"
 #include "UARTDriver.h"
+#include "Profiler.h"
 #include <sys/time.h>
 #include <fenv.h>
 #include <AP_BoardConfig/AP_BoardConfig.h>
@@ -200,9 +201,12 @@ void Scheduler::_run_timer_procs()
     _in_timer_proc = true;
 
     // now call the timer based drivers
-    for (int i = 0; i < _num_timer_procs; i++) {
-        if (_timer_proc[i]) {
-            _timer_proc[i]();
+    {
+        Profiler::Scope scope(Profiler::SECTION_TIMER_PROCS);
+        for (int i = 0; i < _num_timer_procs; i++) {
+            if (_timer_proc[i]) {
+                _timer_proc[i]();
+            }
         }
     }
 
@@ -222,23 +226,29 @@ void Scheduler::_run_io_procs()
     _in_io_proc = true;
 
     // now call the IO based drivers
-    for (int i = 0; i < _num_io_procs; i++) {
-        if (_io_proc[i]) {
-            _io_proc[i]();
+    {
+        Profiler::Scope scope(Profiler::SECTION_IO_PROCS);
+        for (int i = 0; i < _num_io_procs; i++) {
+            if (_io_proc[i]) {
+                _io_proc[i]();
+            }
         }
     }
 
     _in_io_proc = false;
 
-    hal.uartA->_timer_tick();
-    hal.uartB->_timer_tick();
-    hal.uartC->_timer_tick();
-    hal.uartD->_timer_tick();
-    hal.uartE->_timer_tick();
-    hal.uartF->_timer_tick();
-    hal.uartG->_timer_tick();
-    hal.uartH->_timer_tick();
-    hal.storage->_timer_tick();
+    {
+        Profiler::Scope scope(Profiler::SECTION_UART_IO);
+        hal.uartA->_timer_tick();
+        hal.uartB->_timer_tick();
+        hal.uartC->_timer_tick();
+        hal.uartD->_timer_tick();
+        hal.uartE->_timer_tick();
+        hal.uartF->_timer_tick();
+        hal.uartG->_timer_tick();
+        hal.uartH->_timer_tick();
+        hal.storage->_timer_tick();
+    }
 
 #if SITL_STACK_CHECKING_ENABLED
     check_thread_stacks();
@@ -52,4 +52,58 @@ bool Semaphore::take_nonblocking()
     return pthread_mutex_trylock(&_lock) == 0;
 }
 
+/*
+  construct a binary semaphore. Waits are timed on the host monotonic
+  clock rather than simulated time, as the thread signalling us may be
+  waiting on the main thread which drives the simulation
+ */
+BinarySemaphore::BinarySemaphore() :
+    _pending(false)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&_cond, &attr);
+    pthread_mutex_init(&_lock, nullptr);
+}
+
+bool BinarySemaphore::wait(uint32_t timeout_us)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    const uint64_t nsec = ts.tv_nsec + uint64_t(timeout_us) * 1000ULL;
+    ts.tv_sec += nsec / 1000000000ULL;
+    ts.tv_nsec = nsec % 1000000000ULL;
+
+    pthread_mutex_lock(&_lock);
+    while (!_pending) {
+        if (pthread_cond_timedwait(&_cond, &_lock, &ts) != 0) {
+            break;
+        }
+    }
+    const bool ret = _pending;
+    _pending = false;
+    pthread_mutex_unlock(&_lock);
+    return ret;
+}
+
+bool BinarySemaphore::wait_blocking()
+{
+    pthread_mutex_lock(&_lock);
+    while (!_pending) {
+        pthread_cond_wait(&_cond, &_lock);
+    }
+    _pending = false;
+    pthread_mutex_unlock(&_lock);
+    return true;
+}
+
+void BinarySemaphore::signal()
+{
+    pthread_mutex_lock(&_lock);
+    _pending = true;
+    pthread_cond_signal(&_cond);
+    pthread_mutex_unlock(&_lock);
+}
+
 #endif  // CONFIG_HAL_BOARD
@@ -1,10 +1,12 @@
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
 
 #include <assert.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/mman.h>
 #include "Storage.h"
 
 #include <stdio.h>
@@ -37,6 +39,14 @@ void Storage::_storage_open(void)
         hal.console->printf("open failed of " HAL_STORAGE_FILE "\n");
         return;
     }
+#if HAL_STORAGE_USE_MMAP
+    if (_storage_map()) {
+        using_filesystem = true;
+        _initialised = true;
+        return;
+    }
+    // fall back to a RAM copy
+#endif
     int ret = read(log_fd, _buffer, HAL_STORAGE_SIZE);
     if (ret < 0) {
         hal.console->printf("read failed for " HAL_STORAGE_FILE "\n");
@@ -60,6 +70,32 @@ void Storage::_storage_open(void)
     _initialised = true;
 }
 
+#if HAL_STORAGE_USE_MMAP
+/*
+  map the storage file, growing it to full size first. The page cache
+  then holds the only copy of the data, so opening costs no reads and
+  writes reach the file without a system call each
+*/
+bool Storage::_storage_map(void)
+{
+    struct stat st;
+    if (fstat(log_fd, &st) != 0) {
+        return false;
+    }
+    if (st.st_size < HAL_STORAGE_SIZE &&
+        ftruncate(log_fd, HAL_STORAGE_SIZE) != 0) {
+        return false;
+    }
+    void *map = mmap(nullptr, HAL_STORAGE_SIZE, PROT_READ|PROT_WRITE, MAP_SHARED, log_fd, 0);
+    if (map == MAP_FAILED) {
+        hal.console->printf("mmap failed for " HAL_STORAGE_FILE "\n");
+        return false;
+    }
+    _buffer = (uint8_t *)map;
+    return true;
+}
+#endif // HAL_STORAGE_USE_MMAP
+
 /*
   mark some lines as dirty. Note that there is no attempt to avoid
   the race condition between this code and the _timer_tick() code
@@ -82,7 +118,7 @@ void Storage::_mark_dirty(uint16_t loc, uint16_t length)
 
 void Storage::read_block(void *dst, uint16_t loc, size_t n)
 {
-    if (loc >= sizeof(_buffer)-(n-1)) {
+    if (loc >= HAL_STORAGE_SIZE-(n-1)) {
         return;
     }
     _storage_open();
@@ -91,13 +127,16 @@ void Storage::read_block(void *dst, uint16_t loc, size_t n)
 
 void Storage::write_block(uint16_t loc, const void *src, size_t n)
 {
-    if (loc >= sizeof(_buffer)-(n-1)) {
+    if (loc >= HAL_STORAGE_SIZE-(n-1)) {
         return;
     }
     if (memcmp(src, &_buffer[loc], n) != 0) {
         _storage_open();
         memcpy(&_buffer[loc], src, n);
         _mark_dirty(loc, n);
+        _stats.bytes_dirtied += n;
+        _last_write_ms = AP_HAL::millis();
+        _compact_pending = true;
     }
 }
 
@@ -106,13 +145,40 @@ void Storage::_timer_tick(void)
     if (!_initialised) {
         return;
     }
+    const uint32_t now_ms = AP_HAL::millis();
     if (_dirty_mask.empty()) {
-        _last_empty_ms = AP_HAL::millis();
+        _last_empty_ms = now_ms;
+        _flash_compact();
         return;
     }
 
-    // write out the first dirty line. We don't write more
-    // than one to keep the latency of this call to a minimum
+    if (now_ms - _last_write_ms < HAL_STORAGE_COALESCE_MS &&
+        now_ms - _last_empty_ms < HAL_STORAGE_COALESCE_MAX_MS) {
+        // writes are still arriving, let them build up
+        return;
+    }
+
+#if HAL_STORAGE_USE_MMAP
+    if (_buffer != _ram_buffer) {
+        // the data is already in the mapping, so all that is left is
+        // to hand every dirty page to the kernel in one call. The mask
+        // is cleared first so a write racing with us is synced next time
+        const uint32_t start_us = AP_HAL::micros();
+        const uint16_t nlines = _dirty_mask.count();
+        _dirty_mask.clearall();
+        if (msync(_buffer, HAL_STORAGE_SIZE, MS_ASYNC) != 0) {
+            _mark_dirty(0, HAL_STORAGE_SIZE);
+            return;
+        }
+        _stats.bytes_written += nlines * STORAGE_LINE_SIZE;
+        _stats.writes++;
+        _stats.stall_max_us = MAX(_stats.stall_max_us, AP_HAL::micros() - start_us);
+        return;
+    }
+#endif
+
+    // write out the first run of dirty lines. We don't write more
+    // than one run to keep the latency of this call to a minimum
     uint16_t i;
     for (i=0; i<STORAGE_NUM_LINES; i++) {
         if (_dirty_mask.get(i)) {
@@ -123,24 +189,39 @@ void Storage::_timer_tick(void)
         // this shouldn't be possible
         return;
     }
+    uint8_t nlines = 1;
+    while (nlines < STORAGE_MAX_WRITE_LINES &&
+           i + nlines < STORAGE_NUM_LINES &&
+           _dirty_mask.get(i + nlines)) {
+        nlines++;
+    }
+
+    const uint32_t start_us = AP_HAL::micros();
 
 #if STORAGE_USE_POSIX
     if (using_filesystem && log_fd != -1) {
         const off_t offset = STORAGE_LINE_SIZE*i;
+        const ssize_t length = STORAGE_LINE_SIZE*nlines;
         if (lseek(log_fd, offset, SEEK_SET) != offset) {
             return;
         }
-        if (write(log_fd, &_buffer[offset], STORAGE_LINE_SIZE) != STORAGE_LINE_SIZE) {
+        if (write(log_fd, &_buffer[offset], length) != length) {
             return;
         }
-        _dirty_mask.clear(i);
+        _stats.bytes_written += length;
+        _stats.writes++;
+        for (uint8_t n=0; n<nlines; n++) {
+            _dirty_mask.clear(i+n);
+        }
+        _stats.stall_max_us = MAX(_stats.stall_max_us, AP_HAL::micros() - start_us);
         return;
     } 
 #endif
     
 #if STORAGE_USE_FLASH
     // save to storage backend
-    _flash_write(i);
+    _flash_write(i, nlines);
+    _stats.stall_max_us = MAX(_stats.stall_max_us, AP_HAL::micros() - start_us);
 #endif
 }
 
@@ -159,18 +240,45 @@ void Storage::_flash_load(void)
 }
 
 /*
-  write one storage line. This also updates _dirty_mask. 
+  write a run of storage lines. This also updates _dirty_mask.
 */
-void Storage::_flash_write(uint16_t line)
+void Storage::_flash_write(uint16_t line, uint8_t nlines)
 {
 #if STORAGE_USE_FLASH
-    if (_flash.write(line*STORAGE_LINE_SIZE, STORAGE_LINE_SIZE)) {
-        // mark the line clean
-        _dirty_mask.clear(line);
+    if (_flash.write(line*STORAGE_LINE_SIZE, nlines*STORAGE_LINE_SIZE)) {
+        // mark the lines clean
+        for (uint8_t n=0; n<nlines; n++) {
+            _dirty_mask.clear(line+n);
+        }
     }
 #endif
 }
 
+/*
+  compact the flash log while disarmed and idle, so the sector erase it
+  needs is not forced by a write at a worse time
+*/
+void Storage::_flash_compact(void)
+{
+#if STORAGE_USE_FLASH
+    if (!_compact_pending ||
+        AP_HAL::millis() - _last_write_ms < HAL_STORAGE_COMPACT_IDLE_MS ||
+        !_flash_erase_ok()) {
+        return;
+    }
+    // only look again once there have been more writes
+    _compact_pending = false;
+    if (!_flash.compaction_advised()) {
+        return;
+    }
+    const uint32_t start_us = AP_HAL::micros();
+    if (_flash.switch_full_sector()) {
+        _stats.compactions++;
+    }
+    _stats.stall_max_us = MAX(_stats.stall_max_us, AP_HAL::micros() - start_us);
+#endif
+}
+
 
 #if STORAGE_USE_FLASH
 /*
@@ -242,6 +350,10 @@ bool Storage::_flash_write_data(uint8_t sector, uint32_t offset, const uint8_t *
 {
     size_t base_address = sitl_flash_getpageaddr(sector);
     bool ret = sitl_flash_write(base_address+offset, data, length);
+    if (ret) {
+        _stats.bytes_written += length;
+        _stats.writes++;
+    }
     if (!ret && _flash_erase_ok()) {
         // we are getting flash write errors while disarmed. Try
         // re-writing all of flash
@@ -270,7 +382,11 @@ bool Storage::_flash_read_data(uint8_t sector, uint32_t offset, uint8_t *data, u
  */
 bool Storage::_flash_erase_sector(uint8_t sector)
 {
-    return sitl_flash_erasepage(sector);
+    if (!sitl_flash_erasepage(sector)) {
+        return false;
+    }
+    _stats.erases++;
+    return true;
 }
 
 /*
@@ -292,4 +408,11 @@ bool Storage::healthy(void)
     return _initialised && AP_HAL::millis() - _last_empty_ms < 2000;
 }
 
-
+/*
+  get write statistics
+ */
+bool Storage::get_stats(Stats &stats)
+{
+    stats = _stats;
+    return true;
+}
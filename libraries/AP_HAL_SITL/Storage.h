@@ -17,11 +17,35 @@
 
 #define STORAGE_USE_POSIX 1
 
+// map the storage file into memory instead of reading it into a RAM
+// copy and writing dirty lines back with write(). The file layout is
+// unchanged, so either mode can open a file written by the other
+#ifndef HAL_STORAGE_USE_MMAP
+#define HAL_STORAGE_USE_MMAP !STORAGE_USE_FLASH
+#endif
+
 #define STORAGE_LINE_SHIFT 3
 
 #define STORAGE_LINE_SIZE (1<<STORAGE_LINE_SHIFT)
 #define STORAGE_NUM_LINES (HAL_STORAGE_SIZE/STORAGE_LINE_SIZE)
 
+// up to this many contiguous dirty lines are written in one go
+#define STORAGE_MAX_WRITE_LINES 8
+
+// dirty lines are held back until writes have paused for this long,
+// but never for longer than HAL_STORAGE_COALESCE_MAX_MS
+#ifndef HAL_STORAGE_COALESCE_MS
+#define HAL_STORAGE_COALESCE_MS 50
+#endif
+#ifndef HAL_STORAGE_COALESCE_MAX_MS
+#define HAL_STORAGE_COALESCE_MAX_MS 500
+#endif
+
+// flash compaction is only done when disarmed and idle for this long
+#ifndef HAL_STORAGE_COMPACT_IDLE_MS
+#define HAL_STORAGE_COMPACT_IDLE_MS 5000
+#endif
+
 class HALSITL::Storage : public AP_HAL::Storage {
 public:
     void init() override {}
@@ -30,6 +54,7 @@ public:
 
     void _timer_tick(void) override;
     bool healthy(void) override;
+    bool get_stats(Stats &stats) override;
 
 private:
     volatile bool _initialised;
@@ -37,7 +62,9 @@ private:
     void _storage_open(void);
     void _save_backup(void);
     void _mark_dirty(uint16_t loc, uint16_t length);
-    uint8_t _buffer[HAL_STORAGE_SIZE] __attribute__((aligned(4)));
+    uint8_t _ram_buffer[HAL_STORAGE_SIZE] __attribute__((aligned(4)));
+    // points at _ram_buffer, or at the file mapping once it is open
+    uint8_t *_buffer = _ram_buffer;
     Bitmask<STORAGE_NUM_LINES> _dirty_mask;
 
 #if STORAGE_USE_FLASH
@@ -50,9 +77,12 @@ private:
     bool _flash_failed;
     uint32_t _last_re_init_ms;
     uint32_t _last_empty_ms;
+    uint32_t _last_write_ms;
+    bool _compact_pending;
+    Stats _stats;
 
 #if STORAGE_USE_FLASH
-    AP_FlashStorage _flash{_buffer,
+    AP_FlashStorage _flash{_ram_buffer,
             HAL_STORAGE_SIZE,
             FUNCTOR_BIND_MEMBER(&Storage::_flash_write_data, bool, uint8_t, uint32_t, const uint8_t *, uint16_t),
             FUNCTOR_BIND_MEMBER(&Storage::_flash_read_data, bool, uint8_t, uint32_t, uint8_t *, uint16_t),
@@ -61,10 +91,14 @@ private:
 #endif
     
     void _flash_load(void);
-    void _flash_write(uint16_t line);
+    void _flash_write(uint16_t line, uint8_t nlines);
+    void _flash_compact(void);
 
 #if STORAGE_USE_POSIX
     bool using_filesystem;
     int log_fd;
 #endif
+#if HAL_STORAGE_USE_MMAP
+    bool _storage_map(void);
+#endif
 };
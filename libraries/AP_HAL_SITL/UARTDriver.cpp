@@ -65,12 +65,10 @@ void UARTDriver::begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace)
     
     if (strcmp(path, "GPS1") == 0) {
         /* gps */
-        _connected = true;
-        _fd = _sitlState->gps_pipe();
+        _sim_pipe_start(_sitlState->gps_pipe(0));
     } else if (strcmp(path, "GPS2") == 0) {
         /* 2nd gps */
-        _connected = true;
-        _fd = _sitlState->gps2_pipe();
+        _sim_pipe_start(_sitlState->gps_pipe(1));
     } else {
         /* parse type:args:flags string for path. 
            For example:
@@ -108,8 +106,7 @@ void UARTDriver::begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace)
         } else if (strcmp(devtype, "sim") == 0) {
             ::printf("SIM connection %s:%s on port %u\n", args1, args2, _portNumber);
             if (!_connected) {
-                _connected = true;
-                _fd = _sitlState->sim_fd(args1, args2);
+                _sim_pipe_start(_sitlState->sim_pipe(args1, args2));
             }
         } else if (strcmp(devtype, "udpclient") == 0) {
             // udp client connection
@@ -138,7 +135,21 @@ void UARTDriver::begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace)
         _writebuffer.clear();
     }
 
-    _set_nonblocking(_fd);
+    if (_fd != -1) {
+        _set_nonblocking(_fd);
+    }
+}
+
+/*
+  connect the port to a simulated device in this process. The device
+  writes into our read buffer and reads from our write buffer
+  directly, so _timer_tick() has nothing to move for this port
+ */
+void UARTDriver::_sim_pipe_start(SITL::SerialPipe *pipe)
+{
+    _sim_pipe = pipe;
+    _sim_pipe->attach(&_readbuffer, &_writebuffer);
+    _connected = true;
 }
 
 void UARTDriver::end()
@@ -184,6 +195,14 @@ int16_t UARTDriver::read(void)
     return c;
 }
 
+ssize_t UARTDriver::read(uint8_t *buffer, uint16_t count)
+{
+    if (available() <= 0) {
+        return 0;
+    }
+    return _readbuffer.read(buffer, count);
+}
+
 int16_t UARTDriver::read_stale(void)
 {
     if (available() <= 0) {
@@ -231,6 +250,22 @@ size_t UARTDriver::write(const uint8_t *buffer, size_t size)
     return size;
 }
 
+/*
+  reserve space in the write buffer to be filled in place
+ */
+bool UARTDriver::write_reserve(ByteBuffer::IoVec vec[2], uint32_t len)
+{
+    if (_unbuffered_writes || txspace() < len) {
+        return false;
+    }
+    return _writebuffer.reserve(vec, len) != 0;
+}
+
+void UARTDriver::write_commit(uint32_t len)
+{
+    _writebuffer.commit(len);
+}
+
     
 /*
   start a TCP connection for the serial port. If wait_for_connection
@@ -636,6 +671,10 @@ void UARTDriver::_timer_tick(void)
         _check_reconnect();
         return;
     }
+    if (_sim_pipe != nullptr) {
+        // the simulated device uses our buffers directly
+        return;
+    }
     ssize_t nwritten;
     uint32_t max_bytes = 10000;
     SITL::SITL *_sitl = AP::sitl();
@@ -761,7 +800,7 @@ void UARTDriver::_timer_tick(void)
 */
 uint64_t UARTDriver::receive_time_constraint_us(uint16_t nbytes)
 {
-    uint64_t last_receive_us = _receive_timestamp;
+    uint64_t last_receive_us = _sim_pipe ? _sim_pipe->last_write_time_us() : _receive_timestamp;
     if (_uart_baudrate > 0) {
         // assume 10 bits per byte. 
         uint32_t transport_time_us = (1000000UL * 10UL / _uart_baudrate) * (nbytes+available());
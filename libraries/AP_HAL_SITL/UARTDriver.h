@@ -8,6 +8,7 @@
 #include "AP_HAL_SITL_Namespace.h"
 #include <AP_HAL/utility/Socket.h>
 #include <AP_HAL/utility/RingBuffer.h>
+#include <SITL/SIM_SerialPipe.h>
 
 class HALSITL::UARTDriver : public AP_HAL::UARTDriver {
 public:
@@ -46,12 +47,17 @@ public:
     uint32_t available() override;
     uint32_t txspace() override;
     int16_t read() override;
+    ssize_t read(uint8_t *buffer, uint16_t count) override;
     int16_t read_stale();
 
     /* Implementations of Print virtual methods */
     size_t write(uint8_t c) override;
     size_t write(const uint8_t *buffer, size_t size) override;
 
+    // fill the transmit buffer in place
+    bool write_reserve(ByteBuffer::IoVec vec[2], uint32_t len) override;
+    void write_commit(uint32_t len) override;
+
     // file descriptor, exposed so SITL_State::loop_hook() can use it
     int _fd;
 
@@ -110,6 +116,7 @@ private:
     void _tcp_start_client(const char *address, uint16_t port);
     void _udp_start_client(const char *address, uint16_t port);
     void _udp_start_multicast(const char *address, uint16_t port);
+    void _sim_pipe_start(SITL::SerialPipe *pipe);
     void _check_connection(void);
     static bool _select_check(int );
     static void _set_nonblocking(int );
@@ -119,6 +126,8 @@ private:
     uint64_t _receive_timestamp;
     bool _is_udp;
     bool _packetise;
+    // in-process pipe to a simulated device, or nullptr
+    SITL::SerialPipe *_sim_pipe;
     uint16_t _mc_myport;
     uint32_t last_tick_us;
 };
@@ -1,4 +1,6 @@
 #include "Util.h"
+#include "Profiler.h"
+#include <AP_HAL/utility/TLSF.h>
 #include <sys/time.h>
 
 #ifdef WITH_SITL_TONEALARM
@@ -71,56 +73,42 @@ bool HALSITL::Util::get_system_id(char buf[40])
 #ifdef ENABLE_HEAP
 void *HALSITL::Util::allocate_heap_memory(size_t size)
 {
-    struct heap *new_heap = (struct heap*)malloc(sizeof(struct heap));
-    if (new_heap != nullptr) {
-        new_heap->scripting_max_heap_size = size;
-        new_heap->current_heap_usage = 0;
-    }
-    return (void *)new_heap;
+    return TLSFHeap::create(size);
 }
 
-void *HALSITL::Util::heap_realloc(void *heap_ptr, void *ptr, size_t new_size)
+void *HALSITL::Util::heap_realloc(void *heap, void *ptr, size_t new_size)
 {
-    if (heap_ptr == nullptr) {
+    if (heap == nullptr) {
         return nullptr;
     }
+    return ((TLSFHeap *)heap)->reallocate(ptr, new_size);
+}
 
-    struct heap *heapp = (struct heap*)heap_ptr;
-
-    // extract appropriate headers
-    size_t old_size = 0;
-    heap_allocation_header *old_header = nullptr;
-    if (ptr != nullptr) {
-        old_header = ((heap_allocation_header *)ptr) - 1;
-        old_size = old_header->allocation_size;
-    }
-
-    if ((heapp->current_heap_usage + new_size - old_size) > heapp->scripting_max_heap_size) {
-        // fail the allocation as we don't have the memory. Note that we don't simulate fragmentation
-        return nullptr;
+bool HALSITL::Util::get_heap_stats(void *heap, HeapStats &stats)
+{
+    if (heap == nullptr) {
+        return false;
     }
+    ((TLSFHeap *)heap)->get_stats(stats);
+    return true;
+}
 
-    heapp->current_heap_usage -= old_size;
-    if (new_size == 0) {
-       free(old_header);
-       return nullptr;
-    }
+#endif // ENABLE_HEAP
 
-    heap_allocation_header *new_header = (heap_allocation_header *)malloc(new_size + sizeof(heap_allocation_header));
-    if (new_header == nullptr) {
-        // total failure to allocate, this is very surprising in SITL
-        return nullptr;
+void HALSITL::Util::trace(trace_event event, const char *name, uint32_t arg)
+{
+    Profiler *profiler = Profiler::get_singleton();
+    if (profiler == nullptr || !profiler->enabled()) {
+        return;
     }
-    heapp->current_heap_usage += new_size;
-    new_header->allocation_size = new_size;
-    void *new_mem = new_header + 1;
-
-    if (ptr == nullptr) {
-        return new_mem;
+    switch (event) {
+    case TRACE_TASK_BEGIN:
+        profiler->task_begin(name, arg);
+        break;
+    case TRACE_TASK_END:
+        profiler->task_end(arg);
+        break;
+    default:
+        break;
     }
-    memcpy(new_mem, ptr, old_size > new_size ? new_size : old_size);
-    free(old_header);
-    return new_mem;
 }
-
-#endif // ENABLE_HEAP
@@ -38,6 +38,7 @@ public:
     // heap functions, note that a heap once alloc'd cannot be dealloc'd
     void *allocate_heap_memory(size_t size) override;
     void *heap_realloc(void *heap, void *ptr, size_t new_size) override;
+    bool get_heap_stats(void *heap, HeapStats &stats) override;
 #endif // ENABLE_HEAP
 
 #ifdef WITH_SITL_TONEALARM
@@ -47,6 +48,9 @@ public:
     }
 #endif
 
+    // feed scheduler task events to the --profile profiler
+    void trace(trace_event event, const char *name, uint32_t arg) override;
+
     // return true if the reason for the reboot was a watchdog reset
     bool was_watchdog_reset() const override { return getenv("SITL_WATCHDOG_RESET") != nullptr; }
     
@@ -56,15 +60,4 @@ private:
 #ifdef WITH_SITL_TONEALARM
     static ToneAlarm_SF _toneAlarm;
 #endif
-
-#ifdef ENABLE_HEAP
-    struct heap_allocation_header {
-        size_t allocation_size; // size of allocated block, not including this header
-    };
-
-    struct heap {
-      size_t scripting_max_heap_size;
-      size_t current_heap_usage;
-    };
-#endif // ENABLE_HEAP
 };
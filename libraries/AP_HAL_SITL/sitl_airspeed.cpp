@@ -34,19 +34,19 @@ void SITL_State::_update_airspeed(float airspeed)
     airspeed = is_zero(_sitl->arspd_fail) ? airspeed : _sitl->arspd_fail;
     airspeed2 = is_zero(_sitl->arspd2_fail) ? airspeed2 : _sitl->arspd2_fail;
     // Add noise
-    airspeed = airspeed + (_sitl->arspd_noise * rand_float());
-    airspeed2 = airspeed2 + (_sitl->arspd_noise * rand_float());
+    airspeed = airspeed + (_sitl->arspd_noise * _sensor_rand_float());
+    airspeed2 = airspeed2 + (_sitl->arspd_noise * _sensor_rand_float());
 
     if (!is_zero(_sitl->arspd_fail_pressure)) {
         // compute a realistic pressure report given some level of trapper air pressure in the tube and our current altitude
         // algorithm taken from https://en.wikipedia.org/wiki/Calibrated_airspeed#Calculation_from_impact_pressure
-        float tube_pressure = fabsf(_sitl->arspd_fail_pressure - _barometer->get_pressure() + _sitl->arspd_fail_pitot_pressure);
+        float tube_pressure = fabsf(_sitl->arspd_fail_pressure - _emulated.baro_pressure + _sitl->arspd_fail_pitot_pressure);
         airspeed = 340.29409348 * sqrt(5 * (pow((tube_pressure / SSL_AIR_PRESSURE + 1), 2.0/7.0) - 1.0));
     }
     if (!is_zero(_sitl->arspd2_fail_pressure)) {
         // compute a realistic pressure report given some level of trapper air pressure in the tube and our current altitude
         // algorithm taken from https://en.wikipedia.org/wiki/Calibrated_airspeed#Calculation_from_impact_pressure
-        float tube_pressure = fabsf(_sitl->arspd2_fail_pressure - _barometer->get_pressure() + _sitl->arspd2_fail_pitot_pressure);
+        float tube_pressure = fabsf(_sitl->arspd2_fail_pressure - _emulated.baro_pressure + _sitl->arspd2_fail_pitot_pressure);
         airspeed2 = 340.29409348 * sqrt(5 * (pow((tube_pressure / SSL_AIR_PRESSURE + 1), 2.0/7.0) - 1.0));
     }
 
@@ -60,11 +60,11 @@ void SITL_State::_update_airspeed(float airspeed)
     float airspeed_raw = airspeed_pressure + airspeed_offset;
     float airspeed2_raw = airspeed2_pressure + airspeed_offset;
     if (airspeed_raw / 4 > 0xFFFF) {
-        airspeed_pin_value = 0xFFFF;
+        _emulated.airspeed_pin_value = 0xFFFF;
         return;
     }
     if (airspeed2_raw / 4 > 0xFFFF) {
-        airspeed_2_pin_value = 0xFFFF;
+        _emulated.airspeed_2_pin_value = 0xFFFF;
         return;
     }
     // add delay
@@ -103,8 +103,8 @@ void SITL_State::_update_airspeed(float airspeed)
         airspeed2_raw = buffer_wind_2[best_index_wind].data;
     }
 
-    airspeed_pin_value = airspeed_raw / 4;
-    airspeed_2_pin_value = airspeed2_raw / 4;
+    _emulated.airspeed_pin_value = airspeed_raw / 4;
+    _emulated.airspeed_2_pin_value = airspeed2_raw / 4;
 }
 
 #endif
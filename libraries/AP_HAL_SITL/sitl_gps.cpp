@@ -19,7 +19,6 @@
 #include "UARTDriver.h"
 #include <AP_GPS/AP_GPS.h>
 #include <AP_GPS/AP_GPS_UBLOX.h>
-#include <sys/ioctl.h>
 #include <unistd.h>
 #include <time.h>
 #include <stdio.h>
@@ -38,91 +37,58 @@ static uint8_t gps_delay;
 
 // state of GPS emulation
 static struct gps_state {
-    /* pipe emulating UBLOX GPS serial stream */
-    int gps_fd, client_fd;
+    /* in-process pipe emulating UBLOX GPS serial stream */
+    SITL::SerialPipe pipe;
+    /* bytes generated this step, moved to the pipe by _gps_publish() */
+    ByteBuffer staged{4096};
     uint32_t last_update; // milliseconds
-} gps_state, gps2_state;
+} gps_state[2];
 
 /*
-  hook for reading from the GPS pipe
+  return the in-process pipe for a GPS instance
  */
-ssize_t SITL_State::gps_read(int fd, void *buf, size_t count)
+SITL::SerialPipe *SITL_State::gps_pipe(uint8_t instance)
 {
-#ifdef FIONREAD
-    // use FIONREAD to get exact value if possible
-    int num_ready;
-    while (ioctl(fd, FIONREAD, &num_ready) == 0 && num_ready > 3000) {
-        // the pipe is filling up - drain it
-        uint8_t tmp[128];
-        if (read(fd, tmp, sizeof(tmp)) != sizeof(tmp)) {
-            break;
-        }
+    if (!gps_state[instance].pipe.attached()) {
+        gps_state[instance].last_update = AP_HAL::millis();
     }
-#endif
-    return read(fd, buf, count);
+    return &gps_state[instance].pipe;
 }
 
 /*
-  setup GPS input pipe
+  write some bytes from the simulated GPS
  */
-int SITL_State::gps_pipe(void)
+void SITL_State::_gps_write(const uint8_t *p, uint16_t size, uint8_t instance)
 {
-    int fd[2];
-    if (gps_state.client_fd != 0) {
-        return gps_state.client_fd;
+    if (instance == 1 && !_sitl->gps2_enable) {
+        return;
     }
-    pipe(fd);
-    gps_state.gps_fd    = fd[1];
-    gps_state.client_fd = fd[0];
-    gps_state.last_update = AP_HAL::millis();
-    fcntl(fd[0], F_SETFD, FD_CLOEXEC);
-    fcntl(fd[1], F_SETFD, FD_CLOEXEC);
-    HALSITL::UARTDriver::_set_nonblocking(gps_state.gps_fd);
-    HALSITL::UARTDriver::_set_nonblocking(fd[0]);
-    return gps_state.client_fd;
-}
-
-/*
-  setup GPS2 input pipe
- */
-int SITL_State::gps2_pipe(void)
-{
-    int fd[2];
-    if (gps2_state.client_fd != 0) {
-        return gps2_state.client_fd;
+    ByteBuffer &staged = gps_state[instance].staged;
+    if (_sitl->gps_byteloss <= 0.0f) {
+        staged.write(p, size);
+        return;
+    }
+    while (size--) {
+        float r = (_sensor_rand_float() + 1.0f) * 50;
+        if (r >= _sitl->gps_byteloss) {
+            staged.write(p, 1);
+        }
+        p++;
     }
-    pipe(fd);
-    gps2_state.gps_fd    = fd[1];
-    gps2_state.client_fd = fd[0];
-    gps2_state.last_update = AP_HAL::millis();
-    HALSITL::UARTDriver::_set_nonblocking(gps2_state.gps_fd);
-    HALSITL::UARTDriver::_set_nonblocking(fd[0]);
-    return gps2_state.client_fd;
 }
 
 /*
-  write some bytes from the simulated GPS
+  hand the bytes generated by the GPS emulation to the UARTs
  */
-void SITL_State::_gps_write(const uint8_t *p, uint16_t size, uint8_t instance)
+void SITL_State::_gps_publish(void)
 {
-    while (size--) {
-        if (_sitl->gps_byteloss > 0.0f) {
-            float r = ((((unsigned)random()) % 1000000)) / 1.0e4;
-            if (r < _sitl->gps_byteloss) {
-                // lose the byte
-                p++;
-                continue;
-            }
-        }
-        if (instance == 0 && gps_state.gps_fd != 0) {
-            write(gps_state.gps_fd, p, 1);
-        }
-        if (instance == 1 && _sitl->gps2_enable) {
-            if (gps2_state.gps_fd != 0) {
-                write(gps2_state.gps_fd, p, 1);
-            }
+    for (struct gps_state &gps : gps_state) {
+        uint32_t n;
+        const uint8_t *p;
+        while ((p = gps.staged.readptr(n)) != nullptr && n > 0) {
+            gps.pipe.write(p, n);
+            gps.staged.advance(n);
         }
-        p++;
     }
 }
 
@@ -1169,7 +1135,6 @@ void SITL_State::_update_gps(double latitude, double longitude, float altitude,
                              double yaw, bool have_lock)
 {
     struct gps_data d;
-    char c;
 
     // simulate delayed lock times
     if (AP_HAL::millis() < _sitl->gps_lock_time*1000UL) {
@@ -1193,20 +1158,16 @@ void SITL_State::_update_gps(double latitude, double longitude, float altitude,
     }
 
     // run at configured GPS rate (default 5Hz)
-    if ((AP_HAL::millis() - gps_state.last_update) < (uint32_t)(1000/_sitl->gps_hertz)) {
+    if ((AP_HAL::millis() - gps_state[0].last_update) < (uint32_t)(1000/_sitl->gps_hertz)) {
         return;
     }
 
     // swallow any config bytes
-    if (gps_state.gps_fd != 0) {
-        read(gps_state.gps_fd, &c, 1);
-    }
-    if (gps2_state.gps_fd != 0) {
-        read(gps2_state.gps_fd, &c, 1);
-    }
+    gps_state[0].pipe.skip_input();
+    gps_state[1].pipe.skip_input();
 
-    gps_state.last_update = AP_HAL::millis();
-    gps2_state.last_update = AP_HAL::millis();
+    gps_state[0].last_update = AP_HAL::millis();
+    gps_state[1].last_update = AP_HAL::millis();
 
     d.latitude = latitude;
     d.longitude = longitude;
@@ -1274,7 +1235,7 @@ void SITL_State::_update_gps(double latitude, double longitude, float altitude,
         }
     }
 
-    if (gps_state.gps_fd == 0 && gps2_state.gps_fd == 0) {
+    if (!gps_state[0].pipe.attached() && !gps_state[1].pipe.attached()) {
         return;
     }
     // Creating GPS2 data by coping GPS data
@@ -1292,10 +1253,10 @@ void SITL_State::_update_gps(double latitude, double longitude, float altitude,
     d2.longitude += glitch_offsets.y;
     d2.altitude += glitch_offsets.z;
 
-    if (gps_state.gps_fd != 0) {
+    if (gps_state[0].pipe.attached()) {
         _update_gps_instance((SITL::SITL::GPSType)_sitl->gps_type.get(), &d, 0);
     }
-    if (gps2_state.gps_fd != 0) {
+    if (gps_state[1].pipe.attached()) {
         _update_gps_instance((SITL::SITL::GPSType)_sitl->gps2_type.get(), &d2, 1);
     }
 }
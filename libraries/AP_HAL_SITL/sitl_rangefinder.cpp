@@ -52,7 +52,7 @@ void SITL_State::_update_rangefinder(float range_value)
             altitude /= cosf(radians(_sitl->state.rollDeg)) * cosf(radians(_sitl->state.pitchDeg));
         }
         // Add some noise on reading
-        altitude += _sitl->sonar_noise * rand_float();
+        altitude += _sitl->sonar_noise * _sensor_rand_float();
 
         // Altitude in in m, scaler in meters/volt
         voltage = altitude / _sitl->sonar_scale;
@@ -60,12 +60,12 @@ void SITL_State::_update_rangefinder(float range_value)
         voltage = constrain_float(voltage, 0.0f, 5.0f);
 
         // Use glitch defines as the probablility between 0-1 that any given sonar sample will read as max distance
-        if (!is_zero(_sitl->sonar_glitch) && _sitl->sonar_glitch >= (rand_float() + 1.0f) / 2.0f) {
+        if (!is_zero(_sitl->sonar_glitch) && _sitl->sonar_glitch >= (_sensor_rand_float() + 1.0f) / 2.0f) {
             voltage = 5.0f;
         }
     }
 
-    sonar_pin_value = 1023 * (voltage / 5.0f);
+    _emulated.sonar_pin_value = 1023 * (voltage / 5.0f);
 }
 
 #endif
@@ -35,6 +35,7 @@
 #include <AP_Notify/AP_Notify.h>
 #include <AP_Mission/AP_Mission.h>
 #include <AP_InertialSensor/AP_InertialSensor.h>
+#include <AP_SerialManager/AP_SerialFrame.h>
 #include <stdio.h>
 
 #define PROT_BINARY   0x80
@@ -377,6 +378,7 @@ void AP_Hott_Telem::send_packet(const uint8_t *b, uint8_t len)
 {
     // initial delay
     hal.scheduler->delay_microseconds(BYTE_DELAY_FIRST_US);
+    const uint8_t *start = b;
     uint8_t crc = 0;
     while (len) {
         uint8_t ob = *b;
@@ -391,6 +393,10 @@ void AP_Hott_Telem::send_packet(const uint8_t *b, uint8_t len)
     }
     uart->write(crc);
 
+    // the bytes are paced by sleeping so only the frame and bytes are
+    // counted, not the time spent
+    AP_SerialFrame::record(AP_SerialFrame::Protocol::HOTT, (b - start) + 1, 0);
+
     // discard any bytes received during the send
     hal.scheduler->delay_microseconds(BYTE_DELAY_US*2);
     while (uart->available() != 0) {
@@ -104,6 +104,8 @@ void AP_IOMCU::thread_main(void)
     uart.set_blocking_writes(true);
     uart.set_unbuffered_writes(true);
 
+    link.start_us = AP_HAL::micros();
+
     trigger_event(IOEVENT_INIT);
 
     while (!do_shutdown) {
@@ -120,8 +122,13 @@ void AP_IOMCU::thread_main(void)
                 event_failed(IOEVENT_INIT);
                 continue;
             }
-            is_chibios_backend = (config.protocol_version == IOMCU_PROTOCOL_VERSION &&
-                                  config.protocol_version2 == IOMCU_PROTOCOL_VERSION2);
+            // version2 10 is a ChibiOS firmware from before
+            // CODE_WRITE_READ was added
+            have_combined = (config.protocol_version == IOMCU_PROTOCOL_VERSION &&
+                             config.protocol_version2 == IOMCU_PROTOCOL_VERSION2);
+            is_chibios_backend = have_combined ||
+                                 (config.protocol_version == IOMCU_PROTOCOL_VERSION &&
+                                  config.protocol_version2 == 10);
 
             // set IO_ARM_OK and FMU_ARMED
             if (!modify_register(PAGE_SETUP, PAGE_REG_SETUP_ARMING, 0,
@@ -209,15 +216,26 @@ void AP_IOMCU::thread_main(void)
 
         // check for regular timed events
         uint32_t now = AP_HAL::millis();
+
+        // while outputs are being sent the RC input and status pages
+        // come back with each output update, so only need handling
+        const bool combined_active = have_combined && now - combined.last_reply_ms < 50;
+
         if (now - last_rc_read_ms > 20) {
             // read RC input at 50Hz
-            read_rc_input();
+            if (!combined_active) {
+                read_rc_input();
+            }
             last_rc_read_ms = AP_HAL::millis();
         }
 
         if (now - last_status_read_ms > 50) {
             // read status at 20Hz
-            read_status();
+            if (combined_active) {
+                handle_status();
+            } else {
+                read_status();
+            }
             last_status_read_ms = AP_HAL::millis();
         }
 
@@ -272,7 +290,13 @@ void AP_IOMCU::send_servo_out()
         uint32_t now = AP_HAL::micros();
         if (now - last_servo_out_us >= 2000) {
             // don't send data at more than 500Hz
-            if (write_registers(PAGE_DIRECT_PWM, 0, n, pwm_out.pwm)) {
+            bool ok;
+            if (have_combined) {
+                ok = send_combined(n);
+            } else {
+                ok = write_registers(PAGE_DIRECT_PWM, 0, n, pwm_out.pwm);
+            }
+            if (ok) {
                 last_servo_out_us = now;
             }
         }
@@ -288,6 +312,14 @@ void AP_IOMCU::read_rc_input()
     if (!read_registers(PAGE_RAW_RCIN, 0, sizeof(rc_input)/2, r)) {
         return;
     }
+    handle_rc_input();
+}
+
+/*
+  handle new RC input
+ */
+void AP_IOMCU::handle_rc_input()
+{
     if (rc_input.flags_failsafe && rc().ignore_rc_failsafe()) {
         rc_input.flags_failsafe = false;
     }
@@ -306,6 +338,14 @@ void AP_IOMCU::read_status()
         read_status_errors++;
         return;
     }
+    handle_status();
+}
+
+/*
+  handle new status registers
+ */
+void AP_IOMCU::handle_status()
+{
     if (read_status_ok == 0) {
         // reset error count on first good read
         read_status_errors = 0;
@@ -347,15 +387,27 @@ void AP_IOMCU::read_status()
 // @Field: Nerr: Protocol failures on MCU side
 // @Field: Nerr2: Reported number of failures on IOMCU side
 // @Field: NDel: Number of delayed packets received by MCU
-        AP::logger().Write("IOMC", "TimeUS,Mem,TS,NPkt,Nerr,Nerr2,NDel", "QHIIIII",
+// @Field: Util: Percentage of the time the link was busy
+// @Field: RTT: Average request to reply time in microseconds
+// @Field: RTTX: Maximum request to reply time in microseconds
+        const uint32_t now_us = AP_HAL::micros();
+        // 10 bits per byte at 1.5MBit, transfers are half duplex
+        const float busy_us = link.bytes * 10 / 1.5f;
+        const uint32_t dt_us = MAX(now_us - link.start_us, 1U);
+        AP::logger().Write("IOMC", "TimeUS,Mem,TS,NPkt,Nerr,Nerr2,NDel,Util,RTT,RTTX", "QHIIIIIBII",
                            AP_HAL::micros64(),
                            reg_status.freemem,
                            reg_status.timestamp_ms,
                            reg_status.total_pkts,
                            total_errors,
                            reg_status.num_errors,
-                           num_delayed);
+                           num_delayed,
+                           uint8_t(MIN(busy_us * 100 / dt_us, 100)),
+                           link.rtt_count ? link.rtt_sum_us / link.rtt_count : 0,
+                           link.rtt_max_us);
         }
+        link = {};
+        link.start_us = AP_HAL::micros();
 #if IOMCU_DEBUG_ENABLE
         static uint32_t last_io_print;
         if (now - last_io_print >= 5000) {
@@ -420,6 +472,9 @@ size_t AP_IOMCU::write_wait(const uint8_t *pkt, uint8_t len)
 */
 bool AP_IOMCU::read_registers(uint8_t page, uint8_t offset, uint8_t count, uint16_t *regs)
 {
+    // don't let an outstanding reply be taken for ours
+    finish_combined();
+
     while (count > PKT_MAX_REGS) {
         if (!read_registers(page, offset, PKT_MAX_REGS, regs)) {
             return false;
@@ -456,6 +511,7 @@ bool AP_IOMCU::read_registers(uint8_t page, uint8_t offset, uint8_t count, uint1
     pkt.crc = crc_crc8((const uint8_t *)&pkt, pkt_size);
 
     size_t ret = write_wait((uint8_t *)&pkt, pkt_size);
+    const uint32_t sent_us = AP_HAL::micros();
 
     if (ret != pkt_size) {
         debug("write failed1 %u %u %u\n", unsigned(pkt_size), page, offset);
@@ -470,6 +526,7 @@ bool AP_IOMCU::read_registers(uint8_t page, uint8_t offset, uint8_t count, uint1
         protocol_fail_count++;
         return false;
     }
+    const uint32_t rtt_us = AP_HAL::micros() - sent_us;
 
     uint8_t *b = (uint8_t *)&pkt;
     uint8_t n = uart.available();
@@ -511,6 +568,7 @@ bool AP_IOMCU::read_registers(uint8_t page, uint8_t offset, uint8_t count, uint1
         return false;
     }
     memcpy(regs, pkt.regs, count*2);
+    update_link_stats(pkt_size + n, rtt_us);
     if (protocol_fail_count > IOMCU_MAX_REPEATED_FAILURES) {
         handle_repeated_failures();
     }
@@ -525,6 +583,9 @@ bool AP_IOMCU::read_registers(uint8_t page, uint8_t offset, uint8_t count, uint1
 */
 bool AP_IOMCU::write_registers(uint8_t page, uint8_t offset, uint8_t count, const uint16_t *regs)
 {
+    // don't let an outstanding reply be taken for ours
+    finish_combined();
+
     while (count > PKT_MAX_REGS) {
         if (!write_registers(page, offset, PKT_MAX_REGS, regs)) {
             return false;
@@ -549,6 +610,7 @@ bool AP_IOMCU::write_registers(uint8_t page, uint8_t offset, uint8_t count, cons
 
     const uint8_t pkt_size = pkt.get_size();
     size_t ret = write_wait((uint8_t *)&pkt, pkt_size);
+    const uint32_t sent_us = AP_HAL::micros();
 
     if (ret != pkt_size) {
         debug("write failed2 %u %u %u %u\n", pkt_size, page, offset, ret);
@@ -562,6 +624,7 @@ bool AP_IOMCU::write_registers(uint8_t page, uint8_t offset, uint8_t count, cons
         protocol_fail_count++;
         return false;
     }
+    const uint32_t rtt_us = AP_HAL::micros() - sent_us;
 
     uint8_t *b = (uint8_t *)&pkt;
     uint8_t n = uart.available();
@@ -586,15 +649,137 @@ bool AP_IOMCU::write_registers(uint8_t page, uint8_t offset, uint8_t count, cons
         protocol_fail_count++;
         return false;
     }
+    update_link_stats(pkt_size + n, rtt_us);
+    if (protocol_fail_count > IOMCU_MAX_REPEATED_FAILURES) {
+        handle_repeated_failures();
+    }
+    total_errors += protocol_fail_count;
+    protocol_fail_count = 0;
+    protocol_count++;
+    return true;
+}
+
+/*
+  send output values with CODE_WRITE_READ. The reply is collected by
+  finish_combined() before the next transfer, so we don't wait here
+*/
+bool AP_IOMCU::send_combined(uint8_t n)
+{
+    finish_combined();
+
+    IOPacket pkt;
+
+    discard_input();
+
+    pkt.code = CODE_WRITE_READ;
+    pkt.count = n;
+    pkt.page = PAGE_DIRECT_PWM;
+    pkt.offset = 0;
+    pkt.crc = 0;
+    memcpy(pkt.regs, pwm_out.pwm, 2*n);
+    pkt.crc = crc_crc8((const uint8_t *)&pkt, pkt.get_size());
+
+    const uint8_t pkt_size = pkt.get_size();
+    size_t ret = write_wait((uint8_t *)&pkt, pkt_size);
+
+    if (ret != pkt_size) {
+        debug("write failed3 %u %u\n", pkt_size, ret);
+        protocol_fail_count++;
+        return false;
+    }
+    combined.pending = true;
+    combined.sent_us = AP_HAL::micros();
+    update_link_stats(pkt_size, 0);
+    return true;
+}
+
+/*
+  collect the reply to the last send_combined(), which is the RC
+  input page followed by the status page
+*/
+void AP_IOMCU::finish_combined(void)
+{
+    if (!combined.pending) {
+        return;
+    }
+    combined.pending = false;
+
+    const uint8_t rc_size = sizeof(rc_input) + 4;
+    const uint8_t len = rc_size + sizeof(reg_status) + 4;
+
+    // we only know the round trip time if the reply is still to come
+    const bool waited = uart.available() < len;
+    if (!uart.wait_timeout(len, 10)) {
+        debug("t=%u timeout combined\n", AP_HAL::millis());
+        protocol_fail_count++;
+        return;
+    }
+    const uint32_t rtt_us = waited ? AP_HAL::micros() - combined.sent_us : 0;
+
+    uint8_t b[len];
+    const uint32_t n = uart.available();
+    if (n != len) {
+        debug("t=%u bad combined len %u\n", AP_HAL::millis(), unsigned(n));
+        protocol_fail_count++;
+        return;
+    }
+    for (uint8_t i=0; i<len; i++) {
+        b[i] = uart.read();
+    }
+
+    struct page_rc_input rc;
+    struct page_reg_status status;
+    if (!parse_reply(&b[0], PAGE_RAW_RCIN, sizeof(rc)/2, (uint16_t *)&rc) ||
+        !parse_reply(&b[rc_size], PAGE_STATUS, sizeof(status)/2, (uint16_t *)&status)) {
+        debug("t=%u bad combined reply\n", AP_HAL::millis());
+        protocol_fail_count++;
+        return;
+    }
+    rc_input = rc;
+    reg_status = status;
+    handle_rc_input();
+    combined.last_reply_ms = AP_HAL::millis();
+
+    update_link_stats(len, rtt_us);
     if (protocol_fail_count > IOMCU_MAX_REPEATED_FAILURES) {
         handle_repeated_failures();
     }
     total_errors += protocol_fail_count;
     protocol_fail_count = 0;
     protocol_count++;
+}
+
+/*
+  check one packet of a combined reply, copying out its registers
+*/
+bool AP_IOMCU::parse_reply(const uint8_t *b, uint8_t page, uint8_t count, uint16_t *regs)
+{
+    IOPacket pkt;
+    memcpy(&pkt, b, count*2 + 4);
+    const uint8_t got_crc = pkt.crc;
+    pkt.crc = 0;
+    if (pkt.code != CODE_SUCCESS || pkt.page != page || pkt.count != count ||
+        crc_crc8((const uint8_t *)&pkt, pkt.get_size()) != got_crc) {
+        return false;
+    }
+    memcpy(regs, pkt.regs, count*2);
     return true;
 }
 
+/*
+  account for a transfer of bytes in both directions, with rtt_us
+  zero if the round trip time is not known
+*/
+void AP_IOMCU::update_link_stats(uint32_t bytes, uint32_t rtt_us)
+{
+    link.bytes += bytes;
+    if (rtt_us != 0) {
+        link.rtt_sum_us += rtt_us;
+        link.rtt_count++;
+        link.rtt_max_us = MAX(link.rtt_max_us, rtt_us);
+    }
+}
+
 // modify a single register
 bool AP_IOMCU::modify_register(uint8_t page, uint8_t offset, uint16_t clearbits, uint16_t setbits)
 {
@@ -156,8 +156,14 @@ private:
 
     void send_servo_out(void);
     void read_rc_input(void);
+    void handle_rc_input(void);
     void read_servo(void);
     void read_status(void);
+    void handle_status(void);
+    bool send_combined(uint8_t n);
+    void finish_combined(void);
+    bool parse_reply(const uint8_t *b, uint8_t page, uint8_t count, uint16_t *regs);
+    void update_link_stats(uint32_t bytes, uint32_t rtt_us);
     void discard_input(void);
     void event_failed(uint8_t event);
     void update_safety_options(void);
@@ -216,6 +222,29 @@ private:
     bool initialised;
     bool is_chibios_backend;
 
+    // true when the IOMCU takes CODE_WRITE_READ transfers
+    bool have_combined;
+
+    /*
+      output updates are written with CODE_WRITE_READ without waiting
+      for the reply, which has normally arrived by the time of the
+      next transfer and is collected then
+     */
+    struct {
+        bool pending;
+        uint32_t sent_us;
+        uint32_t last_reply_ms;
+    } combined;
+
+    // link statistics, reset each time they are logged
+    struct {
+        uint32_t bytes;
+        uint32_t rtt_sum_us;
+        uint32_t rtt_max_us;
+        uint16_t rtt_count;
+        uint32_t start_us;
+    } link;
+
     uint32_t protocol_fail_count;
     uint32_t protocol_count;
     uint32_t total_errors;
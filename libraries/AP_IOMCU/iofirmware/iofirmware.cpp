@@ -69,8 +69,8 @@ static void dma_rx_end_cb(UARTDriver *uart)
     dmaStreamEnable(uart->dmarx);
     uart->usart->CR3 |= USART_CR3_DMAR;
 
-    dmaStreamSetMemory0(uart->dmatx, &iomcu.tx_io_packet);
-    dmaStreamSetTransactionSize(uart->dmatx, iomcu.tx_io_packet.get_size());
+    dmaStreamSetMemory0(uart->dmatx, iomcu.tx_ptr());
+    dmaStreamSetTransactionSize(uart->dmatx, iomcu.tx_size());
     dmaStreamSetMode(uart->dmatx, uart->dmamode    | STM32_DMA_CR_DIR_M2P |
                      STM32_DMA_CR_MINC | STM32_DMA_CR_TCIE);
     dmaStreamEnable(uart->dmatx);
@@ -339,6 +339,7 @@ void AP_IOMCU_FW::rcin_update()
 void AP_IOMCU_FW::process_io_packet()
 {
     iomcu.reg_status.total_pkts++;
+    tx_combined_len = 0;
 
     uint8_t rx_crc = rx_io_packet.crc;
     uint8_t calc_crc;
@@ -391,6 +392,22 @@ void AP_IOMCU_FW::process_io_packet()
         }
     }
     break;
+    case CODE_WRITE_READ: {
+        // only outputs can be combined with a read
+        if (rx_io_packet.page != PAGE_DIRECT_PWM || !handle_code_write()) {
+            tx_io_packet.count = 0;
+            tx_io_packet.code = CODE_ERROR;
+            tx_io_packet.crc = 0;
+            tx_io_packet.page = 0;
+            tx_io_packet.offset = 0;
+            tx_io_packet.crc =  crc_crc8((const uint8_t *)&tx_io_packet, tx_io_packet.get_size());
+            iomcu.reg_status.num_errors++;
+            iomcu.reg_status.err_write++;
+        } else {
+            fill_combined_reply();
+        }
+    }
+    break;
     default: {
         iomcu.reg_status.num_errors++;
         iomcu.reg_status.err_bad_opcode++;
@@ -461,6 +478,38 @@ bool AP_IOMCU_FW::handle_code_read()
     return true;
 }
 
+/*
+  fill in the reply to CODE_WRITE_READ, which is the RC input page
+  followed by the status page, each as a complete packet. This saves
+  the FMU two round trips for every output update
+ */
+void AP_IOMCU_FW::fill_combined_reply(void)
+{
+    static_assert(sizeof(rc_input) <= PKT_MAX_REGS*2 && sizeof(reg_status) <= PKT_MAX_REGS*2,
+                  "combined reply pages must fit in a packet");
+    uint8_t len = add_page_reply(&tx_combined[0], PAGE_RAW_RCIN, &rc_input, sizeof(rc_input)/2);
+    len += add_page_reply(&tx_combined[len], PAGE_STATUS, &reg_status, sizeof(reg_status)/2);
+    tx_combined_len = len;
+}
+
+/*
+  add a packet with count registers of a page to buf, returning its
+  size. tx_io_packet is used as scratch space
+ */
+uint8_t AP_IOMCU_FW::add_page_reply(uint8_t *buf, uint8_t page, const void *values, uint8_t count)
+{
+    tx_io_packet.count = count;
+    tx_io_packet.code = CODE_SUCCESS;
+    tx_io_packet.page = page;
+    tx_io_packet.offset = 0;
+    memcpy(tx_io_packet.regs, values, sizeof(uint16_t)*count);
+    tx_io_packet.crc = 0;
+    tx_io_packet.crc =  crc_crc8((const uint8_t *)&tx_io_packet, tx_io_packet.get_size());
+    const uint8_t size = tx_io_packet.get_size();
+    memcpy(buf, &tx_io_packet, size);
+    return size;
+}
+
 bool AP_IOMCU_FW::handle_code_write()
 {
     switch (rx_io_packet.page) {
@@ -18,6 +18,19 @@ public:
 
     struct IOPacket rx_io_packet, tx_io_packet;
 
+    // reply to CODE_WRITE_READ, sent instead of tx_io_packet when
+    // tx_combined_len is non-zero
+    uint8_t tx_combined[2*sizeof(IOPacket)];
+    uint8_t tx_combined_len;
+
+    // pointer and length of the reply to send
+    const void *tx_ptr(void) const {
+        return tx_combined_len ? (const void *)tx_combined : (const void *)&tx_io_packet;
+    }
+    uint8_t tx_size(void) const {
+        return tx_combined_len ? tx_combined_len : tx_io_packet.get_size();
+    }
+
     void init();
     void update();
     void calculate_fw_crc(void);
@@ -28,6 +41,8 @@ public:
 
     bool handle_code_write();
     bool handle_code_read();
+    void fill_combined_reply(void);
+    uint8_t add_page_reply(uint8_t *buf, uint8_t page, const void *values, uint8_t count);
     void schedule_reboot(uint32_t time_ms);
     void safety_update();
     void rcout_mode_update();
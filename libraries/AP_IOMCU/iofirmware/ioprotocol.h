@@ -34,6 +34,9 @@ enum iocode {
     // read types
     CODE_READ = 0,
     CODE_WRITE = 1,
+    // write outputs, replying with the RC input and status pages as
+    // two packets back to back. Needs IOMCU_PROTOCOL_VERSION2 >= 11
+    CODE_WRITE_READ = 2,
 
     // reply codes
     CODE_SUCCESS = 0,
@@ -88,7 +91,7 @@ enum iopage {
 #define PAGE_CONFIG_PROTOCOL_VERSION  0
 #define PAGE_CONFIG_PROTOCOL_VERSION2 1
 #define IOMCU_PROTOCOL_VERSION       4
-#define IOMCU_PROTOCOL_VERSION2     10
+#define IOMCU_PROTOCOL_VERSION2     11
 
 // magic value for rebooting to bootloader
 #define REBOOT_BL_MAGIC 14662
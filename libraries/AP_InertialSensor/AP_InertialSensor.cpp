@@ -665,9 +665,15 @@ AP_InertialSensor::init(uint16_t sample_rate)
     // dynamically, the calculated value is always some multiple of the configured center frequency, so start with the
     // configured value
     _calculated_harmonic_notch_freq_hz = _harmonic_notch_filter.center_freq_hz();
+    _calculated_harmonic_notch_freqs_hz[0] = _calculated_harmonic_notch_freq_hz;
+    _num_calculated_harmonic_notch_frequencies = 1;
+
+    // with a notch per motor each motor's fundamental has its own harmonics
+    const uint8_t composite_notches = _harmonic_notch_filter.hasOption(HarmonicNotchFilterParams::Options::DynamicHarmonic) ?
+        HNF_MAX_COMPOSITE_NOTCHES : 1;
 
     for (uint8_t i=0; i<get_gyro_count(); i++) {
-        _gyro_harmonic_notch_filter[i].allocate_filters(_harmonic_notch_filter.harmonics());
+        _gyro_harmonic_notch_filter[i].allocate_filters(_harmonic_notch_filter.harmonics(), composite_notches);
         // initialise default settings, these will be subsequently changed in AP_InertialSensor_Backend::update_gyro()
         _gyro_harmonic_notch_filter[i].init(_gyro_raw_sample_rates[i], _calculated_harmonic_notch_freq_hz,
              _harmonic_notch_filter.bandwidth_hz(), _harmonic_notch_filter.attenuation_dB());
@@ -877,6 +883,15 @@ AP_InertialSensor::detect_backends(void)
 void AP_InertialSensor::periodic()
 {
     batchsampler.periodic();
+
+    // sample interval statistics for each gyro, at 1Hz
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - _last_jitter_report_ms >= 1000) {
+        _last_jitter_report_ms = now_ms;
+        for (uint8_t i=0; i<_gyro_count; i++) {
+            _gyro_sample_jitter[i].report(AP_SampleJitter::SensorType::GYRO, i);
+        }
+    }
 }
 
 
@@ -1334,6 +1349,67 @@ void AP_InertialSensor::update(void)
     _have_sample = false;
 }
 
+/*
+  start handing samples of a gyro, initially the primary one, to a rate
+  loop thread
+ */
+void AP_InertialSensor::enable_rate_loop_samples(uint8_t decimation)
+{
+    _rate_loop_instance = _primary_gyro;
+    _rate_loop_count = 0;
+    _rate_loop_decimation = MAX(decimation, 1U);
+}
+
+/*
+  choose the gyro the rate loop samples come from and the drift to
+  correct them with
+ */
+void AP_InertialSensor::set_rate_loop_gyro(uint8_t instance, const Vector3f &drift)
+{
+    if (instance >= _gyro_count) {
+        return;
+    }
+    WITH_SEMAPHORE(_rate_loop_sem);
+    _rate_loop_instance = instance;
+    _rate_loop_drift = drift;
+}
+
+/*
+  called by the backend that owns the rate loop gyro each time it has
+  filtered a sample
+ */
+void AP_InertialSensor::push_rate_loop_sample(uint8_t instance, const Vector3f &gyro, uint64_t sample_us)
+{
+    if (++_rate_loop_count < _rate_loop_decimation) {
+        return;
+    }
+    _rate_loop_count = 0;
+    const float rate_hz = _gyro_raw_sample_rates[instance];
+    {
+        WITH_SEMAPHORE(_rate_loop_sem);
+        _rate_loop_gyro = gyro + _rate_loop_drift;
+        _rate_loop_sample_us = sample_us;
+        _rate_loop_dt = rate_hz > 0 ? _rate_loop_decimation / rate_hz : _loop_delta_t;
+    }
+    _rate_loop_wake.signal();
+}
+
+/*
+  wait up to timeout_us for the next rate loop sample. If the rate loop
+  falls behind it gets the latest sample, not every one it missed
+ */
+bool AP_InertialSensor::wait_rate_loop_sample(Vector3f &gyro, float &dt, uint64_t &sample_us, uint32_t timeout_us)
+{
+    if (!_rate_loop_wake.wait(timeout_us)) {
+        return false;
+    }
+    WITH_SEMAPHORE(_rate_loop_sem);
+    gyro = _rate_loop_gyro;
+    dt = _rate_loop_dt;
+    sample_us = _rate_loop_sample_us;
+    return true;
+}
+
 /*
   wait for a sample to be available. This is the function that
   determines the timing of the main loop in ardupilot.
@@ -1731,10 +1807,29 @@ void AP_InertialSensor::acal_update()
 
 // Update the harmonic notch frequency
 void AP_InertialSensor::update_harmonic_notch_freq_hz(float scaled_freq) {
-    // protect against zero as the scaled frequency
-    if (is_positive(scaled_freq)) {
-        _calculated_harmonic_notch_freq_hz = scaled_freq;
+    update_harmonic_notch_freqs_hz(1, &scaled_freq);
+}
+
+// Update the harmonic notch frequencies, such as one per motor
+void AP_InertialSensor::update_harmonic_notch_freqs_hz(uint8_t num_freqs, const float scaled_freq[]) {
+    num_freqs = MIN(num_freqs, HNF_MAX_COMPOSITE_NOTCHES);
+    bool changed = num_freqs != _num_calculated_harmonic_notch_frequencies;
+    for (uint8_t i = 0; i < num_freqs; i++) {
+        // protect against zero as the scaled frequency
+        if (!is_positive(scaled_freq[i])) {
+            return;
+        }
+        if (!is_equal(scaled_freq[i], _calculated_harmonic_notch_freqs_hz[i])) {
+            changed = true;
+        }
+    }
+    if (num_freqs == 0 || !changed) {
+        return;
     }
+    memcpy(_calculated_harmonic_notch_freqs_hz, scaled_freq, num_freqs * sizeof(float));
+    _num_calculated_harmonic_notch_frequencies = num_freqs;
+    _calculated_harmonic_notch_freq_hz = scaled_freq[0];
+    _harmonic_notch_update_count++;
 }
 
 /*
@@ -18,6 +18,7 @@
 #define DEFAULT_IMU_LOG_BAT_MASK 0
 
 #include <stdint.h>
+#include <atomic>
 
 #include <AP_AccelCal/AP_AccelCal.h>
 #include <AP_HAL/AP_HAL.h>
@@ -26,6 +27,7 @@
 #include <Filter/LowPassFilter.h>
 #include <Filter/NotchFilter.h>
 #include <Filter/HarmonicNotchFilter.h>
+#include <AP_SampleJitter/AP_SampleJitter.h>
 
 class AP_InertialSensor_Backend;
 class AuxiliaryBus;
@@ -148,6 +150,9 @@ public:
     uint16_t get_gyro_rate_hz(uint8_t instance) const { return uint16_t(_gyro_raw_sample_rates[instance] * _gyro_over_sampling[instance]); }
     uint16_t get_accel_rate_hz(uint8_t instance) const { return uint16_t(_accel_raw_sample_rates[instance] * _accel_over_sampling[instance]); }
 
+    // get the rate at which raw gyro samples are delivered by the backend
+    uint16_t get_raw_gyro_rate_hz(uint8_t instance) const { return uint16_t(_gyro_raw_sample_rates[instance]); }
+
     // get accel offsets in m/s/s
     const Vector3f &get_accel_offsets(uint8_t i) const { return _accel_offset[i]; }
     const Vector3f &get_accel_offsets(void) const { return get_accel_offsets(_primary_accel); }
@@ -183,6 +188,24 @@ public:
     // wait for a sample to be available
     void wait_for_sample(void);
 
+    /*
+      filtered samples of one gyro for a rate loop thread. Once
+      enabled, every decimation'th sample is handed to
+      wait_rate_loop_sample() as soon as it has been filtered, along
+      with the time since the previous one and the time it was
+      taken. set_rate_loop_gyro() picks the gyro, which starts as the
+      primary one, and the drift to add to its samples. The caller
+      normally passes the gyro and drift estimate of the AHRS after
+      each update, so the samples match get_gyro_latest() of the AHRS
+     */
+    void enable_rate_loop_samples(uint8_t decimation);
+    void set_rate_loop_gyro(uint8_t instance, const Vector3f &drift);
+    bool rate_loop_samples_enabled(void) const { return _rate_loop_decimation != 0; }
+    bool wait_rate_loop_sample(Vector3f &gyro, float &dt, uint64_t &sample_us, uint32_t timeout_us);
+
+    // time the latest sample in get_gyro() was taken
+    uint64_t get_gyro_sample_us(void) const { return _gyro_sample_us[_primary_gyro]; }
+
     // class level parameters
     static const struct AP_Param::GroupInfo var_info[];
 
@@ -205,6 +228,8 @@ public:
 
     // Update the harmonic notch frequency
     void update_harmonic_notch_freq_hz(float scaled_freq);
+    // Update the harmonic notch frequencies, one per composite notch
+    void update_harmonic_notch_freqs_hz(uint8_t num_freqs, const float scaled_freq[]);
 
     // enable HIL mode
     void set_hil_mode(void) { _hil_mode = true; }
@@ -227,6 +252,9 @@ public:
     // harmonic notch tracking mode
     uint8_t get_gyro_harmonic_notch_tracking_mode(void) const { return _harmonic_notch_filter.tracking_mode(); }
 
+    // harmonic notch options
+    bool has_harmonic_notch_option(HarmonicNotchFilterParams::Options option) const { return _harmonic_notch_filter.hasOption(option); }
+
     // indicate which bit in LOG_BITMASK indicates raw logging enabled
     void set_log_raw_bit(uint32_t log_raw_bit) { _log_raw_bit = log_raw_bit; }
 
@@ -334,6 +362,9 @@ public:
         AP_Int16 samples_per_msg;
         AP_Int8 push_interval_ms;
 
+        // size of the sample ring used when streaming, in samples
+        AP_Int16 _stream_ring_size;
+
         // end Parameters
 
     private:
@@ -341,17 +372,61 @@ public:
         enum batch_opt_t {
             BATCH_OPT_SENSOR_RATE = (1<<0),
             BATCH_OPT_POST_FILTER = (1<<1),
+            BATCH_OPT_STREAM = (1<<2),
         };
 
         void rotate_to_next_sensor();
         void update_doing_sensor_rate_logging();
+        float sample_rate_hz() const;
 
         bool should_log(uint8_t instance, IMU_SENSOR_TYPE type);
         void push_data_to_log();
 
+        // continuous streaming of a single gyro. data_x/y/z become a
+        // ring of consecutive batches of STREAM_BATCH_SAMPLES samples
+        // each, so a batch is never split by a gap. When the ring can't
+        // take a whole batch the backend drops samples until it can,
+        // and the gap is logged ahead of the next batch.
+        bool init_stream();
+        void stream_sample(uint64_t sample_us, const Vector3f &sample);
+        void push_stream_to_log();
+        void update_stream_decimation(bool backpressure);
+
+        static const uint16_t STREAM_BATCH_SAMPLES = 256;
+        static const uint8_t STREAM_MAX_DECIMATION = 16;
+        static const uint8_t STREAM_MAX_MSGS_PER_CALL = 4;
+        // logger buffer space, in bytes, below which we stop streaming
+        static const uint16_t STREAM_LOG_HEADROOM = 2048;
+
+        // one per batch slot in the ring, written by the backend when
+        // it starts a batch in that slot
+        struct stream_batch {
+            uint64_t start_us;
+            uint32_t dropped; // samples dropped just before this batch
+            uint8_t decimation;
+        } *stream_batches;
+        uint16_t stream_ring_samples;
+        // total samples written and read. The backend only advances
+        // the write count and the main thread the read count
+        std::atomic<uint32_t> stream_write_count{0};
+        std::atomic<uint32_t> stream_read_count{0};
+        // raw samples averaged into each logged sample. Set by the
+        // main thread, taken by the backend at the start of a batch
+        std::atomic<uint8_t> stream_decimation{1};
+        // backend state
+        bool stream_in_batch;
+        uint8_t stream_batch_decimation;
+        uint8_t stream_accum_count;
+        Vector3f stream_accum;
+        uint32_t stream_dropped;
+        // main thread state
+        uint32_t stream_backpressure_ms;
+        uint32_t stream_decimation_change_ms;
+
         uint64_t measurement_started_us;
 
         bool initialised : 1;
+        bool init_attempted : 1;
         bool isbh_sent : 1;
         bool _doing_sensor_rate_logging : 1;
         bool _doing_post_filter_logging : 1;
@@ -432,6 +507,11 @@ private:
     HarmonicNotchFilterVector3f _gyro_harmonic_notch_filter[INS_MAX_INSTANCES];
     // the current center frequency for the notch
     float _calculated_harmonic_notch_freq_hz;
+    // the current center frequencies with a notch per motor
+    float _calculated_harmonic_notch_freqs_hz[HNF_MAX_COMPOSITE_NOTCHES];
+    uint8_t _num_calculated_harmonic_notch_frequencies;
+    // incremented each time the center frequencies change
+    uint32_t _harmonic_notch_update_count;
 
     // Most recent gyro reading
     Vector3f _gyro[INS_MAX_INSTANCES];
@@ -481,6 +561,14 @@ private:
     uint64_t _accel_last_sample_us[INS_MAX_INSTANCES];
     uint64_t _gyro_last_sample_us[INS_MAX_INSTANCES];
 
+    // time the samples in _gyro_filtered and _gyro were taken
+    uint64_t _gyro_filtered_sample_us[INS_MAX_INSTANCES];
+    uint64_t _gyro_sample_us[INS_MAX_INSTANCES];
+
+    // arrival of raw gyro samples, reported by periodic()
+    AP_SampleJitter _gyro_sample_jitter[INS_MAX_INSTANCES];
+    uint32_t _last_jitter_report_ms;
+
     // sample times for checking real sensor rate for FIFO sensors
     uint16_t _sample_accel_count[INS_MAX_INSTANCES];
     uint32_t _sample_accel_start_us[INS_MAX_INSTANCES];
@@ -520,6 +608,18 @@ private:
     uint8_t _primary_gyro;
     uint8_t _primary_accel;
 
+    // samples for a rate loop thread, from push_rate_loop_sample()
+    void push_rate_loop_sample(uint8_t instance, const Vector3f &gyro, uint64_t sample_us);
+    uint8_t _rate_loop_decimation;
+    uint8_t _rate_loop_count;
+    uint8_t _rate_loop_instance;
+    Vector3f _rate_loop_drift;
+    Vector3f _rate_loop_gyro;
+    float _rate_loop_dt;
+    uint64_t _rate_loop_sample_us;
+    HAL_Semaphore _rate_loop_sem;
+    HAL_BinarySemaphore _rate_loop_wake;
+
     // mask of accels and gyros which we will be actively using
     // and this should wait for in wait_for_sample()
     uint8_t _gyro_wait_mask;
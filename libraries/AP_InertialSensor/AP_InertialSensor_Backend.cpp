@@ -3,6 +3,8 @@
 #include "AP_InertialSensor_Backend.h"
 #include <AP_Logger/AP_Logger.h>
 #include <AP_BoardConfig/AP_BoardConfig.h>
+#include <AP_GyroFFT/AP_GyroFFT.h>
+#include <AP_OutputLatency/AP_OutputLatency.h>
 #if AP_MODULE_SUPPORTED
 #include <AP_Module/AP_Module.h>
 #include <stdio.h>
@@ -154,8 +156,13 @@ void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
     if ((1U<<instance) & _imu.imu_kill_mask) {
         return;
     }
+    hal.util->trace(AP_HAL::Util::TRACE_GYRO_SAMPLE, nullptr, instance);
     float dt;
 
+    // FIFO sensors don't give sample_us, so this records the bunching
+    // of their samples by the FIFO reads
+    _imu._gyro_sample_jitter[instance].sample(sample_us != 0 ? sample_us : AP_HAL::micros());
+
     _update_sensor_rate(_imu._sample_gyro_count[instance], _imu._sample_gyro_start_us[instance],
                         _imu._gyro_raw_sample_rates[instance]);
 
@@ -248,9 +255,29 @@ void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
             _imu._gyro_harmonic_notch_filter[instance].reset();
         } else {
             _imu._gyro_filtered[instance] = gyro_filtered;
+            // FIFO sensors are timed by when their samples are read
+            _imu._gyro_filtered_sample_us[instance] = sample_us != 0 ? sample_us : _imu._gyro_last_sample_us[instance];
         }
 
         _imu._new_gyro_data[instance] = true;
+
+        if (instance == _imu._primary_gyro) {
+            AP_OutputLatency *latency = AP::output_latency();
+            if (latency != nullptr) {
+                latency->filtered(_imu._gyro_filtered_sample_us[instance], AP_HAL::micros64());
+            }
+        }
+        if (instance == _imu._rate_loop_instance && _imu._rate_loop_decimation != 0) {
+            _imu.push_rate_loop_sample(instance, _imu._gyro_filtered[instance], _imu._gyro_filtered_sample_us[instance]);
+        }
+    }
+
+    // feed the raw gyro of the first IMU to the spectral analysis
+    if (instance == 0) {
+        AP_GyroFFT *fft = AP::fft();
+        if (fft != nullptr) {
+            fft->sample(gyro);
+        }
     }
 
     if (!_imu.batchsampler.doing_post_filter_logging()) {
@@ -330,6 +357,7 @@ void AP_InertialSensor_Backend::_notify_new_accel_raw_sample(uint8_t instance,
     if ((1U<<instance) & _imu.imu_kill_mask) {
         return;
     }
+    hal.util->trace(AP_HAL::Util::TRACE_ACCEL_SAMPLE, nullptr, instance);
     float dt;
 
     _update_sensor_rate(_imu._sample_accel_count[instance], _imu._sample_accel_start_us[instance],
@@ -514,6 +542,7 @@ void AP_InertialSensor_Backend::update_gyro(uint8_t instance)
     if (_imu._new_gyro_data[instance]) {
         _last_gyro_filtered[instance] = _imu._gyro_filtered[instance];
         _publish_gyro(instance, _imu._gyro_filtered[instance]);
+        _imu._gyro_sample_us[instance] = _imu._gyro_filtered_sample_us[instance];
         _imu._new_gyro_data[instance] = false;
     }
 
@@ -524,17 +553,7 @@ void AP_InertialSensor_Backend::update_gyro(uint8_t instance)
     }
 
     // possily update the harmonic notch filter parameters
-    if (!is_equal(_last_harmonic_notch_bandwidth_hz, gyro_harmonic_notch_bandwidth_hz()) ||
-        !is_equal(_last_harmonic_notch_attenuation_dB, gyro_harmonic_notch_attenuation_dB()) ||
-        sensors_converging()) {
-        _imu._gyro_harmonic_notch_filter[instance].init(_gyro_raw_sample_rate(instance), gyro_harmonic_notch_center_freq_hz(), gyro_harmonic_notch_bandwidth_hz(), gyro_harmonic_notch_attenuation_dB());
-        _last_harmonic_notch_center_freq_hz = gyro_harmonic_notch_center_freq_hz();
-        _last_harmonic_notch_bandwidth_hz = gyro_harmonic_notch_bandwidth_hz();
-        _last_harmonic_notch_attenuation_dB = gyro_harmonic_notch_attenuation_dB();
-    } else if (!is_equal(_last_harmonic_notch_center_freq_hz, gyro_harmonic_notch_center_freq_hz())) {
-        _imu._gyro_harmonic_notch_filter[instance].update(gyro_harmonic_notch_center_freq_hz());
-        _last_harmonic_notch_center_freq_hz = gyro_harmonic_notch_center_freq_hz();
-    }
+    update_harmonic_notch(instance);
     // possily update the notch filter parameters
     if (!is_equal(_last_notch_center_freq_hz, _gyro_notch_center_freq_hz()) ||
         !is_equal(_last_notch_bandwidth_hz, _gyro_notch_bandwidth_hz()) ||
@@ -548,6 +567,28 @@ void AP_InertialSensor_Backend::update_gyro(uint8_t instance)
 }
 
 
+/*
+  update the harmonic notch filter for a new bandwidth or attenuation,
+  or for new center frequencies from the vehicle
+ */
+void AP_InertialSensor_Backend::update_harmonic_notch(uint8_t instance)
+{
+    HarmonicNotchFilterVector3f &notch = _imu._gyro_harmonic_notch_filter[instance];
+    if (!is_equal(_last_harmonic_notch_bandwidth_hz, gyro_harmonic_notch_bandwidth_hz()) ||
+        !is_equal(_last_harmonic_notch_attenuation_dB, gyro_harmonic_notch_attenuation_dB()) ||
+        sensors_converging()) {
+        notch.init(_gyro_raw_sample_rate(instance), gyro_harmonic_notch_center_freq_hz(), gyro_harmonic_notch_bandwidth_hz(), gyro_harmonic_notch_attenuation_dB());
+        _last_harmonic_notch_bandwidth_hz = gyro_harmonic_notch_bandwidth_hz();
+        _last_harmonic_notch_attenuation_dB = gyro_harmonic_notch_attenuation_dB();
+        // init() sets up a single fundamental, add any others
+        _last_harmonic_notch_update_count = _imu._harmonic_notch_update_count - 1;
+    }
+    if (_last_harmonic_notch_update_count != _imu._harmonic_notch_update_count) {
+        notch.update(_imu._num_calculated_harmonic_notch_frequencies, _imu._calculated_harmonic_notch_freqs_hz);
+        _last_harmonic_notch_update_count = _imu._harmonic_notch_update_count;
+    }
+}
+
 void AP_InertialSensor_Backend::update_gyro_with_stale_data(uint8_t instance)
 {    
     WITH_SEMAPHORE(_sem);
@@ -567,17 +608,7 @@ void AP_InertialSensor_Backend::update_gyro_with_stale_data(uint8_t instance)
     }
 
     // possily update the harmonic notch filter parameters
-    if (!is_equal(_last_harmonic_notch_bandwidth_hz, gyro_harmonic_notch_bandwidth_hz()) ||
-        !is_equal(_last_harmonic_notch_attenuation_dB, gyro_harmonic_notch_attenuation_dB()) ||
-        sensors_converging()) {
-        _imu._gyro_harmonic_notch_filter[instance].init(_gyro_raw_sample_rate(instance), gyro_harmonic_notch_center_freq_hz(), gyro_harmonic_notch_bandwidth_hz(), gyro_harmonic_notch_attenuation_dB());
-        _last_harmonic_notch_center_freq_hz = gyro_harmonic_notch_center_freq_hz();
-        _last_harmonic_notch_bandwidth_hz = gyro_harmonic_notch_bandwidth_hz();
-        _last_harmonic_notch_attenuation_dB = gyro_harmonic_notch_attenuation_dB();
-    } else if (!is_equal(_last_harmonic_notch_center_freq_hz, gyro_harmonic_notch_center_freq_hz())) {
-        _imu._gyro_harmonic_notch_filter[instance].update(gyro_harmonic_notch_center_freq_hz());
-        _last_harmonic_notch_center_freq_hz = gyro_harmonic_notch_center_freq_hz();
-    }
+    update_harmonic_notch(instance);
     // possily update the notch filter parameters
     if (!is_equal(_last_notch_center_freq_hz, _gyro_notch_center_freq_hz()) ||
         !is_equal(_last_notch_bandwidth_hz, _gyro_notch_bandwidth_hz()) ||
@@ -623,17 +654,7 @@ void AP_InertialSensor_Backend::update_gyro_with_noise(uint8_t instance)
     }
 
     // possily update the harmonic notch filter parameters
-    if (!is_equal(_last_harmonic_notch_bandwidth_hz, gyro_harmonic_notch_bandwidth_hz()) ||
-        !is_equal(_last_harmonic_notch_attenuation_dB, gyro_harmonic_notch_attenuation_dB()) ||
-        sensors_converging()) {
-        _imu._gyro_harmonic_notch_filter[instance].init(_gyro_raw_sample_rate(instance), gyro_harmonic_notch_center_freq_hz(), gyro_harmonic_notch_bandwidth_hz(), gyro_harmonic_notch_attenuation_dB());
-        _last_harmonic_notch_center_freq_hz = gyro_harmonic_notch_center_freq_hz();
-        _last_harmonic_notch_bandwidth_hz = gyro_harmonic_notch_bandwidth_hz();
-        _last_harmonic_notch_attenuation_dB = gyro_harmonic_notch_attenuation_dB();
-    } else if (!is_equal(_last_harmonic_notch_center_freq_hz, gyro_harmonic_notch_center_freq_hz())) {
-        _imu._gyro_harmonic_notch_filter[instance].update(gyro_harmonic_notch_center_freq_hz());
-        _last_harmonic_notch_center_freq_hz = gyro_harmonic_notch_center_freq_hz();
-    }
+    update_harmonic_notch(instance);
     // possily update the notch filter parameters
     if (!is_equal(_last_notch_center_freq_hz, _gyro_notch_center_freq_hz()) ||
         !is_equal(_last_notch_bandwidth_hz, _gyro_notch_bandwidth_hz()) ||
@@ -262,6 +262,8 @@ protected:
     void update_gyro(uint8_t instance);
     void update_gyro_with_stale_data(uint8_t instance);
     void update_gyro_with_noise(uint8_t instance);
+    // update the harmonic notch filter from the calculated frequencies
+    void update_harmonic_notch(uint8_t instance);
 
     // common accel update function for all backends
     void update_accel(uint8_t instance);
@@ -277,7 +279,7 @@ protected:
     float _last_notch_attenuation_dB;
 
     // support for updating harmonic filter at runtime
-    float _last_harmonic_notch_center_freq_hz;
+    uint32_t _last_harmonic_notch_update_count;
     float _last_harmonic_notch_bandwidth_hz;
     float _last_harmonic_notch_attenuation_dB;
     
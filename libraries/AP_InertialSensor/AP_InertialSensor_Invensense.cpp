@@ -52,9 +52,12 @@ extern const AP_HAL::HAL& hal;
 #endif
 
 #include "AP_InertialSensor_Invensense_registers.h"
+#include <AP_HAL/utility/sparse-endian.h>
+#include <AP_Logger/AP_Logger.h>
 
 #define MPU_SAMPLE_SIZE 14
-#define MPU_FIFO_BUFFER_LEN 16
+// large enough for the most samples _read_fifo() takes in one burst
+#define MPU_FIFO_BUFFER_LEN 32
 
 #define int16_val(v, idx) ((int16_t)(((uint16_t)v[2*idx] << 8) | v[2*idx+1]))
 #define uint16_val(v, idx)(((uint16_t)v[2*idx] << 8) | v[2*idx+1])
@@ -80,7 +83,7 @@ AP_InertialSensor_Invensense::AP_InertialSensor_Invensense(AP_InertialSensor &im
 AP_InertialSensor_Invensense::~AP_InertialSensor_Invensense()
 {
     if (_fifo_buffer != nullptr) {
-        hal.util->free_type(_fifo_buffer, MPU_FIFO_BUFFER_LEN * MPU_SAMPLE_SIZE, AP_HAL::Util::MEM_DMA_SAFE);
+        hal.util->free_type(_fifo_buffer, MPU_FIFO_BUFFER_LEN * MPU_SAMPLE_SIZE, AP_HAL::Util::MEM_DMA_SAFE, "INS");
     }
     delete _auxiliary_bus;
 }
@@ -343,7 +346,7 @@ void AP_InertialSensor_Invensense::start()
     _fifo_gyro_scale = _gyro_scale / _fifo_downsample_rate;
     
     // allocate fifo buffer
-    _fifo_buffer = (uint8_t *)hal.util->malloc_type(MPU_FIFO_BUFFER_LEN * MPU_SAMPLE_SIZE, AP_HAL::Util::MEM_DMA_SAFE);
+    _fifo_buffer = (FIFOData *)hal.util->malloc_type(MPU_FIFO_BUFFER_LEN * MPU_SAMPLE_SIZE, AP_HAL::Util::MEM_DMA_SAFE, "INS");
     if (_fifo_buffer == nullptr) {
         AP_HAL::panic("Invensense: Unable to allocate FIFO buffer");
     }
@@ -363,9 +366,39 @@ bool AP_InertialSensor_Invensense::update()
 
     _publish_temperature(_accel_instance, _temp_filtered);
 
+    _log_fifo_stats();
+
     return true;
 }
 
+/*
+  log the FIFO statistics at 1Hz
+ */
+void AP_InertialSensor_Invensense::_log_fifo_stats(void)
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - _fifo_stats_log_ms < 1000) {
+        return;
+    }
+    _fifo_stats_log_ms = now_ms;
+
+    AP_Logger *logger = AP_Logger::get_singleton();
+    if (logger == nullptr || !logger->logging_started()) {
+        return;
+    }
+    const struct log_IMUFIFO pkt = {
+        LOG_PACKET_HEADER_INIT(LOG_IMU_FIFO_MSG),
+        time_us     : AP_HAL::micros64(),
+        instance    : _accel_instance,
+        bytes       : _fifo_stats.bytes,
+        samples     : _fifo_stats.samples,
+        overflows   : _fifo_stats.overflows,
+        resets      : _fifo_stats.resets,
+        convert_us  : _fifo_stats.convert_us,
+    };
+    logger->WriteBlock(&pkt, sizeof(pkt));
+}
+
 /*
   accumulate new samples
  */
@@ -410,35 +443,51 @@ void AP_InertialSensor_Invensense::_poll_data()
     _read_fifo();
 }
 
-bool AP_InertialSensor_Invensense::_accumulate(uint8_t *samples, uint8_t n_samples)
+/*
+  byte swap a whole burst in one pass. Each sample is seven big endian
+  words, so the burst is treated as a flat array of words
+ */
+void AP_InertialSensor_Invensense::_fifo_to_host(FIFOData *samples, uint8_t n_samples)
+{
+    static_assert(sizeof(FIFOData) == MPU_SAMPLE_SIZE, "FIFOData must match the FIFO sample");
+
+    uint16_t *words = (uint16_t *)samples;
+    const uint16_t n_words = n_samples * (MPU_SAMPLE_SIZE / 2);
+    for (uint16_t i = 0; i < n_words; i++) {
+        words[i] = be16toh(words[i]);
+    }
+}
+
+bool AP_InertialSensor_Invensense::_accumulate(const FIFOData *samples, uint8_t n_samples)
 {
     for (uint8_t i = 0; i < n_samples; i++) {
-        const uint8_t *data = samples + MPU_SAMPLE_SIZE * i;
+        const FIFOData &data = samples[i];
         Vector3f accel, gyro;
         bool fsync_set = false;
 
 #if INVENSENSE_EXT_SYNC_ENABLE
-        fsync_set = (int16_val(data, 2) & 1U) != 0;
+        fsync_set = (data.accel[2] & 1U) != 0;
 #endif
         
-        accel = Vector3f(int16_val(data, 1),
-                         int16_val(data, 0),
-                         -int16_val(data, 2));
+        accel = Vector3f(data.accel[1],
+                         data.accel[0],
+                         -data.accel[2]);
         accel *= _accel_scale;
 
-        int16_t t2 = int16_val(data, 3);
+        int16_t t2 = data.temp;
         if (!_check_raw_temp(t2)) {
             if (!hal.scheduler->in_expected_delay()) {
                 debug("temp reset IMU[%u] %d %d", _accel_instance, _raw_temp, t2);
             }
+            _fifo_stats.resets++;
             _fifo_reset();
             return false;
         }
         float temp = t2 * temp_sensitivity + temp_zero;
         
-        gyro = Vector3f(int16_val(data, 5),
-                        int16_val(data, 4),
-                        -int16_val(data, 6));
+        gyro = Vector3f(data.gyro[1],
+                        data.gyro[0],
+                        -data.gyro[2]);
         gyro *= _gyro_scale;
 
         _rotate_and_correct_accel(_accel_instance, accel);
@@ -460,7 +509,7 @@ bool AP_InertialSensor_Invensense::_accumulate(uint8_t *samples, uint8_t n_sampl
   gives very good aliasing rejection at frequencies well above what
   can be handled with 1kHz sample rates.
  */
-bool AP_InertialSensor_Invensense::_accumulate_sensor_rate_sampling(uint8_t *samples, uint8_t n_samples)
+bool AP_InertialSensor_Invensense::_accumulate_sensor_rate_sampling(const FIFOData *samples, uint8_t n_samples)
 {
     int32_t tsum = 0;
     const int32_t unscaled_clip_limit = _clip_limit / _accel_scale;
@@ -468,14 +517,15 @@ bool AP_InertialSensor_Invensense::_accumulate_sensor_rate_sampling(uint8_t *sam
     bool ret = true;
     
     for (uint8_t i = 0; i < n_samples; i++) {
-        const uint8_t *data = samples + MPU_SAMPLE_SIZE * i;
+        const FIFOData &data = samples[i];
 
         // use temperatue to detect FIFO corruption
-        int16_t t2 = int16_val(data, 3);
+        int16_t t2 = data.temp;
         if (!_check_raw_temp(t2)) {
             if (!hal.scheduler->in_expected_delay()) {
                 debug("temp reset IMU[%u] %d %d", _accel_instance, _raw_temp, t2);
             }
+            _fifo_stats.resets++;
             _fifo_reset();
             ret = false;
             break;
@@ -484,9 +534,9 @@ bool AP_InertialSensor_Invensense::_accumulate_sensor_rate_sampling(uint8_t *sam
 
         if ((_accum.count & 1) == 0) {
             // accel data is at 4kHz
-            Vector3f a(int16_val(data, 1),
-                       int16_val(data, 0),
-                       -int16_val(data, 2));
+            Vector3f a(data.accel[1],
+                       data.accel[0],
+                       -data.accel[2]);
             if (fabsf(a.x) > unscaled_clip_limit ||
                 fabsf(a.y) > unscaled_clip_limit ||
                 fabsf(a.z) > unscaled_clip_limit) {
@@ -497,9 +547,9 @@ bool AP_InertialSensor_Invensense::_accumulate_sensor_rate_sampling(uint8_t *sam
             _notify_new_accel_sensor_rate_sample(_accel_instance, a2);
         }
 
-        Vector3f g(int16_val(data, 5),
-                   int16_val(data, 4),
-                   -int16_val(data, 6));
+        Vector3f g(data.gyro[1],
+                   data.gyro[0],
+                   -data.gyro[2]);
 
         Vector3f g2 = g * _gyro_scale;
         _notify_new_gyro_sensor_rate_sample(_gyro_instance, g2);
@@ -540,8 +590,9 @@ void AP_InertialSensor_Invensense::_read_fifo()
 {
     uint8_t n_samples;
     uint16_t bytes_read;
-    uint8_t *rx = _fifo_buffer;
+    uint8_t *rx = (uint8_t *)_fifo_buffer;
     bool need_reset = false;
+    uint32_t convert_start_us;
 
     if (!_block_read(MPUREG_FIFO_COUNTH, rx, 2)) {
         goto check_registers;
@@ -577,8 +628,17 @@ void AP_InertialSensor_Invensense::_read_fifo()
         }
     }
     
-    while (n_samples > 0) {
-        uint8_t n = MIN(n_samples, MPU_FIFO_BUFFER_LEN);
+    if (need_reset) {
+        _fifo_stats.overflows++;
+    }
+
+    /*
+      read everything we are taking in one burst straight into the DMA
+      safe buffer, then convert it as a block
+     */
+    n_samples = MIN(n_samples, MPU_FIFO_BUFFER_LEN);
+    {
+        const uint16_t n = n_samples;
         if (!_dev->set_chip_select(true)) {
             if (!_block_read(MPUREG_FIFO_R_W, rx, n * MPU_SAMPLE_SIZE)) {
                 goto check_registers;
@@ -600,21 +660,22 @@ void AP_InertialSensor_Invensense::_read_fifo()
             }
             _dev->set_chip_select(false);
         }
+        _fifo_stats.bytes += 2 + n * MPU_SAMPLE_SIZE;
+    }
 
-        if (_fast_sampling) {
-            if (!_accumulate_sensor_rate_sampling(rx, n)) {
-                if (!hal.scheduler->in_expected_delay()) {
-                    debug("IMU[%u] stop at %u of %u", _accel_instance, n_samples, bytes_read/MPU_SAMPLE_SIZE);
-                }
-                break;
-            }
-        } else {
-            if (!_accumulate(rx, n)) {
-                break;
+    convert_start_us = AP_HAL::micros();
+    _fifo_to_host(_fifo_buffer, n_samples);
+    if (_fast_sampling) {
+        if (!_accumulate_sensor_rate_sampling(_fifo_buffer, n_samples)) {
+            if (!hal.scheduler->in_expected_delay()) {
+                debug("IMU[%u] stop at %u of %u", _accel_instance, n_samples, bytes_read/MPU_SAMPLE_SIZE);
             }
         }
-        n_samples -= n;
+    } else {
+        _accumulate(_fifo_buffer, n_samples);
     }
+    _fifo_stats.samples += n_samples;
+    _fifo_stats.convert_us += AP_HAL::micros() - convert_start_us;
 
     if (need_reset) {
         //debug("fifo reset n_samples %u", bytes_read/MPU_SAMPLE_SIZE);
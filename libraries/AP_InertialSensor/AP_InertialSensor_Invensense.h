@@ -101,8 +101,24 @@ private:
     uint8_t _register_read(uint8_t reg);
     void _register_write(uint8_t reg, uint8_t val, bool checked=false);
 
-    bool _accumulate(uint8_t *samples, uint8_t n_samples);
-    bool _accumulate_sensor_rate_sampling(uint8_t *samples, uint8_t n_samples);
+    /*
+      one FIFO sample after conversion to host byte order. The FIFO
+      delivers accel, temperature and gyro as big endian words
+     */
+    struct FIFOData {
+        int16_t accel[3];
+        int16_t temp;
+        int16_t gyro[3];
+    };
+
+    // convert a burst of FIFO samples to host byte order in place
+    static void _fifo_to_host(FIFOData *samples, uint8_t n_samples);
+
+    bool _accumulate(const FIFOData *samples, uint8_t n_samples);
+    bool _accumulate_sensor_rate_sampling(const FIFOData *samples, uint8_t n_samples);
+
+    // log the FIFO statistics
+    void _log_fifo_stats(void);
 
     bool _check_raw_temp(int16_t t2);
 
@@ -121,7 +137,7 @@ private:
 
     float _fifo_accel_scale;
     float _fifo_gyro_scale;
-    LowPassFilter2pFloat _temp_filter;
+    LowPassFilter2pFixedFloat _temp_filter;
 
     enum Rotation _rotation;
 
@@ -144,8 +160,21 @@ private:
     // Last status from register user control
     uint8_t _last_stat_user_ctrl;    
 
-    // buffer for fifo read
-    uint8_t *_fifo_buffer;
+    // DMA safe buffer that each FIFO burst is read into
+    FIFOData *_fifo_buffer;
+
+    /*
+      FIFO statistics, updated from the bus thread and logged from
+      update()
+     */
+    struct {
+        uint32_t bytes;          // bytes read from the FIFO
+        uint32_t samples;        // samples converted
+        uint32_t overflows;      // reads where the FIFO held more than we could take
+        uint32_t resets;         // FIFO resets after corrupt data
+        uint32_t convert_us;     // time spent converting samples
+    } _fifo_stats;
+    uint32_t _fifo_stats_log_ms;
 
     /*
       accumulators for sensor_rate sampling
@@ -111,7 +111,7 @@ private:
     float _accel_scale;
     float _fifo_accel_scale;
     float _fifo_gyro_scale;
-    LowPassFilter2pFloat _temp_filter;
+    LowPassFilter2pFixedFloat _temp_filter;
 
     enum Rotation _rotation;
 
@@ -2,6 +2,8 @@
 #include <GCS_MAVLink/GCS.h>
 #include <AP_Logger/AP_Logger.h>
 
+#define MASK_LOG_ANY                    0xFFFF
+
 // Class level parameters
 const AP_Param::GroupInfo AP_InertialSensor::BatchSampler::var_info[] = {
     // @Param: BAT_CNT
@@ -24,7 +26,7 @@ const AP_Param::GroupInfo AP_InertialSensor::BatchSampler::var_info[] = {
     // @Param: BAT_OPT
     // @DisplayName: Batch Logging Options Mask
     // @Description: Options for the BatchSampler
-    // @Bitmask: 0:Sensor-Rate Logging (sample at full sensor rate seen by AP), 1: Sample post-filtering
+    // @Bitmask: 0:Sensor-Rate Logging (sample at full sensor rate seen by AP), 1: Sample post-filtering, 2: Continuous streaming of the first IMU's gyro
     // @User: Advanced
     AP_GROUPINFO("BAT_OPT",  3, AP_InertialSensor::BatchSampler, _batch_options_mask, 0),
 
@@ -41,6 +43,14 @@ const AP_Param::GroupInfo AP_InertialSensor::BatchSampler::var_info[] = {
     // @Increment: 1
     AP_GROUPINFO("BAT_LGCT", 5, AP_InertialSensor::BatchSampler, samples_per_msg,   32),
 
+    // @Param: BAT_RING
+    // @DisplayName: streaming ring size
+    // @Description: Number of samples buffered when continuous streaming is selected in @PREFIX@BAT_OPT. Will be rounded down to a power of two, with a minimum of 512. A larger ring rides out longer logging stalls before samples are dropped. This option takes effect on the next reboot.
+    // @User: Advanced
+    // @Range: 512 16384
+    // @RebootRequired: True
+    AP_GROUPINFO("BAT_RING", 6, AP_InertialSensor::BatchSampler, _stream_ring_size, 2048),
+
     AP_GROUPEND
 };
 
@@ -51,6 +61,12 @@ void AP_InertialSensor::BatchSampler::init()
     if (_sensor_mask == 0) {
         return;
     }
+    // a failed allocation is not retried
+    init_attempted = true;
+    if ((batch_opt_t)(_batch_options_mask.get()) & BATCH_OPT_STREAM) {
+        initialised = init_stream();
+        return;
+    }
     if (_required_count <= 0) {
         return;
     }
@@ -84,6 +100,14 @@ void AP_InertialSensor::BatchSampler::periodic()
     if (_sensor_mask == 0) {
         return;
     }
+    if (!initialised) {
+        // buffers are only allocated once batch sampling is enabled,
+        // which may be after boot
+        if (!init_attempted) {
+            init();
+        }
+        return;
+    }
     push_data_to_log();
 }
 
@@ -111,6 +135,59 @@ void AP_InertialSensor::BatchSampler::update_doing_sensor_rate_logging()
     }
 }
 
+/*
+  allocate the streaming ring and pick the gyro to stream
+ */
+bool AP_InertialSensor::BatchSampler::init_stream()
+{
+    // stream the first IMU in the mask
+    const uint8_t _count = MIN(_imu._accel_count, _imu._gyro_count);
+    bool haveinstance = false;
+    for (uint8_t i=0; i<_count; i++) {
+        if (_sensor_mask & (1U<<i)) {
+            instance = i;
+            haveinstance = true;
+            break;
+        }
+    }
+    if (!haveinstance) {
+        return false;
+    }
+
+    // a power of two keeps the ring offsets continuous when the
+    // sample counts wrap
+    stream_ring_samples = 2*STREAM_BATCH_SAMPLES;
+    while (stream_ring_samples*2 <= _stream_ring_size) {
+        stream_ring_samples *= 2;
+    }
+
+    const uint32_t total_allocation = 3*stream_ring_samples*sizeof(uint16_t);
+    gcs().send_text(MAV_SEVERITY_DEBUG, "INS: alloc %u bytes for ISB stream (free=%u)", (unsigned int)total_allocation, (unsigned int)hal.util->available_memory());
+
+    data_x = (int16_t*)calloc(stream_ring_samples, sizeof(int16_t));
+    data_y = (int16_t*)calloc(stream_ring_samples, sizeof(int16_t));
+    data_z = (int16_t*)calloc(stream_ring_samples, sizeof(int16_t));
+    stream_batches = (struct stream_batch *)calloc(stream_ring_samples / STREAM_BATCH_SAMPLES, sizeof(struct stream_batch));
+    if (data_x == nullptr || data_y == nullptr || data_z == nullptr || stream_batches == nullptr) {
+        free(data_x);
+        free(data_y);
+        free(data_z);
+        free(stream_batches);
+        data_x = nullptr;
+        data_y = nullptr;
+        data_z = nullptr;
+        stream_batches = nullptr;
+        gcs().send_text(MAV_SEVERITY_WARNING, "Failed to allocate %u bytes for IMU batch streaming", (unsigned int)total_allocation);
+        return false;
+    }
+
+    type = IMU_SENSOR_TYPE_GYRO;
+    multiplier = _imu._gyro_raw_sampling_multiplier[instance];
+    update_doing_sensor_rate_logging();
+
+    return true;
+}
+
 void AP_InertialSensor::BatchSampler::rotate_to_next_sensor()
 {
     if (_sensor_mask == 0) {
@@ -170,6 +247,26 @@ void AP_InertialSensor::BatchSampler::rotate_to_next_sensor()
     update_doing_sensor_rate_logging();
 }
 
+float AP_InertialSensor::BatchSampler::sample_rate_hz() const
+{
+    float sample_rate = 0; // avoid warning about uninitialised values
+    switch(type) {
+    case IMU_SENSOR_TYPE_GYRO:
+        sample_rate = _imu._gyro_raw_sample_rates[instance];
+        if (_doing_sensor_rate_logging) {
+            sample_rate *= _imu._gyro_over_sampling[instance];
+        }
+        break;
+    case IMU_SENSOR_TYPE_ACCEL:
+        sample_rate = _imu._accel_raw_sample_rates[instance];
+        if (_doing_sensor_rate_logging) {
+            sample_rate *= _imu._accel_over_sampling[instance];
+        }
+        break;
+    }
+    return sample_rate;
+}
+
 void AP_InertialSensor::BatchSampler::push_data_to_log()
 {
     if (!initialised) {
@@ -178,6 +275,10 @@ void AP_InertialSensor::BatchSampler::push_data_to_log()
     if (_sensor_mask == 0) {
         return;
     }
+    if (stream_batches != nullptr) {
+        push_stream_to_log();
+        return;
+    }
     if (data_write_offset - data_read_offset < samples_per_msg) {
         // insuffucient data to pack a packet
         return;
@@ -194,28 +295,13 @@ void AP_InertialSensor::BatchSampler::push_data_to_log()
 
     // possibly send isb header:
     if (!isbh_sent && data_read_offset == 0) {
-        float sample_rate = 0; // avoid warning about uninitialised values
-        switch(type) {
-        case IMU_SENSOR_TYPE_GYRO:
-            sample_rate = _imu._gyro_raw_sample_rates[instance];
-            if (_doing_sensor_rate_logging) {
-                sample_rate *= _imu._gyro_over_sampling[instance];
-            }
-            break;
-        case IMU_SENSOR_TYPE_ACCEL:
-            sample_rate = _imu._accel_raw_sample_rates[instance];
-            if (_doing_sensor_rate_logging) {
-                sample_rate *= _imu._accel_over_sampling[instance];
-            }
-            break;
-        }
         if (!logger->Write_ISBH(isb_seqnum,
                                        type,
                                        instance,
                                        multiplier,
                                        _required_count,
                                        measurement_started_us,
-                                       sample_rate)) {
+                                       sample_rate_hz())) {
             // buffer full?
             return;
         }
@@ -243,6 +329,111 @@ void AP_InertialSensor::BatchSampler::push_data_to_log()
     }
 }
 
+/*
+  push as much of the stream to the log as it will take. A failed
+  write means the logger is behind, so we back off by averaging more
+  samples into each logged sample
+ */
+void AP_InertialSensor::BatchSampler::push_stream_to_log()
+{
+    AP_Logger *logger = AP_Logger::get_singleton();
+    if (logger == nullptr) {
+        // should not have been called
+        return;
+    }
+    if (!logger->should_log(MASK_LOG_ANY)) {
+        // not logging isn't backpressure
+        return;
+    }
+
+    bool backpressure = false;
+    for (uint8_t i=0; i<STREAM_MAX_MSGS_PER_CALL; i++) {
+        const uint32_t read_count = stream_read_count.load();
+        if (stream_write_count.load() - read_count < 32) {
+            // insufficient data to pack a packet
+            break;
+        }
+        if (logger->bufferspace_available() < STREAM_LOG_HEADROOM) {
+            // leave the rest of the buffer to everything else
+            backpressure = true;
+            break;
+        }
+        const uint16_t ofs = read_count % stream_ring_samples;
+        const uint16_t batch_ofs = ofs % STREAM_BATCH_SAMPLES;
+
+        // possibly send a gap marker and the isb header:
+        if (!isbh_sent && batch_ofs == 0) {
+            struct stream_batch &batch = stream_batches[ofs / STREAM_BATCH_SAMPLES];
+            if (batch.dropped != 0) {
+                if (!logger->Write_ISBG(isb_seqnum, batch.start_us, batch.dropped)) {
+                    backpressure = true;
+                    break;
+                }
+                batch.dropped = 0;
+            }
+            if (!logger->Write_ISBH(isb_seqnum,
+                                    type,
+                                    instance,
+                                    multiplier,
+                                    STREAM_BATCH_SAMPLES,
+                                    batch.start_us,
+                                    sample_rate_hz() / batch.decimation)) {
+                backpressure = true;
+                break;
+            }
+            isbh_sent = true;
+        }
+
+        if (!logger->Write_ISBD(isb_seqnum,
+                                batch_ofs/32,
+                                &data_x[ofs],
+                                &data_y[ofs],
+                                &data_z[ofs])) {
+            backpressure = true;
+            break;
+        }
+        stream_read_count.store(read_count + 32);
+        if (batch_ofs + 32 >= STREAM_BATCH_SAMPLES) {
+            isb_seqnum++;
+            isbh_sent = false;
+        }
+    }
+
+    update_stream_decimation(backpressure);
+}
+
+/*
+  double the decimation while the logger is pushing back or the ring
+  is filling, and halve it again once the logger has kept up for a
+  while
+ */
+void AP_InertialSensor::BatchSampler::update_stream_decimation(bool backpressure)
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    const uint32_t used = stream_write_count.load() - stream_read_count.load();
+    uint8_t decimation = stream_decimation.load();
+
+    if (backpressure || used > stream_ring_samples*3/4) {
+        stream_backpressure_ms = now_ms;
+        // a change only applies from the next batch, so give the last
+        // one time to take effect
+        if (decimation < STREAM_MAX_DECIMATION &&
+            now_ms - stream_decimation_change_ms > 1000) {
+            stream_decimation.store(decimation*2);
+            stream_decimation_change_ms = now_ms;
+        }
+        return;
+    }
+
+    if (decimation > 1 &&
+        used < stream_ring_samples/4 &&
+        now_ms - stream_backpressure_ms > 5000 &&
+        now_ms - stream_decimation_change_ms > 5000) {
+        stream_decimation.store(decimation/2);
+        stream_decimation_change_ms = now_ms;
+    }
+}
+
 bool AP_InertialSensor::BatchSampler::should_log(uint8_t _instance, IMU_SENSOR_TYPE _type)
 {
     if (_sensor_mask == 0) {
@@ -264,7 +455,6 @@ bool AP_InertialSensor::BatchSampler::should_log(uint8_t _instance, IMU_SENSOR_T
     if (logger == nullptr) {
         return false;
     }
-#define MASK_LOG_ANY                    0xFFFF
     if (!logger->should_log(MASK_LOG_ANY)) {
         return false;
     }
@@ -273,6 +463,12 @@ bool AP_InertialSensor::BatchSampler::should_log(uint8_t _instance, IMU_SENSOR_T
 
 void AP_InertialSensor::BatchSampler::sample(uint8_t _instance, AP_InertialSensor::IMU_SENSOR_TYPE _type, uint64_t sample_us, const Vector3f &_sample)
 {
+    if (stream_batches != nullptr) {
+        if (initialised && _instance == instance && _type == type) {
+            stream_sample(sample_us, _sample);
+        }
+        return;
+    }
     if (!should_log(_instance, _type)) {
         return;
     }
@@ -286,3 +482,51 @@ void AP_InertialSensor::BatchSampler::sample(uint8_t _instance, AP_InertialSenso
 
     data_write_offset++; // may unblock the reading process
 }
+
+/*
+  add a sample to the stream. Called from the backend for the streamed
+  gyro only
+ */
+void AP_InertialSensor::BatchSampler::stream_sample(uint64_t sample_us, const Vector3f &_sample)
+{
+    const uint32_t write_count = stream_write_count.load();
+    const uint16_t ofs = write_count % stream_ring_samples;
+
+    if (!stream_in_batch) {
+        AP_Logger *logger = AP_Logger::get_singleton();
+        if (logger == nullptr || !logger->should_log(MASK_LOG_ANY)) {
+            return;
+        }
+        if (stream_ring_samples - (write_count - stream_read_count.load()) < STREAM_BATCH_SAMPLES) {
+            // no room for a whole batch
+            stream_dropped++;
+            return;
+        }
+        struct stream_batch &batch = stream_batches[ofs / STREAM_BATCH_SAMPLES];
+        batch.start_us = sample_us ? sample_us : AP_HAL::micros64();
+        batch.dropped = stream_dropped;
+        batch.decimation = stream_decimation.load();
+        stream_batch_decimation = batch.decimation;
+        stream_dropped = 0;
+        stream_accum.zero();
+        stream_accum_count = 0;
+        stream_in_batch = true;
+    }
+
+    stream_accum += _sample;
+    if (++stream_accum_count < stream_batch_decimation) {
+        return;
+    }
+    const Vector3f s = stream_accum / stream_accum_count;
+    stream_accum.zero();
+    stream_accum_count = 0;
+
+    data_x[ofs] = multiplier*s.x;
+    data_y[ofs] = multiplier*s.y;
+    data_z[ofs] = multiplier*s.z;
+
+    if ((ofs + 1) % STREAM_BATCH_SAMPLES == 0) {
+        stream_in_batch = false;
+    }
+    stream_write_count.store(write_count + 1); // may unblock the reading process
+}
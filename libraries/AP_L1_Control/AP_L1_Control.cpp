@@ -80,7 +80,7 @@ int32_t AP_L1_Control::get_yaw_sensor() const
 int32_t AP_L1_Control::nav_roll_cd(void) const
 {
     float ret;
-    ret = cosf(_ahrs.pitch)*degrees(atanf(_latAccDem * 0.101972f) * 100.0f); // 0.101972 = 1/9.81
+    ret = cosf(_ahrs.pitch)*degrees(atanf(_output_lat_acc() * 0.101972f) * 100.0f); // 0.101972 = 1/9.81
     ret = constrain_float(ret, -9000, 9000);
     return ret;
 }
@@ -91,7 +91,43 @@ int32_t AP_L1_Control::nav_roll_cd(void) const
  */
 float AP_L1_Control::lateral_acceleration(void) const
 {
-    return _latAccDem;
+    return _output_lat_acc();
+}
+
+/*
+  return _latAccDem linearly interpolated from its value before the
+  last update, over the interpolation period
+ */
+float AP_L1_Control::_output_lat_acc(void) const
+{
+    if (_output.interp_us == 0) {
+        return _latAccDem;
+    }
+    const uint32_t dt_us = AP_HAL::micros() - _output.start_us;
+    if (dt_us >= _output.period_us) {
+        return _latAccDem;
+    }
+    return _output.latAccDem_prev + (_latAccDem - _output.latAccDem_prev) * (dt_us / float(_output.period_us));
+}
+
+void AP_L1_Control::_output_update_start(void)
+{
+    // the demand being output now is where the interpolation to the
+    // new demand starts from, unless there has been a gap in updates
+    const uint32_t now_us = AP_HAL::micros();
+    const uint32_t dt_us = now_us - _output.start_us;
+    _output.interpolate = dt_us < 2 * _output.interp_us;
+    _output.latAccDem_prev = _output_lat_acc();
+    _output.start_us = now_us;
+    _output.period_us = MIN(dt_us, _output.interp_us);
+}
+
+void AP_L1_Control::_output_update_end(void)
+{
+    if (!_output.interpolate) {
+        _output.latAccDem_prev = _latAccDem;
+    }
+    _output.update_us = AP_HAL::micros() - _output.start_us;
 }
 
 int32_t AP_L1_Control::nav_bearing_cd(void) const
@@ -198,6 +234,8 @@ void AP_L1_Control::_prevent_indecision(float &Nu)
 // update L1 control for waypoint navigation
 void AP_L1_Control::update_waypoint(const struct Location &prev_WP, const struct Location &next_WP, float dist_min)
 {
+    _output_update_start();
+
 
     printf("hello whale update_waypoint\n");
 
@@ -221,6 +259,7 @@ void AP_L1_Control::update_waypoint(const struct Location &prev_WP, const struct
     if (_ahrs.get_position(_current_loc) == false) {
         // if no GPS loc available, maintain last nav/target_bearing
         _data_is_stale = true;
+        _output_update_end();
         return;
     }
 
@@ -330,11 +369,15 @@ void AP_L1_Control::update_waypoint(const struct Location &prev_WP, const struct
     _bearing_error = Nu; // bearing error angle (radians), +ve to left of track
 
     _data_is_stale = false; // status are correctly updated with current waypoint data
+
+    _output_update_end();
 }
 
 // update L1 control for loitering
 void AP_L1_Control::update_loiter(const struct Location &center_WP, float radius, int8_t loiter_direction)
 {
+    _output_update_start();
+
     struct Location _current_loc;
 
     // scale loiter radius with square of EAS2TAS to allow us to stay
@@ -353,6 +396,7 @@ void AP_L1_Control::update_loiter(const struct Location &center_WP, float radius
     if (_ahrs.get_position(_current_loc) == false) {
         // if no GPS loc available, maintain last nav/target_bearing
         _data_is_stale = true;
+        _output_update_end();
         return;
     }
 
@@ -442,12 +486,16 @@ void AP_L1_Control::update_loiter(const struct Location &center_WP, float radius
     }
 
     _data_is_stale = false; // status are correctly updated with current waypoint data
+
+    _output_update_end();
 }
 
 
 // update L1 control for heading hold navigation
 void AP_L1_Control::update_heading_hold(int32_t navigation_heading_cd)
 {
+    _output_update_start();
+
     // Calculate normalised frequency for tracking loop
     const float omegaA = 4.4428f/_L1_period; // sqrt(2)*pi/period
     // Calculate additional damping gain
@@ -484,11 +532,15 @@ void AP_L1_Control::update_heading_hold(int32_t navigation_heading_cd)
     _latAccDem = 2.0f*sinf(Nu)*VomegaA;
 
     _data_is_stale = false; // status are correctly updated with current waypoint data
+
+    _output_update_end();
 }
 
 // update L1 control for level flight on current heading
 void AP_L1_Control::update_level_flight(void)
 {
+    _output_update_start();
+
     // copy to _target_bearing_cd and _nav_bearing
     _target_bearing_cd = _ahrs.yaw_sensor;
     _nav_bearing = _ahrs.yaw;
@@ -501,4 +553,6 @@ void AP_L1_Control::update_level_flight(void)
     _latAccDem = 0;
 
     _data_is_stale = false; // status are correctly updated with current waypoint data
+
+    _output_update_end();
 }
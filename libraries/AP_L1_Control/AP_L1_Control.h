@@ -76,6 +76,19 @@ public:
         _reverse = reverse;
     }
 
+    // interpolate the lateral acceleration demand over the period
+    // between calls to the update functions, for vehicles which call
+    // them at update_hz but use the demand at a higher rate. Zero
+    // disables interpolation
+    void set_output_interpolation(float update_hz) {
+        _output.interp_us = is_positive(update_hz) ? 1.0e6f / update_hz : 0;
+    }
+
+    // time taken by the last update in microseconds
+    uint32_t get_update_time_us(void) const {
+        return _output.update_us;
+    }
+
 private:
     // reference to the AHRS object
     AP_AHRS &_ahrs;
@@ -87,6 +100,28 @@ private:
     // L1 reference point (+ve to right)
     float _latAccDem;
 
+    // demand interpolation between updates, and update timing
+    struct {
+        // expected time between updates, zero when disabled
+        uint32_t interp_us;
+        // start and length of the interpolation from the previous
+        // demand. The length is the last time between updates, so
+        // updates called faster than expected aren't smoothed
+        uint32_t start_us;
+        uint32_t period_us;
+        float latAccDem_prev;
+        bool interpolate;
+        // time taken by the last update
+        uint32_t update_us;
+    } _output;
+
+    // _latAccDem interpolated from the previous demand
+    float _output_lat_acc(void) const;
+
+    // called at the start and end of each update
+    void _output_update_start(void);
+    void _output_update_end(void);
+
     // L1 tracking distance in meters which is dynamically updated
     float _L1_dist;
 
@@ -8,6 +8,7 @@
 #include "AP_Logger_MAVLink.h"
 
 #include <AP_InternalError/AP_InternalError.h>
+#include <AP_Scheduler/AP_Scheduler.h>
 #include <GCS_MAVLink/GCS.h>
 
 AP_Logger *AP_Logger::_singleton;
@@ -26,10 +27,19 @@ extern const AP_HAL::HAL& hal;
 #define HAL_LOGGING_MAV_BUFSIZE  8
 #endif 
 
+#ifndef HAL_LOGGING_FILE_BLOCKS
+#define HAL_LOGGING_FILE_BLOCKS 0
+#endif
+
 #ifndef HAL_LOGGING_FILE_TIMEOUT
 #define HAL_LOGGING_FILE_TIMEOUT 5
 #endif 
 
+// per message rates for the rate limiter, read at boot
+#if !defined(HAL_LOGGER_RATE_FILE) && defined(HAL_BOARD_STORAGE_DIRECTORY)
+#define HAL_LOGGER_RATE_FILE HAL_BOARD_STORAGE_DIRECTORY "/lograte.txt"
+#endif
+
 // by default log for 15 seconds after disarming
 #ifndef HAL_LOGGER_ARM_PERSIST
 #define HAL_LOGGER_ARM_PERSIST 15
@@ -81,7 +91,7 @@ const AP_Param::GroupInfo AP_Logger::var_info[] = {
 
     // @Param: _MAV_BUFSIZE
     // @DisplayName: Maximum AP_Logger MAVLink Backend buffer size
-    // @Description: Maximum amount of memory to allocate to AP_Logger-over-mavlink
+    // @Description: Maximum amount of memory to allocate to AP_Logger-over-mavlink. This also limits how much log data can be in flight waiting to be acknowledged, so links with high latency need a larger buffer
     // @User: Advanced
     // @Units: kB
     AP_GROUPINFO("_MAV_BUFSIZE",  5, AP_Logger, _params.mav_bufsize,       HAL_LOGGING_MAV_BUFSIZE),
@@ -92,6 +102,31 @@ const AP_Param::GroupInfo AP_Logger::var_info[] = {
     // @User: Standard
     // @Units: s
     AP_GROUPINFO("_FILE_TIMEOUT",  6, AP_Logger, _params.file_timeout,     HAL_LOGGING_FILE_TIMEOUT),
+
+    // @Param: _FILE_BLOCKS
+    // @DisplayName: Use block writer for AP_Logger File Backend
+    // @Description: When enabled the AP_Logger_File buffer is split into fixed size blocks. Full blocks are handed to the IO thread and written to the card in one go while logging continues into the next block, so a single slow write doesn't stall logging. Takes effect on reboot.
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("_FILE_BLOCKS",  7, AP_Logger, _params.file_blocks,     HAL_LOGGING_FILE_BLOCKS),
+
+    // @Param: _FILE_COMPR
+    // @DisplayName: Compress AP_Logger File Backend logs
+    // @Description: When enabled the AP_Logger_File backend compresses each block before writing it, which also enables the block writer. Compressed logs are smaller and quicker to download, but must be decompressed with Tools/scripts/decompress_log.py before they can be read by most log analysis tools. Replay reads them directly. Takes effect on reboot.
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("_FILE_COMPR",  8, AP_Logger, _params.file_compress,     0),
+
+    // @Param: _RATE_MAX
+    // @DisplayName: Maximum rate of each log message
+    // @Description: If non-zero, each type of log message is written at no more than this rate, with the remaining messages of that type being dropped before they reach the backends. Messages written as critical are never limited. Rates for individual messages can be set in the file lograte.txt in the APM directory of the SD card, which holds one "NAME RATE" pair per line (for example "XKF4 25"), where a rate of 0 means that message is never limited. Replay needs the messages it uses logged at full rate. Enabling rate limiting from 0 takes effect on reboot.
+    // @Units: Hz
+    // @Range: 0 400
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_MAX",  9, AP_Logger, _params.rate_max,     0),
+
     
     AP_GROUPEND
 };
@@ -201,6 +236,8 @@ void AP_Logger::Init(const struct LogStructure *structures, uint8_t num_types)
     }
 #endif
 
+    init_rate_limiter();
+
     for (uint8_t i=0; i<_next_backend; i++) {
         backends[i]->Init();
     }
@@ -218,6 +255,14 @@ void AP_Logger::Init(const struct LogStructure *structures, uint8_t num_types)
 extern const AP_HAL::HAL& hal;
 #define Debug(fmt, args ...)  do {::fprintf(stderr, "%s:%d: " fmt "\n", __FUNCTION__, __LINE__, ## args); } while(0)
 
+// the structures every vehicle logs are checked at build time; the
+// vehicle specific ones are still checked by validate_structures()
+static constexpr struct LogStructure common_log_structures[] = {
+    LOG_COMMON_STRUCTURES
+};
+static_assert(log_structures_valid(common_log_structures, ARRAY_SIZE(common_log_structures)),
+              "Log structures do not match their formats");
+
 /// return the number of commas present in string
 static uint8_t count_commas(const char *string)
 {
@@ -584,8 +629,62 @@ void AP_Logger::set_vehicle_armed(const bool armed_state)
 }
 
 
+void AP_Logger::init_rate_limiter()
+{
+    _rate_limiter = new AP_Logger_RateLimiter(_params.rate_max);
+    if (_rate_limiter == nullptr) {
+        return;
+    }
+#ifdef HAL_LOGGER_RATE_FILE
+    const uint8_t count = _rate_limiter->load_file(HAL_LOGGER_RATE_FILE);
+    if (count != 0) {
+        hal.console->printf("Logger: loaded %u message rates\n", count);
+    }
+#endif
+    if (!is_positive(_params.rate_max) && _rate_limiter->num_rates() == 0) {
+        // nothing to limit, keep the write path free of it
+        delete _rate_limiter;
+        _rate_limiter = nullptr;
+    }
+}
+
+bool AP_Logger::rate_limit_ok(const uint8_t msg_type)
+{
+    if (_rate_limiter == nullptr) {
+        return true;
+    }
+    if (_rate_limiter->needs_resolve(msg_type)) {
+        _rate_limiter->resolve(msg_type, name_for_msg_type(msg_type));
+    }
+    return _rate_limiter->should_log(msg_type, AP_HAL::millis(), AP::scheduler().ticks());
+}
+
+bool AP_Logger::rate_limit_ok(const void *pBuffer)
+{
+    return rate_limit_ok(((const uint8_t *)pBuffer)[2]);
+}
+
+uint32_t AP_Logger::num_rate_limited() const
+{
+    if (_rate_limiter == nullptr) {
+        return 0;
+    }
+    return _rate_limiter->num_suppressed();
+}
+
+uint16_t AP_Logger::num_rate_limited(const uint8_t msg_type) const
+{
+    if (_rate_limiter == nullptr) {
+        return 0;
+    }
+    return _rate_limiter->num_suppressed(msg_type);
+}
+
 // start functions pass straight through to backend:
 void AP_Logger::WriteBlock(const void *pBuffer, uint16_t size) {
+    if (!rate_limit_ok(pBuffer)) {
+        return;
+    }
     FOR_EACH_BACKEND(WriteBlock(pBuffer, size));
 }
 
@@ -594,6 +693,9 @@ void AP_Logger::WriteCriticalBlock(const void *pBuffer, uint16_t size) {
 }
 
 void AP_Logger::WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical) {
+    if (!is_critical && !rate_limit_ok(pBuffer)) {
+        return;
+    }
     FOR_EACH_BACKEND(WritePrioritisedBlock(pBuffer, size, is_critical));
 }
 
@@ -651,6 +753,14 @@ uint16_t AP_Logger::get_num_logs(void) {
     return backends[0]->get_num_logs();
 }
 
+/* only the first backend's space is reported, as for Write_ISBD */
+uint32_t AP_Logger::bufferspace_available(void) {
+    if (_next_backend == 0) {
+        return 0;
+    }
+    return backends[0]->bufferspace_available();
+}
+
 /* we're started if any of the backends are started */
 bool AP_Logger::logging_started(void) {
     for (uint8_t i=0; i< _next_backend; i++) {
@@ -787,6 +897,9 @@ void AP_Logger::WriteV(const char *name, const char *labels, const char *units,
         AP::internalerror().error(AP_InternalError::error_t::logger_mapfailure);
         return;
     }
+    if (!is_critical && !rate_limit_ok(f->msg_type)) {
+        return;
+    }
 
     for (uint8_t i=0; i<_next_backend; i++) {
         if (!(f->sent_mask & (1U<<i))) {
@@ -803,6 +916,37 @@ void AP_Logger::WriteV(const char *name, const char *labels, const char *units,
 }
 
 
+void AP_Logger::WritePacked(const char *name, const char *labels, const char *fmt, const void *fields, uint8_t fields_len)
+{
+    struct log_write_fmt *f = msg_fmt_for_name(name, labels, nullptr, nullptr, fmt);
+    if (f == nullptr) {
+        AP::internalerror().error(AP_InternalError::error_t::logger_mapfailure);
+        return;
+    }
+    if (fields_len + 3U != f->msg_len) {
+        return;
+    }
+    if (!rate_limit_ok(f->msg_type)) {
+        return;
+    }
+
+    uint8_t buffer[f->msg_len];
+    buffer[0] = HEAD_BYTE1;
+    buffer[1] = HEAD_BYTE2;
+    buffer[2] = f->msg_type;
+    memcpy(&buffer[3], fields, fields_len);
+
+    for (uint8_t i=0; i<_next_backend; i++) {
+        if (!(f->sent_mask & (1U<<i))) {
+            if (!backends[i]->Write_Emit_FMT(f->msg_type)) {
+                continue;
+            }
+            f->sent_mask |= (1U<<i);
+        }
+        backends[i]->WriteBlock(buffer, f->msg_len);
+    }
+}
+
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
 void AP_Logger::assert_same_fmt_for_name(const AP_Logger::log_write_fmt *f,
                                                const char *name,
@@ -943,6 +1087,19 @@ const struct LogStructure *AP_Logger::structure_for_msg_type(const uint8_t msg_t
     return nullptr;
 }
 
+const char *AP_Logger::name_for_msg_type(const uint8_t msg_type)
+{
+    const struct LogStructure *s = structure_for_msg_type(msg_type);
+    if (s != nullptr) {
+        return s->name;
+    }
+    const struct log_write_fmt *f = log_write_fmt_for_msg_type(msg_type);
+    if (f != nullptr) {
+        return f->name;
+    }
+    return nullptr;
+}
+
 const struct AP_Logger::log_write_fmt *AP_Logger::log_write_fmt_for_msg_type(const uint8_t msg_type) const
 {
     struct log_write_fmt *f;
@@ -1040,33 +1197,14 @@ int16_t AP_Logger::Write_calc_msg_len(const char *fmt) const
 {
     uint8_t len =  LOG_PACKET_HEADER_LEN;
     for (uint8_t i=0; i<strlen(fmt); i++) {
-        switch(fmt[i]) {
-        case 'a' : len += sizeof(int16_t[32]); break;
-        case 'b' : len += sizeof(int8_t); break;
-        case 'c' : len += sizeof(int16_t); break;
-        case 'd' : len += sizeof(double); break;
-        case 'e' : len += sizeof(int32_t); break;
-        case 'f' : len += sizeof(float); break;
-        case 'h' : len += sizeof(int16_t); break;
-        case 'i' : len += sizeof(int32_t); break;
-        case 'n' : len += sizeof(char[4]); break;
-        case 'B' : len += sizeof(uint8_t); break;
-        case 'C' : len += sizeof(uint16_t); break;
-        case 'E' : len += sizeof(uint32_t); break;
-        case 'H' : len += sizeof(uint16_t); break;
-        case 'I' : len += sizeof(uint32_t); break;
-        case 'L' : len += sizeof(int32_t); break;
-        case 'M' : len += sizeof(uint8_t); break;
-        case 'N' : len += sizeof(char[16]); break;
-        case 'Z' : len += sizeof(char[64]); break;
-        case 'q' : len += sizeof(int64_t); break;
-        case 'Q' : len += sizeof(uint64_t); break;
-        default:
+        const uint8_t size = log_format_field_size(fmt[i]);
+        if (size == 0) {
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
             AP_HAL::panic("Unknown format specifier (%c)", fmt[i]);
 #endif
             return -1;
         }
+        len += size;
     }
     return len;
 }
@@ -1136,6 +1274,30 @@ bool AP_Logger::Write_ISBD(const uint16_t isb_seqno,
     return backends[0]->WriteBlock(&pkt, sizeof(pkt));
 }
 
+// Write a marker for samples dropped from an IMU batch stream:
+bool AP_Logger::Write_ISBG(const uint16_t isb_seqno,
+                                     const uint64_t sample_us,
+                                     const uint32_t dropped)
+{
+    if (_next_backend == 0) {
+        return false;
+    }
+    const struct log_ISBG pkt{
+        LOG_PACKET_HEADER_INIT(LOG_ISBG_MSG),
+        time_us    : AP_HAL::micros64(),
+        isb_seqno  : isb_seqno,
+        sample_us  : sample_us,
+        dropped    : dropped,
+    };
+
+    // only the first backend need succeed for us to be successful
+    for (uint8_t i=1; i<_next_backend; i++) {
+        backends[i]->WriteBlock(&pkt, sizeof(pkt));
+    }
+
+    return backends[0]->WriteBlock(&pkt, sizeof(pkt));
+}
+
 // Wrote an event packet
 void AP_Logger::Write_Event(Log_Event id)
 {
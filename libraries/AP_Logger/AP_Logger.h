@@ -23,11 +23,15 @@
 #include <stdint.h>
 
 #include "LoggerMessageWriter.h"
+#include "AP_Logger_RateLimiter.h"
 
 class AP_Logger_Backend;
 class AP_AHRS;
 class AP_AHRS_View;
 
+// returned by get_log_data() when the data is still being read
+#define LOGGER_DATA_PENDING -2
+
 // do not do anything here apart from add stuff; maintaining older
 // entries means log analysis is easier
 enum Log_Event : uint8_t {
@@ -187,6 +191,14 @@ public:
     AP_Logger(const AP_Logger &other) = delete;
     AP_Logger &operator=(const AP_Logger&) = delete;
 
+    // backend types, as bits of LOG_BACKEND_TYPE
+    enum class Backend_Type : uint8_t {
+        NONE       = 0,
+        FILESYSTEM = (1<<0),
+        MAVLINK    = (1<<1),
+        BLOCK      = (1<<2),
+    };
+
     // get singleton instance
     static AP_Logger *get_singleton(void) {
         return _singleton;
@@ -239,6 +251,9 @@ public:
                         const int16_t x[32],
                         const int16_t y[32],
                         const int16_t z[32]);
+    bool Write_ISBG(uint16_t isb_seqno,
+                        uint64_t sample_us,
+                        uint32_t dropped);
     void Write_Vibration();
     void Write_RCIN(void);
     void Write_RCOUT(void);
@@ -289,6 +304,10 @@ public:
     void WriteCritical(const char *name, const char *labels, const char *fmt, ...);
     void WriteCritical(const char *name, const char *labels, const char *units, const char *mults, const char *fmt, ...);
     void WriteV(const char *name, const char *labels, const char *units, const char *mults, const char *fmt, va_list arg_list, bool is_critical=false);
+    // write a message whose fields have already been packed as fmt
+    // describes, for callers such as scripts that can't use the
+    // variadic Write(). name, labels and fmt must never be freed
+    void WritePacked(const char *name, const char *labels, const char *fmt, const void *fields, uint8_t fields_len);
 
     // This structure provides information on the internal member data of a PID for logging purposes
     struct PID_Info {
@@ -308,6 +327,10 @@ public:
 
     bool logging_started(void);
 
+    // space in the first backend's buffer available for non-critical
+    // messages, in bytes
+    uint32_t bufferspace_available(void);
+
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
     // currently only AP_Logger_File support this:
     void flush(void);
@@ -320,6 +343,11 @@ public:
     // number of blocks that have been dropped
     uint32_t num_dropped(void) const;
 
+    // number of messages suppressed by rate limiting, in total and
+    // per message type
+    uint32_t num_rate_limited(void) const;
+    uint16_t num_rate_limited(uint8_t msg_type) const;
+
     // accesss to public parameters
     void set_force_log_disarmed(bool force_logging) { _force_log_disarmed = force_logging; }
     bool log_while_disarmed(void) const;
@@ -337,6 +365,9 @@ public:
         AP_Int8 log_replay;
         AP_Int8 mav_bufsize; // in kilobytes
         AP_Int16 file_timeout; // in seconds
+        AP_Int8 file_blocks;
+        AP_Int8 file_compress;
+        AP_Float rate_max;
     } _params;
 
     const struct LogStructure *structure(uint16_t num) const;
@@ -387,12 +418,13 @@ private:
     AP_Logger_Backend *backends[LOGGER_MAX_BACKENDS];
     const AP_Int32 &_log_bitmask;
 
-    enum class Backend_Type : uint8_t {
-        NONE       = 0,
-        FILESYSTEM = (1<<0),
-        MAVLINK    = (1<<1),
-        BLOCK      = (1<<2),
-    };
+    // per message type rate limits, nullptr if not rate limiting
+    AP_Logger_RateLimiter *_rate_limiter;
+    void init_rate_limiter();
+    // returns false if the message in pBuffer should be dropped to
+    // keep to its rate limit
+    bool rate_limit_ok(const void *pBuffer);
+    bool rate_limit_ok(uint8_t msg_type);
 
     /*
      * support for dynamic Write; user-supplies name, format,
@@ -421,6 +453,9 @@ private:
 
     const struct LogStructure *structure_for_msg_type(uint8_t msg_type);
 
+    // return the name of msg_type, nullptr if it isn't in use
+    const char *name_for_msg_type(uint8_t msg_type);
+
     // return a msg_type which is not currently in use (or -1 if none available)
     int16_t find_free_msg_type() const;
 
@@ -519,7 +554,7 @@ private:
     void handle_log_request_data(class GCS_MAVLINK &, const mavlink_message_t &msg);
     void handle_log_request_erase(class GCS_MAVLINK &, const mavlink_message_t &msg);
     void handle_log_request_end(class GCS_MAVLINK &, const mavlink_message_t &msg);
-    void handle_log_send_listing(); // handle LISTING state
+    bool handle_log_send_listing(); // handle LISTING state
     void handle_log_sending(); // handle SENDING state
     bool handle_log_send_data(); // send data chunk to client
 
@@ -3,15 +3,27 @@
 #include "LoggerMessageWriter.h"
 
 #include <AP_InternalError/AP_InternalError.h>
+#include <GCS_MAVLink/GCS.h>
 
 extern const AP_HAL::HAL& hal;
 
+// per message type statistics cost about 2kB per backend
+#ifndef HAL_LOGGER_MSG_STATS_ENABLED
+#define HAL_LOGGER_MSG_STATS_ENABLED (HAL_MEM_CLASS >= HAL_MEM_CLASS_300)
+#endif
+
+// minimum interval between drop warnings sent to the GCS
+#define LOGGER_DROP_WARNING_MS 10000U
+
 AP_Logger_Backend::AP_Logger_Backend(AP_Logger &front,
                                      class LoggerMessageWriter_DFLogStart *writer) :
     _front(front),
     _startup_messagewriter(writer)
 {
     writer->set_logger_backend(this);
+#if HAL_LOGGER_MSG_STATS_ENABLED
+    _msg_stats = new msg_stats;
+#endif
 }
 
 uint8_t AP_Logger_Backend::num_types() const
@@ -63,6 +75,7 @@ void AP_Logger_Backend::periodic_tasks()
     uint32_t now = AP_HAL::millis();
     if (now - _last_periodic_1Hz > 1000) {
         periodic_1Hz();
+        msg_stats_log();
         _last_periodic_1Hz = now;
     }
     if (now - _last_periodic_10Hz > 100) {
@@ -363,7 +376,137 @@ bool AP_Logger_Backend::WritePrioritisedBlock(const void *pBuffer, uint16_t size
     if (!WritesOK()) {
         return false;
     }
-    return _WritePrioritisedBlock(pBuffer, size, is_critical);
+    const uint32_t dropped = _dropped;
+    const bool ret = _WritePrioritisedBlock(pBuffer, size, is_critical);
+    if (_msg_stats != nullptr) {
+        msg_stats_update(pBuffer, size, ret, _dropped != dropped);
+    }
+    return ret;
+}
+
+/*
+  account for one message passed to _WritePrioritisedBlock. A message
+  is only counted as dropped if the backend counted it as dropped, as
+  backends may refuse startup messages which will be sent again
+ */
+void AP_Logger_Backend::msg_stats_update(const void *pBuffer, uint16_t size, bool written, bool dropped)
+{
+    const uint8_t type = ((const uint8_t *)pBuffer)[2];
+    if (written) {
+        _msg_stats->bytes[type] += size;
+        _stats_period_bytes += size;
+        const uint32_t space = bufferspace_available();
+        if (space < _stats_period_buf_space_min) {
+            _stats_period_buf_space_min = space;
+        }
+    } else if (dropped && _msg_stats->dropped[type] < UINT16_MAX) {
+        _msg_stats->dropped[type]++;
+    }
+}
+
+uint16_t AP_Logger_Backend::num_dropped(const uint8_t msg_type) const
+{
+    if (_msg_stats == nullptr) {
+        return 0;
+    }
+    return _msg_stats->dropped[msg_type];
+}
+
+const char *AP_Logger_Backend::backend_name() const
+{
+    switch (AP_Logger::Backend_Type(backend_type())) {
+    case AP_Logger::Backend_Type::FILESYSTEM:
+        return "File";
+    case AP_Logger::Backend_Type::MAVLINK:
+        return "MAVLink";
+    case AP_Logger::Backend_Type::BLOCK:
+        return "Block";
+    case AP_Logger::Backend_Type::NONE:
+        break;
+    }
+    return "?";
+}
+
+/*
+  log a summary of the last second of writes and a message for each
+  message type that was dropped, and tell the GCS if messages are
+  being dropped
+ */
+void AP_Logger_Backend::msg_stats_log()
+{
+    if (_msg_stats == nullptr) {
+        return;
+    }
+    if (_stats_period_buf_space_min == UINT32_MAX) {
+        // nothing written in the last second
+        _stats_period_buf_space_min = bufferspace_available();
+    }
+    if (_stats_period_buf_space_min < _stats_buf_space_min) {
+        _stats_buf_space_min = _stats_period_buf_space_min;
+    }
+
+    const bool log = logging_started();
+    struct log_LoggerStats pkt {
+        LOG_PACKET_HEADER_INIT(LOG_LOGGER_STATS_MSG),
+        time_us       : AP_HAL::micros64(),
+        backend       : backend_type(),
+        msg_id        : 255,
+        name          : {},
+        dropped       : _dropped - _stats_dropped_logged,
+        dropped_total : _dropped,
+        bytes         : _stats_period_bytes,
+        buf_space_min : _stats_period_buf_space_min,
+    };
+    if (log) {
+        WriteBlock(&pkt, sizeof(pkt));
+    }
+
+    uint8_t worst_type = 0;
+    uint16_t worst_dropped = 0;
+    for (uint16_t i=0; i<256; i++) {
+        const uint16_t dropped = _msg_stats->dropped[i] - _msg_stats->dropped_logged[i];
+        const uint32_t bytes = _msg_stats->bytes[i];
+        _msg_stats->bytes[i] = 0;
+        if (dropped == 0) {
+            continue;
+        }
+        _msg_stats->dropped_logged[i] = _msg_stats->dropped[i];
+        if (dropped > worst_dropped) {
+            worst_type = i;
+            worst_dropped = dropped;
+        }
+        if (!log || _writing_startup_messages) {
+            // don't compete with the startup messages for space
+            continue;
+        }
+        pkt.msg_id = i;
+        memset(pkt.name, 0, sizeof(pkt.name));
+        const char *name = _front.name_for_msg_type(i);
+        if (name != nullptr) {
+            memcpy(pkt.name, name, MIN(strlen(name), sizeof(pkt.name)));
+        }
+        pkt.dropped = dropped;
+        pkt.dropped_total = _msg_stats->dropped[i];
+        pkt.bytes = bytes;
+        // these explain gaps in the log, so use the reserved space
+        WriteCriticalBlock(&pkt, sizeof(pkt));
+    }
+
+    _stats_dropped_logged = _dropped;
+    _stats_period_bytes = 0;
+    _stats_period_buf_space_min = UINT32_MAX;
+
+    const uint32_t now_ms = AP_HAL::millis();
+    if (worst_dropped != 0 &&
+        now_ms - _stats_last_gcs_ms >= LOGGER_DROP_WARNING_MS) {
+        const char *name = _front.name_for_msg_type(worst_type);
+        gcs().send_text(MAV_SEVERITY_WARNING, "Logger %s: %u dropped, most %.4s",
+                        backend_name(),
+                        unsigned(_dropped - _stats_gcs_dropped),
+                        name != nullptr ? name : "?");
+        _stats_gcs_dropped = _dropped;
+        _stats_last_gcs_ms = now_ms;
+    }
 }
 
 bool AP_Logger_Backend::ShouldLog(bool is_critical)
@@ -38,6 +38,8 @@ public:
     virtual uint16_t find_last_log() = 0;
     virtual void get_log_boundaries(uint16_t log_num, uint32_t & start_page, uint32_t & end_page) = 0;
     virtual void get_log_info(uint16_t log_num, uint32_t &size, uint32_t &time_utc) = 0;
+    // returns the number of bytes read, or LOGGER_DATA_PENDING if
+    // the data isn't available yet and should be asked for again
     virtual int16_t get_log_data(uint16_t log_num, uint16_t page, uint32_t offset, uint16_t len, uint8_t *data) = 0;
     virtual uint16_t get_num_logs() = 0;
 
@@ -103,6 +105,15 @@ public:
         return _dropped;
     }
 
+    // type of this backend as an AP_Logger::Backend_Type, used to
+    // identify it in statistics
+    virtual uint8_t backend_type() const = 0;
+
+    // number of messages of msg_type dropped since boot
+    uint16_t num_dropped(uint8_t msg_type) const;
+    // lowest free buffer space seen since boot
+    uint32_t buffer_space_min() const { return _stats_buf_space_min; }
+
     /*
      * Write support
      */
@@ -162,5 +173,23 @@ private:
     uint32_t _last_periodic_10Hz;
     bool have_logged_armed;
 
+    // per message type write statistics, nullptr if they don't fit
+    struct msg_stats {
+        // bytes written since the last LSTA messages
+        uint32_t bytes[256];
+        uint16_t dropped[256];
+        // dropped counts as of the last LSTA messages
+        uint16_t dropped_logged[256];
+    } *_msg_stats;
+    uint32_t _stats_period_bytes;
+    uint32_t _stats_dropped_logged;
+    uint32_t _stats_period_buf_space_min = UINT32_MAX;
+    uint32_t _stats_buf_space_min = UINT32_MAX;
+    uint32_t _stats_gcs_dropped;
+    uint32_t _stats_last_gcs_ms;
+    void msg_stats_update(const void *pBuffer, uint16_t size, bool written, bool dropped);
+    void msg_stats_log();
+    const char *backend_name() const;
+
     void validate_WritePrioritisedBlock(const void *pBuffer, uint16_t size);
 };
@@ -18,10 +18,12 @@ AP_Logger_Block::AP_Logger_Block(AP_Logger &front, LoggerMessageWriter_DFLogStar
     writebuf(0),
     AP_Logger_Backend(front, writer)
 {
-    buffer = (uint8_t *)hal.util->malloc_type(page_size_max, AP_HAL::Util::MEM_DMA_SAFE);
-    if (buffer == nullptr) {
+    buffer = (uint8_t *)hal.util->malloc_type(page_size_max, AP_HAL::Util::MEM_DMA_SAFE, "Logger");
+    write_buffer = (uint8_t *)hal.util->malloc_type(page_size_max, AP_HAL::Util::MEM_DMA_SAFE, "Logger");
+    if (buffer == nullptr || write_buffer == nullptr) {
         AP_HAL::panic("Out of DMA memory for logging");
     }
+    erased_block = UINT32_MAX;
 }
 
 // init is called after backend init
@@ -72,23 +74,57 @@ void AP_Logger_Block::StartWrite(uint32_t PageAdr)
 {
     df_PageAdr    = PageAdr;
     log_write_started = true;
+    // a page still waiting belongs to the previous log
+    write_page_ready = false;
 }
 
 void AP_Logger_Block::FinishWrite(void)
 {
     // Write Buffer to flash
-    BufferToPage(df_PageAdr);
+    BufferToPage(df_PageAdr, write_buffer);
     df_PageAdr++;
+    invalidate_log_index();
 
     // If we reach the end of the memory, start from the beginning
     if (df_PageAdr > df_NumPages) {
         df_PageAdr = 1;
     }
 
-    // when starting a new sector, erase it
+    // when starting a new sector, erase it unless that has already
+    // been done ahead of time
     if ((df_PageAdr-1) % df_PagePerBlock == 0) {
-        SectorErase(df_PageAdr / df_PagePerBlock);
+        const uint32_t block = get_block(df_PageAdr);
+        if (block != erased_block) {
+            SectorErase(block);
+        }
+        erased_block = UINT32_MAX;
+    }
+}
+
+/*
+  erase the block after the one being written while the chip is idle
+  and the write buffer is nearly empty, so that the erase time is
+  covered by the whole buffer rather than by whatever happens to be
+  free when the write pointer reaches the block. Only done in the last
+  quarter of a block to keep as much of the oldest log as possible
+ */
+void AP_Logger_Block::erase_ahead(void)
+{
+    const uint32_t num_blocks = df_NumPages / df_PagePerBlock;
+    const uint32_t next_block = (get_block(df_PageAdr) + 1) % num_blocks;
+    if (next_block == erased_block) {
+        return;
+    }
+    const uint32_t pages_left = df_PagePerBlock - (df_PageAdr - 1) % df_PagePerBlock;
+    if (pages_left > df_PagePerBlock / 4) {
+        return;
+    }
+    if (write_page_ready || writebuf.available() >= df_PageSize || Busy()) {
+        return;
     }
+    SectorErase(next_block);
+    erased_block = next_block;
+    invalidate_log_index();
 }
 
 bool AP_Logger_Block::WritesOK() const
@@ -114,6 +150,7 @@ bool AP_Logger_Block::_WritePrioritisedBlock(const void *pBuffer, uint16_t size,
 
     if (writebuf.space() < size) {
         // no room in buffer
+        _dropped++;
         return false;
     }
 
@@ -209,6 +246,8 @@ void AP_Logger_Block::EraseAll()
     Sector4kErase(get_sector(df_NumPages));
 
     log_write_started = false;
+    write_page_ready = false;
+    invalidate_log_index();
 
     StartErase();
     erase_started = true;
@@ -273,9 +312,10 @@ void AP_Logger_Block::validate_log_structure()
         StartRead(page);
         file = GetFileNumber();
         next_file++;
-        // skip over the rest of an erased blcok
+        // skip over the rest of an erased block, and any block
+        // erased ahead of it
         if (wrapped && file == 0xFFFF) {
-            StartRead((get_block(page) + 1) * df_PagePerBlock + 1);
+            StartRead(first_page_after_block(page));
             file = GetFileNumber();
         }
         if (wrapped && file < next_file) {
@@ -401,7 +441,7 @@ uint16_t AP_Logger_Block::get_num_logs(void)
         // if we wrapped then the rest of the block will be filled with 0xFFFF because we always erase
         // a block before writing to it, in order to find the first page we therefore have to read after the
         // next block boundary
-        StartRead((get_block(lastpage) + 1) * df_PagePerBlock + 1);
+        StartRead(first_page_after_block(lastpage));
         first = GetFileNumber();
     }
 
@@ -496,8 +536,38 @@ void AP_Logger_Block::get_log_boundaries(uint16_t log_num, uint32_t & start_page
 
 bool AP_Logger_Block::check_wrapped(void)
 {
-    StartRead(df_NumPages);
-    return GetFileNumber() != 0xFFFF;
+    if (log_index.wrapped == -1) {
+        StartRead(df_NumPages);
+        log_index.wrapped = GetFileNumber() != 0xFFFF;
+    }
+    return log_index.wrapped;
+}
+
+/*
+  after wrapping the rest of the block holding the last page is
+  erased, and so may be the block after it, so the oldest data starts
+  at the next block that isn't erased
+ */
+uint32_t AP_Logger_Block::first_page_after_block(uint32_t page)
+{
+    const uint32_t num_blocks = df_NumPages / df_PagePerBlock;
+    uint32_t ret = 1;
+    for (uint8_t i=1; i<=2; i++) {
+        ret = ((get_block(page) + i) % num_blocks) * df_PagePerBlock + 1;
+        StartRead(ret);
+        if (GetFileNumber() != 0xFFFF) {
+            break;
+        }
+    }
+    return ret;
+}
+
+void AP_Logger_Block::invalidate_log_index(void)
+{
+    log_index.last_page = 0;
+    log_index.wrapped = -1;
+    log_index.count = 0;
+    log_index.next = 0;
 }
 
 
@@ -512,6 +582,15 @@ uint16_t AP_Logger_Block::find_last_log(void)
 
 // This function finds the last page of the last file
 uint32_t AP_Logger_Block::find_last_page(void)
+{
+    WITH_SEMAPHORE(sem);
+    if (log_index.last_page == 0) {
+        log_index.last_page = _find_last_page();
+    }
+    return log_index.last_page;
+}
+
+uint32_t AP_Logger_Block::_find_last_page(void)
 {
     uint32_t look;
     uint32_t bottom = 1;
@@ -558,6 +637,25 @@ uint32_t AP_Logger_Block::find_last_page(void)
 
 // This function finds the last page of a particular log file
 uint32_t AP_Logger_Block::find_last_page_of_log(uint16_t log_number)
+{
+    WITH_SEMAPHORE(sem);
+    for (uint8_t i=0; i<log_index.count; i++) {
+        if (log_index.log_num[i] == log_number) {
+            return log_index.end_page[i];
+        }
+    }
+    const uint32_t ret = _find_last_page_of_log(log_number);
+    if (ret != 0) {
+        const uint8_t i = log_index.next;
+        log_index.log_num[i] = log_number;
+        log_index.end_page[i] = ret;
+        log_index.next = (i + 1) % log_index_size;
+        log_index.count = MAX(log_index.count, i + 1);
+    }
+    return ret;
+}
+
+uint32_t AP_Logger_Block::_find_last_page_of_log(uint16_t log_number)
 {
     uint32_t look;
     uint32_t bottom;
@@ -665,8 +763,10 @@ void AP_Logger_Block::io_timer(void)
         // write the logging format in the last page
         StartWrite(df_NumPages+1);
         uint32_t version = DF_LOGGING_FORMAT;
-        memset(buffer, 0, df_PageSize);
-        memcpy(buffer, &version, sizeof(version));
+        memset(write_buffer, 0, df_PageSize);
+        memcpy(write_buffer, &version, sizeof(version));
+        // the whole chip is erased, including the first block
+        erased_block = 0;
         FinishWrite();
         erase_started = false;
         gcs().send_text(MAV_SEVERITY_INFO, "Chip erase complete");
@@ -690,19 +790,36 @@ void AP_Logger_Block::io_timer(void)
         }
         gcs().send_text(MAV_SEVERITY_WARNING, "Log recovery complete, erased %d blocks", unsigned(blocks_erased));
         df_EraseFrom = 0;
+        invalidate_log_index();
     }
 
     if (!CardInserted() || !log_write_started) {
         return;
     }
 
-    while (writebuf.available() >= df_PageSize - sizeof(struct PageHeader)) {
-        struct PageHeader ph;
-        ph.FileNumber = df_FileNumber;
-        ph.FilePage = df_FilePage;
-        memcpy(buffer, &ph, sizeof(ph));
-        writebuf.read(&buffer[sizeof(ph)], df_PageSize - sizeof(ph));
+    while (true) {
+        if (!write_page_ready) {
+            // fill the next page, possibly while the chip is still
+            // busy programming the last one
+            if (writebuf.available() < df_PageSize - sizeof(struct PageHeader)) {
+                break;
+            }
+            struct PageHeader ph;
+            ph.FileNumber = df_FileNumber;
+            ph.FilePage = df_FilePage;
+            memcpy(write_buffer, &ph, sizeof(ph));
+            writebuf.read(&write_buffer[sizeof(ph)], df_PageSize - sizeof(ph));
+            df_FilePage++;
+            write_page_ready = true;
+        }
+        // rather than waiting for the chip, come back on the next
+        // call unless the buffer is getting full
+        if (writebuf.available() < writebuf.get_size() / 2 && Busy()) {
+            break;
+        }
         FinishWrite();
-        df_FilePage++;
+        write_page_ready = false;
     }
+
+    erase_ahead();
 }
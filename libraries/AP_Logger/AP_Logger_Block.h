@@ -27,6 +27,7 @@ public:
     uint16_t get_num_logs() override;
     uint16_t start_new_log(void) override;
     uint32_t bufferspace_available() override;
+    uint8_t backend_type() const override { return uint8_t(AP_Logger::Backend_Type::BLOCK); }
     void stop_logging(void) override { log_write_started = false; }
     bool logging_enabled() const override { return true; }
     bool logging_failed() const override { return false; }
@@ -40,12 +41,14 @@ private:
     /*
       functions implemented by the board specific backends
      */
-    virtual void BufferToPage(uint32_t PageAdr) = 0;
+    virtual void BufferToPage(uint32_t PageAdr, const uint8_t *data) = 0;
     virtual void PageToBuffer(uint32_t PageAdr) = 0;
     virtual void SectorErase(uint32_t SectorAdr) = 0;
     virtual void Sector4kErase(uint32_t SectorAdr) = 0;
     virtual void StartErase() = 0;
     virtual bool InErase() = 0;
+    // true while the chip is programming or erasing
+    virtual bool Busy() = 0;
 
     struct PACKED PageHeader {
         uint32_t FilePage;
@@ -71,6 +74,27 @@ private:
     // are we waiting on an erase to finish?
     bool erase_started;
 
+    // page in write_buffer waiting to be programmed
+    bool write_page_ready;
+    // block erased ahead of the write pointer, or UINT32_MAX
+    uint32_t erased_block;
+
+    /*
+      cache of the results of the binary searches used to find logs,
+      so listing and downloading logs doesn't repeat them for every
+      log. It is cleared whenever the chip is written or erased
+     */
+    static const uint8_t log_index_size = 16;
+    struct {
+        uint32_t last_page;
+        int8_t wrapped = -1;
+        uint8_t count;
+        uint8_t next;
+        uint16_t log_num[log_index_size];
+        uint32_t end_page[log_index_size];
+    } log_index;
+    void invalidate_log_index(void);
+
     // read size bytes of data to a page. The caller must ensure that
     // the data fits within the page, otherwise it will wrap to the
     // start of the page
@@ -85,7 +109,13 @@ private:
     void StartRead(uint32_t PageAdr);
     uint32_t find_last_page(void);
     uint32_t find_last_page_of_log(uint16_t log_number);
+    uint32_t _find_last_page(void);
+    uint32_t _find_last_page_of_log(uint16_t log_number);
     bool check_wrapped(void);
+    // first page holding data after the block holding page
+    uint32_t first_page_after_block(uint32_t page);
+    // erase the next block ahead of the write pointer if it is a good time
+    void erase_ahead(void);
     void StartWrite(uint32_t PageAdr);
     void FinishWrite(void);
 
@@ -123,7 +153,11 @@ protected:
     }
 
     static const uint16_t page_size_max = 256;
+    // page read from the chip
     uint8_t *buffer;
+    // next page to program, kept apart from reads so it can be filled
+    // while the chip is busy with the previous page
+    uint8_t *write_buffer;
 
     bool WritesOK() const override;
 };
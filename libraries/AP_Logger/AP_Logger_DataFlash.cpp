@@ -227,7 +227,7 @@ void AP_Logger_DataFlash::PageToBuffer(uint32_t pageNum)
     dev->set_chip_select(false);
 }
 
-void AP_Logger_DataFlash::BufferToPage(uint32_t pageNum)
+void AP_Logger_DataFlash::BufferToPage(uint32_t pageNum, const uint8_t *data)
 {
     if (pageNum == 0 || pageNum > df_NumPages+1) {
         printf("Invalid page write %u\n", pageNum);
@@ -241,7 +241,7 @@ void AP_Logger_DataFlash::BufferToPage(uint32_t pageNum)
 
     dev->set_chip_select(true);
     send_command_addr(JEDEC_PAGE_WRITE, PageAdr);
-    dev->transfer(buffer, df_PageSize, NULL, 0);
+    dev->transfer(data, df_PageSize, NULL, 0);
     dev->set_chip_select(false);
 }
 
@@ -308,7 +308,7 @@ void AP_Logger_DataFlash::flash_test()
             SectorErase(i / df_PagePerBlock);
         }
         memset(buffer, i, df_PageSize);
-        BufferToPage(i);
+        BufferToPage(i, buffer);
     }
     for (uint8_t i=1; i<=20; i++) {
         printf("Flash check %u\n", i);
@@ -18,7 +18,7 @@ public:
     bool              CardInserted() const override { return !flash_died && df_NumPages > 0; }
 
 private:
-    void              BufferToPage(uint32_t PageAdr) override;
+    void              BufferToPage(uint32_t PageAdr, const uint8_t *data) override;
     void              PageToBuffer(uint32_t PageAdr) override;
     void              SectorErase(uint32_t SectorAdr) override;
     void              Sector4kErase(uint32_t SectorAdr) override;
@@ -26,7 +26,7 @@ private:
     bool              InErase() override;
     void              send_command_addr(uint8_t cmd, uint32_t address);
     void              WaitReady();
-    bool              Busy();
+    bool              Busy() override;
     uint8_t           ReadStatusReg();
     void              Enter4ByteAddressMode(void);
 
@@ -34,6 +34,25 @@ extern const AP_HAL::HAL& hal;
 #define HAL_LOGGER_WRITE_CHUNK_SIZE 4096
 #endif
 
+// contiguous space allocated for each new log file, so that steady
+// logging doesn't need the file's cluster chain to be extended
+#ifndef HAL_LOGGER_PREALLOC_SIZE
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+#define HAL_LOGGER_PREALLOC_SIZE 0
+#else
+#define HAL_LOGGER_PREALLOC_SIZE (32*1024*1024UL)
+#endif
+#endif
+
+// size of the read-ahead buffers used for log download
+#ifndef HAL_LOGGER_READ_AHEAD_SIZE
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_300
+#define HAL_LOGGER_READ_AHEAD_SIZE 8192
+#else
+#define HAL_LOGGER_READ_AHEAD_SIZE 1024
+#endif
+#endif
+
 /*
   constructor
  */
@@ -85,23 +104,143 @@ void AP_Logger_File::Init()
 
     const uint32_t desired_bufsize = bufsize;
 
-    // If we can't allocate the full size, try to reduce it until we can allocate it
-    while (!_writebuf.set_size(bufsize) && bufsize >= _writebuf_chunk) {
-        bufsize *= 0.9;
+    const bool compress = _front._params.file_compress != 0 && _writebuf_chunk <= LOG_COMPRESS_MAX_BLOCK;
+    if ((_front._params.file_blocks != 0 || compress) && init_blocks(bufsize)) {
+        if (compress) {
+            _compress = new LogCompress();
+            _frame = new uint8_t[LOG_COMPRESS_MAX_FRAME(_writebuf_chunk)];
+            if (_compress == nullptr || _frame == nullptr) {
+                hal.console->printf("AP_Logger_File: no memory for compression\n");
+                delete _compress;
+                delete[] _frame;
+                _compress = nullptr;
+                _frame = nullptr;
+            }
+        }
+        hal.console->printf("AP_Logger_File: %u blocks of %u bytes%s\n",
+                            (unsigned)_num_blocks, (unsigned)_writebuf_chunk,
+                            _compress != nullptr ? " compressed" : "");
+    } else {
+        // If we can't allocate the full size, try to reduce it until we can allocate it
+        while (!_writebuf.set_size(bufsize) && bufsize >= _writebuf_chunk) {
+            bufsize *= 0.9;
+        }
+        if (bufsize >= _writebuf_chunk && bufsize != desired_bufsize) {
+            hal.console->printf("AP_Logger: reduced buffer %u/%u\n", (unsigned)bufsize, (unsigned)desired_bufsize);
+        }
+
+        if (!_writebuf.get_size()) {
+            hal.console->printf("Out of memory for logging\n");
+            return;
+        }
+
+        hal.console->printf("AP_Logger_File: buffer size=%u\n", (unsigned)bufsize);
     }
-    if (bufsize >= _writebuf_chunk && bufsize != desired_bufsize) {
-        hal.console->printf("AP_Logger: reduced buffer %u/%u\n", (unsigned)bufsize, (unsigned)desired_bufsize);
+
+    _initialised = true;
+    hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&AP_Logger_File::_io_timer, void));
+}
+
+/*
+  allocate the blocks for the block writer, using as many whole
+  blocks as fit in bufsize. At least two are needed so the front end
+  can fill one while the IO thread writes the other
+ */
+bool AP_Logger_File::init_blocks(uint32_t bufsize)
+{
+    uint32_t nblocks = MIN(bufsize / _writebuf_chunk, (uint32_t)LOGGER_FILE_MAX_BLOCKS);
+    while (nblocks >= 2) {
+        // DMA safe memory lets the SD card driver write straight from the block
+        _blocks = (uint8_t *)hal.util->malloc_type(nblocks * _writebuf_chunk, AP_HAL::Util::MEM_DMA_SAFE, "Logger");
+        if (_blocks != nullptr) {
+            _num_blocks = nblocks;
+            reset_blocks();
+            return true;
+        }
+        nblocks--;
     }
+    hal.console->printf("AP_Logger_File: no memory for blocks\n");
+    return false;
+}
+
+void AP_Logger_File::reset_blocks()
+{
+    _blocks_filled = 0;
+    _blocks_written = 0;
+    _block_fill = 0;
+    _block_limit = _writebuf_chunk;
+    _block_bytes = 0;
+    _block_write_ofs = 0;
+    _frame_len = 0;
+    _block_generation++;
+}
 
-    if (!_writebuf.get_size()) {
-        hal.console->printf("Out of memory for logging\n");
+void AP_Logger_File::write_blocks(const uint8_t *data, uint16_t size)
+{
+    if (_compress != nullptr && _block_fill + size > _block_limit) {
+        // compressed blocks must only hold whole messages
+        publish_block();
+    }
+    while (size > 0) {
+        if (_block_fill == 0) {
+            _block_start_ms = AP_HAL::millis();
+        }
+        const uint16_t n = MIN(size, uint16_t(_block_limit - _block_fill));
+        memcpy(block_ptr(_blocks_filled) + _block_fill, data, n);
+        _block_fill += n;
+        data += n;
+        size -= n;
+        if (_block_fill == _block_limit) {
+            publish_block();
+        }
+    }
+}
+
+void AP_Logger_File::publish_block()
+{
+    if (_block_fill == 0) {
         return;
     }
+    _block_len[_blocks_filled % _num_blocks] = _block_fill;
+    _block_bytes += _block_fill;
+    // the IO thread may start on the block as soon as this is incremented
+    _blocks_filled++;
+    _block_fill = 0;
+    // a partly filled block leaves the file off a sector boundary;
+    // shorten the next block to get back onto one. Compressed frames
+    // are never aligned so don't bother
+    if (_compress == nullptr) {
+        _block_limit = _writebuf_chunk - (_block_bytes % 512);
+    }
+}
 
-    hal.console->printf("AP_Logger_File: buffer size=%u\n", (unsigned)bufsize);
+uint32_t AP_Logger_File::buffer_space() const
+{
+    if (_blocks == nullptr) {
+        return _writebuf.space();
+    }
+    const uint32_t free_blocks = _num_blocks - (_blocks_filled - _blocks_written);
+    if (free_blocks == 0) {
+        return 0;
+    }
+    // the block being filled is one of the free blocks
+    return (_block_limit - _block_fill) + (free_blocks - 1) * _writebuf_chunk;
+}
 
-    _initialised = true;
-    hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&AP_Logger_File::_io_timer, void));
+uint32_t AP_Logger_File::buffer_size() const
+{
+    if (_blocks == nullptr) {
+        return _writebuf.get_size();
+    }
+    return _num_blocks * _writebuf_chunk;
+}
+
+bool AP_Logger_File::buffer_pending() const
+{
+    if (_blocks == nullptr) {
+        return _writebuf.available() != 0;
+    }
+    return _blocks_written != _blocks_filled || _block_fill != 0;
 }
 
 bool AP_Logger_File::file_exists(const char *filename) const
@@ -153,6 +292,14 @@ void AP_Logger_File::periodic_1Hz()
         _write_fd = -1;
         _initialised = false;
     }
+    if (_blocks != nullptr && _block_fill != 0 &&
+        AP_HAL::millis() - _block_start_ms > 2000 &&
+        semaphore.take(1)) {
+        // always write at least once per 2 seconds if data is available
+        publish_block();
+        semaphore.give();
+    }
+
     df_stats_log();
 }
 
@@ -163,7 +310,7 @@ void AP_Logger_File::periodic_fullrate()
 
 uint32_t AP_Logger_File::bufferspace_available()
 {
-    const uint32_t space = _writebuf.space();
+    const uint32_t space = buffer_space();
     const uint32_t crit = critical_message_reserved_space();
 
     return (space > crit) ? space - crit : 0;
@@ -325,6 +472,7 @@ void AP_Logger_File::Prep_MinSpace()
                 }
             } else {
                 free(filename_to_remove);
+                index_invalidate(log_to_remove);
             }
         }
         log_to_remove++;
@@ -419,6 +567,96 @@ char *AP_Logger_File::_lastlog_file_name(void) const
     return buf;
 }
 
+/*
+  return path name of the log index file. Caller must free.
+ */
+char *AP_Logger_File::_index_file_name(void) const
+{
+    char *buf = nullptr;
+    if (asprintf(&buf, "%s/LOGINDEX.DAT", _log_directory) == -1) {
+        return nullptr;
+    }
+    return buf;
+}
+
+/*
+  open the log index file if it isn't already open
+ */
+bool AP_Logger_File::index_open()
+{
+    if (_index_fd != -1) {
+        return true;
+    }
+    if (_index_failed) {
+        // don't keep trying on a card that won't let us
+        return false;
+    }
+    char *fname = _index_file_name();
+    if (fname == nullptr) {
+        return false;
+    }
+    EXPECT_DELAY_MS(3000);
+    _index_fd = AP::FS().open(fname, O_RDWR|O_CREAT);
+    free(fname);
+    if (_index_fd == -1) {
+        _index_failed = true;
+        return false;
+    }
+    return true;
+}
+
+/*
+  read the index entry for a log, returning false if there isn't one
+ */
+bool AP_Logger_File::index_read(uint16_t log_num, struct log_index_entry &entry)
+{
+    if (log_num == 0 || log_num > MAX_LOG_FILES || !index_open()) {
+        return false;
+    }
+    const off_t ofs = (log_num-1) * sizeof(entry);
+    EXPECT_DELAY_MS(3000);
+    if (AP::FS().lseek(_index_fd, ofs, SEEK_SET) != ofs ||
+        AP::FS().read(_index_fd, &entry, sizeof(entry)) != sizeof(entry)) {
+        return false;
+    }
+    return entry.log_num == log_num;
+}
+
+void AP_Logger_File::index_write(const struct log_index_entry &entry)
+{
+    if (entry.log_num == 0 || entry.log_num > MAX_LOG_FILES || !index_open()) {
+        return;
+    }
+    const off_t ofs = (entry.log_num-1) * sizeof(entry);
+    EXPECT_DELAY_MS(3000);
+    if (AP::FS().lseek(_index_fd, ofs, SEEK_SET) != ofs ||
+        AP::FS().write(_index_fd, &entry, sizeof(entry)) != sizeof(entry)) {
+        // a broken index only costs us speed
+        AP::FS().close(_index_fd);
+        _index_fd = -1;
+        _index_failed = true;
+        return;
+    }
+    AP::FS().fsync(_index_fd);
+}
+
+/*
+  forget the index entry for a log that is being removed or reused
+ */
+void AP_Logger_File::index_invalidate(uint16_t log_num)
+{
+    struct log_index_entry entry {};
+    if (!index_read(log_num, entry)) {
+        return;
+    }
+    entry.log_num = 0;
+    const off_t ofs = (log_num-1) * sizeof(entry);
+    if (AP::FS().lseek(_index_fd, ofs, SEEK_SET) == ofs) {
+        AP::FS().write(_index_fd, &entry, sizeof(entry));
+        AP::FS().fsync(_index_fd);
+    }
+}
+
 
 // remove all log files
 void AP_Logger_File::EraseAll()
@@ -433,6 +671,18 @@ void AP_Logger_File::EraseAll()
 
     const bool was_logging = (_write_fd != -1);
     stop_logging();
+    close_read_fd();
+
+    if (_index_fd != -1) {
+        AP::FS().close(_index_fd);
+        _index_fd = -1;
+    }
+    _index_failed = false;
+    char *index_fname = _index_file_name();
+    if (index_fname != nullptr) {
+        AP::FS().unlink(index_fname);
+        free(index_fname);
+    }
 
     for (uint16_t log_num=1; log_num<=MAX_LOG_FILES; log_num++) {
         char *fname = _log_file_name(log_num);
@@ -488,7 +738,7 @@ bool AP_Logger_File::_WritePrioritisedBlock(const void *pBuffer, uint16_t size,
         return false;
     }
         
-    uint32_t space = _writebuf.space();
+    uint32_t space = buffer_space();
 
     if (_writing_startup_messages &&
         _startup_messagewriter->fmt_done()) {
@@ -522,7 +772,11 @@ bool AP_Logger_File::_WritePrioritisedBlock(const void *pBuffer, uint16_t size,
         return false;
     }
 
-    _writebuf.write((uint8_t*)pBuffer, size);
+    if (_blocks != nullptr) {
+        write_blocks((const uint8_t *)pBuffer, size);
+    } else {
+        _writebuf.write((uint8_t*)pBuffer, size);
+    }
     df_stats_gather(size);
     semaphore.give();
     return true;
@@ -642,8 +896,10 @@ void AP_Logger_File::get_log_boundaries(const uint16_t list_entry, uint32_t & st
         return;
     }
 
+    uint32_t size, time_utc;
+    get_log_size_and_time(log_num, size, time_utc);
     start_page = 0;
-    end_page = _get_log_size(log_num) / LOGGER_PAGE_SIZE;
+    end_page = size / LOGGER_PAGE_SIZE;
 }
 
 /*
@@ -662,8 +918,7 @@ int16_t AP_Logger_File::get_log_data(const uint16_t list_entry, const uint16_t p
     }
 
     if (_read_fd != -1 && log_num != _read_fd_log_num) {
-        AP::FS().close(_read_fd);
-        _read_fd = -1;
+        close_read_fd();
     }
     if (_read_fd == -1) {
         char *fname = _log_file_name(log_num);
@@ -683,12 +938,31 @@ int16_t AP_Logger_File::get_log_data(const uint16_t list_entry, const uint16_t p
             free(fname);
             return -1;            
         }
-        free(fname);
         _read_offset = 0;
         _read_fd_log_num = log_num;
+        // the IO thread reads the log ahead of the download. Without
+        // read-ahead we read straight from the file
+        _read_ahead = AP::FS_Async().open_readahead(fname, HAL_LOGGER_READ_AHEAD_SIZE/2);
+        free(fname);
     }
     uint32_t ofs = page * (uint32_t)LOGGER_PAGE_SIZE + offset;
 
+    if (_read_ahead == nullptr || len > HAL_LOGGER_READ_AHEAD_SIZE/2) {
+        return read_log_data(ofs, len, data);
+    }
+
+    const int32_t ret = AP::FS_Async().read_ahead(_read_ahead, ofs, data, len);
+    if (ret == AP_FILESYSTEM_ASYNC_PENDING) {
+        return LOGGER_DATA_PENDING;
+    }
+    return ret;
+}
+
+/*
+  read from the open log file at offset ofs
+ */
+int16_t AP_Logger_File::read_log_data(uint32_t ofs, uint16_t len, uint8_t *data)
+{
     /*
       this rather strange bit of code is here to work around a bug
       in file offsets in NuttX. Every few hundred blocks of reads
@@ -701,14 +975,12 @@ int16_t AP_Logger_File::get_log_data(const uint16_t list_entry, const uint16_t p
     if (ofs / 4096 != (ofs+len) / 4096) {
         off_t seek_current = AP::FS().lseek(_read_fd, 0, SEEK_CUR);
         if (seek_current == (off_t)-1) {
-            AP::FS().close(_read_fd);
-            _read_fd = -1;
+            close_read_fd();
             return -1;
         }
         if (seek_current != (off_t)_read_offset) {
             if (AP::FS().lseek(_read_fd, _read_offset, SEEK_SET) == (off_t)-1) {
-                AP::FS().close(_read_fd);
-                _read_fd = -1;
+                close_read_fd();
                 return -1;
             }
         }
@@ -716,8 +988,7 @@ int16_t AP_Logger_File::get_log_data(const uint16_t list_entry, const uint16_t p
 
     if (ofs != _read_offset) {
         if (AP::FS().lseek(_read_fd, ofs, SEEK_SET) == (off_t)-1) {
-            AP::FS().close(_read_fd);
-            _read_fd = -1;
+            close_read_fd();
             return -1;
         }
         _read_offset = ofs;
@@ -729,6 +1000,16 @@ int16_t AP_Logger_File::get_log_data(const uint16_t list_entry, const uint16_t p
     return ret;
 }
 
+void AP_Logger_File::close_read_fd()
+{
+    if (_read_fd != -1) {
+        AP::FS().close(_read_fd);
+        _read_fd = -1;
+    }
+    AP::FS_Async().close_readahead(_read_ahead);
+    _read_ahead = nullptr;
+}
+
 /*
   find size and date of a log
  */
@@ -742,8 +1023,35 @@ void AP_Logger_File::get_log_info(const uint16_t list_entry, uint32_t &size, uin
         return;
     }
 
+    get_log_size_and_time(log_num, size, time_utc);
+}
+
+/*
+  find size and date of a log from the index, falling back to the
+  file itself and adding that to the index
+ */
+void AP_Logger_File::get_log_size_and_time(const uint16_t log_num, uint32_t &size, uint32_t &time_utc)
+{
+    if (log_is_open(log_num)) {
+        size = _get_log_size(log_num);
+        time_utc = _get_log_time(log_num);
+        return;
+    }
+    struct log_index_entry entry;
+    if (index_read(log_num, entry)) {
+        size = entry.size;
+        time_utc = entry.time_utc;
+        return;
+    }
     size = _get_log_size(log_num);
     time_utc = _get_log_time(log_num);
+    if (size != 0 && !hal.util->get_soft_armed()) {
+        entry = {};
+        entry.log_num = log_num;
+        entry.size = size;
+        entry.time_utc = time_utc;
+        index_write(entry);
+    }
 }
 
 
@@ -756,15 +1064,16 @@ uint16_t AP_Logger_File::get_num_logs()
     uint16_t ret = 0;
     uint16_t high = find_last_log();
     uint16_t i;
+    struct log_index_entry entry;
     for (i=high; i>0; i--) {
-        if (! log_exists(i)) {
+        if (!index_read(i, entry) && !log_exists(i)) {
             break;
         }
         ret++;
     }
     if (i == 0) {
         for (i=MAX_LOG_FILES; i>high; i--) {
-            if (! log_exists(i)) {
+            if (!index_read(i, entry) && !log_exists(i)) {
                 break;
             }
             ret++;
@@ -783,13 +1092,37 @@ void AP_Logger_File::stop_logging(void)
     if (_write_fd != -1) {
         int fd = _write_fd;
         _write_fd = -1;
-        AP::FS().close(fd);
+        close_write_fd(fd);
+
+        struct log_index_entry entry {};
+        entry.log_num = _write_log_num;
+        entry.size = _write_offset;
+        uint64_t utc_usec;
+        if (AP::rtc().get_utc_usec(utc_usec)) {
+            entry.time_utc = utc_usec / 1000000U;
+        }
+        entry.duration_s = (AP_HAL::millis() - _write_open_ms) / 1000U;
+        if (entry.size != 0) {
+            index_write(entry);
+        }
     }
     if (have_sem) {
         write_fd_semaphore.give();
     }
 }
 
+/*
+  close a log file, giving back any preallocated space after the data
+ */
+void AP_Logger_File::close_write_fd(int fd)
+{
+    if (_write_preallocated) {
+        AP::FS().ftruncate(fd, _write_offset);
+        _write_preallocated = false;
+    }
+    AP::FS().close(fd);
+}
+
 void AP_Logger_File::PrepForArming()
 {
     if (logging_started()) {
@@ -813,10 +1146,7 @@ uint16_t AP_Logger_File::start_new_log(void)
         return 0xFFFF;
     }
 
-    if (_read_fd != -1) {
-        AP::FS().close(_read_fd);
-        _read_fd = -1;
-    }
+    close_read_fd();
 
     if (disk_space_avail() < _free_space_min_avail && disk_space() > 0) {
         hal.console->printf("Out of space for logging\n");
@@ -853,6 +1183,9 @@ uint16_t AP_Logger_File::start_new_log(void)
     _need_rtc_update = !AP::rtc().get_utc_usec(utc_usec);
 #endif
 
+    // the file is about to be replaced
+    index_invalidate(log_num);
+
     EXPECT_DELAY_MS(3000);
     _write_fd = AP::FS().open(_write_filename, O_WRONLY|O_CREAT|O_TRUNC);
     _cached_oldest_log = 0;
@@ -869,8 +1202,29 @@ uint16_t AP_Logger_File::start_new_log(void)
         return 0xFFFF;
     }
     _last_write_ms = AP_HAL::millis();
+    _write_open_ms = _last_write_ms;
+    _write_log_num = log_num;
     _write_offset = 0;
+    _write_preallocated = false;
+    if (HAL_LOGGER_PREALLOC_SIZE > 0 &&
+        disk_space_avail() > int64_t(HAL_LOGGER_PREALLOC_SIZE + _free_space_min_avail)) {
+        _write_preallocated = AP::FS().fpreallocate(_write_fd, HAL_LOGGER_PREALLOC_SIZE);
+    }
+    _write_cluster_size = AP::FS().cluster_size(_write_fd);
     _writebuf.clear();
+    if (_blocks != nullptr) {
+        // the IO thread can't be writing as we hold write_fd_semaphore
+        WITH_SEMAPHORE(semaphore);
+        reset_blocks();
+    }
+    if (_compress != nullptr) {
+        _compress->reset();
+        uint8_t hdr[LOG_COMPRESS_FILE_HEADER_LEN];
+        LogCompress::file_header(hdr);
+        if (AP::FS().write(_write_fd, hdr, sizeof(hdr)) == sizeof(hdr)) {
+            _write_offset = sizeof(hdr);
+        }
+    }
     write_fd_semaphore.give();
 
     // now update lastlog.txt with the new log number
@@ -906,7 +1260,11 @@ void AP_Logger_File::flush(void)
 #if APM_BUILD_TYPE(APM_BUILD_Replay) || APM_BUILD_TYPE(APM_BUILD_UNKNOWN)
 {
     uint32_t tnow = AP_HAL::millis();
-    while (_write_fd != -1 && _initialised && !_open_error && _writebuf.available()) {
+    if (_blocks != nullptr) {
+        WITH_SEMAPHORE(semaphore);
+        publish_block();
+    }
+    while (_write_fd != -1 && _initialised && !_open_error && buffer_pending()) {
         // convince the IO timer that it really is OK to write out
         // less than _writebuf_chunk bytes:
         if (tnow > 2001) { // avoid resetting _last_write_time to 0
@@ -938,11 +1296,32 @@ void AP_Logger_File::_io_timer(void)
         return;
     }
 
-    uint32_t nbytes = _writebuf.available();
+    uint32_t nbytes;
+    const uint32_t generation = _block_generation;
+    if (_blocks != nullptr) {
+        // only whole blocks are handed over, so there is no need to
+        // wait for more data
+        if (_blocks_written == _blocks_filled) {
+            return;
+        }
+        if (_compress != nullptr) {
+            if (_frame_len == 0) {
+                _frame_len = _compress->compress(block_ptr(_blocks_written),
+                                                 _block_len[_blocks_written % _num_blocks],
+                                                 _frame);
+            }
+            nbytes = _frame_len - _block_write_ofs;
+        } else {
+            nbytes = _block_len[_blocks_written % _num_blocks] - _block_write_ofs;
+        }
+    } else {
+        nbytes = _writebuf.available();
+    }
     if (nbytes == 0) {
         return;
     }
-    if (nbytes < _writebuf_chunk && 
+    if (_blocks == nullptr &&
+        nbytes < _writebuf_chunk &&
         tnow - _last_write_time < 2000UL) {
         // write in _writebuf_chunk-sized chunks, but always write at
         // least once per 2 seconds if data is available
@@ -964,27 +1343,51 @@ void AP_Logger_File::_io_timer(void)
     hal.util->perf_begin(_perf_write);
 
     _last_write_time = tnow;
-    if (nbytes > _writebuf_chunk) {
-        // be kind to the filesystem layer
-        nbytes = _writebuf_chunk;
-    }
 
-    uint32_t size;
-    const uint8_t *head = _writebuf.readptr(size);
-    nbytes = MIN(nbytes, size);
+    const uint8_t *head;
+    if (_blocks != nullptr) {
+        // blocks are already sized to end on a sector boundary
+        if (_compress != nullptr) {
+            head = _frame + _block_write_ofs;
+        } else {
+            head = block_ptr(_blocks_written) + _block_write_ofs;
+        }
+    } else {
+        if (nbytes > _writebuf_chunk) {
+            // be kind to the filesystem layer
+            nbytes = _writebuf_chunk;
+        }
+
+        uint32_t size;
+        head = _writebuf.readptr(size);
+        nbytes = MIN(nbytes, size);
 
-    // try to align writes on a 512 byte boundary to avoid filesystem reads
-    if ((nbytes + _write_offset) % 512 != 0) {
-        uint32_t ofs = (nbytes + _write_offset) % 512;
-        if (ofs < nbytes) {
-            nbytes -= ofs;
+        // try to align writes on a 512 byte boundary to avoid filesystem reads
+        if ((nbytes + _write_offset) % 512 != 0) {
+            uint32_t ofs = (nbytes + _write_offset) % 512;
+            if (ofs < nbytes) {
+                nbytes -= ofs;
+            }
         }
     }
 
+    if (_write_cluster_size > 0) {
+        // end writes at cluster boundaries so that, once aligned,
+        // each write fills part of a single cluster
+        nbytes = MIN(nbytes, _write_cluster_size - (_write_offset % _write_cluster_size));
+    }
+
     last_io_operation = "write";
     if (!write_fd_semaphore.take(1)) {
         return;
     }
+    if (generation != _block_generation) {
+        // a new log was started while we weren't holding the
+        // semaphore, so the frame is from the old log
+        _frame_len = 0;
+        write_fd_semaphore.give();
+        return;
+    }
     if (_write_fd == -1) {
         write_fd_semaphore.give();
         return;
@@ -998,7 +1401,7 @@ void AP_Logger_File::_io_timer(void)
             // failures caused by directory listing
             hal.util->perf_count(_perf_errors);
             last_io_operation = "close";
-            AP::FS().close(_write_fd);
+            close_write_fd(_write_fd);
             last_io_operation = "";
             _write_fd = -1;
             _initialised = false;
@@ -1009,7 +1412,18 @@ void AP_Logger_File::_io_timer(void)
         _last_write_failed = false;
         _last_write_ms = tnow;
         _write_offset += nwritten;
-        _writebuf.advance(nwritten);
+        if (_blocks != nullptr) {
+            _block_write_ofs += nwritten;
+            const uint16_t len = _compress != nullptr ? _frame_len : _block_len[_blocks_written % _num_blocks];
+            if (_block_write_ofs >= len) {
+                // hand the block back to the front end
+                _block_write_ofs = 0;
+                _frame_len = 0;
+                _blocks_written++;
+            }
+        } else {
+            _writebuf.advance(nwritten);
+        }
         /*
           the best strategy for minimizing corruption on microSD cards
           seems to be to write in 4k chunks and fsync the file on each
@@ -1104,7 +1518,7 @@ void AP_Logger_File::Write_AP_Logger_Stats_File(const struct df_stats &_stats)
 }
 
 void AP_Logger_File::df_stats_gather(const uint16_t bytes_written) {
-    const uint32_t space_remaining = _writebuf.space();
+    const uint32_t space_remaining = buffer_space();
     if (space_remaining < stats.buf_space_min) {
         stats.buf_space_min = space_remaining;
     }
@@ -12,6 +12,11 @@
 
 #include <AP_HAL/utility/RingBuffer.h>
 #include "AP_Logger_Backend.h"
+#include "LogCompress.h"
+#include <atomic>
+
+// maximum number of blocks used by the block writer
+#define LOGGER_FILE_MAX_BLOCKS 16
 
 class AP_Logger_File : public AP_Logger_Backend
 {
@@ -35,6 +40,7 @@ public:
     /* Write a block of data at current offset */
     bool _WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical) override;
     uint32_t bufferspace_available() override;
+    uint8_t backend_type() const override { return uint8_t(AP_Logger::Backend_Type::FILESYSTEM); }
 
     // high level interface
     uint16_t find_last_log() override;
@@ -76,7 +82,19 @@ private:
     int _read_fd;
     uint16_t _read_fd_log_num;
     uint32_t _read_offset;
+    // log download is read ahead by the IO thread
+    AP_Filesystem_Async::ReadAhead *_read_ahead;
+    void close_read_fd();
+    void close_write_fd(int fd);
+    int16_t read_log_data(uint32_t ofs, uint16_t len, uint8_t *data);
+
+    uint16_t _write_log_num;
+    uint32_t _write_open_ms;
     uint32_t _write_offset;
+    // filesystem cluster size, writes don't cross cluster boundaries
+    uint32_t _write_cluster_size;
+    // the log file has preallocated space to truncate when it is closed
+    bool _write_preallocated;
     volatile bool _open_error;
     const char *_log_directory;
     bool _last_write_failed;
@@ -87,6 +105,32 @@ private:
 
     uint16_t _cached_oldest_log;
 
+    /*
+      index of the logs on the card, updated when each log is closed
+      so that listing logs doesn't need a stat() of every file. The
+      entry for a log is at offset (log_num-1) in the file, and is
+      unused if its log_num doesn't match
+     */
+    struct PACKED log_index_entry {
+        uint16_t log_num;
+        uint16_t reserved;
+        uint32_t size;
+        uint32_t time_utc;
+        // how long the log was open for
+        uint32_t duration_s;
+    };
+    int _index_fd = -1;
+    bool _index_failed;
+    char *_index_file_name() const;
+    bool index_open();
+    bool index_read(uint16_t log_num, struct log_index_entry &entry);
+    void index_write(const struct log_index_entry &entry);
+    void index_invalidate(uint16_t log_num);
+    bool log_is_open(uint16_t log_num) const {
+        return _write_fd != -1 && _write_log_num == log_num;
+    }
+    void get_log_size_and_time(uint16_t log_num, uint32_t &size, uint32_t &time_utc);
+
     // should we rotate when we next stop logging
     bool _rotate_pending;
 
@@ -113,6 +157,55 @@ private:
     const uint16_t _writebuf_chunk;
     uint32_t _last_write_time;
 
+    /*
+      block writer, used instead of _writebuf when LOG_FILE_BLOCKS is
+      set. The buffer is split into _writebuf_chunk sized blocks. The
+      front end fills one block at a time under semaphore and hands
+      it to the IO thread by incrementing _blocks_filled. The IO
+      thread writes each block out whole and then increments
+      _blocks_written, so the two sides never share a lock.
+     */
+    uint8_t *_blocks;
+    uint8_t _num_blocks;
+    // length of each block handed to the IO thread
+    uint16_t _block_len[LOGGER_FILE_MAX_BLOCKS];
+    std::atomic<uint32_t> _blocks_filled{0};
+    std::atomic<uint32_t> _blocks_written{0};
+    // front end state for the block being filled. Its size is
+    // limited so blocks always end on a sector boundary in the file
+    uint16_t _block_fill;
+    uint16_t _block_limit;
+    uint32_t _block_start_ms;
+    uint32_t _block_bytes;
+    // IO thread progress through the block being written
+    uint16_t _block_write_ofs;
+    // incremented when the blocks are reset for a new log, so the IO
+    // thread can tell that the block it picked up has gone
+    uint32_t _block_generation;
+
+    // compression of blocks, done by the IO thread just before
+    // writing. Blocks then only hold whole messages and the IO thread
+    // writes _frame instead of the block
+    LogCompress *_compress;
+    uint8_t *_frame;
+    uint16_t _frame_len;
+
+    bool init_blocks(uint32_t bufsize);
+    void reset_blocks();
+    uint8_t *block_ptr(uint32_t count) const {
+        return &_blocks[(count % _num_blocks) * _writebuf_chunk];
+    }
+    // copy data into the blocks. semaphore must be held
+    void write_blocks(const uint8_t *data, uint16_t size);
+    // hand the block being filled to the IO thread. semaphore must be held
+    void publish_block();
+
+    // free space and total size of whichever buffer is in use
+    uint32_t buffer_space() const;
+    uint32_t buffer_size() const;
+    // true if there is data waiting for the IO thread
+    bool buffer_pending() const;
+
     /* construct a file name given a log number. Caller must free. */
     char *_log_file_name(const uint16_t log_num) const;
     char *_log_file_name_long(const uint16_t log_num) const;
@@ -128,16 +221,16 @@ private:
     uint32_t critical_message_reserved_space() const {
         // possibly make this a proportional to buffer size?
         uint32_t ret = 1024;
-        if (ret > _writebuf.get_size()) {
+        if (ret > buffer_size()) {
             // in this case you will only get critical messages
-            ret = _writebuf.get_size();
+            ret = buffer_size();
         }
         return ret;
     };
     uint32_t non_messagewriter_message_reserved_space() const {
         // possibly make this a proportional to buffer size?
         uint32_t ret = 1024;
-        if (ret >= _writebuf.get_size()) {
+        if (ret >= buffer_size()) {
             // need to allow messages out from the messagewriters.  In
             // this case while you have a messagewriter you won't get
             // any other messages.  This should be a corner case!
@@ -22,6 +22,11 @@
 
 extern const AP_HAL::HAL& hal;
 
+// limits on the time before an unacked block is sent again
+#define DM_RESEND_TIMEOUT_MIN_MS 100
+#define DM_RESEND_TIMEOUT_MAX_MS 3000
+// the smallest the window is cut to on loss
+#define DM_WINDOW_MIN 4
 
 // initialisation
 void AP_Logger_MAVLink::Init()
@@ -69,6 +74,7 @@ void AP_Logger_MAVLink::enqueue_block(dm_block_queue_t &queue, struct dm_block *
         queue.oldest = block;
     }
     queue.youngest = block;
+    queue.count++;
 }
 
 struct AP_Logger_MAVLink::dm_block *AP_Logger_MAVLink::dequeue_seqno(AP_Logger_MAVLink::dm_block_queue_t &queue, uint32_t seqno)
@@ -90,6 +96,7 @@ struct AP_Logger_MAVLink::dm_block *AP_Logger_MAVLink::dequeue_seqno(AP_Logger_M
                 prev->next = block->next;
             }
             block->next = nullptr;
+            queue.count--;
             return block;
         }
         prev = block;
@@ -97,16 +104,11 @@ struct AP_Logger_MAVLink::dm_block *AP_Logger_MAVLink::dequeue_seqno(AP_Logger_M
     return nullptr;
 }
 
-bool AP_Logger_MAVLink::free_seqno_from_queue(uint32_t seqno, dm_block_queue_t &queue)
+void AP_Logger_MAVLink::free_block(struct dm_block *block)
 {
-    struct dm_block *block = dequeue_seqno(queue, seqno);
-    if (block != nullptr) {
-        block->next = _blocks_free;
-        _blocks_free = block;
-        _blockcount_free++; // comment me out to expose a bug!
-        return true;
-    }
-    return false;
+    block->next = _blocks_free;
+    _blocks_free = block;
+    _blockcount_free++; // comment me out to expose a bug!
 }
     
 
@@ -181,6 +183,7 @@ struct AP_Logger_MAVLink::dm_block *AP_Logger_MAVLink::next_block()
         _blockcount_free--;
         ret->seqno = _next_seq_num++;
         ret->last_sent = 0;
+        ret->resent = false;
         ret->next = nullptr;
         _latest_block_len = 0;
     }
@@ -193,14 +196,17 @@ void AP_Logger_MAVLink::free_all_blocks()
     _current_block = nullptr;
 
     _blocks_pending.sent_count = 0;
+    _blocks_pending.count = 0;
     _blocks_pending.oldest = _blocks_pending.youngest = nullptr;
     _blocks_retry.sent_count = 0;
+    _blocks_retry.count = 0;
     _blocks_retry.oldest = _blocks_retry.youngest = nullptr;
     _blocks_sent.sent_count = 0;
+    _blocks_sent.count = 0;
     _blocks_sent.oldest = _blocks_sent.youngest = nullptr;
 
     // add blocks to the free stack:
-    for(uint8_t i=0; i < _blockcount; i++) {
+    for(uint16_t i=0; i < _blockcount; i++) {
         _blocks[i].next = _blocks_free;
         _blocks_free = &_blocks[i];
         // this value doesn't really matter, but it stops valgrind
@@ -212,6 +218,63 @@ void AP_Logger_MAVLink::free_all_blocks()
     _blockcount_free = _blockcount;
 
     _latest_block_len = 0;
+
+    window_reset();
+}
+
+void AP_Logger_MAVLink::window_reset()
+{
+    _window = MIN(_max_blocks_per_send_blocks, _blockcount);
+    _window_threshold = _blockcount;
+    _window_cut_ms = 0;
+    _srtt_ms = 0;
+    _rttvar_ms = 0;
+    _resend_timeout_ms = 4 * DM_RESEND_TIMEOUT_MIN_MS;
+}
+
+/*
+  a block has been acked; open the window and update the resend
+  timeout the same way TCP does
+ */
+void AP_Logger_MAVLink::window_ack(const struct dm_block &block, uint32_t now)
+{
+    if (_window < _window_threshold) {
+        // slow start
+        _window += 1;
+    } else {
+        _window += 1 / _window;
+    }
+    _window = MIN(_window, _blockcount);
+
+    if (block.resent) {
+        // can't tell which send this is the ack for
+        return;
+    }
+    const float rtt_ms = now - block.last_sent;
+    if (is_zero(_srtt_ms)) {
+        _srtt_ms = rtt_ms;
+        _rttvar_ms = rtt_ms * 0.5f;
+    } else {
+        _rttvar_ms = 0.75f * _rttvar_ms + 0.25f * fabsf(_srtt_ms - rtt_ms);
+        _srtt_ms = 0.875f * _srtt_ms + 0.125f * rtt_ms;
+    }
+    _resend_timeout_ms = constrain_float(_srtt_ms + 4 * _rttvar_ms,
+                                         DM_RESEND_TIMEOUT_MIN_MS,
+                                         DM_RESEND_TIMEOUT_MAX_MS);
+}
+
+/*
+  a block was lost; halve the window, but only once per round trip
+  as the rest of the blocks sent with it are likely lost too
+ */
+void AP_Logger_MAVLink::window_loss(uint32_t now)
+{
+    if (now - _window_cut_ms < MAX(_srtt_ms, DM_RESEND_TIMEOUT_MIN_MS)) {
+        return;
+    }
+    _window_cut_ms = now;
+    _window_threshold = MAX(_window * 0.5f, DM_WINDOW_MIN);
+    _window = MIN(_window_threshold, _blockcount);
 }
 
 void AP_Logger_MAVLink::stop_logging()
@@ -257,15 +320,17 @@ void AP_Logger_MAVLink::handle_ack(const mavlink_channel_t chan,
     }
 
     // check SENT blocks (VERY likely to be first on the list):
-    if (free_seqno_from_queue(seqno, _blocks_sent)) {
-        // celebrate
-        _last_response_time = AP_HAL::millis();
-    } else if(free_seqno_from_queue(seqno, _blocks_retry)) {
-        // party
-        _last_response_time = AP_HAL::millis();
-    } else {
+    struct dm_block *block = dequeue_seqno(_blocks_sent, seqno);
+    if (block == nullptr) {
+        block = dequeue_seqno(_blocks_retry, seqno);
+    }
+    if (block == nullptr) {
         // probably acked already and put on the free list.
+        return;
     }
+    _last_response_time = AP_HAL::millis();
+    window_ack(*block, _last_response_time);
+    free_block(block);
 }
 
 void AP_Logger_MAVLink::remote_log_block_status_msg(const mavlink_channel_t chan,
@@ -293,7 +358,10 @@ void AP_Logger_MAVLink::handle_retry(uint32_t seqno)
     struct dm_block *victim = dequeue_seqno(_blocks_sent, seqno);
     if (victim != nullptr) {
         _last_response_time = AP_HAL::millis();
+        // an ack may now be for either send
+        victim->resent = true;
         enqueue_block(_blocks_retry, victim);
+        window_loss(_last_response_time);
     }
 }
 
@@ -330,15 +398,17 @@ void AP_Logger_MAVLink::Write_logger_MAV(AP_Logger_MAVLink &logger_mav)
         dropped           : logger_mav._dropped,
         retries           : logger_mav._blocks_retry.sent_count,
         resends           : logger_mav.stats.resends,
-        state_free_avg    : (uint8_t)(logger_mav.stats.state_free/logger_mav.stats.collection_count),
+        state_free_avg    : (uint16_t)(logger_mav.stats.state_free/logger_mav.stats.collection_count),
         state_free_min    : logger_mav.stats.state_free_min,
         state_free_max    : logger_mav.stats.state_free_max,
-        state_pending_avg : (uint8_t)(logger_mav.stats.state_pending/logger_mav.stats.collection_count),
+        state_pending_avg : (uint16_t)(logger_mav.stats.state_pending/logger_mav.stats.collection_count),
         state_pending_min : logger_mav.stats.state_pending_min,
         state_pending_max : logger_mav.stats.state_pending_max,
-        state_sent_avg    : (uint8_t)(logger_mav.stats.state_sent/logger_mav.stats.collection_count),
+        state_sent_avg    : (uint16_t)(logger_mav.stats.state_sent/logger_mav.stats.collection_count),
         state_sent_min    : logger_mav.stats.state_sent_min,
         state_sent_max    : logger_mav.stats.state_sent_max,
+        window            : (uint16_t)logger_mav._window,
+        rtt               : (uint16_t)logger_mav._srtt_ms,
     };
     WriteBlock(&pkt,sizeof(pkt));
 }
@@ -374,15 +444,15 @@ void AP_Logger_MAVLink::stats_log()
     stats_reset();
 }
 
-uint8_t AP_Logger_MAVLink::stack_size(struct dm_block *stack)
+uint16_t AP_Logger_MAVLink::stack_size(struct dm_block *stack)
 {
-    uint8_t ret = 0;
+    uint16_t ret = 0;
     for (struct dm_block *block=stack; block != nullptr; block=block->next) {
         ret++;
     }
     return ret;
 }
-uint8_t AP_Logger_MAVLink::queue_size(dm_block_queue_t queue)
+uint16_t AP_Logger_MAVLink::queue_size(dm_block_queue_t queue)
 {
     return stack_size(queue.oldest);
 }
@@ -395,10 +465,10 @@ void AP_Logger_MAVLink::stats_collect()
     if (!semaphore.take_nonblocking()) {
         return;
     }
-    uint8_t pending = queue_size(_blocks_pending);
-    uint8_t sent = queue_size(_blocks_sent);
-    uint8_t retry = queue_size(_blocks_retry);
-    uint8_t sfree = stack_size(_blocks_free);
+    uint16_t pending = queue_size(_blocks_pending);
+    uint16_t sent = queue_size(_blocks_sent);
+    uint16_t retry = queue_size(_blocks_retry);
+    uint16_t sfree = stack_size(_blocks_free);
 
     if (sfree != _blockcount_free) {
         AP::internalerror().error(AP_InternalError::error_t::logger_blockcount_mismatch);
@@ -440,14 +510,18 @@ void AP_Logger_MAVLink::stats_collect()
 
 /* while we "successfully" send log blocks from a queue, move them to
  * the sent list. DO NOT call this for blocks already sent!
+ * If in_window is true, only send while the window has space.
 */
-bool AP_Logger_MAVLink::send_log_blocks_from_queue(dm_block_queue_t &queue)
+bool AP_Logger_MAVLink::send_log_blocks_from_queue(dm_block_queue_t &queue, bool in_window)
 {
     uint8_t sent_count = 0;
     while (queue.oldest != nullptr) {
         if (sent_count++ > _max_blocks_per_send_blocks) {
             return false;
         }
+        if (in_window && _blocks_sent.count >= uint16_t(_window)) {
+            return false;
+        }
         if (! send_log_block(*queue.oldest)) {
             return false;
         }
@@ -474,12 +548,14 @@ void AP_Logger_MAVLink::push_log_blocks()
         return;
     }
 
-    if (! send_log_blocks_from_queue(_blocks_retry)) {
+    // blocks the client asked for again are already counted against
+    // the window
+    if (! send_log_blocks_from_queue(_blocks_retry, false)) {
         semaphore.give();
         return;
     }
 
-    if (! send_log_blocks_from_queue(_blocks_pending)) {
+    if (! send_log_blocks_from_queue(_blocks_pending, true)) {
         semaphore.give();
         return;
     }
@@ -492,28 +568,28 @@ void AP_Logger_MAVLink::do_resends(uint32_t now)
         return;
     }
 
-    uint8_t count_to_send = 5;
-    if (_blockcount < count_to_send) {
-        count_to_send = _blockcount;
+    if (!semaphore.take_nonblocking()) {
+        return;
     }
-    uint32_t oldest = now - 100; // 100 milliseconds before resend.  Hmm.
-    while (count_to_send-- > 0) {
-        if (!semaphore.take_nonblocking()) {
-            return;
+    bool timed_out = false;
+    for (struct dm_block *block=_blocks_sent.oldest; block != nullptr; block=block->next) {
+        // only resend blocks that should have been acked by now:
+        if (now - block->last_sent < _resend_timeout_ms) {
+            continue;
         }
-        for (struct dm_block *block=_blocks_sent.oldest; block != nullptr; block=block->next) {
-            // only want to send blocks every now-and-then:
-            if (block->last_sent < oldest) {
-                if (! send_log_block(*block)) {
-                    // failed to send the block; try again later....
-                    semaphore.give();
-                    return;
-                }
-                stats.resends++;
-            }
+        if (! send_log_block(*block)) {
+            // failed to send the block; try again later....
+            break;
         }
-        semaphore.give();
+        stats.resends++;
+        timed_out = true;
+    }
+    if (timed_out) {
+        window_loss(now);
+        // back off until an ack gives us a new round trip time
+        _resend_timeout_ms = MIN(_resend_timeout_ms * 2, DM_RESEND_TIMEOUT_MAX_MS);
     }
+    semaphore.give();
 }
 
 // NOTE: any functions called from these periodic functions MUST
@@ -586,6 +662,9 @@ bool AP_Logger_MAVLink::send_log_block(struct dm_block &block)
     hal.scheduler->restore_interrupts(istate);
 #endif
 
+    if (block.last_sent != 0) {
+        block.resent = true;
+    }
     block.last_sent = AP_HAL::millis();
     chan_status->current_tx_seq = saved_seq;
 
@@ -73,6 +73,9 @@ private:
         uint32_t seqno;
         uint8_t buf[MAVLINK_MSG_REMOTE_LOG_DATA_BLOCK_FIELD_DATA_LEN];
         uint32_t last_sent;
+        // true once the block has been sent more than once, so its
+        // ack can't be used to measure the round trip time
+        bool resent;
         struct dm_block *next;
     };
     bool send_log_block(struct dm_block &block);
@@ -80,10 +83,12 @@ private:
     void handle_retry(uint32_t block_num);
     void do_resends(uint32_t now);
     void free_all_blocks();
+    void free_block(struct dm_block *block);
 
     // a stack for free blocks, queues for pending, sent, retries and sent
     struct dm_block_queue {
         uint32_t sent_count;
+        uint16_t count;
         struct dm_block *oldest;
         struct dm_block *youngest;
     };
@@ -91,10 +96,9 @@ private:
     void enqueue_block(dm_block_queue_t &queue, struct dm_block *block);
     bool queue_has_block(dm_block_queue_t &queue, struct dm_block *block);
     struct dm_block *dequeue_seqno(dm_block_queue_t &queue, uint32_t seqno);
-    bool free_seqno_from_queue(uint32_t seqno, dm_block_queue_t &queue);
-    bool send_log_blocks_from_queue(dm_block_queue_t &queue);
-    uint8_t stack_size(struct dm_block *stack);
-    uint8_t queue_size(dm_block_queue_t queue);
+    bool send_log_blocks_from_queue(dm_block_queue_t &queue, bool in_window);
+    uint16_t stack_size(struct dm_block *stack);
+    uint16_t queue_size(dm_block_queue_t queue);
     
     struct dm_block *_blocks_free;
     dm_block_queue_t _blocks_sent;
@@ -105,18 +109,18 @@ private:
         // the following are reset any time we log stats (see "reset_stats")
         uint32_t resends;
         uint8_t collection_count;
-        uint16_t state_free; // cumulative across collection period
-        uint8_t state_free_min;
-        uint8_t state_free_max;
-        uint16_t state_pending; // cumulative across collection period
-        uint8_t state_pending_min;
-        uint8_t state_pending_max;
-        uint16_t state_retry; // cumulative across collection period
-        uint8_t state_retry_min;
-        uint8_t state_retry_max;
-        uint16_t state_sent; // cumulative across collection period
-        uint8_t state_sent_min;
-        uint8_t state_sent_max;
+        uint32_t state_free; // cumulative across collection period
+        uint16_t state_free_min;
+        uint16_t state_free_max;
+        uint32_t state_pending; // cumulative across collection period
+        uint16_t state_pending_min;
+        uint16_t state_pending_max;
+        uint32_t state_retry; // cumulative across collection period
+        uint16_t state_retry_min;
+        uint16_t state_retry_max;
+        uint32_t state_sent; // cumulative across collection period
+        uint16_t state_sent_min;
+        uint16_t state_sent_max;
     } stats;
 
     // this method is used when reporting system status over mavlink
@@ -144,13 +148,33 @@ private:
     uint8_t _next_block_number_to_resend;
     bool _sending_to_client;
 
+    /*
+      sliding window. At most _window blocks are in flight waiting
+      for an ack. The window grows as blocks are acked and is halved,
+      at most once per round trip, when blocks are lost, so the send
+      rate follows what the link can carry. Blocks are resent after
+      a timeout based on the measured round trip time, so a link with
+      high latency doesn't get every block in flight sent again
+     */
+    float _window;
+    float _window_threshold;
+    uint32_t _window_cut_ms;
+    // smoothed round trip time and its variation, in ms
+    float _srtt_ms;
+    float _rttvar_ms;
+    uint16_t _resend_timeout_ms;
+    void window_reset();
+    void window_ack(const struct dm_block &block, uint32_t now);
+    void window_loss(uint32_t now);
+
     void Write_logger_MAV(AP_Logger_MAVLink &logger);
 
     uint32_t bufferspace_available() override; // in bytes
+    uint8_t backend_type() const override { return uint8_t(AP_Logger::Backend_Type::MAVLINK); }
     uint8_t remaining_space_in_current_block();
     // write buffer
-    uint8_t _blockcount_free;
-    uint8_t _blockcount;
+    uint16_t _blockcount_free;
+    uint16_t _blockcount;
     struct dm_block *_blocks;
     struct dm_block *_current_block;
     struct dm_block *next_block();
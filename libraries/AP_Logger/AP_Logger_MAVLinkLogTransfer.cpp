@@ -200,7 +200,13 @@ void AP_Logger::handle_log_send()
     case IDLE:
         break;
     case LISTING:
-        handle_log_send_listing();
+        // entries come from the backend's index, so several can
+        // be sent each time
+        for (uint8_t i=0; i<10 && transfer_activity == LISTING; i++) {
+            if (!handle_log_send_listing()) {
+                break;
+            }
+        }
         break;
     case SENDING:
         handle_log_sending();
@@ -243,17 +249,17 @@ void AP_Logger::handle_log_sending()
 /**
    trigger sending of log messages if there are some pending
  */
-void AP_Logger::handle_log_send_listing()
+bool AP_Logger::handle_log_send_listing()
 {
     WITH_SEMAPHORE(_log_send_sem);
 
     if (!HAVE_PAYLOAD_SPACE(_log_sending_link->get_chan(), LOG_ENTRY)) {
         // no space
-        return;
+        return false;
     }
     if (AP_HAL::millis() - _log_sending_link->get_last_heartbeat_time() > 3000) {
         // give a heartbeat a chance
-        return;
+        return false;
     }
 
     uint32_t size, time_utc;
@@ -275,6 +281,7 @@ void AP_Logger::handle_log_send_listing()
     } else {
         _log_next_list_entry++;
     }
+    return true;
 }
 
 /**
@@ -301,6 +308,10 @@ bool AP_Logger::handle_log_send_data()
         len = MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
     }
     ret = get_log_data(_log_num_data, _log_data_page, _log_data_offset, len, packet.data);
+    if (ret == LOGGER_DATA_PENDING) {
+        // still being read, try again next time
+        return false;
+    }
     if (ret < 0) {
         // report as EOF on error
         ret = 0;
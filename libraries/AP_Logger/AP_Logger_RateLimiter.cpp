@@ -0,0 +1,186 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_Logger_RateLimiter.h"
+
+#include <AP_Filesystem/AP_Filesystem.h>
+#include <AP_Math/AP_Math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// longest period, leaving room for the unresolved marker
+#define RATE_LIMIT_MAX_PERIOD_MS 60000U
+
+AP_Logger_RateLimiter::AP_Logger_RateLimiter(const AP_Float &rate_max) :
+    _rate_max(rate_max)
+{
+    _resolved_rate_max = _rate_max;
+    memset(_period_ms, 0xFF, sizeof(_period_ms));
+}
+
+uint16_t AP_Logger_RateLimiter::period_ms(float rate_hz)
+{
+    if (!is_positive(rate_hz)) {
+        return 0;
+    }
+    return constrain_float(1000.0f / rate_hz + 0.5f, 1, RATE_LIMIT_MAX_PERIOD_MS);
+}
+
+bool AP_Logger_RateLimiter::add_rate(const char *name, float rate_hz)
+{
+    const uint8_t len = strnlen(name, sizeof(_entries[0].name));
+    if (len == 0 || len >= sizeof(_entries[0].name)) {
+        return false;
+    }
+    uint8_t i;
+    for (i=0; i<_num_entries; i++) {
+        if (strcmp(_entries[i].name, name) == 0) {
+            break;
+        }
+    }
+    if (i == ARRAY_SIZE(_entries)) {
+        return false;
+    }
+    if (i == _num_entries) {
+        memcpy(_entries[i].name, name, len+1);
+        _num_entries++;
+    }
+    _entries[i].rate_hz = rate_hz;
+    // the new rate may apply to a type already resolved
+    memset(_period_ms, 0xFF, sizeof(_period_ms));
+    return true;
+}
+
+/*
+  parse a "NAME RATE" line, ignoring blank lines and comments
+ */
+bool AP_Logger_RateLimiter::parse_line(char *line)
+{
+    char *hash = strchr(line, '#');
+    if (hash != nullptr) {
+        *hash = 0;
+    }
+    char *saveptr = nullptr;
+    const char *name = strtok_r(line, " \t\r", &saveptr);
+    if (name == nullptr) {
+        return false;
+    }
+    const char *rate = strtok_r(nullptr, " \t\r", &saveptr);
+    if (rate == nullptr) {
+        return false;
+    }
+    char *end;
+    const float rate_hz = strtof(rate, &end);
+    if (end == rate || *end != 0) {
+        return false;
+    }
+    return add_rate(name, rate_hz);
+}
+
+uint8_t AP_Logger_RateLimiter::load_file(const char *filename)
+{
+    uint8_t count = 0;
+#if HAVE_FILESYSTEM_SUPPORT
+    const int fd = AP::FS().open(filename, O_RDONLY);
+    if (fd == -1) {
+        return 0;
+    }
+    char line[64];
+    uint8_t len = 0;
+    char buf[64];
+    ssize_t n;
+    while ((n = AP::FS().read(fd, buf, sizeof(buf))) > 0) {
+        for (ssize_t i=0; i<n; i++) {
+            if (buf[i] != '\n' && len < sizeof(line)-1) {
+                line[len++] = buf[i];
+                continue;
+            }
+            if (buf[i] != '\n') {
+                // over-long lines are truncated
+                continue;
+            }
+            line[len] = 0;
+            len = 0;
+            if (parse_line(line)) {
+                count++;
+            }
+        }
+    }
+    // last line may have no newline
+    line[len] = 0;
+    if (parse_line(line)) {
+        count++;
+    }
+    AP::FS().close(fd);
+#else
+    (void)filename;
+#endif
+    return count;
+}
+
+bool AP_Logger_RateLimiter::needs_resolve(uint8_t msg_type)
+{
+    if (!is_equal(_resolved_rate_max, _rate_max.get())) {
+        // LOG_RATE_MAX has changed, resolve all types again
+        _resolved_rate_max = _rate_max;
+        memset(_period_ms, 0xFF, sizeof(_period_ms));
+    }
+    return _period_ms[msg_type] == PERIOD_UNRESOLVED;
+}
+
+void AP_Logger_RateLimiter::resolve(uint8_t msg_type, const char *name)
+{
+    float rate_hz = _resolved_rate_max;
+    if (name != nullptr) {
+        for (uint8_t i=0; i<_num_entries; i++) {
+            if (strncmp(_entries[i].name, name, sizeof(_entries[i].name)-1) == 0) {
+                rate_hz = _entries[i].rate_hz;
+                break;
+            }
+        }
+    }
+    _period_ms[msg_type] = period_ms(rate_hz);
+}
+
+bool AP_Logger_RateLimiter::should_log(uint8_t msg_type, uint32_t now_ms, uint16_t tick)
+{
+    const uint16_t period = _period_ms[msg_type];
+    if (period == 0 || period == PERIOD_UNRESOLVED) {
+        return true;
+    }
+    if (!(_seen[msg_type/32] & (1U<<(msg_type%32)))) {
+        _seen[msg_type/32] |= 1U<<(msg_type%32);
+        _next_ms[msg_type] = now_ms + period;
+        _last_tick[msg_type] = tick;
+        return true;
+    }
+    if (tick == _last_tick[msg_type]) {
+        // another instance of a message already written this tick
+        return true;
+    }
+    const int32_t late = int32_t(now_ms - _next_ms[msg_type]);
+    if (late >= 0) {
+        // keep to the requested rate on average when the message
+        // rate isn't a multiple of it, unless we have fallen behind
+        _next_ms[msg_type] = (late < period ? _next_ms[msg_type] : now_ms) + period;
+        _last_tick[msg_type] = tick;
+        return true;
+    }
+    if (_suppressed[msg_type] < UINT16_MAX) {
+        _suppressed[msg_type]++;
+    }
+    _suppressed_total++;
+    return false;
+}
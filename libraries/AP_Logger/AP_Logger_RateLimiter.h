@@ -0,0 +1,97 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  per message type rate limiting for AP_Logger.
+
+  Each message type gets a minimum period, taken from a per-name rate
+  (set with add_rate() or loaded from a file) or else from the
+  LOG_RATE_MAX parameter. A rate of zero means the type is never
+  limited. Messages of a type that has multiple instances (several
+  IMUs, batteries etc.) are all written in the same scheduler tick, so
+  once one message of a type has been let through every other message
+  of that type in the same tick is let through too.
+
+  The rate file holds one "NAME RATE" pair per line, e.g.:
+
+    # log the EKF innovations and IMU data at 25Hz
+    XKF4 25
+    IMU 25
+    # never limit attitude
+    ATT 0
+ */
+
+#include <AP_Param/AP_Param.h>
+
+#ifndef HAL_LOGGER_RATE_LIMIT_MAX_ENTRIES
+#define HAL_LOGGER_RATE_LIMIT_MAX_ENTRIES 32
+#endif
+
+class AP_Logger_RateLimiter
+{
+public:
+    AP_Logger_RateLimiter(const AP_Float &rate_max);
+
+    /* Do not allow copies */
+    AP_Logger_RateLimiter(const AP_Logger_RateLimiter &other) = delete;
+    AP_Logger_RateLimiter &operator=(const AP_Logger_RateLimiter&) = delete;
+
+    // set the rate for messages called name, overriding LOG_RATE_MAX
+    bool add_rate(const char *name, float rate_hz);
+
+    // add the rates from a file, returns the number of entries loaded
+    uint8_t load_file(const char *filename);
+
+    // number of per-name rates
+    uint8_t num_rates() const { return _num_entries; }
+
+    // true if the period for msg_type needs to be looked up with resolve()
+    bool needs_resolve(uint8_t msg_type);
+    void resolve(uint8_t msg_type, const char *name);
+
+    // returns true if a message of msg_type should be written now
+    bool should_log(uint8_t msg_type, uint32_t now_ms, uint16_t tick);
+
+    // count of messages suppressed, in total and per type
+    uint32_t num_suppressed() const { return _suppressed_total; }
+    uint16_t num_suppressed(uint8_t msg_type) const { return _suppressed[msg_type]; }
+
+private:
+    const AP_Float &_rate_max;
+    // LOG_RATE_MAX the periods were resolved with
+    float _resolved_rate_max;
+
+    struct {
+        char name[5];
+        float rate_hz;
+    } _entries[HAL_LOGGER_RATE_LIMIT_MAX_ENTRIES];
+    uint8_t _num_entries;
+
+    // minimum period of each message type in ms, 0 for no limit
+    static const uint16_t PERIOD_UNRESOLVED = 0xFFFF;
+    uint16_t _period_ms[256];
+    // time the next message of each type is due
+    uint32_t _next_ms[256];
+    // tick in which a message of each type was last let through
+    uint16_t _last_tick[256];
+    // types that have been let through at least once
+    uint32_t _seen[8];
+    uint16_t _suppressed[256];
+    uint32_t _suppressed_total;
+
+    static uint16_t period_ms(float rate_hz);
+    bool parse_line(char *line);
+};
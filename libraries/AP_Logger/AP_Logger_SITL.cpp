@@ -59,10 +59,10 @@ void AP_Logger_SITL::PageToBuffer(uint32_t PageAdr)
     }
 }
 
-void AP_Logger_SITL::BufferToPage(uint32_t PageAdr)
+void AP_Logger_SITL::BufferToPage(uint32_t PageAdr, const uint8_t *data)
 {
     assert(PageAdr>0 && PageAdr <= df_NumPages+1);
-    if (pwrite(flash_fd, buffer, DF_PAGE_SIZE, (PageAdr-1)*DF_PAGE_SIZE) != DF_PAGE_SIZE) {
+    if (pwrite(flash_fd, data, DF_PAGE_SIZE, (PageAdr-1)*DF_PAGE_SIZE) != DF_PAGE_SIZE) {
         printf("Failed flash write");
     }
 }
@@ -19,12 +19,13 @@ public:
     static constexpr const char *filename = "dataflash.bin";
 
 private:
-    void  BufferToPage(uint32_t PageAdr) override;
+    void  BufferToPage(uint32_t PageAdr, const uint8_t *data) override;
     void  PageToBuffer(uint32_t PageAdr) override;
     void  SectorErase(uint32_t SectorAdr) override;
     void  Sector4kErase(uint32_t SectorAdr) override;
     void  StartErase() override;
     bool  InErase() override;
+    bool  Busy() override { return InErase(); }
 
     int flash_fd;
     uint32_t erase_started_ms;
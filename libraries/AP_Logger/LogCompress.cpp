@@ -0,0 +1,293 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LogCompress.h"
+
+#include <string.h>
+#include <AP_Math/AP_Math.h>
+#include "LogStructure.h"
+
+// LZ4 block format limits: the last match must start at least
+// MFLIMIT bytes before the end and the last LASTLITERALS bytes are
+// always literals
+#define LZ4_MINMATCH 4
+#define LZ4_MFLIMIT 12
+#define LZ4_LASTLITERALS 5
+
+static inline uint32_t read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static inline uint16_t get16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+void LogCompress::reset()
+{
+    memset(_msg_len, 0, sizeof(_msg_len));
+    _msg_len[LOG_FORMAT_MSG] = sizeof(log_Format);
+}
+
+void LogCompress::file_header(uint8_t *hdr)
+{
+    memset(hdr, 0, LOG_COMPRESS_FILE_HEADER_LEN);
+    memcpy(hdr, LOG_COMPRESS_MAGIC, 4);
+    hdr[4] = LOG_COMPRESS_VERSION;
+}
+
+bool LogCompress::is_compressed(const uint8_t *hdr)
+{
+    return memcmp(hdr, LOG_COMPRESS_MAGIC, 4) == 0 && hdr[4] == LOG_COMPRESS_VERSION;
+}
+
+void LogCompress::frame_lengths(const uint8_t *hdr, uint16_t &raw_len, uint16_t &comp_len)
+{
+    raw_len = get16(&hdr[0]);
+    comp_len = get16(&hdr[2]);
+}
+
+void LogCompress::learn_format(const uint8_t *msg)
+{
+    const struct log_Format *f = (const struct log_Format *)msg;
+    if (f->type != LOG_FORMAT_MSG) {
+        _msg_len[f->type] = f->length;
+    }
+}
+
+/*
+  replace the 8 bytes after each message header with the difference to
+  the previous message of the same type, or undo that. The walk stops
+  at the first message whose length isn't known yet, which happens at
+  the same place when encoding and decoding as both learn lengths from
+  the original FMT messages
+ */
+void LogCompress::delta(uint8_t *block, uint16_t len, bool encode)
+{
+    const uint8_t hdr_len = 3;
+    memset(_seen, 0, sizeof(_seen));
+
+    uint16_t ofs = 0;
+    while (ofs + hdr_len <= len) {
+        uint8_t *msg = &block[ofs];
+        if (msg[0] != HEAD_BYTE1 || msg[1] != HEAD_BYTE2) {
+            break;
+        }
+        const uint8_t type = msg[2];
+        const uint8_t msg_len = _msg_len[type];
+        if (msg_len == 0 || ofs + msg_len > len) {
+            break;
+        }
+        // learn from the original FMT message, before encoding or
+        // after decoding
+        if (encode && type == LOG_FORMAT_MSG) {
+            learn_format(msg);
+        }
+        if (msg_len >= hdr_len + sizeof(uint64_t)) {
+            uint64_t v;
+            memcpy(&v, &msg[hdr_len], sizeof(v));
+            const bool seen = _seen[type/32] & (1U<<(type%32));
+            if (encode) {
+                const uint64_t d = seen ? v - _last[type] : v;
+                _last[type] = v;
+                memcpy(&msg[hdr_len], &d, sizeof(d));
+            } else {
+                if (seen) {
+                    v += _last[type];
+                    memcpy(&msg[hdr_len], &v, sizeof(v));
+                }
+                _last[type] = v;
+            }
+            _seen[type/32] |= 1U<<(type%32);
+        }
+        if (!encode && type == LOG_FORMAT_MSG) {
+            learn_format(msg);
+        }
+        ofs += msg_len;
+    }
+}
+
+uint16_t LogCompress::lz4_compress(const uint8_t *src, uint16_t len, uint8_t *dst)
+{
+    uint8_t *op = dst;
+    uint16_t anchor = 0;
+
+    if (len > LZ4_MFLIMIT) {
+        const uint16_t match_limit = len - LZ4_MFLIMIT;
+        const uint16_t end_limit = len - LZ4_LASTLITERALS;
+        uint16_t ip = 0;
+        while (ip < match_limit) {
+            const uint32_t seq = read32(&src[ip]);
+            const uint16_t h = (seq * 2654435761U) >> (32 - HASH_BITS);
+            // the table isn't cleared between blocks, so entries may
+            // be stale. They are only used after checking the bytes
+            const uint16_t ref = _hash[h];
+            _hash[h] = ip;
+            if (ref >= ip || read32(&src[ref]) != seq) {
+                ip++;
+                continue;
+            }
+
+            uint16_t match_len = LZ4_MINMATCH;
+            while (ip + match_len < end_limit && src[ref + match_len] == src[ip + match_len]) {
+                match_len++;
+            }
+
+            // token, literal length, literals, offset, match length
+            const uint16_t lit_len = ip - anchor;
+            uint8_t *token = op++;
+            *token = MIN(lit_len, 15U) << 4;
+            if (lit_len >= 15) {
+                uint16_t n = lit_len - 15;
+                while (n >= 255) {
+                    *op++ = 255;
+                    n -= 255;
+                }
+                *op++ = n;
+            }
+            memcpy(op, &src[anchor], lit_len);
+            op += lit_len;
+            put16(op, ip - ref);
+            op += 2;
+            uint16_t n = match_len - LZ4_MINMATCH;
+            *token |= MIN(n, 15U);
+            if (n >= 15) {
+                n -= 15;
+                while (n >= 255) {
+                    *op++ = 255;
+                    n -= 255;
+                }
+                *op++ = n;
+            }
+
+            ip += match_len;
+            anchor = ip;
+        }
+    }
+
+    // the last sequence is literals only
+    const uint16_t lit_len = len - anchor;
+    *op++ = MIN(lit_len, 15U) << 4;
+    if (lit_len >= 15) {
+        uint16_t n = lit_len - 15;
+        while (n >= 255) {
+            *op++ = 255;
+            n -= 255;
+        }
+        *op++ = n;
+    }
+    memcpy(op, &src[anchor], lit_len);
+    op += lit_len;
+
+    return op - dst;
+}
+
+bool LogCompress::lz4_decompress(const uint8_t *src, uint16_t src_len, uint8_t *dst, uint16_t dst_len)
+{
+    uint32_t ip = 0;
+    uint32_t op = 0;
+    while (ip < src_len) {
+        const uint8_t token = src[ip++];
+        uint32_t lit_len = token >> 4;
+        if (lit_len == 15) {
+            uint8_t b;
+            do {
+                if (ip >= src_len) {
+                    return false;
+                }
+                b = src[ip++];
+                lit_len += b;
+            } while (b == 255);
+        }
+        if (ip + lit_len > src_len || op + lit_len > dst_len) {
+            return false;
+        }
+        memcpy(&dst[op], &src[ip], lit_len);
+        ip += lit_len;
+        op += lit_len;
+        if (ip == src_len) {
+            // last sequence
+            break;
+        }
+
+        if (ip + 2 > src_len) {
+            return false;
+        }
+        const uint16_t offset = get16(&src[ip]);
+        ip += 2;
+        if (offset == 0 || offset > op) {
+            return false;
+        }
+        uint32_t match_len = token & 0x0F;
+        if (match_len == 15) {
+            uint8_t b;
+            do {
+                if (ip >= src_len) {
+                    return false;
+                }
+                b = src[ip++];
+                match_len += b;
+            } while (b == 255);
+        }
+        match_len += LZ4_MINMATCH;
+        if (op + match_len > dst_len) {
+            return false;
+        }
+        // byte by byte as the match may overlap the output
+        for (uint32_t i = 0; i < match_len; i++, op++) {
+            dst[op] = dst[op - offset];
+        }
+    }
+    return op == dst_len;
+}
+
+uint16_t LogCompress::compress(uint8_t *block, uint16_t len, uint8_t *frame)
+{
+    delta(block, len, true);
+
+    uint8_t *data = &frame[LOG_COMPRESS_FRAME_HEADER_LEN];
+    uint16_t comp_len = lz4_compress(block, len, data);
+    if (comp_len >= len) {
+        // not worth it, store the block as it is
+        memcpy(data, block, len);
+        comp_len = len;
+    }
+    put16(&frame[0], len);
+    put16(&frame[2], comp_len);
+    return LOG_COMPRESS_FRAME_HEADER_LEN + comp_len;
+}
+
+bool LogCompress::decompress(const uint8_t *data, uint16_t comp_len, uint8_t *block, uint16_t raw_len)
+{
+    if (comp_len > raw_len) {
+        return false;
+    }
+    if (comp_len == raw_len) {
+        memcpy(block, data, raw_len);
+    } else if (!lz4_decompress(data, comp_len, block, raw_len)) {
+        return false;
+    }
+    delta(block, raw_len, false);
+    return true;
+}
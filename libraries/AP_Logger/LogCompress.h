@@ -0,0 +1,87 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  block compression for dataflash logs.
+
+  A compressed log starts with an 8 byte file header (LOG_COMPRESS_MAGIC
+  followed by the format version and three zero bytes) and is followed
+  by frames. Each frame is a 4 byte little-endian header holding the
+  raw and compressed lengths, followed by the compressed data. When the
+  two lengths are equal the data is stored uncompressed.
+
+  Each raw block holds whole log messages. Before compression the 8
+  bytes following each message header (the TimeUS field of nearly
+  every message) are replaced by their difference to the same bytes
+  of the previous message of that type in the block, which turns the
+  timestamps of high rate messages into small repeating values. The
+  message lengths needed to walk the block are learnt from the FMT
+  messages in the log itself, so the transform needs no knowledge of
+  the log structures and is exactly reversible. The differenced block
+  is then compressed in the LZ4 block format.
+ */
+
+#include <stdint.h>
+
+#define LOG_COMPRESS_MAGIC "APLZ"
+#define LOG_COMPRESS_VERSION 1
+#define LOG_COMPRESS_FILE_HEADER_LEN 8
+#define LOG_COMPRESS_FRAME_HEADER_LEN 4
+// largest raw block that can be compressed
+#define LOG_COMPRESS_MAX_BLOCK 8192
+// largest frame, including its header, for a raw block of n bytes
+#define LOG_COMPRESS_MAX_FRAME(n) (LOG_COMPRESS_FRAME_HEADER_LEN + (n) + (n)/255 + 16)
+
+class LogCompress
+{
+public:
+    // forget the message lengths learnt so far. Call at the start of each log
+    void reset();
+
+    // fill in the 8 byte file header
+    static void file_header(uint8_t *hdr);
+    // true if hdr is the file header of a compressed log
+    static bool is_compressed(const uint8_t *hdr);
+
+    // difference and compress len bytes of whole messages from block,
+    // which is modified, into frame. frame must have room for
+    // LOG_COMPRESS_MAX_FRAME(len) bytes. Returns the frame length
+    uint16_t compress(uint8_t *block, uint16_t len, uint8_t *frame);
+
+    // decode the data of one frame (after its header) into block,
+    // which must have room for raw_len bytes. Returns false if the
+    // frame is corrupt
+    bool decompress(const uint8_t *data, uint16_t comp_len, uint8_t *block, uint16_t raw_len);
+
+    // lengths of the raw and compressed data from a frame header
+    static void frame_lengths(const uint8_t *hdr, uint16_t &raw_len, uint16_t &comp_len);
+
+private:
+    // length of each message type, learnt from FMT messages
+    uint8_t _msg_len[256];
+    // timestamp of the last message of each type in the block
+    uint64_t _last[256];
+    // message types seen in the current block
+    uint32_t _seen[8];
+    // LZ4 match finder, indexed by a hash of four bytes
+    static const uint8_t HASH_BITS = 12;
+    uint16_t _hash[1U<<HASH_BITS];
+
+    void learn_format(const uint8_t *msg);
+    void delta(uint8_t *block, uint16_t len, bool encode);
+    uint16_t lz4_compress(const uint8_t *src, uint16_t len, uint8_t *dst);
+    static bool lz4_decompress(const uint8_t *src, uint16_t src_len, uint8_t *dst, uint16_t dst_len);
+};
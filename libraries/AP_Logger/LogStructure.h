@@ -133,6 +133,79 @@ static const uint8_t LS_LABELS_SIZE = 65;
 static const uint8_t LS_UNITS_SIZE = 17;
 static const uint8_t LS_MULTIPLIERS_SIZE = 17;
 
+/*
+  compile-time description of messages from their format strings, so
+  the message tables can be checked against the structures at build
+  time. These are C++11 constexpr, hence the recursion.
+ */
+
+// size of the field for a format character, 0 if it isn't one
+constexpr uint8_t log_format_field_size(const char c)
+{
+    return (c == 'b' || c == 'B' || c == 'M') ? sizeof(uint8_t) :
+        (c == 'h' || c == 'H' || c == 'c' || c == 'C') ? sizeof(uint16_t) :
+        (c == 'i' || c == 'I' || c == 'e' || c == 'E' || c == 'L' || c == 'f') ? sizeof(uint32_t) :
+        (c == 'n') ? sizeof(char[4]) :
+        (c == 'q' || c == 'Q' || c == 'd') ? sizeof(uint64_t) :
+        (c == 'N') ? sizeof(char[16]) :
+        (c == 'a') ? sizeof(int16_t[32]) :
+        (c == 'Z') ? sizeof(char[64]) :
+        0;
+}
+
+constexpr uint8_t log_strlen(const char *s)
+{
+    return *s == 0 ? 0 : 1 + log_strlen(s+1);
+}
+
+// true if every character of fmt is a format character
+constexpr bool log_format_valid(const char *fmt)
+{
+    return *fmt == 0 ? true : log_format_field_size(*fmt) != 0 && log_format_valid(fmt+1);
+}
+
+// offset of field n of a message in format fmt, including the header
+constexpr uint16_t log_format_offset(const char *fmt, const uint8_t n)
+{
+    return (n == 0 || *fmt == 0) ? LOG_PACKET_HEADER_LEN : log_format_field_size(*fmt) + log_format_offset(fmt+1, n-1);
+}
+
+// length of a message in format fmt, including the header
+constexpr uint16_t log_format_length(const char *fmt)
+{
+    return log_format_offset(fmt, log_strlen(fmt));
+}
+
+constexpr uint8_t log_label_count(const char *labels)
+{
+    return *labels == 0 ? 1 : (*labels == ',') + log_label_count(labels+1);
+}
+
+// true if the format of s matches its length and the labels, units
+// and multipliers
+constexpr bool log_structure_valid(const struct LogStructure &s)
+{
+    return log_strlen(s.name) > 0 && log_strlen(s.name) < LS_NAME_SIZE &&
+        log_strlen(s.format) < LS_FORMAT_SIZE &&
+        log_strlen(s.labels) < LS_LABELS_SIZE &&
+        log_format_valid(s.format) &&
+        log_format_length(s.format) == s.msg_len &&
+        log_label_count(s.labels) == log_strlen(s.format) &&
+        log_strlen(s.units) == log_strlen(s.format) &&
+        log_strlen(s.multipliers) == log_strlen(s.format);
+}
+
+// never defined; called only when a structure fails its check so the
+// build fails in the check of that structure
+void log_structure_invalid(const struct LogStructure &s);
+
+constexpr bool log_structures_valid(const struct LogStructure *s, const uint16_t n, const uint16_t i=0)
+{
+    return i == n ? true :
+        log_structure_valid(s[i]) ? log_structures_valid(s, n, i+1) :
+        (log_structure_invalid(s[i]), false);
+}
+
 /*
   log structures common to all vehicle types
  */
@@ -185,6 +258,20 @@ struct PACKED log_DSF {
     uint32_t buf_space_avg;
 };
 
+// logging statistics of one backend over the last second, either for
+// all messages (msg_id 255) or for one message type that was dropped
+struct PACKED log_LoggerStats {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t backend;
+    uint8_t msg_id;
+    char name[4];
+    uint32_t dropped;
+    uint32_t dropped_total;
+    uint32_t bytes;
+    uint32_t buf_space_min;
+};
+
 struct PACKED log_Event {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -278,6 +365,16 @@ struct PACKED log_ISBD {
 };
 static_assert(sizeof(log_ISBD) < 256, "log_ISBD is over-size");
 
+// marks samples dropped from a continuous IMU batch stream before
+// batch isb_seqno
+struct PACKED log_ISBG {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint16_t isb_seqno;
+    uint64_t sample_us;
+    uint32_t dropped;
+};
+
 struct PACKED log_Vibe {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -368,6 +465,14 @@ struct PACKED log_MAV {
     uint16_t packet_tx_count;
     uint16_t packet_rx_success_count;
     uint16_t packet_rx_drop_count;
+    uint32_t packet_fwd_count;
+    uint32_t packet_fwd_drop_count;
+    uint32_t sign_hash_count;
+    uint32_t sign_hash_time_us;
+    uint16_t ack_latency_ms;
+    uint16_t param_latency_ms;
+    uint16_t text_latency_ms;
+    uint32_t reply_drop_count;
 };
 
 struct PACKED log_RSSI {
@@ -846,6 +951,8 @@ struct PACKED log_TERRAIN {
     float current_height;
     uint16_t pending;
     uint16_t loaded;
+    uint32_t cache_hits;
+    uint32_t cache_misses;
 };
 
 /*
@@ -998,18 +1105,20 @@ struct PACKED log_MAV_Stats {
     uint32_t dropped;
     uint32_t retries;
     uint32_t resends;
-    uint8_t state_free_avg;
-    uint8_t state_free_min;
-    uint8_t state_free_max;
-    uint8_t state_pending_avg;
-    uint8_t state_pending_min;
-    uint8_t state_pending_max;
-    uint8_t state_sent_avg;
-    uint8_t state_sent_min;
-    uint8_t state_sent_max;
+    uint16_t state_free_avg;
+    uint16_t state_free_min;
+    uint16_t state_free_max;
+    uint16_t state_pending_avg;
+    uint16_t state_pending_min;
+    uint16_t state_pending_max;
+    uint16_t state_sent_avg;
+    uint16_t state_sent_min;
+    uint16_t state_sent_max;
     // uint8_t state_retry_avg;
     // uint8_t state_retry_min;
     // uint8_t state_retry_max;
+    uint16_t window;
+    uint16_t rtt;
 };
 
 struct PACKED log_ORGN {
@@ -1163,6 +1272,126 @@ struct PACKED log_Performance {
     uint32_t extra_loop_us;
 };
 
+struct PACKED log_SchedTask {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t task;
+    uint32_t run_count;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t p999;
+    uint32_t max_time;
+    uint16_t slip_p99;
+    uint16_t slip_p999;
+    uint32_t starved;
+};
+
+struct PACKED log_DMAStats {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t stream;
+    uint32_t lock_count;
+    uint32_t contended;
+    uint32_t nonblock_fail;
+    uint32_t p99;
+    uint32_t p999;
+    uint32_t max_wait;
+};
+
+struct PACKED log_ThreadStats {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t thread;
+    char name[16];
+    uint16_t load;
+    uint32_t stack_free;
+};
+
+struct PACKED log_GyroFFT {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    float freq_hz;
+    float amplitude;
+    float snr;
+    uint32_t overruns;
+    uint8_t healthy;
+};
+
+struct PACKED log_IMUFIFO {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t instance;
+    uint32_t bytes;
+    uint32_t samples;
+    uint32_t overflows;
+    uint32_t resets;
+    uint32_t convert_us;
+};
+
+struct PACKED log_SampleJitter {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t type;
+    uint8_t instance;
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    float mean_us;
+    float sd_us;
+    uint16_t h0;
+    uint16_t h1;
+    uint16_t h2;
+    uint16_t h3;
+    uint16_t h4;
+    uint16_t h5;
+};
+
+struct PACKED log_OutputLatency {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t stage;
+    uint32_t count;
+    float mean_us;
+    uint32_t max_us;
+    uint16_t h0;
+    uint16_t h1;
+    uint16_t h2;
+    uint16_t h3;
+    uint16_t h4;
+    uint16_t h5;
+    uint16_t h6;
+    uint16_t h7;
+};
+
+struct PACKED log_BidirDShot {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t instance;
+    float rpm;
+    float error_rate;
+};
+
+struct PACKED log_ESCTelemStats {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t instance;
+    uint16_t frames;
+    uint16_t bad_frames;
+    uint16_t no_reply;
+    uint16_t age_max;
+    uint16_t age_avg;
+};
+
+struct PACKED log_BootStage {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t stage;
+    char name[16];
+    uint32_t start_us;
+    uint32_t duration_us;
+};
+
 struct PACKED log_SRTL {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -1277,6 +1506,11 @@ struct PACKED log_Arm_Disarm {
 #define ISBD_UNITS  "s--ooo"
 #define ISBD_MULTS  "F--???"
 
+#define ISBG_LABELS "TimeUS,N,SampleUS,Drop"
+#define ISBG_FMT    "QHQI"
+#define ISBG_UNITS  "s-s-"
+#define ISBG_MULTS  "F-F-"
+
 #define IMU_LABELS "TimeUS,GyrX,GyrY,GyrZ,AccX,AccY,AccZ,EG,EA,T,GH,AH,GHz,AHz"
 #define IMU_FMT   "QffffffIIfBBHH"
 #define IMU_UNITS "sEEEooo--O--zz"
@@ -1407,13 +1641,33 @@ struct PACKED log_Arm_Disarm {
     { LOG_RFND_MSG, sizeof(log_RFND), \
       "RFND", "QBCBB", "TimeUS,Instance,Dist,Stat,Orient", "s#m--", "F-B--" }, \
     { LOG_MAV_STATS, sizeof(log_MAV_Stats), \
-      "DMS", "IIIIIBBBBBBBBB",         "TimeMS,N,Dp,RT,RS,Fa,Fmn,Fmx,Pa,Pmn,Pmx,Sa,Smn,Smx", "s-------------", "C-------------" }, \
+      "DMS", "IIIIIHHHHHHHHHHH",         "TimeMS,N,Dp,RT,RS,Fa,Fmn,Fmx,Pa,Pmn,Pmx,Sa,Smn,Smx,Win,RTT", "s--------------s", "C--------------C" }, \
     { LOG_BEACON_MSG, sizeof(log_Beacon), \
       "BCN", "QBBfffffff",  "TimeUS,Health,Cnt,D0,D1,D2,D3,PosX,PosY,PosZ", "s--mmmmmmm", "F--BBBBBBB" }, \
     { LOG_PROXIMITY_MSG, sizeof(log_Proximity), \
       "PRX", "QBfffffffffff", "TimeUS,Health,D0,D45,D90,D135,D180,D225,D270,D315,DUp,CAn,CDis", "s-mmmmmmmmmhm", "F-00000000000" }, \
     { LOG_PERFORMANCE_MSG, sizeof(log_Performance),                     \
       "PM",  "QHHIIHIIIIII", "TimeUS,NLon,NLoop,MaxT,Mem,Load,IntE,IntEC,SPIC,I2CC,I2CI,ExUS", "s---b%-----s", "F---0A-----F" }, \
+    { LOG_SCHED_TASK_MSG, sizeof(log_SchedTask), \
+      "SCHD", "QBIIIIIIHHI", "TimeUS,Task,N,P50,P90,P99,P999,Max,SP99,SP999,Stv", "s#-sssss---", "F--FFFFF---" }, \
+    { LOG_DMA_STATS_MSG, sizeof(log_DMAStats), \
+      "DMAS", "QBIIIIII", "TimeUS,Strm,N,Cont,NBF,P99,P999,Max", "s#---sss", "F----FFF" }, \
+    { LOG_THREAD_STATS_MSG, sizeof(log_ThreadStats), \
+      "THRD", "QBNHI", "TimeUS,Thrd,Name,Load,StkF", "s#-%b", "F--A0" }, \
+    { LOG_GYRO_FFT_MSG, sizeof(log_GyroFFT), \
+      "FTN", "QfffIB", "TimeUS,PkHz,PkAmp,SNR,Ovr,H", "szE---", "F00---" }, \
+    { LOG_IMU_FIFO_MSG, sizeof(log_IMUFIFO), \
+      "IFFO", "QBIIIII", "TimeUS,I,Bytes,NSamp,Ovf,Rst,ConvUS", "s#----s", "F-----F" }, \
+    { LOG_SAMPLE_JITTER_MSG, sizeof(log_SampleJitter), \
+      "SJIT", "QBBIIIffHHHHHH", "TimeUS,T,I,N,Min,Max,Mean,SD,H0,H1,H2,H3,H4,H5", "s-#-ssss------", "F---FFFF------" }, \
+    { LOG_OUTPUT_LATENCY_MSG, sizeof(log_OutputLatency), \
+      "OLAT", "QBIfIHHHHHHHH", "TimeUS,Stg,N,Mean,Max,H0,H1,H2,H3,H4,H5,H6,H7", "s#-ss--------", "F--FF--------" }, \
+    { LOG_BIDIR_DSHOT_MSG, sizeof(log_BidirDShot), \
+      "BDSH", "QBff", "TimeUS,Instance,RPM,ErrRate", "s#q%", "F-00" }, \
+    { LOG_ESC_TELEM_STATS_MSG, sizeof(log_ESCTelemStats), \
+      "ESCS", "QBHHHHH", "TimeUS,Instance,Good,Bad,NoReply,AgeMax,AgeAvg", "s#---ss", "F----CC" }, \
+    { LOG_BOOT_STAGE_MSG, sizeof(log_BootStage), \
+      "BOOT", "QBNII", "TimeUS,Stg,Name,Start,Dur", "s#-ss", "F--FF" }, \
     { LOG_SRTL_MSG, sizeof(log_SRTL), \
       "SRTL", "QBHHBfff", "TimeUS,Active,NumPts,MaxPts,Action,N,E,D", "s----mmm", "F----000" }, \
     { LOG_OA_BENDYRULER_MSG, sizeof(log_OABendyRuler), \
@@ -1502,7 +1756,7 @@ struct PACKED log_Arm_Disarm {
     { LOG_XKV2_MSG, sizeof(log_ekfStateVar), \
       "XKV2","Qffffffffffff","TimeUS,V12,V13,V14,V15,V16,V17,V18,V19,V20,V21,V22,V23", "s------------", "F------------" }, \
     { LOG_TERRAIN_MSG, sizeof(log_TERRAIN), \
-      "TERR","QBLLHffHH","TimeUS,Status,Lat,Lng,Spacing,TerrH,CHeight,Pending,Loaded", "s-DU-mm--", "F-GG-00--" }, \
+      "TERR","QBLLHffHHII","TimeUS,Status,Lat,Lng,Spacing,TerrH,CHeight,Pending,Loaded,CH,CM", "s-DU-mm----", "F-GG-00----" }, \
     { LOG_GPS_UBX1_MSG, sizeof(log_Ubx1), \
       "UBX1", "QBHBBHI",  "TimeUS,Instance,noisePerMS,jamInd,aPower,agcCnt,config", "s------", "F------"  }, \
     { LOG_GPS_UBX2_MSG, sizeof(log_Ubx2), \
@@ -1583,10 +1837,14 @@ struct PACKED log_Arm_Disarm {
       "ISBH",ISBH_FMT,ISBH_LABELS,ISBH_UNITS,ISBH_MULTS },  \
     { LOG_ISBD_MSG, sizeof(log_ISBD), \
       "ISBD",ISBD_FMT,ISBD_LABELS, ISBD_UNITS, ISBD_MULTS }, \
+    { LOG_ISBG_MSG, sizeof(log_ISBG), \
+      "ISBG",ISBG_FMT,ISBG_LABELS, ISBG_UNITS, ISBG_MULTS }, \
     { LOG_ORGN_MSG, sizeof(log_ORGN), \
       "ORGN","QBLLe","TimeUS,Type,Lat,Lng,Alt", "s-DUm", "F-GGB" },   \
     { LOG_DF_FILE_STATS, sizeof(log_DSF), \
       "DSF", "QIHIIII", "TimeUS,Dp,Blk,Bytes,FMn,FMx,FAv", "s--b---", "F--0---" }, \
+    { LOG_LOGGER_STATS_MSG, sizeof(log_LoggerStats), \
+      "LSTA", "QBBnIIII", "TimeUS,Bk,Id,Name,Dp,TDp,Bytes,BufMin", "s-----bb", "F-----00" }, \
     { LOG_RPM_MSG, sizeof(log_RPM), \
       "RPM",  "Qff", "TimeUS,rpm1,rpm2", "sqq", "F00" }, \
     { LOG_GIMBAL1_MSG, sizeof(log_Gimbal1), \
@@ -1600,7 +1858,7 @@ struct PACKED log_Arm_Disarm {
     { LOG_RALLY_MSG, sizeof(log_Rally), \
       "RALY", "QBBLLh", "TimeUS,Tot,Seq,Lat,Lng,Alt", "s--DUm", "F--GGB" },  \
     { LOG_MAV_MSG, sizeof(log_MAV),   \
-      "MAV", "QBHHH",   "TimeUS,chan,txp,rxp,rxdp", "s#---", "F-000" },   \
+      "MAV", "QBHHHIIIIHHHI",   "TimeUS,chan,txp,rxp,rxdp,fwd,fwdd,sgn,sgnT,ackL,prmL,txtL,rqd", "s#------ssss-", "F-000000FCCC0" },   \
     { LOG_VISUALODOM_MSG, sizeof(log_VisualOdom), \
       "VISO", "Qffffffff", "TimeUS,dt,AngDX,AngDY,AngDZ,PosDX,PosDY,PosDZ,conf", "ssrrrmmm-", "FF000000-" }, \
     { LOG_OPTFLOW_MSG, sizeof(log_Optflow), \
@@ -1670,6 +1928,17 @@ enum LogMessages : uint8_t {
     LOG_XKFD_MSG,
     LOG_XKV1_MSG,
     LOG_XKV2_MSG,
+    LOG_SCHED_TASK_MSG,
+    LOG_GYRO_FFT_MSG,
+    LOG_IMU_FIFO_MSG,
+    LOG_ISBG_MSG,
+    LOG_SAMPLE_JITTER_MSG,
+    LOG_DMA_STATS_MSG,
+    LOG_THREAD_STATS_MSG,
+    LOG_OUTPUT_LATENCY_MSG,
+    LOG_BIDIR_DSHOT_MSG,
+    LOG_BOOT_STAGE_MSG,
+    LOG_ESC_TELEM_STATS_MSG,
 
     LOG_FORMAT_MSG = 128, // this must remain #128
 
@@ -1786,6 +2055,7 @@ enum LogMessages : uint8_t {
     LOG_BEACON_MSG,
     LOG_PROXIMITY_MSG,
     LOG_DF_FILE_STATS,
+    LOG_LOGGER_STATS_MSG,
     LOG_SRTL_MSG,
     LOG_ISBH_MSG,
     LOG_ISBD_MSG,
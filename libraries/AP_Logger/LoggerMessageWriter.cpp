@@ -1,4 +1,5 @@
 #include "AP_Common/AP_FWVersion.h"
+#include "AP_Common/AP_BootTrace.h"
 #include "LoggerMessageWriter.h"
 
 #define FORCE_VERSION_H_INCLUDE
@@ -191,7 +192,7 @@ void LoggerMessageWriter_WriteSysInfo::process() {
         stage = Stage::RC_PROTOCOL;
         FALLTHROUGH;
 
-    case Stage::RC_PROTOCOL:
+    case Stage::RC_PROTOCOL: {
         const char *prot = hal.rcin->protocol();
         if (prot == nullptr) {
             prot = "None";
@@ -199,6 +200,33 @@ void LoggerMessageWriter_WriteSysInfo::process() {
         if (! _logger_backend->Write_MessageF("RC Protocol: %s", prot)) {
             return; // call me again
         }
+        boot_stage = 0;
+        stage = Stage::BOOT_TRACE;
+        FALLTHROUGH;
+    }
+
+    case Stage::BOOT_TRACE:
+        // how long each stage of the vehicle init took. If the log
+        // was started during init then wait for it to finish
+        if (AP_BootTrace::num_stages() > 0 && !AP_BootTrace::finished()) {
+            return; // call me again
+        }
+        AP_BootTrace::Stage s;
+        while (AP_BootTrace::get_stage(boot_stage, s)) {
+            struct log_BootStage pkt = {
+                LOG_PACKET_HEADER_INIT(LOG_BOOT_STAGE_MSG),
+                time_us     : AP_HAL::micros64(),
+                stage       : boot_stage,
+                name        : {},
+                start_us    : s.start_us,
+                duration_us : s.duration_us,
+            };
+            strncpy_noterm(pkt.name, s.name, sizeof(pkt.name));
+            if (!_logger_backend->WriteCriticalBlock(&pkt, sizeof(pkt))) {
+                return; // call me again
+            }
+            boot_stage++;
+        }
     }
 
     _finished = true;  // all done!
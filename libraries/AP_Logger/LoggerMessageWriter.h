@@ -32,9 +32,11 @@ private:
         GIT_VERSIONS,
         SYSTEM_ID,
         PARAM_SPACE_USED,
-        RC_PROTOCOL
+        RC_PROTOCOL,
+        BOOT_TRACE
     };
     Stage stage;
+    uint8_t boot_stage;
 };
 
 class LoggerMessageWriter_WriteEntireMission : public LoggerMessageWriter {
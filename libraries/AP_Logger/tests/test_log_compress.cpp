@@ -0,0 +1,143 @@
+#include <AP_gtest.h>
+
+#include <AP_Logger/AP_Logger.h>
+#include <AP_Logger/LogCompress.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+struct PACKED log_Test {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    int16_t value;
+};
+
+static const uint8_t LOG_TEST_MSG = 200;
+static const uint8_t LOG_TEST2_MSG = 201;
+
+// a log made of blocks of whole messages, like the file backend writes
+static uint16_t make_log(uint8_t *log, uint16_t size, uint16_t block_size, uint16_t *block_lens, uint8_t &nblocks)
+{
+    uint16_t len = 0;
+    uint16_t block_start = 0;
+    nblocks = 0;
+    uint32_t n = 0;
+    while (true) {
+        uint8_t msg[sizeof(log_Format)];
+        uint8_t msg_len;
+        if (n < 2) {
+            struct log_Format f {};
+            f.head1 = HEAD_BYTE1;
+            f.head2 = HEAD_BYTE2;
+            f.msgid = LOG_FORMAT_MSG;
+            f.type = n == 0 ? LOG_TEST_MSG : LOG_TEST2_MSG;
+            f.length = sizeof(log_Test) + (n == 0 ? 0 : 4);
+            memcpy(f.name, n == 0 ? "TEST" : "TST2", sizeof(f.name));
+            memcpy(msg, &f, sizeof(f));
+            msg_len = sizeof(f);
+        } else {
+            const bool second = (n % 3) == 0;
+            struct log_Test t {};
+            t.head1 = HEAD_BYTE1;
+            t.head2 = HEAD_BYTE2;
+            t.msgid = second ? LOG_TEST2_MSG : LOG_TEST_MSG;
+            t.time_us = 1000000ULL + n * 2500;
+            t.value = (int16_t)(n * 37 % 1000);
+            memcpy(msg, &t, sizeof(t));
+            msg_len = sizeof(t);
+            if (second) {
+                memset(&msg[msg_len], 0x5A, 4);
+                msg_len += 4;
+            }
+        }
+        if (len + msg_len > size) {
+            break;
+        }
+        if (len + msg_len - block_start > block_size) {
+            block_lens[nblocks++] = len - block_start;
+            block_start = len;
+        }
+        memcpy(&log[len], msg, msg_len);
+        len += msg_len;
+        n++;
+    }
+    block_lens[nblocks++] = len - block_start;
+    return len;
+}
+
+TEST(LogCompress, RoundTrip)
+{
+    static uint8_t log[32768];
+    static uint8_t work[4096];
+    static uint8_t out[32768];
+    static uint8_t frame[LOG_COMPRESS_MAX_FRAME(4096)];
+    static LogCompress enc, dec;
+    uint16_t block_lens[32];
+    uint8_t nblocks;
+    const uint16_t len = make_log(log, sizeof(log), sizeof(work), block_lens, nblocks);
+
+    enc.reset();
+    dec.reset();
+    uint32_t total = 0;
+    uint16_t ofs = 0;
+    for (uint8_t i = 0; i < nblocks; i++) {
+        memcpy(work, &log[ofs], block_lens[i]);
+        const uint16_t frame_len = enc.compress(work, block_lens[i], frame);
+        total += frame_len;
+
+        uint16_t raw_len, comp_len;
+        LogCompress::frame_lengths(frame, raw_len, comp_len);
+        EXPECT_EQ(block_lens[i], raw_len);
+        EXPECT_EQ(frame_len, comp_len + LOG_COMPRESS_FRAME_HEADER_LEN);
+        ASSERT_TRUE(dec.decompress(&frame[LOG_COMPRESS_FRAME_HEADER_LEN], comp_len, &out[ofs], raw_len));
+        ofs += raw_len;
+    }
+    EXPECT_EQ(len, ofs);
+    EXPECT_EQ(0, memcmp(log, out, len));
+    // the synthetic log is very regular, it should shrink a lot
+    EXPECT_LT(total, len / 3U);
+}
+
+TEST(LogCompress, Incompressible)
+{
+    static uint8_t block[1000];
+    static uint8_t copy[1000];
+    static uint8_t out[1000];
+    static uint8_t frame[LOG_COMPRESS_MAX_FRAME(1000)];
+    static LogCompress enc, dec;
+    uint32_t seed = 1;
+    for (uint16_t i = 0; i < sizeof(block); i++) {
+        seed = seed * 1103515245 + 12345;
+        block[i] = seed >> 16;
+    }
+    memcpy(copy, block, sizeof(block));
+    enc.reset();
+    dec.reset();
+    const uint16_t frame_len = enc.compress(block, sizeof(block), frame);
+    EXPECT_EQ(sizeof(block) + LOG_COMPRESS_FRAME_HEADER_LEN, frame_len);
+    ASSERT_TRUE(dec.decompress(&frame[LOG_COMPRESS_FRAME_HEADER_LEN], sizeof(block), out, sizeof(out)));
+    EXPECT_EQ(0, memcmp(copy, out, sizeof(out)));
+}
+
+TEST(LogCompress, Corrupt)
+{
+    static uint8_t block[4096];
+    static uint8_t out[4096];
+    static uint8_t frame[LOG_COMPRESS_MAX_FRAME(4096)];
+    static LogCompress enc, dec;
+    memset(block, 0x11, sizeof(block));
+    enc.reset();
+    dec.reset();
+    const uint16_t frame_len = enc.compress(block, sizeof(block), frame);
+    ASSERT_LT(frame_len, 100);
+    // a truncated frame must be rejected rather than overrun
+    EXPECT_FALSE(dec.decompress(&frame[LOG_COMPRESS_FRAME_HEADER_LEN], frame_len - LOG_COMPRESS_FRAME_HEADER_LEN - 1, out, sizeof(out)));
+    EXPECT_FALSE(dec.decompress(&frame[LOG_COMPRESS_FRAME_HEADER_LEN], frame_len - LOG_COMPRESS_FRAME_HEADER_LEN, out, sizeof(out) - 1));
+
+    uint8_t hdr[LOG_COMPRESS_FILE_HEADER_LEN];
+    LogCompress::file_header(hdr);
+    EXPECT_TRUE(LogCompress::is_compressed(hdr));
+    const uint8_t plain[LOG_COMPRESS_FILE_HEADER_LEN] { HEAD_BYTE1, HEAD_BYTE2, LOG_FORMAT_MSG };
+    EXPECT_FALSE(LogCompress::is_compressed(plain));
+}
+
+AP_GTEST_MAIN()
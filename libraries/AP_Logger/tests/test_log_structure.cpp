@@ -0,0 +1,46 @@
+#include <AP_gtest.h>
+
+#include <AP_Logger/AP_Logger.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static_assert(log_format_length("QffB") == LOG_PACKET_HEADER_LEN + 8 + 4 + 4 + 1, "bad format length");
+static_assert(log_format_offset("QffB", 2) == LOG_PACKET_HEADER_LEN + 12, "bad field offset");
+
+TEST(LogStructure, Format)
+{
+    EXPECT_EQ(sizeof(struct log_Format), log_format_length("BBnNZ"));
+    EXPECT_EQ(LOG_PACKET_HEADER_LEN, log_format_length(""));
+    EXPECT_EQ(0U, log_format_field_size('x'));
+    EXPECT_TRUE(log_format_valid("QBIHhiafdnNZcCeELMqb"));
+    EXPECT_FALSE(log_format_valid("QBx"));
+}
+
+TEST(LogStructure, Valid)
+{
+    const struct LogStructure good {
+        LOG_FORMAT_MSG, sizeof(log_Format), "FMT", "BBnNZ", "Type,Length,Name,Format,Columns", "-b---", "-----"
+    };
+    EXPECT_TRUE(log_structure_valid(good));
+
+    struct LogStructure s = good;
+    s.msg_len++;
+    EXPECT_FALSE(log_structure_valid(s));
+    s = good;
+    s.labels = "Type,Length,Name,Format";
+    EXPECT_FALSE(log_structure_valid(s));
+    s = good;
+    s.units = "-b--";
+    EXPECT_FALSE(log_structure_valid(s));
+    s = good;
+    s.multipliers = "------";
+    EXPECT_FALSE(log_structure_valid(s));
+    s = good;
+    s.name = "NAMES";
+    EXPECT_FALSE(log_structure_valid(s));
+    s = good;
+    s.format = "BBnNy";
+    EXPECT_FALSE(log_structure_valid(s));
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,97 @@
+#include <AP_gtest.h>
+
+#include <AP_Logger/AP_Logger_RateLimiter.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// write a message of msg_type every period_ms for duration_ms, one
+// scheduler tick per write, returning how many were let through
+static uint32_t run(AP_Logger_RateLimiter &limiter, uint8_t msg_type, uint32_t period_ms, uint32_t duration_ms, uint32_t start_ms=1000)
+{
+    uint32_t count = 0;
+    uint16_t tick = 0;
+    for (uint32_t i=0; i<duration_ms/period_ms; i++) {
+        if (limiter.should_log(msg_type, start_ms + i*period_ms, tick++)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+TEST(AP_Logger_RateLimiter, Rates)
+{
+    AP_Float rate_max;
+    rate_max.set(25);
+    AP_Logger_RateLimiter *limiter = new AP_Logger_RateLimiter(rate_max);
+    EXPECT_TRUE(limiter->add_rate("ATT", 0));
+    EXPECT_TRUE(limiter->add_rate("RCOU", 10));
+    EXPECT_FALSE(limiter->add_rate("TOOLONG", 10));
+    EXPECT_EQ(2, limiter->num_rates());
+
+    const uint8_t imu = 1, att = 2, rcou = 3, unnamed = 4;
+    EXPECT_TRUE(limiter->needs_resolve(imu));
+    limiter->resolve(imu, "IMU");
+    limiter->resolve(att, "ATT");
+    limiter->resolve(rcou, "RCOU");
+    limiter->resolve(unnamed, nullptr);
+    EXPECT_FALSE(limiter->needs_resolve(imu));
+
+    // 400Hz IMU limited to LOG_RATE_MAX
+    EXPECT_EQ(250U, run(*limiter, imu, 2, 10000));
+    // unlimited
+    EXPECT_EQ(2500U, run(*limiter, att, 4, 10000));
+    // 50Hz to 10Hz, and 30Hz to 25Hz which isn't a whole divisor
+    EXPECT_EQ(100U, run(*limiter, rcou, 20, 10000));
+    EXPECT_NEAR(250U, run(*limiter, unnamed, 33, 10000), 2);
+
+    EXPECT_EQ(5000U - 250U, limiter->num_suppressed(imu));
+    EXPECT_EQ(0U, limiter->num_suppressed(att));
+    EXPECT_EQ(uint32_t(limiter->num_suppressed(imu) + limiter->num_suppressed(rcou) + limiter->num_suppressed(unnamed)),
+              limiter->num_suppressed());
+
+    // changing LOG_RATE_MAX resolves all types again
+    rate_max.set(0);
+    EXPECT_TRUE(limiter->needs_resolve(imu));
+    limiter->resolve(imu, "IMU");
+    EXPECT_EQ(5000U, run(*limiter, imu, 2, 10000, 20000));
+
+    delete limiter;
+}
+
+TEST(AP_Logger_RateLimiter, Instances)
+{
+    AP_Float rate_max;
+    rate_max.set(10);
+    AP_Logger_RateLimiter *limiter = new AP_Logger_RateLimiter(rate_max);
+    limiter->resolve(7, "BAT");
+
+    // three instances written each tick at 50Hz all get through together
+    uint32_t count = 0;
+    uint16_t tick = 0;
+    for (uint32_t t=0; t<1000; t+=20, tick++) {
+        for (uint8_t i=0; i<3; i++) {
+            if (limiter->should_log(7, t, tick)) {
+                count++;
+            }
+        }
+    }
+    EXPECT_EQ(30U, count);
+
+    delete limiter;
+}
+
+TEST(AP_Logger_RateLimiter, TimerWrap)
+{
+    AP_Float rate_max;
+    rate_max.set(20);
+    AP_Logger_RateLimiter *limiter = new AP_Logger_RateLimiter(rate_max);
+    limiter->resolve(9, "GPS");
+    EXPECT_EQ(200U, run(*limiter, 9, 10, 10000, 0xFFFFFFFFU - 5000));
+
+    // a long gap lets the next message straight through
+    EXPECT_TRUE(limiter->should_log(9, 500000, 1));
+
+    delete limiter;
+}
+
+AP_GTEST_MAIN()
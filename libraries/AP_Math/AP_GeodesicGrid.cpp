@@ -108,15 +108,18 @@
 /* This was generated with
  * libraries/AP_Math/tools/geodesic_grid/geodesic_grid.py */
 const struct AP_GeodesicGrid::neighbor_umbrella
-AP_GeodesicGrid::_neighbor_umbrellas[3]{
+AP_GeodesicGrid::_neighbor_umbrellas[6]{
     {{ 9,  8,  7, 12, 14}, 1, 2, 0, 0, 2},
     {{ 1,  2,  4,  5,  3}, 0, 0, 2, 2, 0},
     {{16, 15, 13, 18, 17}, 2, 2, 0, 2, 1},
+    {{19, 18, 17,  2,  4}, 1, 2, 0, 0, 2},
+    {{11, 12, 14, 15, 13}, 0, 0, 2, 2, 0},
+    {{ 6,  5,  3,  8,  7}, 2, 2, 0, 2, 1},
 };
 
 /* This was generated with
  * libraries/AP_Math/tools/geodesic_grid/geodesic_grid.py */
-const Matrix3f AP_GeodesicGrid::_inverses[10]{
+const Matrix3f AP_GeodesicGrid::_inverses[20]{
     {{-0.309017f,  0.500000f,  0.190983f},
      { 0.000000f,  0.000000f, -0.618034f},
      {-0.309017f, -0.500000f,  0.190983f}},
@@ -147,51 +150,54 @@ const Matrix3f AP_GeodesicGrid::_inverses[10]{
     {{ 0.309017f,  0.500000f, -0.190983f},
      {-0.500000f,  0.190983f,  0.309017f},
      {-0.190983f, -0.309017f, -0.500000f}},
-};
-
-/* This was generated with
- * libraries/AP_Math/tools/geodesic_grid/geodesic_grid.py */
-const Matrix3f AP_GeodesicGrid::_mid_inverses[10]{
-    {{-0.000000f,  1.000000f, -0.618034f},
-     { 0.000000f, -1.000000f, -0.618034f},
-     {-0.618034f,  0.000000f,  1.000000f}},
-    {{-1.000000f,  0.618034f, -0.000000f},
-     {-0.000000f, -1.000000f,  0.618034f},
-     { 0.618034f, -0.000000f, -1.000000f}},
-    {{-0.618034f, -0.000000f, -1.000000f},
-     { 1.000000f, -0.618034f, -0.000000f},
-     {-0.618034f,  0.000000f,  1.000000f}},
-    {{-1.000000f, -0.618034f, -0.000000f},
-     { 1.000000f, -0.618034f,  0.000000f},
-     {-0.000000f,  1.000000f, -0.618034f}},
-    {{-1.000000f, -0.618034f,  0.000000f},
-     { 0.618034f,  0.000000f,  1.000000f},
-     { 0.618034f,  0.000000f, -1.000000f}},
-    {{-0.618034f, -0.000000f, -1.000000f},
-     { 1.000000f,  0.618034f, -0.000000f},
-     { 0.000000f, -1.000000f,  0.618034f}},
-    {{ 0.000000f, -1.000000f, -0.618034f},
-     { 0.000000f,  1.000000f, -0.618034f},
-     { 0.618034f, -0.000000f,  1.000000f}},
-    {{ 1.000000f, -0.618034f, -0.000000f},
-     { 0.000000f,  1.000000f,  0.618034f},
-     {-0.618034f,  0.000000f, -1.000000f}},
-    {{ 1.000000f,  0.618034f, -0.000000f},
-     {-1.000000f,  0.618034f,  0.000000f},
-     { 0.000000f, -1.000000f, -0.618034f}},
-    {{-0.000000f,  1.000000f,  0.618034f},
-     {-1.000000f, -0.618034f, -0.000000f},
-     { 0.618034f,  0.000000f, -1.000000f}},
+    {{ 0.309017f, -0.500000f, -0.190983f},
+     {-0.000000f, -0.000000f,  0.618034f},
+     { 0.309017f,  0.500000f, -0.190983f}},
+    {{ 0.190983f, -0.309017f,  0.500000f},
+     { 0.500000f,  0.190983f, -0.309017f},
+     {-0.309017f,  0.500000f,  0.190983f}},
+    {{ 0.618034f, -0.000000f, -0.000000f},
+     {-0.190983f,  0.309017f,  0.500000f},
+     {-0.190983f,  0.309017f, -0.500000f}},
+    {{ 0.500000f, -0.190983f,  0.309017f},
+     {-0.000000f,  0.618034f, -0.000000f},
+     {-0.500000f, -0.190983f,  0.309017f}},
+    {{ 0.190983f,  0.309017f,  0.500000f},
+     { 0.190983f,  0.309017f, -0.500000f},
+     {-0.618034f, -0.000000f, -0.000000f}},
+    {{ 0.309017f,  0.500000f,  0.190983f},
+     {-0.190983f, -0.309017f,  0.500000f},
+     {-0.500000f,  0.190983f, -0.309017f}},
+    {{-0.309017f,  0.500000f, -0.190983f},
+     {-0.000000f, -0.000000f,  0.618034f},
+     {-0.309017f, -0.500000f, -0.190983f}},
+    {{-0.190983f,  0.309017f,  0.500000f},
+     {-0.500000f, -0.190983f, -0.309017f},
+     { 0.309017f, -0.500000f,  0.190983f}},
+    {{-0.500000f,  0.190983f,  0.309017f},
+     {-0.000000f, -0.618034f, -0.000000f},
+     { 0.500000f,  0.190983f,  0.309017f}},
+    {{-0.309017f, -0.500000f,  0.190983f},
+     { 0.500000f, -0.190983f, -0.309017f},
+     { 0.190983f,  0.309017f,  0.500000f}},
 };
 
 int AP_GeodesicGrid::section(const Vector3f &v, bool inclusive)
 {
-    int i = _triangle_index(v, inclusive);
+    Vector3f w;
+    int i = _triangle_index(v, inclusive, &w);
     if (i < 0) {
         return -1;
     }
 
-    int j = _subtriangle_index(i, v, inclusive);
+    /* Most of the time the triangle search already knows the coordinates of
+     * v with respect to the triangle found, so only do the change of basis
+     * when it didn't. */
+    if (w.is_zero()) {
+        w = _inverses[i] * v;
+    }
+
+    int j = _subtriangle_index(w, inclusive);
     if (j < 0) {
         return -1;
     }
@@ -201,16 +207,14 @@ int AP_GeodesicGrid::section(const Vector3f &v, bool inclusive)
 
 int AP_GeodesicGrid::_neighbor_umbrella_component(int idx, int comp_idx)
 {
-    if (idx < 3) {
-        return _neighbor_umbrellas[idx].components[comp_idx];
-    }
-    return (_neighbor_umbrellas[idx % 3].components[comp_idx] + 10) % 20;
+    return _neighbor_umbrellas[idx].components[comp_idx];
 }
 
 int AP_GeodesicGrid::_from_neighbor_umbrella(int idx,
                                              const Vector3f &v,
                                              const Vector3f &u,
-                                             bool inclusive)
+                                             bool inclusive,
+                                             Vector3f *coords)
 {
     /* The following comparisons between the umbrella's first and second
      * vertices' coefficients work for this algorithm because all vertices'
@@ -221,15 +225,15 @@ int AP_GeodesicGrid::_from_neighbor_umbrella(int idx,
          * v crosses the first component or the edge formed by the umbrella's
          * pivot and forth vertex. */
         int comp = _neighbor_umbrella_component(idx, 0);
-        auto w = _inverses[comp % 10] * v;
-        if (comp > 9) {
-            w = -w;
-        }
-        float x0 = w[_neighbor_umbrellas[idx % 3].v0_c0];
+        auto w = _inverses[comp] * v;
+        float x0 = w[_neighbor_umbrellas[idx].v0_c0];
         if (is_zero(x0)) {
             if (!inclusive) {
                 return -1;
             }
+            if (coords) {
+                *coords = w;
+            }
             return comp;
         } else if (x0 < 0) {
             if (!inclusive) {
@@ -238,6 +242,9 @@ int AP_GeodesicGrid::_from_neighbor_umbrella(int idx,
             return _neighbor_umbrella_component(idx, u.x < u.y ? 3 : 2);
         }
 
+        if (coords) {
+            *coords = w;
+        }
         return comp;
     }
 
@@ -245,12 +252,9 @@ int AP_GeodesicGrid::_from_neighbor_umbrella(int idx,
         /* If the coefficient of the second vertex is greater than the first
          * one's, then v crosses the first, second or third component. */
         int comp = _neighbor_umbrella_component(idx, 1);
-        auto w = _inverses[comp % 10] * v;
-        if (comp > 9) {
-            w = -w;
-        }
-        float x1 = w[_neighbor_umbrellas[idx % 3].v1_c1];
-        float x2 = w[_neighbor_umbrellas[idx % 3].v2_c1];
+        auto w = _inverses[comp] * v;
+        float x1 = w[_neighbor_umbrellas[idx].v1_c1];
+        float x2 = w[_neighbor_umbrellas[idx].v2_c1];
 
         if (is_zero(x1)) {
             if (!inclusive) {
@@ -270,17 +274,17 @@ int AP_GeodesicGrid::_from_neighbor_umbrella(int idx,
             return _neighbor_umbrella_component(idx, 0);
         }
 
+        if (coords) {
+            *coords = w;
+        }
         return comp;
     } else {
         /* If the coefficient of the second vertex is lesser than the first
          * one's, then v crosses the first, fourth or fifth component. */
         int comp = _neighbor_umbrella_component(idx, 4);
-        auto w = _inverses[comp % 10] * v;
-        if (comp > 9) {
-            w = -w;
-        }
-        float x4 = w[_neighbor_umbrellas[idx % 3].v4_c4];
-        float x0 = w[_neighbor_umbrellas[idx % 3].v0_c4];
+        auto w = _inverses[comp] * v;
+        float x4 = w[_neighbor_umbrellas[idx].v4_c4];
+        float x0 = w[_neighbor_umbrellas[idx].v0_c4];
 
         if (is_zero(x4)) {
             if (!inclusive) {
@@ -300,15 +304,23 @@ int AP_GeodesicGrid::_from_neighbor_umbrella(int idx,
             return _neighbor_umbrella_component(idx, 3);
         }
 
+        if (coords) {
+            *coords = w;
+        }
         return comp;
     }
 }
 
-int AP_GeodesicGrid::_triangle_index(const Vector3f &v, bool inclusive)
+int AP_GeodesicGrid::_triangle_index(const Vector3f &v,
+                                     bool inclusive,
+                                     Vector3f *coords)
 {
     /* w holds the coordinates of v with respect to the basis comprised by the
      * vectors of T_i */
     auto w = _inverses[0] * v;
+    if (coords) {
+        coords->zero();
+    }
     int zero_count = 0;
     int balance = 0;
     int umbrella = -1;
@@ -340,10 +352,16 @@ int AP_GeodesicGrid::_triangle_index(const Vector3f &v, bool inclusive)
     switch (balance) {
     case 3:
         /* All coefficients are positive, thus return the first triangle. */
+        if (coords) {
+            *coords = w;
+        }
         return 0;
     case -3:
         /* All coefficients are negative, which means that the coefficients for
          * -w are positive, thus return the first triangle's opposite. */
+        if (coords) {
+            *coords = -w;
+        }
         return 10;
     case 2:
         /* Two coefficients are positive and one is zero, thus v crosses one of
@@ -434,19 +452,26 @@ int AP_GeodesicGrid::_triangle_index(const Vector3f &v, bool inclusive)
         break;
     }
 
-    return _from_neighbor_umbrella(umbrella, v, w, inclusive);
+    return _from_neighbor_umbrella(umbrella, v, w, inclusive, coords);
 }
 
 int AP_GeodesicGrid::_subtriangle_index(const unsigned int triangle_index,
                                         const Vector3f &v,
                                         bool inclusive)
 {
-    /* w holds the coordinates of v with respect to the basis comprised by the
-     * vectors of the middle triangle of T_i where i is triangle_index */
-    auto w = _mid_inverses[triangle_index % 10] * v;
-    if (triangle_index > 9) {
-        w = -w;
-    }
+    return _subtriangle_index(_inverses[triangle_index] * v, inclusive);
+}
+
+int AP_GeodesicGrid::_subtriangle_index(const Vector3f &coords, bool inclusive)
+{
+    /* Let T_i = (a, b, c) and v = x * a + y * b + z * c. The middle triangle
+     * is (ma, mb, mc), with ma = (a + b) / 2, mb = (b + c) / 2 and
+     * mc = (c + a) / 2, so a = ma - mb + mc, b = ma + mb - mc and
+     * c = -ma + mb + mc. Substituting those gives the coordinates of v with
+     * respect to the middle triangle using only additions. */
+    Vector3f w(coords.x + coords.y - coords.z,
+               coords.y + coords.z - coords.x,
+               coords.z + coords.x - coords.y);
 
     if ((is_zero(w.x) || is_zero(w.y) || is_zero(w.z)) && !inclusive) {
         return -1;
@@ -166,17 +166,15 @@ private:
      * triangles.
      *
      * The i-th matrix is the inverse of the change-of-basis matrix from
-     * natural basis to the basis formed by T_i's vectors.
-     */
-    static const Matrix3f _inverses[10];
-
-    /**
-     * The inverses of the change-of-basis matrices for the middle triangles.
+     * natural basis to the basis formed by T_i's vectors. The matrices for
+     * T_10 to T_19 are just the negated matrices for their opposites, but are
+     * stored so that lookups don't need to branch on the triangle index.
      *
-     * The i-th matrix is the inverse of the change-of-basis matrix from
-     * natural basis to the basis formed by T_i's middle triangle's vectors.
+     * The coordinates with respect to the middle triangles are derived from
+     * the coordinates with respect to the icosahedron triangles, so no
+     * matrices are stored for them.
      */
-    static const Matrix3f _mid_inverses[10];
+    static const Matrix3f _inverses[20];
 
     /**
      * The representation of the neighbor umbrellas of T_0.
@@ -193,7 +191,9 @@ private:
      *  - index 4 represents the neighbor of T_10 with respect to (-b, -c).
      *  - index 5 represents the neighbor of T_10 with respect to (-c, -a).
      *
-     * Those indexes are mapped to this array with index % 3.
+     * The last three entries are the same as the first three ones with the
+     * components replaced by their opposites. They are stored so that finding
+     * a component is a plain lookup.
      *
      * The edges are represented with pairs because the order of the vertices
      * matters to the order the triangles' indexes are defined - the order of
@@ -205,9 +205,8 @@ private:
          * The umbrella's components. The value of #components[i] is the
          * icosahedron triangle index of the i-th component.
          *
-         * In order to find the components for T_10, the following just finding
-         * the index of the opposite triangle is enough. In other words,
-         * (#components[i] + 10) % 20.
+         * The components for T_10 are the opposites of the ones for T_0. In
+         * other words, (#components[i] + 10) % 20.
          */
         uint8_t components[5];
         /**
@@ -216,14 +215,14 @@ private:
          * triangle pointed by #components[j], that matches the umbrella's i-th
          * vertex.
          *
-         * The values don't change for T_10.
+         * The values are the same for T_0 and T_10.
          */
         uint8_t v0_c0;
         uint8_t v1_c1;
         uint8_t v2_c1;
         uint8_t v4_c4;
         uint8_t v0_c4;
-    } _neighbor_umbrellas[3];
+    } _neighbor_umbrellas[6];
 
     /**
      * Get the component_index-th component of the umbrella_index-th neighbor
@@ -252,6 +251,10 @@ private:
      * @param inclusive[in] This parameter follows the same rules defined in
      * #section() const.
      *
+     * @param coords[out] If not null and the coordinates of \p v with respect
+     * to the triangle found were calculated, they are written here. Otherwise
+     * it's left untouched.
+     *
      * @return The index of the icosahedron triangle. The value -1 is returned
      * if \p v is the null vector or the triangle isn't found, which might
      * happen when \p inclusive is false.
@@ -259,7 +262,8 @@ private:
     static int _from_neighbor_umbrella(int umbrella_index,
                                        const Vector3f &v,
                                        const Vector3f &u,
-                                       bool inclusive);
+                                       bool inclusive,
+                                       Vector3f *coords = nullptr);
 
     /**
      * Find which icosahedron's triangle is crossed by \p v.
@@ -269,10 +273,17 @@ private:
      * @param inclusive[in] This parameter follow the same rules defined in
      * #section() const.
      *
+     * @param coords[out] If not null, the coordinates of \p v with respect to
+     * the basis formed by the triangle's vectors are written here when they
+     * were calculated as part of the search. Otherwise the null vector is
+     * written, since that is never a valid coordinate for a crossing vector.
+     *
      * @return The index of the triangle. The value -1 is returned if the
      * triangle isn't found, which might happen when \p inclusive is false.
      */
-    static int _triangle_index(const Vector3f &v, bool inclusive);
+    static int _triangle_index(const Vector3f &v,
+                               bool inclusive,
+                               Vector3f *coords = nullptr);
 
     /**
      * Find which sub-triangle of the icosahedron's triangle pointed by \p
@@ -295,4 +306,19 @@ private:
     static int _subtriangle_index(const unsigned int triangle_index,
                                   const Vector3f &v,
                                   bool inclusive);
+
+    /**
+     * Same as _subtriangle_index() above, but taking the coordinates of the
+     * vector with respect to the basis formed by the icosahedron triangle's
+     * vectors instead of the triangle index and the vector.
+     *
+     * @param coords[in] The coordinates of the vector to be verified.
+     *
+     * @param inclusive[in] This parameter follow the same rules defined in
+     * #section() const.
+     *
+     * @return The index of the sub-triangle. The value -1 is returned if the
+     * triangle isn't found, which might happen when \p inclusive is false.
+     */
+    static int _subtriangle_index(const Vector3f &coords, bool inclusive);
 };
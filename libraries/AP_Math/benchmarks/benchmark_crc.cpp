@@ -0,0 +1,58 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+#define MAX_LEN 4096
+
+static uint8_t data[MAX_LEN];
+
+static void setup_data(void)
+{
+    for (uint16_t i = 0; i < MAX_LEN; i++) {
+        data[i] = i * 37 + 11;
+    }
+}
+
+static void BM_CRC32(benchmark::State& state)
+{
+    const uint32_t len = state.range_x();
+    setup_data();
+
+    while (state.KeepRunning()) {
+        uint32_t crc = crc_crc32(0, data, len);
+        gbenchmark_escape(&crc);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * len);
+}
+
+static void BM_CRC16CCITT(benchmark::State& state)
+{
+    const uint32_t len = state.range_x();
+    setup_data();
+
+    while (state.KeepRunning()) {
+        uint16_t crc = crc16_ccitt(data, len, 0);
+        gbenchmark_escape(&crc);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * len);
+}
+
+/* Benchmark from a short protocol packet up to a log block */
+BENCHMARK(BM_CRC32)->Arg(8)->Arg(64)->Arg(239)->Arg(MAX_LEN);
+BENCHMARK(BM_CRC16CCITT)->Arg(8)->Arg(64)->Arg(239)->Arg(MAX_LEN);
+
+BENCHMARK_MAIN()
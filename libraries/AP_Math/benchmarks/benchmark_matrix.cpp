@@ -1,6 +1,7 @@
 #include <AP_gbenchmark.h>
 
 #include <AP_Math/AP_Math.h>
+#include <AP_Math/vector_kernels.h>
 
 static void BM_MatrixMultiplication(benchmark::State& state)
 {
@@ -19,4 +20,114 @@ static void BM_MatrixMultiplication(benchmark::State& state)
 
 BENCHMARK(BM_MatrixMultiplication);
 
+/*
+  the N dimensional kernels at the size of the EKF covariance, with the
+  scalar reference first and then the version selected for this board
+ */
+static const uint8_t KN = 24;
+
+static void fill_matrix(float *m, uint16_t n, float seed)
+{
+    for (uint16_t i = 0; i < n; i++) {
+        m[i] = seed + 0.01f * i;
+    }
+}
+
+static void BM_KernelSub24Scalar(benchmark::State& state)
+{
+    float P[KN*KN], KHP[KN*KN];
+    fill_matrix(P, KN*KN, 1.0f);
+    fill_matrix(KHP, KN*KN, 0.0f);
+    while (state.KeepRunning()) {
+        kernel_sub_scalar(P, KHP, KN*KN);
+        gbenchmark_escape(P);
+    }
+}
+
+static void BM_KernelSub24(benchmark::State& state)
+{
+    float P[KN*KN], KHP[KN*KN];
+    fill_matrix(P, KN*KN, 1.0f);
+    fill_matrix(KHP, KN*KN, 0.0f);
+    while (state.KeepRunning()) {
+        kernel_sub(P, KHP, KN*KN);
+        gbenchmark_escape(P);
+    }
+}
+
+static void BM_KernelOuter24Scalar(benchmark::State& state)
+{
+    float a[KN], b[KN], C[KN*KN];
+    fill_matrix(a, KN, 1.0f);
+    fill_matrix(b, KN, 2.0f);
+    while (state.KeepRunning()) {
+        kernel_outer_scalar(C, a, b, KN, KN);
+        gbenchmark_escape(C);
+    }
+}
+
+static void BM_KernelOuter24(benchmark::State& state)
+{
+    float a[KN], b[KN], C[KN*KN];
+    fill_matrix(a, KN, 1.0f);
+    fill_matrix(b, KN, 2.0f);
+    while (state.KeepRunning()) {
+        kernel_outer(C, a, b, KN, KN);
+        gbenchmark_escape(C);
+    }
+}
+
+static void BM_KernelMatMul24Scalar(benchmark::State& state)
+{
+    float A[KN*KN], B[KN*KN], C[KN*KN];
+    fill_matrix(A, KN*KN, 1.0f);
+    fill_matrix(B, KN*KN, 2.0f);
+    while (state.KeepRunning()) {
+        kernel_mat_mul_scalar(C, A, B, KN, KN, KN);
+        gbenchmark_escape(C);
+    }
+}
+
+static void BM_KernelMatMul24(benchmark::State& state)
+{
+    float A[KN*KN], B[KN*KN], C[KN*KN];
+    fill_matrix(A, KN*KN, 1.0f);
+    fill_matrix(B, KN*KN, 2.0f);
+    while (state.KeepRunning()) {
+        kernel_mat_mul(C, A, B, KN, KN, KN);
+        gbenchmark_escape(C);
+    }
+}
+
+static void BM_KernelMatMulTransA24Scalar(benchmark::State& state)
+{
+    float A[KN*KN], B[KN*KN], C[KN*KN];
+    fill_matrix(A, KN*KN, 1.0f);
+    fill_matrix(B, KN*KN, 2.0f);
+    while (state.KeepRunning()) {
+        kernel_mat_mul_transA_scalar(C, A, B, KN, KN, KN);
+        gbenchmark_escape(C);
+    }
+}
+
+static void BM_KernelMatMulTransA24(benchmark::State& state)
+{
+    float A[KN*KN], B[KN*KN], C[KN*KN];
+    fill_matrix(A, KN*KN, 1.0f);
+    fill_matrix(B, KN*KN, 2.0f);
+    while (state.KeepRunning()) {
+        kernel_mat_mul_transA(C, A, B, KN, KN, KN);
+        gbenchmark_escape(C);
+    }
+}
+
+BENCHMARK(BM_KernelSub24Scalar);
+BENCHMARK(BM_KernelSub24);
+BENCHMARK(BM_KernelOuter24Scalar);
+BENCHMARK(BM_KernelOuter24);
+BENCHMARK(BM_KernelMatMul24Scalar);
+BENCHMARK(BM_KernelMatMul24);
+BENCHMARK(BM_KernelMatMulTransA24Scalar);
+BENCHMARK(BM_KernelMatMulTransA24);
+
 BENCHMARK_MAIN()
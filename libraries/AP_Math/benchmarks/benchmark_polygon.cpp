@@ -0,0 +1,96 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+#define MAX_POINTS 256
+#define NUM_TEST_POINTS 64
+
+static Vector2f polygon[MAX_POINTS];
+static Vector2f test_points[NUM_TEST_POINTS];
+
+// star shaped polygon with n points alternating between two radii and
+// test points spread across its bounding box
+static void setup_polygon(uint16_t n)
+{
+    for (uint16_t i = 0; i < n; i++) {
+        const float radius = (i % 2) ? 1000.0f : 1500.0f;
+        polygon[i] = Vector2f{radius * cosf(M_2PI * i / n), radius * sinf(M_2PI * i / n)};
+    }
+    for (uint16_t i = 0; i < NUM_TEST_POINTS; i++) {
+        test_points[i] = Vector2f{(i % 8) * 400.0f - 1500.0f, (i / 8) * 400.0f - 1500.0f};
+    }
+}
+
+static void BM_PolygonOutside(benchmark::State& state)
+{
+    const uint16_t n = state.range_x();
+    setup_polygon(n);
+    uint16_t i = 0;
+
+    while (state.KeepRunning()) {
+        bool outside = Polygon_outside(test_points[i++ % NUM_TEST_POINTS], polygon, n);
+        gbenchmark_escape(&outside);
+    }
+}
+
+static void BM_PolygonIndexOutside(benchmark::State& state)
+{
+    const uint16_t n = state.range_x();
+    setup_polygon(n);
+    Polygon_index index;
+    index.init(polygon, n);
+    uint16_t i = 0;
+
+    while (state.KeepRunning()) {
+        bool outside = index.outside(test_points[i++ % NUM_TEST_POINTS]);
+        gbenchmark_escape(&outside);
+    }
+}
+
+static void BM_PolygonClosestDistance(benchmark::State& state)
+{
+    const uint16_t n = state.range_x();
+    setup_polygon(n);
+    uint16_t i = 0;
+
+    while (state.KeepRunning()) {
+        float dist = Polygon_closest_distance_point(polygon, n, test_points[i++ % NUM_TEST_POINTS]);
+        gbenchmark_escape(&dist);
+    }
+}
+
+static void BM_PolygonIndexClosestDistance(benchmark::State& state)
+{
+    const uint16_t n = state.range_x();
+    setup_polygon(n);
+    Polygon_index index;
+    index.init(polygon, n);
+    uint16_t i = 0;
+
+    while (state.KeepRunning()) {
+        float dist = index.closest_distance_point(test_points[i++ % NUM_TEST_POINTS]);
+        gbenchmark_escape(&dist);
+    }
+}
+
+/* Benchmark polygons with 8 to 256 points */
+BENCHMARK(BM_PolygonOutside)->Arg(8)->Arg(32)->Arg(128)->Arg(MAX_POINTS);
+BENCHMARK(BM_PolygonIndexOutside)->Arg(8)->Arg(32)->Arg(128)->Arg(MAX_POINTS);
+BENCHMARK(BM_PolygonClosestDistance)->Arg(8)->Arg(32)->Arg(128)->Arg(MAX_POINTS);
+BENCHMARK(BM_PolygonIndexClosestDistance)->Arg(8)->Arg(32)->Arg(128)->Arg(MAX_POINTS);
+
+BENCHMARK_MAIN()
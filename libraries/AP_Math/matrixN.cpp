@@ -5,28 +5,21 @@
 #pragma GCC optimize("O2")
 
 #include "matrixN.h"
+#include "vector_kernels.h"
 
 
 // multiply two vectors to give a matrix, in-place
 template <typename T, uint8_t N>
 void MatrixN<T,N>::mult(const VectorN<T,N> &A, const VectorN<T,N> &B)
 {
-    for (uint8_t i = 0; i < N; i++) {
-        for (uint8_t j = 0; j < N; j++) {
-            v[i][j] = A[i] * B[j];
-        }
-    }
+    kernel_outer(&v[0][0], &A[0], &B[0], N, N);
 }
 
 // subtract B from the matrix
 template <typename T, uint8_t N>
 MatrixN<T,N> &MatrixN<T,N>::operator -=(const MatrixN<T,N> &B)
 {
-    for (uint8_t i = 0; i < N; i++) {
-        for (uint8_t j = 0; j < N; j++) {
-            v[i][j] -= B.v[i][j];
-        }
-    }
+    kernel_sub(&v[0][0], &B.v[0][0], N*N);
     return *this;
 }
 
@@ -34,11 +27,7 @@ MatrixN<T,N> &MatrixN<T,N>::operator -=(const MatrixN<T,N> &B)
 template <typename T, uint8_t N>
 MatrixN<T,N> &MatrixN<T,N>::operator +=(const MatrixN<T,N> &B)
 {
-    for (uint8_t i = 0; i < N; i++) {
-        for (uint8_t j = 0; j < N; j++) {
-            v[i][j] += B.v[i][j];
-        }
-    }
+    kernel_axpy(&v[0][0], &B.v[0][0], 1, N*N);
     return *this;
 }
 
@@ -0,0 +1,160 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  N dimensional symmetric matrix stored as a packed upper triangle
+
+  Only the N*(N+1)/2 elements on and above the diagonal are stored,
+  row by row. M[i][j] and M[j][i] refer to the same element, so the
+  matrix is symmetric by construction and never needs forcing back to
+  symmetry. When both indexes are constants the packed offset is
+  resolved at compile time.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include "vectorN.h"
+
+template <typename T, uint8_t N>
+class SymMatrixN
+{
+public:
+    // number of elements actually stored
+    static constexpr uint16_t num_elements = (uint16_t)N * (N + 1) / 2;
+
+    // offset of element (i,j), i <= j, in the packed storage
+    static constexpr uint16_t upper_index(uint8_t i, uint8_t j) {
+        return (uint16_t)i * (2 * N - 1 - i) / 2 + j;
+    }
+
+    // offset of element (i,j) in the packed storage
+    static constexpr uint16_t index(uint8_t i, uint8_t j) {
+        return i <= j ? upper_index(i, j) : upper_index(j, i);
+    }
+
+    // one row of the matrix, so elements can be addressed as M[i][j]
+    class Row {
+    public:
+        Row(T *v, uint8_t row) : _v(v), _row(row) {}
+        inline T & operator[](uint8_t j) const {
+#if MATH_CHECK_INDEXES
+            assert(j < N);
+#endif
+            return _v[index(_row, j)];
+        }
+    private:
+        T *_v;
+        uint8_t _row;
+    };
+
+    class ConstRow {
+    public:
+        ConstRow(const T *v, uint8_t row) : _v(v), _row(row) {}
+        inline const T & operator[](uint8_t j) const {
+#if MATH_CHECK_INDEXES
+            assert(j < N);
+#endif
+            return _v[index(_row, j)];
+        }
+    private:
+        const T *_v;
+        uint8_t _row;
+    };
+
+    // constructor from zeros
+    SymMatrixN<T,N>(void) {
+        zero();
+    }
+
+    inline Row operator[](uint8_t i) {
+#if MATH_CHECK_INDEXES
+        assert(i < N);
+#endif
+        return Row(_v, i);
+    }
+
+    inline ConstRow operator[](uint8_t i) const {
+#if MATH_CHECK_INDEXES
+        assert(i < N);
+#endif
+        return ConstRow(_v, i);
+    }
+
+    // pointer to the packed upper triangle, row by row. Row i holds
+    // columns i to N-1 starting at upper_index(i,i)
+    inline T *packed(void) { return _v; }
+    inline const T *packed(void) const { return _v; }
+
+    // pointer to element (i,i), which is followed in memory by the
+    // rest of row i up to column N-1
+    inline T *row_from_diagonal(uint8_t i) { return &_v[upper_index(i, i)]; }
+    inline const T *row_from_diagonal(uint8_t i) const { return &_v[upper_index(i, i)]; }
+
+    // zero the matrix
+    inline void zero(void) {
+        memset(_v, 0, sizeof(_v));
+    }
+
+    // zero rows first to last, and so also the same columns
+    void zero_rows_cols(uint8_t first, uint8_t last) {
+        // columns first to last of the rows above the block
+        for (uint8_t row = 0; row < first; row++) {
+            memset(&_v[upper_index(row, first)], 0, sizeof(T) * (1 + last - first));
+        }
+        // the remainder of the rows in the block
+        for (uint8_t row = first; row <= last; row++) {
+            memset(&_v[upper_index(row, row)], 0, sizeof(T) * (N - row));
+        }
+    }
+
+    /*
+      out = h^T * M over the first n columns, for a vector h which is
+      zero except at the nidx indexes listed in idx. Only those rows of
+      M are read, so the cost is nidx * n rather than N * n
+     */
+    void sparse_vec_mul(T *out, const T *h, const uint8_t *idx, uint8_t nidx, uint8_t n) const {
+        memset(out, 0, sizeof(T) * n);
+        for (uint8_t k = 0; k < nidx; k++) {
+            const uint8_t row = idx[k];
+            const T hk = h[row];
+            // the part of the row left of the diagonal is a column of
+            // the upper triangle
+            for (uint8_t j = 0; j < row && j < n; j++) {
+                out[j] += hk * _v[upper_index(j, row)];
+            }
+            const T *v = &_v[upper_index(row, row)];
+            for (uint8_t j = row; j < n; j++) {
+                out[j] += hk * v[j - row];
+            }
+        }
+    }
+
+    // subtract the outer product a * b^T from the upper triangle of
+    // the first n rows and columns. The result is only meaningful if
+    // a * b^T is symmetric, which is up to the caller
+    void sub_outer(const T *a, const T *b, uint8_t n) {
+        for (uint8_t i = 0; i < n; i++) {
+            T *v = &_v[upper_index(i, i)];
+            const T ai = a[i];
+            for (uint8_t j = i; j < n; j++) {
+                v[j - i] -= ai * b[j];
+            }
+        }
+    }
+
+private:
+    T _v[num_elements];
+};
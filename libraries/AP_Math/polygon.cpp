@@ -36,6 +36,49 @@
  *  expect that to be very small over the distances involved in the
  *  fence boundary
  */
+/*
+ *  return true if a ray from P in the +x direction crosses the edge
+ *  from Vi to Vj
+ */
+template <typename T>
+static bool Polygon_edge_crossed(const Vector2<T> &P, const Vector2<T> &Vi, const Vector2<T> &Vj)
+{
+    if ((Vi.y > P.y) == (Vj.y > P.y)) {
+        return false;
+    }
+    const T dx1 = P.x - Vi.x;
+    const T dx2 = Vj.x - Vi.x;
+    const T dy1 = P.y - Vi.y;
+    const T dy2 = Vj.y - Vi.y;
+    const int8_t dx1s = (dx1 < 0) ? -1 : 1;
+    const int8_t dx2s = (dx2 < 0) ? -1 : 1;
+    const int8_t dy1s = (dy1 < 0) ? -1 : 1;
+    const int8_t dy2s = (dy2 < 0) ? -1 : 1;
+    const int8_t m1 = dx1s * dy2s;
+    const int8_t m2 = dx2s * dy1s;
+    // we avoid the 64 bit multiplies if we can based on sign checks.
+    if (dy2 < 0) {
+        if (m1 > m2) {
+            return true;
+        } else if (m1 < m2) {
+            return false;
+        }
+        if (std::is_floating_point<T>::value) {
+            return dx1 * dy2 > dx2 * dy1;
+        }
+        return dx1 * (int64_t)dy2 > dx2 * (int64_t)dy1;
+    }
+    if (m1 < m2) {
+        return true;
+    } else if (m1 > m2) {
+        return false;
+    }
+    if (std::is_floating_point<T>::value) {
+        return dx1 * dy2 < dx2 * dy1;
+    }
+    return dx1 * (int64_t)dy2 < dx2 * (int64_t)dy1;
+}
+
 template <typename T>
 bool Polygon_outside(const Vector2<T> &P, const Vector2<T> *V, unsigned n)
 {
@@ -54,52 +97,8 @@ bool Polygon_outside(const Vector2<T> &P, const Vector2<T> *V, unsigned n)
         if (j >= n) {
             j = 0;
         }
-        if ((V[i].y > P.y) == (V[j].y > P.y)) {
-            continue;
-        }
-        const T dx1 = P.x - V[i].x;
-        const T dx2 = V[j].x - V[i].x;
-        const T dy1 = P.y - V[i].y;
-        const T dy2 = V[j].y - V[i].y;
-        const int8_t dx1s = (dx1 < 0) ? -1 : 1;
-        const int8_t dx2s = (dx2 < 0) ? -1 : 1;
-        const int8_t dy1s = (dy1 < 0) ? -1 : 1;
-        const int8_t dy2s = (dy2 < 0) ? -1 : 1;
-        const int8_t m1 = dx1s * dy2s;
-        const int8_t m2 = dx2s * dy1s;
-        // we avoid the 64 bit multiplies if we can based on sign checks.
-        if (dy2 < 0) {
-            if (m1 > m2) {
-                outside = !outside;
-            } else if (m1 < m2) {
-                continue;
-            } else {
-                if (std::is_floating_point<T>::value) {
-                    if ( dx1 * dy2 > dx2 * dy1 ) {
-                        outside = !outside;
-                    }
-                } else {
-                    if ( dx1 * (int64_t)dy2 > dx2 * (int64_t)dy1 ) {
-                        outside = !outside;
-                    }
-                }
-            }
-        } else {
-            if (m1 < m2) {
-                outside = !outside;
-            } else if (m1 > m2) {
-                continue;
-            } else {
-                if (std::is_floating_point<T>::value) {
-                    if ( dx1 * dy2 < dx2 * dy1 ) {
-                        outside = !outside;
-                    }
-                } else {
-                    if ( dx1 * (int64_t)dy2 < dx2 * (int64_t)dy1 ) {
-                        outside = !outside;
-                    }
-                }
-            }
+        if (Polygon_edge_crossed(P, V[i], V[j])) {
+            outside = !outside;
         }
     }
     return outside;
@@ -214,3 +213,271 @@ float Polygon_closest_distance_point(const Vector2f *V, unsigned N, const Vector
     }
     return sqrtf(closest_sq);
 }
+
+/*
+  index the edges of polygon V, defined by n points with an optional
+  closing point
+ */
+void Polygon_index::init(const Vector2f *V, unsigned n)
+{
+    clear();
+
+    if (Polygon_complete(V, n)) {
+        n--;
+    }
+    _points = V;
+    _num_edges = MIN(n, (unsigned)UINT16_MAX);
+    if (_num_edges < 3) {
+        return;
+    }
+
+    _min = _max = V[0];
+    for (uint16_t i=1; i<_num_edges; i++) {
+        _min.x = MIN(_min.x, V[i].x);
+        _min.y = MIN(_min.y, V[i].y);
+        _max.x = MAX(_max.x, V[i].x);
+        _max.y = MAX(_max.y, V[i].y);
+    }
+
+    // aim for about one edge per bucket, using fewer buckets if long
+    // edges would need to be stored in too many of them
+    uint8_t side = constrain_int16(ceilf(sqrtf(_num_edges)), 1, POLYGON_INDEX_SIDE_MAX);
+    uint32_t total;
+    while (true) {
+        _cols = _rows = side;
+        _inv_cell_x = (_max.x > _min.x) ? (_cols / (_max.x - _min.x)) : 0.0f;
+        _inv_cell_y = (_max.y > _min.y) ? (_rows / (_max.y - _min.y)) : 0.0f;
+        total = 0;
+        for (uint16_t i=0; i<_num_edges; i++) {
+            uint8_t c0, c1, r0, r1;
+            edge_cells(i, c0, c1, r0, r1);
+            total += (c1 - c0 + 1) * (r1 - r0 + 1);
+        }
+        if (total <= _num_edges * 4U || side == 1) {
+            break;
+        }
+        side /= 2;
+    }
+
+    const uint16_t num_cells = _cols * _rows;
+    _cell_start = new uint16_t[num_cells + 1];
+    _cell_edges = new uint16_t[total];
+    if (_cell_start == nullptr || _cell_edges == nullptr || total > UINT16_MAX) {
+        // queries check every edge
+        delete[] _cell_start;
+        delete[] _cell_edges;
+        _cell_start = nullptr;
+        _cell_edges = nullptr;
+        return;
+    }
+
+    // count edges in each bucket, then convert counts to start positions
+    memset(_cell_start, 0, (num_cells + 1) * sizeof(_cell_start[0]));
+    for (uint16_t i=0; i<_num_edges; i++) {
+        uint8_t c0, c1, r0, r1;
+        edge_cells(i, c0, c1, r0, r1);
+        for (uint8_t r=r0; r<=r1; r++) {
+            for (uint8_t c=c0; c<=c1; c++) {
+                _cell_start[r * _cols + c]++;
+            }
+        }
+    }
+    uint16_t pos = 0;
+    for (uint16_t cell=0; cell<num_cells; cell++) {
+        const uint16_t count = _cell_start[cell];
+        _cell_start[cell] = pos;
+        pos += count;
+    }
+
+    // fill buckets, leaving each start position at the start of the next bucket
+    for (uint16_t i=0; i<_num_edges; i++) {
+        uint8_t c0, c1, r0, r1;
+        edge_cells(i, c0, c1, r0, r1);
+        for (uint8_t r=r0; r<=r1; r++) {
+            for (uint8_t c=c0; c<=c1; c++) {
+                _cell_edges[_cell_start[r * _cols + c]++] = i;
+            }
+        }
+    }
+    for (uint16_t cell=num_cells; cell>0; cell--) {
+        _cell_start[cell] = _cell_start[cell-1];
+    }
+    _cell_start[0] = 0;
+}
+
+/*
+  free the buckets and forget the polygon
+ */
+void Polygon_index::clear()
+{
+    delete[] _cell_start;
+    delete[] _cell_edges;
+    _cell_start = nullptr;
+    _cell_edges = nullptr;
+    _points = nullptr;
+    _num_edges = 0;
+}
+
+// bucket column or row holding a coordinate, clamped to the grid
+uint8_t Polygon_index::col(float x) const
+{
+    return constrain_float((x - _min.x) * _inv_cell_x, 0.0f, _cols - 1);
+}
+
+uint8_t Polygon_index::row(float y) const
+{
+    return constrain_float((y - _min.y) * _inv_cell_y, 0.0f, _rows - 1);
+}
+
+// range of buckets covered by an edge's bounding box
+void Polygon_index::edge_cells(uint16_t edge, uint8_t &c0, uint8_t &c1, uint8_t &r0, uint8_t &r1) const
+{
+    const Vector2f &v1 = _points[edge];
+    const Vector2f &v2 = _points[edge_end(edge)];
+    c0 = col(MIN(v1.x, v2.x));
+    c1 = col(MAX(v1.x, v2.x));
+    r0 = row(MIN(v1.y, v2.y));
+    r1 = row(MAX(v1.y, v2.y));
+}
+
+/*
+  return true if P is outside the polygon, the same result as
+  Polygon_outside() but only checking edges in the buckets a ray from
+  P in the +x direction passes through
+ */
+bool Polygon_index::outside(const Vector2f &P) const
+{
+    if (_cell_start == nullptr) {
+        return (_points == nullptr) || Polygon_outside(P, _points, _num_edges);
+    }
+
+    // no edge can be crossed if P is above, below or right of the polygon
+    if (P.y < _min.y || P.y >= _max.y || P.x > _max.x) {
+        return true;
+    }
+
+    bool outside = true;
+    const uint8_t r = row(P.y);
+    const uint8_t c_start = col(P.x);
+    for (uint8_t c=c_start; c<_cols; c++) {
+        const uint16_t cell = r * _cols + c;
+        for (uint16_t k=_cell_start[cell]; k<_cell_start[cell+1]; k++) {
+            const uint16_t edge = _cell_edges[k];
+            const Vector2f &v1 = _points[edge];
+            const Vector2f &v2 = _points[edge_end(edge)];
+            // edges in several buckets are only checked in the first the ray passes through
+            if (MAX(col(MIN(v1.x, v2.x)), c_start) != c) {
+                continue;
+            }
+            if (Polygon_edge_crossed(P, v1, v2)) {
+                outside = !outside;
+            }
+        }
+    }
+    return outside;
+}
+
+/*
+  return the closest distance that point P comes to any edge of the
+  polygon, including the edge from the last point back to the first.
+  Buckets are searched in rings around P until no closer edge is
+  possible
+ */
+float Polygon_index::closest_distance_point(const Vector2f &P) const
+{
+    float closest_sq = FLT_MAX;
+    if (_cell_start == nullptr) {
+        for (uint16_t i=0; i<_num_edges; i++) {
+            closest_sq = MIN(closest_sq, Vector2f::closest_distance_between_line_and_point_squared(_points[i], _points[edge_end(i)], P));
+        }
+        return sqrtf(closest_sq);
+    }
+
+    // buckets in ring r around P's bucket are at least (r-1) bucket sizes away
+    const float ring_step = MIN((_max.x - _min.x) / _cols, (_max.y - _min.y) / _rows);
+    const int16_t pc = col(P.x);
+    const int16_t pr = row(P.y);
+    const int16_t rings = MAX(_cols, _rows);
+    for (int16_t ring=0; ring<rings; ring++) {
+        if ((ring > 0) && (closest_sq <= sq((ring - 1) * ring_step))) {
+            break;
+        }
+        for (int16_t r=MAX(pr-ring, 0); r<=MIN(pr+ring, _rows-1); r++) {
+            // rows at the top and bottom of the ring are checked in full, others only at the ends
+            const int16_t c_step = (abs(r - pr) == ring) ? 1 : MAX(2 * ring, 1);
+            for (int16_t c=pc-ring; c<=pc+ring; c+=c_step) {
+                if (c < 0 || c >= _cols) {
+                    continue;
+                }
+                const uint16_t cell = r * _cols + c;
+                for (uint16_t k=_cell_start[cell]; k<_cell_start[cell+1]; k++) {
+                    const uint16_t edge = _cell_edges[k];
+                    closest_sq = MIN(closest_sq, Vector2f::closest_distance_between_line_and_point_squared(_points[edge], _points[edge_end(edge)], P));
+                }
+            }
+        }
+    }
+    return sqrtf(closest_sq);
+}
+
+/*
+  start iterating over the edges which may be within the box with
+  corners corner1 and corner2
+ */
+void Polygon_index::edges_start(EdgeIterator &it, const Vector2f &corner1, const Vector2f &corner2) const
+{
+    it.pos = 0;
+    if (_cell_start == nullptr) {
+        // check every edge
+        it.col_min = it.col_max = it.col = 0;
+        it.row_min = it.row_max = it.row = 0;
+        it.end = _num_edges;
+        return;
+    }
+    it.col_min = it.col = col(MIN(corner1.x, corner2.x));
+    it.col_max = col(MAX(corner1.x, corner2.x));
+    it.row_min = it.row = row(MIN(corner1.y, corner2.y));
+    it.row_max = row(MAX(corner1.y, corner2.y));
+    const uint16_t cell = it.row * _cols + it.col;
+    it.pos = _cell_start[cell];
+    it.end = _cell_start[cell+1];
+}
+
+/*
+  get the next edge from an iteration as the index of its first
+  point. Returns false when there are no more edges
+ */
+bool Polygon_index::edges_next(EdgeIterator &it, uint16_t &edge) const
+{
+    if (_cell_start == nullptr) {
+        if (it.pos >= it.end) {
+            return false;
+        }
+        edge = it.pos++;
+        return true;
+    }
+    while (true) {
+        while (it.pos < it.end) {
+            const uint16_t e = _cell_edges[it.pos++];
+            // edges in several buckets are only returned from the first bucket of the box they are in
+            uint8_t c0, c1, r0, r1;
+            edge_cells(e, c0, c1, r0, r1);
+            if (MAX(c0, it.col_min) == it.col && MAX(r0, it.row_min) == it.row) {
+                edge = e;
+                return true;
+            }
+        }
+        // move to next bucket
+        if (it.col < it.col_max) {
+            it.col++;
+        } else if (it.row < it.row_max) {
+            it.col = it.col_min;
+            it.row++;
+        } else {
+            return false;
+        }
+        const uint16_t cell = it.row * _cols + it.col;
+        it.pos = _cell_start[cell];
+        it.end = _cell_start[cell+1];
+    }
+}
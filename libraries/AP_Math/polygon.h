@@ -44,3 +44,65 @@ float Polygon_closest_distance_line(const Vector2f *V, unsigned N, const Vector2
   closed polygon V, defined by N points
  */
 float Polygon_closest_distance_point(const Vector2f *V, unsigned N, const Vector2f &p);
+
+/*
+  index of the edges of a polygon in a grid of buckets over its
+  bounding box so containment and closest edge queries only look at
+  nearby edges. The points are not copied so must remain valid while
+  the index is used. If the buckets can't be allocated queries check
+  every edge
+ */
+#define POLYGON_INDEX_SIDE_MAX 16   // maximum number of buckets along each side of the grid
+
+class Polygon_index {
+public:
+    Polygon_index() {}
+    ~Polygon_index() { clear(); }
+
+    /* Do not allow copies */
+    Polygon_index(const Polygon_index &other) = delete;
+    Polygon_index &operator=(const Polygon_index&) = delete;
+
+    // index polygon V defined by n points, the closing point is optional
+    void init(const Vector2f *V, unsigned n);
+
+    // free the buckets and forget the polygon
+    void clear();
+
+    // return true if P is outside the polygon, same result as Polygon_outside()
+    bool outside(const Vector2f &P) const WARN_IF_UNUSED;
+
+    // return the closest distance from P to an edge of the polygon
+    float closest_distance_point(const Vector2f &P) const;
+
+    // iterate over edges that may be within the box with corners
+    // corner1 and corner2. Each edge is returned once, as the index of
+    // its first point. Use edge_end() for the index of its second point
+    struct EdgeIterator {
+        uint8_t col_min, col_max, col;
+        uint8_t row_min, row_max, row;
+        uint16_t pos;
+        uint16_t end;
+    };
+    void edges_start(EdgeIterator &it, const Vector2f &corner1, const Vector2f &corner2) const;
+    bool edges_next(EdgeIterator &it, uint16_t &edge) const WARN_IF_UNUSED;
+
+    // index of the second point of an edge
+    uint16_t edge_end(uint16_t edge) const { return (edge + 1U < _num_edges) ? edge + 1 : 0; }
+
+private:
+    // bucket column or row holding a coordinate, clamped to the grid
+    uint8_t col(float x) const;
+    uint8_t row(float y) const;
+
+    // range of buckets covered by an edge's bounding box
+    void edge_cells(uint16_t edge, uint8_t &c0, uint8_t &c1, uint8_t &r0, uint8_t &r1) const;
+
+    const Vector2f *_points = nullptr;  // polygon points, not including any closing point
+    uint16_t _num_edges = 0;            // number of points and edges
+    Vector2f _min, _max;                // bounding box
+    float _inv_cell_x, _inv_cell_y;     // buckets per unit length
+    uint8_t _cols, _rows;               // number of buckets in x and y
+    uint16_t *_cell_start = nullptr;    // position in _cell_edges of each bucket's edges, with an extra entry for the end
+    uint16_t *_cell_edges = nullptr;    // edge indices of every bucket
+};
@@ -0,0 +1,46 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+
+// one byte at a time from the table, as crc_crc32() did before slicing
+static uint32_t crc32_bytewise(uint32_t crc, const uint8_t *buf, uint32_t size)
+{
+    for (uint32_t i = 0; i < size; i++) {
+        crc ^= buf[i];
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+TEST(CRCTest, CRC32Check)
+{
+    // standard check value, with the usual inversion applied by callers
+    const uint8_t check[] = "123456789";
+    EXPECT_EQ(0xCBF43926U, ~crc_crc32(~0U, check, 9));
+}
+
+TEST(CRCTest, CRC32Lengths)
+{
+    uint8_t buf[300];
+    for (uint16_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = i * 73 + 5;
+    }
+    // every length and alignment through the 4 byte steps and the tail
+    for (uint8_t ofs = 0; ofs < 4; ofs++) {
+        for (uint16_t len = 0; len + ofs <= sizeof(buf); len += 7) {
+            EXPECT_EQ(crc32_bytewise(0x12345678, &buf[ofs], len),
+                      crc_crc32(0x12345678, &buf[ofs], len));
+        }
+    }
+
+    // and in pieces, as a file is checked block by block
+    uint32_t crc = 0;
+    for (uint16_t i = 0; i < sizeof(buf); i += 13) {
+        crc = crc_crc32(crc, &buf[i], MIN(13U, sizeof(buf) - i));
+    }
+    EXPECT_EQ(crc32_bytewise(0, buf, sizeof(buf)), crc);
+}
+
+AP_GTEST_MAIN()
@@ -232,4 +232,44 @@ INSTANTIATE_TEST_CASE_P(HardcodedVectors,
                         GeodesicGridTest,
                         ::testing::ValuesIn(hardcoded_vectors));
 
+/* Check section() against a brute force search over the sections' triangles
+ * for vectors spread over the whole sphere, so that every path through the
+ * triangle search and every coordinate shortcut gets exercised. */
+TEST(GeodesicGridBruteForceTest, RandomVectors)
+{
+    Matrix3f inverses[20 * AP_GeodesicGrid::NUM_SUBTRIANGLES];
+    for (int i = 0; i < 20 * AP_GeodesicGrid::NUM_SUBTRIANGLES; i++) {
+        Vector3f a, b, c;
+        section_triangle(i, a, b, c);
+        Matrix3f m(a.x, b.x, c.x,
+                   a.y, b.y, c.y,
+                   a.z, b.z, c.z);
+        ASSERT_TRUE(m.inverse(inverses[i]));
+    }
+
+    uint32_t seed = 1;
+    for (int n = 0; n < 20000; n++) {
+        Vector3f v;
+        for (int k = 0; k < 3; k++) {
+            seed = seed * 1103515245 + 12345;
+            v[k] = ((seed >> 8) & 0xffff) / 32768.0f - 1.0f;
+        }
+
+        int expected = -1;
+        for (int i = 0; i < 20 * AP_GeodesicGrid::NUM_SUBTRIANGLES; i++) {
+            auto w = inverses[i] * v;
+            if (w.x > 0 && w.y > 0 && w.z > 0) {
+                expected = i;
+                break;
+            }
+        }
+        ASSERT_NE(-1, expected) << "v is " << v.x << ", " << v.y << ", " << v.z;
+
+        EXPECT_EQ(expected, AP_GeodesicGrid::section(v))
+            << "v is " << v.x << ", " << v.y << ", " << v.z;
+        EXPECT_EQ(expected, AP_GeodesicGrid::section(v, true))
+            << "v is " << v.x << ", " << v.y << ", " << v.z;
+    }
+}
+
 AP_GTEST_MAIN()
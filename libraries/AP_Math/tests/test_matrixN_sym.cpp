@@ -0,0 +1,106 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/matrixN_sym.h>
+
+typedef SymMatrixN<float,24> SymMatrix24;
+
+TEST(SymMatrixNTest, Packing)
+{
+    EXPECT_EQ(300U, (unsigned)SymMatrix24::num_elements);
+    EXPECT_EQ(300 * sizeof(float), sizeof(SymMatrix24));
+
+    // the upper triangle is stored row by row with no gaps
+    uint16_t expected = 0;
+    for (uint8_t i = 0; i < 24; i++) {
+        for (uint8_t j = i; j < 24; j++) {
+            EXPECT_EQ(expected, SymMatrix24::index(i, j));
+            EXPECT_EQ(expected, SymMatrix24::index(j, i));
+            expected++;
+        }
+    }
+}
+
+TEST(SymMatrixNTest, Symmetric)
+{
+    SymMatrix24 m;
+    for (uint8_t i = 0; i < 24; i++) {
+        for (uint8_t j = 0; j < 24; j++) {
+            EXPECT_FLOAT_EQ(0.0f, m[i][j]);
+        }
+    }
+
+    m[3][17] = 2.0f;
+    EXPECT_FLOAT_EQ(2.0f, m[17][3]);
+    m[17][3] = 5.0f;
+    EXPECT_FLOAT_EQ(5.0f, m[3][17]);
+
+    const SymMatrix24 &c = m;
+    EXPECT_FLOAT_EQ(5.0f, c[3][17]);
+    EXPECT_FLOAT_EQ(5.0f, c[17][3]);
+}
+
+TEST(SymMatrixNTest, ZeroRowsCols)
+{
+    SymMatrix24 m;
+    for (uint8_t i = 0; i < 24; i++) {
+        for (uint8_t j = i; j < 24; j++) {
+            m[i][j] = 1 + i * 24 + j;
+        }
+    }
+
+    m.zero_rows_cols(10, 12);
+
+    for (uint8_t i = 0; i < 24; i++) {
+        for (uint8_t j = 0; j < 24; j++) {
+            const bool zeroed = (i >= 10 && i <= 12) || (j >= 10 && j <= 12);
+            const float value = 1 + MIN(i, j) * 24 + MAX(i, j);
+            EXPECT_FLOAT_EQ(zeroed ? 0.0f : value, m[i][j]);
+        }
+    }
+}
+
+// the sparse rank one update P -= K*(H*P) must match the dense
+// P -= (K*H)*P for a Jacobian with the magnetometer sparsity
+TEST(SymMatrixNTest, SparseRankOneUpdate)
+{
+    const uint8_t idx[] = { 0, 1, 2, 3, 16, 17, 18, 19, 20, 21 };
+    const uint8_t nidx = ARRAY_SIZE(idx);
+
+    SymMatrix24 P;
+    float dense[24][24];
+    for (uint8_t i = 0; i < 24; i++) {
+        for (uint8_t j = i; j < 24; j++) {
+            P[i][j] = i == j ? 2.0f + 0.1f * i : 0.01f * ((i * 7 + j * 3) % 11) - 0.05f;
+            dense[i][j] = dense[j][i] = P[i][j];
+        }
+    }
+    float H[24] {};
+    for (uint8_t k = 0; k < nidx; k++) {
+        H[idx[k]] = 0.3f * k - 1.2f;
+    }
+    float K[24];
+    for (uint8_t i = 0; i < 24; i++) {
+        K[i] = 0.02f * ((i * 5) % 9) - 0.07f;
+    }
+
+    // only the first 22 states, as when the wind states are inhibited
+    const uint8_t n = 22;
+    float HP[24];
+    P.sparse_vec_mul(HP, H, idx, nidx, n);
+    P.sub_outer(K, HP, n);
+
+    for (uint8_t i = 0; i < 24; i++) {
+        for (uint8_t j = i; j < 24; j++) {
+            float expected = dense[i][j];
+            if (j < n) {
+                for (uint8_t k = 0; k < 24; k++) {
+                    expected -= K[i] * H[k] * dense[k][j];
+                }
+            }
+            EXPECT_NEAR(expected, P[i][j], 1e-5f);
+        }
+    }
+}
+
+AP_GTEST_MAIN()
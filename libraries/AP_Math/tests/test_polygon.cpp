@@ -356,6 +356,61 @@ TEST(Polygon, simple)
     TEST_POLYGON_POINTS(SIMPLE_boundary, SIMPLE_test_points);
 }
 
+// star shaped polygon with n points, alternating between two radii
+static void make_star_polygon(Vector2f *V, uint16_t n)
+{
+    for (uint16_t i = 0; i < n; i++) {
+        const float radius = (i % 2) ? 1000.0f : 1500.0f;
+        V[i] = Vector2f{radius * cosf(M_2PI * i / n), radius * sinf(M_2PI * i / n)};
+    }
+}
+
+TEST(Polygon, index_matches_outside)
+{
+    const uint16_t n = 100;
+    Vector2f star[n+1];
+    make_star_polygon(star, n);
+    star[n] = star[0];
+
+    Polygon_index index;
+    index.init(star, n+1);
+    for (float x = -1600.0f; x <= 1600.0f; x += 23.7f) {
+        for (float y = -1600.0f; y <= 1600.0f; y += 31.3f) {
+            const Vector2f point{x, y};
+            EXPECT_EQ(Polygon_outside(point, star, n+1), index.outside(point));
+            EXPECT_FLOAT_EQ(Polygon_closest_distance_point(star, n+1, point),
+                            index.closest_distance_point(point));
+        }
+    }
+}
+
+TEST(Polygon, index_edges_in_box)
+{
+    const uint16_t n = 60;
+    Vector2f star[n];
+    make_star_polygon(star, n);
+
+    Polygon_index index;
+    index.init(star, n);
+    const Vector2f p1{-200.0f, -300.0f};
+    const Vector2f p2{1400.0f, 900.0f};
+    uint8_t returned[n] {};
+    Polygon_index::EdgeIterator it;
+    index.edges_start(it, p1, p2);
+    uint16_t edge;
+    while (index.edges_next(it, edge)) {
+        returned[edge]++;
+    }
+    for (uint16_t i = 0; i < n; i++) {
+        // each edge is returned at most once and every edge crossing the box's diagonal is returned
+        EXPECT_LE(returned[i], 1);
+        Vector2f intersection;
+        if (Vector2f::segment_intersection(p1, p2, star[i], star[index.edge_end(i)], intersection)) {
+            EXPECT_EQ(1, returned[i]);
+        }
+    }
+}
+
 AP_GTEST_MAIN()
 
 
@@ -0,0 +1,91 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/vector_kernels.h>
+
+// sizes that exercise both the four wide loops and the remainders
+static const uint8_t sizes[] = { 1, 3, 4, 7, 24 };
+
+static void fill(float *v, uint16_t n, float seed)
+{
+    for (uint16_t i = 0; i < n; i++) {
+        v[i] = seed + 0.37f * i - 0.011f * i * i;
+    }
+}
+
+TEST(VectorKernelsTest, Elementwise)
+{
+    for (uint8_t n : sizes) {
+        float src[24], a[24], b[24];
+        fill(src, n, 1.5f);
+
+        fill(a, n, 2.0f);
+        fill(b, n, 2.0f);
+        kernel_sub(a, src, n);
+        kernel_sub_scalar(b, src, n);
+        for (uint8_t i = 0; i < n; i++) {
+            EXPECT_FLOAT_EQ(b[i], a[i]);
+        }
+
+        kernel_scale(a, src, -0.5f, n);
+        kernel_scale_scalar(b, src, -0.5f, n);
+        for (uint8_t i = 0; i < n; i++) {
+            EXPECT_FLOAT_EQ(b[i], a[i]);
+        }
+
+        kernel_axpy(a, src, 3.0f, n);
+        kernel_axpy_scalar(b, src, 3.0f, n);
+        for (uint8_t i = 0; i < n; i++) {
+            EXPECT_FLOAT_EQ(b[i], a[i]);
+        }
+
+        EXPECT_NEAR(kernel_dot_scalar(a, src, n), kernel_dot(a, src, n), 1.0e-4f * n);
+    }
+}
+
+TEST(VectorKernelsTest, Products)
+{
+    for (uint8_t n : sizes) {
+        const uint8_t m = 5;
+        float A[24*24], B[24*24], C[24*24], Cref[24*24];
+        fill(A, m*n, 0.5f);
+        fill(B, n*n, -1.0f);
+
+        kernel_mat_mul(C, A, B, m, n, n);
+        kernel_mat_mul_scalar(Cref, A, B, m, n, n);
+        for (uint16_t i = 0; i < m*n; i++) {
+            EXPECT_NEAR(Cref[i], C[i], 1.0e-3f * fabsf(Cref[i]) + 1.0e-3f);
+        }
+
+        // here A is n x m
+        kernel_mat_mul_transA(C, A, B, m, n, n);
+        kernel_mat_mul_transA_scalar(Cref, A, B, m, n, n);
+        for (uint16_t i = 0; i < m*n; i++) {
+            EXPECT_NEAR(Cref[i], C[i], 1.0e-3f * fabsf(Cref[i]) + 1.0e-3f);
+        }
+
+        kernel_outer(C, A, B, m, n);
+        kernel_outer_scalar(Cref, A, B, m, n);
+        for (uint16_t i = 0; i < m*n; i++) {
+            EXPECT_FLOAT_EQ(Cref[i], C[i]);
+        }
+    }
+}
+
+TEST(VectorKernelsTest, MatrixMultiply)
+{
+    // a small product checked against known values
+    const float A[2*3] = { 1, 2, 3,
+                           4, 5, 6 };
+    const float B[3*2] = { 7, 8,
+                           9, 10,
+                           11, 12 };
+    float C[2*2];
+    kernel_mat_mul(C, A, B, 2, 3, 2);
+    EXPECT_FLOAT_EQ(58.0f, C[0]);
+    EXPECT_FLOAT_EQ(64.0f, C[1]);
+    EXPECT_FLOAT_EQ(139.0f, C[2]);
+    EXPECT_FLOAT_EQ(154.0f, C[3]);
+}
+
+AP_GTEST_MAIN()
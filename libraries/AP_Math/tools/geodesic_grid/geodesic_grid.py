@@ -132,7 +132,7 @@ parser.add_argument(
     '--inverses-gen',
     action='store_true',
     help="""
-Generate C++ code for the initialization of members _inverses and _mid_inverses
+Generate C++ code for the initialization of member _inverses
 declared in AP_GeodesicGrid.h.
 """)
 
@@ -254,7 +254,7 @@ if args.neighbor_umbrella_gen:
     print("Header neighbor umbrellas code generation:")
     print_code_gen_notice()
     print("const struct AP_GeodesicGrid::neighbor_umbrella")
-    print("AP_GeodesicGrid::_neighbor_umbrellas[3]{")
+    print("AP_GeodesicGrid::_neighbor_umbrellas[6]{")
     for i in range(6):
         u, order_edge = header_neighbor_umbrella(i)
 
@@ -280,8 +280,8 @@ if args.neighbor_umbrella_gen:
 if args.inverses_gen:
     print("Header inverses code generation:")
     print_code_gen_notice()
-    print("const Matrix3f AP_GeodesicGrid::_inverses[10]{")
-    for i in range(10):
+    print("const Matrix3f AP_GeodesicGrid::_inverses[20]{")
+    for i in range(20):
         a, b, c = ico.triangles[i]
         m = np.matrix((
             (a.x, b.x, c.x),
@@ -292,21 +292,6 @@ if args.inverses_gen:
         print("     {%9.6ff, %9.6ff, %9.6ff}," % (m[1,0], m[1,1], m[1,2]))
         print("     {%9.6ff, %9.6ff, %9.6ff}}," % (m[2,0], m[2,1], m[2,2]))
     print("};")
-    print()
-    print_code_gen_notice()
-    print("const Matrix3f AP_GeodesicGrid::_mid_inverses[10]{")
-    for i in range(10):
-        a, b, c = ico.triangles[i]
-        ma, mb, mc = .5 * (a + b), .5 * (b + c), .5 * (c + a)
-        m = np.matrix((
-            (ma.x, mb.x, mc.x),
-            (ma.y, mb.y, mc.y),
-            (ma.z, mb.z, mc.z),
-        )).getI()
-        print("    {{%9.6ff, %9.6ff, %9.6ff}," % (m[0,0], m[0,1], m[0,2]))
-        print("     {%9.6ff, %9.6ff, %9.6ff}," % (m[1,0], m[1,1], m[1,2]))
-        print("     {%9.6ff, %9.6ff, %9.6ff}}," % (m[2,0], m[2,1], m[2,2]))
-    print("};")
 
 
 if args.icosahedron:
@@ -0,0 +1,219 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  vector kernels for the N dimensional matrix code
+ */
+
+#pragma GCC optimize("O2")
+
+#include "vector_kernels.h"
+#include <string.h>
+
+/*
+  scalar reference implementations
+ */
+void kernel_sub_scalar(float *dst, const float *src, uint16_t n)
+{
+    for (uint16_t i = 0; i < n; i++) {
+        dst[i] -= src[i];
+    }
+}
+
+void kernel_scale_scalar(float *dst, const float *src, float k, uint16_t n)
+{
+    for (uint16_t i = 0; i < n; i++) {
+        dst[i] = k * src[i];
+    }
+}
+
+void kernel_axpy_scalar(float *dst, const float *src, float k, uint16_t n)
+{
+    for (uint16_t i = 0; i < n; i++) {
+        dst[i] += k * src[i];
+    }
+}
+
+float kernel_dot_scalar(const float *a, const float *b, uint16_t n)
+{
+    float sum = 0;
+    for (uint16_t i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void kernel_outer_scalar(float *C, const float *a, const float *b, uint8_t rows, uint8_t cols)
+{
+    for (uint8_t i = 0; i < rows; i++) {
+        kernel_scale_scalar(&C[i*cols], b, a[i], cols);
+    }
+}
+
+void kernel_mat_mul_scalar(float *C, const float *A, const float *B, uint8_t m, uint8_t n, uint8_t p)
+{
+    for (uint8_t i = 0; i < m; i++) {
+        for (uint8_t j = 0; j < p; j++) {
+            float sum = 0;
+            for (uint8_t k = 0; k < n; k++) {
+                sum += A[i*n+k] * B[k*p+j];
+            }
+            C[i*p+j] = sum;
+        }
+    }
+}
+
+void kernel_mat_mul_transA_scalar(float *C, const float *A, const float *B, uint8_t m, uint8_t n, uint8_t p)
+{
+    for (uint8_t i = 0; i < m; i++) {
+        for (uint8_t j = 0; j < p; j++) {
+            float sum = 0;
+            for (uint8_t k = 0; k < n; k++) {
+                sum += A[k*m+i] * B[k*p+j];
+            }
+            C[i*p+j] = sum;
+        }
+    }
+}
+
+#if AP_MATH_VECTOR_KERNELS
+/*
+  four wide implementations. Loads and stores go through memcpy so the
+  arrays need no particular alignment
+ */
+typedef float vfloat4 __attribute__((vector_size(16)));
+
+static inline vfloat4 load4(const float *p)
+{
+    vfloat4 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void store4(float *p, const vfloat4 &v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+void kernel_sub(float *dst, const float *src, uint16_t n)
+{
+    uint16_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        store4(&dst[i], load4(&dst[i]) - load4(&src[i]));
+    }
+    kernel_sub_scalar(&dst[i], &src[i], n - i);
+}
+
+void kernel_scale(float *dst, const float *src, float k, uint16_t n)
+{
+    const vfloat4 kv = { k, k, k, k };
+    uint16_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        store4(&dst[i], kv * load4(&src[i]));
+    }
+    kernel_scale_scalar(&dst[i], &src[i], k, n - i);
+}
+
+void kernel_axpy(float *dst, const float *src, float k, uint16_t n)
+{
+    const vfloat4 kv = { k, k, k, k };
+    uint16_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        store4(&dst[i], load4(&dst[i]) + kv * load4(&src[i]));
+    }
+    kernel_axpy_scalar(&dst[i], &src[i], k, n - i);
+}
+
+float kernel_dot(const float *a, const float *b, uint16_t n)
+{
+    vfloat4 acc = { 0, 0, 0, 0 };
+    uint16_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc += load4(&a[i]) * load4(&b[i]);
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]) + kernel_dot_scalar(&a[i], &b[i], n - i);
+}
+
+void kernel_outer(float *C, const float *a, const float *b, uint8_t rows, uint8_t cols)
+{
+    for (uint8_t i = 0; i < rows; i++) {
+        kernel_scale(&C[i*cols], b, a[i], cols);
+    }
+}
+
+/*
+  the matrix products accumulate whole rows of B into rows of C, so
+  the inner loop runs along contiguous memory
+ */
+void kernel_mat_mul(float *C, const float *A, const float *B, uint8_t m, uint8_t n, uint8_t p)
+{
+    for (uint8_t i = 0; i < m; i++) {
+        float *Crow = &C[i*p];
+        kernel_scale(Crow, B, A[i*n], p);
+        for (uint8_t k = 1; k < n; k++) {
+            kernel_axpy(Crow, &B[k*p], A[i*n+k], p);
+        }
+    }
+}
+
+void kernel_mat_mul_transA(float *C, const float *A, const float *B, uint8_t m, uint8_t n, uint8_t p)
+{
+    for (uint8_t i = 0; i < m; i++) {
+        float *Crow = &C[i*p];
+        kernel_scale(Crow, B, A[i], p);
+        for (uint8_t k = 1; k < n; k++) {
+            kernel_axpy(Crow, &B[k*p], A[k*m+i], p);
+        }
+    }
+}
+
+#else // AP_MATH_VECTOR_KERNELS
+
+void kernel_sub(float *dst, const float *src, uint16_t n)
+{
+    kernel_sub_scalar(dst, src, n);
+}
+
+void kernel_scale(float *dst, const float *src, float k, uint16_t n)
+{
+    kernel_scale_scalar(dst, src, k, n);
+}
+
+void kernel_axpy(float *dst, const float *src, float k, uint16_t n)
+{
+    kernel_axpy_scalar(dst, src, k, n);
+}
+
+float kernel_dot(const float *a, const float *b, uint16_t n)
+{
+    return kernel_dot_scalar(a, b, n);
+}
+
+void kernel_outer(float *C, const float *a, const float *b, uint8_t rows, uint8_t cols)
+{
+    kernel_outer_scalar(C, a, b, rows, cols);
+}
+
+void kernel_mat_mul(float *C, const float *A, const float *B, uint8_t m, uint8_t n, uint8_t p)
+{
+    kernel_mat_mul_scalar(C, A, B, m, n, p);
+}
+
+void kernel_mat_mul_transA(float *C, const float *A, const float *B, uint8_t m, uint8_t n, uint8_t p)
+{
+    kernel_mat_mul_transA_scalar(C, A, B, m, n, p);
+}
+
+#endif // AP_MATH_VECTOR_KERNELS
@@ -0,0 +1,67 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  kernels for the hot loops of the N dimensional matrix code (the EKF
+  covariance updates in particular) operating on contiguous float
+  arrays. Matrices are row major with the given number of columns.
+
+  When AP_MATH_VECTOR_KERNELS is enabled the kernels work four floats
+  at a time using the compiler's generic vector types, which become
+  NEON on ARM Linux and SSE on x86 SITL. Otherwise, and always for the
+  _scalar versions, they are plain loops which serve as the reference
+  implementation.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifndef AP_MATH_VECTOR_KERNELS
+#if defined(__ARM_NEON) || defined(__SSE2__)
+#define AP_MATH_VECTOR_KERNELS 1
+#else
+#define AP_MATH_VECTOR_KERNELS 0
+#endif
+#endif
+
+// dst[i] -= src[i]
+void kernel_sub(float *dst, const float *src, uint16_t n);
+void kernel_sub_scalar(float *dst, const float *src, uint16_t n);
+
+// dst[i] = k * src[i]
+void kernel_scale(float *dst, const float *src, float k, uint16_t n);
+void kernel_scale_scalar(float *dst, const float *src, float k, uint16_t n);
+
+// dst[i] += k * src[i]
+void kernel_axpy(float *dst, const float *src, float k, uint16_t n);
+void kernel_axpy_scalar(float *dst, const float *src, float k, uint16_t n);
+
+// return the sum of a[i] * b[i]
+float kernel_dot(const float *a, const float *b, uint16_t n);
+float kernel_dot_scalar(const float *a, const float *b, uint16_t n);
+
+// outer product C = a * b^T, where C is rows x cols
+void kernel_outer(float *C, const float *a, const float *b, uint8_t rows, uint8_t cols);
+void kernel_outer_scalar(float *C, const float *a, const float *b, uint8_t rows, uint8_t cols);
+
+// C = A * B, where A is m x n, B is n x p and C is m x p. C must not
+// overlap A or B
+void kernel_mat_mul(float *C, const float *A, const float *B, uint8_t m, uint8_t n, uint8_t p);
+void kernel_mat_mul_scalar(float *C, const float *A, const float *B, uint8_t m, uint8_t n, uint8_t p);
+
+// C = A^T * B, where A is n x m, B is n x p and C is m x p. C must
+// not overlap A or B
+void kernel_mat_mul_transA(float *C, const float *A, const float *B, uint8_t m, uint8_t n, uint8_t p);
+void kernel_mat_mul_transA_scalar(float *C, const float *A, const float *B, uint8_t m, uint8_t n, uint8_t p);
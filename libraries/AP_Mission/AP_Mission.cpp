@@ -5,6 +5,9 @@
 #include <AP_Terrain/AP_Terrain.h>
 #include <GCS_MAVLink/GCS.h>
 #include <AP_AHRS/AP_AHRS.h>
+#ifdef ENABLE_SCRIPTING
+#include <AP_Scripting/AP_Scripting.h>
+#endif
 
 const AP_Param::GroupInfo AP_Mission::var_info[] = {
 
@@ -48,6 +51,8 @@ HAL_Semaphore_Recursive AP_Mission::_rsem;
 /// init - initialises this library including checks the version in eeprom matches this library
 void AP_Mission::init()
 {
+    init_cache();
+
     // check_eeprom_version - checks version of missions stored in eeprom matches this library
     // command list will be cleared if they do not match
     check_eeprom_version();
@@ -203,6 +208,10 @@ bool AP_Mission::clear()
     _flags.nav_cmd_loaded = false;
     _flags.do_cmd_loaded = false;
 
+#ifdef ENABLE_SCRIPTING
+    AP_Scripting::post_event(AP_Scripting::Event::MISSION_CHANGED, 0);
+#endif
+
     // return success
     return true;
 }
@@ -213,6 +222,9 @@ void AP_Mission::truncate(uint16_t index)
 {
     if ((unsigned)_cmd_total > index) {        
         _cmd_total.set_and_save(index);
+#ifdef ENABLE_SCRIPTING
+        AP_Scripting::post_event(AP_Scripting::Event::MISSION_CHANGED, index);
+#endif
     }
 }
 
@@ -284,6 +296,9 @@ bool AP_Mission::verify_command(const Mission_Command& cmd)
 bool AP_Mission::start_command(const Mission_Command& cmd)
 {
     gcs().send_text(MAV_SEVERITY_INFO, "Mission: %u %s", cmd.index, cmd.type());
+#ifdef ENABLE_SCRIPTING
+    AP_Scripting::post_event(AP_Scripting::Event::MISSION_ITEM, cmd.index);
+#endif
     switch (cmd.id) {
     case MAV_CMD_DO_GRIPPER:
         return start_command_do_gripper(cmd);
@@ -354,6 +369,13 @@ bool AP_Mission::get_next_nav_cmd(uint16_t start_index, Mission_Command& cmd)
 {
     // search until the end of the mission command list
     for (uint16_t cmd_index = start_index; cmd_index < (unsigned)_cmd_total; cmd_index++) {
+#if AP_MISSION_FULL_CACHE_ENABLED
+        // skip straight past do commands
+        cmd_index = next_nav_index(cmd_index);
+        if (cmd_index >= (unsigned)_cmd_total) {
+            break;
+        }
+#endif
         // get next command
         if (!get_next_cmd(cmd_index, cmd, false)) {
             // no more commands so return failure
@@ -520,6 +542,14 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
         return false;
     }
 
+    if (_cache_size > 0) {
+        const Mission_Command &cached = _cache[index % _cache_size];
+        if (cached.index == index) {
+            cmd = cached;
+            return true;
+        }
+    }
+
     // Find out proper location in memory by using the start_byte position + the index
     // we can load a command, we don't process it yet
     // read WP position
@@ -567,6 +597,10 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
     // set command's index to it's position in eeprom
     cmd.index = index;
 
+    if (_cache_size > 0) {
+        _cache[index % _cache_size] = cmd;
+    }
+
     // return success
     return true;
 }
@@ -642,13 +676,85 @@ bool AP_Mission::write_cmd_to_storage(uint16_t index, const Mission_Command& cmd
         _storage.write_block(pos_in_storage+5, packed.bytes, 10);
     }
 
+    if (_cache_size > 0) {
+        // drop the slot rather than storing cmd, so a 16 bit command
+        // reads back with the two content bytes storage can't hold
+        Mission_Command &cached = _cache[index % _cache_size];
+        if (cached.index == index) {
+            cached.index = 0;
+        }
+    }
+#if AP_MISSION_FULL_CACHE_ENABLED
+    _next_nav_index_total = 0;
+#endif
+
     // remember when the mission last changed
     _last_change_time_ms = AP_HAL::millis();
+#ifdef ENABLE_SCRIPTING
+    AP_Scripting::post_event(AP_Scripting::Event::MISSION_CHANGED, _cmd_total);
+#endif
 
     // return success
     return true;
 }
 
+// allocate the command cache, holding every command if there is enough memory
+void AP_Mission::init_cache()
+{
+    if (_cache != nullptr) {
+        return;
+    }
+#if AP_MISSION_FULL_CACHE_ENABLED
+    const uint16_t cmds_max = num_commands_max();
+    _cache = new Mission_Command[cmds_max];
+    _next_nav_index = new uint16_t[cmds_max];
+    if (_cache != nullptr && _next_nav_index != nullptr) {
+        _cache_size = cmds_max;
+        return;
+    }
+    delete[] _cache;
+    delete[] _next_nav_index;
+    _cache = nullptr;
+    _next_nav_index = nullptr;
+#endif
+#if AP_MISSION_CACHE_SIZE > 0
+    _cache = new Mission_Command[AP_MISSION_CACHE_SIZE];
+    if (_cache != nullptr) {
+        _cache_size = AP_MISSION_CACHE_SIZE;
+    }
+#endif
+}
+
+#if AP_MISSION_FULL_CACHE_ENABLED
+// return the index of the first navigation or do-jump command at or after index
+// returns index if the table is not available
+uint16_t AP_Mission::next_nav_index(uint16_t index)
+{
+    WITH_SEMAPHORE(_rsem);
+
+    const uint16_t total = _cmd_total;
+    if (_next_nav_index == nullptr || index >= total || total > _cache_size) {
+        return index;
+    }
+
+    if (_next_nav_index_total != total) {
+        // rebuild working back from the end of the mission, commands
+        // which can't be read are left for the caller to handle
+        uint16_t next = total;
+        for (uint16_t i = total; i > 0; i--) {
+            Mission_Command cmd;
+            if (!read_cmd_from_storage(i-1, cmd) || is_nav_cmd(cmd) || cmd.id == MAV_CMD_DO_JUMP) {
+                next = i-1;
+            }
+            _next_nav_index[i-1] = next;
+        }
+        _next_nav_index_total = total;
+    }
+
+    return _next_nav_index[index];
+}
+#endif
+
 /// write_home_to_storage - writes the special purpose cmd 0 (home) to storage
 ///     home is taken directly from ahrs
 void AP_Mission::write_home_to_storage()
@@ -39,6 +39,18 @@
 #define AP_MISSION_OPTIONS_DEFAULT          0       // Do not clear the mission when rebooting
 #define AP_MISSION_MASK_MISSION_CLEAR       (1<<0)  // If set then Clear the mission on boot
 
+#ifndef AP_MISSION_CACHE_SIZE
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_300
+#define AP_MISSION_CACHE_SIZE               64      // number of decoded commands kept in RAM
+#else
+#define AP_MISSION_CACHE_SIZE               0
+#endif
+#endif
+
+#ifndef AP_MISSION_FULL_CACHE_ENABLED
+#define AP_MISSION_FULL_CACHE_ENABLED       (HAL_MEM_CLASS >= HAL_MEM_CLASS_500)    // cache every command and index the navigation commands
+#endif
+
 /// @class    AP_Mission
 /// @brief    Object managing Mission
 class AP_Mission {
@@ -589,6 +601,27 @@ private:
     // const functions
     static HAL_Semaphore_Recursive _rsem;
 
+    // direct-mapped cache of decoded commands, slot is index modulo
+    // the cache size. A slot with index 0 is empty as home is never
+    // read from storage. Holds every command when
+    // AP_MISSION_FULL_CACHE_ENABLED and there is enough memory
+    mutable Mission_Command *_cache;
+    uint16_t _cache_size;
+
+    // allocate the command cache
+    void init_cache();
+
+#if AP_MISSION_FULL_CACHE_ENABLED
+    // index of the first navigation or do-jump command at or after
+    // each command, so searches for the next navigation command can
+    // skip do commands. Rebuilt when the mission changes
+    uint16_t *_next_nav_index;
+    uint16_t _next_nav_index_total;     // _cmd_total the table was built for, zero if out of date
+
+    // return the index of the first navigation or do-jump command at or after index
+    uint16_t next_nav_index(uint16_t index);
+#endif
+
     // mission items common to all vehicles:
     bool start_command_do_gripper(const AP_Mission::Mission_Command& cmd);
     bool start_command_do_servorelayevents(const AP_Mission::Mission_Command& cmd);
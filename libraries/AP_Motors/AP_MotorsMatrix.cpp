@@ -132,6 +132,31 @@ uint16_t AP_MotorsMatrix::get_motor_mask()
 // output_armed - sends commands to the motors
 // includes new scaling stability patch
 void AP_MotorsMatrix::output_armed_stabilizing()
+{
+    switch (_mixer_motors) {
+    case 4:
+        output_armed_stabilizing_motors<4, true>();
+        break;
+    case 6:
+        output_armed_stabilizing_motors<6, true>();
+        break;
+    case 8:
+        output_armed_stabilizing_motors<8, true>();
+        break;
+    default:
+        output_armed_stabilizing_motors<AP_MOTORS_MAX_NUM_MOTORS, false>();
+        break;
+    }
+}
+
+/*
+  mixer for num_motors motors. With all_enabled the motors are numbered
+  contiguously from zero and all enabled, which lets the compiler
+  unroll the loops over the motors and drop the per motor enabled
+  checks for the common frames
+ */
+template <uint8_t num_motors, bool all_enabled>
+void AP_MotorsMatrix::output_armed_stabilizing_motors()
 {
     uint8_t i;                          // general purpose counter
     float   roll_thrust;                // roll thrust input value, +/- 1.0
@@ -197,8 +222,8 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     // this is always equal to or less than the requested yaw from the pilot or rate controller
     float rp_low = 1.0f;    // lowest thrust value
     float rp_high = -1.0f;  // highest thrust value
-    for (i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
+    for (i = 0; i < num_motors; i++) {
+        if (all_enabled || motor_enabled[i]) {
             // calculate the thrust outputs for roll and pitch
             _thrust_rpyt_out[i] = roll_thrust * _roll_factor[i] + pitch_thrust * _pitch_factor[i];
             // record lowest roll + pitch command
@@ -233,7 +258,7 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     yaw_allowed = MAX(yaw_allowed, yaw_allowed_min);
 
     // Include the lost motor scaled by _thrust_boost_ratio to smoothly transition this motor in and out of the calculation
-    if (_thrust_boost && motor_enabled[_motor_lost_index]) {
+    if (_thrust_boost && (all_enabled || motor_enabled[_motor_lost_index])) {
         // record highest roll + pitch command
         if (_thrust_rpyt_out[_motor_lost_index] > rp_high) {
             rp_high = _thrust_boost_ratio * rp_high + (1.0f - _thrust_boost_ratio) * _thrust_rpyt_out[_motor_lost_index];
@@ -259,8 +284,8 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     // add yaw control to thrust outputs
     float rpy_low = 1.0f;   // lowest thrust value
     float rpy_high = -1.0f; // highest thrust value
-    for (i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
+    for (i = 0; i < num_motors; i++) {
+        if (all_enabled || motor_enabled[i]) {
             _thrust_rpyt_out[i] = _thrust_rpyt_out[i] + yaw_thrust * _yaw_factor[i];
 
             // record lowest roll + pitch + yaw command
@@ -277,7 +302,7 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     // Include the lost motor scaled by _thrust_boost_ratio to smoothly transition this motor in and out of the calculation
     if (_thrust_boost) {
         // record highest roll + pitch + yaw command
-        if (_thrust_rpyt_out[_motor_lost_index] > rpy_high && motor_enabled[_motor_lost_index]) {
+        if (_thrust_rpyt_out[_motor_lost_index] > rpy_high && (all_enabled || motor_enabled[_motor_lost_index])) {
             rpy_high = _thrust_boost_ratio * rpy_high + (1.0f - _thrust_boost_ratio) * _thrust_rpyt_out[_motor_lost_index];
         }
     }
@@ -317,8 +342,8 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     }
 
     // add scaled roll, pitch, constrained yaw and throttle for each motor
-    for (i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
+    for (i = 0; i < num_motors; i++) {
+        if (all_enabled || motor_enabled[i]) {
             _thrust_rpyt_out[i] = throttle_thrust_best_rpy + thr_adj + (rpy_scale * _thrust_rpyt_out[i]);
         }
     }
@@ -329,7 +354,7 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     _throttle_out = throttle_thrust_best_plus_adj / compensation_gain;
 
     // check for failed motor
-    check_for_failed_motor(throttle_thrust_best_plus_adj);
+    check_for_failed_motor<num_motors, all_enabled>(throttle_thrust_best_plus_adj);
 }
 
 // check for failed motor
@@ -340,12 +365,13 @@ void AP_MotorsMatrix::output_armed_stabilizing()
 //   records filtered motor output values in _thrust_rpyt_out_filt array
 //   sets thrust_balanced to true if motors are balanced, false if a motor failure is detected
 //   sets _motor_lost_index to index of failed motor
+template <uint8_t num_motors, bool all_enabled>
 void AP_MotorsMatrix::check_for_failed_motor(float throttle_thrust_best_plus_adj)
 {
     // record filtered and scaled thrust output for motor loss monitoring purposes
     float alpha = 1.0f / (1.0f + _loop_rate * 0.5f);
-    for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
+    for (uint8_t i = 0; i < num_motors; i++) {
+        if (all_enabled || motor_enabled[i]) {
             _thrust_rpyt_out_filt[i] += alpha * (_thrust_rpyt_out[i] - _thrust_rpyt_out_filt[i]);
         }
     }
@@ -353,8 +379,8 @@ void AP_MotorsMatrix::check_for_failed_motor(float throttle_thrust_best_plus_adj
     float rpyt_high = 0.0f;
     float rpyt_sum = 0.0f;
     uint8_t number_motors = 0.0f;
-    for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
+    for (uint8_t i = 0; i < num_motors; i++) {
+        if (all_enabled || motor_enabled[i]) {
             number_motors += 1;
             rpyt_sum += _thrust_rpyt_out_filt[i];
             // record highest filtered thrust command
@@ -827,9 +853,41 @@ void AP_MotorsMatrix::setup_motors(motor_frame_class frame_class, motor_frame_ty
     // normalise factors to magnitude 0.5
     normalise_rpy_factors();
 
+    select_mixer();
+
     _flags.initialised_ok = success;
 }
 
+/*
+  choose the mixer specialised for the number of motors if the motors
+  are numbered contiguously from zero, as they are on the common quad,
+  hexa and octa frames
+ */
+void AP_MotorsMatrix::select_mixer()
+{
+    uint8_t num_motors = 0;
+    while (num_motors < AP_MOTORS_MAX_NUM_MOTORS && motor_enabled[num_motors]) {
+        num_motors++;
+    }
+    for (uint8_t i = num_motors; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        if (motor_enabled[i]) {
+            // not contiguous, use the generic mixer
+            num_motors = 0;
+            break;
+        }
+    }
+    switch (num_motors) {
+    case 4:
+    case 6:
+    case 8:
+        _mixer_motors = num_motors;
+        break;
+    default:
+        _mixer_motors = 0;
+        break;
+    }
+}
+
 // normalizes the roll, pitch and yaw factors so maximum magnitude is 0.5
 void AP_MotorsMatrix::normalise_rpy_factors()
 {
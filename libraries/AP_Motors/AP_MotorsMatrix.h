@@ -59,9 +59,17 @@ protected:
     // output - sends commands to the motors
     void                output_armed_stabilizing() override;
 
+    // mixer for a number of motors, see output_armed_stabilizing()
+    template <uint8_t num_motors, bool all_enabled>
+    void                output_armed_stabilizing_motors();
+
     // check for failed motor
+    template <uint8_t num_motors, bool all_enabled>
     void                check_for_failed_motor(float throttle_thrust_best);
 
+    // choose a mixer specialised for the motors in use
+    void                select_mixer();
+
     // add_motor using raw roll, pitch, throttle and yaw factors
     void                add_motor_raw(int8_t motor_num, float roll_fac, float pitch_fac, float yaw_fac, uint8_t testing_order);
 
@@ -94,4 +102,7 @@ protected:
     // motor failure handling
     float               _thrust_rpyt_out_filt[AP_MOTORS_MAX_NUM_MOTORS];    // filtered thrust outputs with 1 second time constant
     uint8_t             _motor_lost_index;  // index number of the lost motor
+
+    // number of motors for the specialised mixer, zero for the generic mixer
+    uint8_t             _mixer_motors;
 };
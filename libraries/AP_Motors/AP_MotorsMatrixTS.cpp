@@ -171,5 +171,7 @@ void AP_MotorsMatrixTS::setup_motors(motor_frame_class frame_class, motor_frame_
     // normalise factors to magnitude 0.5
     normalise_rpy_factors();
 
+    select_mixer();
+
     _flags.initialised_ok = success;
 }
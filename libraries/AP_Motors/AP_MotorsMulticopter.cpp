@@ -22,6 +22,7 @@
 #include "AP_MotorsMulticopter.h"
 #include <AP_HAL/AP_HAL.h>
 #include <AP_BattMonitor/AP_BattMonitor.h>
+#include <AP_OutputLatency/AP_OutputLatency.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -255,6 +256,11 @@ void AP_MotorsMulticopter::output()
 
     // output any booster throttle
     output_boost_throttle();
+
+    AP_OutputLatency *latency = AP::output_latency();
+    if (latency != nullptr) {
+        latency->stage(AP_OutputLatency::Stage::MIXER);
+    }
 };
 
 // output booster throttle, if any
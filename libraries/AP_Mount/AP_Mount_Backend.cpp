@@ -132,25 +132,49 @@ float AP_Mount_Backend::angle_input_rad(const RC_Channel* rc, int16_t angle_min,
 }
 
 // calc_angle_to_location - calculates the earth-frame roll, tilt and pan angles (and radians) to point at the given target
+//  the angles are only recalculated when the target changes or the vehicle has moved significantly relative to its distance from the target
 void AP_Mount_Backend::calc_angle_to_location(const struct Location &target, Vector3f& angles_to_target_rad, bool calc_tilt, bool calc_pan, bool relative_pan)
 {
-    float GPS_vector_x = (target.lng-_frontend._current_loc.lng)*cosf(ToRad((_frontend._current_loc.lat+target.lat)*0.00000005f))*0.01113195f;
-    float GPS_vector_y = (target.lat-_frontend._current_loc.lat)*0.01113195f;
-    float GPS_vector_z = (target.alt-_frontend._current_loc.alt);                 // baro altitude(IN CM) should be adjusted to known home elevation before take off (Set altimeter).
-    float target_distance = 100.0f*norm(GPS_vector_x, GPS_vector_y);      // Careful , centimeters here locally. Baro/alt is in cm, lat/lon is in meters.
+    const Location &current_loc = _frontend._current_loc;
+
+    // distance moved since the angles were calculated. The longitude
+    // difference is not scaled by latitude so this never under estimates
+    const float moved_x = (current_loc.lng - _roi_cache.vehicle.lng) * 1.113195f;
+    const float moved_y = (current_loc.lat - _roi_cache.vehicle.lat) * 1.113195f;
+    const float moved_z = current_loc.alt - _roi_cache.vehicle.alt;
+    const float recalc_sq = sq(_roi_cache.recalc_dist_cm);
+
+    if (!_roi_cache.valid ||
+        target.lat != _roi_cache.target.lat ||
+        target.lng != _roi_cache.target.lng ||
+        target.alt != _roi_cache.target.alt ||
+        sq(moved_x) + sq(moved_y) > recalc_sq ||
+        sq(moved_z) > recalc_sq) {
+        float GPS_vector_x = (target.lng-current_loc.lng)*cosf(ToRad((current_loc.lat+target.lat)*0.00000005f))*0.01113195f;
+        float GPS_vector_y = (target.lat-current_loc.lat)*0.01113195f;
+        float GPS_vector_z = (target.alt-current_loc.alt);                 // baro altitude(IN CM) should be adjusted to known home elevation before take off (Set altimeter).
+        float target_distance = 100.0f*norm(GPS_vector_x, GPS_vector_y);      // Careful , centimeters here locally. Baro/alt is in cm, lat/lon is in meters.
+
+        _roi_cache.tilt_rad = atan2f(GPS_vector_z, target_distance);
+        _roi_cache.pan_rad = atan2f(GPS_vector_x, GPS_vector_y);
+        _roi_cache.recalc_dist_cm = MAX(norm(target_distance, GPS_vector_z) * AP_MOUNT_ROI_RECALC_FRACTION, AP_MOUNT_ROI_RECALC_MIN_CM);
+        _roi_cache.target = target;
+        _roi_cache.vehicle = current_loc;
+        _roi_cache.valid = true;
+    }
 
     // initialise all angles to zero
     angles_to_target_rad.zero();
 
     // tilt calcs
     if (calc_tilt) {
-        angles_to_target_rad.y = atan2f(GPS_vector_z, target_distance);
+        angles_to_target_rad.y = _roi_cache.tilt_rad;
     }
 
     // pan calcs
     if (calc_pan) {
         // calc absolute heading and then onvert to vehicle relative yaw
-        angles_to_target_rad.z = atan2f(GPS_vector_x, GPS_vector_y);
+        angles_to_target_rad.z = _roi_cache.pan_rad;
         if (relative_pan) {
             angles_to_target_rad.z = wrap_PI(angles_to_target_rad.z - AP::ahrs().yaw);
         }
@@ -23,6 +23,11 @@
 #include "AP_Mount.h"
 #include <RC_Channel/RC_Channel.h>
 
+// the angles to an ROI are recalculated when the vehicle has moved by this
+// fraction of its distance from the ROI, or by AP_MOUNT_ROI_RECALC_MIN_CM
+#define AP_MOUNT_ROI_RECALC_FRACTION    0.01f
+#define AP_MOUNT_ROI_RECALC_MIN_CM      20.0f
+
 class AP_Mount_Backend
 {
 public:
@@ -100,4 +105,16 @@ protected:
 private:
 
     void rate_input_rad(float &out, const RC_Channel *ch, float min, float max) const;
+
+    // angles from the vehicle to the last target given to
+    // calc_angle_to_location, kept until the target or the vehicle
+    // moves significantly
+    struct {
+        Location target;
+        Location vehicle;
+        float recalc_dist_cm;   // vehicle movement which causes a recalculation
+        float tilt_rad;
+        float pan_rad;          // earth frame heading to the target
+        bool valid;
+    } _roi_cache;
 };
@@ -1,5 +1,6 @@
 #include "AP_Mount_Servo.h"
 #include <AP_GPS/AP_GPS.h>
+#include <AP_AHRS/AP_AHRS.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -35,6 +36,7 @@ void AP_Mount_Servo::update()
         _last_check_servo_map_ms = now;
     }
 
+    _flags.stabilizing = false;
     switch(get_mode()) {
         // move mount to a "retracted position" or to a position where a fourth servo can retract the entire mount into the fuselage
         case MAV_MOUNT_MODE_RETRACT:
@@ -54,7 +56,7 @@ void AP_Mount_Servo::update()
         case MAV_MOUNT_MODE_MAVLINK_TARGETING:
         {
             // earth-frame angle targets (i.e. _angle_ef_target_rad) should have already been set by a MOUNT_CONTROL message from GCS
-            stabilize();
+            _flags.stabilizing = true;
             break;
         }
 
@@ -63,7 +65,7 @@ void AP_Mount_Servo::update()
         {
             // update targets using pilot's rc inputs
             update_targets_from_rc();
-            stabilize();
+            _flags.stabilizing = true;
             break;
         }
 
@@ -72,7 +74,7 @@ void AP_Mount_Servo::update()
         {
             if(AP::gps().status() >= AP_GPS::GPS_OK_FIX_2D) {
                 calc_angle_to_location(_state._roi_target, _angle_ef_target_rad, _flags.tilt_control, _flags.pan_control, false);
-                stabilize();
+                _flags.stabilizing = true;
             }
             break;
         }
@@ -82,6 +84,13 @@ void AP_Mount_Servo::update()
             break;
     }
 
+    // stabilize here too for vehicles which don't call update_fast
+    if (_flags.stabilizing) {
+        AP_AHRS::Snapshot snap;
+        get_attitude(snap);
+        stabilize(snap);
+    }
+
     // move mount to a "retracted position" into the fuselage with a fourth servo
     bool mount_open_new = (get_mode() == MAV_MOUNT_MODE_RETRACT) ? 0 : 1;
     if (mount_open != mount_open_new) {
@@ -90,9 +99,26 @@ void AP_Mount_Servo::update()
     }
 
     // write the results to the servos
-    move_servo(_roll_idx, _angle_bf_output_deg.x*10, _state._roll_angle_min*0.1f, _state._roll_angle_max*0.1f);
-    move_servo(_tilt_idx, _angle_bf_output_deg.y*10, _state._tilt_angle_min*0.1f, _state._tilt_angle_max*0.1f);
-    move_servo(_pan_idx,  _angle_bf_output_deg.z*10, _state._pan_angle_min*0.1f, _state._pan_angle_max*0.1f);
+    move_servos();
+}
+
+// update_fast - called at the main loop rate. The targets are updated by
+//  update() but the outputs are stabilized against each new attitude so
+//  they are not limited by the rate of update()
+void AP_Mount_Servo::update_fast()
+{
+    if (!_flags.stabilizing) {
+        return;
+    }
+    AP_AHRS::Snapshot snap;
+    const AP_AHRS &ahrs = AP::ahrs();
+    const uint32_t snapshot_count = ahrs.get_snapshot_count();
+    if (snapshot_count == _last_snapshot_count || !ahrs.get_snapshot(snap)) {
+        return;
+    }
+    _last_snapshot_count = snapshot_count;
+    stabilize(snap);
+    move_servos();
 }
 
 // set_mode - sets mount's mode
@@ -119,18 +145,31 @@ void AP_Mount_Servo::send_mount_status(mavlink_channel_t chan)
     mavlink_msg_mount_status_send(chan, 0, 0, _angle_bf_output_deg.y*100, _angle_bf_output_deg.x*100, _angle_bf_output_deg.z*100);
 }
 
+// get_attitude - latest vehicle attitude, from the AHRS snapshot if one has been published
+void AP_Mount_Servo::get_attitude(AP_AHRS::Snapshot &snap) const
+{
+    const AP_AHRS &ahrs = AP::ahrs();
+    if (ahrs.get_snapshot(snap)) {
+        return;
+    }
+    snap.quat.from_rotation_matrix(ahrs.get_rotation_body_to_ned());
+    snap.roll = ahrs.roll;
+    snap.pitch = ahrs.pitch;
+    snap.yaw = ahrs.yaw;
+    snap.gyro = ahrs.get_gyro();
+}
+
 // stabilize - stabilizes the mount relative to the Earth's frame
-//  input: _angle_ef_target_rad (earth frame targets in radians)
+//  input: _angle_ef_target_rad (earth frame targets in radians) and the vehicle attitude
 //  output: _angle_bf_output_deg (body frame angles in degrees)
-void AP_Mount_Servo::stabilize()
+void AP_Mount_Servo::stabilize(const AP_AHRS::Snapshot &snap)
 {
-    AP_AHRS &ahrs = AP::ahrs();
     // only do the full 3D frame transform if we are doing pan control
     if (_state._stab_pan) {
         Matrix3f m;                         ///< holds 3 x 3 matrix, var is used as temp in calcs
         Matrix3f cam;                       ///< Rotation matrix earth to camera. Desired camera from input.
         Matrix3f gimbal_target;             ///< Rotation matrix from plane to camera. Then Euler angles to the servos.
-        m = ahrs.get_rotation_body_to_ned();
+        snap.quat.rotation_matrix(m);
         m.transpose();
         cam.from_euler(_angle_ef_target_rad.x, _angle_ef_target_rad.y, _angle_ef_target_rad.z);
         gimbal_target = m * cam;
@@ -145,29 +184,39 @@ void AP_Mount_Servo::stabilize()
         _angle_bf_output_deg.y = degrees(_angle_ef_target_rad.y);
         _angle_bf_output_deg.z = degrees(_angle_ef_target_rad.z);
         if (_state._stab_roll) {
-            _angle_bf_output_deg.x -= degrees(ahrs.roll);
+            _angle_bf_output_deg.x -= degrees(snap.roll);
         }
         if (_state._stab_tilt) {
-            _angle_bf_output_deg.y -= degrees(ahrs.pitch);
+            _angle_bf_output_deg.y -= degrees(snap.pitch);
         }
 
         // lead filter
-        const Vector3f &gyro = ahrs.get_gyro();
+        const Vector3f &gyro = snap.gyro;
+        const float sin_roll = sinf(snap.roll);
+        const float cos_roll = cosf(snap.roll);
 
-        if (_state._stab_roll && !is_zero(_state._roll_stb_lead) && fabsf(ahrs.pitch) < M_PI/3.0f) {
+        if (_state._stab_roll && !is_zero(_state._roll_stb_lead) && fabsf(snap.pitch) < M_PI/3.0f) {
             // Compute rate of change of euler roll angle
-            float roll_rate = gyro.x + (ahrs.sin_pitch() / ahrs.cos_pitch()) * (gyro.y * ahrs.sin_roll() + gyro.z * ahrs.cos_roll());
+            float roll_rate = gyro.x + tanf(snap.pitch) * (gyro.y * sin_roll + gyro.z * cos_roll);
             _angle_bf_output_deg.x -= degrees(roll_rate) * _state._roll_stb_lead;
         }
 
         if (_state._stab_tilt && !is_zero(_state._pitch_stb_lead)) {
             // Compute rate of change of euler pitch angle
-            float pitch_rate = ahrs.cos_pitch() * gyro.y - ahrs.sin_roll() * gyro.z;
+            float pitch_rate = cosf(snap.pitch) * gyro.y - sin_roll * gyro.z;
             _angle_bf_output_deg.y -= degrees(pitch_rate) * _state._pitch_stb_lead;
         }
     }
 }
 
+// move_servos - writes the body frame output angles to the servos
+void AP_Mount_Servo::move_servos()
+{
+    move_servo(_roll_idx, _angle_bf_output_deg.x*10, _state._roll_angle_min*0.1f, _state._roll_angle_max*0.1f);
+    move_servo(_tilt_idx, _angle_bf_output_deg.y*10, _state._tilt_angle_min*0.1f, _state._tilt_angle_max*0.1f);
+    move_servo(_pan_idx,  _angle_bf_output_deg.z*10, _state._pan_angle_min*0.1f, _state._pan_angle_max*0.1f);
+}
+
 // closest_limit - returns closest angle to 'angle' taking into account limits.  all angles are in degrees * 10
 int16_t AP_Mount_Servo::closest_limit(int16_t angle, int16_t angle_min, int16_t angle_max)
 {
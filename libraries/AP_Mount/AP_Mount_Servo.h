@@ -29,6 +29,9 @@ public:
     // update mount position - should be called periodically
     void update() override;
 
+    // stabilize against the latest attitude at the main loop rate
+    void update_fast() override;
+
     // has_pan_control - returns true if this mount can control it's pan (required for multicopters)
     bool has_pan_control() const override { return _flags.pan_control; }
 
@@ -45,14 +48,21 @@ private:
         bool roll_control   :1; // true if mount has roll control
         bool tilt_control   :1; // true if mount has tilt control
         bool pan_control    :1; // true if mount has pan control
+        bool stabilizing    :1; // true if the mode being run needs stabilize()
     } _flags;
 
     // check_servo_map - detects which axis we control (i.e. _flags) using the functions assigned to the servos in the SRV_Channel
     //  should be called periodically (i.e. 1hz or less)
     void    check_servo_map();
 
+    // get_attitude - latest vehicle attitude, from the AHRS snapshot if one has been published
+    void get_attitude(AP_AHRS::Snapshot &snap) const;
+
     // stabilize - stabilizes the mount relative to the Earth's frame
-    void stabilize();
+    void stabilize(const AP_AHRS::Snapshot &snap);
+
+    // move_servos - writes the body frame output angles to the servos
+    void move_servos();
 
     // closest_limit - returns closest angle to 'angle' taking into account limits.  all angles are in degrees * 10
     int16_t closest_limit(int16_t angle, int16_t angle_min, int16_t angle_max);
@@ -69,4 +79,5 @@ private:
     Vector3f _angle_bf_output_deg;  // final body frame output angle in degrees
 
     uint32_t _last_check_servo_map_ms;  // system time of latest call to check_servo_map function
+    uint32_t _last_snapshot_count;      // AHRS snapshot last used by update_fast
 };
@@ -24,6 +24,7 @@
 #include <AP_Math/definitions.h>
 #include <AP_RTC/AP_RTC.h>
 #include <AP_SerialManager/AP_SerialManager.h>
+#include <AP_SerialManager/AP_SerialFrame.h>
 
 #include <stdio.h>
 #include <time.h>
@@ -55,14 +56,8 @@ AP_NMEA_Output* AP_NMEA_Output::probe()
 
 uint8_t AP_NMEA_Output::_nmea_checksum(const char *str)
 {
-    uint8_t checksum = 0;
-    const uint8_t* bytes = (const uint8_t*) str;
-
-    for (uint16_t i = 1; str[i]; i++) {
-        checksum ^= bytes[i];
-    }
-
-    return checksum;
+    // the checksum covers the characters between the $ and the *
+    return AP_SerialFrame::xor8((const uint8_t *)&str[1], strlen(&str[1]));
 }
 
 void AP_NMEA_Output::update()
@@ -120,17 +115,18 @@ void AP_NMEA_Output::update()
              loc.lng < 0 ? 'W' : 'E');
 
     // format GGA message
-    char* gga = nullptr;
-    int16_t gga_res = asprintf(&gga,
-                               "$GPGGA,%s,%s,%s,%01d,%02d,%04.1f,%07.2f,M,0.0,M,,",
-                               tstring,
-                               lat_string,
-                               lng_string,
-                               pos_valid ? 1 : 0,
-                               pos_valid ? 6 : 3,
-                               2.0,
-                               loc.alt * 0.01f);
-    if (gga_res == -1) {
+    char gga[100];
+    const int gga_res = snprintf(gga,
+                                 sizeof(gga),
+                                 "$GPGGA,%s,%s,%s,%01d,%02d,%04.1f,%07.2f,M,0.0,M,,",
+                                 tstring,
+                                 lat_string,
+                                 lng_string,
+                                 pos_valid ? 1 : 0,
+                                 pos_valid ? 6 : 3,
+                                 2.0,
+                                 loc.alt * 0.01f);
+    if (gga_res < 0 || gga_res >= int(sizeof(gga))) {
         return;
     }
     char gga_end[6];
@@ -142,48 +138,35 @@ void AP_NMEA_Output::update()
     float heading = wrap_360(degrees(atan2f(speed.x, speed.y)));
 
     // format RMC message
-    char* rmc = nullptr;
-    int16_t rmc_res = asprintf(&rmc,
-                               "$GPRMC,%s,%c,%s,%s,%.2f,%.2f,%s,,",
-                               tstring,
-                               pos_valid ? 'A' : 'V',
-                               lat_string,
-                               lng_string,
-                               speed_knots,
-                               heading,
-                               dstring);
-    if (rmc_res == -1) {
-        free(gga);
+    char rmc[100];
+    const int rmc_res = snprintf(rmc,
+                                 sizeof(rmc),
+                                 "$GPRMC,%s,%c,%s,%s,%.2f,%.2f,%s,,",
+                                 tstring,
+                                 pos_valid ? 'A' : 'V',
+                                 lat_string,
+                                 lng_string,
+                                 speed_knots,
+                                 heading,
+                                 dstring);
+    if (rmc_res < 0 || rmc_res >= int(sizeof(rmc))) {
         return;
     }
     char rmc_end[6];
     snprintf(rmc_end, sizeof(rmc_end), "*%02X\r\n", (unsigned) _nmea_checksum(rmc));
 
-    const uint32_t space_required = strlen(gga) + strlen(gga_end) + strlen(rmc) + strlen(rmc_end);
+    const uint32_t space_required = gga_res + strlen(gga_end) + rmc_res + strlen(rmc_end);
 
-    // send to all NMEA output ports
+    // send to all NMEA output ports, both sentences in one frame
     for (uint8_t i = 0; i < _num_outputs; i++) {
         if (_uart[i]->txspace() < space_required) {
             continue;
         }
-
-        if (gga_res != -1) {
-            _uart[i]->write(gga);
-            _uart[i]->write(gga_end);
-        }
-
-        if (rmc_res != -1) {
-            _uart[i]->write(rmc);
-            _uart[i]->write(rmc_end);
-        }
-    }
-
-    if (gga_res != -1) {
-        free(gga);
-    }
-
-    if (rmc_res != -1) {
-        free(rmc);
+        AP_SerialFrame out(_uart[i], AP_SerialFrame::Protocol::NMEA, space_required);
+        out.put((const uint8_t *)gga, gga_res);
+        out.put_str(gga_end);
+        out.put((const uint8_t *)rmc, rmc_res);
+        out.put_str(rmc_end);
     }
 }
 
@@ -23,3 +23,59 @@ void Log_EKF_Timing(const char *name, uint64_t time_us, const struct ekf_timing
         (double)timing.delVelDT_min,
         (double)timing.delVelDT_max);
 }
+
+/*
+  write an EKF observation buffer statistics message
+ */
+void Log_EKF_Buffers(const char *name, uint64_t time_us, const struct ekf_buffer_stats &stats)
+{
+    AP::logger().Write(
+        name,
+        "TimeUS,GD,GM,MD,MM,BD,BM,RD,RM,FD,FM,ND,NM,OD,OM",
+        "QHHHHHHHHHHHHHH",
+        time_us,
+        stats.gps.discarded, stats.gps.misses,
+        stats.mag.discarded, stats.mag.misses,
+        stats.baro.discarded, stats.baro.misses,
+        stats.range.discarded, stats.range.misses,
+        stats.flow.discarded, stats.flow.misses,
+        stats.beacon.discarded, stats.beacon.misses,
+        stats.other.discarded, stats.other.misses);
+}
+
+/*
+  write an EKF lane cost and switch statistics message
+ */
+void Log_EKF_Lane(const char *name, uint64_t time_us, const struct ekf_lane_stats &stats)
+{
+    AP::logger().Write(
+        name,
+        "TimeUS,Pri,Sby,Cnt,Avg,Max,Skip,Sw,SwLat",
+        "QBBIIIIHI",
+        time_us,
+        uint8_t(stats.primary),
+        uint8_t(stats.standby),
+        stats.count,
+        stats.avg_us,
+        stats.max_us,
+        stats.fusion_skips,
+        stats.switches,
+        stats.switch_latency_ms);
+}
+
+/*
+  write an EKF range beacon fusion cost message
+ */
+void Log_EKF_Beacon(const char *name, uint64_t time_us, const struct ekf_beacon_stats &stats)
+{
+    AP::logger().Write(
+        name,
+        "TimeUS,Bat,Cnt,Meas,Avg,Max",
+        "QBIIII",
+        time_us,
+        uint8_t(stats.batch),
+        stats.count,
+        stats.meas,
+        stats.avg_us,
+        stats.max_us);
+}
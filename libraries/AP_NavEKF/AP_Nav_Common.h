@@ -76,3 +76,47 @@ struct ekf_timing {
     float delVelDT_min;
 };
 void Log_EKF_Timing(const char *name, uint64_t time_us, const struct ekf_timing &timing);
+
+/*
+  structure to hold EKF observation buffer statistics. For each sensor
+  this is the number of samples discarded without being fused and the
+  number of recalls that failed because the sample at the fusion time
+  horizon was stale. Airspeed is counted with the other sensors, as a
+  log message has at most 16 fields
+ */
+struct ekf_buffer_stats {
+    struct counts {
+        uint16_t discarded;
+        uint16_t misses;
+    } gps, mag, baro, range, flow, beacon, other;
+};
+void Log_EKF_Buffers(const char *name, uint64_t time_us, const struct ekf_buffer_stats &stats);
+
+/*
+  structure to hold the cost of running an EKF lane and its lane
+  switch history, so the cost of standby lanes can be compared with
+  lanes run at the full rate
+ */
+struct ekf_lane_stats {
+    uint32_t count;             // filter updates
+    uint32_t avg_us;            // average time taken by an update
+    uint32_t max_us;            // longest update
+    uint32_t fusion_skips;      // updates where a standby lane did not fuse measurements
+    uint16_t switches;          // number of switches to this lane
+    uint32_t switch_latency_ms; // time from the old primary failing to the last switch to this lane
+    bool primary;
+    bool standby;
+};
+void Log_EKF_Lane(const char *name, uint64_t time_us, const struct ekf_lane_stats &stats);
+
+/*
+  structure to hold the cost of range beacon fusion
+ */
+struct ekf_beacon_stats {
+    uint32_t count;             // updates which fused beacon ranges
+    uint32_t meas;              // ranges fused
+    uint32_t avg_us;            // average time taken by an update
+    uint32_t max_us;            // longest update
+    bool batch;                 // true when beacons are fused in batches
+};
+void Log_EKF_Beacon(const char *name, uint64_t time_us, const struct ekf_beacon_stats &stats);
@@ -0,0 +1,63 @@
+/*
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  integrate small increments into a float vector, such as the position
+  states, without losing the part of each increment that is below the
+  resolution of the float. At 30km from the origin a float position
+  has a resolution of 2mm, which is comparable to the distance
+  travelled in one IMU step, so plain float sums lose accuracy at
+  exactly the ranges RTK is used over.
+
+  The part of the sum the float can't hold is carried in T and added
+  back in with the next increment. With T=float this is compensated
+  (Kahan) summation, which costs a few extra single precision
+  operations. With T=double the sum is done in double precision,
+  which is only worth it on boards with a double precision FPU.
+
+  The vector may still be changed directly between increments, by
+  fusion corrections and resets, as the carried part is always less
+  than the resolution of the float
+ */
+
+#include <AP_Math/AP_Math.h>
+
+template <typename T>
+class EKF_Accumulator3 {
+public:
+    // v += inc, keeping the part that doesn't fit in v for next time
+    void add(Vector3f &v, const Vector3f &inc) {
+        add(v.x, inc.x, _carry[0]);
+        add(v.y, inc.y, _carry[1]);
+        add(v.z, inc.z, _carry[2]);
+    }
+
+    // forget the carried part, when v has been reset
+    void reset() {
+        _carry[0] = _carry[1] = _carry[2] = 0;
+    }
+
+private:
+    static void add(float &v, float inc, T &carry) {
+        const T y = T(inc) + carry;
+        const float v0 = v;
+        v = float(T(v0) + y);
+        // the change in v is exact, so this is what it missed
+        carry = y - (T(v) - T(v0));
+    }
+
+    T _carry[3] {};
+};
@@ -0,0 +1,209 @@
+/*
+  EKF buffer models shared by EKF2 and EKF3
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EKF_Buffer.h"
+
+#include <string.h>
+
+ekf_ring_buffer::ekf_ring_buffer(uint16_t elsize, uint16_t time_offset) :
+    _buffer(nullptr),
+    _elsize(elsize),
+    _time_offset(time_offset),
+    _size(0),
+    _oldest(0),
+    _count(0),
+    _discarded(0),
+    _recall_misses(0)
+{
+}
+
+bool ekf_ring_buffer::init(uint32_t size)
+{
+    _buffer = new uint8_t[size * _elsize];
+    if (_buffer == nullptr) {
+        return false;
+    }
+    memset(_buffer, 0, size * _elsize);
+    _size = size;
+    _oldest = 0;
+    _count = 0;
+    _discarded = 0;
+    _recall_misses = 0;
+    return true;
+}
+
+uint32_t ekf_ring_buffer::time_ms(const uint8_t *element) const
+{
+    uint32_t t;
+    memcpy(&t, &element[_time_offset], sizeof(t));
+    return t;
+}
+
+bool ekf_ring_buffer::recall(void *element, uint32_t sample_time)
+{
+    if (_count == 0) {
+        return false;
+    }
+
+    // find the number of samples at or before the fusion time horizon
+    uint8_t lo = 0, hi = _count;
+    while (lo < hi) {
+        const uint8_t mid = (lo + hi) / 2;
+        if (time_ms(at(mid)) <= sample_time) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0) {
+        // nothing has reached the time horizon yet
+        return false;
+    }
+
+    // use the most recent sample, provided it is not stale
+    const uint8_t *best = at(lo-1);
+    const bool success = (sample_time - time_ms(best)) < 100;
+    if (success) {
+        memcpy(element, best, _elsize);
+        _discarded += lo - 1;
+    } else {
+        _discarded += lo;
+        _recall_misses++;
+    }
+
+    // remove the samples we have used or skipped over
+    _oldest = wrap(_oldest + lo);
+    _count -= lo;
+    return success;
+}
+
+bool ekf_ring_buffer::recall_oldest(void *element, uint32_t sample_time)
+{
+    while (_count > 0) {
+        const uint8_t *oldest = at(0);
+        const uint32_t t = time_ms(oldest);
+        if (t > sample_time) {
+            // nothing else has reached the time horizon yet
+            return false;
+        }
+        const bool fresh = (sample_time - t) < 100;
+        if (fresh) {
+            memcpy(element, oldest, _elsize);
+        } else {
+            // too old to fuse
+            _discarded++;
+            _recall_misses++;
+        }
+        _oldest = wrap(_oldest + 1);
+        _count--;
+        if (fresh) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ekf_ring_buffer::push(const void *element)
+{
+    if (_buffer == nullptr) {
+        return;
+    }
+    if (_count == _size) {
+        // full, so drop the oldest sample
+        _oldest = wrap(_oldest + 1);
+        _count--;
+        _discarded++;
+    }
+    // data normally arrives in time order, so this rarely moves
+    // anything
+    const uint32_t t = time_ms((const uint8_t *)element);
+    uint8_t i = _count;
+    while (i > 0 && time_ms(at(i-1)) > t) {
+        memcpy(at(i), at(i-1), _elsize);
+        i--;
+    }
+    memcpy(at(i), element, _elsize);
+    _count++;
+}
+
+void ekf_ring_buffer::reset()
+{
+    _oldest = 0;
+    _count = 0;
+    if (_buffer != nullptr) {
+        memset(_buffer, 0, _size * _elsize);
+    }
+}
+
+void ekf_ring_buffer::get_and_reset_stats(uint16_t &discarded, uint16_t &recall_misses)
+{
+    discarded = _discarded;
+    recall_misses = _recall_misses;
+    _discarded = 0;
+    _recall_misses = 0;
+}
+
+ekf_imu_buffer::ekf_imu_buffer(uint16_t elsize) :
+    _buffer(nullptr),
+    _elsize(elsize),
+    _size(0),
+    _oldest(0),
+    _youngest(0),
+    _filled(false)
+{
+}
+
+bool ekf_imu_buffer::init(uint32_t size)
+{
+    _buffer = new uint8_t[size * _elsize];
+    if (_buffer == nullptr) {
+        return false;
+    }
+    memset(_buffer, 0, size * _elsize);
+    _size = size;
+    _youngest = 0;
+    _oldest = 0;
+    return true;
+}
+
+void ekf_imu_buffer::push_youngest_element(const void *element)
+{
+    // push youngest to the buffer
+    _youngest = (_youngest+1) % _size;
+    memcpy(get(_youngest), element, _elsize);
+    // set oldest data index
+    _oldest = (_youngest+1) % _size;
+    if (_oldest == 0) {
+        _filled = true;
+    }
+}
+
+void ekf_imu_buffer::reset_history(const void *element)
+{
+    for (uint8_t index=0; index<_size; index++) {
+        memcpy(get(index), element, _elsize);
+    }
+}
+
+void ekf_imu_buffer::reset()
+{
+    _youngest = 0;
+    _oldest = 0;
+    if (_buffer != nullptr) {
+        memset(_buffer, 0, _size * _elsize);
+    }
+}
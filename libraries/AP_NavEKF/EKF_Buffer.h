@@ -0,0 +1,190 @@
+/*
+  EKF buffer models shared by EKF2 and EKF3
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  The buffers are implemented once on untyped elements of a size given
+  at construction, with thin typed templates over them. This means one
+  copy of the buffer code serves every element type of both filters,
+  rather than one copy per element type per filter
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+// this buffer model is to be used for observation buffers,
+// the data is pushed into buffer like any standard ring buffer
+// and kept in time order, so the sample to fuse can be found with
+// a binary search on the sample time
+class ekf_ring_buffer
+{
+public:
+    // elements are elsize bytes with a uint32_t time in milliseconds
+    // at time_offset
+    ekf_ring_buffer(uint16_t elsize, uint16_t time_offset);
+
+    // initialise buffer, returns false when allocation has failed
+    bool init(uint32_t size);
+
+    /*
+     * Searches the buffer for the newest data that is not newer than the
+     * time specified by sample_time_ms
+     * Removes that data and anything older so it cannot be used again
+     * Returns false if no data can be found that is less than 100msec old
+    */
+    bool recall(void *element, uint32_t sample_time);
+
+    /*
+     * Removes the oldest data that is not newer than sample_time, for
+     * fusing every sample up to the time horizon in turn rather than
+     * only the newest. Data more than 100msec old is discarded
+     * Returns false if there is no such data left
+    */
+    bool recall_oldest(void *element, uint32_t sample_time);
+
+    /*
+     * Writes data and timestamp to a Ring buffer, keeping the data in
+     * time order. If the buffer is full then the oldest data is discarded
+    */
+    void push(const void *element);
+
+    // zeroes all data in the ring buffer
+    void reset();
+
+    // return the number of samples removed without being returned by
+    // recall(), and the number of recalls that failed because the
+    // data at the time horizon was stale, then zero the counts
+    void get_and_reset_stats(uint16_t &discarded, uint16_t &recall_misses);
+
+private:
+    // index wrapped to the buffer size. Only used for indexes less
+    // than twice the buffer size
+    uint8_t wrap(uint16_t index) const {
+        return index >= _size ? index - _size : index;
+    }
+
+    // sample i in time order, where 0 is the oldest
+    uint8_t *at(uint8_t i) const {
+        return &_buffer[wrap(_oldest + i) * _elsize];
+    }
+
+    uint32_t time_ms(const uint8_t *element) const;
+
+    uint8_t *_buffer;
+    const uint16_t _elsize;
+    const uint16_t _time_offset;
+    uint8_t _size,_oldest,_count;
+    uint16_t _discarded,_recall_misses;
+};
+
+template <typename element_type>
+class obs_ring_buffer_t : public ekf_ring_buffer
+{
+public:
+    obs_ring_buffer_t() :
+        ekf_ring_buffer(sizeof(element_type), offsetof(element_type, time_ms)) {}
+
+    bool recall(element_type &element, uint32_t sample_time) {
+        return ekf_ring_buffer::recall(&element, sample_time);
+    }
+
+    bool recall_oldest(element_type &element, uint32_t sample_time) {
+        return ekf_ring_buffer::recall_oldest(&element, sample_time);
+    }
+
+    void push(const element_type &element) {
+        ekf_ring_buffer::push(&element);
+    }
+};
+
+
+// Following buffer model is for IMU data,
+// it achieves a distance of sample size
+// between youngest and oldest
+class ekf_imu_buffer
+{
+public:
+    ekf_imu_buffer(uint16_t elsize);
+
+    // initialise buffer, returns false when allocation has failed
+    bool init(uint32_t size);
+
+    /*
+     * Writes data to a Ring buffer and advances indices that
+     * define the location of the newest and oldest data
+    */
+    void push_youngest_element(const void *element);
+
+    // return true if the buffer has been filled at least once
+    bool is_filled(void) const {
+        return _filled;
+    }
+
+    // writes the same data to all elements in the ring buffer
+    void reset_history(const void *element);
+
+    // zeroes all data in the ring buffer
+    void reset();
+
+    // returns the index for the ring buffer oldest data
+    uint8_t get_oldest_index() const {
+        return _oldest;
+    }
+
+    // returns the index for the ring buffer youngest data
+    uint8_t get_youngest_index() const {
+        return _youngest;
+    }
+
+protected:
+    // element at a buffer index
+    void *get(uint8_t index) const {
+        return &_buffer[index * _elsize];
+    }
+
+private:
+    uint8_t *_buffer;
+    const uint16_t _elsize;
+    uint8_t _size,_oldest,_youngest;
+    bool _filled;
+};
+
+template <typename element_type>
+class imu_ring_buffer_t : public ekf_imu_buffer
+{
+public:
+    imu_ring_buffer_t() :
+        ekf_imu_buffer(sizeof(element_type)) {}
+
+    void push_youngest_element(const element_type &element) {
+        ekf_imu_buffer::push_youngest_element(&element);
+    }
+
+    // retrieve the oldest data from the ring buffer tail
+    element_type pop_oldest_element() {
+        return *(element_type *)get(get_oldest_index());
+    }
+
+    void reset_history(const element_type &element) {
+        ekf_imu_buffer::reset_history(&element);
+    }
+
+    // retrieves data from the ring buffer at a specified index
+    element_type& operator[](uint32_t index) {
+        return *(element_type *)get(index);
+    }
+};
@@ -662,7 +662,7 @@ bool NavEKF2::InitialiseFilter(void)
         }
 
         // try to allocate from CCM RAM, fallback to Normal RAM if not available or full
-        core = (NavEKF2_core*)hal.util->malloc_type(sizeof(NavEKF2_core)*num_cores, AP_HAL::Util::MEM_FAST);
+        core = (NavEKF2_core*)hal.util->malloc_type(sizeof(NavEKF2_core)*num_cores, AP_HAL::Util::MEM_FAST, "EKF2");
         if (core == nullptr) {
             _enable.set(0);
             gcs().send_text(MAV_SEVERITY_CRITICAL, "NavEKF2: allocation failed");
@@ -1597,6 +1597,21 @@ void NavEKF2::getTimingStatistics(int8_t instance, struct ekf_timing &timing) co
     }
 }
 
+/*
+  get observation buffer statistics structure
+*/
+void NavEKF2::getBufferStatistics(int8_t instance, struct ekf_buffer_stats &stats) const
+{
+    if (instance < 0 || instance >= num_cores) {
+        instance = primary;
+    }
+    if (core) {
+        core[instance].getBufferStatistics(stats);
+    } else {
+        memset(&stats, 0, sizeof(stats));
+    }
+}
+
 /*
  * Write position and quaternion data from an external navigation system
  *
@@ -328,6 +328,9 @@ public:
     // get timing statistics structure
     void getTimingStatistics(int8_t instance, struct ekf_timing &timing) const;
 
+    // get observation buffer statistics structure
+    void getBufferStatistics(int8_t instance, struct ekf_buffer_stats &stats) const;
+
     /*
      * Write position and quaternion data from an external navigation system
      *
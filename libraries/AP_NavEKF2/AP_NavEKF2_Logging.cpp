@@ -283,5 +283,18 @@ void NavEKF2::Log_Write()
                 Log_EKF_Timing("NKT3", time_us, timing);
             }
         }
+
+        // and the observation buffer statistics
+        struct ekf_buffer_stats stats;
+        for (uint8_t i=0; i<activeCores(); i++) {
+            getBufferStatistics(i, stats);
+            if (i == 0) {
+                Log_EKF_Buffers("NKB1", time_us, stats);
+            } else if (i == 1) {
+                Log_EKF_Buffers("NKB2", time_us, stats);
+            } else if (i == 2) {
+                Log_EKF_Buffers("NKB3", time_us, stats);
+            }
+        }
     }
 }
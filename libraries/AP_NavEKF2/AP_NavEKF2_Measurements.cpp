@@ -584,9 +584,10 @@ void NavEKF2_core::readGpsData()
             if (gpsGoodToAlign && !have_table_earth_field) {
                 const Compass *compass = _ahrs->get_compass();
                 if (compass && compass->have_scale_factor(magSelectIndex) && compass->auto_declination_enabled()) {
-                    table_earth_field_ga = AP_Declination::get_earth_field_ga(gpsloc);
-                    table_declination = radians(AP_Declination::get_declination(gpsloc.lat*1.0e-7,
-                                                                                gpsloc.lng*1.0e-7));
+                    AP_Declination::MagField field;
+                    AP_Declination::get_mag_field(gpsloc, field);
+                    table_earth_field_ga = field.earth_field_ga();
+                    table_declination = radians(field.declination_deg);
                     have_table_earth_field = true;
                     if (frontend->_mag_ef_limit > 0) {
                         // initialise earth field from tables
@@ -888,6 +889,24 @@ void NavEKF2_core::getTimingStatistics(struct ekf_timing &_timing)
     memset(&timing, 0, sizeof(timing));
 }
 
+// get observation buffer statistics structure
+void NavEKF2_core::getBufferStatistics(struct ekf_buffer_stats &stats)
+{
+    storedGPS.get_and_reset_stats(stats.gps.discarded, stats.gps.misses);
+    storedMag.get_and_reset_stats(stats.mag.discarded, stats.mag.misses);
+    storedBaro.get_and_reset_stats(stats.baro.discarded, stats.baro.misses);
+    storedRange.get_and_reset_stats(stats.range.discarded, stats.range.misses);
+    storedOF.get_and_reset_stats(stats.flow.discarded, stats.flow.misses);
+    storedRangeBeacon.get_and_reset_stats(stats.beacon.discarded, stats.beacon.misses);
+
+    // airspeed and external nav buffers are reported together
+    uint16_t discarded, misses;
+    storedTAS.get_and_reset_stats(stats.other.discarded, stats.other.misses);
+    storedExtNav.get_and_reset_stats(discarded, misses);
+    stats.other.discarded += discarded;
+    stats.other.misses += misses;
+}
+
 void NavEKF2_core::writeExtNavData(const Vector3f &sensOffset, const Vector3f &pos, const Quaternion &quat, float posErr, float angErr, uint32_t timeStamp_ms, uint32_t resetTime_ms)
 {
     // limit update rate to maximum allowed by sensor buffers and fusion process
@@ -31,7 +31,7 @@
 #include <stdio.h>
 #include <AP_Math/vectorN.h>
 #include <AP_NavEKF/AP_NavEKF_core_common.h>
-#include <AP_NavEKF2/AP_NavEKF2_Buffer.h>
+#include <AP_NavEKF/EKF_Buffer.h>
 #include <AP_InertialSensor/AP_InertialSensor.h>
 
 // GPS pre-flight check bit locations
@@ -310,6 +310,9 @@ public:
 
     // get timing statistics structure
     void getTimingStatistics(struct ekf_timing &timing);
+
+    // get observation buffer statistics structure, zeroing the counts
+    void getBufferStatistics(struct ekf_buffer_stats &stats);
     
     /*
      * Write position and quaternion data from an external navigation system
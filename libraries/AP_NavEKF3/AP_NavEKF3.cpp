@@ -604,6 +604,13 @@ const AP_Param::GroupInfo NavEKF3::var_info[] = {
     // @Units: mGauss
     AP_GROUPINFO("MAG_EF_LIM", 56, NavEKF3, _mag_ef_limit, 50),
 
+    // @Param: OPTIONS
+    // @DisplayName: EKF3 options
+    // @Description: Bitmask of EKF3 options. ParallelCores updates each EKF core after the first on its own thread, so that the cost of the cores overlaps rather than adding up on the main loop. ParallelCores is only available on Linux and SITL boards. StandbyLanes runs the cores other than the primary as standby lanes which fuse measurements at a reduced rate while the primary is healthy, to save CPU. They are still predicted at the full rate so they stay aligned, and all cores return to the full rate as soon as the primary starts to look unhealthy. BatchBeacons reads every range beacon with new data on each update and fuses all the ranges that have reached the fusion time horizon together, instead of one beacon per update, for systems with many beacons at high rates.
+    // @Bitmask: 0:ParallelCores,1:StandbyLanes,2:BatchBeacons
+    // @User: Advanced
+    AP_GROUPINFO("OPTIONS", 57, NavEKF3, _options, 0),
+
     AP_GROUPEND
 };
 
@@ -692,7 +699,7 @@ bool NavEKF3::InitialiseFilter(void)
         }
 
         //try to allocate from CCM RAM, fallback to Normal RAM if not available or full
-        core = (NavEKF3_core*)hal.util->malloc_type(sizeof(NavEKF3_core)*num_cores, AP_HAL::Util::MEM_FAST);
+        core = (NavEKF3_core*)hal.util->malloc_type(sizeof(NavEKF3_core)*num_cores, AP_HAL::Util::MEM_FAST, "EKF3");
             if (core == nullptr) {
             _enable.set(0);
             gcs().send_text(MAV_SEVERITY_CRITICAL, "NavEKF3: allocation failed");
@@ -755,7 +762,14 @@ void NavEKF3::UpdateFilter(void)
 
     const AP_InertialSensor &ins = AP::ins();
 
+    updateStandbyLanes();
+
     bool statePredictEnabled[num_cores];
+#if HAL_NAVEKF3_PARALLEL_CORES
+    const bool parallel = num_cores > 1 && option_is_set(Option::PARALLEL_CORES) && start_core_threads();
+#else
+    const bool parallel = false;
+#endif
     for (uint8_t i=0; i<num_cores; i++) {
         // if we have not overrun by more than 3 IMU frames, and we
         // have already used more than 1/3 of the CPU budget for this
@@ -767,8 +781,22 @@ void NavEKF3::UpdateFilter(void)
         } else {
             statePredictEnabled[i] = true;
         }
-        core[i].UpdateFilter(statePredictEnabled[i]);
+        if (!parallel) {
+            core[i].UpdateFilter(statePredictEnabled[i]);
+        }
     }
+#if HAL_NAVEKF3_PARALLEL_CORES
+    if (parallel) {
+        // unlike the serial updates, where a core's prediction
+        // permission is checked after the cores before it have used
+        // their share of the loop, every permission here is checked
+        // before any core runs. The cores' costs overlap, so a core
+        // is only held back by the time used before the EKF update,
+        // not by the cores before it. Core setup is unaffected, as
+        // InitialiseFilter() always runs the cores one after another
+        UpdateCoresParallel(statePredictEnabled);
+    }
+#endif
 
     // If the current core selected has a bad error score or is unhealthy, switch to a healthy core with the lowest fault score
     // Don't start running the check until the primary core has started returned healthy for at least 10 seconds to avoid switching
@@ -781,7 +809,13 @@ void NavEKF3::UpdateFilter(void)
         runCoreSelection = (imuSampleTime_us - lastUnhealthyTime_us) > 1E7;
     }
     float primaryErrorScore = core[primary].errorScore();
-    if ((primaryErrorScore > 1.0f || !core[primary].healthy()) && runCoreSelection) {
+    const bool primaryFailing = primaryErrorScore > 1.0f || !core[primary].healthy();
+    if (!primaryFailing) {
+        primaryFailing_ms = 0;
+    } else if (primaryFailing_ms == 0) {
+        primaryFailing_ms = MAX(AP_HAL::millis(), 1U);
+    }
+    if (primaryFailing && runCoreSelection) {
         float lowestErrorScore = 0.67f * primaryErrorScore;
         uint8_t newPrimaryIndex = primary; // index for new primary
         for (uint8_t coreIndex=0; coreIndex<num_cores; coreIndex++) {
@@ -805,6 +839,7 @@ void NavEKF3::UpdateFilter(void)
             updateLaneSwitchYawResetData(newPrimaryIndex, primary);
             updateLaneSwitchPosResetData(newPrimaryIndex, primary);
             updateLaneSwitchPosDownResetData(newPrimaryIndex, primary);
+            recordLaneSwitch(newPrimaryIndex, AP_HAL::millis());
             primary = newPrimaryIndex;
             lastLaneSwitch_ms = AP_HAL::millis();
         }
@@ -825,6 +860,105 @@ void NavEKF3::UpdateFilter(void)
     check_log_write();
 }
 
+/*
+  with the StandbyLanes option the cores other than the primary run as
+  standby lanes while the primary is healthy and its error score is
+  well below the level at which we would switch. Before core selection
+  starts, and as soon as the primary starts to degrade, every core is
+  run at the full rate so that any of them is ready to take over
+ */
+void NavEKF3::updateStandbyLanes(void)
+{
+    const bool standby = option_is_set(Option::STANDBY_LANES) &&
+        runCoreSelection &&
+        core[primary].healthy() &&
+        core[primary].errorScore() < 0.5f;
+    for (uint8_t i=0; i<num_cores; i++) {
+        core[i].setStandby(standby && i != primary);
+    }
+}
+
+/*
+  record a switch to a new primary core, with the time since the old
+  primary started to fail
+ */
+void NavEKF3::recordLaneSwitch(uint8_t new_primary, uint32_t now_ms)
+{
+    laneSwitchCount[new_primary]++;
+    laneSwitchLatency_ms[new_primary] = primaryFailing_ms != 0 ? now_ms - primaryFailing_ms : 0;
+    primaryFailing_ms = 0;
+    // the new primary runs at the full rate from its next update
+    core[new_primary].setStandby(false);
+}
+
+#if HAL_NAVEKF3_PARALLEL_CORES
+/*
+  start one worker thread for each core after the first. Threads are
+  never stopped, if the option is cleared they just stop being
+  signalled
+ */
+bool NavEKF3::start_core_threads(void)
+{
+    if (core_threads_failed) {
+        return false;
+    }
+    if (core_threads != nullptr) {
+        return true;
+    }
+    core_threads = new CoreThread[num_cores];
+    if (core_threads == nullptr) {
+        core_threads_failed = true;
+        return false;
+    }
+    for (uint8_t i=1; i<num_cores; i++) {
+        CoreThread &t = core_threads[i];
+        t.core = &core[i];
+        t.index = i;
+        if (!hal.scheduler->thread_create(FUNCTOR_BIND(&t, &CoreThread::thread_main, void),
+                                          "ekf3_core", 16384, AP_HAL::Scheduler::PRIORITY_MAIN, 0)) {
+            // any threads already created wait forever and are harmless
+            core_threads_failed = true;
+            gcs().send_text(MAV_SEVERITY_WARNING, "EKF3 core thread failed, running serially");
+            return false;
+        }
+    }
+    return true;
+}
+
+void NavEKF3::CoreThread::thread_main(void)
+{
+    // spread the cores over the CPUs, leaving the first one to the
+    // main thread where possible
+    const uint8_t num_cpus = hal.scheduler->get_num_cores();
+    if (num_cpus > 1) {
+        hal.scheduler->set_thread_affinity(index % num_cpus);
+    }
+    while (true) {
+        start.wait_blocking();
+        core->UpdateFilter(predict);
+        done.signal();
+    }
+}
+
+/*
+  update the first core on this thread and the others on their worker
+  threads, then wait for all of them. The wait acts as a barrier so
+  lane selection and the outputs always see every core at the same
+  point, as they do when the cores are run one after the other
+ */
+void NavEKF3::UpdateCoresParallel(const bool *statePredictEnabled)
+{
+    for (uint8_t i=1; i<num_cores; i++) {
+        core_threads[i].predict = statePredictEnabled[i];
+        core_threads[i].start.signal();
+    }
+    core[0].UpdateFilter(statePredictEnabled[0]);
+    for (uint8_t i=1; i<num_cores; i++) {
+        core_threads[i].done.wait_blocking();
+    }
+}
+#endif // HAL_NAVEKF3_PARALLEL_CORES
+
 /*
   check if switching lanes will reduce the normalised
   innovations. This is called when the vehicle code is about to
@@ -858,6 +992,7 @@ void NavEKF3::checkLaneSwitch(void)
         updateLaneSwitchYawResetData(newPrimaryIndex, primary);
         updateLaneSwitchPosResetData(newPrimaryIndex, primary);
         updateLaneSwitchPosDownResetData(newPrimaryIndex, primary);
+        recordLaneSwitch(newPrimaryIndex, now);
         primary = newPrimaryIndex;
         lastLaneSwitch_ms = now;
         gcs().send_text(MAV_SEVERITY_CRITICAL, "NavEKF3: lane switch %u", primary);
@@ -1691,3 +1826,51 @@ void NavEKF3::getTimingStatistics(int8_t instance, struct ekf_timing &timing) co
     }
 }
 
+/*
+  get range beacon fusion cost statistics structure
+*/
+void NavEKF3::getBeaconStatistics(int8_t instance, struct ekf_beacon_stats &stats) const
+{
+    if (instance < 0 || instance >= num_cores) {
+        instance = primary;
+    }
+    if (core) {
+        core[instance].getBeaconStatistics(stats);
+    } else {
+        memset(&stats, 0, sizeof(stats));
+    }
+}
+
+/*
+  get lane cost and switch statistics structure
+*/
+void NavEKF3::getLaneStatistics(int8_t instance, struct ekf_lane_stats &stats) const
+{
+    if (instance < 0 || instance >= num_cores) {
+        instance = primary;
+    }
+    if (core) {
+        core[instance].getLaneStatistics(stats);
+        stats.switches = laneSwitchCount[instance];
+        stats.switch_latency_ms = laneSwitchLatency_ms[instance];
+        stats.primary = (instance == primary);
+    } else {
+        memset(&stats, 0, sizeof(stats));
+    }
+}
+
+/*
+  get observation buffer statistics structure
+*/
+void NavEKF3::getBufferStatistics(int8_t instance, struct ekf_buffer_stats &stats) const
+{
+    if (instance < 0 || instance >= num_cores) {
+        instance = primary;
+    }
+    if (core) {
+        core[instance].getBufferStatistics(stats);
+    } else {
+        memset(&stats, 0, sizeof(stats));
+    }
+}
+
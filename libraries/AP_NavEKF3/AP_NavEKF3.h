@@ -19,6 +19,7 @@
  */
 #pragma once
 
+#include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_Param/AP_Param.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
@@ -28,6 +29,14 @@
 #include <AP_RangeFinder/AP_RangeFinder.h>
 #include <AP_Logger/LogStructure.h>
 
+/*
+  allow the cores to be updated in parallel on targets with more than
+  one CPU, controlled at runtime by EK3_OPTIONS
+ */
+#ifndef HAL_NAVEKF3_PARALLEL_CORES
+#define HAL_NAVEKF3_PARALLEL_CORES (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
 class NavEKF3_core;
 class AP_AHRS;
 
@@ -374,6 +383,15 @@ public:
     // get timing statistics structure
     void getTimingStatistics(int8_t instance, struct ekf_timing &timing) const;
 
+    // get observation buffer statistics structure
+    void getBufferStatistics(int8_t instance, struct ekf_buffer_stats &stats) const;
+
+    // get lane cost and switch statistics structure
+    void getLaneStatistics(int8_t instance, struct ekf_lane_stats &stats) const;
+
+    // get range beacon fusion cost statistics structure
+    void getBeaconStatistics(int8_t instance, struct ekf_beacon_stats &stats) const;
+
     /*
       check if switching lanes will reduce the normalised
       innovations. This is called when the vehicle code is about to
@@ -450,6 +468,16 @@ private:
     AP_Int8  _flowUse;              // Controls if the optical flow data is fused into the main navigation estimator and/or the terrain estimator.
     AP_Float _hrt_filt_freq;        // frequency of output observer height rate complementary filter in Hz
     AP_Int16 _mag_ef_limit;         // limit on difference between WMM tables and learned earth field.
+    AP_Int8  _options;              // bitmask of EKF3 options
+
+    enum class Option : uint8_t {
+        PARALLEL_CORES = (1U<<0),
+        STANDBY_LANES  = (1U<<1),
+        BATCH_BEACONS  = (1U<<2),
+    };
+    bool option_is_set(Option option) const {
+        return (_options & uint8_t(option)) != 0;
+    }
 
 // Possible values for _flowUse
 #define FLOW_USE_NONE    0
@@ -524,11 +552,48 @@ private:
     bool coreSetupRequired[7]; // true when this core index needs to be setup
     uint8_t coreImuIndex[7];   // IMU index used by this core
 
+    // lane switch statistics
+    uint32_t primaryFailing_ms;         // time the primary core started to fail, zero if it is not failing
+    uint16_t laneSwitchCount[7];        // number of switches to each core
+    uint32_t laneSwitchLatency_ms[7];   // time from the primary failing to the last switch to each core
+
+    // set which cores run as standby lanes
+    void updateStandbyLanes(void);
+
+    // record a switch to a new primary core
+    void recordLaneSwitch(uint8_t new_primary, uint32_t now_ms);
+
     bool inhibitGpsVertVelUse;  // true when GPS vertical velocity use is prohibited
 
     // origin set by one of the cores
     struct Location common_EKF_origin;
     bool common_origin_valid;
+
+#if HAL_NAVEKF3_PARALLEL_CORES
+    // protects the common origin when the cores run in parallel
+    HAL_Semaphore origin_sem;
+
+    // worker thread running the update of one core, while the first
+    // core is updated on the calling thread
+    class CoreThread {
+    public:
+        void thread_main(void);
+
+        NavEKF3_core *core;
+        uint8_t index;
+        bool predict;               // prediction permission for this update
+        HAL_BinarySemaphore start;  // signalled to run an update
+        HAL_BinarySemaphore done;   // signalled when the update is complete
+    };
+    CoreThread *core_threads = nullptr; // one per core, the first is unused
+    bool core_threads_failed;
+
+    // start the core worker threads if not already running
+    bool start_core_threads(void);
+
+    // update all cores in parallel, returning when all have finished
+    void UpdateCoresParallel(const bool *statePredictEnabled);
+#endif
     
     // update the yaw reset data to capture changes due to a lane switch
     // new_primary - index of the ekf instance that we are about to switch to as the primary
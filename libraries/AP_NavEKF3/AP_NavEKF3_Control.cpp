@@ -493,6 +493,9 @@ void NavEKF3_core::setOrigin(const Location &loc)
     gcs().send_text(MAV_SEVERITY_INFO, "EKF3 IMU%u origin set",(unsigned)imu_index);
 
     // put origin in frontend as well to ensure it stays in sync between lanes
+#if HAL_NAVEKF3_PARALLEL_CORES
+    WITH_SEMAPHORE(frontend->origin_sem);
+#endif
     frontend->common_EKF_origin = EKF_origin;
     frontend->common_origin_valid = true;
 }
@@ -13,8 +13,7 @@ extern const AP_HAL::HAL& hal;
 void NavEKF3_core::resetGyroBias(void)
 {
     stateStruct.gyro_bias.zero();
-    zeroRows(P,10,12);
-    zeroCols(P,10,12);
+    zeroRowsCols(P,10,12);
 
     P[10][10] = sq(radians(0.5f * dtIMUavg));
     P[11][11] = P[10][10];
@@ -354,6 +354,48 @@ void NavEKF3::Log_Write()
                 Log_EKF_Timing("XKT3", time_us, timing);
             }
         }
+
+        // and the observation buffer statistics
+        struct ekf_buffer_stats stats;
+        for (uint8_t i=0; i<activeCores(); i++) {
+            getBufferStatistics(i, stats);
+            if (i == 0) {
+                Log_EKF_Buffers("XKB1", time_us, stats);
+            } else if (i == 1) {
+                Log_EKF_Buffers("XKB2", time_us, stats);
+            } else if (i == 2) {
+                Log_EKF_Buffers("XKB3", time_us, stats);
+            }
+        }
+
+        // and the cost and switch history of each lane
+        struct ekf_lane_stats lane;
+        for (uint8_t i=0; i<activeCores(); i++) {
+            getLaneStatistics(i, lane);
+            if (i == 0) {
+                Log_EKF_Lane("XKL1", time_us, lane);
+            } else if (i == 1) {
+                Log_EKF_Lane("XKL2", time_us, lane);
+            } else if (i == 2) {
+                Log_EKF_Lane("XKL3", time_us, lane);
+            }
+        }
+
+        // and the cost of range beacon fusion, when beacons are in use
+        struct ekf_beacon_stats bcn;
+        for (uint8_t i=0; i<activeCores(); i++) {
+            getBeaconStatistics(i, bcn);
+            if (bcn.count == 0) {
+                continue;
+            }
+            if (i == 0) {
+                Log_EKF_Beacon("XKY1", time_us, bcn);
+            } else if (i == 1) {
+                Log_EKF_Beacon("XKY2", time_us, bcn);
+            } else if (i == 2) {
+                Log_EKF_Beacon("XKY3", time_us, bcn);
+            }
+        }
     }
 }
 
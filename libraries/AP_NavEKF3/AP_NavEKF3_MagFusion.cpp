@@ -187,8 +187,7 @@ void NavEKF3_core::realignYawGPS()
             angleErrVarVec.z = sq(radians(45.0f));
 
             // reset the quaternion covariances using the rotation vector variances
-            zeroRows(P,0,3);
-            zeroCols(P,0,3);
+            zeroRowsCols(P,0,3);
             initialiseQuatCovariances(angleErrVarVec);
 
             // send yaw alignment information to console
@@ -231,8 +230,7 @@ void NavEKF3_core::alignYawAngle()
     angleErrVarVec.z = sq(yawAngDataDelayed.yawAngErr);
 
     // reset the quaternion covariances using the rotation vector variances
-    zeroRows(P,0,3);
-    zeroCols(P,0,3);
+    zeroRowsCols(P,0,3);
     initialiseQuatCovariances(angleErrVarVec);
 
     // send yaw alignment information to console
@@ -728,56 +726,13 @@ void NavEKF3_core::FuseMagnetometer()
             // this can be used by other fusion processes to avoid fusing on the same frame as this expensive step
             magFusePerformed = true;
         }
-        // correct the covariance P = (I - K*H)*P
-        // take advantage of the empty columns in KH to reduce the
-        // number of operations
-        for (unsigned i = 0; i<=stateIndexLim; i++) {
-            for (unsigned j = 0; j<=3; j++) {
-                KH[i][j] = Kfusion[i] * H_MAG[j];
-            }
-            for (unsigned j = 4; j<=15; j++) {
-                KH[i][j] = 0.0f;
-            }
-            for (unsigned j = 16; j<=21; j++) {
-                KH[i][j] = Kfusion[i] * H_MAG[j];
-            }
-            for (unsigned j = 22; j<=23; j++) {
-                KH[i][j] = 0.0f;
-            }
-        }
-        for (unsigned j = 0; j<=stateIndexLim; j++) {
-            for (unsigned i = 0; i<=stateIndexLim; i++) {
-                ftype res = 0;
-                res += KH[i][0] * P[0][j];
-                res += KH[i][1] * P[1][j];
-                res += KH[i][2] * P[2][j];
-                res += KH[i][3] * P[3][j];
-                res += KH[i][16] * P[16][j];
-                res += KH[i][17] * P[17][j];
-                res += KH[i][18] * P[18][j];
-                res += KH[i][19] * P[19][j];
-                res += KH[i][20] * P[20][j];
-                res += KH[i][21] * P[21][j];
-                KHP[i][j] = res;
-            }
-        }
-        // Check that we are not going to drive any variances negative and skip the update if so
-        bool healthyFusion = true;
-        for (uint8_t i= 0; i<=stateIndexLim; i++) {
-            if (KHP[i][i] > P[i][i]) {
-                healthyFusion = false;
-            }
-        }
+        // correct the covariance P = (I - K*H)*P, H is only nonzero for
+        // the attitude and magnetic field states. The update is skipped
+        // if it would drive any variances negative
+        static const uint8_t H_MAG_idx[] = { 0, 1, 2, 3, 16, 17, 18, 19, 20, 21 };
+        const bool healthyFusion = sparseCovarianceUpdate(&H_MAG[0], H_MAG_idx, ARRAY_SIZE(H_MAG_idx), true);
         if (healthyFusion) {
-            // update the covariance matrix
-            for (uint8_t i= 0; i<=stateIndexLim; i++) {
-                for (uint8_t j= 0; j<=stateIndexLim; j++) {
-                    P[i][j] = P[i][j] - KHP[i][j];
-                }
-            }
-
-            // force the covariance matrix to be symmetrical and limit the variances to prevent ill-conditioning.
-            ForceSymmetry();
+            // limit the variances to prevent ill-conditioning
             ConstrainVariances();
 
             // correct the state vector
@@ -1015,40 +970,12 @@ void NavEKF3_core::fuseEulerYaw(bool usePredictedYaw, bool useExternalYawSensor)
         innovation = -0.5f;
     }
 
-    // correct the covariance using P = P - K*H*P taking advantage of the fact that only the first 3 elements in H are non zero
-    // calculate K*H*P
-    for (uint8_t row = 0; row <= stateIndexLim; row++) {
-        for (uint8_t column = 0; column <= 3; column++) {
-            KH[row][column] = Kfusion[row] * H_YAW[column];
-        }
-    }
-    for (uint8_t row = 0; row <= stateIndexLim; row++) {
-        for (uint8_t column = 0; column <= stateIndexLim; column++) {
-            float tmp = KH[row][0] * P[0][column];
-            tmp += KH[row][1] * P[1][column];
-            tmp += KH[row][2] * P[2][column];
-            tmp += KH[row][3] * P[3][column];
-            KHP[row][column] = tmp;
-        }
-    }
-
-    // Check that we are not going to drive any variances negative and skip the update if so
-    bool healthyFusion = true;
-    for (uint8_t i= 0; i<=stateIndexLim; i++) {
-        if (KHP[i][i] > P[i][i]) {
-            healthyFusion = false;
-        }
-    }
+    // correct the covariance using P = P - K*H*P taking advantage of the fact that only the first 4 elements in H are non zero
+    // Skip the update if it would drive any variances negative
+    static const uint8_t H_YAW_idx[] = { 0, 1, 2, 3 };
+    const bool healthyFusion = sparseCovarianceUpdate(H_YAW, H_YAW_idx, ARRAY_SIZE(H_YAW_idx), true);
     if (healthyFusion) {
-        // update the covariance matrix
-        for (uint8_t i= 0; i<=stateIndexLim; i++) {
-            for (uint8_t j= 0; j<=stateIndexLim; j++) {
-                P[i][j] = P[i][j] - KHP[i][j];
-            }
-        }
-
-        // force the covariance matrix to be symmetrical and limit the variances to prevent ill-conditioning.
-        ForceSymmetry();
+        // limit the variances to prevent ill-conditioning
         ConstrainVariances();
 
         // correct the state vector
@@ -1190,43 +1117,14 @@ void NavEKF3_core::FuseDeclination(float declErr)
         innovation = -0.5f;
     }
 
-    // correct the covariance P = (I - K*H)*P
-    // take advantage of the empty columns in KH to reduce the
-    // number of operations
-    for (unsigned i = 0; i<=stateIndexLim; i++) {
-        for (unsigned j = 0; j<=15; j++) {
-            KH[i][j] = 0.0f;
-        }
-        KH[i][16] = Kfusion[i] * H_DECL[16];
-        KH[i][17] = Kfusion[i] * H_DECL[17];
-        for (unsigned j = 18; j<=23; j++) {
-            KH[i][j] = 0.0f;
-        }
-    }
-    for (unsigned j = 0; j<=stateIndexLim; j++) {
-        for (unsigned i = 0; i<=stateIndexLim; i++) {
-            KHP[i][j] = KH[i][16] * P[16][j] + KH[i][17] * P[17][j];
-        }
-    }
-
-    // Check that we are not going to drive any variances negative and skip the update if so
-    bool healthyFusion = true;
-    for (uint8_t i= 0; i<=stateIndexLim; i++) {
-        if (KHP[i][i] > P[i][i]) {
-            healthyFusion = false;
-        }
-    }
+    // correct the covariance P = (I - K*H)*P, H is only nonzero for
+    // the north and east earth field states. Skip the update if it
+    // would drive any variances negative
+    static const uint8_t H_DECL_idx[] = { 16, 17 };
+    const bool healthyFusion = sparseCovarianceUpdate(&H_DECL[0], H_DECL_idx, ARRAY_SIZE(H_DECL_idx), true);
 
     if (healthyFusion) {
-        // update the covariance matrix
-        for (uint8_t i= 0; i<=stateIndexLim; i++) {
-            for (uint8_t j= 0; j<=stateIndexLim; j++) {
-                P[i][j] = P[i][j] - KHP[i][j];
-            }
-        }
-
-        // force the covariance matrix to be symmetrical and limit the variances to prevent ill-conditioning.
-        ForceSymmetry();
+        // limit the variances to prevent ill-conditioning
         ConstrainVariances();
 
         // correct the state vector
@@ -1268,8 +1166,7 @@ void NavEKF3_core::alignMagStateDeclination()
         // zero the corresponding state covariances if magnetic field state learning is active
         float var_16 = P[16][16];
         float var_17 = P[17][17];
-        zeroRows(P,16,17);
-        zeroCols(P,16,17);
+        zeroRowsCols(P,16,17);
         P[16][16] = var_16;
         P[17][17] = var_17;
 
@@ -589,8 +589,13 @@ void NavEKF3_core::readGpsData()
             calcGpsGoodForFlight();
 
             // see if we can get an origin from the frontend
-            if (!validOrigin && frontend->common_origin_valid) {
-                setOrigin(frontend->common_EKF_origin);
+            {
+#if HAL_NAVEKF3_PARALLEL_CORES
+                WITH_SEMAPHORE(frontend->origin_sem);
+#endif
+                if (!validOrigin && frontend->common_origin_valid) {
+                    setOrigin(frontend->common_EKF_origin);
+                }
             }
 
             // Read the GPS location in WGS-84 lat,long,height coordinates
@@ -615,9 +620,10 @@ void NavEKF3_core::readGpsData()
             if (gpsGoodToAlign && !have_table_earth_field) {
                 const Compass *compass = _ahrs->get_compass();
                 if (compass && compass->have_scale_factor(magSelectIndex) && compass->auto_declination_enabled()) {
-                    table_earth_field_ga = AP_Declination::get_earth_field_ga(gpsloc);
-                    table_declination = radians(AP_Declination::get_declination(gpsloc.lat*1.0e-7,
-                                                                            gpsloc.lng*1.0e-7));
+                    AP_Declination::MagField field;
+                    AP_Declination::get_mag_field(gpsloc, field);
+                    table_earth_field_ga = field.earth_field_ga();
+                    table_declination = radians(field.declination_deg);
                     have_table_earth_field = true;
                     if (frontend->_mag_ef_limit > 0) {
                         // initialise earth field from tables
@@ -807,12 +813,14 @@ void NavEKF3_core::readRngBcnData()
     // get the number of beacons in use
     N_beacons = beacon->count();
 
-    // search through all the beacons for new data and if we find it stop searching and push the data into the observation buffer
+    // search through all the beacons for new data and if we find it stop searching and push the data into the observation buffer.
+    // When batching beacons we push the data from every beacon with new data
+    const bool batch = frontend->option_is_set(NavEKF3::Option::BATCH_BEACONS);
     bool newDataToPush = false;
     uint8_t numRngBcnsChecked = 0;
     // start the search one index up from where we left it last time
     uint8_t index = lastRngBcnChecked;
-    while (!newDataToPush && numRngBcnsChecked < N_beacons) {
+    while ((batch || !newDataToPush) && numRngBcnsChecked < N_beacons) {
         // track the number of beacons checked
         numRngBcnsChecked++;
 
@@ -848,6 +856,10 @@ void NavEKF3_core::readRngBcnData()
 
             // update the last checked index
             lastRngBcnChecked = index;
+
+            if (batch) {
+                storedRangeBeacon.push(rngBcnDataNew);
+            }
         }
     }
 
@@ -886,19 +898,29 @@ void NavEKF3_core::readRngBcnData()
     }
 
     // Save data into the buffer to be fused when the fusion time horizon catches up with it
-    if (newDataToPush) {
+    if (newDataToPush && !batch) {
         storedRangeBeacon.push(rngBcnDataNew);
     }
 
     // Check the buffer for measurements that have been overtaken by the fusion time horizon and need to be fused
-    rngBcnDataToFuse = storedRangeBeacon.recall(rngBcnDataDelayed, imuDataDelayed.time_ms);
+    rngBcnDataToFuse = recallRngBcnData(batch);
+}
+
+bool NavEKF3_core::recallRngBcnData(bool oldest)
+{
+    bool ret;
+    if (oldest) {
+        ret = storedRangeBeacon.recall_oldest(rngBcnDataDelayed, imuDataDelayed.time_ms);
+    } else {
+        ret = storedRangeBeacon.recall(rngBcnDataDelayed, imuDataDelayed.time_ms);
+    }
 
     // Correct the range beacon earth frame origin for estimated offset relative to the EKF earth frame origin
-    if (rngBcnDataToFuse) {
+    if (ret) {
         rngBcnDataDelayed.beacon_posNED.x += bcnPosOffsetNED.x;
         rngBcnDataDelayed.beacon_posNED.y += bcnPosOffsetNED.y;
     }
-
+    return ret;
 }
 
 /********************************************************
@@ -959,6 +981,52 @@ void NavEKF3_core::getTimingStatistics(struct ekf_timing &_timing)
     memset(&timing, 0, sizeof(timing));
 }
 
+// get observation buffer statistics structure
+void NavEKF3_core::getBufferStatistics(struct ekf_buffer_stats &stats)
+{
+    storedGPS.get_and_reset_stats(stats.gps.discarded, stats.gps.misses);
+    storedMag.get_and_reset_stats(stats.mag.discarded, stats.mag.misses);
+    storedBaro.get_and_reset_stats(stats.baro.discarded, stats.baro.misses);
+    storedRange.get_and_reset_stats(stats.range.discarded, stats.range.misses);
+    storedOF.get_and_reset_stats(stats.flow.discarded, stats.flow.misses);
+    storedRangeBeacon.get_and_reset_stats(stats.beacon.discarded, stats.beacon.misses);
+
+    // airspeed, odometry and yaw angle buffers are reported together
+    uint16_t discarded, misses;
+    storedTAS.get_and_reset_stats(stats.other.discarded, stats.other.misses);
+    storedBodyOdm.get_and_reset_stats(discarded, misses);
+    stats.other.discarded += discarded;
+    stats.other.misses += misses;
+    storedWheelOdm.get_and_reset_stats(discarded, misses);
+    stats.other.discarded += discarded;
+    stats.other.misses += misses;
+    storedYawAng.get_and_reset_stats(discarded, misses);
+    stats.other.discarded += discarded;
+    stats.other.misses += misses;
+}
+
+// get the update cost of this lane
+void NavEKF3_core::getLaneStatistics(struct ekf_lane_stats &stats)
+{
+    stats.count = laneCost.count;
+    stats.avg_us = laneCost.count ? laneCost.total_us / laneCost.count : 0;
+    stats.max_us = laneCost.max_us;
+    stats.fusion_skips = laneCost.fusion_skips;
+    stats.standby = standbyMode;
+    memset(&laneCost, 0, sizeof(laneCost));
+}
+
+// get the cost of range beacon fusion
+void NavEKF3_core::getBeaconStatistics(struct ekf_beacon_stats &stats)
+{
+    stats.count = rngBcnCost.count;
+    stats.meas = rngBcnCost.meas;
+    stats.avg_us = rngBcnCost.count ? rngBcnCost.total_us / rngBcnCost.count : 0;
+    stats.max_us = rngBcnCost.max_us;
+    stats.batch = frontend->option_is_set(NavEKF3::Option::BATCH_BEACONS);
+    memset(&rngBcnCost, 0, sizeof(rngBcnCost));
+}
+
 /*
   update estimates of inactive bias states. This keeps inactive IMUs
   as hot-spares so we can switch to them without causing a jump in the
@@ -708,7 +708,7 @@ void NavEKF3_core::FuseOptFlow()
                 }
             }
             for (unsigned j = 0; j<=stateIndexLim; j++) {
-                for (unsigned i = 0; i<=stateIndexLim; i++) {
+                for (unsigned i = 0; i<=j; i++) {
                     ftype res = 0;
                     res += KH[i][0] * P[0][j];
                     res += KH[i][1] * P[1][j];
@@ -731,14 +731,11 @@ void NavEKF3_core::FuseOptFlow()
 
             if (healthyFusion) {
                 // update the covariance matrix
-                for (uint8_t i= 0; i<=stateIndexLim; i++) {
-                    for (uint8_t j= 0; j<=stateIndexLim; j++) {
-                        P[i][j] = P[i][j] - KHP[i][j];
-                    }
+                for (uint8_t i = 0; i<=stateIndexLim; i++) {
+                    kernel_sub(P.row_from_diagonal(i), &KHP[i][i], stateIndexLim + 1 - i);
                 }
 
-                // force the covariance matrix to be symmetrical and limit the variances to prevent ill-conditioning.
-                ForceSymmetry();
+                // limit the variances to prevent ill-conditioning
                 ConstrainVariances();
 
                 // correct the state vector
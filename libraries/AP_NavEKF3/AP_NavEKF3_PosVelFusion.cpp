@@ -24,8 +24,7 @@ void NavEKF3_core::ResetVelocity(void)
     velResetNE.y = stateStruct.velocity.y;
 
     // reset the corresponding covariances
-    zeroRows(P,4,5);
-    zeroCols(P,4,5);
+    zeroRowsCols(P,4,5);
 
     gps_elements gps_corrected = gpsDataNew;
     CorrectGPSForAntennaOffset(gps_corrected);
@@ -62,6 +61,8 @@ void NavEKF3_core::ResetVelocity(void)
     outputDataNew.velocity.y = stateStruct.velocity.y;
     outputDataDelayed.velocity.x = stateStruct.velocity.x;
     outputDataDelayed.velocity.y = stateStruct.velocity.y;
+    stateVelAccum.reset();
+    outputVelAccum.reset();
 
     // Calculate the position jump due to the reset
     velResetNE.x = stateStruct.velocity.x - velResetNE.x;
@@ -83,8 +84,7 @@ void NavEKF3_core::ResetPosition(void)
     posResetNE.y = stateStruct.position.y;
 
     // reset the corresponding covariances
-    zeroRows(P,7,8);
-    zeroCols(P,7,8);
+    zeroRowsCols(P,7,8);
 
     if (PV_AidingMode != AID_ABSOLUTE) {
         // reset all position state history to the last known position
@@ -128,6 +128,8 @@ void NavEKF3_core::ResetPosition(void)
     outputDataNew.position.y = stateStruct.position.y;
     outputDataDelayed.position.x = stateStruct.position.x;
     outputDataDelayed.position.y = stateStruct.position.y;
+    statePosAccum.reset();
+    outputPosAccum.reset();
 
     // Calculate the position jump due to the reset
     posResetNE.x = stateStruct.position.x - posResetNE.x;
@@ -176,8 +178,7 @@ void NavEKF3_core::ResetHeight(void)
     lastHgtPassTime_ms = imuSampleTime_ms;
 
     // reset the corresponding covariances
-    zeroRows(P,9,9);
-    zeroCols(P,9,9);
+    zeroRowsCols(P,9,9);
 
     // set the variances to the measurement variance
     P[9][9] = posDownObsNoise;
@@ -197,8 +198,7 @@ void NavEKF3_core::ResetHeight(void)
     vertCompFiltState.vel = outputDataNew.velocity.z;
 
     // reset the corresponding covariances
-    zeroRows(P,6,6);
-    zeroCols(P,6,6);
+    zeroRowsCols(P,6,6);
 
     // set the variances to the measurement variance
     P[6][6] = sq(frontend->_gpsVertVelNoise);
@@ -515,8 +515,7 @@ void NavEKF3_core::FuseVelPosNED()
                     fusePosData = false;
                     fuseVelData = false;
                     // Reset the position variances and corresponding covariances to a value that will pass the checks
-                    zeroRows(P,7,8);
-                    zeroCols(P,7,8);
+                    zeroRowsCols(P,7,8);
                     P[7][7] = sq(float(0.5f*frontend->_gpsGlitchRadiusMax));
                     P[8][8] = P[7][7];
                     // Reset the normalised innovation to avoid failing the bad fusion tests
@@ -709,11 +708,13 @@ void NavEKF3_core::FuseVelPosNED()
 
                 // update the covariance - take advantage of direct observation of a single state at index = stateIndex to reduce computations
                 // this is a numerically optimised implementation of standard equation P = (I - K*H)*P;
+                // each row of KHP is a multiple of row stateIndex of P, so gather that once
+                ftype PRow[24];
+                for (uint8_t j = 0; j<=stateIndexLim; j++) {
+                    PRow[j] = P[stateIndex][j];
+                }
                 for (uint8_t i= 0; i<=stateIndexLim; i++) {
-                    for (uint8_t j= 0; j<=stateIndexLim; j++)
-                    {
-                        KHP[i][j] = Kfusion[i] * P[stateIndex][j];
-                    }
+                    kernel_scale(&KHP[i][i], &PRow[i], Kfusion[i], stateIndexLim + 1 - i);
                 }
                 // Check that we are not going to drive any variances negative and skip the update if so
                 bool healthyFusion = true;
@@ -724,14 +725,11 @@ void NavEKF3_core::FuseVelPosNED()
                 }
                 if (healthyFusion) {
                     // update the covariance matrix
-                    for (uint8_t i= 0; i<=stateIndexLim; i++) {
-                        for (uint8_t j= 0; j<=stateIndexLim; j++) {
-                            P[i][j] = P[i][j] - KHP[i][j];
-                        }
+                    for (uint8_t i = 0; i<=stateIndexLim; i++) {
+                        kernel_sub(P.row_from_diagonal(i), &KHP[i][i], stateIndexLim + 1 - i);
                     }
 
-                    // force the covariance matrix to be symmetrical and limit the variances to prevent ill-conditioning.
-                    ForceSymmetry();
+                    // limit the variances to prevent ill-conditioning
                     ConstrainVariances();
 
                     // update states and renormalise the quaternions
@@ -1535,7 +1533,7 @@ void NavEKF3_core::FuseBodyVel()
                 }
             }
             for (unsigned j = 0; j<=stateIndexLim; j++) {
-                for (unsigned i = 0; i<=stateIndexLim; i++) {
+                for (unsigned i = 0; i<=j; i++) {
                     ftype res = 0;
                     res += KH[i][0] * P[0][j];
                     res += KH[i][1] * P[1][j];
@@ -1558,14 +1556,11 @@ void NavEKF3_core::FuseBodyVel()
 
             if (healthyFusion) {
                 // update the covariance matrix
-                for (uint8_t i= 0; i<=stateIndexLim; i++) {
-                    for (uint8_t j= 0; j<=stateIndexLim; j++) {
-                        P[i][j] = P[i][j] - KHP[i][j];
-                    }
+                for (uint8_t i = 0; i<=stateIndexLim; i++) {
+                    kernel_sub(P.row_from_diagonal(i), &KHP[i][i], stateIndexLim + 1 - i);
                 }
 
-                // force the covariance matrix to be symmetrical and limit the variances to prevent ill-conditioning.
-                ForceSymmetry();
+                // limit the variances to prevent ill-conditioning
                 ConstrainVariances();
 
                 // correct the state vector
@@ -15,264 +15,211 @@ extern const AP_HAL::HAL& hal;
 // select fusion of range beacon measurements
 void NavEKF3_core::SelectRngBcnFusion()
 {
+    const uint32_t start_us = AP_HAL::micros();
+
     // read range data from the sensor and check for new data in the buffer
     readRngBcnData();
 
+    if (!rngBcnDataToFuse) {
+        return;
+    }
+
+    // when batching beacons, take every measurement that has reached
+    // the fusion time horizon
+    uint8_t nMeas = 0;
+    rngBcnBatch[nMeas++] = rngBcnDataDelayed;
+    if (frontend->option_is_set(NavEKF3::Option::BATCH_BEACONS)) {
+        while (nMeas < EK3_RNG_BCN_BATCH_MAX && recallRngBcnData(true)) {
+            rngBcnBatch[nMeas++] = rngBcnDataDelayed;
+        }
+    }
+
     // Determine if we need to fuse range beacon data on this time step
-    if (rngBcnDataToFuse) {
-        if (PV_AidingMode == AID_ABSOLUTE) {
-            if (!filterStatus.flags.using_gps && rngBcnAlignmentCompleted) {
-                if (!bcnOriginEstInit) {
-                    bcnOriginEstInit = true;
-                    bcnPosOffsetNED.x = receiverPos.x - stateStruct.position.x;
-                    bcnPosOffsetNED.y = receiverPos.y - stateStruct.position.y;
-                }
-                // If we aren't using GPS, then the beacons are used as the primary means of position reference
-                FuseRngBcn();
-            } else {
-                // If we are using GPS, then GPS is the primary reference, but we continue to use the beacon data
-                // to calculate an independant position that is used to update the beacon position offset if we need to
-                // start using beacon data as the primary reference.
-                FuseRngBcnStatic();
-                // record that the beacon origin needs to be initialised
-                bcnOriginEstInit = false;
-            }
-        } else {
-            // If we aren't able to use the data in the main filter, use a simple 3-state filter to estimate position only
+    if (PV_AidingMode == AID_ABSOLUTE && !filterStatus.flags.using_gps && rngBcnAlignmentCompleted) {
+        if (!bcnOriginEstInit) {
+            bcnOriginEstInit = true;
+            bcnPosOffsetNED.x = receiverPos.x - stateStruct.position.x;
+            bcnPosOffsetNED.y = receiverPos.y - stateStruct.position.y;
+        }
+        // If we aren't using GPS, then the beacons are used as the primary means of position reference
+        FuseRngBcnBatch(rngBcnBatch, nMeas);
+    } else {
+        // If we are using GPS, then GPS is the primary reference, but we continue to use the beacon data
+        // to calculate an independant position that is used to update the beacon position offset if we need to
+        // start using beacon data as the primary reference.
+        // If we aren't able to use the data in the main filter, use a simple 3-state filter to estimate position only
+        for (uint8_t i=0; i<nMeas; i++) {
+            rngBcnDataDelayed = rngBcnBatch[i];
             FuseRngBcnStatic();
-            // record that the beacon origin needs to be initialised
-            bcnOriginEstInit = false;
         }
+        // record that the beacon origin needs to be initialised
+        bcnOriginEstInit = false;
     }
+
+    const uint32_t dt_us = AP_HAL::micros() - start_us;
+    rngBcnCost.count++;
+    rngBcnCost.meas += nMeas;
+    rngBcnCost.total_us += dt_us;
+    rngBcnCost.max_us = MAX(rngBcnCost.max_us, dt_us);
 }
 
 void NavEKF3_core::FuseRngBcn()
 {
-    // declarations
-    float pn;
-    float pe;
-    float pd;
-    float bcn_pn;
-    float bcn_pe;
-    float bcn_pd;
-    const float R_BCN = sq(MAX(rngBcnDataDelayed.rngErr , 0.1f));
-    float rngPred;
+    FuseRngBcnBatch(&rngBcnDataDelayed, 1);
+}
 
+/*
+  fuse a set of range beacon measurements. The beacon vertical offset
+  is updated with every measurement in the set and the hypothesis to
+  use selected once, then each range is fused in turn
+ */
+void NavEKF3_core::FuseRngBcnBatch(const rng_bcn_elements *meas, uint8_t n)
+{
     // health is set bad until test passed
     rngBcnHealth = false;
 
-    if (activeHgtSource != HGT_SOURCE_BCN) {
+    // only allow the range observations to modify the vertical states if we are using it as a height reference
+    const bool fuseHgt = (activeHgtSource == HGT_SOURCE_BCN);
+
+    if (!fuseHgt) {
         // calculate the vertical offset from EKF datum to beacon datum
-        CalcRangeBeaconPosDownOffset(R_BCN, stateStruct.position, false);
+        for (uint8_t i=0; i<n; i++) {
+            const float R_BCN = sq(MAX(meas[i].rngErr , 0.1f));
+            updateRangeBeaconPosDownOffset(meas[i], R_BCN, stateStruct.position, false);
+        }
+        selectRangeBeaconPosDownOffset(stateStruct.position);
     } else {
         bcnPosOffsetNED.z = 0.0f;
     }
 
-    // copy required states to local variable names
-    pn = stateStruct.position.x;
-    pe = stateStruct.position.y;
-    pd = stateStruct.position.z;
-    bcn_pn = rngBcnDataDelayed.beacon_posNED.x;
-    bcn_pe = rngBcnDataDelayed.beacon_posNED.y;
-    bcn_pd = rngBcnDataDelayed.beacon_posNED.z + bcnPosOffsetNED.z;
-
-    // predicted range
-    Vector3f deltaPosNED = stateStruct.position - rngBcnDataDelayed.beacon_posNED;
-    rngPred = deltaPosNED.length();
-
-    // calculate measurement innovation
-    innovRngBcn = rngPred - rngBcnDataDelayed.rng;
-
-    // perform fusion of range measurement
-    if (rngPred > 0.1f)
-    {
-        // calculate observation jacobians
-        float H_BCN[24];
-        memset(H_BCN, 0, sizeof(H_BCN));
-        float t2 = bcn_pd-pd;
-        float t3 = bcn_pe-pe;
-        float t4 = bcn_pn-pn;
-        float t5 = t2*t2;
-        float t6 = t3*t3;
-        float t7 = t4*t4;
-        float t8 = t5+t6+t7;
-        float t9 = 1.0f/sqrtf(t8);
-        H_BCN[7] = -t4*t9;
-        H_BCN[8] = -t3*t9;
-        // If we are not using the beacons as a height reference, we pretend that the beacons
-        // are at the same height as the flight vehicle when calculating the observation derivatives
-        // and Kalman gains
-        // TODO  - less hacky way of achieving this, preferably using an alternative derivation
-        if (activeHgtSource != HGT_SOURCE_BCN) {
-            t2 = 0.0f;
-        }
-        H_BCN[9] = -t2*t9;
-
-        // calculate Kalman gains
-        float t10 = P[9][9]*t2*t9;
-        float t11 = P[8][9]*t3*t9;
-        float t12 = P[7][9]*t4*t9;
-        float t13 = t10+t11+t12;
-        float t14 = t2*t9*t13;
-        float t15 = P[9][8]*t2*t9;
-        float t16 = P[8][8]*t3*t9;
-        float t17 = P[7][8]*t4*t9;
-        float t18 = t15+t16+t17;
-        float t19 = t3*t9*t18;
-        float t20 = P[9][7]*t2*t9;
-        float t21 = P[8][7]*t3*t9;
-        float t22 = P[7][7]*t4*t9;
-        float t23 = t20+t21+t22;
-        float t24 = t4*t9*t23;
-        varInnovRngBcn = R_BCN+t14+t19+t24;
-        float t26;
-        if (varInnovRngBcn >= R_BCN) {
-            t26 = 1.0f/varInnovRngBcn;
-            faultStatus.bad_rngbcn = false;
-        } else {
-            // the calculation is badly conditioned, so we cannot perform fusion on this step
-            // we reset the covariance matrix and try again next measurement
-            CovarianceInit();
-            faultStatus.bad_rngbcn = true;
+    const float gateSq = sq(MAX(0.01f * (float)frontend->_rngBcnInnovGate, 1.0f));
+
+    for (uint8_t i=0; i<n; i++) {
+        Vector3f bcnPosNED = meas[i].beacon_posNED;
+        bcnPosNED.z += bcnPosOffsetNED.z;
+        if (!FuseRngBcnMeas(meas[i], bcnPosNED, gateSq, fuseHgt)) {
+            // the covariance has been reset, try again with the next set
             return;
         }
+    }
+}
 
-        Kfusion[0] = -t26*(P[0][7]*t4*t9+P[0][8]*t3*t9+P[0][9]*t2*t9);
-        Kfusion[1] = -t26*(P[1][7]*t4*t9+P[1][8]*t3*t9+P[1][9]*t2*t9);
-        Kfusion[2] = -t26*(P[2][7]*t4*t9+P[2][8]*t3*t9+P[2][9]*t2*t9);
-        Kfusion[3] = -t26*(P[3][7]*t4*t9+P[3][8]*t3*t9+P[3][9]*t2*t9);
-        Kfusion[4] = -t26*(P[4][7]*t4*t9+P[4][8]*t3*t9+P[4][9]*t2*t9);
-        Kfusion[5] = -t26*(P[5][7]*t4*t9+P[5][8]*t3*t9+P[5][9]*t2*t9);
-        Kfusion[7] = -t26*(t22+P[7][8]*t3*t9+P[7][9]*t2*t9);
-        Kfusion[8] = -t26*(t16+P[8][7]*t4*t9+P[8][9]*t2*t9);
-
-        if (!inhibitDelAngBiasStates) {
-            Kfusion[10] = -t26*(P[10][7]*t4*t9+P[10][8]*t3*t9+P[10][9]*t2*t9);
-            Kfusion[11] = -t26*(P[11][7]*t4*t9+P[11][8]*t3*t9+P[11][9]*t2*t9);
-            Kfusion[12] = -t26*(P[12][7]*t4*t9+P[12][8]*t3*t9+P[12][9]*t2*t9);
-        } else {
-            // zero indexes 10 to 12 = 3*4 bytes
-            memset(&Kfusion[10], 0, 12);
-        }
+bool NavEKF3_core::FuseRngBcnMeas(const rng_bcn_elements &meas, const Vector3f &bcnPosNED, float gateSq, bool fuseHgt)
+{
+    const float R_BCN = sq(MAX(meas.rngErr , 0.1f));
 
-        if (!inhibitDelVelBiasStates) {
-            Kfusion[13] = -t26*(P[13][7]*t4*t9+P[13][8]*t3*t9+P[13][9]*t2*t9);
-            Kfusion[14] = -t26*(P[14][7]*t4*t9+P[14][8]*t3*t9+P[14][9]*t2*t9);
-            Kfusion[15] = -t26*(P[15][7]*t4*t9+P[15][8]*t3*t9+P[15][9]*t2*t9);
-        } else {
-            // zero indexes 13 to 15 = 3*4 bytes
-            memset(&Kfusion[13], 0, 12);
-        }
+    // predicted range and innovation
+    const Vector3f deltaPosNED = stateStruct.position - bcnPosNED;
+    const float rngPred = deltaPosNED.length();
+    innovRngBcn = rngPred - meas.rng;
 
-        // only allow the range observations to modify the vertical states if we are using it as a height reference
-        if (activeHgtSource == HGT_SOURCE_BCN) {
-            Kfusion[6] = -t26*(P[6][7]*t4*t9+P[6][8]*t3*t9+P[6][9]*t2*t9);
-            Kfusion[9] = -t26*(t10+P[9][7]*t4*t9+P[9][8]*t3*t9);
-        } else {
-            Kfusion[6] = 0.0f;
-            Kfusion[9] = 0.0f;
-        }
+    rngBcnHealth = false;
+    if (rngPred <= 0.1f) {
+        return true;
+    }
 
-        if (!inhibitMagStates) {
-            Kfusion[16] = -t26*(P[16][7]*t4*t9+P[16][8]*t3*t9+P[16][9]*t2*t9);
-            Kfusion[17] = -t26*(P[17][7]*t4*t9+P[17][8]*t3*t9+P[17][9]*t2*t9);
-            Kfusion[18] = -t26*(P[18][7]*t4*t9+P[18][8]*t3*t9+P[18][9]*t2*t9);
-            Kfusion[19] = -t26*(P[19][7]*t4*t9+P[19][8]*t3*t9+P[19][9]*t2*t9);
-            Kfusion[20] = -t26*(P[20][7]*t4*t9+P[20][8]*t3*t9+P[20][9]*t2*t9);
-            Kfusion[21] = -t26*(P[21][7]*t4*t9+P[21][8]*t3*t9+P[21][9]*t2*t9);
-        } else {
-            // zero indexes 16 to 21 = 6*4 bytes
-            memset(&Kfusion[16], 0, 24);
-        }
+    // calculate observation jacobians, which are only non-zero for
+    // the position states. If we are not using the beacons as a
+    // height reference, we pretend that the beacons are at the same
+    // height as the flight vehicle when calculating the observation
+    // derivatives and Kalman gains
+    const float invRngPred = 1.0f / rngPred;
+    const float H7 = deltaPosNED.x * invRngPred;
+    const float H8 = deltaPosNED.y * invRngPred;
+    const float H9 = fuseHgt ? deltaPosNED.z * invRngPred : 0.0f;
+
+    // P*H', shared by the Kalman gains and the covariance update
+    ftype PHT[24];
+    for (uint8_t i = 0; i<=stateIndexLim; i++) {
+        PHT[i] = P[i][7] * H7 + P[i][8] * H8 + P[i][9] * H9;
+    }
 
-        if (!inhibitWindStates) {
-            Kfusion[22] = -t26*(P[22][7]*t4*t9+P[22][8]*t3*t9+P[22][9]*t2*t9);
-            Kfusion[23] = -t26*(P[23][7]*t4*t9+P[23][8]*t3*t9+P[23][9]*t2*t9);
-        } else {
-            // zero indexes 22 to 23 = 2*4 bytes
-            memset(&Kfusion[22], 0, 8);
-        }
+    varInnovRngBcn = R_BCN + H7 * PHT[7] + H8 * PHT[8] + H9 * PHT[9];
+    if (varInnovRngBcn < R_BCN) {
+        // the calculation is badly conditioned, so we cannot perform fusion on this step
+        // we reset the covariance matrix and try again next measurement
+        CovarianceInit();
+        faultStatus.bad_rngbcn = true;
+        return false;
+    }
+    faultStatus.bad_rngbcn = false;
 
-        // Calculate innovation using the selected offset value
-        Vector3f delta = stateStruct.position - rngBcnDataDelayed.beacon_posNED;
-        innovRngBcn = delta.length() - rngBcnDataDelayed.rng;
+    // calculate Kalman gains
+    const float invVarInnov = 1.0f / varInnovRngBcn;
+    for (uint8_t i = 0; i<=stateIndexLim; i++) {
+        Kfusion[i] = PHT[i] * invVarInnov;
+    }
+    if (inhibitDelAngBiasStates) {
+        Kfusion[10] = Kfusion[11] = Kfusion[12] = 0.0f;
+    }
+    if (inhibitDelVelBiasStates) {
+        Kfusion[13] = Kfusion[14] = Kfusion[15] = 0.0f;
+    }
+    if (!fuseHgt) {
+        Kfusion[6] = 0.0f;
+        Kfusion[9] = 0.0f;
+    }
+    if (inhibitMagStates) {
+        for (uint8_t i = 16; i<=21; i++) {
+            Kfusion[i] = 0.0f;
+        }
+    }
+    if (inhibitWindStates) {
+        Kfusion[22] = Kfusion[23] = 0.0f;
+    }
 
-        // calculate the innovation consistency test ratio
-        rngBcnTestRatio = sq(innovRngBcn) / (sq(MAX(0.01f * (float)frontend->_rngBcnInnovGate, 1.0f)) * varInnovRngBcn);
+    // calculate the innovation consistency test ratio
+    rngBcnTestRatio = sq(innovRngBcn) / (gateSq * varInnovRngBcn);
 
-        // fail if the ratio is > 1, but don't fail if bad IMU data
-        rngBcnHealth = ((rngBcnTestRatio < 1.0f) || badIMUdata);
+    // fail if the ratio is > 1, but don't fail if bad IMU data
+    rngBcnHealth = ((rngBcnTestRatio < 1.0f) || badIMUdata);
 
-        // test the ratio before fusing data
-        if (rngBcnHealth) {
+    // test the ratio before fusing data
+    if (rngBcnHealth) {
 
-            // restart the counter
-            lastRngBcnPassTime_ms = imuSampleTime_ms;
+        // restart the counter
+        lastRngBcnPassTime_ms = imuSampleTime_ms;
 
-            // correct the covariance P = (I - K*H)*P
-            // take advantage of the empty columns in KH to reduce the
-            // number of operations
-            for (unsigned i = 0; i<=stateIndexLim; i++) {
-                for (unsigned j = 0; j<=6; j++) {
-                    KH[i][j] = 0.0f;
-                }
-                for (unsigned j = 7; j<=9; j++) {
-                    KH[i][j] = Kfusion[i] * H_BCN[j];
-                }
-                for (unsigned j = 10; j<=23; j++) {
-                    KH[i][j] = 0.0f;
-                }
-            }
-            for (unsigned j = 0; j<=stateIndexLim; j++) {
-                for (unsigned i = 0; i<=stateIndexLim; i++) {
-                    ftype res = 0;
-                    res += KH[i][7] * P[7][j];
-                    res += KH[i][8] * P[8][j];
-                    res += KH[i][9] * P[9][j];
-                    KHP[i][j] = res;
-                }
-            }
-            // Check that we are not going to drive any variances negative and skip the update if so
-            bool healthyFusion = true;
-            for (uint8_t i= 0; i<=stateIndexLim; i++) {
-                if (KHP[i][i] > P[i][i]) {
-                    healthyFusion = false;
-                }
+        // correct the covariance P = (I - K*H)*P. As H is only
+        // non-zero for the position states, K*H*P is the outer
+        // product of K and P*H'.
+        // Check that we are not going to drive any variances negative and skip the update if so
+        bool healthyFusion = true;
+        for (uint8_t i= 0; i<=stateIndexLim; i++) {
+            if (Kfusion[i] * PHT[i] > P[i][i]) {
+                healthyFusion = false;
             }
-            if (healthyFusion) {
-                // update the covariance matrix
-                for (uint8_t i= 0; i<=stateIndexLim; i++) {
-                    for (uint8_t j= 0; j<=stateIndexLim; j++) {
-                        P[i][j] = P[i][j] - KHP[i][j];
-                    }
-                }
+        }
+        if (healthyFusion) {
+            // update the covariance matrix
+            P.sub_outer(&Kfusion[0], PHT, stateIndexLim + 1);
 
-                // force the covariance matrix to be symmetrical and limit the variances to prevent ill-conditioning.
-                ForceSymmetry();
-                ConstrainVariances();
+            // limit the variances to prevent ill-conditioning
+            ConstrainVariances();
 
-                // correct the state vector
-                for (uint8_t j= 0; j<=stateIndexLim; j++) {
-                    statesArray[j] = statesArray[j] - Kfusion[j] * innovRngBcn;
-                }
+            // correct the state vector
+            for (uint8_t j= 0; j<=stateIndexLim; j++) {
+                statesArray[j] = statesArray[j] - Kfusion[j] * innovRngBcn;
+            }
 
-                // record healthy fusion
-                faultStatus.bad_rngbcn = false;
+            // record healthy fusion
+            faultStatus.bad_rngbcn = false;
 
-            } else {
-                // record bad fusion
-                faultStatus.bad_rngbcn = true;
+        } else {
+            // record bad fusion
+            faultStatus.bad_rngbcn = true;
 
-            }
         }
-
-        // Update the fusion report
-        rngBcnFusionReport[rngBcnDataDelayed.beacon_ID].beaconPosNED = rngBcnDataDelayed.beacon_posNED;
-        rngBcnFusionReport[rngBcnDataDelayed.beacon_ID].innov = innovRngBcn;
-        rngBcnFusionReport[rngBcnDataDelayed.beacon_ID].innovVar = varInnovRngBcn;
-        rngBcnFusionReport[rngBcnDataDelayed.beacon_ID].rng = rngBcnDataDelayed.rng;
-        rngBcnFusionReport[rngBcnDataDelayed.beacon_ID].testRatio = rngBcnTestRatio;
     }
+
+    // Update the fusion report
+    rngBcnFusionReport[meas.beacon_ID].beaconPosNED = bcnPosNED;
+    rngBcnFusionReport[meas.beacon_ID].innov = innovRngBcn;
+    rngBcnFusionReport[meas.beacon_ID].innovVar = varInnovRngBcn;
+    rngBcnFusionReport[meas.beacon_ID].rng = meas.rng;
+    rngBcnFusionReport[meas.beacon_ID].testRatio = rngBcnTestRatio;
+
+    return true;
 }
 
 /*
@@ -516,6 +463,15 @@ Run a single state Kalman filter to estimate the vertical position offset of the
 Calculate using a high and low hypothesis and select the hypothesis with the lowest innovation sequence
 */
 void NavEKF3_core::CalcRangeBeaconPosDownOffset(float obsVar, Vector3f &vehiclePosNED, bool aligning)
+{
+    updateRangeBeaconPosDownOffset(rngBcnDataDelayed, obsVar, vehiclePosNED, aligning);
+    selectRangeBeaconPosDownOffset(vehiclePosNED);
+
+    // apply the vertical offset to the beacon positions
+    rngBcnDataDelayed.beacon_posNED.z += bcnPosOffsetNED.z;
+}
+
+void NavEKF3_core::updateRangeBeaconPosDownOffset(const rng_bcn_elements &meas, float obsVar, const Vector3f &vehiclePosNED, bool aligning)
 {
     // Handle height offsets between the primary height source and the range beacons by estimating
     // the beacon systems global vertical position offset using a single state Kalman filter
@@ -535,9 +491,9 @@ void NavEKF3_core::CalcRangeBeaconPosDownOffset(float obsVar, Vector3f &vehicleP
     // estimate upper value for offset
 
     // calculate observation derivative
-    float t2 = rngBcnDataDelayed.beacon_posNED.z - vehiclePosNED.z + bcnPosDownOffsetMax;
-    float t3 = rngBcnDataDelayed.beacon_posNED.y - vehiclePosNED.y;
-    float t4 = rngBcnDataDelayed.beacon_posNED.x - vehiclePosNED.x;
+    float t2 = meas.beacon_posNED.z - vehiclePosNED.z + bcnPosDownOffsetMax;
+    float t3 = meas.beacon_posNED.y - vehiclePosNED.y;
+    float t4 = meas.beacon_posNED.x - vehiclePosNED.x;
     float t5 = t2*t2;
     float t6 = t3*t3;
     float t7 = t4*t4;
@@ -548,7 +504,7 @@ void NavEKF3_core::CalcRangeBeaconPosDownOffset(float obsVar, Vector3f &vehicleP
         obsDeriv = t2*t9;
 
         // Calculate innovation
-        innov = sqrtf(t8) - rngBcnDataDelayed.rng;
+        innov = sqrtf(t8) - meas.rng;
 
         // covariance prediction
         bcnPosOffsetMaxVar += stateNoiseVar;
@@ -579,7 +535,7 @@ void NavEKF3_core::CalcRangeBeaconPosDownOffset(float obsVar, Vector3f &vehicleP
     // estimate lower value for offset
 
     // calculate observation derivative
-    t2 = rngBcnDataDelayed.beacon_posNED.z - vehiclePosNED.z + bcnPosDownOffsetMin;
+    t2 = meas.beacon_posNED.z - vehiclePosNED.z + bcnPosDownOffsetMin;
     t5 = t2*t2;
     t8 = t5+t6+t7;
     if (t8 > 0.1f) {
@@ -587,7 +543,7 @@ void NavEKF3_core::CalcRangeBeaconPosDownOffset(float obsVar, Vector3f &vehicleP
         obsDeriv = t2*t9;
 
         // Calculate innovation
-        innov = sqrtf(t8) - rngBcnDataDelayed.rng;
+        innov = sqrtf(t8) - meas.rng;
 
         // covariance prediction
         bcnPosOffsetMinVar += stateNoiseVar;
@@ -614,7 +570,10 @@ void NavEKF3_core::CalcRangeBeaconPosDownOffset(float obsVar, Vector3f &vehicleP
             bcnPosOffsetMinVar = MAX(bcnPosOffsetMinVar, 0.0f);
         }
     }
+}
 
+void NavEKF3_core::selectRangeBeaconPosDownOffset(const Vector3f &vehiclePosNED)
+{
     // calculate the mid vertical position of all beacons
     float bcnMidPosD = 0.5f * (minBcnPosD + maxBcnPosD);
 
@@ -634,8 +593,5 @@ void NavEKF3_core::CalcRangeBeaconPosDownOffset(float obsVar, Vector3f &vehicleP
     } else {
         bcnPosOffsetNED.z = bcnPosDownOffsetMax;
     }
-
-    // apply the vertical offset to the beacon positions
-    rngBcnDataDelayed.beacon_posNED.z += bcnPosOffsetNED.z;
 }
 
@@ -160,6 +160,22 @@ bool NavEKF3_core::setup_core(uint8_t _imu_index, uint8_t _core_index)
 *                   INIT FUNCTIONS                      *
 ********************************************************/
 
+#if HAL_NAVEKF3_PARALLEL_CORES
+/*
+  fill the per-core scratch variables, for detecting re-use of
+  variables between loops in SITL
+ */
+void NavEKF3_core::fill_scratch_variables(void)
+{
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+    fill_nanf(&KH[0][0], sizeof(KH)/sizeof(float));
+    fill_nanf(&KHP[0][0], sizeof(KHP)/sizeof(float));
+    fill_nanf(&nextP[0][0], sizeof(nextP)/sizeof(float));
+    fill_nanf(&Kfusion[0], sizeof(Kfusion)/sizeof(float));
+#endif
+}
+#endif
+
 // Use a function call rather than a constructor to initialise variables because it enables the filter to be re-started in flight if necessary.
 void NavEKF3_core::InitialiseVariables()
 {
@@ -210,7 +226,7 @@ void NavEKF3_core::InitialiseVariables()
     velDotNEDfilt.zero();
     lastKnownPositionNE.zero();
     prevTnb.zero();
-    memset(&P[0][0], 0, sizeof(P));
+    P.zero();
     memset(&KH[0][0], 0, sizeof(KH));
     memset(&KHP[0][0], 0, sizeof(KHP));
     memset(&nextP[0][0], 0, sizeof(nextP));
@@ -300,6 +316,13 @@ void NavEKF3_core::InitialiseVariables()
     imuDataDownSampledNew.accel_index = accel_index_active;
     runUpdates = false;
     framesSincePredict = 0;
+    stateVelAccum.reset();
+    statePosAccum.reset();
+    outputVelAccum.reset();
+    outputPosAccum.reset();
+    standbyMode = false;
+    standbyFusionStep = 0;
+    memset(&laneCost, 0, sizeof(laneCost));
     gpsYawResetRequest = false;
     delAngBiasLearned = false;
     memset(&filterStatus, 0, sizeof(filterStatus));
@@ -328,6 +351,7 @@ void NavEKF3_core::InitialiseVariables()
     innovRngBcn = 0.0f;
     memset(&lastTimeRngBcn_ms, 0, sizeof(lastTimeRngBcn_ms));
     rngBcnDataToFuse = false;
+    memset(&rngBcnCost, 0, sizeof(rngBcnCost));
     beaconVehiclePosNED.zero();
     beaconVehiclePosErr = 1.0f;
     rngBcnLast3DmeasTime_ms = 0;
@@ -521,7 +545,7 @@ bool NavEKF3_core::InitialiseFilterBootstrap(void)
 void NavEKF3_core::CovarianceInit()
 {
     // zero the matrix
-    memset(&P[0][0], 0, sizeof(P));
+    P.zero();
 
     // define the initial angle uncertainty as variances for a rotation vector
     Vector3f rot_vec_var;
@@ -583,6 +607,7 @@ void NavEKF3_core::UpdateFilter(bool predict)
     void *istate = hal.scheduler->disable_interrupts_save();
 #endif
     hal.util->perf_begin(_perf_UpdateFilter);
+    const uint32_t start_us = AP_HAL::micros();
 
     fill_scratch_variables();
 
@@ -602,26 +627,43 @@ void NavEKF3_core::UpdateFilter(bool predict)
         // Predict the covariance growth
         CovariancePrediction();
 
-        // Update states using  magnetometer or external yaw sensor data
-        SelectMagFusion();
+        // A standby lane only fuses measurements on some updates. The
+        // states and covariance are still predicted on every update so
+        // the lane stays on the same fusion time horizon and can take
+        // over without realigning. Measurements it skips stay in the
+        // buffers and the newest is fused on the next fusion update
+        bool fuseMeasurements = true;
+        if (standbyMode) {
+            standbyFusionStep = (standbyFusionStep + 1) % EK3_STANDBY_FUSION_DIVIDER;
+            fuseMeasurements = (standbyFusionStep == 0);
+        } else {
+            standbyFusionStep = 0;
+        }
+
+        if (fuseMeasurements) {
+            // Update states using  magnetometer or external yaw sensor data
+            SelectMagFusion();
 
-        // Update states using GPS and altimeter data
-        SelectVelPosFusion();
+            // Update states using GPS and altimeter data
+            SelectVelPosFusion();
 
-        // Update states using range beacon data
-        SelectRngBcnFusion();
+            // Update states using range beacon data
+            SelectRngBcnFusion();
 
-        // Update states using optical flow data
-        SelectFlowFusion();
+            // Update states using optical flow data
+            SelectFlowFusion();
 
-        // Update states using body frame odometry data
-        SelectBodyOdomFusion();
+            // Update states using body frame odometry data
+            SelectBodyOdomFusion();
 
-        // Update states using airspeed data
-        SelectTasFusion();
+            // Update states using airspeed data
+            SelectTasFusion();
 
-        // Update states using sideslip constraint assumption for fly-forward vehicles
-        SelectBetaFusion();
+            // Update states using sideslip constraint assumption for fly-forward vehicles
+            SelectBetaFusion();
+        } else {
+            laneCost.fusion_skips++;
+        }
 
         // Update the filter status
         updateFilterStatus();
@@ -631,6 +673,10 @@ void NavEKF3_core::UpdateFilter(bool predict)
     calcOutputStates();
 
     // stop the timer used for load measurement
+    const uint32_t dt_us = AP_HAL::micros() - start_us;
+    laneCost.count++;
+    laneCost.total_us += dt_us;
+    laneCost.max_us = MAX(laneCost.max_us, dt_us);
     hal.util->perf_end(_perf_UpdateFilter);
 #if EK3_DISABLE_INTERRUPTS
     hal.scheduler->restore_interrupts(istate);
@@ -697,10 +743,10 @@ void NavEKF3_core::UpdateStrapdownEquationsNED()
     Vector3f lastVelocity = stateStruct.velocity;
 
     // sum delta velocities to get velocity
-    stateStruct.velocity += delVelNav;
+    stateVelAccum.add(stateStruct.velocity, delVelNav);
 
     // apply a trapezoidal integration to velocities to calculate position
-    stateStruct.position += (stateStruct.velocity + lastVelocity) * (imuDataDelayed.delVelDT*0.5f);
+    statePosAccum.add(stateStruct.position, (stateStruct.velocity + lastVelocity) * (imuDataDelayed.delVelDT*0.5f));
 
     // accumulate the bias delta angle and time since last reset by an OF measurement arrival
     delAngBodyOF += delAngCorrected;
@@ -759,7 +805,7 @@ void NavEKF3_core::calcOutputStates()
     Vector3f lastVelocity = outputDataNew.velocity;
 
     // sum delta velocities to get velocity
-    outputDataNew.velocity += delVelNav;
+    outputVelAccum.add(outputDataNew.velocity, delVelNav);
 
     // Implement third order complementary filter for height and height rate
     // Reference Paper :
@@ -780,7 +826,7 @@ void NavEKF3_core::calcOutputStates()
     vertCompFiltState.pos += integ3_input; 
 
     // apply a trapezoidal integration to velocities to calculate position
-    outputDataNew.position += (outputDataNew.velocity + lastVelocity) * (imuDataNew.delVelDT*0.5f);
+    outputPosAccum.add(outputDataNew.position, (outputDataNew.velocity + lastVelocity) * (imuDataNew.delVelDT*0.5f));
 
     // If the IMU accelerometer is offset from the body frame origin, then calculate corrections
     // that can be added to the EKF velocity and position outputs so that they represent the velocity
@@ -1379,15 +1425,11 @@ void NavEKF3_core::CovariancePrediction()
         }
     }
 
-    // covariance matrix is symmetrical, so copy diagonals and copy lower half in nextP
-    // to lower and upper half in P
+    // covariance matrix is symmetrical, so copy the diagonals and upper half
+    // of nextP into the packed storage of P
+    ftype *Pdata = P.packed();
     for (uint8_t row = 0; row <= stateIndexLim; row++) {
-        // copy diagonals
-        P[row][row] = nextP[row][row];
-        // copy off diagonals
-        for (uint8_t column = 0 ; column < row; column++) {
-            P[row][column] = P[column][row] = nextP[column][row];
-        }
+        memcpy(&Pdata[Matrix24Sym::upper_index(row, row)], &nextP[row][row], sizeof(ftype)*(stateIndexLim + 1 - row));
     }
 
     // constrain values to prevent ill-conditioning
@@ -1396,24 +1438,36 @@ void NavEKF3_core::CovariancePrediction()
     hal.util->perf_end(_perf_CovariancePrediction);
 }
 
-// zero specified range of rows in the state covariance matrix
-void NavEKF3_core::zeroRows(Matrix24 &covMat, uint8_t first, uint8_t last)
+// zero specified range of rows and columns in the state covariance matrix
+void NavEKF3_core::zeroRowsCols(Matrix24Sym &covMat, uint8_t first, uint8_t last)
 {
-    uint8_t row;
-    for (row=first; row<=last; row++)
-    {
-        memset(&covMat[row][0], 0, sizeof(covMat[0][0])*24);
-    }
+    covMat.zero_rows_cols(first, last);
 }
 
-// zero specified range of columns in the state covariance matrix
-void NavEKF3_core::zeroCols(Matrix24 &covMat, uint8_t first, uint8_t last)
+/*
+  correct the covariance P = (I - K*H)*P for a scalar measurement.
+  K*H*P is the outer product of K with the row vector H*P, so only H*P
+  needs a sparse product over the nonzero elements of H and each
+  element of the upper triangle is then a single multiply, instead of
+  forming K*H and multiplying it by P
+ */
+bool NavEKF3_core::sparseCovarianceUpdate(const ftype *H, const uint8_t *idx, uint8_t nidx, bool check_variances)
 {
-    uint8_t row;
-    for (row=0; row<=23; row++)
-    {
-        memset(&covMat[row][first], 0, sizeof(covMat[0][0])*(1+last-first));
+    const uint8_t n = stateIndexLim + 1;
+    ftype HP[24];
+    P.sparse_vec_mul(HP, H, idx, nidx, n);
+
+    // check that we are not going to drive any variances negative
+    if (check_variances) {
+        for (uint8_t i = 0; i < n; i++) {
+            if (Kfusion[i] * HP[i] > P[i][i]) {
+                return false;
+            }
+        }
     }
+
+    P.sub_outer(&Kfusion[0], HP, n);
+    return true;
 }
 
 // reset the output data to the current EKF state
@@ -1461,20 +1515,6 @@ void NavEKF3_core::quat2Tbn(Matrix3f &Tbn, const Quaternion &quat) const
     quat.rotation_matrix(Tbn);
 }
 
-// force symmetry on the covariance matrix to prevent ill-conditioning
-void NavEKF3_core::ForceSymmetry()
-{
-    for (uint8_t i=1; i<=stateIndexLim; i++)
-    {
-        for (uint8_t j=0; j<=i-1; j++)
-        {
-            float temp = 0.5f*(P[i][j] + P[j][i]);
-            P[i][j] = temp;
-            P[j][i] = temp;
-        }
-    }
-}
-
 // constrain variances (diagonal terms) in the state covariance matrix to  prevent ill-conditioning
 // if states are inactive, zero the corresponding off-diagonals
 void NavEKF3_core::ConstrainVariances()
@@ -1487,8 +1527,7 @@ void NavEKF3_core::ConstrainVariances()
     if (!inhibitDelAngBiasStates) {
         for (uint8_t i=10; i<=12; i++) P[i][i] = constrain_float(P[i][i],0.0f,sq(0.175f * dtEkfAvg));
     } else {
-        zeroCols(P,10,12);
-        zeroRows(P,10,12);
+        zeroRowsCols(P,10,12);
     }
 
     if (!inhibitDelVelBiasStates) {
@@ -1513,7 +1552,7 @@ void NavEKF3_core::ConstrainVariances()
                 delVelBiasVar[i] = P[i+13][i+13];
             }
             // reset all delta velocity bias covariances
-            zeroCols(P,13,15);
+            zeroRowsCols(P,13,15);
             // restore all delta velocity bias variances
             for (uint8_t i=0; i<=2; i++) {
                 P[i+13][i+13] = delVelBiasVar[i];
@@ -1521,23 +1560,20 @@ void NavEKF3_core::ConstrainVariances()
         }
 
     } else {
-        zeroCols(P,13,15);
-        zeroRows(P,13,15);
+        zeroRowsCols(P,13,15);
     }
 
     if (!inhibitMagStates) {
         for (uint8_t i=16; i<=18; i++) P[i][i] = constrain_float(P[i][i],0.0f,0.01f); // earth magnetic field
         for (uint8_t i=19; i<=21; i++) P[i][i] = constrain_float(P[i][i],0.0f,0.01f); // body magnetic field
     } else {
-        zeroCols(P,16,21);
-        zeroRows(P,16,21);
+        zeroRowsCols(P,16,21);
     }
 
     if (!inhibitWindStates) {
         for (uint8_t i=22; i<=23; i++) P[i][i] = constrain_float(P[i][i],0.0f,1.0e3f);
     } else {
-        zeroCols(P,22,23);
-        zeroRows(P,22,23);
+        zeroRowsCols(P,22,23);
     }
 }
 
@@ -1659,8 +1695,7 @@ Quaternion NavEKF3_core::calcQuatAndFieldStates(float roll, float pitch)
             alignMagStateDeclination();
 
             // set the remaining variances and covariances
-            zeroRows(P,18,21);
-            zeroCols(P,18,21);
+            zeroRowsCols(P,18,21);
             P[18][18] = sq(frontend->_magNoise);
             P[19][19] = P[18][18];
             P[20][20] = P[18][18];
@@ -1691,8 +1726,7 @@ void NavEKF3_core::zeroAttCovOnly()
     for (uint8_t index=0; index<=3; index++) {
         varTemp[index] = P[index][index];
     }
-    zeroCols(P,0,3);
-    zeroRows(P,0,3);
+    zeroRowsCols(P,0,3);
     for (uint8_t index=0; index<=3; index++) {
         P[index][index] = varTemp[index];
     }
@@ -1813,8 +1847,7 @@ void NavEKF3_core::initialiseQuatCovariances(const Vector3f &rotVarVec)
         float t44 = t17-t36;
 
         // zero all the quaternion covariances
-        zeroRows(P,0,3);
-        zeroCols(P,0,3);
+        zeroRowsCols(P,0,3);
 
         // Update the quaternion internal covariances using auto-code generated using matlab symbolic toolbox
         P[0][0] = rotVarVec.x*t2*t9*t10*0.25f+rotVarVec.y*t4*t9*t10*0.25f+rotVarVec.z*t5*t9*t10*0.25f;
@@ -27,8 +27,11 @@
 #include <AP_Math/AP_Math.h>
 #include "AP_NavEKF3.h"
 #include <AP_Math/vectorN.h>
+#include <AP_Math/matrixN_sym.h>
+#include <AP_Math/vector_kernels.h>
 #include <AP_NavEKF/AP_NavEKF_core_common.h>
-#include <AP_NavEKF3/AP_NavEKF3_Buffer.h>
+#include <AP_NavEKF/EKF_Buffer.h>
+#include <AP_NavEKF/EKF_Accumulator.h>
 #include <AP_InertialSensor/AP_InertialSensor.h>
 
 // GPS pre-flight check bit locations
@@ -59,9 +62,27 @@
 #define EKF_TARGET_DT_MS 12
 #define EKF_TARGET_DT    0.012f
 
+// integrate the velocity and position in double precision on boards
+// with a double precision FPU. Other boards use compensated single
+// precision sums, which keep most of the accuracy for less CPU
+#ifndef EK3_POSITION_DOUBLE
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX || (defined(__ARM_FP) && (__ARM_FP & 8))
+#define EK3_POSITION_DOUBLE 1
+#else
+#define EK3_POSITION_DOUBLE 0
+#endif
+#endif
+
+// a standby lane fuses measurements on one in this many updates
+#define EK3_STANDBY_FUSION_DIVIDER 2
+
 // mag fusion final reset altitude (using NED frame so altitude is negative)
 #define EKF3_MAG_FINAL_RESET_ALT 2.5f
 
+// maximum number of range beacon measurements fused together in one
+// update when batching beacons
+#define EK3_RNG_BCN_BATCH_MAX 16
+
 class AP_AHRS;
 
 class NavEKF3_core : public NavEKF_core_common
@@ -367,7 +388,23 @@ public:
     // get timing statistics structure
     void getTimingStatistics(struct ekf_timing &timing);
 
+    // get observation buffer statistics structure, zeroing the counts
+    void getBufferStatistics(struct ekf_buffer_stats &stats);
+
+    // run as a standby lane, which fuses measurements at a reduced
+    // rate but still predicts the states at the full rate
+    void setStandby(bool standby) { standbyMode = standby; }
+
+    // get the update cost of this lane, zeroing the counts
+    void getLaneStatistics(struct ekf_lane_stats &stats);
+
+    // get the cost of range beacon fusion, zeroing the counts
+    void getBeaconStatistics(struct ekf_beacon_stats &stats);
+
 private:
+    // allow the benchmarks to drive individual prediction and fusion steps
+    friend class NavEKF3_Benchmark;
+
     // Reference to the global EKF frontend for parameters
     NavEKF3 *frontend;
     uint8_t imu_index; // preferred IMU index
@@ -426,6 +463,24 @@ private:
     typedef ftype Matrix34_50[34][50];
     typedef uint32_t Vector_u32_50[50];
 #endif
+    typedef SymMatrixN<ftype,24> Matrix24Sym;
+#if EK3_POSITION_DOUBLE
+    typedef EKF_Accumulator3<double> Accumulator3;
+#else
+    typedef EKF_Accumulator3<float> Accumulator3;
+#endif
+
+#if HAL_NAVEKF3_PARALLEL_CORES
+    // when cores can run in parallel each needs its own scratch
+    // space. These hide the shared copies in NavEKF_core_common
+    Matrix24 KH;
+    Matrix24 KHP;
+    Matrix24 nextP;
+    Vector28 Kfusion;
+
+    // fill the per-core scratch variables with NaN on SITL
+    void fill_scratch_variables(void);
+#endif
 
     const AP_AHRS *_ahrs;
 
@@ -548,9 +603,6 @@ private:
     // calculate the predicted state covariance matrix
     void CovariancePrediction();
 
-    // force symmetry on the state covariance matrix
-    void ForceSymmetry();
-
     // constrain variances (diagonal terms) in the state covariance matrix
     void ConstrainVariances();
 
@@ -569,12 +621,26 @@ private:
     // fuse range beacon measurements
     void FuseRngBcn();
 
+    // fuse a set of range beacon measurements, sharing the beacon
+    // vertical offset update between them
+    void FuseRngBcnBatch(const rng_bcn_elements *meas, uint8_t n);
+
+    // fuse a single range beacon measurement to a beacon at bcnPosNED,
+    // returning false if the covariance had to be reset
+    bool FuseRngBcnMeas(const rng_bcn_elements &meas, const Vector3f &bcnPosNED, float gateSq, bool fuseHgt);
+
     // use range beacon measurements to calculate a static position
     void FuseRngBcnStatic();
 
     // calculate the offset from EKF vertical position datum to the range beacon system datum
     void CalcRangeBeaconPosDownOffset(float obsVar, Vector3f &vehiclePosNED, bool aligning);
 
+    // update the high and low hypotheses of the beacon vertical offset with one measurement
+    void updateRangeBeaconPosDownOffset(const rng_bcn_elements &meas, float obsVar, const Vector3f &vehiclePosNED, bool aligning);
+
+    // select the beacon vertical offset hypothesis to use
+    void selectRangeBeaconPosDownOffset(const Vector3f &vehiclePosNED);
+
     // fuse magnetometer measurements
     void FuseMagnetometer();
 
@@ -584,11 +650,14 @@ private:
     // fuse synthetic sideslip measurement of zero
     void FuseSideslip();
 
-    // zero specified range of rows in the state covariance matrix
-    void zeroRows(Matrix24 &covMat, uint8_t first, uint8_t last);
+    // zero specified range of rows and columns in the state covariance matrix
+    void zeroRowsCols(Matrix24Sym &covMat, uint8_t first, uint8_t last);
 
-    // zero specified range of columns in the state covariance matrix
-    void zeroCols(Matrix24 &covMat, uint8_t first, uint8_t last);
+    // correct the covariance for a scalar measurement with gain Kfusion
+    // and a Jacobian H which is zero except at the nidx states in idx.
+    // Returns false without changing P if check_variances is set and
+    // the update would make a variance negative
+    bool sparseCovarianceUpdate(const ftype *H, const uint8_t *idx, uint8_t nidx, bool check_variances);
 
     // Reset the stored output history to current data
     void StoreOutputReset(void);
@@ -672,6 +741,11 @@ private:
     // check for new range beacon data and update stored measurements if available
     void readRngBcnData();
 
+    // recall range beacon data at the fusion time horizon into
+    // rngBcnDataDelayed, taking the oldest rather than the newest when
+    // oldest is true
+    bool recallRngBcnData(bool oldest);
+
     // determine when to perform fusion of GPS position and  velocity measurements
     void SelectVelPosFusion();
 
@@ -863,7 +937,7 @@ private:
     bool badIMUdata;                // boolean true if the bad IMU data is detected
 
     float gpsNoiseScaler;           // Used to scale the  GPS measurement noise and consistency gates to compensate for operation with small satellite counts
-    Matrix24 P;                     // covariance matrix
+    Matrix24Sym P;                  // covariance matrix, upper triangle only
     imu_ring_buffer_t<imu_elements> storedIMU;      // IMU data buffer
     obs_ring_buffer_t<gps_elements> storedGPS;      // GPS data buffer
     obs_ring_buffer_t<mag_elements> storedMag;      // Magnetometer data buffer
@@ -1155,6 +1229,13 @@ private:
     float innovRngBcn;                  // range beacon observation innovation (m)
     uint32_t lastTimeRngBcn_ms[10];     // last time we received a range beacon measurement (msec)
     bool rngBcnDataToFuse;              // true when there is new range beacon data to fuse
+    rng_bcn_elements rngBcnBatch[EK3_RNG_BCN_BATCH_MAX]; // Range beacon data to fuse on this update
+    struct {
+        uint32_t count;
+        uint32_t meas;
+        uint32_t total_us;
+        uint32_t max_us;
+    } rngBcnCost;                       // cost of range beacon fusion
     Vector3f beaconVehiclePosNED;       // NED position estimate from the beacon system (NED)
     float beaconVehiclePosErr;          // estimated position error from the beacon system (m)
     uint32_t rngBcnLast3DmeasTime_ms;   // last time the beacon system returned a 3D fix (msec)
@@ -1300,6 +1381,23 @@ private:
 
     // timing statistics
     struct ekf_timing timing;
+
+    // the part of the velocity and position integration that is below
+    // the resolution of the float states
+    Accumulator3 stateVelAccum;
+    Accumulator3 statePosAccum;
+    Accumulator3 outputVelAccum;
+    Accumulator3 outputPosAccum;
+
+    // standby lane state and the cost of the filter updates
+    bool standbyMode;
+    uint8_t standbyFusionStep;
+    struct {
+        uint32_t count;
+        uint32_t total_us;
+        uint32_t max_us;
+        uint32_t fusion_skips;
+    } laneCost;
     
     // should we assume zero sideslip?
     bool assume_zero_sideslip(void) const;
@@ -0,0 +1,312 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  Benchmarks for the EKF3 covariance prediction and fusion steps.
+
+  Each benchmark runs one step of a single core against a sequence of
+  sensor samples recorded from a slow circle at 10m altitude. The
+  filter state and covariance are restored before every iteration so
+  each step is timed from the same starting point, and the cost of a
+  full lane can be estimated by adding the steps at their fusion rates.
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Baro/AP_Baro.h>
+#include <AP_Compass/AP_Compass.h>
+#include <AP_GPS/AP_GPS.h>
+#include <AP_InertialSensor/AP_InertialSensor.h>
+#include <AP_Logger/AP_Logger.h>
+#include <AP_NavEKF3/AP_NavEKF3.h>
+#include <AP_NavEKF3/AP_NavEKF3_core.h>
+#include <AP_RangeFinder/AP_RangeFinder.h>
+#include <AP_SerialManager/AP_SerialManager.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static AP_InertialSensor ins;
+static AP_GPS gps;
+static AP_Baro barometer;
+static Compass compass;
+static AP_SerialManager serial_manager;
+static AP_Int32 logger_bitmask;
+static AP_Logger logger{logger_bitmask};
+
+const struct AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+static GCS_Dummy _gcs;
+static RangeFinder rangefinder;
+static NavEKF3 ekf3{nullptr, rangefinder};
+
+#define BENCH_NUM_SAMPLES 64
+#define BENCH_DT 0.0025f
+#define BENCH_NUM_BEACONS 8
+
+/*
+  drives the private prediction and fusion steps of one EKF3 core
+ */
+class NavEKF3_Benchmark {
+public:
+    NavEKF3_Benchmark() : core(&ekf3)
+    {
+        core.InitialiseVariables();
+        core.dtEkfAvg = BENCH_DT;
+        core.dtIMUavg = BENCH_DT;
+        core.PV_AidingMode = NavEKF3_core::AID_ABSOLUTE;
+        core.tiltAlignComplete = true;
+        core.yawAlignComplete = true;
+        core.activeHgtSource = HGT_SOURCE_BARO;
+        core.N_beacons = 4;
+        core.rngOnGnd = 0.05f;
+        core.terrainState = 0.0f;
+
+        record_samples();
+
+        // start from the first sample with an aligned filter
+        core.stateStruct.quat.from_euler(0, 0, 0);
+        core.stateStruct.velocity = gps_samples[0].vel;
+        core.stateStruct.position = Vector3f(gps_samples[0].pos.x, gps_samples[0].pos.y, -10.0f);
+        core.stateStruct.earth_magfield = earth_field;
+        core.stateStruct.body_magfield.zero();
+        core.stateStruct.quat.inverse().rotation_matrix(core.prevTnb);
+        core.prevTnb.transpose();
+        core.imuDataDelayed = imu_samples[0];
+        core.CovarianceInit();
+
+        // let the covariance settle into a representative state
+        for (uint16_t i=0; i<500; i++) {
+            core.imuDataDelayed = imu_samples[i % BENCH_NUM_SAMPLES];
+            core.CovariancePrediction();
+        }
+        save();
+    }
+
+    void save()
+    {
+        memcpy(saved_states, core.statesArray, sizeof(saved_states));
+        saved_P = core.P;
+    }
+
+    void restore()
+    {
+        memcpy(core.statesArray, saved_states, sizeof(saved_states));
+        core.P = saved_P;
+    }
+
+    // load the inputs for one step from sample i of the recording
+    void load_sample(uint8_t i)
+    {
+        core.imuDataDelayed = imu_samples[i];
+        core.gpsDataDelayed = gps_samples[i];
+        core.magDataDelayed = mag_samples[i];
+        core.ofDataDelayed = flow_samples[i];
+        core.rngBcnDataDelayed = beacon_samples[i];
+        memcpy(beacon_set, beacon_sets[i], sizeof(beacon_set));
+        core.hgtMea = 10.0f;
+        core.posDownObsNoise = sq(0.5f);
+        core.fuseVelData = true;
+        core.fusePosData = true;
+        core.fuseHgtData = true;
+    }
+
+    void UpdateStrapdownEquationsNED() { core.UpdateStrapdownEquationsNED(); }
+    void CovariancePrediction() { core.CovariancePrediction(); }
+    void FuseVelPosNED() { core.FuseVelPosNED(); }
+    void FuseMagnetometer() { core.FuseMagnetometer(); }
+    void FuseOptFlow() { core.FuseOptFlow(); }
+    void FuseRngBcn() { core.FuseRngBcn(); }
+
+    // ranges to all 8 beacons fused one at a time, and as one set
+    void FuseRngBcnSequential() {
+        for (uint8_t k=0; k<BENCH_NUM_BEACONS; k++) {
+            core.rngBcnDataDelayed = beacon_set[k];
+            core.FuseRngBcn();
+        }
+    }
+    void FuseRngBcnBatch() { core.FuseRngBcnBatch(beacon_set, BENCH_NUM_BEACONS); }
+
+private:
+    // generate a deterministic recording of a 5m radius circle at
+    // 1m/s, with measurement errors small enough to pass the
+    // innovation gates
+    void record_samples()
+    {
+        const float radius = 5.0f;
+        const float speed = 1.0f;
+        const float omega = speed / radius;
+        for (uint8_t i=0; i<BENCH_NUM_SAMPLES; i++) {
+            const float t = i * BENCH_DT;
+            const float noise = 0.01f * sinf(i * 1.7f);
+
+            NavEKF3_core::imu_elements &imu = imu_samples[i];
+            imu.delAng = Vector3f(noise, -noise, omega) * BENCH_DT;
+            imu.delVel = Vector3f(-speed * omega, noise, -GRAVITY_MSS) * BENCH_DT;
+            imu.delAngDT = BENCH_DT;
+            imu.delVelDT = BENCH_DT;
+            imu.time_ms = i * 2.5f;
+
+            NavEKF3_core::gps_elements &g = gps_samples[i];
+            g.pos = Vector2f(radius * cosf(omega * t), radius * sinf(omega * t));
+            g.hgt = 10.0f + noise;
+            g.vel = Vector3f(-speed * sinf(omega * t), speed * cosf(omega * t), noise);
+            g.time_ms = imu.time_ms;
+
+            mag_samples[i].mag = earth_field + Vector3f(noise, noise, -noise) * 0.01f;
+            mag_samples[i].time_ms = imu.time_ms;
+
+            NavEKF3_core::of_elements &of = flow_samples[i];
+            of.flowRadXY = Vector2f(noise, -noise);
+            of.flowRadXYcomp = of.flowRadXY;
+            of.bodyRadXYZ = imu.delAng / BENCH_DT;
+            of.body_offset = &flow_offset;
+            of.time_ms = imu.time_ms;
+
+            static const Vector3f beacons[BENCH_NUM_BEACONS] = {
+                Vector3f(-20, -20, 0), Vector3f(20, -20, 0), Vector3f(20, 20, -2), Vector3f(-20, 20, -2),
+                Vector3f(0, -25, -1), Vector3f(25, 0, -3), Vector3f(0, 25, -1), Vector3f(-25, 0, -3)
+            };
+            for (uint8_t k=0; k<BENCH_NUM_BEACONS; k++) {
+                NavEKF3_core::rng_bcn_elements &bcn = beacon_sets[i][k];
+                bcn.beacon_ID = k;
+                bcn.beacon_posNED = beacons[k];
+                bcn.rng = (Vector3f(g.pos.x, g.pos.y, -10.0f) - bcn.beacon_posNED).length() + noise;
+                bcn.rngErr = 0.1f;
+                bcn.time_ms = imu.time_ms;
+            }
+            beacon_samples[i] = beacon_sets[i][i % 4];
+        }
+    }
+
+    NavEKF3_core core;
+
+    NavEKF3_core::Vector24 saved_states;
+    NavEKF3_core::Matrix24Sym saved_P;
+
+    const Vector3f earth_field{0.22f, 0.05f, -0.42f};
+    const Vector3f flow_offset;
+
+    NavEKF3_core::imu_elements imu_samples[BENCH_NUM_SAMPLES];
+    NavEKF3_core::gps_elements gps_samples[BENCH_NUM_SAMPLES];
+    NavEKF3_core::mag_elements mag_samples[BENCH_NUM_SAMPLES];
+    NavEKF3_core::of_elements flow_samples[BENCH_NUM_SAMPLES];
+    NavEKF3_core::rng_bcn_elements beacon_samples[BENCH_NUM_SAMPLES];
+    NavEKF3_core::rng_bcn_elements beacon_sets[BENCH_NUM_SAMPLES][BENCH_NUM_BEACONS];
+    NavEKF3_core::rng_bcn_elements beacon_set[BENCH_NUM_BEACONS];
+};
+
+static NavEKF3_Benchmark *bench;
+
+static void run_step(benchmark::State& state, void (NavEKF3_Benchmark::*step)())
+{
+    if (bench == nullptr) {
+        bench = new NavEKF3_Benchmark();
+    }
+    uint8_t i = 0;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        bench->restore();
+        bench->load_sample(i);
+        i = (i + 1) % BENCH_NUM_SAMPLES;
+        state.ResumeTiming();
+
+        (bench->*step)();
+        gbenchmark_clobber();
+    }
+}
+
+static void BM_EKF3_UpdateStrapdownEquationsNED(benchmark::State& state)
+{
+    run_step(state, &NavEKF3_Benchmark::UpdateStrapdownEquationsNED);
+}
+
+static void BM_EKF3_CovariancePrediction(benchmark::State& state)
+{
+    run_step(state, &NavEKF3_Benchmark::CovariancePrediction);
+}
+
+static void BM_EKF3_FuseVelPosNED(benchmark::State& state)
+{
+    run_step(state, &NavEKF3_Benchmark::FuseVelPosNED);
+}
+
+static void BM_EKF3_FuseMagnetometer(benchmark::State& state)
+{
+    run_step(state, &NavEKF3_Benchmark::FuseMagnetometer);
+}
+
+static void BM_EKF3_FuseOptFlow(benchmark::State& state)
+{
+    run_step(state, &NavEKF3_Benchmark::FuseOptFlow);
+}
+
+static void BM_EKF3_FuseRngBcn(benchmark::State& state)
+{
+    run_step(state, &NavEKF3_Benchmark::FuseRngBcn);
+}
+
+static void BM_EKF3_FuseRngBcnSequential(benchmark::State& state)
+{
+    run_step(state, &NavEKF3_Benchmark::FuseRngBcnSequential);
+}
+
+static void BM_EKF3_FuseRngBcnBatch(benchmark::State& state)
+{
+    run_step(state, &NavEKF3_Benchmark::FuseRngBcnBatch);
+}
+
+/*
+  cost of integrating a position 30km from the origin one IMU step at
+  a time, with a plain float sum and with the part below float
+  resolution carried in float or double. Compare on each target to
+  choose EK3_POSITION_DOUBLE
+ */
+static void BM_EKF3_PositionFloat(benchmark::State& state)
+{
+    Vector3f pos(30000, -30000, -100);
+    const Vector3f inc(0.0125f, 0.0031f, -0.0007f);
+    while (state.KeepRunning()) {
+        pos += inc;
+        gbenchmark_escape(&pos);
+    }
+}
+
+template <typename T>
+static void BM_EKF3_PositionAccumulator(benchmark::State& state)
+{
+    Vector3f pos(30000, -30000, -100);
+    const Vector3f inc(0.0125f, 0.0031f, -0.0007f);
+    EKF_Accumulator3<T> accum;
+    while (state.KeepRunning()) {
+        accum.add(pos, inc);
+        gbenchmark_escape(&pos);
+    }
+}
+
+BENCHMARK(BM_EKF3_UpdateStrapdownEquationsNED);
+BENCHMARK(BM_EKF3_PositionFloat);
+BENCHMARK_TEMPLATE(BM_EKF3_PositionAccumulator, float);
+BENCHMARK_TEMPLATE(BM_EKF3_PositionAccumulator, double);
+BENCHMARK(BM_EKF3_CovariancePrediction);
+BENCHMARK(BM_EKF3_FuseVelPosNED);
+BENCHMARK(BM_EKF3_FuseMagnetometer);
+BENCHMARK(BM_EKF3_FuseOptFlow);
+BENCHMARK(BM_EKF3_FuseRngBcn);
+BENCHMARK(BM_EKF3_FuseRngBcnSequential);
+BENCHMARK(BM_EKF3_FuseRngBcnBatch);
+
+BENCHMARK_MAIN()
@@ -29,6 +29,7 @@
 #include <AP_BattMonitor/AP_BattMonitor.h>
 #include <utility>
 #include <AP_Notify/AP_Notify.h>
+#include <AP_Logger/AP_Logger.h>
 
 const AP_Param::GroupInfo AP_OSD::var_info[] = {
 
@@ -225,6 +226,8 @@ void AP_OSD::osd_thread()
 
 void AP_OSD::update_osd()
 {
+    const uint32_t start_us = AP_HAL::micros();
+
     backend->clear();
     stats();
     update_current_screen();
@@ -232,7 +235,38 @@ void AP_OSD::update_osd()
     screen[current_screen].set_backend(backend);
     screen[current_screen].draw();
 
+    const uint32_t draw_end_us = AP_HAL::micros();
     backend->flush();
+    const uint32_t flush_end_us = AP_HAL::micros();
+
+    render.draw_us = draw_end_us - start_us;
+    render.flush_us = flush_end_us - draw_end_us;
+    render.draw_max_us = MAX(render.draw_max_us, render.draw_us);
+    render.flush_max_us = MAX(render.flush_max_us, render.flush_us);
+    log_render_stats();
+}
+
+/*
+  log the time taken to draw the screen and send it to the display,
+  with the number of characters changed and bytes sent, once a second
+ */
+void AP_OSD::log_render_stats()
+{
+    const uint32_t now = AP_HAL::millis();
+    if (now - render.last_log_ms < 1000) {
+        return;
+    }
+    render.last_log_ms = now;
+    AP::logger().Write("OSDR", "TimeUS,Draw,DrawMax,Flush,FlushMax,Cells,Bytes", "QIIIIII",
+                       AP_HAL::micros64(),
+                       render.draw_us,
+                       render.draw_max_us,
+                       render.flush_us,
+                       render.flush_max_us,
+                       backend->get_cells_written(),
+                       backend->get_bytes_sent());
+    render.draw_max_us = 0;
+    render.flush_max_us = 0;
 }
 
 //update maximums and totals
@@ -263,6 +263,7 @@ public:
 private:
     void osd_thread();
     void update_osd();
+    void log_render_stats();
     void stats();
     void update_current_screen();
     void next_screen();
@@ -286,4 +287,14 @@ private:
     float max_speed_mps;
     float max_current_a;
     float avg_current_a;
+
+    // time taken by the last draw of the screen and the last flush
+    // to the display, and the most since last logged
+    struct {
+        uint32_t draw_us;
+        uint32_t draw_max_us;
+        uint32_t flush_us;
+        uint32_t flush_max_us;
+        uint32_t last_log_ms;
+    } render;
 };
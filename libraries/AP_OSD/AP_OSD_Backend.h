@@ -54,6 +54,16 @@ public:
         return &_osd;
     }
 
+    // characters changed on the display and bytes sent to it since boot
+    uint32_t get_cells_written() const
+    {
+        return cells_written;
+    }
+    uint32_t get_bytes_sent() const
+    {
+        return bytes_sent;
+    }
+
 protected:
     AP_OSD& _osd;
 
@@ -70,6 +80,9 @@ protected:
     }
 
     int8_t blink_phase;
+
+    uint32_t cells_written;
+    uint32_t bytes_sent;
 };
 
 
@@ -120,6 +120,14 @@
 //time to wait nvm flash complete
 #define MAX_NVM_WAIT 10000
 
+// a gap of up to this many unchanged characters between changed ones
+// is rewritten rather than leaving and re-entering autoincrement mode,
+// which takes 10 bytes against 2 per character
+#define AUTOINCREMENT_MAX_GAP 4
+// the frame is sent in transactions of about this many bytes, so other
+// devices on the bus don't wait for the whole frame
+#define SPI_CHUNK_SIZE 128
+
 //black and white level
 #ifndef WHITEBRIGHTNESS
 #define WHITEBRIGHTNESS 0x01
@@ -386,42 +394,44 @@ void AP_OSD_MAX7456::transfer_frame()
     }
 
     buffer_offset = 0;
-    for (uint8_t y=0; y<video_lines; y++) {
-        for (uint8_t x=0; x<video_columns; x++) {
-            if (!is_dirty(x, y)) {
-                continue;
-            }
-            //ensure space for 1 char and escape sequence
-            if (buffer_offset >= spi_buffer_size - 32) {
-                break;
-            }
-            shadow_frame[y][x] = frame[y][x];
-            uint8_t chr = frame[y][x];
-            uint16_t pos = y * video_columns + x;
-            bool position_changed = ((previous_pos + 1) != pos);
-
-            if (position_changed && autoincrement) {
-                //it is impossible to write to MAX7456ADD_DMAH/MAX7456ADD_DMAL in autoincrement mode
-                //so, exit autoincrement mode
-                buffer_add_cmd(MAX7456ADD_DMDI, 0xFF);
-                buffer_add_cmd(MAX7456ADD_DMM, 0);
-                autoincrement = false;
-            }
+    const uint16_t num_cells = video_lines * video_columns;
+    for (uint16_t pos=0; pos<num_cells; pos++) {
+        const uint8_t y = pos / video_columns;
+        const uint8_t x = pos % video_columns;
+        const bool dirty = is_dirty(pos);
+        if (!dirty && !(autoincrement && is_dirty_within(pos + 1, AUTOINCREMENT_MAX_GAP))) {
+            continue;
+        }
+        bool position_changed = ((previous_pos + 1) != pos);
+
+        if (autoincrement && (position_changed || buffer_offset >= SPI_CHUNK_SIZE)) {
+            //it is impossible to write to MAX7456ADD_DMAH/MAX7456ADD_DMAL in autoincrement mode
+            //so, exit autoincrement mode
+            buffer_add_cmd(MAX7456ADD_DMDI, 0xFF);
+            buffer_add_cmd(MAX7456ADD_DMM, 0);
+            autoincrement = false;
+        }
 
-            if (!autoincrement) {
-                buffer_add_cmd(MAX7456ADD_DMAH, pos >> 8);
-                buffer_add_cmd(MAX7456ADD_DMAL, pos & 0xFF);
+        if (!autoincrement) {
+            if (buffer_offset >= SPI_CHUNK_SIZE) {
+                send_buffer();
             }
+            buffer_add_cmd(MAX7456ADD_DMAH, pos >> 8);
+            buffer_add_cmd(MAX7456ADD_DMAL, pos & 0xFF);
+        }
 
-            if (!autoincrement && is_dirty(x+1, y)) {
-                //(re)enter autoincrement mode
-                buffer_add_cmd(MAX7456ADD_DMM, DMM_AUTOINCREMENT);
-                autoincrement = true;
-            }
+        if (!autoincrement && is_dirty_within(pos + 1, AUTOINCREMENT_MAX_GAP + 1)) {
+            //(re)enter autoincrement mode
+            buffer_add_cmd(MAX7456ADD_DMM, DMM_AUTOINCREMENT);
+            autoincrement = true;
+        }
 
-            buffer_add_cmd(MAX7456ADD_DMDI, chr);
-            previous_pos = pos;
+        if (dirty) {
+            shadow_frame[y][x] = frame[y][x];
+            cells_written++;
         }
+        buffer_add_cmd(MAX7456ADD_DMDI, frame[y][x]);
+        previous_pos = pos;
     }
     if (autoincrement) {
         buffer_add_cmd(MAX7456ADD_DMDI, 0xFF);
@@ -430,20 +440,40 @@ void AP_OSD_MAX7456::transfer_frame()
     }
 
     if (buffer_offset > 0) {
-        _dev->get_semaphore()->take_blocking();
-        _dev->transfer(buffer, buffer_offset, nullptr, 0);
-        _dev->get_semaphore()->give();
+        send_buffer();
     }
 }
 
-bool AP_OSD_MAX7456::is_dirty(uint8_t x, uint8_t y)
+void AP_OSD_MAX7456::send_buffer()
 {
-    if (y>=video_lines || x>=video_columns) {
+    _dev->get_semaphore()->take_blocking();
+    _dev->transfer(buffer, buffer_offset, nullptr, 0);
+    _dev->get_semaphore()->give();
+    bytes_sent += buffer_offset;
+    buffer_offset = 0;
+}
+
+bool AP_OSD_MAX7456::is_dirty(uint16_t pos) const
+{
+    const uint8_t y = pos / video_columns;
+    const uint8_t x = pos % video_columns;
+    if (y>=video_lines) {
         return false;
     }
     return frame[y][x] != shadow_frame[y][x];
 }
 
+// check for a changed character in the count positions from pos
+bool AP_OSD_MAX7456::is_dirty_within(uint16_t pos, uint8_t count) const
+{
+    for (uint8_t i=0; i<count; i++) {
+        if (is_dirty(pos + i)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void AP_OSD_MAX7456::clear()
 {
     AP_OSD_Backend::clear();
@@ -56,7 +56,12 @@ private:
 
     void transfer_frame();
 
-    bool is_dirty(uint8_t x, uint8_t y);
+    // send the commands in the buffer in one transaction and empty it
+    void send_buffer();
+
+    bool is_dirty(uint16_t pos) const;
+
+    bool is_dirty_within(uint16_t pos, uint8_t count) const;
 
     AP_HAL::OwnPtr<AP_HAL::Device> _dev;
 
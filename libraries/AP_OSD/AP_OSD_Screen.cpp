@@ -1088,10 +1088,12 @@ void AP_OSD_Screen::draw_gspeed(uint8_t x, uint8_t y)
 //Thanks to betaflight/inav for simple and clean artificial horizon visual design
 void AP_OSD_Screen::draw_horizon(uint8_t x, uint8_t y)
 {
-    AP_AHRS &ahrs = AP::ahrs();
-    WITH_SEMAPHORE(ahrs.get_semaphore());
-    float roll = ahrs.roll;
-    float pitch = -ahrs.pitch;
+    AP_AHRS::Snapshot snap;
+    if (!AP::ahrs().get_snapshot(snap)) {
+        return;
+    }
+    float roll = snap.roll;
+    float pitch = -snap.pitch;
 
     //inverted roll AH
     if (check_option(AP_OSD::OPTION_INVERTED_AH_ROLL)) {
@@ -1153,13 +1155,12 @@ void AP_OSD_Screen::draw_distance(uint8_t x, uint8_t y, float distance)
 
 void AP_OSD_Screen::draw_home(uint8_t x, uint8_t y)
 {
-    AP_AHRS &ahrs = AP::ahrs();
-    WITH_SEMAPHORE(ahrs.get_semaphore());
-    Location loc;
-    if (ahrs.get_position(loc) && ahrs.home_is_set()) {
-        const Location &home_loc = ahrs.get_home();
+    AP_AHRS::Snapshot snap;
+    if (AP::ahrs().get_snapshot(snap) && snap.flags.location_valid && snap.flags.home_is_set) {
+        const Location &loc = snap.location;
+        const Location &home_loc = snap.home;
         float distance = home_loc.get_distance(loc);
-        int32_t angle = wrap_360_cd(loc.get_bearing_to(home_loc) - ahrs.yaw_sensor);
+        int32_t angle = wrap_360_cd(loc.get_bearing_to(home_loc) - degrees(snap.yaw) * 100);
         int32_t interval = 36000 / SYM_ARROW_COUNT;
         if (distance < 2.0f) {
             //avoid fast rotating arrow at small distances
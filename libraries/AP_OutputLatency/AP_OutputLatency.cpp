@@ -0,0 +1,163 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_OutputLatency.h"
+
+#include <AP_Logger/AP_Logger.h>
+#include <GCS_MAVLink/GCS.h>
+
+#include <stdio.h>
+
+extern const AP_HAL::HAL& hal;
+
+// upper edges of all but the last histogram bin
+static const uint16_t bin_edges_us[AP_OutputLatency::NUM_BINS-1] { 50, 100, 200, 300, 500, 1000, 2000 };
+
+AP_OutputLatency::AP_OutputLatency()
+{
+    if (_singleton != nullptr) {
+        AP_HAL::panic("AP_OutputLatency must be singleton");
+    }
+    _singleton = this;
+}
+
+void AP_OutputLatency::filtered(uint64_t sample_us, uint64_t now_us)
+{
+    WITH_SEMAPHORE(_sem);
+    record(Stage::FILTER, now_us - sample_us);
+}
+
+void AP_OutputLatency::start(uint64_t sample_us)
+{
+    start(sample_us, hal.rcout->get_push_dma_start_us());
+}
+
+void AP_OutputLatency::start(uint64_t sample_us, uint32_t dma_start_us)
+{
+    WITH_SEMAPHORE(_sem);
+
+    // the last push() was of the previous output, if it got that far
+    if (_pushed && dma_start_us != 0 && dma_start_us != _last_dma_start_us) {
+        const int32_t latency_us = int32_t(dma_start_us - uint32_t(_sample_us));
+        if (latency_us >= 0) {
+            record(Stage::DMA, latency_us);
+        }
+    }
+    _last_dma_start_us = dma_start_us;
+
+    _sample_us = sample_us;
+    _pushed = false;
+}
+
+void AP_OutputLatency::stage(Stage s, uint64_t now_us)
+{
+    WITH_SEMAPHORE(_sem);
+
+    if (_sample_us == 0 || now_us < _sample_us) {
+        return;
+    }
+    record(s, now_us - _sample_us);
+    if (s == Stage::OUTPUT) {
+        _pushed = true;
+    }
+}
+
+void AP_OutputLatency::record(Stage s, uint32_t latency_us)
+{
+    auto &st = _stages[uint8_t(s)];
+
+    if (latency_us > st.max_us) {
+        st.max_us = latency_us;
+    }
+    st.sum_us += latency_us;
+    st.count++;
+
+    uint8_t bin = 0;
+    while (bin < NUM_BINS-1 && latency_us >= bin_edges_us[bin]) {
+        bin++;
+    }
+    if (st.histogram[bin] < UINT16_MAX) {
+        st.histogram[bin]++;
+    }
+}
+
+bool AP_OutputLatency::take(Stage s, Stats &stats)
+{
+    WITH_SEMAPHORE(_sem);
+
+    auto &st = _stages[uint8_t(s)];
+    if (st.count == 0) {
+        return false;
+    }
+
+    stats.count = st.count;
+    stats.max_us = st.max_us;
+    stats.mean_us = float(st.sum_us) / st.count;
+    memcpy(stats.histogram, st.histogram, sizeof(stats.histogram));
+
+    memset(&st, 0, sizeof(st));
+
+    return true;
+}
+
+void AP_OutputLatency::report()
+{
+    static const char *names[NUM_STAGES] { "FLT", "PID", "MIX", "OUT", "DMA" };
+
+    for (uint8_t i = 0; i < NUM_STAGES; i++) {
+        Stats stats;
+        if (!take(Stage(i), stats)) {
+            continue;
+        }
+
+        AP_Logger *logger = AP_Logger::get_singleton();
+        if (logger != nullptr && logger->logging_started()) {
+            const struct log_OutputLatency pkt {
+                LOG_PACKET_HEADER_INIT(LOG_OUTPUT_LATENCY_MSG),
+                time_us  : AP_HAL::micros64(),
+                stage    : i,
+                count    : stats.count,
+                mean_us  : stats.mean_us,
+                max_us   : stats.max_us,
+                h0       : stats.histogram[0],
+                h1       : stats.histogram[1],
+                h2       : stats.histogram[2],
+                h3       : stats.histogram[3],
+                h4       : stats.histogram[4],
+                h5       : stats.histogram[5],
+                h6       : stats.histogram[6],
+                h7       : stats.histogram[7],
+            };
+            logger->WriteBlock(&pkt, sizeof(pkt));
+        }
+
+        char name[10];
+        snprintf(name, sizeof(name), "LAT%s", names[i]);
+        gcs().send_named_float(name, stats.mean_us);
+        snprintf(name, sizeof(name), "LAT%sMX", names[i]);
+        gcs().send_named_float(name, stats.max_us);
+    }
+}
+
+AP_OutputLatency *AP_OutputLatency::_singleton;
+
+namespace AP {
+
+AP_OutputLatency *output_latency()
+{
+    return AP_OutputLatency::get_singleton();
+}
+
+}
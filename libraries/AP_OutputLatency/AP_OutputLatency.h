@@ -0,0 +1,111 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  latency from a gyro sample to the motor outputs calculated from it.
+
+  The vehicle calls start() with the time of the gyro sample each
+  output is calculated from, then the attitude controller, motors and
+  vehicle call stage() as the output passes through them. Each stage
+  records the time since the gyro sample, so the stages show where
+  the latency builds up. The time the outputs started going out by
+  DMA is only known afterwards, so it is taken from RCOutput at the
+  next start().
+
+  The vehicle calls report() at a low rate from the main thread, which
+  logs the statistics gathered since the last report, sends the mean
+  and maximum of each stage to the GCS and starts a new period.
+ */
+
+#include <AP_HAL/AP_HAL.h>
+
+class AP_OutputLatency
+{
+public:
+    AP_OutputLatency();
+
+    /* Do not allow copies */
+    AP_OutputLatency(const AP_OutputLatency &other) = delete;
+    AP_OutputLatency &operator=(const AP_OutputLatency&) = delete;
+
+    static AP_OutputLatency *get_singleton() { return _singleton; }
+
+    enum class Stage : uint8_t {
+        FILTER   = 0,   // gyro sample filtered
+        RATE_PID = 1,   // rate controller run on it
+        MIXER    = 2,   // motor outputs mixed and written
+        OUTPUT   = 3,   // outputs pushed to RCOutput
+        DMA      = 4,   // DShot DMA started
+    };
+    static const uint8_t NUM_STAGES = 5;
+
+    // histogram bins of the latency in microseconds: <50, 50-100,
+    // 100-200, 200-300, 300-500, 500-1000, 1000-2000, >2000
+    static const uint8_t NUM_BINS = 8;
+
+    struct Stats {
+        uint32_t count;
+        uint32_t max_us;
+        float mean_us;
+        uint16_t histogram[NUM_BINS];
+    };
+
+    // a sample of the primary gyro taken at sample_us was filtered at now_us
+    void filtered(uint64_t sample_us, uint64_t now_us);
+
+    // the output now being calculated comes from the gyro sample
+    // taken at sample_us. dma_start_us is the time the outputs of the
+    // last push() started going out by DMA, zero if not known
+    void start(uint64_t sample_us, uint32_t dma_start_us);
+    void start(uint64_t sample_us);
+
+    // the output being calculated reached a stage at now_us
+    void stage(Stage s, uint64_t now_us);
+    void stage(Stage s) { stage(s, AP_HAL::micros64()); }
+
+    // return the statistics of a stage since the last call and start
+    // a new period. Returns false if there were no outputs
+    bool take(Stage s, Stats &stats);
+
+    // take the statistics of every stage, then log them and send them
+    // to the GCS
+    void report();
+
+private:
+    static AP_OutputLatency *_singleton;
+
+    void record(Stage s, uint32_t latency_us);
+
+    HAL_Semaphore _sem;
+
+    // gyro sample of the output being calculated
+    uint64_t _sample_us;
+    // has it been pushed to RCOutput?
+    bool _pushed;
+    // last DMA start recorded, so a push is only counted once
+    uint32_t _last_dma_start_us;
+
+    struct {
+        uint32_t count;
+        uint32_t max_us;
+        uint64_t sum_us;
+        uint16_t histogram[NUM_BINS];
+    } _stages[NUM_STAGES];
+};
+
+namespace AP {
+    AP_OutputLatency *output_latency();
+};
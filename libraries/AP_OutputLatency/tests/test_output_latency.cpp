@@ -0,0 +1,101 @@
+#include <AP_gtest.h>
+
+#include <AP_OutputLatency/AP_OutputLatency.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// it is a singleton, so every test shares it and empties it after use
+static AP_OutputLatency latency;
+
+TEST(OutputLatencyTest, NoOutputs)
+{
+    AP_OutputLatency::Stats stats;
+
+    EXPECT_FALSE(latency.take(AP_OutputLatency::Stage::RATE_PID, stats));
+    // nothing is recorded before the first start()
+    latency.stage(AP_OutputLatency::Stage::RATE_PID, 1000);
+    EXPECT_FALSE(latency.take(AP_OutputLatency::Stage::RATE_PID, stats));
+}
+
+TEST(OutputLatencyTest, Stages)
+{
+    AP_OutputLatency::Stats stats;
+
+    // outputs from samples 2500us apart, taking 100 or 300us to the
+    // rate PID and 400us to the push
+    uint64_t t = 1000000;
+    for (uint8_t i = 0; i < 10; i++) {
+        latency.filtered(t, t + 40);
+        latency.start(t, 0);
+        latency.stage(AP_OutputLatency::Stage::RATE_PID, t + ((i & 1) ? 300 : 100));
+        latency.stage(AP_OutputLatency::Stage::OUTPUT, t + 400);
+        t += 2500;
+    }
+
+    ASSERT_TRUE(latency.take(AP_OutputLatency::Stage::FILTER, stats));
+    EXPECT_EQ(10U, stats.count);
+    EXPECT_EQ(40U, stats.max_us);
+    EXPECT_FLOAT_EQ(40.0f, stats.mean_us);
+    EXPECT_EQ(10U, stats.histogram[0]);
+
+    ASSERT_TRUE(latency.take(AP_OutputLatency::Stage::RATE_PID, stats));
+    EXPECT_EQ(10U, stats.count);
+    EXPECT_EQ(300U, stats.max_us);
+    EXPECT_FLOAT_EQ(200.0f, stats.mean_us);
+    EXPECT_EQ(5U, stats.histogram[2]);
+    EXPECT_EQ(5U, stats.histogram[4]);
+
+    ASSERT_TRUE(latency.take(AP_OutputLatency::Stage::OUTPUT, stats));
+    EXPECT_EQ(10U, stats.count);
+    EXPECT_EQ(10U, stats.histogram[4]);
+
+    // no DMA times were given and the mixer was never reached
+    EXPECT_FALSE(latency.take(AP_OutputLatency::Stage::DMA, stats));
+    EXPECT_FALSE(latency.take(AP_OutputLatency::Stage::MIXER, stats));
+
+    // a new period starts empty
+    EXPECT_FALSE(latency.take(AP_OutputLatency::Stage::RATE_PID, stats));
+}
+
+TEST(OutputLatencyTest, Histogram)
+{
+    AP_OutputLatency::Stats stats;
+
+    const uint32_t latencies[] = { 10, 50, 150, 250, 400, 700, 1500, 5000 };
+    uint64_t t = 1000000;
+    for (uint32_t l : latencies) {
+        latency.start(t, 0);
+        latency.stage(AP_OutputLatency::Stage::MIXER, t + l);
+        t += 10000;
+    }
+    ASSERT_TRUE(latency.take(AP_OutputLatency::Stage::MIXER, stats));
+    EXPECT_EQ(8U, stats.count);
+    EXPECT_EQ(5000U, stats.max_us);
+    for (uint8_t i = 0; i < AP_OutputLatency::NUM_BINS; i++) {
+        EXPECT_EQ(1U, stats.histogram[i]);
+    }
+}
+
+TEST(OutputLatencyTest, DMA)
+{
+    AP_OutputLatency::Stats stats;
+
+    // the DMA start of each push is only seen at the next start(), and
+    // wraps the 32 bit clock on the way
+    uint64_t t = 0xFFFFFF00;
+    latency.start(t, 0);
+    latency.stage(AP_OutputLatency::Stage::OUTPUT, t + 200);
+    latency.start(t + 2500, uint32_t(t + 250));
+    // the same DMA start again is not a new push
+    latency.stage(AP_OutputLatency::Stage::OUTPUT, t + 2700);
+    latency.start(t + 5000, uint32_t(t + 250));
+    // an output that was never pushed has no DMA start
+    latency.start(t + 7500, uint32_t(t + 5300));
+
+    ASSERT_TRUE(latency.take(AP_OutputLatency::Stage::DMA, stats));
+    EXPECT_EQ(1U, stats.count);
+    EXPECT_EQ(250U, stats.max_us);
+    latency.take(AP_OutputLatency::Stage::OUTPUT, stats);
+}
+
+AP_GTEST_MAIN()
@@ -72,14 +72,35 @@ uint16_t AP_Param::_num_vars;
 // cached parameter count
 uint16_t AP_Param::_parameter_count;
 
+#if AP_PARAM_NAME_INDEX_ENABLED
+struct AP_Param::name_index_entry *AP_Param::_name_index;
+uint16_t *AP_Param::_name_order;
+uint16_t AP_Param::_name_index_count;
+uint16_t AP_Param::_name_index_size;
+bool AP_Param::_name_index_valid;
+HAL_Semaphore AP_Param::_name_index_sem;
+#endif
+
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+struct AP_Param::storage_index_slot *AP_Param::_storage_index;
+uint8_t AP_Param::_storage_index_bits;
+uint16_t AP_Param::_storage_index_count;
+bool AP_Param::_storage_index_valid;
+HAL_Semaphore AP_Param::_storage_index_sem;
+#endif
+
 // storage and naming information about all types that can be saved
 const AP_Param::Info *AP_Param::_var_info;
 
+// phase timings of the last load_all()
+AP_Param::LoadTiming AP_Param::_load_timing;
+
 struct AP_Param::param_override *AP_Param::param_overrides = nullptr;
 uint16_t AP_Param::num_param_overrides = 0;
 uint16_t AP_Param::num_read_only = 0;
 
-ObjectBuffer<AP_Param::param_save> AP_Param::save_queue{30};
+ObjectBuffer<AP_Param::param_save> AP_Param::save_queue{AP_PARAM_SAVE_QUEUE_SIZE};
+HAL_Semaphore AP_Param::save_queue_sem;
 bool AP_Param::registered_save_handler;
 
 // we need a dummy object for the parameter save callback
@@ -143,6 +164,10 @@ void AP_Param::erase_all(void)
 
     // add a sentinal directly after the header
     write_sentinal(sizeof(struct EEPROM_header));
+
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+    storage_index_reset(true);
+#endif
 }
 
 /* the 'group_id' of a element of a group is the 18 bit identifier
@@ -703,6 +728,19 @@ bool AP_Param::is_sentinal(const Param_header &phdr)
 // if the sentinal isn't found either, the offset is set to 0xFFFF
 bool AP_Param::scan(const AP_Param::Param_header *target, uint16_t *pofs)
 {
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+    {
+        WITH_SEMAPHORE(_storage_index_sem);
+        if (_storage_index_valid) {
+            if (storage_index_find(*target, *pofs)) {
+                return true;
+            }
+            *pofs = sentinal_offset;
+            return false;
+        }
+    }
+#endif
+
     struct Param_header phdr;
     uint16_t ofs = sizeof(AP_Param::EEPROM_header);
     while (ofs < _storage.size()) {
@@ -858,6 +896,18 @@ AP_Param::find_group(const char *name, uint16_t vindex, ptrdiff_t group_offset,
 AP_Param *
 AP_Param::find(const char *name, enum ap_var_type *ptype, uint16_t *flags)
 {
+#if AP_PARAM_NAME_INDEX_ENABLED
+    AP_Param *indexed = find_in_name_index(name, ptype);
+    if (indexed != nullptr) {
+        if (flags != nullptr) {
+            indexed->get_group_flags(flags);
+        }
+        return indexed;
+    }
+    // parameters hidden in disabled groups, whole vectors, names in
+    // a different case and objects allocated since the index was
+    // built can still be found by searching the tree
+#endif
     for (uint16_t i=0; i<_num_vars; i++) {
         uint8_t type = _var_info[i].type;
         if (type == AP_PARAM_GROUP) {
@@ -872,14 +922,7 @@ AP_Param::find(const char *name, enum ap_var_type *ptype, uint16_t *flags)
             AP_Param *ap = find_group(name + len, i, 0, group_info, ptype);
             if (ap != nullptr) {
                 if (flags != nullptr) {
-                    uint32_t group_element = 0;
-                    const struct GroupInfo *ginfo;
-                    struct GroupNesting group_nesting {};
-                    uint8_t idx;
-                    ap->find_var_info(&group_element, ginfo, group_nesting, &idx);
-                    if (ginfo != nullptr) {
-                        *flags = ginfo->flags;
-                    }
+                    ap->get_group_flags(flags);
                 }
                 return ap;
             }
@@ -898,11 +941,25 @@ AP_Param::find(const char *name, enum ap_var_type *ptype, uint16_t *flags)
     return nullptr;
 }
 
-// Find a variable by index. Note that this is quite slow.
+// Find a variable by index. Note that this is quite slow unless the
+// name index has been built.
 //
 AP_Param *
 AP_Param::find_by_index(uint16_t idx, enum ap_var_type *ptype, ParamToken *token)
 {
+#if AP_PARAM_NAME_INDEX_ENABLED
+    {
+        WITH_SEMAPHORE(_name_index_sem);
+        if (_name_index_valid && idx < _name_index_count) {
+            const struct name_index_entry &e = _name_index[idx];
+            *token = e.token;
+            if (ptype != nullptr) {
+                *ptype = (enum ap_var_type)e.type;
+            }
+            return e.ap;
+        }
+    }
+#endif
     AP_Param *ap;
     uint16_t count=0;
     for (ap=AP_Param::first(token, ptype);
@@ -913,6 +970,131 @@ AP_Param::find_by_index(uint16_t idx, enum ap_var_type *ptype, ParamToken *token
     return ap;    
 }
 
+// fill in the group flags of a variable, leaving flags alone for top
+// level variables
+void AP_Param::get_group_flags(uint16_t *flags) const
+{
+    uint32_t group_element = 0;
+    const struct GroupInfo *ginfo;
+    struct GroupNesting group_nesting {};
+    uint8_t idx;
+    find_var_info(&group_element, ginfo, group_nesting, &idx);
+    if (ginfo != nullptr) {
+        *flags = ginfo->flags;
+    }
+}
+
+#if AP_PARAM_NAME_INDEX_ENABLED
+// 24 bit FNV-1a hash of a parameter name
+uint32_t AP_Param::name_hash(const char *name)
+{
+    uint32_t hash = 2166136261U;
+    for (uint8_t i=0; i<AP_MAX_NAME_SIZE && name[i] != 0; i++) {
+        hash = (hash ^ (uint8_t)name[i]) * 16777619U;
+    }
+    return hash & 0xFFFFFFU;
+}
+
+/*
+  build the name index of count scalar parameters. Called with
+  _name_index_sem held
+ */
+void AP_Param::build_name_index(uint16_t count)
+{
+    _name_index_valid = false;
+    if (count > _name_index_size) {
+        delete[] _name_index;
+        delete[] _name_order;
+        _name_index = new name_index_entry[count];
+        _name_order = new uint16_t[count];
+        if (_name_index == nullptr || _name_order == nullptr) {
+            delete[] _name_index;
+            delete[] _name_order;
+            _name_index = nullptr;
+            _name_order = nullptr;
+            _name_index_size = 0;
+            return;
+        }
+        _name_index_size = count;
+    }
+
+    char name[AP_MAX_NAME_SIZE+1];
+    ParamToken token;
+    enum ap_var_type type;
+    uint16_t n = 0;
+    for (AP_Param *ap = first(&token, &type);
+         ap != nullptr && n < count;
+         ap = next_scalar(&token, &type)) {
+        ap->copy_name_token(token, name, sizeof(name), true);
+        name[AP_MAX_NAME_SIZE] = 0;
+        struct name_index_entry &e = _name_index[n];
+        e.ap = ap;
+        e.token = token;
+        e.hash = name_hash(name);
+        e.type = type;
+        _name_order[n] = n;
+        n++;
+    }
+
+    // shell sort the order by hash, keeping parameters with the same
+    // hash in index order
+    for (uint16_t gap = n/2; gap > 0; gap /= 2) {
+        for (uint16_t i = gap; i < n; i++) {
+            const uint16_t v = _name_order[i];
+            const uint32_t hash = _name_index[v].hash;
+            uint16_t j = i;
+            while (j >= gap && _name_index[_name_order[j-gap]].hash > hash) {
+                _name_order[j] = _name_order[j-gap];
+                j -= gap;
+            }
+            _name_order[j] = v;
+        }
+    }
+
+    _name_index_count = n;
+    _name_index_valid = true;
+}
+
+/*
+  find a scalar parameter by exact name in the name index
+ */
+AP_Param *AP_Param::find_in_name_index(const char *name, enum ap_var_type *ptype)
+{
+    WITH_SEMAPHORE(_name_index_sem);
+    if (!_name_index_valid) {
+        return nullptr;
+    }
+    const uint32_t hash = name_hash(name);
+
+    // find the first entry with this hash
+    uint16_t lo = 0;
+    uint16_t hi = _name_index_count;
+    while (lo < hi) {
+        const uint16_t mid = (lo + hi) / 2;
+        if (_name_index[_name_order[mid]].hash < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    char buf[AP_MAX_NAME_SIZE+1];
+    for (; lo < _name_index_count; lo++) {
+        const struct name_index_entry &e = _name_index[_name_order[lo]];
+        if (e.hash != hash) {
+            break;
+        }
+        e.ap->copy_name_token(e.token, buf, sizeof(buf), true);
+        buf[AP_MAX_NAME_SIZE] = 0;
+        if (strcmp(buf, name) == 0) {
+            *ptype = (enum ap_var_type)e.type;
+            return e.ap;
+        }
+    }
+    return nullptr;
+}
+#endif // AP_PARAM_NAME_INDEX_ENABLED
+
 
 /*
   Find a variable by pointer, returning key. This is used for loading pointer variables
@@ -1081,7 +1263,7 @@ void AP_Param::save_sync(bool force_save)
 
     if (phdr.type == AP_PARAM_INT8 && ginfo != nullptr && (ginfo->flags & AP_PARAM_FLAG_ENABLE)) {
         // clear cached parameter count
-        _parameter_count = 0;
+        invalidate_count();
     }
     
     char name[AP_MAX_NAME_SIZE+1];
@@ -1132,6 +1314,9 @@ void AP_Param::save_sync(bool force_save)
     write_sentinal(ofs + sizeof(phdr) + type_size((enum ap_var_type)phdr.type));
     eeprom_write_check(ap, ofs+sizeof(phdr), type_size((enum ap_var_type)phdr.type));
     eeprom_write_check(&phdr, ofs, sizeof(phdr));
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+    storage_index_add(phdr, ofs);
+#endif
 
     send_parameter(name, (enum ap_var_type)phdr.type, idx);
 }
@@ -1144,7 +1329,13 @@ void AP_Param::save(bool force_save)
     struct param_save p;
     p.param = this;
     p.force_save = force_save;
-    while (!save_queue.push(p)) {
+    while (true) {
+        {
+            WITH_SEMAPHORE(save_queue_sem);
+            if (save_queue.push(p)) {
+                break;
+            }
+        }
         // if we can't save to the queue
         if (hal.util->get_soft_armed()) {
             // if we are armed then don't sleep, instead we lose the
@@ -1165,9 +1356,33 @@ void AP_Param::save(bool force_save)
  */
 void AP_Param::save_io_handler(void)
 {
-    struct param_save p;
-    while (save_queue.pop(p)) {
-        p.param->save_sync(p.force_save);
+    /*
+      take everything queued in one pass. A GCS often sends the same
+      parameter more than once while waiting for its reply, so
+      repeated saves of a parameter in the batch are only written once
+     */
+    struct param_save batch[16];
+    while (true) {
+        uint8_t n = 0;
+        struct param_save p;
+        while (n < ARRAY_SIZE(batch) && save_queue.pop(p)) {
+            uint8_t i;
+            for (i=0; i<n; i++) {
+                if (batch[i].param == p.param) {
+                    batch[i].force_save |= p.force_save;
+                    break;
+                }
+            }
+            if (i == n) {
+                batch[n++] = p;
+            }
+        }
+        if (n == 0) {
+            break;
+        }
+        for (uint8_t i=0; i<n; i++) {
+            batch[i].param->save_sync(batch[i].force_save);
+        }
     }
 }
 
@@ -1402,6 +1617,263 @@ void AP_Param::setup_sketch_defaults(void)
 }
 
 
+#if AP_PARAM_LOAD_INDEX_ENABLED || AP_PARAM_STORAGE_INDEX_ENABLED
+/*
+  storage header of a variable as a single number, ordered by key then
+  group element
+ */
+uint32_t AP_Param::header_id(uint16_t key, uint32_t group_element, uint8_t type)
+{
+    return (uint32_t(key) << (_group_bits + 5)) | (group_element << 5) | type;
+}
+#endif
+
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+// fibonacci hash of a header id to a slot of a table of 2^bits slots
+uint32_t AP_Param::storage_index_slot_of(uint32_t id, uint8_t bits)
+{
+    return (id * 2654435769U) >> (32 - bits);
+}
+
+/*
+  empty the storage index. It is only valid when the location of
+  every stored variable is known, after load_all() or erase_all()
+ */
+void AP_Param::storage_index_reset(bool valid)
+{
+    WITH_SEMAPHORE(_storage_index_sem);
+    if (_storage_index != nullptr) {
+        memset(_storage_index, 0, sizeof(_storage_index[0]) << _storage_index_bits);
+    }
+    _storage_index_count = 0;
+    _storage_index_valid = valid;
+}
+
+bool AP_Param::storage_index_add(const struct Param_header &phdr, uint16_t ofs)
+{
+    WITH_SEMAPHORE(_storage_index_sem);
+    if (_storage_index == nullptr || 2U*(_storage_index_count+1) > (1U<<_storage_index_bits)) {
+        // keep the table at most half full
+        const uint8_t bits = _storage_index == nullptr ? 7 : _storage_index_bits + 1;
+        struct storage_index_slot *table = new storage_index_slot[1U<<bits];
+        if (table == nullptr) {
+            _storage_index_valid = false;
+            return false;
+        }
+        memset(table, 0, sizeof(table[0]) << bits);
+        if (_storage_index != nullptr) {
+            for (uint32_t i=0; i < (1U<<_storage_index_bits); i++) {
+                const struct storage_index_slot &e = _storage_index[i];
+                if (e.ofs == 0) {
+                    continue;
+                }
+                uint32_t j = storage_index_slot_of(e.id, bits);
+                while (table[j].ofs != 0) {
+                    j = (j + 1) & ((1U<<bits)-1);
+                }
+                table[j] = e;
+            }
+            delete[] _storage_index;
+        }
+        _storage_index = table;
+        _storage_index_bits = bits;
+    }
+    const uint32_t id = header_id(get_key(phdr), phdr.group_element, phdr.type);
+    const uint32_t mask = (1U<<_storage_index_bits)-1;
+    for (uint32_t i = storage_index_slot_of(id, _storage_index_bits); ; i = (i + 1) & mask) {
+        struct storage_index_slot &e = _storage_index[i];
+        if (e.ofs == 0) {
+            e.id = id;
+            e.ofs = ofs;
+            _storage_index_count++;
+            return true;
+        }
+        if (e.id == id) {
+            // scan() finds the first copy, so keep that one
+            return true;
+        }
+    }
+}
+
+bool AP_Param::storage_index_find(const struct Param_header &phdr, uint16_t &ofs)
+{
+    if (_storage_index == nullptr) {
+        return false;
+    }
+    const uint32_t id = header_id(get_key(phdr), phdr.group_element, phdr.type);
+    const uint32_t mask = (1U<<_storage_index_bits)-1;
+    for (uint32_t i = storage_index_slot_of(id, _storage_index_bits); _storage_index[i].ofs != 0; i = (i + 1) & mask) {
+        if (_storage_index[i].id == id) {
+            ofs = _storage_index[i].ofs;
+            return true;
+        }
+    }
+    return false;
+}
+#endif // AP_PARAM_STORAGE_INDEX_ENABLED
+
+#if AP_PARAM_LOAD_INDEX_ENABLED
+/*
+  add the elements of a group to the header index, walking the group
+  the same way as find_by_header_group(). With no entries allocated
+  the elements are only counted. Returns the new number of entries
+ */
+uint16_t AP_Param::add_group_to_header_index(struct header_index *index, uint16_t n,
+                                             uint16_t vindex,
+                                             const struct GroupInfo *group_info,
+                                             uint32_t group_base,
+                                             uint8_t group_shift,
+                                             ptrdiff_t group_offset)
+{
+    uint8_t type;
+    for (uint8_t i=0;
+         (type=group_info[i].type) != AP_PARAM_NONE;
+         i++) {
+        if (type == AP_PARAM_GROUP) {
+            // a nested group
+            if (group_shift + _group_level_shift >= _group_bits) {
+                continue;
+            }
+            const struct GroupInfo *ginfo = get_group_info(group_info[i]);
+            if (ginfo == nullptr) {
+                continue;
+            }
+            ptrdiff_t new_offset = group_offset;
+            if (!adjust_group_offset(vindex, group_info[i], new_offset)) {
+                continue;
+            }
+            n = add_group_to_header_index(index, n, vindex, ginfo,
+                                          group_id(group_info, group_base, i, group_shift),
+                                          group_shift + _group_level_shift, new_offset);
+            continue;
+        }
+        ptrdiff_t base;
+        if (!get_base(_var_info[vindex], base)) {
+            continue;
+        }
+        if (index->entries != nullptr) {
+            struct header_index_entry &e = index->entries[n];
+            e.id = header_id(_var_info[vindex].key, group_id(group_info, group_base, i, group_shift), type);
+            e.ptr = (void*)(base + group_info[i].offset + group_offset);
+        }
+        n++;
+    }
+    return n;
+}
+
+/*
+  add all variables to the header index, or only count them if no
+  entries are allocated
+ */
+uint16_t AP_Param::add_vars_to_header_index(struct header_index *index)
+{
+    uint16_t n = 0;
+    for (uint16_t i=0; i<_num_vars; i++) {
+        const uint8_t type = _var_info[i].type;
+        const uint16_t key = _var_info[i].key;
+        if (type == AP_PARAM_GROUP) {
+            const struct GroupInfo *group_info = get_group_info(_var_info[i]);
+            if (group_info != nullptr) {
+                n = add_group_to_header_index(index, n, i, group_info, 0, 0, 0);
+            }
+            continue;
+        }
+        ptrdiff_t base;
+        if (!get_base(_var_info[i], base)) {
+            continue;
+        }
+        if (index->entries != nullptr) {
+            struct header_index_entry &e = index->entries[n];
+            e.id = header_id(key, 0, type);
+            e.ptr = (void*)base;
+            index->top_level[key/8] |= 1U<<(key%8);
+        }
+        n++;
+    }
+    return n;
+}
+
+/*
+  build the header index used by load_all(). Returns false if there is
+  not enough memory for it, in which case find_in_header_index() falls
+  back to searching the var_info tree
+ */
+bool AP_Param::build_header_index(struct header_index &index)
+{
+    memset(&index, 0, sizeof(index));
+    const uint16_t count = add_vars_to_header_index(&index);
+    if (count == 0) {
+        return false;
+    }
+    index.entries = new header_index_entry[count];
+    index.order = new uint16_t[count];
+    if (index.entries == nullptr || index.order == nullptr) {
+        delete[] index.entries;
+        delete[] index.order;
+        index.entries = nullptr;
+        index.order = nullptr;
+        return false;
+    }
+    index.count = add_vars_to_header_index(&index);
+
+    // shell sort the order by header, keeping variables with the same
+    // header in var_info order so the first one is found, as with
+    // find_by_header()
+    const uint16_t n = index.count;
+    for (uint16_t i = 0; i < n; i++) {
+        index.order[i] = i;
+    }
+    for (uint16_t gap = n/2; gap > 0; gap /= 2) {
+        for (uint16_t i = gap; i < n; i++) {
+            const uint16_t v = index.order[i];
+            const uint32_t id = index.entries[v].id;
+            uint16_t j = i;
+            while (j >= gap) {
+                const uint16_t w = index.order[j-gap];
+                if (index.entries[w].id < id || (index.entries[w].id == id && w < v)) {
+                    break;
+                }
+                index.order[j] = w;
+                j -= gap;
+            }
+            index.order[j] = v;
+        }
+    }
+    return true;
+}
+
+/*
+  find the storage for a stored header in the header index
+ */
+void *AP_Param::find_in_header_index(const struct header_index &index, const struct Param_header &phdr)
+{
+    void *ptr = nullptr;
+    if (index.entries == nullptr) {
+        find_by_header(phdr, &ptr);
+        return ptr;
+    }
+    const uint16_t key = get_key(phdr);
+    const uint32_t group_element = (index.top_level[key/8] & (1U<<(key%8))) ? 0 : phdr.group_element;
+    const uint32_t id = header_id(key, group_element, phdr.type);
+
+    // find the first entry with this header
+    uint16_t lo = 0;
+    uint16_t hi = index.count;
+    while (lo < hi) {
+        const uint16_t mid = (lo + hi) / 2;
+        if (index.entries[index.order[mid]].id < id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < index.count && index.entries[index.order[lo]].id == id) {
+        ptr = index.entries[index.order[lo]].ptr;
+    }
+    return ptr;
+}
+#endif // AP_PARAM_LOAD_INDEX_ENABLED
+
 // Load all variables from EEPROM
 //
 bool AP_Param::load_all()
@@ -1409,13 +1881,29 @@ bool AP_Param::load_all()
     struct Param_header phdr;
     uint16_t ofs = sizeof(AP_Param::EEPROM_header);
 
+    uint32_t start_us = AP_HAL::micros();
     reload_defaults_file(false);
+    _load_timing.defaults_us = AP_HAL::micros() - start_us;
 
     if (!registered_save_handler) {
         registered_save_handler = true;
         hal.scheduler->register_io_process(FUNCTOR_BIND((&save_dummy), &AP_Param::save_io_handler, void));
     }
-    
+
+#if AP_PARAM_LOAD_INDEX_ENABLED
+    start_us = AP_HAL::micros();
+    struct header_index index;
+    build_header_index(index);
+    _load_timing.index_us = AP_HAL::micros() - start_us;
+#endif
+
+    start_us = AP_HAL::micros();
+    _load_timing.loaded = 0;
+    bool found_sentinal = false;
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+    storage_index_reset(false);
+    bool storage_index_ok = true;
+#endif
     while (ofs < _storage.size()) {
         _storage.read_block(&phdr, ofs, sizeof(phdr));
         // note that this is an || not an && for robustness
@@ -1423,23 +1911,46 @@ bool AP_Param::load_all()
         if (is_sentinal(phdr)) {
             // we've reached the sentinal
             sentinal_offset = ofs;
-            return true;
+            found_sentinal = true;
+            break;
         }
 
-        const struct AP_Param::Info *info;
-        void *ptr;
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+        storage_index_ok = storage_index_ok && storage_index_add(phdr, ofs);
+#endif
 
-        info = find_by_header(phdr, &ptr);
-        if (info != nullptr) {
+#if AP_PARAM_LOAD_INDEX_ENABLED
+        void *ptr = find_in_header_index(index, phdr);
+#else
+        void *ptr = nullptr;
+        find_by_header(phdr, &ptr);
+#endif
+        if (ptr != nullptr) {
             _storage.read_block(ptr, ofs+sizeof(phdr), type_size((enum ap_var_type)phdr.type));
+            _load_timing.loaded++;
         }
 
         ofs += type_size((enum ap_var_type)phdr.type) + sizeof(phdr);
     }
 
-    // we didn't find the sentinal
-    Debug("no sentinal in load_all");
-    return false;
+#if AP_PARAM_LOAD_INDEX_ENABLED
+    delete[] index.entries;
+    delete[] index.order;
+#endif
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+    {
+        // saves can now find variables without scanning storage
+        WITH_SEMAPHORE(_storage_index_sem);
+        _storage_index_valid = found_sentinal && storage_index_ok;
+    }
+#endif
+    _load_timing.storage_us = AP_HAL::micros() - start_us;
+
+    if (!found_sentinal) {
+        // we didn't find the sentinal
+        Debug("no sentinal in load_all");
+    }
+    return found_sentinal;
 }
 
 /*
@@ -1483,7 +1994,7 @@ void AP_Param::load_object_from_eeprom(const void *object_pointer, const struct
     uint16_t key;
 
     // reset cached param counter as we may be loading a dynamic var_info
-    _parameter_count = 0;
+    invalidate_count();
     
     if (!find_key_by_pointer(object_pointer, key)) {
         hal.console->printf("ERROR: Unable to find param pointer\n");
@@ -2337,16 +2848,34 @@ uint16_t AP_Param::count_parameters(void)
         AP_Param  *vp;
         AP_Param::ParamToken token;
 
+#if AP_PARAM_NAME_INDEX_ENABLED
+        WITH_SEMAPHORE(_name_index_sem);
+#endif
         for (vp = AP_Param::first(&token, nullptr);
              vp != nullptr;
              vp = AP_Param::next_scalar(&token, nullptr)) {
             ret++;
         }
         _parameter_count = ret;
+#if AP_PARAM_NAME_INDEX_ENABLED
+        build_name_index(ret);
+#endif
     }
     return ret;
 }
 
+/*
+  clear the cached parameter count, and the name index with it
+ */
+void AP_Param::invalidate_count(void)
+{
+#if AP_PARAM_NAME_INDEX_ENABLED
+    WITH_SEMAPHORE(_name_index_sem);
+    _name_index_valid = false;
+#endif
+    _parameter_count = 0;
+}
+
 /*
   set a default value by name
  */
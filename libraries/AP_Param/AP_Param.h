@@ -42,6 +42,41 @@
 #define AP_PARAM_MAX_EMBEDDED_PARAM 8192
 #endif
 
+/*
+  keep an index of scalar parameters sorted by a hash of their names,
+  built when the parameters are counted, to speed up find() and
+  find_by_index()
+ */
+#ifndef AP_PARAM_NAME_INDEX_ENABLED
+#define AP_PARAM_NAME_INDEX_ENABLED (HAL_MEM_CLASS >= HAL_MEM_CLASS_300)
+#endif
+
+/*
+  build a temporary index of all variables by storage header in
+  load_all(), so stored values are matched to their variables without
+  searching the var_info tree for each one
+ */
+#ifndef AP_PARAM_LOAD_INDEX_ENABLED
+#define AP_PARAM_LOAD_INDEX_ENABLED (HAL_MEM_CLASS >= HAL_MEM_CLASS_300)
+#endif
+
+/*
+  keep a hash of where each variable is in storage, so saving a
+  variable doesn't need to search storage for it
+ */
+#ifndef AP_PARAM_STORAGE_INDEX_ENABLED
+#define AP_PARAM_STORAGE_INDEX_ENABLED (HAL_MEM_CLASS >= HAL_MEM_CLASS_300)
+#endif
+
+// number of background saves which can be queued
+#ifndef AP_PARAM_SAVE_QUEUE_SIZE
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_300
+#define AP_PARAM_SAVE_QUEUE_SIZE 100
+#else
+#define AP_PARAM_SAVE_QUEUE_SIZE 30
+#endif
+#endif
+
 /*
   flags for variables in var_info and group tables
  */
@@ -357,6 +392,15 @@ public:
     ///
     static bool load_all();
 
+    // time taken by the phases of the last load_all()
+    struct LoadTiming {
+        uint32_t defaults_us;   // loading the defaults file
+        uint32_t index_us;      // building the header index
+        uint32_t storage_us;    // loading the stored values
+        uint16_t loaded;        // number of stored values loaded
+    };
+    static const LoadTiming &get_load_timing(void) { return _load_timing; }
+
     // returns storage space used:
     static uint16_t storage_used() { return sentinal_offset; }
 
@@ -459,7 +503,7 @@ public:
 
     // set frame type flags. Used to unhide frame specific parameters
     static void set_frame_type_flags(uint16_t flags_to_set) {
-        _parameter_count = 0;
+        invalidate_count();
         _frame_type_flags |= flags_to_set;
     }
 
@@ -640,6 +684,92 @@ private:
     // send a parameter to all GCS instances
     void send_parameter(const char *name, enum ap_var_type param_header_type, uint8_t idx) const;
 
+    // fill in the group flags of a variable, if it is in a group
+    void get_group_flags(uint16_t *flags) const;
+
+    // clear the cached parameter count and name index
+    static void invalidate_count(void);
+
+#if AP_PARAM_NAME_INDEX_ENABLED
+    /*
+      scalar parameters in next_scalar() order, with a list of
+      them sorted by name hash
+    */
+    struct name_index_entry {
+        AP_Param *ap;
+        ParamToken token;
+        uint32_t hash:24;
+        uint32_t type:8;
+    };
+    static struct name_index_entry *_name_index;
+    static uint16_t *_name_order;
+    static uint16_t _name_index_count;
+    static uint16_t _name_index_size;
+    static bool _name_index_valid;
+    static HAL_Semaphore _name_index_sem;
+
+    static uint32_t name_hash(const char *name);
+    static void build_name_index(uint16_t count);
+    static AP_Param *find_in_name_index(const char *name, enum ap_var_type *ptype);
+#endif
+
+#if AP_PARAM_LOAD_INDEX_ENABLED
+    /*
+      variables which can be stored, in var_info order, with a list
+      of them sorted by storage header
+    */
+    struct header_index_entry {
+        uint32_t id;
+        void *ptr;
+    };
+    struct header_index {
+        struct header_index_entry *entries;
+        uint16_t *order;
+        uint16_t count;
+        // keys of top level variables, which match any group element
+        uint8_t top_level[(_sentinal_key+8)/8];
+    };
+    static uint16_t add_group_to_header_index(struct header_index *index, uint16_t n,
+                                              uint16_t vindex,
+                                              const struct GroupInfo *group_info,
+                                              uint32_t group_base,
+                                              uint8_t group_shift,
+                                              ptrdiff_t group_offset);
+    static uint16_t add_vars_to_header_index(struct header_index *index);
+    static bool build_header_index(struct header_index &index);
+    static void *find_in_header_index(const struct header_index &index, const struct Param_header &phdr);
+#endif
+
+#if AP_PARAM_LOAD_INDEX_ENABLED || AP_PARAM_STORAGE_INDEX_ENABLED
+    static uint32_t header_id(uint16_t key, uint32_t group_element, uint8_t type);
+#endif
+
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+    /*
+      open addressed hash from the header_id() of each variable in
+      storage to its offset. Offset zero is the EEPROM header, so it
+      marks an empty slot
+     */
+    struct PACKED storage_index_slot {
+        uint32_t id;
+        uint16_t ofs;
+    };
+    static struct storage_index_slot *_storage_index;
+    static uint8_t _storage_index_bits;
+    static uint16_t _storage_index_count;
+    static bool _storage_index_valid;
+    static HAL_Semaphore _storage_index_sem;
+
+    // empty the index, keeping it valid if storage is known to be empty
+    static void storage_index_reset(bool valid);
+    // add the offset of a header, growing the table as needed
+    static bool storage_index_add(const struct Param_header &phdr, uint16_t ofs);
+    static bool storage_index_find(const struct Param_header &phdr, uint16_t &ofs);
+    static uint32_t storage_index_slot_of(uint32_t id, uint8_t bits);
+#endif
+
+    static LoadTiming           _load_timing;
+
     static StorageAccess        _storage;
     static StorageAccess        _storage_bak;
     static uint16_t             _num_vars;
@@ -672,6 +802,8 @@ private:
         bool force_save;
     };
     static ObjectBuffer<struct param_save> save_queue;
+    // save() may be called from any thread, the queue has one reader
+    static HAL_Semaphore save_queue_sem;
     static bool registered_save_handler;
 
     // background function for saving parameters
@@ -357,6 +357,25 @@ bool AP_Proximity::get_horizontal_distances(Proximity_Distance_Array &prx_dist_a
     return drivers[primary_instance]->get_horizontal_distances(prx_dist_array);
 }
 
+// get distances in cm in each grid sector of the horizontal plane, for OBSTACLE_DISTANCE
+bool AP_Proximity::get_grid_distances(uint16_t *distances_cm, uint16_t no_object_cm) const
+{
+    if (!valid_instance(primary_instance)) {
+        return false;
+    }
+    return drivers[primary_instance]->get_grid_distances(distances_cm, no_object_cm);
+}
+
+// get distance in meters to the closest object in a direction in the horizontal plane
+//   returns false if there is no reading in that direction
+bool AP_Proximity::get_horizontal_distance(float angle_deg, float &distance) const
+{
+    if (!valid_instance(primary_instance)) {
+        return false;
+    }
+    return drivers[primary_instance]->get_horizontal_distance(angle_deg, distance);
+}
+
 // get boundary points around vehicle for use by avoidance
 //   returns nullptr and sets num_points to zero if no boundary can be returned
 const Vector2f* AP_Proximity::get_boundary_points(uint8_t instance, uint16_t& num_points) const
@@ -88,6 +88,15 @@ public:
     // get distances in PROXIMITY_MAX_DIRECTION directions. used for sending distances to ground station
     bool get_horizontal_distances(Proximity_Distance_Array &prx_dist_array) const;
 
+    // get distance in meters to the closest object in a direction (in degrees from the front) in the horizontal plane
+    //   returns false if there is no reading in that direction
+    bool get_horizontal_distance(float angle_deg, float &distance) const;
+
+    // get distances in cm in each of the PROXIMITY_GRID_SECTORS sectors of the horizontal plane, for OBSTACLE_DISTANCE
+    //   sectors with no object are set to no_object_cm and those with no information to UINT16_MAX
+    //   returns false if there are no distances
+    bool get_grid_distances(uint16_t *distances_cm, uint16_t no_object_cm) const;
+
     // get boundary points around vehicle for use by avoidance
     //   returns nullptr and sets num_points to zero if no boundary can be returned
     const Vector2f* get_boundary_points(uint8_t instance, uint16_t& num_points) const;
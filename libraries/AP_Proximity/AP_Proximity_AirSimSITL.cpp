@@ -38,6 +38,9 @@ void AP_Proximity_AirSimSITL::update(void)
     memset(_angle, 0, sizeof(_angle));
     memset(_distance, 0, sizeof(_distance));
 
+    // closest point in each cell of the grid
+    uint16_t grid_distance_cm[PROXIMITY_GRID_SECTORS][PROXIMITY_GRID_LAYERS] {};
+
     for (uint16_t i=0; i<points.length; i++) {
         Vector3f &point = points.data[i];
         if (point.is_zero()) {
@@ -46,12 +49,34 @@ void AP_Proximity_AirSimSITL::update(void)
         float angle_deg = wrap_360(degrees(atan2f(-point.y, point.x)));
         uint16_t angle_rounded = uint16_t(angle_deg+0.5);
         const uint8_t sector = convert_angle_to_sector(angle_rounded);
+
+        const float xy_length = Vector2f(point.x, point.y).length();
+        uint8_t layer;
+        if (AP_Proximity_Grid::get_layer(degrees(atan2f(point.z, xy_length)), layer)) {
+            const uint8_t grid_sector = AP_Proximity_Grid::get_sector(angle_deg);
+            const uint16_t distance_cm = constrain_float(point.length() * 100.0f, 1.0f, UINT16_MAX);
+            uint16_t &cell = grid_distance_cm[grid_sector][layer];
+            if (cell == 0 || distance_cm < cell) {
+                cell = distance_cm;
+            }
+        }
+
         if (!_distance_valid[sector] || PROXIMITY_MAX_RANGE < _distance[sector]) {
             _distance_valid[sector] = true;
-            const Vector2f v = Vector2f(point.x, point.y);
-            _distance[sector] = v.length();
+            _distance[sector] = xy_length;
             _angle[sector] = angle_deg;
-            update_boundary_for_sector(sector, true);
+            update_boundary_for_sector(sector, false);
+        }
+    }
+
+    // update the grid with this scan, pushing the horizontal layer to the object database
+    for (uint8_t grid_sector=0; grid_sector<PROXIMITY_GRID_SECTORS; grid_sector++) {
+        for (uint8_t layer=0; layer<PROXIMITY_GRID_LAYERS; layer++) {
+            const float distance = grid_distance_cm[grid_sector][layer] * 0.01f;
+            _grid.set_distance(grid_sector, layer, distance);
+            if (layer == PROXIMITY_GRID_HORIZONTAL_LAYER && is_positive(distance)) {
+                database_push(AP_Proximity_Grid::sector_middle_deg(grid_sector), distance);
+            }
         }
     }
 
@@ -37,6 +37,10 @@ AP_Proximity_Backend::AP_Proximity_Backend(AP_Proximity &_frontend, AP_Proximity
 //   returns true on success, false if no valid readings
 bool AP_Proximity_Backend::get_closest_object(float& angle_deg, float &distance) const
 {
+    if (_grid.has_horizontal_data()) {
+        return _grid.get_horizontal_closest(angle_deg, distance);
+    }
+
     bool sector_found = false;
     uint8_t sector = 0;
 
@@ -60,6 +64,9 @@ bool AP_Proximity_Backend::get_closest_object(float& angle_deg, float &distance)
 // get number of objects, used for non-GPS avoidance
 uint8_t AP_Proximity_Backend::get_object_count() const
 {
+    if (_grid.has_horizontal_data()) {
+        return PROXIMITY_GRID_SECTORS;
+    }
     return PROXIMITY_NUM_SECTORS;
 }
 
@@ -67,6 +74,13 @@ uint8_t AP_Proximity_Backend::get_object_count() const
 // returns false if no angle or distance could be returned for some reason
 bool AP_Proximity_Backend::get_object_angle_and_distance(uint8_t object_number, float& angle_deg, float &distance) const
 {
+    if (_grid.has_horizontal_data()) {
+        if (_grid.get_distance(object_number, PROXIMITY_GRID_HORIZONTAL_LAYER, distance)) {
+            angle_deg = AP_Proximity_Grid::sector_middle_deg(object_number);
+            return true;
+        }
+        return false;
+    }
     if (object_number < PROXIMITY_NUM_SECTORS && _distance_valid[object_number]) {
         angle_deg = _angle[object_number];
         distance = _distance[object_number];
@@ -124,6 +138,52 @@ bool AP_Proximity_Backend::get_horizontal_distances(AP_Proximity::Proximity_Dist
     return true;
 }
 
+// get distance to the closest object in a direction in the horizontal plane
+//   returns false if there is no reading in that direction
+bool AP_Proximity_Backend::get_horizontal_distance(float angle_deg, float &distance) const
+{
+    if (_grid.has_horizontal_data()) {
+        return _grid.get_distance(AP_Proximity_Grid::get_sector(angle_deg), PROXIMITY_GRID_HORIZONTAL_LAYER, distance);
+    }
+    const uint8_t sector = convert_angle_to_sector(angle_deg);
+    if (!_distance_valid[sector]) {
+        return false;
+    }
+    distance = _distance[sector];
+    return true;
+}
+
+// get distances in cm in each grid sector of the horizontal plane, for OBSTACLE_DISTANCE
+//   returns false if there are no distances
+bool AP_Proximity_Backend::get_grid_distances(uint16_t *distances_cm, uint16_t no_object_cm) const
+{
+    if (_grid.has_horizontal_data()) {
+        // a cleared grid sector has had readings with nothing in range
+        for (uint8_t i=0; i<PROXIMITY_GRID_SECTORS; i++) {
+            float distance;
+            if (_grid.get_distance(i, PROXIMITY_GRID_HORIZONTAL_LAYER, distance)) {
+                distances_cm[i] = distance * 100.0f + 0.5f;
+            } else {
+                distances_cm[i] = no_object_cm;
+            }
+        }
+        return true;
+    }
+
+    // spread each of the sectors over the grid sectors it covers
+    bool valid_distances = false;
+    for (uint8_t i=0; i<PROXIMITY_GRID_SECTORS; i++) {
+        const uint8_t sector = convert_angle_to_sector(AP_Proximity_Grid::sector_middle_deg(i));
+        if (_distance_valid[sector]) {
+            distances_cm[i] = _distance[sector] * 100.0f + 0.5f;
+            valid_distances = true;
+        } else {
+            distances_cm[i] = UINT16_MAX;
+        }
+    }
+    return valid_distances;
+}
+
 // get boundary points around vehicle for use by avoidance
 //   returns nullptr and sets num_points to zero if no boundary can be returned
 const Vector2f* AP_Proximity_Backend::get_boundary_points(uint16_t& num_points) const
@@ -134,6 +194,12 @@ const Vector2f* AP_Proximity_Backend::get_boundary_points(uint16_t& num_points)
         return nullptr;
     }
 
+    // use the grid if it has data as it follows the objects more closely
+    if (_grid.has_horizontal_data()) {
+        num_points = PROXIMITY_GRID_SECTORS;
+        return _grid.get_boundary_points();
+    }
+
     // check at least one sector has valid data, if not, exit
     bool some_valid = false;
     for (uint8_t i=0; i<PROXIMITY_NUM_SECTORS; i++) {
@@ -222,6 +288,95 @@ void AP_Proximity_Backend::update_boundary_for_sector(const uint8_t sector, cons
     }
 }
 
+// add a reading from a scanning sensor to the grid
+void AP_Proximity_Backend::grid_scan_reading(float angle_deg, float distance, bool valid, bool push_to_OA_DB)
+{
+    const uint8_t sector = AP_Proximity_Grid::get_sector(angle_deg);
+    if (sector != _grid_scan.sector) {
+        grid_scan_flush(push_to_OA_DB);
+        _grid_scan.sector = sector;
+        _grid_scan.valid = false;
+    }
+    if (valid && (!_grid_scan.valid || distance < _grid_scan.distance)) {
+        _grid_scan.angle_deg = angle_deg;
+        _grid_scan.distance = distance;
+        _grid_scan.valid = true;
+    }
+}
+
+// store the reading accumulated for the grid sector the scan is in
+void AP_Proximity_Backend::grid_scan_flush(bool push_to_OA_DB)
+{
+    if (_grid_scan.sector >= PROXIMITY_GRID_SECTORS) {
+        return;
+    }
+    if (_grid_scan.valid) {
+        _grid.set_distance(_grid_scan.sector, PROXIMITY_GRID_HORIZONTAL_LAYER, _grid_scan.distance);
+        if (push_to_OA_DB) {
+            database_push(_grid_scan.angle_deg, _grid_scan.distance);
+        }
+    } else {
+        _grid.set_distance(_grid_scan.sector, PROXIMITY_GRID_HORIZONTAL_LAYER, 0.0f);
+    }
+    _grid_scan.sector = UINT8_MAX;
+}
+
+// allocate the queue for readings from a scanning sensor
+bool AP_Proximity_Backend::scan_queue_init(uint16_t num_readings)
+{
+    if (_scan_readings == nullptr) {
+        _scan_readings = new ObjectBuffer<ScanReading>(num_readings);
+    }
+    return (_scan_readings != nullptr) && (_scan_readings->space() > 0);
+}
+
+// queue a reading from a scanning sensor. called from the driver's thread
+void AP_Proximity_Backend::scan_queue_reading(float angle_deg, float distance, bool valid)
+{
+    if (_scan_readings == nullptr) {
+        return;
+    }
+    ScanReading reading;
+    reading.angle_cd = wrap_360(angle_deg) * 100.0f;
+    reading.distance_cm = valid ? constrain_float(distance * 100.0f, 1.0f, UINT16_MAX) : 0;
+    _scan_readings->push(reading);
+}
+
+// apply the queued readings of a scanning sensor to the sectors and grid
+void AP_Proximity_Backend::scan_apply_readings(bool push_to_OA_DB)
+{
+    if (_scan_readings == nullptr) {
+        return;
+    }
+    ScanReading reading;
+    while (_scan_readings->pop(reading)) {
+        const float angle_deg = reading.angle_cd * 0.01f;
+        const float distance = reading.distance_cm * 0.01f;
+        const bool valid = reading.distance_cm != 0;
+
+        // the grid is used for avoidance and pushes to the object database
+        grid_scan_reading(angle_deg, distance, valid, push_to_OA_DB);
+
+        // keep the closest reading in each sector, storing it once the scan moves into another sector
+        const uint8_t sector = convert_angle_to_sector(angle_deg);
+        if (sector != _scan.sector) {
+            if (_scan.sector < PROXIMITY_NUM_SECTORS) {
+                _angle[_scan.sector] = _scan.angle_deg;
+                _distance[_scan.sector] = _scan.distance;
+                _distance_valid[_scan.sector] = _scan.valid;
+                update_boundary_for_sector(_scan.sector, false);
+            }
+            _scan.sector = sector;
+            _scan.valid = false;
+        }
+        if (valid && (!_scan.valid || distance < _scan.distance)) {
+            _scan.angle_deg = angle_deg;
+            _scan.distance = distance;
+            _scan.valid = true;
+        }
+    }
+}
+
 // set status and update valid count
 void AP_Proximity_Backend::set_status(AP_Proximity::Status status)
 {
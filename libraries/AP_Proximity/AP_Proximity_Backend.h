@@ -18,11 +18,11 @@
 #include <AP_HAL/AP_HAL.h>
 #include "AP_Proximity.h"
 #include <AP_Common/Location.h>
+#include <AP_HAL/utility/RingBuffer.h>
+#include "AP_Proximity_Grid.h"
 
 #define PROXIMITY_NUM_SECTORS           8       // number of sectors
 #define PROXIMITY_SECTOR_WIDTH_DEG      45.0f   // width of sectors in degrees
-#define PROXIMITY_BOUNDARY_DIST_MIN 0.6f    // minimum distance for a boundary point.  This ensures the object avoidance code doesn't think we are outside the boundary.
-#define PROXIMITY_BOUNDARY_DIST_DEFAULT 100 // if we have no data for a sector, boundary is placed 100m out
 
 class AP_Proximity_Backend
 {
@@ -62,6 +62,15 @@ public:
     // get distances in 8 directions. used for sending distances to ground station
     bool get_horizontal_distances(AP_Proximity::Proximity_Distance_Array &prx_dist_array) const;
 
+    // get distance to the closest object in a direction in the horizontal plane
+    //   returns false if there is no reading in that direction
+    bool get_horizontal_distance(float angle_deg, float &distance) const;
+
+    // get distances in cm in each of the PROXIMITY_GRID_SECTORS sectors of the horizontal plane, for OBSTACLE_DISTANCE
+    //   sectors with no object are set to no_object_cm and those with no information to UINT16_MAX
+    //   returns false if there are no distances
+    bool get_grid_distances(uint16_t *distances_cm, uint16_t no_object_cm) const;
+
 protected:
 
     // set status and update valid_count
@@ -88,6 +97,23 @@ protected:
     void database_push(float angle, float distance);
     void database_push(float angle, float distance, uint32_t timestamp_ms, const Vector2f &current_pos, float current_heading);
 
+    // grid helpers for sensors that scan around the vehicle.  Readings
+    // are combined into the closest one in each grid sector, which is
+    // stored once the scan moves into another sector.  Invalid readings
+    // clear the sector if nothing valid was seen in it
+    void grid_scan_reading(float angle_deg, float distance, bool valid, bool push_to_OA_DB);
+    void grid_scan_flush(bool push_to_OA_DB);
+
+    // queue of readings from a sensor that scans around the vehicle.
+    // The driver decodes the sensor's output on its own thread and
+    // queues each reading with scan_queue_reading().  update() then
+    // applies the queued readings to the sectors and grid with
+    // scan_apply_readings().  The queue is lock-free with one writer
+    // and one reader
+    bool scan_queue_init(uint16_t num_readings);
+    void scan_queue_reading(float angle_deg, float distance, bool valid);
+    void scan_apply_readings(bool push_to_OA_DB);
+
     AP_Proximity &frontend;
     AP_Proximity::Proximity_State &state;   // reference to this instances state
 
@@ -102,4 +128,34 @@ protected:
     // fence boundary
     Vector2f _sector_edge_vector[PROXIMITY_NUM_SECTORS];    // vector for right-edge of each sector, used to speed up calculation of boundary
     Vector2f _boundary_point[PROXIMITY_NUM_SECTORS];        // bounding polygon around the vehicle calculated conservatively for object avoidance
+
+    // high resolution distances by sector and layer.  When it holds
+    // horizontal distances these are used for avoidance in place of the
+    // 8 sectors above, which are kept for reporting to the ground station
+    AP_Proximity_Grid _grid;
+
+private:
+
+    // reading queued by a scanning sensor's thread
+    struct ScanReading {
+        uint16_t angle_cd;      // angle in centi-degrees
+        uint16_t distance_cm;   // distance in cm, zero if the reading is not valid
+    };
+    ObjectBuffer<ScanReading> *_scan_readings;
+
+    // reading being accumulated for the sector a scan is in
+    struct {
+        uint8_t sector = UINT8_MAX;
+        float angle_deg;
+        float distance;
+        bool valid;
+    } _scan;
+
+    // reading being accumulated for the grid sector a scan is in
+    struct {
+        uint8_t sector = UINT8_MAX;
+        float angle_deg;
+        float distance;
+        bool valid;
+    } _grid_scan;
 };
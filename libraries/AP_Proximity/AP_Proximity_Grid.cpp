@@ -0,0 +1,144 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_Proximity_Grid.h"
+
+AP_Proximity_Grid::AP_Proximity_Grid()
+{
+    for (uint8_t sector=0; sector < PROXIMITY_GRID_SECTORS; sector++) {
+        const float angle_rad = radians(sector_middle_deg(sector) + (PROXIMITY_GRID_SECTOR_WIDTH_DEG * 0.5f));
+        _sector_edge_vector[sector].x = cosf(angle_rad) * 100.0f;
+        _sector_edge_vector[sector].y = sinf(angle_rad) * 100.0f;
+    }
+    reset();
+}
+
+uint8_t AP_Proximity_Grid::get_sector(float yaw_deg)
+{
+    const uint16_t sector = wrap_360(yaw_deg + (PROXIMITY_GRID_SECTOR_WIDTH_DEG * 0.5f)) / PROXIMITY_GRID_SECTOR_WIDTH_DEG;
+    return MIN(sector, PROXIMITY_GRID_SECTORS - 1);
+}
+
+bool AP_Proximity_Grid::get_layer(float pitch_deg, uint8_t &layer)
+{
+    const float bottom_deg = -(PROXIMITY_GRID_HORIZONTAL_LAYER + 0.5f) * PROXIMITY_GRID_LAYER_WIDTH_DEG;
+    const float index = (pitch_deg - bottom_deg) / PROXIMITY_GRID_LAYER_WIDTH_DEG;
+    if (index < 0.0f || index >= PROXIMITY_GRID_LAYERS) {
+        return false;
+    }
+    layer = uint8_t(index);
+    return true;
+}
+
+void AP_Proximity_Grid::set_distance(uint8_t sector, uint8_t layer, float distance_m)
+{
+    if (sector >= PROXIMITY_GRID_SECTORS || layer >= PROXIMITY_GRID_LAYERS) {
+        return;
+    }
+    const uint16_t distance_cm = is_positive(distance_m) ? uint16_t(constrain_float(distance_m * 100.0f, 1.0f, UINT16_MAX)) : 0;
+    uint16_t &cell = _distance_cm[sector][layer];
+    if (cell == distance_cm) {
+        return;
+    }
+    if (layer == PROXIMITY_GRID_HORIZONTAL_LAYER) {
+        if (cell == 0) {
+            _num_horizontal++;
+        } else if (distance_cm == 0) {
+            _num_horizontal--;
+        }
+        cell = distance_cm;
+        update_boundary(sector);
+    } else {
+        cell = distance_cm;
+    }
+}
+
+void AP_Proximity_Grid::reset()
+{
+    memset(_distance_cm, 0, sizeof(_distance_cm));
+    _num_horizontal = 0;
+    for (uint8_t sector=0; sector < PROXIMITY_GRID_SECTORS; sector++) {
+        _boundary_point[sector] = _sector_edge_vector[sector] * PROXIMITY_BOUNDARY_DIST_DEFAULT;
+    }
+}
+
+bool AP_Proximity_Grid::get_distance(uint8_t sector, uint8_t layer, float &distance_m) const
+{
+    if (sector >= PROXIMITY_GRID_SECTORS || layer >= PROXIMITY_GRID_LAYERS || _distance_cm[sector][layer] == 0) {
+        return false;
+    }
+    distance_m = _distance_cm[sector][layer] * 0.01f;
+    return true;
+}
+
+bool AP_Proximity_Grid::get_horizontal_closest(float &yaw_deg, float &distance_m) const
+{
+    uint16_t closest_cm = 0;
+    for (uint8_t sector=0; sector < PROXIMITY_GRID_SECTORS; sector++) {
+        const uint16_t distance_cm = _distance_cm[sector][PROXIMITY_GRID_HORIZONTAL_LAYER];
+        if (distance_cm != 0 && (closest_cm == 0 || distance_cm < closest_cm)) {
+            closest_cm = distance_cm;
+            yaw_deg = sector_middle_deg(sector);
+        }
+    }
+    if (closest_cm == 0) {
+        return false;
+    }
+    distance_m = closest_cm * 0.01f;
+    return true;
+}
+
+// boundary point lies on the line between the two sectors at the shorter distance found in the two sectors
+float AP_Proximity_Grid::boundary_distance(uint8_t sector, uint8_t next_sector) const
+{
+    const uint16_t dist_cm = _distance_cm[sector][PROXIMITY_GRID_HORIZONTAL_LAYER];
+    const uint16_t next_dist_cm = _distance_cm[next_sector][PROXIMITY_GRID_HORIZONTAL_LAYER];
+    float shortest_distance = PROXIMITY_BOUNDARY_DIST_DEFAULT;
+    if (dist_cm != 0 && next_dist_cm != 0) {
+        shortest_distance = MIN(dist_cm, next_dist_cm) * 0.01f;
+    } else if (dist_cm != 0) {
+        shortest_distance = dist_cm * 0.01f;
+    } else if (next_dist_cm != 0) {
+        shortest_distance = next_dist_cm * 0.01f;
+    }
+    return MAX(shortest_distance, PROXIMITY_BOUNDARY_DIST_MIN);
+}
+
+// update boundary points used for object avoidance based on a single sector's distance changing
+//   the boundary points lie on the line between sectors meaning two boundary points may be updated based on a single sector's distance changing
+//   the boundary point is set to the shortest distance found in the two adjacent sectors, this is a conservative boundary around the vehicle
+void AP_Proximity_Grid::update_boundary(uint8_t sector)
+{
+    const uint8_t next_sector = (sector + 1) % PROXIMITY_GRID_SECTORS;
+    const uint8_t prev_sector = (sector == 0) ? PROXIMITY_GRID_SECTORS - 1 : sector - 1;
+
+    float shortest_distance = boundary_distance(sector, next_sector);
+    _boundary_point[sector] = _sector_edge_vector[sector] * shortest_distance;
+
+    // if the next sector (clockwise) has no distance, set boundary to create a cup like boundary
+    if (_distance_cm[next_sector][PROXIMITY_GRID_HORIZONTAL_LAYER] == 0) {
+        _boundary_point[next_sector] = _sector_edge_vector[next_sector] * shortest_distance;
+    }
+
+    // repeat for edge between sector and previous sector
+    shortest_distance = boundary_distance(prev_sector, sector);
+    _boundary_point[prev_sector] = _sector_edge_vector[prev_sector] * shortest_distance;
+
+    // if the sector counter-clockwise from the previous sector has no distance, set boundary to create a cup like boundary
+    const uint8_t prev_sector_ccw = (prev_sector == 0) ? PROXIMITY_GRID_SECTORS - 1 : prev_sector - 1;
+    if (_distance_cm[prev_sector_ccw][PROXIMITY_GRID_HORIZONTAL_LAYER] == 0) {
+        _boundary_point[prev_sector_ccw] = _sector_edge_vector[prev_sector_ccw] * shortest_distance;
+    }
+}
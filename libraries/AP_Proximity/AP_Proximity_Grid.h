@@ -0,0 +1,85 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_Math/AP_Math.h>
+
+#ifndef PROXIMITY_GRID_SECTORS
+#define PROXIMITY_GRID_SECTORS          72      // number of sectors around the vehicle in the grid
+#endif
+#ifndef PROXIMITY_GRID_LAYERS
+#define PROXIMITY_GRID_LAYERS            5      // number of elevation layers in the grid
+#endif
+#define PROXIMITY_GRID_SECTOR_WIDTH_DEG (360.0f / PROXIMITY_GRID_SECTORS)
+#define PROXIMITY_GRID_LAYER_WIDTH_DEG  30.0f   // height of each layer in degrees of pitch
+#define PROXIMITY_GRID_HORIZONTAL_LAYER (PROXIMITY_GRID_LAYERS / 2)    // layer around the horizontal, which the boundary is built from
+
+#define PROXIMITY_BOUNDARY_DIST_MIN 0.6f    // minimum distance for a boundary point.  This ensures the object avoidance code doesn't think we are outside the boundary.
+#define PROXIMITY_BOUNDARY_DIST_DEFAULT 100 // if we have no data for a sector, boundary is placed 100m out
+
+/*
+  distance to the closest object in each cell of a polar grid around
+  the vehicle, by body-frame yaw sector and pitch layer. Distances are
+  held in cm to keep the grid small. The boundary used for avoidance is
+  built from the horizontal layer, and changing a cell only recalculates
+  the boundary points either side of its sector
+ */
+class AP_Proximity_Grid
+{
+public:
+    AP_Proximity_Grid();
+
+    // sector a body-frame yaw angle in degrees falls into
+    static uint8_t get_sector(float yaw_deg);
+
+    // layer a pitch angle in degrees (up is positive) falls into.
+    // returns false if it is above or below all the layers
+    static bool get_layer(float pitch_deg, uint8_t &layer);
+
+    // middle angle of a sector
+    static float sector_middle_deg(uint8_t sector) { return sector * PROXIMITY_GRID_SECTOR_WIDTH_DEG; }
+
+    // set the distance to the closest object in a cell. A distance
+    // of zero or less clears the cell
+    void set_distance(uint8_t sector, uint8_t layer, float distance_m);
+
+    // clear all the cells
+    void reset();
+
+    // distance to the closest object in a cell. returns false if the cell is clear
+    bool get_distance(uint8_t sector, uint8_t layer, float &distance_m) const;
+
+    // true if any cell of the horizontal layer has a distance
+    bool has_horizontal_data() const { return _num_horizontal > 0; }
+
+    // direction and distance of the closest object in the horizontal layer
+    bool get_horizontal_closest(float &yaw_deg, float &distance_m) const;
+
+    // boundary points around the vehicle in cm for use by avoidance, one per sector
+    const Vector2f *get_boundary_points() const { return _boundary_point; }
+
+private:
+    // update the boundary points either side of a sector after its horizontal distance changes
+    void update_boundary(uint8_t sector);
+
+    // shortest horizontal distance of two adjacent sectors, for the boundary point between them
+    float boundary_distance(uint8_t sector, uint8_t next_sector) const;
+
+    uint16_t _distance_cm[PROXIMITY_GRID_SECTORS][PROXIMITY_GRID_LAYERS];   // zero if the cell is clear
+    uint16_t _num_horizontal;                                   // number of cells of the horizontal layer with a distance
+
+    Vector2f _sector_edge_vector[PROXIMITY_GRID_SECTORS];       // vector for right-edge of each sector
+    Vector2f _boundary_point[PROXIMITY_GRID_SECTORS];           // bounding polygon around the vehicle
+};
@@ -25,6 +25,9 @@ extern const AP_HAL::HAL& hal;
 #define PROXIMITY_SF40C_HEADER                  0xAA
 #define PROXIMITY_SF40C_DESIRED_OUTPUT_RATE     3
 #define PROXIMITY_SF40C_UART_RX_SPACE           1280
+#define PROXIMITY_SF40C_READ_LEN                128     // bytes read from the uart at once
+#define PROXIMITY_SF40C_SCAN_QUEUE_LEN          512     // readings queued between the thread and update()
+#define PROXIMITY_SF40C_THREAD_PERIOD_US        2000
 
 /* 
    The constructor also initialises the proximity sensor. Note that this
@@ -35,11 +38,16 @@ AP_Proximity_LightWareSF40C::AP_Proximity_LightWareSF40C(AP_Proximity &_frontend
                                                          AP_Proximity::Proximity_State &_state) :
     AP_Proximity_Backend(_frontend, _state)
 {
-    const AP_SerialManager &serial_manager = AP::serialmanager();
-    _uart = serial_manager.find_serial(AP_SerialManager::SerialProtocol_Lidar360, 0);
+    _uart = AP::serialmanager().find_serial(AP_SerialManager::SerialProtocol_Lidar360, 0);
+
+    // the sensor is read and decoded on its own thread which queues the readings for update()
     if (_uart != nullptr) {
-        // start uart with larger receive buffer
-        _uart->begin(serial_manager.find_baudrate(AP_SerialManager::SerialProtocol_Lidar360, 0), PROXIMITY_SF40C_UART_RX_SPACE, 0);
+        if (!scan_queue_init(PROXIMITY_SF40C_SCAN_QUEUE_LEN) ||
+            !hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_Proximity_LightWareSF40C::thread_main, void),
+                                          "SF40C", 1024, AP_HAL::Scheduler::PRIORITY_UART, 0)) {
+            hal.console->printf("Failed to create SF40C thread\n");
+            _uart = nullptr;
+        }
     }
 }
 
@@ -49,6 +57,23 @@ bool AP_Proximity_LightWareSF40C::detect()
     return AP::serialmanager().find_serial(AP_SerialManager::SerialProtocol_Lidar360, 0) != nullptr;
 }
 
+// thread reading the sensor and decoding its output
+void AP_Proximity_LightWareSF40C::thread_main()
+{
+    // the uart is used only from this thread. start it with a larger receive buffer
+    _uart->begin(AP::serialmanager().find_baudrate(AP_SerialManager::SerialProtocol_Lidar360, 0), PROXIMITY_SF40C_UART_RX_SPACE, 0);
+
+    while (true) {
+        // initialise sensor if necessary
+        initialise();
+
+        // process incoming messages
+        process_replies();
+
+        hal.scheduler->delay_microseconds(PROXIMITY_SF40C_THREAD_PERIOD_US);
+    }
+}
+
 // update the state of the sensor
 void AP_Proximity_LightWareSF40C::update(void)
 {
@@ -56,11 +81,8 @@ void AP_Proximity_LightWareSF40C::update(void)
         return;
     }
 
-    // initialise sensor if necessary
-    initialise();
-
-    // process incoming messages
-    process_replies();
+    // apply the readings decoded since the last update
+    scan_apply_readings(true);
 
     // check for timeout and set health status
     if ((_last_distance_received_ms == 0) || ((AP_HAL::millis() - _last_distance_received_ms) > PROXIMITY_SF40C_TIMEOUT_MS)) {
@@ -73,9 +95,6 @@ void AP_Proximity_LightWareSF40C::update(void)
 // initialise sensor
 void AP_Proximity_LightWareSF40C::initialise()
 {
-    // initialise boundary
-    init_boundary();
-
     // exit immediately if we've sent initialisation requests in the last second
     uint32_t now_ms = AP_HAL::millis();
     if ((now_ms - _last_request_ms) < 1000) {
@@ -214,13 +233,10 @@ void AP_Proximity_LightWareSF40C::process_replies()
         return;
     }
 
-    int16_t nbytes = _uart->available();
-    while (nbytes-- > 0) {
-        const int16_t r = _uart->read();
-        if ((r < 0) || (r > 0xFF)) {
-            continue;
-        }
-        parse_byte((uint8_t)r);
+    uint8_t buf[PROXIMITY_SF40C_READ_LEN];
+    const ssize_t nbytes = _uart->read(buf, sizeof(buf));
+    for (ssize_t i = 0; i < nbytes; i++) {
+        parse_byte(buf[i]);
     }
 }
 
@@ -327,69 +343,23 @@ void AP_Proximity_LightWareSF40C::process_message()
             break;
         }
 
-        // prepare to push to object database
-        Vector2f current_pos;
-        float current_heading;
-        const bool database_ready = database_prepare_for_push(current_pos, current_heading);
-
-        // process each point
+        // queue each point for update()
         const float angle_inc_deg = (1.0f / point_total) * 360.0f;
         const float angle_sign = (frontend.get_orientation(state.instance) == 1) ? -1.0f : 1.0f;
         const float angle_correction = frontend.get_yaw_correction(state.instance);
         const uint16_t dist_min_cm = distance_min() * 100;
         const uint16_t dist_max_cm = distance_max() * 100;
 
-        // mini sectors are used to combine several readings together
-        uint8_t combined_count = 0;
-        float combined_angle_deg = 0;
-        float combined_dist_m = INT16_MAX;
         for (uint16_t i = 0; i < point_count; i++) {
             const uint16_t idx = 14 + (i * 2);
             const int16_t dist_cm = (int16_t)buff_to_uint16(_msg.payload[idx], _msg.payload[idx+1]);
             const float angle_deg = wrap_360((point_start_index + i) * angle_inc_deg * angle_sign + angle_correction);
-            const uint8_t sector = convert_angle_to_sector(angle_deg);
-
-            // if we've entered a new sector then finish off previous sector
-            if (sector != _last_sector) {
-                // update boundary used for avoidance
-                if (_last_sector != UINT8_MAX) {
-                    update_boundary_for_sector(_last_sector, false);
-                }
-                // init for new sector
-                _last_sector = sector;
-                _distance[sector] = INT16_MAX;
-                _distance_valid[sector] = false;
-            }
 
             // check reading is not within an ignore zone
             if (!ignore_reading(angle_deg)) {
                 // check distance reading is valid
-                if ((dist_cm >= dist_min_cm) && (dist_cm <= dist_max_cm)) {
-                    const float dist_m = dist_cm * 0.01f;
-
-                    // update shortest distance for this sector
-                    if (dist_m < _distance[sector]) {
-                        _angle[sector] = angle_deg;
-                        _distance[sector] = dist_m;
-                        _distance_valid[sector] = true;
-                    }
-
-                    // calculate shortest of last few readings
-                    if (dist_m < combined_dist_m) {
-                        combined_dist_m = dist_m;
-                        combined_angle_deg = angle_deg;
-                    }
-                    combined_count++;
-                }
-            }
-
-            // send combined distance to object database
-            if ((i+1 >= point_count) || (combined_count >= PROXIMITY_SF40C_COMBINE_READINGS)) {
-                if ((combined_dist_m < INT16_MAX) && database_ready) {
-                    database_push(combined_angle_deg, combined_dist_m, _last_distance_received_ms, current_pos, current_heading);
-                }
-                combined_count = 0;
-                combined_dist_m = INT16_MAX;
+                const bool dist_valid = (dist_cm >= dist_min_cm) && (dist_cm <= dist_max_cm);
+                scan_queue_reading(angle_deg, dist_cm * 0.01f, dist_valid);
             }
         }
         break;
@@ -5,7 +5,6 @@
 
 #define PROXIMITY_SF40C_TIMEOUT_MS            200   // requests timeout after 0.2 seconds
 #define PROXIMITY_SF40C_PAYLOAD_LEN_MAX       256   // maximum payload size we can accept (in some configurations sensor may send as large as 1023)
-#define PROXIMITY_SF40C_COMBINE_READINGS        7   // combine this many readings together to improve efficiency
 
 class AP_Proximity_LightWareSF40C : public AP_Proximity_Backend
 {
@@ -27,6 +26,9 @@ public:
 
 private:
 
+    // thread reading the sensor and decoding its output
+    void thread_main();
+
     // initialise sensor
     void initialise();
 
@@ -110,7 +112,6 @@ private:
     uint32_t _last_reply_ms;                // system time of last valid reply
     uint32_t _last_restart_ms;              // system time we restarted the sensor
     uint32_t _last_distance_received_ms;    // system time of last distance measurement received from sensor
-    uint8_t _last_sector = UINT8_MAX;       // sector of last distance_cm
 
     // state of sensor
     struct {
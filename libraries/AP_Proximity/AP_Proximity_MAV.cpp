@@ -116,20 +116,41 @@ void AP_Proximity_MAV::handle_msg(const mavlink_message_t &msg)
             _distance[i] = MAX_DISTANCE;
         }
 
+        // shortest distance in each grid sector the message covers, zero if it saw nothing there
+        uint16_t grid_distance_cm[PROXIMITY_GRID_SECTORS];
+        bool grid_covered[PROXIMITY_GRID_SECTORS] {};
+        const uint8_t grid_per_reading = MAX(1, ceilf(fabsf(increment) / PROXIMITY_GRID_SECTOR_WIDTH_DEG));
+
         // iterate over message's sectors
         for (uint8_t j = 0; j < total_distances; j++) {
             const uint16_t distance_cm = packet.distances[j];
-            if (distance_cm == 0 ||
-                distance_cm == 65535 ||
-                distance_cm < packet.min_distance ||
-                distance_cm > packet.max_distance)
-            {
+            if (distance_cm == 0) {
+                // no information for this direction
+                continue;
+            }
+
+            const float mid_angle = wrap_360((float)j * increment + yaw_correction);
+            const bool distance_valid = (distance_cm != 65535) && (distance_cm >= packet.min_distance) && (distance_cm <= packet.max_distance);
+
+            // update each grid sector the reading spans
+            const float grid_start_angle = mid_angle - (grid_per_reading - 1) * PROXIMITY_GRID_SECTOR_WIDTH_DEG * 0.5f;
+            for (uint8_t k = 0; k < grid_per_reading; k++) {
+                const uint8_t grid_sector = AP_Proximity_Grid::get_sector(grid_start_angle + k * PROXIMITY_GRID_SECTOR_WIDTH_DEG);
+                if (!grid_covered[grid_sector]) {
+                    grid_covered[grid_sector] = true;
+                    grid_distance_cm[grid_sector] = 0;
+                }
+                if (distance_valid && (grid_distance_cm[grid_sector] == 0 || distance_cm < grid_distance_cm[grid_sector])) {
+                    grid_distance_cm[grid_sector] = distance_cm;
+                }
+            }
+
+            if (!distance_valid) {
                 // sanity check failed, ignore this distance value
                 continue;
             }
 
             const float packet_distance_m = distance_cm * 0.01f;
-            const float mid_angle = wrap_360((float)j * increment + yaw_correction);
 
             // iterate over proximity sectors
             for (uint8_t i = 0; i < PROXIMITY_NUM_SECTORS; i++) {
@@ -155,5 +176,12 @@ void AP_Proximity_MAV::handle_msg(const mavlink_message_t &msg)
                 update_boundary_for_sector(i, false);
             }
         }
+
+        // update the grid sectors the message covered, clearing those in which it saw nothing
+        for (uint8_t i = 0; i < PROXIMITY_GRID_SECTORS; i++) {
+            if (grid_covered[i]) {
+                _grid.set_distance(i, PROXIMITY_GRID_HORIZONTAL_LAYER, grid_distance_cm[i] * 0.01f);
+            }
+        }
     }
 }
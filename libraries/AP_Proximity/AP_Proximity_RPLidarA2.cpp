@@ -59,6 +59,10 @@
 #define RPLIDAR_CMD_GET_DEVICE_INFO    0x50
 #define RPLIDAR_CMD_GET_DEVICE_HEALTH  0x52
 
+#define RPLIDAR_SCAN_QUEUE_LEN       512    // readings queued between the thread and update()
+#define RPLIDAR_READ_LEN              128    // bytes read from the uart at once
+#define RPLIDAR_THREAD_PERIOD_US     2000
+
 // Commands with payload and have response
 #define RPLIDAR_CMD_EXPRESS_SCAN       0x82
 
@@ -76,12 +80,19 @@ AP_Proximity_RPLidarA2::AP_Proximity_RPLidarA2(
 {
     const AP_SerialManager &serial_manager = AP::serialmanager();
     _uart = serial_manager.find_serial(AP_SerialManager::SerialProtocol_Lidar360, 0);
-    if (_uart != nullptr) {
-        _uart->begin(serial_manager.find_baudrate(AP_SerialManager::SerialProtocol_Lidar360, 0));
-    }
     _cnt = 0 ;
     _sync_error = 0 ;
     _byte_count = 0;
+
+    // the sensor is read and decoded on its own thread which queues the readings for update()
+    if (_uart != nullptr) {
+        if (!scan_queue_init(RPLIDAR_SCAN_QUEUE_LEN) ||
+            !hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_Proximity_RPLidarA2::thread_main, void),
+                                          "RPLidar", 1024, AP_HAL::Scheduler::PRIORITY_UART, 0)) {
+            hal.console->printf("Failed to create RPLidar thread\n");
+            _uart = nullptr;
+        }
+    }
 }
 
 // detect if a RPLidarA2 proximity sensor is connected by looking for a configured serial port
@@ -90,6 +101,27 @@ bool AP_Proximity_RPLidarA2::detect()
     return AP::serialmanager().find_serial(AP_SerialManager::SerialProtocol_Lidar360, 0) != nullptr;
 }
 
+// thread reading the sensor and decoding its output
+void AP_Proximity_RPLidarA2::thread_main()
+{
+    // the uart is used only from this thread
+    _uart->begin(AP::serialmanager().find_baudrate(AP_SerialManager::SerialProtocol_Lidar360, 0));
+
+    while (true) {
+        // initialise sensor if necessary
+        if (!_initialised) {
+            _initialised = initialise();    //returns true if everything initialized properly
+        }
+
+        // if LIDAR in known state
+        if (_initialised) {
+            get_readings();
+        }
+
+        hal.scheduler->delay_microseconds(RPLIDAR_THREAD_PERIOD_US);
+    }
+}
+
 // update the _rp_state of the sensor
 void AP_Proximity_RPLidarA2::update(void)
 {
@@ -97,15 +129,8 @@ void AP_Proximity_RPLidarA2::update(void)
         return;
     }
 
-    // initialise sensor if necessary
-    if (!_initialised) {
-        _initialised = initialise();    //returns true if everything initialized properly
-    }
-
-    // if LIDAR in known state
-    if (_initialised) {
-        get_readings();
-    }
+    // apply the readings decoded since the last update
+    scan_apply_readings(true);
 
     // check for timeout and set health status
     if ((_last_distance_received_ms == 0) || (AP_HAL::millis() - _last_distance_received_ms > COMM_ACTIVITY_TIMEOUT_MS)) {
@@ -130,9 +155,6 @@ float AP_Proximity_RPLidarA2::distance_min() const
 
 bool AP_Proximity_RPLidarA2::initialise()
 {
-    // initialise boundary
-    init_boundary();
-
     if (!_initialised) {
         reset_rplidar();            // set to a known state
         Debug(1, "LIDAR initialised");
@@ -187,11 +209,12 @@ void AP_Proximity_RPLidarA2::get_readings()
         return;
     }
     Debug(2, "             CURRENT STATE: %d ", _rp_state);
-    uint32_t nbytes = _uart->available();
+    uint8_t buf[RPLIDAR_READ_LEN];
+    const ssize_t nbytes = _uart->read(buf, sizeof(buf));
 
-    while (nbytes-- > 0) {
+    for (ssize_t i = 0; i < nbytes; i++) {
 
-        uint8_t c = _uart->read();
+        uint8_t c = buf[i];
         Debug(2, "UART READ %x <%c>", c, c); //show HEX values
 
         STATE:
@@ -342,28 +365,7 @@ void AP_Proximity_RPLidarA2::parse_response_data()
 #endif
                 _last_distance_received_ms = AP_HAL::millis();
                 if (!ignore_reading(angle_deg)) {
-                    const uint8_t sector = convert_angle_to_sector(angle_deg);
-                    if (distance_m > distance_min()) {
-                        if (_last_sector == sector) {
-                            if (_distance_m_last > distance_m) {
-                                _distance_m_last = distance_m;
-                                _angle_deg_last  = angle_deg;
-                            }
-                        } else {
-                            // a new sector started, the previous one can be updated now
-                            _angle[_last_sector] = _angle_deg_last;
-                            _distance[_last_sector] = _distance_m_last;
-                            _distance_valid[_last_sector] = true;
-                            // update boundary used for avoidance
-                            update_boundary_for_sector(_last_sector, true);
-                            // initialize the new sector
-                            _last_sector     = sector;
-                            _distance_m_last = distance_m;
-                            _angle_deg_last  = angle_deg;
-                        }
-                    } else {
-                        _distance_valid[sector] = false;
-                    }
+                    scan_queue_reading(angle_deg, distance_m, distance_m > distance_min());
                 }
             } else {
                 // not valid payload packet
@@ -67,6 +67,9 @@ private:
         ResponseType_Health
     };
 
+    // thread reading the sensor and decoding its output
+    void thread_main();
+
     // initialise sensor (returns true if sensor is successfully initialised)
     bool initialise();
     void set_scan_mode();
@@ -95,15 +98,10 @@ private:
     // request related variables
     enum ResponseType _response_type;         ///< response from the lidar
     enum rp_state _rp_state;
-    uint8_t   _last_sector;                   ///< last sector requested
     uint32_t  _last_request_ms;               ///< system time of last request
     uint32_t  _last_distance_received_ms;     ///< system time of last distance measurement received from sensor
     uint32_t  _last_reset_ms;
 
-    // sector related variables
-    float _angle_deg_last;
-    float _distance_m_last;
-
     struct PACKED _sensor_scan {
         uint8_t startbit      : 1;            ///< on the first revolution 1 else 0
         uint8_t not_startbit  : 1;            ///< complementary to startbit
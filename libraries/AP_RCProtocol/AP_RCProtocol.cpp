@@ -61,7 +61,10 @@ void AP_RCProtocol::process_pulse(uint32_t width_s0, uint32_t width_s1)
     }
     // first try current protocol
     if (_detected_protocol != AP_RCProtocol::NONE && !searching) {
+        const uint32_t start_us = AP_HAL::micros();
+        const uint32_t frame_count = backend[_detected_protocol]->get_rc_frame_count();
         backend[_detected_protocol]->process_pulse(width_s0, width_s1);
+        update_stats(start_us, frame_count);
         if (backend[_detected_protocol]->new_input()) {
             _new_input = true;
             _last_input_ms = now;
@@ -89,6 +92,7 @@ void AP_RCProtocol::process_pulse(uint32_t width_s0, uint32_t width_s1)
                 memset(_good_frames, 0, sizeof(_good_frames));
                 _last_input_ms = now;
                 _detected_with_bytes = false;
+                reset_stats();
                 break;
             }
         }
@@ -96,7 +100,8 @@ void AP_RCProtocol::process_pulse(uint32_t width_s0, uint32_t width_s1)
 }
 
 /*
-  process an array of pulses. n must be even
+  process an array of pulses. n must be even. Once a protocol has been
+  detected the rest of the list is decoded by that protocol alone
  */
 void AP_RCProtocol::process_pulse_list(const uint32_t *widths, uint16_t n, bool need_swap)
 {
@@ -104,6 +109,15 @@ void AP_RCProtocol::process_pulse_list(const uint32_t *widths, uint16_t n, bool
         return;
     }
     while (n) {
+        const uint32_t now = AP_HAL::millis();
+        const bool searching = (now - _last_input_ms >= 200);
+        if (_detected_protocol != AP_RCProtocol::NONE && !searching) {
+            if (!_detected_with_bytes) {
+                process_pulse_list_detected(widths, n, need_swap, now);
+            }
+            // else we're using byte inputs, discard pulses
+            return;
+        }
         uint32_t widths0 = widths[0];
         uint32_t widths1 = widths[1];
         if (need_swap) {
@@ -118,6 +132,28 @@ void AP_RCProtocol::process_pulse_list(const uint32_t *widths, uint16_t n, bool
     }
 }
 
+void AP_RCProtocol::process_pulse_list_detected(const uint32_t *widths, uint16_t n, bool need_swap, uint32_t now_ms)
+{
+    AP_RCProtocol_Backend *b = backend[_detected_protocol];
+    const uint32_t start_us = AP_HAL::micros();
+    const uint32_t frame_count = b->get_rc_frame_count();
+    for (; n; widths += 2, n -= 2) {
+        uint32_t widths0 = widths[0];
+        uint32_t widths1 = widths[1];
+        if (need_swap) {
+            uint32_t tmp = widths1;
+            widths1 = widths0;
+            widths0 = tmp;
+        }
+        b->process_pulse(widths0, widths1 - widths0);
+    }
+    update_stats(start_us, frame_count);
+    if (b->new_input()) {
+        _new_input = true;
+        _last_input_ms = now_ms;
+    }
+}
+
 bool AP_RCProtocol::process_byte(uint8_t byte, uint32_t baudrate)
 {
     uint32_t now = AP_HAL::millis();
@@ -128,7 +164,10 @@ bool AP_RCProtocol::process_byte(uint8_t byte, uint32_t baudrate)
     }
     // first try current protocol
     if (_detected_protocol != AP_RCProtocol::NONE && !searching) {
+        const uint32_t start_us = AP_HAL::micros();
+        const uint32_t frame_count = backend[_detected_protocol]->get_rc_frame_count();
         backend[_detected_protocol]->process_byte(byte, baudrate);
+        update_stats(start_us, frame_count);
         if (backend[_detected_protocol]->new_input()) {
             _new_input = true;
             _last_input_ms = now;
@@ -152,6 +191,7 @@ bool AP_RCProtocol::process_byte(uint8_t byte, uint32_t baudrate)
                 memset(_good_frames, 0, sizeof(_good_frames));
                 _last_input_ms = now;
                 _detected_with_bytes = true;
+                reset_stats();
 
                 // stop decoding pulses to save CPU
                 hal.rcin->pulse_input_enable(false);
@@ -229,11 +269,43 @@ void AP_RCProtocol::update()
     check_added_uart();
 }
 
+void AP_RCProtocol::update_stats(uint32_t start_us, uint32_t frame_count)
+{
+    _stats.decode_us += AP_HAL::micros() - start_us;
+    _stats.frames += backend[_detected_protocol]->get_rc_frame_count() - frame_count;
+}
+
+void AP_RCProtocol::reset_stats(void)
+{
+    memset(&_stats, 0, sizeof(_stats));
+    _stats.start_ms = AP_HAL::millis();
+}
+
+bool AP_RCProtocol::get_decode_stats(struct decode_stats &stats) const
+{
+    if (_detected_protocol == AP_RCProtocol::NONE) {
+        return false;
+    }
+    stats = _stats.last;
+    return true;
+}
+
 bool AP_RCProtocol::new_input()
 {
     bool ret = _new_input;
     _new_input = false;
 
+    // calculate the decode stats once a second
+    const uint32_t now = AP_HAL::millis();
+    const uint32_t dt_ms = now - _stats.start_ms;
+    if (dt_ms >= 1000) {
+        _stats.last.frame_rate_hz = _stats.frames * 1000.0f / dt_ms;
+        _stats.last.decode_us = _stats.frames ? MIN(_stats.decode_us / _stats.frames, uint32_t(UINT16_MAX)) : 0;
+        _stats.frames = 0;
+        _stats.decode_us = 0;
+        _stats.start_ms = now;
+    }
+
     // if we have an extra UART from a SERIALn_PROTOCOL then check it for data
     check_added_uart();
 
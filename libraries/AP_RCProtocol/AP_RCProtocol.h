@@ -81,9 +81,24 @@ public:
     // add a UART for RCIN
     void add_uart(AP_HAL::UARTDriver* uart);
 
+    // decoding statistics for the detected protocol, updated once a second
+    struct decode_stats {
+        float frame_rate_hz;        // frames decoded per second
+        uint16_t decode_us;         // average time spent decoding each frame
+    };
+    // returns false if no protocol has been detected
+    bool get_decode_stats(struct decode_stats &stats) const;
+
 private:
     void check_added_uart(void);
 
+    // decode a list of pulses using only the detected protocol
+    void process_pulse_list_detected(const uint32_t *widths, uint16_t n, bool need_swap, uint32_t now_ms);
+
+    // add the decode time and frames from one call into the detected backend
+    void update_stats(uint32_t start_us, uint32_t frame_count);
+    void reset_stats(void);
+
     enum rcprotocol_t _detected_protocol = NONE;
     uint16_t _disabled_for_pulses;
     bool _detected_with_bytes;
@@ -93,6 +108,14 @@ private:
     bool _valid_serial_prot = false;
     uint8_t _good_frames[NONE];
 
+    // frames and decode time since the stats were last calculated
+    struct {
+        uint32_t frames;
+        uint32_t decode_us;
+        uint32_t start_ms;
+        struct decode_stats last;
+    } _stats;
+
     enum config_phase {
         CONFIG_115200_8N1 = 0,
         CONFIG_115200_8N1I = 1,
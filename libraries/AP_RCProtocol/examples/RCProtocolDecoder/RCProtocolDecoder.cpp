@@ -106,6 +106,15 @@ void loop()
             printf("\n");
         }
     }
+
+    // show decode stats once a second
+    static uint32_t last_stats_ms;
+    const uint32_t now = AP_HAL::millis();
+    AP_RCProtocol::decode_stats stats;
+    if (now - last_stats_ms >= 1000 && rcprot->get_decode_stats(stats)) {
+        last_stats_ms = now;
+        printf("%s: %.1f frames/s %uus/frame\n", rcprot->protocol_name(), (double)stats.frame_rate_hz, (unsigned)stats.decode_us);
+    }
 }
 
 #else
@@ -18,6 +18,7 @@
 
 #include "AP_ROMFS.h"
 #include "tinf.h"
+#include <AP_Math/AP_Math.h>
 
 #ifdef HAL_HAVE_AP_ROMFS_EMBEDDED_H
 #include <ap_romfs_embedded.h>
@@ -25,6 +26,16 @@
 const AP_ROMFS::embedded_file AP_ROMFS::files[] = {};
 #endif
 
+static uint16_t get_le16(const uint8_t *p)
+{
+    return p[0] | p[1] << 8;
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | uint32_t(p[3]) << 24;
+}
+
 /*
   find an embedded file
 */
@@ -54,8 +65,14 @@ const uint8_t *AP_ROMFS::find_decompress(const char *name, uint32_t &size)
     }
 
 #ifdef HAL_ROMFS_UNCOMPRESSED
+    size = compressed_size;
     return compressed_data;
 #else
+    if (is_chunked(compressed_data, compressed_size)) {
+        size = compressed_size;
+        return decompress_chunked(compressed_data, size);
+    }
+
     // last 4 bytes of gzip file are length of decompressed data
     const uint8_t *p = &compressed_data[compressed_size-4];
     uint32_t decompressed_size = p[0] | p[1] << 8 | p[2] << 16 | p[3] << 24;
@@ -105,6 +122,94 @@ const uint8_t *AP_ROMFS::find_decompress(const char *name, uint32_t &size)
 #endif
 }
 
+/*
+  check the header and block index of a chunked file
+*/
+bool AP_ROMFS::is_chunked(const uint8_t *data, uint32_t size)
+{
+    if (size < AP_ROMFS_CHUNKED_HEADER || get_le32(data) != AP_ROMFS_CHUNKED_MAGIC) {
+        return false;
+    }
+    const uint32_t file_size = get_le32(&data[4]);
+    const uint16_t block_size = get_le16(&data[8]);
+    const uint16_t num_blocks = get_le16(&data[10]);
+    if (block_size == 0 ||
+        num_blocks != (file_size + block_size - 1) / block_size ||
+        size < AP_ROMFS_CHUNKED_HEADER + 4 * (num_blocks + 1U)) {
+        return false;
+    }
+    // the blocks must follow the index, in order
+    const uint8_t *index = &data[AP_ROMFS_CHUNKED_HEADER];
+    uint32_t prev_ofs = AP_ROMFS_CHUNKED_HEADER + 4 * (num_blocks + 1U);
+    for (uint16_t i=0; i<=num_blocks; i++) {
+        const uint32_t ofs = get_le32(&index[i*4]);
+        if (ofs < prev_ofs || ofs > size) {
+            return false;
+        }
+        prev_ofs = ofs;
+    }
+    return true;
+}
+
+/*
+  decompress one independently compressed raw deflate block. Returns
+  false unless it produces exactly dest_len bytes
+*/
+bool AP_ROMFS::inflate_block(TINF_DATA *d, const uint8_t *src, uint32_t src_len, uint8_t *dest, uint32_t dest_len)
+{
+    if (dest_len == 0) {
+        return true;
+    }
+    uzlib_uncompress_init(d, NULL, 0);
+    d->source = src;
+    d->source_limit = src + src_len;
+    d->dest = dest;
+    d->destSize = dest_len;
+    const int res = uzlib_uncompress(d);
+    return (res == TINF_OK || res == TINF_DONE) && d->dest == dest + dest_len;
+}
+
+/*
+  decompress all the blocks of a chunked file into one buffer from
+  malloc, with a null after the data. size is the size of the chunked
+  data on entry and the decompressed size on return
+*/
+const uint8_t *AP_ROMFS::decompress_chunked(const uint8_t *data, uint32_t &size)
+{
+    const uint32_t file_size = get_le32(&data[4]);
+    const uint16_t block_size = get_le16(&data[8]);
+    const uint16_t num_blocks = get_le16(&data[10]);
+    const uint8_t *index = &data[AP_ROMFS_CHUNKED_HEADER];
+
+    uint8_t *decompressed_data = (uint8_t *)malloc(file_size + 1);
+    if (!decompressed_data) {
+        return nullptr;
+    }
+    decompressed_data[file_size] = 0;
+
+    TINF_DATA *d = (TINF_DATA *)malloc(sizeof(TINF_DATA));
+    if (!d) {
+        ::free(decompressed_data);
+        return nullptr;
+    }
+
+    for (uint16_t i=0; i<num_blocks; i++) {
+        const uint32_t ofs = get_le32(&index[i*4]);
+        const uint32_t next_ofs = get_le32(&index[(i+1)*4]);
+        const uint32_t start = uint32_t(i) * block_size;
+        if (!inflate_block(d, &data[ofs], next_ofs - ofs,
+                           &decompressed_data[start], MIN(uint32_t(block_size), file_size - start))) {
+            ::free(d);
+            ::free(decompressed_data);
+            return nullptr;
+        }
+    }
+    ::free(d);
+
+    size = file_size;
+    return decompressed_data;
+}
+
 // free returned data
 void AP_ROMFS::free(const uint8_t *data)
 {
@@ -112,3 +217,130 @@ void AP_ROMFS::free(const uint8_t *data)
     ::free(const_cast<uint8_t *>(data));
 #endif
 }
+
+/*
+  directory listing interface. Start with ofs=0. Returns nullptr at
+  the end of the list
+*/
+const char *AP_ROMFS::dir_list(const char *dirname, uint16_t &ofs)
+{
+    const size_t dlen = strlen(dirname);
+    for ( ; ofs < ARRAY_SIZE(files); ofs++) {
+        if (strncmp(dirname, files[ofs].filename, dlen) == 0 &&
+            files[ofs].filename[dlen] == '/') {
+            // found one
+            return &files[ofs++].filename[dlen+1];
+        }
+    }
+    return nullptr;
+}
+
+/*
+  open a file for streaming. Chunked files only need a buffer of one
+  block, other files are decompressed whole
+*/
+AP_ROMFS::Stream *AP_ROMFS::open(const char *name)
+{
+    uint32_t size;
+    const uint8_t *data = find_file(name, size);
+    if (!data) {
+        return nullptr;
+    }
+    Stream *s = new Stream();
+    if (s == nullptr) {
+        return nullptr;
+    }
+    s->loaded_block = -1;
+
+#ifndef HAL_ROMFS_UNCOMPRESSED
+    if (is_chunked(data, size)) {
+        s->chunked = true;
+        s->data = data;
+        s->file_size = get_le32(&data[4]);
+        s->block_size = get_le16(&data[8]);
+        s->num_blocks = get_le16(&data[10]);
+        s->buf = (uint8_t *)malloc(s->block_size);
+        s->tinf = (TINF_DATA *)malloc(sizeof(TINF_DATA));
+        if (s->buf == nullptr || s->tinf == nullptr) {
+            close(s);
+            return nullptr;
+        }
+        return s;
+    }
+#endif
+
+    s->data = find_decompress(name, s->file_size);
+    if (s->data == nullptr) {
+        delete s;
+        return nullptr;
+    }
+    return s;
+}
+
+void AP_ROMFS::close(Stream *s)
+{
+    if (s == nullptr) {
+        return;
+    }
+    if (s->chunked) {
+        ::free(s->buf);
+        ::free(s->tinf);
+    } else {
+        free(s->data);
+    }
+    delete s;
+}
+
+uint32_t AP_ROMFS::Stream::block_offset(uint16_t block) const
+{
+    return get_le32(&data[AP_ROMFS_CHUNKED_HEADER + block*4U]);
+}
+
+bool AP_ROMFS::Stream::load_block(uint16_t block)
+{
+    if (loaded_block == block) {
+        return true;
+    }
+    const uint32_t ofs = block_offset(block);
+    const uint32_t start = uint32_t(block) * block_size;
+    if (!inflate_block(tinf, &data[ofs], block_offset(block+1) - ofs,
+                       buf, MIN(uint32_t(block_size), file_size - start))) {
+        loaded_block = -1;
+        return false;
+    }
+    loaded_block = block;
+    return true;
+}
+
+int32_t AP_ROMFS::Stream::read(void *_buf, uint32_t count)
+{
+    uint8_t *b = (uint8_t *)_buf;
+    count = MIN(count, file_size - pos);
+    if (!chunked) {
+        memcpy(b, &data[pos], count);
+        pos += count;
+        return count;
+    }
+    uint32_t total = 0;
+    while (total < count) {
+        const uint16_t block = pos / block_size;
+        if (!load_block(block)) {
+            return -1;
+        }
+        const uint32_t block_ofs = pos - uint32_t(block) * block_size;
+        const uint32_t n = MIN(count - total, block_size - block_ofs);
+        memcpy(&b[total], &buf[block_ofs], n);
+        total += n;
+        pos += n;
+    }
+    return total;
+}
+
+bool AP_ROMFS::Stream::seek(uint32_t ofs)
+{
+    if (ofs > file_size) {
+        return false;
+    }
+    pos = ofs;
+    return true;
+}
@@ -5,6 +5,27 @@
 
 #include <AP_HAL/AP_HAL.h>
 
+struct TINF_DATA;
+
+/*
+  files are embedded either gzip compressed or in a chunked format,
+  where the data is compressed in independent blocks of a fixed
+  uncompressed size, followed by an index of where each block
+  starts. A chunked file can be read a block at a time without
+  decompressing the whole file.
+
+  chunked format, little endian:
+    uint32_t magic (AP_ROMFS_CHUNKED_MAGIC)
+    uint32_t size of the uncompressed file
+    uint16_t block size
+    uint16_t number of blocks
+    uint32_t offset of each block from the start of the file, plus one
+             more for the end of the last block
+    raw deflate data of each block
+ */
+#define AP_ROMFS_CHUNKED_MAGIC  0x315A4652  // "RFZ1"
+#define AP_ROMFS_CHUNKED_HEADER 12
+
 class AP_ROMFS {
 public:
     // find a file and de-compress, assumning gzip format. The
@@ -16,10 +37,69 @@ public:
     // free returned data
     static void free(const uint8_t *data);
 
+    // list the files in a directory. Start with ofs at zero and call
+    // until nullptr is returned. The name returned does not include
+    // the directory
+    static const char *dir_list(const char *dirname, uint16_t &ofs);
+
+    /*
+      streaming access to a file. Chunked files are decompressed one
+      block at a time into a buffer of the block size as they are
+      read, gzip files are decompressed whole when opened
+     */
+    class Stream {
+    public:
+        // read up to count bytes from the current position, returning
+        // the number of bytes read or -1 if the data is corrupt
+        int32_t read(void *buf, uint32_t count);
+
+        // move to a position from the start of the file. Returns
+        // false if it is past the end of the file
+        bool seek(uint32_t ofs);
+
+        uint32_t tell() const { return pos; }
+        uint32_t size() const { return file_size; }
+
+    private:
+        friend class AP_ROMFS;
+
+        // decompress a block of a chunked file into the buffer
+        bool load_block(uint16_t block);
+
+        // offset of a block of a chunked file from the start of the file
+        uint32_t block_offset(uint16_t block) const;
+
+        const uint8_t *data;        // file data, or the chunked file
+        uint32_t file_size;
+        uint32_t pos;
+        bool chunked;
+        uint16_t block_size;
+        uint16_t num_blocks;
+        int32_t loaded_block;       // block in buf, -1 if none
+        uint8_t *buf;               // decompressed block
+        TINF_DATA *tinf;
+    };
+
+    // open a file for streaming, returns nullptr if it is not found
+    // or there is not enough memory. Close with AP_ROMFS::close()
+    static Stream *open(const char *name);
+
+    // close a stream
+    static void close(Stream *s);
+
 private:
     // find an embedded file
     static const uint8_t *find_file(const char *name, uint32_t &size);
 
+    // true if the data of an embedded file is in the chunked format
+    static bool is_chunked(const uint8_t *data, uint32_t size);
+
+    // decompress a whole chunked file
+    static const uint8_t *decompress_chunked(const uint8_t *data, uint32_t &size);
+
+    // decompress one raw deflate block to dest
+    static bool inflate_block(TINF_DATA *d, const uint8_t *src, uint32_t src_len, uint8_t *dest, uint32_t dest_len);
+
     struct embedded_file {
         const char *filename;
         uint32_t size;
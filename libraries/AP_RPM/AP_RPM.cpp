@@ -16,6 +16,7 @@
 #include "AP_RPM.h"
 #include "RPM_Pin.h"
 #include "RPM_SITL.h"
+#include "RPM_ESC_Telem.h"
 
 extern const AP_HAL::HAL& hal;
 
@@ -24,7 +25,7 @@ const AP_Param::GroupInfo AP_RPM::var_info[] = {
     // @Param: _TYPE
     // @DisplayName: RPM type
     // @Description: What type of RPM sensor is connected
-    // @Values: 0:None,1:PWM,2:AUXPIN
+    // @Values: 0:None,1:PWM,2:AUXPIN,3:ESCTelemetry
     // @User: Standard
     AP_GROUPINFO("_TYPE",    0, AP_RPM, _type[0], 0),
 
@@ -67,7 +68,7 @@ const AP_Param::GroupInfo AP_RPM::var_info[] = {
     // @Param: 2_TYPE
     // @DisplayName: Second RPM type
     // @Description: What type of RPM sensor is connected
-    // @Values: 0:None,1:PWM,2:AUXPIN
+    // @Values: 0:None,1:PWM,2:AUXPIN,3:ESCTelemetry
     // @User: Advanced
     AP_GROUPINFO("2_TYPE",    10, AP_RPM, _type[1], 0),
 
@@ -118,6 +119,11 @@ void AP_RPM::init(void)
         if (type == RPM_TYPE_PIN) {
             drivers[i] = new AP_RPM_Pin(*this, i, state[i]);
         }
+#ifdef HAVE_AP_BLHELI_SUPPORT
+        if (type == RPM_TYPE_ESC_TELEM) {
+            drivers[i] = new AP_RPM_ESC_Telem(*this, i, state[i]);
+        }
+#endif
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
         drivers[i] = new AP_RPM_SITL(*this, i, state[i]);
 #endif
@@ -0,0 +1,43 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RPM_ESC_Telem.h"
+
+#ifdef HAVE_AP_BLHELI_SUPPORT
+
+AP_RPM_ESC_Telem::AP_RPM_ESC_Telem(AP_RPM &_ap_rpm, uint8_t _instance, AP_RPM::RPM_State &_state) :
+    AP_RPM_Backend(_ap_rpm, _instance, _state)
+{
+}
+
+void AP_RPM_ESC_Telem::update(void)
+{
+    const AP_BLHeli *blheli = AP_BLHeli::get_singleton();
+    if (blheli == nullptr) {
+        return;
+    }
+    // the average is zero if no motor has recent data
+    const float motor_freq_hz = blheli->get_average_motor_frequency_hz();
+    if (is_positive(motor_freq_hz)) {
+        state.rate_rpm = motor_freq_hz * 60.0f * ap_rpm._scaling[state.instance];
+        state.signal_quality = 1.0f;
+        state.last_reading_ms = AP_HAL::millis();
+    } else if (AP_HAL::millis() - state.last_reading_ms > 1000) {
+        state.signal_quality = 0;
+        state.rate_rpm = 0;
+    }
+}
+
+#endif // HAVE_AP_BLHELI_SUPPORT
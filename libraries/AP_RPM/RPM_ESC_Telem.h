@@ -0,0 +1,39 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "AP_RPM.h"
+#include "RPM_Backend.h"
+
+#include <AP_BLHeli/AP_BLHeli.h>
+
+#ifdef HAVE_AP_BLHELI_SUPPORT
+
+/*
+  RPM from the ESCs, using bidirectional DShot where available and
+  serial ESC telemetry otherwise. This is the average of the motors
+  with recent data, times the scaling
+ */
+class AP_RPM_ESC_Telem : public AP_RPM_Backend
+{
+public:
+    // constructor
+    AP_RPM_ESC_Telem(AP_RPM &ranger, uint8_t instance, AP_RPM::RPM_State &_state);
+
+    // update state
+    void update(void) override;
+};
+
+#endif // HAVE_AP_BLHELI_SUPPORT
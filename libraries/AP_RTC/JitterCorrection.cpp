@@ -70,6 +70,12 @@ uint64_t JitterCorrection::correct_offboard_timestamp_usec(uint64_t offboard_use
         link_offset_usec = estimate_us - offboard_usec;
     }
 
+    // filter the lag of each message. The minimum lag can't be seen
+    // from one end of the link, so this is relative to the quickest
+    // message
+    const float lag_ms = (int64_t(local_usec) - estimate_us) * 0.001f;
+    link_lag_ms += 0.05f * (lag_ms - link_lag_ms);
+
     if (min_sample_counter == 0) {
         min_sample_us = diff_us;
     }
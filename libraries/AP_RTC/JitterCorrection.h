@@ -16,7 +16,14 @@ public:
     // correct an offboard timestamp to a jitter-free local
     // timestamp. See JitterCorrection.cpp for details
     uint32_t correct_offboard_timestamp_msec(uint32_t offboard_ms, uint32_t local_ms);
-    
+
+    // the most a corrected timestamp may be before the local time
+    uint16_t get_max_lag_ms() const { return max_lag_ms; }
+
+    // average time between a message being generated and it arriving,
+    // over the lag of the quickest message seen
+    float get_link_lag_ms() const { return link_lag_ms; }
+
 private:
     const uint16_t max_lag_ms;
     const uint16_t convergence_loops;
@@ -24,4 +31,5 @@ private:
     int64_t min_sample_us;
     bool initialised;
     uint16_t min_sample_counter;
+    float link_lag_ms;
 };
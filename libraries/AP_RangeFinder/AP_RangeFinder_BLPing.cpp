@@ -46,53 +46,9 @@
 // 8-n      uint8_t[]   payload         message payload
 // (n+1)-(n+2)  uint16_t    checksum    the sum of all the non-checksum bytes in the message (low byte, high byte)
 
-/* 
-   The constructor also initialises the rangefinder. Note that this
-   constructor is not called until detect() returns true, so we
-   already know that we should setup the rangefinder
-*/
-AP_RangeFinder_BLPing::AP_RangeFinder_BLPing(RangeFinder::RangeFinder_State &_state,
-                                             AP_RangeFinder_Params &_params,
-                                             uint8_t serial_instance) :
-    AP_RangeFinder_Backend(_state, _params)
+uint16_t AP_RangeFinder_BLPing::read_timeout_ms() const
 {
-    const AP_SerialManager &serial_manager = AP::serialmanager();
-    uart = serial_manager.find_serial(AP_SerialManager::SerialProtocol_Rangefinder, serial_instance);
-    if (uart != nullptr) {
-        uart->begin(serial_manager.find_baudrate(AP_SerialManager::SerialProtocol_Rangefinder, serial_instance));
-    }
-}
-
-// detect if a serial port has been setup to accept rangefinder input
-bool AP_RangeFinder_BLPing::detect(uint8_t serial_instance)
-{
-    return AP::serialmanager().find_serial(AP_SerialManager::SerialProtocol_Rangefinder, serial_instance) != nullptr;
-}
-
-/*
-   update the state of the sensor
-*/
-void AP_RangeFinder_BLPing::update(void)
-{
-    if (uart == nullptr) {
-        return;
-    }
-
-    const uint32_t now = AP_HAL::millis();
-
-    if (get_reading(state.distance_cm)) {
-        // update range_valid state based on distance measured
-        state.last_reading_ms = now;
-        update_status();
-    } else if (now - state.last_reading_ms > BLPING_TIMEOUT_MS) {
-        set_status(RangeFinder::RangeFinder_NoData);
-
-        // initialise sensor if no distances recently
-        if (now - last_init_ms > BLPING_INIT_RATE_MS) {
-            last_init_ms = now;
-            init_sensor();
-        }
-    }
+    return BLPING_TIMEOUT_MS;
 }
 
 void AP_RangeFinder_BLPing::init_sensor()
@@ -156,6 +112,14 @@ bool AP_RangeFinder_BLPing::get_reading(uint16_t &reading_cm)
         return false;
     }
 
+    // initialise sensor if no distances recently
+    const uint32_t now = AP_HAL::millis();
+    if (now - state.last_reading_ms > BLPING_TIMEOUT_MS &&
+        now - last_init_ms > BLPING_INIT_RATE_MS) {
+        last_init_ms = now;
+        init_sensor();
+    }
+
     float sum_cm = 0;
     uint16_t count = 0;
 
@@ -1,23 +1,14 @@
 #pragma once
 
 #include "RangeFinder.h"
-#include "RangeFinder_Backend.h"
+#include "AP_RangeFinder_Backend_Serial.h"
 
-class AP_RangeFinder_BLPing : public AP_RangeFinder_Backend
+class AP_RangeFinder_BLPing : public AP_RangeFinder_Backend_Serial
 {
 
 public:
 
-    // constructor
-    AP_RangeFinder_BLPing(RangeFinder::RangeFinder_State &_state,
-                          AP_RangeFinder_Params &_params,
-                          uint8_t serial_instance);
-
-    // static detection function
-    static bool detect(uint8_t serial_instance);
-
-    // update state
-    void update(void) override;
+    using AP_RangeFinder_Backend_Serial::AP_RangeFinder_Backend_Serial;
 
 protected:
 
@@ -33,7 +24,9 @@ private:
     void send_message(uint16_t msgid, const uint8_t *payload, uint16_t payload_len);
 
     // read a distance from the sensor
-    bool get_reading(uint16_t &reading_cm);
+    bool get_reading(uint16_t &reading_cm) override;
+
+    uint16_t read_timeout_ms() const override;
 
     // process one byte received on serial port
     // returns true if a distance message has been successfully parsed
@@ -54,7 +47,6 @@ private:
         CRC_H
     };
 
-    AP_HAL::UARTDriver *uart;
     uint32_t last_init_ms;      // system time that sensor was last initialised
     uint16_t distance_cm;       // latest distance
 
@@ -0,0 +1,90 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include "AP_RangeFinder_Backend_Serial.h"
+#include <AP_SerialManager/AP_SerialManager.h>
+
+extern const AP_HAL::HAL& hal;
+
+/*
+   The constructor also initialises the rangefinder. Note that this
+   constructor is not called until detect() returns true, so we
+   already know that we should setup the rangefinder
+*/
+AP_RangeFinder_Backend_Serial::AP_RangeFinder_Backend_Serial(RangeFinder::RangeFinder_State &_state,
+                                                             AP_RangeFinder_Params &_params,
+                                                             uint8_t serial_instance) :
+    AP_RangeFinder_Backend(_state, _params),
+    _serial_instance(serial_instance)
+{
+    uart = AP::serialmanager().find_serial(AP_SerialManager::SerialProtocol_Rangefinder, serial_instance);
+}
+
+uint32_t AP_RangeFinder_Backend_Serial::initial_baudrate(const uint8_t serial_instance) const
+{
+    return AP::serialmanager().find_baudrate(AP_SerialManager::SerialProtocol_Rangefinder, serial_instance);
+}
+
+/*
+   detect if a serial port has been setup to accept rangefinder input
+*/
+bool AP_RangeFinder_Backend_Serial::detect(uint8_t serial_instance)
+{
+    return AP::serialmanager().find_serial(AP_SerialManager::SerialProtocol_Rangefinder, serial_instance) != nullptr;
+}
+
+/*
+   read the sensor on the serial thread. The port is opened here as on
+   some boards only the thread which opened a port can read from it
+*/
+void AP_RangeFinder_Backend_Serial::update_serial(void)
+{
+    if (uart == nullptr) {
+        return;
+    }
+    if (!_uart_started) {
+        uart->begin(initial_baudrate(_serial_instance), rx_bufsize(), tx_bufsize());
+        _uart_started = true;
+    }
+    uint16_t reading_cm;
+    if (get_reading(reading_cm)) {
+        WITH_SEMAPHORE(_sem);
+        _reading.distance_cm = reading_cm;
+        _reading.time_ms = AP_HAL::millis();
+        _reading.new_reading = true;
+    }
+}
+
+/*
+   update the state of the sensor
+*/
+void AP_RangeFinder_Backend_Serial::update(void)
+{
+    {
+        WITH_SEMAPHORE(_sem);
+        if (_reading.new_reading) {
+            state.distance_cm = _reading.distance_cm;
+            state.last_reading_ms = _reading.time_ms;
+            _reading.new_reading = false;
+            // update range_valid state based on distance measured
+            update_status();
+            return;
+        }
+    }
+    if (AP_HAL::millis() - state.last_reading_ms > read_timeout_ms()) {
+        set_status(RangeFinder::RangeFinder_NoData);
+    }
+}
@@ -0,0 +1,67 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "RangeFinder_Backend.h"
+
+/*
+  base class for rangefinders on a serial port. The port is read on the
+  rangefinder serial thread, so each reading is timestamped when it
+  arrives rather than when the main loop gets around to it
+ */
+class AP_RangeFinder_Backend_Serial : public AP_RangeFinder_Backend
+{
+public:
+    // constructor
+    AP_RangeFinder_Backend_Serial(RangeFinder::RangeFinder_State &_state,
+                                  AP_RangeFinder_Params &_params,
+                                  uint8_t serial_instance);
+
+    // static detection function
+    static bool detect(uint8_t serial_instance);
+
+    // update state from the latest reading taken on the serial thread
+    void update(void) override;
+
+    // read the sensor. Called on the rangefinder serial thread
+    void update_serial(void) override;
+    bool uses_serial_thread(void) const override { return true; }
+
+protected:
+    // baudrate and buffer sizes to open the port with. Zero buffer
+    // sizes give the defaults
+    virtual uint32_t initial_baudrate(uint8_t serial_instance) const;
+    virtual uint16_t rx_bufsize() const { return 0; }
+    virtual uint16_t tx_bufsize() const { return 0; }
+
+    // parse any bytes from the sensor, returning true with a new reading
+    virtual bool get_reading(uint16_t &reading_cm) = 0;
+
+    // how long without a reading before the sensor has no data
+    virtual uint16_t read_timeout_ms() const { return 200; }
+
+    AP_HAL::UARTDriver *uart = nullptr;
+
+private:
+    uint8_t _serial_instance;
+    bool _uart_started;
+
+    // latest reading from the serial thread, protected by _sem
+    struct {
+        uint16_t distance_cm;
+        uint32_t time_ms;
+        bool new_reading;
+    } _reading;
+};
@@ -47,33 +47,13 @@ extern const AP_HAL::HAL& hal;
 // byte 7 (TF02 only)   TIME            Exposure time in two levels 0x03 and 0x06
 // byte 8               Checksum        Checksum byte, sum of bytes 0 to bytes 7
 
-/* 
-   The constructor also initialises the rangefinder. Note that this
-   constructor is not called until detect() returns true, so we
-   already know that we should setup the rangefinder
-*/
 AP_RangeFinder_Benewake::AP_RangeFinder_Benewake(RangeFinder::RangeFinder_State &_state,
                                                              AP_RangeFinder_Params &_params,
                                                              uint8_t serial_instance,
                                                              benewake_model_type model) :
-    AP_RangeFinder_Backend(_state, _params),
+    AP_RangeFinder_Backend_Serial(_state, _params, serial_instance),
     model_type(model)
 {
-    const AP_SerialManager &serial_manager = AP::serialmanager();
-    uart = serial_manager.find_serial(AP_SerialManager::SerialProtocol_Rangefinder, serial_instance);
-    if (uart != nullptr) {
-        uart->begin(serial_manager.find_baudrate(AP_SerialManager::SerialProtocol_Rangefinder, serial_instance));
-    }
-}
-
-/* 
-   detect if a Benewake rangefinder is connected. We'll detect by
-   trying to take a reading on Serial. If we get a result the sensor is
-   there.
-*/
-bool AP_RangeFinder_Benewake::detect(uint8_t serial_instance)
-{
-    return AP::serialmanager().find_serial(AP_SerialManager::SerialProtocol_Rangefinder, serial_instance) != nullptr;
 }
 
 // distance returned in reading_cm, signal_ok is set to true if sensor reports a strong signal
@@ -175,17 +155,3 @@ bool AP_RangeFinder_Benewake::get_reading(uint16_t &reading_cm)
     // no readings so return false
     return false;
 }
-
-/* 
-   update the state of the sensor
-*/
-void AP_RangeFinder_Benewake::update(void)
-{
-    if (get_reading(state.distance_cm)) {
-        // update range_valid state based on distance measured
-        state.last_reading_ms = AP_HAL::millis();
-        update_status();
-    } else if (AP_HAL::millis() - state.last_reading_ms > 200) {
-        set_status(RangeFinder::RangeFinder_NoData);
-    }
-}
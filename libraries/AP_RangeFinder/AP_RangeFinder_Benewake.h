@@ -1,9 +1,9 @@
 #pragma once
 
 #include "RangeFinder.h"
-#include "RangeFinder_Backend.h"
+#include "AP_RangeFinder_Backend_Serial.h"
 
-class AP_RangeFinder_Benewake : public AP_RangeFinder_Backend
+class AP_RangeFinder_Benewake : public AP_RangeFinder_Backend_Serial
 {
 
 public:
@@ -20,12 +20,6 @@ public:
                             uint8_t serial_instance,
                             benewake_model_type model);
 
-    // static detection function
-    static bool detect(uint8_t serial_instance);
-
-    // update state
-    void update(void) override;
-
 protected:
 
     virtual MAV_DISTANCE_SENSOR _get_mav_distance_sensor_type() const override {
@@ -36,9 +30,8 @@ private:
 
     // get a reading
     // distance returned in reading_cm
-    bool get_reading(uint16_t &reading_cm);
+    bool get_reading(uint16_t &reading_cm) override;
 
-    AP_HAL::UARTDriver *uart = nullptr;
     benewake_model_type model_type;
     uint8_t linebuf[10];
     uint8_t linebuf_len;
@@ -31,34 +31,6 @@ extern const AP_HAL::HAL& hal;
  */
 #define LANBAO_MAX_RANGE_CM 600
 
-/*
-   The constructor also initialises the rangefinder. Note that this
-   constructor is not called until detect() returns true, so we
-   already know that we should setup the rangefinder
-*/
-AP_RangeFinder_Lanbao::AP_RangeFinder_Lanbao(RangeFinder::RangeFinder_State &_state,
-                                             AP_RangeFinder_Params &_params,
-                                             uint8_t serial_instance) :
-    AP_RangeFinder_Backend(_state, _params)
-{
-    const AP_SerialManager &serial_manager = AP::serialmanager();
-    uart = serial_manager.find_serial(AP_SerialManager::SerialProtocol_Rangefinder, serial_instance);
-    if (uart != nullptr) {
-        // always 115200
-        uart->begin(115200);
-    }
-}
-
-/* 
-   detect if a rangefinder is connected. We'll detect by trying to
-   take a reading on Serial. If we get a result the sensor is there.
-*/
-bool AP_RangeFinder_Lanbao::detect(uint8_t serial_instance)
-{
-    return AP::serialmanager().find_serial(AP_SerialManager::SerialProtocol_Rangefinder, serial_instance) != nullptr;
-}
-
-
 // read - return last value measured by sensor
 bool AP_RangeFinder_Lanbao::get_reading(uint16_t &reading_cm)
 {
@@ -109,17 +81,3 @@ bool AP_RangeFinder_Lanbao::get_reading(uint16_t &reading_cm)
     }
     return false;
 }
-
-/* 
-   update the state of the sensor
-*/
-void AP_RangeFinder_Lanbao::update(void)
-{
-    if (get_reading(state.distance_cm)) {
-        // update range_valid state based on distance measured
-        state.last_reading_ms = AP_HAL::millis();
-        update_status();
-    } else if (AP_HAL::millis() - state.last_reading_ms > 200) {
-        set_status(RangeFinder::RangeFinder_NoData);
-    }
-}
@@ -1,22 +1,13 @@
 #pragma once
 
 #include "RangeFinder.h"
-#include "RangeFinder_Backend.h"
+#include "AP_RangeFinder_Backend_Serial.h"
 
-class AP_RangeFinder_Lanbao : public AP_RangeFinder_Backend
+class AP_RangeFinder_Lanbao : public AP_RangeFinder_Backend_Serial
 {
 
 public:
-    // constructor
-    AP_RangeFinder_Lanbao(RangeFinder::RangeFinder_State &_state,
-                          AP_RangeFinder_Params &_params,
-                          uint8_t serial_instance);
-
-    // static detection function
-    static bool detect(uint8_t serial_instance);
-
-    // update state
-    void update(void) override;
+    using AP_RangeFinder_Backend_Serial::AP_RangeFinder_Backend_Serial;
 
 protected:
 
@@ -25,10 +16,12 @@ protected:
     }
 
 private:
+    // always 115200
+    uint32_t initial_baudrate(uint8_t serial_instance) const override { return 115200; }
+
     // get a reading
-    bool get_reading(uint16_t &reading_cm);
+    bool get_reading(uint16_t &reading_cm) override;
 
-    AP_HAL::UARTDriver *uart = nullptr;
     uint8_t buf[6];
     uint8_t buf_len = 0;
 };
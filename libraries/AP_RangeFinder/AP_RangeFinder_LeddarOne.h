@@ -1,7 +1,7 @@
 #pragma once
 
 #include "RangeFinder.h"
-#include "RangeFinder_Backend.h"
+#include "AP_RangeFinder_Backend_Serial.h"
 
 // defines
 #define LEDDARONE_DEFAULT_ADDRESS 0x01
@@ -37,20 +37,11 @@ enum LeddarOne_ModbusStatus {
     LEDDARONE_MODBUS_STATE_AVAILABLE
 };
 
-class AP_RangeFinder_LeddarOne : public AP_RangeFinder_Backend
+class AP_RangeFinder_LeddarOne : public AP_RangeFinder_Backend_Serial
 {
 
 public:
-    // constructor
-    AP_RangeFinder_LeddarOne(RangeFinder::RangeFinder_State &_state,
-                             AP_RangeFinder_Params &_params,
-                             uint8_t serial_instance);
-
-    // static detection function
-    static bool detect(uint8_t serial_instance);
-
-    // update state
-    void update(void) override;
+    using AP_RangeFinder_Backend_Serial::AP_RangeFinder_Backend_Serial;
 
 protected:
 
@@ -60,7 +51,7 @@ protected:
 
 private:
     // get a reading
-    bool get_reading(uint16_t &reading_cm);
+    bool get_reading(uint16_t &reading_cm) override;
 
     // CRC16
     bool CRC16(uint8_t *aBuffer, uint8_t aLength, bool aCheck);
@@ -68,7 +59,6 @@ private:
     // parse a response message from ModBus
     LeddarOne_Status parse_response(uint8_t &number_detections);
 
-    AP_HAL::UARTDriver *uart = nullptr;
     uint32_t last_sending_request_ms;
     uint32_t last_available_ms;
 
@@ -27,33 +27,9 @@ extern const AP_HAL::HAL& hal;
 AP_RangeFinder_NMEA::AP_RangeFinder_NMEA(RangeFinder::RangeFinder_State &_state,
                                          AP_RangeFinder_Params &_params,
                                          uint8_t serial_instance) :
-    AP_RangeFinder_Backend(_state, _params),
+    AP_RangeFinder_Backend_Serial(_state, _params, serial_instance),
     _distance_m(-1.0f)
 {
-    const AP_SerialManager &serial_manager = AP::serialmanager();
-    uart = serial_manager.find_serial(AP_SerialManager::SerialProtocol_Rangefinder, serial_instance);
-    if (uart != nullptr) {
-        uart->begin(serial_manager.find_baudrate(AP_SerialManager::SerialProtocol_Rangefinder, serial_instance));
-    }
-}
-
-// detect if a NMEA rangefinder by looking to see if the user has configured it
-bool AP_RangeFinder_NMEA::detect(uint8_t serial_instance)
-{
-    return AP::serialmanager().find_serial(AP_SerialManager::SerialProtocol_Rangefinder, serial_instance) != nullptr;
-}
-
-// update the state of the sensor
-void AP_RangeFinder_NMEA::update(void)
-{
-    uint32_t now = AP_HAL::millis();
-    if (get_reading(state.distance_cm)) {
-        // update range_valid state based on distance measured
-        state.last_reading_ms = now;
-        update_status();
-    } else if ((now - state.last_reading_ms) > 3000) {
-        set_status(RangeFinder::RangeFinder_NoData);
-    }
 }
 
 // return last value measured by sensor
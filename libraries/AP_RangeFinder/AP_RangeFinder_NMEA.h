@@ -16,9 +16,9 @@
 #pragma once
 
 #include "RangeFinder.h"
-#include "RangeFinder_Backend.h"
+#include "AP_RangeFinder_Backend_Serial.h"
 
-class AP_RangeFinder_NMEA : public AP_RangeFinder_Backend
+class AP_RangeFinder_NMEA : public AP_RangeFinder_Backend_Serial
 {
 
 public:
@@ -27,12 +27,6 @@ public:
                         AP_RangeFinder_Params &_params,
                         uint8_t serial_instance);
 
-    // static detection function
-    static bool detect(uint8_t serial_instance);
-
-    // update state
-    void update(void) override;
-
 protected:
 
     virtual MAV_DISTANCE_SENSOR _get_mav_distance_sensor_type() const override {
@@ -49,7 +43,9 @@ private:
     };
 
     // get a reading
-    bool get_reading(uint16_t &reading_cm);
+    bool get_reading(uint16_t &reading_cm) override;
+
+    uint16_t read_timeout_ms() const override { return 3000; }
 
     // add a single character to the buffer and attempt to decode
     // returns true if a complete sentence was successfully decoded
@@ -60,8 +56,6 @@ private:
     // returns true if new sentence has just passed checksum test and is validated
     bool decode_latest_term();
 
-    AP_HAL::UARTDriver *uart = nullptr;     // pointer to serial uart
-
     // message decoding related members
     char _term[15];                         // buffer for the current term within the current sentence
     uint8_t _term_offset;                   // offset within the _term buffer where the next character should be placed
@@ -27,30 +27,19 @@
 
 extern const AP_HAL::HAL& hal;
 
-/*
-   The constructor also initialises the rangefinder. Note that this
-   constructor is not called until detect() returns true, so we
-   already know that we should setup the rangefinder
-*/
-AP_RangeFinder_uLanding::AP_RangeFinder_uLanding(RangeFinder::RangeFinder_State &_state,
-                                                 AP_RangeFinder_Params &_params,
-                                                 uint8_t serial_instance) :
-    AP_RangeFinder_Backend(_state, _params)
+uint32_t AP_RangeFinder_uLanding::initial_baudrate(uint8_t serial_instance) const
 {
-    uart = AP::serialmanager().find_serial(AP_SerialManager::SerialProtocol_Rangefinder, serial_instance);
-    if (uart != nullptr) {
-        uart->begin(ULANDING_BAUD, ULANDING_BUFSIZE_RX, ULANDING_BUFSIZE_TX);
-    }
+    return ULANDING_BAUD;
 }
 
-/*
-   detect if a uLanding rangefinder is connected. We'll detect by
-   trying to take a reading on Serial. If we get a result the sensor is
-   there.
-*/
-bool AP_RangeFinder_uLanding::detect(uint8_t serial_instance)
+uint16_t AP_RangeFinder_uLanding::rx_bufsize() const
+{
+    return ULANDING_BUFSIZE_RX;
+}
+
+uint16_t AP_RangeFinder_uLanding::tx_bufsize() const
 {
-    return AP::serialmanager().find_serial(AP_SerialManager::SerialProtocol_Rangefinder, serial_instance) != nullptr;
+    return ULANDING_BUFSIZE_TX;
 }
 
 /*
@@ -204,17 +193,3 @@ bool AP_RangeFinder_uLanding::get_reading(uint16_t &reading_cm)
 
     return true;
 }
-
-/*
-   update the state of the sensor
-*/
-void AP_RangeFinder_uLanding::update(void)
-{
-    if (get_reading(state.distance_cm)) {
-        state.last_reading_ms = AP_HAL::millis();
-        // update range_valid state based on distance measured
-        update_status();
-    } else if (AP_HAL::millis() - state.last_reading_ms > 200) {
-        set_status(RangeFinder::RangeFinder_NoData);
-    }
-}
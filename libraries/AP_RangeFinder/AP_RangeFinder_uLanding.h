@@ -1,22 +1,13 @@
 #pragma once
 
 #include "RangeFinder.h"
-#include "RangeFinder_Backend.h"
+#include "AP_RangeFinder_Backend_Serial.h"
 
-class AP_RangeFinder_uLanding : public AP_RangeFinder_Backend
+class AP_RangeFinder_uLanding : public AP_RangeFinder_Backend_Serial
 {
 
 public:
-    // constructor
-	AP_RangeFinder_uLanding(RangeFinder::RangeFinder_State &_state,
-                            AP_RangeFinder_Params &_params,
-                            uint8_t serial_instance);
-
-    // static detection function
-    static bool detect(uint8_t serial_instance);
-
-    // update state
-    void update(void) override;
+    using AP_RangeFinder_Backend_Serial::AP_RangeFinder_Backend_Serial;
 
 protected:
 
@@ -25,13 +16,17 @@ protected:
     }
 
 private:
+    // uLanding sets its own baudrate and buffer sizes
+    uint32_t initial_baudrate(uint8_t serial_instance) const override;
+    uint16_t rx_bufsize() const override;
+    uint16_t tx_bufsize() const override;
+
     // detect uLanding Firmware Version
     bool detect_version(void);
 
     // get a reading
-    bool get_reading(uint16_t &reading_cm);
+    bool get_reading(uint16_t &reading_cm) override;
 
-    AP_HAL::UARTDriver *uart;
     uint8_t  _linebuf[6];
     uint8_t  _linebuf_len;
     bool     _version_known;
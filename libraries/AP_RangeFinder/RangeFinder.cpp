@@ -45,6 +45,7 @@
 #include <AP_Logger/AP_Logger.h>
 #include <AP_SerialManager/AP_SerialManager.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
+#include <GCS_MAVLink/GCS.h>
 
 extern const AP_HAL::HAL &hal;
 
@@ -265,10 +266,40 @@ void RangeFinder::init(enum Rotation orientation_default)
         params[i].orientation.set_default(orientation_default);
     }
 
+    // I2C rangefinders can take a long time to probe, so they are
+    // probed by other threads while the rest are detected here. Each
+    // instance's driver goes in its own slot, so the order of the
+    // instances does not depend on which probe finishes first
+    _probe.count = 0;
     for (uint8_t i=0, serial_instance = 0; i<RANGEFINDER_MAX_INSTANCES; i++) {
+        if (RANGEFINDER_PROBE_THREADS > 0 && is_i2c_type((enum RangeFinder_Type)params[i].type.get())) {
+            _probe.instances[_probe.count++] = i;
+            continue;
+        }
         // serial_instance will be increased inside detect_instance
         // if a serial driver is loaded for this instance
-        detect_instance(i, serial_instance);
+        probe_instance(i, serial_instance);
+    }
+    if (_probe.count > 0) {
+        _probe.next = 0;
+        _probe.running = 1;
+        for (uint8_t t=0; t<MIN(_probe.count-1, RANGEFINDER_PROBE_THREADS); t++) {
+            _probe.running++;
+            if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&RangeFinder::probe_thread, void),
+                                              "rngprobe", 2048, AP_HAL::Scheduler::PRIORITY_IO, 0)) {
+                _probe.running--;
+                break;
+            }
+        }
+        // probe here as well until there are none left, then wait
+        // for the other threads to finish theirs
+        probe_thread();
+        while (_probe.running > 0) {
+            hal.scheduler->delay(1);
+        }
+    }
+
+    for (uint8_t i=0; i<RANGEFINDER_MAX_INSTANCES; i++) {
         if (drivers[i] != nullptr) {
             // we loaded a driver for this instance, so it must be
             // present (although it may not be healthy)
@@ -279,6 +310,78 @@ void RangeFinder::init(enum Rotation orientation_default)
         state[i].status = RangeFinder_NotConnected;
         state[i].range_valid_count = 0;
     }
+
+    for (uint8_t i=0; i<num_instances; i++) {
+        if (drivers[i] != nullptr && drivers[i]->uses_serial_thread()) {
+            if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&RangeFinder::serial_thread, void),
+                                              "rngfnd", 2048, AP_HAL::Scheduler::PRIORITY_UART, 0)) {
+                // read them from update() instead
+                _serial_in_update = true;
+                GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "RangeFinder: failed to create thread");
+            }
+            break;
+        }
+    }
+}
+
+/*
+  true for rangefinder types which are probed on the I2C buses
+ */
+bool RangeFinder::is_i2c_type(enum RangeFinder_Type type)
+{
+    switch (type) {
+    case RangeFinder_TYPE_PLI2C:
+    case RangeFinder_TYPE_PLI2CV3:
+    case RangeFinder_TYPE_PLI2CV3HP:
+    case RangeFinder_TYPE_MBI2C:
+    case RangeFinder_TYPE_LWI2C:
+    case RangeFinder_TYPE_TRI2C:
+    case RangeFinder_TYPE_VL53L0X:
+    case RangeFinder_TYPE_BenewakeTFminiPlus:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void RangeFinder::probe_instance(uint8_t instance, uint8_t& serial_instance)
+{
+    const uint32_t start_ms = AP_HAL::millis();
+    detect_instance(instance, serial_instance);
+    _probe_ms[instance] = MIN(AP_HAL::millis() - start_ms, uint32_t(UINT16_MAX));
+}
+
+/*
+  probe I2C instances until there are none left
+ */
+void RangeFinder::probe_thread(void)
+{
+    // I2C types don't use a serial port
+    uint8_t serial_instance = 0;
+    while (true) {
+        const uint8_t n = _probe.next++;
+        if (n >= _probe.count) {
+            break;
+        }
+        probe_instance(_probe.instances[n], serial_instance);
+    }
+    _probe.running--;
+}
+
+/*
+  read all the serial rangefinders. Their readings are passed to the
+  main loop by update()
+ */
+void RangeFinder::serial_thread(void)
+{
+    while (true) {
+        for (uint8_t i=0; i<num_instances; i++) {
+            if (drivers[i] != nullptr && drivers[i]->uses_serial_thread()) {
+                drivers[i]->update_serial();
+            }
+        }
+        hal.scheduler->delay_microseconds(2000);
+    }
 }
 
 /*
@@ -295,6 +398,9 @@ void RangeFinder::update(void)
                 state[i].range_valid_count = 0;
                 continue;
             }
+            if (_serial_in_update && drivers[i]->uses_serial_thread()) {
+                drivers[i]->update_serial();
+            }
             drivers[i]->update();
         }
     }
@@ -303,16 +409,16 @@ void RangeFinder::update(void)
 #endif
 }
 
-bool RangeFinder::_add_backend(AP_RangeFinder_Backend *backend)
+bool RangeFinder::_add_backend(AP_RangeFinder_Backend *backend, uint8_t instance)
 {
     if (!backend) {
         return false;
     }
-    if (num_instances == RANGEFINDER_MAX_INSTANCES) {
+    if (instance >= RANGEFINDER_MAX_INSTANCES) {
         AP_HAL::panic("Too many RANGERS backends");
     }
 
-    drivers[num_instances++] = backend;
+    drivers[instance] = backend;
     return true;
 }
 
@@ -327,7 +433,7 @@ void RangeFinder::detect_instance(uint8_t instance, uint8_t& serial_instance)
     case RangeFinder_TYPE_PLI2CV3:
     case RangeFinder_TYPE_PLI2CV3HP:
         FOREACH_I2C(i) {
-            if (_add_backend(AP_RangeFinder_PulsedLightLRF::detect(i, state[instance], params[instance], _type))) {
+            if (_add_backend(AP_RangeFinder_PulsedLightLRF::detect(i, state[instance], params[instance], _type), instance)) {
                 break;
             }
         }
@@ -335,7 +441,7 @@ void RangeFinder::detect_instance(uint8_t instance, uint8_t& serial_instance)
     case RangeFinder_TYPE_MBI2C:
         FOREACH_I2C(i) {
             if (_add_backend(AP_RangeFinder_MaxsonarI2CXL::detect(state[instance], params[instance],
-                                                                  hal.i2c_mgr->get_device(i, AP_RANGE_FINDER_MAXSONARI2CXL_DEFAULT_ADDR)))) {
+                                                                  hal.i2c_mgr->get_device(i, AP_RANGE_FINDER_MAXSONARI2CXL_DEFAULT_ADDR)), instance)) {
                 break;
             }
         }
@@ -348,11 +454,11 @@ void RangeFinder::detect_instance(uint8_t instance, uint8_t& serial_instance)
             }
 #ifdef HAL_RANGEFINDER_LIGHTWARE_I2C_BUS
             _add_backend(AP_RangeFinder_LightWareI2C::detect(state[instance], params[instance],
-                hal.i2c_mgr->get_device(HAL_RANGEFINDER_LIGHTWARE_I2C_BUS, params[instance].address)));
+                hal.i2c_mgr->get_device(HAL_RANGEFINDER_LIGHTWARE_I2C_BUS, params[instance].address)), instance);
 #else
             FOREACH_I2C(i) {
                 if (_add_backend(AP_RangeFinder_LightWareI2C::detect(state[instance], params[instance],
-                                                                     hal.i2c_mgr->get_device(i, params[instance].address)))) {
+                                                                     hal.i2c_mgr->get_device(i, params[instance].address)), instance)) {
                     break;
                 }
             }
@@ -363,7 +469,7 @@ void RangeFinder::detect_instance(uint8_t instance, uint8_t& serial_instance)
         if (params[instance].address) {
             FOREACH_I2C(i) {
                 if (_add_backend(AP_RangeFinder_TeraRangerI2C::detect(state[instance], params[instance],
-                                                                      hal.i2c_mgr->get_device(i, params[instance].address)))) {
+                                                                      hal.i2c_mgr->get_device(i, params[instance].address)), instance)) {
                     break;
                 }
             }
@@ -372,11 +478,11 @@ void RangeFinder::detect_instance(uint8_t instance, uint8_t& serial_instance)
     case RangeFinder_TYPE_VL53L0X:
             FOREACH_I2C(i) {
                 if (_add_backend(AP_RangeFinder_VL53L0X::detect(state[instance], params[instance],
-                                                                 hal.i2c_mgr->get_device(i, params[instance].address)))) {
+                                                                 hal.i2c_mgr->get_device(i, params[instance].address)), instance)) {
                     break;
                 }
                 if (_add_backend(AP_RangeFinder_VL53L1X::detect(state[instance], params[instance],
-                                                                hal.i2c_mgr->get_device(i, params[instance].address)))) {
+                                                                hal.i2c_mgr->get_device(i, params[instance].address)), instance)) {
                     break;
                 }
             }
@@ -384,7 +490,7 @@ void RangeFinder::detect_instance(uint8_t instance, uint8_t& serial_instance)
     case RangeFinder_TYPE_BenewakeTFminiPlus:
         FOREACH_I2C(i) {
             if (_add_backend(AP_RangeFinder_Benewake_TFMiniPlus::detect(state[instance], params[instance],
-                                                                        hal.i2c_mgr->get_device(i, params[instance].address)))) {
+                                                                        hal.i2c_mgr->get_device(i, params[instance].address)), instance)) {
                 break;
             }
         }
@@ -14,6 +14,8 @@
  */
 #pragma once
 
+#include <atomic>
+
 #include <AP_Common/AP_Common.h>
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Param/AP_Param.h>
@@ -25,6 +27,13 @@
 #define RANGEFINDER_MAX_INSTANCES 10
 #endif
 
+// number of threads probing I2C rangefinders at boot alongside the
+// main thread. Threads created by the scheduler are not freed when
+// they finish, so this is only enabled on boards with plenty of memory
+#ifndef RANGEFINDER_PROBE_THREADS
+#define RANGEFINDER_PROBE_THREADS ((HAL_MEM_CLASS >= HAL_MEM_CLASS_500) ? 2 : 0)
+#endif
+
 #define RANGEFINDER_GROUND_CLEARANCE_CM_DEFAULT 10
 #define RANGEFINDER_PREARM_ALT_MAX_CM           200
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
@@ -180,7 +189,30 @@ private:
 
     void detect_instance(uint8_t instance, uint8_t& serial_instance);
 
-    bool _add_backend(AP_RangeFinder_Backend *driver);
+    // true for types which are probed on the I2C buses
+    static bool is_i2c_type(enum RangeFinder_Type type);
+
+    // detect an instance, recording how long it took
+    void probe_instance(uint8_t instance, uint8_t& serial_instance);
+
+    // I2C instances which are probed concurrently at boot. Each
+    // probing thread claims the next one until all are done
+    void probe_thread(void);
+    struct {
+        uint8_t instances[RANGEFINDER_MAX_INSTANCES];
+        uint8_t count;
+        std::atomic<uint8_t> next;
+        std::atomic<uint8_t> running;
+    } _probe;
+    uint16_t _probe_ms[RANGEFINDER_MAX_INSTANCES];
+
+    // read serial rangefinders as their data arrives
+    void serial_thread(void);
+    // true if the serial thread could not be started, so serial
+    // rangefinders are read from update() instead
+    bool _serial_in_update;
+
+    bool _add_backend(AP_RangeFinder_Backend *driver, uint8_t instance);
 
     uint32_t _log_rfnd_bit = -1;
     void Log_RFND();
@@ -31,6 +31,11 @@ public:
     // update the state structure
     virtual void update() = 0;
 
+    // read the sensor on the rangefinder serial thread, for drivers
+    // which return true from uses_serial_thread()
+    virtual void update_serial() {}
+    virtual bool uses_serial_thread() const { return false; }
+
     virtual void handle_msg(const mavlink_message_t &msg) { return; }
 
     enum Rotation orientation() const { return (Rotation)params.orientation.get(); }
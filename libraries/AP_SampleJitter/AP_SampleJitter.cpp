@@ -0,0 +1,137 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_SampleJitter.h"
+
+#ifndef HAL_BUILD_AP_PERIPH
+#include <AP_Logger/AP_Logger.h>
+#include <GCS_MAVLink/GCS.h>
+#endif
+
+#include <stdio.h>
+
+void AP_SampleJitter::sample(uint32_t now_us)
+{
+    WITH_SEMAPHORE(_sem);
+
+    if (_last_us == 0) {
+        _last_us = now_us;
+        return;
+    }
+    const uint32_t dt = now_us - _last_us;
+    _last_us = now_us;
+
+    if (_ref_us == 0) {
+        // no previous period yet, so take the first interval
+        _ref_us = MAX(dt, 1U);
+    }
+
+    if (_count == 0 || dt < _min_us) {
+        _min_us = dt;
+    }
+    if (dt > _max_us) {
+        _max_us = dt;
+    }
+    _sum_us += dt;
+    _sum_sq_us += uint64_t(dt) * dt;
+    _count++;
+
+    // bin in tenths of the reference interval
+    const uint64_t dt10 = uint64_t(dt) * 10;
+    const uint64_t ref = _ref_us;
+    uint8_t bin;
+    if (dt10 < ref*5) {
+        bin = 0;
+    } else if (dt10 < ref*9) {
+        bin = 1;
+    } else if (dt10 <= ref*11) {
+        bin = 2;
+    } else if (dt10 <= ref*15) {
+        bin = 3;
+    } else if (dt10 <= ref*20) {
+        bin = 4;
+    } else {
+        bin = 5;
+    }
+    if (_histogram[bin] < UINT16_MAX) {
+        _histogram[bin]++;
+    }
+}
+
+bool AP_SampleJitter::take(Stats &stats)
+{
+    WITH_SEMAPHORE(_sem);
+
+    if (_count == 0) {
+        return false;
+    }
+
+    stats.count = _count;
+    stats.min_us = _min_us;
+    stats.max_us = _max_us;
+    stats.mean_us = float(_sum_us) / _count;
+    // n*sum(dt^2) - sum(dt)^2 is exact in integers, and stays well
+    // inside 64 bits for the periods of a second or so used here
+    const uint64_t n_var = _count * _sum_sq_us - _sum_us * _sum_us;
+    stats.sd_us = sqrtf(float(n_var)) / _count;
+    memcpy(stats.histogram, _histogram, sizeof(stats.histogram));
+
+    _ref_us = MAX(uint32_t(_sum_us / _count), 1U);
+    _count = 0;
+    _min_us = 0;
+    _max_us = 0;
+    _sum_us = 0;
+    _sum_sq_us = 0;
+    memset(_histogram, 0, sizeof(_histogram));
+
+    return true;
+}
+
+void AP_SampleJitter::report(SensorType type, uint8_t instance)
+{
+    Stats stats;
+    if (!take(stats)) {
+        return;
+    }
+
+#ifndef HAL_BUILD_AP_PERIPH
+    AP_Logger *logger = AP_Logger::get_singleton();
+    if (logger != nullptr && logger->logging_started()) {
+        const struct log_SampleJitter pkt {
+            LOG_PACKET_HEADER_INIT(LOG_SAMPLE_JITTER_MSG),
+            time_us  : AP_HAL::micros64(),
+            type     : uint8_t(type),
+            instance : instance,
+            count    : stats.count,
+            min_us   : stats.min_us,
+            max_us   : stats.max_us,
+            mean_us  : stats.mean_us,
+            sd_us    : stats.sd_us,
+            h0       : stats.histogram[0],
+            h1       : stats.histogram[1],
+            h2       : stats.histogram[2],
+            h3       : stats.histogram[3],
+            h4       : stats.histogram[4],
+            h5       : stats.histogram[5],
+        };
+        logger->WriteBlock(&pkt, sizeof(pkt));
+    }
+
+    static const char *prefix[] { "JGYR", "JMAG", "JBAR" };
+    char name[10];
+    snprintf(name, sizeof(name), "%s%u", prefix[uint8_t(type)], unsigned(instance));
+    gcs().send_named_float(name, stats.sd_us);
+#endif
+}
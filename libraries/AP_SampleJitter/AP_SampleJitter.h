@@ -0,0 +1,75 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  statistics on the interval between samples from a sensor, so that
+  irregular arrival caused by an overloaded bus can be seen directly.
+
+  A sensor backend calls sample() as each sample arrives, from any
+  thread. The frontend calls report() at a low rate from the main
+  thread, which logs the statistics gathered since the last report,
+  sends the interval standard deviation to the GCS and starts a new
+  period.
+ */
+
+#include <AP_HAL/AP_HAL.h>
+
+class AP_SampleJitter
+{
+public:
+    enum class SensorType : uint8_t {
+        GYRO    = 0,
+        COMPASS = 1,
+        BARO    = 2,
+    };
+
+    // histogram bins of the interval as a proportion of the previous
+    // period's mean: <50%, 50-90%, 90-110%, 110-150%, 150-200%, >200%
+    static const uint8_t NUM_BINS = 6;
+
+    struct Stats {
+        uint32_t count;     // intervals in the period
+        uint32_t min_us;
+        uint32_t max_us;
+        float mean_us;
+        float sd_us;        // standard deviation
+        uint16_t histogram[NUM_BINS];
+    };
+
+    // record a sample arriving at time now_us
+    void sample(uint32_t now_us);
+
+    // return the statistics since the last call and start a new
+    // period. Returns false if there were no intervals
+    bool take(Stats &stats);
+
+    // take the statistics, then log them and send them to the GCS
+    void report(SensorType type, uint8_t instance);
+
+private:
+    HAL_Semaphore _sem;
+
+    uint32_t _last_us = 0;
+    // mean interval of the previous period, used for the histogram
+    uint32_t _ref_us = 0;
+
+    uint32_t _count = 0;
+    uint32_t _min_us = 0;
+    uint32_t _max_us = 0;
+    uint64_t _sum_us = 0;
+    uint64_t _sum_sq_us = 0;
+    uint16_t _histogram[NUM_BINS] {};
+};
@@ -0,0 +1,73 @@
+#include <AP_gtest.h>
+
+#include <AP_SampleJitter/AP_SampleJitter.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+TEST(SampleJitterTest, NoSamples)
+{
+    AP_SampleJitter jitter;
+    AP_SampleJitter::Stats stats;
+
+    EXPECT_FALSE(jitter.take(stats));
+    // a single sample has no interval
+    jitter.sample(1000);
+    EXPECT_FALSE(jitter.take(stats));
+}
+
+TEST(SampleJitterTest, Stats)
+{
+    AP_SampleJitter jitter;
+    AP_SampleJitter::Stats stats;
+
+    // intervals of 900, 1100, 900, 1100 ...
+    uint32_t t = 5000;
+    jitter.sample(t);
+    for (uint8_t i = 0; i < 100; i++) {
+        t += (i & 1) ? 1100 : 900;
+        jitter.sample(t);
+    }
+    ASSERT_TRUE(jitter.take(stats));
+    EXPECT_EQ(100U, stats.count);
+    EXPECT_EQ(900U, stats.min_us);
+    EXPECT_EQ(1100U, stats.max_us);
+    EXPECT_FLOAT_EQ(1000.0f, stats.mean_us);
+    EXPECT_FLOAT_EQ(100.0f, stats.sd_us);
+
+    // a new period starts empty
+    EXPECT_FALSE(jitter.take(stats));
+}
+
+TEST(SampleJitterTest, Histogram)
+{
+    AP_SampleJitter jitter;
+    AP_SampleJitter::Stats stats;
+
+    // establish a 1000us reference interval, wrapping the 32 bit
+    // clock on the way
+    uint32_t t = 0xFFFFF000;
+    jitter.sample(t);
+    for (uint8_t i = 0; i < 10; i++) {
+        t += 1000;
+        jitter.sample(t);
+    }
+    ASSERT_TRUE(jitter.take(stats));
+    EXPECT_EQ(10U, stats.histogram[2]);
+
+    // one interval in each bin, and another long one
+    const uint32_t intervals[] = { 100, 700, 1000, 1300, 1800, 5000, 10000 };
+    for (uint32_t dt : intervals) {
+        t += dt;
+        jitter.sample(t);
+    }
+    ASSERT_TRUE(jitter.take(stats));
+    EXPECT_EQ(7U, stats.count);
+    for (uint8_t i = 0; i < AP_SampleJitter::NUM_BINS-1; i++) {
+        EXPECT_EQ(1U, stats.histogram[i]);
+    }
+    EXPECT_EQ(2U, stats.histogram[AP_SampleJitter::NUM_BINS-1]);
+    EXPECT_EQ(100U, stats.min_us);
+    EXPECT_EQ(10000U, stats.max_us);
+}
+
+AP_GTEST_MAIN()
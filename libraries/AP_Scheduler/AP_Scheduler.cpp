@@ -26,6 +26,7 @@
 #include <AP_Logger/AP_Logger.h>
 #include <AP_InertialSensor/AP_InertialSensor.h>
 #include <AP_InternalError/AP_InternalError.h>
+#include <GCS_MAVLink/GCS.h>
 
 // Gecko Added
 #include <vector>
@@ -73,6 +74,13 @@ const AP_Param::GroupInfo AP_Scheduler::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("LOOP_RATE",  1, AP_Scheduler, _loop_rate_hz, SCHEDULER_DEFAULT_LOOP_RATE),
 
+    // @Param: OPTIONS
+    // @DisplayName: Scheduler options
+    // @Description: Scheduler options bitmask. When RecordTaskHistograms is set the scheduler keeps a log2 histogram of the run time and start slip of every task, along with a count of the times each task could not be run while already four times overdue. The histograms are logged as SCHD messages alongside PM messages and can be requested over MAVLink as SCHED_TASK_HISTOGRAM messages. When DeadlineScheduling is set, due tasks are run most overdue first and a task is run when its learned run time, rather than its fixed budget, fits in the time left in the loop. When ThreadedTaskGroups is set, tasks tagged with a thread group other than the main one run on a worker thread per group, pinned to a CPU core other than the first where the board supports it. This is experimental and only has an effect on boards with thread support. This option only takes effect on restart.
+    // @Bitmask: 0:RecordTaskHistograms,1:DeadlineScheduling,2:ThreadedTaskGroups
+    // @User: Advanced
+    AP_GROUPINFO("OPTIONS",  2, AP_Scheduler, _options, 0),
+
     AP_GROUPEND
 };
 
@@ -152,9 +160,6 @@ static void fill_nanf_stack(void)
  */
 void AP_Scheduler::run(uint32_t time_available)
 {
-    uint32_t run_started_usec = AP_HAL::micros();
-    uint32_t now = run_started_usec;
-
     if (_debug > 1 && _perf_counters == nullptr) {
         _perf_counters = new AP_HAL::Util::perf_counter_t[_num_tasks];
         if (_perf_counters != nullptr) {
@@ -163,88 +168,327 @@ void AP_Scheduler::run(uint32_t time_available)
             }
         }
     }
-    
+
+    _record_task_info = option_is_set(Options::RECORD_TASK_HISTOGRAMS) &&
+        perf_info.allocate_task_info(_num_tasks);
+
+    if (!_group_threads_started) {
+        _group_threads_started = true;
+        if (option_is_set(Options::THREADED_TASK_GROUPS)) {
+            start_group_threads();
+        }
+    }
+
+    if (option_is_set(Options::DEADLINE_SCHEDULING) && allocate_deadline_state()) {
+        time_available = run_deadline_order(time_available);
+    } else {
+        time_available = run_table_order(time_available);
+    }
+
+    // update number of spare microseconds
+    _spare_micros += time_available;
+
+    _spare_ticks++;
+    if (_spare_ticks == 32) {
+        _spare_ticks /= 2;
+        _spare_micros /= 2;
+    }
+}
+
+/*
+  run due tasks in task table order, skipping any task whose
+  max_time_micros does not fit in the remaining time. Returns the
+  time left over
+ */
+uint32_t AP_Scheduler::run_table_order(uint32_t time_available)
+{
     for (uint8_t i=0; i<_num_tasks; i++) {
         uint32_t dt = _tick_counter - _last_run[i];
-        uint32_t interval_ticks = _loop_rate_hz / _tasks[i].rate_hz;
-        if (interval_ticks < 1) {
-            interval_ticks = 1;
-        }
-        if (dt < interval_ticks) {
+        uint32_t interval_ticks = task_interval_ticks(i);
+        if (dt < interval_ticks || !runs_in_main_loop(i)) {
             // this task is not yet scheduled to run again
             continue;
         }
         // this task is due to run. Do we have enough time to run it?
-        _task_time_allowed = _tasks[i].max_time_micros;
-
-        if (dt >= interval_ticks*2) {
-            // we've slipped a whole run of this task!
-            debug(2, "Scheduler slip task[%u-%s] (%u/%u/%u)\n",
-                  (unsigned)i,
-                  _tasks[i].name,
-                  (unsigned)dt,
-                  (unsigned)interval_ticks,
-                  (unsigned)_task_time_allowed);
-        }
-
-        if (dt >= interval_ticks*max_task_slowdown) {
-            // we are going beyond the maximum slowdown factor for a
-            // task. This will trigger increasing the time budget
-            task_not_achieved++;
-        }
+        check_task_slip(i, dt, interval_ticks);
 
-        if (_task_time_allowed > time_available) {
+        if (_tasks[i].max_time_micros > time_available) {
             // not enough time to run this task.  Continue loop -
             // maybe another task will fit into time remaining
+            check_task_starved(i, dt, interval_ticks);
             continue;
         }
 
-        // run it
-        _task_time_started = now;
-        hal.util->persistent_data.scheduler_task = i;
-        if (_debug > 1 && _perf_counters && _perf_counters[i]) {
-            hal.util->perf_begin(_perf_counters[i]);
+        const uint32_t time_taken = run_task(i, dt, interval_ticks);
+        if (time_taken >= time_available) {
+            return 0;
         }
-#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
-        fill_nanf_stack();
-#endif
-        _tasks[i].function();
-        if (_debug > 1 && _perf_counters && _perf_counters[i]) {
-            hal.util->perf_end(_perf_counters[i]);
+        time_available -= time_taken;
+    }
+    return time_available;
+}
+
+/*
+  run due tasks most overdue first. Lateness is measured relative to
+  each task's own interval, so a 1Hz task that has missed a run
+  comes before a 400Hz task that is on time. Tasks that are equally
+  late keep their task table order. Whether a task fits is decided
+  using its learned run time rather than max_time_micros, so tasks
+  with generous budgets are not skipped forever on a busy
+  CPU. Returns the time left over
+ */
+uint32_t AP_Scheduler::run_deadline_order(uint32_t time_available)
+{
+    uint8_t num_due = 0;
+    for (uint8_t i=0; i<_num_tasks; i++) {
+        const uint32_t dt = _tick_counter - _last_run[i];
+        const uint32_t interval_ticks = task_interval_ticks(i);
+        if (dt < interval_ticks || !runs_in_main_loop(i)) {
+            continue;
         }
-        hal.util->persistent_data.scheduler_task = -1;
+        check_task_slip(i, dt, interval_ticks);
+
+        // lateness in units of 1/16 of the task interval
+        const uint16_t lateness = MIN((dt * 16) / interval_ticks, (uint32_t)UINT16_MAX);
+
+        // insertion sort, most late first. Ties stay in table order
+        uint8_t j = num_due++;
+        while (j > 0 && _due_tasks[j-1].lateness < lateness) {
+            _due_tasks[j] = _due_tasks[j-1];
+            j--;
+        }
+        _due_tasks[j].task = i;
+        _due_tasks[j].lateness = lateness;
+    }
 
-        // record the tick counter when we ran. This drives
-        // when we next run the event
-        _last_run[i] = _tick_counter;
-
-        // work out how long the event actually took
-        now = AP_HAL::micros();
-        uint32_t time_taken = now - _task_time_started;
-
-        if (time_taken > _task_time_allowed) {
-            // the event overran!
-            debug(3, "Scheduler overrun task[%u-%s] (%u/%u)\n",
-                  (unsigned)i,
-                  _tasks[i].name,
-                  (unsigned)time_taken,
-                  (unsigned)_task_time_allowed);
+    for (uint8_t n=0; n<num_due; n++) {
+        const uint8_t i = _due_tasks[n].task;
+        const uint32_t dt = _tick_counter - _last_run[i];
+        const uint32_t interval_ticks = task_interval_ticks(i);
+
+        if (_task_estimate_us[i] > time_available) {
+            check_task_starved(i, dt, interval_ticks);
+            continue;
         }
+
+        const uint32_t time_taken = run_task(i, dt, interval_ticks);
         if (time_taken >= time_available) {
-            time_available = 0;
-            break;
+            return 0;
         }
         time_available -= time_taken;
     }
+    return time_available;
+}
 
-    // update number of spare microseconds
-    _spare_micros += time_available;
+// return the number of ticks between runs of task i
+uint32_t AP_Scheduler::task_interval_ticks(uint8_t i) const
+{
+    const uint32_t interval_ticks = _loop_rate_hz / _tasks[i].rate_hz;
+    if (interval_ticks < 1) {
+        return 1;
+    }
+    return interval_ticks;
+}
 
-    _spare_ticks++;
-    if (_spare_ticks == 32) {
-        _spare_ticks /= 2;
-        _spare_micros /= 2;
+// checks done for every task that is due to run
+void AP_Scheduler::check_task_slip(uint8_t i, uint32_t dt, uint32_t interval_ticks)
+{
+    if (dt >= interval_ticks*2) {
+        // we've slipped a whole run of this task!
+        debug(2, "Scheduler slip task[%u-%s] (%u/%u/%u)\n",
+              (unsigned)i,
+              _tasks[i].name,
+              (unsigned)dt,
+              (unsigned)interval_ticks,
+              (unsigned)_tasks[i].max_time_micros);
+    }
+
+    if (dt >= interval_ticks*max_task_slowdown) {
+        // we are going beyond the maximum slowdown factor for a
+        // task. This will trigger increasing the time budget
+        task_not_achieved++;
+    }
+}
+
+// count a due task that did not fit in the time available while
+// already beyond the maximum slowdown factor
+void AP_Scheduler::check_task_starved(uint8_t i, uint32_t dt, uint32_t interval_ticks)
+{
+    if (dt >= interval_ticks*max_task_slowdown) {
+        _starvation_count++;
+        if (_record_task_info) {
+            perf_info.task_starved(i);
+        }
+    }
+}
+
+/*
+  allocate the state used for deadline scheduling. Returns false if
+  allocation failed, in which case table order scheduling is used
+ */
+bool AP_Scheduler::allocate_deadline_state()
+{
+    if (_task_estimate_us != nullptr && _due_tasks != nullptr) {
+        return true;
     }
+    if (_task_estimate_us == nullptr) {
+        _task_estimate_us = new uint16_t[_num_tasks];
+        if (_task_estimate_us == nullptr) {
+            return false;
+        }
+        // start from the task table budgets and learn from there
+        for (uint8_t i=0; i<_num_tasks; i++) {
+            _task_estimate_us[i] = _tasks[i].max_time_micros;
+        }
+    }
+    if (_due_tasks == nullptr) {
+        _due_tasks = new DueTask[_num_tasks];
+    }
+    return _due_tasks != nullptr;
+}
+
+/*
+  start a worker thread for each thread group that has tasks. Groups
+  whose thread can't be created stay in the main loop
+ */
+void AP_Scheduler::start_group_threads(void)
+{
+    _last_run_us = new uint32_t[_num_tasks];
+    if (_last_run_us == nullptr) {
+        return;
+    }
+    const uint32_t now = AP_HAL::micros();
+    for (uint8_t i=0; i<_num_tasks; i++) {
+        _last_run_us[i] = now;
+    }
+
+    static const char *names[THREAD_GROUP_COUNT] = { "sched", "sched_tlm", "sched_log", "sched_bg" };
+    for (uint8_t g=THREAD_GROUP_MAIN+1; g<THREAD_GROUP_COUNT; g++) {
+        bool have_tasks = false;
+        for (uint8_t i=0; i<_num_tasks; i++) {
+            if (_tasks[i].thread_group == g) {
+                have_tasks = true;
+                break;
+            }
+        }
+        if (!have_tasks) {
+            continue;
+        }
+        GroupThread &t = _group_threads[g];
+        t.scheduler = this;
+        t.group = g;
+        t.running = true;
+        if (!hal.scheduler->thread_create(FUNCTOR_BIND(&t, &GroupThread::thread_main, void),
+                                          names[g], 8192, AP_HAL::Scheduler::PRIORITY_IO, 0)) {
+            t.running = false;
+            gcs().send_text(MAV_SEVERITY_WARNING, "Scheduler: %s thread failed", names[g]);
+        }
+    }
+}
+
+void AP_Scheduler::GroupThread::thread_main(void)
+{
+    // keep the first core for the main loop where we can
+    const uint8_t num_cores = hal.scheduler->get_num_cores();
+    if (num_cores > 1) {
+        hal.scheduler->set_thread_affinity(1 + (group - 1) % (num_cores - 1));
+    }
+    while (true) {
+        const uint32_t sleep_us = scheduler->run_group_tasks(group);
+        hal.scheduler->delay_microseconds(constrain_int32(sleep_us, 50, 10000));
+    }
+}
+
+/*
+  run the tasks of one group which are due, using elapsed time rather
+  than main loop ticks. Returns the time until the next task is due
+ */
+uint32_t AP_Scheduler::run_group_tasks(uint8_t group)
+{
+    uint32_t next_due_us = UINT32_MAX;
+    for (uint8_t i=0; i<_num_tasks; i++) {
+        const Task &task = _tasks[i];
+        if (task.thread_group != group) {
+            continue;
+        }
+        const uint32_t interval_us = 1000000UL / task.rate_hz;
+        uint32_t now = AP_HAL::micros();
+        uint32_t elapsed = now - _last_run_us[i];
+        if (elapsed < interval_us) {
+            next_due_us = MIN(next_due_us, interval_us - elapsed);
+            continue;
+        }
+        _last_run_us[i] = now;
+        hal.util->trace(AP_HAL::Util::TRACE_TASK_BEGIN, task.name, i);
+        task.function();
+        hal.util->trace(AP_HAL::Util::TRACE_TASK_END, task.name, i);
+        const uint32_t time_taken = AP_HAL::micros() - now;
+        if (_record_task_info) {
+            // slip is reported in main loop ticks for consistency
+            const uint32_t slip_us = elapsed - interval_us;
+            perf_info.update_task_info(i, time_taken, slip_us / get_loop_period_us());
+        }
+        next_due_us = MIN(next_due_us, interval_us);
+    }
+    return next_due_us;
+}
+
+/*
+  run task i, returning the time it took in microseconds
+ */
+uint32_t AP_Scheduler::run_task(uint8_t i, uint32_t dt, uint32_t interval_ticks)
+{
+    _task_time_allowed = _tasks[i].max_time_micros;
+
+    // run it
+    _task_time_started = AP_HAL::micros();
+    hal.util->persistent_data.scheduler_task = i;
+    if (_debug > 1 && _perf_counters && _perf_counters[i]) {
+        hal.util->perf_begin(_perf_counters[i]);
+    }
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+    fill_nanf_stack();
+#endif
+    hal.util->trace(AP_HAL::Util::TRACE_TASK_BEGIN, _tasks[i].name, i);
+    _tasks[i].function();
+    hal.util->trace(AP_HAL::Util::TRACE_TASK_END, _tasks[i].name, i);
+    if (_debug > 1 && _perf_counters && _perf_counters[i]) {
+        hal.util->perf_end(_perf_counters[i]);
+    }
+    hal.util->persistent_data.scheduler_task = -1;
+
+    // record the tick counter when we ran. This drives
+    // when we next run the event
+    _last_run[i] = _tick_counter;
+
+    // work out how long the event actually took
+    const uint32_t time_taken = AP_HAL::micros() - _task_time_started;
+
+    if (_record_task_info) {
+        perf_info.update_task_info(i, time_taken, dt - interval_ticks);
+    }
+
+    if (_task_estimate_us != nullptr) {
+        // follow increases in run time quickly and decay slowly, so
+        // occasional slow runs are still allowed for
+        uint16_t &estimate = _task_estimate_us[i];
+        const uint16_t taken = MIN(time_taken, (uint32_t)UINT16_MAX);
+        if (taken > estimate) {
+            estimate += (taken - estimate + 1) / 2;
+        } else {
+            estimate -= (estimate - taken) / 16;
+        }
+    }
+
+    if (time_taken > _task_time_allowed) {
+        // the event overran!
+        debug(3, "Scheduler overrun task[%u-%s] (%u/%u)\n",
+              (unsigned)i,
+              _tasks[i].name,
+              (unsigned)time_taken,
+              (unsigned)_task_time_allowed);
+    }
+    return time_taken;
 }
 
 /*
@@ -365,6 +609,9 @@ void AP_Scheduler::update_logging()
     if (_log_performance_bit != (uint32_t)-1 &&
         AP::logger().should_log(_log_performance_bit)) {
         Log_Write_Performance();
+        Log_Write_Task_Histograms();
+        Log_Write_DMA_Stats();
+        Log_Write_Thread_Stats();
     }
     perf_info.set_loop_rate(get_loop_rate_hz());
     perf_info.reset();
@@ -392,6 +639,76 @@ void AP_Scheduler::Log_Write_Performance()
     AP::logger().WriteCriticalBlock(&pkt, sizeof(pkt));
 }
 
+// Write a summary of each task's run time and slip histograms
+void AP_Scheduler::Log_Write_Task_Histograms()
+{
+    const uint64_t now_us = AP_HAL::micros64();
+    for (uint8_t i=0; i<_num_tasks; i++) {
+        const AP::PerfInfo::TaskInfo *ti = perf_info.get_task_info(i);
+        if (ti == nullptr) {
+            return;
+        }
+        struct log_SchedTask pkt = {
+            LOG_PACKET_HEADER_INIT(LOG_SCHED_TASK_MSG),
+            time_us     : now_us,
+            task        : i,
+            run_count   : ti->run_count,
+            p50         : AP::PerfInfo::histogram_percentile(ti->time_hist, 500),
+            p90         : AP::PerfInfo::histogram_percentile(ti->time_hist, 900),
+            p99         : AP::PerfInfo::histogram_percentile(ti->time_hist, 990),
+            p999        : AP::PerfInfo::histogram_percentile(ti->time_hist, 999),
+            max_time    : ti->max_time_us,
+            slip_p99    : (uint16_t)AP::PerfInfo::histogram_percentile(ti->slip_hist, 990),
+            slip_p999   : (uint16_t)AP::PerfInfo::histogram_percentile(ti->slip_hist, 999),
+            starved     : ti->starved,
+        };
+        AP::logger().WriteBlock(&pkt, sizeof(pkt));
+    }
+}
+
+// Write the lock statistics of each shared DMA stream that has been used
+void AP_Scheduler::Log_Write_DMA_Stats()
+{
+    const uint64_t now_us = AP_HAL::micros64();
+    AP_HAL::Util::DMAStats stats;
+    for (uint8_t i=0; hal.util->get_dma_stats(i, stats); i++) {
+        if (stats.lock_count == 0) {
+            continue;
+        }
+        struct log_DMAStats pkt = {
+            LOG_PACKET_HEADER_INIT(LOG_DMA_STATS_MSG),
+            time_us       : now_us,
+            stream        : i,
+            lock_count    : stats.lock_count,
+            contended     : stats.contended_count,
+            nonblock_fail : stats.nonblock_fail_count,
+            p99           : AP::PerfInfo::histogram_percentile(stats.wait_hist, 990),
+            p999          : AP::PerfInfo::histogram_percentile(stats.wait_hist, 999),
+            max_wait      : stats.max_wait_us,
+        };
+        AP::logger().WriteBlock(&pkt, sizeof(pkt));
+    }
+}
+
+// Write the CPU load and lowest free stack of each thread
+void AP_Scheduler::Log_Write_Thread_Stats()
+{
+    const uint64_t now_us = AP_HAL::micros64();
+    AP_HAL::Util::ThreadStats stats;
+    for (uint8_t i=0; hal.util->get_thread_stats(i, stats); i++) {
+        struct log_ThreadStats pkt = {
+            LOG_PACKET_HEADER_INIT(LOG_THREAD_STATS_MSG),
+            time_us    : now_us,
+            thread     : i,
+            name       : {},
+            load       : stats.load,
+            stack_free : stats.stack_free,
+        };
+        memcpy(pkt.name, stats.name, sizeof(pkt.name));
+        AP::logger().WriteBlock(&pkt, sizeof(pkt));
+    }
+}
+
 namespace AP {
 
 AP_Scheduler &scheduler()
@@ -30,11 +30,22 @@
 /*
   useful macro for creating scheduler task table
  */
-#define SCHED_TASK_CLASS(classname, classptr, func, _rate_hz, _max_time_micros) { \
+#define SCHED_TASK_CLASS(classname, classptr, func, _rate_hz, _max_time_micros) \
+    SCHED_TASK_CLASS_GROUP(classname, classptr, func, _rate_hz, _max_time_micros, AP_Scheduler::THREAD_GROUP_MAIN)
+
+/*
+  as SCHED_TASK_CLASS, but tagging the task with a thread group. When
+  threaded task groups are enabled in SCHED_OPTIONS on a HAL that can
+  create threads, tasks outside THREAD_GROUP_MAIN are run on a worker
+  thread per group instead of the main loop, so they must be safe to
+  run concurrently with the main loop
+ */
+#define SCHED_TASK_CLASS_GROUP(classname, classptr, func, _rate_hz, _max_time_micros, _group) { \
     .function = FUNCTOR_BIND(classptr, &classname::func, void),\
     AP_SCHEDULER_NAME_INITIALIZER(func)\
     .rate_hz = _rate_hz,\
-    .max_time_micros = _max_time_micros\
+    .max_time_micros = _max_time_micros,\
+    .thread_group = _group\
 }
 
 /*
@@ -67,11 +78,21 @@ public:
 
     FUNCTOR_TYPEDEF(task_fn_t, void);
 
+    // groups of tasks which may be run on their own thread
+    enum ThreadGroup : uint8_t {
+        THREAD_GROUP_MAIN = 0,
+        THREAD_GROUP_TELEMETRY,
+        THREAD_GROUP_LOGGING,
+        THREAD_GROUP_BACKGROUND,
+        THREAD_GROUP_COUNT
+    };
+
     struct Task {
         task_fn_t function;
         const char *name;
         float rate_hz;
         uint16_t max_time_micros;
+        uint8_t thread_group;
     };
 
     // initialise scheduler
@@ -87,6 +108,15 @@ public:
     // write out PERF message to logger
     void Log_Write_Performance();
 
+    // write out per-task histogram summary messages to logger
+    void Log_Write_Task_Histograms();
+
+    // write out shared DMA stream lock statistics to logger
+    void Log_Write_DMA_Stats();
+
+    // write out per-thread CPU load and free stack to logger
+    void Log_Write_Thread_Stats();
+
     // call when one tick has passed
     void tick(void);
 
@@ -104,6 +134,25 @@ public:
     // return debug parameter
     uint8_t debug_flags(void) { return _debug; }
 
+    // options bits
+    enum class Options : uint8_t {
+        RECORD_TASK_HISTOGRAMS = 1U << 0,
+        DEADLINE_SCHEDULING    = 1U << 1,
+        THREADED_TASK_GROUPS   = 1U << 2,
+    };
+    bool option_is_set(Options option) const {
+        return (_options & uint8_t(option)) != 0;
+    }
+
+    // task table accessors, mainly for reporting task statistics
+    uint8_t get_num_tasks(void) const { return _num_tasks; }
+    const char *get_task_name(uint8_t i) const {
+        return i < _num_tasks ? _tasks[i].name : nullptr;
+    }
+    uint16_t get_task_max_time_micros(uint8_t i) const {
+        return i < _num_tasks ? _tasks[i].max_time_micros : 0;
+    }
+
     // return load average, as a number between 0 and 1. 1 means
     // 100% load. Calculated from how much spare time we have at the
     // end of a run()
@@ -145,6 +194,12 @@ public:
         return extra_loop_us;
     }
 
+    // get the number of times a task has been skipped while already
+    // beyond the maximum slowdown factor
+    uint32_t get_starvation_count(void) const {
+        return _starvation_count;
+    }
+
     static const struct AP_Param::GroupInfo var_info[];
 
     // loop performance monitoring:
@@ -160,6 +215,9 @@ private:
     // overall scheduling rate in Hz
     AP_Int16 _loop_rate_hz;
 
+    // scheduler options bitmask
+    AP_Int8 _options;
+
     // loop rate in Hz as set at startup
     AP_Int16 _active_loop_rate_hz;
     
@@ -185,6 +243,70 @@ private:
     // number of microseconds allowed for the current task
     uint32_t _task_time_allowed;
 
+    // true when per-task statistics are being recorded
+    bool _record_task_info;
+
+    // run all due tasks in the order given by the task table
+    uint32_t run_table_order(uint32_t time_available);
+
+    // run due tasks most overdue first, using learned run time
+    // estimates to decide if a task fits in the time available
+    uint32_t run_deadline_order(uint32_t time_available);
+    bool allocate_deadline_state();
+
+    // checks done for every due task before deciding to run it
+    void check_task_slip(uint8_t i, uint32_t dt, uint32_t interval_ticks);
+    void check_task_starved(uint8_t i, uint32_t dt, uint32_t interval_ticks);
+
+    // run one task and return how long it took in microseconds
+    uint32_t run_task(uint8_t i, uint32_t dt, uint32_t interval_ticks);
+
+    // return the number of ticks between runs of task i
+    uint32_t task_interval_ticks(uint8_t i) const;
+
+    // true if task i should be run from the main loop
+    bool runs_in_main_loop(uint8_t i) const {
+        return _tasks[i].thread_group == THREAD_GROUP_MAIN ||
+            !_group_threads[_tasks[i].thread_group].running;
+    }
+
+    /*
+      worker thread running the tasks of one thread group at their
+      own rates, independently of the main loop tick
+     */
+    class GroupThread {
+    public:
+        void thread_main(void);
+
+        AP_Scheduler *scheduler;
+        uint8_t group;
+        bool running;
+    };
+    GroupThread _group_threads[THREAD_GROUP_COUNT];
+    bool _group_threads_started;
+
+    // start worker threads for the thread groups in use
+    void start_group_threads(void);
+
+    // run due tasks of one group, returning microseconds until the
+    // next task of the group is due
+    uint32_t run_group_tasks(uint8_t group);
+
+    // time each task last ran on its group thread
+    uint32_t *_last_run_us;
+
+    // learned per-task run time for deadline scheduling, in microseconds
+    uint16_t *_task_estimate_us;
+
+    // working list of due tasks for deadline scheduling
+    struct DueTask {
+        uint8_t task;
+        uint16_t lateness;
+    } *_due_tasks;
+
+    // number of times a starved task could not be fitted into a run
+    uint32_t _starvation_count;
+
     // the time in microseconds when the task started
     uint32_t _task_time_started;
 
@@ -115,14 +115,109 @@ float AP::PerfInfo::get_filtered_time() const
 void AP::PerfInfo::update_logging()
 {
     gcs().send_text(MAV_SEVERITY_WARNING,
-                    "PERF: %u/%u [%lu:%lu] F=%uHz sd=%lu Ex=%lu",
+                    "PERF: %u/%u [%lu:%lu] F=%uHz sd=%lu Ex=%lu St=%lu",
                     (unsigned)get_num_long_running(),
                     (unsigned)get_num_loops(),
                     (unsigned long)get_max_time(),
                     (unsigned long)get_min_time(),
                     (unsigned)(0.5+(1.0f/get_filtered_time())),
                     (unsigned long)get_stddev_time(),
-                    (unsigned long)AP::scheduler().get_extra_loop_us());
+                    (unsigned long)AP::scheduler().get_extra_loop_us(),
+                    (unsigned long)AP::scheduler().get_starvation_count());
+}
+
+// allocate_task_info - allocate statistics for each scheduler task
+bool AP::PerfInfo::allocate_task_info(uint8_t num_tasks)
+{
+    if (_task_info != nullptr) {
+        return true;
+    }
+    _task_info = new TaskInfo[num_tasks];
+    if (_task_info == nullptr) {
+        return false;
+    }
+    memset(_task_info, 0, sizeof(TaskInfo) * num_tasks);
+    _num_tasks = num_tasks;
+    return true;
+}
+
+// update_task_info - record the run time and start slip of one task run
+void AP::PerfInfo::update_task_info(uint8_t task_index, uint32_t time_us, uint32_t slip_ticks)
+{
+    if (_task_info == nullptr || task_index >= _num_tasks) {
+        return;
+    }
+    TaskInfo &ti = _task_info[task_index];
+    histogram_add(ti.time_hist, time_us);
+    histogram_add(ti.slip_hist, slip_ticks);
+    if (time_us > ti.max_time_us) {
+        ti.max_time_us = time_us;
+    }
+    ti.run_count++;
+}
+
+// task_starved - record that a far overdue task could not be run
+void AP::PerfInfo::task_starved(uint8_t task_index)
+{
+    if (_task_info == nullptr || task_index >= _num_tasks) {
+        return;
+    }
+    _task_info[task_index].starved++;
+}
+
+// get_task_info - return statistics for a task, or nullptr if not allocated
+const AP::PerfInfo::TaskInfo *AP::PerfInfo::get_task_info(uint8_t task_index) const
+{
+    if (_task_info == nullptr || task_index >= _num_tasks) {
+        return nullptr;
+    }
+    return &_task_info[task_index];
+}
+
+uint8_t AP::PerfInfo::histogram_bin(uint32_t value)
+{
+    uint8_t bin = 0;
+    while (value != 0 && bin < HISTOGRAM_BINS-1) {
+        value >>= 1;
+        bin++;
+    }
+    return bin;
+}
+
+/*
+  add a sample to a histogram. When a bucket saturates all buckets are
+  halved, so the histogram keeps its shape while weighting recent
+  samples more heavily
+ */
+void AP::PerfInfo::histogram_add(uint16_t hist[HISTOGRAM_BINS], uint32_t value)
+{
+    const uint8_t bin = histogram_bin(value);
+    if (hist[bin] == UINT16_MAX) {
+        for (uint8_t i=0; i<HISTOGRAM_BINS; i++) {
+            hist[i] /= 2;
+        }
+    }
+    hist[bin]++;
+}
+
+uint32_t AP::PerfInfo::histogram_percentile(const uint16_t hist[HISTOGRAM_BINS], uint16_t permille)
+{
+    uint32_t total = 0;
+    for (uint8_t i=0; i<HISTOGRAM_BINS; i++) {
+        total += hist[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    const uint32_t threshold = (total * permille + 999) / 1000;
+    uint32_t sum = 0;
+    for (uint8_t i=0; i<HISTOGRAM_BINS; i++) {
+        sum += hist[i];
+        if (sum >= threshold) {
+            return i==0 ? 0 : (1UL<<i)-1;
+        }
+    }
+    return (1UL<<(HISTOGRAM_BINS-1))-1;
 }
 
 void AP::PerfInfo::set_loop_rate(uint16_t rate_hz)
@@ -8,6 +8,20 @@ class PerfInfo {
 public:
     PerfInfo() {}
 
+    // number of log2 buckets in each task histogram. Bucket 0 counts
+    // zero values, bucket n counts values in [2^(n-1), 2^n) and the
+    // last bucket also counts everything larger
+    static const uint8_t HISTOGRAM_BINS = 16;
+
+    // per-task run time and start slip statistics
+    struct TaskInfo {
+        uint16_t time_hist[HISTOGRAM_BINS]; // run time in microseconds
+        uint16_t slip_hist[HISTOGRAM_BINS]; // start slip in scheduler ticks
+        uint32_t max_time_us;
+        uint32_t run_count;
+        uint32_t starved;   // times skipped while far overdue
+    };
+
     /* Do not allow copies */
     PerfInfo(const PerfInfo &other) = delete;
     PerfInfo &operator=(const PerfInfo&) = delete;
@@ -26,6 +40,18 @@ public:
 
     void update_logging();
 
+    // allocate per-task statistics; returns false on allocation failure
+    bool allocate_task_info(uint8_t num_tasks);
+    void update_task_info(uint8_t task_index, uint32_t time_us, uint32_t slip_ticks);
+    void task_starved(uint8_t task_index);
+    const TaskInfo *get_task_info(uint8_t task_index) const;
+
+    // return the bucket a value is counted in
+    static uint8_t histogram_bin(uint32_t value);
+    // return the upper bound of the bucket containing the given
+    // fraction (in parts per thousand) of all samples
+    static uint32_t histogram_percentile(const uint16_t hist[HISTOGRAM_BINS], uint16_t permille);
+
 private:
     uint16_t loop_rate_hz;
     uint16_t overtime_threshold_micros;
@@ -39,6 +65,10 @@ private:
     float filtered_loop_time;
     bool ignore_loop;
 
+    TaskInfo *_task_info;
+    uint8_t _num_tasks;
+
+    static void histogram_add(uint16_t hist[HISTOGRAM_BINS], uint32_t value);
 };
 
 };
@@ -65,6 +65,33 @@ const AP_Param::GroupInfo AP_Scripting::var_info[] = {
 
     AP_GROUPINFO("DEBUG_LVL", 4, AP_Scripting, _debug_level, 1),
 
+    // @Param: RUN_MAX_US
+    // @DisplayName: Scripting run time budget
+    // @Description: The longest a script may run each time it is called before it is stopped, in addition to the VM_I_COUNT limit. Zero for no limit
+    // @Units: us
+    // @Range: 0 1000000
+    // @Increment: 1000
+    // @User: Advanced
+    AP_GROUPINFO("RUN_MAX_US", 5, AP_Scripting, _run_max_us, 0),
+
+    // @Param: MEM_MAX
+    // @DisplayName: Scripting memory budget
+    // @Description: The most heap memory each script may hold. A script that needs more fails with a memory error and is stopped. Zero for no limit
+    // @Units: B
+    // @Range: 0 1048576
+    // @Increment: 1024
+    // @User: Advanced
+    AP_GROUPINFO("MEM_MAX", 6, AP_Scripting, _mem_max, 0),
+
+    // @Param: GC_US
+    // @DisplayName: Scripting garbage collection budget
+    // @Description: Time the garbage collector may take between script runs. It collects in small steps so it never runs in the middle of a script, and takes longer steps as the heap fills. Zero for a full collection after every run, which is also done while MEM_MAX is set so memory is accounted to each script exactly
+    // @Units: us
+    // @Range: 0 10000
+    // @Increment: 100
+    // @User: Advanced
+    AP_GROUPINFO("GC_US", 7, AP_Scripting, _gc_max_us, 500),
+
     AP_GROUPEND
 };
 
@@ -93,18 +120,35 @@ void AP_Scripting::init(void) {
 }
 
 void AP_Scripting::thread(void) {
-    lua_scripts *lua = new lua_scripts(_script_vm_exec_count, _script_heap_size, _debug_level);
+    lua_scripts *lua = new lua_scripts(_script_vm_exec_count, _script_heap_size, _debug_level,
+                                       _run_max_us, _mem_max, _gc_max_us);
     if (lua == nullptr || !lua->heap_allocated()) {
         gcs().send_text(MAV_SEVERITY_CRITICAL, "Unable to allocate scripting memory");
         _init_failed = true;
         return;
     }
+    _lua = lua;
     lua->run();
 
     // only reachable if the lua backend has died for any reason
     gcs().send_text(MAV_SEVERITY_CRITICAL, "Scripting has stopped");
 }
 
+bool AP_Scripting::heap_stats(AP_HAL::Util::HeapStats &stats) const {
+    return lua_scripts::heap_stats(stats);
+}
+
+bool AP_Scripting::script_stats(uint8_t n, ScriptStats &stats) const {
+    if (_lua == nullptr) {
+        return false;
+    }
+    return _lua->get_script_stats(n, stats);
+}
+
+void AP_Scripting::post_event(Event event, int32_t value, int32_t value2) {
+    lua_scripts::post_event(event, value, value2);
+}
+
 AP_Scripting *AP_Scripting::_singleton = nullptr;
 
 namespace AP {
@@ -17,8 +17,11 @@
 #ifdef ENABLE_SCRIPTING
 
 #include <AP_Common/AP_Common.h>
+#include <AP_HAL/AP_HAL.h>
 #include <AP_Param/AP_Param.h>
 
+class lua_scripts;
+
 class AP_Scripting
 {
 public:
@@ -35,6 +38,39 @@ public:
 
     static AP_Scripting * get_singleton(void) { return _singleton; }
 
+    // statistics of the script heap, false if there is no heap
+    bool heap_stats(AP_HAL::Util::HeapStats &stats) const;
+
+    struct ScriptStats {
+        char name[32];              // file name, without the directory
+        bool running;
+        uint32_t run_count;
+        uint32_t run_time_us;       // last run
+        uint32_t run_time_max_us;
+        uint64_t run_time_total_us;
+        uint32_t instructions;      // last run
+        uint32_t alloc_bytes;       // last run
+        int32_t mem_resident;
+    };
+
+    // statistics of the n'th loaded script, false once n is past the end
+    bool script_stats(uint8_t n, ScriptStats &stats) const;
+
+    // vehicle events that scripts can subscribe to, with the values
+    // passed to their handlers
+    enum class Event : uint8_t {
+        MODE_CHANGE = 0,     // new mode number
+        ARMING = 1,          // 1 when armed, 0 when disarmed
+        MISSION_ITEM = 2,    // index of the mission command started
+        MISSION_CHANGED = 3, // number of mission commands
+        MAVLINK = 4,         // message id and channel of a received message
+        COUNT
+    };
+
+    // queue an event for the scripts subscribed to it, from any
+    // thread. Cheap when no script has subscribed
+    static void post_event(Event event, int32_t value, int32_t value2=0);
+
     static const struct AP_Param::GroupInfo var_info[];
 
 private:
@@ -46,6 +82,11 @@ private:
     AP_Int32 _script_vm_exec_count;
     AP_Int32 _script_heap_size;
     AP_Int8 _debug_level;
+    AP_Int32 _run_max_us;
+    AP_Int32 _mem_max;
+    AP_Int32 _gc_max_us;
+
+    lua_scripts *_lua;
 
     bool _init_failed;  // true if memory allocation failed
 
@@ -0,0 +1,304 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  Benchmarks for the scripting engine.
+
+  Scripts run in the same sandbox, bindings and heap allocator as on a
+  vehicle, with a GCS that drops the messages they send. The VM
+  benchmark reports instructions per second and the binding benchmarks
+  calls per second. The example benchmarks run scripts from
+  libraries/AP_Scripting/examples as the scheduler would, and label
+  each with its allocations and garbage collection time per run.
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_ROMFS/AP_ROMFS.h>
+#include <AP_Scripting/lua_bindings.h>
+#include <AP_Scripting/lua_generated_bindings.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+#include <stdio.h>
+#include <time.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+const struct AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+
+// drop the messages scripts send rather than print them
+class GCS_Benchmark : public GCS_Dummy {
+    using GCS_Dummy::GCS_Dummy;
+    void send_statustext(MAV_SEVERITY severity, uint8_t dest_bitmask, const char *text) override {}
+};
+static GCS_Benchmark _gcs;
+
+#define BENCH_HEAP_SIZE (64 * 1024)
+
+// heaps can't be freed, so every benchmark's state uses this one
+static void *heap;
+
+static uint32_t allocs;
+static uint32_t alloc_bytes;
+
+static void *bench_alloc(void *ud, void *ptr, size_t osize, size_t nsize)
+{
+    const size_t old_size = ptr != nullptr ? osize : 0;
+    if (nsize > old_size) {
+        allocs++;
+        alloc_bytes += nsize - old_size;
+    }
+    return hal.util->heap_realloc(heap, ptr, nsize);
+}
+
+static uint64_t wall_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+  a Lua state set up as the scripting thread does, with the sandbox
+  loaded
+ */
+static lua_State *new_state(void)
+{
+    if (heap == nullptr) {
+        heap = hal.util->allocate_heap_memory(BENCH_HEAP_SIZE);
+    }
+    lua_State *L = lua_newstate(bench_alloc, nullptr);
+    if (L == nullptr) {
+        return nullptr;
+    }
+    luaL_openlibs(L);
+    load_lua_bindings(L);
+
+    uint32_t sandbox_size;
+    const char *sandbox_data = (const char *)AP_ROMFS::find_decompress("sandbox.lua", sandbox_size);
+    if (sandbox_data != nullptr) {
+        if (luaL_dostring(L, sandbox_data)) {
+            lua_pop(L, 1);
+        }
+        AP_ROMFS::free((const uint8_t *)sandbox_data);
+    }
+    return L;
+}
+
+/*
+  give the chunk on the stack its own sandbox, as lua_scripts does
+ */
+static void sandbox_chunk(lua_State *L)
+{
+    lua_getglobal(L, "get_sandbox_env");
+    if (!lua_isfunction(L, -1) || lua_pcall(L, 0, 1, 0) != LUA_OK) {
+        // no sandbox, run in the global environment
+        lua_pop(L, 1);
+        return;
+    }
+    load_generated_sandbox(L);
+    lua_setupvalue(L, -2, 1);
+}
+
+static lua_State *load_string(const char *source)
+{
+    lua_State *L = new_state();
+    if (L == nullptr) {
+        return nullptr;
+    }
+    if (luaL_loadstring(L, source) != LUA_OK) {
+        ::printf("benchmark_scripting: %s\n", lua_tostring(L, -1));
+        lua_close(L);
+        return nullptr;
+    }
+    sandbox_chunk(L);
+    return L;
+}
+
+static uint32_t hook_instructions;
+
+static void count_hook(lua_State *L, lua_Debug *ar)
+{
+    hook_instructions++;
+}
+
+// VM instructions in one call of the function on top of the stack
+static uint32_t count_instructions(lua_State *L)
+{
+    hook_instructions = 0;
+    lua_sethook(L, count_hook, LUA_MASKCOUNT, 1);
+    lua_pushvalue(L, -1);
+    if (lua_pcall(L, 0, 0, 0) != LUA_OK) {
+        lua_pop(L, 1);
+    }
+    lua_sethook(L, nullptr, 0, 0);
+    return hook_instructions;
+}
+
+// call the function on top of the stack, returning false on an error
+static bool call(lua_State *L)
+{
+    lua_pushvalue(L, -1);
+    if (lua_pcall(L, 0, 0, 0) != LUA_OK) {
+        ::printf("benchmark_scripting: %s\n", lua_tostring(L, -1));
+        lua_pop(L, 1);
+        return false;
+    }
+    return true;
+}
+
+static void BM_ScriptingInstructions(benchmark::State& state)
+{
+    lua_State *L = load_string(
+        "local x = 0.0\n"
+        "local t = {}\n"
+        "for i = 1, 1000 do\n"
+        "  x = x + i * 0.5\n"
+        "  t[(i % 8) + 1] = x\n"
+        "end\n"
+        "return x\n");
+    if (L == nullptr) {
+        return;
+    }
+    const uint32_t instructions = count_instructions(L);
+
+    while (state.KeepRunning()) {
+        if (!call(L)) {
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(int64_t(state.iterations()) * instructions);
+    lua_close(L);
+}
+
+/*
+  each loop calls a binding 100 times, so the reported items per
+  second are calls per second, including the loop overhead
+ */
+static const struct {
+    const char *name;
+    const char *source;
+} binding_calls[] = {
+    { "millis", "local millis = millis\n"
+                "for i = 1, 100 do millis() end\n" },
+    { "millis_reused", "local millis = millis\n"
+                       "local now = uint32_t()\n"
+                       "for i = 1, 100 do millis(now) end\n" },
+    { "Vector3f_add", "local a = Vector3f()\n"
+                      "local b = Vector3f()\n"
+                      "b:x(1)\n"
+                      "for i = 1, 100 do a = a + b end\n" },
+    { "Location_get_distance", "local a = Location()\n"
+                               "local b = Location()\n"
+                               "b:lat(10000)\n"
+                               "for i = 1, 100 do a:get_distance(b) end\n" },
+    { "gcs_send_text", "for i = 1, 100 do gcs:send_text(6, \"benchmark\") end\n" },
+};
+
+static void BM_ScriptingBindingCall(benchmark::State& state)
+{
+    lua_State *L = load_string(binding_calls[state.range_x()].source);
+    if (L == nullptr) {
+        return;
+    }
+
+    while (state.KeepRunning()) {
+        if (!call(L)) {
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(int64_t(state.iterations()) * 100);
+    state.SetLabel(binding_calls[state.range_x()].name);
+    lua_close(L);
+}
+
+static const char *examples[] = {
+    "hello_world.lua",
+    "simple_loop.lua",
+};
+
+/*
+  load an example and run it as the scheduler does: the chunk runs
+  once, and if it returns a function that is what runs from then on.
+  Each run is followed by a full collection, which is timed apart
+ */
+static void BM_ScriptingExample(benchmark::State& state)
+{
+    const char *name = examples[state.range_x()];
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", SCRIPTING_EXAMPLES_DIR, name);
+
+    lua_State *L = new_state();
+    if (L == nullptr) {
+        return;
+    }
+    if (luaL_loadfile(L, path) != LUA_OK) {
+        ::printf("benchmark_scripting: %s\n", lua_tostring(L, -1));
+        lua_close(L);
+        return;
+    }
+    sandbox_chunk(L);
+
+    // the first run decides what is run from then on
+    lua_pushvalue(L, -1);
+    if (lua_pcall(L, 0, 1, 0) != LUA_OK) {
+        ::printf("benchmark_scripting: %s\n", lua_tostring(L, -1));
+        lua_close(L);
+        return;
+    }
+    if (lua_isfunction(L, -1)) {
+        lua_remove(L, -2);
+    } else {
+        lua_pop(L, 1);
+    }
+    lua_gc(L, LUA_GCCOLLECT, 0);
+
+    const uint32_t instructions = count_instructions(L);
+    allocs = 0;
+    alloc_bytes = 0;
+    uint64_t gc_ns = 0;
+    while (state.KeepRunning()) {
+        if (!call(L)) {
+            break;
+        }
+        state.PauseTiming();
+        const uint64_t start_ns = wall_ns();
+        lua_gc(L, LUA_GCCOLLECT, 0);
+        gc_ns += wall_ns() - start_ns;
+        state.ResumeTiming();
+    }
+
+    const size_t runs = MAX(state.iterations(), size_t(1));
+    char label[96];
+    snprintf(label, sizeof(label), "%s instr=%u allocs=%.1f bytes=%.0f gc_us=%.2f",
+             name,
+             (unsigned)instructions,
+             double(allocs) / runs,
+             double(alloc_bytes) / runs,
+             gc_ns * 1.0e-3 / runs);
+    state.SetLabel(label);
+    state.SetItemsProcessed(int64_t(state.iterations()) * instructions);
+    lua_close(L);
+}
+
+BENCHMARK(BM_ScriptingInstructions);
+BENCHMARK(BM_ScriptingBindingCall)->DenseRange(0, ARRAY_SIZE(binding_calls) - 1);
+BENCHMARK(BM_ScriptingExample)->DenseRange(0, ARRAY_SIZE(examples) - 1);
+
+BENCHMARK_MAIN()
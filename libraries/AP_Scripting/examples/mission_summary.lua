@@ -0,0 +1,26 @@
+-- logs the length of the mission each time it changes, reading all of the commands in one call
+
+local items = {}
+
+function mission_changed()
+  local n = mission.get_items(1, mission.num_commands(), items)
+  local length = 0
+  local last = nil
+  for i = 1, n do
+    local item = items[i]
+    if item.x ~= 0 or item.y ~= 0 then
+      local loc = Location()
+      loc:lat(item.x)
+      loc:lng(item.y)
+      if last then
+        length = length + last:get_distance(loc)
+      end
+      last = loc
+    end
+  end
+  logger.write("SMIS", "Cmds,Len", "Hf", n, length)
+  gcs:send_text(6, string.format("mission has %d commands, %.0fm", n, length))
+end
+
+scripting.subscribe(scripting.EVENT_MISSION_CHANGED, mission_changed)
+mission_changed()
@@ -0,0 +1,16 @@
+-- reports mode and arming changes as they happen, without polling
+
+function mode_changed(mode)
+  gcs:send_text(6, string.format("mode changed to %d", mode))
+end
+
+function arming_changed(armed)
+  if armed == 1 then
+    gcs:send_text(6, "armed")
+  else
+    gcs:send_text(6, "disarmed")
+  end
+end
+
+scripting.subscribe(scripting.EVENT_MODE_CHANGE, mode_changed)
+scripting.subscribe(scripting.EVENT_ARMING, arming_changed)
@@ -843,9 +843,37 @@ void emit_userdata_allocators(void) {
 void emit_userdata_checkers(void) {
   struct userdata * node = parsed_userdata;
   while (node) {
+    // the metatable is remembered when it is created, so a check is a
+    // pointer comparison rather than a lookup of the metatable by name
+    fprintf(source, "static const void *%s_metatable;\n\n", node->name);
     fprintf(source, "%s * check_%s(lua_State *L, int arg) {\n", node->name, node->name);
-    fprintf(source, "    void *data = luaL_checkudata(L, arg, \"%s\");\n", node->name);
-    fprintf(source, "    return (%s *)data;\n", node->name);
+    fprintf(source, "    void *data = lua_touserdata(L, arg);\n");
+    fprintf(source, "    if ((data != nullptr) && lua_getmetatable(L, arg)) {\n");
+    fprintf(source, "        const bool match = lua_topointer(L, -1) == %s_metatable;\n", node->name);
+    fprintf(source, "        lua_pop(L, 1);\n");
+    fprintf(source, "        if (match) {\n");
+    fprintf(source, "            return (%s *)data;\n", node->name);
+    fprintf(source, "        }\n");
+    fprintf(source, "    }\n");
+    fprintf(source, "    // not a %s, let lua raise the error\n", node->name);
+    fprintf(source, "    return (%s *)luaL_checkudata(L, arg, \"%s\");\n", node->name, node->name);
+    fprintf(source, "}\n\n");
+    node = node->next;
+  }
+}
+
+void emit_userdata_pushers(void) {
+  struct userdata * node = parsed_userdata;
+  while (node) {
+    fprintf(source, "%s * push_%s(lua_State *L, int arg) {\n", node->name, node->name);
+    fprintf(source, "    if ((arg == 0) || lua_isnil(L, arg)) {\n");
+    fprintf(source, "        new_%s(L);\n", node->name);
+    fprintf(source, "    } else {\n");
+    fprintf(source, "        check_%s(L, arg);\n", node->name);
+    fprintf(source, "        luaL_checkstack(L, 1, \"Out of stack\");\n");
+    fprintf(source, "        lua_pushvalue(L, arg);\n");
+    fprintf(source, "    }\n");
+    fprintf(source, "    return (%s *)lua_touserdata(L, -1);\n", node->name);
     fprintf(source, "}\n\n");
     node = node->next;
   }
@@ -856,6 +884,7 @@ void emit_userdata_declarations(void) {
   while (node) {
     fprintf(header, "int new_%s(lua_State *L);\n", node->name);
     fprintf(header, "%s * check_%s(lua_State *L, int arg);\n", node->name, node->name);
+    fprintf(header, "%s * push_%s(lua_State *L, int arg);\n", node->name, node->name);
     node = node->next;
   }
 }
@@ -1144,6 +1173,27 @@ void emit_userdata_fields() {
   }
 }
 
+// results that are returned in a box, rather than as a lua value
+int is_boxed(const struct type *t) {
+  return (t->type == TYPE_USERDATA) || (t->type == TYPE_UINT32_T);
+}
+
+// emit the push of a boxed result into the caller's box if they passed
+// one as argument dest_arg, otherwise into a new box
+void emit_boxed_result(const struct type *t, int dest_arg, const char *indentation, const char *value) {
+  switch (t->type) {
+    case TYPE_UINT32_T:
+      fprintf(source, "%s*push_uint32_t(L, (args >= %d) ? %d : 0) = %s;\n", indentation, dest_arg, dest_arg, value);
+      break;
+    case TYPE_USERDATA:
+      fprintf(source, "%s*push_%s(L, (args >= %d) ? %d : 0) = %s;\n", indentation, t->data.userdata_name, dest_arg, dest_arg, value);
+      break;
+    default:
+      error(ERROR_INTERNAL, "Attempted to box a result that isn't boxed");
+      break;
+  }
+}
+
 void emit_userdata_method(const struct userdata *data, const struct method *method) {
   int arg_count = 1;
 
@@ -1169,7 +1219,27 @@ void emit_userdata_method(const struct userdata *data, const struct method *meth
     }
     arg = arg->next;
   }
-  fprintf(source, "    binding_argcheck(L, %d);\n", arg_count);
+
+  // boxed results can be written into boxes passed as extra arguments
+  // after the normal ones, so a script can reuse them between calls
+  int boxed_count = 0;
+  if (is_boxed(&(method->return_type))) {
+    boxed_count = 1;
+  } else if ((method->return_type.type == TYPE_BOOLEAN) && (method->flags & TYPE_FLAGS_NULLABLE)) {
+    arg = method->arguments;
+    while (arg != NULL) {
+      if ((arg->type.flags & TYPE_FLAGS_NULLABLE) && is_boxed(&(arg->type))) {
+        boxed_count++;
+      }
+      arg = arg->next;
+    }
+  }
+  const int first_dest_arg = arg_count + 1;
+  if (boxed_count > 0) {
+    fprintf(source, "    const int args = binding_argcheck_range(L, %d, %d);\n", arg_count, arg_count + boxed_count);
+  } else {
+    fprintf(source, "    binding_argcheck(L, %d);\n", arg_count);
+  }
 
   switch (data->ud_type) {
     case UD_USERDATA:
@@ -1293,6 +1363,7 @@ void emit_userdata_method(const struct userdata *data, const struct method *meth
         fprintf(source, "    if (data) {\n");
         // we need to emit out nullable arguments, iterate the args again, creating and copying objects, while keeping a new count
         return_count = 0;
+        int dest_arg = first_dest_arg;
         arg = method->arguments;
         int arg_index = NULLABLE_ARG_COUNT_BASE + 2;
         while (arg != NULL) {
@@ -1314,17 +1385,17 @@ void emit_userdata_method(const struct userdata *data, const struct method *meth
                 fprintf(source, "        lua_pushinteger(L, data_%d);\n", arg_index);
                 break;
               case TYPE_UINT32_T:
-                fprintf(source, "        new_uint32_t(L);\n");
-                fprintf(source, "        *static_cast<uint32_t *>(luaL_checkudata(L, -1, \"uint32_t\")) = data_%d;\n", arg_index);
-                break;
+              case TYPE_USERDATA:
+                {
+                  char value[32];
+                  snprintf(value, sizeof(value), "data_%d", arg_index);
+                  emit_boxed_result(&(arg->type), dest_arg, "        ", value);
+                  dest_arg++;
+                  break;
+                }
               case TYPE_STRING:
                 fprintf(source, "        lua_pushstring(L, data_%d);\n", arg_index);
                 break;
-              case TYPE_USERDATA:
-                // userdatas must allocate a new container to return
-                fprintf(source, "        new_%s(L);\n", arg->type.data.userdata_name);
-                fprintf(source, "        *check_%s(L, -1) = data_%d;\n", arg->type.data.userdata_name, arg_index);
-                break;
               case TYPE_NONE:
                 error(ERROR_INTERNAL, "Attempted to emit a nullable argument of type none");
                 break;
@@ -1356,17 +1427,12 @@ void emit_userdata_method(const struct userdata *data, const struct method *meth
       fprintf(source, "    lua_pushinteger(L, data);\n");
       break;
     case TYPE_UINT32_T:
-      fprintf(source, "        new_uint32_t(L);\n");
-      fprintf(source, "        *static_cast<uint32_t *>(luaL_checkudata(L, -1, \"uint32_t\")) = data;\n");
+    case TYPE_USERDATA:
+      emit_boxed_result(&(method->return_type), first_dest_arg, "    ", "data");
       break;
     case TYPE_STRING:
       fprintf(source, "    lua_pushstring(L, data);\n");
       break;
-    case TYPE_USERDATA:
-      // userdatas must allocate a new container to return
-      fprintf(source, "    new_%s(L);\n", method->return_type.data.userdata_name);
-      fprintf(source, "    *check_%s(L, -1) = data;\n", method->return_type.data.userdata_name);
-      break;
     case TYPE_NONE:
     case TYPE_LITERAL:
       // no return value, so don't worry about pushing a value
@@ -1527,10 +1593,14 @@ void emit_enums(struct userdata * data) {
 void emit_metas(struct userdata * data, char * meta_name) {
   fprintf(source, "const struct userdata_meta %s_fun[] = {\n", meta_name);
   while (data) {
+    char metatable[128] = "NULL";
+    if (data->ud_type == UD_USERDATA) {
+      snprintf(metatable, sizeof(metatable), "&%s_metatable", data->name);
+    }
     if (data->enums) {
-      fprintf(source, "    {\"%s\", %s_meta, %s_enums},\n", data->alias ? data->alias : data->name, data->name, data->name);
+      fprintf(source, "    {\"%s\", %s_meta, %s_enums, %s},\n", data->alias ? data->alias : data->name, data->name, data->name, metatable);
     } else {
-      fprintf(source, "    {\"%s\", %s_meta, NULL},\n", data->alias ? data->alias : data->name, data->name);
+      fprintf(source, "    {\"%s\", %s_meta, NULL, %s},\n", data->alias ? data->alias : data->name, data->name, metatable);
     }
     data = data->next;
   }
@@ -1551,6 +1621,7 @@ void emit_loaders(void) {
   fprintf(source, "    const char *name;\n");
   fprintf(source, "    const luaL_Reg *reg;\n");
   fprintf(source, "    const struct userdata_enum *enums;\n");
+  fprintf(source, "    const void **metatable;\n");
   fprintf(source, "};\n\n");
   emit_metas(parsed_userdata, "userdata");
   emit_metas(parsed_singletons, "singleton");
@@ -1560,6 +1631,7 @@ void emit_loaders(void) {
   fprintf(source, "    // userdata metatables\n");
   fprintf(source, "    for (uint32_t i = 0; i < ARRAY_SIZE(userdata_fun); i++) {\n");
   fprintf(source, "        luaL_newmetatable(L, userdata_fun[i].name);\n");
+  fprintf(source, "        *userdata_fun[i].metatable = lua_topointer(L, -1);\n");
   fprintf(source, "        luaL_setfuncs(L, userdata_fun[i].reg, 0);\n");
   fprintf(source, "        lua_pushstring(L, \"__index\");\n");
   fprintf(source, "        lua_pushvalue(L, -2);\n");
@@ -1653,6 +1725,18 @@ void emit_argcheck_helper(void) {
   fprintf(source, "    }\n");
   fprintf(source, "    return 0;\n");
   fprintf(source, "}\n\n");
+
+  // as above, for functions taking optional trailing arguments. Returns
+  // the number of arguments
+  fprintf(source, "static int binding_argcheck_range(lua_State *L, int min_arg_count, int max_arg_count) {\n");
+  fprintf(source, "    const int args = lua_gettop(L);\n");
+  fprintf(source, "    if (args > max_arg_count) {\n");
+  fprintf(source, "        return luaL_argerror(L, args, \"too many arguments\");\n");
+  fprintf(source, "    } else if (args < min_arg_count) {\n");
+  fprintf(source, "        return luaL_argerror(L, args, \"too few arguments\");\n");
+  fprintf(source, "    }\n");
+  fprintf(source, "    return args;\n");
+  fprintf(source, "}\n\n");
 }
 
 
@@ -1750,6 +1834,8 @@ int main(int argc, char **argv) {
 
   emit_userdata_checkers();
 
+  emit_userdata_pushers();
+
   emit_userdata_fields();
 
   emit_userdata_methods(parsed_userdata);
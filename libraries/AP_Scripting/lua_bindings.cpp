@@ -1,8 +1,13 @@
 #include <AP_Common/AP_Common.h>
 #include <SRV_Channel/SRV_Channel.h>
 #include <AP_HAL/HAL.h>
+#include <AP_Math/polygon.h>
+#include <AP_Logger/AP_Logger.h>
+#include <AP_Mission/AP_Mission.h>
+#include <AP_Proximity/AP_Proximity.h>
 
 #include "lua_bindings.h"
+#include "lua_scripts.h"
 
 #include "lua_boxed_numerics.h"
 #include "lua_generated_bindings.h"
@@ -42,16 +47,521 @@ static int lua_servo_set_output_pwm(lua_State *L) {
     return 0;
 }
 
-// millis
+// millis, optionally written into an existing uint32_t
 static int lua_millis(lua_State *L) {
-    check_arguments(L, 0, "millis");
+    const int args = lua_gettop(L);
+    if (args > 1) {
+        return luaL_error(L, "millis expected at most 1 argument got %d", args);
+    }
+
+    *push_uint32_t(L, args) = AP_HAL::millis();
+
+    return 1;
+}
+
+// scripting.heap_stats(), statistics of the script heap as a table
+static int lua_scripting_heap_stats(lua_State *L) {
+    check_arguments(L, 0, "heap_stats");
+
+    AP_HAL::Util::HeapStats stats;
+    if (!lua_scripts::heap_stats(stats)) {
+        return 0;
+    }
+    lua_createtable(L, 0, 7);
+    lua_pushinteger(L, stats.size);
+    lua_setfield(L, -2, "size");
+    lua_pushinteger(L, stats.used);
+    lua_setfield(L, -2, "used");
+    lua_pushinteger(L, stats.peak);
+    lua_setfield(L, -2, "peak");
+    lua_pushinteger(L, stats.free);
+    lua_setfield(L, -2, "free");
+    lua_pushinteger(L, stats.largest_free);
+    lua_setfield(L, -2, "largest_free");
+    lua_pushinteger(L, stats.allocs);
+    lua_setfield(L, -2, "allocs");
+    lua_pushinteger(L, stats.failures);
+    lua_setfield(L, -2, "failures");
+
+    return 1;
+}
+
+// scripting.subscribe(event, handler [, msgid]), see lua_scripts::subscribe()
+static int lua_scripting_subscribe(lua_State *L) {
+    return lua_scripts::subscribe(L);
+}
+
+static const luaL_Reg scripting_functions[] =
+{
+    {"heap_stats", lua_scripting_heap_stats},
+    {"subscribe", lua_scripting_subscribe},
+    {NULL, NULL}
+};
+
+static const struct {
+    const char *name;
+    AP_Scripting::Event event;
+} scripting_events[] = {
+    {"EVENT_MODE_CHANGE", AP_Scripting::Event::MODE_CHANGE},
+    {"EVENT_ARMING", AP_Scripting::Event::ARMING},
+    {"EVENT_MISSION_ITEM", AP_Scripting::Event::MISSION_ITEM},
+    {"EVENT_MISSION_CHANGED", AP_Scripting::Event::MISSION_CHANGED},
+    {"EVENT_MAVLINK", AP_Scripting::Event::MAVLINK},
+};
+
+// proximity.get_boundary_points(points), fills the array points with
+// the avoidance boundary as Vector2f, reusing any Vector2f already in
+// it. Returns the number of points
+static int lua_proximity_get_boundary_points(lua_State *L) {
+    check_arguments(L, 1, "get_boundary_points");
+    luaL_checktype(L, 1, LUA_TTABLE);
+
+    uint16_t num_points = 0;
+    const AP_Proximity *proximity = AP::proximity();
+    const Vector2f *points = nullptr;
+    if (proximity != nullptr) {
+        points = proximity->get_boundary_points(num_points);
+    }
+    if (points == nullptr) {
+        num_points = 0;
+    }
 
-    new_uint32_t(L);
-    *check_uint32_t(L, -1) = AP_HAL::millis();
+    for (uint16_t i=0; i<num_points; i++) {
+        lua_rawgeti(L, 1, i+1);
+        *push_Vector2f(L, lua_gettop(L)) = points[i];
+        lua_rawseti(L, 1, i+1);
+        lua_pop(L, 1);
+    }
 
+    lua_pushinteger(L, num_points);
     return 1;
 }
 
+static const luaL_Reg proximity_functions[] =
+{
+    {"get_boundary_points", lua_proximity_get_boundary_points},
+    {NULL, NULL}
+};
+
+static int lua_mission_num_commands(lua_State *L) {
+    check_arguments(L, 0, "num_commands");
+
+    const AP_Mission *mission = AP::mission();
+    lua_pushinteger(L, mission != nullptr ? mission->num_commands() : 0);
+    return 1;
+}
+
+// mission.get_items(first, count, items), fills the array items with up
+// to count mission commands starting at index first. Each is a table
+// with the fields of a MISSION_ITEM_INT, and tables already in items are
+// reused. Returns the number of commands read
+static int lua_mission_get_items(lua_State *L) {
+    check_arguments(L, 3, "get_items");
+
+    const lua_Integer first = luaL_checkinteger(L, 1);
+    luaL_argcheck(L, ((first >= 0) && (first <= UINT16_MAX)), 1, "index out of range");
+    const lua_Integer count = luaL_checkinteger(L, 2);
+    luaL_argcheck(L, ((count >= 0) && (count <= UINT16_MAX)), 2, "count out of range");
+    luaL_checktype(L, 3, LUA_TTABLE);
+
+    const AP_Mission *mission = AP::mission();
+    uint16_t n = 0;
+    while ((mission != nullptr) && (n < count) && (first + n < mission->num_commands())) {
+        AP_Mission::Mission_Command cmd;
+        mavlink_mission_item_int_t item {};
+        if (!mission->read_cmd_from_storage(first + n, cmd) ||
+            !AP_Mission::mission_cmd_to_mavlink_int(cmd, item)) {
+            break;
+        }
+
+        lua_rawgeti(L, 3, n+1);
+        if (!lua_istable(L, -1)) {
+            lua_pop(L, 1);
+            lua_createtable(L, 0, 9);
+            lua_pushvalue(L, -1);
+            lua_rawseti(L, 3, n+1);
+        }
+        lua_pushinteger(L, first + n);
+        lua_setfield(L, -2, "seq");
+        lua_pushinteger(L, item.command);
+        lua_setfield(L, -2, "command");
+        lua_pushinteger(L, item.frame);
+        lua_setfield(L, -2, "frame");
+        lua_pushnumber(L, item.param1);
+        lua_setfield(L, -2, "param1");
+        lua_pushnumber(L, item.param2);
+        lua_setfield(L, -2, "param2");
+        lua_pushnumber(L, item.param3);
+        lua_setfield(L, -2, "param3");
+        lua_pushnumber(L, item.param4);
+        lua_setfield(L, -2, "param4");
+        lua_pushinteger(L, item.x);
+        lua_setfield(L, -2, "x");
+        lua_pushinteger(L, item.y);
+        lua_setfield(L, -2, "y");
+        lua_pushnumber(L, item.z);
+        lua_setfield(L, -2, "z");
+        lua_pop(L, 1);
+        n++;
+    }
+
+    lua_pushinteger(L, n);
+    return 1;
+}
+
+static const luaL_Reg mission_functions[] =
+{
+    {"num_commands", lua_mission_num_commands},
+    {"get_items", lua_mission_get_items},
+    {NULL, NULL}
+};
+
+#ifndef SCRIPTING_LOG_FORMATS
+#define SCRIPTING_LOG_FORMATS 16
+#endif
+
+// the logger keeps the strings describing a message for good, so the
+// formats of messages written by scripts are copied out of the Lua heap
+struct script_log_format {
+    char name[LS_NAME_SIZE];
+    char labels[LS_LABELS_SIZE];
+    char fmt[LS_FORMAT_SIZE];
+    uint8_t fields_len;
+};
+static script_log_format *log_formats[SCRIPTING_LOG_FORMATS];
+
+// size of a log field type, zero if scripts can't write it
+static uint8_t log_field_size(char c) {
+    switch (c) {
+    case 'b':
+    case 'B':
+    case 'M':
+        return 1;
+    case 'h':
+    case 'H':
+    case 'c':
+    case 'C':
+        return 2;
+    case 'i':
+    case 'I':
+    case 'e':
+    case 'E':
+    case 'L':
+    case 'f':
+    case 'n':
+        return 4;
+    case 'q':
+    case 'Q':
+    case 'd':
+        return 8;
+    case 'N':
+        return 16;
+    case 'Z':
+        return 64;
+    default:
+        return 0;
+    }
+}
+
+static const script_log_format *log_format_for_name(lua_State *L, const char *name, const char *labels, const char *fmt) {
+    uint8_t i;
+    for (i=0; i<ARRAY_SIZE(log_formats) && log_formats[i] != nullptr; i++) {
+        if (strcmp(log_formats[i]->name, name) == 0) {
+            if ((strcmp(log_formats[i]->labels, labels) != 0) || (strcmp(log_formats[i]->fmt, fmt) != 0)) {
+                luaL_error(L, "log message %s was written with a different format", name);
+            }
+            return log_formats[i];
+        }
+    }
+
+    const size_t name_len = strlen(name);
+    luaL_argcheck(L, ((name_len > 0) && (name_len < LS_NAME_SIZE)), 1, "name must be 1 to 4 characters");
+    const size_t fmt_len = strlen(fmt);
+    luaL_argcheck(L, ((fmt_len > 0) && (fmt_len < LS_FORMAT_SIZE)), 3, "format must be 1 to 16 characters");
+    luaL_argcheck(L, strlen(labels) < LS_LABELS_SIZE, 2, "labels too long");
+    size_t label_count = 1;
+    for (const char *c = labels; *c != '\0'; c++) {
+        if (*c == ',') {
+            label_count++;
+        }
+    }
+    luaL_argcheck(L, label_count == fmt_len, 2, "labels must match the format");
+    size_t fields_len = 0;
+    for (const char *c = fmt; *c != '\0'; c++) {
+        const uint8_t size = log_field_size(*c);
+        luaL_argcheck(L, size != 0, 3, "unsupported format character");
+        fields_len += size;
+    }
+    luaL_argcheck(L, fields_len <= UINT8_MAX - 3U, 3, "message too long");
+
+    if (i == ARRAY_SIZE(log_formats)) {
+        luaL_error(L, "too many log messages");
+    }
+    script_log_format *f = (script_log_format *)calloc(1, sizeof(script_log_format));
+    if (f == nullptr) {
+        luaL_error(L, "out of memory");
+    }
+    strncpy(f->name, name, sizeof(f->name)-1);
+    strncpy(f->labels, labels, sizeof(f->labels)-1);
+    strncpy(f->fmt, fmt, sizeof(f->fmt)-1);
+    f->fields_len = fields_len;
+    log_formats[i] = f;
+    return f;
+}
+
+// pack the value at idx into buf as the log field type c
+static uint8_t pack_log_field(lua_State *L, char c, int idx, int arg, uint8_t *buf) {
+    switch (c) {
+    case 'b': {
+        const int8_t v = luaL_checkinteger(L, idx);
+        memcpy(buf, &v, sizeof(v));
+        return sizeof(v);
+    }
+    case 'B':
+    case 'M': {
+        const uint8_t v = luaL_checkinteger(L, idx);
+        memcpy(buf, &v, sizeof(v));
+        return sizeof(v);
+    }
+    case 'h':
+    case 'c': {
+        const int16_t v = luaL_checkinteger(L, idx);
+        memcpy(buf, &v, sizeof(v));
+        return sizeof(v);
+    }
+    case 'H':
+    case 'C': {
+        const uint16_t v = luaL_checkinteger(L, idx);
+        memcpy(buf, &v, sizeof(v));
+        return sizeof(v);
+    }
+    case 'i':
+    case 'L':
+    case 'e': {
+        const int32_t v = luaL_checkinteger(L, idx);
+        memcpy(buf, &v, sizeof(v));
+        return sizeof(v);
+    }
+    case 'I':
+    case 'E': {
+        const uint32_t v = lua_isuserdata(L, idx) ? *check_uint32_t(L, idx) : uint32_t(luaL_checkinteger(L, idx));
+        memcpy(buf, &v, sizeof(v));
+        return sizeof(v);
+    }
+    case 'q': {
+        const int64_t v = luaL_checkinteger(L, idx);
+        memcpy(buf, &v, sizeof(v));
+        return sizeof(v);
+    }
+    case 'Q': {
+        const uint64_t v = lua_isuserdata(L, idx) ? *check_uint32_t(L, idx) : uint64_t(luaL_checkinteger(L, idx));
+        memcpy(buf, &v, sizeof(v));
+        return sizeof(v);
+    }
+    case 'f': {
+        const float v = luaL_checknumber(L, idx);
+        memcpy(buf, &v, sizeof(v));
+        return sizeof(v);
+    }
+    case 'd': {
+        const double v = luaL_checknumber(L, idx);
+        memcpy(buf, &v, sizeof(v));
+        return sizeof(v);
+    }
+    case 'n':
+    case 'N':
+    case 'Z': {
+        const uint8_t charlen = log_field_size(c);
+        size_t len;
+        const char *str = luaL_checklstring(L, idx, &len);
+        memset(buf, 0, charlen);
+        memcpy(buf, str, MIN(len, size_t(charlen)));
+        return charlen;
+    }
+    default:
+        return luaL_argerror(L, arg, "unsupported format character");
+    }
+}
+
+// logger.write(name, labels, fmt, ...), writes a message with all its
+// fields in one call. The values follow fmt, or are given as one array
+static int lua_logger_write(lua_State *L) {
+    const int args = lua_gettop(L);
+    const char *name = luaL_checkstring(L, 1);
+    const char *labels = luaL_checkstring(L, 2);
+    const char *fmt = luaL_checkstring(L, 3);
+    const script_log_format *f = log_format_for_name(L, name, labels, fmt);
+
+    const uint8_t field_count = strlen(f->fmt);
+    const bool from_table = (args == 4) && lua_istable(L, 4);
+    if (!from_table && (args - 3 != field_count)) {
+        return luaL_error(L, "write expected %d values got %d", field_count, args - 3);
+    }
+
+    uint8_t buffer[f->fields_len];
+    uint8_t offset = 0;
+    for (uint8_t i=0; i<field_count; i++) {
+        if (from_table) {
+            lua_rawgeti(L, 4, i+1);
+            offset += pack_log_field(L, f->fmt[i], -1, 4, &buffer[offset]);
+            lua_pop(L, 1);
+        } else {
+            offset += pack_log_field(L, f->fmt[i], 4 + i, 4 + i, &buffer[offset]);
+        }
+    }
+
+    AP::logger().WritePacked(f->name, f->labels, f->fmt, buffer, offset);
+
+    return 0;
+}
+
+static const luaL_Reg logger_functions[] =
+{
+    {"write", lua_logger_write},
+    {NULL, NULL}
+};
+
+// vector kernels working in place, added to the generated Vector2f and
+// Vector3f methods so control loops don't allocate for each operation
+
+// v:add(v2), adds v2 to v and returns v
+template <typename T, T *(*check)(lua_State *, int)>
+static int lua_vector_add(lua_State *L) {
+    check_arguments(L, 2, "add");
+    *check(L, 1) += *check(L, 2);
+    lua_pop(L, 1);
+    return 1;
+}
+
+// v:sub(v2), subtracts v2 from v and returns v
+template <typename T, T *(*check)(lua_State *, int)>
+static int lua_vector_sub(lua_State *L) {
+    check_arguments(L, 2, "sub");
+    *check(L, 1) -= *check(L, 2);
+    lua_pop(L, 1);
+    return 1;
+}
+
+// v:scale(s), multiplies v by s and returns v
+template <typename T, T *(*check)(lua_State *, int)>
+static int lua_vector_scale(lua_State *L) {
+    check_arguments(L, 2, "scale");
+    *check(L, 1) *= luaL_checknumber(L, 2);
+    lua_pop(L, 1);
+    return 1;
+}
+
+// v:dot(v2)
+template <typename T, T *(*check)(lua_State *, int)>
+static int lua_vector_dot(lua_State *L) {
+    check_arguments(L, 2, "dot");
+    lua_pushnumber(L, *check(L, 1) * *check(L, 2));
+    return 1;
+}
+
+// v:cross(v2 [, result]), optionally written into an existing Vector3f
+static int lua_vector3f_cross(lua_State *L) {
+    const int args = lua_gettop(L);
+    if ((args < 2) || (args > 3)) {
+        return luaL_error(L, "cross expected 2 or 3 arguments got %d", args);
+    }
+    const Vector3f result = *check_Vector3f(L, 1) % *check_Vector3f(L, 2);
+    *push_Vector3f(L, (args >= 3) ? 3 : 0) = result;
+    return 1;
+}
+
+static const luaL_Reg vector2f_functions[] =
+{
+    {"add", lua_vector_add<Vector2f, check_Vector2f>},
+    {"sub", lua_vector_sub<Vector2f, check_Vector2f>},
+    {"scale", lua_vector_scale<Vector2f, check_Vector2f>},
+    {"dot", lua_vector_dot<Vector2f, check_Vector2f>},
+    {NULL, NULL}
+};
+
+static const luaL_Reg vector3f_functions[] =
+{
+    {"add", lua_vector_add<Vector3f, check_Vector3f>},
+    {"sub", lua_vector_sub<Vector3f, check_Vector3f>},
+    {"scale", lua_vector_scale<Vector3f, check_Vector3f>},
+    {"dot", lua_vector_dot<Vector3f, check_Vector3f>},
+    {"cross", lua_vector3f_cross},
+    {NULL, NULL}
+};
+
+#ifndef SCRIPTING_POLYGON_MAX_POINTS
+#define SCRIPTING_POLYGON_MAX_POINTS 250
+#endif
+
+// a polygon indexed for point tests, followed in the same userdata by
+// its points, which the index refers to
+struct lua_polygon {
+    Polygon_index index;
+    uint16_t num_points;
+};
+
+// Polygon(points), from an array of Vector2f
+static int lua_new_polygon(lua_State *L) {
+    check_arguments(L, 1, "Polygon");
+    luaL_checktype(L, 1, LUA_TTABLE);
+    const lua_Integer n = luaL_len(L, 1);
+    luaL_argcheck(L, ((n >= 3) && (n <= SCRIPTING_POLYGON_MAX_POINTS)), 1, "wrong number of points");
+
+    lua_polygon *polygon = (lua_polygon *)lua_newuserdata(L, sizeof(lua_polygon) + n * sizeof(Vector2f));
+    Vector2f *points = (Vector2f *)(polygon + 1);
+    for (lua_Integer i=0; i<n; i++) {
+        lua_rawgeti(L, 1, i+1);
+        points[i] = *check_Vector2f(L, -1);
+        lua_pop(L, 1);
+    }
+
+    // the metatable is set once the index is constructed, so it is
+    // only ever collected constructed
+    new (&polygon->index) Polygon_index();
+    polygon->num_points = n;
+    luaL_setmetatable(L, "Polygon");
+    polygon->index.init(points, n);
+    return 1;
+}
+
+static lua_polygon *check_polygon(lua_State *L, int arg) {
+    return (lua_polygon *)luaL_checkudata(L, arg, "Polygon");
+}
+
+// polygon:outside(point), true if the Vector2f is outside the polygon
+static int lua_polygon_outside(lua_State *L) {
+    check_arguments(L, 2, "outside");
+    lua_pushboolean(L, check_polygon(L, 1)->index.outside(*check_Vector2f(L, 2)));
+    return 1;
+}
+
+// polygon:closest_distance(point), distance from the Vector2f to the nearest edge
+static int lua_polygon_closest_distance(lua_State *L) {
+    check_arguments(L, 2, "closest_distance");
+    lua_pushnumber(L, check_polygon(L, 1)->index.closest_distance_point(*check_Vector2f(L, 2)));
+    return 1;
+}
+
+static int lua_polygon_gc(lua_State *L) {
+    check_polygon(L, 1)->index.~Polygon_index();
+    return 0;
+}
+
+static const luaL_Reg polygon_functions[] =
+{
+    {"outside", lua_polygon_outside},
+    {"closest_distance", lua_polygon_closest_distance},
+    {"__gc", lua_polygon_gc},
+    {NULL, NULL}
+};
+
+// add functions to a metatable made by load_generated_bindings()
+static void add_methods(lua_State *L, const char *name, const luaL_Reg *functions) {
+    luaL_getmetatable(L, name);
+    luaL_setfuncs(L, functions, 0);
+    lua_pop(L, 1);
+}
+
 static const luaL_Reg servo_functions[] =
 {
     {"set_output_pwm", lua_servo_set_output_pwm},
@@ -62,8 +572,35 @@ void load_lua_bindings(lua_State *L) {
     luaL_newlib(L, servo_functions);
     lua_setglobal(L, "servo");
 
+    luaL_newlib(L, scripting_functions);
+    for (uint8_t i=0; i<ARRAY_SIZE(scripting_events); i++) {
+        lua_pushinteger(L, lua_Integer(scripting_events[i].event));
+        lua_setfield(L, -2, scripting_events[i].name);
+    }
+    lua_setglobal(L, "scripting");
+
+    luaL_newlib(L, proximity_functions);
+    lua_setglobal(L, "proximity");
+
+    luaL_newlib(L, mission_functions);
+    lua_setglobal(L, "mission");
+
+    luaL_newlib(L, logger_functions);
+    lua_setglobal(L, "logger");
+
     load_generated_bindings(L);
 
+    add_methods(L, "Vector2f", vector2f_functions);
+    add_methods(L, "Vector3f", vector3f_functions);
+
+    luaL_newmetatable(L, "Polygon");
+    luaL_setfuncs(L, polygon_functions, 0);
+    lua_pushvalue(L, -1);
+    lua_setfield(L, -2, "__index");
+    lua_pop(L, 1);
+    lua_pushcfunction(L, lua_new_polygon);
+    lua_setglobal(L, "Polygon");
+
     lua_pushcfunction(L, lua_millis);
     lua_setglobal(L, "millis");
 }
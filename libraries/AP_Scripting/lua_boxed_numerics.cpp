@@ -4,9 +4,25 @@
 
 extern const AP_HAL::HAL& hal;
 
+// remembered when the metatable is created, so checking a uint32_t is a
+// pointer comparison rather than a lookup of the metatable by name
+static const void *uint32_t_metatable;
+
+static uint32_t *test_uint32_t(lua_State *L, int arg) {
+    void *data = lua_touserdata(L, arg);
+    if ((data != nullptr) && lua_getmetatable(L, arg)) {
+        const bool match = lua_topointer(L, -1) == uint32_t_metatable;
+        lua_pop(L, 1);
+        if (match) {
+            return static_cast<uint32_t *>(data);
+        }
+    }
+    return nullptr;
+}
+
 static uint32_t coerce_to_uint32_t(lua_State *L, int arg) {
     { // userdata
-        const uint32_t * ud = static_cast<uint32_t *>(luaL_testudata(L, arg, "uint32_t"));
+        const uint32_t * ud = test_uint32_t(L, arg);
         if (ud != nullptr) {
             return *ud;
         }
@@ -58,8 +74,25 @@ int lua_new_uint32_t(lua_State *L) {
 }
 
 uint32_t * check_uint32_t(lua_State *L, int arg) {
-    void *data = luaL_checkudata(L, arg, "uint32_t");
-    return static_cast<uint32_t *>(data);
+    uint32_t *data = test_uint32_t(L, arg);
+    if (data != nullptr) {
+        return data;
+    }
+    // not a uint32_t, let lua raise the error
+    return static_cast<uint32_t *>(luaL_checkudata(L, arg, "uint32_t"));
+}
+
+// pushes a box for a result, reusing the uint32_t passed as argument arg
+// rather than allocating a new one, unless arg is 0 or nil
+uint32_t * push_uint32_t(lua_State *L, int arg) {
+    if ((arg == 0) || lua_isnil(L, arg)) {
+        new_uint32_t(L);
+    } else {
+        check_uint32_t(L, arg);
+        luaL_checkstack(L, 1, "Out of stack");
+        lua_pushvalue(L, arg);
+    }
+    return static_cast<uint32_t *>(lua_touserdata(L, -1));
 }
 
 #define UINT32_T_BOX_OP(name, sym) \
@@ -75,7 +108,7 @@ uint32_t * check_uint32_t(lua_State *L, int arg) {
         uint32_t v2 = coerce_to_uint32_t(L, 2); \
           \
         new_uint32_t(L); \
-        *static_cast<uint32_t *>(luaL_checkudata(L, -1, "uint32_t")) = v1 sym v2; \
+        *check_uint32_t(L, -1) = v1 sym v2; \
         return 1; \
     }
 
@@ -123,7 +156,7 @@ UINT32_T_BOX_OP_BOOL(le, <=)
         uint32_t v1 = coerce_to_uint32_t(L, 1); \
           \
         new_uint32_t(L); \
-        *static_cast<uint32_t *>(luaL_checkudata(L, -1, "uint32_t")) = sym v1; \
+        *check_uint32_t(L, -1) = sym v1; \
         return 1; \
     }
 
@@ -136,7 +169,7 @@ static int uint32_t_toint(lua_State *L) {
         return luaL_argerror(L, args, "Expected 1 argument");
     }
 
-    uint32_t v = *static_cast<uint32_t *>(luaL_checkudata(L, 1, "uint32_t"));
+    uint32_t v = *check_uint32_t(L, 1);
 
     lua_pushinteger(L, static_cast<lua_Integer>(v));
 
@@ -149,7 +182,7 @@ static int uint32_t_tofloat(lua_State *L) {
         return luaL_argerror(L, args, "Expected 1 argument");
     }
 
-    uint32_t v = *static_cast<uint32_t *>(luaL_checkudata(L, 1, "uint32_t"));
+    uint32_t v = *check_uint32_t(L, 1);
 
     lua_pushnumber(L, static_cast<lua_Number>(v));
 
@@ -162,7 +195,7 @@ static int uint32_t___tostring(lua_State *L) {
         return luaL_argerror(L, args, "Expected 1 argument");
     }
 
-    uint32_t v = *static_cast<uint32_t *>(luaL_checkudata(L, 1, "uint32_t"));
+    uint32_t v = *check_uint32_t(L, 1);
 
     char buf[32];
     hal.util->snprintf(buf, ARRAY_SIZE(buf), "%u", (unsigned)v);
@@ -198,6 +231,7 @@ const luaL_Reg uint32_t_meta[] = {
 void load_boxed_numerics(lua_State *L) {
     luaL_checkstack(L, 5, "Out of stack");
     luaL_newmetatable(L, "uint32_t");
+    uint32_t_metatable = lua_topointer(L, -1);
     luaL_setfuncs(L, uint32_t_meta, 0);
     lua_pushstring(L, "__index");
     lua_pushvalue(L, -2);
@@ -9,6 +9,8 @@
 #include <AP_Terrain/AP_Terrain.h>
 #include <AP_RangeFinder/AP_RangeFinder.h>
 #include <AP_Notify/AP_Notify.h>
+#include <Filter/NotchFilter.h>
+#include <Filter/LowPassFilter.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_GPS/AP_GPS.h>
 #include <AP_BattMonitor/AP_BattMonitor.h>
@@ -33,6 +35,36 @@ static int binding_argcheck(lua_State *L, int expected_arg_count) {
     return 0;
 }
 
+static int binding_argcheck_range(lua_State *L, int min_arg_count, int max_arg_count) {
+    const int args = lua_gettop(L);
+    if (args > max_arg_count) {
+        return luaL_argerror(L, args, "too many arguments");
+    } else if (args < min_arg_count) {
+        return luaL_argerror(L, args, "too few arguments");
+    }
+    return args;
+}
+
+int new_NotchFilterFloat(lua_State *L) {
+    luaL_checkstack(L, 2, "Out of stack");
+    void *ud = lua_newuserdata(L, sizeof(NotchFilterFloat));
+    memset(ud, 0, sizeof(NotchFilterFloat));
+    new (ud) NotchFilterFloat();
+    luaL_getmetatable(L, "NotchFilterFloat");
+    lua_setmetatable(L, -2);
+    return 1;
+}
+
+int new_LowPassFilterFloat(lua_State *L) {
+    luaL_checkstack(L, 2, "Out of stack");
+    void *ud = lua_newuserdata(L, sizeof(LowPassFilterFloat));
+    memset(ud, 0, sizeof(LowPassFilterFloat));
+    new (ud) LowPassFilterFloat();
+    luaL_getmetatable(L, "LowPassFilterFloat");
+    lua_setmetatable(L, -2);
+    return 1;
+}
+
 int new_Vector2f(lua_State *L) {
     luaL_checkstack(L, 2, "Out of stack");
     void *ud = lua_newuserdata(L, sizeof(Vector2f));
@@ -63,19 +95,134 @@ int new_Location(lua_State *L) {
     return 1;
 }
 
+static const void *NotchFilterFloat_metatable;
+
+NotchFilterFloat * check_NotchFilterFloat(lua_State *L, int arg) {
+    void *data = lua_touserdata(L, arg);
+    if ((data != nullptr) && lua_getmetatable(L, arg)) {
+        const bool match = lua_topointer(L, -1) == NotchFilterFloat_metatable;
+        lua_pop(L, 1);
+        if (match) {
+            return (NotchFilterFloat *)data;
+        }
+    }
+    // not a NotchFilterFloat, let lua raise the error
+    return (NotchFilterFloat *)luaL_checkudata(L, arg, "NotchFilterFloat");
+}
+
+static const void *LowPassFilterFloat_metatable;
+
+LowPassFilterFloat * check_LowPassFilterFloat(lua_State *L, int arg) {
+    void *data = lua_touserdata(L, arg);
+    if ((data != nullptr) && lua_getmetatable(L, arg)) {
+        const bool match = lua_topointer(L, -1) == LowPassFilterFloat_metatable;
+        lua_pop(L, 1);
+        if (match) {
+            return (LowPassFilterFloat *)data;
+        }
+    }
+    // not a LowPassFilterFloat, let lua raise the error
+    return (LowPassFilterFloat *)luaL_checkudata(L, arg, "LowPassFilterFloat");
+}
+
+static const void *Vector2f_metatable;
+
 Vector2f * check_Vector2f(lua_State *L, int arg) {
-    void *data = luaL_checkudata(L, arg, "Vector2f");
-    return (Vector2f *)data;
+    void *data = lua_touserdata(L, arg);
+    if ((data != nullptr) && lua_getmetatable(L, arg)) {
+        const bool match = lua_topointer(L, -1) == Vector2f_metatable;
+        lua_pop(L, 1);
+        if (match) {
+            return (Vector2f *)data;
+        }
+    }
+    // not a Vector2f, let lua raise the error
+    return (Vector2f *)luaL_checkudata(L, arg, "Vector2f");
 }
 
+static const void *Vector3f_metatable;
+
 Vector3f * check_Vector3f(lua_State *L, int arg) {
-    void *data = luaL_checkudata(L, arg, "Vector3f");
-    return (Vector3f *)data;
+    void *data = lua_touserdata(L, arg);
+    if ((data != nullptr) && lua_getmetatable(L, arg)) {
+        const bool match = lua_topointer(L, -1) == Vector3f_metatable;
+        lua_pop(L, 1);
+        if (match) {
+            return (Vector3f *)data;
+        }
+    }
+    // not a Vector3f, let lua raise the error
+    return (Vector3f *)luaL_checkudata(L, arg, "Vector3f");
 }
 
+static const void *Location_metatable;
+
 Location * check_Location(lua_State *L, int arg) {
-    void *data = luaL_checkudata(L, arg, "Location");
-    return (Location *)data;
+    void *data = lua_touserdata(L, arg);
+    if ((data != nullptr) && lua_getmetatable(L, arg)) {
+        const bool match = lua_topointer(L, -1) == Location_metatable;
+        lua_pop(L, 1);
+        if (match) {
+            return (Location *)data;
+        }
+    }
+    // not a Location, let lua raise the error
+    return (Location *)luaL_checkudata(L, arg, "Location");
+}
+
+NotchFilterFloat * push_NotchFilterFloat(lua_State *L, int arg) {
+    if ((arg == 0) || lua_isnil(L, arg)) {
+        new_NotchFilterFloat(L);
+    } else {
+        check_NotchFilterFloat(L, arg);
+        luaL_checkstack(L, 1, "Out of stack");
+        lua_pushvalue(L, arg);
+    }
+    return (NotchFilterFloat *)lua_touserdata(L, -1);
+}
+
+LowPassFilterFloat * push_LowPassFilterFloat(lua_State *L, int arg) {
+    if ((arg == 0) || lua_isnil(L, arg)) {
+        new_LowPassFilterFloat(L);
+    } else {
+        check_LowPassFilterFloat(L, arg);
+        luaL_checkstack(L, 1, "Out of stack");
+        lua_pushvalue(L, arg);
+    }
+    return (LowPassFilterFloat *)lua_touserdata(L, -1);
+}
+
+Vector2f * push_Vector2f(lua_State *L, int arg) {
+    if ((arg == 0) || lua_isnil(L, arg)) {
+        new_Vector2f(L);
+    } else {
+        check_Vector2f(L, arg);
+        luaL_checkstack(L, 1, "Out of stack");
+        lua_pushvalue(L, arg);
+    }
+    return (Vector2f *)lua_touserdata(L, -1);
+}
+
+Vector3f * push_Vector3f(lua_State *L, int arg) {
+    if ((arg == 0) || lua_isnil(L, arg)) {
+        new_Vector3f(L);
+    } else {
+        check_Vector3f(L, arg);
+        luaL_checkstack(L, 1, "Out of stack");
+        lua_pushvalue(L, arg);
+    }
+    return (Vector3f *)lua_touserdata(L, -1);
+}
+
+Location * push_Location(lua_State *L, int arg) {
+    if ((arg == 0) || lua_isnil(L, arg)) {
+        new_Location(L);
+    } else {
+        check_Location(L, arg);
+        luaL_checkstack(L, 1, "Out of stack");
+        lua_pushvalue(L, arg);
+    }
+    return (Location *)lua_touserdata(L, -1);
 }
 
 static int Vector2f_y(lua_State *L) {
@@ -268,6 +415,138 @@ static int Location_lat(lua_State *L) {
     }
 }
 
+static int NotchFilterFloat_reset(lua_State *L) {
+    binding_argcheck(L, 1);
+    NotchFilterFloat * ud = check_NotchFilterFloat(L, 1);
+    ud->reset();
+
+    return 0;
+}
+
+static int NotchFilterFloat_apply(lua_State *L) {
+    binding_argcheck(L, 2);
+    NotchFilterFloat * ud = check_NotchFilterFloat(L, 1);
+    const float raw_data_2 = luaL_checknumber(L, 2);
+    luaL_argcheck(L, ((raw_data_2 >= MAX(-FLT_MAX, -INFINITY)) && (raw_data_2 <= MIN(FLT_MAX, INFINITY))), 2, "argument out of range");
+    const float data_2 = raw_data_2;
+    const float data = ud->apply(
+            data_2);
+
+    lua_pushnumber(L, data);
+    return 1;
+}
+
+static int NotchFilterFloat_init(lua_State *L) {
+    binding_argcheck(L, 5);
+    NotchFilterFloat * ud = check_NotchFilterFloat(L, 1);
+    const float raw_data_2 = luaL_checknumber(L, 2);
+    luaL_argcheck(L, ((raw_data_2 >= MAX(0, -INFINITY)) && (raw_data_2 <= MIN(FLT_MAX, INFINITY))), 2, "argument out of range");
+    const float data_2 = raw_data_2;
+    const float raw_data_3 = luaL_checknumber(L, 3);
+    luaL_argcheck(L, ((raw_data_3 >= MAX(0, -INFINITY)) && (raw_data_3 <= MIN(FLT_MAX, INFINITY))), 3, "argument out of range");
+    const float data_3 = raw_data_3;
+    const float raw_data_4 = luaL_checknumber(L, 4);
+    luaL_argcheck(L, ((raw_data_4 >= MAX(0, -INFINITY)) && (raw_data_4 <= MIN(FLT_MAX, INFINITY))), 4, "argument out of range");
+    const float data_4 = raw_data_4;
+    const float raw_data_5 = luaL_checknumber(L, 5);
+    luaL_argcheck(L, ((raw_data_5 >= MAX(0, -INFINITY)) && (raw_data_5 <= MIN(FLT_MAX, INFINITY))), 5, "argument out of range");
+    const float data_5 = raw_data_5;
+    ud->init(
+            data_2,
+            data_3,
+            data_4,
+            data_5);
+
+    return 0;
+}
+
+static int LowPassFilterFloat_reset(lua_State *L) {
+    binding_argcheck(L, 2);
+    LowPassFilterFloat * ud = check_LowPassFilterFloat(L, 1);
+    const float raw_data_2 = luaL_checknumber(L, 2);
+    luaL_argcheck(L, ((raw_data_2 >= MAX(-FLT_MAX, -INFINITY)) && (raw_data_2 <= MIN(FLT_MAX, INFINITY))), 2, "argument out of range");
+    const float data_2 = raw_data_2;
+    ud->reset(
+            data_2);
+
+    return 0;
+}
+
+static int LowPassFilterFloat_get(lua_State *L) {
+    binding_argcheck(L, 1);
+    LowPassFilterFloat * ud = check_LowPassFilterFloat(L, 1);
+    const float data = ud->get();
+
+    lua_pushnumber(L, data);
+    return 1;
+}
+
+static int LowPassFilterFloat_apply(lua_State *L) {
+    binding_argcheck(L, 3);
+    LowPassFilterFloat * ud = check_LowPassFilterFloat(L, 1);
+    const float raw_data_2 = luaL_checknumber(L, 2);
+    luaL_argcheck(L, ((raw_data_2 >= MAX(-FLT_MAX, -INFINITY)) && (raw_data_2 <= MIN(FLT_MAX, INFINITY))), 2, "argument out of range");
+    const float data_2 = raw_data_2;
+    const float raw_data_3 = luaL_checknumber(L, 3);
+    luaL_argcheck(L, ((raw_data_3 >= MAX(0, -INFINITY)) && (raw_data_3 <= MIN(FLT_MAX, INFINITY))), 3, "argument out of range");
+    const float data_3 = raw_data_3;
+    const float data = ud->apply(
+            data_2,
+            data_3);
+
+    lua_pushnumber(L, data);
+    return 1;
+}
+
+static int LowPassFilterFloat_get_cutoff_freq(lua_State *L) {
+    binding_argcheck(L, 1);
+    LowPassFilterFloat * ud = check_LowPassFilterFloat(L, 1);
+    const float data = ud->get_cutoff_freq();
+
+    lua_pushnumber(L, data);
+    return 1;
+}
+
+static int LowPassFilterFloat_set_cutoff_frequency(lua_State *L) {
+    binding_argcheck(L, 2);
+    LowPassFilterFloat * ud = check_LowPassFilterFloat(L, 1);
+    const float raw_data_2 = luaL_checknumber(L, 2);
+    luaL_argcheck(L, ((raw_data_2 >= MAX(0, -INFINITY)) && (raw_data_2 <= MIN(FLT_MAX, INFINITY))), 2, "argument out of range");
+    const float data_2 = raw_data_2;
+    ud->set_cutoff_frequency(
+            data_2);
+
+    return 0;
+}
+
+static int Vector2f_angle(lua_State *L) {
+    binding_argcheck(L, 2);
+    Vector2f * ud = check_Vector2f(L, 1);
+    Vector2f & data_2 = *check_Vector2f(L, 2);
+    const float data = ud->angle(
+            data_2);
+
+    lua_pushnumber(L, data);
+    return 1;
+}
+
+static int Vector2f_length_squared(lua_State *L) {
+    binding_argcheck(L, 1);
+    Vector2f * ud = check_Vector2f(L, 1);
+    const float data = ud->length_squared();
+
+    lua_pushnumber(L, data);
+    return 1;
+}
+
+static int Vector2f_zero(lua_State *L) {
+    binding_argcheck(L, 1);
+    Vector2f * ud = check_Vector2f(L, 1);
+    ud->zero();
+
+    return 0;
+}
+
 static int Vector2f_is_zero(lua_State *L) {
     binding_argcheck(L, 1);
     Vector2f * ud = check_Vector2f(L, 1);
@@ -330,6 +609,58 @@ static int Vector2f___sub(lua_State *L) {
     return 1;
 }
 
+static int Vector3f_distance_to_segment(lua_State *L) {
+    binding_argcheck(L, 3);
+    Vector3f * ud = check_Vector3f(L, 1);
+    Vector3f & data_2 = *check_Vector3f(L, 2);
+    Vector3f & data_3 = *check_Vector3f(L, 3);
+    const float data = ud->distance_to_segment(
+            data_2,
+            data_3);
+
+    lua_pushnumber(L, data);
+    return 1;
+}
+
+static int Vector3f_distance_squared(lua_State *L) {
+    binding_argcheck(L, 2);
+    Vector3f * ud = check_Vector3f(L, 1);
+    Vector3f & data_2 = *check_Vector3f(L, 2);
+    const float data = ud->distance_squared(
+            data_2);
+
+    lua_pushnumber(L, data);
+    return 1;
+}
+
+static int Vector3f_angle(lua_State *L) {
+    binding_argcheck(L, 2);
+    Vector3f * ud = check_Vector3f(L, 1);
+    Vector3f & data_2 = *check_Vector3f(L, 2);
+    const float data = ud->angle(
+            data_2);
+
+    lua_pushnumber(L, data);
+    return 1;
+}
+
+static int Vector3f_length_squared(lua_State *L) {
+    binding_argcheck(L, 1);
+    Vector3f * ud = check_Vector3f(L, 1);
+    const float data = ud->length_squared();
+
+    lua_pushnumber(L, data);
+    return 1;
+}
+
+static int Vector3f_zero(lua_State *L) {
+    binding_argcheck(L, 1);
+    Vector3f * ud = check_Vector3f(L, 1);
+    ud->zero();
+
+    return 0;
+}
+
 static int Vector3f_is_zero(lua_State *L) {
     binding_argcheck(L, 1);
     Vector3f * ud = check_Vector3f(L, 1);
@@ -392,6 +723,44 @@ static int Vector3f___sub(lua_State *L) {
     return 1;
 }
 
+static int Location_offset_bearing(lua_State *L) {
+    binding_argcheck(L, 3);
+    Location * ud = check_Location(L, 1);
+    const float raw_data_2 = luaL_checknumber(L, 2);
+    luaL_argcheck(L, ((raw_data_2 >= MAX(-FLT_MAX, -INFINITY)) && (raw_data_2 <= MIN(FLT_MAX, INFINITY))), 2, "argument out of range");
+    const float data_2 = raw_data_2;
+    const float raw_data_3 = luaL_checknumber(L, 3);
+    luaL_argcheck(L, ((raw_data_3 >= MAX(-FLT_MAX, -INFINITY)) && (raw_data_3 <= MIN(FLT_MAX, INFINITY))), 3, "argument out of range");
+    const float data_3 = raw_data_3;
+    ud->offset_bearing(
+            data_2,
+            data_3);
+
+    return 0;
+}
+
+static int Location_get_distance_NED(lua_State *L) {
+    const int args = binding_argcheck_range(L, 2, 3);
+    Location * ud = check_Location(L, 1);
+    Location & data_2 = *check_Location(L, 2);
+    const Vector3f &data = ud->get_distance_NED(
+            data_2);
+
+    *push_Vector3f(L, (args >= 3) ? 3 : 0) = data;
+    return 1;
+}
+
+static int Location_get_distance_NE(lua_State *L) {
+    const int args = binding_argcheck_range(L, 2, 3);
+    Location * ud = check_Location(L, 1);
+    Location & data_2 = *check_Location(L, 2);
+    const Vector2f &data = ud->get_distance_NE(
+            data_2);
+
+    *push_Vector2f(L, (args >= 3) ? 3 : 0) = data;
+    return 1;
+}
+
 static int Location_get_bearing(lua_State *L) {
     binding_argcheck(L, 2);
     Location * ud = check_Location(L, 1);
@@ -404,15 +773,14 @@ static int Location_get_bearing(lua_State *L) {
 }
 
 static int Location_get_vector_from_origin_NEU(lua_State *L) {
-    binding_argcheck(L, 1);
+    const int args = binding_argcheck_range(L, 1, 2);
     Location * ud = check_Location(L, 1);
     Vector3f data_5002 = {};
     const bool data = ud->get_vector_from_origin_NEU(
             data_5002);
 
     if (data) {
-        new_Vector3f(L);
-        *check_Vector3f(L, -1) = data_5002;
+        *push_Vector3f(L, (args >= 2) ? 2 : 0) = data_5002;
     } else {
         lua_pushnil(L);
     }
@@ -446,9 +814,28 @@ static int Location_get_distance(lua_State *L) {
     return 1;
 }
 
+const luaL_Reg NotchFilterFloat_meta[] = {
+    {"reset", NotchFilterFloat_reset},
+    {"apply", NotchFilterFloat_apply},
+    {"init", NotchFilterFloat_init},
+    {NULL, NULL}
+};
+
+const luaL_Reg LowPassFilterFloat_meta[] = {
+    {"reset", LowPassFilterFloat_reset},
+    {"get", LowPassFilterFloat_get},
+    {"apply", LowPassFilterFloat_apply},
+    {"get_cutoff_freq", LowPassFilterFloat_get_cutoff_freq},
+    {"set_cutoff_frequency", LowPassFilterFloat_set_cutoff_frequency},
+    {NULL, NULL}
+};
+
 const luaL_Reg Vector2f_meta[] = {
     {"y", Vector2f_y},
     {"x", Vector2f_x},
+    {"angle", Vector2f_angle},
+    {"length_squared", Vector2f_length_squared},
+    {"zero", Vector2f_zero},
     {"is_zero", Vector2f_is_zero},
     {"is_inf", Vector2f_is_inf},
     {"is_nan", Vector2f_is_nan},
@@ -463,6 +850,11 @@ const luaL_Reg Vector3f_meta[] = {
     {"z", Vector3f_z},
     {"y", Vector3f_y},
     {"x", Vector3f_x},
+    {"distance_to_segment", Vector3f_distance_to_segment},
+    {"distance_squared", Vector3f_distance_squared},
+    {"angle", Vector3f_angle},
+    {"length_squared", Vector3f_length_squared},
+    {"zero", Vector3f_zero},
     {"is_zero", Vector3f_is_zero},
     {"is_inf", Vector3f_is_inf},
     {"is_nan", Vector3f_is_nan},
@@ -480,6 +872,9 @@ const luaL_Reg Location_meta[] = {
     {"relative_alt", Location_relative_alt},
     {"lng", Location_lng},
     {"lat", Location_lat},
+    {"offset_bearing", Location_offset_bearing},
+    {"get_distance_NED", Location_get_distance_NED},
+    {"get_distance_NE", Location_get_distance_NE},
     {"get_bearing", Location_get_bearing},
     {"get_vector_from_origin_NEU", Location_get_vector_from_origin_NEU},
     {"offset", Location_offset},
@@ -870,15 +1265,14 @@ static int AP_GPS_get_antenna_offset(lua_State *L) {
         return luaL_argerror(L, 1, "gps not supported on this firmware");
     }
 
-    binding_argcheck(L, 2);
+    const int args = binding_argcheck_range(L, 2, 3);
     const lua_Integer raw_data_2 = luaL_checkinteger(L, 2);
     luaL_argcheck(L, ((raw_data_2 >= MAX(0, 0)) && (raw_data_2 <= MIN(ud->num_sensors(), UINT8_MAX))), 2, "argument out of range");
     const uint8_t data_2 = static_cast<uint8_t>(raw_data_2);
     const Vector3f &data = ud->get_antenna_offset(
             data_2);
 
-    new_Vector3f(L);
-    *check_Vector3f(L, -1) = data;
+    *push_Vector3f(L, (args >= 3) ? 3 : 0) = data;
     return 1;
 }
 
@@ -905,15 +1299,14 @@ static int AP_GPS_last_message_time_ms(lua_State *L) {
         return luaL_argerror(L, 1, "gps not supported on this firmware");
     }
 
-    binding_argcheck(L, 2);
+    const int args = binding_argcheck_range(L, 2, 3);
     const lua_Integer raw_data_2 = luaL_checkinteger(L, 2);
     luaL_argcheck(L, ((raw_data_2 >= MAX(0, 0)) && (raw_data_2 <= MIN(ud->num_sensors(), UINT8_MAX))), 2, "argument out of range");
     const uint8_t data_2 = static_cast<uint8_t>(raw_data_2);
     const uint32_t data = ud->last_message_time_ms(
             data_2);
 
-        new_uint32_t(L);
-        *static_cast<uint32_t *>(luaL_checkudata(L, -1, "uint32_t")) = data;
+    *push_uint32_t(L, (args >= 3) ? 3 : 0) = data;
     return 1;
 }
 
@@ -923,15 +1316,14 @@ static int AP_GPS_last_fix_time_ms(lua_State *L) {
         return luaL_argerror(L, 1, "gps not supported on this firmware");
     }
 
-    binding_argcheck(L, 2);
+    const int args = binding_argcheck_range(L, 2, 3);
     const lua_Integer raw_data_2 = luaL_checkinteger(L, 2);
     luaL_argcheck(L, ((raw_data_2 >= MAX(0, 0)) && (raw_data_2 <= MIN(ud->num_sensors(), UINT8_MAX))), 2, "argument out of range");
     const uint8_t data_2 = static_cast<uint8_t>(raw_data_2);
     const uint32_t data = ud->last_fix_time_ms(
             data_2);
 
-        new_uint32_t(L);
-        *static_cast<uint32_t *>(luaL_checkudata(L, -1, "uint32_t")) = data;
+    *push_uint32_t(L, (args >= 3) ? 3 : 0) = data;
     return 1;
 }
 
@@ -975,15 +1367,14 @@ static int AP_GPS_time_week_ms(lua_State *L) {
         return luaL_argerror(L, 1, "gps not supported on this firmware");
     }
 
-    binding_argcheck(L, 2);
+    const int args = binding_argcheck_range(L, 2, 3);
     const lua_Integer raw_data_2 = luaL_checkinteger(L, 2);
     luaL_argcheck(L, ((raw_data_2 >= MAX(0, 0)) && (raw_data_2 <= MIN(ud->num_sensors(), UINT8_MAX))), 2, "argument out of range");
     const uint8_t data_2 = static_cast<uint8_t>(raw_data_2);
     const uint32_t data = ud->time_week_ms(
             data_2);
 
-        new_uint32_t(L);
-        *static_cast<uint32_t *>(luaL_checkudata(L, -1, "uint32_t")) = data;
+    *push_uint32_t(L, (args >= 3) ? 3 : 0) = data;
     return 1;
 }
 
@@ -1061,15 +1452,14 @@ static int AP_GPS_velocity(lua_State *L) {
         return luaL_argerror(L, 1, "gps not supported on this firmware");
     }
 
-    binding_argcheck(L, 2);
+    const int args = binding_argcheck_range(L, 2, 3);
     const lua_Integer raw_data_2 = luaL_checkinteger(L, 2);
     luaL_argcheck(L, ((raw_data_2 >= MAX(0, 0)) && (raw_data_2 <= MIN(ud->num_sensors(), UINT8_MAX))), 2, "argument out of range");
     const uint8_t data_2 = static_cast<uint8_t>(raw_data_2);
     const Vector3f &data = ud->velocity(
             data_2);
 
-    new_Vector3f(L);
-    *check_Vector3f(L, -1) = data;
+    *push_Vector3f(L, (args >= 3) ? 3 : 0) = data;
     return 1;
 }
 
@@ -1148,15 +1538,14 @@ static int AP_GPS_location(lua_State *L) {
         return luaL_argerror(L, 1, "gps not supported on this firmware");
     }
 
-    binding_argcheck(L, 2);
+    const int args = binding_argcheck_range(L, 2, 3);
     const lua_Integer raw_data_2 = luaL_checkinteger(L, 2);
     luaL_argcheck(L, ((raw_data_2 >= MAX(0, 0)) && (raw_data_2 <= MIN(ud->num_sensors(), UINT8_MAX))), 2, "argument out of range");
     const uint8_t data_2 = static_cast<uint8_t>(raw_data_2);
     const Location &data = ud->location(
             data_2);
 
-    new_Location(L);
-    *check_Location(L, -1) = data;
+    *push_Location(L, (args >= 3) ? 3 : 0) = data;
     return 1;
 }
 
@@ -1521,7 +1910,7 @@ static int AP_AHRS_get_relative_position_NED_home(lua_State *L) {
         return luaL_argerror(L, 1, "ahrs not supported on this firmware");
     }
 
-    binding_argcheck(L, 1);
+    const int args = binding_argcheck_range(L, 1, 2);
     Vector3f data_5002 = {};
     ud->get_semaphore().take_blocking();
     const bool data = ud->get_relative_position_NED_home(
@@ -1529,8 +1918,7 @@ static int AP_AHRS_get_relative_position_NED_home(lua_State *L) {
 
     ud->get_semaphore().give();
     if (data) {
-        new_Vector3f(L);
-        *check_Vector3f(L, -1) = data_5002;
+        *push_Vector3f(L, (args >= 2) ? 2 : 0) = data_5002;
     } else {
         lua_pushnil(L);
     }
@@ -1543,7 +1931,7 @@ static int AP_AHRS_get_velocity_NED(lua_State *L) {
         return luaL_argerror(L, 1, "ahrs not supported on this firmware");
     }
 
-    binding_argcheck(L, 1);
+    const int args = binding_argcheck_range(L, 1, 2);
     Vector3f data_5002 = {};
     ud->get_semaphore().take_blocking();
     const bool data = ud->get_velocity_NED(
@@ -1551,8 +1939,7 @@ static int AP_AHRS_get_velocity_NED(lua_State *L) {
 
     ud->get_semaphore().give();
     if (data) {
-        new_Vector3f(L);
-        *check_Vector3f(L, -1) = data_5002;
+        *push_Vector3f(L, (args >= 2) ? 2 : 0) = data_5002;
     } else {
         lua_pushnil(L);
     }
@@ -1565,13 +1952,12 @@ static int AP_AHRS_groundspeed_vector(lua_State *L) {
         return luaL_argerror(L, 1, "ahrs not supported on this firmware");
     }
 
-    binding_argcheck(L, 1);
+    const int args = binding_argcheck_range(L, 1, 2);
     ud->get_semaphore().take_blocking();
     const Vector2f &data = ud->groundspeed_vector();
 
     ud->get_semaphore().give();
-    new_Vector2f(L);
-    *check_Vector2f(L, -1) = data;
+    *push_Vector2f(L, (args >= 2) ? 2 : 0) = data;
     return 1;
 }
 
@@ -1581,13 +1967,12 @@ static int AP_AHRS_wind_estimate(lua_State *L) {
         return luaL_argerror(L, 1, "ahrs not supported on this firmware");
     }
 
-    binding_argcheck(L, 1);
+    const int args = binding_argcheck_range(L, 1, 2);
     ud->get_semaphore().take_blocking();
     const Vector3f &data = ud->wind_estimate();
 
     ud->get_semaphore().give();
-    new_Vector3f(L);
-    *check_Vector3f(L, -1) = data;
+    *push_Vector3f(L, (args >= 2) ? 2 : 0) = data;
     return 1;
 }
 
@@ -1618,13 +2003,12 @@ static int AP_AHRS_get_gyro(lua_State *L) {
         return luaL_argerror(L, 1, "ahrs not supported on this firmware");
     }
 
-    binding_argcheck(L, 1);
+    const int args = binding_argcheck_range(L, 1, 2);
     ud->get_semaphore().take_blocking();
     const Vector3f &data = ud->get_gyro();
 
     ud->get_semaphore().give();
-    new_Vector3f(L);
-    *check_Vector3f(L, -1) = data;
+    *push_Vector3f(L, (args >= 2) ? 2 : 0) = data;
     return 1;
 }
 
@@ -1634,13 +2018,12 @@ static int AP_AHRS_get_home(lua_State *L) {
         return luaL_argerror(L, 1, "ahrs not supported on this firmware");
     }
 
-    binding_argcheck(L, 1);
+    const int args = binding_argcheck_range(L, 1, 2);
     ud->get_semaphore().take_blocking();
     const Location &data = ud->get_home();
 
     ud->get_semaphore().give();
-    new_Location(L);
-    *check_Location(L, -1) = data;
+    *push_Location(L, (args >= 2) ? 2 : 0) = data;
     return 1;
 }
 
@@ -1650,7 +2033,7 @@ static int AP_AHRS_get_position(lua_State *L) {
         return luaL_argerror(L, 1, "ahrs not supported on this firmware");
     }
 
-    binding_argcheck(L, 1);
+    const int args = binding_argcheck_range(L, 1, 2);
     Location data_5002 = {};
     ud->get_semaphore().take_blocking();
     const bool data = ud->get_position(
@@ -1658,8 +2041,7 @@ static int AP_AHRS_get_position(lua_State *L) {
 
     ud->get_semaphore().give();
     if (data) {
-        new_Location(L);
-        *check_Location(L, -1) = data_5002;
+        *push_Location(L, (args >= 2) ? 2 : 0) = data_5002;
     } else {
         lua_pushnil(L);
     }
@@ -1852,27 +2234,30 @@ struct userdata_meta {
     const char *name;
     const luaL_Reg *reg;
     const struct userdata_enum *enums;
+    const void **metatable;
 };
 
 const struct userdata_meta userdata_fun[] = {
-    {"Vector2f", Vector2f_meta, NULL},
-    {"Vector3f", Vector3f_meta, NULL},
-    {"Location", Location_meta, NULL},
+    {"NotchFilterFloat", NotchFilterFloat_meta, NULL, &NotchFilterFloat_metatable},
+    {"LowPassFilterFloat", LowPassFilterFloat_meta, NULL, &LowPassFilterFloat_metatable},
+    {"Vector2f", Vector2f_meta, NULL, &Vector2f_metatable},
+    {"Vector3f", Vector3f_meta, NULL, &Vector3f_metatable},
+    {"Location", Location_meta, NULL, &Location_metatable},
 };
 
 const struct userdata_meta singleton_fun[] = {
-    {"SRV_Channels", SRV_Channels_meta, NULL},
-    {"serialLED", AP_SerialLED_meta, NULL},
-    {"vehicle", AP_Vehicle_meta, NULL},
-    {"gcs", GCS_meta, NULL},
-    {"relay", AP_Relay_meta, NULL},
-    {"terrain", AP_Terrain_meta, AP_Terrain_enums},
-    {"rangefinder", RangeFinder_meta, NULL},
-    {"notify", AP_Notify_meta, NULL},
-    {"gps", AP_GPS_meta, AP_GPS_enums},
-    {"battery", AP_BattMonitor_meta, NULL},
-    {"arming", AP_Arming_meta, NULL},
-    {"ahrs", AP_AHRS_meta, NULL},
+    {"SRV_Channels", SRV_Channels_meta, NULL, NULL},
+    {"serialLED", AP_SerialLED_meta, NULL, NULL},
+    {"vehicle", AP_Vehicle_meta, NULL, NULL},
+    {"gcs", GCS_meta, NULL, NULL},
+    {"relay", AP_Relay_meta, NULL, NULL},
+    {"terrain", AP_Terrain_meta, AP_Terrain_enums, NULL},
+    {"rangefinder", RangeFinder_meta, NULL, NULL},
+    {"notify", AP_Notify_meta, NULL, NULL},
+    {"gps", AP_GPS_meta, AP_GPS_enums, NULL},
+    {"battery", AP_BattMonitor_meta, NULL, NULL},
+    {"arming", AP_Arming_meta, NULL, NULL},
+    {"ahrs", AP_AHRS_meta, NULL, NULL},
 };
 
 void load_generated_bindings(lua_State *L) {
@@ -1880,6 +2265,7 @@ void load_generated_bindings(lua_State *L) {
     // userdata metatables
     for (uint32_t i = 0; i < ARRAY_SIZE(userdata_fun); i++) {
         luaL_newmetatable(L, userdata_fun[i].name);
+        *userdata_fun[i].metatable = lua_topointer(L, -1);
         luaL_setfuncs(L, userdata_fun[i].reg, 0);
         lua_pushstring(L, "__index");
         lua_pushvalue(L, -2);
@@ -1932,6 +2318,8 @@ const struct userdata {
     const char *name;
     const lua_CFunction fun;
 } new_userdata[] = {
+    {"NotchFilterFloat", new_NotchFilterFloat},
+    {"LowPassFilterFloat", new_LowPassFilterFloat},
     {"Vector2f", new_Vector2f},
     {"Vector3f", new_Vector3f},
     {"Location", new_Location},
@@ -8,6 +8,8 @@
 #include <AP_Terrain/AP_Terrain.h>
 #include <AP_RangeFinder/AP_RangeFinder.h>
 #include <AP_Notify/AP_Notify.h>
+#include <Filter/NotchFilter.h>
+#include <Filter/LowPassFilter.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_GPS/AP_GPS.h>
 #include <AP_BattMonitor/AP_BattMonitor.h>
@@ -23,11 +25,20 @@
 #endif // !defined(AP_TERRAIN_AVAILABLE) || (AP_TERRAIN_AVAILABLE != 1)
 
 
+int new_NotchFilterFloat(lua_State *L);
+NotchFilterFloat * check_NotchFilterFloat(lua_State *L, int arg);
+NotchFilterFloat * push_NotchFilterFloat(lua_State *L, int arg);
+int new_LowPassFilterFloat(lua_State *L);
+LowPassFilterFloat * check_LowPassFilterFloat(lua_State *L, int arg);
+LowPassFilterFloat * push_LowPassFilterFloat(lua_State *L, int arg);
 int new_Vector2f(lua_State *L);
 Vector2f * check_Vector2f(lua_State *L, int arg);
+Vector2f * push_Vector2f(lua_State *L, int arg);
 int new_Vector3f(lua_State *L);
 Vector3f * check_Vector3f(lua_State *L, int arg);
+Vector3f * push_Vector3f(lua_State *L, int arg);
 int new_Location(lua_State *L);
 Location * check_Location(lua_State *L, int arg);
+Location * push_Location(lua_State *L, int arg);
 void load_generated_bindings(lua_State *L);
 void load_generated_sandbox(lua_State *L);
@@ -18,6 +18,8 @@
 #include <GCS_MAVLink/GCS.h>
 #include "AP_Scripting.h"
 #include <AP_ROMFS/AP_ROMFS.h>
+#include <AP_Math/crc.h>
+#include <AP_Logger/AP_Logger.h>
 
 #include "lua_generated_bindings.h"
 
@@ -29,22 +31,73 @@
   #endif //HAL_OS_FATFS_IO
 #endif // SCRIPTING_DIRECTORY
 
+// scripts embedded in ROMFS are under this directory, and are named
+// with this prefix in messages
+#define SCRIPTING_ROMFS_DIRECTORY "scripts"
+#define SCRIPTING_ROMFS_PREFIX "@ROMFS/"
+
 extern const AP_HAL::HAL& hal;
 
 bool lua_scripts::overtime;
 jmp_buf lua_scripts::panic_jmp;
 
-lua_scripts::lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int8 &debug_level)
+lua_scripts::script_info *lua_scripts::_running;
+uint32_t lua_scripts::_run_start_us;
+uint32_t lua_scripts::_run_instructions;
+uint32_t lua_scripts::_instruction_limit;
+uint32_t lua_scripts::_time_limit_us;
+uint16_t lua_scripts::_hook_count;
+uint32_t lua_scripts::_run_alloc;
+int32_t lua_scripts::_run_net;
+int32_t lua_scripts::_mem_limit;
+bool lua_scripts::_time_exceeded;
+bool lua_scripts::_mem_exceeded;
+
+lua_scripts::queued_event lua_scripts::_event_queue[SCRIPTING_EVENT_QUEUE_LENGTH];
+uint8_t lua_scripts::_event_head;
+uint8_t lua_scripts::_event_count;
+uint32_t lua_scripts::_events_dropped;
+uint32_t lua_scripts::_event_mask;
+uint8_t lua_scripts::_handler_count[uint8_t(AP_Scripting::Event::COUNT)];
+HAL_Semaphore lua_scripts::_event_sem;
+HAL_BinarySemaphore lua_scripts::_wake;
+lua_scripts::mavlink_subscription lua_scripts::_mavlink_subs[SCRIPTING_MAVLINK_SUBSCRIPTIONS];
+uint8_t lua_scripts::_mavlink_sub_count;
+
+lua_scripts::lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int8 &debug_level,
+                         const AP_Int32 &run_max_us, const AP_Int32 &mem_max, const AP_Int32 &gc_max_us)
     : _vm_steps(vm_steps),
-      _debug_level(debug_level) {
+      _debug_level(debug_level),
+      _run_max_us(run_max_us),
+      _mem_max(mem_max),
+      _gc_max_us(gc_max_us),
+      _heap_size(MAX(heap_size.get(), 1)) {
     _heap = hal.util->allocate_heap_memory(heap_size);
 }
 
+/*
+  the hook runs every _hook_count instructions, counting them and
+  checking the run against its instruction and time budgets
+ */
 void lua_scripts::hook(lua_State *L, lua_Debug *ar) {
+    _run_instructions += _hook_count;
+
+    if (!overtime) {
+        const bool out_of_time = _time_limit_us != 0 &&
+                                 AP_HAL::micros() - _run_start_us > _time_limit_us;
+        if (_run_instructions < _instruction_limit && !out_of_time) {
+            _hook_count = MIN(_instruction_limit - _run_instructions, uint32_t(SCRIPTING_HOOK_INTERVAL));
+            lua_sethook(L, hook, LUA_MASKCOUNT, _hook_count);
+            return;
+        }
+        _time_exceeded = out_of_time;
+    }
+
     lua_scripts::overtime = true;
 
     // we need to aggressively bail out as we are over time
     // so we will aggressively trap errors until we clear out
+    _hook_count = 1;
     lua_sethook(L, hook, LUA_MASKCOUNT, 1);
 
     luaL_error(L, "Exceeded CPU time");
@@ -57,8 +110,182 @@ int lua_scripts::atpanic(lua_State *L) {
     return 0;
 }
 
+#if SCRIPTING_BYTECODE_CACHE
+/*
+  a cached chunk is this header followed by the output of lua_dump().
+  It is only used if the source still has the size and modification
+  time it had when the cache was written, and the chunk passes its CRC
+ */
+struct PACKED bytecode_cache_header {
+    uint32_t magic;
+    uint32_t source_size;
+    uint32_t source_mtime;
+    uint32_t length;
+    uint32_t crc;
+};
+static const uint32_t BYTECODE_CACHE_MAGIC = 0x4C554331; // "LUC1"
+
+struct cache_io {
+    int fd;
+    uint32_t remaining;
+    uint32_t crc;
+    char buf[256];
+};
+
+// lua_Reader for a cached chunk
+static const char *cache_reader(lua_State *L, void *ud, size_t *size)
+{
+    cache_io *io = (cache_io *)ud;
+    const ssize_t n = AP::FS().read(io->fd, io->buf, MIN(sizeof(io->buf), io->remaining));
+    if (n <= 0) {
+        *size = 0;
+        return nullptr;
+    }
+    io->remaining -= n;
+    *size = n;
+    return io->buf;
+}
+
+// lua_Writer for a cached chunk
+static int cache_writer(lua_State *L, const void *p, size_t sz, void *ud)
+{
+    cache_io *io = (cache_io *)ud;
+    if (AP::FS().write(io->fd, p, sz) != (ssize_t)sz) {
+        return 1;
+    }
+    io->crc = crc_crc32(io->crc, (const uint8_t *)p, sz);
+    io->remaining += sz;
+    return 0;
+}
+
+char *lua_scripts::cache_filename(const char *filename) {
+    const size_t size = strlen(filename) + 2;
+    char *name = (char *)hal.util->heap_realloc(_heap, nullptr, size);
+    if (name != nullptr) {
+        snprintf(name, size, "%sc", filename);
+    }
+    return name;
+}
+
+/*
+  try to load filename from its cached chunk. The chunk is checked
+  before it is given to Lua, as Lua does not verify bytecode
+ */
+bool lua_scripts::load_cached_chunk(lua_State *L, const char *filename, const struct stat &st) {
+    char *name = cache_filename(filename);
+    if (name == nullptr) {
+        return false;
+    }
+    cache_io io;
+    io.fd = AP::FS().open(name, O_RDONLY);
+    hal.util->heap_realloc(_heap, name, 0);
+    if (io.fd == -1) {
+        return false;
+    }
+    bytecode_cache_header hdr;
+    bool ok = AP::FS().read(io.fd, &hdr, sizeof(hdr)) == sizeof(hdr) &&
+              hdr.magic == BYTECODE_CACHE_MAGIC &&
+              hdr.source_size == (uint32_t)st.st_size &&
+              hdr.source_mtime == (uint32_t)st.st_mtime;
+    if (ok) {
+        // check the CRC, then go back and load
+        io.crc = 0;
+        io.remaining = hdr.length;
+        while (io.remaining > 0) {
+            const ssize_t n = AP::FS().read(io.fd, io.buf, MIN(sizeof(io.buf), io.remaining));
+            if (n <= 0) {
+                break;
+            }
+            io.crc = crc_crc32(io.crc, (const uint8_t *)io.buf, n);
+            io.remaining -= n;
+        }
+        ok = io.remaining == 0 && io.crc == hdr.crc &&
+             AP::FS().lseek(io.fd, sizeof(hdr), SEEK_SET) == sizeof(hdr);
+    }
+    if (ok) {
+        io.remaining = hdr.length;
+        ok = lua_load(L, cache_reader, &io, filename, "b") == LUA_OK;
+        if (!ok) {
+            // probably from a different build
+            lua_pop(L, 1);
+        }
+    }
+    AP::FS().close(io.fd);
+    return ok;
+}
+
+/*
+  write the chunk on the top of the stack to the cache for filename
+ */
+void lua_scripts::save_cached_chunk(lua_State *L, const char *filename, const struct stat &st) {
+    char *name = cache_filename(filename);
+    if (name == nullptr) {
+        return;
+    }
+    cache_io io;
+    io.fd = AP::FS().open(name, O_WRONLY|O_CREAT|O_TRUNC);
+    if (io.fd == -1) {
+        hal.util->heap_realloc(_heap, name, 0);
+        return;
+    }
+    bytecode_cache_header hdr {};
+    io.crc = 0;
+    io.remaining = 0;
+    // the header is written last so a partial file is never valid
+    bool ok = AP::FS().write(io.fd, &hdr, sizeof(hdr)) == sizeof(hdr) &&
+              lua_dump(L, cache_writer, &io, 0) == 0;
+    if (ok) {
+        hdr.magic = BYTECODE_CACHE_MAGIC;
+        hdr.source_size = st.st_size;
+        hdr.source_mtime = st.st_mtime;
+        hdr.length = io.remaining;
+        hdr.crc = io.crc;
+        ok = AP::FS().lseek(io.fd, 0, SEEK_SET) == 0 &&
+             AP::FS().write(io.fd, &hdr, sizeof(hdr)) == sizeof(hdr) &&
+             AP::FS().fsync(io.fd) == 0;
+    }
+    AP::FS().close(io.fd);
+    if (!ok) {
+        AP::FS().unlink(name);
+    }
+    hal.util->heap_realloc(_heap, name, 0);
+}
+#endif // SCRIPTING_BYTECODE_CACHE
+
+int lua_scripts::load_chunk(lua_State *L, const char *filename) {
+    if (strncmp(filename, SCRIPTING_ROMFS_PREFIX, strlen(SCRIPTING_ROMFS_PREFIX)) == 0) {
+        uint32_t size;
+        const char *data = (const char *)AP_ROMFS::find_decompress(&filename[strlen(SCRIPTING_ROMFS_PREFIX)], size);
+        if (data == nullptr) {
+            lua_pushfstring(L, "cannot open %s", filename);
+            return LUA_ERRFILE;
+        }
+        const int error = luaL_loadbufferx(L, data, size, filename, "bt");
+        AP_ROMFS::free((const uint8_t *)data);
+        return error;
+    }
+
+#if SCRIPTING_BYTECODE_CACHE
+    struct stat st;
+    if (AP::FS().stat(filename, &st) == 0) {
+        if (load_cached_chunk(L, filename, st)) {
+            return LUA_OK;
+        }
+        const int error = luaL_loadfile(L, filename);
+        if (error == LUA_OK) {
+            save_cached_chunk(L, filename, st);
+        }
+        return error;
+    }
+#endif
+    return luaL_loadfile(L, filename);
+}
+
 lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename) {
-    if (int error = luaL_loadfile(L, filename)) {
+    // the chunk and its sandbox are the script's first resident memory
+    const int start_mem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+
+    if (int error = load_chunk(L, filename)) {
         switch (error) {
             case LUA_ERRSYNTAX:
                 gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: Syntax error in %s", filename);
@@ -89,8 +316,12 @@ lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename)
         return nullptr;
     }
 
+    memset(new_script, 0, sizeof(*new_script));
     new_script->name = filename;
     new_script->next = nullptr;
+    for (uint8_t i=0; i<ARRAY_SIZE(new_script->event_ref); i++) {
+        new_script->event_ref[i] = LUA_NOREF;
+    }
 
 
     // find and create a sandbox for the new chunk
@@ -105,6 +336,7 @@ lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename)
 
     new_script->lua_ref = luaL_ref(L, LUA_REGISTRYINDEX);   // cache the reference
     new_script->next_run_ms = AP_HAL::millis64() - 1; // force the script to be stale
+    new_script->mem_resident = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0) - start_mem;
 
     return new_script;
 }
@@ -153,6 +385,33 @@ void lua_scripts::load_all_scripts_in_dir(lua_State *L, const char *dirname) {
     AP::FS().closedir(d);
 }
 
+void lua_scripts::load_all_scripts_in_romfs(lua_State *L) {
+    uint16_t ofs = 0;
+    for (const char *fname = AP_ROMFS::dir_list(SCRIPTING_ROMFS_DIRECTORY, ofs);
+         fname != nullptr;
+         fname = AP_ROMFS::dir_list(SCRIPTING_ROMFS_DIRECTORY, ofs)) {
+        const size_t length = strlen(fname);
+        if ((length < 5 || strcmp(&fname[length-4], ".lua") != 0) &&
+            (length < 6 || strcmp(&fname[length-5], ".luac") != 0)) {
+            continue;
+        }
+
+        size_t size = strlen(SCRIPTING_ROMFS_PREFIX SCRIPTING_ROMFS_DIRECTORY) + length + 2;
+        char * filename = (char *) hal.util->heap_realloc(_heap, nullptr, size);
+        if (filename == nullptr) {
+            continue;
+        }
+        snprintf(filename, size, SCRIPTING_ROMFS_PREFIX SCRIPTING_ROMFS_DIRECTORY "/%s", fname);
+
+        script_info * script = load_script(L, filename);
+        if (script == nullptr) {
+            hal.util->heap_realloc(_heap, filename, 0);
+            continue;
+        }
+        reschedule_script(script);
+    }
+}
+
 void lua_scripts::run_next_script(lua_State *L) {
     if (scripts == nullptr) {
 #if defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
@@ -161,16 +420,13 @@ void lua_scripts::run_next_script(lua_State *L) {
         return;
     }
 
-    // reset the current script tracking information
-    overtime = false;
-
     // strip the selected script out of the list
-    script_info *script = scripts;
-    scripts = script->next;
-
-    // reset the hook to clear the counter
-    const int32_t vm_steps = MAX(_vm_steps, 1000);
-    lua_sethook(L, hook, LUA_MASKCOUNT, vm_steps);
+    script_info *script;
+    {
+        WITH_SEMAPHORE(_sem);
+        script = scripts;
+        scripts = script->next;
+    }
 
     // store top of stack so we can calculate the number of return values
     int stack_top = lua_gettop(L);
@@ -178,22 +434,21 @@ void lua_scripts::run_next_script(lua_State *L) {
     // pop the function to the top of the stack
     lua_rawgeti(L, LUA_REGISTRYINDEX, script->lua_ref);
 
-    if(lua_pcall(L, 0, LUA_MULTRET, 0)) {
-        if (overtime) {
-            // script has consumed an excessive amount of CPU time
-            gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: %s exceeded time limit (%d)", script->name,  (int)vm_steps);
-            remove_script(L, script);
-        } else {
-            gcs().send_text(MAV_SEVERITY_INFO, "Lua: %s", lua_tostring(L, -1));
-            hal.console->printf("Lua: Error: %s\n", lua_tostring(L, -1));
-            remove_script(L, script);
-        }
+    if (const int error = call_script(L, script, 0, LUA_MULTRET)) {
+        report_error(L, script, error);
+        remove_script(L, script);
         lua_pop(L, 1);
         return;
     } else {
         int returned = lua_gettop(L) - stack_top;
         switch (returned) {
             case 0:
+                if (has_handlers(script)) {
+                    // nothing to schedule, but it stays loaded for its events
+                    script->next_run_ms = UINT64_MAX;
+                    reschedule_script(script);
+                    break;
+                }
                 // no time to reschedule so bail out
                 remove_script(L, script);
                 break;
@@ -234,11 +489,85 @@ void lua_scripts::run_next_script(lua_State *L) {
      }
 }
 
+int lua_scripts::call_script(lua_State *L, script_info *script, int nargs, int nresults) {
+    // reset the current script tracking information
+    overtime = false;
+    _time_exceeded = false;
+    _mem_exceeded = false;
+    {
+        WITH_SEMAPHORE(_sem);
+        _running = script;
+    }
+
+    // reset the hook to clear the counter
+    _instruction_limit = MAX(_vm_steps, 1000);
+    _time_limit_us = MAX(_run_max_us.get(), 0);
+    _mem_limit = MAX(_mem_max.get(), 0);
+    _run_instructions = 0;
+    _run_alloc = 0;
+    _run_net = 0;
+    _hook_count = SCRIPTING_HOOK_INTERVAL;
+    lua_sethook(L, hook, LUA_MASKCOUNT, _hook_count);
+
+    _run_start_us = AP_HAL::micros();
+    const int error = lua_pcall(L, nargs, nresults, 0);
+    end_run(L, script, AP_HAL::micros() - _run_start_us);
+    return error;
+}
+
+void lua_scripts::report_error(lua_State *L, const script_info *script, int error) {
+    if (_time_exceeded) {
+        // script has run for longer than its budget
+        gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: %s exceeded run time budget (%u us)", script->name, (unsigned)_time_limit_us);
+    } else if (overtime) {
+        // script has consumed an excessive amount of CPU time
+        gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: %s exceeded time limit (%d)", script->name,  (int)_instruction_limit);
+    } else if (_mem_exceeded && error == LUA_ERRMEM) {
+        gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: %s exceeded memory budget (%d)", script->name, (int)_mem_limit);
+    } else {
+        gcs().send_text(MAV_SEVERITY_INFO, "Lua: %s", lua_tostring(L, -1));
+        hal.console->printf("Lua: Error: %s\n", lua_tostring(L, -1));
+    }
+}
+
+/*
+  add the run to the script's statistics. Without incremental
+  collection the garbage left by the run is collected first, so the
+  change in allocated memory is exactly what the script still holds
+ */
+void lua_scripts::end_run(lua_State *L, script_info *script, uint32_t run_time_us) {
+    if (!incremental_gc()) {
+        const uint32_t start_us = AP_HAL::micros();
+        lua_gc(L, LUA_GCCOLLECT, 0);
+        const uint32_t dt = AP_HAL::micros() - start_us;
+        _gc_time_us += dt;
+        _gc_time_max_us = MAX(_gc_time_max_us, dt);
+        _gc_cycles++;
+    }
+
+    WITH_SEMAPHORE(_sem);
+    _running = nullptr;
+    _gc_script = script;
+    script->run_count++;
+    script->run_time_us = run_time_us;
+    script->run_time_max_us = MAX(script->run_time_max_us, run_time_us);
+    script->run_time_total_us += run_time_us;
+    script->instructions = _run_instructions;
+    script->alloc_bytes = _run_alloc;
+    script->mem_resident = MAX(script->mem_resident + _run_net, 0);
+}
+
 void lua_scripts::remove_script(lua_State *L, script_info *script) {
     if (script == nullptr) {
         return;
     }
 
+    WITH_SEMAPHORE(_sem);
+
+    if (_gc_script == script) {
+        _gc_script = nullptr;
+    }
+
     // ensure that the script isn't in the loaded list for any reason
     if (scripts == nullptr) {
         // nothing to do, already not in the list
@@ -257,10 +586,87 @@ void lua_scripts::remove_script(lua_State *L, script_info *script) {
         // state could be null if we are force killing all scripts
         luaL_unref(L, LUA_REGISTRYINDEX, script->lua_ref);
     }
+
+    // drop its event subscriptions
+    for (uint8_t i=0; i<ARRAY_SIZE(script->event_ref); i++) {
+        set_handler(L, script, i, LUA_NOREF);
+    }
+    {
+        WITH_SEMAPHORE(_event_sem);
+        for (uint8_t i=0; i<_mavlink_sub_count; ) {
+            if (_mavlink_subs[i].script == script) {
+                remove_mavlink_subscription(i);
+            } else {
+                i++;
+            }
+        }
+    }
+
     hal.util->heap_realloc(_heap, script->name, 0);
     hal.util->heap_realloc(_heap, script, 0);
 }
 
+bool lua_scripts::incremental_gc(void) const {
+    return (_gc_max_us > 0) && (_mem_max <= 0);
+}
+
+/*
+  the collector is stopped while scripts run, so a collection never
+  stalls one part way through, and is instead stepped here between
+  runs until its time budget is spent. Lua still collects everything
+  if an allocation fails.
+
+  A cycle starts once the heap has grown by the pause ratio since the
+  last one finished. As the heap fills the pause shortens and the
+  budget grows, taking the place of the collector's step multiplier
+ */
+void lua_scripts::collect_garbage(lua_State *L) {
+    const bool stop = _gc_max_us > 0;
+    if (stop != _gc_stopped) {
+        lua_gc(L, stop ? LUA_GCSTOP : LUA_GCRESTART, 0);
+        _gc_stopped = stop;
+    }
+    if (!incremental_gc()) {
+        return;
+    }
+
+    const uint32_t used = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+    if (!_gc_in_cycle && (used < _gc_threshold)) {
+        return;
+    }
+    const uint32_t pressure_pct = uint64_t(used) * 100U / _heap_size;
+    uint32_t budget_us = _gc_max_us;
+    if (pressure_pct >= 75) {
+        budget_us *= 4;
+    } else if (pressure_pct >= 50) {
+        budget_us *= 2;
+    }
+
+    // frees while no script runs are counted here
+    _run_net = 0;
+    const uint32_t start_us = AP_HAL::micros();
+    uint32_t dt;
+    do {
+        _gc_in_cycle = (lua_gc(L, LUA_GCSTEP, 0) == 0);
+        dt = AP_HAL::micros() - start_us;
+    } while (_gc_in_cycle && (dt < budget_us));
+
+    if (!_gc_in_cycle) {
+        const uint32_t pause_pct = (pressure_pct >= 75) ? 100 : ((pressure_pct >= 50) ? 150 : 200);
+        const uint32_t live = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+        _gc_threshold = MIN(uint64_t(live) * pause_pct / 100U, uint64_t(UINT32_MAX));
+        _gc_cycles++;
+    }
+    _gc_time_us += dt;
+    _gc_time_max_us = MAX(_gc_time_max_us, dt);
+
+    // the garbage is mostly the last script's, so it gets the credit
+    WITH_SEMAPHORE(_sem);
+    if (_gc_script != nullptr) {
+        _gc_script->mem_resident = MAX(_gc_script->mem_resident + _run_net, 0);
+    }
+}
+
 void lua_scripts::reschedule_script(script_info *script) {
     if (script == nullptr) {
 #if defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
@@ -269,6 +675,8 @@ void lua_scripts::reschedule_script(script_info *script) {
        return;
     }
 
+    WITH_SEMAPHORE(_sem);
+
     script->next = nullptr;
     if (scripts == nullptr) {
         scripts = script;
@@ -296,11 +704,319 @@ void lua_scripts::reschedule_script(script_info *script) {
     previous->next = script;
 }
 
+/*
+  events are queued by the threads they happen in and handled in the
+  scripting thread between script runs. The queue is bounded so a flood
+  of events can't hold up the scripts or use up memory
+ */
+void lua_scripts::post_event(AP_Scripting::Event event, int32_t value, int32_t value2) {
+    const uint8_t type = uint8_t(event);
+    if ((_event_mask & (1U << type)) == 0) {
+        // no handlers
+        return;
+    }
+    {
+        WITH_SEMAPHORE(_event_sem);
+        if (event == AP_Scripting::Event::MAVLINK && !has_mavlink_subscription(nullptr, value)) {
+            return;
+        }
+        if (event == AP_Scripting::Event::MISSION_CHANGED) {
+            // an upload changes every item, only the latest change is queued
+            for (uint8_t i=0; i<_event_count; i++) {
+                queued_event &ev = _event_queue[(_event_head + i) % ARRAY_SIZE(_event_queue)];
+                if (ev.type == event) {
+                    ev.value = value;
+                    ev.value2 = value2;
+                    return;
+                }
+            }
+        }
+        if (_event_count == ARRAY_SIZE(_event_queue)) {
+            _events_dropped++;
+            return;
+        }
+        queued_event &ev = _event_queue[(_event_head + _event_count) % ARRAY_SIZE(_event_queue)];
+        ev.type = event;
+        ev.value = value;
+        ev.value2 = value2;
+        _event_count++;
+    }
+    _wake.signal();
+}
+
+bool lua_scripts::pop_event(queued_event &ev) {
+    WITH_SEMAPHORE(_event_sem);
+    if (_event_count == 0) {
+        return false;
+    }
+    ev = _event_queue[_event_head];
+    _event_head = (_event_head + 1) % ARRAY_SIZE(_event_queue);
+    _event_count--;
+    return true;
+}
+
+void lua_scripts::run_events(lua_State *L) {
+    queued_event ev;
+    while (pop_event(ev)) {
+        const uint8_t type = uint8_t(ev.type);
+        for (script_info *script = scripts; script != nullptr; ) {
+            // the handler may remove its script
+            script_info *next = script->next;
+            bool wanted = script->event_ref[type] != LUA_NOREF;
+            if (wanted && ev.type == AP_Scripting::Event::MAVLINK) {
+                WITH_SEMAPHORE(_event_sem);
+                wanted = has_mavlink_subscription(script, ev.value);
+            }
+            if (wanted) {
+                lua_rawgeti(L, LUA_REGISTRYINDEX, script->event_ref[type]);
+                lua_pushinteger(L, ev.value);
+                lua_pushinteger(L, ev.value2);
+                if (const int error = call_script(L, script, 2, 0)) {
+                    report_error(L, script, error);
+                    remove_script(L, script);
+                    lua_pop(L, 1);
+                }
+            }
+            script = next;
+        }
+    }
+
+    const uint32_t dropped = _events_dropped;
+    if (dropped != _reported_events_dropped) {
+        gcs().send_text(MAV_SEVERITY_WARNING, "Lua: %u events dropped", (unsigned)(dropped - _reported_events_dropped));
+        _reported_events_dropped = dropped;
+    }
+}
+
+bool lua_scripts::has_handlers(const script_info *script) {
+    for (uint8_t i=0; i<ARRAY_SIZE(script->event_ref); i++) {
+        if (script->event_ref[i] != LUA_NOREF) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void lua_scripts::set_handler(lua_State *L, script_info *script, uint8_t event, int ref) {
+    if (script->event_ref[event] != LUA_NOREF) {
+        if (L != nullptr) {
+            luaL_unref(L, LUA_REGISTRYINDEX, script->event_ref[event]);
+        }
+        _handler_count[event]--;
+    }
+    script->event_ref[event] = ref;
+    if (ref != LUA_NOREF) {
+        _handler_count[event]++;
+    }
+
+    WITH_SEMAPHORE(_event_sem);
+    if (_handler_count[event] > 0) {
+        _event_mask |= 1U << event;
+    } else {
+        _event_mask &= ~(1U << event);
+    }
+}
+
+// a nullptr script matches any script. Must be called with _event_sem held
+bool lua_scripts::has_mavlink_subscription(const script_info *script, uint32_t msgid) {
+    for (uint8_t i=0; i<_mavlink_sub_count; i++) {
+        if (_mavlink_subs[i].msgid == msgid &&
+            (script == nullptr || _mavlink_subs[i].script == script)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// must be called with _event_sem held
+void lua_scripts::remove_mavlink_subscription(uint8_t i) {
+    _mavlink_sub_count--;
+    _mavlink_subs[i] = _mavlink_subs[_mavlink_sub_count];
+}
+
+/*
+  scripting.subscribe(event, handler [, msgid]) calls handler(value,
+  value2) each time the event happens, see AP_Scripting::Event. A nil
+  handler unsubscribes. MAVLink subscriptions are per message id, and
+  all of them share the script's one MAVLINK handler
+ */
+int lua_scripts::subscribe(lua_State *L) {
+    const int args = lua_gettop(L);
+    if (args < 2 || args > 3) {
+        return luaL_error(L, "subscribe expected 2 or 3 arguments got %d", args);
+    }
+    const lua_Integer type = luaL_checkinteger(L, 1);
+    luaL_argcheck(L, type >= 0 && type < lua_Integer(AP_Scripting::Event::COUNT), 1, "unknown event");
+    const bool unsubscribe = lua_isnil(L, 2);
+    if (!unsubscribe) {
+        luaL_checktype(L, 2, LUA_TFUNCTION);
+    }
+    script_info *script = _running;
+    if (script == nullptr) {
+        return luaL_error(L, "subscribe called outside a script");
+    }
+
+    if (AP_Scripting::Event(type) == AP_Scripting::Event::MAVLINK) {
+        const lua_Integer msgid = luaL_checkinteger(L, 3);
+        luaL_argcheck(L, msgid >= 0 && msgid < (1 << 24), 3, "message id out of range");
+        bool remaining = false;
+        bool full = false;
+        {
+            // no lua errors while this is held
+            WITH_SEMAPHORE(_event_sem);
+            for (uint8_t i=0; i<_mavlink_sub_count; i++) {
+                if (_mavlink_subs[i].script == script && _mavlink_subs[i].msgid == uint32_t(msgid)) {
+                    if (unsubscribe) {
+                        remove_mavlink_subscription(i);
+                    }
+                    break;
+                }
+            }
+            if (!unsubscribe && !has_mavlink_subscription(script, msgid)) {
+                if (_mavlink_sub_count == ARRAY_SIZE(_mavlink_subs)) {
+                    full = true;
+                } else {
+                    _mavlink_subs[_mavlink_sub_count].msgid = msgid;
+                    _mavlink_subs[_mavlink_sub_count].script = script;
+                    _mavlink_sub_count++;
+                }
+            }
+            for (uint8_t i=0; i<_mavlink_sub_count; i++) {
+                if (_mavlink_subs[i].script == script) {
+                    remaining = true;
+                }
+            }
+        }
+        if (full) {
+            return luaL_error(L, "too many MAVLink subscriptions");
+        }
+        if (unsubscribe && remaining) {
+            // keep the handler for the other message ids
+            return 0;
+        }
+    } else if (args > 2) {
+        return luaL_argerror(L, 3, "message id is only for MAVLink events");
+    }
+
+    int ref = LUA_NOREF;
+    if (!unsubscribe) {
+        lua_pushvalue(L, 2);
+        ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    }
+    set_handler(L, script, type, ref);
+    return 0;
+}
+
 void *lua_scripts::_heap;
 
+bool lua_scripts::heap_stats(AP_HAL::Util::HeapStats &stats) {
+    return hal.util->get_heap_stats(_heap, stats);
+}
+
+bool lua_scripts::get_script_stats(uint8_t n, AP_Scripting::ScriptStats &stats) {
+    WITH_SEMAPHORE(_sem);
+
+    // the running script first, then the list in run order. A script
+    // running an event handler is in the list too
+    script_info *script = _running;
+    if (script == nullptr || n > 0) {
+        if (script != nullptr) {
+            n--;
+        }
+        for (script = scripts; script != nullptr; script = script->next) {
+            if (script == _running) {
+                continue;
+            }
+            if (n == 0) {
+                break;
+            }
+            n--;
+        }
+    }
+    if (script == nullptr) {
+        return false;
+    }
+
+    const char *name = strrchr(script->name, '/');
+    strncpy(stats.name, name != nullptr ? name+1 : script->name, sizeof(stats.name)-1);
+    stats.name[sizeof(stats.name)-1] = 0;
+    stats.running = script == _running;
+    stats.run_count = script->run_count;
+    stats.run_time_us = script->run_time_us;
+    stats.run_time_max_us = script->run_time_max_us;
+    stats.run_time_total_us = script->run_time_total_us;
+    stats.instructions = script->instructions;
+    stats.alloc_bytes = script->alloc_bytes;
+    stats.mem_resident = script->mem_resident;
+    return true;
+}
+
+void lua_scripts::log_script_stats(void) {
+    AP_Scripting::ScriptStats stats;
+    for (uint8_t i=0; get_script_stats(i, stats); i++) {
+        // @LoggerMessage: SCR
+        // @Description: Scripting runtime statistics, per script
+        // @Field: TimeUS: Time since system startup
+        // @Field: Name: script file name
+        // @Field: Runs: number of times the script has run
+        // @Field: Avg: mean run time
+        // @Field: Max: longest run time
+        // @Field: Inst: VM instructions in the last run
+        // @Field: Alloc: bytes allocated in the last run
+        // @Field: Mem: heap memory held by the script
+        AP::logger().Write("SCR", "TimeUS,Name,Runs,Avg,Max,Inst,Alloc,Mem",
+                           "QNIIIIIi",
+                           AP_HAL::micros64(),
+                           stats.name,
+                           stats.run_count,
+                           uint32_t(stats.run_count ? stats.run_time_total_us / stats.run_count : 0),
+                           stats.run_time_max_us,
+                           stats.instructions,
+                           stats.alloc_bytes,
+                           stats.mem_resident);
+    }
+
+    // @LoggerMessage: SCRG
+    // @Description: Scripting garbage collection
+    // @Field: TimeUS: Time since system startup
+    // @Field: Time: time spent collecting since the last message
+    // @Field: Max: longest collection between two runs
+    // @Field: Cyc: collection cycles completed since the last message
+    // @Field: Mem: heap memory in use by scripting
+    AP::logger().Write("SCRG", "TimeUS,Time,Max,Cyc,Mem",
+                       "QIIHI",
+                       AP_HAL::micros64(),
+                       _gc_time_us,
+                       _gc_time_max_us,
+                       _gc_cycles,
+                       uint32_t(lua_gc(lua_state, LUA_GCCOUNT, 0) * 1024 + lua_gc(lua_state, LUA_GCCOUNTB, 0)));
+    _gc_time_us = 0;
+    _gc_time_max_us = 0;
+    _gc_cycles = 0;
+}
+
+/*
+  allocations are accounted to the running script, and fail if they
+  would take it past its memory budget. Lua collects garbage and tries
+  again before giving up
+ */
 void *lua_scripts::alloc(void *ud, void *ptr, size_t osize, size_t nsize) {
-    (void)ud; (void)osize;  /* not used */
-    return hal.util->heap_realloc(_heap, ptr, nsize);
+    (void)ud;  /* not used */
+    const int32_t old_size = ptr != nullptr ? osize : 0;
+    const int32_t change = int32_t(nsize) - old_size;
+    if (_running != nullptr && _mem_limit > 0 && change > 0 &&
+        _running->mem_resident + _run_net + change > _mem_limit) {
+        _mem_exceeded = true;
+        return nullptr;
+    }
+    void *ret = hal.util->heap_realloc(_heap, ptr, nsize);
+    if (ret != nullptr || nsize == 0) {
+        if (change > 0) {
+            _run_alloc += change;
+        }
+        _run_net += change;
+    }
+    return ret;
 }
 
 void lua_scripts::run(void) {
@@ -315,11 +1031,23 @@ void lua_scripts::run(void) {
             lua_close(lua_state); // shutdown the old state
         }
         // remove all the old scheduled scripts
+        if (_running != nullptr) {
+            remove_script(nullptr, _running);
+        }
         for (script_info *script = scripts; script != nullptr; script = scripts) {
             remove_script(nullptr, script);
         }
         scripts = nullptr;
+        _running = nullptr;
+        _gc_script = nullptr;
+        _gc_in_cycle = false;
+        _gc_stopped = false;
+        _gc_threshold = 0;
         overtime = false;
+        {
+            WITH_SEMAPHORE(_event_sem);
+            _event_count = 0;
+        }
     }
 
     lua_state = lua_newstate(alloc, NULL);
@@ -348,6 +1076,7 @@ void lua_scripts::run(void) {
 
     // Scan the filesystem in an appropriate manner and autostart scripts
     load_all_scripts_in_dir(L, SCRIPTING_DIRECTORY);
+    load_all_scripts_in_romfs(L);
 
     while (AP_Scripting::get_singleton()->enabled()) {
 #if defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
@@ -368,10 +1097,20 @@ void lua_scripts::run(void) {
               }
 #endif // defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
 
-            // compute delay time
+            run_events(L);
+            collect_garbage(L);
+            if (scripts == nullptr) {
+                continue;
+            }
+
+            // wait until the next script is due, waking early for events
             uint64_t now_ms = AP_HAL::millis64();
             if (now_ms < scripts->next_run_ms) {
-                hal.scheduler->delay(scripts->next_run_ms - now_ms);
+                const uint32_t wait_ms = MIN(scripts->next_run_ms - now_ms, 1000U);
+                // an event or the script being due are both handled by
+                // going round again
+                IGNORE_RETURN(_wake.wait(wait_ms * 1000U));
+                continue;
             }
 
             if (_debug_level > 1) {
@@ -392,8 +1131,10 @@ void lua_scripts::run(void) {
                                                     (int)(endMem - startMem));
             }
 
-            // garbage collect after each script, this shouldn't matter, but seems to resolve a memory leak
-            lua_gc(L, LUA_GCCOLLECT, 0);
+            if (AP_HAL::millis() - _last_log_ms >= SCRIPTING_LOG_INTERVAL_MS) {
+                _last_log_ms = AP_HAL::millis();
+                log_script_stats();
+            }
 
         } else {
             gcs().send_text(MAV_SEVERITY_DEBUG, "Lua: No scripts to run");
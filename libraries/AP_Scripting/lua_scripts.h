@@ -20,11 +20,40 @@
 
 #include <AP_Filesystem/posix_compat.h>
 #include "lua_bindings.h"
+#include "AP_Scripting.h"
+
+// keep a compiled copy of each script next to it, as name.luac, so
+// later boots skip parsing and compiling the source
+#ifndef SCRIPTING_BYTECODE_CACHE
+#define SCRIPTING_BYTECODE_CACHE 1
+#endif
+
+// the hook counting VM instructions runs at least this often, which is
+// the resolution of the per script instruction counts
+#ifndef SCRIPTING_HOOK_INTERVAL
+#define SCRIPTING_HOOK_INTERVAL 100
+#endif
+
+// how often the per script statistics are logged
+#ifndef SCRIPTING_LOG_INTERVAL_MS
+#define SCRIPTING_LOG_INTERVAL_MS 10000
+#endif
+
+// events waiting for the scripting thread, further events are dropped
+#ifndef SCRIPTING_EVENT_QUEUE_LENGTH
+#define SCRIPTING_EVENT_QUEUE_LENGTH 16
+#endif
+
+// MAVLink message ids that scripts can subscribe to, over all scripts
+#ifndef SCRIPTING_MAVLINK_SUBSCRIPTIONS
+#define SCRIPTING_MAVLINK_SUBSCRIPTIONS 8
+#endif
 
 class lua_scripts
 {
 public:
-    lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int8 &debug_level);
+    lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int8 &debug_level,
+                const AP_Int32 &run_max_us, const AP_Int32 &mem_max, const AP_Int32 &gc_max_us);
 
     /* Do not allow copies */
     lua_scripts(const lua_scripts &other) = delete;
@@ -37,6 +66,18 @@ public:
     void run(void);
 
     static bool overtime; // script exceeded it's execution slot, and we are bailing out
+
+    // statistics of the script heap
+    static bool heap_stats(AP_HAL::Util::HeapStats &stats);
+
+    // statistics of the n'th loaded script, false once n is past the end
+    bool get_script_stats(uint8_t n, AP_Scripting::ScriptStats &stats);
+
+    // queue an event for the subscribed scripts and wake the scripting thread
+    static void post_event(AP_Scripting::Event event, int32_t value, int32_t value2);
+
+    // scripting.subscribe(event, handler [, msgid]), binding for the running script
+    static int subscribe(lua_State *L);
 private:
 
     typedef struct script_info {
@@ -44,14 +85,77 @@ private:
        uint64_t next_run_ms; // time (in milliseconds) the script should next be run at
        char *name;           // filename for the script // FIXME: This information should be available from Lua
        script_info *next;
+
+       // accounting, updated at the end of each run
+       uint32_t run_count;         // number of times the script has run
+       uint32_t run_time_us;       // wall time of the last run
+       uint32_t run_time_max_us;   // longest run
+       uint64_t run_time_total_us; // wall time of all runs
+       uint32_t instructions;      // VM instructions in the last run
+       uint32_t alloc_bytes;       // bytes allocated in the last run
+       int32_t mem_resident;       // heap held by the script after garbage collection
+
+       // references to the event handlers, LUA_NOREF if not subscribed
+       int event_ref[uint8_t(AP_Scripting::Event::COUNT)];
     } script_info;
 
     script_info *load_script(lua_State *L, char *filename);
 
+    // load a chunk from a file or from ROMFS and push it on the stack
+    int load_chunk(lua_State *L, const char *filename);
+
+#if SCRIPTING_BYTECODE_CACHE
+    bool load_cached_chunk(lua_State *L, const char *filename, const struct stat &st);
+    void save_cached_chunk(lua_State *L, const char *filename, const struct stat &st);
+    char *cache_filename(const char *filename);
+#endif
+
     void load_all_scripts_in_dir(lua_State *L, const char *dirname);
 
+    // load the scripts embedded in ROMFS under scripts/, either as
+    // source or as chunks precompiled for this firmware
+    void load_all_scripts_in_romfs(lua_State *L);
+
     void run_next_script(lua_State *L);
 
+    // call the function and arguments on the stack for the script,
+    // within its budgets, returning the lua_pcall() result
+    int call_script(lua_State *L, script_info *script, int nargs, int nresults);
+
+    // report why a call failed, with the error message on the stack
+    void report_error(lua_State *L, const script_info *script, int error);
+
+    // account the run that just finished to the script
+    void end_run(lua_State *L, script_info *script, uint32_t run_time_us);
+
+    // true when garbage is collected in steps between runs rather than
+    // with a full collection after each run
+    bool incremental_gc(void) const;
+
+    // step the garbage collector within the GC_US budget
+    void collect_garbage(lua_State *L);
+    script_info *_gc_script;     // the last script run, credited with the memory collected
+    uint32_t _gc_threshold;      // heap in use at which the next cycle starts
+    bool _gc_in_cycle;
+    bool _gc_stopped;            // the collector only runs when stepped
+    uint32_t _gc_time_us;        // time collecting since last logged
+    uint32_t _gc_time_max_us;    // longest collection since last logged
+    uint16_t _gc_cycles;         // cycles completed since last logged
+
+    // call the handlers of the queued events
+    void run_events(lua_State *L);
+    uint32_t _reported_events_dropped;
+
+    // true if the script has an event handler
+    static bool has_handlers(const script_info *script);
+
+    // set a script's handler for an event, or clear it with LUA_NOREF
+    static void set_handler(lua_State *L, script_info *script, uint8_t event, int ref);
+
+    // log the statistics of each script
+    void log_script_stats(void);
+    uint32_t _last_log_ms;
+
     void remove_script(lua_State *L, script_info *script);
 
     // reschedule the script for execution. It is assumed the script is not in the list already
@@ -71,6 +175,54 @@ private:
 
     const AP_Int32 & _vm_steps;
     const AP_Int8 & _debug_level;
+    const AP_Int32 & _run_max_us;
+    const AP_Int32 & _mem_max;
+    const AP_Int32 & _gc_max_us;
+    const uint32_t _heap_size;
+
+    // the script being run, if any. It and the scripts list are
+    // changed under _sem so the statistics can be read from other threads
+    static script_info *_running;
+    HAL_Semaphore _sem;
+
+    // accounting of the current run, shared with hook() and alloc()
+    static uint32_t _run_start_us;
+    static uint32_t _run_instructions;   // instructions up to the last hook
+    static uint32_t _instruction_limit;
+    static uint32_t _time_limit_us;      // zero for no limit
+    static uint16_t _hook_count;         // instructions between hooks
+    static uint32_t _run_alloc;          // bytes allocated
+    static int32_t _run_net;             // change in allocated bytes
+    static int32_t _mem_limit;           // zero for no limit
+    static bool _time_exceeded;
+    static bool _mem_exceeded;
+
+    // queued events, posted from any thread
+    struct queued_event {
+        AP_Scripting::Event type;
+        int32_t value;
+        int32_t value2;
+    };
+    static queued_event _event_queue[SCRIPTING_EVENT_QUEUE_LENGTH];
+    static uint8_t _event_head;
+    static uint8_t _event_count;
+    static uint32_t _events_dropped;
+    static uint32_t _event_mask;         // bit for each event with a handler
+    static uint8_t _handler_count[uint8_t(AP_Scripting::Event::COUNT)];
+    static HAL_Semaphore _event_sem;
+    static HAL_BinarySemaphore _wake;    // signalled when an event is queued
+    static bool pop_event(queued_event &ev);
+
+    // subscriptions to MAVLink messages, the script's MAVLINK handler
+    // is called for each of its message ids
+    struct mavlink_subscription {
+        uint32_t msgid;
+        script_info *script;
+    };
+    static mavlink_subscription _mavlink_subs[SCRIPTING_MAVLINK_SUBSCRIPTIONS];
+    static uint8_t _mavlink_sub_count;
+    static void remove_mavlink_subscription(uint8_t i);
+    static bool has_mavlink_subscription(const script_info *script, uint32_t msgid);
 
     static void *alloc(void *ud, void *ptr, size_t osize, size_t nsize);
 
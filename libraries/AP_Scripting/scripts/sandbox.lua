@@ -33,5 +33,14 @@ function get_sandbox_env ()
           -- ArduPilot specific
           millis = millis,
           servo = { set_output_pwm = servo.set_output_pwm},
+          scripting = { heap_stats = scripting.heap_stats, subscribe = scripting.subscribe,
+                        EVENT_MODE_CHANGE = scripting.EVENT_MODE_CHANGE, EVENT_ARMING = scripting.EVENT_ARMING,
+                        EVENT_MISSION_ITEM = scripting.EVENT_MISSION_ITEM,
+                        EVENT_MISSION_CHANGED = scripting.EVENT_MISSION_CHANGED,
+                        EVENT_MAVLINK = scripting.EVENT_MAVLINK },
+          proximity = { get_boundary_points = proximity.get_boundary_points },
+          mission = { num_commands = mission.num_commands, get_items = mission.get_items },
+          logger = { write = logger.write },
+          Polygon = Polygon,
         }
 end
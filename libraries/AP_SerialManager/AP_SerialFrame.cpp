@@ -0,0 +1,158 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_SerialFrame.h"
+
+#include <AP_Math/AP_Math.h>
+#include <string.h>
+
+AP_SerialFrame::Stats AP_SerialFrame::_stats[uint8_t(Protocol::NUM_PROTOCOLS)];
+
+AP_SerialFrame::AP_SerialFrame(AP_HAL::UARTDriver *port, Protocol protocol, uint16_t max_len) :
+    _port(port),
+    _start_us(AP_HAL::micros()),
+    _max_len(max_len),
+    _len(0),
+    _reserved(0),
+    _buf_len(0),
+    _protocol(protocol),
+    _committed(false)
+{
+    if (_port != nullptr && _port->write_reserve(_vec, max_len)) {
+        _reserved = max_len;
+    }
+}
+
+void AP_SerialFrame::put(uint8_t b)
+{
+    if (_committed || _len >= _max_len) {
+        _stats[uint8_t(_protocol)].dropped++;
+        return;
+    }
+    if (_reserved != 0) {
+        if (_len < _vec[0].len) {
+            _vec[0].data[_len] = b;
+        } else {
+            _vec[1].data[_len - _vec[0].len] = b;
+        }
+    } else {
+        if (_buf_len == BUFFER_SIZE) {
+            flush_buffer();
+        }
+        _buf[_buf_len++] = b;
+    }
+    _len++;
+}
+
+void AP_SerialFrame::put(const uint8_t *data, uint16_t len)
+{
+    if (_reserved == 0 || _committed) {
+        while (len--) {
+            put(*data++);
+        }
+        return;
+    }
+    if (len > _max_len - _len) {
+        _stats[uint8_t(_protocol)].dropped += len - (_max_len - _len);
+        len = _max_len - _len;
+    }
+    // copy the part before the wrap then the part after it
+    if (_len < _vec[0].len) {
+        const uint16_t n = MIN(len, uint16_t(_vec[0].len - _len));
+        memcpy(&_vec[0].data[_len], data, n);
+        _len += n;
+        data += n;
+        len -= n;
+    }
+    if (len > 0) {
+        memcpy(&_vec[1].data[_len - _vec[0].len], data, len);
+        _len += len;
+    }
+}
+
+void AP_SerialFrame::put_str(const char *str)
+{
+    put((const uint8_t *)str, strlen(str));
+}
+
+void AP_SerialFrame::flush_buffer()
+{
+    if (_buf_len == 0 || _port == nullptr) {
+        return;
+    }
+    const size_t written = _port->write(_buf, _buf_len);
+    if (written < _buf_len) {
+        _stats[uint8_t(_protocol)].dropped += _buf_len - written;
+    }
+    _buf_len = 0;
+}
+
+void AP_SerialFrame::commit()
+{
+    if (_committed) {
+        return;
+    }
+    _committed = true;
+    Stats &stats = _stats[uint8_t(_protocol)];
+    if (_reserved != 0) {
+        _port->write_commit(_len);
+        stats.direct++;
+    } else {
+        flush_buffer();
+    }
+    const uint32_t dt = AP_HAL::micros() - _start_us;
+    stats.frames++;
+    stats.bytes += _len;
+    stats.time_us += dt;
+    stats.max_us = MAX(stats.max_us, dt);
+}
+
+uint8_t AP_SerialFrame::sum8(const uint8_t *data, uint16_t len, uint8_t sum)
+{
+    while (len--) {
+        sum += *data++;
+    }
+    return sum;
+}
+
+uint8_t AP_SerialFrame::xor8(const uint8_t *data, uint16_t len, uint8_t sum)
+{
+    while (len--) {
+        sum ^= *data++;
+    }
+    return sum;
+}
+
+void AP_SerialFrame::record(Protocol protocol, uint16_t bytes, uint32_t time_us)
+{
+    Stats &stats = _stats[uint8_t(protocol)];
+    stats.frames++;
+    stats.bytes += bytes;
+    stats.time_us += time_us;
+    stats.max_us = MAX(stats.max_us, time_us);
+}
+
+bool AP_SerialFrame::get_stats(uint8_t protocol, const char *&name, Stats &stats)
+{
+    static const char *names[uint8_t(Protocol::NUM_PROTOCOLS)] = {
+        "FrSkyD", "FrSkySPort", "HoTT", "Devo", "NMEA"
+    };
+    if (protocol >= uint8_t(Protocol::NUM_PROTOCOLS)) {
+        return false;
+    }
+    name = names[protocol];
+    stats = _stats[protocol];
+    return true;
+}
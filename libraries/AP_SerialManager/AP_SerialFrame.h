@@ -0,0 +1,123 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  serializer for the frames of serial telemetry protocols. A frame
+  reserves space in the UART transmit buffer when it is created and
+  the bytes put into it are written there in place, then queued for
+  transmit together when the frame is committed or goes out of
+  scope. Ports which can't reserve space are written to from a small
+  buffer in the frame, still in one write() call per frame.
+
+  The port is held for writing while a frame is open, so a frame
+  should be short lived and nothing else should write to the port
+  until it is committed.
+
+  The frames, bytes and time spent in each protocol are counted, so
+  the cost of each telemetry protocol can be compared
+ */
+
+#include <AP_HAL/AP_HAL.h>
+
+class AP_SerialFrame {
+public:
+    enum class Protocol : uint8_t {
+        FRSKY_D = 0,
+        FRSKY_SPORT,
+        HOTT,
+        DEVO,
+        NMEA,
+        NUM_PROTOCOLS
+    };
+
+    // start a frame of at most max_len bytes on port
+    AP_SerialFrame(AP_HAL::UARTDriver *port, Protocol protocol, uint16_t max_len);
+    ~AP_SerialFrame() { commit(); }
+
+    AP_SerialFrame(const AP_SerialFrame &other) = delete;
+    AP_SerialFrame &operator=(const AP_SerialFrame&) = delete;
+
+    // add bytes to the frame. Bytes beyond max_len are dropped
+    void put(uint8_t b);
+    void put(const uint8_t *data, uint16_t len);
+    void put_str(const char *str);
+
+    // add a byte, escaping it if it is the flag byte of the protocol
+    // or the escape byte itself. An escaped byte is sent as escape
+    // followed by the byte xored with xor_mask
+    void put_escaped(uint8_t b, uint8_t flag, uint8_t escape, uint8_t xor_mask) {
+        if (b == flag || b == escape) {
+            put(escape);
+            put(b ^ xor_mask);
+        } else {
+            put(b);
+        }
+    }
+
+    // number of bytes in the frame so far
+    uint16_t length() const { return _len; }
+
+    // queue the frame for transmit. Done automatically when the frame
+    // goes out of scope
+    void commit();
+
+    // checksums used by telemetry protocols
+    static uint8_t sum8(const uint8_t *data, uint16_t len, uint8_t sum=0);
+    static uint8_t xor8(const uint8_t *data, uint16_t len, uint8_t sum=0);
+
+    // FrSky SPort CRC, a sum with the carry added back in. Start with
+    // 0 and send 0xFF - crc
+    static uint8_t crc_sport(uint8_t crc, uint8_t b) {
+        uint16_t c = crc + b;
+        c += c >> 8;
+        return c & 0xFF;
+    }
+
+    // count a frame sent without a serializer, for protocols that
+    // must pace their bytes
+    static void record(Protocol protocol, uint16_t bytes, uint32_t time_us);
+
+    struct Stats {
+        uint32_t frames;        // frames committed
+        uint32_t bytes;         // bytes queued for transmit
+        uint32_t direct;        // frames written in place in the transmit buffer
+        uint32_t dropped;       // bytes that did not fit in the frame or the port
+        uint32_t time_us;       // total time spent building and queueing frames
+        uint32_t max_us;        // longest time spent on one frame
+    };
+
+    // statistics for a protocol, returns false if there is no such protocol
+    static bool get_stats(uint8_t protocol, const char *&name, Stats &stats);
+
+private:
+    // frames which can't be written in place are built here
+    static const uint8_t BUFFER_SIZE = 96;
+
+    void flush_buffer();
+
+    AP_HAL::UARTDriver *_port;
+    ByteBuffer::IoVec _vec[2];
+    uint32_t _start_us;
+    uint16_t _max_len;
+    uint16_t _len;
+    uint16_t _reserved;
+    uint8_t _buf_len;
+    Protocol _protocol;
+    bool _committed;
+    uint8_t _buf[BUFFER_SIZE];
+
+    static Stats _stats[uint8_t(Protocol::NUM_PROTOCOLS)];
+};
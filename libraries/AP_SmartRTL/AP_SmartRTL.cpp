@@ -30,8 +30,8 @@ const AP_Param::GroupInfo AP_SmartRTL::var_info[] = {
 
     // @Param: POINTS
     // @DisplayName: SmartRTL maximum number of points on path
-    // @Description: SmartRTL maximum number of points on path. Set to 0 to disable SmartRTL.  100 points consumes about 3k of memory.
-    // @Range: 0 500
+    // @Description: SmartRTL maximum number of points on path. Set to 0 to disable SmartRTL.  100 points consumes about 3k of memory.  Boards with less than 500k of RAM are limited to 500 points.
+    // @Range: 0 2000
     // @User: Advanced
     // @RebootRequired: True
     AP_GROUPINFO("POINTS", 1, AP_SmartRTL, _points_max, SMARTRTL_POINTS_DEFAULT),
@@ -58,7 +58,13 @@ const AP_Param::GroupInfo AP_SmartRTL::var_info[] = {
 *    trim between them.
 *
 *    2. Simplification uses the Ramer-Douglas-Peucker algorithm. See Wikipedia
-*    for a more complete description.
+*    for a more complete description.  Routine cleanup instead uses a sliding
+*    window which checks each new point against at most SMARTRTL_SIMPLIFY_WINDOW
+*    points since the last point kept so its cost does not grow with the path.
+*
+*    Pruning keeps a bounding box for each SMARTRTL_PRUNING_BLOCK_POINTS
+*    segments of the path so whole blocks far from the segment being checked
+*    can be skipped.
 *
 *    The simplification and pruning algorithms run in the background and do not
 *    alter the path in memory.  Two definitions, SMARTRTL_SIMPLIFY_TIME_US and
@@ -83,48 +89,80 @@ AP_SmartRTL::AP_SmartRTL(bool example_mode) :
     _simplify.bitmask.setall();
 }
 
-// initialise safe rtl including setting up background processes
+// initialise safe rtl.  The path is allocated when it is first recorded, so no memory is used unless SmartRTL is enabled
 void AP_SmartRTL::init()
 {
-    // protect against repeated call to init
-    if (_path != nullptr) {
-        return;
-    }
-
     // constrain the path length, in case the user decided to make the path unreasonably long.
     _points_max = constrain_int16(_points_max, 0, SMARTRTL_POINTS_MAX);
+}
 
-    // check if user has disabled SmartRTL
-    if (_points_max == 0 || !is_positive(_accuracy)) {
-        return;
+// allocate the path and the arrays used to clean it up for SRTL_POINTS points, freeing those of a different size.
+// returns false if SmartRTL is disabled or allocation failed.  Must only be called while not active
+bool AP_SmartRTL::allocate()
+{
+    const uint16_t points_max = constrain_int16(_points_max, 0, SMARTRTL_POINTS_MAX);
+
+    // check if user has disabled SmartRTL, and give back any memory if so
+    if (points_max == 0 || !is_positive(_accuracy)) {
+        deallocate();
+        return false;
+    }
+    if (_path != nullptr && points_max == _path_points_max) {
+        return true;
+    }
+    // don't retry a failed allocation until the size is changed
+    if (points_max == _alloc_failed_points) {
+        return false;
     }
+    deallocate();
 
     // allocate arrays
-    _path = (Vector3f*)calloc(_points_max, sizeof(Vector3f));
+    _path = (Vector3f*)calloc(points_max, sizeof(Vector3f));
 
-    _prune.loops_max = _points_max * SMARTRTL_PRUNING_LOOP_BUFFER_LEN_MULT;
+    _prune.loops_max = points_max * SMARTRTL_PRUNING_LOOP_BUFFER_LEN_MULT;
     _prune.loops = (prune_loop_t*)calloc(_prune.loops_max, sizeof(prune_loop_t));
 
-    _simplify.stack_max = _points_max * SMARTRTL_SIMPLIFY_STACK_LEN_MULT;
+    _simplify.stack_max = points_max * SMARTRTL_SIMPLIFY_STACK_LEN_MULT;
     _simplify.stack = (simplify_start_finish_t*)calloc(_simplify.stack_max, sizeof(simplify_start_finish_t));
 
+    _prune.blocks = (prune_block_t*)calloc((points_max + SMARTRTL_PRUNING_BLOCK_POINTS - 1) / SMARTRTL_PRUNING_BLOCK_POINTS, sizeof(prune_block_t));
+
     // check if memory allocation failed
-    if (_path == nullptr || _prune.loops == nullptr || _simplify.stack == nullptr) {
+    if (_path == nullptr || _prune.loops == nullptr || _simplify.stack == nullptr || _prune.blocks == nullptr) {
         log_action(SRTL_DEACTIVATED_INIT_FAILED);
         gcs().send_text(MAV_SEVERITY_WARNING, "SmartRTL deactivated: init failed");
-        free(_path);
-        free(_prune.loops);
-        free(_simplify.stack);
-        return;
+        deallocate();
+        _alloc_failed_points = points_max;
+        return false;
     }
 
-    _path_points_max = _points_max;
+    _path_points_max = points_max;
+    _alloc_failed_points = 0;
 
     // when running the example sketch, we want the cleanup tasks to run when we tell them to, not in the background (so that they can be timed.)
-    if (!_example_mode){
+    if (!_example_mode && !_background_registered) {
         // register background cleanup to run in IO thread
         hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&AP_SmartRTL::run_background_cleanup, void));
+        _background_registered = true;
     }
+    return true;
+}
+
+// free the path and cleanup arrays.  Must only be called while not active
+void AP_SmartRTL::deallocate()
+{
+    free(_path);
+    free(_prune.loops);
+    free(_simplify.stack);
+    free(_prune.blocks);
+    _path = nullptr;
+    _prune.loops = nullptr;
+    _simplify.stack = nullptr;
+    _prune.blocks = nullptr;
+    _path_points_max = 0;
+    _path_points_count = 0;
+    _prune.loops_max = 0;
+    _simplify.stack_max = 0;
 }
 
 // returns number of points on the path
@@ -173,7 +211,8 @@ void AP_SmartRTL::set_home(bool position_ok)
 
 void AP_SmartRTL::set_home(bool position_ok, const Vector3f& current_pos)
 {
-    if (_path == nullptr) {
+    // allocate the path on first use, or resize it if SRTL_POINTS has changed since the last flight
+    if (!_active && !allocate()) {
         return;
     }
 
@@ -331,6 +370,9 @@ void AP_SmartRTL::run_background_cleanup()
     _path_points_completed_limit = SMARTRTL_POINTS_MAX;
     _path_sem.give();
 
+    // points beyond the completed limit may have been popped and replaced
+    _prune.blocks_points = MIN(_prune.blocks_points, path_points_completed_limit);
+
     // check if thorough cleanup is required
     if (_thorough_clean_request_ms > 0) {
         // check if we have already completed the request
@@ -402,7 +444,7 @@ void AP_SmartRTL::routine_cleanup(uint16_t path_points_count, uint16_t path_poin
 
     // if 50 points can be simplified or we are low on space and at least 10 points can be simplified
     if ((points_to_simplify >= SMARTRTL_CLEANUP_POINT_TRIGGER) || (low_on_space && (points_to_simplify >= SMARTRTL_CLEANUP_POINT_MIN))) {
-        restart_simplification(path_points_count);
+        restart_simplification(path_points_count, true);
         return;
     }
 
@@ -463,6 +505,11 @@ void AP_SmartRTL::detect_simplifications()
         return;
     }
 
+    if (_simplify.windowed) {
+        detect_simplifications_windowed();
+        return;
+    }
+
     // if not complete but also nothing to do, we must be restarting
     if (_simplify.stack_count == 0) {
         // reset to beginning state. add a single element in the array with:
@@ -522,6 +569,54 @@ void AP_SmartRTL::detect_simplifications()
     _simplify.complete = true;
 }
 
+// Simplifies new points on the path by replacing runs of points with a single segment for as long as all points
+// in the run are within SMARTRTL_SIMPLIFY_EPSILON of it and the run is no more than SMARTRTL_SIMPLIFY_WINDOW points long.
+// Unlike Ramer-Douglas-Peucker each point is checked against a bounded number of points so the cost per point is fixed.
+// _simplify.complete is set to true when all simplifications on the path have been identified
+void AP_SmartRTL::detect_simplifications_windowed()
+{
+    // if not complete but also nothing to do, we must be restarting from the last already-simplified point
+    if (_simplify.next == 0) {
+        _simplify.anchor = (_simplify.path_points_completed > 0) ? _simplify.path_points_completed - 1 : 0;
+        _simplify.next = _simplify.anchor + 2;
+    }
+
+    const uint32_t start_time_us = AP_HAL::micros();
+    while (_simplify.next < _simplify.path_points_count) {
+
+        // if this method has run for long enough, exit
+        if (AP_HAL::micros() - start_time_us > SMARTRTL_SIMPLIFY_TIME_US) {
+            return;
+        }
+
+        // check all points since the anchor are close to the segment from the anchor to the next point
+        const uint16_t end_index = _simplify.next;
+        bool within_epsilon = (end_index - _simplify.anchor) <= SMARTRTL_SIMPLIFY_WINDOW;
+        for (uint16_t i = _simplify.anchor + 1; within_epsilon && (i < end_index); i++) {
+            within_epsilon = _path[i].distance_to_segment(_path[_simplify.anchor], _path[end_index]) <= SMARTRTL_SIMPLIFY_EPSILON;
+        }
+
+        // if not, the previous point ends the run so all points between it and the anchor can be simplified
+        if (!within_epsilon) {
+            for (uint16_t i = _simplify.anchor + 1; i < end_index - 1; i++) {
+                _simplify.bitmask.clear(i);
+                _simplify.removal_required = true;
+            }
+            _simplify.anchor = end_index - 1;
+        }
+        _simplify.next++;
+    }
+
+    // the last point is kept so points between it and the anchor can be simplified
+    for (uint16_t i = _simplify.anchor + 1; i < _simplify.path_points_count - 1; i++) {
+        _simplify.bitmask.clear(i);
+        _simplify.removal_required = true;
+    }
+    _simplify.next = 0;
+    _simplify.path_points_completed = _simplify.path_points_count;
+    _simplify.complete = true;
+}
+
 /**
 *   This method runs for the allotted time, and detects loops in a path. Any detected loops are added to _prune.loops,
 *   this function does not alter the path in memory. It works by comparing the line segment between any two sequential points
@@ -558,6 +653,15 @@ void AP_SmartRTL::detect_loops()
             }
         }
 
+        // skip whole blocks of segments which are too far from the outer loop's segment to be close to it
+        if (((_prune.j - 1) % SMARTRTL_PRUNING_BLOCK_POINTS) == 0) {
+            const prune_block_t &block = _prune.blocks[(_prune.j - 1) / SMARTRTL_PRUNING_BLOCK_POINTS];
+            if (!segment_near_block(_path[_prune.i], _path[_prune.i-1], block)) {
+                _prune.j += SMARTRTL_PRUNING_BLOCK_POINTS - 1;
+                continue;
+            }
+        }
+
         // find the closest distance between two line segments and the mid-point
         dist_point dp = segment_segment_dist(_path[_prune.i], _path[_prune.i-1], _path[_prune.j-1], _path[_prune.j]);
         if (dp.distance < SMARTRTL_PRUNING_DELTA) {
@@ -592,12 +696,14 @@ void AP_SmartRTL::restart_pruning_if_new_points()
 }
 
 // restart simplification algorithm so that it will check new points in the path
-void AP_SmartRTL::restart_simplification(uint16_t path_points_count)
+void AP_SmartRTL::restart_simplification(uint16_t path_points_count, bool windowed)
 {
     _simplify.complete = false;
     _simplify.removal_required = false;
+    _simplify.windowed = windowed;
     _simplify.bitmask.setall();
     _simplify.stack_count = 0;
+    _simplify.next = 0;
     _simplify.path_points_count = path_points_count;
 }
 
@@ -615,16 +721,43 @@ void AP_SmartRTL::restart_pruning(uint16_t path_points_count)
     _prune.i = (path_points_count > 0) ? path_points_count - 1 : 0;
     _prune.j = 0;
     _prune.path_points_count = path_points_count;
+    update_prune_blocks(path_points_count);
 }
 
 // reset pruning algorithm so that it will re-check all points in the path
 void AP_SmartRTL::reset_pruning()
 {
+    _prune.blocks_points = 0;
     restart_pruning(0);
     _prune.loops_count = 0; // clear the loops that we've recorded
     _prune.path_points_completed = 0;
 }
 
+// update pruning bounding boxes for path points from _prune.blocks_points up to path_points_count
+void AP_SmartRTL::update_prune_blocks(uint16_t path_points_count)
+{
+    // blocks share their first point with the previous block's last point so start with the block holding the last up to date point
+    const uint16_t first_point = MIN(_prune.blocks_points, path_points_count);
+    const uint16_t first_block = ((first_point > 0) ? first_point - 1 : 0) / SMARTRTL_PRUNING_BLOCK_POINTS;
+    for (uint16_t b = first_block; b * SMARTRTL_PRUNING_BLOCK_POINTS + 1 < path_points_count; b++) {
+        const uint16_t start = b * SMARTRTL_PRUNING_BLOCK_POINTS;
+        const uint16_t end = MIN(start + SMARTRTL_PRUNING_BLOCK_POINTS, path_points_count - 1);
+        prune_block_t &block = _prune.blocks[b];
+        block.min = _path[start];
+        block.max = _path[start];
+        for (uint16_t i = start + 1; i <= end; i++) {
+            const Vector3f &p = _path[i];
+            block.min.x = MIN(block.min.x, p.x);
+            block.min.y = MIN(block.min.y, p.y);
+            block.min.z = MIN(block.min.z, p.z);
+            block.max.x = MAX(block.max.x, p.x);
+            block.max.y = MAX(block.max.y, p.y);
+            block.max.z = MAX(block.max.z, p.z);
+        }
+    }
+    _prune.blocks_points = path_points_count;
+}
+
 // remove all simplify-able points from the path
 void AP_SmartRTL::remove_points_by_simplify_bitmask()
 {
@@ -637,6 +770,10 @@ void AP_SmartRTL::remove_points_by_simplify_bitmask()
     for (uint16_t src = 1; src < _path_points_count; src++) {
         if (!_simplify.bitmask.get(src)) {
             log_action(SRTL_POINT_SIMPLIFY, _path[src]);
+            if (removed == 0) {
+                // pruning bounding boxes are out of date from here on
+                _prune.blocks_points = MIN(_prune.blocks_points, src);
+            }
             removed++;
         } else {
             _path[dest] = _path[src];
@@ -653,6 +790,7 @@ void AP_SmartRTL::remove_points_by_simplify_bitmask()
         // this is an error that should never happen so deactivate
         deactivate(SRTL_DEACTIVATED_PROGRAM_ERROR, "program error");
     }
+    update_prune_blocks(_path_points_count);
 
     _path_sem.give();
 
@@ -685,6 +823,9 @@ bool AP_SmartRTL::remove_points_by_loops(uint16_t num_points_to_remove)
         // midpoint goes into start_index (this is the end point of the first segment)
         _path[loop.start_index] = loop.midpoint;
 
+        // pruning bounding boxes are out of date from here on
+        _prune.blocks_points = MIN(_prune.blocks_points, loop.start_index);
+
         // shift points after the end of the loop down by the number of points in the loop
         uint16_t loop_num_points_to_remove = loop.end_index - loop.start_index;
         for (uint16_t dest = loop.start_index + 1; dest < _path_points_count - loop_num_points_to_remove; dest++) {
@@ -717,6 +858,7 @@ bool AP_SmartRTL::remove_points_by_loops(uint16_t num_points_to_remove)
         // remove last prune loop from array
         _prune.loops_count--;
     }
+    update_prune_blocks(_path_points_count);
 
     _path_sem.give();
     return true;
@@ -841,6 +983,16 @@ void AP_SmartRTL::log_action(SRTL_Actions action, const Vector3f &point)
     }
 }
 
+// returns true if the segment from p1 to p2 may come within SMARTRTL_PRUNING_DELTA of any segment in the block
+bool AP_SmartRTL::segment_near_block(const Vector3f& p1, const Vector3f& p2, const prune_block_t& block) const
+{
+    // compare bounding box of the segment expanded by the pruning distance with the block's bounding box
+    const float delta = SMARTRTL_PRUNING_DELTA;
+    return (MIN(p1.x, p2.x) - delta <= block.max.x) && (MAX(p1.x, p2.x) + delta >= block.min.x) &&
+           (MIN(p1.y, p2.y) - delta <= block.max.y) && (MAX(p1.y, p2.y) + delta >= block.min.y) &&
+           (MIN(p1.z, p2.z) - delta <= block.max.z) && (MAX(p1.z, p2.z) + delta >= block.min.z);
+}
+
 // returns true if the two loops overlap (used within add_loop to determine which loops to keep or throw away)
 bool AP_SmartRTL::loops_overlap(const prune_loop_t &loop1, const prune_loop_t &loop2) const
 {
@@ -7,7 +7,11 @@
 // definitions and macros
 #define SMARTRTL_ACCURACY_DEFAULT        2.0f   // default _ACCURACY parameter value.  Points will be no closer than this distance (in meters) together.
 #define SMARTRTL_POINTS_DEFAULT          300    // default _POINTS parameter value.  High numbers improve path pruning but use more memory and CPU for cleanup. Memory used will be 20bytes * this number.
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#define SMARTRTL_POINTS_MAX              2000   // the absolute maximum number of points this library can support.
+#else
 #define SMARTRTL_POINTS_MAX              500    // the absolute maximum number of points this library can support.
+#endif
 #define SMARTRTL_TIMEOUT                 15000  // the time in milliseconds with no points saved to the path (for whatever reason), before SmartRTL is disabled for the flight
 #define SMARTRTL_CLEANUP_POINT_TRIGGER   50     // simplification will trigger when this many points are added to the path
 #define SMARTRTL_CLEANUP_START_MARGIN    10     // routine cleanup algorithms begin when the path array has only this many empty slots remaining
@@ -17,9 +21,11 @@
                                                 // The minimum is int((s/2-1)+min(s/2, SMARTRTL_POINTS_MAX-s)), where s = pow(2, floor(log(SMARTRTL_POINTS_MAX)/log(2)))
                                                 // To avoid this annoying math, a good-enough overestimate is ceil(SMARTRTL_POINTS_MAX*2.0f/3.0f)
 #define SMARTRTL_SIMPLIFY_TIME_US        200    // maximum time (in microseconds) the simplification algorithm will run before returning
+#define SMARTRTL_SIMPLIFY_WINDOW         20     // maximum number of points routine simplification will replace with a single segment.  Bounds the cost per point
 #define SMARTRTL_PRUNING_DELTA (_accuracy * 0.99)   // How many meters apart must two points be, such that we can assume that there is no obstacle between them.  must be smaller than _ACCURACY parameter
 #define SMARTRTL_PRUNING_LOOP_BUFFER_LEN_MULT 0.25f // pruning loop buffer size as compared to maximum number of points
 #define SMARTRTL_PRUNING_LOOP_TIME_US    200    // maximum time (in microseconds) that the loop finding algorithm will run before returning
+#define SMARTRTL_PRUNING_BLOCK_POINTS    16     // number of path segments covered by each bounding box used to skip distant parts of the path when finding loops
 
 class AP_SmartRTL {
 
@@ -28,7 +34,7 @@ public:
     // constructor, destructor
     AP_SmartRTL(bool example_mode = false);
 
-    // initialise safe rtl including setting up background processes
+    // initialise safe rtl.  Memory for the path is allocated when it is first recorded
     void init();
 
     // return true if smart_rtl is usable (it may become unusable if the user took off without GPS lock or the path became too long)
@@ -94,6 +100,12 @@ private:
         SRTL_DEACTIVATED_PROGRAM_ERROR,
     };
 
+    // allocate the path for SRTL_POINTS points, or free it if SmartRTL is disabled.  returns true if the path is allocated
+    bool allocate();
+
+    // free the path and the arrays used to clean it up
+    void deallocate();
+
     // add point to end of path
     bool add_point(const Vector3f& point);
 
@@ -109,6 +121,10 @@ private:
     void detect_simplifications();
     void detect_loops();
 
+    // routine simplification which only tests each new point against a window of at most SMARTRTL_SIMPLIFY_WINDOW
+    // points since the last point kept, so its cost per point is bounded however long the path is
+    void detect_simplifications_windowed();
+
     // restart simplify or pruning if new points have been added to path
     // path_points_count is _path_points_count but passed in to avoid having to take the semaphore
     void restart_simplify_if_new_points(uint16_t path_points_count);
@@ -119,7 +135,8 @@ private:
     // restart simplify algorithm so that detect_simplify will check all new points that have been added
     // to the path since it last completed.
     // path_points_count is _path_points_count but passed in to avoid having to take the semaphore
-    void restart_simplification(uint16_t path_points_count);
+    // windowed should be true to use the bounded cost routine simplification instead of Ramer-Douglas-Peucker
+    void restart_simplification(uint16_t path_points_count, bool windowed = false);
 
     // reset simplify algorithm so that it will re-check all points in the path
     void reset_simplification();
@@ -132,6 +149,9 @@ private:
     // reset pruning algorithm so that it will re-check all points in the path
     void reset_pruning();
 
+    // update pruning bounding boxes for path points from _prune.blocks_points up to path_points_count
+    void update_prune_blocks(uint16_t path_points_count);
+
     // remove all simplify-able points from the path
     void remove_points_by_simplify_bitmask();
 
@@ -179,6 +199,8 @@ private:
     // path variables
     Vector3f* _path;    // points are stored in meters from EKF origin in NED
     uint16_t _path_points_max;  // after the array has been allocated, we will need to know how big it is. We can't use the parameter, because a user could change the parameter in-flight
+    uint16_t _alloc_failed_points;  // size of the last allocation which failed, which is not retried
+    bool _background_registered;    // true once the background cleanup has been registered with the IO thread
     uint16_t _path_points_count;// number of points in the path array
     uint16_t _path_points_completed_limit;  // set by main thread to the path_point_count when a point is popped.  used by simplify and prune algorithms to detect path shrinking
     HAL_Semaphore _path_sem;   // semaphore for updating path
@@ -192,6 +214,9 @@ private:
     struct {
         bool complete;          // true after simplify_detection has completed
         bool removal_required;  // true if some simplify-able points have been found on the path, set true by detect_simplifications, set false by remove_points_by_simplify_bitmask
+        bool windowed;          // true if detect_simplifications_windowed is being used instead of Ramer-Douglas-Peucker
+        uint16_t anchor;        // windowed simplification's index of the last point which will be kept
+        uint16_t next;          // windowed simplification's index of the next point to check (zero when restarting)
         uint16_t path_points_count; // copy of _path_points_count taken when the simply algorithm started
         uint16_t path_points_completed = SMARTRTL_POINTS_MAX; // number of points in that path that have already been simplified and should be ignored
         simplify_start_finish_t* stack;
@@ -207,6 +232,10 @@ private:
         Vector3f midpoint;      // midpoint which should replace the first point when the loop is removed
         float length_squared;   // length squared (in meters) of the loop (used so we can remove the longest loops)
     } prune_loop_t;
+    typedef struct {
+        Vector3f min;           // minimum of each axis over the block's points
+        Vector3f max;           // maximum of each axis over the block's points
+    } prune_block_t;
     struct {
         bool complete;
         uint16_t path_points_count;  // copy of _path_points_count taken when the prune algorithm started
@@ -216,8 +245,13 @@ private:
         prune_loop_t* loops;// the result of the pruning algorithm
         uint16_t loops_max; // maximum number of elements in the _prunable_loops array
         uint16_t loops_count;   // number of elements in the _prunable_loops array
+        prune_block_t* blocks;  // bounding boxes of each SMARTRTL_PRUNING_BLOCK_POINTS segments of the path
+        uint16_t blocks_points; // number of path points the bounding boxes are up to date for
     } _prune;
 
+    // returns true if the segment from p1 to p2 may come within SMARTRTL_PRUNING_DELTA of any segment in the block
+    bool segment_near_block(const Vector3f& p1, const Vector3f& p2, const prune_block_t& block) const;
+
     // returns true if the two loops overlap (used within add_loop to determine which loops to keep or throw away)
     bool loops_overlap(const prune_loop_t& loop1, const prune_loop_t& loop2) const;
 };
@@ -209,19 +209,16 @@ void SoaringController::init_thermalling()
     float cov_q1 = powf(thermal_q1, 2); // State covariance
     float cov_q2 = powf(thermal_q2, 2); // State covariance
     const float init_q[4] = {cov_q1, cov_q2, cov_q2, cov_q2};
-    const MatrixN<float,4> q{init_q};
     const float init_p[4] = {INITIAL_STRENGTH_COVARIANCE, INITIAL_RADIUS_COVARIANCE, INITIAL_POSITION_COVARIANCE, INITIAL_POSITION_COVARIANCE};
-    const MatrixN<float,4> p{init_p};
 
     // New state vector filter will be reset. Thermal location is placed in front of a/c
     const float init_xr[4] = {INITIAL_THERMAL_STRENGTH,
                               INITIAL_THERMAL_RADIUS,
                               thermal_distance_ahead * cosf(_ahrs.yaw),
                               thermal_distance_ahead * sinf(_ahrs.yaw)};
-    const VectorN<float,4> xr{init_xr};
 
     // Also reset covariance matrix p so filter is not affected by previous data
-    _ekf.reset(xr, p, q, r);
+    _ekf.reset(init_xr, init_p, init_q, r);
 
     _ahrs.get_position(_prev_update_location);
     _prev_update_time = AP_HAL::micros64();
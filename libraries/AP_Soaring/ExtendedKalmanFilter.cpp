@@ -1,79 +1,86 @@
 #include "ExtendedKalmanFilter.h"
-#include "AP_Math/matrixN.h"
+#include <AP_Math/AP_Math.h>
 
 
-float ExtendedKalmanFilter::measurementpredandjacobian(VectorN<float,N> &A)
+float ExtendedKalmanFilter::measurementpredandjacobian(float H[N]) const
 {
     // This function computes the Jacobian using equations from
     // analytical derivation of Gaussian updraft distribution
+    const float r2 = sq(X[2]) + sq(X[3]);
+    const float inv_R2 = 1.0f / sq(X[1]);
     // This expression gets used lots
-    float expon = expf(- (powf(X[2], 2) + powf(X[3], 2)) / powf(X[1], 2));
+    const float expon = expf(-r2 * inv_R2);
     // Expected measurement
-    float w = X[0] * expon;
+    const float w = X[0] * expon;
 
     // Elements of the Jacobian
-    A[0] = expon;
-    A[1] = 2 * X[0] * ((powf(X[2],2) + powf(X[3],2)) / powf(X[1],3)) * expon;
-    A[2] = -2 * (X[0] * X[2] / powf(X[1],2)) * expon;
-    A[3] = A[2] * X[3] / X[2];
+    const float k = -2 * w * inv_R2;
+    H[0] = expon;
+    H[1] = -k * r2 / X[1];
+    H[2] = k * X[2];
+    H[3] = k * X[3];
     return w;
 }
 
 
-void ExtendedKalmanFilter::reset(const VectorN<float,N> &x, const MatrixN<float,N> &p, const MatrixN<float,N> q, float r)
+void ExtendedKalmanFilter::reset(const float x[N], const float p_diag[N], const float q_diag[N], float r)
 {
-    P = p;
-    X = x;
-    Q = q;
+    P.zero();
+    for (uint8_t i = 0; i < N; i++) {
+        X[i] = x[i];
+        P[i][i] = p_diag[i];
+        Q[i] = q_diag[i];
+    }
     R = r;
 }
 
 
 void ExtendedKalmanFilter::update(float z, float Vx, float Vy)
 {
-    MatrixN<float,N> tempM;
-    VectorN<float,N> H;
-    VectorN<float,N> P12;
-    VectorN<float,N> K;
-    
-    // LINE 28
     // Estimate new state from old.
     X[2] -= Vx;
     X[3] -= Vy;
 
-    // LINE 33
     // Update the covariance matrix
     // P = A*ekf.P*A'+ekf.Q;
-    // We know A is identity so
-    // P = ekf.P+ekf.Q;
-    P += Q;
+    // We know A is identity and Q is diagonal so
+    P[0][0] += Q[0];
+    P[1][1] += Q[1];
+    P[2][2] += Q[2];
+    P[3][3] += Q[3];
 
     // What measurement do we expect to receive in the estimated
     // state
-    // LINE 37
-    // [z1,H] = ekf.jacobian_h(x1);
-    float z1 = measurementpredandjacobian(H);
+    float H[N];
+    const float z1 = measurementpredandjacobian(H);
+
+    // P12 = P * H'; cross covariance
+    const float P12[N] {
+        P[0][0]*H[0] + P[0][1]*H[1] + P[0][2]*H[2] + P[0][3]*H[3],
+        P[0][1]*H[0] + P[1][1]*H[1] + P[1][2]*H[2] + P[1][3]*H[3],
+        P[0][2]*H[0] + P[1][2]*H[1] + P[2][2]*H[2] + P[2][3]*H[3],
+        P[0][3]*H[0] + P[1][3]*H[1] + P[2][3]*H[2] + P[3][3]*H[3],
+    };
 
-    // LINE 40
-    // P12 = P * H';
-    P12.mult(P, H); //cross covariance 
-    
-    // LINE 41
     // Calculate the KALMAN GAIN
-    // K = P12 * inv(H*P12 + ekf.R);                     %Kalman filter gain
-    K = P12 * 1.0 / (H * P12 + R);
+    // K = P12 * inv(H*P12 + ekf.R);
+    const float inv_S = 1.0f / (H[0]*P12[0] + H[1]*P12[1] + H[2]*P12[2] + H[3]*P12[3] + R);
 
     // Correct the state estimate using the measurement residual.
-    // LINE 44
     // X = x1 + K * (z - z1);
-    X += K * (z - z1);
+    const float innov = (z - z1) * inv_S;
+    X[0] += P12[0] * innov;
+    X[1] += P12[1] * innov;
+    X[2] += P12[2] * innov;
+    X[3] += P12[3] * innov;
 
     // Correct the covariance too.
-    // LINE 46
     // NB should be altered to reflect Stengel
-    // P = P_predict - K * P12';
-    tempM.mult(K, P12);
-    P -= tempM;
-    
-    P.force_symmetry();
+    // P = P_predict - K * P12' = P_predict - P12 * P12' / S
+    // which is symmetric, so only the upper triangle is updated
+    float K[N];
+    for (uint8_t i = 0; i < N; i++) {
+        K[i] = P12[i] * inv_S;
+    }
+    P.sub_outer(K, P12, N);
 }
@@ -3,11 +3,18 @@ Extended Kalman Filter class by Sam Tabor, 2013.
 * http://diydrones.com/forum/topics/autonomous-soaring
 * Set up for identifying thermals of Gaussian form, but could be adapted to other
 * purposes by adapting the equations for the jacobians.
+*
+* The four state filter is written out element by element. The state
+* transition is the identity, the process noise is diagonal and there
+* is one scalar measurement, so each update is a few dozen multiplies
+* with no temporary matrices, and the covariance is kept as its upper
+* triangle so it is symmetric by construction.
 */
 
 #pragma once
 
-#include <AP_Math/matrixN.h>
+#include <AP_Math/vectorN.h>
+#include <AP_Math/matrixN_sym.h>
 
 class ExtendedKalmanFilter {
 public:
@@ -15,13 +22,17 @@ public:
 
     static constexpr const uint8_t N = 4;
 
+    // state is thermal strength, radius, and x and y position
+    // relative to the aircraft
     VectorN<float,N> X;
-    MatrixN<float,N> P;
-    MatrixN<float,N> Q;
+    SymMatrixN<float,N> P;
+    float Q[N];     // diagonal of the process noise
     float R;
-    void reset(const VectorN<float,N> &x, const MatrixN<float,N> &p, const MatrixN<float,N> q, float r);
+
+    // reset the state, with a diagonal covariance
+    void reset(const float x[N], const float p_diag[N], const float q_diag[N], float r);
     void update(float z, float Vx, float Vy);
 
 private:
-    float measurementpredandjacobian(VectorN<float,N> &A);
+    float measurementpredandjacobian(float H[N]) const;
 };
@@ -0,0 +1,127 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/matrixN.h>
+#include <AP_Soaring/ExtendedKalmanFilter.h>
+
+/*
+  the thermal filter fed with a glider circling at 25m radius and
+  20m/s in a 2.5m/s, 60m radius thermal, with the circle centre 30m
+  from the thermal centre and the filter started 50m ahead, as
+  init_thermalling() does. The filter is reset at the end of each
+  pass over the samples, so every iteration sees the same convergence
+ */
+#define BENCH_NUM_SAMPLES 128
+
+struct Sample {
+    float z, dx, dy;
+};
+
+static Sample samples[BENCH_NUM_SAMPLES];
+
+static const float init_x[4] = {2.0f, 80.0f, 50.0f, 0.0f};
+static const float init_p[4] = {0.0049f, 2500.0f, 2500.0f, 2500.0f};
+static const float init_q[4] = {sq(0.001f), sq(0.03f), sq(0.03f), sq(0.03f)};
+static const float init_r = sq(0.45f);
+
+static void make_samples(void)
+{
+    const float dt = 0.1f;
+    const float omega = 20.0f / 25.0f;
+    float px = 25.0f, py = 0;
+    for (uint16_t i = 0; i < BENCH_NUM_SAMPLES; i++) {
+        const float a = omega * dt * (i+1);
+        const float nx = 25.0f * cosf(a);
+        const float ny = 25.0f * sinf(a);
+        // thermal centred at (30,0) from the circle centre
+        const float r2 = sq(nx - 30.0f) + sq(ny);
+        samples[i].z = 2.5f * expf(-r2 / sq(60.0f)) + 0.1f * sinf(7.0f * i);
+        samples[i].dx = nx - px;
+        samples[i].dy = ny - py;
+        px = nx;
+        py = ny;
+    }
+}
+
+/*
+  the previous implementation on general N dimensional matrices, for
+  comparison
+ */
+class GenericThermalEKF {
+public:
+    static constexpr const uint8_t N = 4;
+
+    VectorN<float,N> X;
+    MatrixN<float,N> P;
+    MatrixN<float,N> Q;
+    float R;
+
+    void reset(void) {
+        X = VectorN<float,N>{init_x};
+        P = MatrixN<float,N>{init_p};
+        Q = MatrixN<float,N>{init_q};
+        R = init_r;
+    }
+
+    void update(float z, float Vx, float Vy) {
+        MatrixN<float,N> tempM;
+        VectorN<float,N> H;
+        VectorN<float,N> P12;
+        VectorN<float,N> K;
+
+        X[2] -= Vx;
+        X[3] -= Vy;
+        P += Q;
+
+        float expon = expf(- (powf(X[2], 2) + powf(X[3], 2)) / powf(X[1], 2));
+        float z1 = X[0] * expon;
+        H[0] = expon;
+        H[1] = 2 * X[0] * ((powf(X[2],2) + powf(X[3],2)) / powf(X[1],3)) * expon;
+        H[2] = -2 * (X[0] * X[2] / powf(X[1],2)) * expon;
+        H[3] = H[2] * X[3] / X[2];
+
+        P12.mult(P, H);
+        K = P12 * 1.0 / (H * P12 + R);
+        X += K * (z - z1);
+        tempM.mult(K, P12);
+        P -= tempM;
+        P.force_symmetry();
+    }
+};
+
+static void BM_ThermalEKFGeneric(benchmark::State& state)
+{
+    make_samples();
+    GenericThermalEKF ekf;
+    ekf.reset();
+    uint16_t i = 0;
+    while (state.KeepRunning()) {
+        ekf.update(samples[i].z, samples[i].dx, samples[i].dy);
+        gbenchmark_escape(&ekf.X);
+        if (++i == BENCH_NUM_SAMPLES) {
+            i = 0;
+            ekf.reset();
+        }
+    }
+}
+
+static void BM_ThermalEKF(benchmark::State& state)
+{
+    make_samples();
+    ExtendedKalmanFilter ekf;
+    ekf.reset(init_x, init_p, init_q, init_r);
+    uint16_t i = 0;
+    while (state.KeepRunning()) {
+        ekf.update(samples[i].z, samples[i].dx, samples[i].dy);
+        gbenchmark_escape(&ekf.X);
+        if (++i == BENCH_NUM_SAMPLES) {
+            i = 0;
+            ekf.reset(init_x, init_p, init_q, init_r);
+        }
+    }
+}
+
+BENCHMARK(BM_ThermalEKFGeneric);
+BENCHMARK(BM_ThermalEKF);
+
+BENCHMARK_MAIN()
@@ -69,6 +69,7 @@ void AP_Stats::init()
 
 void AP_Stats::flush()
 {
+    WITH_SEMAPHORE(_sem);
     params.flttime.set_and_save_ifchanged(flttime);
     params.runtime.set_and_save_ifchanged(runtime);
 }
@@ -93,6 +94,8 @@ void AP_Stats::update_runtime()
 
 void AP_Stats::update()
 {
+    WITH_SEMAPHORE(_sem);
+
     const uint32_t now_ms = AP_HAL::millis();
     if (now_ms -  last_flush_ms > flush_interval_ms) {
         update_flighttime();
@@ -121,6 +124,7 @@ void AP_Stats::update()
 
 void AP_Stats::set_flying(const bool is_flying)
 {
+    WITH_SEMAPHORE(_sem);
     if (is_flying) {
         if (!_flying_ms) {
             _flying_ms = AP_HAL::millis();
@@ -136,6 +140,7 @@ void AP_Stats::set_flying(const bool is_flying)
  */
 uint32_t AP_Stats::get_flight_time_s(void)
 {
+    WITH_SEMAPHORE(_sem);
     update_flighttime();
     return flttime - flttime_boot;
 }
@@ -68,6 +68,9 @@ private:
     void update_flighttime();
     void update_runtime();
 
+    // update() may run on a scheduler worker thread
+    HAL_Semaphore _sem;
+
 };
 
 namespace AP {
@@ -970,6 +970,17 @@ void AP_TECS::update_pitch_throttle(int32_t hgt_dem_cm,
     _DT = (now - _update_pitch_throttle_last_usec) * 1.0e-6f;
     _update_pitch_throttle_last_usec = now;
 
+    // the demands being output now are where the interpolation to the
+    // new demands starts from. After a reset or a gap in updates there
+    // is nothing sensible to interpolate from
+    const uint32_t start_us = AP_HAL::micros();
+    const uint32_t interval_us = start_us - _output.start_us;
+    const bool interpolate = !_need_reset && interval_us < 2 * _output.interp_us;
+    _output.throttle_prev = _output_demand(_output.throttle_prev, _throttle_dem);
+    _output.pitch_prev = _output_demand(_output.pitch_prev, _pitch_dem);
+    _output.start_us = start_us;
+    _output.period_us = MIN(interval_us, _output.interp_us);
+
     _flags.is_doing_auto_land = (flight_stage == AP_Vehicle::FixedWing::FLIGHT_LAND);
     _distance_beyond_land_wp = distance_beyond_land_wp;
     _flight_stage = flight_stage;
@@ -1131,6 +1142,12 @@ void AP_TECS::update_pitch_throttle(int32_t hgt_dem_cm,
     // Calculate pitch demand
     _update_pitch();
 
+    if (!interpolate) {
+        _output.throttle_prev = _throttle_dem;
+        _output.pitch_prev = _pitch_dem;
+    }
+    _output.update_us = AP_HAL::micros() - start_us;
+
     // log to AP_Logger
     AP::logger().Write(
         "TECS",
@@ -1153,15 +1170,32 @@ void AP_TECS::update_pitch_throttle(int32_t hgt_dem_cm,
         (double)_TAS_rate_dem,
         (double)logging.SKE_weighting,
         _flags_byte);
-    AP::logger().Write("TEC2", "TimeUS,pmax,pmin,KErr,PErr,EDelta,LF",
-                       "s------",
-                       "F------",
-                       "Qffffff",
+    AP::logger().Write("TEC2", "TimeUS,pmax,pmin,KErr,PErr,EDelta,LF,Tus",
+                       "s-------",
+                       "F-------",
+                       "QffffffI",
                        now,
                        (double)degrees(_PITCHmaxf),
                        (double)degrees(_PITCHminf),
                        (double)logging.SKE_error,
                        (double)logging.SPE_error,
                        (double)logging.SEB_delta,
-                       (double)load_factor);
+                       (double)load_factor,
+                       _output.update_us);
+}
+
+/*
+  return a demand linearly interpolated from its value before the last
+  update to its new value, over the interpolation period
+ */
+float AP_TECS::_output_demand(float prev, float dem) const
+{
+    if (_output.interp_us == 0) {
+        return dem;
+    }
+    const uint32_t dt_us = AP_HAL::micros() - _output.start_us;
+    if (dt_us >= _output.period_us) {
+        return dem;
+    }
+    return prev + (dem - prev) * (dt_us / float(_output.period_us));
 }
@@ -58,13 +58,26 @@ public:
     // demanded throttle in percentage
     // should return -100 to 100, usually positive unless reverse thrust is enabled via _THRminf < 0
     int32_t get_throttle_demand(void) override {
-        return int32_t(_throttle_dem * 100.0f);
+        return int32_t(_output_demand(_output.throttle_prev, _throttle_dem) * 100.0f);
     }
 
     // demanded pitch angle in centi-degrees
     // should return between -9000 to +9000
     int32_t get_pitch_demand(void) override {
-        return int32_t(_pitch_dem * 5729.5781f);
+        return int32_t(_output_demand(_output.pitch_prev, _pitch_dem) * 5729.5781f);
+    }
+
+    // interpolate the pitch and throttle demands over the period
+    // between calls to update_pitch_throttle(), for vehicles which
+    // call it at update_hz but use the demands at a higher rate. Zero
+    // disables interpolation
+    void set_output_interpolation(float update_hz) {
+        _output.interp_us = is_positive(update_hz) ? 1.0e6f / update_hz : 0;
+    }
+
+    // time taken by the last update_pitch_throttle() in microseconds
+    uint32_t get_update_time_us(void) const {
+        return _output.update_us;
     }
 
     // Rate of change of velocity along X body axis in m/s^2
@@ -189,6 +202,24 @@ private:
     // pitch angle demand in radians
     float _pitch_dem;
 
+    // demand interpolation between updates, and update timing
+    struct {
+        // expected time between updates, zero when disabled
+        uint32_t interp_us;
+        // start and length of the interpolation from the previous
+        // demands. The length is the last time between updates, so
+        // updates called faster than expected aren't smoothed
+        uint32_t start_us;
+        uint32_t period_us;
+        float throttle_prev;
+        float pitch_prev;
+        // time taken by the last update
+        uint32_t update_us;
+    } _output;
+
+    // demand interpolated from the previous demand
+    float _output_demand(float prev, float dem) const;
+
     // estimated climb rate (m/s)
     float _climb_rate;
 
@@ -84,6 +84,44 @@ float AP_TempCalibration::calculate_correction(float temp, float exponent) const
 }
 
 
+/*
+  build the table of corrections for the current exponent
+ */
+void AP_TempCalibration::build_table(void)
+{
+    if (correction_table == nullptr) {
+        correction_table = new float[table_size];
+        if (correction_table == nullptr) {
+            return;
+        }
+    }
+    for (uint8_t i=0; i<table_size; i++) {
+        correction_table[i] = calculate_correction(Tzero + i, baro_exponent);
+    }
+    table_exponent = baro_exponent;
+}
+
+/*
+  correction for a temperature, interpolated from the table. Falls
+  back to calculating it above the table or if the table can't be
+  allocated
+ */
+float AP_TempCalibration::table_correction(float temp)
+{
+    if (correction_table == nullptr || !is_equal(table_exponent, baro_exponent.get())) {
+        build_table();
+    }
+    const float x = temp - Tzero;
+    if (correction_table == nullptr || x >= table_size - 1) {
+        return calculate_correction(temp, baro_exponent);
+    }
+    if (x <= 0) {
+        return correction_table[0];
+    }
+    const uint8_t i = x;
+    return correction_table[i] + (x - i) * (correction_table[i+1] - correction_table[i]);
+}
+
 /*
   setup for learning
  */
@@ -93,6 +131,7 @@ void AP_TempCalibration::setup_learning(void)
     learn_temp_step = 0.25;
     learn_count = 200;
     learn_i = 0;
+    learn_pass.active = false;
     if (learn_values != nullptr) {
         delete [] learn_values;
     }
@@ -103,42 +142,61 @@ void AP_TempCalibration::setup_learning(void)
 }
 
 /*
-  calculate the sum of squares range of pressure values we get with
-  the current data. This is the function we try to minimise in the
-  calibration
+  start a pass over the data learned so far, finding the sum of squares
+  range of pressure values we get with the current exponent and the
+  exponents either side of it. This is the function we try to minimise
+  in the calibration
  */
-float AP_TempCalibration::calculate_p_range(float baro_factor) const
+void AP_TempCalibration::start_learn_pass(void)
 {
-    float sum = 0;
-    float P0 = learn_values[0] + calculate_correction(learn_temp_start, baro_factor);
-    for (uint16_t i=0; i<learn_i; i++) {
+    learn_pass.active = true;
+    learn_pass.i = 0;
+    learn_pass.n = learn_i;
+    learn_pass.exponent[0] = baro_exponent;
+    learn_pass.exponent[1] = baro_exponent + learn_delta;
+    learn_pass.exponent[2] = baro_exponent - learn_delta;
+    for (uint8_t k=0; k<3; k++) {
+        learn_pass.P0[k] = learn_values[0] + calculate_correction(learn_temp_start, learn_pass.exponent[k]);
+        learn_pass.sum[k] = 0;
+    }
+}
+
+/*
+  add the next learn_pass_step temperatures to the pass. Returns true
+  when the pass is complete
+ */
+bool AP_TempCalibration::continue_learn_pass(void)
+{
+    const uint16_t end = MIN(learn_pass.i + learn_pass_step, learn_pass.n);
+    for (; learn_pass.i < end; learn_pass.i++) {
+        const uint16_t i = learn_pass.i;
         if (is_zero(learn_values[i])) {
             // gap in the data
             continue;
         }
-        float temp = learn_temp_start + learn_temp_step*i;
-        float correction = calculate_correction(temp, baro_factor);
-        float P = learn_values[i] + correction;
-        sum += sq(P - P0);
+        const float temp = learn_temp_start + learn_temp_step*i;
+        for (uint8_t k=0; k<3; k++) {
+            const float P = learn_values[i] + calculate_correction(temp, learn_pass.exponent[k]);
+            learn_pass.sum[k] += sq(P - learn_pass.P0[k]);
+        }
     }
-    return sum / learn_i;
+    return learn_pass.i >= learn_pass.n;
 }
 
 /*
-  calculate a calibration value
+  calculate a calibration value from a completed pass
 
   This fits a simple single value power function to the baro data to
   find the calibration exponent.
  */
 void AP_TempCalibration::calculate_calibration(void)
 {
-    float current_err = calculate_p_range(baro_exponent);
-    float test_exponent = baro_exponent + learn_delta;
-    float test_err = calculate_p_range(test_exponent);
-    if (test_err >= current_err) {
-        test_exponent = baro_exponent - learn_delta;
-        test_err = calculate_p_range(test_exponent);
-    }
+    // the sums are over the same temperatures, so can be compared
+    // without dividing by the count
+    const float current_err = learn_pass.sum[0];
+    const uint8_t test = (learn_pass.sum[1] < current_err) ? 1 : 2;
+    const float test_exponent = learn_pass.exponent[test];
+    const float test_err = learn_pass.sum[test];
     if (test_exponent <= exp_limit_max &&
         test_exponent >= exp_limit_min &&
         test_err < current_err) {
@@ -148,7 +206,7 @@ void AP_TempCalibration::calculate_calibration(void)
             baro_exponent.set_and_save(test_exponent);
         }
         temp_min.set_and_save_ifchanged(learn_temp_start);
-        temp_max.set_and_save_ifchanged(learn_temp_start + learn_i*learn_temp_step);
+        temp_max.set_and_save_ifchanged(learn_temp_start + learn_pass.n*learn_temp_step);
     }
 }
 
@@ -191,12 +249,18 @@ void AP_TempCalibration::learn_calibration(void)
     learn_i = MAX(learn_i, idx);
     
     uint32_t now = AP_HAL::millis();
-    if (now - last_learn_ms > 100 &&
+    if (learn_pass.active) {
+        if (continue_learn_pass()) {
+            learn_pass.active = false;
+            // update parameters
+            calculate_calibration();
+        }
+    } else if (now - last_learn_ms > 100 &&
         idx*learn_temp_step > min_learn_temp_range &&
         temp - learn_temp_start > temp_max - temp_min) {
         last_learn_ms = now;
-        // run estimation and update parameters
-        calculate_calibration();
+        // start estimation
+        start_learn_pass();
     }
 }
 
@@ -211,7 +275,7 @@ void AP_TempCalibration::apply_calibration(void)
         return;
     }
     float temp = baro.get_temperature(0);
-    float correction = calculate_correction(temp, baro_exponent);
+    float correction = table_correction(temp);
     baro.set_pressure_correction(0, correction);
 }
 
@@ -71,12 +71,36 @@ private:
     // require observation of at least 5 degrees of temp range to
     // start learning
     const float min_learn_temp_range = 7;
+
+    // a pass of the learner over the learned data, comparing the
+    // current exponent with the exponent moved either way by
+    // learn_delta. The pass is spread over calls, doing at most
+    // learn_pass_step temperatures in each, to bound the cost of a call
+    static const uint8_t learn_pass_step = 20;
+    struct {
+        bool active;
+        uint16_t i;             // next temperature to add
+        uint16_t n;             // number of temperatures in this pass
+        float exponent[3];
+        float P0[3];            // corrected pressure of the first temperature
+        float sum[3];           // sum of squared differences from P0
+    } learn_pass;
+
+    // corrections at 1 degree steps from Tzero with the exponent
+    // they were built for. Corrections are interpolated from this
+    // rather than calling powf() for each
+    static const uint8_t table_size = 64;
+    float *correction_table;
+    float table_exponent;
     
     void setup_learning(void);
     void learn_calibration(void);
     void apply_calibration(void);
     void calculate_calibration();
     float calculate_correction(float temp, float exponent) const;
-    float calculate_p_range(float baro_factor) const;
+    void start_learn_pass(void);
+    bool continue_learn_pass(void);
+    void build_table(void);
+    float table_correction(float temp);
     
 };
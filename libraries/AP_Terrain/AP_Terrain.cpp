@@ -41,7 +41,7 @@ const AP_Param::GroupInfo AP_Terrain::var_info[] = {
 
     // @Param: SPACING
     // @DisplayName: Terrain grid spacing
-    // @Description: Distance between terrain grid points in meters. This controls the horizontal resolution of the terrain data that is stored on te SD card and requested from the ground station. If your GCS is using the worldwide SRTM database then a resolution of 100 meters is appropriate. Some parts of the world may have higher resolution data available, such as 30 meter data available in the SRTM database in the USA. The grid spacing also controls how much data is kept in memory during flight. A larger grid spacing will allow for a larger amount of data in memory. A grid spacing of 100 meters results in the vehicle keeping 12 grid squares in memory with each grid square having a size of 2.7 kilometers by 3.2 kilometers. Any additional grid squares are stored on the SD once they are fetched from the GCS and will be demand loaded as needed.
+    // @Description: Distance between terrain grid points in meters. This controls the horizontal resolution of the terrain data that is stored on te SD card and requested from the ground station. If your GCS is using the worldwide SRTM database then a resolution of 100 meters is appropriate. Some parts of the world may have higher resolution data available, such as 30 meter data available in the SRTM database in the USA. The grid spacing also controls how much data is kept in memory during flight. A larger grid spacing will allow for a larger amount of data in memory. A grid spacing of 100 meters results in the vehicle keeping at least 12 grid squares in memory with each grid square having a size of 2.7 kilometers by 3.2 kilometers. Any additional grid squares are stored on the SD once they are fetched from the GCS and will be demand loaded as needed.
     // @Units: m
     // @Increment: 1
     // @User: Advanced
@@ -106,8 +106,40 @@ bool AP_Terrain::height_amsl(const Location &loc, float &height, bool corrected)
     calculate_grid_info(loc, info);
 
     // find the grid
-    const struct grid_block &grid = find_grid_cache(info).grid;
+    const struct grid_cache &gcache = find_grid_cache(info);
+    const struct grid_block &grid = gcache.grid;
+    if (gcache.state >= GRID_CACHE_VALID) {
+        cache_hits++;
+    } else {
+        cache_misses++;
+    }
+
+    if (!interpolate_height(grid, info, height)) {
+        return false;
+    }
+
+    if (loc.lat == ahrs.get_home().lat &&
+        loc.lng == ahrs.get_home().lng) {
+        // remember home altitude as a special case
+        home_height = height;
+        home_loc = loc;
+    }
+
+    // apply correction which assumes home altitude is at terrain altitude
+    if (corrected) {
+        height += (ahrs.get_home().alt * 0.01f) - home_height;
+    }
+
+    return true;
+}
 
+/*
+  interpolate the terrain height at the position given by info within
+  a grid block. Returns false if the block doesn't have the heights of
+  all 4 surrounding grid points
+ */
+bool AP_Terrain::interpolate_height(const struct grid_block &grid, const struct grid_info &info, float &height)
+{
     /*
       note that we rely on the one square overlap to ensure these
       calculations don't go past the end of the arrays
@@ -140,20 +172,56 @@ bool AP_Terrain::height_amsl(const Location &loc, float &height, bool corrected)
     float avg  = (1.0f-info.frac_y) * avg1 + info.frac_y * avg2;
 
     height = avg;
+    return true;
+}
 
-    if (loc.lat == ahrs.get_home().lat &&
-        loc.lng == ahrs.get_home().lng) {
-        // remember home altitude as a special case
-        home_height = height;
-        home_loc = loc;
+/*
+  find the terrain heights in meters above sea level at count points
+  along a straight path
+ */
+uint8_t AP_Terrain::height_profile(const Location &loc, float bearing, float spacing, uint8_t count, float *heights)
+{
+    if (!allocate()) {
+        return 0;
     }
 
-    // apply correction which assumes home altitude is at terrain altitude
-    if (corrected) {
-        height += (ahrs.get_home().alt * 0.01f) - home_height;
+    // the step between points is the same all along the path, so
+    // only needs the trig doing once
+    const float step_north = cosf(radians(bearing)) * spacing;
+    const float step_east = sinf(radians(bearing)) * spacing;
+
+    // consecutive points are nearly always in the same grid block, so
+    // keep hold of the last block rather than searching the cache for
+    // it at each point
+    const struct grid_cache *gcache = nullptr;
+    uint8_t valid = 0;
+
+    for (uint8_t i=0; i<count; i++) {
+        Location point = loc;
+        point.offset(step_north * (i+1), step_east * (i+1));
+
+        struct grid_info info;
+        calculate_grid_info(point, info);
+
+        if (gcache == nullptr ||
+            !TERRAIN_LATLON_EQUAL(gcache->grid.lat, info.grid_lat) ||
+            !TERRAIN_LATLON_EQUAL(gcache->grid.lon, info.grid_lon)) {
+            gcache = &find_grid_cache(info);
+        }
+        if (gcache->state >= GRID_CACHE_VALID) {
+            cache_hits++;
+        } else {
+            cache_misses++;
+        }
+
+        if (interpolate_height(gcache->grid, info, heights[i])) {
+            valid++;
+        } else {
+            heights[i] = nanf("");
+        }
     }
 
-    return true;
+    return valid;
 }
 
 
@@ -278,18 +346,24 @@ float AP_Terrain::lookahead(float bearing, float distance, float climb_ratio)
     float climb = 0;
     float lookahead_estimate = 0;
 
-    // check for terrain at grid spacing intervals
+    // check for terrain at grid spacing intervals, a batch of points
+    // at a time
     while (distance > 0) {
-        loc.offset_bearing(bearing, grid_spacing);
-        climb += climb_ratio * grid_spacing;
-        distance -= grid_spacing;
-        float height;
-        if (height_amsl(loc, height, false)) {
-            float rise = (height - base_height) - climb;
+        float heights[16];
+        const uint8_t count = MIN(ceilf(distance / grid_spacing), ARRAY_SIZE(heights));
+        height_profile(loc, bearing, grid_spacing, count, heights);
+        for (uint8_t i=0; i<count; i++) {
+            climb += climb_ratio * grid_spacing;
+            if (isnan(heights[i])) {
+                continue;
+            }
+            float rise = (heights[i] - base_height) - climb;
             if (rise > lookahead_estimate) {
                 lookahead_estimate = rise;
             }
         }
+        loc.offset_bearing(bearing, grid_spacing * count);
+        distance -= grid_spacing * count;
     }
 
     return lookahead_estimate;
@@ -303,6 +377,11 @@ float AP_Terrain::lookahead(float bearing, float distance, float climb_ratio)
  */
 void AP_Terrain::update(void)
 {
+    if (enable == 0) {
+        // give the cache back if terrain has been disabled
+        deallocate();
+    }
+
     // just schedule any needed disk IO
     schedule_disk_io();
 
@@ -327,6 +406,9 @@ void AP_Terrain::update(void)
     // check for pending rally data
     update_rally_data();
 
+    // load grids we will need soon
+    update_prefetch();
+
     // update capabilities and status
     if (allocate()) {
         if (!pos_valid) {
@@ -357,10 +439,12 @@ void AP_Terrain::log_terrain_data()
     float terrain_height = 0;
     float current_height = 0;
     uint16_t pending, loaded;
+    uint32_t hits, misses;
 
     height_amsl(loc, terrain_height, false);
     height_above_terrain(current_height, true);
     get_statistics(pending, loaded);
+    get_cache_statistics(hits, misses);
 
     struct log_TERRAIN pkt = {
         LOG_PACKET_HEADER_INIT(LOG_TERRAIN_MSG),
@@ -372,14 +456,18 @@ void AP_Terrain::log_terrain_data()
         terrain_height : terrain_height,
         current_height : current_height,
         pending        : pending,
-        loaded         : loaded
+        loaded         : loaded,
+        cache_hits     : hits,
+        cache_misses   : misses
     };
     AP::logger().WriteBlock(&pkt, sizeof(pkt));
 }
 
 /*
   allocate terrain cache. Making this dynamically allocated allows
-  memory to be saved when terrain functionality is disabled
+  memory to be saved when terrain functionality is disabled. The cache
+  takes up to a quarter of the free memory, so boards with plenty of
+  RAM hold more of the area around the vehicle
  */
 bool AP_Terrain::allocate(void)
 {
@@ -389,14 +477,40 @@ bool AP_Terrain::allocate(void)
     if (cache != nullptr) {
         return true;
     }
-    cache = (struct grid_cache *)calloc(TERRAIN_GRID_BLOCK_CACHE_SIZE, sizeof(cache[0]));
+    const uint32_t num_blocks = constrain_int32(hal.util->available_memory() / (4 * sizeof(cache[0])),
+                                                TERRAIN_GRID_BLOCK_CACHE_SIZE,
+                                                TERRAIN_GRID_BLOCK_CACHE_MAX);
+    cache = (struct grid_cache *)calloc(num_blocks, sizeof(cache[0]));
+    if (cache == nullptr && num_blocks > TERRAIN_GRID_BLOCK_CACHE_SIZE) {
+        cache = (struct grid_cache *)calloc(TERRAIN_GRID_BLOCK_CACHE_SIZE, sizeof(cache[0]));
+        cache_size = TERRAIN_GRID_BLOCK_CACHE_SIZE;
+    } else {
+        cache_size = num_blocks;
+    }
     if (cache == nullptr) {
         gcs().send_text(MAV_SEVERITY_CRITICAL, "Terrain: Allocation failed");
         memory_alloc_failed = true;
+        cache_size = 0;
         return false;
     }
-    cache_size = TERRAIN_GRID_BLOCK_CACHE_SIZE;
     return true;
 }
 
+/*
+  free the terrain cache. The IO thread only works on disk_block, so
+  the cache can be freed with a disk read or write in progress. Blocks
+  received from the GCS but not yet written to disk are lost
+ */
+void AP_Terrain::deallocate(void)
+{
+    if (cache == nullptr) {
+        return;
+    }
+    free(cache);
+    cache = nullptr;
+    cache_size = 0;
+    // allow a new attempt if terrain is enabled again
+    memory_alloc_failed = false;
+}
+
 #endif // AP_TERRAIN_AVAILABLE
@@ -51,12 +51,32 @@
 #define TERRAIN_GRID_BLOCK_SIZE_X (TERRAIN_GRID_MAVLINK_SIZE*TERRAIN_GRID_BLOCK_MUL_X)
 #define TERRAIN_GRID_BLOCK_SIZE_Y (TERRAIN_GRID_MAVLINK_SIZE*TERRAIN_GRID_BLOCK_MUL_Y)
 
-// number of grid_blocks in the LRU memory cache
+// minimum number of grid_blocks in the LRU memory cache. More are
+// allocated when the board has memory to spare
 #define TERRAIN_GRID_BLOCK_CACHE_SIZE 12
 
+// maximum number of grid_blocks in the LRU memory cache
+#ifndef TERRAIN_GRID_BLOCK_CACHE_MAX
+#define TERRAIN_GRID_BLOCK_CACHE_MAX 48
+#endif
+
+// how far ahead along the current velocity to prefetch grid_blocks,
+// in seconds
+#define TERRAIN_PREFETCH_TIME 60
+
+// a grid_block not used for this long may be replaced by a prefetch
+#define TERRAIN_PREFETCH_MIN_AGE_MS 5000
+
 // format of grid on disk
 #define TERRAIN_GRID_FORMAT_VERSION 1
 
+// on boards with a POSIX filesystem the degree files are memory
+// mapped, so blocks already on disk can be loaded without waiting for
+// the IO thread
+#ifndef AP_TERRAIN_MMAP_ENABLED
+#define AP_TERRAIN_MMAP_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
 // we allow for a 2cm discrepancy in the grid corners. This is to
 // account for different rounding in terrain DAT file generators using
 // different programming languages
@@ -125,6 +145,18 @@ public:
      */
     bool height_amsl(const Location &loc, float &height, bool corrected);
 
+    /*
+      find the terrain heights in meters above sea level at count
+      points spaced spacing meters apart along bearing (degrees) from
+      loc, starting one spacing from loc. This is much cheaper than
+      calling height_amsl() for each point, as the grid block is only
+      looked up again when the path crosses into another one.
+
+      Points without terrain data are set to NaN. Returns the number
+      of points with terrain data
+     */
+    uint8_t height_profile(const Location &loc, float bearing, float spacing, uint8_t count, float *heights);
+
     /* 
        find difference between home terrain height and the terrain
        height at the current location in meters. A positive result
@@ -185,6 +217,13 @@ public:
      */
     void get_statistics(uint16_t &pending, uint16_t &loaded) const;
 
+    /*
+      get grid_cache statistics. Hits are height lookups answered from a
+      block in memory, misses are lookups that had to wait for a block
+      to be loaded
+     */
+    void get_cache_statistics(uint32_t &hits, uint32_t &misses) const;
+
     /*
       returns true if initialisation failed because out-of-memory
      */
@@ -194,6 +233,9 @@ private:
     // allocate the terrain subsystem data
     bool allocate(void);
 
+    // free the terrain subsystem data when terrain is disabled
+    void deallocate(void);
+
     /*
       a grid block is a structure in a local file containing height
       information. Each grid block is 2048 in size, to keep file IO to
@@ -305,6 +347,11 @@ private:
     */
     bool check_bitmap(const struct grid_block &grid, uint8_t idx_x, uint8_t idx_y);
 
+    /*
+      interpolate the height at a grid_info within a grid block
+    */
+    bool interpolate_height(const struct grid_block &grid, const struct grid_info &info, float &height);
+
     /*
       request any missing 4x4 grids from a block
     */
@@ -330,6 +377,7 @@ private:
     void check_disk_write(void);
     void io_timer(void);
     void open_file(void);
+    uint32_t block_file_offset(struct grid_block &block) const;
     void seek_offset(void);
     uint32_t east_blocks(struct grid_block &block) const;
     void write_block(void);
@@ -345,6 +393,14 @@ private:
      */
     void update_rally_data(void);
 
+    /*
+      load grid_blocks the vehicle will soon need, along its velocity
+      vector and the next legs of the mission
+     */
+    void update_prefetch(void);
+    bool prefetch_leg(const Location &from, const Location &to, uint8_t &budget);
+    bool prefetch_grid(const Location &loc, uint8_t &budget);
+
 
     // parameters
     AP_Int8  enable;
@@ -395,6 +451,20 @@ private:
     // have we created the terrain directory?
     bool directory_created;
 
+#if AP_TERRAIN_MMAP_ENABLED
+    /*
+      read-only mapping of the last opened degree file. The IO thread
+      replaces the mapping, the main thread loads blocks from it
+     */
+    void update_mapping(void);
+    bool load_mapped_block(struct grid_cache &gcache);
+    HAL_Semaphore map_sem;
+    const uint8_t *map_base;
+    size_t map_length;
+    int8_t map_lat_degrees;
+    int16_t map_lon_degrees;
+#endif
+
     // cache the home altitude, as it is needed so often
     float home_height;
     Location home_loc;
@@ -426,6 +496,13 @@ private:
     // grid spacing during rally check
     uint16_t last_rally_spacing;
 
+    // last time we prefetched grid_blocks
+    uint32_t last_prefetch_ms;
+
+    // cache statistics
+    uint32_t cache_hits;
+    uint32_t cache_misses;
+
     char *file_path = nullptr;
 
     // status
@@ -188,6 +188,15 @@ void AP_Terrain::get_statistics(uint16_t &pending, uint16_t &loaded) const
     }
 }
 
+/*
+  get grid_cache statistics
+ */
+void AP_Terrain::get_cache_statistics(uint32_t &hits, uint32_t &misses) const
+{
+    hits = cache_hits;
+    misses = cache_misses;
+}
+
 
 /* 
    handle terrain messages from GCS
@@ -28,6 +28,11 @@
 
 #include <AP_Filesystem/AP_Filesystem.h>
 
+#if AP_TERRAIN_MMAP_ENABLED
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 extern const AP_HAL::HAL& hal;
 
 /*
@@ -205,6 +210,94 @@ void AP_Terrain::open_file(void)
     file_lon_degrees = block.lon_degrees;
 }
 
+#if AP_TERRAIN_MMAP_ENABLED
+/*
+  map the open degree file, replacing any previous mapping. Called
+  from the IO thread when the file changes or grows
+ */
+void AP_Terrain::update_mapping(void)
+{
+    struct stat st;
+    if (fd == -1 || fstat(fd, &st) != 0) {
+        return;
+    }
+    if (map_base != nullptr &&
+        map_lat_degrees == file_lat_degrees &&
+        map_lon_degrees == file_lon_degrees &&
+        map_length == (size_t)st.st_size) {
+        // mapping is up to date
+        return;
+    }
+
+    const uint8_t *new_base = nullptr;
+    if (st.st_size > 0) {
+        void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED) {
+            new_base = (const uint8_t *)p;
+        }
+    }
+
+    WITH_SEMAPHORE(map_sem);
+    if (map_base != nullptr) {
+        munmap((void *)map_base, map_length);
+    }
+    map_base = new_base;
+    map_length = new_base != nullptr ? st.st_size : 0;
+    map_lat_degrees = file_lat_degrees;
+    map_lon_degrees = file_lon_degrees;
+}
+
+/*
+  load a block waiting for disk IO straight from the mapped degree
+  file. Returns false if the block is not covered by the mapping, in
+  which case the IO thread reads it as usual. Called from the main
+  thread
+ */
+bool AP_Terrain::load_mapped_block(struct grid_cache &gcache)
+{
+    if (!map_sem.take_nonblocking()) {
+        return false;
+    }
+    struct grid_block &block = gcache.grid;
+    if (map_base == nullptr ||
+        block.lat_degrees != map_lat_degrees ||
+        block.lon_degrees != map_lon_degrees) {
+        map_sem.give();
+        return false;
+    }
+    const uint32_t file_offset = block_file_offset(block);
+    if (file_offset + sizeof(union grid_io_block) > map_length) {
+        map_sem.give();
+        return false;
+    }
+
+    const struct grid_block &mapped = ((const union grid_io_block *)&map_base[file_offset])->block;
+
+    // CRC of the block with the crc field taken as zero, as in get_block_crc()
+    const uint8_t *bytes = (const uint8_t *)&mapped;
+    const uint8_t zero_crc[sizeof(mapped.crc)] {};
+    const uint32_t crc_ofs = offsetof(struct grid_block, crc);
+    uint16_t crc = crc16_ccitt(bytes, crc_ofs, 0);
+    crc = crc16_ccitt(zero_crc, sizeof(zero_crc), crc);
+    crc = crc16_ccitt(&bytes[crc_ofs+sizeof(zero_crc)], sizeof(mapped)-(crc_ofs+sizeof(zero_crc)), crc);
+
+    if (TERRAIN_LATLON_EQUAL(mapped.lat,block.lat) &&
+        TERRAIN_LATLON_EQUAL(mapped.lon,block.lon) &&
+        mapped.bitmap != 0 &&
+        mapped.spacing == grid_spacing &&
+        mapped.version == TERRAIN_GRID_FORMAT_VERSION &&
+        mapped.crc == crc) {
+        block = mapped;
+    }
+    // otherwise the block is not on disk yet, leaving an empty block
+    // to be filled from the GCS
+    map_sem.give();
+
+    gcache.state = GRID_CACHE_VALID;
+    return true;
+}
+#endif // AP_TERRAIN_MMAP_ENABLED
+
 /*
   work out how many blocks needed in a stride for a given location
  */
@@ -223,14 +316,21 @@ uint32_t AP_Terrain::east_blocks(struct grid_block &block) const
 }
 
 /*
-  seek to the right offset for disk_block
+  get the offset of a block in its degree file
  */
-void AP_Terrain::seek_offset(void)
+uint32_t AP_Terrain::block_file_offset(struct grid_block &block) const
 {
-    struct grid_block &block = disk_block.block;
     // work out how many longitude blocks there are at this latitude
     uint32_t blocknum = east_blocks(block) * block.grid_idx_x + block.grid_idx_y;
-    uint32_t file_offset = blocknum * sizeof(union grid_io_block);
+    return blocknum * sizeof(union grid_io_block);
+}
+
+/*
+  seek to the right offset for disk_block
+ */
+void AP_Terrain::seek_offset(void)
+{
+    uint32_t file_offset = block_file_offset(disk_block.block);
     if (AP::FS().lseek(fd, file_offset, SEEK_SET) != (off_t)file_offset) {
 #if TERRAIN_DEBUG
         hal.console->printf("Seek %lu failed - %s\n",
@@ -264,6 +364,10 @@ void AP_Terrain::write_block(void)
         io_failure = true;
     } else {
         AP::FS().fsync(fd);
+#if AP_TERRAIN_MMAP_ENABLED
+        // the file may have grown
+        update_mapping();
+#endif
 #if TERRAIN_DEBUG
         printf("wrote block at %ld %ld ret=%d mask=%07llx\n",
                (long)disk_block.block.lat,
@@ -358,6 +462,9 @@ void AP_Terrain::io_timer(void)
         if (fd == -1) {
             return;
         }
+#if AP_TERRAIN_MMAP_ENABLED
+        update_mapping();
+#endif
         read_block();
         break;
     }
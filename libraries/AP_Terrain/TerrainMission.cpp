@@ -13,7 +13,8 @@
    along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 /*
-  handle checking mission points for terrain data
+  handle checking mission points for terrain data, and prefetching
+  the grids the vehicle is heading towards
  */
 
 #include <AP_HAL/AP_HAL.h>
@@ -24,6 +25,7 @@
 #include <GCS_MAVLink/GCS.h>
 #include "AP_Terrain.h"
 #include <AP_GPS/AP_GPS.h>
+#include <AP_AHRS/AP_AHRS.h>
 
 #if AP_TERRAIN_AVAILABLE
 
@@ -164,4 +166,129 @@ void AP_Terrain::update_rally_data(void)
     }
 }
 
+/*
+  prefetch one grid_block into the cache. Returns false when the
+  prefetch budget is used up or there is no free slot, in which case
+  the caller should stop for this round
+ */
+bool AP_Terrain::prefetch_grid(const Location &loc, uint8_t &budget)
+{
+    struct grid_info info;
+    calculate_grid_info(loc, info);
+
+    const uint32_t now_ms = AP_HAL::millis();
+    uint16_t oldest_i = 0;
+    for (uint16_t i=0; i<cache_size; i++) {
+        if (TERRAIN_LATLON_EQUAL(cache[i].grid.lat,info.grid_lat) &&
+            TERRAIN_LATLON_EQUAL(cache[i].grid.lon,info.grid_lon) &&
+            cache[i].grid.spacing == grid_spacing) {
+            // already cached or being loaded
+            return true;
+        }
+        if (cache[i].last_access_ms < cache[oldest_i].last_access_ms) {
+            oldest_i = i;
+        }
+    }
+
+    if (budget == 0) {
+        return false;
+    }
+
+    // only replace a grid that is idle, so prefetching never evicts
+    // data the vehicle is using now
+    const struct grid_cache &oldest = cache[oldest_i];
+    if (oldest.state == GRID_CACHE_DIRTY ||
+        oldest.state == GRID_CACHE_DISKWAIT ||
+        now_ms - oldest.last_access_ms < TERRAIN_PREFETCH_MIN_AGE_MS) {
+        return false;
+    }
+
+    // claim the slot. The disk IO thread loads it, and if it is not
+    // on disk it is requested from the GCS
+    find_grid_cache(info);
+    budget--;
+    return true;
+}
+
+/*
+  prefetch the grid_blocks along a line between two locations
+ */
+bool AP_Terrain::prefetch_leg(const Location &from, const Location &to, uint8_t &budget)
+{
+    const Vector2f ne = from.get_distance_NE(to);
+    const float length = ne.length();
+
+    // step at half a grid_block, so no block along the line is skipped
+    const float step = MAX(grid_spacing * TERRAIN_GRID_BLOCK_SPACING_X * 0.5f, 1.0f);
+    const uint8_t steps = constrain_int32(length / step, 0, 64);
+
+    for (uint8_t i=1; i<=steps; i++) {
+        Location loc = from;
+        const float frac = i / float(steps);
+        loc.offset(ne.x * frac, ne.y * frac);
+        if (!prefetch_grid(loc, budget)) {
+            return false;
+        }
+    }
+    return prefetch_grid(to, budget);
+}
+
+/*
+  load grid_blocks ahead of the vehicle. We look along the current
+  ground velocity and along the next few legs of the mission, and
+  claim idle cache slots for blocks we don't have, so the disk reads
+  and GCS requests happen before the vehicle gets there
+ */
+void AP_Terrain::update_prefetch(void)
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - last_prefetch_ms < 1000 || cache_size == 0) {
+        return;
+    }
+    last_prefetch_ms = now_ms;
+
+    AP_AHRS &ahrs = AP::ahrs();
+    Location loc;
+    if (!ahrs.get_position(loc)) {
+        return;
+    }
+
+    // don't use more than a third of the cache each round
+    uint8_t budget = cache_size / 3;
+
+    // along the current velocity
+    const Vector2f vel = ahrs.groundspeed_vector();
+    if (vel.length() > 1) {
+        Location ahead = loc;
+        ahead.offset(vel.x * TERRAIN_PREFETCH_TIME, vel.y * TERRAIN_PREFETCH_TIME);
+        if (!prefetch_leg(loc, ahead, budget)) {
+            return;
+        }
+    }
+
+    // along the next legs of the mission
+    if (mission.state() != AP_Mission::MISSION_RUNNING) {
+        return;
+    }
+    Location prev = loc;
+    uint8_t legs = 0;
+    for (uint16_t index = mission.get_current_nav_index();
+         index != AP_MISSION_CMD_INDEX_NONE && index < mission.num_commands() && legs < 3;
+         index++) {
+        AP_Mission::Mission_Command cmd;
+        if (!mission.read_cmd_from_storage(index, cmd)) {
+            break;
+        }
+        if (!AP_Mission::is_nav_cmd(cmd) ||
+            (cmd.content.location.lat == 0 && cmd.content.location.lng == 0)) {
+            continue;
+        }
+        if (!prefetch_leg(prev, cmd.content.location, budget)) {
+            return;
+        }
+        prev = cmd.content.location;
+        legs++;
+    }
+}
+
 #endif // AP_TERRAIN_AVAILABLE
@@ -142,6 +142,12 @@ AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info
     // mark as waiting for disk read
     grid.state = GRID_CACHE_DISKWAIT;
 
+#if AP_TERRAIN_MMAP_ENABLED
+    // if the degree file is mapped, load the block now rather than
+    // waiting for the IO thread
+    load_mapped_block(grid);
+#endif
+
     return grid;
 }
 
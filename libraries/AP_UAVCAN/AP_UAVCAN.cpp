@@ -96,6 +96,22 @@ const AP_Param::GroupInfo AP_UAVCAN::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("SRV_RT", 4, AP_UAVCAN, _servo_rate_hz, 50),
 
+    // @Param: POOL
+    // @DisplayName: UAVCAN memory pool size
+    // @Description: Size of the memory pool used by UAVCAN for transfer buffers and subscriptions. Transfers are dropped if it runs out, which is shown by the Fail field of the CANP log message and in @SYS/uavcan.txt
+    // @Range: 2048 65536
+    // @Units: B
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("POOL", 5, AP_UAVCAN, _pool_size, UAVCAN_NODE_POOL_SIZE),
+
+    // @Param: POOL_AUTO
+    // @DisplayName: UAVCAN memory pool automatic sizing
+    // @Description: When enabled, a minute after boot POOL is set to twice the most of the pool used so far, or doubled if allocations have failed, so it fits the nodes on this bus from the next boot
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    AP_GROUPINFO("POOL_AUTO", 6, AP_UAVCAN, _pool_auto, 0),
+
     AP_GROUPEND
 };
 
@@ -105,7 +121,6 @@ const AP_Param::GroupInfo AP_UAVCAN::var_info[] = {
 
 // publisher interfaces
 static uavcan::Publisher<uavcan::equipment::actuator::ArrayCommand>* act_out_array[MAX_NUMBER_OF_CAN_DRIVERS];
-static uavcan::Publisher<uavcan::equipment::esc::RawCommand>* esc_raw[MAX_NUMBER_OF_CAN_DRIVERS];
 static uavcan::Publisher<uavcan::equipment::indication::LightsCommand>* rgb_led[MAX_NUMBER_OF_CAN_DRIVERS];
 static uavcan::Publisher<uavcan::equipment::indication::BeepCommand>* buzzer[MAX_NUMBER_OF_CAN_DRIVERS];
 static uavcan::Publisher<ardupilot::indication::SafetyState>* safety_state[MAX_NUMBER_OF_CAN_DRIVERS];
@@ -130,8 +145,7 @@ UC_REGISTRY_BINDER(ESCStatusCb, uavcan::equipment::esc::Status);
 static uavcan::Subscriber<uavcan::equipment::esc::Status, ESCStatusCb> *esc_status_listener[MAX_NUMBER_OF_CAN_DRIVERS];
 
 
-AP_UAVCAN::AP_UAVCAN() :
-    _node_allocator()
+AP_UAVCAN::AP_UAVCAN()
 {
     AP_Param::setup_object_defaults(this, var_info);
 
@@ -182,6 +196,12 @@ void AP_UAVCAN::init(uint8_t driver_index, bool enable_filters)
         return;
     }
 
+    uint32_t pool_size = constrain_int32(_pool_size, UAVCAN_NODE_POOL_SIZE_MIN, UAVCAN_NODE_POOL_SIZE_MAX);
+    if (!_node_allocator.init(pool_size)) {
+        debug_uavcan(1, "UAVCAN: couldn't allocate pool\n\r");
+        return;
+    }
+
     _node = new uavcan::Node<0>(*driver, SystemClock::instance(), _node_allocator);
 
     if (_node == nullptr) {
@@ -253,10 +273,6 @@ void AP_UAVCAN::init(uint8_t driver_index, bool enable_filters)
     act_out_array[driver_index]->setTxTimeout(uavcan::MonotonicDuration::fromMSec(2));
     act_out_array[driver_index]->setPriority(uavcan::TransferPriority::OneLowerThanHighest);
 
-    esc_raw[driver_index] = new uavcan::Publisher<uavcan::equipment::esc::RawCommand>(*_node);
-    esc_raw[driver_index]->setTxTimeout(uavcan::MonotonicDuration::fromMSec(2));
-    esc_raw[driver_index]->setPriority(uavcan::TransferPriority::OneLowerThanHighest);
-
     rgb_led[driver_index] = new uavcan::Publisher<uavcan::equipment::indication::LightsCommand>(*_node);
     rgb_led[driver_index]->setTxTimeout(uavcan::MonotonicDuration::fromMSec(20));
     rgb_led[driver_index]->setPriority(uavcan::TransferPriority::OneHigherThanLowest);
@@ -315,6 +331,7 @@ void AP_UAVCAN::init(uint8_t driver_index, bool enable_filters)
         return;
     }
 
+    _init_ms = AP_HAL::millis();
     _initialized = true;
     debug_uavcan(2, "UAVCAN: init done\n\r");
 }
@@ -327,7 +344,11 @@ void AP_UAVCAN::loop(void)
             continue;
         }
 
-        const int error = _node->spin(uavcan::MonotonicDuration::fromMSec(1));
+        // wake on received frames, or when SRV_push_servos() has new
+        // outputs, so ESC commands go out as soon as they are produced
+        wait_for_event(uavcan::MonotonicDuration::fromMSec(1));
+
+        const int error = _node->spinOnce();
 
         if (error < 0) {
             hal.scheduler->delay_microseconds(100);
@@ -335,7 +356,11 @@ void AP_UAVCAN::loop(void)
         }
 
         if (_SRV_armed) {
-            bool sent_servos = false;
+            // if we have any ESC's in bitmask. These go first as they
+            // bypass the libuavcan queue and should not wait on servos
+            if (_esc_bm > 0) {
+                SRV_send_esc();
+            }
 
             if (_servo_bm > 0) {
                 // if we have any Servos in bitmask
@@ -344,31 +369,100 @@ void AP_UAVCAN::loop(void)
                 if (now - _SRV_last_send_us >= servo_period_us) {
                     _SRV_last_send_us = now;
                     SRV_send_actuator();
-                    sent_servos = true;
                     for (uint8_t i = 0; i < UAVCAN_SRV_NUMBER; i++) {
                         _SRV_conf[i].servo_pending = false;
                     }
                 }
             }
-
-            // if we have any ESC's in bitmask
-            if (_esc_bm > 0 && !sent_servos) {
-                SRV_send_esc();
-            }
-
-            for (uint8_t i = 0; i < UAVCAN_SRV_NUMBER; i++) {
-                _SRV_conf[i].esc_pending = false;
-            }
         }
 
         led_out_send();
         buzzer_send();
         rtcm_stream_send();
         safety_state_send();
+        pool_update();
         AP::uavcan_server().verify_nodes(this);
     }
 }
 
+bool AP_UAVCAN::get_stats(Stats &stats) const
+{
+    if (!_initialized) {
+        return false;
+    }
+    _node_allocator.get_stats(stats.pool);
+    stats.transfer_errors = _node->getDispatcher().getTransferPerfCounter().getErrorCount();
+    stats.can_errors = 0;
+    const uavcan::ICanDriver* driver = hal.can_mgr[_driver_index]->get_driver();
+    for (uint8_t i = 0; i < driver->getNumIfaces(); i++) {
+        const uavcan::ICanIface* iface = driver->getIface(i);
+        if (iface != nullptr) {
+            stats.can_errors += iface->getErrorCount();
+        }
+    }
+    return true;
+}
+
+void AP_UAVCAN::pool_update()
+{
+    const uint32_t now = AP_HAL::millis();
+    if (now - _pool_log_ms < 1000) {
+        return;
+    }
+    _pool_log_ms = now;
+
+    Stats stats;
+    if (!get_stats(stats)) {
+        return;
+    }
+
+    AP::logger().Write("CANP", "TimeUS,Drv,Cap,Used,Peak,Fail,TErr,CErr", "QBHHHIII",
+                       AP_HAL::micros64(),
+                       _driver_index,
+                       stats.pool.capacity,
+                       stats.pool.used,
+                       stats.pool.peak,
+                       stats.pool.failures,
+                       stats.transfer_errors,
+                       stats.can_errors);
+
+    if (stats.pool.failures > 0 && !_pool_fail_reported) {
+        _pool_fail_reported = true;
+        gcs().send_text(MAV_SEVERITY_WARNING, "UAVCAN%u: memory pool exhausted, raise CAN_D%u_UC_POOL",
+                        unsigned(_driver_index + 1), unsigned(_driver_index + 1));
+    }
+
+    // resize once every node on the bus should have been discovered
+    if (!_pool_auto || _pool_sized || now - _init_ms < 60000) {
+        return;
+    }
+    _pool_sized = true;
+    const uint32_t size = stats.pool.capacity * uint32_t(UAVCAN_NODE_POOL_BLOCK_SIZE);
+    uint32_t new_size;
+    if (stats.pool.failures > 0) {
+        new_size = size * 2;
+    } else {
+        new_size = stats.pool.peak * uint32_t(UAVCAN_NODE_POOL_BLOCK_SIZE) * 2;
+    }
+    new_size = constrain_int32(new_size, UAVCAN_NODE_POOL_SIZE_MIN, UAVCAN_NODE_POOL_SIZE_MAX);
+    // leave it alone unless it is a quarter or more out
+    if (new_size * 4 < size * 3 || new_size * 4 > size * 5) {
+        _pool_size.set_and_save(new_size);
+        gcs().send_text(MAV_SEVERITY_INFO, "UAVCAN%u: pool set to %u bytes after reboot",
+                        unsigned(_driver_index + 1), unsigned(new_size));
+    }
+}
+
+
+void AP_UAVCAN::wait_for_event(uavcan::MonotonicDuration timeout)
+{
+    uavcan::ICanDriver* driver = hal.can_mgr[_driver_index]->get_driver();
+    uavcan::CanSelectMasks masks;
+    masks.read = (1U << driver->getNumIfaces()) - 1U;
+    const uavcan::CanFrame* pending_tx[uavcan::MaxCanIfaces] = {};
+    driver->select(masks, pending_tx, _node->getMonotonicTime() + timeout);
+}
+
 
 ///// SRV output /////
 
@@ -422,10 +516,32 @@ void AP_UAVCAN::SRV_send_actuator(void)
     } while (repeat_send);
 }
 
+/*
+  append the low nbits of value to a UAVCAN bit stream. Values are
+  split into little endian bytes, each written most significant bit
+  first, with the bits of a partial last byte taken from its top
+ */
+static void put_bits(uint8_t *buf, uint16_t &bit_ofs, uint32_t value, uint8_t nbits)
+{
+    for (uint8_t i = 0; i < nbits; i++) {
+        const uint8_t byte_start = i & ~7U;
+        const uint8_t byte_bits = (nbits - byte_start) < 8 ? (nbits - byte_start) : 8;
+        const uint8_t bit = (value >> (byte_start + byte_bits - 1 - (i - byte_start))) & 1U;
+        if (bit) {
+            buf[bit_ofs / 8] |= 0x80U >> (bit_ofs % 8);
+        } else {
+            buf[bit_ofs / 8] &= ~(0x80U >> (bit_ofs % 8));
+        }
+        bit_ofs++;
+    }
+}
+
 void AP_UAVCAN::SRV_send_esc(void)
 {
     static const int cmd_max = uavcan::equipment::esc::RawCommand::FieldTypes::cmd::RawValueType::max();
-    uavcan::equipment::esc::RawCommand esc_msg;
+    static const uint8_t cmd_bits = uavcan::equipment::esc::RawCommand::FieldTypes::cmd::RawValueType::BitLen;
+    uint8_t payload[(20 * cmd_bits + 7) / 8];
+    uint16_t bit_ofs = 0;
 
     uint8_t active_esc_num = 0, max_esc_num = 0;
     uint8_t k = 0;
@@ -453,18 +569,83 @@ void AP_UAVCAN::SRV_send_esc(void)
 
                 scaled = constrain_float(scaled, 0, cmd_max);
 
-                esc_msg.cmd.push_back(static_cast<int>(scaled));
+                put_bits(payload, bit_ofs, static_cast<int>(scaled), cmd_bits);
             } else {
-                esc_msg.cmd.push_back(static_cast<unsigned>(0));
+                put_bits(payload, bit_ofs, 0, cmd_bits);
             }
 
             k++;
         }
 
-        esc_raw[_driver_index]->broadcast(esc_msg);
+        esc_send_raw(payload, (bit_ofs + 7) / 8);
+
+        for (uint8_t i = 0; i < UAVCAN_SRV_NUMBER; i++) {
+            _SRV_conf[i].esc_pending = false;
+        }
     }
 }
 
+/*
+  send a serialised RawCommand straight to the CAN interfaces at the
+  highest transfer priority. This skips the libuavcan publisher, so no
+  transfer buffers are allocated and the frames go ahead of anything
+  libuavcan has queued. Frames not on the bus within
+  UAVCAN_ESC_TX_TIMEOUT_US are dropped by the driver, so a late
+  command never goes out after the one which replaced it
+ */
+void AP_UAVCAN::esc_send_raw(const uint8_t *payload, uint8_t len)
+{
+    typedef uavcan::equipment::esc::RawCommand RawCommand;
+
+    const uint32_t can_id = uavcan::CanFrame::FlagEFF |
+                            (uint32_t(uavcan::TransferPriority::NumericallyMin) << 24) |
+                            (uint32_t(RawCommand::DefaultDataTypeID) << 8) |
+                            _node->getNodeID().get();
+    const uavcan::MonotonicTime deadline = _node->getMonotonicTime() + uavcan::MonotonicDuration::fromUSec(UAVCAN_ESC_TX_TIMEOUT_US);
+    const uint8_t transfer_id = _esc_transfer_id++ & 0x1FU;
+
+    uint8_t crc_bytes[2];
+    uint8_t crc_len = 0;
+    if (len > 7) {
+        // multi-frame transfers start with the transfer CRC
+        uavcan::TransferCRC crc = RawCommand::getDataTypeSignature().toTransferCRC();
+        crc.add(payload, len);
+        crc_bytes[0] = crc.get() & 0xFFU;
+        crc_bytes[1] = crc.get() >> 8;
+        crc_len = 2;
+    }
+
+    uavcan::ICanDriver* driver = hal.can_mgr[_driver_index]->get_driver();
+    const uint8_t num_ifaces = driver->getNumIfaces();
+
+    uint8_t ofs = 0;
+    bool toggle = false;
+    do {
+        uint8_t data[8];
+        uint8_t n = 0;
+        if (ofs == 0) {
+            while (n < crc_len) {
+                data[n] = crc_bytes[n];
+                n++;
+            }
+        }
+        const bool start = (ofs == 0);
+        while (n < 7 && ofs < len) {
+            data[n++] = payload[ofs++];
+        }
+        // tail byte
+        data[n++] = (start ? 0x80U : 0) | (ofs == len ? 0x40U : 0) | (toggle ? 0x20U : 0) | transfer_id;
+        const uavcan::CanFrame frame(can_id, data, n);
+        for (uint8_t i = 0; i < num_ifaces; i++) {
+            uavcan::ICanIface* iface = driver->getIface(i);
+            if (iface != nullptr) {
+                iface->send(frame, deadline, 0);
+            }
+        }
+        toggle = !toggle;
+    } while (ofs < len);
+}
+
 void AP_UAVCAN::SRV_push_servos()
 {
     WITH_SEMAPHORE(SRV_sem);
@@ -479,6 +660,11 @@ void AP_UAVCAN::SRV_push_servos()
     }
 
     _SRV_armed = hal.util->safety_switch_state() != AP_HAL::Util::SAFETY_DISARMED;
+
+    if (_esc_bm > 0) {
+        // have the CAN thread send the ESC command now rather than on its next poll
+        hal.can_mgr[_driver_index]->wake_driver();
+    }
 }
 
 
@@ -19,6 +19,7 @@
 
 #include <uavcan/uavcan.hpp>
 #include "AP_UAVCAN_Server.h"
+#include "AP_UAVCAN_Pool.h"
 
 #include <AP_HAL/CAN.h>
 #include <AP_HAL/Semaphores.h>
@@ -30,14 +31,19 @@
 #define UAVCAN_NODE_POOL_SIZE 8192
 #endif
 
-#ifndef UAVCAN_NODE_POOL_BLOCK_SIZE
-#define UAVCAN_NODE_POOL_BLOCK_SIZE 64
-#endif
+// bounds of the pool size set by POOL_AUTO
+#define UAVCAN_NODE_POOL_SIZE_MIN 2048
+#define UAVCAN_NODE_POOL_SIZE_MAX 65536
 
 #ifndef UAVCAN_SRV_NUMBER
 #define UAVCAN_SRV_NUMBER 18
 #endif
 
+// time an ESC command may wait to go out on the bus before it is stale and dropped
+#ifndef UAVCAN_ESC_TX_TIMEOUT_US
+#define UAVCAN_ESC_TX_TIMEOUT_US 2000
+#endif
+
 #define AP_UAVCAN_SW_VERS_MAJOR 1
 #define AP_UAVCAN_SW_VERS_MINOR 0
 
@@ -93,6 +99,17 @@ public:
     // send RTCMStream packets
     void send_RTCMStream(const uint8_t *data, uint32_t len);
 
+    /*
+      memory pool and transfer statistics, for finding whether the
+      pool is too small for the nodes on the bus
+     */
+    struct Stats {
+        AP_UAVCAN_Pool::Stats pool;
+        uint32_t transfer_errors;   // transfers libuavcan failed to receive or send
+        uint32_t can_errors;        // errors and RX queue overflows of the CAN interfaces
+    };
+    bool get_stats(Stats &stats) const;
+
     template <typename DataType_>
     class RegistryBinder {
     protected:
@@ -151,9 +168,13 @@ private:
 
     void loop(void);
 
+    // block until there is bus activity, the driver is woken or timeout passes
+    void wait_for_event(uavcan::MonotonicDuration timeout);
+
     ///// SRV output /////
     void SRV_send_actuator();
     void SRV_send_esc();
+    void esc_send_raw(const uint8_t *payload, uint8_t len);
 
     ///// LED /////
     void led_out_send();
@@ -167,13 +188,23 @@ private:
     // send GNSS injection
     void rtcm_stream_send();
 
-    uavcan::PoolAllocator<UAVCAN_NODE_POOL_SIZE, UAVCAN_NODE_POOL_BLOCK_SIZE, AP_UAVCAN::RaiiSynchronizer> _node_allocator;
+    // log the pool statistics and resize the pool for the next boot if POOL_AUTO is set
+    void pool_update();
+
+    AP_UAVCAN_Pool _node_allocator;
 
     // UAVCAN parameters
     AP_Int8 _uavcan_node;
     AP_Int32 _servo_bm;
     AP_Int32 _esc_bm;
     AP_Int16 _servo_rate_hz;
+    AP_Int32 _pool_size;
+    AP_Int8 _pool_auto;
+
+    uint32_t _init_ms;
+    uint32_t _pool_log_ms;
+    bool _pool_sized;
+    bool _pool_fail_reported;
 
     uavcan::Node<0> *_node;
 
@@ -190,6 +221,7 @@ private:
     uint8_t _SRV_armed;
     uint32_t _SRV_last_send_us;
     HAL_Semaphore SRV_sem;
+    uint8_t _esc_transfer_id;
 
     ///// LED /////
     struct led_device {
@@ -0,0 +1,77 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_UAVCAN_Pool.h"
+
+#if HAL_WITH_UAVCAN
+
+bool AP_UAVCAN_Pool::init(uint32_t size)
+{
+    if (_blocks != nullptr) {
+        return true;
+    }
+    const uint32_t num_blocks = size / sizeof(Block);
+    if (num_blocks == 0 || num_blocks > UINT16_MAX) {
+        return false;
+    }
+    _blocks = (Block *)calloc(num_blocks, sizeof(Block));
+    if (_blocks == nullptr) {
+        return false;
+    }
+    _num_blocks = num_blocks;
+    for (uint16_t i = 0; i < _num_blocks - 1; i++) {
+        _blocks[i].next = &_blocks[i + 1];
+    }
+    _blocks[_num_blocks - 1].next = nullptr;
+    _free_list = _blocks;
+    return true;
+}
+
+// only called from the thread of the node, so no locking is needed
+void* AP_UAVCAN_Pool::allocate(std::size_t size)
+{
+    if (_free_list == nullptr || size > sizeof(Block)) {
+        _failures++;
+        return nullptr;
+    }
+    Block *b = _free_list;
+    _free_list = b->next;
+    _used++;
+    if (_used > _peak) {
+        _peak = _used;
+    }
+    return b;
+}
+
+void AP_UAVCAN_Pool::deallocate(const void* ptr)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    Block *b = static_cast<Block *>(const_cast<void *>(ptr));
+    b->next = _free_list;
+    _free_list = b;
+    _used--;
+}
+
+void AP_UAVCAN_Pool::get_stats(Stats &stats) const
+{
+    stats.capacity = _num_blocks;
+    stats.used = _used;
+    stats.peak = _peak;
+    stats.failures = _failures;
+}
+
+#endif // HAL_WITH_UAVCAN
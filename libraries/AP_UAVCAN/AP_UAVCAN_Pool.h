@@ -0,0 +1,64 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+
+#if HAL_WITH_UAVCAN
+#include <uavcan/dynamic_memory.hpp>
+
+#ifndef UAVCAN_NODE_POOL_BLOCK_SIZE
+#define UAVCAN_NODE_POOL_BLOCK_SIZE 64
+#endif
+
+/*
+  block pool for a libuavcan node, sized at runtime so it can be set
+  by parameter, which counts the allocations it could not satisfy.
+  libuavcan drops a transfer when it cannot get a block, so the
+  failure count is the only sign the pool is too small
+ */
+class AP_UAVCAN_Pool : public uavcan::IPoolAllocator, uavcan::Noncopyable
+{
+public:
+    // allocate a pool of size bytes. returns false on failure
+    bool init(uint32_t size);
+
+    void* allocate(std::size_t size) override;
+    void deallocate(const void* ptr) override;
+    uint16_t getBlockCapacity() const override { return _num_blocks; }
+
+    struct Stats {
+        uint16_t capacity;      // blocks in the pool
+        uint16_t used;          // blocks in use
+        uint16_t peak;          // highest value of used
+        uint32_t failures;      // allocations that failed
+    };
+    void get_stats(Stats &stats) const;
+
+private:
+    union Block {
+        uint8_t data[UAVCAN_NODE_POOL_BLOCK_SIZE];
+        Block *next;
+    };
+
+    Block *_blocks;
+    Block *_free_list;
+    uint16_t _num_blocks;
+    uint16_t _used;
+    uint16_t _peak;
+    uint32_t _failures;
+};
+
+#endif // HAL_WITH_UAVCAN
@@ -34,6 +34,13 @@ extern const AP_HAL::HAL& hal;
 #define NODEDATA_MAGIC_LEN 2
 #define MAX_NODE_ID    125
 
+// number of nodes asked for their info by each verification round
+#define VERIFY_BATCH_SIZE 4
+// time between verification rounds, long enough for the requests to time out
+#define VERIFY_PERIOD_MS 1500
+// time without a new node on the bus before all nodes are considered to have booted
+#define READY_SETTLE_MS 3000
+
 #define debug_uavcan(fmt, args...) do { hal.console->printf(fmt, ##args); } while (0)
 
 //Callback Object Definitions
@@ -102,17 +109,21 @@ void AP_UAVCAN_Server::getHash(NodeData &node_data, const uint8_t unique_id[], u
     }
 }
 
-//Read Node Data from Storage Region
+//Read Node Data from the copy of the Storage Region
 bool AP_UAVCAN_Server::readNodeData(NodeData &data, uint8_t node_id)
 {
     if (node_id > MAX_NODE_ID) {
         return false;
     }
-    if (!storage.read_block(&data, (node_id * sizeof(struct NodeData)) + NODEDATA_MAGIC_LEN, sizeof(struct NodeData))) {
-        //This will fall through to Prearm Check
-        server_state = STORAGE_FAILURE;
-        return false;
+    if (!node_records_loaded) {
+        if (!storage.read_block(node_records, NODEDATA_MAGIC_LEN, (MAX_NODE_ID + 1) * sizeof(struct NodeData))) {
+            //This will fall through to Prearm Check
+            server_state = STORAGE_FAILURE;
+            return false;
+        }
+        node_records_loaded = true;
     }
+    data = node_records[node_id];
     return true;
 }
 
@@ -127,6 +138,7 @@ bool AP_UAVCAN_Server::writeNodeData(const NodeData &data, uint8_t node_id)
         server_state = STORAGE_FAILURE;
         return false;
     }
+    node_records[node_id] = data;
     return true;
 }
 
@@ -169,6 +181,9 @@ void AP_UAVCAN_Server::setVerificationMask(uint8_t node_id)
     if (node_id > MAX_NODE_ID) {
         return;
     }
+    if (!verified_mask.get(node_id)) {
+        last_verified_ms = AP_HAL::millis();
+    }
     verified_mask.set(node_id);
 }
 
@@ -411,56 +426,105 @@ void AP_UAVCAN_Server::addToSeenNodeMask(uint8_t node_id)
     if (node_id > MAX_NODE_ID) {
         return;
     }
+    if (!node_seen_mask.get(node_id)) {
+        last_new_node_ms = AP_HAL::millis();
+    }
     node_seen_mask.set(node_id);
 }
 
-/* Run through the list of seen node ids for verification no more
-than once per 5 second. We continually verify the nodes in our 
-seen list, So that we can raise issue if there are duplicates
-on the bus. */
+//Check if this is our own node id on any driver
+bool AP_UAVCAN_Server::isSelfNodeID(uint8_t node_id) const
+{
+    for (uint8_t i = 0; i < MAX_NUMBER_OF_CAN_DRIVERS; i++) {
+        if (getNodeInfo_client[i] != nullptr && self_node_id[i] == node_id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Ask for Node Info on every driver, as we don't know which bus the
+node is on. Requests to different nodes run concurrently, but we don't
+ask the same node again until it has replied or the request timed out */
+void AP_UAVCAN_Server::requestNodeInfo(uint8_t node_id)
+{
+    for (uint8_t i = 0; i < MAX_NUMBER_OF_CAN_DRIVERS; i++) {
+        if (getNodeInfo_client[i] != nullptr && !getNodeInfo_client[i]->hasPendingCallToServer(node_id)) {
+            uavcan::protocol::GetNodeInfo::Request request;
+            getNodeInfo_client[i]->call(node_id, request);
+        }
+    }
+}
+
+/* Report once how long after boot all the nodes on the bus were
+verified. Nodes boot at different times, so we wait until no new
+node has appeared for a while before deciding they are all there */
+void AP_UAVCAN_Server::checkAllNodesReady(uint32_t now)
+{
+    if (ready_reported || (now - last_new_node_ms) < READY_SETTLE_MS) {
+        return;
+    }
+    uint8_t num_nodes = 0;
+    for (uint8_t i = 0; i <= MAX_NODE_ID; i++) {
+        if (!isNodeSeen(i) || isSelfNodeID(i)) {
+            continue;
+        }
+        if (!isNodeIDVerified(i)) {
+            return;
+        }
+        num_nodes++;
+    }
+    if (num_nodes == 0) {
+        return;
+    }
+    ready_reported = true;
+    gcs().send_text(MAV_SEVERITY_INFO, "UC: %u nodes ready in %ums", unsigned(num_nodes), unsigned(last_verified_ms));
+}
+
+/* Run through the list of seen node ids for verification, a batch
+of them at a time with their requests running concurrently. We
+continually verify the nodes in our seen list, So that we can raise
+issue if there are duplicates on the bus. */
 void AP_UAVCAN_Server::verify_nodes(AP_UAVCAN *ap_uavcan)
 {
     WITH_SEMAPHORE(sem);
 
     uint32_t now = AP_HAL::millis();
-    if ((now - last_verification_request) < 5000) {
+    checkAllNodesReady(now);
+    if ((now - last_verification_request) < VERIFY_PERIOD_MS) {
         return;
     }
 
-    //Check if we got acknowledgement from previous request
-    //except for requests using our own node_id
-    for (uint8_t i = 0; i < MAX_NUMBER_OF_CAN_DRIVERS; i++) {
-        if (curr_verifying_node == self_node_id[i]) {
-            nodeInfo_resp_rcvd = true;
-        }
-    }
-    if (!nodeInfo_resp_rcvd) {
-        /* Also notify GCS about this
-        Reason for this could be either the node was disconnected
-        Or a node with conflicting ID appeared and is sending response
-        at the same time. */
-        /* Only report if the node was verified, otherwise ignore
-        as this could be just Bootloader to Application transition. */
-        if (isNodeIDVerified(curr_verifying_node)) {
-            // remove verification flag for this node
-            verified_mask.clear(curr_verifying_node);
+    //Check if we got acknowledgement from the previous batch
+    for (uint8_t i = 0; i <= MAX_NODE_ID; i++) {
+        if (verify_requested_mask.get(i) && !verify_resp_mask.get(i)) {
+            /* Reason for this could be either the node was disconnected
+            Or a node with conflicting ID appeared and is sending response
+            at the same time. Only unverify if the node was verified,
+            otherwise ignore as this could be just Bootloader to
+            Application transition. */
+            if (isNodeIDVerified(i)) {
+                // remove verification flag for this node
+                verified_mask.clear(i);
+            }
         }
     }
+    verify_requested_mask.clearall();
+    verify_resp_mask.clearall();
 
     last_verification_request = now;
-    //Find the next registered Node ID to be verified.
-    for (uint8_t i = 0; i <= MAX_NODE_ID; i++) {
+    //Find the next registered Node IDs to be verified.
+    uint8_t num_requested = 0;
+    for (uint8_t i = 0; i <= MAX_NODE_ID && num_requested < VERIFY_BATCH_SIZE; i++) {
         curr_verifying_node = (curr_verifying_node + 1) % (MAX_NODE_ID + 1);
-        if (isNodeSeen(curr_verifying_node)) {
-            break;
-        }
-    }
-    for (uint8_t i = 0; i < MAX_NUMBER_OF_CAN_DRIVERS; i++) {
-        if (getNodeInfo_client[i] != nullptr && isNodeIDOccupied(curr_verifying_node)) {
-            uavcan::protocol::GetNodeInfo::Request request;
-            getNodeInfo_client[i]->call(curr_verifying_node, request);
-            nodeInfo_resp_rcvd = false;
+        if (!isNodeSeen(curr_verifying_node) ||
+            !isNodeIDOccupied(curr_verifying_node) ||
+            isSelfNodeID(curr_verifying_node)) {
+            continue;
         }
+        requestNodeInfo(curr_verifying_node);
+        verify_requested_mask.set(curr_verifying_node);
+        num_requested++;
     }
 }
 
@@ -475,12 +539,7 @@ void AP_UAVCAN_Server::handleNodeStatus(uint8_t node_id, const NodeStatusCb &cb)
     WITH_SEMAPHORE(sem);
     if (!isNodeIDVerified(node_id)) {
         //immediately begin verification of the node_id
-        for (uint8_t i = 0; i < MAX_NUMBER_OF_CAN_DRIVERS; i++) {
-            if (getNodeInfo_client[i] != nullptr) {
-                uavcan::protocol::GetNodeInfo::Request request;
-                getNodeInfo_client[i]->call(node_id, request);
-            }
-        }
+        requestNodeInfo(node_id);
     }
     //Add node to seen list if not seen before
     addToSeenNodeMask(node_id);
@@ -511,9 +570,7 @@ void AP_UAVCAN_Server::handleNodeInfo(uint8_t node_id, uint8_t unique_id[], char
     if (isNodeIDOccupied(node_id)) {
         //if node_id already registered, just verify if Unique ID matches as well
         if (node_id == getNodeIDForUniqueID(unique_id, 16)) {
-            if (node_id == curr_verifying_node) {
-                nodeInfo_resp_rcvd = true;
-            }
+            verify_resp_mask.set(node_id);
             setVerificationMask(node_id);
         } else {
             /* This is a device with node_id already registered
@@ -534,15 +591,17 @@ void AP_UAVCAN_Server::handleNodeInfo(uint8_t node_id, uint8_t unique_id[], char
         addNodeIDForUniqueID(node_id, unique_id, 16);
         //Verify as well
         setVerificationMask(node_id);
-        if (node_id == curr_verifying_node) {
-            nodeInfo_resp_rcvd = true;
-        }
+        verify_resp_mask.set(node_id);
     }
 }
 
 //Trampoline call for handleNodeInfo member call
 void trampoline_handleNodeInfo(const uavcan::ServiceCallResult<uavcan::protocol::GetNodeInfo>& resp)
 {
+    if (!resp.isSuccessful()) {
+        //timed out, which verify_nodes will notice
+        return;
+    }
     uint8_t node_id, unique_id[16] = {0};
     char name[15] = {0};
 
@@ -31,12 +31,24 @@ class AP_UAVCAN_Server
     uint32_t last_verification_request;
     uint8_t curr_verifying_node;
     uint8_t self_node_id[MAX_NUMBER_OF_CAN_DRIVERS];
-    bool nodeInfo_resp_rcvd;
 
     Bitmask<128> occupation_mask;
     Bitmask<128> verified_mask;
     Bitmask<128> node_seen_mask;
 
+    //Nodes asked for their info in the last verification batch, and those that replied
+    Bitmask<128> verify_requested_mask;
+    Bitmask<128> verify_resp_mask;
+
+    //Copy of the Server Record, so lookups don't have to read storage
+    NodeData node_records[128];
+    bool node_records_loaded;
+
+    //Boot to all nodes verified timing
+    uint32_t last_new_node_ms;
+    uint32_t last_verified_ms;
+    bool ready_reported;
+
     //Error State
     enum ServerState server_state;
     uint8_t fault_node_id;
@@ -82,6 +94,15 @@ class AP_UAVCAN_Server
     //Look in the storage and check if there's a valid Server Record there
     bool isValidNodeDataAvailable(uint8_t node_id);
 
+    //Ask a node for its info on every driver, unless a request is already pending
+    void requestNodeInfo(uint8_t node_id);
+
+    //Check if this is our own node id on any driver
+    bool isSelfNodeID(uint8_t node_id) const;
+
+    //Report the time taken for all seen nodes to be verified, once they all are
+    void checkAllNodesReady(uint32_t now);
+
     HAL_Semaphore_Recursive sem;
 
 public:
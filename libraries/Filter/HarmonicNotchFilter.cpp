@@ -63,7 +63,7 @@ const AP_Param::GroupInfo HarmonicNotchFilterParams::var_info[] = {
 
     // @Param: REF
     // @DisplayName: Harmonic Notch Filter reference value
-    // @Description: A reference value of zero disables dynamic updates on the Harmonic Notch Filter and a positive value enables dynamic updates on the Harmonic Notch Filter.  For throttle-based scaling, this parameter is the reference value associated with the specified frequency to facilitate frequency scaling of the Harmonic Notch Filter. For RPM and ESC telemetry based tracking, this parameter is set to 1 to enable the Harmonic Notch Filter using the RPM sensor or ESC telemetry set to measure rotor speed.  The sensor data is converted to Hz automatically for use in the Harmonic Notch Filter.  This reference value may also be used to scale the sensor data, if required.  For example, rpm sensor data is required to measure heli motor RPM. Therefore the reference value can be used to scale the RPM sensor to the rotor RPM.
+    // @Description: A reference value of zero disables dynamic updates on the Harmonic Notch Filter and a positive value enables dynamic updates on the Harmonic Notch Filter.  For throttle-based scaling, this parameter is the reference value associated with the specified frequency to facilitate frequency scaling of the Harmonic Notch Filter. For RPM, ESC telemetry and gyro FFT based tracking, this parameter is set to 1 to enable the Harmonic Notch Filter using the RPM sensor, ESC telemetry or gyro FFT to measure rotor speed.  The sensor data is converted to Hz automatically for use in the Harmonic Notch Filter.  This reference value may also be used to scale the sensor data, if required.  For example, rpm sensor data is required to measure heli motor RPM. Therefore the reference value can be used to scale the RPM sensor to the rotor RPM.
     // @User: Advanced
     // @Range: 0.0 1.0
     // @RebootRequired: True
@@ -71,12 +71,20 @@ const AP_Param::GroupInfo HarmonicNotchFilterParams::var_info[] = {
 
     // @Param: MODE
     // @DisplayName: Harmonic Notch Filter dynamic frequency tracking mode
-    // @Description: Harmonic Notch Filter dynamic frequency tracking mode. Dynamic updates can be throttle, RPM sensor or ESC telemetry based. Throttle-based updates should only be used with multicopters.
-    // @Range: 0 3
-    // @Values: 0:Disabled,1:Throttle,2:RPM Sensor,3:ESC Telemetry
+    // @Description: Harmonic Notch Filter dynamic frequency tracking mode. Dynamic updates can be throttle, RPM sensor, ESC telemetry or gyro FFT based. Throttle-based updates should only be used with multicopters. Gyro FFT based updates need FFT_ENABLE set.
+    // @Range: 0 4
+    // @Values: 0:Disabled,1:Throttle,2:RPM Sensor,3:ESC Telemetry,4:Gyro FFT
     // @User: Advanced
     AP_GROUPINFO("MODE", 7, HarmonicNotchFilterParams, _tracking_mode, 1),
 
+    // @Param: OPTS
+    // @DisplayName: Harmonic Notch Filter options
+    // @Description: Harmonic Notch Filter options. With ESC telemetry tracking, including bidirectional DShot, one notch per motor tracks each motor's own frequency rather than a single notch at the average frequency. This takes effect on the next reboot
+    // @Bitmask: 0:Notch per motor
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("OPTS", 8, HarmonicNotchFilterParams, _options, 0),
+
     AP_GROUPEND
 };
 
@@ -85,7 +93,9 @@ const AP_Param::GroupInfo HarmonicNotchFilterParams::var_info[] = {
  */
 template <class T>
 HarmonicNotchFilter<T>::~HarmonicNotchFilter() {
-    delete[] _filters;
+    delete[] _coeffs;
+    delete[] _sig1;
+    delete[] _sig2;
     _num_filters = 0;
     _num_enabled_filters = 0;
 }
@@ -98,7 +108,7 @@ template <class T>
 void HarmonicNotchFilter<T>::init(float sample_freq_hz, float center_freq_hz, float bandwidth_hz, float attenuation_dB)
 {
     // sanity check the input
-    if (_filters == nullptr || is_zero(sample_freq_hz) || isnan(sample_freq_hz)) {
+    if (_coeffs == nullptr || is_zero(sample_freq_hz) || isnan(sample_freq_hz)) {
         return;
     }
 
@@ -111,37 +121,37 @@ void HarmonicNotchFilter<T>::init(float sample_freq_hz, float center_freq_hz, fl
     // calculate attenuation and quality from the shaping constraints
     NotchFilter<T>::calculate_A_and_Q(center_freq_hz, bandwidth_hz, attenuation_dB, _A, _Q);
 
-    _num_enabled_filters = 0;
     // initialize all the configured filters with the same A & Q and multiples of the center frequency
-    for (uint8_t i = 0, filt = 0; i < HNF_MAX_HARMONICS && filt < _num_filters; i++) {
-        const float notch_center = center_freq_hz * (i+1);
-        if ((1U<<i) & _harmonics) {
-            // only enable the filter if its center frequency is below the nyquist frequency
-            if (notch_center < nyquist_limit) {
-                _filters[filt].init_with_A_and_Q(sample_freq_hz, notch_center, _A, _Q);
-                _num_enabled_filters++;
-            }
-            filt++;
-        }
-    }
+    calculate_coefficients(1, &center_freq_hz);
     _initialised = true;
 }
 
 /*
-  allocate a collection of, at most HNF_MAX_FILTERS, notch filters to be managed by this harmonic notch filter
+  allocate a collection of, at most HNF_MAX_FILTERS, notch filters for
+  each of the composite notches to be managed by this harmonic notch filter
  */
 template <class T>
-void HarmonicNotchFilter<T>::allocate_filters(uint8_t harmonics)
+void HarmonicNotchFilter<T>::allocate_filters(uint8_t harmonics, uint8_t composite_notches)
 {
     for (uint8_t i = 0; i < HNF_MAX_HARMONICS && _num_filters < HNF_MAX_FILTERS; i++) {
         if ((1U<<i) & harmonics) {
             _num_filters++;
         }
     }
+    _composite_notches = constrain_int16(composite_notches, 1, HNF_MAX_COMPOSITE_NOTCHES);
+    _num_filters *= _composite_notches;
     if (_num_filters > 0) {
-        _filters = new NotchFilter<T>[_num_filters];
-        if (_filters == nullptr) {
-            gcs().send_text(MAV_SEVERITY_WARNING, "Failed to allocate %u bytes for HarmonicNotchFilter", (unsigned int)(_num_filters * sizeof(NotchFilter<T>)));
+        _coeffs = new Coefficients[_num_filters];
+        _sig1 = new T[_num_filters+1];
+        _sig2 = new T[_num_filters+1];
+        if (_coeffs == nullptr || _sig1 == nullptr || _sig2 == nullptr) {
+            gcs().send_text(MAV_SEVERITY_WARNING, "Failed to allocate %u bytes for HarmonicNotchFilter",
+                            (unsigned int)(_num_filters * sizeof(Coefficients) + 2 * (_num_filters+1) * sizeof(T)));
+            delete[] _coeffs;
+            delete[] _sig1;
+            delete[] _sig2;
+            _coeffs = nullptr;
+            _sig1 = _sig2 = nullptr;
             _num_filters = 0;
         }
 
@@ -164,18 +174,89 @@ void HarmonicNotchFilter<T>::update(float center_freq_hz)
     const float nyquist_limit = _sample_freq_hz * 0.48f;
     center_freq_hz = constrain_float(center_freq_hz, 1.0f, nyquist_limit);
 
-    _num_enabled_filters = 0;
     // update all of the filters using the new center frequency and existing A & Q
-    for (uint8_t i = 0, filt = 0; i < HNF_MAX_HARMONICS && filt < _num_filters; i++) {
+    calculate_coefficients(1, &center_freq_hz);
+}
+
+/*
+  update the underlying filters' center frequencies with a fundamental
+  for each composite notch, such as one per motor. Composite notches
+  beyond num_centers are left disabled
+ */
+template <class T>
+void HarmonicNotchFilter<T>::update(uint8_t num_centers, const float center_freq_hz[])
+{
+    if (!_initialised) {
+        return;
+    }
+
+    // adjust the fundamental center frequencies to be in the allowable range
+    const float nyquist_limit = _sample_freq_hz * 0.48f;
+    float centers[HNF_MAX_COMPOSITE_NOTCHES];
+    num_centers = MIN(num_centers, _composite_notches);
+    for (uint8_t i = 0; i < num_centers; i++) {
+        centers[i] = constrain_float(center_freq_hz[i], 1.0f, nyquist_limit);
+    }
+
+    calculate_coefficients(num_centers, centers);
+}
+
+/*
+  calculate the coefficients of the harmonics of each fundamental, in
+  cascade order
+ */
+template <class T>
+void HarmonicNotchFilter<T>::calculate_coefficients(uint8_t num_centers, const float center_freq_hz[])
+{
+    _num_enabled_filters = 0;
+    for (uint8_t i = 0; i < num_centers; i++) {
+        add_harmonic_coefficients(center_freq_hz[i]);
+    }
+}
+
+/*
+  add the coefficients of each enabled harmonic of a fundamental to the
+  cascade, using the current attenuation and quality. Only the
+  fundamental needs sin and cos, the
+  higher harmonics are stepped from it with the angle sum identities
+ */
+template <class T>
+void HarmonicNotchFilter<T>::add_harmonic_coefficients(float center_freq_hz)
+{
+    const float nyquist_limit = _sample_freq_hz * 0.48f;
+    const float omega = 2.0f * M_PI * center_freq_hz / _sample_freq_hz;
+    const float cos_omega = cosf(omega);
+    const float sin_omega = sinf(omega);
+    // cos and sin of the current harmonic's center frequency
+    float cos_h = cos_omega;
+    float sin_h = sin_omega;
+
+    const uint8_t harmonic_filters = _num_filters / _composite_notches;
+    for (uint8_t i = 0, filt = 0; i < HNF_MAX_HARMONICS && filt < harmonic_filters; i++) {
         const float notch_center = center_freq_hz * (i+1);
         if ((1U<<i) & _harmonics) {
             // only enable the filter if its center frequency is below the nyquist frequency
             if (notch_center < nyquist_limit) {
-                _filters[filt].init_with_A_and_Q(_sample_freq_hz, notch_center, _A, _Q);
-                _num_enabled_filters++;
+                Coefficients &c = _coeffs[_num_enabled_filters++];
+                if (_Q > 0.0f) {
+                    const float alpha = sin_h / (2 * _Q);
+                    const float a0_inv = 1.0f / (1.0f + alpha);
+                    c.b0 = (1.0f + alpha*sq(_A)) * a0_inv;
+                    c.b1 = -2.0f * cos_h * a0_inv;
+                    c.b2 = (1.0f - alpha*sq(_A)) * a0_inv;
+                    c.a1 = c.b1;
+                    c.a2 = (1.0f - alpha) * a0_inv;
+                } else {
+                    // pass the signal through unchanged
+                    c.b0 = 1.0f;
+                    c.b1 = c.b2 = c.a1 = c.a2 = 0.0f;
+                }
             }
             filt++;
         }
+        const float cos_next = cos_h * cos_omega - sin_h * sin_omega;
+        sin_h = sin_h * cos_omega + cos_h * sin_omega;
+        cos_h = cos_next;
     }
 }
 
@@ -189,11 +270,18 @@ T HarmonicNotchFilter<T>::apply(const T &sample)
         return sample;
     }
 
-    T output = sample;
-    for (uint8_t i = 0; i < _num_enabled_filters; i++) {
-        output = _filters[i].apply(output);
+    T input = sample;
+    uint8_t i = 0;
+    for (; i < _num_enabled_filters; i++) {
+        const Coefficients &c = _coeffs[i];
+        const T output = input*c.b0 + _sig1[i]*c.b1 + _sig2[i]*c.b2 - _sig1[i+1]*c.a1 - _sig2[i+1]*c.a2;
+        _sig2[i] = _sig1[i];
+        _sig1[i] = input;
+        input = output;
     }
-    return output;
+    _sig2[i] = _sig1[i];
+    _sig1[i] = input;
+    return input;
 }
 
 /*
@@ -206,8 +294,8 @@ void HarmonicNotchFilter<T>::reset()
         return;
     }
 
-    for (uint8_t i = 0; i < _num_filters; i++) {
-        _filters[i].reset();
+    for (uint8_t i = 0; i <= _num_filters; i++) {
+        _sig1[i] = _sig2[i] = T();
     }
 }
 
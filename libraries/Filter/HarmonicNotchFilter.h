@@ -19,6 +19,9 @@
 #include <AP_Param/AP_Param.h>
 #include "NotchFilter.h"
 
+// most fundamentals a harmonic notch can track, such as one per motor
+#define HNF_MAX_COMPOSITE_NOTCHES 8
+
 /*
   a filter that manages a set of notch filters targetted at a fundamental center frequency
   and multiples of that fundamental frequency
@@ -27,20 +30,38 @@ template <class T>
 class HarmonicNotchFilter {
 public:
     ~HarmonicNotchFilter();
-    // allocate a bank of notch filters for this harmonic notch filter
-    void allocate_filters(uint8_t harmonics);
+    // allocate a bank of notch filters for this harmonic notch filter,
+    // with a set of harmonics for each of composite_notches fundamentals
+    void allocate_filters(uint8_t harmonics, uint8_t composite_notches = 1);
     // initialize the underlying filters using the provided filter parameters
     void init(float sample_freq_hz, float center_freq_hz, float bandwidth_hz, float attenuation_dB);
     // update the underlying filters' center frequencies using center_freq_hz as the fundamental
     void update(float center_freq_hz);
+    // update the underlying filters' center frequencies with a fundamental for each composite notch
+    void update(uint8_t num_centers, const float center_freq_hz[]);
     // apply a sample to each of the underlying filters in turn
     T apply(const T &sample);
     // reset each of the underlying filters
     void reset();
 
 private:
-    // underlying bank of notch filters
-    NotchFilter<T>*  _filters;
+    // biquad coefficients of one harmonic, pre-scaled by 1/a0
+    struct Coefficients {
+        float b0, b1, b2, a1, a2;
+    };
+
+    // calculate the coefficients of every configured harmonic of each fundamental
+    void calculate_coefficients(uint8_t num_centers, const float center_freq_hz[]);
+    // add the coefficients of the harmonics of one fundamental
+    void add_harmonic_coefficients(float center_freq_hz);
+
+    // coefficients of each harmonic in cascade order
+    Coefficients *_coeffs;
+    // delay lines of the cascade. Entry 0 holds the input history and
+    // entry i+1 the output history of harmonic i, which is also the
+    // input history of harmonic i+1
+    T *_sig1;
+    T *_sig2;
     // sample frequency for each filter
     float _sample_freq_hz;
     // attenuation for each filter
@@ -51,6 +72,8 @@ private:
     uint8_t _harmonics;
     // number of allocated filters
     uint8_t _num_filters;
+    // number of fundamentals, each with its own set of harmonics
+    uint8_t _composite_notches;
     // number of enabled filters
     uint8_t _num_enabled_filters;
     bool _initialised;
@@ -70,6 +93,11 @@ public:
     float reference(void) const { return _reference; }
     // notch dynamic tracking mode
     uint8_t tracking_mode(void) const { return _tracking_mode; }
+    // harmonic notch options
+    enum class Options {
+        DynamicHarmonic = 1<<0,
+    };
+    bool hasOption(Options option) const { return _options & uint16_t(option); }
     static const struct AP_Param::GroupInfo var_info[];
 
 private:
@@ -79,6 +107,8 @@ private:
     AP_Float _reference;
     // notch dynamic tracking mode
     AP_Int8 _tracking_mode;
+    // notch options
+    AP_Int16 _options;
 };
 
 typedef HarmonicNotchFilter<Vector3f> HarmonicNotchFilterVector3f;
@@ -99,6 +99,24 @@ void LowPassFilter2p<T>::reset(void) {
     return _filter.reset();
 }
 
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// LowPassFilter2pFixed
+////////////////////////////////////////////////////////////////////////////////////////////
+
+template <class T>
+LowPassFilter2pFixed<T>::LowPassFilter2pFixed(float sample_freq, float cutoff_freq) {
+    if (is_positive(cutoff_freq) && is_positive(sample_freq)) {
+        DigitalBiquadFilter<T>::compute_params(sample_freq, cutoff_freq, _params);
+        return;
+    }
+    // pass-thru
+    _params.cutoff_freq = cutoff_freq;
+    _params.sample_freq = sample_freq;
+    _params.b0 = 1.0f;
+    _params.b1 = _params.b2 = _params.a1 = _params.a2 = 0.0f;
+}
+
 /* 
  * Make an instances
  * Otherwise we have to move the constructor implementations to the header file :P
@@ -108,3 +126,7 @@ template class LowPassFilter2p<long>;
 template class LowPassFilter2p<float>;
 template class LowPassFilter2p<Vector2f>;
 template class LowPassFilter2p<Vector3f>;
+
+template class LowPassFilter2pFixed<float>;
+template class LowPassFilter2pFixed<Vector2f>;
+template class LowPassFilter2pFixed<Vector3f>;
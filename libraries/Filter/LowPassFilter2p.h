@@ -67,6 +67,41 @@ private:
     DigitalBiquadFilter<T> _filter;
 };
 
+/*
+  a second order low pass filter whose sample rate and cutoff are
+  frozen when it is constructed. The coefficients are computed once,
+  with a zero cutoff folded in as a pass-through, so apply() is inline
+  and has no branches. Use this for filters which run at a high rate
+  and never change frequency.
+ */
+template <class T>
+class LowPassFilter2pFixed {
+public:
+    LowPassFilter2pFixed(float sample_freq, float cutoff_freq);
+
+    float get_cutoff_freq(void) const { return _params.cutoff_freq; }
+    float get_sample_freq(void) const { return _params.sample_freq; }
+
+    T apply(const T &sample) {
+        const T delay_element_0 = sample - _delay_element_1 * _params.a1 - _delay_element_2 * _params.a2;
+        const T output = delay_element_0 * _params.b0 + _delay_element_1 * _params.b1 + _delay_element_2 * _params.b2;
+
+        _delay_element_2 = _delay_element_1;
+        _delay_element_1 = delay_element_0;
+
+        return output;
+    }
+
+    void reset(void) {
+        _delay_element_1 = _delay_element_2 = T();
+    }
+
+private:
+    struct DigitalBiquadFilter<T>::biquad_params _params;
+    T _delay_element_1 = T();
+    T _delay_element_2 = T();
+};
+
 // Uncomment this, if you decide to remove the instantiations in the implementation file
 /*
 template <class T>
@@ -87,3 +122,7 @@ typedef LowPassFilter2p<long>     LowPassFilter2pLong;
 typedef LowPassFilter2p<float>    LowPassFilter2pFloat;
 typedef LowPassFilter2p<Vector2f> LowPassFilter2pVector2f;
 typedef LowPassFilter2p<Vector3f> LowPassFilter2pVector3f;
+
+typedef LowPassFilter2pFixed<float>    LowPassFilter2pFixedFloat;
+typedef LowPassFilter2pFixed<Vector2f> LowPassFilter2pFixedVector2f;
+typedef LowPassFilter2pFixed<Vector3f> LowPassFilter2pFixedVector3f;
@@ -0,0 +1,143 @@
+#include "TargetEstimator.h"
+
+// spectral density of the vehicle's jerk in (m/s^3)^2/Hz. Large
+// enough to follow a plane pulling into a turn
+static const float jerk_noise = 4.0f;
+
+// variance of the reported position in m^2 and velocity in (m/s)^2.
+// The reports come from the vehicle's own navigation filter, so are
+// smooth but not exact
+static const float pos_variance = sq(2.0f);
+static const float vel_variance = sq(0.5f);
+
+// the acceleration estimate is only extrapolated this many seconds
+// ahead, after which the vehicle is assumed to hold its velocity
+static const float accel_horizon = 1.0f;
+
+void TargetEstimator::update(const Vector3f &pos, const Vector3f &vel, uint32_t time_us, uint32_t timeout_us)
+{
+    const uint32_t dt_us = time_us - _last_update_us;
+    if (_initialised && int32_t(dt_us) < 0 && uint32_t(-int32_t(dt_us)) <= timeout_us) {
+        // report from before the last one, which arrived out of order
+        return;
+    }
+    _last_update_us = time_us;
+
+    if (!_initialised || dt_us > timeout_us) {
+        for (uint8_t i=0; i<3; i++) {
+            reset_axis(_axis[i], pos[i], vel[i]);
+        }
+        _initialised = true;
+        return;
+    }
+
+    const float dt = dt_us * 1.0e-6f;
+    for (uint8_t i=0; i<3; i++) {
+        predict_axis(_axis[i], dt);
+        fuse_axis(_axis[i], 0, pos[i], pos_variance);
+        fuse_axis(_axis[i], 1, vel[i], vel_variance);
+    }
+}
+
+Vector3f TargetEstimator::predict(uint32_t time_us) const
+{
+    const float dt = (time_us - _last_update_us) * 1.0e-6f;
+    const float dt_accel = MIN(dt, accel_horizon);
+
+    Vector3f pos;
+    for (uint8_t i=0; i<3; i++) {
+        const float *x = _axis[i].x;
+        // accelerate for up to accel_horizon, then hold the velocity
+        pos[i] = x[0] + x[1] * dt + x[2] * dt_accel * (dt - 0.5f * dt_accel);
+    }
+    return pos;
+}
+
+Vector3f TargetEstimator::predict_velocity(uint32_t time_us) const
+{
+    const float dt_accel = MIN((time_us - _last_update_us) * 1.0e-6f, accel_horizon);
+    return velocity() + acceleration() * dt_accel;
+}
+
+Vector3f TargetEstimator::velocity() const
+{
+    return Vector3f(_axis[0].x[1], _axis[1].x[1], _axis[2].x[1]);
+}
+
+Vector3f TargetEstimator::acceleration() const
+{
+    return Vector3f(_axis[0].x[2], _axis[1].x[2], _axis[2].x[2]);
+}
+
+void TargetEstimator::reset_axis(Axis &axis, float pos, float vel)
+{
+    axis.x[0] = pos;
+    axis.x[1] = vel;
+    axis.x[2] = 0;
+    memset(axis.P, 0, sizeof(axis.P));
+    axis.P[0][0] = pos_variance;
+    axis.P[1][1] = vel_variance;
+    axis.P[2][2] = sq(5.0f);
+}
+
+void TargetEstimator::predict_axis(Axis &axis, float dt)
+{
+    float *x = axis.x;
+    float (&P)[3][3] = axis.P;
+
+    x[0] += x[1] * dt + 0.5f * x[2] * sq(dt);
+    x[1] += x[2] * dt;
+
+    // P = F*P*F' + Q with F = [1 dt dt^2/2; 0 1 dt; 0 0 1]
+    const float h = 0.5f * sq(dt);
+    float FP[3][3];
+    for (uint8_t j=0; j<3; j++) {
+        FP[0][j] = P[0][j] + dt * P[1][j] + h * P[2][j];
+        FP[1][j] = P[1][j] + dt * P[2][j];
+        FP[2][j] = P[2][j];
+    }
+    for (uint8_t i=0; i<3; i++) {
+        P[i][0] = FP[i][0] + dt * FP[i][1] + h * FP[i][2];
+        P[i][1] = FP[i][1] + dt * FP[i][2];
+        P[i][2] = FP[i][2];
+    }
+
+    // white noise jerk
+    const float dt2 = sq(dt);
+    const float dt3 = dt2 * dt;
+    P[0][0] += jerk_noise * dt3 * dt2 / 20;
+    P[0][1] += jerk_noise * dt2 * dt2 / 8;
+    P[0][2] += jerk_noise * dt3 / 6;
+    P[1][1] += jerk_noise * dt3 / 3;
+    P[1][2] += jerk_noise * dt2 / 2;
+    P[2][2] += jerk_noise * dt;
+    P[1][0] = P[0][1];
+    P[2][0] = P[0][2];
+    P[2][1] = P[1][2];
+}
+
+void TargetEstimator::fuse_axis(Axis &axis, uint8_t state, float measurement, float variance)
+{
+    float *x = axis.x;
+    float (&P)[3][3] = axis.P;
+
+    const float innovation_variance = P[state][state] + variance;
+    if (!is_positive(innovation_variance)) {
+        return;
+    }
+    const float innovation = measurement - x[state];
+
+    float K[3];
+    for (uint8_t i=0; i<3; i++) {
+        K[i] = P[i][state] / innovation_variance;
+        x[i] += K[i] * innovation;
+    }
+
+    // P = (I - K*H)*P, using the row of P before the update
+    const float Prow[3] { P[state][0], P[state][1], P[state][2] };
+    for (uint8_t i=0; i<3; i++) {
+        for (uint8_t j=0; j<3; j++) {
+            P[i][j] -= K[i] * Prow[j];
+        }
+    }
+}
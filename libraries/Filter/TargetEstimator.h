@@ -0,0 +1,52 @@
+#pragma once
+
+/*
+  estimate of another vehicle's position, velocity and acceleration
+  from its position reports, so it can be tracked or followed where it
+  is now rather than where it was at the last report.
+
+  Each axis is a separate constant acceleration Kalman filter, with the
+  reported position and velocity fused as independent measurements.
+  Positions are in meters NED from an origin chosen by the caller.
+
+  Reports should be timestamped with the time they were generated in
+  the local time domain, such as from JitterCorrection, rather than
+  their time of arrival, so the prediction covers the link latency and
+  jitter on the link doesn't show up as changes in speed
+ */
+
+#include <AP_Math/AP_Math.h>
+
+class TargetEstimator {
+public:
+    // fuse a position and velocity reported at time_us. The filter is
+    // reset to the report if it has no estimate or the last report was
+    // more than timeout_us before. Reports older than the last one are
+    // ignored
+    void update(const Vector3f &pos, const Vector3f &vel, uint32_t time_us, uint32_t timeout_us);
+
+    // return the position and velocity predicted for time_us
+    Vector3f predict(uint32_t time_us) const;
+    Vector3f predict_velocity(uint32_t time_us) const;
+
+    // return the estimated velocity and acceleration at the last report
+    Vector3f velocity() const;
+    Vector3f acceleration() const;
+
+    // true once a report has been fused
+    bool initialised() const { return _initialised; }
+
+private:
+    // state is position, velocity and acceleration along the axis
+    struct Axis {
+        float x[3];
+        float P[3][3];
+    } _axis[3];
+
+    uint32_t _last_update_us;
+    bool _initialised;
+
+    static void reset_axis(Axis &axis, float pos, float vel);
+    static void predict_axis(Axis &axis, float dt);
+    static void fuse_axis(Axis &axis, uint8_t state, float measurement, float variance);
+};
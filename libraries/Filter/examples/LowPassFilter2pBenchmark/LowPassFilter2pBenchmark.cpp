@@ -0,0 +1,72 @@
+/*
+ *       Example sketch to compare the run time of LowPassFilter2p, which
+ *       can change frequency at any time, with LowPassFilter2pFixed,
+ *       whose coefficients are frozen at construction.
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <Filter/Filter.h>                     // Filter library
+#include <Filter/LowPassFilter2p.h>
+
+void setup();
+void loop();
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define SAMPLE_RATE_HZ  1000
+#define CUTOFF_HZ       20
+#define NUM_SAMPLES     10000
+
+static LowPassFilter2pFloat filter_float(SAMPLE_RATE_HZ, CUTOFF_HZ);
+static LowPassFilter2pFixedFloat fixed_float(SAMPLE_RATE_HZ, CUTOFF_HZ);
+static LowPassFilter2pVector3f filter_vector(SAMPLE_RATE_HZ, CUTOFF_HZ);
+static LowPassFilter2pFixedVector3f fixed_vector(SAMPLE_RATE_HZ, CUTOFF_HZ);
+
+static float input[NUM_SAMPLES];
+
+template <class F, class T>
+static uint32_t run(F &filter, const T &scale, T &result)
+{
+    filter.reset();
+    const uint32_t start_us = AP_HAL::micros();
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+        result = filter.apply(scale * input[i]);
+    }
+    return AP_HAL::micros() - start_us;
+}
+
+void setup()
+{
+    hal.console->printf("ArduPilot LowPassFilter2p benchmark\n\n");
+
+    // 5Hz signal with a 150Hz vibration on top
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+        const float t = i / (float)SAMPLE_RATE_HZ;
+        input[i] = sinf(t * 2 * M_PI * 5) + 0.3f * sinf(t * 2 * M_PI * 150);
+    }
+}
+
+void loop()
+{
+    float out_float = 0, out_fixed = 0;
+    Vector3f out_vector, out_fixed_vector;
+    const Vector3f scale(1.0f, -2.0f, 0.5f);
+
+    const uint32_t float_us = run(filter_float, 1.0f, out_float);
+    const uint32_t fixed_us = run(fixed_float, 1.0f, out_fixed);
+    const uint32_t vector_us = run(filter_vector, scale, out_vector);
+    const uint32_t fixed_vector_us = run(fixed_vector, scale, out_fixed_vector);
+
+    hal.console->printf("%u samples at %uHz, cutoff %uHz\n",
+                        (unsigned)NUM_SAMPLES, (unsigned)SAMPLE_RATE_HZ, (unsigned)CUTOFF_HZ);
+    hal.console->printf("float:    %6u us  fixed %6u us  (last %.6f %.6f)\n",
+                        (unsigned)float_us, (unsigned)fixed_us,
+                        (double)out_float, (double)out_fixed);
+    hal.console->printf("Vector3f: %6u us  fixed %6u us  (diff %.6f)\n\n",
+                        (unsigned)vector_us, (unsigned)fixed_vector_us,
+                        (double)(out_vector - out_fixed_vector).length());
+
+    hal.scheduler->delay(1000);
+}
+
+AP_HAL_MAIN();
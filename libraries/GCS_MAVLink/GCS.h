@@ -51,6 +51,10 @@ public:
 
     // saveable rate of each stream
     AP_Int16        streamRates[GCS_MAVLINK_NUM_STREAM_RATES];
+
+    // target link utilisation in percent for adaptive stream rates,
+    // zero for fixed rates
+    AP_Int8         adaptive_util;
 };
 
 ///
@@ -80,13 +84,23 @@ public:
 
     void send_mission_ack(const mavlink_message_t &msg,
                           MAV_MISSION_TYPE mission_type,
-                          MAV_MISSION_RESULT result) const {
-        mavlink_msg_mission_ack_send(chan,
-                                     msg.sysid,
-                                     msg.compid,
-                                     result,
-                                     mission_type);
-    }
+                          MAV_MISSION_RESULT result) const;
+    void send_command_ack(uint16_t command, MAV_RESULT result) const;
+
+    // classes of reply to the GCS. Replies are sent ahead of any
+    // stream message, and their latency is logged per class
+    enum class ReplyClass : uint8_t {
+        ACK = 0,    // COMMAND_ACK and MISSION_ACK
+        PARAM = 1,  // PARAM_VALUE for a changed parameter
+        TEXT = 2,   // STATUSTEXT
+    };
+    static const uint8_t num_reply_classes = 3;
+
+    // send a reply now if there is room, otherwise queue it to be
+    // sent as soon as there is
+    void send_reply(ReplyClass reply_class, uint32_t msgid, const char *pkt) const;
+    // record the time a reply spent queued
+    void record_reply_latency(ReplyClass reply_class, uint32_t queued_ms) const;
 
     static const MAV_MISSION_TYPE supported_mission_types[3];
 
@@ -153,7 +167,7 @@ public:
         return GCS_MAVLINK::active_channel_mask() & (1 << (chan-MAVLINK_COMM_0));
     }
     bool is_streaming() const {
-        return sending_bucket_id != no_bucket_to_send;
+        return stream_heap_count != 0;
     }
 
     mavlink_channel_t get_chan() const { return chan; }
@@ -179,6 +193,7 @@ public:
     // found.  Rover overrides this!
     virtual void send_rangefinder() const;
     void send_proximity() const;
+    void send_obstacle_distance();
     virtual void send_nav_controller_output() const = 0;
     virtual void send_pid_tuning() = 0;
     void send_ahrs2();
@@ -203,6 +218,8 @@ public:
     void send_local_position() const;
     void send_vfr_hud();
     void send_vibration() const;
+    void send_sched_task_histogram();
+    void send_stream_rate_stats();
     void send_mount_status() const;
     void send_named_float(const char *name, float value) const;
     void send_gimbal_report() const;
@@ -306,6 +323,7 @@ protected:
 
     // saveable rate of each stream
     AP_Int16        *streamRates;
+    AP_Int8         *adaptive_util;
 
     virtual bool persist_streamrates() const { return false; }
     void handle_request_data_stream(const mavlink_message_t &msg);
@@ -381,8 +399,22 @@ protected:
         int64_t sent_ts1;
         uint32_t last_sent_ms;
         const uint16_t interval_ms = 10000;
+        // faster while offboard timestamps are being corrected, to
+        // keep the clock offset below up to date
+        const uint16_t offboard_interval_ms = 1000;
     }  _timesync_request;
 
+    // clock offset of the source of offboard timestamps, learned from
+    // its responses to our TIMESYNC requests. It is taken from the
+    // response with the shortest round trip, as the error in it is at
+    // most half the round trip
+    void update_timesync_offset(uint64_t remote_ns, uint64_t local_ns, uint32_t round_trip_time_us);
+    struct {
+        int64_t offset_us;      // remote time minus local time
+        uint32_t rtt_us;        // round trip time of the response the offset came from
+        uint32_t updated_ms;    // time the offset was last updated, zero if never
+    } _timesync_offset;
+
     void handle_statustext(const mavlink_message_t &msg);
 
     bool telemetry_delayed() const;
@@ -491,6 +523,52 @@ private:
     // number of extra ms to add to slow things down for the radio
     uint16_t         stream_slowdown_ms;
 
+    // OBSTACLE_DISTANCE distances last sent, allocated on the first
+    // send so only links which ask for the message pay for it
+    struct {
+        uint16_t *distances_cm;
+        uint32_t last_sent_ms;
+    } obstacle_distance;
+
+    // replies waiting for room on the link
+    struct queued_reply_t {
+        uint32_t queued_ms;
+        uint32_t msgid;
+        ReplyClass reply_class;
+        char pkt[MAVLINK_MSG_ID_PARAM_VALUE_LEN];
+    };
+    mutable HAL_Semaphore reply_sem;
+    mutable ObjectBuffer<queued_reply_t> reply_queue{6};
+    // send queued replies, returning false if any are still waiting
+    bool send_queued_replies();
+    mutable struct {
+        uint16_t max_latency_ms;
+    } reply_stats[num_reply_classes];
+    mutable uint32_t reply_drop_count;
+
+    // adaptive stream rates. The link's usable throughput is
+    // estimated from how fast the UART drains and from RADIO_STATUS,
+    // and stream intervals are stretched by scale to keep the bytes
+    // sent near the target utilisation of it
+    struct {
+        uint32_t last_update_ms;
+        uint32_t last_tx_bytes;
+        uint16_t last_queued;
+        uint16_t txspace_max;
+        uint32_t radio_status_ms;
+        uint8_t radio_txbuf;
+        float capacity; // bytes/s
+        float scale;
+    } adaptive;
+    void update_adaptive_rate();
+    // streams are thinned in priority order: low first, high last
+    enum class StreamPriority : uint8_t {
+        High,
+        Medium,
+        Low,
+    };
+    static StreamPriority stream_priority(ap_message id);
+
     // perf counters
     AP_HAL::Util::perf_counter_t _perf_packet;
     AP_HAL::Util::perf_counter_t _perf_update;
@@ -519,20 +597,41 @@ private:
     // cache of which deferred message should be sent next:
     int8_t next_deferred_message_to_send_cache = -1;
 
-    struct deferred_message_bucket_t {
-        Bitmask<MSG_LAST> ap_message_ids;
+    // stream-rated messages, kept in a binary min-heap ordered by the
+    // time each is next due, so the next message to send is always
+    // stream_heap[0] and rescheduling it is O(log n)
+    struct stream_entry_t {
+        ap_message id;
+        // sends more than one interval late since the interval was set
+        uint8_t late_count;
         uint16_t interval_ms;
-        uint16_t last_sent_ms; // from AP_HAL::millis16()
+        // sends in the current and the last rate period
+        uint16_t sent_count;
+        uint16_t last_sent_count;
+        uint32_t next_due_ms;
     };
-    deferred_message_bucket_t deferred_message_bucket[10];
-    static const uint8_t no_bucket_to_send = -1;
+    stream_entry_t stream_heap[MSG_LAST];
+    uint8_t stream_heap_count;
+    // one more than the index of each ap_message in stream_heap, or
+    // zero if it is not being streamed
+    uint8_t stream_heap_index[MSG_LAST];
     static const ap_message no_message_to_send = (ap_message)-1;
-    uint8_t sending_bucket_id = no_bucket_to_send;
-    Bitmask<MSG_LAST> bucket_message_ids_to_send;
 
-    ap_message next_deferred_bucket_message_to_send();
-    void find_next_bucket_to_send();
-    void remove_message_from_bucket(int8_t bucket, ap_message id);
+    ap_message next_deferred_stream_message_to_send();
+    void reschedule_first_stream_message();
+    void stream_heap_remove(ap_message id);
+    void stream_heap_set(uint8_t i, const stream_entry_t &entry);
+    void stream_heap_sift_up(uint8_t i);
+    void stream_heap_sift_down(uint8_t i);
+    void stream_heap_update(uint8_t i);
+
+    // start and length of the current and last period over which
+    // achieved stream rates are measured
+    uint32_t stream_rate_period_start_ms;
+    uint32_t stream_rate_last_period_ms;
+    void update_stream_rates();
+    // next ap_message to send a STREAM_RATE_STATS for
+    uint8_t stream_rate_stats_id;
 
     // bitmask of IDs the code has spontaneously decided it wants to
     // send out.  Examples include HEARTBEAT (gcs_send_heartbeat)
@@ -558,6 +657,9 @@ private:
     // try_send_message, will cause a mavlink message with that id to
     // be emitted.  Returns MSG_LAST if no such mapping exists.
     ap_message mavlink_id_to_ap_message_id(const uint32_t mavlink_id) const;
+    // the reverse of mavlink_id_to_ap_message_id.  Returns UINT32_MAX
+    // if no such mapping exists.
+    uint32_t ap_message_id_to_mavlink_id(const ap_message id) const;
     // set the interval at which an ap_message should be emitted (in ms)
     bool set_ap_message_interval(enum ap_message id, uint16_t interval_ms);
     // call set_ap_message_interval for each entry in a stream,
@@ -568,10 +670,11 @@ private:
     // boolean that indicated that message intervals have been set
     // from streamrates:
     bool deferred_messages_initialised;
-    // return interval deferred message bucket should be sent after.
-    // When sending parameters and waypoints this may be longer than
-    // the interval specified in "deferred"
-    uint16_t get_reschedule_interval_ms(const deferred_message_bucket_t &deferred) const;
+    // return interval a stream message should be sent after.  When
+    // sending parameters and waypoints, or when adaptive rates are
+    // thinning streams, this may be longer than the interval it was
+    // given
+    uint16_t get_reschedule_interval_ms(ap_message id, uint16_t interval_ms) const;
 
     bool do_try_send_message(const ap_message id);
 
@@ -617,6 +720,12 @@ private:
 
     uint8_t send_parameter_async_replies();
 
+    // packed parameter file, see GCS_Param.cpp
+    static uint32_t param_pack(uint8_t *buf, uint32_t size);
+    static bool param_unpack(const uint8_t *buf, uint32_t len, bool apply,
+                             uint16_t &num_set, uint16_t &num_failed);
+    static bool param_set_packed(const char *name, float value);
+
 #if HAVE_FILESYSTEM_SUPPORT
 
     enum class FTP_OP : uint8_t {
@@ -671,6 +780,14 @@ private:
     enum class FTP_FILE_MODE {
         Read,
         Write,
+        VirtualRead,
+        VirtualWrite,
+    };
+
+    // files generated on the vehicle rather than held in AP_Filesystem
+    enum class FTP_VIRTUAL_FILE {
+        Param,
+        Mission,
     };
 
     struct ftp_state {
@@ -681,12 +798,23 @@ private:
         int fd = -1;
         FTP_FILE_MODE mode; // work around AP_Filesystem not supporting file modes
         int16_t current_session;
+
+        // contents of the virtual file while it is open
+        FTP_VIRTUAL_FILE virtual_file;
+        uint8_t *virtual_data;
+        uint32_t virtual_len;
+        uint32_t virtual_size;
     };
     static struct ftp_state ftp;
 
     static void ftp_error(struct pending_ftp &response, FTP_ERROR error); // FTP helper method for packing a NAK
     static int gen_dir_entry(char *dest, size_t space, const char * path, const struct dirent * entry); // FTP helper for emitting a dir response
     static void ftp_list_dir(struct pending_ftp &request, struct pending_ftp &response);
+    static ssize_t ftp_read(uint8_t *buf, size_t count, uint32_t offset);
+    static ssize_t ftp_write(const uint8_t *buf, size_t count, uint32_t offset);
+    static void ftp_close(void);
+    static bool ftp_virtual_open(struct pending_ftp &request, struct pending_ftp &response, FTP_FILE_MODE mode);
+    static void ftp_virtual_close(void);
 
     bool ftp_init(void);
     void handle_file_transfer_protocol(const mavlink_message_t &msg);
@@ -740,6 +868,7 @@ private:
     void load_signing_key(void);
     bool signing_enabled(void) const;
     static void save_signing_timestamp(bool force_save_now);
+    static void get_signing_hash_stats(uint32_t &count, uint32_t &time_us);
 
     // alternative protocol handler support
     struct {
@@ -750,6 +879,17 @@ private:
     } alternative;
 
     JitterCorrection lag_correction;
+
+    // latency from the time offboard samples were taken to the time
+    // they were received, after correction, and the jitter in it
+    struct {
+        float lag_ms;           // filtered lag
+        float jitter_ms;        // filtered absolute deviation of lag from lag_ms
+        uint32_t last_ms;       // time of the last sample, zero if none
+        bool timesync;          // true if the last sample was corrected with the TIMESYNC offset
+        uint8_t sysid;          // source of the samples, whose TIMESYNC responses are used
+        uint8_t compid;
+    } offboard_lag;
     
     // we cache the current location and send it even if the AHRS has
     // no idea where we are:
@@ -758,6 +898,9 @@ private:
     void zero_rc_outputs();
 
     uint8_t last_tx_seq;
+
+    // next scheduler task to send a SCHED_TASK_HISTOGRAM for
+    uint8_t sched_histogram_task;
     uint16_t send_packet_count;
 
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
@@ -768,7 +911,7 @@ private:
         uint16_t statustext_last_sent_ms;
         uint32_t behind;
         uint32_t out_of_time;
-        uint16_t fnbts_maxtime;
+        uint16_t reschedule_maxtime;
         uint32_t max_retry_deferred_body_us;
         uint8_t max_retry_deferred_body_type;
     } try_send_message_stats;
@@ -896,6 +1039,7 @@ private:
                                     AP_HAL::UARTDriver &uart);
 
     struct statustext_t {
+        uint32_t                queued_ms;
         uint8_t                 bitmask;
         mavlink_statustext_t    msg;
     };
@@ -25,6 +25,7 @@
 #include <AP_OpticalFlow/AP_OpticalFlow.h>
 #include <AP_Vehicle/AP_Vehicle.h>
 #include <AP_RangeFinder/RangeFinder_Backend.h>
+#include <AP_Proximity/AP_Proximity_Grid.h>
 #include <AP_Airspeed/AP_Airspeed.h>
 #include <AP_Camera/AP_Camera.h>
 #include <AP_Gripper/AP_Gripper.h>
@@ -38,6 +39,9 @@
 #include <AP_VisualOdom/AP_VisualOdom.h>
 #include <AP_OpticalFlow/OpticalFlow.h>
 #include <AP_Baro/AP_Baro.h>
+#ifdef ENABLE_SCRIPTING
+#include <AP_Scripting/AP_Scripting.h>
+#endif
 
 #include <stdio.h>
 
@@ -83,6 +87,7 @@ GCS_MAVLINK::GCS_MAVLINK(GCS_MAVLINK_Parameters &parameters,
     _port = &uart;
 
     streamRates = parameters.streamRates;
+    adaptive_util = &parameters.adaptive_util;
 }
 
 bool GCS_MAVLINK::init(uint8_t instance)
@@ -384,6 +389,72 @@ void GCS_MAVLINK::send_proximity() const
     }
 }
 
+/*
+  send the horizontal distances of the primary proximity sensor as a
+  single OBSTACLE_DISTANCE, one element per grid sector, for companion
+  computers. This is a fraction of the bytes of the DISTANCE_SENSOR
+  messages for the same data. When nothing has moved by more than
+  OBSTACLE_DISTANCE_CHANGE_CM it is only resent every
+  OBSTACLE_DISTANCE_KEEPALIVE_MS, so it can be streamed at a high rate
+  for low latency without using the link when nothing is changing
+ */
+#define OBSTACLE_DISTANCE_CHANGE_CM     5
+#define OBSTACLE_DISTANCE_KEEPALIVE_MS  250
+
+void GCS_MAVLINK::send_obstacle_distance()
+{
+    static_assert(PROXIMITY_GRID_SECTORS <= MAVLINK_MSG_OBSTACLE_DISTANCE_FIELD_DISTANCES_LEN, "grid sectors must fit in OBSTACLE_DISTANCE");
+
+    const AP_Proximity *proximity = AP_Proximity::get_singleton();
+    if (proximity == nullptr || proximity->get_status() != AP_Proximity::Status::Good) {
+        return;
+    }
+
+    mavlink_obstacle_distance_t packet {};
+    packet.min_distance = proximity->distance_min() * 100.0f;
+    packet.max_distance = proximity->distance_max() * 100.0f;
+    // the packet's distances may not be aligned, so fill a local array
+    uint16_t distances[PROXIMITY_GRID_SECTORS];
+    if (!proximity->get_grid_distances(distances, packet.max_distance + 1)) {
+        return;
+    }
+    memcpy(packet.distances, distances, sizeof(distances));
+    for (uint8_t i = PROXIMITY_GRID_SECTORS; i < MAVLINK_MSG_OBSTACLE_DISTANCE_FIELD_DISTANCES_LEN; i++) {
+        packet.distances[i] = UINT16_MAX;
+    }
+
+    const uint32_t now_ms = AP_HAL::millis();
+    if (obstacle_distance.distances_cm == nullptr) {
+        obstacle_distance.distances_cm = new uint16_t[PROXIMITY_GRID_SECTORS];
+    } else if (now_ms - obstacle_distance.last_sent_ms < OBSTACLE_DISTANCE_KEEPALIVE_MS) {
+        bool changed = false;
+        for (uint8_t i = 0; i < PROXIMITY_GRID_SECTORS; i++) {
+            const uint16_t last_cm = obstacle_distance.distances_cm[i];
+            const uint16_t diff_cm = packet.distances[i] > last_cm ? packet.distances[i] - last_cm : last_cm - packet.distances[i];
+            if (diff_cm > OBSTACLE_DISTANCE_CHANGE_CM) {
+                changed = true;
+                break;
+            }
+        }
+        if (!changed) {
+            return;
+        }
+    }
+
+    packet.time_usec = AP_HAL::micros64();
+    packet.sensor_type = MAV_DISTANCE_SENSOR_LASER;
+    packet.increment = PROXIMITY_GRID_SECTOR_WIDTH_DEG;
+    packet.increment_f = PROXIMITY_GRID_SECTOR_WIDTH_DEG;
+    packet.angle_offset = 0;
+    packet.frame = MAV_FRAME_BODY_FRD;
+    mavlink_msg_obstacle_distance_send_struct(chan, &packet);
+
+    obstacle_distance.last_sent_ms = now_ms;
+    if (obstacle_distance.distances_cm != nullptr) {
+        memcpy(obstacle_distance.distances_cm, packet.distances, PROXIMITY_GRID_SECTORS * sizeof(uint16_t));
+    }
+}
+
 // report AHRS2 state
 void GCS_MAVLINK::send_ahrs2()
 {
@@ -449,11 +520,7 @@ void GCS_MAVLINK::handle_mission_request_list(const mavlink_message_t &msg)
 
     MissionItemProtocol *prot = gcs().get_prot_for_mission_type((MAV_MISSION_TYPE)packet.mission_type);
     if (prot == nullptr) {
-        mavlink_msg_mission_ack_send(chan,
-                                     msg.sysid,
-                                     msg.compid,
-                                     MAV_MISSION_UNSUPPORTED,
-                                     packet.mission_type);
+        send_mission_ack(msg, (MAV_MISSION_TYPE)packet.mission_type, MAV_MISSION_UNSUPPORTED);
         return;
     }
 
@@ -515,11 +582,7 @@ void GCS_MAVLINK::handle_mission_count(const mavlink_message_t &msg)
 
     MissionItemProtocol *prot = gcs().get_prot_for_mission_type((MAV_MISSION_TYPE)packet.mission_type);
     if (prot == nullptr) {
-        mavlink_msg_mission_ack_send(chan,
-                                     msg.sysid,
-                                     msg.compid,
-                                     MAV_MISSION_UNSUPPORTED,
-                                     packet.mission_type);
+        send_mission_ack(msg, (MAV_MISSION_TYPE)packet.mission_type, MAV_MISSION_UNSUPPORTED);
         return;
     }
 
@@ -604,6 +667,92 @@ void GCS_MAVLINK::send_text(MAV_SEVERITY severity, const char *fmt, ...) const
     gcs().send_statustext(severity, (1<<chan), text);
 }
 
+static_assert(MAVLINK_MSG_ID_COMMAND_ACK_LEN <= MAVLINK_MSG_ID_PARAM_VALUE_LEN &&
+              MAVLINK_MSG_ID_MISSION_ACK_LEN <= MAVLINK_MSG_ID_PARAM_VALUE_LEN,
+              "queued replies must fit in queued_reply_t");
+
+/*
+  send a reply to the GCS. If there is no room, or earlier replies are
+  still waiting, it is queued and sent by update_send() before any
+  stream message. When the queue is full the oldest reply is dropped
+ */
+void GCS_MAVLINK::send_reply(const ReplyClass reply_class, const uint32_t msgid, const char *pkt) const
+{
+    const mavlink_msg_entry_t *entry = mavlink_get_msg_entry(msgid);
+    if (entry == nullptr) {
+        return;
+    }
+
+    WITH_SEMAPHORE(reply_sem);
+
+    if (reply_queue.empty() &&
+        comm_get_txspace(chan) >= packet_overhead() + entry->max_msg_len) {
+        send_message(pkt, entry);
+        record_reply_latency(reply_class, AP_HAL::millis());
+        return;
+    }
+
+    queued_reply_t reply {};
+    reply.queued_ms = AP_HAL::millis();
+    reply.msgid = msgid;
+    reply.reply_class = reply_class;
+    memcpy(reply.pkt, pkt, MIN(entry->max_msg_len, sizeof(reply.pkt)));
+    if (reply_queue.space() == 0) {
+        reply_drop_count++;
+    }
+    reply_queue.push_force(reply);
+}
+
+/*
+  send queued replies while there is room. Returns false if any are
+  still waiting
+ */
+bool GCS_MAVLINK::send_queued_replies()
+{
+    WITH_SEMAPHORE(reply_sem);
+
+    queued_reply_t reply;
+    while (reply_queue.peek(reply)) {
+        const mavlink_msg_entry_t *entry = mavlink_get_msg_entry(reply.msgid);
+        if (entry != nullptr) {
+            if (comm_get_txspace(chan) < packet_overhead() + entry->max_msg_len) {
+                return false;
+            }
+            send_message(reply.pkt, entry);
+            record_reply_latency(reply.reply_class, reply.queued_ms);
+        }
+        reply_queue.pop();
+    }
+    return true;
+}
+
+void GCS_MAVLINK::record_reply_latency(const ReplyClass reply_class, const uint32_t queued_ms) const
+{
+    const uint32_t latency_ms = AP_HAL::millis() - queued_ms;
+    uint16_t &max_latency_ms = reply_stats[uint8_t(reply_class)].max_latency_ms;
+    max_latency_ms = MAX(max_latency_ms, MIN(latency_ms, uint32_t(UINT16_MAX)));
+}
+
+void GCS_MAVLINK::send_command_ack(const uint16_t command, const MAV_RESULT result) const
+{
+    mavlink_command_ack_t packet {};
+    packet.command = command;
+    packet.result = result;
+    send_reply(ReplyClass::ACK, MAVLINK_MSG_ID_COMMAND_ACK, (const char *)&packet);
+}
+
+void GCS_MAVLINK::send_mission_ack(const mavlink_message_t &msg,
+                                   const MAV_MISSION_TYPE mission_type,
+                                   const MAV_MISSION_RESULT result) const
+{
+    mavlink_mission_ack_t packet {};
+    packet.target_system = msg.sysid;
+    packet.target_component = msg.compid;
+    packet.type = result;
+    packet.mission_type = mission_type;
+    send_reply(ReplyClass::ACK, MAVLINK_MSG_ID_MISSION_ACK, (const char *)&packet);
+}
+
 void GCS_MAVLINK::handle_radio_status(const mavlink_message_t &msg, bool log_radio)
 {
     mavlink_radio_t packet;
@@ -632,6 +781,9 @@ void GCS_MAVLINK::handle_radio_status(const mavlink_message_t &msg, bool log_rad
         stream_slowdown_ms -= 20;
     }
 
+    adaptive.radio_status_ms = AP_HAL::millis();
+    adaptive.radio_txbuf = packet.txbuf;
+
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
     if (stream_slowdown_ms > max_slowdown_ms) {
         max_slowdown_ms = stream_slowdown_ms;
@@ -708,91 +860,104 @@ void GCS_MAVLINK::handle_mission_item(const mavlink_message_t &msg)
     prot->handle_mission_item(msg, packet);
 }
 
+// MSG_NEXT_MISSION_REQUEST doesn't correspond to a mavlink message directly.
+// It is used to request the next waypoint after receiving one.
+
+// MSG_NEXT_PARAM doesn't correspond to a mavlink message directly.
+// It is used to send the next parameter in a stream after sending one
+
+// MSG_NAMED_FLOAT messages can't really be "streamed"...
+
+static const struct {
+    uint32_t mavlink_id;
+    ap_message msg_id;
+} ap_message_map[] {
+    { MAVLINK_MSG_ID_HEARTBEAT,             MSG_HEARTBEAT},
+    { MAVLINK_MSG_ID_ATTITUDE,              MSG_ATTITUDE},
+    { MAVLINK_MSG_ID_GLOBAL_POSITION_INT,   MSG_LOCATION},
+    { MAVLINK_MSG_ID_HOME_POSITION,         MSG_HOME},
+    { MAVLINK_MSG_ID_GPS_GLOBAL_ORIGIN,     MSG_ORIGIN},
+    { MAVLINK_MSG_ID_SYS_STATUS,            MSG_SYS_STATUS},
+    { MAVLINK_MSG_ID_POWER_STATUS,          MSG_POWER_STATUS},
+    { MAVLINK_MSG_ID_MEMINFO,               MSG_MEMINFO},
+    { MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT, MSG_NAV_CONTROLLER_OUTPUT},
+    { MAVLINK_MSG_ID_MISSION_CURRENT,       MSG_CURRENT_WAYPOINT},
+    { MAVLINK_MSG_ID_VFR_HUD,               MSG_VFR_HUD},
+    { MAVLINK_MSG_ID_SERVO_OUTPUT_RAW,      MSG_SERVO_OUTPUT_RAW},
+    { MAVLINK_MSG_ID_RC_CHANNELS,           MSG_RC_CHANNELS},
+    { MAVLINK_MSG_ID_RC_CHANNELS_RAW,       MSG_RC_CHANNELS_RAW},
+    { MAVLINK_MSG_ID_RAW_IMU,               MSG_RAW_IMU},
+    { MAVLINK_MSG_ID_SCALED_IMU,            MSG_SCALED_IMU},
+    { MAVLINK_MSG_ID_SCALED_IMU2,           MSG_SCALED_IMU2},
+    { MAVLINK_MSG_ID_SCALED_IMU3,           MSG_SCALED_IMU3},
+    { MAVLINK_MSG_ID_SCALED_PRESSURE,       MSG_SCALED_PRESSURE},
+    { MAVLINK_MSG_ID_SCALED_PRESSURE2,      MSG_SCALED_PRESSURE2},
+    { MAVLINK_MSG_ID_SCALED_PRESSURE3,      MSG_SCALED_PRESSURE3},
+    { MAVLINK_MSG_ID_SENSOR_OFFSETS,        MSG_SENSOR_OFFSETS},
+    { MAVLINK_MSG_ID_GPS_RAW_INT,           MSG_GPS_RAW},
+    { MAVLINK_MSG_ID_GPS_RTK,               MSG_GPS_RTK},
+    { MAVLINK_MSG_ID_GPS2_RAW,              MSG_GPS2_RAW},
+    { MAVLINK_MSG_ID_GPS2_RTK,              MSG_GPS2_RTK},
+    { MAVLINK_MSG_ID_SYSTEM_TIME,           MSG_SYSTEM_TIME},
+    { MAVLINK_MSG_ID_RC_CHANNELS_SCALED,    MSG_SERVO_OUT},
+    { MAVLINK_MSG_ID_PARAM_VALUE,           MSG_NEXT_PARAM},
+    { MAVLINK_MSG_ID_FENCE_STATUS,          MSG_FENCE_STATUS},
+    { MAVLINK_MSG_ID_AHRS,                  MSG_AHRS},
+    { MAVLINK_MSG_ID_SIMSTATE,              MSG_SIMSTATE},
+    { MAVLINK_MSG_ID_AHRS2,                 MSG_AHRS2},
+    { MAVLINK_MSG_ID_AHRS3,                 MSG_AHRS3},
+    { MAVLINK_MSG_ID_HWSTATUS,              MSG_HWSTATUS},
+    { MAVLINK_MSG_ID_WIND,                  MSG_WIND},
+    { MAVLINK_MSG_ID_RANGEFINDER,           MSG_RANGEFINDER},
+    { MAVLINK_MSG_ID_DISTANCE_SENSOR,       MSG_DISTANCE_SENSOR},
+            // request also does report:
+    { MAVLINK_MSG_ID_TERRAIN_REQUEST,       MSG_TERRAIN},
+    { MAVLINK_MSG_ID_BATTERY2,              MSG_BATTERY2},
+    { MAVLINK_MSG_ID_CAMERA_FEEDBACK,       MSG_CAMERA_FEEDBACK},
+    { MAVLINK_MSG_ID_MOUNT_STATUS,          MSG_MOUNT_STATUS},
+    { MAVLINK_MSG_ID_OPTICAL_FLOW,          MSG_OPTICAL_FLOW},
+    { MAVLINK_MSG_ID_GIMBAL_REPORT,         MSG_GIMBAL_REPORT},
+    { MAVLINK_MSG_ID_MAG_CAL_PROGRESS,      MSG_MAG_CAL_PROGRESS},
+    { MAVLINK_MSG_ID_MAG_CAL_REPORT,        MSG_MAG_CAL_REPORT},
+    { MAVLINK_MSG_ID_EKF_STATUS_REPORT,     MSG_EKF_STATUS_REPORT},
+    { MAVLINK_MSG_ID_LOCAL_POSITION_NED,    MSG_LOCAL_POSITION},
+    { MAVLINK_MSG_ID_PID_TUNING,            MSG_PID_TUNING},
+    { MAVLINK_MSG_ID_VIBRATION,             MSG_VIBRATION},
+    { MAVLINK_MSG_ID_RPM,                   MSG_RPM},
+    { MAVLINK_MSG_ID_MISSION_ITEM_REACHED,  MSG_MISSION_ITEM_REACHED},
+    { MAVLINK_MSG_ID_POSITION_TARGET_GLOBAL_INT,  MSG_POSITION_TARGET_GLOBAL_INT},
+    { MAVLINK_MSG_ID_POSITION_TARGET_LOCAL_NED,  MSG_POSITION_TARGET_LOCAL_NED},
+    { MAVLINK_MSG_ID_ADSB_VEHICLE,          MSG_ADSB_VEHICLE},
+    { MAVLINK_MSG_ID_BATTERY_STATUS,        MSG_BATTERY_STATUS},
+    { MAVLINK_MSG_ID_AOA_SSA,               MSG_AOA_SSA},
+    { MAVLINK_MSG_ID_DEEPSTALL,             MSG_LANDING},
+    { MAVLINK_MSG_ID_EXTENDED_SYS_STATE,    MSG_EXTENDED_SYS_STATE},
+    { MAVLINK_MSG_ID_AUTOPILOT_VERSION,     MSG_AUTOPILOT_VERSION},
+    { MAVLINK_MSG_ID_SCHED_TASK_HISTOGRAM,  MSG_SCHED_TASK_HISTOGRAM},
+    { MAVLINK_MSG_ID_STREAM_RATE_STATS,     MSG_STREAM_RATE_STATS},
+    { MAVLINK_MSG_ID_OBSTACLE_DISTANCE,     MSG_OBSTACLE_DISTANCE},
+};
+
 ap_message GCS_MAVLINK::mavlink_id_to_ap_message_id(const uint32_t mavlink_id) const
 {
-    // MSG_NEXT_MISSION_REQUEST doesn't correspond to a mavlink message directly.
-    // It is used to request the next waypoint after receiving one.
-
-    // MSG_NEXT_PARAM doesn't correspond to a mavlink message directly.
-    // It is used to send the next parameter in a stream after sending one
-
-    // MSG_NAMED_FLOAT messages can't really be "streamed"...
-
-    static const struct {
-        uint32_t mavlink_id;
-        ap_message msg_id;
-    } map[] {
-        { MAVLINK_MSG_ID_HEARTBEAT,             MSG_HEARTBEAT},
-        { MAVLINK_MSG_ID_ATTITUDE,              MSG_ATTITUDE},
-        { MAVLINK_MSG_ID_GLOBAL_POSITION_INT,   MSG_LOCATION},
-        { MAVLINK_MSG_ID_HOME_POSITION,         MSG_HOME},
-        { MAVLINK_MSG_ID_GPS_GLOBAL_ORIGIN,     MSG_ORIGIN},
-        { MAVLINK_MSG_ID_SYS_STATUS,            MSG_SYS_STATUS},
-        { MAVLINK_MSG_ID_POWER_STATUS,          MSG_POWER_STATUS},
-        { MAVLINK_MSG_ID_MEMINFO,               MSG_MEMINFO},
-        { MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT, MSG_NAV_CONTROLLER_OUTPUT},
-        { MAVLINK_MSG_ID_MISSION_CURRENT,       MSG_CURRENT_WAYPOINT},
-        { MAVLINK_MSG_ID_VFR_HUD,               MSG_VFR_HUD},
-        { MAVLINK_MSG_ID_SERVO_OUTPUT_RAW,      MSG_SERVO_OUTPUT_RAW},
-        { MAVLINK_MSG_ID_RC_CHANNELS,           MSG_RC_CHANNELS},
-        { MAVLINK_MSG_ID_RC_CHANNELS_RAW,       MSG_RC_CHANNELS_RAW},
-        { MAVLINK_MSG_ID_RAW_IMU,               MSG_RAW_IMU},
-        { MAVLINK_MSG_ID_SCALED_IMU,            MSG_SCALED_IMU},
-        { MAVLINK_MSG_ID_SCALED_IMU2,           MSG_SCALED_IMU2},
-        { MAVLINK_MSG_ID_SCALED_IMU3,           MSG_SCALED_IMU3},
-        { MAVLINK_MSG_ID_SCALED_PRESSURE,       MSG_SCALED_PRESSURE},
-        { MAVLINK_MSG_ID_SCALED_PRESSURE2,      MSG_SCALED_PRESSURE2},
-        { MAVLINK_MSG_ID_SCALED_PRESSURE3,      MSG_SCALED_PRESSURE3},
-        { MAVLINK_MSG_ID_SENSOR_OFFSETS,        MSG_SENSOR_OFFSETS},
-        { MAVLINK_MSG_ID_GPS_RAW_INT,           MSG_GPS_RAW},
-        { MAVLINK_MSG_ID_GPS_RTK,               MSG_GPS_RTK},
-        { MAVLINK_MSG_ID_GPS2_RAW,              MSG_GPS2_RAW},
-        { MAVLINK_MSG_ID_GPS2_RTK,              MSG_GPS2_RTK},
-        { MAVLINK_MSG_ID_SYSTEM_TIME,           MSG_SYSTEM_TIME},
-        { MAVLINK_MSG_ID_RC_CHANNELS_SCALED,    MSG_SERVO_OUT},
-        { MAVLINK_MSG_ID_PARAM_VALUE,           MSG_NEXT_PARAM},
-        { MAVLINK_MSG_ID_FENCE_STATUS,          MSG_FENCE_STATUS},
-        { MAVLINK_MSG_ID_AHRS,                  MSG_AHRS},
-        { MAVLINK_MSG_ID_SIMSTATE,              MSG_SIMSTATE},
-        { MAVLINK_MSG_ID_AHRS2,                 MSG_AHRS2},
-        { MAVLINK_MSG_ID_AHRS3,                 MSG_AHRS3},
-        { MAVLINK_MSG_ID_HWSTATUS,              MSG_HWSTATUS},
-        { MAVLINK_MSG_ID_WIND,                  MSG_WIND},
-        { MAVLINK_MSG_ID_RANGEFINDER,           MSG_RANGEFINDER},
-        { MAVLINK_MSG_ID_DISTANCE_SENSOR,       MSG_DISTANCE_SENSOR},
-            // request also does report:
-        { MAVLINK_MSG_ID_TERRAIN_REQUEST,       MSG_TERRAIN},
-        { MAVLINK_MSG_ID_BATTERY2,              MSG_BATTERY2},
-        { MAVLINK_MSG_ID_CAMERA_FEEDBACK,       MSG_CAMERA_FEEDBACK},
-        { MAVLINK_MSG_ID_MOUNT_STATUS,          MSG_MOUNT_STATUS},
-        { MAVLINK_MSG_ID_OPTICAL_FLOW,          MSG_OPTICAL_FLOW},
-        { MAVLINK_MSG_ID_GIMBAL_REPORT,         MSG_GIMBAL_REPORT},
-        { MAVLINK_MSG_ID_MAG_CAL_PROGRESS,      MSG_MAG_CAL_PROGRESS},
-        { MAVLINK_MSG_ID_MAG_CAL_REPORT,        MSG_MAG_CAL_REPORT},
-        { MAVLINK_MSG_ID_EKF_STATUS_REPORT,     MSG_EKF_STATUS_REPORT},
-        { MAVLINK_MSG_ID_LOCAL_POSITION_NED,    MSG_LOCAL_POSITION},
-        { MAVLINK_MSG_ID_PID_TUNING,            MSG_PID_TUNING},
-        { MAVLINK_MSG_ID_VIBRATION,             MSG_VIBRATION},
-        { MAVLINK_MSG_ID_RPM,                   MSG_RPM},
-        { MAVLINK_MSG_ID_MISSION_ITEM_REACHED,  MSG_MISSION_ITEM_REACHED},
-        { MAVLINK_MSG_ID_POSITION_TARGET_GLOBAL_INT,  MSG_POSITION_TARGET_GLOBAL_INT},
-        { MAVLINK_MSG_ID_POSITION_TARGET_LOCAL_NED,  MSG_POSITION_TARGET_LOCAL_NED},
-        { MAVLINK_MSG_ID_ADSB_VEHICLE,          MSG_ADSB_VEHICLE},
-        { MAVLINK_MSG_ID_BATTERY_STATUS,        MSG_BATTERY_STATUS},
-        { MAVLINK_MSG_ID_AOA_SSA,               MSG_AOA_SSA},
-        { MAVLINK_MSG_ID_DEEPSTALL,             MSG_LANDING},
-        { MAVLINK_MSG_ID_EXTENDED_SYS_STATE,    MSG_EXTENDED_SYS_STATE},
-        { MAVLINK_MSG_ID_AUTOPILOT_VERSION,     MSG_AUTOPILOT_VERSION},
-            };
-
-    for (uint8_t i=0; i<ARRAY_SIZE(map); i++) {
-        if (map[i].mavlink_id == mavlink_id) {
-            return map[i].msg_id;
+    for (uint8_t i=0; i<ARRAY_SIZE(ap_message_map); i++) {
+        if (ap_message_map[i].mavlink_id == mavlink_id) {
+            return ap_message_map[i].msg_id;
         }
     }
     return MSG_LAST;
 }
 
+uint32_t GCS_MAVLINK::ap_message_id_to_mavlink_id(const ap_message id) const
+{
+    for (uint8_t i=0; i<ARRAY_SIZE(ap_message_map); i++) {
+        if (ap_message_map[i].msg_id == id) {
+            return ap_message_map[i].mavlink_id;
+        }
+    }
+    return UINT32_MAX;
+}
+
 bool GCS_MAVLINK::set_mavlink_message_id_interval(const uint32_t mavlink_id,
                                                   const uint16_t interval_ms)
 {
@@ -826,9 +991,24 @@ bool GCS_MAVLINK::should_send_message_in_delay_callback(const ap_message id) con
     return false;
 }
 
-uint16_t GCS_MAVLINK::get_reschedule_interval_ms(const deferred_message_bucket_t &deferred) const
+uint16_t GCS_MAVLINK::get_reschedule_interval_ms(const ap_message id, const uint16_t interval) const
 {
-    uint32_t interval_ms = deferred.interval_ms;
+    uint32_t interval_ms = interval;
+
+    if (adaptive.scale > 1) {
+        float scale = adaptive.scale;
+        switch (stream_priority(id)) {
+        case StreamPriority::High:
+            scale = 1 + (scale - 1) * 0.25f;
+            break;
+        case StreamPriority::Medium:
+            break;
+        case StreamPriority::Low:
+            scale = sq(scale);
+            break;
+        }
+        interval_ms = MIN(interval_ms * scale, 60000U);
+    }
 
     interval_ms += stream_slowdown_ms;
 
@@ -850,77 +1030,235 @@ uint16_t GCS_MAVLINK::get_reschedule_interval_ms(const deferred_message_bucket_t
     return interval_ms;
 }
 
-// typical runtime on fmuv3: 5 microseconds for 3 buckets
-void GCS_MAVLINK::find_next_bucket_to_send()
+// place entry at position i of the stream heap
+void GCS_MAVLINK::stream_heap_set(const uint8_t i, const stream_entry_t &entry)
 {
-#if GCS_DEBUG_SEND_MESSAGE_TIMINGS
-    void *data = hal.scheduler->disable_interrupts_save();
-    uint32_t start_us = AP_HAL::micros();
-#endif
+    stream_heap[i] = entry;
+    stream_heap_index[entry.id] = i + 1;
+}
 
-    const uint16_t now16_ms{AP_HAL::millis16()};
+void GCS_MAVLINK::stream_heap_sift_up(uint8_t i)
+{
+    const stream_entry_t entry = stream_heap[i];
+    while (i > 0) {
+        const uint8_t parent = (i - 1) / 2;
+        if (int32_t(entry.next_due_ms - stream_heap[parent].next_due_ms) >= 0) {
+            break;
+        }
+        stream_heap_set(i, stream_heap[parent]);
+        i = parent;
+    }
+    stream_heap_set(i, entry);
+}
 
-    // all done sending this bucket... find another bucket...
-    sending_bucket_id = no_bucket_to_send;
-    uint16_t ms_before_send_next_bucket_to_send = UINT16_MAX;
-    for (uint8_t i=0; i<ARRAY_SIZE(deferred_message_bucket); i++) {
-        if (deferred_message_bucket[i].ap_message_ids.count() == 0) {
-            // no entries
-            continue;
+void GCS_MAVLINK::stream_heap_sift_down(uint8_t i)
+{
+    const stream_entry_t entry = stream_heap[i];
+    while (true) {
+        uint8_t child = 2 * i + 1;
+        if (child >= stream_heap_count) {
+            break;
         }
-        const uint16_t interval = get_reschedule_interval_ms(deferred_message_bucket[i]);
-        const uint16_t ms_since_last_sent = now16_ms - deferred_message_bucket[i].last_sent_ms;
-        uint16_t ms_before_send_this_bucket;
-        if (ms_since_last_sent > interval) {
-            // should already have sent this bucket!
-            ms_before_send_this_bucket = 0;
-        } else {
-            ms_before_send_this_bucket = interval - ms_since_last_sent;
+        if (child + 1 < stream_heap_count &&
+            int32_t(stream_heap[child + 1].next_due_ms - stream_heap[child].next_due_ms) < 0) {
+            child++;
         }
-        if (ms_before_send_this_bucket < ms_before_send_next_bucket_to_send) {
-            sending_bucket_id = i;
-            ms_before_send_next_bucket_to_send = ms_before_send_this_bucket;
+        if (int32_t(stream_heap[child].next_due_ms - entry.next_due_ms) >= 0) {
+            break;
         }
+        stream_heap_set(i, stream_heap[child]);
+        i = child;
     }
-    if (sending_bucket_id != no_bucket_to_send) {
-        bucket_message_ids_to_send = deferred_message_bucket[sending_bucket_id].ap_message_ids;
+    stream_heap_set(i, entry);
+}
+
+// restore the heap order after the due time of entry i has changed
+void GCS_MAVLINK::stream_heap_update(const uint8_t i)
+{
+    if (i > 0 && int32_t(stream_heap[i].next_due_ms - stream_heap[(i - 1) / 2].next_due_ms) < 0) {
+        stream_heap_sift_up(i);
     } else {
-        bucket_message_ids_to_send.clearall();
+        stream_heap_sift_down(i);
+    }
+}
+
+void GCS_MAVLINK::stream_heap_remove(const ap_message id)
+{
+    if (stream_heap_index[id] == 0) {
+        return;
+    }
+    const uint8_t i = stream_heap_index[id] - 1;
+    stream_heap_index[id] = 0;
+    stream_heap_count--;
+    if (i == stream_heap_count) {
+        return;
+    }
+    // move the last entry into the hole
+    stream_heap_set(i, stream_heap[stream_heap_count]);
+    stream_heap_update(i);
+}
+
+// schedule the message at the top of the stream heap, which has just
+// been sent, for its next send
+void GCS_MAVLINK::reschedule_first_stream_message()
+{
+#if GCS_DEBUG_SEND_MESSAGE_TIMINGS
+    void *data = hal.scheduler->disable_interrupts_save();
+    uint32_t start_us = AP_HAL::micros();
+#endif
+
+    stream_entry_t &entry = stream_heap[0];
+    const uint32_t now_ms = AP_HAL::millis();
+    const uint16_t interval_ms = get_reschedule_interval_ms(entry.id, entry.interval_ms);
+    entry.next_due_ms += interval_ms;
+    if (int32_t(now_ms - entry.next_due_ms) >= 0) {
+        // more than an interval behind; rather than sending it again
+        // straight away to catch up, start again from now
+        entry.next_due_ms = now_ms + interval_ms;
+        if (entry.late_count < UINT8_MAX) {
+            entry.late_count++;
+        }
     }
+    entry.sent_count++;
+    stream_heap_sift_down(0);
 
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
     uint32_t delta_us = AP_HAL::micros() - start_us;
     hal.scheduler->restore_interrupts(data);
-    if (delta_us > try_send_message_stats.fnbts_maxtime) {
-        try_send_message_stats.fnbts_maxtime = delta_us;
+    if (delta_us > try_send_message_stats.reschedule_maxtime) {
+        try_send_message_stats.reschedule_maxtime = delta_us;
     }
 #endif
 }
 
-ap_message GCS_MAVLINK::next_deferred_bucket_message_to_send()
+ap_message GCS_MAVLINK::next_deferred_stream_message_to_send()
 {
-    if (sending_bucket_id == no_bucket_to_send) {
+    if (stream_heap_count == 0) {
         // could happen if all streamrates are zero?
         return no_message_to_send;
     }
-
-    const uint16_t now16_ms = AP_HAL::millis16();
-    const uint16_t ms_since_last_sent = now16_ms - deferred_message_bucket[sending_bucket_id].last_sent_ms;
-    if (ms_since_last_sent < get_reschedule_interval_ms(deferred_message_bucket[sending_bucket_id])) {
-        // not time to send this bucket
+    if (int32_t(AP_HAL::millis() - stream_heap[0].next_due_ms) < 0) {
+        // not time to send anything yet
         return no_message_to_send;
     }
+    return stream_heap[0].id;
+}
 
-    const int16_t next = bucket_message_ids_to_send.first_set();
-    if (next == -1) {
-        // should not happen
-#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
-        AP_HAL::panic("next_deferred_bucket_message_to_send called on empty bucket");
-#endif
-        find_next_bucket_to_send();
-        return no_message_to_send;
+/*
+  start a new period over which the achieved rate of each stream
+  message is measured
+ */
+void GCS_MAVLINK::update_stream_rates()
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - stream_rate_period_start_ms < 5000) {
+        return;
+    }
+    for (uint8_t i=0; i<stream_heap_count; i++) {
+        stream_heap[i].last_sent_count = stream_heap[i].sent_count;
+        stream_heap[i].sent_count = 0;
+    }
+    stream_rate_last_period_ms = now_ms - stream_rate_period_start_ms;
+    stream_rate_period_start_ms = now_ms;
+}
+
+GCS_MAVLINK::StreamPriority GCS_MAVLINK::stream_priority(const ap_message id)
+{
+    switch (id) {
+    case MSG_HEARTBEAT:
+    case MSG_ATTITUDE:
+    case MSG_LOCATION:
+    case MSG_SYS_STATUS:
+    case MSG_GPS_RAW:
+    case MSG_VFR_HUD:
+    case MSG_MISSION_ITEM_REACHED:
+        return StreamPriority::High;
+    case MSG_SERVO_OUTPUT_RAW:
+    case MSG_RC_CHANNELS:
+    case MSG_RC_CHANNELS_RAW:
+    case MSG_RAW_IMU:
+    case MSG_SCALED_IMU:
+    case MSG_SCALED_IMU2:
+    case MSG_SCALED_IMU3:
+    case MSG_SCALED_PRESSURE:
+    case MSG_SCALED_PRESSURE2:
+    case MSG_SCALED_PRESSURE3:
+    case MSG_SENSOR_OFFSETS:
+    case MSG_GPS_RTK:
+    case MSG_GPS2_RTK:
+    case MSG_MEMINFO:
+    case MSG_AHRS3:
+    case MSG_HWSTATUS:
+    case MSG_SIMSTATE:
+    case MSG_PID_TUNING:
+    case MSG_VIBRATION:
+    case MSG_RPM:
+    case MSG_ESC_TELEMETRY:
+    case MSG_ADSB_VEHICLE:
+    case MSG_NAMED_FLOAT:
+    case MSG_SCHED_TASK_HISTOGRAM:
+    case MSG_STREAM_RATE_STATS:
+        return StreamPriority::Low;
+    default:
+        return StreamPriority::Medium;
     }
-    return (ap_message)next;
+}
+
+/*
+  estimate the throughput this link can carry and adjust the stream
+  scale so we use the configured fraction of it. The UART draining
+  slower than we write, or the radio reporting a filling buffer,
+  shows the link is saturated, and what was actually carried then is
+  the capacity. Otherwise the link carried everything and the
+  estimate is raised slowly to probe for more
+ */
+void GCS_MAVLINK::update_adaptive_rate()
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    const uint32_t dt_ms = now_ms - adaptive.last_update_ms;
+    if (dt_ms < 500) {
+        return;
+    }
+    const int8_t util = adaptive_util->get();
+    const uint16_t txspace = comm_get_txspace(chan);
+    adaptive.txspace_max = MAX(adaptive.txspace_max, txspace);
+    const uint16_t queued = adaptive.txspace_max - txspace;
+    const uint32_t tx_bytes = mavlink_comm_tx_bytes[chan];
+    const float drained = MAX(float(tx_bytes - adaptive.last_tx_bytes) + adaptive.last_queued - queued, 0.0f);
+    adaptive.last_update_ms = now_ms;
+    adaptive.last_tx_bytes = tx_bytes;
+    adaptive.last_queued = queued;
+
+    if (util <= 0 || dt_ms > 2000) {
+        // disabled, or the first period after a stall
+        adaptive.scale = 1;
+        adaptive.capacity = 0;
+        return;
+    }
+
+    const float rate = drained * 1000.0f / dt_ms;
+    const bool uart_saturated = queued > adaptive.txspace_max / 2;
+    const bool radio_saturated = now_ms - adaptive.radio_status_ms < 5000 && adaptive.radio_txbuf < 50;
+    if (uart_saturated || radio_saturated) {
+        // the radio has already accepted more than it can send
+        const float carried = uart_saturated ? rate : rate * 0.9f;
+        adaptive.capacity = is_positive(adaptive.capacity) ? (adaptive.capacity + carried) * 0.5f : carried;
+    } else if (adaptive.scale > 1) {
+        adaptive.capacity = MAX(adaptive.capacity * 1.05f, rate);
+    } else {
+        adaptive.capacity = MAX(adaptive.capacity, rate);
+    }
+
+    const float target = adaptive.capacity * MIN(util, 100) * 0.01f;
+    if (!is_positive(target) || !is_positive(rate)) {
+        return;
+    }
+    float desired = adaptive.scale * rate / target;
+    if (!uart_saturated && !radio_saturated) {
+        // everything was carried, so never thin streams further
+        desired = MIN(desired, adaptive.scale);
+    }
+    adaptive.scale = constrain_float((adaptive.scale + desired) * 0.5f, 1, 16);
 }
 
 // call try_send_message if appropriate.  Incorporates debug code to
@@ -1012,6 +1350,11 @@ int8_t GCS_MAVLINK::deferred_message_to_send_index()
 
 void GCS_MAVLINK::update_send()
 {
+    // replies to the GCS go out ahead of everything else
+    if (!send_queued_replies()) {
+        return;
+    }
+
     if (!hal.scheduler->in_delay_callback()) {
         // AP_Logger will not send log data if we are armed.
         AP::logger().handle_log_send();
@@ -1026,6 +1369,9 @@ void GCS_MAVLINK::update_send()
         deferred_messages_initialised = true;
     }
 
+    update_stream_rates();
+    update_adaptive_rate();
+
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
     uint32_t retry_deferred_body_start = AP_HAL::micros();
 #endif
@@ -1083,18 +1429,12 @@ void GCS_MAVLINK::update_send()
             continue;
         }
 
-        ap_message next = next_deferred_bucket_message_to_send();
+        ap_message next = next_deferred_stream_message_to_send();
         if (next != no_message_to_send) {
             if (!do_try_send_message(next)) {
                 break;
             }
-            bucket_message_ids_to_send.clear(next);
-            if (bucket_message_ids_to_send.count() == 0) {
-                // we sent everything in the bucket.  Reschedule it.
-                deferred_message_bucket[sending_bucket_id].last_sent_ms +=
-                    get_reschedule_interval_ms(deferred_message_bucket[sending_bucket_id]);
-                find_next_bucket_to_send();
-            }
+            reschedule_first_stream_message();
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
                 const uint32_t stop = AP_HAL::micros();
                 const uint32_t delta = stop - retry_deferred_body_start;
@@ -1126,24 +1466,6 @@ void GCS_MAVLINK::update_send()
     }
 }
 
-void GCS_MAVLINK::remove_message_from_bucket(int8_t bucket, ap_message id)
-{
-    deferred_message_bucket[bucket].ap_message_ids.clear(id);
-
-    if (bucket == sending_bucket_id) {
-        bucket_message_ids_to_send.clear(id);
-    }
-
-    if (deferred_message_bucket[bucket].ap_message_ids.count() == 0) {
-        // bucket empty.  Free it:
-        deferred_message_bucket[bucket].interval_ms = 0;
-        deferred_message_bucket[bucket].last_sent_ms = 0;
-        if (sending_bucket_id == bucket) {
-            find_next_bucket_to_send();
-        }
-    }
-}
-
 bool GCS_MAVLINK::set_ap_message_interval(enum ap_message id, uint16_t interval_ms)
 {
     if (id == MSG_NEXT_PARAM) {
@@ -1170,83 +1492,35 @@ bool GCS_MAVLINK::set_ap_message_interval(enum ap_message id, uint16_t interval_
         return true;
     }
 
-    // see which bucket has the closest interval:
-    int8_t closest_bucket = -1;
-    uint16_t closest_bucket_interval_delta = UINT16_MAX;
-    int8_t in_bucket = -1;
-    int8_t empty_bucket_id = -1;
-    for (uint8_t i=0; i<ARRAY_SIZE(deferred_message_bucket); i++) {
-        const deferred_message_bucket_t &bucket = deferred_message_bucket[i];
-        if (bucket.interval_ms == 0) {
-            // unused bucket
-            if (empty_bucket_id == -1) {
-                empty_bucket_id = i;
-            }
-#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
-            if (bucket.ap_message_ids.count() != 0) {
-                AP_HAL::panic("Bucket %u has zero interval but with ids set", i);
-            }
-#endif
-            continue;
-        }
-        if (bucket.ap_message_ids.get(id)) {
-            in_bucket = i;
-        }
-        const uint16_t interval_delta = abs(bucket.interval_ms - interval_ms);
-        if (interval_delta < closest_bucket_interval_delta) {
-            closest_bucket = i;
-            closest_bucket_interval_delta = interval_delta;
-        }
-    }
-
-    if (in_bucket == -1 && interval_ms == 0) {
-        // not in a bucket and told to remove from scheduling
+    if (interval_ms == 0) {
+        // told to remove from scheduling
+        stream_heap_remove(id);
         return true;
     }
 
-    if (in_bucket != -1) {
-        if (interval_ms == 0) {
-            // remove it
-            remove_message_from_bucket(in_bucket, id);
-            return true;
-        }
-        if (closest_bucket_interval_delta == 0 &&
-            in_bucket == closest_bucket) {
-            // don't need to move it
+    const uint32_t now_ms = AP_HAL::millis();
+    if (stream_heap_index[id] != 0) {
+        const uint8_t i = stream_heap_index[id] - 1;
+        if (stream_heap[i].interval_ms == interval_ms) {
             return true;
         }
-        // remove from existing bucket
-        remove_message_from_bucket(in_bucket, id);
-        if (empty_bucket_id == -1 &&
-            deferred_message_bucket[in_bucket].ap_message_ids.count() == 0) {
-            empty_bucket_id = in_bucket;
-        }
+        stream_heap[i].interval_ms = interval_ms;
+        stream_heap[i].next_due_ms = now_ms + interval_ms;
+        stream_heap[i].late_count = 0;
+        stream_heap_update(i);
+        return true;
     }
 
-    if (closest_bucket == -1 && empty_bucket_id == -1) {
-        // gah?!
-#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
-        ::fprintf(stderr, "no buckets?!\n");
-        abort();
-#endif
+    if (stream_heap_count >= ARRAY_SIZE(stream_heap)) {
+        // can't happen, each ap_message has a place
         return false;
     }
-
-    if (closest_bucket_interval_delta != 0 &&
-        empty_bucket_id != -1) {
-        // allocate a bucket for this interval
-        deferred_message_bucket[empty_bucket_id].interval_ms = interval_ms;
-        deferred_message_bucket[empty_bucket_id].last_sent_ms = AP_HAL::millis16();
-        closest_bucket = empty_bucket_id;
-        closest_bucket_interval_delta = 0;
-    }
-
-    deferred_message_bucket[closest_bucket].ap_message_ids.set(id);
-
-    if (sending_bucket_id == no_bucket_to_send) {
-        sending_bucket_id = closest_bucket;
-        bucket_message_ids_to_send = deferred_message_bucket[closest_bucket].ap_message_ids;
-    }
+    stream_entry_t entry {};
+    entry.id = id;
+    entry.interval_ms = interval_ms;
+    entry.next_due_ms = now_ms + interval_ms;
+    stream_heap_set(stream_heap_count, entry);
+    stream_heap_sift_up(stream_heap_count++);
 
     return true;
 }
@@ -1298,6 +1572,9 @@ void GCS_MAVLINK::packetReceived(const mavlink_status_t &status,
         // e.g. enforce-sysid says we shouldn't look at this packet
         return;
     }
+#ifdef ENABLE_SCRIPTING
+    AP_Scripting::post_event(AP_Scripting::Event::MAVLINK, msg.msgid, chan);
+#endif
     handleMessage(msg);
 }
 
@@ -1371,8 +1648,12 @@ GCS_MAVLINK::update_receive(uint32_t max_time_us)
     const uint32_t tnow = AP_HAL::millis();
 
     // send a timesync message every 10 seconds; this is for data
-    // collection purposes
-    if (tnow - _timesync_request.last_sent_ms > _timesync_request.interval_ms && !is_private()) {
+    // collection purposes, and for the remote clock offset used to
+    // correct offboard timestamps, which is refreshed more often while
+    // they are arriving
+    const bool offboard_active = offboard_lag.last_ms != 0 && tnow - offboard_lag.last_ms < 5000;
+    const uint16_t timesync_interval_ms = offboard_active ? _timesync_request.offboard_interval_ms : _timesync_request.interval_ms;
+    if (tnow - _timesync_request.last_sent_ms > timesync_interval_ms && !is_private()) {
         if (HAVE_PAYLOAD_SPACE(chan, TIMESYNC)) {
             send_timesync();
             _timesync_request.last_sent_ms = tnow;
@@ -1429,12 +1710,12 @@ GCS_MAVLINK::update_receive(uint32_t max_time_us)
                             try_send_message_stats.behind);
             try_send_message_stats.behind = 0;
         }
-        if (try_send_message_stats.fnbts_maxtime) {
+        if (try_send_message_stats.reschedule_maxtime) {
             gcs().send_text(MAV_SEVERITY_INFO,
-                            "GCS.chan(%u): fnbts_maxtime=%uus",
+                            "GCS.chan(%u): reschedule_maxtime=%uus",
                             chan,
-                            try_send_message_stats.fnbts_maxtime);
-            try_send_message_stats.fnbts_maxtime = 0;
+                            try_send_message_stats.reschedule_maxtime);
+            try_send_message_stats.reschedule_maxtime = 0;
         }
         if (try_send_message_stats.max_retry_deferred_body_us) {
             gcs().send_text(MAV_SEVERITY_INFO,
@@ -1446,16 +1727,10 @@ GCS_MAVLINK::update_receive(uint32_t max_time_us)
             try_send_message_stats.max_retry_deferred_body_us = 0;
         }
 
-        for (uint8_t i=0; i<ARRAY_SIZE(deferred_message_bucket); i++) {
-            gcs().send_text(MAV_SEVERITY_INFO,
-                            "B. intvl. (%u): %u %u %u %u %u",
-                            chan,
-                            deferred_message_bucket[0].interval_ms,
-                            deferred_message_bucket[1].interval_ms,
-                            deferred_message_bucket[2].interval_ms,
-                            deferred_message_bucket[3].interval_ms,
-                            deferred_message_bucket[4].interval_ms);
-        }
+        gcs().send_text(MAV_SEVERITY_INFO,
+                        "GCS.chan(%u): streams=%u",
+                        chan,
+                        stream_heap_count);
 
         try_send_message_stats.statustext_last_sent_ms = now16_ms;
     }
@@ -1474,14 +1749,28 @@ void GCS_MAVLINK::log_mavlink_stats()
         return;
     }
 
+    uint32_t fwd_count, fwd_drop_count;
+    routing.get_forward_counts(chan, fwd_count, fwd_drop_count);
+    uint32_t sign_count, sign_time_us;
+    get_signing_hash_stats(sign_count, sign_time_us);
+
     const struct log_MAV pkt = {
     LOG_PACKET_HEADER_INIT(LOG_MAV_MSG),
     time_us                : AP_HAL::micros64(),
     chan                   : (uint8_t)chan,
     packet_tx_count        : send_packet_count,
     packet_rx_success_count: status->packet_rx_success_count,
-    packet_rx_drop_count   : status->packet_rx_drop_count
+    packet_rx_drop_count   : status->packet_rx_drop_count,
+    packet_fwd_count       : fwd_count,
+    packet_fwd_drop_count  : fwd_drop_count,
+    sign_hash_count        : sign_count,
+    sign_hash_time_us      : sign_time_us,
+    ack_latency_ms         : reply_stats[uint8_t(ReplyClass::ACK)].max_latency_ms,
+    param_latency_ms       : reply_stats[uint8_t(ReplyClass::PARAM)].max_latency_ms,
+    text_latency_ms        : reply_stats[uint8_t(ReplyClass::TEXT)].max_latency_ms,
+    reply_drop_count       : reply_drop_count
     };
+    memset(reply_stats, 0, sizeof(reply_stats));
 
     AP::logger().WriteBlock(&pkt, sizeof(pkt));
 }
@@ -1784,6 +2073,7 @@ void GCS::send_statustext(MAV_SEVERITY severity, uint8_t dest_bitmask, const cha
         return;
     }
 
+    statustext.queued_ms = AP_HAL::millis();
     statustext.msg.severity = severity;
     strncpy(statustext.msg.text, text, sizeof(statustext.msg.text));
 
@@ -1835,6 +2125,12 @@ void GCS::service_statustext(void)
                     // we have space so send then clear that channel bit on the mask
                     mavlink_msg_statustext_send(chan_index, statustext->msg.severity, statustext->msg.text, 0, 0);
                     statustext->bitmask &= ~chan_bit;
+                    for (uint8_t j=0; j<num_gcs(); j++) {
+                        if (chan(j)->get_chan() == chan_index) {
+                            chan(j)->record_reply_latency(GCS_MAVLINK::ReplyClass::TEXT, statustext->queued_ms);
+                            break;
+                        }
+                    }
                 }
             }
         }
@@ -1882,6 +2178,11 @@ void GCS::update_send()
     if (_missionitemprotocol_fence != nullptr) {
         _missionitemprotocol_fence->update();
     }
+    // status text goes out ahead of stream messages
+    {
+        WITH_SEMAPHORE(_statustext_sem);
+        service_statustext();
+    }
     // round-robin the GCS_MAVLINK backend that gets to go first so
     // one backend doesn't monopolise all of the time allowed for sending
     // messages
@@ -2017,7 +2318,7 @@ void GCS_MAVLINK::handle_set_mode(const mavlink_message_t &msg)
     // exist, but if it did we'd probably be acking something
     // completely unrelated to setting modes.
     if (HAVE_PAYLOAD_SPACE(chan, MAVLINK_MSG_ID_COMMAND_ACK)) {
-        mavlink_msg_command_ack_send(chan, MAVLINK_MSG_ID_SET_MODE, result);
+        send_command_ack(MAVLINK_MSG_ID_SET_MODE, result);
     }
 }
 
@@ -2188,6 +2489,90 @@ void GCS_MAVLINK::send_vibration() const
         ins.get_accel_clip_count(2));
 }
 
+/*
+  send SCHED_TASK_HISTOGRAM for one scheduler task. Each call moves on
+  to the next task so a full table is reported over several calls
+ */
+void GCS_MAVLINK::send_sched_task_histogram()
+{
+    static_assert(MAVLINK_MSG_SCHED_TASK_HISTOGRAM_FIELD_TIME_HIST_LEN == AP::PerfInfo::HISTOGRAM_BINS,
+                  "SCHED_TASK_HISTOGRAM must match scheduler histogram size");
+    AP_Scheduler &scheduler = AP::scheduler();
+    const uint8_t num_tasks = scheduler.get_num_tasks();
+    if (num_tasks == 0) {
+        return;
+    }
+    if (sched_histogram_task >= num_tasks) {
+        sched_histogram_task = 0;
+    }
+    const uint8_t i = sched_histogram_task++;
+    const AP::PerfInfo::TaskInfo *ti = scheduler.perf_info.get_task_info(i);
+    if (ti == nullptr) {
+        // histograms are not being recorded
+        return;
+    }
+    char name[MAVLINK_MSG_SCHED_TASK_HISTOGRAM_FIELD_NAME_LEN] {};
+    strncpy_noterm(name, scheduler.get_task_name(i), sizeof(name));
+    mavlink_msg_sched_task_histogram_send(
+        chan,
+        i,
+        num_tasks,
+        name,
+        scheduler.get_task_max_time_micros(i),
+        ti->max_time_us,
+        ti->run_count,
+        ti->time_hist,
+        ti->slip_hist,
+        ti->starved);
+}
+
+/*
+  send STREAM_RATE_STATS for one stream-rated message. Each call moves
+  on to the next message so all of them are reported over several
+  calls
+ */
+void GCS_MAVLINK::send_stream_rate_stats()
+{
+    if (stream_heap_count == 0) {
+        return;
+    }
+    // find the next message being streamed, in ap_message order as
+    // heap positions change as messages are sent
+    uint8_t index = 0;
+    for (uint8_t n=0; n<MSG_LAST; n++) {
+        if (stream_rate_stats_id >= MSG_LAST) {
+            stream_rate_stats_id = 0;
+        }
+        if (stream_heap_index[stream_rate_stats_id] != 0) {
+            break;
+        }
+        stream_rate_stats_id++;
+    }
+    const ap_message id = (ap_message)stream_rate_stats_id++;
+    if (stream_heap_index[id] == 0) {
+        return;
+    }
+    for (uint8_t i=0; i<id; i++) {
+        if (stream_heap_index[i] != 0) {
+            index++;
+        }
+    }
+    const stream_entry_t &entry = stream_heap[stream_heap_index[id] - 1];
+    float rate = 0;
+    if (stream_rate_last_period_ms != 0) {
+        rate = entry.last_sent_count * 1000.0f / stream_rate_last_period_ms;
+    }
+    mavlink_msg_stream_rate_stats_send(
+        chan,
+        index,
+        stream_heap_count,
+        ap_message_id_to_mavlink_id(id),
+        entry.interval_ms,
+        get_reschedule_interval_ms(entry.id, entry.interval_ms),
+        rate,
+        entry.late_count);
+}
+
 void GCS_MAVLINK::send_named_float(const char *name, float value) const
 {
     char float_name[MAVLINK_MSG_NAMED_VALUE_FLOAT_FIELD_NAME_LEN+1] {};
@@ -2337,13 +2722,10 @@ bool GCS_MAVLINK::get_ap_message_interval(ap_message id, uint16_t &interval_ms)
         return true;
     }
 
-    // check the deferred message buckets:
-    for (uint8_t i=0; i<ARRAY_SIZE(deferred_message_bucket); i++) {
-        const deferred_message_bucket_t &bucket = deferred_message_bucket[i];
-        if (bucket.ap_message_ids.get(id)) {
-            interval_ms = bucket.interval_ms;
-            return true;
-        }
+    // check the stream-rated messages:
+    if (stream_heap_index[id] != 0) {
+        interval_ms = stream_heap[stream_heap_index[id] - 1].interval_ms;
+        return true;
     }
 
     return false;
@@ -2567,7 +2949,7 @@ MAV_RESULT GCS_MAVLINK::handle_preflight_reboot(const mavlink_command_long_t &pa
     }
 
     // send ack before we reboot
-    mavlink_msg_command_ack_send(chan, packet.command, MAV_RESULT_ACCEPTED);
+    send_command_ack(packet.command, MAV_RESULT_ACCEPTED);
     // Notify might want to blink some LEDs:
     AP_Notify *notify = AP_Notify::get_singleton();
     if (notify) {
@@ -2642,6 +3024,26 @@ uint64_t GCS_MAVLINK::timesync_timestamp_ns() const
     return AP_HAL::micros64()*1000LL + mavlink_system.sysid;
 }
 
+/*
+  update the remote clock offset from a response to our TIMESYNC
+  request. remote_ns is the remote time the request was answered at
+  and local_ns the local time half way through the round trip
+ */
+void GCS_MAVLINK::update_timesync_offset(uint64_t remote_ns, uint64_t local_ns, uint32_t round_trip_time_us)
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    // keep the offset from the shortest round trip, but let a longer
+    // one replace it after a while so clock drift is followed
+    if (_timesync_offset.updated_ms != 0 &&
+        round_trip_time_us > _timesync_offset.rtt_us * 2 &&
+        now_ms - _timesync_offset.updated_ms < 10000) {
+        return;
+    }
+    _timesync_offset.offset_us = int64_t(remote_ns / 1000U) - int64_t(local_ns / 1000U);
+    _timesync_offset.rtt_us = round_trip_time_us;
+    _timesync_offset.updated_ms = now_ms;
+}
+
 /*
   return a timesync request
   Sends back ts1 as received, and tc1 is the local timestamp in usec
@@ -2659,7 +3061,11 @@ void GCS_MAVLINK::handle_timesync(const mavlink_message_t &msg)
             // response to an ancient request...
             return;
         }
-        const uint64_t round_trip_time_us = (timesync_receive_timestamp_ns() - _timesync_request.sent_ts1)*0.001f;
+        const uint64_t receive_ns = timesync_receive_timestamp_ns();
+        const uint64_t round_trip_time_us = (receive_ns - _timesync_request.sent_ts1)*0.001f;
+        if (msg.sysid == offboard_lag.sysid && msg.compid == offboard_lag.compid) {
+            update_timesync_offset(tsync.tc1, (_timesync_request.sent_ts1 + receive_ns) / 2, round_trip_time_us);
+        }
 #if 0
         gcs().send_text(MAV_SEVERITY_INFO,
                         "timesync response sysid=%u (latency=%fms)",
@@ -2878,6 +3284,8 @@ void GCS_MAVLINK::handle_vision_position_estimate(const mavlink_message_t &msg)
 {
     mavlink_vision_position_estimate_t m;
     mavlink_msg_vision_position_estimate_decode(&msg, &m);
+    offboard_lag.sysid = msg.sysid;
+    offboard_lag.compid = msg.compid;
 
     handle_common_vision_position_estimate_data(m.usec, m.x, m.y, m.z, m.roll, m.pitch, m.yaw,
                                                 PAYLOAD_SIZE(chan, VISION_POSITION_ESTIMATE));
@@ -2887,6 +3295,8 @@ void GCS_MAVLINK::handle_global_vision_position_estimate(const mavlink_message_t
 {
     mavlink_global_vision_position_estimate_t m;
     mavlink_msg_global_vision_position_estimate_decode(&msg, &m);
+    offboard_lag.sysid = msg.sysid;
+    offboard_lag.compid = msg.compid;
 
     handle_common_vision_position_estimate_data(m.usec, m.x, m.y, m.z, m.roll, m.pitch, m.yaw,
                                                 PAYLOAD_SIZE(chan, GLOBAL_VISION_POSITION_ESTIMATE));
@@ -2896,6 +3306,8 @@ void GCS_MAVLINK::handle_vicon_position_estimate(const mavlink_message_t &msg)
 {
     mavlink_vicon_position_estimate_t m;
     mavlink_msg_vicon_position_estimate_decode(&msg, &m);
+    offboard_lag.sysid = msg.sysid;
+    offboard_lag.compid = msg.compid;
 
     handle_common_vision_position_estimate_data(m.usec, m.x, m.y, m.z, m.roll, m.pitch, m.yaw,
                                                 PAYLOAD_SIZE(chan, VICON_POSITION_ESTIMATE));
@@ -2950,8 +3362,8 @@ void GCS_MAVLINK::log_vision_position_estimate_data(const uint64_t usec,
                                                     const float pitch,
                                                     const float yaw)
 {
-    AP::logger().Write("VISP", "TimeUS,RemTimeUS,CTimeMS,PX,PY,PZ,Roll,Pitch,Yaw",
-                       "sssmmmddh", "FFC000000", "QQIffffff",
+    AP::logger().Write("VISP", "TimeUS,RemTimeUS,CTimeMS,PX,PY,PZ,Roll,Pitch,Yaw,Lag,Jit,TSync",
+                       "sssmmmddhss-", "FFC000000CC-", "QQIffffffffB",
                        (uint64_t)AP_HAL::micros64(),
                        (uint64_t)usec,
                        corrected_msec,
@@ -2960,13 +3372,18 @@ void GCS_MAVLINK::log_vision_position_estimate_data(const uint64_t usec,
                        (double)z,
                        (double)(roll * RAD_TO_DEG),
                        (double)(pitch * RAD_TO_DEG),
-                       (double)(yaw * RAD_TO_DEG));
+                       (double)(yaw * RAD_TO_DEG),
+                       (double)offboard_lag.lag_ms,
+                       (double)offboard_lag.jitter_ms,
+                       (uint8_t)offboard_lag.timesync);
 }
 
 void GCS_MAVLINK::handle_att_pos_mocap(const mavlink_message_t &msg)
 {
     mavlink_att_pos_mocap_t m;
     mavlink_msg_att_pos_mocap_decode(&msg, &m);
+    offboard_lag.sysid = msg.sysid;
+    offboard_lag.compid = msg.compid;
 
     // sensor assumed to be at 0,0,0 body-frame; need parameters for this?
     const Vector3f sensor_offset = {};
@@ -3860,7 +4277,7 @@ void GCS_MAVLINK::handle_command_long(const mavlink_message_t &msg)
     const MAV_RESULT result = handle_command_long_packet(packet);
 
     // send ACK or NAK
-    mavlink_msg_command_ack_send(chan, packet.command, result);
+    send_command_ack(packet.command, result);
 
     // log the packet:
     mavlink_command_int_t packet_int;
@@ -3986,7 +4403,7 @@ void GCS_MAVLINK::handle_command_int(const mavlink_message_t &msg)
     const MAV_RESULT result = handle_command_int_packet(packet);
 
     // send ACK or NAK
-    mavlink_msg_command_ack_send(chan, packet.command, result);
+    send_command_ack(packet.command, result);
 
     AP::logger().Write_Command(packet, result);
 
@@ -4488,6 +4905,21 @@ bool GCS_MAVLINK::try_send_message(const enum ap_message id)
         send_autopilot_version();
         break;
 
+    case MSG_SCHED_TASK_HISTOGRAM:
+        CHECK_PAYLOAD_SIZE(SCHED_TASK_HISTOGRAM);
+        send_sched_task_histogram();
+        break;
+
+    case MSG_STREAM_RATE_STATS:
+        CHECK_PAYLOAD_SIZE(STREAM_RATE_STATS);
+        send_stream_rate_stats();
+        break;
+
+    case MSG_OBSTACLE_DISTANCE:
+        CHECK_PAYLOAD_SIZE(OBSTACLE_DISTANCE);
+        send_obstacle_distance();
+        break;
+
     case MSG_ESC_TELEMETRY: {
 #ifdef HAVE_AP_BLHELI_SUPPORT
         CHECK_PAYLOAD_SIZE(ESC_TELEMETRY_1_TO_4);
@@ -4633,6 +5065,37 @@ uint32_t GCS_MAVLINK::correct_offboard_timestamp_usec_to_ms(uint64_t offboard_us
     }
     uint64_t corrected_us = lag_correction.correct_offboard_timestamp_usec(offboard_usec, local_us);
 
+    // The jitter correction takes the quickest message to have arrived
+    // with no lag at all, so corrected times are late by at least the
+    // lag of the link. When the remote stamps its messages with the
+    // clock it answers TIMESYNC with, the TIMESYNC offset gives their
+    // time directly. The offset is only used when it puts the message
+    // in the window the jitter correction allows, which also rejects
+    // remotes which convert their timestamps to our clock themselves
+    const uint32_t now_ms = AP_HAL::millis();
+    offboard_lag.timesync = false;
+    if (_timesync_offset.updated_ms != 0 && now_ms - _timesync_offset.updated_ms < 30000) {
+        const int64_t timesync_us = int64_t(offboard_usec) - _timesync_offset.offset_us;
+        const int64_t max_lag_us = int64_t(lag_correction.get_max_lag_ms()) * 1000;
+        if (timesync_us <= int64_t(local_us) && timesync_us >= int64_t(local_us) - max_lag_us) {
+            corrected_us = timesync_us;
+            offboard_lag.timesync = true;
+        }
+    }
+
+    // filter the lag and its deviation, which is the jitter the EKF
+    // sees in these samples
+    const float lag_ms = (local_us - corrected_us) * 0.001f;
+    if (offboard_lag.last_ms == 0 || now_ms - offboard_lag.last_ms > 5000) {
+        offboard_lag.lag_ms = lag_ms;
+        offboard_lag.jitter_ms = 0;
+    } else {
+        const float alpha = 0.05f;
+        offboard_lag.jitter_ms += alpha * (fabsf(lag_ms - offboard_lag.lag_ms) - offboard_lag.jitter_ms);
+        offboard_lag.lag_ms += alpha * (lag_ms - offboard_lag.lag_ms);
+    }
+    offboard_lag.last_ms = now_ms;
+
     return corrected_us / 1000U;
 }
 
@@ -17,6 +17,7 @@
 #include <AP_HAL/AP_HAL.h>
 
 #include "GCS.h"
+#include "MissionItemProtocol_Waypoints.h"
 
 #include <AP_Filesystem/AP_Filesystem.h>
 
@@ -26,6 +27,17 @@ extern const AP_HAL::HAL& hal;
 
 struct GCS_MAVLINK::ftp_state GCS_MAVLINK::ftp;
 
+// virtual file holding all parameters in packed form
+#define FTP_PARAM_FILE "@PARAM/param.pck"
+// virtual file holding the mission in packed form
+#define FTP_MISSION_FILE "@MISSION/mission.dat"
+// file descriptor marking a virtual file as open
+#define FTP_VIRTUAL_FD -2
+// largest window a GCS can ask for when acknowledging a burst
+#define FTP_BURST_MAX_WINDOW 0x100000U
+// largest virtual file accepted for upload
+#define FTP_VIRTUAL_MAX_UPLOAD 65536U
+
 bool GCS_MAVLINK::ftp_init(void) {
     // we can simply check if we allocated everything we need
     if (ftp.requests != nullptr) {
@@ -204,8 +216,7 @@ void GCS_MAVLINK::ftp_worker(void) {
                 case FTP_OP::ResetSessions:
                     // we already handled this, just listed for completeness
                     if (ftp.fd != -1) {
-                        AP::FS().close(ftp.fd);
-                        ftp.fd = -1;
+                        ftp_close();
                     }
                     ftp.current_session = -1;
                     reply.opcode = FTP_OP::Ack;
@@ -230,6 +241,10 @@ void GCS_MAVLINK::ftp_worker(void) {
 
                         request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
 
+                        if (ftp_virtual_open(request, reply, FTP_FILE_MODE::VirtualRead)) {
+                            break;
+                        }
+
                         // get the file size
                         struct stat st;
                         if (AP::FS().stat((char *)request.data, &st)) {
@@ -261,19 +276,20 @@ void GCS_MAVLINK::ftp_worker(void) {
                         }
 
                         // must have the file in read mode
-                        if ((ftp.mode != FTP_FILE_MODE::Read)) {
+                        if (ftp.mode != FTP_FILE_MODE::Read && ftp.mode != FTP_FILE_MODE::VirtualRead) {
                             ftp_error(reply, FTP_ERROR::Fail);
                             break;
                         }
 
                         // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
+                        if (ftp.mode == FTP_FILE_MODE::Read &&
+                            AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
                             ftp_error(reply, FTP_ERROR::FailErrno);
                             break;
                         }
 
                         // fill the buffer
-                        const ssize_t read_bytes = AP::FS().read(ftp.fd, reply.data, request.size);
+                        const ssize_t read_bytes = ftp_read(reply.data, request.size, request.offset);
                         if (read_bytes == -1) {
                             ftp_error(reply, FTP_ERROR::FailErrno);
                             break;
@@ -311,6 +327,10 @@ void GCS_MAVLINK::ftp_worker(void) {
 
                         request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
 
+                        if (ftp_virtual_open(request, reply, FTP_FILE_MODE::VirtualWrite)) {
+                            break;
+                        }
+
                         // actually open the file
                         ftp.fd = AP::FS().open((char *)request.data,
                                                (request.opcode == FTP_OP::CreateFile) ? O_WRONLY|O_CREAT|O_TRUNC : O_WRONLY);
@@ -333,19 +353,20 @@ void GCS_MAVLINK::ftp_worker(void) {
                         }
 
                         // must have the file in write mode
-                        if ((ftp.mode != FTP_FILE_MODE::Write)) {
+                        if (ftp.mode != FTP_FILE_MODE::Write && ftp.mode != FTP_FILE_MODE::VirtualWrite) {
                             ftp_error(reply, FTP_ERROR::Fail);
                             break;
                         }
 
                         // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
+                        if (ftp.mode == FTP_FILE_MODE::Write &&
+                            AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
                             ftp_error(reply, FTP_ERROR::FailErrno);
                             break;
                         }
 
                         // fill the buffer
-                        const ssize_t write_bytes = AP::FS().write(ftp.fd, request.data, request.size);
+                        const ssize_t write_bytes = ftp_write(request.data, request.size, request.offset);
                         if (write_bytes == -1) {
                             ftp_error(reply, FTP_ERROR::FailErrno);
                             break;
@@ -443,22 +464,37 @@ void GCS_MAVLINK::ftp_worker(void) {
                         }
 
                         // must have the file in read mode
-                        if ((ftp.mode != FTP_FILE_MODE::Read)) {
+                        if (ftp.mode != FTP_FILE_MODE::Read && ftp.mode != FTP_FILE_MODE::VirtualRead) {
                             ftp_error(reply, FTP_ERROR::Fail);
                             break;
                         }
 
                         // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
+                        if (ftp.mode == FTP_FILE_MODE::Read &&
+                            AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
                             ftp_error(reply, FTP_ERROR::FailErrno);
                             break;
                         }
 
+                        /*
+                          send transfer_size chunks. While the burst is
+                          running a GCS can acknowledge what it has
+                          received with a BurstReadFile request that has
+                          burst_complete set, which slides the window on
+                          past that offset, by transfer_size chunks or by
+                          a uint32_t window in bytes given as its data.
+                          With a window larger than the bandwidth delay
+                          product this keeps the link full however long
+                          the round trip. Any other request ends the
+                          burst
+                         */
                         bool more_pending = true;
                         const uint32_t transfer_size = 100;
-                        for (uint32_t i = 0; (i < transfer_size) && more_pending; i++) {
+                        uint32_t offset = request.offset;
+                        uint32_t window_end = offset + transfer_size * sizeof(reply.data);
+                        while (more_pending) {
                             // fill the buffer
-                            const ssize_t read_bytes = AP::FS().read(ftp.fd, reply.data, sizeof(reply.data));
+                            const ssize_t read_bytes = ftp_read(reply.data, sizeof(reply.data), offset);
                             if (read_bytes == -1) {
                                 ftp_error(reply, FTP_ERROR::FailErrno);
                                 more_pending = false;
@@ -477,14 +513,37 @@ void GCS_MAVLINK::ftp_worker(void) {
                             }
 
                             reply.opcode = FTP_OP::Ack;
-                            reply.offset = request.offset + i * sizeof(reply.data);
-                            reply.burst_complete = (i == (transfer_size - 1));
+                            reply.offset = offset;
+                            reply.burst_complete = (offset + read_bytes >= window_end);
                             reply.size = (uint8_t)read_bytes;
 
                             ftp_push_replies(reply);
 
                             // prep the reply to be used again
                             reply.seq_number++;
+                            offset += read_bytes;
+
+                            // slide the window on any acknowledgements
+                            pending_ftp next;
+                            while (ftp.requests->peek(next)) {
+                                if (next.opcode != FTP_OP::BurstReadFile ||
+                                    !next.burst_complete ||
+                                    next.session != request.session) {
+                                    // leave it for the main loop
+                                    more_pending = false;
+                                    break;
+                                }
+                                ftp.requests->pop();
+                                uint32_t window = transfer_size * sizeof(reply.data);
+                                if (next.size == sizeof(uint32_t)) {
+                                    memcpy(&window, next.data, sizeof(window));
+                                    window = MIN(window, FTP_BURST_MAX_WINDOW);
+                                }
+                                window_end = MAX(window_end, next.offset + window);
+                            }
+                            if (offset >= window_end) {
+                                more_pending = false;
+                            }
                         }
 
                         break;
@@ -504,6 +563,163 @@ void GCS_MAVLINK::ftp_worker(void) {
     }
 }
 
+/*
+  read from the open file, which for a real file has already been
+  positioned at offset
+ */
+ssize_t GCS_MAVLINK::ftp_read(uint8_t *buf, size_t count, uint32_t offset)
+{
+    if (ftp.mode != FTP_FILE_MODE::VirtualRead) {
+        return AP::FS().read(ftp.fd, buf, count);
+    }
+    if (offset >= ftp.virtual_len) {
+        return 0;
+    }
+    count = MIN(count, ftp.virtual_len - offset);
+    memcpy(buf, &ftp.virtual_data[offset], count);
+    return count;
+}
+
+/*
+  write to the open file, which for a real file has already been
+  positioned at offset
+ */
+ssize_t GCS_MAVLINK::ftp_write(const uint8_t *buf, size_t count, uint32_t offset)
+{
+    if (ftp.mode != FTP_FILE_MODE::VirtualWrite) {
+        return AP::FS().write(ftp.fd, buf, count);
+    }
+    const uint32_t end = offset + count;
+    if (end > FTP_VIRTUAL_MAX_UPLOAD) {
+        errno = ENOSPC;
+        return -1;
+    }
+    if (end > ftp.virtual_size) {
+        // grow the upload buffer in 4k steps
+        const uint32_t new_size = MIN((end + 0xFFFU) & ~0xFFFU, FTP_VIRTUAL_MAX_UPLOAD);
+        uint8_t *new_data = new uint8_t[new_size];
+        if (new_data == nullptr) {
+            errno = ENOMEM;
+            return -1;
+        }
+        if (ftp.virtual_data != nullptr) {
+            memcpy(new_data, ftp.virtual_data, ftp.virtual_len);
+        }
+        delete[] ftp.virtual_data;
+        ftp.virtual_data = new_data;
+        ftp.virtual_size = new_size;
+    }
+    memcpy(&ftp.virtual_data[offset], buf, count);
+    ftp.virtual_len = MAX(ftp.virtual_len, end);
+    return count;
+}
+
+// close the open file
+void GCS_MAVLINK::ftp_close(void)
+{
+    if (ftp.mode == FTP_FILE_MODE::VirtualRead || ftp.mode == FTP_FILE_MODE::VirtualWrite) {
+        ftp_virtual_close();
+    } else {
+        AP::FS().close(ftp.fd);
+    }
+    ftp.fd = -1;
+}
+
+/*
+  open a virtual file if the request names one, returning false
+  otherwise. For reading the file is generated now, so the GCS sees a
+  consistent snapshot
+ */
+bool GCS_MAVLINK::ftp_virtual_open(struct pending_ftp &request, struct pending_ftp &response, FTP_FILE_MODE mode)
+{
+    const char *path = (const char *)request.data;
+    MissionItemProtocol_Waypoints *prot_mission = gcs()._missionitemprotocol_waypoints;
+    if (strcmp(path, FTP_PARAM_FILE) == 0) {
+        ftp.virtual_file = FTP_VIRTUAL_FILE::Param;
+    } else if (strcmp(path, FTP_MISSION_FILE) == 0 && prot_mission != nullptr) {
+        // don't mix with a MISSION_ITEM upload in progress
+        if (prot_mission->receiving) {
+            ftp_error(response, FTP_ERROR::Fail);
+            return true;
+        }
+        ftp.virtual_file = FTP_VIRTUAL_FILE::Mission;
+    } else {
+        return false;
+    }
+
+    ftp.virtual_len = 0;
+    ftp.virtual_size = 0;
+    if (mode == FTP_FILE_MODE::VirtualRead) {
+        uint32_t size;
+        if (ftp.virtual_file == FTP_VIRTUAL_FILE::Param) {
+            size = param_pack(nullptr, 0);
+        } else {
+            size = prot_mission->pack_items(nullptr, 0);
+        }
+        ftp.virtual_data = new uint8_t[size];
+        if (ftp.virtual_data == nullptr) {
+            ftp_error(response, FTP_ERROR::Fail);
+            return true;
+        }
+        ftp.virtual_size = size;
+        if (ftp.virtual_file == FTP_VIRTUAL_FILE::Param) {
+            ftp.virtual_len = param_pack(ftp.virtual_data, size);
+        } else {
+            ftp.virtual_len = prot_mission->pack_items(ftp.virtual_data, size);
+        }
+        if (ftp.virtual_len == 0 || ftp.virtual_len > size) {
+            // changed while we were packing it, or could not be encoded
+            delete[] ftp.virtual_data;
+            ftp.virtual_data = nullptr;
+            ftp.virtual_size = 0;
+            ftp_error(response, FTP_ERROR::Fail);
+            return true;
+        }
+        response.size = sizeof(uint32_t);
+        *((int32_t *)response.data) = (int32_t)ftp.virtual_len;
+    }
+    ftp.fd = FTP_VIRTUAL_FD;
+    ftp.mode = mode;
+    ftp.current_session = request.session;
+    response.opcode = FTP_OP::Ack;
+    return true;
+}
+
+/*
+  close a virtual file, applying an upload. Uploads are checked as a
+  whole before anything is changed
+ */
+void GCS_MAVLINK::ftp_virtual_close(void)
+{
+    if (ftp.mode == FTP_FILE_MODE::VirtualWrite && ftp.virtual_file == FTP_VIRTUAL_FILE::Param) {
+        uint16_t num_set, num_failed;
+        if (ftp.virtual_data == nullptr ||
+            !param_unpack(ftp.virtual_data, ftp.virtual_len, false, num_set, num_failed)) {
+            gcs().send_text(MAV_SEVERITY_WARNING, "Param upload invalid");
+        } else {
+            param_unpack(ftp.virtual_data, ftp.virtual_len, true, num_set, num_failed);
+            gcs().send_text(num_failed ? MAV_SEVERITY_WARNING : MAV_SEVERITY_INFO,
+                            "Param upload: %u set, %u failed", (unsigned)num_set, (unsigned)num_failed);
+        }
+    } else if (ftp.mode == FTP_FILE_MODE::VirtualWrite && ftp.virtual_file == FTP_VIRTUAL_FILE::Mission) {
+        MissionItemProtocol_Waypoints *prot_mission = gcs()._missionitemprotocol_waypoints;
+        MAV_MISSION_RESULT res = MAV_MISSION_ERROR;
+        if (ftp.virtual_data != nullptr && prot_mission != nullptr && !prot_mission->receiving) {
+            res = prot_mission->unpack_items(ftp.virtual_data, ftp.virtual_len, false);
+            if (res == MAV_MISSION_ACCEPTED) {
+                res = prot_mission->unpack_items(ftp.virtual_data, ftp.virtual_len, true);
+            }
+        }
+        if (res != MAV_MISSION_ACCEPTED) {
+            gcs().send_text(MAV_SEVERITY_WARNING, "Mission upload invalid (%u)", (unsigned)res);
+        }
+    }
+    delete[] ftp.virtual_data;
+    ftp.virtual_data = nullptr;
+    ftp.virtual_len = 0;
+    ftp.virtual_size = 0;
+}
+
 // calculates how much string length is needed to fit this in a list response
 int GCS_MAVLINK::gen_dir_entry(char *dest, size_t space, const char *path, const struct dirent * entry) {
     const bool is_file = entry->d_type == DT_REG;
@@ -38,10 +38,19 @@ extern const AP_HAL::HAL& hal;
 
 AP_HAL::UARTDriver	*mavlink_comm_port[MAVLINK_COMM_NUM_BUFFERS];
 bool gcs_alternative_active[MAVLINK_COMM_NUM_BUFFERS];
+uint32_t mavlink_comm_tx_bytes[MAVLINK_COMM_NUM_BUFFERS];
 
 // per-channel lock
 static HAL_Semaphore chan_locks[MAVLINK_COMM_NUM_BUFFERS];
 
+// transmit buffer space reserved for the packet being sent on each
+// channel, filled by comm_send_buffer() while the channel is locked
+static struct {
+    ByteBuffer::IoVec vec[2];
+    uint16_t reserved;
+    uint16_t ofs;
+} tx_reservation[MAVLINK_COMM_NUM_BUFFERS];
+
 mavlink_system_t mavlink_system = {7,1};
 
 // mask of serial ports disabled to allow for SERIAL_CONTROL
@@ -127,7 +136,29 @@ void comm_send_buffer(mavlink_channel_t chan, const uint8_t *buf, uint8_t len)
         // an alternative protocol is active
         return;
     }
+    auto &res = tx_reservation[chan];
+    if (res.reserved != 0) {
+        // copy into the reserved space, which may wrap once
+        uint16_t n = MIN(len, res.reserved - res.ofs);
+        uint32_t ofs = res.ofs;
+        res.ofs += n;
+        mavlink_comm_tx_bytes[chan] += n;
+        if (ofs < res.vec[0].len) {
+            const uint16_t n0 = MIN(n, res.vec[0].len - ofs);
+            memcpy(&res.vec[0].data[ofs], buf, n0);
+            buf += n0;
+            n -= n0;
+            ofs = 0;
+        } else {
+            ofs -= res.vec[0].len;
+        }
+        if (n > 0) {
+            memcpy(&res.vec[1].data[ofs], buf, n);
+        }
+        return;
+    }
     const size_t written = mavlink_comm_port[chan]->write(buf, len);
+    mavlink_comm_tx_bytes[chan] += written;
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
     if (written < len) {
         AP_HAL::panic("Short write on UART: %lu < %u", written, len);
@@ -138,11 +169,21 @@ void comm_send_buffer(mavlink_channel_t chan, const uint8_t *buf, uint8_t len)
 }
 
 /*
-  lock a channel for send
+  lock a channel for send, reserving transmit space for a packet of
+  size bytes if the port supports it
  */
-void comm_send_lock(mavlink_channel_t chan)
+void comm_send_lock(mavlink_channel_t chan, uint16_t size)
 {
     chan_locks[(uint8_t)chan].take_blocking();
+    if (size == 0 || !valid_channel(chan) || gcs_alternative_active[chan] ||
+        mavlink_comm_port[chan] == nullptr) {
+        return;
+    }
+    auto &res = tx_reservation[chan];
+    if (mavlink_comm_port[chan]->write_reserve(res.vec, size)) {
+        res.reserved = size;
+        res.ofs = 0;
+    }
 }
 
 /*
@@ -150,5 +191,12 @@ void comm_send_lock(mavlink_channel_t chan)
  */
 void comm_send_unlock(mavlink_channel_t chan)
 {
+    auto &res = tx_reservation[chan];
+    if (res.reserved != 0) {
+        // commit only what was written so a short packet is never
+        // padded with stale buffer contents
+        mavlink_comm_port[chan]->write_commit(res.ofs);
+        res.reserved = 0;
+    }
     chan_locks[(uint8_t)chan].give();
 }
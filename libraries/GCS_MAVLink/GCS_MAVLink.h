@@ -11,7 +11,9 @@
 
 #define MAVLINK_SEND_UART_BYTES(chan, buf, len) comm_send_buffer(chan, buf, len)
 
-#define MAVLINK_START_UART_SEND(chan, size) comm_send_lock(chan)
+// the size of each packet is known before it is sent, so it is
+// written straight into space reserved in the UART transmit buffer
+#define MAVLINK_START_UART_SEND(chan, size) comm_send_lock(chan, size)
 #define MAVLINK_END_UART_SEND(chan, size) comm_send_unlock(chan)
 
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
@@ -40,10 +42,33 @@
 
 #include "include/mavlink/v2.0/mavlink_types.h"
 
+/*
+  signing uses our own SHA-256 with the API of mavlink_sha256.h, so
+  it can use the hash peripheral where a board has one. See
+  GCS_Signing.cpp
+ */
+#define HAVE_MAVLINK_SHA256
+typedef struct {
+    uint32_t sz[2];
+    uint32_t counter[8];
+    union {
+        uint8_t save_bytes[64];
+        uint32_t save_u32[16];
+    } u;
+    uint32_t start_us;
+    bool hw;
+} mavlink_sha256_ctx;
+void mavlink_sha256_init(mavlink_sha256_ctx *m);
+void mavlink_sha256_update(mavlink_sha256_ctx *m, const void *v, uint32_t len);
+void mavlink_sha256_final_48(mavlink_sha256_ctx *m, uint8_t result[6]);
+
 /// MAVLink stream used for uartA
 extern AP_HAL::UARTDriver	*mavlink_comm_port[MAVLINK_COMM_NUM_BUFFERS];
 extern bool gcs_alternative_active[MAVLINK_COMM_NUM_BUFFERS];
 
+// bytes written to each MAVLink channel, for throughput estimates
+extern uint32_t mavlink_comm_tx_bytes[MAVLINK_COMM_NUM_BUFFERS];
+
 /// MAVLink system definition
 extern mavlink_system_t mavlink_system;
 
@@ -69,8 +94,10 @@ uint16_t comm_get_txspace(mavlink_channel_t chan);
 #define MAVLINK_USE_CONVENIENCE_FUNCTIONS
 #include "include/mavlink/v2.0/ardupilotmega/mavlink.h"
 
-// lock and unlock a channel, for multi-threaded mavlink send
-void comm_send_lock(mavlink_channel_t chan);
+// lock and unlock a channel, for multi-threaded mavlink send. If a
+// size is given then that much transmit buffer is reserved for the
+// packet and the writes until unlock fill it in place
+void comm_send_lock(mavlink_channel_t chan, uint16_t size=0);
 void comm_send_unlock(mavlink_channel_t chan);
 
 #pragma GCC diagnostic pop
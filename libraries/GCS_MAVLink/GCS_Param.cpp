@@ -304,16 +304,15 @@ void GCS_MAVLINK::handle_param_set(const mavlink_message_t &msg)
 
 void GCS_MAVLINK::send_parameter_value(const char *param_name, ap_var_type param_type, float param_value)
 {
-    if (!HAVE_PAYLOAD_SPACE(chan, PARAM_VALUE)) {
-        return;
-    }
-    mavlink_msg_param_value_send(
-        chan,
-        param_name,
-        param_value,
-        mav_param_type(param_type),
-        AP_Param::count_parameters(),
-        -1);
+    mavlink_param_value_t packet{};
+    const uint8_t to_copy = MIN(ARRAY_SIZE(packet.param_id), strlen(param_name));
+    memcpy(packet.param_id, param_name, to_copy);
+    packet.param_value = param_value;
+    packet.param_type = mav_param_type(param_type);
+    packet.param_count = AP_Param::count_parameters();
+    packet.param_index = -1;
+
+    send_reply(ReplyClass::PARAM, MAVLINK_MSG_ID_PARAM_VALUE, (const char *)&packet);
 }
 
 /*
@@ -329,8 +328,15 @@ void GCS::send_parameter_value(const char *param_name, ap_var_type param_type, f
     packet.param_count = AP_Param::count_parameters();
     packet.param_index = -1;
 
-    gcs().send_to_active_channels(MAVLINK_MSG_ID_PARAM_VALUE,
-                                  (const char *)&packet);
+    // the change is a reply to whichever GCS set it, so it is queued
+    // ahead of stream messages on every link
+    for (uint8_t i=0; i<num_gcs(); i++) {
+        const GCS_MAVLINK &c = *chan(i);
+        if (c.is_active()) {
+            c.send_reply(GCS_MAVLINK::ReplyClass::PARAM, MAVLINK_MSG_ID_PARAM_VALUE,
+                         (const char *)&packet);
+        }
+    }
 
     // also log to AP_Logger
     AP_Logger *logger = AP_Logger::get_singleton();
@@ -447,3 +453,237 @@ void GCS_MAVLINK::handle_common_param_message(const mavlink_message_t &msg)
         break;
     }
 }
+
+/*
+  packed parameter file, served by FTP as @PARAM/param.pck and
+  accepted as an upload to the same name
+
+  header:
+    uint16_t magic (0x671B)
+    uint16_t num_params   number of parameters in the file
+    uint16_t total_params number of parameters on the vehicle
+  then for each parameter:
+    uint8_t type:4        ap_var_type, INT8 to FLOAT
+    uint8_t flags:4       zero
+    uint8_t common_len:4  bytes of name shared with the previous parameter
+    uint8_t name_len:4    remaining bytes of name, less one
+    char name[name_len+1]
+    uint8_t value[]       little endian, the size of the type
+
+  No parameter crosses a 256 byte boundary in the file, so a GCS can
+  decode any block it has received. The gap before a boundary is
+  filled with zeros, which is never a valid type.
+ */
+#define PARAM_PACK_MAGIC 0x671B
+#define PARAM_PACK_HEADER_LEN 6
+
+static uint8_t param_pack_value_len(uint8_t type)
+{
+    switch (type) {
+    case AP_PARAM_INT8:
+        return 1;
+    case AP_PARAM_INT16:
+        return 2;
+    case AP_PARAM_INT32:
+    case AP_PARAM_FLOAT:
+        return 4;
+    }
+    return 0;
+}
+
+/*
+  pack all scalar parameters into buf, returning the length of the
+  file. With a null buf only the length is calculated
+ */
+uint32_t GCS_MAVLINK::param_pack(uint8_t *buf, uint32_t size)
+{
+    uint32_t ofs = PARAM_PACK_HEADER_LEN;
+    uint16_t count = 0;
+    char last_name[AP_MAX_NAME_SIZE+1] {};
+    AP_Param::ParamToken token;
+    enum ap_var_type type;
+
+    for (AP_Param *vp = AP_Param::first(&token, &type);
+         vp != nullptr;
+         vp = AP_Param::next_scalar(&token, &type)) {
+        const uint8_t value_len = param_pack_value_len(type);
+        if (value_len == 0) {
+            continue;
+        }
+        char name[AP_MAX_NAME_SIZE+1];
+        vp->copy_name_token(token, name, sizeof(name), true);
+        name[AP_MAX_NAME_SIZE] = 0;
+
+        uint8_t common_len = 0;
+        while (common_len < 15 &&
+               name[common_len] != 0 &&
+               name[common_len] == last_name[common_len]) {
+            common_len++;
+        }
+        uint8_t name_len = strlen(name) - common_len;
+        if (name_len == 0) {
+            // name is a prefix of the last one, at least one byte
+            // must be stored
+            common_len--;
+            name_len = 1;
+        }
+        const uint8_t entry_len = 2 + name_len + value_len;
+
+        if ((ofs & 0xFF) + entry_len > 0x100) {
+            const uint32_t pad = 0x100 - (ofs & 0xFF);
+            if (buf != nullptr) {
+                if (ofs + pad > size) {
+                    break;
+                }
+                memset(&buf[ofs], 0, pad);
+            }
+            ofs += pad;
+        }
+
+        if (buf != nullptr) {
+            if (ofs + entry_len > size) {
+                // parameters were added since the size was found
+                break;
+            }
+            uint8_t *p = &buf[ofs];
+            p[0] = type;
+            p[1] = common_len | ((name_len-1)<<4);
+            memcpy(&p[2], &name[common_len], name_len);
+            p += 2 + name_len;
+            switch (type) {
+            case AP_PARAM_INT8:
+                p[0] = ((AP_Int8 *)vp)->get();
+                break;
+            case AP_PARAM_INT16: {
+                const int16_t v = ((AP_Int16 *)vp)->get();
+                memcpy(p, &v, sizeof(v));
+                break;
+            }
+            case AP_PARAM_INT32: {
+                const int32_t v = ((AP_Int32 *)vp)->get();
+                memcpy(p, &v, sizeof(v));
+                break;
+            }
+            default: {
+                const float v = ((AP_Float *)vp)->get();
+                memcpy(p, &v, sizeof(v));
+                break;
+            }
+            }
+        }
+        ofs += entry_len;
+        count++;
+        memcpy(last_name, name, sizeof(last_name));
+    }
+
+    if (buf != nullptr && size >= PARAM_PACK_HEADER_LEN) {
+        const uint16_t header[3] { PARAM_PACK_MAGIC, count, AP_Param::count_parameters() };
+        memcpy(buf, header, sizeof(header));
+    }
+    return ofs;
+}
+
+/*
+  check a packed parameter file, and set and save its parameters if
+  apply is true. Returns false if the file is malformed
+ */
+bool GCS_MAVLINK::param_unpack(const uint8_t *buf, uint32_t len, bool apply,
+                               uint16_t &num_set, uint16_t &num_failed)
+{
+    num_set = 0;
+    num_failed = 0;
+
+    uint16_t header[3];
+    if (len < PARAM_PACK_HEADER_LEN) {
+        return false;
+    }
+    memcpy(header, buf, sizeof(header));
+    if (header[0] != PARAM_PACK_MAGIC) {
+        return false;
+    }
+
+    uint32_t ofs = PARAM_PACK_HEADER_LEN;
+    char name[AP_MAX_NAME_SIZE+1] {};
+    for (uint16_t i=0; i<header[1]; i++) {
+        // skip padding before a block boundary
+        while (ofs < len && buf[ofs] == 0) {
+            ofs++;
+        }
+        if (ofs + 2 > len) {
+            return false;
+        }
+        const uint8_t type = buf[ofs] & 0x0F;
+        const uint8_t common_len = buf[ofs+1] & 0x0F;
+        const uint8_t name_len = (buf[ofs+1] >> 4) + 1;
+        const uint8_t value_len = param_pack_value_len(type);
+        if (value_len == 0 ||
+            common_len > strlen(name) ||
+            common_len + name_len > AP_MAX_NAME_SIZE ||
+            ofs + 2 + name_len + value_len > len) {
+            return false;
+        }
+        memcpy(&name[common_len], &buf[ofs+2], name_len);
+        name[common_len+name_len] = 0;
+
+        const uint8_t *p = &buf[ofs+2+name_len];
+        float value;
+        switch (type) {
+        case AP_PARAM_INT8:
+            value = (int8_t)p[0];
+            break;
+        case AP_PARAM_INT16: {
+            int16_t v;
+            memcpy(&v, p, sizeof(v));
+            value = v;
+            break;
+        }
+        case AP_PARAM_INT32: {
+            int32_t v;
+            memcpy(&v, p, sizeof(v));
+            value = v;
+            break;
+        }
+        default:
+            memcpy(&value, p, sizeof(value));
+            break;
+        }
+        ofs += 2 + name_len + value_len;
+
+        if (!apply) {
+            continue;
+        }
+        if (param_set_packed(name, value)) {
+            num_set++;
+        } else {
+            num_failed++;
+        }
+    }
+    return true;
+}
+
+/*
+  set and save a parameter from a packed parameter upload, as
+  handle_param_set() does for PARAM_SET
+ */
+bool GCS_MAVLINK::param_set_packed(const char *name, float value)
+{
+    enum ap_var_type var_type;
+    uint16_t parameter_flags = 0;
+    AP_Param *vp = AP_Param::find(name, &var_type, &parameter_flags);
+    if (vp == nullptr) {
+        return false;
+    }
+    if ((parameter_flags & AP_PARAM_FLAG_INTERNAL_USE_ONLY) || vp->is_read_only()) {
+        return false;
+    }
+
+    const float old_value = vp->cast_to_float(var_type);
+    vp->set_float(value, var_type);
+    vp->save(!is_equal(value, old_value));
+
+    AP_Logger *logger = AP_Logger::get_singleton();
+    if (logger != nullptr) {
+        logger->Write_Parameter(name, vp->cast_to_float(var_type));
+    }
+    return true;
+}
@@ -265,3 +265,216 @@ uint8_t GCS_MAVLINK::packet_overhead_chan(mavlink_channel_t chan)
     return MAVLINK_NUM_NON_PAYLOAD_BYTES + reserved_space;
 }
 
+
+/*
+  SHA-256 for signing, replacing the one in mavlink_sha256.h. Only the
+  first 48 bits of the hash are needed.
+
+  The secret key is 32 bytes, half a SHA-256 block, so hashing it
+  alone never completes a block and there is no compressed key state
+  to carry between packets. The cost is in the one or two blocks per
+  packet, which are done here with a rolling message schedule, or by
+  the HASH peripheral on MCUs that have SHA-256 in hardware.
+ */
+#ifndef HAL_MAVLINK_HW_HASH
+#if CONFIG_HAL_BOARD == HAL_BOARD_CHIBIOS && (defined(STM32F437xx) || defined(STM32F439xx) || \
+                                              defined(STM32F756xx) || defined(STM32F777xx) || defined(STM32F779xx))
+#define HAL_MAVLINK_HW_HASH 1
+#else
+#define HAL_MAVLINK_HW_HASH 0
+#endif
+#endif
+
+#if HAL_MAVLINK_HW_HASH
+#include <hal.h>
+
+// the peripheral holds one hash at a time; a packet signed while it
+// is busy is hashed in software
+static HAL_Semaphore hw_hash_sem;
+static bool hw_hash_enabled;
+#endif
+
+// packets hashed and the time spent doing it
+static uint32_t sha256_count;
+static uint32_t sha256_time_us;
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t sha256_rotr(uint32_t x, uint8_t n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+/*
+  compress the 64 byte block in m->u, keeping only the 16 words of
+  the message schedule that are live
+ */
+static void sha256_block(mavlink_sha256_ctx *m)
+{
+    uint32_t w[16];
+    for (uint8_t i=0; i<16; i++) {
+        w[i] = __builtin_bswap32(m->u.save_u32[i]);
+    }
+    uint32_t a = m->counter[0], b = m->counter[1], c = m->counter[2], d = m->counter[3];
+    uint32_t e = m->counter[4], f = m->counter[5], g = m->counter[6], h = m->counter[7];
+    for (uint8_t i=0; i<64; i++) {
+        if (i >= 16) {
+            const uint32_t w15 = w[(i+1) & 15];
+            const uint32_t w2 = w[(i+14) & 15];
+            w[i & 15] += (sha256_rotr(w2, 17) ^ sha256_rotr(w2, 19) ^ (w2 >> 10)) + w[(i+9) & 15] +
+                (sha256_rotr(w15, 7) ^ sha256_rotr(w15, 18) ^ (w15 >> 3));
+        }
+        const uint32_t t1 = h + (sha256_rotr(e, 6) ^ sha256_rotr(e, 11) ^ sha256_rotr(e, 25)) +
+            ((e & f) ^ (~e & g)) + sha256_k[i] + w[i & 15];
+        const uint32_t t2 = (sha256_rotr(a, 2) ^ sha256_rotr(a, 13) ^ sha256_rotr(a, 22)) +
+            ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    m->counter[0] += a;
+    m->counter[1] += b;
+    m->counter[2] += c;
+    m->counter[3] += d;
+    m->counter[4] += e;
+    m->counter[5] += f;
+    m->counter[6] += g;
+    m->counter[7] += h;
+}
+
+void mavlink_sha256_init(mavlink_sha256_ctx *m)
+{
+    m->start_us = AP_HAL::micros();
+    m->sz[0] = 0;
+    m->sz[1] = 0;
+#if HAL_MAVLINK_HW_HASH
+    m->hw = hw_hash_sem.take_nonblocking();
+    if (m->hw) {
+        if (!hw_hash_enabled) {
+            rccEnableAHB2(RCC_AHB2ENR_HASHEN, true);
+            hw_hash_enabled = true;
+        }
+        // SHA-256 of a byte stream
+        HASH->CR = HASH_CR_ALGO_1 | HASH_CR_ALGO_0 | HASH_CR_DATATYPE_1 | HASH_CR_INIT;
+        return;
+    }
+#else
+    m->hw = false;
+#endif
+    m->counter[0] = 0x6a09e667;
+    m->counter[1] = 0xbb67ae85;
+    m->counter[2] = 0x3c6ef372;
+    m->counter[3] = 0xa54ff53a;
+    m->counter[4] = 0x510e527f;
+    m->counter[5] = 0x9b05688c;
+    m->counter[6] = 0x1f83d9ab;
+    m->counter[7] = 0x5be0cd19;
+}
+
+void mavlink_sha256_update(mavlink_sha256_ctx *m, const void *v, uint32_t len)
+{
+    const uint8_t *p = (const uint8_t *)v;
+    uint32_t offset = m->sz[0] % 64;
+    m->sz[0] += len;
+    if (m->sz[0] < len) {
+        m->sz[1]++;
+    }
+#if HAL_MAVLINK_HW_HASH
+    if (m->hw) {
+        // the peripheral takes whole words, so odd bytes wait in
+        // save_bytes until the rest of the word arrives
+        offset %= 4;
+        while (len > 0) {
+            m->u.save_bytes[offset++] = *p++;
+            len--;
+            if (offset == 4) {
+                HASH->DIN = m->u.save_u32[0];
+                offset = 0;
+            }
+        }
+        return;
+    }
+#endif
+    while (len > 0) {
+        const uint32_t n = MIN(len, 64 - offset);
+        memcpy(&m->u.save_bytes[offset], p, n);
+        offset += n;
+        p += n;
+        len -= n;
+        if (offset == 64) {
+            sha256_block(m);
+            offset = 0;
+        }
+    }
+}
+
+/*
+  get first 48 bits of final sha256 hash
+ */
+void mavlink_sha256_final_48(mavlink_sha256_ctx *m, uint8_t result[6])
+{
+#if HAL_MAVLINK_HW_HASH
+    if (m->hw) {
+        const uint8_t nbytes = m->sz[0] % 4;
+        if (nbytes != 0) {
+            HASH->DIN = m->u.save_u32[0];
+        }
+        HASH->SR = 0;
+        HASH->STR = 8 * nbytes;
+        HASH->STR = (8 * nbytes) | HASH_STR_DCAL;
+        while ((HASH->SR & HASH_SR_DCIS) == 0) {
+        }
+        m->counter[0] = HASH_DIGEST->HR[0];
+        m->counter[1] = HASH_DIGEST->HR[1];
+        hw_hash_sem.give();
+    } else
+#endif
+    {
+        // pad with 0x80, zeros, then the length in bits, big-endian
+        const uint32_t offset = m->sz[0] % 64;
+        const uint32_t pad_len = (offset < 56 ? 56 : 120) - offset;
+        uint8_t pad[72] {};
+        pad[0] = 0x80;
+        const uint32_t bits_hi = (m->sz[1] << 3) | (m->sz[0] >> 29);
+        const uint32_t bits_lo = m->sz[0] << 3;
+        for (uint8_t i=0; i<4; i++) {
+            pad[pad_len+i] = bits_hi >> (24 - 8*i);
+            pad[pad_len+4+i] = bits_lo >> (24 - 8*i);
+        }
+        mavlink_sha256_update(m, pad, pad_len + 8);
+    }
+
+    result[0] = m->counter[0] >> 24;
+    result[1] = m->counter[0] >> 16;
+    result[2] = m->counter[0] >> 8;
+    result[3] = m->counter[0];
+    result[4] = m->counter[1] >> 24;
+    result[5] = m->counter[1] >> 16;
+
+    sha256_count++;
+    sha256_time_us += AP_HAL::micros() - m->start_us;
+}
+
+/*
+  return the number of packets hashed for signing and the time spent
+  hashing them
+ */
+void GCS_MAVLINK::get_signing_hash_stats(uint32_t &count, uint32_t &time_us)
+{
+    count = sha256_count;
+    time_us = sha256_time_us;
+}
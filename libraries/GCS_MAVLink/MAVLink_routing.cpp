@@ -27,7 +27,11 @@ extern const AP_HAL::HAL& hal;
 #define ROUTING_DEBUG 0
 
 // constructor
-MAVLink_routing::MAVLink_routing(void) : num_routes(0) {}
+MAVLink_routing::MAVLink_routing(void) : num_routes(0)
+{
+    memset(routes, 0, sizeof(routes));
+    memset(sysid_channels, 0, sizeof(sysid_channels));
+}
 
 /*
   forward a MAVLink message to the right port. This also
@@ -134,43 +138,45 @@ bool MAVLink_routing::check_and_forward(mavlink_channel_t in_channel, const mavl
         return true;
     }
 
-    // forward on any channels matching the targets
-    bool forwarded = false;
-    bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS];
-    memset(sent_to_chan, 0, sizeof(sent_to_chan));
-    for (uint8_t i=0; i<num_routes; i++) {
-    
-        // Skip if channel is private and the target system or component IDs do not match
-        if ((GCS_MAVLINK::is_private(routes[i].channel)) &&
-            (target_system != routes[i].sysid ||
-             target_component != routes[i].compid)) {
-            continue;
+    // the channels the exact target has been seen on; private
+    // channels only get messages for a route seen on them
+    uint8_t exact_channels = 0;
+    if (target_system > 0 && target_component >= 0) {
+        const struct route *r = find_route(target_system, target_component);
+        if (r != nullptr) {
+            exact_channels = r->channels;
         }
+    }
 
-        if (broadcast_system || (target_system == routes[i].sysid &&
-                                 (broadcast_component || 
-                                  target_component == routes[i].compid ||
-                                  !match_system))) {
-
-            if (in_channel != routes[i].channel && !sent_to_chan[routes[i].channel]) {
-                
-                if (comm_get_txspace(routes[i].channel) >= ((uint16_t)msg.len) +
-                    GCS_MAVLINK::packet_overhead_chan(routes[i].channel)) {
-#if ROUTING_DEBUG
-                    ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
-                             msg.msgid,
-                             (unsigned)in_channel,
-                             (unsigned)routes[i].channel,
-                             (int)target_system,
-                             (int)target_component);
-#endif
-                    _mavlink_resend_uart(routes[i].channel, &msg);
-                }
-                sent_to_chan[routes[i].channel] = true;
-                forwarded = true;
-            }
+    // forward on any channels matching the targets
+    uint8_t channels;
+    if (broadcast_system) {
+        channels = route_channels;
+    } else if (broadcast_component || !match_system) {
+        channels = sysid_channels[target_system];
+    } else {
+        channels = exact_channels;
+    }
+    channels &= ~(1U<<(in_channel-MAVLINK_COMM_0));
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if ((channels & (1U<<i)) &&
+            GCS_MAVLINK::is_private((mavlink_channel_t)(MAVLINK_COMM_0 + i)) &&
+            !(exact_channels & (1U<<i))) {
+            channels &= ~(1U<<i);
         }
     }
+#if ROUTING_DEBUG
+    if (channels != 0) {
+        ::printf("fwd msg %u from chan %u on mask 0x%x sysid=%d compid=%d\n",
+                 msg.msgid,
+                 (unsigned)in_channel,
+                 (unsigned)channels,
+                 (int)target_system,
+                 (int)target_component);
+    }
+#endif
+    forward(channels, msg);
+    const bool forwarded = channels != 0;
 
     if (!forwarded && match_system) {
         process_locally = true;
@@ -195,29 +201,23 @@ void MAVLink_routing::send_to_components(uint32_t msgid, const char *pkt, uint8_
 
 void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entry_t *entry, const uint8_t pkt_len)
 {
-    bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS] {};
-
     // check learned routes
-    for (uint8_t i=0; i<num_routes; i++) {
-        if (routes[i].sysid != mavlink_system.sysid) {
+    const uint8_t channels = sysid_channels[mavlink_system.sysid];
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if (!(channels & (1U<<i))) {
             // our system ID hasn't been seen on this link
             continue;
         }
-        if (sent_to_chan[routes[i].channel]) {
-            // we've already send it on this link
-            continue;
-        }
-        if (comm_get_txspace(routes[i].channel) <
-            ((uint16_t)entry->max_msg_len) + GCS_MAVLINK::packet_overhead_chan(routes[i].channel)) {
+        const mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
+        if (comm_get_txspace(channel) <
+            ((uint16_t)entry->max_msg_len) + GCS_MAVLINK::packet_overhead_chan(channel)) {
             // it doesn't fit on this channel
             continue;
         }
 #if ROUTING_DEBUG
-        ::printf("send msg %u on chan %u sysid=%u compid=%u\n",
-                 msg.msgid,
-                 (unsigned)routes[i].channel,
-                 (unsigned)routes[i].sysid,
-                 (unsigned)routes[i].compid);
+        ::printf("send msg %u on chan %u\n",
+                 (unsigned)entry->msgid,
+                 (unsigned)channel);
 #endif
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
         if (entry->max_msg_len > pkt_len) {
@@ -225,13 +225,12 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
                           entry->max_msg_len, pkt_len);
         }
 #endif
-        _mav_finalize_message_chan_send(routes[i].channel,
+        _mav_finalize_message_chan_send(channel,
                                         entry->msgid,
                                         pkt,
                                         entry->min_msg_len,
                                         MIN(entry->max_msg_len, pkt_len),
                                         entry->crc_extra);
-        sent_to_chan[routes[i].channel] = true;
     }
 }
 
@@ -242,11 +241,11 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
 bool MAVLink_routing::find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &compid, mavlink_channel_t &channel)
 {
     // check learned routes
-    for (uint8_t i=0; i<num_routes; i++) {
-        if (routes[i].mavtype == mavtype) {
+    for (uint8_t i=0; i<MAVLINK_ROUTE_HASH_SIZE; i++) {
+        if (routes[i].channels != 0 && routes[i].mavtype == mavtype) {
             sysid = routes[i].sysid;
             compid = routes[i].compid;
-            channel = routes[i].channel;
+            channel = (mavlink_channel_t)(MAVLINK_COMM_0 + __builtin_ctz(routes[i].channels));
             return true;
         }
     }
@@ -255,35 +254,148 @@ bool MAVLink_routing::find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &
     return false;
 }
 
+void MAVLink_routing::get_forward_counts(mavlink_channel_t chan, uint32_t &forwarded, uint32_t &dropped) const
+{
+    const uint8_t i = chan - MAVLINK_COMM_0;
+    if (i >= MAVLINK_COMM_NUM_BUFFERS) {
+        forwarded = dropped = 0;
+        return;
+    }
+    forwarded = forward_counts[i].forwarded;
+    dropped = forward_counts[i].dropped;
+}
+
+uint8_t MAVLink_routing::route_hash(uint8_t sysid, uint8_t compid)
+{
+    return (sysid * 67U + compid) & (MAVLINK_ROUTE_HASH_SIZE-1);
+}
+
+const struct MAVLink_routing::route *MAVLink_routing::find_route(uint8_t sysid, uint8_t compid) const
+{
+    // the table always has free slots, so this ends
+    for (uint8_t i=route_hash(sysid, compid); routes[i].channels != 0; i=(i+1) & (MAVLINK_ROUTE_HASH_SIZE-1)) {
+        if (routes[i].sysid == sysid && routes[i].compid == compid) {
+            return &routes[i];
+        }
+    }
+    return nullptr;
+}
+
+struct MAVLink_routing::route *MAVLink_routing::find_route(uint8_t sysid, uint8_t compid)
+{
+    return const_cast<struct route *>(static_cast<const MAVLink_routing *>(this)->find_route(sysid, compid));
+}
+
+/*
+  remove the route in slot idx, moving later routes in its probe
+  sequence back so they can still be found
+ */
+void MAVLink_routing::remove_route(uint8_t idx)
+{
+    routes[idx].channels = 0;
+    num_routes--;
+    uint8_t i = idx;
+    while (true) {
+        i = (i+1) & (MAVLINK_ROUTE_HASH_SIZE-1);
+        if (routes[i].channels == 0) {
+            break;
+        }
+        const uint8_t home = route_hash(routes[i].sysid, routes[i].compid);
+        // move it if its home slot is not between the hole and it
+        if (((i - home) & (MAVLINK_ROUTE_HASH_SIZE-1)) >= ((i - idx) & (MAVLINK_ROUTE_HASH_SIZE-1))) {
+            routes[idx] = routes[i];
+            routes[i].channels = 0;
+            idx = i;
+        }
+    }
+}
+
+bool MAVLink_routing::remove_stale_route(uint32_t now_ms)
+{
+    int16_t oldest = -1;
+    uint32_t oldest_age_ms = MAVLINK_ROUTE_MAX_AGE_MS;
+    for (uint8_t i=0; i<MAVLINK_ROUTE_HASH_SIZE; i++) {
+        if (routes[i].channels == 0) {
+            continue;
+        }
+        const uint32_t age_ms = now_ms - routes[i].last_seen_ms;
+        if (age_ms > oldest_age_ms) {
+            oldest = i;
+            oldest_age_ms = age_ms;
+        }
+    }
+    if (oldest == -1) {
+        return false;
+    }
+#if ROUTING_DEBUG
+    ::printf("forgot route %u %u\n",
+             (unsigned)routes[oldest].sysid,
+             (unsigned)routes[oldest].compid);
+#endif
+    remove_route(oldest);
+    update_channel_masks();
+    return true;
+}
+
+// rebuild the channel masks after a route has been removed
+void MAVLink_routing::update_channel_masks()
+{
+    memset(sysid_channels, 0, sizeof(sysid_channels));
+    route_channels = 0;
+    for (uint8_t i=0; i<MAVLINK_ROUTE_HASH_SIZE; i++) {
+        sysid_channels[routes[i].sysid] |= routes[i].channels;
+        route_channels |= routes[i].channels;
+    }
+}
+
+void MAVLink_routing::forward(uint8_t mask, const mavlink_message_t &msg)
+{
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if (!(mask & (1U<<i))) {
+            continue;
+        }
+        const mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
+        if (comm_get_txspace(channel) >= ((uint16_t)msg.len) +
+            GCS_MAVLINK::packet_overhead_chan(channel)) {
+            _mavlink_resend_uart(channel, &msg);
+            forward_counts[i].forwarded++;
+        } else {
+            forward_counts[i].dropped++;
+        }
+    }
+}
+
 /*
   see if the message is for a new route and learn it
 */
 void MAVLink_routing::learn_route(mavlink_channel_t in_channel, const mavlink_message_t &msg)
 {
-    uint8_t i;
     if (msg.sysid == 0 ||
         (msg.sysid == mavlink_system.sysid &&
          msg.compid == mavlink_system.compid)) {
         return;
     }
-    for (i=0; i<num_routes; i++) {
-        if (routes[i].sysid == msg.sysid &&
-            routes[i].compid == msg.compid &&
-            routes[i].channel == in_channel) {
-            if (routes[i].mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
-            }
-            break;
+    const uint32_t now_ms = AP_HAL::millis();
+    struct route *r = find_route(msg.sysid, msg.compid);
+    if (r == nullptr) {
+        if (num_routes >= MAVLINK_MAX_ROUTES && !remove_stale_route(now_ms)) {
+            return;
         }
-    }
-    if (i == num_routes && i<MAVLINK_MAX_ROUTES) {
-        routes[i].sysid = msg.sysid;
-        routes[i].compid = msg.compid;
-        routes[i].channel = in_channel;
-        if (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-            routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
+        uint8_t i = route_hash(msg.sysid, msg.compid);
+        while (routes[i].channels != 0) {
+            i = (i+1) & (MAVLINK_ROUTE_HASH_SIZE-1);
         }
+        r = &routes[i];
+        r->sysid = msg.sysid;
+        r->compid = msg.compid;
+        r->mavtype = 0;
         num_routes++;
+    }
+    const uint8_t mask = 1U<<(in_channel-MAVLINK_COMM_0);
+    if (!(r->channels & mask)) {
+        r->channels |= mask;
+        sysid_channels[msg.sysid] |= mask;
+        route_channels |= mask;
 #if ROUTING_DEBUG
         ::printf("learned route %u %u via %u\n",
                  (unsigned)msg.sysid,
@@ -291,6 +403,10 @@ void MAVLink_routing::learn_route(mavlink_channel_t in_channel, const mavlink_me
                  (unsigned)in_channel);
 #endif
     }
+    if (r->mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        r->mavtype = mavlink_msg_heartbeat_get_type(&msg);
+    }
+    r->last_seen_ms = now_ms;
 }
 
 
@@ -311,10 +427,9 @@ void MAVLink_routing::handle_heartbeat(mavlink_channel_t in_channel, const mavli
     mask &= ~no_route_mask;
     
     // mask out channels that are known sources for this sysid/compid
-    for (uint8_t i=0; i<num_routes; i++) {
-        if (routes[i].sysid == msg.sysid && routes[i].compid == msg.compid) {
-            mask &= ~(1U<<((unsigned)(routes[i].channel-MAVLINK_COMM_0)));
-        }
+    const struct route *r = find_route(msg.sysid, msg.compid);
+    if (r != nullptr) {
+        mask &= ~r->channels;
     }
 
     if (mask == 0) {
@@ -323,22 +438,14 @@ void MAVLink_routing::handle_heartbeat(mavlink_channel_t in_channel, const mavli
     }
 
     // send on the remaining channels
-    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
-        if (mask & (1U<<i)) {
-            mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
-            if (comm_get_txspace(channel) >= ((uint16_t)msg.len) +
-                GCS_MAVLINK::packet_overhead_chan(channel)) {
 #if ROUTING_DEBUG
-                ::printf("fwd HB from chan %u on chan %u from sysid=%u compid=%u\n",
-                         (unsigned)in_channel,
-                         (unsigned)channel,
-                         (unsigned)msg.sysid,
-                         (unsigned)msg.compid);
+    ::printf("fwd HB from chan %u on mask 0x%x from sysid=%u compid=%u\n",
+             (unsigned)in_channel,
+             (unsigned)mask,
+             (unsigned)msg.sysid,
+             (unsigned)msg.compid);
 #endif
-                _mavlink_resend_uart(channel, &msg);
-            }
-        }
-    }
+    forward(mask, msg);
 }
 
 
@@ -6,9 +6,22 @@
 #include <AP_Common/AP_Common.h>
 #include "GCS_MAVLink.h"
 
-// 20 routes should be enough for now. This may need to increase as
-// we make more extensive use of MAVLink forwarding
-#define MAVLINK_MAX_ROUTES 20
+// maximum number of sysid/compid pairs routes are kept for. Each is
+// counted once however many channels it has been seen on
+#ifndef MAVLINK_MAX_ROUTES
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_300
+#define MAVLINK_MAX_ROUTES 64
+#else
+#define MAVLINK_MAX_ROUTES 32
+#endif
+#endif
+
+// routes are kept in a hash table with at least half its slots free
+#define MAVLINK_ROUTE_HASH_SIZE (2*MAVLINK_MAX_ROUTES)
+
+// when the table is full a route not seen for this long is replaced
+// by a new one
+#define MAVLINK_ROUTE_MAX_AGE_MS 30000
 
 /*
   object to handle MAVLink packet routing
@@ -44,20 +57,54 @@ public:
      */
     bool find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &compid, mavlink_channel_t &channel);
 
+    // number of packets forwarded out of a channel, and not forwarded
+    // for lack of space
+    void get_forward_counts(mavlink_channel_t chan, uint32_t &forwarded, uint32_t &dropped) const;
+
 private:
-    // a simple linear routing table. We don't expect to have a lot of
-    // routes, so a scalable structure isn't worthwhile yet.
+    static_assert((MAVLINK_ROUTE_HASH_SIZE & (MAVLINK_ROUTE_HASH_SIZE-1)) == 0, "route hash size must be a power of 2");
+    static_assert(MAVLINK_ROUTE_HASH_SIZE <= 256, "route hash index must fit in uint8_t");
+    static_assert(MAVLINK_COMM_NUM_BUFFERS <= 8, "channel masks must fit in uint8_t");
+
+    // routing table, an open addressing hash of sysid/compid with
+    // linear probing
     uint8_t num_routes;
     struct route {
         uint8_t sysid;
         uint8_t compid;
-        mavlink_channel_t channel;
+        // mask of channels this sysid/compid has been seen on, zero
+        // for an empty slot
+        uint8_t channels;
         uint8_t mavtype;
-    } routes[MAVLINK_MAX_ROUTES];
-    
+        uint32_t last_seen_ms;
+    } routes[MAVLINK_ROUTE_HASH_SIZE];
+
+    // mask of channels each sysid has been seen on, and of all
+    // channels with any route
+    uint8_t sysid_channels[256];
+    uint8_t route_channels;
+
+    struct {
+        uint32_t forwarded;
+        uint32_t dropped;
+    } forward_counts[MAVLINK_COMM_NUM_BUFFERS];
+
     // a channel mask to block routing as required
     uint8_t no_route_mask;
-    
+
+    static uint8_t route_hash(uint8_t sysid, uint8_t compid);
+    // return the route for sysid/compid, or nullptr if not known
+    struct route *find_route(uint8_t sysid, uint8_t compid);
+    const struct route *find_route(uint8_t sysid, uint8_t compid) const;
+    // remove the least recently seen route if it is older than
+    // MAVLINK_ROUTE_MAX_AGE_MS, returning true if one was removed
+    bool remove_stale_route(uint32_t now_ms);
+    void remove_route(uint8_t idx);
+    void update_channel_masks();
+
+    // send msg on the channels in mask, counting it as forwarded
+    void forward(uint8_t mask, const mavlink_message_t &msg);
+
     // learn new routes
     void learn_route(mavlink_channel_t in_channel, const mavlink_message_t &msg);
 
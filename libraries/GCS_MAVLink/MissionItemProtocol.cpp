@@ -292,11 +292,7 @@ void MissionItemProtocol::send_mission_ack(const GCS_MAVLINK &_link,
                                            const mavlink_message_t &msg,
                                            MAV_MISSION_RESULT result) const
 {
-    mavlink_msg_mission_ack_send(_link.get_chan(),
-                                 msg.sysid,
-                                 msg.compid,
-                                 result,
-                                 mission_type());
+    _link.send_mission_ack(msg, mission_type(), result);
 }
 
 /**
@@ -339,11 +335,12 @@ void MissionItemProtocol::update()
     if (tnow - timelast_receive_ms > upload_timeout_ms) {
         receiving = false;
         timeout();
-        mavlink_msg_mission_ack_send(link->get_chan(),
-                                     dest_sysid,
-                                     dest_compid,
-                                     MAV_MISSION_OPERATION_CANCELLED,
-                                     mission_type());
+        mavlink_mission_ack_t packet {};
+        packet.target_system = dest_sysid;
+        packet.target_component = dest_compid;
+        packet.type = MAV_MISSION_OPERATION_CANCELLED;
+        packet.mission_type = mission_type();
+        link->send_reply(GCS_MAVLINK::ReplyClass::ACK, MAVLINK_MSG_ID_MISSION_ACK, (const char *)&packet);
         link = nullptr;
         free_upload_resources();
         return;
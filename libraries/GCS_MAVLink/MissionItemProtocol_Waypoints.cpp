@@ -138,3 +138,104 @@ void MissionItemProtocol_Waypoints::truncate(const mavlink_mission_count_t &pack
     // new mission arriving, truncate mission to be the same length
     mission.truncate(packet.count);
 }
+
+/*
+  the packed mission file is a header followed by num_items
+  MISSION_ITEM_INT payloads in MAVLink wire format, with item 0 being
+  home. The payload is the leading bytes of the message structure, as
+  MAVLink orders fields so any padding comes at the end
+ */
+#define MISSION_FILE_MAGIC 0x763d
+#define MISSION_FILE_ITEM_LEN MAVLINK_MSG_ID_MISSION_ITEM_INT_LEN
+
+uint32_t MissionItemProtocol_Waypoints::pack_items(uint8_t *buf, uint32_t size) const
+{
+    WITH_SEMAPHORE(mission.get_semaphore());
+
+    const uint16_t num_items = MAX(mission.num_commands(), 1U);
+    const uint32_t len = sizeof(mission_file_header) + num_items * MISSION_FILE_ITEM_LEN;
+    if (buf == nullptr || size < len) {
+        return len;
+    }
+
+    mission_file_header hdr {};
+    hdr.magic = MISSION_FILE_MAGIC;
+    hdr.mission_type = MAV_MISSION_TYPE_MISSION;
+    hdr.num_items = num_items;
+    memcpy(buf, &hdr, sizeof(hdr));
+
+    uint8_t *items = &buf[sizeof(hdr)];
+    for (uint16_t i=0; i<num_items; i++) {
+        AP_Mission::Mission_Command cmd;
+        mavlink_mission_item_int_t item {};
+        if (!mission.read_cmd_from_storage(i, cmd) ||
+            !AP_Mission::mission_cmd_to_mavlink_int(cmd, item)) {
+            return 0;
+        }
+        item.seq = i;
+        item.command = cmd.id;
+        item.autocontinue = 1;
+        item.mission_type = MAV_MISSION_TYPE_MISSION;
+        memcpy(&items[i*MISSION_FILE_ITEM_LEN], &item, MISSION_FILE_ITEM_LEN);
+    }
+    return len;
+}
+
+MAV_MISSION_RESULT MissionItemProtocol_Waypoints::unpack_items(const uint8_t *buf, uint32_t len, bool apply)
+{
+    mission_file_header hdr;
+    if (len < sizeof(hdr)) {
+        return MAV_MISSION_ERROR;
+    }
+    memcpy(&hdr, buf, sizeof(hdr));
+    if (hdr.magic != MISSION_FILE_MAGIC ||
+        hdr.mission_type != MAV_MISSION_TYPE_MISSION ||
+        len != sizeof(hdr) + hdr.num_items * MISSION_FILE_ITEM_LEN) {
+        return MAV_MISSION_ERROR;
+    }
+    if (hdr.num_items == 0) {
+        // home is always present
+        return MAV_MISSION_INVALID_SEQUENCE;
+    }
+    if (hdr.num_items > max_items()) {
+        return MAV_MISSION_NO_SPACE;
+    }
+
+    WITH_SEMAPHORE(mission.get_semaphore());
+
+    if (apply) {
+        mission.truncate(hdr.num_items);
+    }
+
+    const uint8_t *items = &buf[sizeof(hdr)];
+    for (uint16_t i=0; i<hdr.num_items; i++) {
+        mavlink_mission_item_int_t item {};
+        memcpy(&item, &items[i*MISSION_FILE_ITEM_LEN], MISSION_FILE_ITEM_LEN);
+        if (item.seq != i) {
+            return MAV_MISSION_INVALID_SEQUENCE;
+        }
+        AP_Mission::Mission_Command cmd;
+        const MAV_MISSION_RESULT res = AP_Mission::mavlink_int_to_mission_cmd(item, cmd);
+        if (res != MAV_MISSION_ACCEPTED) {
+            return res;
+        }
+        // the whole mission is known, so jumps must land inside it
+        if (cmd.id == MAV_CMD_DO_JUMP &&
+            (cmd.content.jump.target == 0 || cmd.content.jump.target >= hdr.num_items)) {
+            return MAV_MISSION_ERROR;
+        }
+        if (!apply) {
+            continue;
+        }
+        const bool stored = (i < mission.num_commands()) ? mission.replace_cmd(i, cmd) : mission.add_cmd(cmd);
+        if (!stored) {
+            return MAV_MISSION_ERROR;
+        }
+    }
+
+    if (apply) {
+        gcs().send_text(MAV_SEVERITY_INFO, "Flight plan received");
+        AP::logger().Write_EntireMission();
+    }
+    return MAV_MISSION_ACCEPTED;
+}
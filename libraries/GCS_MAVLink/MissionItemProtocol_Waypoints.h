@@ -25,6 +25,14 @@ public:
     // can't truncate-to a longer list)
     void truncate(const mavlink_mission_count_t &packet) override;
 
+    // packed mission file for transfer over MAVLink FTP.
+    // pack_items() returns the file length, or zero on failure, and
+    // only fills buf when buf is not null and size is large enough
+    uint32_t pack_items(uint8_t *buf, uint32_t size) const;
+    // check a packed mission file as a whole, replacing the stored
+    // mission with it if apply is true
+    MAV_MISSION_RESULT unpack_items(const uint8_t *buf, uint32_t len, bool apply);
+
 protected:
 
     // clear_all_items() is called to clear all items on the vehicle
@@ -41,6 +49,14 @@ protected:
 private:
     AP_Mission &mission;
 
+    struct PACKED mission_file_header {
+        uint16_t magic;
+        uint8_t mission_type;
+        uint8_t options;
+        uint16_t start;
+        uint16_t num_items;
+    };
+
     // append_item() is called by the base class to add the supplied
     // item to the end of the list of stored items.
     MAV_MISSION_RESULT append_item(const mavlink_mission_item_int_t &) override WARN_IF_UNUSED;
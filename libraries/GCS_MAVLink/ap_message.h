@@ -73,5 +73,8 @@ enum ap_message : uint8_t {
     MSG_NAMED_FLOAT,
     MSG_EXTENDED_SYS_STATE,
     MSG_AUTOPILOT_VERSION,
+    MSG_SCHED_TASK_HISTOGRAM,
+    MSG_STREAM_RATE_STATS,
+    MSG_OBSTACLE_DISTANCE,
     MSG_LAST // MSG_LAST must be the last entry in this enum
 };
@@ -24,11 +24,14 @@ const AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
 };
 
 static MAVLink_routing routing;
+static MAVLink_routing fwd_routing;
 
 void setup(void)
 {
     hal.console->printf("routing test startup...");
+    _serialmanager.init();
     gcs().setup_console();
+    gcs().setup_uarts();
 }
 
 void loop(void)
@@ -92,6 +95,53 @@ void loop(void)
         err_count++;
     }
 
+    // learn a route to a component on the console channel, using
+    // a separate table so the routes don't change the results above
+    mavlink_msg_heartbeat_encode(10, 1, &msg, &heartbeat);
+    fwd_routing.check_and_forward(MAVLINK_COMM_0, msg);
+
+    uint32_t fwd0, drop0, fwd0_new, drop0_new;
+    fwd_routing.get_forward_counts(MAVLINK_COMM_0, fwd0, drop0);
+
+    // targeted message for that component is forwarded to its
+    // channel, and not processed locally
+    param_set.target_system = 10;
+    param_set.target_component = 1;
+    mavlink_msg_param_set_encode(3, 1, &msg, &param_set);
+    if (fwd_routing.check_and_forward(MAVLINK_COMM_1, msg)) {
+        hal.console->printf("param set 5 should not be processed locally\n");
+        err_count++;
+    }
+    fwd_routing.get_forward_counts(MAVLINK_COMM_0, fwd0_new, drop0_new);
+    if (fwd0_new + drop0_new != fwd0 + drop0 + 1) {
+        hal.console->printf("param set 5 should be forwarded on channel 0\n");
+        err_count++;
+    }
+
+    // messages for a system we haven't seen are not forwarded
+    param_set.target_system = 11;
+    mavlink_msg_param_set_encode(3, 1, &msg, &param_set);
+    fwd_routing.check_and_forward(MAVLINK_COMM_1, msg);
+    fwd_routing.get_forward_counts(MAVLINK_COMM_0, fwd0, drop0);
+    if (fwd0 + drop0 != fwd0_new + drop0_new) {
+        hal.console->printf("param set 6 should not be forwarded\n");
+        err_count++;
+    }
+
+    // many senders don't stop the route being found
+    for (uint8_t i=0; i<2*MAVLINK_MAX_ROUTES; i++) {
+        mavlink_msg_attitude_encode(100+i/8, i%8, &msg, &attitude);
+        fwd_routing.check_and_forward(MAVLINK_COMM_0, msg);
+    }
+    param_set.target_system = 10;
+    mavlink_msg_param_set_encode(3, 1, &msg, &param_set);
+    fwd_routing.check_and_forward(MAVLINK_COMM_1, msg);
+    fwd_routing.get_forward_counts(MAVLINK_COMM_0, fwd0_new, drop0_new);
+    if (fwd0_new + drop0_new != fwd0 + drop0 + 1) {
+        hal.console->printf("param set 7 should be forwarded on channel 0\n");
+        err_count++;
+    }
+
     if (err_count == 0) {
         hal.console->printf("All OK\n");
     }
@@ -33,6 +33,8 @@
 #include <AP_Param/AP_Param.h>
 #include <AP_Declination/AP_Declination.h>
 
+extern const AP_HAL::HAL& hal;
+
 using namespace SITL;
 
 /*
@@ -93,6 +95,41 @@ void Aircraft::set_start_location(const Location &start_loc, const float start_y
     dcm.from_euler(0.0f, 0.0f, radians(home_yaw));
 }
 
+/*
+  get the physical state for a snapshot
+ */
+void Aircraft::get_snapshot(snapshot_state &state) const
+{
+    state.time_now_us = time_now_us;
+    state.home = home;
+    state.home_yaw = home_yaw;
+    state.ground_level = ground_level;
+    state.position = position;
+    state.velocity_ef = velocity_ef;
+    state.dcm = dcm;
+    state.gyro = gyro;
+}
+
+/*
+  restore the physical state from a snapshot. Sensor outputs are
+  derived from this on the next step
+ */
+void Aircraft::set_snapshot(const snapshot_state &state)
+{
+    home = state.home;
+    home_yaw = state.home_yaw;
+    home_is_set = true;
+    ground_level = state.ground_level;
+    position = state.position;
+    velocity_ef = state.velocity_ef;
+    dcm = state.dcm;
+    gyro = state.gyro;
+    gyro_prev = state.gyro;
+    time_now_us = state.time_now_us;
+    last_time_us = time_now_us;
+    update_position();
+}
+
 /*
    return difference in altitude between home position and current loc
 */
@@ -155,16 +192,11 @@ void Aircraft::update_position(void)
 void Aircraft::update_mag_field_bf()
 {
     // get the magnetic field intensity and orientation
-    float intensity;
-    float declination;
-    float inclination;
-    AP_Declination::get_mag_field_ef(location.lat * 1e-7f, location.lng * 1e-7f, intensity, declination, inclination);
+    AP_Declination::MagField field;
+    mag_lookup.get_mag_field(location, field);
 
-    // create a field vector and rotate to the required orientation
-    Vector3f mag_ef(1e3f * intensity, 0.0f, 0.0f);
-    Matrix3f R;
-    R.from_euler(0.0f, -ToRad(inclination), ToRad(declination));
-    mag_ef = R * mag_ef;
+    // create a field vector in mGauss
+    Vector3f mag_ef = field.earth_field_ga() * 1e3f;
 
     // calculate frame height above ground
     const float frame_height_agl = fmaxf((-position.z) + home.alt * 0.01f - ground_level, 0.0f);
@@ -233,6 +265,21 @@ void Aircraft::adjust_frame_time(float new_rate)
 */
 void Aircraft::sync_frame_time(void)
 {
+    if (lockstep != nullptr) {
+        // don't get ahead of the rest of the swarm
+        const uint64_t wait_start_us = get_wall_time_us();
+        lockstep->sync(time_now_us);
+        wait_time_us += get_wall_time_us() - wait_start_us;
+    }
+
+    if (time_warp_idle()) {
+        // nothing is happening that needs real time, so don't sleep.
+        // Restart the rate measurement so we pick up cleanly after
+        frame_counter = 0;
+        last_wall_time_us = get_wall_time_us();
+        return;
+    }
+
     frame_counter++;
     uint64_t now = get_wall_time_us();
     if (frame_counter >= 40 &&
@@ -254,12 +301,25 @@ void Aircraft::sync_frame_time(void)
         const uint32_t sleep_time = static_cast<uint32_t>(scaled_frame_time_us * frame_counter);
         if (sleep_time > min_sleep_time) {
             usleep(sleep_time);
+            wait_time_us += get_wall_time_us() - now;
         }
         last_wall_time_us = now;
         frame_counter = 0;
     }
 }
 
+/*
+  the vehicle is idle if it is disarmed and at rest on the ground. The
+  physics step is unchanged, only the wall clock pacing is skipped
+ */
+bool Aircraft::time_warp_idle(void) const
+{
+    return time_warp &&
+           !hal.util->get_soft_armed() &&
+           on_ground() &&
+           velocity_ef.length() < 0.1f;
+}
+
 /* add noise based on throttle level (from 0..1) */
 void Aircraft::add_noise(float throttle)
 {
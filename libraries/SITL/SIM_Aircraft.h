@@ -29,7 +29,9 @@
 #include "SIM_Parachute.h"
 #include "SIM_Precland.h"
 #include "SIM_Buzzer.h"
+#include "SIM_Lockstep.h"
 #include <Filter/Filter.h>
+#include <AP_Declination/AP_Declination.h>
 
 namespace SITL {
 
@@ -55,6 +57,28 @@ public:
         instance = _instance;
     }
 
+    /*
+      run as fast as possible, ignoring the speedup, while the vehicle
+      is disarmed and at rest on the ground
+     */
+    void set_time_warp(bool enable) {
+        time_warp = enable;
+    }
+
+    /*
+      step in lockstep with other instances sharing this group
+     */
+    void set_lockstep(Lockstep *_lockstep) {
+        lockstep = _lockstep;
+    }
+
+    /*
+      wall clock time spent waiting in sync_frame_time(), for profiling
+     */
+    uint64_t get_wait_time_us(void) const {
+        return wait_time_us;
+    }
+
     /*
       set directory for additional files such as aircraft models
      */
@@ -122,6 +146,22 @@ public:
     const Location &get_home() const { return home; }
     float get_home_yaw() const { return home_yaw; }
 
+    /*
+      physical state kept in a SITL snapshot
+     */
+    struct snapshot_state {
+        uint64_t time_now_us;
+        Location home;
+        float home_yaw;
+        float ground_level;
+        Vector3f position;
+        Vector3f velocity_ef;
+        Matrix3f dcm;
+        Vector3f gyro;
+    };
+    void get_snapshot(snapshot_state &state) const;
+    void set_snapshot(const snapshot_state &state);
+
     void set_buzzer(Buzzer *_buzzer) { buzzer = _buzzer; }
     void set_sprayer(Sprayer *_sprayer) { sprayer = _sprayer; }
     void set_parachute(Parachute *_parachute) { parachute = _parachute; }
@@ -184,6 +224,9 @@ protected:
     float scaled_frame_time_us;
     uint64_t last_wall_time_us;
     uint8_t instance;
+    Lockstep *lockstep;
+    bool time_warp;
+    uint64_t wait_time_us;
     const char *autotest_dir;
     const char *frame;
     bool use_time_sync = true;
@@ -215,6 +258,7 @@ protected:
 
     /* update body frame magnetic field */
     void update_mag_field_bf(void);
+    AP_Declination::Lookup mag_lookup;
 
     /* advance time by deltat in seconds */
     void time_advance();
@@ -229,6 +273,9 @@ protected:
        into account desired speedup */
     void sync_frame_time(void);
 
+    /* true when time warp allows skipping wall clock sync */
+    bool time_warp_idle(void) const;
+
     /* add noise based on throttle level (from 0..1) */
     void add_noise(float throttle);
 
@@ -226,6 +226,23 @@ void Frame::init(float _mass, float hover_throttle, float _terminal_velocity, fl
 
     terminal_velocity = _terminal_velocity;
     terminal_rotation_rate = _terminal_rotation_rate;
+
+    // split the motors into fixed and tilting sets
+    const float arm_scale = radians(5000);
+    num_fixed = 0;
+    num_tilt = 0;
+    for (uint8_t i=0; i<MIN(num_motors, max_motors); i++) {
+        const Motor &m = motors[i];
+        if (m.roll_servo >= 0 || m.pitch_servo >= 0) {
+            tilt_motor[num_tilt++] = i;
+            continue;
+        }
+        fixed_servo[num_fixed] = m.servo;
+        fixed_arm_x[num_fixed] = arm_scale * cosf(radians(m.angle));
+        fixed_arm_y[num_fixed] = arm_scale * sinf(radians(m.angle));
+        fixed_yaw[num_fixed] = m.yaw_factor;
+        num_fixed++;
+    }
 }
 
 /*
@@ -250,12 +267,7 @@ void Frame::calculate_forces(const Aircraft &aircraft,
 {
     Vector3f thrust; // newtons
 
-    for (uint8_t i=0; i<num_motors; i++) {
-        Vector3f mraccel, mthrust;
-        motors[i].calculate_forces(input, thrust_scale, motor_offset, mraccel, mthrust);
-        rot_accel += mraccel;
-        thrust += mthrust;
-    }
+    calculate_motor_forces(input, rot_accel, thrust);
 
     body_accel = thrust/aircraft.gross_mass();
 
@@ -285,6 +297,39 @@ void Frame::calculate_forces(const Aircraft &aircraft,
                            aircraft.rand_normal(0, 1)) * accel_noise * noise_scale;
 }
 
+/*
+  sum the forces from all motors. This is the same model as
+  Motor::calculate_forces() for an untilted motor, with the arm %
+  thrust cross product expanded as thrust only has a z component
+ */
+void Frame::calculate_motor_forces(const struct sitl_input &input,
+                                   Vector3f &rot_accel, Vector3f &thrust)
+{
+    const float yaw_scale = radians(400);
+    const uint16_t *servos = &input.servos[motor_offset];
+
+    float speed[max_motors];
+    for (uint8_t i=0; i<num_fixed; i++) {
+        speed[i] = constrain_float((servos[fixed_servo[i]]-1100) * (1.0f/900), 0, 1);
+    }
+
+    float rx = 0, ry = 0, rz = 0, tz = 0;
+    for (uint8_t i=0; i<num_fixed; i++) {
+        rx -= fixed_arm_y[i] * speed[i];
+        ry += fixed_arm_x[i] * speed[i];
+        rz += fixed_yaw[i] * speed[i];
+        tz += speed[i];
+    }
+    rot_accel += Vector3f(rx, ry, rz * yaw_scale);
+    thrust.z -= tz * thrust_scale;
+
+    for (uint8_t i=0; i<num_tilt; i++) {
+        Vector3f mraccel, mthrust;
+        motors[tilt_motor[i]].calculate_forces(input, thrust_scale, motor_offset, mraccel, mthrust);
+        rot_accel += mraccel;
+        thrust += mthrust;
+    }
+}
 
 // calculate current and voltage
 void Frame::current_and_voltage(const struct sitl_input &input, float &voltage, float &current)
@@ -50,7 +50,11 @@ public:
     void calculate_forces(const Aircraft &aircraft,
                           const struct sitl_input &input,
                           Vector3f &rot_accel, Vector3f &body_accel);
-    
+
+    // sum the rotational acceleration and unscaled-by-mass thrust of all motors
+    void calculate_motor_forces(const struct sitl_input &input,
+                                Vector3f &rot_accel, Vector3f &thrust);
+
     float terminal_velocity;
     float terminal_rotation_rate;
     float thrust_scale;
@@ -58,5 +62,22 @@ public:
 
     // calculate current and voltage
     void current_and_voltage(const struct sitl_input &input, float &voltage, float &current);
+
+    static const uint8_t max_motors = 12;
+
+private:
+    /*
+      motors that never tilt are held as parallel arrays built in
+      init() so the per-step work is a single pass of multiply-adds
+      with the arm geometry precomputed. Tilting motors keep using
+      Motor::calculate_forces()
+     */
+    uint8_t num_fixed;
+    uint8_t fixed_servo[max_motors];
+    float fixed_arm_x[max_motors];
+    float fixed_arm_y[max_motors];
+    float fixed_yaw[max_motors];
+    uint8_t num_tilt;
+    uint8_t tilt_motor[max_motors];
 };
 }
@@ -20,6 +20,7 @@
 
 #include <stdio.h>
 #include <errno.h>
+#include <string.h>
 
 #include <AP_HAL/AP_HAL.h>
 
@@ -40,6 +41,16 @@ Gazebo::Gazebo(const char *frame_str) :
 */
 void Gazebo::set_interface_ports(const char* address, const int port_in, const int port_out)
 {
+    if (strncmp(address, "shm:", 4) == 0) {
+        // --sim-address shm:NAME uses a shared memory link instead
+        if (!shm_link.open(&address[4])) {
+            fprintf(stderr, "Aborting launch...\n");
+            exit(1);
+        }
+        use_shm = true;
+        return;
+    }
+
     // try to bind to a specific port so that if we restart ArduPilot
     // Gazebo keeps sending us packets. Not strictly necessary but
     // useful for debugging
@@ -69,7 +80,24 @@ void Gazebo::send_servos(const struct sitl_input &input)
     {
       pkt.motor_speed[i] = (input.servos[i]-1000) / 1000.0f;
     }
-    socket_sitl.sendto(&pkt, sizeof(pkt), _gazebo_address, _gazebo_port);
+    send_packet(&pkt, sizeof(pkt));
+}
+
+void Gazebo::send_packet(const void *pkt, uint16_t len)
+{
+    if (use_shm) {
+        shm_link.send(pkt, len);
+    } else {
+        socket_sitl.sendto(pkt, len, _gazebo_address, _gazebo_port);
+    }
+}
+
+ssize_t Gazebo::recv_packet(void *pkt, uint16_t len, uint32_t timeout_ms)
+{
+    if (use_shm) {
+        return shm_link.recv(pkt, len, timeout_ms);
+    }
+    return socket_sitl.recv(pkt, len, timeout_ms);
 }
 
 /*
@@ -84,7 +112,7 @@ void Gazebo::recv_fdm(const struct sitl_input &input)
       we re-send the servo packet every 0.1 seconds until we get a
       reply. This allows us to cope with some packet loss to the FDM
      */
-    while (socket_sitl.recv(&pkt, sizeof(pkt), 100) != sizeof(pkt)) {
+    while (recv_packet(&pkt, sizeof(pkt), 100) != sizeof(pkt)) {
         send_servos(input);
         // Reset the timestamp after a long disconnection, also catch gazebo reset
         if (get_wall_time_us() > last_wall_time_us + GAZEBO_TIMEOUT_US) {
@@ -142,7 +170,7 @@ void Gazebo::drain_sockets()
     ssize_t received;
     errno = 0;
     do {
-        received = socket_sitl.recv(buf, buflen, 0);
+        received = recv_packet(buf, buflen, 0);
         if (received < 0) {
             if (errno != EAGAIN && errno != EWOULDBLOCK && errno != 0) {
                 fprintf(stderr, "error recv on socket in: %s \n",
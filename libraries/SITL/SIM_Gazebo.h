@@ -20,6 +20,7 @@
 
 #include "SIM_Aircraft.h"
 #include <AP_HAL/utility/Socket.h>
+#include "SIM_ShmLink.h"
 
 namespace SITL {
 
@@ -66,9 +67,15 @@ private:
     void send_servos(const struct sitl_input &input);
     void drain_sockets();
 
+    // packet transport, either UDP or a shared memory link
+    void send_packet(const void *pkt, uint16_t len);
+    ssize_t recv_packet(void *pkt, uint16_t len, uint32_t timeout_ms);
+
     double last_timestamp;
 
     SocketAPM socket_sitl;
+    ShmLink shm_link;
+    bool use_shm;
     const char *_gazebo_address = "127.0.0.1";
     int _gazebo_port = 9002;
     static const uint64_t GAZEBO_TIMEOUT_US = 5000000;
@@ -0,0 +1,136 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  lockstep stepping of a group of SITL instances over shared memory
+*/
+
+#include "SIM_Lockstep.h"
+
+#include <AP_Math/AP_Math.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace SITL;
+
+/*
+  join a lockstep group, creating the shared segment if we are first
+ */
+bool Lockstep::init(const char *group, uint8_t instance, uint32_t _window_us)
+{
+    if (instance >= max_members) {
+        ::printf("Lockstep: instance %u too large, max %u\n",
+                 unsigned(instance), unsigned(max_members-1));
+        return false;
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "/ap_lockstep_%s", group);
+    int fd = shm_open(name, O_RDWR|O_CREAT, 0600);
+    if (fd == -1) {
+        ::printf("Lockstep: shm_open(%s) failed: %s\n", name, strerror(errno));
+        return false;
+    }
+    // a new segment is zero filled, which is an empty group
+    if (ftruncate(fd, sizeof(shared)) != 0) {
+        ::printf("Lockstep: ftruncate(%s) failed: %s\n", name, strerror(errno));
+        close(fd);
+        return false;
+    }
+    void *p = mmap(nullptr, sizeof(shared), PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        ::printf("Lockstep: mmap(%s) failed: %s\n", name, strerror(errno));
+        return false;
+    }
+
+    shared *s = (shared *)p;
+    member &m = s->members[instance];
+    const pid_t other = __atomic_load_n(&m.pid, __ATOMIC_ACQUIRE);
+    if (other != 0 && other != getpid() && kill(other, 0) == 0) {
+        ::printf("Lockstep: member %u of %s is in use by pid %d\n",
+                 unsigned(instance), group, int(other));
+        munmap(p, sizeof(shared));
+        return false;
+    }
+
+    slot = instance;
+    window_us = _window_us;
+    __atomic_store_n(&m.time_us, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&m.pid, getpid(), __ATOMIC_RELEASE);
+    shm = s;
+
+    // drop any members left behind by earlier runs
+    group_time_us(true);
+
+    ::printf("Lockstep: joined %s as member %u with window %uus\n",
+             group, unsigned(instance), unsigned(window_us));
+    return true;
+}
+
+/*
+  return the lowest simulation time of the other members, optionally
+  removing any whose process has gone
+ */
+uint64_t Lockstep::group_time_us(bool check_pids)
+{
+    uint64_t ret = UINT64_MAX;
+    for (uint8_t i=0; i<max_members; i++) {
+        if (i == slot) {
+            continue;
+        }
+        member &m = shm->members[i];
+        pid_t pid = __atomic_load_n(&m.pid, __ATOMIC_ACQUIRE);
+        if (pid == 0) {
+            continue;
+        }
+        if (check_pids && kill(pid, 0) != 0 && errno == ESRCH) {
+            // the process exited without leaving the group
+            __atomic_compare_exchange_n(&m.pid, &pid, 0, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+            continue;
+        }
+        ret = MIN(ret, __atomic_load_n(&m.time_us, __ATOMIC_ACQUIRE));
+    }
+    return ret;
+}
+
+/*
+  publish our time and wait for the slowest member to catch up
+ */
+void Lockstep::sync(uint64_t time_us)
+{
+    if (shm == nullptr) {
+        return;
+    }
+    __atomic_store_n(&shm->members[slot].time_us, time_us, __ATOMIC_RELEASE);
+    if (time_us <= window_us) {
+        return;
+    }
+    const uint64_t limit = time_us - window_us;
+    uint32_t waits = 0;
+    while (group_time_us(false) < limit) {
+        usleep(50);
+        // every second or so check for members that have died while
+        // we were waiting on them
+        if (++waits % 10000 == 0) {
+            group_time_us(true);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  keep a group of SITL instances on one host stepping their physics in
+  lockstep. Each member publishes its simulation time in a shared
+  memory segment and does not step more than a window ahead of the
+  slowest member, so a swarm advances together as fast as the CPU
+  allows without any socket traffic for timing
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <sys/types.h>
+
+namespace SITL {
+
+class Lockstep {
+public:
+    static const uint8_t max_members = 64;
+
+    // join the named group using slot instance. window_us is how far
+    // ahead of the slowest member we may step
+    bool init(const char *group, uint8_t instance, uint32_t window_us);
+
+    // publish our simulation time and wait until every other member
+    // of the group is within the window
+    void sync(uint64_t time_us);
+
+private:
+    // accessed with __atomic builtins as other processes update it
+    struct member {
+        uint64_t time_us;
+        pid_t pid;
+    };
+    struct shared {
+        member members[max_members];
+    };
+
+    shared *shm = nullptr;
+    uint8_t slot;
+    uint32_t window_us;
+
+    // return the lowest simulation time of the other live members
+    uint64_t group_time_us(bool check_pids);
+};
+
+} // namespace SITL
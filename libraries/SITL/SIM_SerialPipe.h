@@ -0,0 +1,75 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  in-process serial link between a simulated device and a SITL
+  UART. The UART lends its own receive and transmit ring buffers to
+  the pipe, so the device writes straight into the buffer the driver
+  reads from and no byte crosses a file descriptor. Both directions
+  are single producer, single consumer
+*/
+
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/RingBuffer.h>
+
+namespace SITL {
+
+class SerialPipe {
+public:
+    // connect the UART end of the pipe
+    void attach(ByteBuffer *_to_autopilot, ByteBuffer *_from_autopilot) {
+        to_autopilot = _to_autopilot;
+        from_autopilot = _from_autopilot;
+    }
+
+    // true once a UART has been attached
+    bool attached(void) const { return to_autopilot != nullptr; }
+
+    // write bytes from the device to the autopilot. Bytes that do
+    // not fit are lost, as on a real serial line
+    uint32_t write(const uint8_t *buf, uint32_t len) {
+        if (to_autopilot == nullptr) {
+            return 0;
+        }
+        last_write_us = AP_HAL::micros64();
+        return to_autopilot->write(buf, len);
+    }
+
+    // read bytes sent by the autopilot to the device
+    uint32_t read(uint8_t *buf, uint32_t len) {
+        if (from_autopilot == nullptr) {
+            return 0;
+        }
+        return from_autopilot->read(buf, len);
+    }
+
+    // discard anything the autopilot has sent
+    void skip_input(void) {
+        if (from_autopilot != nullptr) {
+            from_autopilot->advance(from_autopilot->available());
+        }
+    }
+
+    // time of the last write from the device, for receive timestamps
+    uint64_t last_write_time_us(void) const { return last_write_us; }
+
+private:
+    ByteBuffer *to_autopilot;
+    ByteBuffer *from_autopilot;
+    uint64_t last_write_us;
+};
+
+} // namespace SITL
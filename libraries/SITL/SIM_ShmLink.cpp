@@ -0,0 +1,149 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  shared memory link to an external simulator
+*/
+
+#include "SIM_ShmLink.h"
+
+#include <AP_Math/AP_Math.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+using namespace SITL;
+
+/*
+  create or attach to the named segment. Either side may be first
+ */
+bool ShmLink::open(const char *name)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/ap_sim_%s", name);
+    int fd = shm_open(path, O_RDWR|O_CREAT, 0600);
+    if (fd == -1) {
+        ::printf("ShmLink: shm_open(%s) failed: %s\n", path, strerror(errno));
+        return false;
+    }
+    if (ftruncate(fd, sizeof(segment)) != 0) {
+        ::printf("ShmLink: ftruncate(%s) failed: %s\n", path, strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    void *p = mmap(nullptr, sizeof(segment), PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        ::printf("ShmLink: mmap(%s) failed: %s\n", path, strerror(errno));
+        return false;
+    }
+    seg = (segment *)p;
+
+    // we restart the rings on each start, discarding anything the
+    // simulator sent to a previous run
+    __atomic_store_n(&seg->to_sim.tail, __atomic_load_n(&seg->to_sim.head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+    __atomic_store_n(&seg->from_sim.tail, __atomic_load_n(&seg->from_sim.head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+    seg->version = version;
+    __atomic_store_n(&seg->magic, magic, __ATOMIC_RELEASE);
+
+    ::printf("ShmLink: using %s\n", path);
+    return true;
+}
+
+bool ShmLink::send(const void *data, uint16_t len)
+{
+    if (seg == nullptr || len > max_payload) {
+        return false;
+    }
+    ring &r = seg->to_sim;
+    const uint32_t head = __atomic_load_n(&r.head, __ATOMIC_RELAXED);
+    const uint32_t tail = __atomic_load_n(&r.tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= ring_size) {
+        return false;
+    }
+    auto &e = r.entry[head % ring_size];
+    e.len = len;
+    memcpy(e.data, data, len);
+    __atomic_store_n(&r.head, head+1, __ATOMIC_RELEASE);
+    wake(&r.head);
+    return true;
+}
+
+ssize_t ShmLink::recv(void *data, uint16_t len, uint32_t timeout_ms)
+{
+    if (seg == nullptr) {
+        return -1;
+    }
+    ring &r = seg->from_sim;
+    const uint32_t tail = __atomic_load_n(&r.tail, __ATOMIC_RELAXED);
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    const uint64_t start_us = ts.tv_sec*1000000ULL + ts.tv_nsec/1000U;
+    const uint64_t timeout_us = timeout_ms*1000ULL;
+    while (true) {
+        const uint32_t head = __atomic_load_n(&r.head, __ATOMIC_ACQUIRE);
+        if (head != tail) {
+            const auto &e = r.entry[tail % ring_size];
+            const uint16_t n = MIN(e.len, uint32_t(len));
+            memcpy(data, e.data, n);
+            __atomic_store_n(&r.tail, tail+1, __ATOMIC_RELEASE);
+            return n;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        const uint64_t elapsed_us = ts.tv_sec*1000000ULL + ts.tv_nsec/1000U - start_us;
+        if (elapsed_us >= timeout_us) {
+            return -1;
+        }
+        wait(&r.head, head, timeout_us - elapsed_us);
+    }
+}
+
+/*
+  wake a process waiting on a ring head
+ */
+void ShmLink::wake(uint32_t *word)
+{
+#ifdef __linux__
+    syscall(SYS_futex, word, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+/*
+  wait for a ring head to change from value
+ */
+void ShmLink::wait(uint32_t *word, uint32_t value, uint32_t timeout_us)
+{
+#ifdef __linux__
+    struct timespec ts;
+    ts.tv_sec = timeout_us / 1000000U;
+    ts.tv_nsec = (timeout_us % 1000000U) * 1000U;
+    syscall(SYS_futex, word, FUTEX_WAIT, value, &ts, nullptr, 0);
+#else
+    (void)word;
+    (void)value;
+    usleep(MIN(timeout_us, 50U));
+#endif
+}
@@ -0,0 +1,78 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  shared memory link to an external simulator, for use in place of a
+  UDP socket by any SIM_* backend that exchanges fixed packets.
+
+  The segment (shm_open name "/ap_sim_NAME") holds two single producer,
+  single consumer rings of packets: to_sim carries servo outputs from
+  ArduPilot and from_sim carries FDM state back. A producer copies a
+  packet into entry[head % ring_size] then increments head; a consumer
+  reads entry[tail % ring_size] once head != tail then increments tail.
+  On Linux the consumer sleeps on head with a (shared, non-private)
+  futex and the producer wakes it, so a lockstep frame costs no socket
+  syscalls. Elsewhere the consumer polls. The layout uses only fixed
+  size types so a simulator plugin can mirror it in plain C
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <sys/types.h>
+
+namespace SITL {
+
+class ShmLink {
+public:
+    static const uint32_t magic = 0x41505348; // "APSH"
+    static const uint32_t version = 1;
+    static const uint8_t ring_size = 4;
+    static const uint16_t max_payload = 512;
+
+    // create or attach to the named segment
+    bool open(const char *name);
+
+    // queue a packet for the simulator, returning false if the
+    // simulator has not kept up and the ring is full
+    bool send(const void *data, uint16_t len);
+
+    // wait up to timeout_ms for the next packet from the simulator,
+    // returning its length, or -1 on timeout
+    ssize_t recv(void *data, uint16_t len, uint32_t timeout_ms);
+
+    struct ring {
+        uint32_t head;
+        uint32_t tail;
+        struct {
+            uint32_t len;
+            uint8_t data[max_payload];
+        } entry[ring_size];
+    };
+
+    struct segment {
+        uint32_t magic;
+        uint32_t version;
+        ring to_sim;
+        ring from_sim;
+    };
+
+private:
+    segment *seg = nullptr;
+
+    static void wake(uint32_t *word);
+    static void wait(uint32_t *word, uint32_t value, uint32_t timeout_us);
+};
+
+} // namespace SITL
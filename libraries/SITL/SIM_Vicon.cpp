@@ -21,8 +21,6 @@
 
 #include "SIM_Vicon.h"
 #include <stdio.h>
-#include <unistd.h>
-#include <fcntl.h>
 
 using namespace SITL;
 
@@ -31,21 +29,6 @@ using namespace SITL;
 
 Vicon::Vicon()
 {
-    int tmp[2];
-    if (pipe(tmp) == -1) {
-        AP_HAL::panic("pipe() failed");
-    }
-    fd_my_end    = tmp[1];
-    fd_their_end = tmp[0];
-
-    // close file descriptors on exec:
-    fcntl(fd_my_end, F_SETFD, FD_CLOEXEC);
-    fcntl(fd_their_end, F_SETFD, FD_CLOEXEC);
-
-    // make sure we don't screw the simulation up by blocking:
-    fcntl(fd_my_end, F_SETFL, fcntl(fd_my_end, F_GETFL, 0) | O_NONBLOCK);
-    fcntl(fd_their_end, F_SETFL, fcntl(fd_their_end, F_GETFL, 0) | O_NONBLOCK);
-
     if (!valid_channel(mavlink_ch)) {
         AP_HAL::panic("Invalid mavlink channel");
     }
@@ -87,7 +70,7 @@ void Vicon::update_vicon_position_estimate(const Location &loc,
         uint8_t msgbuf[300];
         uint16_t msgbuf_len = mavlink_msg_to_send_buffer(msgbuf, &obs_msg);
 
-        if (::write(fd_my_end, (void*)&msgbuf, msgbuf_len) != msgbuf_len) {
+        if (_pipe.write(msgbuf, msgbuf_len) != msgbuf_len) {
             ::fprintf(stderr, "Vicon: write failure\n");
         }
         time_send_us = 0;
@@ -24,6 +24,8 @@
 
 #include <AP_HAL/utility/RingBuffer.h>
 
+#include "SIM_SerialPipe.h"
+
 namespace SITL {
 
 class Vicon {
@@ -34,9 +36,8 @@ public:
     // update state
     void update(const Location &loc, const Vector3f &position, const Quaternion &attitude);
 
-    // return fd on which data from the device can be read, and data
-    // to the device can be written
-    int fd() { return fd_their_end; }
+    // return the in-process pipe carrying data from the device
+    SerialPipe *pipe() { return &_pipe; }
 
 private:
 
@@ -49,8 +50,7 @@ private:
     // we share channels with the ArduPilot binary!
     const mavlink_channel_t mavlink_ch = (mavlink_channel_t)(MAVLINK_COMM_0+5);
 
-    int fd_their_end;
-    int fd_my_end;
+    SerialPipe _pipe;
 
     uint64_t last_observation_usec;
     uint64_t time_send_us;
@@ -0,0 +1,56 @@
+#include <AP_gbenchmark.h>
+
+#include <SITL/SIM_Frame.h>
+
+using namespace SITL;
+
+/*
+  compare the per-motor force model with the batched one in
+  Frame::calculate_motor_forces() on the largest frame
+ */
+static Frame *setup_frame(struct sitl_input &input)
+{
+    Frame *frame = Frame::find_frame("dodeca-hexa");
+    frame->init(3.0, 0.5, 85, 4*radians(360));
+    frame->motor_offset = 0;
+    for (uint8_t i=0; i<ARRAY_SIZE(input.servos); i++) {
+        input.servos[i] = 1400 + 20*i;
+    }
+    return frame;
+}
+
+static void BM_FrameForcesPerMotor(benchmark::State& state)
+{
+    struct sitl_input input {};
+    Frame *frame = setup_frame(input);
+
+    while (state.KeepRunning()) {
+        Vector3f rot_accel, thrust;
+        for (uint8_t i=0; i<frame->num_motors; i++) {
+            Vector3f mraccel, mthrust;
+            frame->motors[i].calculate_forces(input, frame->thrust_scale, frame->motor_offset, mraccel, mthrust);
+            rot_accel += mraccel;
+            thrust += mthrust;
+        }
+        gbenchmark_escape(&rot_accel);
+        gbenchmark_escape(&thrust);
+    }
+}
+
+static void BM_FrameForcesBatched(benchmark::State& state)
+{
+    struct sitl_input input {};
+    Frame *frame = setup_frame(input);
+
+    while (state.KeepRunning()) {
+        Vector3f rot_accel, thrust;
+        frame->calculate_motor_forces(input, rot_accel, thrust);
+        gbenchmark_escape(&rot_accel);
+        gbenchmark_escape(&thrust);
+    }
+}
+
+BENCHMARK(BM_FrameForcesPerMotor);
+BENCHMARK(BM_FrameForcesBatched);
+
+BENCHMARK_MAIN()
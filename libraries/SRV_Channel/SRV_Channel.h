@@ -270,6 +270,9 @@ private:
     // output value based on function
     void output_ch(void);
 
+    // update output_pwm for the manual and rc passthrough functions
+    void update_passthrough_pwm(void);
+
     // setup output type and range based on function
     void aux_servo_function_setup(void);
 
@@ -338,7 +341,7 @@ public:
     // limit slew rate to given limit in percent per second
     static void limit_slew_rate(SRV_Channel::Aux_servo_function_t function, float slew_rate, float dt);
 
-    // call output_ch() on all channels
+    // output all channels, in one write to the HAL
     static void output_ch_all(void);
 
     // setup output ESC scaling based on a channels MIN/MAX
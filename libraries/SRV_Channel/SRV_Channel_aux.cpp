@@ -26,6 +26,15 @@ extern const AP_HAL::HAL& hal;
 
 /// map a function to a servo channel and output it
 void SRV_Channel::output_ch(void)
+{
+    update_passthrough_pwm();
+    if (!(SRV_Channels::disabled_mask & (1U<<ch_num))) {
+        hal.rcout->write(ch_num, output_pwm);
+    }
+}
+
+/// take the output from the rc input for passthrough functions
+void SRV_Channel::update_passthrough_pwm(void)
 {
     int8_t passthrough_from = -1;
 
@@ -60,19 +69,23 @@ void SRV_Channel::output_ch(void)
             }
         }
     }
-    if (!(SRV_Channels::disabled_mask & (1U<<ch_num))) {
-        hal.rcout->write(ch_num, output_pwm);
-    }
 }
 
 /*
-  call output_ch() on all channels
+  output all channels, in one write to the HAL
  */
 void SRV_Channels::output_ch_all(void)
 {
+    uint16_t pwm[NUM_SERVO_CHANNELS];
+    uint32_t chmask = 0;
     for (uint8_t i = 0; i < NUM_SERVO_CHANNELS; i++) {
-        channels[i].output_ch();
+        channels[i].update_passthrough_pwm();
+        pwm[i] = channels[i].output_pwm;
+        if (!(disabled_mask & (1U<<i))) {
+            chmask |= (1U<<i);
+        }
     }
+    hal.rcout->write_channels(chmask, pwm);
 }
 
 /*
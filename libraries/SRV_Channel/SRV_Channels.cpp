@@ -233,6 +233,8 @@ void SRV_Channels::cork()
  */
 void SRV_Channels::push()
 {
+    static uint32_t push_count;
+    hal.util->trace(AP_HAL::Util::TRACE_RCOUT_PUSH, nullptr, push_count++);
     hal.rcout->push();
 
     // give volz library a chance to update